@@ -57,6 +57,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/platform.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/public/version.h"
@@ -588,6 +589,25 @@ TFE_TensorHandle* TFE_NewTensorHandleFromDeviceMemory(
       std::move(t), device, device, context));
 }
 
+void* TFE_GetDeviceStream(TFE_Context* ctx, const char* device_name,
+                          TF_Status* status) {
+  tensorflow::Device* device = nullptr;
+  tensorflow::EagerContext* context =
+      tensorflow::ContextFromInterface(tensorflow::unwrap(ctx));
+  status->status = context->FindDeviceFromName(device_name, &device);
+  if (!status->status.ok()) {
+    status->status =
+        tensorflow::errors::InvalidArgument(device_name, " unknown device.");
+    return nullptr;
+  }
+  const tensorflow::DeviceBase::AcceleratorDeviceInfo* device_info =
+      device->tensorflow_accelerator_device_info();
+  if (device_info == nullptr || device_info->stream == nullptr) {
+    return nullptr;
+  }
+  return device_info->stream->implementation()->GpuStreamHack();
+}
+
 // This function will block till the operation that produces `h` has
 // completed. This is only valid on local TFE_TensorHandles. Returns the size in
 // bytes of the memory pointed to by the device pointer returned above.
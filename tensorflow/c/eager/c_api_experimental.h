@@ -417,6 +417,12 @@ TF_CAPI_EXPORT extern size_t TFE_TensorHandleDeviceMemorySize(TFE_TensorHandle*,
 // device_name. Takes ownership of the memory, and will call deleter to release
 // it after TF no longer needs it or in case of error.
 //
+// The memory is not copied. Kernels that read it are enqueued on the stream
+// returned by TFE_GetDeviceStream, so memory written on another stream must be
+// ordered before them (e.g. with cuStreamWaitEvent on that stream) before the
+// handle is used. Likewise, the deleter may run before those kernels finish,
+// so it should only recycle the memory after work on the stream completes.
+//
 // Custom devices must use TFE_NewCustomDeviceTensorHandle instead.
 TF_CAPI_EXPORT extern TFE_TensorHandle* TFE_NewTensorHandleFromDeviceMemory(
     TFE_Context* ctx, const char* device_name, TF_DataType, const int64_t* dims,
@@ -424,6 +430,15 @@ TF_CAPI_EXPORT extern TFE_TensorHandle* TFE_NewTensorHandleFromDeviceMemory(
     void (*deallocator)(void* data, size_t len, void* arg),
     void* deallocator_arg, TF_Status* status);
 
+// Returns the platform stream (a cudaStream_t or hipStream_t) that kernels on
+// the physical device `device_name` are enqueued on, for synchronizing with
+// memory passed to TFE_NewTensorHandleFromDeviceMemory. Returns nullptr if the
+// device does not execute on a GPU stream, e.g. for CPU devices. The stream
+// is owned by TF and lives as long as `ctx`.
+TF_CAPI_EXPORT extern void* TFE_GetDeviceStream(TFE_Context* ctx,
+                                                const char* device_name,
+                                                TF_Status* status);
+
 // Retrieves the address space (i.e. job, replia, task) of the local host and
 // saves it in the buffer.
 TF_CAPI_EXPORT extern void TFE_HostAddressSpace(TFE_Context* ctx,
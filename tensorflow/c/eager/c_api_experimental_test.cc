@@ -410,6 +410,30 @@ TEST(CAPI, TensorHandleOnDeviceMemory) {
   TF_DeleteStatus(status);
 }
 
+TEST(CAPI, DeviceStream) {
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  EXPECT_EQ(nullptr, TFE_GetDeviceStream(ctx, "CPU:0", status));
+  EXPECT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+
+  string gpu_device_name;
+  if (GetDeviceName(ctx, &gpu_device_name, "GPU")) {
+    EXPECT_NE(nullptr,
+              TFE_GetDeviceStream(ctx, gpu_device_name.c_str(), status));
+    EXPECT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  }
+
+  EXPECT_EQ(nullptr, TFE_GetDeviceStream(ctx, "NoSuchDevice:0", status));
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(status));
+
+  TFE_DeleteContext(ctx);
+  TF_DeleteStatus(status);
+}
+
 TEST(CAPI, TensorHandleNullptr) {
   TFE_TensorHandle* h = nullptr;
   std::unique_ptr<TF_Status, decltype(&TF_DeleteStatus)> status(
@@ -0,0 +1,94 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/c/experimental/saved_model/core/revived_types/lazy_function_library.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/c/experimental/saved_model/core/test_utils.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class LazyFunctionLibraryTest : public ::testing::Test {
+ public:
+  LazyFunctionLibraryTest()
+      : device_mgr_(testing::CreateTestingDeviceMgr()),
+        ctx_(testing::CreateTestingEagerContext(device_mgr_.get())) {}
+
+  EagerContext* context() { return ctx_.get(); }
+
+ private:
+  std::unique_ptr<StaticDeviceMgr> device_mgr_;
+  EagerContextPtr ctx_;
+};
+
+// Adds a function named `name` that calls `callee` through a node, and
+// `branch` through a function-valued attr, if they are non-empty.
+void AddFunction(const std::string& name, const std::string& callee,
+                 const std::string& branch, FunctionDefLibrary* library) {
+  FunctionDef* function = library->add_function();
+  function->mutable_signature()->set_name(name);
+  if (!callee.empty()) {
+    NodeDef* node = function->add_node_def();
+    node->set_name("call");
+    node->set_op(callee);
+  }
+  if (!branch.empty()) {
+    NodeDef* node = function->add_node_def();
+    node->set_name("cond");
+    node->set_op("If");
+    (*node->mutable_attr())["then_branch"].mutable_func()->set_name(branch);
+  }
+}
+
+TEST_F(LazyFunctionLibraryTest, RegistersCalleesOnFirstUse) {
+  FunctionDefLibrary library;
+  AddFunction("serve", /*callee=*/"body", /*branch=*/"", &library);
+  AddFunction("body", /*callee=*/"", /*branch=*/"then", &library);
+  AddFunction("then", /*callee=*/"", /*branch=*/"", &library);
+  AddFunction("train", /*callee=*/"body", /*branch=*/"", &library);
+
+  {
+    LazyFunctionLibrary lazy_library(library, context());
+    EXPECT_EQ(context()->FindFunctionDef("serve"), nullptr);
+
+    TF_ASSERT_OK(lazy_library.Register("serve"));
+    EXPECT_NE(context()->FindFunctionDef("serve"), nullptr);
+    EXPECT_NE(context()->FindFunctionDef("body"), nullptr);
+    EXPECT_NE(context()->FindFunctionDef("then"), nullptr);
+    EXPECT_EQ(context()->FindFunctionDef("train"), nullptr);
+
+    // Registering again, or registering a function whose callees are already
+    // registered, is fine.
+    TF_ASSERT_OK(lazy_library.Register("serve"));
+    TF_ASSERT_OK(lazy_library.Register("train"));
+    EXPECT_NE(context()->FindFunctionDef("train"), nullptr);
+  }
+
+  // The registered functions are removed with the library.
+  EXPECT_EQ(context()->FindFunctionDef("serve"), nullptr);
+  EXPECT_EQ(context()->FindFunctionDef("train"), nullptr);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -34,10 +34,15 @@ namespace tensorflow {
 
 FlatTensorFunction::FlatTensorFunction(
     const std::string& name, std::vector<ImmediateTensorHandlePtr> captures,
-    ImmediateExecutionContext* ctx)
-    : name_(name), captures_(std::move(captures)), ctx_(ctx) {}
+    LazyFunctionLibrary* library, ImmediateExecutionContext* ctx)
+    : name_(name),
+      captures_(std::move(captures)),
+      library_(library),
+      ctx_(ctx) {}
 
 FlatTensorFunction::~FlatTensorFunction() {
+  // The library de-registers the functions it has registered.
+  if (library_ != nullptr) return;
   Status status = ctx_->RemoveFunction(name_);
   if (!status.ok()) {
     LOG(ERROR) << "Failed to remove functiondef " << name_ << ". "
@@ -48,8 +53,11 @@ FlatTensorFunction::~FlatTensorFunction() {
 Status FlatTensorFunction::Create(
     const FunctionDef* function_def,
     std::vector<ImmediateExecutionTensorHandle*> captures,
-    ImmediateExecutionContext* ctx, std::unique_ptr<FlatTensorFunction>* out) {
-  TF_RETURN_IF_ERROR(ctx->AddFunctionDef(*function_def));
+    LazyFunctionLibrary* library, ImmediateExecutionContext* ctx,
+    std::unique_ptr<FlatTensorFunction>* out) {
+  if (library == nullptr) {
+    TF_RETURN_IF_ERROR(ctx->AddFunctionDef(*function_def));
+  }
   std::vector<ImmediateTensorHandlePtr> owned_captures;
   owned_captures.reserve(captures.size());
   for (ImmediateExecutionTensorHandle* capture : captures) {
@@ -58,12 +66,16 @@ Status FlatTensorFunction::Create(
   }
 
   out->reset(new FlatTensorFunction(function_def->signature().name(),
-                                    std::move(owned_captures), ctx));
+                                    std::move(owned_captures), library, ctx));
   return Status();
 }
 
 Status FlatTensorFunction::MakeCallOp(
     absl::Span<AbstractTensorHandle* const> inputs, ImmediateOpPtr* out) const {
+  if (library_ != nullptr && !registered_.load(std::memory_order_acquire)) {
+    TF_RETURN_IF_ERROR(library_->Register(name_));
+    registered_.store(true, std::memory_order_release);
+  }
   out->reset(ctx_->CreateOperation());
   // In eager mode, TF2 python executes functions by constructing an op with
   // the name of the functiondef:
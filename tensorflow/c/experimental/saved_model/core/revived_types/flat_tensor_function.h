@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_C_EXPERIMENTAL_SAVED_MODEL_CORE_REVIVED_TYPES_FLAT_TENSOR_FUNCTION_H_
 #define TENSORFLOW_C_EXPERIMENTAL_SAVED_MODEL_CORE_REVIVED_TYPES_FLAT_TENSOR_FUNCTION_H_
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <string>
@@ -24,6 +25,7 @@ limitations under the License.
 #include "tensorflow/c/eager/immediate_execution_context.h"
 #include "tensorflow/c/eager/immediate_execution_operation.h"
 #include "tensorflow/c/eager/immediate_execution_tensor_handle.h"
+#include "tensorflow/c/experimental/saved_model/core/revived_types/lazy_function_library.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/protobuf/saved_object_graph.pb.h"
 
@@ -53,11 +55,17 @@ class FlatTensorFunction {
   //             FlatTensorFunction. FlatTensorFunction will participate in
   //             ownership of the handles (it explicitly increments the refcount
   //             of each handle, and will decrement them on destruction).
+  //  library  - If non-null, function_def is not registered on creation.
+  //             Instead, `library` registers it and the functions it calls
+  //             on the first call of the function, and de-registers them on
+  //             its own destruction. `library` MUST hold function_def and
+  //             outlive the FlatTensorFunction.
   //  ctx      - A handle to the Tensorflow runtime. This MUST be non-null and
   //             outlive TFConcreteFunction.
   //  out      - The output FlatTensorFunction.
   static Status Create(const FunctionDef* function_def,
                        std::vector<ImmediateExecutionTensorHandle*> captures,
+                       LazyFunctionLibrary* library,
                        ImmediateExecutionContext* ctx,
                        std::unique_ptr<FlatTensorFunction>* out);
 
@@ -70,6 +78,7 @@ class FlatTensorFunction {
  private:
   FlatTensorFunction(const std::string& name,
                      std::vector<ImmediateTensorHandlePtr> captures,
+                     LazyFunctionLibrary* library,
                      ImmediateExecutionContext* ctx);
 
   FlatTensorFunction(const FlatTensorFunction&) = delete;
@@ -78,6 +87,10 @@ class FlatTensorFunction {
   // Name of the FunctionDef corresponding to this TFConcreteFunction
   std::string name_;
   std::vector<ImmediateTensorHandlePtr> captures_;
+  // Null if the function was registered on creation.
+  LazyFunctionLibrary* library_;
+  // Whether `library_` has registered the function.
+  mutable std::atomic<bool> registered_{false};
   ImmediateExecutionContext* ctx_;
 };
 
@@ -0,0 +1,93 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/c/experimental/saved_model/core/revived_types/lazy_function_library.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+// Adds the names of the functions called by `node`, either directly or through
+// a function-valued attr such as the branches of an If, to `callees`.
+void AddCallees(const NodeDef& node, std::vector<std::string>* callees) {
+  callees->push_back(node.op());
+  for (const auto& attr : node.attr()) {
+    const AttrValue& value = attr.second;
+    if (value.has_func()) {
+      callees->push_back(value.func().name());
+    } else if (value.has_list()) {
+      for (const NameAttrList& func : value.list().func()) {
+        callees->push_back(func.name());
+      }
+    }
+  }
+}
+
+}  // namespace
+
+LazyFunctionLibrary::LazyFunctionLibrary(const FunctionDefLibrary& library,
+                                         ImmediateExecutionContext* ctx)
+    : ctx_(ctx) {
+  mutex_lock l(mu_);
+  serialized_functions_.reserve(library.function_size());
+  for (const FunctionDef& function : library.function()) {
+    serialized_functions_[function.signature().name()] =
+        function.SerializeAsString();
+  }
+}
+
+LazyFunctionLibrary::~LazyFunctionLibrary() {
+  mutex_lock l(mu_);
+  for (const std::string& name : registered_functions_) {
+    Status status = ctx_->RemoveFunction(name);
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to remove functiondef " << name << ". "
+                 << status.error_message();
+    }
+  }
+}
+
+Status LazyFunctionLibrary::Register(const std::string& name) {
+  mutex_lock l(mu_);
+  std::vector<std::string> pending = {name};
+  while (!pending.empty()) {
+    const std::string function_name = std::move(pending.back());
+    pending.pop_back();
+    // Op names that are not functions of the library are skipped here.
+    auto it = serialized_functions_.find(function_name);
+    if (it == serialized_functions_.end()) continue;
+
+    FunctionDef function;
+    if (!function.ParseFromString(it->second)) {
+      return errors::Internal("Failed to parse functiondef ", function_name);
+    }
+    TF_RETURN_IF_ERROR(ctx_->AddFunctionDef(function));
+    serialized_functions_.erase(it);
+    registered_functions_.insert(function_name);
+    for (const NodeDef& node : function.node_def()) {
+      AddCallees(node, &pending);
+    }
+  }
+  return Status();
+}
+
+}  // namespace tensorflow
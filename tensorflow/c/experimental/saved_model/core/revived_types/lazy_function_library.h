@@ -0,0 +1,70 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_C_EXPERIMENTAL_SAVED_MODEL_CORE_REVIVED_TYPES_LAZY_FUNCTION_LIBRARY_H_
+#define TENSORFLOW_C_EXPERIMENTAL_SAVED_MODEL_CORE_REVIVED_TYPES_LAZY_FUNCTION_LIBRARY_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/c/eager/immediate_execution_context.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// LazyFunctionLibrary holds the FunctionDefs of a SavedModel in serialized
+// form, and only registers a function with the runtime when it is first
+// called, along with the functions it calls. Functions that are never called,
+// such as training functions and unused signatures, are never parsed,
+// registered or instantiated.
+class LazyFunctionLibrary {
+ public:
+  // Params:
+  //  library - The function library of the SavedModel. It has no lifetime
+  //            requirements.
+  //  ctx     - A handle to the Tensorflow runtime. This MUST be non-null and
+  //            outlive the LazyFunctionLibrary.
+  LazyFunctionLibrary(const FunctionDefLibrary& library,
+                      ImmediateExecutionContext* ctx);
+
+  // Removes the registered functions from the runtime.
+  ~LazyFunctionLibrary();
+
+  // Registers the function `name` and the functions it transitively calls
+  // with the runtime, unless they are already registered.
+  Status Register(const std::string& name);
+
+ private:
+  LazyFunctionLibrary(const LazyFunctionLibrary&) = delete;
+  LazyFunctionLibrary& operator=(const LazyFunctionLibrary&) = delete;
+
+  ImmediateExecutionContext* const ctx_;
+  mutex mu_;
+  // Functions that are not registered yet, keyed by name. A function is
+  // removed from here once it is registered.
+  absl::flat_hash_map<std::string, std::string> serialized_functions_
+      TF_GUARDED_BY(mu_);
+  absl::flat_hash_set<std::string> registered_functions_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_C_EXPERIMENTAL_SAVED_MODEL_CORE_REVIVED_TYPES_LAZY_FUNCTION_LIBRARY_H_
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/c/eager/immediate_execution_context.h"
 #include "tensorflow/c/eager/immediate_execution_operation.h"
 #include "tensorflow/c/eager/immediate_execution_tensor_handle.h"
+#include "tensorflow/c/experimental/saved_model/core/revived_types/lazy_function_library.h"
 #include "tensorflow/c/experimental/saved_model/core/revived_types/restored_resource.h"
 #include "tensorflow/c/experimental/saved_model/core/revived_types/restored_resource_revival_state.h"
 #include "tensorflow/c/experimental/saved_model/core/revived_types/revived_objects.h"
@@ -280,6 +281,7 @@ Status CreateConcreteFunction(ImmediateExecutionContext* ctx,
                               const TFConcreteFunctionRevivalState& builder,
                               const SavedObjectGraph& obj_graph,
                               const PartiallyRevivedObjects& objects,
+                              LazyFunctionLibrary* library,
                               std::unique_ptr<TFConcreteFunction>* out) {
   const auto& capture_node_ids = builder.saved_concrete_func->bound_inputs();
   std::vector<ImmediateExecutionTensorHandle*> captures;
@@ -294,6 +296,7 @@ Status CreateConcreteFunction(ImmediateExecutionContext* ctx,
   return TFConcreteFunction::Create(/*function_def=*/builder.fdef,
                                     /*captures=*/std::move(captures),
                                     /*metadata=*/{},
+                                    /*library=*/library,
                                     /*ctx=*/ctx,
                                     /*out=*/out);
 }
@@ -302,6 +305,7 @@ Status CreateSignatureDefFunction(
     ImmediateExecutionContext* ctx,
     const TFSignatureDefFunctionRevivalState& builder,
     const SavedObjectGraph& obj_graph, const PartiallyRevivedObjects& objects,
+    LazyFunctionLibrary* library,
     std::unique_ptr<TFSignatureDefFunction>* out) {
   const auto& capture_node_ids = builder.saved_concrete_func->bound_inputs();
   std::vector<ImmediateExecutionTensorHandle*> captures;
@@ -320,6 +324,7 @@ Status CreateSignatureDefFunction(
   return TFSignatureDefFunction::Create(/*function_def=*/builder.fdef,
                                         /*captures=*/std::move(captures),
                                         /*metadata=*/std::move(metadata),
+                                        /*library=*/library,
                                         /*ctx=*/ctx,
                                         /*out=*/out);
 }
@@ -341,8 +346,9 @@ Status InitializeCreateResourceFunctions(ImmediateExecutionContext* ctx,
           "Create Resource functions with captures are currently unsupported.");
     }
     std::unique_ptr<TFConcreteFunction> out;
-    TF_RETURN_IF_ERROR(CreateConcreteFunction(ctx, *create_resource_fn,
-                                              obj_graph, objects, &out));
+    TF_RETURN_IF_ERROR(CreateConcreteFunction(
+        ctx, *create_resource_fn, obj_graph, objects,
+        revived->lazy_function_library.get(), &out));
     revived->concrete_functions.Insert(std::move(out),
                                        create_resource_fn->node_id);
   }
@@ -368,8 +374,9 @@ Status InitializeAllFunctions(ImmediateExecutionContext* ctx,
     }
 
     std::unique_ptr<TFConcreteFunction> out;
-    TF_RETURN_IF_ERROR(
-        CreateConcreteFunction(ctx, func, obj_graph, objects, &out));
+    TF_RETURN_IF_ERROR(CreateConcreteFunction(
+        ctx, func, obj_graph, objects, revived->lazy_function_library.get(),
+        &out));
     revived->concrete_functions.Insert(std::move(out), node_id);
   }
 
@@ -382,8 +389,9 @@ Status InitializeAllFunctions(ImmediateExecutionContext* ctx,
     }
 
     std::unique_ptr<TFSignatureDefFunction> out;
-    TF_RETURN_IF_ERROR(
-        CreateSignatureDefFunction(ctx, func, obj_graph, objects, &out));
+    TF_RETURN_IF_ERROR(CreateSignatureDefFunction(
+        ctx, func, obj_graph, objects, revived->lazy_function_library.get(),
+        &out));
     (*destination_sig_map)[node_id] = std::move(out);
   }
 
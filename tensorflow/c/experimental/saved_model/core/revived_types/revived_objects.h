@@ -22,6 +22,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/c/experimental/saved_model/core/revived_types/asset.h"
 #include "tensorflow/c/experimental/saved_model/core/revived_types/constant.h"
+#include "tensorflow/c/experimental/saved_model/core/revived_types/lazy_function_library.h"
 #include "tensorflow/c/experimental/saved_model/core/revived_types/restored_resource.h"
 #include "tensorflow/c/experimental/saved_model/core/revived_types/tf_concrete_function.h"
 #include "tensorflow/c/experimental/saved_model/core/revived_types/tf_signature_def_function.h"
@@ -77,6 +78,10 @@ class RevivedObjectContainer {
 struct RevivedObjects {
   // Order of declaration is important here: we want the RestoredResources to be
   // freed after TFConcreteFunctions, for example.
+  //
+  // If set, the functions are registered with the runtime on their first call
+  // instead of on creation.
+  std::unique_ptr<LazyFunctionLibrary> lazy_function_library;
   gtl::FlatMap<int, std::unique_ptr<Variable>> variables;
   gtl::FlatMap<int, std::unique_ptr<Asset>> assets;
   gtl::FlatMap<int, std::unique_ptr<Constant>> constants;
@@ -42,9 +42,18 @@ Status TFConcreteFunction::Create(
     std::vector<ImmediateExecutionTensorHandle*> captures,
     FunctionMetadata metadata, ImmediateExecutionContext* ctx,
     std::unique_ptr<TFConcreteFunction>* out) {
+  return Create(function_def, std::move(captures), std::move(metadata),
+                /*library=*/nullptr, ctx, out);
+}
+
+Status TFConcreteFunction::Create(
+    const FunctionDef* function_def,
+    std::vector<ImmediateExecutionTensorHandle*> captures,
+    FunctionMetadata metadata, LazyFunctionLibrary* library,
+    ImmediateExecutionContext* ctx, std::unique_ptr<TFConcreteFunction>* out) {
   std::unique_ptr<FlatTensorFunction> func;
   TF_RETURN_IF_ERROR(FlatTensorFunction::Create(
-      function_def, std::move(captures), ctx, &func));
+      function_def, std::move(captures), library, ctx, &func));
 
   out->reset(new TFConcreteFunction(std::move(func), std::move(metadata)));
   return Status();
@@ -57,6 +57,15 @@ class TFConcreteFunction : public ConcreteFunction {
                        ImmediateExecutionContext* ctx,
                        std::unique_ptr<TFConcreteFunction>* out);
 
+  // Same as above, but the function is registered with `ctx` by `library`
+  // when it is first called. See FlatTensorFunction::Create.
+  static Status Create(const FunctionDef* function_def,
+                       std::vector<ImmediateExecutionTensorHandle*> captures,
+                       FunctionMetadata metadata,
+                       LazyFunctionLibrary* library,
+                       ImmediateExecutionContext* ctx,
+                       std::unique_ptr<TFConcreteFunction>* out);
+
   // This method returns the "Call" Op used to execute the function.
   Status MakeCallOp(absl::Span<AbstractTensorHandle* const> inputs,
                     ImmediateOpPtr* out) const override;
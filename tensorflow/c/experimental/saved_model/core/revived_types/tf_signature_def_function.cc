@@ -43,9 +43,19 @@ Status TFSignatureDefFunction::Create(
     std::vector<ImmediateExecutionTensorHandle*> captures,
     SignatureDefFunctionMetadata metadata, ImmediateExecutionContext* ctx,
     std::unique_ptr<TFSignatureDefFunction>* out) {
+  return Create(function_def, std::move(captures), std::move(metadata),
+                /*library=*/nullptr, ctx, out);
+}
+
+Status TFSignatureDefFunction::Create(
+    const FunctionDef* function_def,
+    std::vector<ImmediateExecutionTensorHandle*> captures,
+    SignatureDefFunctionMetadata metadata, LazyFunctionLibrary* library,
+    ImmediateExecutionContext* ctx,
+    std::unique_ptr<TFSignatureDefFunction>* out) {
   std::unique_ptr<FlatTensorFunction> func;
   TF_RETURN_IF_ERROR(FlatTensorFunction::Create(
-      function_def, std::move(captures), ctx, &func));
+      function_def, std::move(captures), library, ctx, &func));
 
   out->reset(new TFSignatureDefFunction(std::move(func), std::move(metadata)));
   return Status();
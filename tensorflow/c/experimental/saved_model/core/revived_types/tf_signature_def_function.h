@@ -61,6 +61,15 @@ class TFSignatureDefFunction : public SignatureDefFunction {
                        ImmediateExecutionContext* ctx,
                        std::unique_ptr<TFSignatureDefFunction>* out);
 
+  // Same as above, but the function is registered with `ctx` by `library`
+  // when it is first called. See FlatTensorFunction::Create.
+  static Status Create(const FunctionDef* function_def,
+                       std::vector<ImmediateExecutionTensorHandle*> captures,
+                       SignatureDefFunctionMetadata metadata,
+                       LazyFunctionLibrary* library,
+                       ImmediateExecutionContext* ctx,
+                       std::unique_ptr<TFSignatureDefFunction>* out);
+
   // This method creates a "Call" Op used to execute the function.
   Status MakeCallOp(absl::Span<AbstractTensorHandle* const> inputs,
                     ImmediateOpPtr* out) const override;
@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
@@ -31,6 +32,7 @@ limitations under the License.
 #include "tensorflow/c/experimental/saved_model/core/ops/restore_ops.h"
 #include "tensorflow/c/experimental/saved_model/core/revived_types/constant.h"
 #include "tensorflow/c/experimental/saved_model/core/revived_types/flat_tensor_function.h"
+#include "tensorflow/c/experimental/saved_model/core/revived_types/lazy_function_library.h"
 #include "tensorflow/c/experimental/saved_model/core/revived_types/partially_revived_objects.h"
 #include "tensorflow/c/experimental/saved_model/core/revived_types/revived_objects.h"
 #include "tensorflow/c/experimental/saved_model/core/revived_types/tensorhandle_convertible.h"
@@ -260,6 +262,14 @@ Status TFSavedModelAPI::Load(
     const std::string& directory,
     const absl::optional<std::unordered_set<std::string>>& tags,
     ImmediateExecutionContext* context, std::unique_ptr<TFSavedModelAPI>* out) {
+  return Load(directory, tags, LoadOptions(), context, out);
+}
+
+Status TFSavedModelAPI::Load(
+    const std::string& directory,
+    const absl::optional<std::unordered_set<std::string>>& tags,
+    const LoadOptions& options, ImmediateExecutionContext* context,
+    std::unique_ptr<TFSavedModelAPI>* out) {
   // TODO(bmzhao): Add support for loading a TF1 SavedModel.
   if (tags) {
     return errors::Unimplemented(
@@ -284,6 +294,11 @@ Status TFSavedModelAPI::Load(
       bundle.meta_graph_def(), context, directory, &partially_revived_objects));
 
   RevivedObjects revived_objects;
+  if (options.lazy_load_functions) {
+    revived_objects.lazy_function_library =
+        absl::make_unique<LazyFunctionLibrary>(
+            bundle.meta_graph_def().graph_def().library(), context);
+  }
   TF_RETURN_IF_ERROR(partially_revived_objects.Build(
       context, bundle.saved_object_graph(), &revived_objects));
 
@@ -291,16 +306,20 @@ Status TFSavedModelAPI::Load(
   // This is necessary because object graph functions may refer to functions
   // _not_ in the object graph: A while loop, for example, will create two
   // auxiliary `while_cond` and `while_body` functions that are only present in
-  // the graph def function library.
-  for (const FunctionDef& function :
-       bundle.meta_graph_def().graph_def().library().function()) {
-    std::unique_ptr<TFConcreteFunction> concrete_function;
-    TF_RETURN_IF_ERROR(TFConcreteFunction::Create(/*function_def=*/&function,
-                                                  /*captures=*/{},
-                                                  /*metadata=*/{},
-                                                  /*ctx=*/context,
-                                                  /*out=*/&concrete_function));
-    revived_objects.concrete_functions.Insert(std::move(concrete_function));
+  // the graph def function library. The lazy function library registers them
+  // along with their callers instead.
+  if (!options.lazy_load_functions) {
+    for (const FunctionDef& function :
+         bundle.meta_graph_def().graph_def().library().function()) {
+      std::unique_ptr<TFConcreteFunction> concrete_function;
+      TF_RETURN_IF_ERROR(
+          TFConcreteFunction::Create(/*function_def=*/&function,
+                                     /*captures=*/{},
+                                     /*metadata=*/{},
+                                     /*ctx=*/context,
+                                     /*out=*/&concrete_function));
+      revived_objects.concrete_functions.Insert(std::move(concrete_function));
+    }
   }
 
   TF_RETURN_IF_ERROR(
@@ -308,6 +327,11 @@ Status TFSavedModelAPI::Load(
 
   TF_RETURN_IF_ERROR(InitializeAllResources(revived_objects));
 
+  if (options.lazy_load_functions) {
+    // The lazy function library holds its own serialized copy.
+    bundle.meta_graph_def().mutable_graph_def()->clear_library();
+  }
+
   out->reset(new TFSavedModelAPI(directory, std::move(bundle),
                                  std::move(revived_objects)));
   return Status();
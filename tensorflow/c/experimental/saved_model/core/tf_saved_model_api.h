@@ -65,12 +65,27 @@ class TFSavedModelAPI : public SavedModelAPI {
   Status GetSignatureDefFunction(const std::string& signature_def_key,
                                  SignatureDefFunction** function) override;
 
+  struct LoadOptions {
+    // Keeps the function library in serialized form, and only registers a
+    // function with the runtime, which instantiates and optimizes it on its
+    // first execution, when a function that reaches it is first called.
+    // Training functions and unused signatures are then never instantiated.
+    // The bundle returned by GetBundle() has no function library.
+    bool lazy_load_functions = false;
+  };
+
   static Status Load(
       const std::string& directory,
       const absl::optional<std::unordered_set<std::string>>& tags,
       ImmediateExecutionContext* context,
       std::unique_ptr<TFSavedModelAPI>* out);
 
+  static Status Load(
+      const std::string& directory,
+      const absl::optional<std::unordered_set<std::string>>& tags,
+      const LoadOptions& options, ImmediateExecutionContext* context,
+      std::unique_ptr<TFSavedModelAPI>* out);
+
   ~TFSavedModelAPI() override = default;
 
   Status GetVariable(const std::string& variable_path, Variable** variable);
@@ -0,0 +1,73 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/aot_compiled_signatures.h"
+
+#include <vector>
+
+#include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+Status LoadAotCompiledSignatures(
+    const std::string& export_dir,
+    std::unordered_map<std::string, AotCompiledSignature>* signatures) {
+  signatures->clear();
+  Env* env = Env::Default();
+  const std::string aot_dir =
+      io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory,
+                   kSavedModelXlaAotDirectory);
+  if (!env->IsDirectory(aot_dir).ok()) {
+    return Status::OK();
+  }
+
+  std::vector<std::string> children;
+  TF_RETURN_IF_ERROR(env->GetChildren(aot_dir, &children));
+  for (const std::string& child : children) {
+    const std::string def_path =
+        io::JoinPath(aot_dir, child, kSavedModelXlaAotSignatureFilename);
+    if (!env->FileExists(def_path).ok()) {
+      continue;
+    }
+    AotCompiledSignature signature;
+    TF_RETURN_IF_ERROR(ReadTextProto(env, def_path, &signature.def));
+    if (signature.def.signature_def_key().empty()) {
+      return errors::InvalidArgument("Missing signature_def_key in ",
+                                     def_path);
+    }
+    const XlaAotFunctionRegistry::Factory* factory =
+        XlaAotFunctionRegistry::Lookup(signature.def.cpp_class());
+    if (factory == nullptr) {
+      VLOG(1) << "Skipping AOT compiled signature '"
+              << signature.def.signature_def_key() << "': class '"
+              << signature.def.cpp_class() << "' is not linked in.";
+      continue;
+    }
+    signature.factory = *factory;
+    const std::string key = signature.def.signature_def_key();
+    if (!signatures->emplace(key, std::move(signature)).second) {
+      return errors::InvalidArgument(
+          "Duplicate AOT compiled signature for SignatureDef key '", key,
+          "' in ", aot_dir);
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
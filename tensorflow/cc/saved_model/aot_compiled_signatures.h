@@ -0,0 +1,49 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CC_SAVED_MODEL_AOT_COMPILED_SIGNATURES_H_
+#define TENSORFLOW_CC_SAVED_MODEL_AOT_COMPILED_SIGNATURES_H_
+
+#include <string>
+#include <unordered_map>
+
+#include "tensorflow/compiler/tf2xla/tf2xla.pb.h"
+#include "tensorflow/compiler/tf2xla/xla_aot_function_registry.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+
+/// A SignatureDef that was compiled ahead-of-time by `saved_model_cli
+/// aot_compile_cpu --store_in_saved_model` and whose generated class is linked
+/// into the current binary.
+struct AotCompiledSignature {
+  tf2xla::AotCompiledSignature def;
+  /// Creates a new instance of the generated class. Each instance owns its
+  /// buffers, so instances may run concurrently.
+  XlaAotFunctionRegistry::Factory factory;
+};
+
+/// Reads the ahead-of-time compiled signatures stored under
+/// `export_dir`/assets.extra/xla_aot and returns those whose generated class
+/// has been registered with REGISTER_XLA_AOT_FUNCTION, keyed by SignatureDef
+/// key. Signatures whose class is not linked in are skipped. A SavedModel
+/// without AOT artifacts yields an empty map.
+Status LoadAotCompiledSignatures(
+    const std::string& export_dir,
+    std::unordered_map<std::string, AotCompiledSignature>* signatures);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CC_SAVED_MODEL_AOT_COMPILED_SIGNATURES_H_
@@ -0,0 +1,68 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/aot_compiled_signatures.h"
+
+#include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/compiler/tf2xla/xla_aot_function_registry.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+void WriteSignature(const string& export_dir, const string& key,
+                    const string& cpp_class) {
+  const string dir = io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory,
+                                  kSavedModelXlaAotDirectory, key);
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(dir));
+  tf2xla::AotCompiledSignature def;
+  def.set_signature_def_key(key);
+  def.set_cpp_class(cpp_class);
+  def.mutable_config()->add_fetch()->set_name("out");
+  TF_ASSERT_OK(WriteTextProto(
+      Env::Default(), io::JoinPath(dir, kSavedModelXlaAotSignatureFilename),
+      def));
+}
+
+TEST(AotCompiledSignaturesTest, NoArtifacts) {
+  const string export_dir = io::JoinPath(testing::TmpDir(), "no_aot");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(export_dir));
+  std::unordered_map<string, AotCompiledSignature> signatures;
+  TF_ASSERT_OK(LoadAotCompiledSignatures(export_dir, &signatures));
+  EXPECT_TRUE(signatures.empty());
+}
+
+TEST(AotCompiledSignaturesTest, LoadsOnlyRegisteredClasses) {
+  XlaAotFunctionRegistry::Register("test::Registered", [] {
+    return std::unique_ptr<XlaCompiledCpuFunction>();
+  });
+  const string export_dir = io::JoinPath(testing::TmpDir(), "with_aot");
+  WriteSignature(export_dir, "serving_default", "test::Registered");
+  WriteSignature(export_dir, "other", "test::NotLinkedIn");
+
+  std::unordered_map<string, AotCompiledSignature> signatures;
+  TF_ASSERT_OK(LoadAotCompiledSignatures(export_dir, &signatures));
+  ASSERT_EQ(signatures.size(), 1);
+  const AotCompiledSignature& signature = signatures.at("serving_default");
+  EXPECT_EQ(signature.def.cpp_class(), "test::Registered");
+  EXPECT_EQ(signature.def.config().fetch(0).name(), "out");
+  ASSERT_TRUE(signature.factory);
+}
+
+}  // namespace
+}  // namespace tensorflow
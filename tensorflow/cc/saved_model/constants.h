@@ -24,6 +24,18 @@ constexpr char kSavedModelAssetsDirectory[] = "assets";
 // SavedModel assets.extra directory.
 constexpr char kSavedModelAssetsExtraDirectory[] = "assets.extra";
 
+// Subdirectory of assets.extra holding ahead-of-time compiled signatures, one
+// directory per SignatureDef key.
+constexpr char kSavedModelXlaAotDirectory[] = "xla_aot";
+
+// File describing an ahead-of-time compiled signature.
+constexpr char kSavedModelXlaAotSignatureFilename[] =
+    "aot_compiled_signature.pbtxt";
+
+// File in assets.extra holding the requests replayed by RunSavedModelWarmup.
+constexpr char kSavedModelWarmupRequestsFilename[] =
+    "tf_saved_model_warmup_requests";
+
 // SavedModel assets key for graph collection-def.
 constexpr char kSavedModelAssetsKey[] = "saved_model_assets";
 
@@ -284,6 +284,15 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
       session_options, bundle->meta_graph_def, &bundle->session));
   TF_RETURN_IF_ERROR(RestoreSession(run_options, bundle->meta_graph_def,
                                     export_dir, &bundle->session));
+  // AOT artifacts are an optional fast path; the session remains usable for
+  // every signature if they cannot be read.
+  const Status aot_status = LoadAotCompiledSignatures(
+      export_dir, &bundle->aot_compiled_signatures);
+  if (!aot_status.ok()) {
+    LOG(WARNING) << "Ignoring ahead-of-time compiled signatures in "
+                 << export_dir << ": " << aot_status;
+    bundle->aot_compiled_signatures.clear();
+  }
   return Status::OK();
 }
 
@@ -19,8 +19,10 @@ limitations under the License.
 #define TENSORFLOW_CC_SAVED_MODEL_LOADER_H_
 
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 
+#include "tensorflow/cc/saved_model/aot_compiled_signatures.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/protobuf/graph_debug_info.pb.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
@@ -65,6 +67,9 @@ struct SavedModelBundle : public SavedModelBundleInterface {
   std::unique_ptr<Session> session;
   MetaGraphDef meta_graph_def;
   std::unique_ptr<GraphDebugInfo> debug_info;
+  /// Ahead-of-time compiled signatures stored with the SavedModel whose
+  /// generated class is linked into this binary, keyed by SignatureDef key.
+  std::unordered_map<string, AotCompiledSignature> aot_compiled_signatures;
 };
 
 // A version of SavedModelBundle that avoids storing a potentially large
@@ -117,6 +122,10 @@ Status LoadMetagraphIntoSession(const SessionOptions& session_options,
 /// the set of tags used at SavedModel build time. Stores a SavedModel bundle in
 /// *bundle with a session and the requested MetaGraphDef, if found.
 ///
+/// Setting `run_options.experimental().memmap_restored_tensors()` restores
+/// large variables as read-only memory mappings of the checkpoint instead of
+/// copies, which lets several servers loading the same model share the pages.
+///
 /// NOTE: Prefer the overload that takes a SavedModelBundleLite* in new code.
 Status LoadSavedModel(const SessionOptions& session_options,
                       const RunOptions& run_options, const string& export_dir,
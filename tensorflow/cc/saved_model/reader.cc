@@ -15,9 +15,12 @@ limitations under the License.
 
 #include "tensorflow/cc/saved_model/reader.h"
 
+#include <limits>
 #include <unordered_set>
+#include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/cc/saved_model/metrics.h"
 #include "tensorflow/cc/saved_model/util.h"
@@ -30,12 +33,145 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/protobuf/saved_model.pb.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap.h"
 
 namespace tensorflow {
 namespace {
 
+using ::tensorflow::protobuf::internal::WireFormatLite;
+
+// Field numbers of the SavedModel messages that are scanned without being
+// parsed.
+constexpr int kSavedModelMetaGraphsField = 2;
+constexpr int kMetaGraphDefMetaInfoDefField = 1;
+constexpr int kMetaGraphDefObjectGraphDefField = 7;
+constexpr int kMetaInfoDefTagsField = 4;
+
+// Calls `fn(field_number, value)` for each length-delimited field of the
+// serialized message `data`, and skips the other fields. Returns false if
+// `data` is malformed.
+template <typename Fn>
+bool ForEachLengthDelimitedField(absl::string_view data, Fn fn) {
+  if (data.size() > static_cast<size_t>(std::numeric_limits<int>::max())) {
+    return false;
+  }
+  protobuf::io::CodedInputStream input(
+      reinterpret_cast<const uint8*>(data.data()), data.size());
+  while (true) {
+    const uint32 tag = input.ReadTag();
+    if (tag == 0) return input.CurrentPosition() == data.size();
+    if (WireFormatLite::GetTagWireType(tag) !=
+        WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+      if (!WireFormatLite::SkipField(&input, tag)) return false;
+      continue;
+    }
+    uint32 length;
+    if (!input.ReadVarint32(&length)) return false;
+    const size_t position = input.CurrentPosition();
+    if (length > data.size() - position) return false;
+    if (!fn(WireFormatLite::GetTagFieldNumber(tag),
+            data.substr(position, length))) {
+      return false;
+    }
+    if (!input.Skip(length)) return false;
+  }
+}
+
+// A MetaGraphDef of a serialized SavedModel, with the fields needed to pick it
+// and to record the metrics of the read.
+struct SerializedMetaGraphDef {
+  absl::string_view data;
+  std::unordered_set<string> tags;
+  bool has_object_graph_def = false;
+};
+
+// Splits the serialized SavedModel `data` into its MetaGraphDefs, and reads
+// their tags without parsing them. Returns false if `data` is malformed.
+bool ScanSavedModel(absl::string_view data,
+                    std::vector<SerializedMetaGraphDef>* meta_graphs) {
+  auto scan_meta_info_def = [](absl::string_view data,
+                               SerializedMetaGraphDef* meta_graph) {
+    return ForEachLengthDelimitedField(
+        data, [&](int field, absl::string_view value) {
+          if (field == kMetaInfoDefTagsField) meta_graph->tags.emplace(value);
+          return true;
+        });
+  };
+  auto scan_meta_graph_def = [&](absl::string_view data,
+                                 SerializedMetaGraphDef* meta_graph) {
+    meta_graph->data = data;
+    return ForEachLengthDelimitedField(
+        data, [&](int field, absl::string_view value) {
+          if (field == kMetaGraphDefObjectGraphDefField) {
+            meta_graph->has_object_graph_def = true;
+          } else if (field == kMetaGraphDefMetaInfoDefField) {
+            return scan_meta_info_def(value, meta_graph);
+          }
+          return true;
+        });
+  };
+  return ForEachLengthDelimitedField(
+      data, [&](int field, absl::string_view value) {
+        if (field != kSavedModelMetaGraphsField) return true;
+        meta_graphs->emplace_back();
+        return scan_meta_graph_def(value, &meta_graphs->back());
+      });
+}
+
+Status NoMatchingMetaGraphDefError(const std::unordered_set<string>& tags) {
+  return Status(
+      error::Code::NOT_FOUND,
+      strings::StrCat(
+          "Could not find meta graph def matching supplied tags: { ",
+          absl::StrJoin(tags, " "),
+          " }. To inspect available tag-sets in the SavedModel, please "
+          "use the SavedModel CLI: `saved_model_cli`"));
+}
+
+// Reads the MetaGraphDef that matches `tags` from the saved_model.pb at
+// `path`. The file is memory-mapped and only the matching MetaGraphDef is
+// parsed, which saves a copy of the file and the parse of the MetaGraphDefs
+// of the other tag-sets. Sets `*read` to false, and returns OK, if the file
+// cannot be mapped or scanned, in which case the caller should parse the whole
+// SavedModel instead.
+Status ReadMatchingMetaGraphDefFromPb(const string& path,
+                                      const std::unordered_set<string>& tags,
+                                      MetaGraphDef* meta_graph_def,
+                                      bool* read) {
+  *read = false;
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  if (!Env::Default()->NewReadOnlyMemoryRegionFromFile(path, &region).ok()) {
+    return Status::OK();
+  }
+  const absl::string_view data(static_cast<const char*>(region->data()),
+                               region->length());
+  std::vector<SerializedMetaGraphDef> meta_graphs;
+  if (!ScanSavedModel(data, &meta_graphs)) return Status::OK();
+
+  LOG(INFO) << "Reading meta graph with tags { " << absl::StrJoin(tags, " ")
+            << " }";
+  for (const SerializedMetaGraphDef& meta_graph : meta_graphs) {
+    if (meta_graph.tags != tags) continue;
+    if (!meta_graph_def->ParseFromArray(meta_graph.data.data(),
+                                        meta_graph.data.size())) {
+      return Status::OK();
+    }
+    *read = true;
+    const bool is_v2 =
+        meta_graphs.size() == 1 && meta_graph.has_object_graph_def;
+    metrics::SavedModelRead(is_v2 ? "2" : "1").IncrementBy(1);
+    // Correct the endiness of Tensor content on big-endian system
+    if (!port::kLittleEndian) {
+      TF_RETURN_IF_ERROR(ByteSwapTensorContent(meta_graph_def));
+    }
+    return Status::OK();
+  }
+  *read = true;
+  return NoMatchingMetaGraphDefError(tags);
+}
+
 // Reads the SavedModel proto from saved_model.pb in `export_dir`.
 // Returns a failure status when the SavedModel file does not exist.
 Status ReadSavedModel(absl::string_view export_dir,
@@ -96,19 +232,22 @@ Status FindMetaGraphDef(const std::unordered_set<string>& tags,
       return Status::OK();
     }
   }
-  return Status(
-      error::Code::NOT_FOUND,
-      strings::StrCat(
-          "Could not find meta graph def matching supplied tags: { ",
-          absl::StrJoin(tags, " "),
-          " }. To inspect available tag-sets in the SavedModel, please "
-          "use the SavedModel CLI: `saved_model_cli`"));
+  return NoMatchingMetaGraphDefError(tags);
 }
 }  // namespace
 
 Status ReadMetaGraphDefFromSavedModel(const string& export_dir,
                                       const std::unordered_set<string>& tags,
                                       MetaGraphDef* const meta_graph_def) {
+  const string saved_model_pb_path =
+      io::JoinPath(export_dir, kSavedModelFilenamePb);
+  if (Env::Default()->FileExists(saved_model_pb_path).ok()) {
+    LOG(INFO) << "Reading SavedModel from: " << export_dir;
+    bool read;
+    TF_RETURN_IF_ERROR(ReadMatchingMetaGraphDefFromPb(
+        saved_model_pb_path, tags, meta_graph_def, &read));
+    if (read) return Status::OK();
+  }
   SavedModel saved_model_proto;
   TF_RETURN_IF_ERROR(ReadSavedModel(export_dir, &saved_model_proto));
   TF_RETURN_IF_ERROR(
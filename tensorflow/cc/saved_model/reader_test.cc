@@ -23,8 +23,10 @@ limitations under the License.
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/resource_loader.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/saved_model.pb.h"
 
 namespace tensorflow {
 namespace {
@@ -89,6 +91,47 @@ TEST_F(ReaderTest, NoTagMatchMultiple) {
       << st.error_message();
 }
 
+TEST_F(ReaderTest, MultipleMetaGraphs) {
+  SavedModel saved_model;
+  saved_model.set_saved_model_schema_version(1);
+  for (const string& tag : {"train", "serve"}) {
+    MetaGraphDef* meta_graph = saved_model.add_meta_graphs();
+    meta_graph->mutable_meta_info_def()->add_tags(tag);
+    meta_graph->mutable_meta_info_def()->set_tensorflow_version(tag);
+    meta_graph->mutable_graph_def()->add_node()->set_name(tag);
+  }
+  const string export_dir = io::JoinPath(testing::TmpDir(), "multiple");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(export_dir));
+  TF_ASSERT_OK(WriteBinaryProto(
+      Env::Default(), io::JoinPath(export_dir, kSavedModelFilenamePb),
+      saved_model));
+
+  for (const string& tag : {"train", "serve"}) {
+    MetaGraphDef meta_graph_def;
+    TF_ASSERT_OK(
+        ReadMetaGraphDefFromSavedModel(export_dir, {tag}, &meta_graph_def));
+    EXPECT_EQ(meta_graph_def.meta_info_def().tensorflow_version(), tag);
+    ASSERT_EQ(meta_graph_def.graph_def().node_size(), 1);
+    EXPECT_EQ(meta_graph_def.graph_def().node(0).name(), tag);
+  }
+  MetaGraphDef meta_graph_def;
+  EXPECT_FALSE(ReadMetaGraphDefFromSavedModel(export_dir, {"train", "serve"},
+                                              &meta_graph_def)
+                   .ok());
+}
+
+TEST_F(ReaderTest, MalformedPb) {
+  const string export_dir = io::JoinPath(testing::TmpDir(), "malformed");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(export_dir));
+  TF_ASSERT_OK(WriteStringToFile(
+      Env::Default(), io::JoinPath(export_dir, kSavedModelFilenamePb),
+      "\x12\xff\xff"));
+  MetaGraphDef meta_graph_def;
+  EXPECT_FALSE(ReadMetaGraphDefFromSavedModel(export_dir, {kSavedModelTagServe},
+                                              &meta_graph_def)
+                   .ok());
+}
+
 TEST_F(ReaderTest, PbtxtFormat) {
   MetaGraphDef meta_graph_def;
 
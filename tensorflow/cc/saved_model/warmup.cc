@@ -0,0 +1,221 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/warmup.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
+
+namespace tensorflow {
+namespace {
+
+string GetShapesKey(const std::vector<std::pair<string, Tensor>>& inputs) {
+  string key;
+  for (const auto& input : inputs) {
+    strings::StrAppend(&key, input.first, ":",
+                       input.second.shape().DebugString(), ";");
+  }
+  return key;
+}
+
+// Runs `requests`, which are all for the same signature, one after another.
+Status RunSignatureWarmup(
+    const SavedModelWarmupOptions& options, const RunOptions& run_options,
+    const std::vector<const SavedModelWarmupRequest*>& requests,
+    const SavedModelBundleInterface& bundle) {
+  const string& signature_name = requests.front()->signature_name();
+  const auto signature = bundle.GetSignatures().find(signature_name);
+  if (signature == bundle.GetSignatures().end()) {
+    return errors::InvalidArgument("Warmup request for unknown signature: ",
+                                   signature_name);
+  }
+
+  std::unordered_set<string> replayed_shapes;
+  for (const SavedModelWarmupRequest* request : requests) {
+    std::vector<std::pair<string, Tensor>> inputs;
+    std::vector<string> output_tensor_names;
+    TF_RETURN_IF_ERROR(GetSavedModelWarmupFeedsAndFetches(
+        *request, signature->second, &inputs, &output_tensor_names));
+    if (options.skip_duplicate_shapes &&
+        !replayed_shapes.insert(GetShapesKey(inputs)).second) {
+      continue;
+    }
+    // Unlike the callables used to run the init op, Session::Run() keeps the
+    // executors it creates for the real requests with the same feeds and
+    // fetches.
+    std::vector<Tensor> outputs;
+    RunMetadata run_metadata;
+    TF_RETURN_IF_ERROR(bundle.GetSession()->Run(run_options, inputs,
+                                                output_tensor_names, {},
+                                                &outputs, &run_metadata));
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status GetSavedModelWarmupFeedsAndFetches(
+    const SavedModelWarmupRequest& request, const SignatureDef& signature,
+    std::vector<std::pair<string, Tensor>>* inputs,
+    std::vector<string>* output_tensor_names) {
+  // Sorted by alias, so that equal requests produce equal feeds.
+  const std::map<string, TensorProto> sorted_inputs(request.inputs().begin(),
+                                                    request.inputs().end());
+  for (const auto& input : sorted_inputs) {
+    const auto it = signature.inputs().find(input.first);
+    if (it == signature.inputs().end()) {
+      return errors::InvalidArgument("Warmup request for signature ",
+                                     request.signature_name(),
+                                     " has unknown input: ", input.first);
+    }
+    Tensor tensor;
+    if (!tensor.FromProto(input.second)) {
+      return errors::InvalidArgument("Warmup request for signature ",
+                                     request.signature_name(),
+                                     " has an invalid tensor for input: ",
+                                     input.first);
+    }
+    inputs->emplace_back(it->second.name(), std::move(tensor));
+  }
+
+  if (request.output_filter().empty()) {
+    const std::map<string, TensorInfo> sorted_outputs(
+        signature.outputs().begin(), signature.outputs().end());
+    for (const auto& output : sorted_outputs) {
+      output_tensor_names->push_back(output.second.name());
+    }
+    return Status::OK();
+  }
+  for (const string& alias : request.output_filter()) {
+    const auto it = signature.outputs().find(alias);
+    if (it == signature.outputs().end()) {
+      return errors::InvalidArgument("Warmup request for signature ",
+                                     request.signature_name(),
+                                     " has unknown output: ", alias);
+    }
+    output_tensor_names->push_back(it->second.name());
+  }
+  return Status::OK();
+}
+
+Status ReadSavedModelWarmupRequestsFromFile(
+    const string& path, std::vector<SavedModelWarmupRequest>* requests) {
+  requests->clear();
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewRandomAccessFile(path, &file));
+  io::SequentialRecordReader reader(file.get());
+  tstring record;
+  while (true) {
+    const Status status = reader.ReadRecord(&record);
+    if (errors::IsOutOfRange(status)) break;
+    TF_RETURN_IF_ERROR(status);
+    requests->emplace_back();
+    if (!requests->back().ParseFromArray(record.data(), record.size())) {
+      return errors::DataLoss("Unable to parse warmup request ",
+                              requests->size(), " in ", path);
+    }
+  }
+  return Status::OK();
+}
+
+Status ReadSavedModelWarmupRequests(
+    const string& export_dir, std::vector<SavedModelWarmupRequest>* requests) {
+  requests->clear();
+  const string path =
+      io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory,
+                   kSavedModelWarmupRequestsFilename);
+  if (!Env::Default()->FileExists(path).ok()) {
+    return Status::OK();
+  }
+  return ReadSavedModelWarmupRequestsFromFile(path, requests);
+}
+
+Status RunSavedModelWarmup(const SavedModelWarmupOptions& options,
+                           const RunOptions& run_options,
+                           const std::vector<SavedModelWarmupRequest>& requests,
+                           const SavedModelBundleInterface& bundle) {
+  if (requests.empty()) return Status::OK();
+  const uint64 start_microseconds = EnvTime::NowMicros();
+
+  // The requests of each signature, in the order they appear in `requests`.
+  std::vector<std::vector<const SavedModelWarmupRequest*>> signatures;
+  std::unordered_map<string, int> signature_indices;
+  for (const SavedModelWarmupRequest& request : requests) {
+    const auto it = signature_indices.emplace(
+        request.signature_name(), static_cast<int>(signatures.size()));
+    if (it.second) signatures.emplace_back();
+    signatures[it.first->second].push_back(&request);
+  }
+
+  mutex mu;
+  Status status;
+  auto run_signature =
+      [&](const std::vector<const SavedModelWarmupRequest*>&
+              signature_requests) {
+        const Status signature_status = RunSignatureWarmup(
+            options, run_options, signature_requests, bundle);
+        mutex_lock l(mu);
+        status.Update(signature_status);
+      };
+  const int num_threads =
+      std::min<int>(options.num_threads, signatures.size());
+  if (num_threads <= 1) {
+    for (const auto& signature_requests : signatures) {
+      run_signature(signature_requests);
+    }
+  } else {
+    // The destructor of the pool waits for all the signatures to finish.
+    thread::ThreadPool pool(Env::Default(), "saved_model_warmup", num_threads);
+    for (const auto& signature_requests : signatures) {
+      pool.Schedule([&run_signature, &signature_requests]() {
+        run_signature(signature_requests);
+      });
+    }
+  }
+
+  LOG(INFO) << "Ran " << requests.size() << " SavedModel warmup requests for "
+            << signatures.size() << " signatures on "
+            << std::max(num_threads, 1) << " threads. Status: " << status
+            << ". Took " << EnvTime::NowMicros() - start_microseconds
+            << " microseconds.";
+  return status;
+}
+
+Status RunSavedModelWarmup(const SavedModelWarmupOptions& options,
+                           const RunOptions& run_options,
+                           const string& export_dir,
+                           const SavedModelBundleInterface& bundle) {
+  std::vector<SavedModelWarmupRequest> requests;
+  TF_RETURN_IF_ERROR(ReadSavedModelWarmupRequests(export_dir, &requests));
+  return RunSavedModelWarmup(options, run_options, requests, bundle);
+}
+
+}  // namespace tensorflow
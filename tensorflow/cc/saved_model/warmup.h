@@ -0,0 +1,87 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/// Replays warmup requests against a loaded SavedModel.
+
+#ifndef TENSORFLOW_CC_SAVED_MODEL_WARMUP_H_
+#define TENSORFLOW_CC_SAVED_MODEL_WARMUP_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/cc/saved_model/warmup.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
+
+namespace tensorflow {
+
+struct SavedModelWarmupOptions {
+  /// Number of threads replaying the requests. The requests of one signature
+  /// run one after another, so that concurrent requests do not optimize and
+  /// instantiate the same graph twice. Different signatures run in parallel.
+  int num_threads = 1;
+
+  /// Skips a request if a previous request to the same signature fed inputs
+  /// of the same shapes. String inputs, such as serialized tf.Examples, may
+  /// produce different shapes inside the graph for the same input shape, so
+  /// this is off by default.
+  bool skip_duplicate_shapes = false;
+};
+
+/// Reads the warmup requests stored in
+/// `export_dir`/assets.extra/tf_saved_model_warmup_requests. A SavedModel
+/// without warmup requests yields no requests.
+Status ReadSavedModelWarmupRequests(
+    const std::string& export_dir,
+    std::vector<SavedModelWarmupRequest>* requests);
+
+/// Reads the requests stored in the TFRecord file `path`, one serialized
+/// SavedModelWarmupRequest per record.
+Status ReadSavedModelWarmupRequestsFromFile(
+    const std::string& path, std::vector<SavedModelWarmupRequest>* requests);
+
+/// Converts `request` to the feeds and fetches of a Session::Run() call on the
+/// signature `signature` it refers to.
+Status GetSavedModelWarmupFeedsAndFetches(
+    const SavedModelWarmupRequest& request, const SignatureDef& signature,
+    std::vector<std::pair<std::string, Tensor>>* inputs,
+    std::vector<std::string>* output_tensor_names);
+
+/// Runs each of `requests` once on the session of `bundle` and discards the
+/// outputs. This runs grappler, creates the executors and kernels, and JIT
+/// compiles the XLA clusters for every signature and every shape variant in
+/// the requests, so that the real requests that follow find them cached.
+///
+/// The requests of a signature stop at its first failure. The first error is
+/// returned once all signatures are done.
+Status RunSavedModelWarmup(const SavedModelWarmupOptions& options,
+                           const RunOptions& run_options,
+                           const std::vector<SavedModelWarmupRequest>& requests,
+                           const SavedModelBundleInterface& bundle);
+
+/// Reads the warmup requests of the SavedModel in `export_dir` and runs them
+/// on `bundle`, which should have been loaded from `export_dir`.
+Status RunSavedModelWarmup(const SavedModelWarmupOptions& options,
+                           const RunOptions& run_options,
+                           const std::string& export_dir,
+                           const SavedModelBundleInterface& bundle);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CC_SAVED_MODEL_WARMUP_H_
@@ -0,0 +1,132 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/warmup.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/cc/saved_model/signature_constants.h"
+#include "tensorflow/cc/saved_model/tag_constants.h"
+#include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kTestDataSharded[] =
+    "cc/saved_model/testdata/half_plus_two/00000123";
+
+class SavedModelWarmupTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const string export_dir =
+        io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+    TF_ASSERT_OK(LoadSavedModel(SessionOptions(), RunOptions(), export_dir,
+                                {kSavedModelTagServe}, &bundle_));
+  }
+
+  // Returns a request that feeds `batch_size` tf.Examples to `signature_name`.
+  SavedModelWarmupRequest MakeRequest(const string& signature_name,
+                                      int batch_size) {
+    std::vector<tstring> serialized_examples;
+    for (int i = 0; i < batch_size; ++i) {
+      Example example;
+      (*example.mutable_features()->mutable_feature())["x"]
+          .mutable_float_list()
+          ->add_value(i);
+      serialized_examples.push_back(example.SerializeAsString());
+    }
+    SavedModelWarmupRequest request;
+    request.set_signature_name(signature_name);
+    test::AsTensor<tstring>(serialized_examples, TensorShape({batch_size}))
+        .AsProtoField(&(*request.mutable_inputs())[kRegressInputs]);
+    return request;
+  }
+
+  // Writes `requests` to the assets.extra directory of a new export dir.
+  string WriteRequests(const std::vector<SavedModelWarmupRequest>& requests) {
+    const string export_dir = io::JoinPath(testing::TmpDir(), "warmup_test");
+    const string assets_extra_dir =
+        io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory);
+    TF_CHECK_OK(Env::Default()->RecursivelyCreateDir(assets_extra_dir));
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(Env::Default()->NewWritableFile(
+        io::JoinPath(assets_extra_dir, kSavedModelWarmupRequestsFilename),
+        &file));
+    io::RecordWriter writer(file.get());
+    for (const SavedModelWarmupRequest& request : requests) {
+      TF_CHECK_OK(writer.WriteRecord(request.SerializeAsString()));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+    return export_dir;
+  }
+
+  SavedModelBundle bundle_;
+};
+
+TEST_F(SavedModelWarmupTest, RunsRequestsOfSeveralSignatures) {
+  const string export_dir = WriteRequests(
+      {MakeRequest("regress_x_to_y", 1), MakeRequest("classify_x_to_y", 2),
+       MakeRequest("regress_x_to_y", 4), MakeRequest("regress_x_to_y", 4)});
+  std::vector<SavedModelWarmupRequest> requests;
+  TF_ASSERT_OK(ReadSavedModelWarmupRequests(export_dir, &requests));
+  EXPECT_EQ(requests.size(), 4);
+
+  SavedModelWarmupOptions options;
+  options.num_threads = 2;
+  options.skip_duplicate_shapes = true;
+  TF_EXPECT_OK(
+      RunSavedModelWarmup(options, RunOptions(), export_dir, bundle_));
+}
+
+TEST_F(SavedModelWarmupTest, NoRequests) {
+  std::vector<SavedModelWarmupRequest> requests;
+  TF_ASSERT_OK(ReadSavedModelWarmupRequests(
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded),
+      &requests));
+  EXPECT_TRUE(requests.empty());
+  TF_EXPECT_OK(RunSavedModelWarmup(SavedModelWarmupOptions(), RunOptions(),
+                                   requests, bundle_));
+}
+
+TEST_F(SavedModelWarmupTest, UnknownSignature) {
+  const Status status =
+      RunSavedModelWarmup(SavedModelWarmupOptions(), RunOptions(),
+                          {MakeRequest("no_such_signature", 1)}, bundle_);
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+}
+
+TEST_F(SavedModelWarmupTest, UnknownInput) {
+  SavedModelWarmupRequest request = MakeRequest("regress_x_to_y", 1);
+  (*request.mutable_inputs())["no_such_input"] =
+      request.inputs().at(kRegressInputs);
+  const Status status = RunSavedModelWarmup(SavedModelWarmupOptions(),
+                                            RunOptions(), {request}, bundle_);
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+}
+
+}  // namespace
+}  // namespace tensorflow
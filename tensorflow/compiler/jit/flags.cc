@@ -203,6 +203,7 @@ void AllocateAndParseFlags() {
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
   ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_shape_buckets = "";
 
   jitter_flags = new IntroduceFloatingPointJitterPassFlags;
   jitter_flags->jitter_amount = 1e-5;
@@ -263,6 +264,13 @@ void AllocateAndParseFlags() {
             "When lazy compilation is enabled, asynchronous compilation starts "
             "the cluster compilation in the background, and the fallback path "
             "is executed until the compilation has finished."),
+       Flag("tf_xla_shape_buckets", &ops_flags->tf_xla_shape_buckets,
+            "Pads the leading dimension of the inputs of auto-clustered "
+            "computations up to a bucket size, and slices it off the outputs, "
+            "so that fewer distinct shapes are compiled. Either \"pow2\" or a "
+            "comma-separated increasing list of bucket sizes. Zero-padded rows "
+            "must not affect the other rows of the outputs, so this is only "
+            "valid for clusters that compute each row independently."),
 
        Flag("tf_introduce_floating_point_jitter_to_tensors",
             setter_for_jitter_tensor_names, "",
@@ -119,6 +119,12 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fallback path is taken while compilation happens.
   bool tf_xla_async_compilation;
+  // Rounds the leading dimension of the inputs of auto-clustered computations
+  // up to a bucket size before compiling, which bounds the number of
+  // recompilations for variable batch sizes. Either empty (disabled), "pow2",
+  // or a comma-separated increasing list of bucket sizes. Only valid for
+  // clusters whose rows are computed independently of each other.
+  std::string tf_xla_shape_buckets;
 };
 
 // Flags for the build_xla_ops pass.
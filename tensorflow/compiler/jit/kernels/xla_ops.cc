@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/defs.h"
 #include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
 #include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/shape_bucketing.h"
 #include "tensorflow/compiler/jit/xla_activity_listener.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/jit/xla_platform_info.h"
@@ -74,6 +75,12 @@ auto* xla_launch_counter = monitoring::Counter<1>::New(
     "/tensorflow/core/xla_launch_counter",
     "The number of times a XlaLaunch is called.", "device");
 
+auto* xla_compile_fallback_counter = monitoring::Counter<2>::New(
+    "/tensorflow/core/xla_compile_fallback_counter",
+    "The number of times a cluster ran through the TF function fallback "
+    "instead of an XLA executable.",
+    "device", "reason");
+
 // A closure describing how to run a compiled version of a TensorFlow function.
 //
 // It may seem unusual to stick the resource variable snapshots in this class.
@@ -86,12 +93,14 @@ class XlaExecutableClosure {
   explicit XlaExecutableClosure(
       xla::LocalClient* client, xla::LocalExecutable* executable,
       const XlaCompiler::CompilationResult* compilation_result,
-      ResourceVarsSnapshot resource_var_snapshots, int num_constant_args)
+      ResourceVarsSnapshot resource_var_snapshots, int num_constant_args,
+      BucketedBatch bucketed_batch)
       : client_(client),
         executable_(executable),
         compilation_result_(compilation_result),
         resource_var_snapshots_(std::move(resource_var_snapshots)),
-        num_constant_args_(num_constant_args) {}
+        num_constant_args_(num_constant_args),
+        bucketed_batch_(bucketed_batch) {}
 
   XlaExecutableClosure(XlaExecutableClosure&&) = default;
   XlaExecutableClosure& operator=(XlaExecutableClosure&&) = default;
@@ -105,6 +114,7 @@ class XlaExecutableClosure {
     return resource_var_snapshots_;
   }
   int num_constant_args() const { return num_constant_args_; }
+  const BucketedBatch& bucketed_batch() const { return bucketed_batch_; }
 
  private:
   xla::LocalClient* client_;
@@ -112,6 +122,9 @@ class XlaExecutableClosure {
   const XlaCompiler::CompilationResult* compilation_result_;
   ResourceVarsSnapshot resource_var_snapshots_;
   int num_constant_args_;
+  // The leading dimension the inputs are padded to, if the executable was
+  // compiled for bucketed shapes.
+  BucketedBatch bucketed_batch_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(XlaExecutableClosure);
 };
@@ -228,7 +241,8 @@ static Status CompileToLocalExecutable(
     XlaCompilationCache::CompileMode compile_mode,
     bool may_alias_resource_update, xla::LocalClient** client,
     const XlaCompiler::CompilationResult** compilation_result,
-    xla::LocalExecutable** executable) {
+    xla::LocalExecutable** executable,
+    BucketedBatch* bucketed_batch = nullptr) {
   // We store information about the JIT-compiled XLA computation
   // in the ResourceMgr.
   ResourceMgr* rm = ctx->resource_manager();
@@ -267,6 +281,10 @@ static Status CompileToLocalExecutable(
           constants, inputs, variable_infos,
           static_cast<Device*>(ctx->device()));
   TF_RETURN_IF_ERROR(args.status());
+  if (bucketed_batch != nullptr && !platform_info.is_on_xla_device()) {
+    *bucketed_batch =
+        BucketCompilerArguments(ShapeBucketingPolicy::FromFlags(), &*args);
+  }
   return cache->Compile(options, function, *args, compile_options, compile_mode,
                         compilation_result, executable);
 }
@@ -423,6 +441,7 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
   const XlaCompiler::CompilationResult* kernel;
   xla::LocalExecutable* executable;
   ResourceVarsSnapshot variables;
+  BucketedBatch bucketed_batch;
 
   std::vector<const Tensor*> inputs = InputsFromContext(ctx);
   bool cannot_compile_cluster;
@@ -439,9 +458,12 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
                : XlaCompilationCache::CompileMode::kLazy;
   }();
 
+  // Why the cluster runs through the TF function fallback, if it does.
+  absl::string_view fallback_reason;
   if (GetXlaOpsCommonFlags().tf_xla_always_defer_compilation ||
       cannot_compile_cluster) {
     executable = nullptr;
+    fallback_reason = cannot_compile_cluster ? "unimplemented" : "deferred";
   } else {
     std::vector<VariableInfo> variable_infos;
     OP_REQUIRES_OK(
@@ -454,7 +476,7 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
     Status status = CompileToLocalExecutable(
         ctx, function_, has_ref_vars_, platform_info_, inputs, variable_infos,
         constants_, compile_mode, /*may_alias_resource_update=*/false, &client,
-        &kernel, &executable);
+        &kernel, &executable, &bucketed_batch);
     OP_REQUIRES_OK(ctx, SnapshotResourceVariables(ctx, resources_,
                                                   variable_infos, &variables));
     if (compile_mode != XlaCompilationCache::CompileMode::kLazy ||
@@ -470,8 +492,15 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
           XlaOptimizationRemark::UNIMPLEMENTED_OPERATION, status.ToString())
           .IgnoreError();
       executable = nullptr;
+      fallback_reason = "unimplemented";
       mutex_lock guard(cannot_compile_cluster_mu_);
       cannot_compile_cluster_ = true;
+    } else if (!executable) {
+      // The cluster has not been executed often enough to be compiled yet, or
+      // is being compiled in the background.
+      fallback_reason = compile_mode == XlaCompilationCache::CompileMode::kAsync
+                            ? "async_compilation"
+                            : "lazy_compilation";
     }
   }
 
@@ -483,6 +512,10 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
   // Async compilation returns nullptr executable without an error.
   if (!executable) {
     DCHECK(!must_compile_);
+    xla_compile_fallback_counter
+        ->GetCell(platform_info_.device_type().type_string(),
+                  std::string(fallback_reason))
+        ->IncrementBy(1);
     Tensor compilation_key(cpu_allocator, DT_STRING, TensorShape({}));
 
     Tensor compilation_successful(cpu_allocator, DT_BOOL, TensorShape({}));
@@ -498,7 +531,8 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
   // variables.
   XlaExecutableClosureStore::KeyT key =
       XlaExecutableClosureStore::Global()->Produce(XlaExecutableClosure(
-          client, executable, kernel, std::move(variables), constants_.size()));
+          client, executable, kernel, std::move(variables), constants_.size(),
+          bucketed_batch));
 
   Tensor compilation_key(cpu_allocator, DT_STRING, TensorShape({}));
   compilation_key.flat<tstring>()(0) = key;
@@ -532,6 +566,10 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
       closure.executable()->executable()->module().input_output_alias_config();
   StatusOr<std::vector<xla::ExecutionInput>> execution_inputs;
   std::map<int, const Tensor*> snapshot_ptrs;
+  const BucketedBatch& bucketed_batch = closure.bucketed_batch();
+  // Keeps the padded inputs alive until the executable has been enqueued.
+  std::map<int, Tensor> padded_inputs;
+  std::map<int, const Tensor*> input_overrides;
   {
     tensorflow::profiler::TraceMe hlo_module_activity(
         [&] {
@@ -545,10 +583,27 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
       snapshot_ptrs.emplace(p.first,
                             p.second.has_value() ? &p.second.value() : nullptr);
     }
+    if (bucketed_batch.padded()) {
+      // Pad the inputs to the shapes the executable was compiled for.
+      for (int arg_num : closure.compilation_result()->input_mapping) {
+        if (snapshot_ptrs.count(arg_num)) {
+          continue;
+        }
+        const Tensor& input =
+            ctx->input(arg_num - closure.num_constant_args());
+        if (input.dims() == 0) {
+          continue;
+        }
+        OP_REQUIRES_OK(ctx, PadLeadingDimension(
+                                ctx, input, bucketed_batch.padded_batch_size,
+                                &padded_inputs[arg_num]));
+        input_overrides[arg_num] = &padded_inputs[arg_num];
+      }
+    }
     execution_inputs = launch_context.PopulateInputs(
         ctx, closure.compilation_result(), snapshot_ptrs,
         /*missing_ctx_input_prefix=*/closure.num_constant_args(),
-        input_output_alias);
+        input_output_alias, input_overrides);
     OP_REQUIRES_OK(ctx, execution_inputs.status());
   }
 
@@ -574,6 +629,18 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
           ctx, closure.compilation_result(), execution_output->ConsumeResult(),
           /*missing_ctx_input_prefix=*/closure.num_constant_args(),
           absl::MakeSpan(*variable_infos), input_output_alias, snapshot_ptrs));
+
+  if (bucketed_batch.padded()) {
+    // Slice the padding off the outputs, which share the leading dimension of
+    // the inputs.
+    for (int i = 0; i < ctx->num_outputs(); ++i) {
+      Tensor* output = ctx->mutable_output(i);
+      if (output != nullptr && output->dims() > 0 &&
+          output->dim_size(0) == bucketed_batch.padded_batch_size) {
+        ctx->set_output(i, output->Slice(0, bucketed_batch.batch_size));
+      }
+    }
+  }
 }
 
 XlaMergeOp::XlaMergeOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
@@ -0,0 +1,167 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/shape_bucketing.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+
+namespace tensorflow {
+
+StatusOr<ShapeBucketingPolicy> ShapeBucketingPolicy::Parse(
+    absl::string_view spec) {
+  ShapeBucketingPolicy policy;
+  if (spec.empty()) {
+    return policy;
+  }
+  if (spec == "pow2") {
+    policy.power_of_two_ = true;
+    return policy;
+  }
+  for (absl::string_view size_str : absl::StrSplit(spec, ',')) {
+    int64_t size;
+    if (!absl::SimpleAtoi(size_str, &size) || size <= 0) {
+      return errors::InvalidArgument("Invalid bucket size \"", size_str,
+                                     "\" in shape bucketing policy \"", spec,
+                                     "\"");
+    }
+    if (!policy.bucket_sizes_.empty() && size <= policy.bucket_sizes_.back()) {
+      return errors::InvalidArgument(
+          "Bucket sizes must be strictly increasing in shape bucketing "
+          "policy \"",
+          spec, "\"");
+    }
+    policy.bucket_sizes_.push_back(size);
+  }
+  return policy;
+}
+
+const ShapeBucketingPolicy& ShapeBucketingPolicy::FromFlags() {
+  static const ShapeBucketingPolicy* policy = [] {
+    const std::string& spec = GetXlaOpsCommonFlags().tf_xla_shape_buckets;
+    StatusOr<ShapeBucketingPolicy> parsed = Parse(spec);
+    if (!parsed.ok()) {
+      LOG(ERROR) << "Disabling shape bucketing: " << parsed.status();
+      return new ShapeBucketingPolicy();
+    }
+    return new ShapeBucketingPolicy(*std::move(parsed));
+  }();
+  return *policy;
+}
+
+int64_t ShapeBucketingPolicy::BucketSize(int64_t size) const {
+  if (size <= 0) {
+    return size;
+  }
+  if (power_of_two_) {
+    int64_t bucket = 1;
+    while (bucket < size) {
+      bucket <<= 1;
+    }
+    return bucket;
+  }
+  auto it = std::lower_bound(bucket_sizes_.begin(), bucket_sizes_.end(), size);
+  return it == bucket_sizes_.end() ? size : *it;
+}
+
+BucketedBatch BucketCompilerArguments(
+    const ShapeBucketingPolicy& policy,
+    std::vector<XlaCompiler::Argument>* args) {
+  BucketedBatch batch;
+  if (!policy.enabled()) {
+    return batch;
+  }
+  std::vector<TensorShape*> shapes;
+  for (XlaCompiler::Argument& arg : *args) {
+    if (arg.kind != XlaCompiler::Argument::kParameter) {
+      continue;
+    }
+    TensorShape* shape = absl::get_if<TensorShape>(&arg.shape);
+    if (shape == nullptr) {
+      // The argument has an XLA shape, which may describe a tuple.
+      return BucketedBatch();
+    }
+    if (shape->dims() == 0) {
+      continue;
+    }
+    if (!shapes.empty() && shape->dim_size(0) != batch.batch_size) {
+      return BucketedBatch();
+    }
+    batch.batch_size = shape->dim_size(0);
+    shapes.push_back(shape);
+  }
+  batch.padded_batch_size = policy.BucketSize(batch.batch_size);
+  if (batch.padded()) {
+    for (TensorShape* shape : shapes) {
+      shape->set_dim(0, batch.padded_batch_size);
+    }
+    VLOG(2) << "Bucketed a batch of " << batch.batch_size << " to "
+            << batch.padded_batch_size;
+  }
+  return batch;
+}
+
+Status PadLeadingDimension(OpKernelContext* ctx, const Tensor& input,
+                           int64_t padded_size, Tensor* output) {
+  if (input.dims() == 0 || input.dim_size(0) > padded_size) {
+    return errors::InvalidArgument("Cannot pad tensor of shape ",
+                                   input.shape().DebugString(),
+                                   " to a leading dimension of ", padded_size);
+  }
+  if (!DataTypeCanUseMemcpy(input.dtype())) {
+    return errors::Unimplemented("Cannot pad tensors of type ",
+                                 DataTypeString(input.dtype()));
+  }
+  TensorShape padded_shape = input.shape();
+  padded_shape.set_dim(0, padded_size);
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(input.dtype(), padded_shape, output));
+
+  const StringPiece src = input.tensor_data();
+  char* dst = const_cast<char*>(output->tensor_data().data());
+  const uint64 padding_bytes = output->TotalBytes() - src.size();
+  se::Stream* stream =
+      ctx->op_device_context() ? ctx->op_device_context()->stream() : nullptr;
+  if (stream == nullptr) {
+    std::memcpy(dst, src.data(), src.size());
+    std::memset(dst + src.size(), 0, padding_bytes);
+    return Status::OK();
+  }
+  // The leading dimension is the outermost one, so the input is a prefix of
+  // the padded tensor.
+  se::DeviceMemoryBase dst_data(dst, src.size());
+  se::DeviceMemoryBase padding(dst + src.size(), padding_bytes);
+  if (!src.empty()) {
+    stream->ThenMemcpy(&dst_data,
+                       se::DeviceMemoryBase(const_cast<char*>(src.data()),
+                                            src.size()),
+                       src.size());
+  }
+  stream->ThenMemZero(&padding, padding_bytes);
+  if (!stream->ok()) {
+    return errors::Internal("Failed to pad tensor of shape ",
+                            input.shape().DebugString());
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
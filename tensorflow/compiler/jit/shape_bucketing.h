@@ -0,0 +1,84 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Contains utilities for bucketing the shapes of the inputs of auto-clustered
+// computations, which bounds the number of compilations for variable batch
+// sizes.
+
+#ifndef TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
+#define TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
+
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+
+namespace tensorflow {
+
+// Maps sizes of the leading dimension of cluster inputs to bucket sizes.
+class ShapeBucketingPolicy {
+ public:
+  // Returns a policy that does not bucket.
+  ShapeBucketingPolicy() = default;
+
+  // Parses a policy specification, which is either empty (no bucketing),
+  // "pow2" (round up to the next power of two), or a comma-separated,
+  // strictly increasing list of bucket sizes (round up to the next listed
+  // size; larger sizes are not bucketed).
+  static StatusOr<ShapeBucketingPolicy> Parse(absl::string_view spec);
+
+  // Returns the policy specified by --tf_xla_shape_buckets.
+  static const ShapeBucketingPolicy& FromFlags();
+
+  bool enabled() const { return power_of_two_ || !bucket_sizes_.empty(); }
+
+  // Returns the bucket size for a leading dimension of `size`, which is at
+  // least `size`.
+  int64_t BucketSize(int64_t size) const;
+
+ private:
+  bool power_of_two_ = false;
+  std::vector<int64_t> bucket_sizes_;
+};
+
+// The leading dimension of the inputs of a bucketed computation.
+struct BucketedBatch {
+  // The size of the leading dimension of the actual inputs.
+  int64_t batch_size = 0;
+  // The size of the leading dimension the computation was compiled for.
+  int64_t padded_batch_size = 0;
+
+  bool padded() const { return padded_batch_size > batch_size; }
+};
+
+// Rounds the leading dimension of the parameter arguments in `args` up to its
+// bucket size. Arguments are only bucketed if all parameters of rank >= 1
+// share the size of their leading dimension; constants and resources are
+// never bucketed.
+BucketedBatch BucketCompilerArguments(
+    const ShapeBucketingPolicy& policy,
+    std::vector<XlaCompiler::Argument>* args);
+
+// Sets `output` to a copy of `input` whose leading dimension is padded with
+// zeros to `padded_size`. The copy is done on the stream of `ctx`, if any.
+Status PadLeadingDimension(OpKernelContext* ctx, const Tensor& input,
+                           int64_t padded_size, Tensor* output);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
@@ -0,0 +1,96 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/shape_bucketing.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+XlaCompiler::Argument Parameter(const TensorShape& shape) {
+  XlaCompiler::Argument arg;
+  arg.kind = XlaCompiler::Argument::kParameter;
+  arg.type = DT_FLOAT;
+  arg.shape = shape;
+  return arg;
+}
+
+TEST(ShapeBucketingTest, Disabled) {
+  TF_ASSERT_OK_AND_ASSIGN(ShapeBucketingPolicy policy,
+                          ShapeBucketingPolicy::Parse(""));
+  EXPECT_FALSE(policy.enabled());
+  std::vector<XlaCompiler::Argument> args = {Parameter(TensorShape({3, 2}))};
+  EXPECT_FALSE(BucketCompilerArguments(policy, &args).padded());
+  EXPECT_EQ(3, absl::get<TensorShape>(args[0].shape).dim_size(0));
+}
+
+TEST(ShapeBucketingTest, PowerOfTwo) {
+  TF_ASSERT_OK_AND_ASSIGN(ShapeBucketingPolicy policy,
+                          ShapeBucketingPolicy::Parse("pow2"));
+  EXPECT_TRUE(policy.enabled());
+  EXPECT_EQ(1, policy.BucketSize(1));
+  EXPECT_EQ(4, policy.BucketSize(3));
+  EXPECT_EQ(64, policy.BucketSize(64));
+  EXPECT_EQ(128, policy.BucketSize(65));
+}
+
+TEST(ShapeBucketingTest, ExplicitBuckets) {
+  TF_ASSERT_OK_AND_ASSIGN(ShapeBucketingPolicy policy,
+                          ShapeBucketingPolicy::Parse("8,32,100"));
+  EXPECT_EQ(8, policy.BucketSize(1));
+  EXPECT_EQ(32, policy.BucketSize(9));
+  EXPECT_EQ(100, policy.BucketSize(100));
+  EXPECT_EQ(101, policy.BucketSize(101));
+}
+
+TEST(ShapeBucketingTest, InvalidSpecs) {
+  EXPECT_FALSE(ShapeBucketingPolicy::Parse("pow3").ok());
+  EXPECT_FALSE(ShapeBucketingPolicy::Parse("8,0").ok());
+  EXPECT_FALSE(ShapeBucketingPolicy::Parse("32,8").ok());
+}
+
+TEST(ShapeBucketingTest, BucketsSharedLeadingDimension) {
+  TF_ASSERT_OK_AND_ASSIGN(ShapeBucketingPolicy policy,
+                          ShapeBucketingPolicy::Parse("pow2"));
+  XlaCompiler::Argument constant;
+  constant.kind = XlaCompiler::Argument::kConstant;
+  constant.type = DT_INT32;
+  constant.constant_value = Tensor(DT_INT32, TensorShape({5}));
+  std::vector<XlaCompiler::Argument> args = {
+      Parameter(TensorShape({5, 3})), constant, Parameter(TensorShape({})),
+      Parameter(TensorShape({5}))};
+  BucketedBatch batch = BucketCompilerArguments(policy, &args);
+  EXPECT_TRUE(batch.padded());
+  EXPECT_EQ(5, batch.batch_size);
+  EXPECT_EQ(8, batch.padded_batch_size);
+  EXPECT_EQ(TensorShape({8, 3}), absl::get<TensorShape>(args[0].shape));
+  EXPECT_EQ(TensorShape({}), absl::get<TensorShape>(args[2].shape));
+  EXPECT_EQ(TensorShape({8}), absl::get<TensorShape>(args[3].shape));
+}
+
+TEST(ShapeBucketingTest, SkipsMismatchedLeadingDimensions) {
+  TF_ASSERT_OK_AND_ASSIGN(ShapeBucketingPolicy policy,
+                          ShapeBucketingPolicy::Parse("pow2"));
+  std::vector<XlaCompiler::Argument> args = {Parameter(TensorShape({5, 3})),
+                                             Parameter(TensorShape({3}))};
+  EXPECT_FALSE(BucketCompilerArguments(policy, &args).padded());
+  EXPECT_EQ(TensorShape({5, 3}), absl::get<TensorShape>(args[0].shape));
+  EXPECT_EQ(TensorShape({3}), absl::get<TensorShape>(args[1].shape));
+}
+
+}  // namespace
+}  // namespace tensorflow
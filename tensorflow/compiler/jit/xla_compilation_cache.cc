@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/compiler/tf2xla/xla_context.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
+#include "tensorflow/compiler/xla/debug_options_flags.h"
 #include "tensorflow/compiler/xla/protobuf_util.h"
 #include "tensorflow/compiler/xla/service/compiler.h"
 #include "tensorflow/compiler/xla/service/hlo.pb.h"
@@ -140,7 +141,24 @@ std::string XlaSerializedCacheKeyToString(const XlaSerializedCacheKey& key) {
       key.prefix(), key.prefix().empty() ? "" : kXlaSerializedCacheKeySeparator,
       key.signature_fingerprint(), kXlaSerializedCacheKeySeparator,
       key.cluster_fingerprint(), kXlaSerializedCacheKeySeparator,
-      key.device_type());
+      key.device_type(), kXlaSerializedCacheKeySeparator,
+      key.compiler_fingerprint());
+}
+
+// Returns a fingerprint of the XLA compiler flags and of the devices of
+// `client`, so that entries persisted by a differently configured compiler,
+// or for a different kind of device, are not loaded.
+uint64 CompilerFingerprint(xla::LocalClient* client) {
+  uint64 fingerprint =
+      DeterministicProtoHash64(xla::GetDebugOptionsFromFlags());
+  if (client != nullptr) {
+    const se::DeviceDescription& description =
+        client->backend().default_stream_executor()->GetDeviceDescription();
+    fingerprint = Hash64Combine(fingerprint, Hash64(description.name()));
+    fingerprint =
+        Hash64Combine(fingerprint, Hash64(description.platform_version()));
+  }
+  return fingerprint;
 }
 
 }  // namespace
@@ -824,6 +842,7 @@ XlaSerializedCacheKey XlaCompilationCache::BuildSerializedCacheKey(
       DeterministicProtoHash64(hlo_module));
   serialized_cache_key.set_device_type(device_type_.type_string());
   serialized_cache_key.set_prefix(persistance_prefix_);
+  serialized_cache_key.set_compiler_fingerprint(CompilerFingerprint(client_));
   return serialized_cache_key;
 }
 
@@ -906,7 +925,20 @@ Status XlaCompilationCache::SaveSerializedEntry(
   TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(persistent_cache_directory_));
   const std::string file_path =
       GetFilePath(entry.key(), persistent_cache_directory_);
-  return WriteBinaryProto(env, file_path, entry);
+  // The directory may be shared between processes, which may load the entry
+  // while it is being written. Write to a temporary file and rename it, so
+  // that only complete entries are observed.
+  std::string temp_path = file_path;
+  if (!env->CreateUniqueFileName(&temp_path, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            file_path);
+  }
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_path, entry));
+  Status s = env->RenameFile(temp_path, file_path);
+  if (!s.ok()) {
+    env->DeleteFile(temp_path).IgnoreError();
+  }
+  return s;
 }
 
 StatusOr<absl::optional<XlaSerializedCacheEntry>>
@@ -249,7 +249,8 @@ XlaComputationLaunchContext::PopulateInputs(
     const XlaCompiler::CompilationResult* compilation_result,
     const std::map<int, const Tensor*>& resource_vars,
     int missing_ctx_input_prefix,
-    const xla::HloInputOutputAliasConfig& input_output_alias) {
+    const xla::HloInputOutputAliasConfig& input_output_alias,
+    const std::map<int, const Tensor*>& input_overrides) {
   std::vector<xla::ExecutionInput> arguments;
   arguments.reserve(compilation_result->xla_input_shapes.size());
 
@@ -272,8 +273,10 @@ XlaComputationLaunchContext::PopulateInputs(
                                 update.modified;
                        });
 
-    const Tensor* t = is_resource_variable
-                          ? resource_vars.at(arg_num)
+    auto input_override = input_overrides.find(arg_num);
+    const Tensor* t = is_resource_variable ? resource_vars.at(arg_num)
+                      : input_override != input_overrides.end()
+                          ? input_override->second
                           : &(ctx->input(arg_num - missing_ctx_input_prefix));
     CHECK(t);
     bool donate_buffer =
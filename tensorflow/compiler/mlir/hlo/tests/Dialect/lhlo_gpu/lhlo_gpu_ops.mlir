@@ -215,6 +215,27 @@ func.func @gemm_bias(%lhs: memref<5x4xf32>, %rhs: memref<4x5xf32>,
   func.return
 }
 
+// CHECK-LABEL: func @gemm_bias_relu_epilogue
+func.func @gemm_bias_relu_epilogue(%lhs: memref<5x4xf32>, %rhs: memref<4x5xf32>,
+                %bias: memref<5xf32>, %output:memref<5x5xf32>) {
+  "lmhlo_gpu.gemm_bias"(%lhs, %rhs, %bias, %output) {
+    dot_dimension_numbers = #mhlo.dot<
+       lhs_batching_dimensions = [1,1],
+       rhs_batching_dimensions = [1,1],
+       lhs_contracting_dimensions = [1,1],
+       rhs_contracting_dimensions = [1,1]
+    >,
+    alpha_real = 0.5,
+    alpha_imag = 0.0,
+    beta = 0.0,
+    batch_size = 1,
+    lhs_stride = 20,
+    rhs_stride = 20,
+    epilogue = #lmhlo_gpu<"epilogue BiasRelu">
+  } : (memref<5x4xf32>, memref<4x5xf32>, memref<5xf32>, memref<5x5xf32>) -> ()
+  func.return
+}
+
 // CHECK-LABEL: func @cholesky
 func.func @cholesky(%arg : memref<10x10xf32>, %out: memref<10x10xf32>) {
   %scratch = memref.alloc() : memref<32xi8>
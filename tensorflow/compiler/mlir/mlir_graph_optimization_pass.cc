@@ -21,6 +21,7 @@ limitations under the License.
 #include "absl/container/flat_hash_set.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_os_ostream.h"
 #include "mlir/Dialect/Arithmetic/IR/Arithmetic.h"  // from @llvm-project
 #include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
@@ -67,6 +68,14 @@ constexpr char kGraphImportSuccess[] = "kGraphImportSuccess";
 constexpr char kRoundTripSuccess[] = "kRoundTripSuccess";
 constexpr char kRoundTripFailure[] = "kRoundTripFailure";
 
+// Returns the thread pool shared by the MLIR contexts of the passes, on which
+// the passes nested on functions run in parallel. Without it, every context
+// would start and join a pool of its own for each graph.
+static llvm::ThreadPool& GetMlirContextThreadPool() {
+  static llvm::ThreadPool* pool = new llvm::ThreadPool();
+  return *pool;
+}
+
 static inline absl::string_view StringRefToView(llvm::StringRef ref) {
   return {ref.data(), ref.size()};
 }
@@ -206,7 +215,8 @@ Status MlirFunctionOptimizationPass::Run(
   GraphDebugInfo debug_info;
   mlir::DialectRegistry registry;
   RegisterDialects(registry);
-  mlir::MLIRContext context(registry);
+  mlir::MLIRContext context(registry, mlir::MLIRContext::Threading::DISABLED);
+  context.setThreadPool(GetMlirContextThreadPool());
   GraphImportConfig import_config;
   import_config.graph_as_function = true;
   import_config.control_outputs = *control_ret_node_names;
@@ -360,7 +370,8 @@ Status MlirV1CompatGraphOptimizationPass::Run(
   GraphDebugInfo debug_info;
   mlir::DialectRegistry registry;
   RegisterDialects(registry);
-  mlir::MLIRContext context(registry);
+  mlir::MLIRContext context(registry, mlir::MLIRContext::Threading::DISABLED);
+  context.setThreadPool(GetMlirContextThreadPool());
   GraphImportConfig import_config;
   import_config.upgrade_legacy = true;
   // Restrict functionalization to compiled nodes to avoid problems in v1
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/mlir/tensorflow/transforms/passes.h"
 #include "tensorflow/compiler/mlir/tensorflow/utils/bridge_logger.h"
+#include "tensorflow/compiler/mlir/tensorflow/utils/bridge_pass_timing.h"
 #include "tensorflow/compiler/mlir/tensorflow/utils/dump_mlir_util.h"
 #include "tensorflow/compiler/mlir/tensorflow/utils/error_util.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -64,12 +65,20 @@ tensorflow::Status RunTFXLABridge(
   // Add set of passes to lower back to graph (from tf_executor).
   TF::AddGraphExportLoweringPasses(bridge);
 
+  // The passes nested on functions run in parallel over the functions of the
+  // module, unless detailed logging disabled multi-threading. Time them per
+  // function to tell which functions dominate the bridge.
+  auto timing = std::make_unique<tensorflow::BridgePassTimingInstrumentation>();
+  tensorflow::BridgePassTimingInstrumentation* timing_ptr = timing.get();
+  bridge.addInstrumentation(std::move(timing));
+
   mlir::StatusScopedDiagnosticHandler diag_handler(
       module.getContext(), /*propagate=*/false,
       /*filter_stack=*/!VLOG_IS_ON(1));
 
   LogicalResult result = bridge.run(module);
   (void)result;
+  VLOG(1) << timing_ptr->Summary(/*n=*/10);
   if (enable_logging || VLOG_IS_ON(1))
     tensorflow::DumpMlirOpToFile("tf_xla_bridge_after", module);
   return diag_handler.ConsumeStatus();
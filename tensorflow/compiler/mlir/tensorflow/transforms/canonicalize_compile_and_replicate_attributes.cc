@@ -43,8 +43,9 @@ struct CanonicalizeCompileAndReplicateAttributesPass
 
 void CanonicalizeCompileAndReplicateAttributesPass::runOnOperation() {
   func::FuncOp func_op = getOperation();
-  ModuleOp module_op = func_op->getParentOfType<ModuleOp>();
-  mlir::OpBuilder builder(module_op.getContext());
+  // Runs concurrently with the other functions of the module, so it must not
+  // touch the module.
+  mlir::OpBuilder builder(func_op.getContext());
   func_op->walk([&](mlir::Operation* op) {
     if (op->hasAttr(TF::kTPUReplicateAttr)) {
       op->setAttr(TF::kReplicationInfoAttr, op->getAttr(TF::kTPUReplicateAttr));
@@ -0,0 +1,112 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/mlir/tensorflow/utils/bridge_pass_timing.h"
+
+#include <algorithm>
+
+#include "llvm/Support/FormatVariadic.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+
+static const char* kTfMlirBridgePassCategory = "TfMlirBridgePass";
+
+void BridgePassTimingInstrumentation::runBeforePass(mlir::Pass* pass,
+                                                    mlir::Operation* op) {
+  // Passes on the module include the adaptors that run the nested passes,
+  // whose time is already attributed to the functions.
+  if (!llvm::isa<mlir::func::FuncOp>(op)) return;
+  const uint64_t now_us = Env::Default()->NowMicros();
+  mutex_lock lock(mu_);
+  start_us_[{pass, op}] = now_us;
+}
+
+void BridgePassTimingInstrumentation::runAfterPass(mlir::Pass* pass,
+                                                   mlir::Operation* op) {
+  RecordPass(pass, op);
+}
+
+void BridgePassTimingInstrumentation::runAfterPassFailed(mlir::Pass* pass,
+                                                         mlir::Operation* op) {
+  RecordPass(pass, op);
+}
+
+void BridgePassTimingInstrumentation::RecordPass(mlir::Pass* pass,
+                                                 mlir::Operation* op) {
+  auto func = llvm::dyn_cast<mlir::func::FuncOp>(op);
+  if (!func) return;
+  const uint64_t now_us = Env::Default()->NowMicros();
+  const std::string pass_name = pass->getName().str();
+  int64_t elapsed_us;
+  {
+    mutex_lock lock(mu_);
+    auto it = start_us_.find({pass, op});
+    if (it == start_us_.end()) return;
+    elapsed_us = now_us - it->second;
+    start_us_.erase(it);
+    function_pass_us_[func.getName().str()][pass_name] += elapsed_us;
+  }
+  metrics::GetGraphOptimizationCounter()
+      ->GetCell(kTfMlirBridgePassCategory, pass_name)
+      ->IncrementBy(elapsed_us);
+}
+
+std::vector<BridgePassTimingInstrumentation::FunctionTiming>
+BridgePassTimingInstrumentation::SlowestFunctions(int n) const {
+  std::vector<FunctionTiming> timings;
+  {
+    mutex_lock lock(mu_);
+    timings.reserve(function_pass_us_.size());
+    for (const auto& function : function_pass_us_) {
+      FunctionTiming timing;
+      timing.function = function.first;
+      for (const auto& pass : function.second) {
+        timing.total_us += pass.second;
+        if (pass.second > timing.slowest_pass_us ||
+            (pass.second == timing.slowest_pass_us &&
+             pass.first < timing.slowest_pass)) {
+          timing.slowest_pass = pass.first;
+          timing.slowest_pass_us = pass.second;
+        }
+      }
+      timings.push_back(std::move(timing));
+    }
+  }
+  std::sort(timings.begin(), timings.end(),
+            [](const FunctionTiming& a, const FunctionTiming& b) {
+              if (a.total_us != b.total_us) return a.total_us > b.total_us;
+              return a.function < b.function;
+            });
+  if (timings.size() > static_cast<size_t>(std::max(n, 0))) {
+    timings.resize(std::max(n, 0));
+  }
+  return timings;
+}
+
+std::string BridgePassTimingInstrumentation::Summary(int n) const {
+  std::string summary = "Bridge pass time by function:\n";
+  for (const FunctionTiming& timing : SlowestFunctions(n)) {
+    summary += llvm::formatv("{0,10}us  {1} (slowest pass: {2}, {3}us)\n",
+                             timing.total_us, timing.function,
+                             timing.slowest_pass, timing.slowest_pass_us)
+                   .str();
+  }
+  return summary;
+}
+
+}  // namespace tensorflow
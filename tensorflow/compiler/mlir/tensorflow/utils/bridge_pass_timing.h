@@ -0,0 +1,73 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_MLIR_TENSORFLOW_UTILS_BRIDGE_PASS_TIMING_H_
+#define TENSORFLOW_COMPILER_MLIR_TENSORFLOW_UTILS_BRIDGE_PASS_TIMING_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "mlir/IR/Operation.h"  // from @llvm-project
+#include "mlir/Pass/Pass.h"  // from @llvm-project
+#include "mlir/Pass/PassInstrumentation.h"  // from @llvm-project
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Times the passes that the bridge runs on each function.
+//
+// The passes nested on functions run concurrently on the thread pool of the
+// MLIR context, so the instrumentation is thread-safe. The time of each pass,
+// summed over the functions, is added to the
+// /tensorflow/core/graph_optimization_usecs counter, and Summary() lists the
+// functions that took the longest.
+class BridgePassTimingInstrumentation : public mlir::PassInstrumentation {
+ public:
+  struct FunctionTiming {
+    std::string function;
+    int64_t total_us = 0;
+    // The pass that took the longest on the function.
+    std::string slowest_pass;
+    int64_t slowest_pass_us = 0;
+  };
+
+  void runBeforePass(mlir::Pass* pass, mlir::Operation* op) override;
+  void runAfterPass(mlir::Pass* pass, mlir::Operation* op) override;
+  void runAfterPassFailed(mlir::Pass* pass, mlir::Operation* op) override;
+
+  // Returns the `n` functions with the largest total pass time.
+  std::vector<FunctionTiming> SlowestFunctions(int n) const;
+
+  // Returns a human-readable table of SlowestFunctions(n).
+  std::string Summary(int n) const;
+
+ private:
+  void RecordPass(mlir::Pass* pass, mlir::Operation* op);
+
+  mutable mutex mu_;
+  absl::flat_hash_map<std::pair<mlir::Pass*, mlir::Operation*>, uint64_t>
+      start_us_ TF_GUARDED_BY(mu_);
+  // The time of each pass on each function, by function name.
+  absl::flat_hash_map<std::string, absl::flat_hash_map<std::string, int64_t>>
+      function_pass_us_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_MLIR_TENSORFLOW_UTILS_BRIDGE_PASS_TIMING_H_
@@ -0,0 +1,78 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/mlir/tensorflow/utils/bridge_pass_timing.h"
+
+#include <memory>
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "mlir/IR/MLIRContext.h"  // from @llvm-project
+#include "mlir/Pass/PassManager.h"  // from @llvm-project
+#include "mlir/Transforms/Passes.h"  // from @llvm-project
+#include "tensorflow/compiler/mlir/tensorflow/dialect_registration.h"
+#include "tensorflow/compiler/mlir/tensorflow/utils/serialize_mlir_module_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+static const char *const module_with_two_functions =
+    R"(module {
+func.func @main(%arg0: tensor<3x4x5xf32>, %arg1: tensor<3x4x5xf32>) -> tensor<3x4x5xf32> {
+  %0 = "tf.AddV2"(%arg0, %arg1) : (tensor<3x4x5xf32>, tensor<3x4x5xf32>) -> tensor<3x4x5xf32>
+  func.return %0 : tensor<3x4x5xf32>
+}
+func.func @sub(%arg0: tensor<7x8x9xi8>, %arg1: tensor<7x8x9xi8>) -> tensor<7x8x9xi8> {
+  %0 = "tf.Sub"(%arg0, %arg1) : (tensor<7x8x9xi8>, tensor<7x8x9xi8>) -> tensor<7x8x9xi8>
+  func.return %0 : tensor<7x8x9xi8>
+}
+}
+)";
+
+TEST(BridgePassTimingInstrumentation, TimesNestedPassesPerFunction) {
+  mlir::DialectRegistry mlir_registry;
+  mlir::RegisterAllTensorFlowDialects(mlir_registry);
+  mlir::MLIRContext mlir_context(mlir_registry);
+  mlir::OwningOpRef<mlir::ModuleOp> module;
+  TF_ASSERT_OK(DeserializeMlirModule(module_with_two_functions, &mlir_context,
+                                     &module));
+
+  mlir::PassManager pm(&mlir_context);
+  pm.addNestedPass<mlir::func::FuncOp>(mlir::createCanonicalizerPass());
+  pm.addNestedPass<mlir::func::FuncOp>(mlir::createCSEPass());
+  pm.addPass(mlir::createSymbolDCEPass());
+  auto timing = std::make_unique<BridgePassTimingInstrumentation>();
+  BridgePassTimingInstrumentation *timing_ptr = timing.get();
+  pm.addInstrumentation(std::move(timing));
+  ASSERT_TRUE(mlir::succeeded(pm.run(module.get())));
+
+  // The module pass is not attributed to a function.
+  const auto functions = timing_ptr->SlowestFunctions(/*n=*/10);
+  ASSERT_EQ(functions.size(), 2);
+  EXPECT_NE(functions[0].function, functions[1].function);
+  for (const auto &function : functions) {
+    EXPECT_TRUE(function.function == "main" || function.function == "sub");
+    EXPECT_GE(function.total_us, function.slowest_pass_us);
+    EXPECT_FALSE(function.slowest_pass.empty());
+  }
+  EXPECT_GE(functions[0].total_us, functions[1].total_us);
+
+  EXPECT_EQ(timing_ptr->SlowestFunctions(/*n=*/1).size(), 1);
+  EXPECT_NE(timing_ptr->Summary(/*n=*/10).find("sub"), std::string::npos);
+}
+
+}  // namespace
+}  // namespace tensorflow
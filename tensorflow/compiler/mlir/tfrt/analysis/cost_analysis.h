@@ -16,9 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_MLIR_TFRT_ANALYSIS_COST_ANALYSIS_H_
 #define TENSORFLOW_COMPILER_MLIR_TFRT_ANALYSIS_COST_ANALYSIS_H_
 
+#include <algorithm>
+
 #include "absl/strings/string_view.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
+#include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 
 namespace tensorflow {
 namespace tfrt_compiler {
@@ -32,14 +35,29 @@ namespace tfrt_compiler {
 // threshold to decide whether a cost is cheap or expensive), as it might not be
 // accurate in some cases.
 //
+// If a `cost_recorder` is provided, the costs measured at runtime are preferred
+// over the heuristic for the fallback ops that have been profiled. The measured
+// costs are execution times in microseconds, so the cost thresholds should be
+// set accordingly when profiling is enabled.
+//
 class CostAnalysis {
  public:
-  explicit CostAnalysis(mlir::func::FuncOp func_op) {
+  explicit CostAnalysis(
+      mlir::func::FuncOp func_op,
+      const tfrt_stub::CostRecorder* cost_recorder = nullptr)
+      : cost_recorder_(cost_recorder) {
     AnalyzeArguments(func_op);
     AnalyzeBlock(&func_op.front());
   }
 
-  int64_t GetCost(mlir::Operation* op) const {
+  // Returns the cost of `op`. `op_key` is the fallback key of `op` and is used
+  // to look up the measured cost, if any.
+  int64_t GetCost(mlir::Operation* op, int64_t op_key = -1) const {
+    if (cost_recorder_ != nullptr && op_key >= 0 &&
+        cost_recorder_->HasCost(op_key)) {
+      // Costs must be positive.
+      return std::max<int64_t>(1, cost_recorder_->GetCost(op_key));
+    }
     assert(cost_map_.count(op) > 0);
     return cost_map_.lookup(op);
   }
@@ -49,6 +67,7 @@ class CostAnalysis {
   void AnalyzeBlock(mlir::Block* block);
   void EvaluateCost(mlir::Operation* op);
 
+  const tfrt_stub::CostRecorder* cost_recorder_ = nullptr;
   int64_t max_arg_size_ = 1;
   llvm::DenseMap<mlir::Operation*, int64_t> cost_map_;
 };
@@ -193,6 +193,9 @@ FailureOr<Value> GemmOpConversionRewrite(GemmOp op,
   if (get_element_type(op.rhs()) != input_type) {
     return rewriter.notifyMatchFailure(op, "Input element type mismatch.");
   }
+  if (op.epilogue() && *op.epilogue() != lmhlo_gpu::GemmEpilogue::Default) {
+    return rewriter.notifyMatchFailure(op, "GEMM epilogues are unsupported.");
+  }
 
   const xla::Shape output_shape = xla::gpu::GetShape(op.output());
   const xla::Shape lhs_shape = xla::gpu::GetShape(op.lhs());
@@ -23,6 +23,7 @@ limitations under the License.
 #include "mlir/Transforms/DialectConversion.h"  // from @llvm-project
 #include "tensorflow/compiler/mlir/tensorflow/analysis/side_effect_analysis.h"
 #include "tensorflow/compiler/mlir/tfrt/transforms/tpu_passes.h"
+#include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 
 namespace mlir {
 class PassManager;
@@ -211,6 +212,10 @@ struct TfrtPipelineOptions
                      "preferred to be merged for inline execution."),
       llvm::cl::init(false)};
 
+  // If not null, the op costs measured at runtime are used in place of the
+  // static cost analysis. Not owned.
+  const tfrt_stub::CostRecorder* cost_recorder = nullptr;
+
   // A set of flags to control auto-fusion: automatic clustering of Tensorflow
   // operations and compiling outlined regions using MLIR based compilation
   // stack.
@@ -247,11 +247,13 @@ mlir::LogicalResult FallbackExecuteOpConversion::ConvertToFallbackExecuteOp(
           op, device.getValue(), operands, &new_operands, rewriter)))
     return failure();
 
-  auto fallback_key =
-      rewriter.getI64IntegerAttr(fallback_converter.GetNextFallbackKey());
+  const int64_t key = fallback_converter.GetNextFallbackKey();
+  auto fallback_key = rewriter.getI64IntegerAttr(key);
 
-  // Query cost analysis to assign costs.
-  auto cost = rewriter.getI64IntegerAttr(cost_analysis_.GetCost(op));
+  // Query cost analysis to assign costs. The fallback keys are assigned in a
+  // deterministic order, so the key can be used to find the cost measured when
+  // running a previous compilation of the same module.
+  auto cost = rewriter.getI64IntegerAttr(cost_analysis_.GetCost(op, key));
 
   if (mlir::MemoryEffectOpInterface::hasNoEffect(op)) {
     auto new_op = rewriter.create<tfrt::fallback_async::ExecuteOp>(
@@ -1638,8 +1640,10 @@ class TfToTfrtConversionPass
     func_use_fallback_tensor_ = options.func_use_fallback_tensor;
     enable_while_parallel_iterations_ =
         options.enable_while_parallel_iterations;
+    cost_recorder_ = options.cost_recorder;
   }
-  TfToTfrtConversionPass(const TfToTfrtConversionPass &) {}
+  TfToTfrtConversionPass(const TfToTfrtConversionPass &other)
+      : cost_recorder_(other.cost_recorder_) {}
 
   mlir::LogicalResult runOnFunction(
       mlir::func::FuncOp func,
@@ -1652,7 +1656,7 @@ class TfToTfrtConversionPass
     mlir::ConversionTarget target(context);
     mlir::RewritePatternSet patterns(&getContext());
     CoreRTConverter corert_converter(&context, &side_effect_analysis);
-    tfrt_compiler::CostAnalysis cost_analysis(func);
+    tfrt_compiler::CostAnalysis cost_analysis(func, cost_recorder_);
 
     if (target_tpurt_)
       AddTPUTargetDialectAndPatterns(
@@ -1918,6 +1922,9 @@ class TfToTfrtConversionPass
       llvm::cl::desc("If true, tf.While op will be parallelized. This is "
                      "currently experimental."),
       llvm::cl::init(false)};
+
+  // Not a pass option as it can only be set programmatically.
+  const tfrt_stub::CostRecorder *cost_recorder_ = nullptr;
 };
 
 // Assigns devices so that later passes can utilize device information.
@@ -133,6 +133,7 @@ Status ConvertTfMlirToBef(const TfrtCompileOptions& options,
   pass_options.upper_cost_threshold = options.upper_cost_threshold;
   pass_options.merge_inter_dependent_streams =
       options.merge_inter_dependent_streams;
+  pass_options.cost_recorder = options.cost_recorder;
   tensorflow::CreateTfExecutorToTfrtPipeline(pm, pass_options);
 
   if (mlir::failed(pm.run(module)))
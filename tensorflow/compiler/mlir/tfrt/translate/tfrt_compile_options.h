@@ -21,6 +21,9 @@ limitations under the License.
 #include <vector>
 
 namespace tensorflow {
+namespace tfrt_stub {
+class CostRecorder;
+}  // namespace tfrt_stub
 
 enum class TfrtTpuInfraTarget {
   kNoTpu,           // No TPU support.
@@ -123,6 +126,10 @@ struct TfrtCompileOptions {
   // If true, streams with inter data depenedencies will be preferred to be
   // merged for inline execution.
   bool merge_inter_dependent_streams = false;
+
+  // If not null, the op costs measured at runtime are used instead of the
+  // static cost analysis to decide which ops are executed inline. Not owned.
+  const tfrt_stub::CostRecorder* cost_recorder = nullptr;
 };
 
 }  // namespace tensorflow
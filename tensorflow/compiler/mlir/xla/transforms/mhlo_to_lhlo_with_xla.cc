@@ -785,12 +785,35 @@ StatusOr<lmhlo_gpu::CholeskyOp> LhloDialectEmitter::EmitCholesky(
   return cholesky_op;
 }
 
+static StatusOr<mlir::lmhlo_gpu::GemmEpilogue> GetLHLOGemmEpilogue(
+    xla::gpu::GemmBackendConfig::Epilogue epilogue) {
+  switch (epilogue) {
+    case xla::gpu::GemmBackendConfig::DEFAULT:
+      return mlir::lmhlo_gpu::GemmEpilogue::Default;
+    case xla::gpu::GemmBackendConfig::RELU:
+      return mlir::lmhlo_gpu::GemmEpilogue::Relu;
+    case xla::gpu::GemmBackendConfig::GELU:
+      return mlir::lmhlo_gpu::GemmEpilogue::Gelu;
+    case xla::gpu::GemmBackendConfig::BIAS:
+      return mlir::lmhlo_gpu::GemmEpilogue::Bias;
+    case xla::gpu::GemmBackendConfig::BIAS_RELU:
+      return mlir::lmhlo_gpu::GemmEpilogue::BiasRelu;
+    case xla::gpu::GemmBackendConfig::BIAS_GELU:
+      return mlir::lmhlo_gpu::GemmEpilogue::BiasGelu;
+    default:
+      return xla::InternalError("Unknown GEMM epilogue");
+  }
+}
+
 StatusOr<Operation*> LhloDialectEmitter::EmitGemm(
     const HloCustomCallInstruction* custom_call) {
   TF_ASSIGN_OR_RETURN(
       auto const config,
       custom_call->backend_config<xla::gpu::GemmBackendConfig>());
 
+  TF_ASSIGN_OR_RETURN(mlir::lmhlo_gpu::GemmEpilogue epilogue,
+                      GetLHLOGemmEpilogue(config.epilogue()));
+
   auto set_common_attributes = [&](auto op) -> Operation* {
     auto arrayref = [](absl::Span<const int64_t> array) {
       return llvm::ArrayRef<int64_t>{array.data(), array.size()};
@@ -811,6 +834,10 @@ StatusOr<Operation*> LhloDialectEmitter::EmitGemm(
         xla::gpu::GemmBackendConfig::kSelectedAlgorithm) {
       op.algorithmAttr(builder_.getI64IntegerAttr(config.selected_algorithm()));
     }
+    if (epilogue != mlir::lmhlo_gpu::GemmEpilogue::Default) {
+      op.epilogueAttr(mlir::lmhlo_gpu::GemmEpilogueAttr::get(
+          builder_.getContext(), epilogue));
+    }
     return op.getOperation();
   };
 
@@ -40,8 +40,12 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/utils.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
@@ -65,6 +69,9 @@ using ::nvinfer1::IRuntime;
 #define LOG_FIRST_FEW_WARNING_WITH_PREFIX \
   LOG_FIRST_N(WARNING, 5) << "TF-TRT Warning: "
 
+// The number of most frequent input shapes that the profiles are learned from.
+constexpr int kMaxLearnedProfileShapes = 32;
+
 // Allocates device memory for an execution context to execute a TensorRT
 // engine and records the relevant information for deallocating the memory when
 // the engine finishes execution.
@@ -198,6 +205,45 @@ class TRTEngineOp : public AsyncOpKernel {
       bool use_calibration, TRTInt8Calibrator* calibrator,
       TRTEngineCacheResource* cache_resource, OpKernelContext* ctx);
 
+  // Schedules building the engine for the input shapes on the background
+  // thread of cache_resource, and persists it to `engine_path` unless it is
+  // empty. Only used in implicit batch mode.
+  void BuildEngineInBackground(
+      const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+      const string& engine_path, TRTEngineCacheResource* cache_resource,
+      OpKernelContext* ctx);
+
+  // Counts the input shapes in the histogram of cache_res, and when the
+  // profiles did not cover some of the last profile_refresh_interval_ ones,
+  // schedules rebuilding the engine for profiles learned from the histogram.
+  // Only used in explicit batch mode, under engine_mutex_.
+  void LearnProfiles(const std::vector<TensorShape>& input_concrete_shapes,
+                     bool covered, TRTEngineCacheResource* cache_res,
+                     OpKernelContext* ctx);
+
+  // What a background build uses of the op, copied since the op may be
+  // destroyed before the build runs.
+  struct BackgroundBuildParams {
+    GraphDef segment_graph_def;
+    TrtPrecisionMode precision_mode;
+    int batch_size;
+    int64 workspace_size;
+    bool use_explicit_precision;
+    string engine_name;
+    string device_name;
+    int platform_device_id;
+  };
+  BackgroundBuildParams GetBackgroundBuildParams(int batch_size,
+                                                 OpKernelContext* ctx);
+
+  // Builds an engine on a thread other than the one of the request, without
+  // calibration. Returns nullptr if the build fails.
+  static TrtUniquePtrType<nvinfer1::ICudaEngine> BuildBackgroundEngine(
+      const BackgroundBuildParams& params,
+      const std::vector<PartialTensorShape>& input_shapes,
+      bool use_implicit_batch, TrtShapeOptimizationProfile* profiles,
+      TRTBaseAllocator* allocator);
+
   // Verify that the input shapes are consistent and can be handled by this op.
   Status VerifyInputShapes(const std::vector<TensorShape>& shapes);
 
@@ -239,6 +285,26 @@ class TRTEngineOp : public AsyncOpKernel {
   // Whether to build TensorRT engines at runtime.
   bool allow_build_at_runtime_;
 
+  // Whether to build the engines for new input shapes in the background, and
+  // to run the native segment until they are built, rather than to build them
+  // in the request. Set by TF_TRT_BUILD_ENGINES_IN_BACKGROUND, and only used in
+  // implicit batch mode without calibration.
+  bool build_engines_in_background_;
+
+  // The number of requests after which the optimization profiles are learned
+  // again from their input shapes, if they did not cover some of them, or 0
+  // to keep the profiles. Set by TF_TRT_PROFILE_REFRESH_INTERVAL, and only used
+  // in explicit batch mode for networks without shape tensors.
+  int64 profile_refresh_interval_;
+
+  // The maximum number of learned profiles, set by TF_TRT_MAX_LEARNED_PROFILES.
+  int64 max_learned_profiles_;
+
+  // The directory that the engines built at runtime are persisted to, and
+  // loaded from before building them, or empty. Set by TF_TRT_ENGINE_CACHE_DIR,
+  // and only used in implicit batch mode.
+  string engine_cache_dir_;
+
   // Whether to allow soft placement when the graph is executed with native
   // TensorFlow.
   bool allow_soft_placement_;
@@ -422,6 +488,20 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
     OP_REQUIRES_OK(context, status);
   }
 
+  OP_REQUIRES_OK(context,
+                 ReadBoolFromEnvVar("TF_TRT_BUILD_ENGINES_IN_BACKGROUND",
+                                    /*default_val=*/false,
+                                    &build_engines_in_background_));
+  OP_REQUIRES_OK(context, ReadInt64FromEnvVar("TF_TRT_PROFILE_REFRESH_INTERVAL",
+                                              /*default_val=*/0,
+                                              &profile_refresh_interval_));
+  OP_REQUIRES_OK(context, ReadInt64FromEnvVar("TF_TRT_MAX_LEARNED_PROFILES",
+                                              /*default_val=*/4,
+                                              &max_learned_profiles_));
+  OP_REQUIRES_OK(context, ReadStringFromEnvVar("TF_TRT_ENGINE_CACHE_DIR",
+                                               /*default_val=*/"",
+                                               &engine_cache_dir_));
+
   status = context->GetAttr("_allow_soft_placement", &allow_soft_placement_);
   if (status.code() == tensorflow::error::NOT_FOUND) {
     allow_soft_placement_ = true;
@@ -765,6 +845,81 @@ static bool AllowEngineNativeSegmentExecution() {
   return value;
 }
 
+// Returns the file in `dir` that persists the engine of `segment_graph_def` for
+// `input_shapes`, or an empty string if the engine can't be identified. The
+// file name is a fingerprint of the segment, of the build parameters, of the
+// GPU and of the TensorRT version, so that an engine is only loaded where it
+// is valid.
+static string GetPersistedEnginePath(
+    const string& dir, const GraphDef& segment_graph_def,
+    TrtPrecisionMode precision_mode, int64 workspace_size,
+    const std::vector<TensorShape>& input_shapes, int gpu_id) {
+  string key;
+  if (dir.empty() || !SerializeToStringDeterministic(segment_graph_def, &key)) {
+    return "";
+  }
+  cudaDeviceProp properties;
+  if (cudaGetDeviceProperties(&properties, gpu_id) != cudaSuccess) {
+    return "";
+  }
+  string precision_name;
+  TrtPrecisionModeToName(precision_mode, &precision_name).IgnoreError();
+  StrAppend(&key, "|", precision_name, "|", workspace_size, "|",
+            TensorShapeUtils::ShapeListString(input_shapes), "|",
+            properties.name, "|", properties.major, ".", properties.minor, "|",
+            getInferLibVersion());
+  return io::JoinPath(
+      dir, StrCat(absl::Hex(Fingerprint64(key), absl::kZeroPad16), ".engine"));
+}
+
+// Returns the engine persisted to `path`, or nullptr if there is none.
+static TrtUniquePtrType<nvinfer1::ICudaEngine> LoadPersistedEngine(
+    const string& path, TRTBaseAllocator* allocator) {
+  string serialized_engine;
+  if (!Env::Default()->FileExists(path).ok() ||
+      !ReadFileToString(Env::Default(), path, &serialized_engine).ok()) {
+    return nullptr;
+  }
+  TrtUniquePtrType<IRuntime> infer(nvinfer1::createInferRuntime(logger));
+  infer->setGpuAllocator(allocator);
+  // Need to initialize plugins in order to deserialize engines that contain
+  // plugins.
+  MaybeInitializeTrtPlugins(&logger);
+  TrtUniquePtrType<nvinfer1::ICudaEngine> engine(infer->deserializeCudaEngine(
+      serialized_engine.data(), serialized_engine.size(), nullptr));
+  if (!engine) {
+    LOG_FIRST_FEW_WARNING_WITH_PREFIX << "Failed to deserialize the engine "
+                                      << "persisted to " << path;
+  } else {
+    VLOG(1) << "Loaded the engine persisted to " << path;
+  }
+  return engine;
+}
+
+// Persists `engine` to `path`. The engine is written to a temporary file that
+// is then renamed, so that no one loads a partially written engine.
+static void PersistEngine(const string& path, nvinfer1::ICudaEngine* engine) {
+  TrtUniquePtrType<nvinfer1::IHostMemory> serialized_engine(
+      engine->serialize());
+  Env* env = Env::Default();
+  const string tmp_path = StrCat(path, ".tmp", env->NowMicros());
+  Status status = env->RecursivelyCreateDir(string(io::Dirname(path)));
+  if (status.ok()) {
+    status = WriteStringToFile(
+        env, tmp_path,
+        StringPiece(static_cast<const char*>(serialized_engine->data()),
+                    serialized_engine->size()));
+  }
+  if (status.ok()) status = env->RenameFile(tmp_path, path);
+  if (!status.ok()) {
+    LOG_FIRST_FEW_WARNING_WITH_PREFIX << "Failed to persist the engine to "
+                                      << path << ": " << status;
+    env->DeleteFile(tmp_path).IgnoreError();
+    return;
+  }
+  VLOG(1) << "Persisted the engine to " << path;
+}
+
 void TRTEngineOp::ComputeAsync(OpKernelContext* ctx,
                                AsyncOpKernel::DoneCallback done) {
   tensorflow::profiler::TraceMe activity(
@@ -1051,6 +1206,115 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
   return engine;
 }
 
+void TRTEngineOp::BuildEngineInBackground(
+    const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+    const string& engine_path, TRTEngineCacheResource* cache_resource,
+    OpKernelContext* ctx) {
+  // The build copies what it uses of the op, since the op may be destroyed
+  // before the build runs. The resource outlives it.
+  auto build = [params = GetBackgroundBuildParams(batch_size, ctx),
+                input_concrete_shapes, engine_path,
+                cache_resource]() -> TrtUniquePtrType<nvinfer1::ICudaEngine> {
+    TrtUniquePtrType<nvinfer1::ICudaEngine> engine = BuildBackgroundEngine(
+        params,
+        std::vector<PartialTensorShape>(input_concrete_shapes.begin(),
+                                        input_concrete_shapes.end()),
+        /*use_implicit_batch=*/true, /*profiles=*/nullptr,
+        cache_resource->allocator_.get());
+    if (engine && !engine_path.empty()) {
+      PersistEngine(engine_path, engine.get());
+    }
+    return engine;
+  };
+  cache_resource->BuildEngineInBackground(input_concrete_shapes,
+                                          std::move(build));
+}
+
+TRTEngineOp::BackgroundBuildParams TRTEngineOp::GetBackgroundBuildParams(
+    int batch_size, OpKernelContext* ctx) {
+  BackgroundBuildParams params;
+  params.segment_graph_def = segment_graph_def_;
+  params.precision_mode = precision_mode_;
+  params.batch_size = batch_size;
+  params.workspace_size = workspace_size_;
+  params.use_explicit_precision = use_explicit_precision_;
+  params.engine_name = name();
+  params.device_name = ctx->device()->name();
+  params.platform_device_id =
+      ctx->device()->tensorflow_accelerator_device_info()->gpu_id;
+  return params;
+}
+
+TrtUniquePtrType<nvinfer1::ICudaEngine> TRTEngineOp::BuildBackgroundEngine(
+    const BackgroundBuildParams& params,
+    const std::vector<PartialTensorShape>& input_shapes,
+    bool use_implicit_batch, TrtShapeOptimizationProfile* profiles,
+    TRTBaseAllocator* allocator) {
+  auto err = cudaSetDevice(params.platform_device_id);
+  if (err != cudaSuccess) {
+    LOG(ERROR) << "Couldn't set cuda device to " << params.platform_device_id
+               << " to build an engine for " << params.engine_name;
+    return nullptr;
+  }
+  std::unordered_map<string, tensorflow::DeviceProperties> device_map;
+  DeviceNameUtils::ParsedName full_parsed_name;
+  DeviceNameUtils::ParseFullName(params.device_name, &full_parsed_name);
+  device_map.emplace(params.device_name,
+                     grappler::GetDeviceInfo(full_parsed_name));
+  tensorflow::grappler::VirtualCluster cluster(device_map);
+
+  TrtUniquePtrType<nvinfer1::ICudaEngine> engine;
+  auto status = convert::ConvertGraphDefToEngine(
+      params.segment_graph_def, params.precision_mode, params.batch_size,
+      params.workspace_size, input_shapes, &logger, allocator,
+      /*calibrator=*/nullptr, &engine, /*use_calibration=*/false,
+      use_implicit_batch, /*convert_successfully=*/nullptr, profiles,
+      params.engine_name, params.use_explicit_precision, &cluster);
+  if (!status.ok()) {
+    LOG_FIRST_FEW_WARNING_WITH_PREFIX
+        << "Engine creation for " << params.engine_name << " failed. "
+        << "The native segment will be used instead. "
+        << "Reason: " << status;
+    return nullptr;
+  }
+  return engine;
+}
+
+void TRTEngineOp::LearnProfiles(
+    const std::vector<TensorShape>& input_concrete_shapes, bool covered,
+    TRTEngineCacheResource* cache_res, OpKernelContext* ctx) {
+  InputShapeHistogram& histogram = cache_res->shape_histogram_;
+  histogram.Add(input_concrete_shapes, covered);
+  if (histogram.num_samples() < profile_refresh_interval_) return;
+  if (histogram.num_uncovered_samples() == 0) {
+    // The profiles still cover the shapes.
+    histogram.Decay();
+    return;
+  }
+  // Starts from the current profiles, which know the shape tensors and the
+  // pruned inputs of the network.
+  TrtShapeOptimizationProfile profiles = cache_res->profiles_;
+  Status status = profiles.InitProfilesFromHistogram(
+      input_partial_shapes_, histogram.MostFrequent(kMaxLearnedProfileShapes),
+      max_learned_profiles_);
+  histogram.Decay();
+  if (!status.ok()) {
+    LOG_FIRST_FEW_WARNING_WITH_PREFIX << "Failed to learn profiles for "
+                                      << name() << ": " << status;
+    return;
+  }
+  auto build = [params = GetBackgroundBuildParams(
+                    input_concrete_shapes[0].dim_size(0), ctx),
+                input_partial_shapes = input_partial_shapes_, cache_res](
+                   TrtShapeOptimizationProfile* profiles) {
+    return BuildBackgroundEngine(params, input_partial_shapes,
+                                 /*use_implicit_batch=*/false, profiles,
+                                 cache_res->allocator_.get());
+  };
+  cache_res->RebuildEngineInBackground(input_concrete_shapes,
+                                       std::move(profiles), std::move(build));
+}
+
 StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
     const std::vector<TensorShape>& input_concrete_shapes, OpKernelContext* ctx,
     TRTEngineCacheResource* cache_res) {
@@ -1171,9 +1435,15 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
                                           0);
   }  // static_engine_
 
+  cache_res->AddBuiltEngines();
   int profile_id = -1;
   if (!use_implicit_batch_) {
     profile_id = cache_res->profiles_.GetProfileNumber(input_concrete_shapes);
+    if (profile_refresh_interval_ > 0 && cache.size() > 0 &&
+        !cache_res->profiles_.HasShapeTensor()) {
+      LearnProfiles(input_concrete_shapes, /*covered=*/profile_id != -1,
+                    cache_res, ctx);
+    }
     // Since all profiles are already created at this point, finding no
     // compatible profiles results in falling back to native TF.
     if (profile_id == -1) {
@@ -1202,16 +1472,39 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
 
-    // Up to this point, calibrator_ can never be empty, since otherwise it
-    // means calibration_mode_ is true and this path won't get executed.
-    auto result =
-        BuildEngine(input_concrete_shapes, batch_size, use_calibration_,
-                    calibrator_.get(), cache_res, ctx);
-    if (!result.ok()) {
+    TrtUniquePtrType<nvinfer1::ICudaEngine> engine;
+    // Engines built with calibration data depend on more than the segment and
+    // the build parameters, so they are not persisted.
+    const bool calibrated =
+        precision_mode_ == TrtPrecisionMode::INT8 && use_calibration_;
+    string engine_path;
+    if (use_implicit_batch_ && !calibrated) {
+      engine_path = GetPersistedEnginePath(
+          engine_cache_dir_, segment_graph_def_, precision_mode_,
+          workspace_size_, input_concrete_shapes,
+          ctx->device()->tensorflow_accelerator_device_info()->gpu_id);
+    }
+    if (!engine_path.empty()) {
+      engine = LoadPersistedEngine(engine_path, allocator);
+    }
+    if (!engine && use_implicit_batch_ && !calibrated &&
+        build_engines_in_background_) {
+      BuildEngineInBackground(input_concrete_shapes, batch_size, engine_path,
+                              cache_res, ctx);
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
-    TrtUniquePtrType<nvinfer1::ICudaEngine> engine =
-        std::move(result.ValueOrDie());
+    if (!engine) {
+      // Up to this point, calibrator_ can never be empty, since otherwise it
+      // means calibration_mode_ is true and this path won't get executed.
+      auto result =
+          BuildEngine(input_concrete_shapes, batch_size, use_calibration_,
+                      calibrator_.get(), cache_res, ctx);
+      if (!result.ok()) {
+        return std::pair<EngineContext*, int>(&empty_context, 0);
+      }
+      engine = std::move(result.ValueOrDie());
+      if (!engine_path.empty()) PersistEngine(engine_path, engine.get());
+    }
     std::vector<ExecutionContext> exec_contexts;
     TF_RETURN_IF_ERROR(cache_res->profiles_.CreateExecutionContexts(
         engine.get(), &exec_contexts));
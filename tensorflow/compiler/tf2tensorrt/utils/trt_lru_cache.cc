@@ -17,10 +17,12 @@ limitations under the License.
 
 #include <sstream>
 
+#include "absl/memory/memory.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_allocator.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 
 #if GOOGLE_CUDA && GOOGLE_TENSORRT
@@ -119,6 +121,98 @@ EngineContext* TRTEngineCacheResource::GetEngineContext(
   return engine_context;
 }
 
+void TRTEngineCacheResource::BuildEngineInBackground(
+    const std::vector<TensorShape>& input_shapes, EngineBuilder build) {
+  mutex_lock lock(build_mu_);
+  if (!pending_builds_.insert(input_shapes).second) return;
+  VLOG(1) << "Building an engine in the background for input shapes "
+          << TensorShapeUtils::ShapeListString(input_shapes);
+  GetBuildThreadPool()->Schedule([this, input_shapes, build]() {
+    TrtUniquePtrType<nvinfer1::ICudaEngine> engine = build();
+    mutex_lock lock(build_mu_);
+    pending_builds_.erase(input_shapes);
+    built_engines_.emplace_back(input_shapes, std::move(engine));
+  });
+}
+
+void TRTEngineCacheResource::RebuildEngineInBackground(
+    const std::vector<TensorShape>& input_shapes,
+    TrtShapeOptimizationProfile profiles, ProfileEngineBuilder build) {
+  mutex_lock lock(build_mu_);
+  if (rebuild_pending_) return;
+  rebuild_pending_ = true;
+  VLOG(1) << "Building an engine in the background for "
+          << profiles.GetNumProfiles() << " new profiles";
+  // Shared, since the closure of Schedule() must be copyable.
+  auto shared_profiles =
+      std::make_shared<TrtShapeOptimizationProfile>(std::move(profiles));
+  GetBuildThreadPool()->Schedule([this, input_shapes, shared_profiles,
+                                  build]() {
+    TrtUniquePtrType<nvinfer1::ICudaEngine> engine =
+        build(shared_profiles.get());
+    mutex_lock lock(build_mu_);
+    rebuild_pending_ = false;
+    if (!engine) return;
+    rebuilt_input_shapes_ = input_shapes;
+    rebuilt_profiles_ = absl::make_unique<TrtShapeOptimizationProfile>(
+        std::move(*shared_profiles));
+    rebuilt_engine_ = std::move(engine);
+  });
+}
+
+thread::ThreadPool* TRTEngineCacheResource::GetBuildThreadPool() {
+  if (!build_thread_pool_) {
+    // Engines are built one at a time, since each build can use all the memory
+    // of the GPU.
+    build_thread_pool_ = absl::make_unique<thread::ThreadPool>(
+        Env::Default(), "tf_trt_engine_build", /*num_threads=*/1);
+  }
+  return build_thread_pool_.get();
+}
+
+void TRTEngineCacheResource::AddBuiltEngines() {
+  mutex_lock lock(build_mu_);
+  if (rebuilt_engine_) {
+    std::vector<ExecutionContext> exec_contexts;
+    Status status = rebuilt_profiles_->CreateExecutionContexts(
+        rebuilt_engine_.get(), &exec_contexts);
+    if (status.ok()) {
+      retired_engines_.clear();
+      for (auto& item : cache_) {
+        retired_engines_.push_back(std::move(item.second));
+      }
+      cache_.clear();
+      cache_.emplace(rebuilt_input_shapes_,
+                     absl::make_unique<EngineContext>(
+                         std::move(rebuilt_engine_), std::move(exec_contexts)));
+      profiles_ = std::move(*rebuilt_profiles_);
+      VLOG(1) << "Replaced the engine with one for "
+              << profiles_.GetNumProfiles() << " new profiles";
+    } else {
+      LOG(WARNING) << "Failed to create the execution contexts of the engine "
+                   << "rebuilt for new profiles: " << status;
+    }
+    rebuilt_engine_.reset();
+    rebuilt_profiles_.reset();
+  }
+  for (auto& built_engine : built_engines_) {
+    if (!built_engine.second) {
+      // Store an empty engine so that the same failing engine is not built
+      // again.
+      cache_.emplace(built_engine.first, absl::make_unique<EngineContext>());
+      continue;
+    }
+    ExecutionContext context =
+        ExecutionContext::Create(built_engine.second.get());
+    cache_.emplace(built_engine.first,
+                   absl::make_unique<EngineContext>(
+                       std::move(built_engine.second), std::move(context)));
+    VLOG(1) << "Added an engine built in the background to the cache. "
+            << "Cache size: " << cache_.size();
+  }
+  built_engines_.clear();
+}
+
 EngineContext* TRTEngineCacheResource::GetEngineContext(const int profile_id) {
   if (profiles_.NeedProfiles() && profile_id >= profiles_.GetNumProfiles()) {
     LOG(ERROR) << "Out of range: profile_id " << profile_id
@@ -16,9 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_LRU_CACHE_H_
 #define TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_LRU_CACHE_H_
 
+#include <functional>
 #include <list>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/compiler/tf2tensorrt/convert/utils.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_allocator.h"
@@ -28,6 +32,8 @@ limitations under the License.
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_shape_optimization_profiles.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 #if GOOGLE_CUDA && GOOGLE_TENSORRT
 #include "third_party/tensorrt/NvInfer.h"
@@ -68,6 +74,11 @@ class LRUCache {
   iterator begin() { return objects_.begin(); }
   iterator end() { return objects_.end(); }
 
+  void clear() {
+    objects_.clear();
+    keys_.clear();
+  }
+
   template <typename... Args>
   std::pair<iterator, bool> emplace(Args&&... args) {
     DiscardOld(1);
@@ -217,6 +228,37 @@ class TRTEngineCacheResource : public ResourceBase {
   // Returns nullptr if no compatible EngineContexts is found in cache.
   EngineContext* GetEngineContext(const int profile_id);
 
+  using EngineBuilder =
+      std::function<TrtUniquePtrType<nvinfer1::ICudaEngine>()>;
+
+  // Runs `build` on a background thread to create the engine for
+  // input_shapes, unless such an engine is already being built. The engine is
+  // added to cache_ by the first AddBuiltEngines() call after it is built, or
+  // an empty engine if `build` returns nullptr. `build` must not use the op
+  // that schedules it, which may be destroyed before it runs.
+  void BuildEngineInBackground(const std::vector<TensorShape>& input_shapes,
+                               EngineBuilder build);
+
+  using ProfileEngineBuilder =
+      std::function<TrtUniquePtrType<nvinfer1::ICudaEngine>(
+          TrtShapeOptimizationProfile* profiles)>;
+
+  // For explicit batch mode: runs `build` on a background thread to create an
+  // engine for the optimization profiles `profiles`, unless such an engine is
+  // already being built. The first AddBuiltEngines() call after it is built
+  // replaces the engine in cache_, under the key `input_shapes`, and
+  // profiles_ with them. The replaced engine is kept alive until the next
+  // replacement for the requests that may still execute it. `build` gets the
+  // profiles to configure the builder with, and must not use the op that
+  // schedules it.
+  void RebuildEngineInBackground(const std::vector<TensorShape>& input_shapes,
+                                 TrtShapeOptimizationProfile profiles,
+                                 ProfileEngineBuilder build);
+
+  // Adds the engines built in the background since the last call to cache_.
+  // Must be called under the same lock as the other accesses to cache_.
+  void AddBuiltEngines();
+
   // Keep device allocator for TRT.
   std::unique_ptr<TRTBaseAllocator> allocator_;
 
@@ -233,6 +275,41 @@ class TRTEngineCacheResource : public ResourceBase {
   // generation and engine build. During runtime the list of profiles is used to
   // look up a matching profile for the input data.
   TrtShapeOptimizationProfile profiles_;
+
+  // The input shapes that the profiles are learned from at runtime, guarded
+  // by the same lock as cache_.
+  InputShapeHistogram shape_histogram_;
+
+ private:
+  // Returns the thread that builds the engines in the background.
+  thread::ThreadPool* GetBuildThreadPool()
+      TF_EXCLUSIVE_LOCKS_REQUIRED(build_mu_);
+
+  // The engines replaced by the last rebuild, guarded by the same lock as
+  // cache_.
+  std::vector<std::unique_ptr<EngineContext>> retired_engines_;
+
+  mutex build_mu_;
+  // The input shapes of the engines that are being built in the background.
+  std::unordered_set<std::vector<TensorShape>, VectorTensorShapeHasher>
+      pending_builds_ TF_GUARDED_BY(build_mu_);
+  // The engines built in the background, not yet added to cache_.
+  std::vector<std::pair<std::vector<TensorShape>,
+                        TrtUniquePtrType<nvinfer1::ICudaEngine>>>
+      built_engines_ TF_GUARDED_BY(build_mu_);
+  // Whether an engine for new profiles is being built in the background.
+  bool rebuild_pending_ TF_GUARDED_BY(build_mu_) = false;
+  // The engine rebuilt in the background with its profiles, and the key to add
+  // it to cache_ under.
+  std::vector<TensorShape> rebuilt_input_shapes_ TF_GUARDED_BY(build_mu_);
+  std::unique_ptr<TrtShapeOptimizationProfile> rebuilt_profiles_
+      TF_GUARDED_BY(build_mu_);
+  TrtUniquePtrType<nvinfer1::ICudaEngine> rebuilt_engine_
+      TF_GUARDED_BY(build_mu_);
+  // Declared last so that it is destroyed first, which waits for the pending
+  // builds while the rest of the resource is still alive.
+  std::unique_ptr<thread::ThreadPool> build_thread_pool_
+      TF_GUARDED_BY(build_mu_);
 };
 
 #endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
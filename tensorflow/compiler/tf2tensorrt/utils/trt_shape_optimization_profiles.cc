@@ -123,6 +123,90 @@ Status TrtShapeOptimizationProfile::RangeStrategy(
   return Status::OK();
 }
 
+// Returns the number of elements of the input tensors of `shapes`.
+int64 NumElements(const std::vector<nvinfer1::Dims>& shapes) {
+  int64 num_elements = 0;
+  for (const nvinfer1::Dims& dims : shapes) {
+    if (dims.nbDims == 0) continue;
+    int64 tensor_elements = 1;
+    for (int i = 0; i < dims.nbDims; i++) tensor_elements *= dims.d[i];
+    num_elements += tensor_elements;
+  }
+  return num_elements;
+}
+
+Status TrtShapeOptimizationProfile::CoveringStrategy(
+    const std::vector<std::vector<nvinfer1::Dims>>& collected_shapes,
+    const std::vector<int64>& counts, int max_profiles) {
+  // A range of shapes, and the shapes that it covers.
+  struct ShapeRange {
+    std::vector<nvinfer1::Dims> min;
+    std::vector<nvinfer1::Dims> max;
+    std::vector<int> shapes;
+  };
+  auto padding = [&](const ShapeRange& range) {
+    const int64 max_elements = NumElements(range.max);
+    int64 result = 0;
+    for (int shape : range.shapes) {
+      result +=
+          counts[shape] * (max_elements - NumElements(collected_shapes[shape]));
+    }
+    return result;
+  };
+  auto merge = [](const ShapeRange& x, const ShapeRange& y,
+                  ShapeRange* merged) -> Status {
+    *merged = x;
+    TF_RETURN_IF_ERROR(ShapeProfileBinaryOp(
+        &merged->min, y.min, [](int a, int b) { return std::min(a, b); }));
+    TF_RETURN_IF_ERROR(ShapeProfileBinaryOp(
+        &merged->max, y.max, [](int a, int b) { return std::max(a, b); }));
+    merged->shapes.insert(merged->shapes.end(), y.shapes.begin(),
+                          y.shapes.end());
+    return Status::OK();
+  };
+
+  // Starts with a range for each shape, and merges the two ranges whose merge
+  // adds the least padding until there are at most max_profiles of them.
+  std::vector<ShapeRange> ranges;
+  std::vector<int64> paddings;
+  for (int i = 0; i < collected_shapes.size(); i++) {
+    ranges.push_back({collected_shapes[i], collected_shapes[i], {i}});
+    paddings.push_back(0);
+  }
+  while (ranges.size() > static_cast<size_t>(std::max(max_profiles, 1))) {
+    int best_x = -1;
+    int best_y = -1;
+    int64 best_added_padding = 0;
+    ShapeRange best_merged;
+    for (int x = 0; x < ranges.size(); x++) {
+      for (int y = x + 1; y < ranges.size(); y++) {
+        ShapeRange merged;
+        TF_RETURN_IF_ERROR(merge(ranges[x], ranges[y], &merged));
+        const int64 added_padding =
+            padding(merged) - paddings[x] - paddings[y];
+        if (best_x == -1 || added_padding < best_added_padding) {
+          best_x = x;
+          best_y = y;
+          best_added_padding = added_padding;
+          best_merged = std::move(merged);
+        }
+      }
+    }
+    paddings[best_x] += paddings[best_y] + best_added_padding;
+    ranges[best_x] = std::move(best_merged);
+    ranges.erase(ranges.begin() + best_y);
+    paddings.erase(paddings.begin() + best_y);
+  }
+  for (ShapeRange& range : ranges) {
+    VLOG(2) << "Initializing optimization profile config with min="
+            << DebugString(range.min) << ", opt=max=" << DebugString(range.max)
+            << " covering " << range.shapes.size() << " shapes";
+    OptimizationProfileConfig profConfig{range.min, range.max, range.max};
+    profiles_.push_back(std::move(profConfig));
+  }
+  return Status::OK();
+}
+
 void TrtShapeOptimizationProfile::OptimalStrategy(
     const std::vector<std::vector<nvinfer1::Dims>>& collected_shapes) {
   for (auto& shape_vec : collected_shapes) {
@@ -300,6 +384,40 @@ void TrtShapeOptimizationProfile::InitProfiles(
       OptimalStrategy(collected_shapes);
       break;
   }
+  MakeProfilesCompatible(input_partial_shapes);
+}
+
+Status TrtShapeOptimizationProfile::InitProfilesFromHistogram(
+    const std::vector<PartialTensorShape>& input_partial_shapes,
+    const std::vector<std::pair<std::vector<TensorShape>, int64>>&
+        shape_counts,
+    int max_profiles) {
+  strategy_ = ProfileStrategy::kRange;
+  input_shapes_.clear();
+  input_shape_values_.clear();
+  profiles_.clear();
+  std::vector<std::vector<nvinfer1::Dims>> collected_shapes;
+  std::vector<int64> counts;
+  for (const auto& shape_count : shape_counts) {
+    const std::vector<TensorShape>& shape_vec = shape_count.first;
+    // There are no shape values, so they are all empty.
+    std::vector<nvinfer1::Dims> shape_values(shape_vec.size(), {0, {}});
+    std::vector<nvinfer1::Dims> dimvec = GetDimVec(shape_vec);
+    dimvec.insert(dimvec.end(), shape_values.begin(), shape_values.end());
+    input_shapes_.push_back(shape_vec);
+    input_shape_values_.push_back(std::move(shape_values));
+    collected_shapes.push_back(std::move(dimvec));
+    counts.push_back(shape_count.second);
+  }
+  VLOG(1) << "Creating at most " << max_profiles << " profiles for "
+          << collected_shapes.size() << " shapes";
+  TF_RETURN_IF_ERROR(CoveringStrategy(collected_shapes, counts, max_profiles));
+  MakeProfilesCompatible(input_partial_shapes);
+  return Status::OK();
+}
+
+void TrtShapeOptimizationProfile::MakeProfilesCompatible(
+    const std::vector<PartialTensorShape>& input_partial_shapes) {
   // Define a mask that describe which input could be a shape tensor. Note
   // that here we can have false positives. The shape tensor mask will be
   // updated once the network is constructed.
@@ -589,6 +707,42 @@ int TrtShapeOptimizationProfile::GetNumProfiles() const {
   return profiles_.size();
 }
 
+void InputShapeHistogram::Add(const std::vector<TensorShape>& shapes,
+                              bool covered) {
+  ++counts_[shapes];
+  ++num_samples_;
+  if (!covered) ++num_uncovered_samples_;
+}
+
+std::vector<std::pair<std::vector<TensorShape>, int64>>
+InputShapeHistogram::MostFrequent(int max_shapes) const {
+  std::vector<std::pair<std::vector<TensorShape>, int64>> shape_counts(
+      counts_.begin(), counts_.end());
+  // Sorts by shape among equal counts, so that the result is deterministic.
+  std::sort(shape_counts.begin(), shape_counts.end(),
+            [](const std::pair<std::vector<TensorShape>, int64>& a,
+               const std::pair<std::vector<TensorShape>, int64>& b) {
+              if (a.second != b.second) return a.second > b.second;
+              return TensorShapeUtils::ShapeListString(a.first) <
+                     TensorShapeUtils::ShapeListString(b.first);
+            });
+  if (shape_counts.size() > max_shapes) shape_counts.resize(max_shapes);
+  return shape_counts;
+}
+
+void InputShapeHistogram::Decay() {
+  for (auto it = counts_.begin(); it != counts_.end();) {
+    it->second /= 2;
+    if (it->second == 0) {
+      counts_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  num_samples_ = 0;
+  num_uncovered_samples_ = 0;
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
 #endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
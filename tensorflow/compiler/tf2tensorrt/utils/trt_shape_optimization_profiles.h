@@ -18,7 +18,9 @@ limitations under the License.
 
 #include <list>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/compiler/tf2tensorrt/common/datavec.h"
@@ -169,6 +171,34 @@ struct OptimizationProfileConfig {
   }
 };
 
+// Counts how often a TRTEngineOp runs with each input shape, to learn the
+// optimization profiles that cover them at runtime. Decay() halves the counts,
+// so that profiles learned after it follow the drift of the shapes. Not thread
+// safe.
+class InputShapeHistogram {
+ public:
+  // Counts `shapes`, which the current profiles `covered` or not.
+  void Add(const std::vector<TensorShape>& shapes, bool covered);
+
+  // The shapes counted since the last Decay().
+  int64 num_samples() const { return num_samples_; }
+  int64 num_uncovered_samples() const { return num_uncovered_samples_; }
+
+  // Returns the `max_shapes` most frequent shapes and their counts.
+  std::vector<std::pair<std::vector<TensorShape>, int64>> MostFrequent(
+      int max_shapes) const;
+
+  // Halves the counts, dropping the shapes whose count reaches 0, and resets
+  // the number of samples.
+  void Decay();
+
+ private:
+  std::unordered_map<std::vector<TensorShape>, int64, VectorTensorShapeHasher>
+      counts_;
+  int64 num_samples_ = 0;
+  int64 num_uncovered_samples_ = 0;
+};
+
 // Manages Optimization profiles during TRT Engine construction.
 //
 // An optimization profile describes a range of dimensions for each TRT network
@@ -224,6 +254,18 @@ class TrtShapeOptimizationProfile {
   void InitProfiles(const std::vector<PartialTensorShape>& input_partial_shapes,
                     ProfileStrategy strategy);
 
+  // Creates at most `max_profiles` optimization profiles that cover the input
+  // shapes of `shape_counts`, for a network without shape tensors. Like the
+  // Range strategy, each profile is a range that is optimized for its maximum.
+  // The shapes are grouped into ranges that minimize the padding, which is the
+  // number of elements that the inputs of each shape lack relative to the
+  // maximum of its range, weighted by the count of the shape.
+  Status InitProfilesFromHistogram(
+      const std::vector<PartialTensorShape>& input_partial_shapes,
+      const std::vector<std::pair<std::vector<TensorShape>, int64>>&
+          shape_counts,
+      int max_profiles);
+
   // Returns number of created profiles.
   int GetNumProfiles() const;
 
@@ -298,6 +340,13 @@ class TrtShapeOptimizationProfile {
       const std::vector<std::vector<nvinfer1::Dims>>& collected_shapes);
   Status RangeStrategy(
       const std::vector<std::vector<nvinfer1::Dims>>& collected_shapes);
+  Status CoveringStrategy(
+      const std::vector<std::vector<nvinfer1::Dims>>& collected_shapes,
+      const std::vector<int64>& counts, int max_profiles);
+
+  // Makes profiles_ compatible with the network inputs.
+  void MakeProfilesCompatible(
+      const std::vector<PartialTensorShape>& input_partial_shapes);
 };
 
 }  // namespace tensorrt
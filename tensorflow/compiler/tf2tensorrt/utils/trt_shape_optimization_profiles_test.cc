@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <string.h>
 
+#include <algorithm>
+#include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -25,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "third_party/tensorrt/NvInfer.h"
 
@@ -245,6 +248,48 @@ TEST_P(TrtShapeOptimizationProfileTest, Dynamic) {
   CheckProfile(unseen_shapes, &profile, has_prof, false);
 }
 
+TEST(InputShapeHistogramTest, CountsAndDecays) {
+  InputShapeHistogram histogram;
+  const std::vector<TensorShape> small = {TensorShape({1, 8})};
+  const std::vector<TensorShape> large = {TensorShape({4, 8})};
+  for (int i = 0; i < 3; i++) histogram.Add(small, /*covered=*/true);
+  histogram.Add(large, /*covered=*/false);
+  EXPECT_EQ(histogram.num_samples(), 4);
+  EXPECT_EQ(histogram.num_uncovered_samples(), 1);
+
+  auto shape_counts = histogram.MostFrequent(/*max_shapes=*/2);
+  ASSERT_EQ(shape_counts.size(), 2);
+  EXPECT_EQ(shape_counts[0].first, small);
+  EXPECT_EQ(shape_counts[0].second, 3);
+  EXPECT_EQ(shape_counts[1].first, large);
+  EXPECT_EQ(shape_counts[1].second, 1);
+  EXPECT_EQ(histogram.MostFrequent(/*max_shapes=*/1).size(), 1);
+
+  histogram.Decay();
+  EXPECT_EQ(histogram.num_samples(), 0);
+  EXPECT_EQ(histogram.num_uncovered_samples(), 0);
+  shape_counts = histogram.MostFrequent(/*max_shapes=*/2);
+  ASSERT_EQ(shape_counts.size(), 1);
+  EXPECT_EQ(shape_counts[0].first, small);
+  EXPECT_EQ(shape_counts[0].second, 1);
+}
+
+TEST(TrtShapeOptimizationProfileHistogramTest, LimitsNumberOfProfiles) {
+  std::vector<std::pair<std::vector<TensorShape>, int64>> shape_counts;
+  for (int batch_size = 1; batch_size <= 8; batch_size++) {
+    shape_counts.push_back({{TensorShape({batch_size, 16})}, batch_size});
+  }
+  const std::vector<PartialTensorShape> input_partial_shapes = {
+      PartialTensorShape({-1, 16})};
+  for (int max_profiles : {1, 3, 8, 10}) {
+    TrtShapeOptimizationProfile profile;
+    TF_ASSERT_OK(profile.InitProfilesFromHistogram(
+        input_partial_shapes, shape_counts, max_profiles));
+    EXPECT_EQ(profile.GetNumProfiles(), std::min(max_profiles, 8));
+    EXPECT_FALSE(profile.IsStaticCompatible());
+  }
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
 
@@ -0,0 +1,55 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/tf2xla/xla_aot_function_registry.h"
+
+#include <unordered_map>
+#include <utility>
+
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace {
+
+struct Registry {
+  mutex mu;
+  // Values are never erased, so pointers to them stay valid.
+  std::unordered_map<std::string, XlaAotFunctionRegistry::Factory> factories
+      TF_GUARDED_BY(mu);
+};
+
+Registry& GetRegistry() {
+  static Registry* registry = new Registry;
+  return *registry;
+}
+
+}  // namespace
+
+/*static*/ void XlaAotFunctionRegistry::Register(const std::string& cpp_class,
+                                                 Factory factory) {
+  Registry& registry = GetRegistry();
+  mutex_lock lock(registry.mu);
+  registry.factories.emplace(cpp_class, std::move(factory));
+}
+
+/*static*/ const XlaAotFunctionRegistry::Factory*
+XlaAotFunctionRegistry::Lookup(const std::string& cpp_class) {
+  Registry& registry = GetRegistry();
+  mutex_lock lock(registry.mu);
+  auto it = registry.factories.find(cpp_class);
+  return it == registry.factories.end() ? nullptr : &it->second;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,80 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_TF2XLA_XLA_AOT_FUNCTION_REGISTRY_H_
+#define TENSORFLOW_COMPILER_TF2XLA_XLA_AOT_FUNCTION_REGISTRY_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "tensorflow/compiler/tf2xla/xla_compiled_cpu_function.h"
+
+namespace tensorflow {
+
+// Maps the fully qualified name of a tfcompile-generated class to a factory
+// for it. The SavedModel loader uses this to materialize ahead-of-time
+// compiled signatures whose code has been linked into the serving binary; the
+// object files stored in the SavedModel cannot be loaded at runtime.
+class XlaAotFunctionRegistry {
+ public:
+  using Factory = std::function<std::unique_ptr<XlaCompiledCpuFunction>()>;
+
+  // Registers `factory` under `cpp_class`. Registering the same class twice
+  // keeps the first registration.
+  static void Register(const std::string& cpp_class, Factory factory);
+
+  // Returns the factory registered for `cpp_class`, or nullptr if the class is
+  // not linked in. The returned pointer is valid for the process lifetime.
+  static const Factory* Lookup(const std::string& cpp_class);
+};
+
+namespace xla_aot_function_registry {
+class XlaAotFunctionRegistrar {
+ public:
+  XlaAotFunctionRegistrar(const std::string& cpp_class,
+                          XlaAotFunctionRegistry::Factory factory) {
+    XlaAotFunctionRegistry::Register(cpp_class, std::move(factory));
+  }
+};
+}  // namespace xla_aot_function_registry
+
+// REGISTER_XLA_AOT_FUNCTION(CLASS) registers a tfcompile-generated class so
+// that LoadSavedModel can attach it to the matching AotCompiledSignature, for
+// example:
+//
+//   REGISTER_XLA_AOT_FUNCTION(foo::bar::MyModel);
+//
+// CLASS must be spelled exactly as the cpp_class passed to saved_model_cli,
+// without a leading "::".
+#define REGISTER_XLA_AOT_FUNCTION(CLASS) \
+  REGISTER_XLA_AOT_FUNCTION_UNIQ_HELPER(__COUNTER__, CLASS)
+
+#define REGISTER_XLA_AOT_FUNCTION_UNIQ_HELPER(CTR, CLASS) \
+  REGISTER_XLA_AOT_FUNCTION_UNIQ(CTR, CLASS)
+
+#define REGISTER_XLA_AOT_FUNCTION_UNIQ(CTR, CLASS)                        \
+  static ::tensorflow::xla_aot_function_registry::XlaAotFunctionRegistrar \
+      xla_aot_function_registrar__body__##CTR##__object(                  \
+          #CLASS,                                                         \
+          []() -> std::unique_ptr<::tensorflow::XlaCompiledCpuFunction> { \
+            return std::make_unique<CLASS>(                               \
+                ::tensorflow::XlaCompiledCpuFunction::AllocMode::        \
+                    ARGS_VARIABLES_RESULTS_PROFILES_AND_TEMPS);           \
+          });
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_TF2XLA_XLA_AOT_FUNCTION_REGISTRY_H_
@@ -654,6 +654,62 @@ static void AllocateFlags() {
       flag_values->xla_gpu_force_compilation_parallelism(),
       "Overrides normal multi-threaded compilation settting to use this many "
       "threads. Setting to 0 (the default value) means no enforcement."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_hlo_pass_threads",
+      int32_setter_for(&DebugOptions::set_xla_hlo_pass_threads),
+      flag_values->xla_hlo_pass_threads(),
+      "Number of threads used to run computation-local HLO passes, such as "
+      "the algebraic simplifier, over independent computations concurrently. "
+      "0 or 1 (the default) runs them sequentially."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_auto_sharding",
+      bool_setter_for(&DebugOptions::set_xla_gpu_auto_sharding),
+      flag_values->xla_gpu_auto_sharding(),
+      "Pick shardings for unannotated dots and convolutions before sharding "
+      "propagation when partitioning with SPMD on GPU."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_auto_sharding_memory_limit_bytes",
+      int64_setter_for(
+          &DebugOptions::set_xla_gpu_auto_sharding_memory_limit_bytes),
+      flag_values->xla_gpu_auto_sharding_memory_limit_bytes(),
+      "Per-device memory budget in bytes for --xla_gpu_auto_sharding. 0 (the "
+      "default) means unlimited."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_enable_cuda_graphs",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_cuda_graphs),
+      flag_values->xla_gpu_enable_cuda_graphs(),
+      "Record runs of consecutive kernel, GEMM, memset and copy thunks into "
+      "CUDA graphs on the second execution of an executable, and replay them "
+      "afterwards. Only applies to single-stream thunk schedules."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_autotune_results_path",
+      string_setter_for(&DebugOptions::set_xla_gpu_autotune_results_path),
+      flag_values->xla_gpu_autotune_results_path(),
+      "A file of GEMM and convolution autotuning results. Results are loaded "
+      "from it on first use and new results are merged back after each "
+      "autotuning pass."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_host_offload_memory_budget_bytes",
+      int64_setter_for(
+          &DebugOptions::set_xla_gpu_host_offload_memory_budget_bytes),
+      flag_values->xla_gpu_host_offload_memory_budget_bytes(),
+      "Device memory budget in bytes for offloading long-lived activations to "
+      "pinned host memory on GPU. 0 (the default) disables offloading."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_enable_latency_hiding_scheduler",
+      bool_setter_for(
+          &DebugOptions::set_xla_gpu_enable_latency_hiding_scheduler),
+      flag_values->xla_gpu_enable_latency_hiding_scheduler(),
+      "Schedule compute that is independent of in-flight asynchronous "
+      "all-reduces ahead of their all-reduce-done, based on a cost model of "
+      "compute and collective bandwidth. Use together with "
+      "--xla_gpu_enable_async_all_reduce."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_enable_fused_attention",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_fused_attention),
+      flag_values->xla_gpu_enable_fused_attention(),
+      "Rewrite softmax(Q * K^T) * V attention blocks into a single fused "
+      "kernel that does not materialize the attention scores."));
   flag_objects->push_back(tensorflow::Flag(
       "xla_gpu_deterministic_ops",
       bool_setter_for(&DebugOptions::set_xla_gpu_deterministic_ops),
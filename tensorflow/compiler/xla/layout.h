@@ -211,6 +211,8 @@ class Layout {
   }
   static constexpr int64_t kDefaultMemorySpace = 0;
   static constexpr int64_t kGenericFastMemorySpace = 1;
+  // Pinned host memory that the device can access directly.
+  static constexpr int64_t kHostMemorySpace = 5;
   int64_t memory_space() const { return memory_space_; }
   Layout& set_memory_space(int64_t value) {
     memory_space_ = value;
@@ -50,6 +50,12 @@ LocalDeviceState::LocalDeviceState(se::StreamExecutor* executor,
     callback_stream_map_ =
         absl::flat_hash_map<se::Stream*, std::unique_ptr<se::Stream>>();
   }
+  host_to_device_streams_.reserve(kNumHostToDeviceStreams);
+  for (int i = 0; i < kNumHostToDeviceStreams; ++i) {
+    auto stream = std::make_unique<se::Stream>(executor);
+    stream->Init();
+    host_to_device_streams_.push_back(std::move(stream));
+  }
   device_to_host_streams_.reserve(kNumDeviceToHostStreams);
   for (int i = 0; i < kNumDeviceToHostStreams; ++i) {
     auto stream = std::make_unique<se::Stream>(executor);
@@ -126,6 +132,14 @@ void LocalDeviceState::ThenExecuteCallback(se::Stream* stream,
   });
 }
 
+se::Stream* LocalDeviceState::GetHostToDeviceStream() {
+  absl::MutexLock lock(&mu_);
+  int i = next_host_to_device_stream_;
+  next_host_to_device_stream_ =
+      (next_host_to_device_stream_ + 1) % host_to_device_streams_.size();
+  return host_to_device_streams_.at(i).get();
+}
+
 se::Stream* LocalDeviceState::GetDeviceToHostStream() {
   absl::MutexLock lock(&mu_);
   int i = next_device_to_host_stream_;
@@ -623,6 +623,10 @@ StatusOr<Shape> PjRtStreamExecutorBuffer::logical_on_device_shape() {
 
 namespace {
 
+// The size of the chunks that large staged host to device transfers are split
+// into.
+constexpr int64_t kHostToDeviceTransferChunkBytes = 4 << 20;
+
 // Implements PjRtBuffer::ExternalReference as a wrapped
 // ScopedHold::kExternalReference.
 class ScopedHoldAsExternalReference : public PjRtBuffer::ExternalReference {
@@ -773,10 +777,12 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
     }
   }
 
+  // Transfers are spread over several streams, so that the transfers of
+  // several buffers overlap.
+  se::Stream* h2d_stream = local_device->GetHostToDeviceStream();
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<PjRtStreamExecutorBuffer> py_buffer,
-      AllocateDestinationBuffer(compact_shape, device, local_device,
-                                local_device->host_to_device_stream(),
+      AllocateDestinationBuffer(compact_shape, device, local_device, h2d_stream,
                                 /*is_uninitialized_create=*/false, this));
 
   PjRtStreamExecutorBuffer::ScopedHold device_buffer(
@@ -825,6 +831,20 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
     }
   }
 
+  // A large dense array that is staged on the transfer thread is copied to
+  // the staging buffer in chunks, each of which is transferred as soon as it
+  // is staged, so that the transfer overlaps with the staging copy. The
+  // transfer manager is bypassed, which is only valid if the device buffer is
+  // a copy of the staging buffer.
+  const bool transfer_in_chunks =
+      staging_buffer != nullptr && !transpose &&
+      host_buffer_semantics !=
+          HostBufferSemantics::kImmutableOnlyDuringCall &&
+      should_stage_host_to_device_transfers() &&
+      size > kHostToDeviceTransferChunkBytes &&
+      transfer_manager->GetByteSizeRequirement(
+          py_buffer->on_device_shape()) == size;
+
   // The host to device transfer is performed on a thread pool, mostly because
   // it includes linearization that may be slow. It is OK to capture the
   // py_buffer pointer because the py_buffer can't be deleted until all the
@@ -832,13 +852,14 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
   // TODO(misard) assess if it would be preferable to introduce a heuristic to
   // put the transfer into the calling thread for small literals.
   auto transfer_h2d =
-      [local_client = client(), transfer_manager, local_device, data, size,
-       movable_device_buffer{device_buffer.ToClosure()}, shape,
+      [local_client = client(), transfer_manager, local_device, h2d_stream,
+       data, size, movable_device_buffer{device_buffer.ToClosure()}, shape,
        py_buffer{py_buffer.get()},
        on_device_shape{py_buffer->on_device_shape()},
        staging_buffer{std::move(staging_buffer)},
        on_done_with_host_buffer{std::move(on_done_with_host_buffer)},
-       host_buffer_semantics, transpose{std::move(transpose)}]() {
+       host_buffer_semantics, transpose{std::move(transpose)},
+       transfer_in_chunks]() {
         PjRtStreamExecutorBuffer::ScopedHold device_buffer(
             movable_device_buffer);
         // This function uses TF_CHECK_OK and ValueOrDie() since we have no way
@@ -851,7 +872,23 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
         // If applicable on the backend, stage the transfer via host memory
         // allocated via the host_memory_allocator. On GPU, this is pinned
         // memory.
-        if (staging_buffer) {
+        if (transfer_in_chunks) {
+          char* staging = static_cast<char*>(staging_buffer.get());
+          se::DeviceMemoryBase root_buffer = buffer.root_buffer();
+          char* device_memory = static_cast<char*>(root_buffer.opaque());
+          for (int64_t offset = 0; offset < size;
+               offset += kHostToDeviceTransferChunkBytes) {
+            const int64_t chunk_size =
+                std::min(kHostToDeviceTransferChunkBytes, size - offset);
+            std::memcpy(staging + offset,
+                        static_cast<const char*>(data) + offset, chunk_size);
+            se::DeviceMemoryBase device_chunk(device_memory + offset,
+                                              chunk_size);
+            h2d_stream->ThenMemcpy(&device_chunk, staging + offset,
+                                   chunk_size);
+          }
+          CHECK(h2d_stream->ok());
+        } else if (staging_buffer) {
           // If we didn't already copy the input buffer into the staging buffer,
           // do so now.
           if (host_buffer_semantics !=
@@ -868,24 +905,24 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
               static_cast<const char*>(staging_buffer.get()),
               ShapeUtil::DeviceShapeToHostShape(on_device_shape));
           TF_CHECK_OK(transfer_manager->TransferLiteralToDeviceAsync(
-              local_device->host_to_device_stream(), literal, buffer));
+              h2d_stream, literal, buffer));
         } else {
           BorrowingLiteral literal(
               reinterpret_cast<const char*>(data),
               ShapeUtil::DeviceShapeToHostShape(on_device_shape));
           // Otherwise, just transfer the literal.
           TF_CHECK_OK(transfer_manager->TransferLiteralToDeviceAsync(
-              local_device->host_to_device_stream(), literal, buffer));
+              h2d_stream, literal, buffer));
         }
 
         std::shared_ptr<BufferSequencingEvent> event =
             device_buffer->definition_events()[0];
         TF_CHECK_OK(AddDestinationBufferSynchronization(
             local_device, std::move(device_buffer), event,
-            local_device->host_to_device_stream()));
+            h2d_stream));
 
         local_device->ThenExecuteCallback(
-            local_device->host_to_device_stream(),
+            h2d_stream,
             [staging_buffer{std::move(staging_buffer)},
              on_done_with_host_buffer{std::move(on_done_with_host_buffer)}]() {
               if (on_done_with_host_buffer) {
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
@@ -68,6 +69,9 @@ namespace xla {
 
 static const char kCpuPlatformName[] = "cpu";
 static constexpr size_t kSmallDataTransferByteSize = 102400;  // 100 KiB
+// The estimated FLOPs per intra-op thread below which an execution does not
+// use more threads, about 100 times the cost of waking a thread up.
+static constexpr float kFlopsPerIntraOpThread = 100000;
 
 static tfrt::AsyncValueRef<CpuEvent> GetOrCreateReadyEvent(
     tfrt::HostContext* host_context) {
@@ -176,6 +180,22 @@ TfrtCpuClient::TfrtCpuClient(
   LOG(INFO) << "TfrtCpuClient created.";
 }
 
+std::shared_ptr<Eigen::ThreadPoolDevice> TfrtCpuClient::AcquireIntraOpDevice(
+    int max_parallelism) {
+  const int num_executions =
+      num_intraop_executions_.fetch_add(1, std::memory_order_relaxed) + 1;
+  const int num_threads = eigen_intraop_pool_->NumThreads();
+  const int parallelism = std::max(
+      1, std::min(max_parallelism, num_threads / num_executions));
+  return std::shared_ptr<Eigen::ThreadPoolDevice>(
+      new Eigen::ThreadPoolDevice(eigen_intraop_pool_->AsEigenThreadPool(),
+                                  parallelism),
+      [this](Eigen::ThreadPoolDevice* device) {
+        num_intraop_executions_.fetch_sub(1, std::memory_order_relaxed);
+        delete device;
+      });
+}
+
 StatusOr<PjRtDevice*> TfrtCpuClient::LookupDevice(int device_id) const {
   auto it = id_to_device_.find(device_id);
   if (it != id_to_device_.end()) {
@@ -1313,11 +1333,19 @@ TfrtCpuExecutable::TfrtCpuExecutable(
       addressable_devices_(std::move(addressable_devices)) {
   auto hlo_cost_analysis =
       std::make_unique<HloCostAnalysis>(cpu::CpuExecutable::ShapeSizeBytes);
+  CHECK_OK(cpu_executable_->module().entry_computation()->Accept(
+      hlo_cost_analysis.get()));
   // Cache to avoid std::map lookup in flop_count() on critical path.
   // The magic constant 1000 is determined by correlating computation with flop
   // estimate. It is a crude heuristic to find computation less than the thread
   // context switch time (~5us).
-  cheap_computation_ = hlo_cost_analysis->flop_count() < 1000;
+  const float flop_count = hlo_cost_analysis->flop_count();
+  cheap_computation_ = flop_count < 1000;
+  // Give each intra-op thread enough work to amortize waking it up, by the
+  // same heuristic.
+  max_intra_op_parallelism_ = static_cast<int>(
+      std::min<float>(std::max<float>(flop_count / kFlopsPerIntraOpThread, 1),
+                      std::numeric_limits<int>::max()));
 
   const auto& computation_layout =
       cpu_executable_->module().entry_computation_layout();
@@ -1600,7 +1628,9 @@ StatusOr<PjRtExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
   run_options.set_device_ordinal(device->local_hardware_id());
   // Need to keep device_assignment alive until execution completes.
   run_options.set_device_assignment(device_assignment.get());
-  run_options.set_intra_op_thread_pool(client_->eigen_intraop_device());
+  std::shared_ptr<Eigen::ThreadPoolDevice> intra_op_device =
+      client_->AcquireIntraOpDevice(max_intra_op_parallelism_);
+  run_options.set_intra_op_thread_pool(intra_op_device.get());
 
   // Schedule only one collective at a time.
   bool is_a_collective_launch = !!last_collective_launch_event;
@@ -1649,6 +1679,7 @@ StatusOr<PjRtExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
          buffer_pointers = std::move(buffer_pointers),
          buffer_table = std::move(buffer_table),
          run_options = std::move(run_options),
+         intra_op_device = std::move(intra_op_device),
          cpu_executable_copy = cpu_executable_,
          device_assignment = std::move(device_assignment),
          compute_reservation = std::move(compute_reservation),
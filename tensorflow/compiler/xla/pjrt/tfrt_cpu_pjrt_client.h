@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_PJRT_TFRT_CPU_PJRT_CLIENT_H_
 #define TENSORFLOW_COMPILER_XLA_PJRT_TFRT_CPU_PJRT_CLIENT_H_
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <string>
@@ -217,6 +218,15 @@ class TfrtCpuClient final : public PjRtClient {
     return eigen_intraop_device_.get();
   }
 
+  // Returns an intra-op device for one execution of an executable that can
+  // use at most `max_parallelism` threads. The device runs on the shared,
+  // work-stealing intra-op pool, but splits its work for no more threads than
+  // `max_parallelism` and an even share of the pool between the executions
+  // that hold a device at the same time, so that concurrent executions do not
+  // oversubscribe the pool. The execution holds the device until it completes.
+  std::shared_ptr<Eigen::ThreadPoolDevice> AcquireIntraOpDevice(
+      int max_parallelism);
+
   tfrt::AsyncValueRef<CpuEvent> GetLastCollectiveLaunchEvent() {
     absl::MutexLock lock(&mu_);
     return last_collective_launch_event_.CopyRef();
@@ -243,6 +253,8 @@ class TfrtCpuClient final : public PjRtClient {
   // TODO(zhangqiaorjc): Use tfrt::compat::EigenHostContextThreadPool.
   std::unique_ptr<tensorflow::thread::ThreadPool> eigen_intraop_pool_;
   std::unique_ptr<Eigen::ThreadPoolDevice> eigen_intraop_device_;
+  // The executions that hold a device from AcquireIntraOpDevice().
+  std::atomic<int> num_intraop_executions_{0};
 
   // Launching collectives are prone to deadlock when we use fixed-sized
   // threadpools since ExecuteHelper will block until all replicas reach the
@@ -680,6 +692,10 @@ class TfrtCpuExecutable final : public PjRtExecutable {
   // Cached result of comparing HloCostAnalysis FLOP estimate for execute
   // critical path.
   bool cheap_computation_;
+
+  // The number of intra-op threads the computation can keep busy, from its
+  // HloCostAnalysis FLOP estimate.
+  int max_intra_op_parallelism_;
 };
 
 StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(bool asynchronous);
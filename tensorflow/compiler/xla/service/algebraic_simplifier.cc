@@ -6216,4 +6216,10 @@ StatusOr<bool> AlgebraicSimplifier::Run(HloModule* module) {
   return changed;
 }
 
+StatusOr<bool> AlgebraicSimplifier::RunOnSingleComputation(
+    HloComputation* computation) {
+  AlgebraicSimplifierVisitor visitor(options_, this);
+  return visitor.Run(computation, options_, this);
+}
+
 }  // namespace xla
@@ -231,6 +231,11 @@ class AlgebraicSimplifier : public HloModulePass {
   // computation was changed.
   StatusOr<bool> Run(HloModule* module) override;
 
+  // The simplifier only rewrites the instructions of the computation that it
+  // runs on, so it can run concurrently over independent computations.
+  bool IsComputationLocal() const override { return true; }
+  StatusOr<bool> RunOnSingleComputation(HloComputation* computation) override;
+
   // Create constant from literal with tiles and element size updated in the
   // constant's layout.
   std::unique_ptr<HloInstruction> CreateConstantWithLayoutUpdated(
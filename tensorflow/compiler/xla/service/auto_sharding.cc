@@ -0,0 +1,354 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/auto_sharding.h"
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/array.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/hlo_sharding.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/status_macros.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace {
+
+// The dimensions of a dot or convolution that the strategies split, or -1
+// where the instruction has no such dimension.
+struct ShardableDims {
+  int64_t lhs_batch = -1;
+  int64_t rhs_batch = -1;
+  int64_t out_batch = -1;
+  int64_t rhs_feature = -1;
+  int64_t out_feature = -1;
+};
+
+absl::optional<ShardableDims> GetShardableDims(const HloInstruction* hlo) {
+  ShardableDims dims;
+  if (hlo->opcode() == HloOpcode::kDot) {
+    const DotDimensionNumbers& dnums = hlo->dot_dimension_numbers();
+    auto free_dims = [](int64_t rank,
+                        const tensorflow::protobuf::RepeatedField<int64_t>&
+                            batch,
+                        const tensorflow::protobuf::RepeatedField<int64_t>&
+                            contracting) {
+      std::vector<int64_t> free;
+      for (int64_t i = 0; i < rank; ++i) {
+        if (!absl::c_linear_search(batch, i) &&
+            !absl::c_linear_search(contracting, i)) {
+          free.push_back(i);
+        }
+      }
+      return free;
+    };
+    std::vector<int64_t> lhs_free =
+        free_dims(hlo->operand(0)->shape().rank(), dnums.lhs_batch_dimensions(),
+                  dnums.lhs_contracting_dimensions());
+    std::vector<int64_t> rhs_free =
+        free_dims(hlo->operand(1)->shape().rank(), dnums.rhs_batch_dimensions(),
+                  dnums.rhs_contracting_dimensions());
+    // The result holds the batch dimensions, then the free lhs dimensions,
+    // then the free rhs dimensions.
+    int64_t num_batch = dnums.lhs_batch_dimensions_size();
+    if (num_batch > 0) {
+      dims.lhs_batch = dnums.lhs_batch_dimensions(0);
+      dims.rhs_batch = dnums.rhs_batch_dimensions(0);
+      dims.out_batch = 0;
+    } else if (!lhs_free.empty()) {
+      dims.lhs_batch = lhs_free[0];
+      dims.out_batch = 0;
+    }
+    if (!rhs_free.empty()) {
+      dims.rhs_feature = rhs_free[0];
+      dims.out_feature = num_batch + lhs_free.size();
+    }
+    return dims;
+  }
+  if (hlo->opcode() == HloOpcode::kConvolution) {
+    if (hlo->feature_group_count() != 1 || hlo->batch_group_count() != 1) {
+      return absl::nullopt;
+    }
+    const ConvolutionDimensionNumbers& dnums =
+        hlo->convolution_dimension_numbers();
+    dims.lhs_batch = dnums.input_batch_dimension();
+    dims.out_batch = dnums.output_batch_dimension();
+    dims.rhs_feature = dnums.kernel_output_feature_dimension();
+    dims.out_feature = dnums.output_feature_dimension();
+    return dims;
+  }
+  return absl::nullopt;
+}
+
+// Returns the sharding of `shape` in which dimension `dim_a` is split into
+// `a` pieces and dimension `dim_b` into `b` pieces, over a*b devices. Device
+// i*b+j holds piece i of `dim_a` and piece j of `dim_b`. A factor whose
+// dimension is -1 is replicated instead. Returns nullopt if a split dimension
+// is not divisible by its number of pieces.
+absl::optional<HloSharding> MakeSharding(const Shape& shape, int64_t dim_a,
+                                         int64_t a, int64_t dim_b, int64_t b) {
+  std::vector<int64_t> tile_dims(shape.rank(), 1);
+  int64_t replication = 1;
+  auto split = [&](int64_t dim, int64_t count) {
+    if (dim < 0) {
+      replication *= count;
+      return true;
+    }
+    tile_dims[dim] = count;
+    return shape.dimensions(dim) % count == 0;
+  };
+  if (!split(dim_a, a) || !split(dim_b, b)) {
+    return absl::nullopt;
+  }
+  if (replication == a * b) {
+    return HloSharding::Replicate();
+  }
+  if (replication > 1) {
+    tile_dims.push_back(replication);
+  }
+  Array<int64_t> tile_assignment(tile_dims);
+  tile_assignment.Each([&](absl::Span<const int64_t> index, int64_t* device) {
+    // The replicated factor, if any, is indexed by the trailing dimension.
+    auto piece = [&](int64_t dim, int64_t count) -> int64_t {
+      if (dim >= 0) {
+        return index[dim];
+      }
+      return count > 1 ? index.back() : 0;
+    };
+    int64_t i = piece(dim_a, a);
+    int64_t j = piece(dim_b, b);
+    *device = i * b + j;
+  });
+  if (replication > 1) {
+    return HloSharding::PartialTile(tile_assignment);
+  }
+  return HloSharding::Tile(tile_assignment);
+}
+
+struct Strategy {
+  std::string name;
+  HloSharding output;
+  HloSharding lhs;
+  HloSharding rhs;
+  // Estimated time of the instruction under this strategy.
+  double seconds;
+  // Estimated per-device bytes of the operands and the result.
+  int64_t bytes_per_device;
+};
+
+int64_t BytesPerDevice(const Shape& shape, const HloSharding& sharding) {
+  int64_t bytes = ShapeUtil::ByteSizeOfElements(shape);
+  if (sharding.IsReplicated()) {
+    return bytes;
+  }
+  return bytes / sharding.NumTiles();
+}
+
+class StrategyBuilder {
+ public:
+  StrategyBuilder(const AutoShardingOptions& options,
+                  const HloCostAnalysis& cost_analysis,
+                  const absl::flat_hash_map<const HloInstruction*,
+                                            HloSharding>& chosen)
+      : options_(options), cost_analysis_(cost_analysis), chosen_(chosen) {}
+
+  // Returns the candidate strategies for `hlo`, splitting its batch dimension
+  // `a` ways and its feature dimension `b` ways for every a*b equal to the
+  // number of devices.
+  std::vector<Strategy> Build(const HloInstruction* hlo,
+                              const ShardableDims& dims) const {
+    std::vector<Strategy> strategies;
+    strategies.push_back(MakeStrategy(
+        hlo, "replicated", HloSharding::Replicate(), HloSharding::Replicate(),
+        HloSharding::Replicate(), /*num_shards=*/1));
+    const int64_t n = options_.num_devices;
+    for (int64_t a = 1; a <= n; ++a) {
+      if (n % a != 0) {
+        continue;
+      }
+      int64_t b = n / a;
+      if ((a > 1 && dims.lhs_batch < 0) || (b > 1 && dims.rhs_feature < 0)) {
+        continue;
+      }
+      absl::optional<HloSharding> output =
+          MakeSharding(hlo->shape(), dims.out_batch, a, dims.out_feature, b);
+      absl::optional<HloSharding> lhs =
+          MakeSharding(hlo->operand(0)->shape(), dims.lhs_batch, a, -1, b);
+      absl::optional<HloSharding> rhs = MakeSharding(
+          hlo->operand(1)->shape(), dims.rhs_batch, a, dims.rhs_feature, b);
+      if (!output || !lhs || !rhs) {
+        continue;
+      }
+      std::string name = b == 1   ? "data-parallel"
+                         : a == 1 ? "model-parallel"
+                                  : absl::StrCat("mixed-", a, "x", b);
+      strategies.push_back(
+          MakeStrategy(hlo, name, *output, *lhs, *rhs, /*num_shards=*/n));
+    }
+    return strategies;
+  }
+
+ private:
+  // Returns the known sharding of `hlo`, if any.
+  const HloSharding* KnownSharding(const HloInstruction* hlo) const {
+    if (hlo->has_sharding()) {
+      return &hlo->sharding();
+    }
+    auto it = chosen_.find(hlo);
+    return it == chosen_.end() ? nullptr : &it->second;
+  }
+
+  // Each device receives the part of an operand it needs, unless the operand
+  // is already known to be sharded that way.
+  double TransferSeconds(const HloInstruction* operand,
+                         const HloSharding& required) const {
+    const HloSharding* known = KnownSharding(operand);
+    if (known != nullptr && *known == required) {
+      return 0;
+    }
+    return BytesPerDevice(operand->shape(), required) /
+           options_.device_bytes_per_second;
+  }
+
+  Strategy MakeStrategy(const HloInstruction* hlo, std::string name,
+                        HloSharding output, HloSharding lhs, HloSharding rhs,
+                        int64_t num_shards) const {
+    double seconds = cost_analysis_.flop_count(*hlo) /
+                         (num_shards * options_.device_flops_per_second) +
+                     TransferSeconds(hlo->operand(0), lhs) +
+                     TransferSeconds(hlo->operand(1), rhs);
+    int64_t bytes = BytesPerDevice(hlo->shape(), output) +
+                    BytesPerDevice(hlo->operand(0)->shape(), lhs) +
+                    BytesPerDevice(hlo->operand(1)->shape(), rhs);
+    return Strategy{std::move(name), std::move(output), std::move(lhs),
+                    std::move(rhs), seconds, bytes};
+  }
+
+  const AutoShardingOptions& options_;
+  const HloCostAnalysis& cost_analysis_;
+  const absl::flat_hash_map<const HloInstruction*, HloSharding>& chosen_;
+};
+
+struct Candidate {
+  HloInstruction* hlo;
+  std::vector<Strategy> strategies;
+  int64_t choice;
+};
+
+// Moves candidates to smaller strategies until their total footprint fits in
+// `limit`, each time taking the move that costs the least time per byte
+// saved. Returns false if the footprint cannot be brought under the limit.
+bool FitToMemoryLimit(std::vector<Candidate>& candidates, int64_t limit) {
+  int64_t total = 0;
+  for (const Candidate& candidate : candidates) {
+    total += candidate.strategies[candidate.choice].bytes_per_device;
+  }
+  while (total > limit) {
+    Candidate* best_candidate = nullptr;
+    int64_t best_choice = -1;
+    double best_cost = std::numeric_limits<double>::infinity();
+    for (Candidate& candidate : candidates) {
+      const Strategy& current = candidate.strategies[candidate.choice];
+      for (int64_t i = 0; i < candidate.strategies.size(); ++i) {
+        const Strategy& strategy = candidate.strategies[i];
+        int64_t saved = current.bytes_per_device - strategy.bytes_per_device;
+        if (saved <= 0) {
+          continue;
+        }
+        double cost = (strategy.seconds - current.seconds) / saved;
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_candidate = &candidate;
+          best_choice = i;
+        }
+      }
+    }
+    if (best_candidate == nullptr) {
+      return false;
+    }
+    total -=
+        best_candidate->strategies[best_candidate->choice].bytes_per_device -
+        best_candidate->strategies[best_choice].bytes_per_device;
+    best_candidate->choice = best_choice;
+  }
+  return true;
+}
+
+}  // namespace
+
+StatusOr<bool> AutoSharding::Run(HloModule* module) {
+  if (options_.num_devices <= 1) {
+    return false;
+  }
+  std::vector<Candidate> candidates;
+  absl::flat_hash_map<const HloInstruction*, HloSharding> chosen;
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    HloCostAnalysis cost_analysis([](const Shape& shape) {
+      return ShapeUtil::ByteSizeOf(shape, sizeof(void*));
+    });
+    TF_RETURN_IF_ERROR(computation->Accept(&cost_analysis));
+    StrategyBuilder builder(options_, cost_analysis, chosen);
+    for (HloInstruction* hlo : computation->MakeInstructionPostOrder()) {
+      if (hlo->has_sharding() || !hlo->shape().IsArray()) {
+        continue;
+      }
+      absl::optional<ShardableDims> dims = GetShardableDims(hlo);
+      if (!dims) {
+        continue;
+      }
+      // Operands are visited first, so their strategies are known when the
+      // cost of resharding them is estimated.
+      Candidate candidate{hlo, builder.Build(hlo, *dims), 0};
+      for (int64_t i = 1; i < candidate.strategies.size(); ++i) {
+        if (candidate.strategies[i].seconds <
+            candidate.strategies[candidate.choice].seconds) {
+          candidate.choice = i;
+        }
+      }
+      chosen.emplace(hlo, candidate.strategies[candidate.choice].output);
+      candidates.push_back(std::move(candidate));
+    }
+  }
+  if (candidates.empty()) {
+    return false;
+  }
+
+  if (options_.memory_limit_per_device_bytes > 0 &&
+      !FitToMemoryLimit(candidates, options_.memory_limit_per_device_bytes)) {
+    LOG(WARNING) << "Auto-sharding could not fit " << module->name()
+                 << " into " << options_.memory_limit_per_device_bytes
+                 << " bytes per device; using the smallest strategies found.";
+  }
+
+  for (const Candidate& candidate : candidates) {
+    const Strategy& strategy = candidate.strategies[candidate.choice];
+    VLOG(2) << "Auto-sharding " << candidate.hlo->name() << " as "
+            << strategy.name << ": " << strategy.output.ToString();
+    candidate.hlo->set_sharding(strategy.output);
+  }
+  return true;
+}
+
+}  // namespace xla
@@ -0,0 +1,69 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_AUTO_SHARDING_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_AUTO_SHARDING_H_
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/compiler/xla/statusor.h"
+
+namespace xla {
+
+struct AutoShardingOptions {
+  // Number of devices the module is partitioned over.
+  int64_t num_devices = 1;
+  // Per-device memory budget for the operands and results of the dots and
+  // convolutions that are sharded. Zero means unlimited.
+  int64_t memory_limit_per_device_bytes = 0;
+  // Throughput of a single device, used to turn flops into time.
+  double device_flops_per_second = 1e13;
+  // Per-device interconnect bandwidth, used to turn resharding into time.
+  double device_bytes_per_second = 1e10;
+};
+
+// Picks shardings for dots and convolutions that have none, so that a module
+// can be partitioned without hand-written annotations. Each candidate is
+// scored with an estimate of its step time: its HloCostAnalysis flops split
+// over the devices computing it, plus the cost of resharding operands whose
+// sharding is already known. The candidates are
+//
+//   - replicated,
+//   - data parallel: the batch (or lhs non-contracting) dimension is split,
+//   - model parallel: the rhs non-contracting (output feature) dimension is
+//     split,
+//   - mixed: both are split over a 2D arrangement of the devices.
+//
+// Each instruction first gets its fastest candidate. If the summed per-device
+// footprint then exceeds the memory limit, instructions are moved to smaller
+// candidates, cheapest in time per byte saved first, until it fits.
+//
+// Only the chosen instructions are annotated; this pass is meant to run
+// before ShardingPropagation, which then completes the rest of the graph.
+// Shardings that are already present are kept and treated as constraints.
+class AutoSharding : public HloModulePass {
+ public:
+  explicit AutoSharding(const AutoShardingOptions& options)
+      : options_(options) {}
+  absl::string_view name() const override { return "auto-sharding"; }
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  AutoShardingOptions options_;
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_AUTO_SHARDING_H_
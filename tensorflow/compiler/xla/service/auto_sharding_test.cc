@@ -0,0 +1,158 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/auto_sharding.h"
+
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/service/hlo_parser.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace op = xla::testing::opcode_matchers;
+
+namespace xla {
+namespace {
+
+class AutoShardingTest : public HloTestBase {
+ protected:
+  StatusOr<bool> RunAutoSharding(HloModule* module, int64_t num_devices,
+                                 int64_t memory_limit_per_device_bytes = 0) {
+    AutoShardingOptions options;
+    options.num_devices = num_devices;
+    options.memory_limit_per_device_bytes = memory_limit_per_device_bytes;
+    return AutoSharding(options).Run(module);
+  }
+};
+
+TEST_F(AutoShardingTest, LargeBatchIsDataParallel) {
+  const char* const hlo_string = R"(
+HloModule module
+
+ENTRY %entry {
+  %lhs = f32[1024,64] parameter(0)
+  %rhs = f32[64,64] parameter(1)
+  ROOT %dot = f32[1024,64] dot(%lhs, %rhs), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunAutoSharding(module.get(), 4));
+  EXPECT_TRUE(changed);
+  EXPECT_THAT(FindInstruction(module.get(), "dot"),
+              op::Sharding("{devices=[4,1]0,1,2,3}"));
+}
+
+TEST_F(AutoShardingTest, LargeWeightsAreModelParallel) {
+  const char* const hlo_string = R"(
+HloModule module
+
+ENTRY %entry {
+  %lhs = f32[8,1024] parameter(0)
+  %rhs = f32[1024,4096] parameter(1)
+  ROOT %dot = f32[8,4096] dot(%lhs, %rhs), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunAutoSharding(module.get(), 4));
+  EXPECT_TRUE(changed);
+  EXPECT_THAT(FindInstruction(module.get(), "dot"),
+              op::Sharding("{devices=[1,4]0,1,2,3}"));
+}
+
+TEST_F(AutoShardingTest, BalancedOperandsAreMixed) {
+  const char* const hlo_string = R"(
+HloModule module
+
+ENTRY %entry {
+  %lhs = f32[512,512] parameter(0)
+  %rhs = f32[512,512] parameter(1)
+  ROOT %dot = f32[512,512] dot(%lhs, %rhs), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunAutoSharding(module.get(), 4));
+  EXPECT_TRUE(changed);
+  EXPECT_THAT(FindInstruction(module.get(), "dot"),
+              op::Sharding("{devices=[2,2]0,1,2,3}"));
+}
+
+TEST_F(AutoShardingTest, ConvolutionBatchIsDataParallel) {
+  const char* const hlo_string = R"(
+HloModule module
+
+ENTRY %entry {
+  %input = f32[128,32,32,16] parameter(0)
+  %kernel = f32[3,3,16,16] parameter(1)
+  ROOT %conv = f32[128,32,32,16] convolution(%input, %kernel),
+    window={size=3x3 pad=1_1x1_1}, dim_labels=b01f_01io->b01f
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunAutoSharding(module.get(), 4));
+  EXPECT_TRUE(changed);
+  EXPECT_THAT(FindInstruction(module.get(), "conv"),
+              op::Sharding("{devices=[4,1,1,1]0,1,2,3}"));
+}
+
+TEST_F(AutoShardingTest, MemoryLimitForcesSharding) {
+  // The operands are already replicated, so replicating the dot is fastest,
+  // but it does not fit in the memory limit.
+  const char* const hlo_string = R"(
+HloModule module
+
+ENTRY %entry {
+  %lhs = f32[512,512] parameter(0), sharding={replicated}
+  %rhs = f32[512,512] parameter(1), sharding={replicated}
+  ROOT %dot = f32[512,512] dot(%lhs, %rhs), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunAutoSharding(module.get(), 4));
+  EXPECT_TRUE(changed);
+  EXPECT_THAT(FindInstruction(module.get(), "dot"),
+              op::Sharding("{replicated}"));
+
+  TF_ASSERT_OK_AND_ASSIGN(module, ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(
+      changed, RunAutoSharding(module.get(), 4,
+                               /*memory_limit_per_device_bytes=*/1300 * 1024));
+  EXPECT_TRUE(changed);
+  EXPECT_THAT(FindInstruction(module.get(), "dot"),
+              op::Sharding("{devices=[2,2]0,1,2,3}"));
+}
+
+TEST_F(AutoShardingTest, KeepsExistingSharding) {
+  const char* const hlo_string = R"(
+HloModule module
+
+ENTRY %entry {
+  %lhs = f32[1024,64] parameter(0)
+  %rhs = f32[64,64] parameter(1)
+  ROOT %dot = f32[1024,64] dot(%lhs, %rhs), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}, sharding={devices=[1,4]0,1,2,3}
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunAutoSharding(module.get(), 4));
+  EXPECT_FALSE(changed);
+  EXPECT_THAT(FindInstruction(module.get(), "dot"),
+              op::Sharding("{devices=[1,4]0,1,2,3}"));
+}
+
+}  // namespace
+}  // namespace xla
@@ -35,6 +35,9 @@ class NoopStats : public CompilationStats {
 
   void EndPass(absl::string_view pass_name) override {}
 
+  void RecordInstructionCountDelta(absl::string_view pass_name,
+                                   int64_t delta) override {}
+
   void CompilationReport() override {}
 
   int GetPassesSize() override { return 0; }
@@ -48,6 +51,9 @@ class Stats : public CompilationStats {
 
   void EndPass(absl::string_view pass_name) override;
 
+  void RecordInstructionCountDelta(absl::string_view pass_name,
+                                   int64_t delta) override;
+
   void CompilationReport() override;
 
   int GetPassesSize() override;
@@ -60,6 +66,7 @@ class Stats : public CompilationStats {
     std::string name;
     int num_runs = 1;
     double duration_ms;
+    int64_t instruction_count_delta = 0;
   };
 
   // Info about the passes that have been run so far.
@@ -98,6 +105,14 @@ void Stats::EndPass(absl::string_view pass_name) {
   passes_.push_back(PassInfo(current_pass_, duration_ms));
 }
 
+void Stats::RecordInstructionCountDelta(absl::string_view pass_name,
+                                        int64_t delta) {
+  CHECK(!pass_running_);
+  CHECK(!passes_.empty());
+  CHECK_EQ(passes_.back().name, std::string(pass_name));
+  passes_.back().instruction_count_delta = delta;
+}
+
 void Stats::CompilationReport() {
   CHECK(!pass_running_) << "EndPass never called for " << current_pass_;
   absl::flat_hash_map<std::string, PassInfo> summary;
@@ -112,6 +127,8 @@ void Stats::CompilationReport() {
     } else {
       ++summary.at(pass_name).num_runs;
       summary.at(pass_name).duration_ms += pass_run.duration_ms;
+      summary.at(pass_name).instruction_count_delta +=
+          pass_run.instruction_count_delta;
     }
   }
 
@@ -126,10 +143,11 @@ void Stats::CompilationReport() {
            std::make_pair(a.duration_ms, b.name);
   });
   LOG(INFO) << "Total runtime (ms) of HLO passes: " << total_duration;
-  LOG(INFO) << "Pass name, num runs, time (ms)";
+  LOG(INFO) << "Pass name, num runs, time (ms), instruction count delta";
   for (auto& pass_info : sorted_summary) {
     LOG(INFO) << pass_info.name << ", " << pass_info.num_runs << ", "
-              << pass_info.duration_ms;
+              << pass_info.duration_ms << ", "
+              << pass_info.instruction_count_delta;
   }
 }
 
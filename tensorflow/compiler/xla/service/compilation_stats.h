@@ -25,9 +25,9 @@ namespace xla {
 
 // This class is used to collect information about HLO passes and print some
 // statistics at the end of compilation. From HloPassPipeline, we call StartPass
-// before the execution of a pass, and EndPass after. Currently, we only collect
-// timing information and how many times each pass was run. In the future, we
-// can add more things, such as the size of the HLO graph after each pass.
+// before the execution of a pass, and EndPass after. We collect timing
+// information, how many times each pass was run, and how much each pass grew
+// or shrank the HLO graph.
 class CompilationStats {
  public:
   virtual ~CompilationStats() = default;
@@ -40,6 +40,11 @@ class CompilationStats {
 
   virtual void EndPass(absl::string_view pass_name) = 0;
 
+  // Records the change in the number of HLO instructions caused by the run of
+  // `pass_name` that most recently ended.
+  virtual void RecordInstructionCountDelta(absl::string_view pass_name,
+                                           int64_t delta) = 0;
+
   virtual void CompilationReport() = 0;
 
   virtual int GetPassesSize() = 0;
@@ -132,6 +132,8 @@ extern const char* const kStatusIsSuccessSymbolName =
     "__xla_cpu_runtime_StatusIsSuccess";
 extern const char* const kKeyValueSortSymbolName =
     "__xla_cpu_runtime_KeyValueSort";
+extern const char* const kSortPrimitiveKeysSymbolName =
+    "__xla_cpu_runtime_SortPrimitiveKeys";
 extern const char* const kTopKF32SymbolName = "__xla_cpu_runtime_TopKF32";
 extern const char* const kTracingStartSymbolName =
     "__xla_cpu_runtime_TracingStart";
@@ -57,6 +57,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_function.h"
 #include "tensorflow/compiler/xla/service/cpu/parallel_loop_emitter.h"
+#include "tensorflow/compiler/xla/service/cpu/runtime_key_value_sort.h"
 #include "tensorflow/compiler/xla/service/cpu/shape_partition.h"
 #include "tensorflow/compiler/xla/service/cpu/simple_orc_jit.h"
 #include "tensorflow/compiler/xla/service/elemental_ir_emitter.h"
@@ -568,6 +569,51 @@ Status IrEmitter::HandleOutfeed(HloInstruction* outfeed) {
   return Status::OK();
 }
 
+// Returns the XlaCpuSortKeyKind of the keys of `sort`, and whether it sorts
+// them in descending order, if it has no values and its comparator compares
+// its parameters with LT or GT. The runtime then sorts the keys without calling
+// the comparator.
+static absl::optional<std::pair<XlaCpuSortKeyKind, bool>> GetPrimitiveSortKeys(
+    const HloSortInstruction& sort) {
+  if (sort.operand_count() != 1) {
+    return absl::nullopt;
+  }
+  const HloInstruction* root = sort.to_apply()->root_instruction();
+  if (root->opcode() != HloOpcode::kCompare ||
+      root->operand(0)->opcode() != HloOpcode::kParameter ||
+      root->operand(1)->opcode() != HloOpcode::kParameter) {
+    return absl::nullopt;
+  }
+  const int64_t lhs = root->operand(0)->parameter_number();
+  const int64_t rhs = root->operand(1)->parameter_number();
+  if (!((lhs == 0 && rhs == 1) || (lhs == 1 && rhs == 0))) {
+    return absl::nullopt;
+  }
+  bool descending;
+  if (root->comparison_direction() == ComparisonDirection::kLt) {
+    descending = lhs == 1;
+  } else if (root->comparison_direction() == ComparisonDirection::kGt) {
+    descending = lhs == 0;
+  } else {
+    return absl::nullopt;
+  }
+  const PrimitiveType type = sort.keys()->shape().element_type();
+  XlaCpuSortKeyKind kind;
+  if (primitive_util::IsSignedIntegralType(type)) {
+    kind = kXlaCpuSortSignedKeys;
+  } else if (primitive_util::IsUnsignedIntegralType(type) || type == PRED) {
+    kind = kXlaCpuSortUnsignedKeys;
+  } else if (primitive_util::IsFloatingPointType(type) &&
+             root->comparison_order() == ComparisonOrder::kTotal) {
+    kind = kXlaCpuSortFloatTotalOrderKeys;
+  } else if (type == F32 || type == F64) {
+    kind = kXlaCpuSortFloatKeys;
+  } else {
+    return absl::nullopt;
+  }
+  return std::make_pair(kind, descending);
+}
+
 Status IrEmitter::HandleSort(HloInstruction* hlo) {
   const HloSortInstruction* sort = Cast<HloSortInstruction>(hlo);
   TF_RETURN_IF_ERROR(EmitTargetAddressForOp(sort));
@@ -624,6 +670,21 @@ Status IrEmitter::HandleSort(HloInstruction* hlo) {
     lower_dimensions *= normalized_keys_shape.dimensions(i);
   }
 
+  if (absl::optional<std::pair<XlaCpuSortKeyKind, bool>> primitive_keys =
+          GetPrimitiveSortKeys(*sort)) {
+    EmitCallToFunc(
+        runtime::kSortPrimitiveKeysSymbolName,
+        {b_.getInt64(higher_dimensions), b_.getInt64(sort_dimension_elements),
+         b_.getInt64(lower_dimensions),
+         PointerCast(destination_addresses[0], b_.getInt8PtrTy()),
+         b_.getInt32(primitive_keys->first),
+         b_.getInt32(ShapeUtil::ByteSizeOfPrimitiveType(keys_type)),
+         b_.getInt1(primitive_keys->second), b_.getInt1(sort->is_stable()),
+         GetExecutableRunOptionsArgument()},
+        b_.getVoidTy());
+    return Status::OK();
+  }
+
   CHECK(absl::c_binary_search(thread_local_computations_, sort->to_apply()));
   llvm::Value* values = llvm_ir::EmitAllocaAtFunctionEntryWithCount(
       b_.getInt8PtrTy(), b_.getInt32(sort->operand_count()), "cc_values_alloca",
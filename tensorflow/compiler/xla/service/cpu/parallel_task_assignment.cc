@@ -28,6 +28,23 @@ limitations under the License.
 namespace xla {
 namespace cpu {
 
+// The fork/join runtime hands out tasks to threads dynamically (see
+// runtime_fork_join.cc), so an instruction is split into several tasks per
+// thread, letting threads that finish early take over work from slower ones.
+// The per-thread minimum costs below are shared between the tasks of a
+// thread accordingly.
+static constexpr int64_t kTasksPerThread = 4;
+
+// Returns the task count for an instruction of cost 'instruction_cost', given
+// the minimum cost worth running on a thread of its own.
+static int64_t TaskCount(int64_t instruction_cost, int64_t min_cost_per_thread,
+                         int64_t max_parallelism) {
+  const int64_t min_cost_per_task = min_cost_per_thread / kTasksPerThread;
+  // Return target parallel task count in [1, max_parallelism * tasks/thread].
+  return std::min(max_parallelism * kTasksPerThread,
+                  std::max(int64_t{1}, instruction_cost / min_cost_per_task));
+}
+
 class SimpleCostModel : public ParallelCostModel {
  public:
   SimpleCostModel(const int64_t max_parallelism,
@@ -39,10 +56,7 @@ class SimpleCostModel : public ParallelCostModel {
     // Simple cost model based on hlo size and typical L2 cache size.
     const int64_t instruction_cost = shape_size_(instruction->shape());
     const int64_t min_cost_per_thread = 256LL << 10;  // 256KB L2 Cache size.
-    // Return target parallel task count in [1, max_parallelism_].
-    return std::min(
-        max_parallelism_,
-        std::max(int64_t{1}, instruction_cost / min_cost_per_thread));
+    return TaskCount(instruction_cost, min_cost_per_thread, max_parallelism_);
   }
 
  private:
@@ -96,10 +110,7 @@ class DefaultCostModel : public ParallelCostModel {
       // Minimum per-thread cost is 100us of work on a 2GHz core.
       min_cost_per_thread = 100000;
     }
-    // Return target parallel task count in [1, max_parallelism_].
-    return std::min(
-        max_parallelism,
-        std::max(int64_t{1}, instruction_cost / min_cost_per_thread));
+    return TaskCount(instruction_cost, min_cost_per_thread, max_parallelism);
   }
 
  private:
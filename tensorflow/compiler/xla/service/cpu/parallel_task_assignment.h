@@ -35,7 +35,8 @@ class ParallelCostModel {
 // ParallelTaskAssignment computes parallel task counts for HLOs in 'module'.
 class ParallelTaskAssignment {
  public:
-  // 'max_parallelism': the maximum parallel task count per instruction.
+  // 'max_parallelism': the maximum number of threads an instruction runs on.
+  //                    Instructions may be split into a few tasks per thread.
   // 'shape_size': shape size function used by HloCostAnalysis during parallel
   //               task assignment.
   // 'module': the containing HloModule.
@@ -63,7 +64,8 @@ class ParallelTaskAssignment {
 // a runtime parallel fork/join call.
 class ParallelTaskAssigner : public HloModulePass {
  public:
-  // 'max_parallelism': the maximum parallel task count per instruction.
+  // 'max_parallelism': the maximum number of threads an instruction runs on.
+  //                    Instructions may be split into a few tasks per thread.
   // 'shape_size': shape size function used by HloCostAnalysis during parallel
   //               task assignment.
   ParallelTaskAssigner(const int64_t max_parallelism,
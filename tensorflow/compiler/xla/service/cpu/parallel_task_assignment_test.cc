@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
 
 #include "tensorflow/compiler/xla/service/cpu/cpu_executable.h"
+#include "tensorflow/compiler/xla/service/cpu/shape_partition.h"
 #include "tensorflow/compiler/xla/service/cpu/target_machine_features_fake.h"
 #include "tensorflow/compiler/xla/test.h"
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
@@ -192,6 +193,28 @@ TEST_F(ParallelTaskAssignmentTest, AllReduceNotParallelized) {
   EXPECT_FALSE(changed);
 }
 
+TEST_F(ParallelTaskAssignmentTest, ElementwiseSplitIntoSeveralTasksPerThread) {
+  const std::string hlo_string = R"(
+    HloModule TestTaskParallel_Add
+    ENTRY Add {
+      p0 = f32[4096,1024] parameter(0)
+      p1 = f32[4096,1024] parameter(1)
+      ROOT add = f32[4096,1024] add(p0, p1)
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto m, ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunParallelTaskAssigner(m.get()));
+  EXPECT_TRUE(changed);
+
+  HloInstruction* call = m->entry_computation()->root_instruction();
+  ASSERT_EQ(call->opcode(), HloOpcode::kCall);
+  int64_t task_count = ShapePartitionAssigner::GetTotalPartitionCount(
+      call->to_apply()->root_instruction()->outer_dimension_partitions());
+  EXPECT_GT(task_count, 1);
+  EXPECT_LE(task_count, 4 * max_parallelism_);
+}
+
 TEST_F(ParallelTaskAssignmentTest, ConstantNotParallelized) {
   constexpr char hlo_string[] = R"(
   HloModule TestTaskParallel_constant
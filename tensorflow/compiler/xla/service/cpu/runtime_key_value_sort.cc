@@ -14,14 +14,319 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/compiler/xla/service/cpu/runtime_key_value_sort.h"
 
+#define EIGEN_USE_THREADS
+
 #include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <functional>
 #include <memory>
 #include <numeric>
 #include <string>
+#include <utility>
 
 #include "absl/base/dynamic_annotations.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/compiler/xla/executable_run_options.h"
+
+namespace {
+
+// Slices of up to this many elements are sorted by one thread. Longer slices
+// are sorted by chunks of this many elements in parallel, which are merged.
+constexpr int64_t kParallelSortChunkElements = 1 << 14;
+
+// Rough costs of a comparison by the JIT-compiled comparator and of a
+// comparison of primitive keys, for the Eigen cost model.
+constexpr double kCyclesPerComparatorCall = 20;
+constexpr double kCyclesPerKeyComparison = 2;
+
+// Returns the intra-op device of 'run_options_ptr', or nullptr if the sort
+// runs on the calling thread.
+const Eigen::ThreadPoolDevice* GetIntraOpDevice(char* run_options_ptr) {
+  const auto* run_options =
+      reinterpret_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
+  if (run_options == nullptr) return nullptr;
+  const Eigen::ThreadPoolDevice* device = run_options->intra_op_thread_pool();
+  return device != nullptr && device->numThreads() > 1 ? device : nullptr;
+}
+
+// Calls 'fn(first, last)' for ranges that cover [0, n), in parallel on
+// 'device' or on the calling thread if 'device' is nullptr.
+void ParallelFor(const Eigen::ThreadPoolDevice* device, int64_t n,
+                 double cycles_per_item,
+                 const std::function<void(int64_t, int64_t)>& fn) {
+  if (device == nullptr || n <= 1) {
+    fn(0, n);
+    return;
+  }
+  device->parallelFor(n, Eigen::TensorOpCost(0, 0, cycles_per_item),
+                      [&fn](Eigen::Index first, Eigen::Index last) {
+                        fn(first, last);
+                      });
+}
+
+double SortCycles(int64_t n, double cycles_per_comparison) {
+  return n * std::log2(std::max<int64_t>(n, 2)) * cycles_per_comparison;
+}
+
+// Sorts 'data[0, n)' by sorting chunks of kParallelSortChunkElements elements
+// with 'sort_chunk(begin, end)' in parallel, then merging adjacent runs with
+// 'merge(begin, middle, end, out)' in parallel rounds. 'merge' must take equal
+// elements from [begin, middle) first, so that the sort is stable if
+// 'sort_chunk' is.
+template <typename T, typename SortChunk, typename Merge>
+void ParallelMergeSort(T* data, int64_t n,
+                       const Eigen::ThreadPoolDevice* device,
+                       double cycles_per_comparison, SortChunk sort_chunk,
+                       Merge merge) {
+  const int64_t chunk = kParallelSortChunkElements;
+  ParallelFor(device, (n + chunk - 1) / chunk,
+              SortCycles(chunk, cycles_per_comparison),
+              [&](int64_t first, int64_t last) {
+                for (int64_t i = first; i < last; ++i) {
+                  sort_chunk(data + i * chunk,
+                             data + std::min(n, (i + 1) * chunk));
+                }
+              });
+  std::unique_ptr<T[]> buffer(new T[n]);
+  T* source = data;
+  T* destination = buffer.get();
+  for (int64_t width = chunk; width < n; width *= 2) {
+    ParallelFor(device, (n + 2 * width - 1) / (2 * width),
+                2 * width * cycles_per_comparison,
+                [&](int64_t first, int64_t last) {
+                  for (int64_t i = first; i < last; ++i) {
+                    const int64_t begin = i * 2 * width;
+                    merge(source + begin, source + std::min(n, begin + width),
+                          source + std::min(n, begin + 2 * width),
+                          destination + begin);
+                  }
+                });
+    std::swap(source, destination);
+  }
+  if (source != data) std::copy(source, source + n, data);
+}
+
+// Sorts 'data[0, n)' with 'sort_chunk' on the calling thread if it is short
+// or 'device' is nullptr, and with ParallelMergeSort otherwise.
+template <typename T, typename SortChunk, typename Merge>
+void SortMaybeInParallel(T* data, int64_t n,
+                         const Eigen::ThreadPoolDevice* device,
+                         double cycles_per_comparison, SortChunk sort_chunk,
+                         Merge merge) {
+  if (device == nullptr || n <= kParallelSortChunkElements) {
+    sort_chunk(data, data + n);
+  } else {
+    ParallelMergeSort(data, n, device, cycles_per_comparison, sort_chunk,
+                      merge);
+  }
+}
+
+// Calls 'sort_slices(first, last, slice_device)' for ranges that cover the
+// a * c slices of length b. If there are enough slices to keep the threads of
+// 'device' busy, the ranges are sorted in parallel and 'slice_device' is
+// nullptr. Otherwise the slices are sorted one after the other, and
+// 'slice_device' is 'device' so that each of them can be sorted in parallel.
+void ForEachSliceRange(
+    int64_t a, int64_t b, int64_t c, const Eigen::ThreadPoolDevice* device,
+    double cycles_per_comparison,
+    const std::function<void(int64_t, int64_t,
+                             const Eigen::ThreadPoolDevice*)>& sort_slices) {
+  const int64_t num_slices = a * c;
+  if (device != nullptr && num_slices >= device->numThreads()) {
+    ParallelFor(device, num_slices, SortCycles(b, cycles_per_comparison),
+                [&](int64_t first, int64_t last) {
+                  sort_slices(first, last, /*slice_device=*/nullptr);
+                });
+  } else {
+    sort_slices(0, num_slices, device);
+  }
+}
+
+// Returns the offset in elements of the first element of slice 'index', which
+// can be split into two values which index into the 'c' dimension and the 'a'
+// dimension, respectively. 'index' % 'c' is the index into the 'c' dimension,
+// 'index' / 'c' is the index into the 'a' dimension. When calculating the base
+// offset, we need to multiply the index into the 'a' dimension with 'b' * 'c'.
+// 'index' / 'c' * 'c' * 'b' = ('index' - 'index' % 'c') * 'b'.
+int64_t SliceBaseOffset(int64_t index, int64_t b, int64_t c) {
+  return index % c + (index - index % c) * b;
+}
+
+// Compares the elements at two indices of a slice with the JIT-compiled
+// comparator. Copies share 'comparison_values', space for 2 * values_count
+// pointers, so threads must not share a comparator.
+class IndexLessThan {
+ public:
+  IndexLessThan(int64_t base_offset, int64_t sort_dimension_offset,
+                char** values, int32_t values_count,
+                int32_t* values_primitive_type_size_in_bytes,
+                char* run_options, int64_t* prof_counters,
+                void (*less_than)(char*, char*, char**, char**, int64_t*),
+                char** comparison_values)
+      : base_offset_(base_offset),
+        sort_dimension_offset_(sort_dimension_offset),
+        values_(values),
+        values_count_(values_count),
+        values_primitive_type_size_in_bytes_(
+            values_primitive_type_size_in_bytes),
+        run_options_(run_options),
+        prof_counters_(prof_counters),
+        less_than_(less_than),
+        comparison_values_(comparison_values) {}
+
+  bool operator()(int64_t a, int64_t b) const {
+    for (int32_t i = 0; i < values_count_; ++i) {
+      int64_t memory_index_lhs = (base_offset_ + a * sort_dimension_offset_) *
+                                 values_primitive_type_size_in_bytes_[i];
+      int64_t memory_index_rhs = (base_offset_ + b * sort_dimension_offset_) *
+                                 values_primitive_type_size_in_bytes_[i];
+      comparison_values_[i * 2] = values_[i] + memory_index_lhs;
+      comparison_values_[i * 2 + 1] = values_[i] + memory_index_rhs;
+    }
+    char result = 0;  // Overwritten by less_than.
+    less_than_(&result, run_options_, comparison_values_, nullptr,
+               prof_counters_);
+    return result != 0u;
+  }
+
+ private:
+  int64_t base_offset_;
+  int64_t sort_dimension_offset_;
+  char** values_;
+  int32_t values_count_;
+  int32_t* values_primitive_type_size_in_bytes_;
+  char* run_options_;
+  int64_t* prof_counters_;
+  void (*less_than_)(char*, char*, char**, char**, int64_t*);
+  char** comparison_values_;
+};
+
+// The key of 'bits', a key of kind 'key_kind', as an unsigned integer in the
+// same order, or in the reverse order if 'descending' is true.
+template <typename U>
+U ToOrderedBits(U bits, int32_t key_kind, bool descending) {
+  constexpr U kSignBit = static_cast<U>(U{1} << (sizeof(U) * 8 - 1));
+  if (key_kind == kXlaCpuSortSignedKeys) {
+    bits ^= kSignBit;
+  } else if (key_kind == kXlaCpuSortFloatTotalOrderKeys) {
+    bits = (bits & kSignBit) ? static_cast<U>(~bits) : bits | kSignBit;
+  }
+  return descending ? static_cast<U>(~bits) : bits;
+}
+
+// The inverse of ToOrderedBits.
+template <typename U>
+U FromOrderedBits(U bits, int32_t key_kind, bool descending) {
+  constexpr U kSignBit = static_cast<U>(U{1} << (sizeof(U) * 8 - 1));
+  if (descending) bits = ~bits;
+  if (key_kind == kXlaCpuSortSignedKeys) {
+    bits ^= kSignBit;
+  } else if (key_kind == kXlaCpuSortFloatTotalOrderKeys) {
+    bits = (bits & kSignBit) ? bits ^ kSignBit : static_cast<U>(~bits);
+  }
+  return bits;
+}
+
+// Sorts 'keys[0, n)' with a stable least significant digit radix sort over
+// bytes, using 'scratch' for n keys. Skips the bytes that all keys share.
+template <typename U>
+void RadixSort(U* keys, U* scratch, int64_t n) {
+  U* source = keys;
+  U* destination = scratch;
+  for (int shift = 0; shift < static_cast<int>(sizeof(U)) * 8; shift += 8) {
+    int64_t offsets[256] = {};
+    for (int64_t i = 0; i < n; ++i) {
+      ++offsets[(source[i] >> shift) & 0xff];
+    }
+    if (std::find(offsets, offsets + 256, n) != offsets + 256) continue;
+    int64_t sum = 0;
+    for (int64_t& offset : offsets) {
+      const int64_t count = offset;
+      offset = sum;
+      sum += count;
+    }
+    for (int64_t i = 0; i < n; ++i) {
+      destination[offsets[(source[i] >> shift) & 0xff]++] = source[i];
+    }
+    std::swap(source, destination);
+  }
+  if (source != keys) std::copy(source, source + n, keys);
+}
+
+// Sorts the slices of integer or total order float keys as unsigned integers
+// in their order, with a radix sort.
+template <typename U>
+void SortOrderedBitsSlices(int64_t a, int64_t b, int64_t c, char* keys,
+                           int32_t key_kind, bool descending,
+                           const Eigen::ThreadPoolDevice* device) {
+  ForEachSliceRange(
+      a, b, c, device, kCyclesPerKeyComparison,
+      [&](int64_t first, int64_t last,
+          const Eigen::ThreadPoolDevice* slice_device) {
+        std::unique_ptr<U[]> slice(new U[b]);
+        for (int64_t index = first; index < last; ++index) {
+          U* data = reinterpret_cast<U*>(keys) + SliceBaseOffset(index, b, c);
+          for (int64_t i = 0; i < b; ++i) {
+            U bits;
+            std::memcpy(&bits, data + i * c, sizeof(U));
+            slice[i] = ToOrderedBits(bits, key_kind, descending);
+          }
+          SortMaybeInParallel(
+              slice.get(), b, slice_device, kCyclesPerKeyComparison,
+              [](U* begin, U* end) {
+                std::unique_ptr<U[]> scratch(new U[end - begin]);
+                RadixSort(begin, scratch.get(), end - begin);
+              },
+              [](U* begin, U* middle, U* end, U* out) {
+                std::merge(begin, middle, middle, end, out);
+              });
+          for (int64_t i = 0; i < b; ++i) {
+            const U bits = FromOrderedBits(slice[i], key_kind, descending);
+            std::memcpy(data + i * c, &bits, sizeof(U));
+          }
+        }
+      });
+}
+
+// Sorts the slices of floats ordered by operator<, which is not a total order,
+// by comparing them.
+template <typename T>
+void SortFloatSlices(int64_t a, int64_t b, int64_t c, char* keys,
+                     bool descending, bool is_stable,
+                     const Eigen::ThreadPoolDevice* device) {
+  const std::function<bool(T, T)> less =
+      descending ? std::function<bool(T, T)>(std::greater<T>())
+                 : std::function<bool(T, T)>(std::less<T>());
+  ForEachSliceRange(
+      a, b, c, device, kCyclesPerKeyComparison,
+      [&](int64_t first, int64_t last,
+          const Eigen::ThreadPoolDevice* slice_device) {
+        std::unique_ptr<T[]> slice(new T[b]);
+        for (int64_t index = first; index < last; ++index) {
+          T* data = reinterpret_cast<T*>(keys) + SliceBaseOffset(index, b, c);
+          for (int64_t i = 0; i < b; ++i) slice[i] = data[i * c];
+          auto sort_chunk = [&](T* begin, T* end) {
+            if (descending) {
+              is_stable ? std::stable_sort(begin, end, std::greater<T>())
+                        : std::sort(begin, end, std::greater<T>());
+            } else {
+              is_stable ? std::stable_sort(begin, end, std::less<T>())
+                        : std::sort(begin, end, std::less<T>());
+            }
+          };
+          SortMaybeInParallel(slice.get(), b, slice_device,
+                              kCyclesPerKeyComparison, sort_chunk,
+                              [&](T* begin, T* middle, T* end, T* out) {
+                                std::merge(begin, middle, middle, end, out,
+                                           less);
+                              });
+          for (int64_t i = 0; i < b; ++i) data[i * c] = slice[i];
+        }
+      });
+}
+
+}  // namespace
 
 ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_KeyValueSort(
     int64_t a, int64_t b, int64_t c, char** values, int32_t values_count,
@@ -41,71 +346,114 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_KeyValueSort(
   // dimensions (set to 1 if b is the most major dimension). There are a * c
   // many rows that we need to sort. We iterate through these, calculate a
   // 'base_offset' value which points to the first element in that row, and add
-  // i * c for accessing the 'i'-th element in that row.
+  // i * c for accessing the 'i'-th element in that row. The rows are sorted in
+  // parallel if there are enough of them, and each row is sorted in parallel
+  // otherwise.
 
   int64_t sort_dimension_elements = b;
-  int64_t num_iteration_elements = a * c;
   int64_t sort_dimension_offset = c;
+  int32_t max_primitive_type_size_in_bytes =
+      *std::max_element(values_primitive_type_size_in_bytes,
+                        values_primitive_type_size_in_bytes + values_count);
 
-  std::unique_ptr<int64_t[]> indices(new int64_t[sort_dimension_elements]);
-  std::unique_ptr<char*[]> comparison_values(new char*[2 * values_count]);
-  std::iota(indices.get(), indices.get() + sort_dimension_elements, 0);
-  std::unique_ptr<std::string[]> reordered_values(
-      new std::string[sort_dimension_elements]);
-  for (int64_t index = 0; index < num_iteration_elements; ++index) {
-    // If the sort should be stable, we have to reinitialize indices to iota to
-    // guarantee that we still keep the relative order in case of ties.
-    if (is_stable && index > 0) {
-      std::iota(indices.get(), indices.get() + sort_dimension_elements, 0);
-    }
-    // 'index' can be split into two values which index into the 'c' dimension
-    // and the 'a' dimension, respectively. 'index' % 'c' is the index into the
-    // 'c' dimension, 'index' / 'c' is the index into the 'a' dimension. When
-    // calculating the base offset, we need to multiply the index into the 'a'
-    // dimension with 'b' * 'c'.
-    // 'index' / 'c' * 'c' * 'b' = ('index' - 'index' % 'c') * 'b'.
-    int64_t base_offset =
-        index % sort_dimension_offset +
-        (index - index % sort_dimension_offset) * sort_dimension_elements;
-    auto compare_function = [&](int64_t a, int64_t b) -> bool {
-      for (int32_t i = 0; i < values_count; ++i) {
-        int64_t memory_index_lhs = (base_offset + a * sort_dimension_offset) *
-                                   values_primitive_type_size_in_bytes[i];
-        int64_t memory_index_rhs = (base_offset + b * sort_dimension_offset) *
-                                   values_primitive_type_size_in_bytes[i];
-        comparison_values[i * 2] = values[i] + memory_index_lhs;
-        comparison_values[i * 2 + 1] = values[i] + memory_index_rhs;
-      }
-      char result = 0;  // Overwritten by less_than.
-      less_than(&result, run_options, comparison_values.get(), nullptr,
-                prof_counters);
-      return result != 0u;
-    };
-    if (is_stable) {
-      std::stable_sort(indices.get(), indices.get() + sort_dimension_elements,
-                       compare_function);
-    } else {
-      std::sort(indices.get(), indices.get() + sort_dimension_elements,
-                compare_function);
-    }
+  ForEachSliceRange(
+      a, b, c, GetIntraOpDevice(run_options), kCyclesPerComparatorCall,
+      [&](int64_t first, int64_t last,
+          const Eigen::ThreadPoolDevice* slice_device) {
+        std::unique_ptr<int64_t[]> indices(
+            new int64_t[sort_dimension_elements]);
+        std::unique_ptr<char[]> reordered_values(
+            new char[sort_dimension_elements *
+                     max_primitive_type_size_in_bytes]);
+        for (int64_t index = first; index < last; ++index) {
+          int64_t base_offset = SliceBaseOffset(index, sort_dimension_elements,
+                                                sort_dimension_offset);
+          // Each chunk and merge makes its own comparator, since the
+          // comparators of concurrent tasks must not share their scratch
+          // space.
+          auto make_less = [&](char** comparison_values) {
+            return IndexLessThan(base_offset, sort_dimension_offset, values,
+                                 values_count,
+                                 values_primitive_type_size_in_bytes,
+                                 run_options, prof_counters, less_than,
+                                 comparison_values);
+          };
+          // Reinitialize indices to iota to guarantee that a stable sort keeps
+          // the relative order in case of ties.
+          std::iota(indices.get(), indices.get() + sort_dimension_elements, 0);
+          SortMaybeInParallel(
+              indices.get(), sort_dimension_elements, slice_device,
+              kCyclesPerComparatorCall,
+              [&](int64_t* begin, int64_t* end) {
+                std::unique_ptr<char*[]> comparison_values(
+                    new char*[2 * values_count]);
+                if (is_stable) {
+                  std::stable_sort(begin, end,
+                                   make_less(comparison_values.get()));
+                } else {
+                  std::sort(begin, end, make_less(comparison_values.get()));
+                }
+              },
+              [&](int64_t* begin, int64_t* middle, int64_t* end,
+                  int64_t* out) {
+                std::unique_ptr<char*[]> comparison_values(
+                    new char*[2 * values_count]);
+                std::merge(begin, middle, middle, end, out,
+                           make_less(comparison_values.get()));
+              });
+
+          // Reorder the values according to the order defined by 'indices'.
+          for (int32_t idx = 0; idx < values_count; ++idx) {
+            const int32_t size = values_primitive_type_size_in_bytes[idx];
+            for (int64_t i = 0; i < sort_dimension_elements; ++i) {
+              int64_t memory_index =
+                  (base_offset + indices[i] * sort_dimension_offset) * size;
+              memcpy(reordered_values.get() + i * size,
+                     values[idx] + memory_index, size);
+            }
+            for (int64_t i = 0; i < sort_dimension_elements; ++i) {
+              int64_t memory_index =
+                  (base_offset + i * sort_dimension_offset) * size;
+              memcpy(values[idx] + memory_index,
+                     reordered_values.get() + i * size, size);
+            }
+          }
+        }
+      });
+}
 
-    // Reorder the values according to the order defined by 'indices'.
-    for (int32_t idx = 0; idx < values_count; ++idx) {
-      for (int64_t i = 0; i < sort_dimension_elements; ++i) {
-        int64_t memory_index =
-            (base_offset + indices[i] * sort_dimension_offset) *
-            values_primitive_type_size_in_bytes[idx];
-
-        reordered_values[i] =
-            std::string(values[idx] + memory_index,
-                        values_primitive_type_size_in_bytes[idx]);
-      }
-      for (int64_t i = 0; i < sort_dimension_elements; ++i) {
-        int64_t memory_index = (base_offset + i * sort_dimension_offset) *
-                               values_primitive_type_size_in_bytes[idx];
-        memcpy(values[idx] + memory_index, reordered_values[i].c_str(),
-               values_primitive_type_size_in_bytes[idx]);
-      }
+void __xla_cpu_runtime_SortPrimitiveKeys(int64_t a, int64_t b, int64_t c,
+                                         char* keys, int32_t key_kind,
+                                         int32_t key_size_in_bytes,
+                                         bool descending, bool is_stable,
+                                         char* run_options) {
+  const Eigen::ThreadPoolDevice* device = GetIntraOpDevice(run_options);
+  if (key_kind == kXlaCpuSortFloatKeys) {
+    if (key_size_in_bytes == sizeof(double)) {
+      SortFloatSlices<double>(a, b, c, keys, descending, is_stable, device);
+    } else {
+      SortFloatSlices<float>(a, b, c, keys, descending, is_stable, device);
     }
+    return;
+  }
+  // Integers and total order floats have no distinct keys that compare equal,
+  // so the radix sort is stable as well.
+  switch (key_size_in_bytes) {
+    case 1:
+      SortOrderedBitsSlices<uint8_t>(a, b, c, keys, key_kind, descending,
+                                     device);
+      break;
+    case 2:
+      SortOrderedBitsSlices<uint16_t>(a, b, c, keys, key_kind, descending,
+                                      device);
+      break;
+    case 4:
+      SortOrderedBitsSlices<uint32_t>(a, b, c, keys, key_kind, descending,
+                                      device);
+      break;
+    default:
+      SortOrderedBitsSlices<uint64_t>(a, b, c, keys, key_kind, descending,
+                                      device);
+      break;
   }
 }
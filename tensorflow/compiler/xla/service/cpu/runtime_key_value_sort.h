@@ -18,7 +18,7 @@ limitations under the License.
 
 #include <stdint.h>
 
-#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "third_party/eigen3/Eigen/Core"
 
 extern "C" {
 
@@ -36,11 +36,38 @@ extern "C" {
 // - pointers to the parameter buffers (char**)
 // - pointers to the buffer tables = nullptr for thread local functions (char**)
 // - profile counters = 'prof_counters' (int64_t*)
+// Uses the intra-op thread pool of 'run_options' if it has one, in which case
+// 'less_than' may be called concurrently.
 extern void __xla_cpu_runtime_KeyValueSort(
     int64_t a, int64_t b, int64_t c, char** values, int32_t values_count,
     int32_t* values_primitive_type_size_in_bytes, bool is_stable,
     char* run_options, int64_t* prof_counters,
     void (*less_than)(char*, char*, char**, char**, int64_t*));
+
+// The kinds of keys that __xla_cpu_runtime_SortPrimitiveKeys sorts.
+enum XlaCpuSortKeyKind {
+  // Two's complement integers.
+  kXlaCpuSortSignedKeys = 0,
+  // Unsigned integers.
+  kXlaCpuSortUnsignedKeys = 1,
+  // 32 or 64-bit IEEE floats ordered by operator<.
+  kXlaCpuSortFloatKeys = 2,
+  // IEEE floats in the total order -NaN < -Inf < ... < -0 < +0 < ... < +Inf
+  // < +NaN.
+  kXlaCpuSortFloatTotalOrderKeys = 3,
+};
+
+// Sorts the 'b' dimension of 'keys', a 3-dimensional shape [a, b, c] as in
+// __xla_cpu_runtime_KeyValueSort, for a sort without values whose comparator
+// compares its two parameters with less-than, or with greater-than if
+// 'descending' is true. 'key_kind' is an XlaCpuSortKeyKind and
+// 'key_size_in_bytes' the size of a key. Equal keys stay in order if
+// 'is_stable' is true. Uses the intra-op thread pool of 'run_options', an
+// xla::ExecutableRunOptions, if it has one.
+extern void __xla_cpu_runtime_SortPrimitiveKeys(
+    int64_t a, int64_t b, int64_t c, char* keys, int32_t key_kind,
+    int32_t key_size_in_bytes, bool descending, bool is_stable,
+    char* run_options);
 }
 
 #endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_RUNTIME_KEY_VALUE_SORT_H_
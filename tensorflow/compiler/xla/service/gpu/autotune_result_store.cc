@@ -0,0 +1,191 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_result_store.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+
+/*static*/ AutotuneResultStore& AutotuneResultStore::Global() {
+  static auto* store = new AutotuneResultStore();
+  return *store;
+}
+
+/*static*/ std::string AutotuneResultStore::DeviceKey(
+    se::StreamExecutor* executor) {
+  const se::DeviceDescription& desc = executor->GetDeviceDescription();
+  se::CudaComputeCapability cc = desc.cuda_compute_capability();
+  std::string key =
+      absl::StrCat(desc.name(), ", sm_", cc.major, cc.minor, ", driver ",
+                   desc.driver_version(), ", runtime ", desc.runtime_version());
+  if (auto* dnn = executor->AsDnn()) {
+    StatusOr<se::dnn::VersionInfo> version = dnn->GetVersion();
+    if (version.ok()) {
+      absl::StrAppend(&key, ", cudnn ", version->major_version(), ".",
+                      version->minor_version(), ".", version->patch());
+    }
+  }
+  if (auto* blas = executor->AsBlas()) {
+    std::string blas_version;
+    if (blas->GetVersion(&blas_version).ok()) {
+      absl::StrAppend(&key, ", blas ", blas_version);
+    }
+  }
+  return key;
+}
+
+absl::optional<tensorflow::AutotuneResult> AutotuneResultStore::Lookup(
+    Kind kind, absl::string_view device, absl::string_view hlo) {
+  absl::MutexLock lock(&mu_);
+  auto it = results_.find(Key(kind, std::string(device), std::string(hlo)));
+  if (it == results_.end()) {
+    return absl::nullopt;
+  }
+  return it->second;
+}
+
+void AutotuneResultStore::Insert(Kind kind, absl::string_view device,
+                                 absl::string_view hlo,
+                                 const tensorflow::AutotuneResult& result) {
+  absl::MutexLock lock(&mu_);
+  if (results_.emplace(Key(kind, std::string(device), std::string(hlo)), result)
+          .second) {
+    changed_ = true;
+  }
+}
+
+Status AutotuneResultStore::Merge(const AutotuneResults& results) {
+  if (results.version() != kVersion) {
+    return InvalidArgument(
+        "Autotune results have version %d, but version %d is expected.",
+        results.version(), kVersion);
+  }
+  absl::MutexLock lock(&mu_);
+  for (const auto& entry : results.convs()) {
+    results_.emplace(Key(Kind::kConv, entry.device(), entry.hlo()),
+                     entry.result());
+  }
+  for (const auto& entry : results.gemms()) {
+    results_.emplace(Key(Kind::kGemm, entry.device(), entry.hlo()),
+                     entry.result());
+  }
+  return Status::OK();
+}
+
+AutotuneResults AutotuneResultStore::Serialize() {
+  absl::MutexLock lock(&mu_);
+  std::vector<const Key*> keys;
+  keys.reserve(results_.size());
+  for (const auto& it : results_) {
+    keys.push_back(&it.first);
+  }
+  std::sort(keys.begin(), keys.end(),
+            [](const Key* a, const Key* b) { return *a < *b; });
+
+  AutotuneResults results;
+  results.set_version(kVersion);
+  for (const Key* key : keys) {
+    AutotuneResults::Entry* entry = std::get<0>(*key) == Kind::kConv
+                                        ? results.add_convs()
+                                        : results.add_gemms();
+    entry->set_device(std::get<1>(*key));
+    entry->set_hlo(std::get<2>(*key));
+    *entry->mutable_result() = results_.at(*key);
+  }
+  return results;
+}
+
+// Writes to a temporary file and renames it over `path`, so readers never see
+// a partially written file.
+static Status WriteToFile(const std::string& path,
+                          const AutotuneResults& results) {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  std::string tmp_path = path;
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return InternalError("Could not create a temporary file name for %s",
+                         path);
+  }
+  if (absl::EndsWith(path, ".pbtxt")) {
+    TF_RETURN_IF_ERROR(tensorflow::WriteTextProto(env, tmp_path, results));
+  } else {
+    TF_RETURN_IF_ERROR(tensorflow::WriteBinaryProto(env, tmp_path, results));
+  }
+  return env->RenameFile(tmp_path, path);
+}
+
+Status AutotuneResultStore::LoadFromFile(const std::string& path) {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  if (!env->FileExists(path).ok()) {
+    return Status::OK();
+  }
+  AutotuneResults results;
+  TF_RETURN_IF_ERROR(tensorflow::ReadTextOrBinaryProto(env, path, &results));
+  TF_RETURN_IF_ERROR(Merge(results));
+  VLOG(1) << "Loaded " << results.convs_size() << " convolution and "
+          << results.gemms_size() << " GEMM autotuning results from " << path;
+  return Status::OK();
+}
+
+Status AutotuneResultStore::LoadFromFileOnce(const std::string& path) {
+  {
+    absl::MutexLock lock(&mu_);
+    if (!loaded_paths_.insert(path).second) {
+      return Status::OK();
+    }
+  }
+  return LoadFromFile(path);
+}
+
+Status AutotuneResultStore::SaveToFileIfChanged(const std::string& path) {
+  {
+    absl::MutexLock lock(&mu_);
+    if (!changed_) {
+      return Status::OK();
+    }
+    changed_ = false;
+  }
+
+  // Pick up whatever other processes have written since we loaded the file.
+  Status merged = LoadFromFile(path);
+  if (!merged.ok()) {
+    LOG(WARNING) << "Overwriting unreadable autotune results in " << path
+                 << ": " << merged;
+  }
+
+  AutotuneResults results = Serialize();
+  Status written = WriteToFile(path, results);
+  if (!written.ok()) {
+    // Retry on the next save.
+    absl::MutexLock lock(&mu_);
+    changed_ = true;
+    return written;
+  }
+  VLOG(1) << "Saved " << results.convs_size() << " convolution and "
+          << results.gemms_size() << " GEMM autotuning results to " << path;
+  return Status::OK();
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,97 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_RESULT_STORE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_RESULT_STORE_H_
+
+#include <string>
+#include <tuple>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_autotuning.pb.h"
+#include "tensorflow/compiler/xla/status.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+#include "tensorflow/core/protobuf/autotuning.pb.h"
+
+namespace xla {
+namespace gpu {
+
+// Process-wide store of autotuning results that can be persisted to disk and
+// reloaded by later processes, so that GemmAlgorithmPicker and
+// GpuConvAlgorithmPicker only profile instructions they have not seen before
+// on a given device.
+//
+// Results are keyed by DeviceKey() and by an instruction description chosen
+// by the caller. When results are merged, entries already present win, so a
+// result never changes underneath a running process.
+class AutotuneResultStore {
+ public:
+  enum class Kind { kConv, kGemm };
+
+  // Bump when the meaning of keys or results changes; files written with a
+  // different version are ignored.
+  static constexpr int kVersion = 1;
+
+  static AutotuneResultStore& Global();
+
+  // Identifies the device, driver and libraries a result was measured with:
+  // device name, compute capability, driver version, cuDNN and BLAS versions.
+  static std::string DeviceKey(se::StreamExecutor* executor);
+
+  absl::optional<tensorflow::AutotuneResult> Lookup(Kind kind,
+                                                    absl::string_view device,
+                                                    absl::string_view hlo);
+  void Insert(Kind kind, absl::string_view device, absl::string_view hlo,
+              const tensorflow::AutotuneResult& result);
+
+  // Adds the entries of `results` that are not in the store yet. Returns an
+  // error, and adds nothing, if `results` has a different version.
+  Status Merge(const AutotuneResults& results);
+
+  // Returns all entries, sorted by key so the output is deterministic.
+  AutotuneResults Serialize();
+
+  // Merges the results in `path` into the store. A missing file is not an
+  // error. Only the first call for a given path reads the file.
+  Status LoadFromFileOnce(const std::string& path);
+
+  // Writes the store to `path` if anything was inserted since the last save.
+  // The current contents of `path` are merged in first, so concurrent
+  // processes sharing a file do not drop each other's results. The file is
+  // replaced atomically.
+  Status SaveToFileIfChanged(const std::string& path);
+
+ private:
+  using Key = std::tuple<Kind, std::string, std::string>;
+
+  Status LoadFromFile(const std::string& path);
+
+  absl::Mutex mu_;
+  absl::flat_hash_map<Key, tensorflow::AutotuneResult> results_
+      ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_set<std::string> loaded_paths_ ABSL_GUARDED_BY(mu_);
+  bool changed_ ABSL_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_RESULT_STORE_H_
@@ -0,0 +1,122 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_result_store.h"
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+using Kind = AutotuneResultStore::Kind;
+
+tensorflow::AutotuneResult GemmResult(int64_t algorithm) {
+  tensorflow::AutotuneResult result;
+  result.mutable_gemm()->set_algorithm(algorithm);
+  return result;
+}
+
+TEST(AutotuneResultStoreTest, LookupIsKeyedByKindDeviceAndHlo) {
+  AutotuneResultStore store;
+  store.Insert(Kind::kGemm, "dev0", "hlo", GemmResult(3));
+
+  absl::optional<tensorflow::AutotuneResult> found =
+      store.Lookup(Kind::kGemm, "dev0", "hlo");
+  ASSERT_TRUE(found.has_value());
+  EXPECT_EQ(found->gemm().algorithm(), 3);
+  EXPECT_FALSE(store.Lookup(Kind::kConv, "dev0", "hlo").has_value());
+  EXPECT_FALSE(store.Lookup(Kind::kGemm, "dev1", "hlo").has_value());
+  EXPECT_FALSE(store.Lookup(Kind::kGemm, "dev0", "other").has_value());
+}
+
+TEST(AutotuneResultStoreTest, MergeKeepsExistingEntries) {
+  AutotuneResultStore store;
+  store.Insert(Kind::kGemm, "dev0", "a", GemmResult(1));
+
+  AutotuneResults results;
+  results.set_version(AutotuneResultStore::kVersion);
+  AutotuneResults::Entry* entry = results.add_gemms();
+  entry->set_device("dev0");
+  entry->set_hlo("a");
+  *entry->mutable_result() = GemmResult(2);
+  entry = results.add_gemms();
+  entry->set_device("dev0");
+  entry->set_hlo("b");
+  *entry->mutable_result() = GemmResult(4);
+  TF_ASSERT_OK(store.Merge(results));
+
+  EXPECT_EQ(store.Lookup(Kind::kGemm, "dev0", "a")->gemm().algorithm(), 1);
+  EXPECT_EQ(store.Lookup(Kind::kGemm, "dev0", "b")->gemm().algorithm(), 4);
+}
+
+TEST(AutotuneResultStoreTest, MergeRejectsOtherVersions) {
+  AutotuneResultStore store;
+  AutotuneResults results;
+  results.set_version(AutotuneResultStore::kVersion + 1);
+  results.add_convs()->set_hlo("a");
+  EXPECT_FALSE(store.Merge(results).ok());
+  EXPECT_FALSE(store.Lookup(Kind::kConv, "", "a").has_value());
+}
+
+TEST(AutotuneResultStoreTest, SerializeIsSorted) {
+  AutotuneResultStore store;
+  store.Insert(Kind::kConv, "dev1", "b", tensorflow::AutotuneResult());
+  store.Insert(Kind::kConv, "dev0", "c", tensorflow::AutotuneResult());
+  store.Insert(Kind::kConv, "dev1", "a", tensorflow::AutotuneResult());
+  store.Insert(Kind::kGemm, "dev0", "d", GemmResult(1));
+
+  AutotuneResults results = store.Serialize();
+  EXPECT_EQ(results.version(), AutotuneResultStore::kVersion);
+  ASSERT_EQ(results.convs_size(), 3);
+  EXPECT_EQ(results.convs(0).hlo(), "c");
+  EXPECT_EQ(results.convs(1).hlo(), "a");
+  EXPECT_EQ(results.convs(2).hlo(), "b");
+  ASSERT_EQ(results.gemms_size(), 1);
+  EXPECT_EQ(results.gemms(0).hlo(), "d");
+}
+
+TEST(AutotuneResultStoreTest, SaveMergesWithFileAndReloads) {
+  for (const char* ext : {".pb", ".pbtxt"}) {
+    std::string path = tensorflow::io::JoinPath(
+        tensorflow::testing::TmpDir(), absl::StrCat("autotune_results", ext));
+
+    // Two processes that autotuned different instructions.
+    AutotuneResultStore first;
+    TF_ASSERT_OK(first.LoadFromFileOnce(path));
+    first.Insert(Kind::kGemm, "dev0", "a", GemmResult(1));
+    TF_ASSERT_OK(first.SaveToFileIfChanged(path));
+
+    AutotuneResultStore second;
+    second.Insert(Kind::kGemm, "dev0", "b", GemmResult(2));
+    TF_ASSERT_OK(second.SaveToFileIfChanged(path));
+
+    AutotuneResultStore reloaded;
+    TF_ASSERT_OK(reloaded.LoadFromFileOnce(path));
+    EXPECT_EQ(reloaded.Lookup(Kind::kGemm, "dev0", "a")->gemm().algorithm(),
+              1);
+    EXPECT_EQ(reloaded.Lookup(Kind::kGemm, "dev0", "b")->gemm().algorithm(),
+              2);
+    TF_ASSERT_OK(tensorflow::Env::Default()->DeleteFile(path));
+  }
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
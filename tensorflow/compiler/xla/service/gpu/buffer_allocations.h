@@ -52,6 +52,9 @@ class BufferAllocations {
   }
   int device_ordinal() const { return device_ordinal_; }
 
+  // Returns the number of buffers, including those not assigned an address.
+  int64_t buffer_count() const { return buffers_.size(); }
+
   // Returns the device address of buffer `buffer_index`. `buffer_index` must be
   // a valid index, i.e., in [0, buffer_count). This function returns null if
   // `buffer_index` is not assigned to a buffer address.
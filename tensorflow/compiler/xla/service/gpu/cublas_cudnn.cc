@@ -25,6 +25,7 @@ bool IsCublasGemm(const HloInstruction& hlo) {
 
 const char* const kGemmCallTarget = "__cublas$gemm";
 const char* const kTriangularSolveCallTarget = "__cublas$triangularSolve";
+const char* const kFusedAttentionCallTarget = "__xla$fusedAttention";
 const char* const kCudnnConvForwardCallTarget = "__cudnn$convForward";
 const char* const kCudnnConvBackwardInputCallTarget =
     "__cudnn$convBackwardInput";
@@ -62,6 +62,13 @@ extern const char* const kGemmCallTarget;
 // Like cudnn convolutions, this op returns a tuple (result, scratch_memory).
 extern const char* const kTriangularSolveCallTarget;
 
+// A call to XLA's fused multi-head attention kernel, which computes
+// softmax(scale * Q * K^T) * V without materializing the score matrix.
+//
+// The operands are Q, K and V, and the result has the shape of Q; see
+// FusedAttentionRewriter for the exact shapes and layouts.
+extern const char* const kFusedAttentionCallTarget;
+
 // A call to cuDNN for convolution (forward, backward filter, or backward input)
 // is represented as a CustomCall HLO with a call target equal to one of these
 // strings.
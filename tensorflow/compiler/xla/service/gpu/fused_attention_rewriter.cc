@@ -0,0 +1,253 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/fused_attention_rewriter.h"
+
+#include <numeric>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/layout_util.h"
+#include "tensorflow/compiler/xla/service/dfs_hlo_visitor_with_default.h"
+#include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
+#include "tensorflow/compiler/xla/service/gpu/cublas_cudnn.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/pattern_matcher.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/status_macros.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace m = match;
+
+// Limits of the fused attention kernel, see RunFusedAttention.
+constexpr int64_t kMaxHeadDim = 128;  // kFusedAttentionMaxHeadDim
+constexpr int64_t kMaxBatchSize = 65535;
+
+// Frameworks often run the softmax reductions in f32 for f16 inputs.  The
+// kernel accumulates in f32 anyway, so converts can be looked through.
+HloInstruction *SkipConverts(HloInstruction *instr) {
+  while (instr->opcode() == HloOpcode::kConvert) {
+    instr = instr->mutable_operand(0);
+  }
+  return instr;
+}
+
+// Returns true if `dnums` batches over the leading `rank - 2` dimensions of
+// both operands and contracts a single dimension of each.
+bool HasLeadingBatchDims(const DotDimensionNumbers &dnums, int64_t rank) {
+  if (dnums.lhs_batch_dimensions_size() != rank - 2 ||
+      dnums.rhs_batch_dimensions_size() != rank - 2 ||
+      dnums.lhs_contracting_dimensions_size() != 1 ||
+      dnums.rhs_contracting_dimensions_size() != 1) {
+    return false;
+  }
+  for (int64_t i = 0; i < rank - 2; ++i) {
+    if (dnums.lhs_batch_dimensions(i) != i ||
+        dnums.rhs_batch_dimensions(i) != i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the value of `instr` if it is a broadcast of a scalar constant.
+absl::optional<double> GetBroadcastedScalar(const HloInstruction *instr) {
+  const HloInstruction *constant;
+  if (!Match(instr, m::Broadcast(m::Constant(&constant))) ||
+      !ShapeUtil::IsEffectiveScalar(constant->shape())) {
+    return absl::nullopt;
+  }
+  return constant->literal().GetAsDouble(
+      std::vector<int64_t>(constant->shape().rank(), 0));
+}
+
+// If `bcast` broadcasts a `reduce_opcode` reduction over the minor-most
+// dimension back to the shape of its input, returns that input.
+HloInstruction *MatchRowReduction(HloInstruction *bcast,
+                                  HloOpcode reduce_opcode) {
+  const int64_t rank = bcast->shape().rank();
+  std::vector<int64_t> leading_dims(rank - 1);
+  std::iota(leading_dims.begin(), leading_dims.end(), 0);
+  if (bcast->opcode() != HloOpcode::kBroadcast ||
+      bcast->dimensions() != leading_dims) {
+    return nullptr;
+  }
+  HloInstruction *reduce = SkipConverts(bcast->mutable_operand(0));
+  if (reduce->opcode() != HloOpcode::kReduce || reduce->operand_count() != 2 ||
+      reduce->dimensions() != std::vector<int64_t>{rank - 1} ||
+      reduce->to_apply()->root_instruction()->opcode() != reduce_opcode) {
+    return nullptr;
+  }
+  return SkipConverts(reduce->mutable_operand(0));
+}
+
+// Returns `instr` with its two minor-most dimensions swapped.
+HloInstruction *SwapMinorDims(HloInstruction *instr) {
+  const int64_t rank = instr->shape().rank();
+  std::vector<int64_t> permutation(rank);
+  std::iota(permutation.begin(), permutation.end(), 0);
+  std::swap(permutation[rank - 1], permutation[rank - 2]);
+  return instr->parent()->AddInstruction(HloInstruction::CreateTranspose(
+      ShapeUtil::PermuteDimensions(permutation, instr->shape()), instr,
+      permutation));
+}
+
+class FusedAttentionVisitor : public DfsHloRewriteVisitor {
+ public:
+  Status HandleDot(HloInstruction *instr) override {
+    // output = dot(probs, v), contracting seq_k.
+    const Shape &output_shape = instr->shape();
+    const int64_t rank = output_shape.rank();
+    if (rank < 2 || (output_shape.element_type() != F16 &&
+                     output_shape.element_type() != F32)) {
+      return Status::OK();
+    }
+    const DotDimensionNumbers &pv_dnums = instr->dot_dimension_numbers();
+    if (!HasLeadingBatchDims(pv_dnums, rank) ||
+        pv_dnums.lhs_contracting_dimensions(0) != rank - 1) {
+      return Status::OK();
+    }
+    HloInstruction *v = instr->mutable_operand(1);
+    const bool v_transposed =
+        pv_dnums.rhs_contracting_dimensions(0) == rank - 1;
+
+    // probs = e / broadcast(reduce_add(e)).
+    HloInstruction *probs = SkipConverts(instr->mutable_operand(0));
+    HloInstruction *numerator;
+    HloInstruction *denominator;
+    if (instr->operand(0)->user_count() != 1 ||
+        !Match(probs, m::Divide(m::Op(&numerator), m::Op(&denominator)))) {
+      return Status::OK();
+    }
+    HloInstruction *exp = SkipConverts(numerator);
+    if (exp->opcode() != HloOpcode::kExp ||
+        MatchRowReduction(denominator, HloOpcode::kAdd) != exp) {
+      return Status::OK();
+    }
+
+    // e = exp(s - broadcast(reduce_max(s))) or exp(s).  The kernel always
+    // subtracts the running maximum, so both have the same result.
+    HloInstruction *scores = SkipConverts(exp->mutable_operand(0));
+    HloInstruction *max_bcast;
+    HloInstruction *unshifted;
+    if (Match(scores, m::Subtract(m::Op(&unshifted), m::Op(&max_bcast)))) {
+      unshifted = SkipConverts(unshifted);
+      if (MatchRowReduction(max_bcast, HloOpcode::kMaximum) != unshifted) {
+        return Status::OK();
+      }
+      scores = unshifted;
+    }
+
+    // s = dot(q, k) * scale, dot(q, k) / scale or dot(q, k).
+    double scale = 1.0;
+    HloInstruction *qk = scores;
+    HloInstruction *lhs;
+    HloInstruction *rhs;
+    if (Match(scores, m::MultiplyAnyOrder(m::Dot(&qk, m::Op(), m::Op()),
+                                          m::Op(&rhs)))) {
+      absl::optional<double> value = GetBroadcastedScalar(rhs);
+      if (!value) {
+        return Status::OK();
+      }
+      scale = *value;
+    } else if (Match(scores, m::Divide(m::Dot(&qk, m::Op(), m::Op()),
+                                       m::Op(&rhs)))) {
+      absl::optional<double> value = GetBroadcastedScalar(rhs);
+      if (!value || *value == 0.0) {
+        return Status::OK();
+      }
+      scale = 1.0 / *value;
+    }
+    if (qk->opcode() != HloOpcode::kDot || qk->shape().rank() != rank) {
+      return Status::OK();
+    }
+    const DotDimensionNumbers &qk_dnums = qk->dot_dimension_numbers();
+    if (!HasLeadingBatchDims(qk_dnums, rank) ||
+        qk_dnums.lhs_contracting_dimensions(0) != rank - 1) {
+      return Status::OK();
+    }
+    HloInstruction *q = qk->mutable_operand(0);
+    HloInstruction *k = qk->mutable_operand(1);
+    const bool k_transposed =
+        qk_dnums.rhs_contracting_dimensions(0) == rank - 2;
+
+    PrimitiveType type = output_shape.element_type();
+    if (q->shape().element_type() != type ||
+        k->shape().element_type() != type ||
+        v->shape().element_type() != type) {
+      return Status::OK();
+    }
+
+    const int64_t head_dim = q->shape().dimensions(rank - 1);
+    const int64_t seq_k = qk->shape().dimensions(rank - 1);
+    const int64_t batch_size = std::accumulate(
+        output_shape.dimensions().begin(), output_shape.dimensions().end() - 2,
+        int64_t{1}, [](int64_t a, int64_t b) { return a * b; });
+    if (head_dim > kMaxHeadDim ||
+        head_dim != output_shape.dimensions(rank - 1) || seq_k == 0 ||
+        batch_size > kMaxBatchSize) {
+      return Status::OK();
+    }
+
+    VLOG(2) << "Rewriting attention block ending in " << instr->ToString();
+
+    if (k_transposed) {
+      k = SwapMinorDims(k);
+    }
+    if (v_transposed) {
+      v = SwapMinorDims(v);
+    }
+    std::vector<HloInstruction *> operands = {q, k, v};
+    std::vector<Shape> operand_shapes;
+    for (HloInstruction *operand : operands) {
+      Shape shape = operand->shape();
+      LayoutUtil::SetToDefaultLayout(&shape);
+      operand_shapes.push_back(shape);
+    }
+    Shape call_shape = output_shape;
+    LayoutUtil::SetToDefaultLayout(&call_shape);
+
+    HloInstruction *call =
+        instr->parent()->AddInstruction(HloInstruction::CreateCustomCall(
+            call_shape, operands, kFusedAttentionCallTarget, operand_shapes));
+    FusedAttentionBackendConfig config;
+    config.set_scale(scale);
+    TF_RETURN_IF_ERROR(call->set_backend_config(config));
+    call->set_metadata(instr->metadata());
+    return ReplaceInstruction(instr, call);
+  }
+};
+
+}  // namespace
+
+StatusOr<bool> FusedAttentionRewriter::Run(HloModule *module) {
+  bool changed = false;
+  for (HloComputation *computation : module->MakeNonfusionComputations()) {
+    FusedAttentionVisitor visitor;
+    TF_RETURN_IF_ERROR(computation->Accept(&visitor));
+    changed |= visitor.changed();
+  }
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,49 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSED_ATTENTION_REWRITER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSED_ATTENTION_REWRITER_H_
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace gpu {
+
+// Rewrites scaled dot-product attention blocks of the form
+//
+//   s = dot(q, k^T) * scale
+//   p = exp(s - broadcast(reduce_max(s))) / broadcast(reduce_add(...))
+//   output = dot(p, v)
+//
+// into a kFusedAttentionCallTarget custom call, which computes the softmax
+// online and never writes the [seq_q, seq_k] scores to memory.  The max
+// subtraction and the scale are optional, and converts around the softmax
+// reductions are looked through.  All three dots must share the same leading
+// batch dimensions.  K and V are transposed to [batch..., seq_k, head_dim]
+// when they come in the other way around.
+class FusedAttentionRewriter : public HloModulePass {
+ public:
+  absl::string_view name() const override {
+    return "fused-attention-rewriter";
+  }
+
+  StatusOr<bool> Run(HloModule* module) override;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSED_ATTENTION_REWRITER_H_
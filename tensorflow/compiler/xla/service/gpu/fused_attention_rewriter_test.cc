@@ -0,0 +1,181 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/fused_attention_rewriter.h"
+
+#include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
+#include "tensorflow/compiler/xla/service/gpu/cublas_cudnn.h"
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+class FusedAttentionRewriterTest : public HloTestBase {};
+
+TEST_F(FusedAttentionRewriterTest, ScaledSoftmaxAttention) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test
+
+  max {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT max = f32[] maximum(x, y)
+  }
+
+  add {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT add = f32[] add(x, y)
+  }
+
+  ENTRY main {
+    q = f32[2,4,128,64] parameter(0)
+    k = f32[2,4,256,64] parameter(1)
+    v = f32[2,4,256,64] parameter(2)
+    qk = f32[2,4,128,256] dot(q, k), lhs_batch_dims={0,1},
+      rhs_batch_dims={0,1}, lhs_contracting_dims={3}, rhs_contracting_dims={3}
+    c = f32[] constant(0.125)
+    c_bcast = f32[2,4,128,256] broadcast(c), dimensions={}
+    s = f32[2,4,128,256] multiply(qk, c_bcast)
+    ninf = f32[] constant(-inf)
+    s_max = f32[2,4,128] reduce(s, ninf), dimensions={3}, to_apply=max
+    s_max_bcast = f32[2,4,128,256] broadcast(s_max), dimensions={0,1,2}
+    shifted = f32[2,4,128,256] subtract(s, s_max_bcast)
+    e = f32[2,4,128,256] exponential(shifted)
+    zero = f32[] constant(0)
+    sum = f32[2,4,128] reduce(e, zero), dimensions={3}, to_apply=add
+    sum_bcast = f32[2,4,128,256] broadcast(sum), dimensions={0,1,2}
+    p = f32[2,4,128,256] divide(e, sum_bcast)
+    ROOT out = f32[2,4,128,64] dot(p, v), lhs_batch_dims={0,1},
+      rhs_batch_dims={0,1}, lhs_contracting_dims={3}, rhs_contracting_dims={2}
+  })")
+                    .ValueOrDie();
+  ASSERT_TRUE(FusedAttentionRewriter().Run(module.get()).ValueOrDie());
+  SCOPED_TRACE(module->ToString());
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, op::CustomCall(kFusedAttentionCallTarget, op::Parameter(0),
+                                   op::Parameter(1), op::Parameter(2)));
+  FusedAttentionBackendConfig config =
+      root->backend_config<FusedAttentionBackendConfig>().ValueOrDie();
+  EXPECT_EQ(config.scale(), 0.125);
+}
+
+TEST_F(FusedAttentionRewriterTest, HalfSoftmaxWithConvertsAndTransposedK) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test
+
+  add {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT add = f32[] add(x, y)
+  }
+
+  ENTRY main {
+    q = f16[8,32,64] parameter(0)
+    k = f16[8,64,48] parameter(1)
+    v = f16[8,48,64] parameter(2)
+    qk = f16[8,32,48] dot(q, k), lhs_batch_dims={0}, rhs_batch_dims={0},
+      lhs_contracting_dims={2}, rhs_contracting_dims={1}
+    c = f16[] constant(8)
+    c_bcast = f16[8,32,48] broadcast(c), dimensions={}
+    s = f16[8,32,48] divide(qk, c_bcast)
+    e = f16[8,32,48] exponential(s)
+    e_f32 = f32[8,32,48] convert(e)
+    zero = f32[] constant(0)
+    sum_f32 = f32[8,32] reduce(e_f32, zero), dimensions={2}, to_apply=add
+    sum = f16[8,32] convert(sum_f32)
+    sum_bcast = f16[8,32,48] broadcast(sum), dimensions={0,1}
+    p = f16[8,32,48] divide(e, sum_bcast)
+    ROOT out = f16[8,32,64] dot(p, v), lhs_batch_dims={0}, rhs_batch_dims={0},
+      lhs_contracting_dims={2}, rhs_contracting_dims={1}
+  })")
+                    .ValueOrDie();
+  ASSERT_TRUE(FusedAttentionRewriter().Run(module.get()).ValueOrDie());
+  SCOPED_TRACE(module->ToString());
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, op::CustomCall(kFusedAttentionCallTarget, op::Parameter(0),
+                                   op::Transpose(op::Parameter(1)),
+                                   op::Parameter(2)));
+  FusedAttentionBackendConfig config =
+      root->backend_config<FusedAttentionBackendConfig>().ValueOrDie();
+  EXPECT_EQ(config.scale(), 0.125);
+}
+
+TEST_F(FusedAttentionRewriterTest, MaskedSoftmaxNotRewritten) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test
+
+  add {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT add = f32[] add(x, y)
+  }
+
+  ENTRY main {
+    q = f32[8,32,64] parameter(0)
+    k = f32[8,48,64] parameter(1)
+    v = f32[8,48,64] parameter(2)
+    mask = f32[8,32,48] parameter(3)
+    qk = f32[8,32,48] dot(q, k), lhs_batch_dims={0}, rhs_batch_dims={0},
+      lhs_contracting_dims={2}, rhs_contracting_dims={2}
+    s = f32[8,32,48] add(qk, mask)
+    e = f32[8,32,48] exponential(s)
+    zero = f32[] constant(0)
+    sum = f32[8,32] reduce(e, zero), dimensions={2}, to_apply=add
+    sum_bcast = f32[8,32,48] broadcast(sum), dimensions={0,1}
+    p = f32[8,32,48] divide(e, sum_bcast)
+    ROOT out = f32[8,32,64] dot(p, v), lhs_batch_dims={0}, rhs_batch_dims={0},
+      lhs_contracting_dims={2}, rhs_contracting_dims={1}
+  })")
+                    .ValueOrDie();
+  EXPECT_FALSE(FusedAttentionRewriter().Run(module.get()).ValueOrDie());
+}
+
+TEST_F(FusedAttentionRewriterTest, LargeHeadDimNotRewritten) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test
+
+  add {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT add = f32[] add(x, y)
+  }
+
+  ENTRY main {
+    q = f32[8,32,256] parameter(0)
+    k = f32[8,48,256] parameter(1)
+    v = f32[8,48,256] parameter(2)
+    qk = f32[8,32,48] dot(q, k), lhs_batch_dims={0}, rhs_batch_dims={0},
+      lhs_contracting_dims={2}, rhs_contracting_dims={2}
+    e = f32[8,32,48] exponential(qk)
+    zero = f32[] constant(0)
+    sum = f32[8,32] reduce(e, zero), dimensions={2}, to_apply=add
+    sum_bcast = f32[8,32,48] broadcast(sum), dimensions={0,1}
+    p = f32[8,32,48] divide(e, sum_bcast)
+    ROOT out = f32[8,32,256] dot(p, v), lhs_batch_dims={0}, rhs_batch_dims={0},
+      lhs_contracting_dims={2}, rhs_contracting_dims={1}
+  })")
+                    .ValueOrDie();
+  EXPECT_FALSE(FusedAttentionRewriter().Run(module.get()).ValueOrDie());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,63 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/fused_attention_thunk.h"
+
+#include "tensorflow/compiler/xla/service/gpu/precompiled_kernels.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/stream_executor/device_memory.h"
+
+namespace xla {
+namespace gpu {
+
+FusedAttentionThunk::FusedAttentionThunk(
+    ThunkInfo thunk_info, se::GpuAsmOpts asm_opts,
+    const BufferAllocation::Slice& q_buffer,
+    const BufferAllocation::Slice& k_buffer,
+    const BufferAllocation::Slice& v_buffer,
+    const BufferAllocation::Slice& output_buffer, PrimitiveType type,
+    int64_t batch_size, int64_t seq_q, int64_t seq_k, int64_t head_dim,
+    float scale)
+    : Thunk(Kind::kFusedAttention, thunk_info),
+      asm_opts_(asm_opts),
+      q_buffer_(q_buffer),
+      k_buffer_(k_buffer),
+      v_buffer_(v_buffer),
+      output_buffer_(output_buffer),
+      type_(type),
+      batch_size_(batch_size),
+      seq_q_(seq_q),
+      seq_k_(seq_k),
+      head_dim_(head_dim),
+      scale_(scale) {}
+
+Status FusedAttentionThunk::ExecuteOnStream(const ExecuteParams& params) {
+  const BufferAllocations& buffer_allocations = *params.buffer_allocations;
+
+  VLOG(3) << "batch_size=" << batch_size_ << " seq_q=" << seq_q_
+          << " seq_k=" << seq_k_ << " head_dim=" << head_dim_
+          << " scale=" << scale_;
+
+  return RunFusedAttention(
+      params.stream, asm_opts_, type_,
+      buffer_allocations.GetDeviceAddress(q_buffer_),
+      buffer_allocations.GetDeviceAddress(k_buffer_),
+      buffer_allocations.GetDeviceAddress(v_buffer_),
+      buffer_allocations.GetDeviceAddress(output_buffer_), batch_size_, seq_q_,
+      seq_k_, head_dim_, scale_);
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,72 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSED_ATTENTION_THUNK_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSED_ATTENTION_THUNK_H_
+
+#include "tensorflow/compiler/xla/service/buffer_assignment.h"
+#include "tensorflow/compiler/xla/service/gpu/thunk.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/stream_executor/gpu/gpu_asm_opts.h"
+
+namespace xla {
+namespace gpu {
+
+// Launches the fused attention kernel, computing
+//
+//   output = softmax(scale * q * k^T) * v
+//
+// for each of `batch_size` row-major [seq_q, head_dim] queries and
+// [seq_k, head_dim] keys and values.  It is generated by IrEmitter for
+// kFusedAttentionCallTarget custom calls.
+//
+// Thread-compatible.
+class FusedAttentionThunk : public Thunk {
+ public:
+  FusedAttentionThunk(ThunkInfo thunk_info, se::GpuAsmOpts asm_opts,
+                      const BufferAllocation::Slice& q_buffer,
+                      const BufferAllocation::Slice& k_buffer,
+                      const BufferAllocation::Slice& v_buffer,
+                      const BufferAllocation::Slice& output_buffer,
+                      PrimitiveType type, int64_t batch_size, int64_t seq_q,
+                      int64_t seq_k, int64_t head_dim, float scale);
+
+  FusedAttentionThunk(const FusedAttentionThunk&) = delete;
+  FusedAttentionThunk& operator=(const FusedAttentionThunk&) = delete;
+
+  Status ExecuteOnStream(const ExecuteParams& params) override;
+
+ private:
+  se::GpuAsmOpts asm_opts_;
+
+  const BufferAllocation::Slice q_buffer_;
+  const BufferAllocation::Slice k_buffer_;
+  const BufferAllocation::Slice v_buffer_;
+  const BufferAllocation::Slice output_buffer_;
+
+  const PrimitiveType type_;
+  const int64_t batch_size_;
+  const int64_t seq_q_;
+  const int64_t seq_k_;
+  const int64_t head_dim_;
+  const float scale_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSED_ATTENTION_THUNK_H_
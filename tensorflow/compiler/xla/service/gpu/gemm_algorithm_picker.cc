@@ -18,6 +18,7 @@ limitations under the License.
 #include <limits>
 #include <string>
 
+#include "tensorflow/compiler/xla/service/gpu/autotune_result_store.h"
 #include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_comparator.h"
 #include "tensorflow/compiler/xla/service/gpu/gemm_thunk.h"
@@ -145,6 +146,12 @@ Status DoBlasPlansAutotune(se::Stream* stream, const HloInstruction* instr,
                       get_initialized_buffer(instr->operand(1)));
   TF_ASSIGN_OR_RETURN(se::DeviceMemoryBase output_buffer,
                       get_initialized_buffer(instr));
+  se::DeviceMemoryBase bias_buffer;
+  if (EpilogueAddsBias(gemm_config.epilogue())) {
+    TF_ASSIGN_OR_RETURN(bias_buffer,
+                        get_initialized_buffer(instr->operands().back()));
+  }
+  se::blas::Epilogue epilogue = BlasLtEpilogue(gemm_config.epilogue());
 
   const Shape& output_shape = config.output_shape;
   PrimitiveType element_type = output_shape.element_type();
@@ -178,12 +185,13 @@ Status DoBlasPlansAutotune(se::Stream* stream, const HloInstruction* instr,
   se::BatchMatmulParameters matmul_parameters(
       trans_x, trans_y, false, false, m, n, k, batch_size,
       /*broadcast_a*/ broadcast, /*broadcast_b*/ broadcast, dtype, dtype,
-      device_id);
+      device_id, epilogue);
 
   TF_ASSIGN_OR_RETURN(
       const se::blas::PlanAndAlgorithms* plan_and_algorithms,
       se::GetPlanAndAlgorithms(stream, matmul_parameters, batch_size, dtype,
-                               lhs_matrix, rhs_matrix, output_matrix));
+                               lhs_matrix, rhs_matrix, output_matrix,
+                               epilogue));
 
   const std::vector<std::unique_ptr<se::blas::IBlasLtMatmulAlgorithm>>&
       algorithms = plan_and_algorithms->algorithms;
@@ -213,8 +221,8 @@ Status DoBlasPlansAutotune(se::Stream* stream, const HloInstruction* instr,
       }
 
       TF_RETURN_IF_ERROR(
-          RunGemm(config, lhs_buffer, rhs_buffer, output_buffer, stream,
-                  /*scratch allocator=*/&scratch_allocator,
+          RunGemm(config, lhs_buffer, rhs_buffer, output_buffer, bias_buffer,
+                  stream, /*scratch allocator=*/&scratch_allocator,
                   /*algorithm_being_profiled=*/algorithms[i].get(),
                   /*profile_result=*/&profile_result, absl::nullopt));
 
@@ -273,6 +281,12 @@ static StatusOr<absl::optional<se::blas::AlgorithmType>> DoUncachedGemmAutotune(
     return InternalError("Failed to synchronize GPU for autotuning.");
   }
 
+  GemmBackendConfig backend_config =
+      gemm->backend_config<GemmBackendConfig>().ValueOrDie();
+  if (backend_config.epilogue() != GemmBackendConfig::DEFAULT) {
+    return InternalError("GEMM epilogues require cuBLASLt.");
+  }
+
   const HloModuleConfig& hlo_module_config = gemm->GetModule()->config();
   const int32_t cublas_autotune_level =
       hlo_module_config.debug_options().xla_gpu_autotune_level();
@@ -317,9 +331,6 @@ static StatusOr<absl::optional<se::blas::AlgorithmType>> DoUncachedGemmAutotune(
   const bool crash_on_checking_failure =
       debug_options.xla_gpu_crash_on_verification_failures();
 
-  GemmBackendConfig backend_config =
-      gemm->backend_config<GemmBackendConfig>().ValueOrDie();
-
   std::vector<se::blas::AlgorithmType> algorithms;
   CHECK(stream->parent()->GetBlasGemmAlgorithms(&algorithms));
 
@@ -342,7 +353,8 @@ static StatusOr<absl::optional<se::blas::AlgorithmType>> DoUncachedGemmAutotune(
     // for all algorithms if we're targeting < sm_50.  But because we pass a
     // non-null ProfileResult, DoGemmWithAlgorithm should always return true,
     // and the actual success-ness is returned in ProfileResult::is_valid.
-    Status st = RunGemm(config, lhs_buffer, rhs_buffer, output_buffer, stream,
+    Status st = RunGemm(config, lhs_buffer, rhs_buffer, output_buffer,
+                        /*bias_buffer=*/se::DeviceMemoryBase(), stream,
                         /*scratch allocator=*/nullptr,
                         /* algorithm_being_profiled=*/nullptr,
                         /*profile_result=*/&profile_result, algorithm);
@@ -462,6 +474,33 @@ static StatusOr<absl::optional<se::blas::AlgorithmType>> DoGemmAutotune(
     cache_misses++;
     VLOG(4) << "Autotuning cache miss";
 
+    // Results persisted by earlier processes are keyed by the device rather
+    // than the StreamExecutor, and by a textual form of the cache key.
+    const std::string& results_path = instr->GetModule()
+                                          ->config()
+                                          .debug_options()
+                                          .xla_gpu_autotune_results_path();
+    std::string device_key, hlo_key;
+    if (!results_path.empty()) {
+      device_key = AutotuneResultStore::DeviceKey(stream->parent());
+      hlo_key = absl::StrCat(
+          lhs->shape().ToString(/*print_layout=*/true), ", ",
+          rhs->shape().ToString(/*print_layout=*/true), ", ",
+          instr->shape().ToString(/*print_layout=*/true), ", ",
+          gemm_config.ShortDebugString());
+      if (absl::optional<AutotuneResult> stored =
+              AutotuneResultStore::Global().Lookup(
+                  AutotuneResultStore::Kind::kGemm, device_key, hlo_key)) {
+        absl::optional<se::blas::AlgorithmType> result;
+        if (stored->has_gemm()) {
+          result = stored->gemm().algorithm();
+        }
+        VLOG(4) << "Using stored autotuning result for " << hlo_key;
+        CHECK(autotune_cache.emplace(key, result).second);
+        return result;
+      }
+    }
+
     // Make sure any previous activity on this executor is done. We don't want
     // other work still running on the GPU to interfere with autotuning.
     if (!stream->parent()->SynchronizeAllActivity()) {
@@ -476,6 +515,14 @@ static StatusOr<absl::optional<se::blas::AlgorithmType>> DoGemmAutotune(
                         DoUncachedGemmAutotune(instr, stream, allocator));
 
     CHECK(autotune_cache.emplace(key, result).second);
+    if (!results_path.empty()) {
+      AutotuneResult stored;
+      if (result) {
+        stored.mutable_gemm()->set_algorithm(*result);
+      }
+      AutotuneResultStore::Global().Insert(AutotuneResultStore::Kind::kGemm,
+                                           device_key, hlo_key, stored);
+    }
     return result;
   }
 }
@@ -528,12 +575,30 @@ StatusOr<bool> GemmAlgorithmPicker::Run(HloModule* module) {
     return false;
   }
 
+  // Failing to read or write the results file only costs autotuning time, so
+  // it does not fail compilation.
+  const std::string& results_path =
+      module->config().debug_options().xla_gpu_autotune_results_path();
+  if (!results_path.empty()) {
+    Status loaded =
+        AutotuneResultStore::Global().LoadFromFileOnce(results_path);
+    LOG_IF(WARNING, !loaded.ok())
+        << "Failed to load autotune results: " << loaded;
+  }
+
   bool changed = false;
   for (HloComputation* computation : module->MakeNonfusionComputations()) {
     TF_ASSIGN_OR_RETURN(
         bool result, RunOnComputation(computation, stream_exec_, allocator_));
     changed |= result;
   }
+
+  if (!results_path.empty()) {
+    Status saved =
+        AutotuneResultStore::Global().SaveToFileIfChanged(results_path);
+    LOG_IF(WARNING, !saved.ok())
+        << "Failed to save autotune results: " << saved;
+  }
   return changed;
 }
 
@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/gpu/gemm_rewriter.h"
 
+#include <cmath>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/compiler/xla/layout_util.h"
 #include "tensorflow/compiler/xla/service/dfs_hlo_visitor_with_default.h"
 #include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/cublas_cudnn.h"
@@ -28,12 +33,23 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/stream_executor/lib/statusor.h"
 
+#if GOOGLE_CUDA
+#include "third_party/gpus/cuda/include/cuda.h"
+#endif
+
 namespace xla {
 namespace gpu {
 namespace {
 
 namespace m = match;
 
+// cuBLASLt provides the GELU epilogues from CUDA 11.4 on.
+#if GOOGLE_CUDA && CUDA_VERSION >= 11040
+constexpr bool kGeluEpilogueSupported = true;
+#else
+constexpr bool kGeluEpilogueSupported = false;
+#endif
+
 // Give this instruction a more useful name than "custom-call.42".
 Status SetName(HloModule *module, HloInstruction *gemm) {
   GemmBackendConfig config;
@@ -45,6 +61,17 @@ Status SetName(HloModule *module, HloInstruction *gemm) {
   return Status::OK();
 }
 
+// Matches a broadcast of a scalar constant within a relative 1e-3 of `value`,
+// so that constants rounded to f16 still match.
+auto BroadcastOfConstantNear(double value) {
+  return m::Broadcast(m::ConstantScalar().WithPredicate(
+      [value](const HloInstruction *constant) {
+        absl::optional<double> actual = constant->literal().GetAsDouble({});
+        return actual.has_value() &&
+               std::abs(*actual - value) <= 1e-3 * std::abs(value);
+      }));
+}
+
 // The rewriting proceeds in a bottom-up way:
 //
 // (kDot A B) is rewritten into a (kCustomCall:gemm A B)
@@ -57,8 +84,15 @@ Status SetName(HloModule *module, HloInstruction *gemm) {
 // and provided C has no other users).
 // We then guide the buffer assignment to alias the buffer of the custom call
 // and C.
+//
+// With cuBLASLt, (kAdd (kCustomCall:gemm A B) (kBroadcast v)),
+// (kMaximum (kCustomCall:gemm A B) 0) and GELU(kCustomCall:gemm A B) are
+// folded into the epilogue of the custom call instead.
 class GemmRewriterVisitor : public DfsHloRewriteVisitor {
  public:
+  explicit GemmRewriterVisitor(bool enable_cublaslt)
+      : enable_cublaslt_(enable_cublaslt) {}
+
   Status HandleDot(HloInstruction *instr) override {
     if (IsMatrixMultiplication(*instr)) {
       CHECK(!instr->IsRank2Transpose());
@@ -100,6 +134,10 @@ class GemmRewriterVisitor : public DfsHloRewriteVisitor {
 
   Status HandleMultiply(HloInstruction *instr) override {
     HloInstruction *alpha, *existing_gemm;
+    if (enable_cublaslt_ && kGeluEpilogueSupported &&
+        MatchApproximateGelu(instr, &existing_gemm)) {
+      return FuseEpilogue(instr, existing_gemm, GemmBackendConfig::GELU);
+    }
     if (Match(instr,
               m::MultiplyAnyOrder(
                   m::Op(&existing_gemm).WithCustomCallTarget(kGemmCallTarget),
@@ -113,7 +151,8 @@ class GemmRewriterVisitor : public DfsHloRewriteVisitor {
         return Status::OK();
       }
 
-      if (config.beta() == 0.0 && existing_gemm->user_count() == 1) {
+      if (config.beta() == 0.0 && existing_gemm->user_count() == 1 &&
+          config.epilogue() == GemmBackendConfig::DEFAULT) {
         complex128 prev_alpha = {config.alpha_real(), config.alpha_imag()};
         complex128 new_alpha =
             *alpha->literal().GetAsComplex128({}) * prev_alpha;
@@ -127,7 +166,18 @@ class GemmRewriterVisitor : public DfsHloRewriteVisitor {
   }
 
   Status HandleAdd(HloInstruction *instr) override {
-    HloInstruction *bias, *existing_gemm;
+    HloInstruction *bias, *existing_gemm, *bcast;
+    if (enable_cublaslt_ &&
+        Match(instr, m::AddAnyOrder(m::Op(&existing_gemm)
+                                        .WithCustomCallTarget(kGemmCallTarget)
+                                        .WithOneUser(),
+                                    m::Broadcast(&bcast, m::Op(&bias))))) {
+      TF_ASSIGN_OR_RETURN(bool fused,
+                          FuseVectorBias(instr, bcast, bias, existing_gemm));
+      if (fused) {
+        return Status::OK();
+      }
+    }
     if (Match(instr,
               m::AddAnyOrder(
                   m::Op(&existing_gemm).WithCustomCallTarget(kGemmCallTarget),
@@ -137,6 +187,19 @@ class GemmRewriterVisitor : public DfsHloRewriteVisitor {
     return Status::OK();
   }
 
+  Status HandleMaximum(HloInstruction *instr) override {
+    HloInstruction *existing_gemm;
+    if (enable_cublaslt_ &&
+        Match(instr,
+              m::MaximumAnyOrder(m::Op(&existing_gemm)
+                                     .WithCustomCallTarget(kGemmCallTarget)
+                                     .WithOneUser(),
+                                 m::Broadcast(m::ConstantScalar(0))))) {
+      return FuseEpilogue(instr, existing_gemm, GemmBackendConfig::RELU);
+    }
+    return Status::OK();
+  }
+
   Status HandleConvert(HloInstruction *instr) override {
     HloInstruction *bias, *existing_gemm;
     if (Match(
@@ -161,7 +224,8 @@ class GemmRewriterVisitor : public DfsHloRewriteVisitor {
     }
     auto config =
         existing_gemm->backend_config<GemmBackendConfig>().ValueOrDie();
-    if (config.beta() == 0 && bias->user_count() == 1 &&
+    if (config.beta() == 0 && config.epilogue() == GemmBackendConfig::DEFAULT &&
+        bias->user_count() == 1 &&
         existing_gemm->user_count() == 1 &&
         bias->shape() == existing_gemm->shape()) {
       config.set_beta(1.0);
@@ -177,10 +241,163 @@ class GemmRewriterVisitor : public DfsHloRewriteVisitor {
     }
     return Status::OK();
   }
+
+ private:
+  // Folds `bias`, which `bcast` broadcasts to the shape of `existing_gemm`,
+  // into the cuBLASLt bias epilogue.  cuBLASLt adds the bias along the rows of
+  // its column-major output, which is the minor-most dimension of ours.
+  StatusOr<bool> FuseVectorBias(HloInstruction *instr, HloInstruction *bcast,
+                                HloInstruction *bias,
+                                HloInstruction *existing_gemm) {
+    TF_ASSIGN_OR_RETURN(auto config,
+                        existing_gemm->backend_config<GemmBackendConfig>());
+    const Shape &shape = existing_gemm->shape();
+    if (config.beta() != 0 || config.epilogue() != GemmBackendConfig::DEFAULT ||
+        !SupportsEpilogue(shape.element_type()) ||
+        !LayoutUtil::HasLayout(shape) || bias->shape().rank() != 1 ||
+        shape.rank() < 2) {
+      return false;
+    }
+    int64_t minor_dim = LayoutUtil::Minor(shape.layout(), 0);
+    if (minor_dim < shape.rank() - 2 || bcast->dimensions().size() != 1 ||
+        bcast->dimensions(0) != minor_dim) {
+      return false;
+    }
+    config.set_epilogue(GemmBackendConfig::BIAS);
+    std::unique_ptr<HloInstruction> gemm_call =
+        existing_gemm->CloneWithNewOperands(
+            instr->shape(), {existing_gemm->mutable_operand(0),
+                             existing_gemm->mutable_operand(1), bias});
+    TF_RETURN_IF_ERROR(gemm_call->set_backend_config(config));
+    TF_RETURN_IF_ERROR(SetName(instr->GetModule(), gemm_call.get()));
+    TF_RETURN_IF_ERROR(ReplaceWithNewInstruction(instr, std::move(gemm_call)));
+    return true;
+  }
+
+  // Replaces `instr`, an activation of `existing_gemm`, with a copy of
+  // `existing_gemm` applying `activation` (RELU or GELU) in its epilogue.
+  Status FuseEpilogue(HloInstruction *instr, HloInstruction *existing_gemm,
+                      GemmBackendConfig::Epilogue activation) {
+    TF_ASSIGN_OR_RETURN(auto config,
+                        existing_gemm->backend_config<GemmBackendConfig>());
+    if (config.beta() != 0 ||
+        !SupportsEpilogue(existing_gemm->shape().element_type())) {
+      return Status::OK();
+    }
+    bool gelu = activation == GemmBackendConfig::GELU;
+    switch (config.epilogue()) {
+      case GemmBackendConfig::DEFAULT:
+        config.set_epilogue(activation);
+        break;
+      case GemmBackendConfig::BIAS:
+        config.set_epilogue(gelu ? GemmBackendConfig::BIAS_GELU
+                                 : GemmBackendConfig::BIAS_RELU);
+        break;
+      default:
+        return Status::OK();
+    }
+    std::unique_ptr<HloInstruction> gemm_call =
+        existing_gemm->CloneWithNewOperands(instr->shape(),
+                                            existing_gemm->operands());
+    TF_RETURN_IF_ERROR(gemm_call->set_backend_config(config));
+    TF_RETURN_IF_ERROR(SetName(instr->GetModule(), gemm_call.get()));
+    return ReplaceWithNewInstruction(instr, std::move(gemm_call));
+  }
+
+  // Matches the tanh approximation of GELU of a gemm output x,
+  //   x * 0.5 * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3))),
+  // where the three outer factors may be multiplied in any order and x^3 may
+  // be spelled as a power or as two multiplications.  The gemm must not have
+  // users outside of the pattern.
+  static bool MatchApproximateGelu(HloInstruction *instr,
+                                   HloInstruction **gemm) {
+    std::vector<HloInstruction *> factors;
+    std::vector<HloInstruction *> stack = {instr};
+    while (!stack.empty()) {
+      HloInstruction *factor = stack.back();
+      stack.pop_back();
+      if (factor->opcode() == HloOpcode::kMultiply &&
+          (factor == instr || factor->user_count() == 1)) {
+        if (factors.size() + stack.size() + 2 > 3) {
+          return false;
+        }
+        stack.push_back(factor->mutable_operand(0));
+        stack.push_back(factor->mutable_operand(1));
+      } else {
+        factors.push_back(factor);
+      }
+    }
+    if (factors.size() != 3) {
+      return false;
+    }
+    auto gemm_it = absl::c_find_if(factors, [](const HloInstruction *factor) {
+      return Match(factor, m::Op().WithCustomCallTarget(kGemmCallTarget));
+    });
+    if (gemm_it == factors.end()) {
+      return false;
+    }
+    HloInstruction *x = *gemm_it;
+    factors.erase(gemm_it);
+    // x^3 shows up either as x * (x * x) or as pow(x, 3).
+    auto cdf = [&](auto x_cubed) {
+      return m::AddAnyOrder(
+          BroadcastOfConstantNear(1.0),
+          m::Tanh(m::MultiplyAnyOrder(
+              BroadcastOfConstantNear(std::sqrt(M_2_PI)),
+              m::AddAnyOrder(
+                  m::Op().Is(x),
+                  m::MultiplyAnyOrder(BroadcastOfConstantNear(0.044715),
+                                      x_cubed)))));
+    };
+    auto is_cdf = [&](const HloInstruction *factor) {
+      return Match(factor,
+                   cdf(m::MultiplyAnyOrder(
+                       m::Op().Is(x),
+                       m::Multiply(m::Op().Is(x), m::Op().Is(x))))) ||
+             Match(factor, cdf(m::Power(m::Op().Is(x),
+                                        BroadcastOfConstantNear(3.0))));
+    };
+    bool matched =
+        (Match(factors[0], BroadcastOfConstantNear(0.5)) &&
+         is_cdf(factors[1])) ||
+        (Match(factors[1], BroadcastOfConstantNear(0.5)) &&
+         is_cdf(factors[0]));
+    if (!matched) {
+      return false;
+    }
+
+    // Everything between `instr` and x belongs to the pattern.
+    absl::flat_hash_set<const HloInstruction *> pattern;
+    std::vector<const HloInstruction *> worklist = {instr};
+    while (!worklist.empty()) {
+      const HloInstruction *node = worklist.back();
+      worklist.pop_back();
+      if (node == x || !pattern.insert(node).second) {
+        continue;
+      }
+      for (const HloInstruction *operand : node->operands()) {
+        worklist.push_back(operand);
+      }
+    }
+    if (!absl::c_all_of(x->users(), [&](const HloInstruction *user) {
+          return pattern.contains(user);
+        })) {
+      return false;
+    }
+    *gemm = x;
+    return true;
+  }
+
+  static bool SupportsEpilogue(PrimitiveType type) {
+    return type == F16 || type == F32;
+  }
+
+  bool enable_cublaslt_;
 };
 
-StatusOr<bool> RunOnComputation(HloComputation *computation) {
-  GemmRewriterVisitor visitor;
+StatusOr<bool> RunOnComputation(HloComputation *computation,
+                                bool enable_cublaslt) {
+  GemmRewriterVisitor visitor(enable_cublaslt);
   TF_RETURN_IF_ERROR(computation->Accept(&visitor));
   return visitor.changed();
 }
@@ -190,7 +407,11 @@ StatusOr<bool> RunOnComputation(HloComputation *computation) {
 StatusOr<bool> GemmRewriter::Run(HloModule *module) {
   bool changed = false;
   for (HloComputation *computation : module->MakeNonfusionComputations()) {
-    TF_ASSIGN_OR_RETURN(bool result, RunOnComputation(computation));
+    TF_ASSIGN_OR_RETURN(
+        bool result,
+        RunOnComputation(
+            computation,
+            module->config().debug_options().xla_gpu_enable_cublaslt()));
     changed |= result;
   }
   return changed;
@@ -40,6 +40,16 @@ namespace gpu {
 // (we assume transposes are already folded), and rewrites it into a custom call
 // where (A, B, C) are three operands respectively, and `alpha` and `beta` are
 // stored in the backend config.
+//
+// When cuBLASLt is enabled (--xla_gpu_enable_cublaslt), the pass also fuses
+// the following elementwise consumers of the matrix multiplication into the
+// cuBLASLt epilogue, in this order:
+//
+//   - a bias vector broadcast along the minor-most non-batch dimension of the
+//     output, which becomes the last operand of the custom call,
+//   - ReLU, spelled as max(x, 0),
+//   - the tanh approximation of GELU,
+//     x * 0.5 * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3))).
 class GemmRewriter : public HloModulePass {
  public:
   absl::string_view name() const override { return "cublas-gemm-rewriter"; }
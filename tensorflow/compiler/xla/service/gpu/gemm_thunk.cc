@@ -67,12 +67,14 @@ StatusOr<se::DeviceMemory<uint8_t>> BlasScratchAllocator::AllocateBytes(
 GemmThunk::GemmThunk(ThunkInfo thunk_info, GpuGemmConfig config,
                      const BufferAllocation::Slice &lhs_buffer,
                      const BufferAllocation::Slice &rhs_buffer,
-                     const BufferAllocation::Slice &output_buffer)
+                     const BufferAllocation::Slice &output_buffer,
+                     const BufferAllocation::Slice &bias_buffer)
     : Thunk(Kind::kGemm, thunk_info),
       config_(std::move(config)),
       lhs_buffer_(lhs_buffer),
       rhs_buffer_(rhs_buffer),
-      output_buffer_(output_buffer) {}
+      output_buffer_(output_buffer),
+      bias_buffer_(bias_buffer) {}
 
 Status GemmThunk::ExecuteOnStream(const ExecuteParams &params) {
   auto get_device_address = [&](const BufferAllocation::Slice &slice) {
@@ -82,14 +84,41 @@ Status GemmThunk::ExecuteOnStream(const ExecuteParams &params) {
   se::DeviceMemoryBase lhs_data = get_device_address(lhs_buffer_);
   se::DeviceMemoryBase rhs_data = get_device_address(rhs_buffer_);
   se::DeviceMemoryBase output_data = get_device_address(output_buffer_);
+  se::DeviceMemoryBase bias_data;
+  if (bias_buffer_.allocation() != nullptr) {
+    bias_data = get_device_address(bias_buffer_);
+  }
 
   auto &buffer_allocations = *params.buffer_allocations;
   BlasScratchAllocator scratch_allocator(buffer_allocations.device_ordinal(),
                                          buffer_allocations.memory_allocator());
 
   VLOG(3) << "Running GEMM thunk";
-  return RunGemm(config_, lhs_data, rhs_data, output_data, params.stream,
-                 &scratch_allocator, nullptr);
+  return RunGemm(config_, lhs_data, rhs_data, output_data, bias_data,
+                 params.stream, &scratch_allocator, nullptr);
+}
+
+se::blas::Epilogue BlasLtEpilogue(GemmBackendConfig::Epilogue epilogue) {
+  switch (epilogue) {
+    case GemmBackendConfig::RELU:
+      return se::blas::Epilogue::kReLU;
+    case GemmBackendConfig::GELU:
+      return se::blas::Epilogue::kGELU;
+    case GemmBackendConfig::BIAS:
+      return se::blas::Epilogue::kBias;
+    case GemmBackendConfig::BIAS_RELU:
+      return se::blas::Epilogue::kBiasThenReLU;
+    case GemmBackendConfig::BIAS_GELU:
+      return se::blas::Epilogue::kBiasThenGELU;
+    default:
+      return se::blas::Epilogue::kDefault;
+  }
+}
+
+bool EpilogueAddsBias(GemmBackendConfig::Epilogue epilogue) {
+  return epilogue == GemmBackendConfig::BIAS ||
+         epilogue == GemmBackendConfig::BIAS_RELU ||
+         epilogue == GemmBackendConfig::BIAS_GELU;
 }
 
 bool BlasPlansAutotuneCache::Find(const se::BatchMatmulParameters &params,
@@ -215,8 +244,9 @@ template <typename Input>
 static Status DoGemmLt(
     int64_t batch_size, se::blas::MatrixDescriptor lhs_matrix,
     se::blas::MatrixDescriptor rhs_matrix,
-    se::blas::MatrixDescriptor output_matrix, se::Stream *stream, Input alpha,
-    Input beta, se::ScratchAllocator *scratch_allocator,
+    se::blas::MatrixDescriptor output_matrix, se::DeviceMemoryBase bias,
+    se::blas::Epilogue epilogue, se::Stream *stream, Input alpha, Input beta,
+    se::ScratchAllocator *scratch_allocator,
     se::blas::IBlasLtMatmulAlgorithm *const algorithm_being_profiled,
     se::blas::ProfileResult *output_profile_result) {
   CHECK(output_matrix.transpose == se::blas::Transpose::kNoTranspose);
@@ -235,15 +265,16 @@ static Status DoGemmLt(
           << " adj_x " << false << " adj_y " << false << " m " << m << " n "
           << n << " k " << k << " batch_size " << batch_size << " broadcast "
           << broadcast << " broadcast " << broadcast << " dtype " << dtype
-          << " device_id " << device_id;
+          << " device_id " << device_id << " epilogue "
+          << static_cast<int>(epilogue);
   se::BatchMatmulParameters matmul_parameters(
       trans_x, trans_y, false, false, m, n, k, batch_size, broadcast, broadcast,
-      dtype, dtype, device_id);
+      dtype, dtype, device_id, epilogue);
 
   TF_ASSIGN_OR_RETURN(
       const se::blas::PlanAndAlgorithms *plan_and_algorithms,
       GetPlanAndAlgorithms(stream, matmul_parameters, batch_size, dtype,
-                           lhs_matrix, rhs_matrix, output_matrix));
+                           lhs_matrix, rhs_matrix, output_matrix, epilogue));
 
   const std::unique_ptr<se::blas::IBlasLtMatmulPlan> &plan =
       plan_and_algorithms->plan;
@@ -284,7 +315,8 @@ static Status DoGemmLt(
   if (stream
           ->ThenBlasLtMatmul(plan.get(), alpha, lhs_matrix.cast<Input>(),
                              rhs_matrix.cast<Input>(), beta, &output_data,
-                             scratch_allocator, algorithm_ptr, {},
+                             scratch_allocator, algorithm_ptr,
+                             se::DeviceMemory<Input>(bias),
                              output_profile_result)
           .ok()) {
     return Status::OK();
@@ -407,7 +439,8 @@ MatrixDescs PopulateInputOutputMatrices(const GpuGemmConfig &gemm_config,
 
 Status RunGemm(const GpuGemmConfig &gemm_config,
                se::DeviceMemoryBase lhs_buffer, se::DeviceMemoryBase rhs_buffer,
-               se::DeviceMemoryBase output_buffer, se::Stream *stream,
+               se::DeviceMemoryBase output_buffer,
+               se::DeviceMemoryBase bias_buffer, se::Stream *stream,
                BlasScratchAllocator *scratch_allocator,
                se::blas::IBlasLtMatmulAlgorithm *const algorithm_being_profiled,
                se::blas::ProfileResult *profile_result,
@@ -423,6 +456,7 @@ Status RunGemm(const GpuGemmConfig &gemm_config,
   // alpha and beta with the same type as the matrices.
   complex128 alpha = {backend_config.alpha_real(), backend_config.alpha_imag()};
   double beta = backend_config.beta();
+  se::blas::Epilogue epilogue = BlasLtEpilogue(backend_config.epilogue());
 
   // The BlasLtMatmul routines are only supported from CUDA 11.0 onward.
   if (gemm_config.use_cublaslt && stream->parent()->SupportsBlasPlans() &&
@@ -436,33 +470,36 @@ Status RunGemm(const GpuGemmConfig &gemm_config,
       case F16:
         CHECK_EQ(alpha.imag(), 0);
         return DoGemmLt<Eigen::half>(
-            batch_size, lhs_matrix, rhs_matrix, output_matrix, stream,
-            static_cast<Eigen::half>(alpha.real()),
+            batch_size, lhs_matrix, rhs_matrix, output_matrix, bias_buffer,
+            epilogue, stream, static_cast<Eigen::half>(alpha.real()),
             static_cast<Eigen::half>(beta), scratch_allocator, best_algorithm,
             /*output_profile_result=*/profile_result);
       case F32:
         CHECK_EQ(alpha.imag(), 0);
         return DoGemmLt<float>(
-            batch_size, lhs_matrix, rhs_matrix, output_matrix, stream,
-            static_cast<float>(alpha.real()), static_cast<float>(beta),
+            batch_size, lhs_matrix, rhs_matrix, output_matrix, bias_buffer,
+            epilogue, stream, static_cast<float>(alpha.real()),
+            static_cast<float>(beta),
             scratch_allocator, best_algorithm,
             /*output_profile_result=*/profile_result);
       case F64:
         CHECK_EQ(alpha.imag(), 0);
         return DoGemmLt<double>(batch_size, lhs_matrix, rhs_matrix,
-                                output_matrix, stream,
+                                output_matrix, bias_buffer, epilogue, stream,
                                 static_cast<double>(alpha.real()), beta,
                                 scratch_allocator, best_algorithm,
                                 /*output_profile_result=*/profile_result);
       case C64:
         return DoGemmLt<complex64>(
-            batch_size, lhs_matrix, rhs_matrix, output_matrix, stream,
-            static_cast<complex64>(alpha), static_cast<complex64>(beta_cmplx),
+            batch_size, lhs_matrix, rhs_matrix, output_matrix, bias_buffer,
+            epilogue, stream, static_cast<complex64>(alpha),
+            static_cast<complex64>(beta_cmplx),
             scratch_allocator, best_algorithm,
             /*output_profile_result=*/profile_result);
       case C128:
         return DoGemmLt<complex128>(batch_size, lhs_matrix, rhs_matrix,
-                                    output_matrix, stream, alpha, beta_cmplx,
+                                    output_matrix, bias_buffer, epilogue,
+                                    stream, alpha, beta_cmplx,
                                     scratch_allocator, best_algorithm,
                                     /*output_profile_result=*/profile_result);
       default:
@@ -470,6 +507,9 @@ Status RunGemm(const GpuGemmConfig &gemm_config,
                                                 output_shape.ToString()));
     }
   } else {
+    if (epilogue != se::blas::Epilogue::kDefault) {
+      return InternalError("GEMM epilogues require cuBLASLt.");
+    }
     auto best_algorithm = [&]() -> absl::optional<se::blas::AlgorithmType> {
       if (algorithm) {
         return *algorithm;
@@ -485,16 +525,16 @@ Status RunGemm(const GpuGemmConfig &gemm_config,
 
     switch (output_shape.element_type()) {
       case S32: {
-        if (!best_algorithm) {
-          return InternalError("Only extended GEMM is supported for int32_t");
-        }
+        // Only extended GEMM is supported for int32_t.  GemmAlgorithmPicker
+        // does not run on Ampere and later, so fall back to cuBLAS' default
+        // algorithm when none was selected.
         CHECK_EQ(alpha.imag(), 0);
         if (lhs_shape.element_type() == PrimitiveType::S8 &&
             rhs_shape.element_type() == lhs_shape.element_type()) {
           return DoGemmWithAlgorithm<int8_t, int32_t>(
               batch_size, lhs_matrix, rhs_matrix, output_matrix,
               static_cast<int32_t>(alpha.real()), static_cast<int32_t>(beta),
-              stream, *best_algorithm,
+              stream, best_algorithm.value_or(se::blas::kDefaultGemmAlgo),
               /*output_profile_result=*/profile_result);
         }
         return InternalError(
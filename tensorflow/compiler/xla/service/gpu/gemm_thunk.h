@@ -68,33 +68,41 @@ struct GpuGemmConfig {
 class GemmThunk : public Thunk {
  public:
   // Constructs a thunk that computes "output = (lhs <dot> rhs) * alpha" using
-  // BLAS gemm (alpha is stored in the instruction GemmBackendConfig).
+  // BLAS gemm (alpha is stored in the instruction GemmBackendConfig).  If the
+  // config has a cuBLASLt epilogue with a bias, `bias_buffer` holds the bias
+  // vector.
   GemmThunk(ThunkInfo thunk_info, GpuGemmConfig config,
             const BufferAllocation::Slice& lhs_buffer,
             const BufferAllocation::Slice& rhs_buffer,
-            const BufferAllocation::Slice& output_buffer);
+            const BufferAllocation::Slice& output_buffer,
+            const BufferAllocation::Slice& bias_buffer = {});
 
   GemmThunk(const GemmThunk&) = delete;
   GemmThunk& operator=(const GemmThunk&) = delete;
 
   Status ExecuteOnStream(const ExecuteParams& params) override;
+  // cuBLASLt plans may allocate scratch memory, which a graph cannot replay.
+  bool SupportsGraphCapture() const override { return !config_.use_cublaslt; }
 
  private:
   const GpuGemmConfig config_;
   const BufferAllocation::Slice lhs_buffer_;
   const BufferAllocation::Slice rhs_buffer_;
   const BufferAllocation::Slice output_buffer_;
+  const BufferAllocation::Slice bias_buffer_;
 };
 
 // Run the given GEMM instruction `gemm` subject to the configuration
 // in `gemm_config` and the passed buffers.
 //
 // If `algorithm` is provided, it overrides the one specified in
-// `gemm_config.backend_config`.
+// `gemm_config.backend_config`.  `bias_buffer` is only used by epilogues that
+// add a bias vector and may be null otherwise.
 Status RunGemm(
     const GpuGemmConfig& gemm_config, se::DeviceMemoryBase lhs_buffer,
     se::DeviceMemoryBase rhs_buffer, se::DeviceMemoryBase output_buffer,
-    se::Stream* stream, BlasScratchAllocator* scratch_allocator,
+    se::DeviceMemoryBase bias_buffer, se::Stream* stream,
+    BlasScratchAllocator* scratch_allocator,
     se::blas::IBlasLtMatmulAlgorithm* const algorithm_being_profiled,
     se::blas::ProfileResult* profile_result = nullptr,
     absl::optional<se::blas::AlgorithmType> algorithm = absl::nullopt);
@@ -107,6 +115,12 @@ MatrixDescs PopulateInputOutputMatrices(const GpuGemmConfig& gemm_config,
                                         se::DeviceMemoryBase rhs_buffer,
                                         se::DeviceMemoryBase output_buffer);
 
+// Maps the epilogue of a GemmBackendConfig to the cuBLASLt one.
+se::blas::Epilogue BlasLtEpilogue(GemmBackendConfig::Epilogue epilogue);
+
+// Whether `epilogue` adds a bias vector to the result of the matmul.
+bool EpilogueAddsBias(GemmBackendConfig::Epilogue epilogue);
+
 inline bool BlasPlansCompatibleType(PrimitiveType type) {
   switch (type) {
     case F16:
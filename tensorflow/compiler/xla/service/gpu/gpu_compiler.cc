@@ -59,6 +59,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/all_reduce_reassociate.h"
 #include "tensorflow/compiler/xla/service/all_to_all_decomposer.h"
 #include "tensorflow/compiler/xla/service/async_collective_creator.h"
+#include "tensorflow/compiler/xla/service/auto_sharding.h"
 #include "tensorflow/compiler/xla/service/batchnorm_expander.h"
 #include "tensorflow/compiler/xla/service/bfloat16_normalization.h"
 #include "tensorflow/compiler/xla/service/bitcast_dtypes_expander.h"
@@ -97,6 +98,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/gpu_sanitize_constant_names.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_scatter_expander.h"
 #include "tensorflow/compiler/xla/service/gpu/horizontal_input_fusion.h"
+#include "tensorflow/compiler/xla/service/gpu/host_memory_offload.h"
 #include "tensorflow/compiler/xla/service/gpu/horizontal_loop_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/instruction_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
@@ -355,6 +357,13 @@ Status GpuCompiler::OptimizeHloModule(
       spmd_simplify.AddPass<ConditionalSimplifier>();
       spmd_simplify.AddPass<HloDCE>();
 
+      if (debug_options.xla_gpu_auto_sharding()) {
+        AutoShardingOptions auto_sharding_options;
+        auto_sharding_options.num_devices = num_partitions;
+        auto_sharding_options.memory_limit_per_device_bytes =
+            debug_options.xla_gpu_auto_sharding_memory_limit_bytes();
+        spmd_pipeline.AddPass<AutoSharding>(auto_sharding_options);
+      }
       spmd_pipeline.AddPass<ShardingPropagation>(/*is_spmd=*/true);
       spmd_pipeline.AddPass<spmd::StatefulRngSpmdPartitioner>(
           num_partitions, hlo_module->config().replica_count());
@@ -640,6 +649,15 @@ Status GpuCompiler::OptimizeHloModule(
     TF_RETURN_IF_ERROR(pipeline.Run(hlo_module).status());
   }
 
+  // Runs last, so that no simplification folds the offload and prefetch
+  // copies back together.
+  if (debug_options.xla_gpu_host_offload_memory_budget_bytes() > 0) {
+    HloPassPipeline pipeline("host-memory-offload");
+    pipeline.AddPass<HostMemoryOffload>(
+        debug_options.xla_gpu_host_offload_memory_budget_bytes());
+    TF_RETURN_IF_ERROR(pipeline.Run(hlo_module).status());
+  }
+
   return Status::OK();
 }
 
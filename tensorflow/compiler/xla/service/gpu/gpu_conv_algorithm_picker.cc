@@ -25,6 +25,7 @@ limitations under the License.
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/gpu/autotune_result_store.h"
 #include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/convolution_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_asm_opts_util.h"
@@ -360,6 +361,26 @@ StatusOr<AutotuneResult> GpuConvAlgorithmPicker::PickBestAlgorithm(
     autotune_cache_stats.cache_misses++;
   }
 
+  // Fall back to results persisted by earlier processes on the same kind of
+  // device.
+  const std::string& results_path = instr->GetModule()
+                                        ->config()
+                                        .debug_options()
+                                        .xla_gpu_autotune_results_path();
+  std::string device_key;
+  if (!results_path.empty()) {
+    device_key = AutotuneResultStore::DeviceKey(stream_exec_);
+    if (absl::optional<AutotuneResult> stored =
+            AutotuneResultStore::Global().Lookup(
+                AutotuneResultStore::Kind::kConv, device_key,
+                std::get<1>(key))) {
+      VLOG(4) << "Using stored autotuning result for " << std::get<1>(key);
+      absl::MutexLock lock(&autotune_cache_lock);
+      CHECK(autotune_cache.insert({key, *stored}).second);
+      return *stored;
+    }
+  }
+
   // Make sure any previous activity on this executor is done. We don't want
   // other work still running on the GPU to interfere with autotuning.
   if (!stream_exec_->SynchronizeAllActivity()) {
@@ -396,6 +417,11 @@ StatusOr<AutotuneResult> GpuConvAlgorithmPicker::PickBestAlgorithm(
   if (result_or.ok()) {
     absl::MutexLock lock(&autotune_cache_lock);
     CHECK(autotune_cache.insert({key, result_or.ValueOrDie()}).second);
+    if (!results_path.empty()) {
+      AutotuneResultStore::Global().Insert(AutotuneResultStore::Kind::kConv,
+                                           device_key, std::get<1>(key),
+                                           result_or.ValueOrDie());
+    }
   }
   return result_or;
 }
@@ -1004,12 +1030,30 @@ StatusOr<bool> GpuConvAlgorithmPicker::Run(HloModule* module) {
     return false;
   }
 
+  // Failing to read or write the results file only costs autotuning time, so
+  // it does not fail compilation.
+  const std::string& results_path =
+      module->config().debug_options().xla_gpu_autotune_results_path();
+  if (!results_path.empty()) {
+    Status loaded =
+        AutotuneResultStore::Global().LoadFromFileOnce(results_path);
+    LOG_IF(WARNING, !loaded.ok())
+        << "Failed to load autotune results: " << loaded;
+  }
+
   bool changed = false;
   for (HloComputation* computation : module->MakeNonfusionComputations()) {
     TF_ASSIGN_OR_RETURN(bool result, RunOnComputation(computation));
     changed |= result;
   }
 
+  if (!results_path.empty()) {
+    Status saved =
+        AutotuneResultStore::Global().SaveToFileIfChanged(results_path);
+    LOG_IF(WARNING, !saved.ok())
+        << "Failed to save autotune results: " << saved;
+  }
+
   {
     absl::MutexLock lock(&autotune_cache_lock);
     autotune_cache_stats.LogStats();
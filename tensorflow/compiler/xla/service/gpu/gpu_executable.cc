@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/buffer_allocations.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable_run_options.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_graph.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_types.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_executor_util.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
@@ -190,6 +191,20 @@ StatusOr<std::unique_ptr<GpuExecutable>> GpuExecutable::Create(Params params) {
 
   if (absl::holds_alternative<OwnedThunkSchedule>(thunks_or_bef)) {
     result->thunks_ = std::move(absl::get<OwnedThunkSchedule>(thunks_or_bef));
+    // Graphs are only recorded from single-stream schedules, which need no
+    // events between streams.
+    if (result->has_module() && result->module()
+                                    .config()
+                                    .debug_options()
+                                    .xla_gpu_enable_cuda_graphs()) {
+      if (!GpuGraph::IsSupported()) {
+        LOG(WARNING) << "--xla_gpu_enable_cuda_graphs is not supported by this "
+                        "build, ignoring it";
+      } else if (result->thunks_->StreamCount() == 1) {
+        result->thunk_graph_cache_ =
+            absl::make_unique<ThunkGraphCache>(*result->thunks_);
+      }
+    }
     return result;
   }
 
@@ -224,6 +239,7 @@ GpuExecutable::GpuExecutable(GpuExecutable::Params params)
   XlaDebugInfoManager::Get()->RegisterModule(
       ModuleUniqueName(module_name_, shared_module().get()), shared_module(),
       debug_buffer_assignment_);
+  ComputeHostMemoryLayout();
 }
 
 GpuExecutable::GpuExecutable(
@@ -244,6 +260,7 @@ GpuExecutable::GpuExecutable(
   XlaDebugInfoManager::Get()->RegisterModule(
       ModuleUniqueName(module_name_, shared_module().get()), shared_module(),
       debug_buffer_assignment_);
+  ComputeHostMemoryLayout();
 }
 
 GpuExecutable::~GpuExecutable() {
@@ -264,6 +281,13 @@ GpuExecutable::~GpuExecutable() {
     }
   }
 
+  {
+    absl::MutexLock lock(&host_memory_mutex_);
+    for (const auto& block : host_memory_blocks_) {
+      block.first->HostMemoryDeallocate(block.second);
+    }
+  }
+
 #if XLA_ENABLE_XLIR
   delete bef_executable_;
 #endif
@@ -307,7 +331,8 @@ Status ExecuteThunks(const std::string& module_name,
                      const ThunkSchedule& thunk_schedule,
                      const ServiceExecutableRunOptions* run_options,
                      const BufferAllocations& buffer_allocations,
-                     bool block_host_until_done) {
+                     bool block_host_until_done,
+                     ThunkGraphCache* thunk_graph_cache) {
   XlaDebugInfoManager::Get()->OnModuleStart(module_name);
   auto cleanup = absl::MakeCleanup(
       [&]() { XlaDebugInfoManager::Get()->OnModuleStop(module_name); });
@@ -338,7 +363,35 @@ Status ExecuteThunks(const std::string& module_name,
 
   absl::flat_hash_map<const Thunk*, std::unique_ptr<se::Event>>
       thunk_to_finish_event;
-  for (const std::unique_ptr<Thunk>& thunk : thunk_schedule.TotalOrder()) {
+  const ThunkSequence& thunks = thunk_schedule.TotalOrder();
+  for (int64_t i = 0; i < thunks.size(); ++i) {
+    // Segments of the schedule that the cache records into GPU graphs run as a
+    // whole. They are on the main stream and have no events to wait for or to
+    // record.
+    int64_t segment_end =
+        thunk_graph_cache ? thunk_graph_cache->SegmentEnd(i) : i;
+    if (segment_end > i) {
+      TF_RETURN_IF_ERROR(thunk_graph_cache->RunSegment(
+          i, main_stream, buffer_allocations, [&]() -> Status {
+            for (int64_t j = i; j < segment_end; ++j) {
+              const Thunk* thunk = thunks[j].get();
+              ScopedAnnotation annotation(
+                  [&] { return thunk->profile_annotation(); });
+              VLOG(2) << "Executing the thunk for "
+                      << thunk->profile_annotation() << " in a graph segment";
+              Thunk::ExecuteParams thunk_params{
+                  *run_options, buffer_allocations, main_stream,
+                  async_comms_stream.ok() ? async_comms_stream->get()
+                                          : nullptr};
+              TF_RETURN_IF_ERROR(thunks[j]->ExecuteOnStream(thunk_params));
+            }
+            return Status::OK();
+          }));
+      i = segment_end - 1;
+      continue;
+    }
+
+    const std::unique_ptr<Thunk>& thunk = thunks[i];
     // Annotate execution of this op if tracing was enabled when we started
     // running this module.  If tracing is enabled *while* we're running the
     // module, we won't get any data, but that's probably an OK trade-off.
@@ -479,12 +532,49 @@ GpuExecutable::ResolveConstantGlobals(se::Stream* stream) {
   return &module_globals_.emplace(executor, std::move(globals)).first->second;
 }
 
+void GpuExecutable::ComputeHostMemoryLayout() {
+  for (const BufferAllocation& allocation : allocations_) {
+    if (allocation.color() != Layout::kHostMemorySpace) {
+      continue;
+    }
+    host_memory_offsets_[allocation.index()] = host_memory_block_size_;
+    host_memory_block_size_ += RoundUpTo<int64_t>(
+        allocation.size(), kXlaAllocatedBufferAlignBytes);
+  }
+}
+
+StatusOr<void*> GpuExecutable::AcquireHostMemoryBlock(
+    se::StreamExecutor* executor) {
+  absl::MutexLock lock(&host_memory_mutex_);
+  std::vector<void*>& free_blocks = free_host_memory_blocks_[executor];
+  if (!free_blocks.empty()) {
+    void* block = free_blocks.back();
+    free_blocks.pop_back();
+    return block;
+  }
+  void* block = executor->HostMemoryAllocate(host_memory_block_size_);
+  if (block == nullptr) {
+    return ResourceExhausted(
+        "Failed to allocate %d bytes of pinned host memory for offloaded "
+        "buffers",
+        host_memory_block_size_);
+  }
+  host_memory_blocks_.emplace_back(executor, block);
+  return block;
+}
+
+void GpuExecutable::ReleaseHostMemoryBlock(se::StreamExecutor* executor,
+                                           void* block) {
+  absl::MutexLock lock(&host_memory_mutex_);
+  free_host_memory_blocks_[executor].push_back(block);
+}
+
 StatusOr<se::DeviceMemoryBase> GpuExecutable::BufferForAllocation(
     VariantArguments arguments,
     const GpuExecutable::BufferAllocToDeviceMemoryMap* globals,
     const BufferAllocation& allocation,
     se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal,
-    int64_t arg_idx) {
+    int64_t arg_idx, void* host_memory_block) {
   if (allocation.is_thread_local()) {
     return se::DeviceMemoryBase{};
   } else if (allocation.is_entry_computation_parameter()) {
@@ -515,6 +605,12 @@ StatusOr<se::DeviceMemoryBase> GpuExecutable::BufferForAllocation(
       return se::DeviceMemoryBase();
     }
     return it->second;
+  } else if (allocation.color() == Layout::kHostMemorySpace) {
+    TF_RET_CHECK(!allocation.maybe_live_out());
+    TF_RET_CHECK(host_memory_block != nullptr);
+    return se::DeviceMemoryBase(static_cast<char*>(host_memory_block) +
+                                    host_memory_offsets_.at(arg_idx),
+                                allocation.size());
   } else {
     // Allocate each allocation that might escape, or is the temp buffer.
     CHECK(allocation.maybe_live_out() || allocation.IsPreallocatedTempBuffer());
@@ -557,7 +653,8 @@ static Status CheckAlignment(const BufferAllocation& allocation,
 StatusOr<BufferAllocations> GpuExecutable::GenerateBufferAllocations(
     VariantArguments arguments,
     const GpuExecutable::BufferAllocToDeviceMemoryMap* globals,
-    se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal) {
+    se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal,
+    void* host_memory_block) {
   tensorflow::profiler::TraceMe hlo_module_activity(
       [&] { return std::string("Build buffer allocations"); },
       tensorflow::profiler::TraceMeLevel::kInfo);
@@ -570,7 +667,7 @@ StatusOr<BufferAllocations> GpuExecutable::GenerateBufferAllocations(
     TF_ASSIGN_OR_RETURN(
         se::DeviceMemoryBase buffer,
         BufferForAllocation(arguments, globals, allocation, memory_allocator,
-                            device_ordinal, i));
+                            device_ordinal, i, host_memory_block));
     buffers.push_back(buffer);
     TF_RETURN_IF_ERROR(CheckAlignment(allocation, buffer, i));
   }
@@ -743,10 +840,25 @@ StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStreamImpl(
   ExecutionOutput result(/*on_device_shape=*/output_shape_, memory_allocator,
                          device_ordinal);
 
+  void* host_memory_block = nullptr;
+  if (host_memory_block_size_ > 0) {
+    TF_ASSIGN_OR_RETURN(host_memory_block, AcquireHostMemoryBlock(executor));
+  }
+  // The block is reused by later executions once the stream has finished all
+  // work enqueued by this one.
+  auto release_host_memory_block = absl::MakeCleanup([&] {
+    if (host_memory_block != nullptr) {
+      run_options->stream()->ThenDoHostCallback(
+          [this, executor, host_memory_block] {
+            ReleaseHostMemoryBlock(executor, host_memory_block);
+          });
+    }
+  });
+
   TF_ASSIGN_OR_RETURN(
       BufferAllocations buffer_allocations,
       GenerateBufferAllocations(arguments, globals, memory_allocator,
-                                device_ordinal));
+                                device_ordinal, host_memory_block));
   VLOG(2) << buffer_allocations.ToString();
   std::set<se::DeviceMemoryBase> buffers_in_result;
 
@@ -886,7 +998,8 @@ Status GpuExecutable::ExecuteThunksOrBef(
       TF_RETURN_IF_ERROR(thunk->Initialize(*this, executor));
     }
     return ExecuteThunks(module_name_, *thunks_, run_options,
-                         buffer_allocations, block_host_until_done);
+                         buffer_allocations, block_host_until_done,
+                         thunk_graph_cache_.get());
   }
 
 #if XLA_ENABLE_XLIR
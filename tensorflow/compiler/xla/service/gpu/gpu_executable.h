@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
 #include "tensorflow/compiler/xla/service/executable.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_allocations.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_graph.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_types.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_assignment.h"
 #include "tensorflow/compiler/xla/service/gpu/thunk.h"
@@ -226,14 +227,23 @@ class GpuExecutable : public Executable {
   StatusOr<BufferAllocations> GenerateBufferAllocations(
       VariantArguments arguments,
       const GpuExecutable::BufferAllocToDeviceMemoryMap* globals,
-      se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal);
+      se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal,
+      void* host_memory_block);
 
   StatusOr<se::DeviceMemoryBase> BufferForAllocation(
       VariantArguments arguments,
       const GpuExecutable::BufferAllocToDeviceMemoryMap* globals,
       const BufferAllocation& allocation,
       se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal,
-      int64_t arg_idx);
+      int64_t arg_idx, void* host_memory_block);
+
+  // Lays out the allocations in Layout::kHostMemorySpace in one block.
+  void ComputeHostMemoryLayout();
+
+  // Returns a pinned host memory block of host_memory_block_size_ bytes that
+  // no other execution uses, allocating one if none is free.
+  StatusOr<void*> AcquireHostMemoryBlock(se::StreamExecutor* executor);
+  void ReleaseHostMemoryBlock(se::StreamExecutor* executor, void* block);
 
   // The LLVM IR, in string format, of the unoptimized module generated for
   // this GpuExecutable. We save a string instead of an llvm::Module* because
@@ -259,6 +269,10 @@ class GpuExecutable : public Executable {
   // IrEmitter.
   OwnedThunkSchedule thunks_;
 
+  // The GPU graphs recorded from thunks_, if --xla_gpu_enable_cuda_graphs is
+  // set and thunks_ runs on a single stream.
+  std::unique_ptr<ThunkGraphCache> thunk_graph_cache_;
+
   xla::EntryFunctionAttributes entry_func_attrs_;
 
   std::string module_name_;
@@ -283,6 +297,21 @@ class GpuExecutable : public Executable {
 
   std::vector<ConstantInfo> constants_;
   const absl::flat_hash_map<ShapeIndex, OutputInfo> output_info_;
+
+  // Offsets of the host memory space allocations (see HostMemoryOffload) in a
+  // pinned host memory block of host_memory_block_size_ bytes. The device
+  // addresses pinned host memory directly, so such a block stands in for
+  // device memory in BufferAllocations.
+  absl::flat_hash_map<BufferAllocation::Index, int64_t> host_memory_offsets_;
+  int64_t host_memory_block_size_ = 0;
+
+  absl::Mutex host_memory_mutex_;
+  // Host memory blocks that are not in use, and all host memory blocks, per
+  // executor. Executions return their block once their stream is done with it.
+  std::map<stream_executor::StreamExecutor*, std::vector<void*>>
+      free_host_memory_blocks_ ABSL_GUARDED_BY(host_memory_mutex_);
+  std::vector<std::pair<stream_executor::StreamExecutor*, void*>>
+      host_memory_blocks_ ABSL_GUARDED_BY(host_memory_mutex_);
   // Retains shared ownership of on-device constants that are managed by XLA and
   // potentially shared with other executables.
   std::vector<std::shared_ptr<se::DeviceMemoryBase>> shared_constants_;
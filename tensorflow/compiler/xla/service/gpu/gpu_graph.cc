@@ -0,0 +1,179 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/gpu_graph.h"
+
+#include <algorithm>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/platform/logging.h"
+
+#if GOOGLE_CUDA
+#include "tensorflow/stream_executor/gpu/gpu_driver.h"
+#include "tensorflow/stream_executor/gpu/gpu_executor.h"
+#include "tensorflow/stream_executor/gpu/gpu_stream.h"
+#endif  // GOOGLE_CUDA
+
+namespace xla {
+namespace gpu {
+
+#if GOOGLE_CUDA && CUDA_VERSION >= 10020
+
+namespace {
+
+using se::gpu::GpuDriver;
+
+se::gpu::GpuContext* GetContext(se::StreamExecutor* executor) {
+  return se::gpu::ExtractGpuExecutor(executor)->gpu_context();
+}
+
+}  // namespace
+
+GpuGraph::~GpuGraph() {
+  if (exec_ != nullptr) {
+    GpuDriver::DestroyGraphExec(GetContext(executor_),
+                                static_cast<CUgraphExec>(exec_));
+  }
+}
+
+/* static */ bool GpuGraph::IsSupported() { return true; }
+
+Status GpuGraph::Capture(se::Stream* stream,
+                         const std::function<Status()>& enqueue) {
+  se::gpu::GpuContext* context = GetContext(stream->parent());
+  se::gpu::GpuStreamHandle handle = se::gpu::AsGpuStreamValue(stream);
+  TF_RETURN_IF_ERROR(GpuDriver::StreamBeginCapture(context, handle));
+  Status enqueue_status = enqueue();
+  // The capture must be ended even if enqueuing failed, to return the stream
+  // to its normal state.
+  auto graph = GpuDriver::StreamEndCapture(context, handle);
+  TF_RETURN_IF_ERROR(enqueue_status);
+  TF_RETURN_IF_ERROR(graph.status());
+
+  Status status = Status::OK();
+  bool updated = false;
+  if (exec_ != nullptr && executor_ == stream->parent()) {
+    auto update = GpuDriver::GraphExecUpdate(
+        context, static_cast<CUgraphExec>(exec_), graph.ValueOrDie());
+    status = update.status();
+    updated = update.ok() && update.ValueOrDie();
+  }
+  if (status.ok() && !updated) {
+    auto exec = GpuDriver::GraphInstantiate(context, graph.ValueOrDie());
+    status = exec.status();
+    if (status.ok()) {
+      if (exec_ != nullptr) {
+        GpuDriver::DestroyGraphExec(GetContext(executor_),
+                                    static_cast<CUgraphExec>(exec_));
+      }
+      exec_ = exec.ValueOrDie();
+      executor_ = stream->parent();
+    }
+  }
+  GpuDriver::DestroyGraph(context, graph.ValueOrDie());
+  return status;
+}
+
+Status GpuGraph::Launch(se::Stream* stream) const {
+  TF_RET_CHECK(exec_ != nullptr) << "Launching a graph that was not captured";
+  TF_RET_CHECK(stream->parent() == executor_);
+  return GpuDriver::GraphLaunch(GetContext(executor_),
+                                static_cast<CUgraphExec>(exec_),
+                                se::gpu::AsGpuStreamValue(stream));
+}
+
+#else  // GOOGLE_CUDA && CUDA_VERSION >= 10020
+
+GpuGraph::~GpuGraph() = default;
+
+/* static */ bool GpuGraph::IsSupported() { return false; }
+
+Status GpuGraph::Capture(se::Stream* stream,
+                         const std::function<Status()>& enqueue) {
+  return Unimplemented("GPU graphs require CUDA 10.2 or later");
+}
+
+Status GpuGraph::Launch(se::Stream* stream) const {
+  return Unimplemented("GPU graphs require CUDA 10.2 or later");
+}
+
+#endif  // GOOGLE_CUDA && CUDA_VERSION >= 10020
+
+ThunkGraphCache::ThunkGraphCache(const ThunkSchedule& thunk_schedule) {
+  CHECK_EQ(thunk_schedule.StreamCount(), 1);
+  const ThunkSequence& thunks = thunk_schedule.TotalOrder();
+  auto capturable = [&](const Thunk* thunk) {
+    return thunk->SupportsGraphCapture() && !thunk_schedule.Depended(thunk) &&
+           thunk_schedule.DependsOn(thunk).empty();
+  };
+  for (int64_t begin = 0; begin < thunks.size();) {
+    int64_t end = begin;
+    while (end < thunks.size() && capturable(thunks[end].get())) {
+      ++end;
+    }
+    // A single thunk saves no launches.
+    if (end - begin >= 2) {
+      segment_ends_[begin] = end;
+    }
+    begin = std::max(end, begin + 1);
+  }
+  VLOG(2) << "Found " << segment_ends_.size()
+          << " segments of thunks to record into GPU graphs";
+}
+
+int64_t ThunkGraphCache::SegmentEnd(int64_t begin) const {
+  auto it = segment_ends_.find(begin);
+  return it == segment_ends_.end() ? begin : it->second;
+}
+
+Status ThunkGraphCache::RunSegment(int64_t begin, se::Stream* stream,
+                                   const BufferAllocations& buffer_allocations,
+                                   const std::function<Status()>& enqueue) {
+  absl::MutexLock lock(&mu_);
+  if (disabled_) {
+    return enqueue();
+  }
+  std::vector<void*> buffer_addresses(buffer_allocations.buffer_count());
+  for (int64_t i = 0; i < buffer_addresses.size(); ++i) {
+    buffer_addresses[i] = buffer_allocations.GetDeviceAddress(i).opaque();
+  }
+
+  Recording& recording = recordings_[{stream->parent(), begin}];
+  if (recording.graph != nullptr && recording.graph->is_captured() &&
+      recording.buffer_addresses == buffer_addresses) {
+    return recording.graph->Launch(stream);
+  }
+  if (recording.num_runs++ == 0) {
+    return enqueue();
+  }
+
+  if (recording.graph == nullptr) {
+    recording.graph = absl::make_unique<GpuGraph>();
+  }
+  Status status = recording.graph->Capture(stream, enqueue);
+  if (!status.ok()) {
+    LOG(WARNING) << "Disabling GPU graphs after failing to record thunks: "
+                 << status;
+    disabled_ = true;
+    recordings_.clear();
+    return enqueue();
+  }
+  recording.buffer_addresses = std::move(buffer_addresses);
+  return recording.graph->Launch(stream);
+}
+
+}  // namespace gpu
+}  // namespace xla
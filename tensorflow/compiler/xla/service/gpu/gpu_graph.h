@@ -0,0 +1,113 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_GRAPH_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_GRAPH_H_
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/compiler/xla/service/gpu/buffer_allocations.h"
+#include "tensorflow/compiler/xla/service/gpu/thunk_schedule.h"
+#include "tensorflow/compiler/xla/status.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/stream_executor/stream_executor.h"
+
+namespace xla {
+namespace gpu {
+
+// An executable CUDA graph, recorded from the work enqueued on a stream.
+// Replaying the graph enqueues all of that work with a single launch, which
+// saves the host overhead of enqueuing it piece by piece.
+//
+// Graphs require CUDA 10.2 or later. Elsewhere IsSupported() returns false
+// and the other methods return Unimplemented.
+class GpuGraph {
+ public:
+  GpuGraph() = default;
+  ~GpuGraph();
+
+  GpuGraph(const GpuGraph&) = delete;
+  GpuGraph& operator=(const GpuGraph&) = delete;
+
+  static bool IsSupported();
+
+  // Records the work that `enqueue` puts on `stream`, without running it, as
+  // the contents of the graph. If the graph was already recorded, it is
+  // updated in place when the new work has the same structure, which is much
+  // cheaper than instantiating a new graph.
+  Status Capture(se::Stream* stream, const std::function<Status()>& enqueue);
+
+  // Enqueues the recorded work on `stream`, which must belong to the same
+  // StreamExecutor as the stream used in Capture.
+  Status Launch(se::Stream* stream) const;
+
+  bool is_captured() const { return exec_ != nullptr; }
+
+ private:
+  se::StreamExecutor* executor_ = nullptr;
+  void* exec_ = nullptr;  // CUgraphExec
+};
+
+// The GPU graphs for the thunks of a single-stream ThunkSchedule. The schedule
+// is split into segments: maximal runs of at least two consecutive thunks that
+// support graph capture and need no cross-thunk events. The first time a
+// segment runs on a StreamExecutor its thunks are executed directly, so that
+// they can finish any lazy initialization. The second time they are recorded
+// into a graph, which later runs replay. A segment is recorded again when the
+// buffer addresses change, which updates its graph in place.
+//
+// If recording ever fails, graphs are disabled and all thunks run directly.
+class ThunkGraphCache {
+ public:
+  explicit ThunkGraphCache(const ThunkSchedule& thunk_schedule);
+
+  // Returns the index one past the last thunk of the segment that begins at
+  // thunk `begin` in the schedule's total order, or `begin` if no segment
+  // begins there.
+  int64_t SegmentEnd(int64_t begin) const;
+
+  // Runs the segment that begins at thunk `begin` on `stream`, either by
+  // replaying its graph or by calling `enqueue`, which must execute the
+  // segment's thunks on `stream`.
+  Status RunSegment(int64_t begin, se::Stream* stream,
+                    const BufferAllocations& buffer_allocations,
+                    const std::function<Status()>& enqueue);
+
+ private:
+  struct Recording {
+    int64_t num_runs = 0;
+    // The buffer addresses that `graph` was recorded with.
+    std::vector<void*> buffer_addresses;
+    std::unique_ptr<GpuGraph> graph;
+  };
+
+  // Maps the first thunk of each segment to the index past its last thunk.
+  absl::flat_hash_map<int64_t, int64_t> segment_ends_;
+
+  absl::Mutex mu_;
+  absl::flat_hash_map<std::pair<se::StreamExecutor*, int64_t>, Recording>
+      recordings_ ABSL_GUARDED_BY(mu_);
+  bool disabled_ ABSL_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_GRAPH_H_
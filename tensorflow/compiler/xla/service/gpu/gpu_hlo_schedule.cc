@@ -21,6 +21,8 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "tensorflow/compiler/xla/service/buffer_value.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/gpu/latency_hiding_scheduler.h"
 #include "tensorflow/compiler/xla/service/hlo_instructions.h"
 #include "tensorflow/compiler/xla/service/hlo_memory_scheduler.h"
 #include "tensorflow/compiler/xla/service/hlo_reachability.h"
@@ -322,7 +324,25 @@ StatusOr<std::unique_ptr<GpuHloSchedule>> GpuHloSchedule::Build(
   HloComputation* entry_computation = module->entry_computation();
   if (stream_assignment.StreamCount() == 1) {
     // All kernels are launched on a single stream, so there's no loss of
-    // concurrency by optimizing for minimal memory usage.
+    // concurrency by optimizing for minimal memory usage. Only asynchronous
+    // collectives run concurrently, on their own stream.
+    MemorySchedulerPostprocessor postprocessor =
+        PostprocessorToScheduleAsEarlyOrLateAsPossible;
+    GpuHloCostAnalysis cost_analysis(
+        HloCostAnalysis::Options{[pointer_size](const Shape& shape) {
+          return ShapeUtil::ByteSizeOf(shape, pointer_size);
+        }});
+    std::unique_ptr<LatencyHidingScheduler> latency_hiding_scheduler;
+    if (module->config()
+            .debug_options()
+            .xla_gpu_enable_latency_hiding_scheduler()) {
+      TF_RETURN_IF_ERROR(entry_computation->Accept(&cost_analysis));
+      latency_hiding_scheduler =
+          absl::make_unique<LatencyHidingScheduler>(&cost_analysis);
+      postprocessor = [&](const HloInstructionSequence& sequence) {
+        return latency_hiding_scheduler->Schedule(sequence);
+      };
+    }
     TF_ASSIGN_OR_RETURN(
         HloSchedule sequences,
         ScheduleModule(
@@ -330,9 +350,8 @@ StatusOr<std::unique_ptr<GpuHloSchedule>> GpuHloSchedule::Build(
             [pointer_size](const BufferValue& buffer) {
               return ShapeUtil::ByteSizeOf(buffer.shape(), pointer_size);
             },
-            ComputationSchedulerToModuleScheduler(
-                DefaultMemoryScheduler,
-                PostprocessorToScheduleAsEarlyOrLateAsPossible)));
+            ComputationSchedulerToModuleScheduler(DefaultMemoryScheduler,
+                                                  postprocessor)));
     schedule->thunk_launch_order_ =
         sequences.sequence(entry_computation).instructions();
     schedule->hlo_ordering_ =
@@ -0,0 +1,243 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/host_memory_offload.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/layout.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// Returns true if `instr` only forwards (part of) the buffers of its operands.
+bool IsAliasingOp(const HloInstruction& instr) {
+  switch (instr.opcode()) {
+    case HloOpcode::kBitcast:
+    case HloOpcode::kGetTupleElement:
+    case HloOpcode::kTuple:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns the number of device bytes defined by `instr`.
+int64_t DefinedBytes(const HloInstruction& instr) {
+  if (IsAliasingOp(instr)) {
+    return 0;
+  }
+  int64_t bytes = 0;
+  ShapeUtil::ForEachSubshape(
+      instr.shape(), [&](const Shape& subshape, const ShapeIndex& /*index*/) {
+        if (subshape.IsArray()) {
+          bytes += ShapeUtil::ByteSizeOf(subshape);
+        }
+      });
+  return bytes;
+}
+
+// A value that is idle between its use at position `forward` and its use at
+// position `backward` in the post order.
+struct Candidate {
+  HloInstruction* value;
+  int64_t bytes;
+  int64_t forward;
+  int64_t backward;
+  // The offload is ordered before the instruction at `offload_before`, and the
+  // prefetch after the instruction at `prefetch_after`. The device buffer is
+  // free in between.
+  int64_t offload_before;
+  int64_t prefetch_after;
+};
+
+}  // namespace
+
+StatusOr<bool> HostMemoryOffload::Run(HloModule* module) {
+  if (memory_budget_bytes_ <= 0) {
+    return false;
+  }
+  HloComputation* computation = module->entry_computation();
+  const std::vector<HloInstruction*> order =
+      computation->MakeInstructionPostOrder();
+  const int64_t n = order.size();
+  absl::flat_hash_map<const HloInstruction*, int64_t> position;
+  for (int64_t i = 0; i < n; ++i) {
+    position[order[i]] = i;
+  }
+
+  // Live range ends. Buffers read through aliasing ops stay live as long as
+  // the aliases do; parameters, constants and the outputs stay live for the
+  // whole computation.
+  std::vector<int64_t> live_end(n);
+  for (int64_t i = n - 1; i >= 0; --i) {
+    const HloInstruction* instr = order[i];
+    int64_t end = i;
+    if (instr == computation->root_instruction() ||
+        instr->opcode() == HloOpcode::kParameter ||
+        instr->opcode() == HloOpcode::kConstant) {
+      end = n - 1;
+    }
+    for (const HloInstruction* user : instr->users()) {
+      const int64_t user_position = position.at(user);
+      end = std::max(end, IsAliasingOp(*user) ? live_end[user_position]
+                                              : user_position);
+    }
+    live_end[i] = end;
+  }
+
+  std::vector<int64_t> live_bytes(n + 1, 0);
+  for (int64_t i = 0; i < n; ++i) {
+    const bool live_in = order[i]->opcode() == HloOpcode::kParameter ||
+                         order[i]->opcode() == HloOpcode::kConstant;
+    const int64_t bytes = DefinedBytes(*order[i]);
+    live_bytes[live_in ? 0 : i] += bytes;
+    live_bytes[live_end[i] + 1] -= bytes;
+  }
+  for (int64_t i = 1; i < n; ++i) {
+    live_bytes[i] += live_bytes[i - 1];
+  }
+  live_bytes.pop_back();
+  auto peak = [&](int64_t begin, int64_t end) {
+    return *std::max_element(live_bytes.begin() + begin,
+                             live_bytes.begin() + end + 1);
+  };
+  if (n == 0 || peak(0, n - 1) <= memory_budget_bytes_) {
+    return false;
+  }
+
+  auto is_schedulable = [](const HloInstruction* instr) {
+    return instr->opcode() != HloOpcode::kParameter &&
+           instr->opcode() != HloOpcode::kConstant;
+  };
+  std::vector<Candidate> candidates;
+  for (int64_t i = 0; i < n; ++i) {
+    HloInstruction* instr = order[i];
+    if (!is_schedulable(instr) || IsAliasingOp(*instr) ||
+        !instr->shape().IsArray() ||
+        instr->shape().layout().memory_space() !=
+            Layout::kDefaultMemorySpace ||
+        instr == computation->root_instruction() ||
+        instr->HasSideEffect() ||
+        ShapeUtil::ByteSizeOf(instr->shape()) < min_offload_bytes_ ||
+        absl::c_any_of(instr->users(), [](const HloInstruction* user) {
+          return IsAliasingOp(*user);
+        })) {
+      continue;
+    }
+    std::vector<int64_t> uses = {i};
+    for (const HloInstruction* user : instr->users()) {
+      uses.push_back(position.at(user));
+    }
+    absl::c_sort(uses);
+    Candidate candidate{instr, ShapeUtil::ByteSizeOf(instr->shape()), 0, 0,
+                        0, 0};
+    for (int64_t u = 1; u < uses.size(); ++u) {
+      if (uses[u] - uses[u - 1] > candidate.backward - candidate.forward) {
+        candidate.forward = uses[u - 1];
+        candidate.backward = uses[u];
+      }
+    }
+    if (candidate.backward - candidate.forward <= 2 * prefetch_distance_) {
+      continue;
+    }
+    candidate.offload_before = candidate.forward + 1;
+    while (!is_schedulable(order[candidate.offload_before])) {
+      ++candidate.offload_before;
+    }
+    candidate.prefetch_after = candidate.backward - prefetch_distance_;
+    while (!is_schedulable(order[candidate.prefetch_after])) {
+      --candidate.prefetch_after;
+    }
+    if (candidate.offload_before >= candidate.prefetch_after) {
+      continue;
+    }
+    candidates.push_back(candidate);
+  }
+  absl::c_stable_sort(candidates, [](const Candidate& a, const Candidate& b) {
+    return a.bytes * (a.prefetch_after - a.offload_before) >
+           b.bytes * (b.prefetch_after - b.offload_before);
+  });
+
+  bool changed = false;
+  for (const Candidate& candidate : candidates) {
+    if (peak(0, n - 1) <= memory_budget_bytes_) {
+      break;
+    }
+    // Only offload values that are resident while the schedule is over
+    // budget.
+    if (peak(candidate.offload_before, candidate.prefetch_after) <=
+        memory_budget_bytes_) {
+      continue;
+    }
+    for (int64_t i = candidate.offload_before; i <= candidate.prefetch_after;
+         ++i) {
+      live_bytes[i] -= candidate.bytes;
+    }
+
+    HloInstruction* value = candidate.value;
+    Shape host_shape = value->shape();
+    host_shape.mutable_layout()->set_memory_space(Layout::kHostMemorySpace);
+    auto offload =
+        HloInstruction::CreateUnary(host_shape, HloOpcode::kCopy, value);
+    offload->SetAndSanitizeName(absl::StrCat(value->name(), ".offload"));
+    HloInstruction* offload_ptr =
+        computation->AddInstruction(std::move(offload));
+    auto prefetch = HloInstruction::CreateUnary(
+        value->shape(), HloOpcode::kCopy, offload_ptr);
+    prefetch->SetAndSanitizeName(absl::StrCat(value->name(), ".prefetch"));
+    HloInstruction* prefetch_ptr =
+        computation->AddInstruction(std::move(prefetch));
+
+    std::vector<HloInstruction*> late_users;
+    for (HloInstruction* user : value->users()) {
+      if (position.at(user) >= candidate.backward) {
+        late_users.push_back(user);
+      }
+    }
+    for (HloInstruction* user : late_users) {
+      TF_RETURN_IF_ERROR(value->ReplaceUseWith(user, prefetch_ptr));
+    }
+    // Both edges point forward in the post order, so they cannot form a
+    // cycle, also not with the edges of other offloaded values.
+    TF_RETURN_IF_ERROR(offload_ptr->AddControlDependencyTo(
+        order[candidate.offload_before]));
+    TF_RETURN_IF_ERROR(
+        order[candidate.prefetch_after]->AddControlDependencyTo(prefetch_ptr));
+    VLOG(2) << "Offloading " << value->name() << " (" << candidate.bytes
+            << " bytes) to host memory between "
+            << order[candidate.offload_before]->name() << " and "
+            << order[candidate.prefetch_after]->name();
+    changed = true;
+  }
+  VLOG(1) << "Estimated peak device memory after host offloading: "
+          << peak(0, n - 1) << " bytes (budget " << memory_budget_bytes_
+          << ")";
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
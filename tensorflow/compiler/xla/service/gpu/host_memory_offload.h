@@ -0,0 +1,75 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_MEMORY_OFFLOAD_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_MEMORY_OFFLOAD_H_
+
+#include <cstdint>
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace gpu {
+
+// Offloads long-lived activations of the entry computation to pinned host
+// memory so that the estimated peak device memory fits in a budget.
+//
+// This is the reverse of memory space assignment: instead of placing hot
+// buffers in a small fast memory, it evicts buffers that are idle between a
+// forward use and a much later (typically backward pass) use. For every such
+// value `x` it inserts
+//
+//   offload  = copy(x)        // result in Layout::kHostMemorySpace
+//   prefetch = copy(offload)  // result in device memory
+//
+// and rewires the late users of `x` to `prefetch`. Control dependencies pin
+// the offload before the idle interval starts, so that the device buffer of
+// `x` can be reused during the interval, and the prefetch `prefetch_distance`
+// instructions ahead of the first late use.
+//
+// Values are picked by decreasing size times idle time until the estimated
+// peak, computed from live ranges over the post order of the entry
+// computation, is within `memory_budget_bytes`, or no candidate lowers it.
+//
+// The copies are emitted as memcpy thunks on the compute stream: the GPU
+// backend launches all thunks on one stream, so transfers do not yet overlap
+// with kernels. The executable backs host memory space buffers with pinned
+// host memory, which the device addresses directly.
+//
+// Runs after fusion, so that the copies are not fused into their neighbours.
+class HostMemoryOffload : public HloModulePass {
+ public:
+  explicit HostMemoryOffload(int64_t memory_budget_bytes,
+                             int64_t min_offload_bytes = 1 << 20,
+                             int64_t prefetch_distance = 4)
+      : memory_budget_bytes_(memory_budget_bytes),
+        min_offload_bytes_(min_offload_bytes),
+        prefetch_distance_(prefetch_distance) {}
+
+  absl::string_view name() const override { return "host-memory-offload"; }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  const int64_t memory_budget_bytes_;
+  const int64_t min_offload_bytes_;
+  const int64_t prefetch_distance_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_MEMORY_OFFLOAD_H_
@@ -0,0 +1,102 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/host_memory_offload.h"
+
+#include "tensorflow/compiler/xla/layout.h"
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+class HostMemoryOffloadTest : public HloTestBase {};
+
+// `act` is used right away and then only by the root, ten instructions later.
+// Each f32[256,256] buffer takes 256KiB, and the schedule peaks at 1MiB.
+constexpr char kHloString[] = R"(
+HloModule test
+
+ENTRY main {
+  p0 = f32[256,256]{1,0} parameter(0)
+  act = f32[256,256]{1,0} exponential(p0)
+  n0 = f32[256,256]{1,0} negate(act)
+  n1 = f32[256,256]{1,0} negate(n0)
+  n2 = f32[256,256]{1,0} negate(n1)
+  n3 = f32[256,256]{1,0} negate(n2)
+  n4 = f32[256,256]{1,0} negate(n3)
+  n5 = f32[256,256]{1,0} negate(n4)
+  n6 = f32[256,256]{1,0} negate(n5)
+  n7 = f32[256,256]{1,0} negate(n6)
+  n8 = f32[256,256]{1,0} negate(n7)
+  ROOT out = f32[256,256]{1,0} add(n8, act)
+}
+)";
+
+TEST_F(HostMemoryOffloadTest, OffloadsIdleActivation) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kHloString));
+  HostMemoryOffload offload(/*memory_budget_bytes=*/900 * 1024,
+                            /*min_offload_bytes=*/1024,
+                            /*prefetch_distance=*/1);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, offload.Run(module.get()));
+  EXPECT_TRUE(changed);
+  SCOPED_TRACE(module->ToString());
+
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, op::Add(op::Negate(), op::Copy(op::Copy(op::Exp()))));
+  const HloInstruction* prefetch = root->operand(1);
+  const HloInstruction* offloaded = prefetch->operand(0);
+  EXPECT_EQ(offloaded->shape().layout().memory_space(),
+            Layout::kHostMemorySpace);
+  EXPECT_EQ(prefetch->shape().layout().memory_space(),
+            Layout::kDefaultMemorySpace);
+
+  // The offload happens before the chain continues past the forward use, and
+  // the prefetch one instruction ahead of the root.
+  ASSERT_EQ(offloaded->control_successors().size(), 1);
+  EXPECT_EQ(offloaded->control_successors()[0]->name(), "n1");
+  ASSERT_EQ(prefetch->control_predecessors().size(), 1);
+  EXPECT_EQ(prefetch->control_predecessors()[0]->name(), "n8");
+  EXPECT_THAT(FindInstruction(module.get(), "n0"), op::Negate(op::Exp()));
+}
+
+TEST_F(HostMemoryOffloadTest, KeepsScheduleWithinBudget) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kHloString));
+  HostMemoryOffload offload(/*memory_budget_bytes=*/1024 * 1024,
+                            /*min_offload_bytes=*/1024,
+                            /*prefetch_distance=*/1);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, offload.Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(HostMemoryOffloadTest, DoesNotOffloadShortIdleIntervals) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kHloString));
+  HostMemoryOffload offload(/*memory_budget_bytes=*/900 * 1024,
+                            /*min_offload_bytes=*/1024,
+                            /*prefetch_distance=*/5);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, offload.Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
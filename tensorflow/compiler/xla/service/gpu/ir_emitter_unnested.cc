@@ -129,6 +129,7 @@ limitations under the License.
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/compiler/xla/service/gpu/cholesky_thunk.h"
+#include "tensorflow/compiler/xla/service/gpu/fused_attention_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/triangular_solve_thunk.h"
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
@@ -1111,8 +1112,9 @@ Status IrEmitterUnnested::EmitGemmThunk(mlir::Operation* op) {
   };
 
   auto make_gemm_thunk =
-      [&](auto op, absl::optional<double> gemm_bias_beta =
-                       absl::nullopt) -> StatusOr<std::unique_ptr<Thunk>> {
+      [&](auto op, absl::optional<double> gemm_bias_beta = absl::nullopt,
+          const BufferAllocation::Slice& bias_vector =
+              {}) -> StatusOr<std::unique_ptr<Thunk>> {
     TF_ASSIGN_OR_RETURN(auto lhs, GetAllocationSlice(op.lhs()));
     TF_ASSIGN_OR_RETURN(auto rhs, GetAllocationSlice(op.rhs()));
     TF_ASSIGN_OR_RETURN(auto output, GetAllocationSlice(op.output()));
@@ -1134,6 +1136,11 @@ Status IrEmitterUnnested::EmitGemmThunk(mlir::Operation* op) {
     }
     backend.set_lhs_stride(op.lhs_stride());
     backend.set_rhs_stride(op.rhs_stride());
+    if (op.epilogue()) {
+      // The LMHLO enum mirrors GemmBackendConfig::Epilogue value for value.
+      backend.set_epilogue(
+          static_cast<GemmBackendConfig::Epilogue>(*op.epilogue()));
+    }
 
     config.use_cublaslt =
         hlo_module_config_.debug_options().xla_gpu_enable_cublaslt();
@@ -1153,13 +1160,20 @@ Status IrEmitterUnnested::EmitGemmThunk(mlir::Operation* op) {
     fill_dims(mlir_dims.getRhsContractingDimensions(),
               dims.mutable_rhs_contracting_dimensions());
 
-    return std::unique_ptr<Thunk>(
-        new GemmThunk(GetThunkInfo(op), std::move(config), lhs, rhs, output));
+    return std::unique_ptr<Thunk>(new GemmThunk(
+        GetThunkInfo(op), std::move(config), lhs, rhs, output, bias_vector));
+  };
+
+  // Epilogues are only implemented by the cuBLASLt path of GemmThunk.
+  auto has_epilogue = [](auto op) {
+    return op.epilogue() &&
+           *op.epilogue() != mlir::lmhlo_gpu::GemmEpilogue::Default;
   };
 
   TF_ASSIGN_OR_RETURN(auto thunk, [&]() -> StatusOr<std::unique_ptr<Thunk>> {
     if (auto gemm = mlir::dyn_cast<mlir::lmhlo_gpu::GEMMOp>(op)) {
-      if (IsBefThunkEnabled(hlo_module_config_)) return make_bef_thunk(gemm);
+      if (IsBefThunkEnabled(hlo_module_config_) && !has_epilogue(gemm))
+        return make_bef_thunk(gemm);
       return make_gemm_thunk(gemm);
     }
 
@@ -1168,6 +1182,12 @@ Status IrEmitterUnnested::EmitGemmThunk(mlir::Operation* op) {
       TF_ASSIGN_OR_RETURN(auto bias, GetAllocationSlice(gemm.bias()));
       TF_ASSIGN_OR_RETURN(auto output, GetAllocationSlice(gemm.output()));
 
+      // With an epilogue the bias is a vector that cuBLASLt broadcasts
+      // itself, so it is not copied into the output.
+      if (has_epilogue(gemm)) {
+        return make_gemm_thunk(gemm, gemm_bias_beta, bias);
+      }
+
       if (IsBefThunkEnabled(hlo_module_config_))
         return make_bef_thunk(gemm, bias);
 
@@ -1585,6 +1605,48 @@ Status IrEmitterUnnested::EmitTriangularSolveCustomCall(mlir::Operation* op) {
   }
   return Status::OK();
 }
+
+Status IrEmitterUnnested::EmitFusedAttentionCustomCall(mlir::Operation* op) {
+  auto custom_call = mlir::cast<mlir::lmhlo::CustomCallOp>(op);
+
+  // Operands are q, k, v and the output, all in row-major layout with the
+  // sequence and head dimensions minor-most.
+  auto operands = op->getOperands();
+  TF_RET_CHECK(operands.size() == 4);
+  TF_RET_CHECK(absl::c_all_of(operands, [&](mlir::Value v) {
+    return LayoutUtil::IsMonotonicWithDim0Major(GetShape(v).layout());
+  }));
+
+  TF_ASSIGN_OR_RETURN(BufferAllocation::Slice q_slice,
+                      GetAllocationSlice(operands[0]));
+  TF_ASSIGN_OR_RETURN(BufferAllocation::Slice k_slice,
+                      GetAllocationSlice(operands[1]));
+  TF_ASSIGN_OR_RETURN(BufferAllocation::Slice v_slice,
+                      GetAllocationSlice(operands[2]));
+  TF_ASSIGN_OR_RETURN(BufferAllocation::Slice output_slice,
+                      GetAllocationSlice(operands[3]));
+
+  FusedAttentionBackendConfig backend_config;
+  TF_RETURN_IF_ERROR(tensorflow::HumanReadableJsonToProto(
+      custom_call.backend_config().str(), &backend_config));
+
+  const Shape q_shape = GetShape(operands[0]);
+  const Shape k_shape = GetShape(operands[1]);
+  TF_RET_CHECK(q_shape.rank() >= 2 && q_shape.rank() == k_shape.rank());
+  int64_t seq_q = q_shape.dimensions(q_shape.rank() - 2);
+  int64_t head_dim = q_shape.dimensions(q_shape.rank() - 1);
+  int64_t seq_k = k_shape.dimensions(k_shape.rank() - 2);
+  int64_t batch_size = std::accumulate(
+      q_shape.dimensions().begin(), q_shape.dimensions().end() - 2, int64_t{1},
+      [](int64_t a, int64_t b) { return a * b; });
+
+  AddThunkToThunkSequence(absl::make_unique<FusedAttentionThunk>(
+      GetThunkInfo(op),
+      PtxOptsFromDebugOptions(hlo_module_config_.debug_options()), q_slice,
+      k_slice, v_slice, output_slice, q_shape.element_type(), batch_size, seq_q,
+      seq_k, head_dim, static_cast<float>(backend_config.scale())));
+  return Status::OK();
+}
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
 // Convert the following form of fusion region:
@@ -3830,8 +3892,13 @@ ReductionCodegenState IrEmitterUnnested::GenerateReductionCodegenState(
       const TilingScheme& tiling_scheme =
           reduction_codegen_state.GetTilingScheme();
       int64_t num_threads_x = tiling_scheme.GetNumThreadsFor(kDimX);
-      llvm::GlobalVariable* shared_cache = [&] {
+      llvm::GlobalVariable* shared_cache = [&]() -> llvm::GlobalVariable* {
         if (reduction_codegen_state.IsRowReduction()) {
+          if (num_threads_x <= WarpSize()) {
+            // Rows are reduced within a warp, see
+            // EmitReductionOutputForRowReduction.
+            return nullptr;
+          }
           // Allocate __shared__
           // cache[num_partial_results][num_warps][scaling_factor].
           CHECK_EQ(tiling_scheme.GetNumThreadsPerBlock() % WarpSize(), 0);
@@ -3868,14 +3935,16 @@ void IrEmitterUnnested::EmitFullWarpShuffleDownLoopForReduce(
     const HloComputation* reducer,
     absl::Span<std::pair<llvm::Value* const, llvm::Type* const>>
         partial_result_addresses,
-    int threads_per_block) {
+    int threads_per_block, int num_results_per_warp) {
   // This only works when the block size is a multiple of 32 threads.
 
   // We check this here as a mistake in the number of threads per
   // block is very hard to detect.
   CHECK_EQ(threads_per_block % 32, 0);
+  CHECK_EQ(WarpSize() % num_results_per_warp, 0);
 
-  for (int distance = 16; distance >= 1; distance /= 2) {
+  for (int distance = 16 / num_results_per_warp; distance >= 1;
+       distance /= 2) {
     absl::InlinedVector<llvm::Value*, 2> reduction_params;
 
     for (auto acc : partial_result_addresses) {
@@ -4066,10 +4135,44 @@ void IrEmitterUnnested::EmitReductionOutputForRowReduction(
          state.partial_result_address->getAllocatedType()});
   }
 
-  EmitFullWarpShuffleDownLoopForReduce(reducer, absl::MakeSpan(current_outputs),
-                                       tiling_scheme.GetNumThreadsPerBlock());
+  // Rows reduced by at most a warp each are packed into warps (see
+  // ComputeShortRowReductionCodegenInfo). For them the shuffle alone reduces
+  // every row into thread_id_x == 0, with no need for shared memory.
+  int64_t num_threads_x = tiling_scheme.GetNumThreadsFor(kDimX);
+  bool is_warp_local = num_threads_x <= WarpSize();
+  EmitFullWarpShuffleDownLoopForReduce(
+      reducer, absl::MakeSpan(current_outputs),
+      tiling_scheme.GetNumThreadsPerBlock(),
+      /*num_results_per_warp=*/is_warp_local ? WarpSize() / num_threads_x : 1);
+
+  auto write_output = [&](const auto& values) {
+    for (int oidx = 0; oidx < num_outputs; oidx++) {
+      llvm::Value* output_address = GetOutputAddressForReduction(
+          partial_result_idx, index_ty, reduction_codegen_state,
+          tiling_kernel_info, output_arrays, reduction, oidx);
+
+      if (reduction_codegen_state.IsRaceFree()) {
+        Store(Load(values[oidx].first, "output"), output_address);
+      } else {
+        CHECK_EQ(num_outputs, 1);
+        TF_CHECK_OK(EmitAtomicOperationForNestedComputation(
+            *reducer, output_address, values[oidx].first));
+      }
+    }
+  };
 
   KernelSupportLibrary ksl(&b_);
+  if (is_warp_local) {
+    // Rows past the end of the last tile have nothing to write.
+    llvm::Value* is_row_in_tile =
+        b_.CreateICmpULT(thread_id_info.thread_id_y,
+                         tiling_kernel_info.output_tile_bounds[kDimY]);
+    ksl.If("reduction_write_output",
+           b_.CreateAnd(is_row_in_tile, is_zero(thread_id_info.thread_id_x)),
+           [&] { write_output(current_outputs); });
+    return;
+  }
+
   llvm::Value* warp_id =
       b_.CreateUDiv(thread_id_info.thread_id_x, constant(WarpSize()));
 
@@ -4120,21 +4223,8 @@ void IrEmitterUnnested::EmitReductionOutputForRowReduction(
                                          absl::MakeSpan(selected_values),
                                          tiling_scheme.GetNumThreadsPerBlock());
 
-    ksl.If("reduction_write_output", is_zero(thread_id_info.thread_id_x), [&] {
-      for (int oidx = 0; oidx < num_outputs; oidx++) {
-        llvm::Value* output_address = GetOutputAddressForReduction(
-            partial_result_idx, index_ty, reduction_codegen_state,
-            tiling_kernel_info, output_arrays, reduction, oidx);
-
-        if (reduction_codegen_state.IsRaceFree()) {
-          Store(Load(selected_values[oidx].first, "output"), output_address);
-        } else {
-          CHECK_EQ(num_outputs, 1);
-          TF_CHECK_OK(EmitAtomicOperationForNestedComputation(
-              *reducer, output_address, selected_values[oidx].first));
-        }
-      }
-    });
+    ksl.If("reduction_write_output", is_zero(thread_id_info.thread_id_x),
+           [&] { write_output(selected_values); });
   });
 }
 
@@ -4865,25 +4955,6 @@ static int GetPrimitiveBitwidth(mlir::Value i) {
   return primitive_util::BitWidth(GetShape(i).element_type());
 }
 
-// Experimentally determined values to achieve optimal number of
-// bytes-in-flight. With a bound of #warps/SM which can be concurrently
-// scheduled, for small reduced values it can be hard to achieve optimal
-// number of bytes-in-flight. In order to address it, we increase the # of
-// threads/block (physically, while keeping logical mapping the same), which
-// allows larger # of bytes-in-flight.
-static int CalculateVirtualThreadScalingFactorForReduction(
-    const ReductionDimensions& reduction_dimensions,
-    const se::CudaComputeCapability& cc) {
-  if (reduction_dimensions.is_row_reduction &&
-      reduction_dimensions.dimensions[kDimX] <= 128) {
-    if (cc.IsAtLeast(se::CudaComputeCapability::AMPERE)) {
-      return 3;
-    }
-    return 5;
-  }
-  return 1;
-}
-
 llvm::Value* IrEmitterUnnested::ThreadIdInfo::GEPIntoSharedMemory(
     llvm::IRBuilder<>* b, llvm::GlobalVariable* shared,
     absl::Span<llvm::Value* const> idx_major_to_minor,
@@ -4959,6 +5030,54 @@ static bool CanVectorizeReduction(
   return false;
 }
 
+// Tiling for row reductions whose rows are short enough to be reduced by a
+// single warp, or by a fraction of one (e.g. the feature dimension of layer
+// norms and softmaxes). A full block would leave most of its threads idle on
+// such rows, so instead several rows are packed into every warp and block,
+// each row being reduced by `num_threads_x` consecutive lanes using only warp
+// shuffles (see EmitReductionOutputForRowReduction). Lanes load
+// `vector_size` consecutive elements at a time, using wider vectors for
+// narrow types. Packing rows also keeps enough bytes in flight per SM, which
+// the number of concurrently scheduled warps would otherwise limit.
+static ReductionCodegenInfo ComputeShortRowReductionCodegenInfo(
+    se::CudaComputeCapability cc, mlir::lmhlo::FusionOp fusion,
+    const ReductionDimensions& reduction_dimensions, Vector3 reduction_tiling,
+    int smallest_input_dtype_bits) {
+  constexpr int64_t kThreadsPerBlock = 256;
+  int64_t row_size = reduction_dimensions.dimensions[kDimX];
+  int64_t num_rows = reduction_dimensions.dimensions[kDimY];
+
+  int vector_size = 1;
+  if (cc.IsAtLeast(se::CudaComputeCapability::PASCAL_) &&
+      !MayPreventVectorization(fusion)) {
+    if (smallest_input_dtype_bits <= 16 && row_size % 4 == 0) {
+      vector_size = 4;
+    } else if (row_size % 2 == 0) {
+      vector_size = 2;
+    }
+  }
+
+  // A power of two, so that rows never straddle warps.
+  int64_t threads_needed = CeilOfRatio(row_size, int64_t{vector_size});
+  int64_t num_threads_x = std::min<int64_t>(
+      WarpSize(), absl::bit_ceil(static_cast<uint64_t>(threads_needed)));
+  reduction_tiling[kDimX] =
+      RoundUpTo(CeilOfRatio(row_size, num_threads_x), int64_t{vector_size});
+  int64_t rows_per_warp = WarpSize() / num_threads_x;
+  int64_t num_threads_y = std::min(kThreadsPerBlock / num_threads_x,
+                                   RoundUpTo(num_rows, rows_per_warp));
+  VLOG(3) << "Short row reduction: " << num_threads_x << " threads per row, "
+          << num_threads_y << " rows per block, vector size " << vector_size;
+
+  TilingScheme tiling_scheme(reduction_dimensions.dimensions, reduction_tiling,
+                             {1, num_threads_y, num_threads_x},
+                             kStridedIndexingX, vector_size,
+                             /*scaling_factor=*/1);
+  return ReductionCodegenInfo(
+      tiling_scheme, /*num_partial_results=*/1, /*is_row_reduction=*/true,
+      ReductionIsRaceFree(reduction_dimensions, reduction_tiling));
+}
+
 StatusOr<ReductionCodegenInfo> IrEmitterUnnested::ComputeReductionCodegenInfo(
     mlir::lmhlo::FusionOp fusion, mlir::mhlo::ReduceOp first_reduce) {
   Shape input_shape = GetShape(first_reduce->getOperand(0));
@@ -4970,6 +5089,21 @@ StatusOr<ReductionCodegenInfo> IrEmitterUnnested::ComputeReductionCodegenInfo(
            << reduction_dimensions.dimensions[2];
   Vector3 reduction_tiling = GetReductionTiling(
       reduction_dimensions, ir_emitter_context_->cuda_compute_capability());
+  se::CudaComputeCapability cc = ir_emitter_context_->cuda_compute_capability();
+
+  int smallest_input_dtype_bits = std::numeric_limits<int>::max();
+  for (mlir::Value operand : fusion.getInputBuffers()) {
+    smallest_input_dtype_bits =
+        std::min(GetPrimitiveBitwidth(operand), smallest_input_dtype_bits);
+  }
+
+  if (reduction_dimensions.is_row_reduction &&
+      reduction_dimensions.dimensions[kDimX] <=
+          WarpSize() * reduction_tiling[kDimX]) {
+    return ComputeShortRowReductionCodegenInfo(cc, fusion, reduction_dimensions,
+                                               reduction_tiling,
+                                               smallest_input_dtype_bits);
+  }
 
   int64_t num_threads_y =
       reduction_dimensions.is_row_reduction ? 1 : WarpSize();
@@ -4990,14 +5124,6 @@ StatusOr<ReductionCodegenInfo> IrEmitterUnnested::ComputeReductionCodegenInfo(
     return WarpSize();
   }();
 
-  se::CudaComputeCapability cc = ir_emitter_context_->cuda_compute_capability();
-
-  int smallest_input_dtype_bits = std::numeric_limits<int>::max();
-  for (mlir::Value operand : fusion.getInputBuffers()) {
-    smallest_input_dtype_bits =
-        std::min(GetPrimitiveBitwidth(operand), smallest_input_dtype_bits);
-  }
-
   TilingScheme::IndexingOrder indexing_order =
       reduction_dimensions.is_row_reduction ? kStridedIndexingX
                                             : kLinearIndexingX;
@@ -5012,13 +5138,9 @@ StatusOr<ReductionCodegenInfo> IrEmitterUnnested::ComputeReductionCodegenInfo(
   reduction_tiling[kDimX] *= num_partial_results;
 
   Vector3 num_threads = {1, num_threads_y, num_threads_x};
-  int virtual_thread_scaling_factor =
-      CalculateVirtualThreadScalingFactorForReduction(reduction_dimensions, cc);
-  VLOG(2) << "Using virtual thread scaling: " << virtual_thread_scaling_factor;
-
   TilingScheme tiling_scheme(reduction_dimensions.dimensions, reduction_tiling,
                              num_threads, indexing_order, vector_size,
-                             virtual_thread_scaling_factor);
+                             /*scaling_factor=*/1);
   return ReductionCodegenInfo(
       tiling_scheme, num_partial_results, reduction_dimensions.is_row_reduction,
       ReductionIsRaceFree(reduction_dimensions, reduction_tiling));
@@ -5569,6 +5691,9 @@ Status IrEmitterUnnested::EmitOp(mlir::Operation* op) {
     if (call.call_target_name() == kTriangularSolveCallTarget) {
       return EmitTriangularSolveCustomCall(op);
     }
+    if (call.call_target_name() == kFusedAttentionCallTarget) {
+      return EmitFusedAttentionCustomCall(op);
+    }
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
     return EmitCustomCallThunk(op);
@@ -191,6 +191,7 @@ class IrEmitterUnnested : public IrEmitter {
   Status EmitSort(mlir::Operation* op);
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   Status EmitTriangularSolveCustomCall(mlir::Operation* op);
+  Status EmitFusedAttentionCustomCall(mlir::Operation* op);
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
   template <typename NcclThunkType, typename OpTy>
@@ -614,11 +615,15 @@ class IrEmitterUnnested : public IrEmitter {
   //
   // Multiple partial_result_address inputs happen when doing variadic
   // reduction: each one should get the output value.
+  //
+  // With `num_results_per_warp` > 1, each warp is split into that many
+  // independent groups of consecutive lanes, and each group's result ends up
+  // in its first lane.
   void EmitFullWarpShuffleDownLoopForReduce(
       const HloComputation* reducer,
       absl::Span<std::pair<llvm::Value* const, llvm::Type* const>>
           partial_result_addresses,
-      int threads_per_block);
+      int threads_per_block, int num_results_per_warp = 1);
 
   // Allocates a shared tile of given dimensions, applying scaling specified in
   // tilng_scheme as a major-most dimension to avoid collisions.
@@ -58,6 +58,7 @@ class KernelThunk : public Thunk {
   Status Initialize(const GpuExecutable& executable,
                     se::StreamExecutor* executor) override;
   Status ExecuteOnStream(const ExecuteParams& params) override;
+  bool SupportsGraphCapture() const override { return true; }
 
   const std::vector<const BufferAllocation*>& arguments() const {
     return args_;
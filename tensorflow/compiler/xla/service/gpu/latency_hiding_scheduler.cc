@@ -0,0 +1,222 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/latency_hiding_scheduler.h"
+
+#include <algorithm>
+#include <limits>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/compiler/xla/service/hlo_instructions.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+bool IsIssuedEarly(const HloInstruction& instr) {
+  if (instr.opcode() == HloOpcode::kAllReduceStart) {
+    return true;
+  }
+  return instr.opcode() == HloOpcode::kCustomCall &&
+         static_cast<const HloCustomCallInstruction&>(instr)
+                 .custom_call_schedule() ==
+             CustomCallSchedule::SCHEDULE_EARLIEST;
+}
+
+bool IsRetiredLate(const HloInstruction& instr) {
+  if (instr.opcode() == HloOpcode::kAllReduceDone) {
+    return true;
+  }
+  return instr.opcode() == HloOpcode::kCustomCall &&
+         static_cast<const HloCustomCallInstruction&>(instr)
+                 .custom_call_schedule() ==
+             CustomCallSchedule::SCHEDULE_LATEST;
+}
+
+std::vector<HloInstruction*> Predecessors(const HloInstruction* instr) {
+  absl::flat_hash_set<HloInstruction*> seen;
+  std::vector<HloInstruction*> result;
+  for (HloInstruction* operand : instr->operands()) {
+    if (seen.insert(operand).second) {
+      result.push_back(operand);
+    }
+  }
+  for (HloInstruction* predecessor : instr->control_predecessors()) {
+    if (seen.insert(predecessor).second) {
+      result.push_back(predecessor);
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+LatencyHidingScheduler::LatencyHidingScheduler(
+    const HloCostAnalysis* cost_analysis)
+    : LatencyHidingScheduler(cost_analysis, Config()) {}
+
+double LatencyHidingScheduler::ComputeSeconds(
+    const HloInstruction& instr) const {
+  switch (instr.opcode()) {
+    case HloOpcode::kParameter:
+    case HloOpcode::kConstant:
+    case HloOpcode::kGetTupleElement:
+    case HloOpcode::kTuple:
+    case HloOpcode::kBitcast:
+    case HloOpcode::kAllReduceStart:
+    case HloOpcode::kAllReduceDone:
+      return 0;
+    default:
+      break;
+  }
+  double seconds = 0;
+  if (cost_analysis_ != nullptr) {
+    // Unknown costs, e.g. of custom-calls, are reported as negative values.
+    const double flops =
+        std::max<int64_t>(cost_analysis_->flop_count(instr), 0);
+    const double bytes =
+        std::max<int64_t>(cost_analysis_->bytes_accessed(instr), 0);
+    seconds = std::max(flops / config_.flops_per_second,
+                       bytes / config_.bytes_per_second);
+  }
+  return config_.kernel_launch_seconds + seconds;
+}
+
+double LatencyHidingScheduler::CollectiveSeconds(
+    const HloInstruction& start) const {
+  int64_t bytes = 0;
+  for (const HloInstruction* operand : start.operands()) {
+    bytes += ShapeUtil::ByteSizeOf(operand->shape());
+  }
+  // A ring all-reduce sends and receives about twice its input size.
+  return config_.collective_latency_seconds +
+         2.0 * bytes / config_.collective_bytes_per_second;
+}
+
+HloInstructionSequence LatencyHidingScheduler::Schedule(
+    const HloInstructionSequence& sequence) const {
+  const std::vector<HloInstruction*>& input = sequence.instructions();
+  absl::flat_hash_map<const HloInstruction*, int64_t> priority;
+  for (int64_t i = 0; i < input.size(); ++i) {
+    priority[input[i]] = i;
+  }
+  absl::flat_hash_map<const HloInstruction*, int64_t> unscheduled_predecessors;
+  absl::flat_hash_map<const HloInstruction*, std::vector<HloInstruction*>>
+      successors;
+  for (HloInstruction* instr : input) {
+    int64_t& count = unscheduled_predecessors[instr];
+    for (HloInstruction* predecessor : Predecessors(instr)) {
+      if (priority.contains(predecessor)) {
+        ++count;
+        successors[predecessor].push_back(instr);
+      }
+    }
+  }
+
+  // Ready instructions by their position in the input sequence.
+  std::set<std::pair<int64_t, HloInstruction*>> ready_early;
+  std::set<std::pair<int64_t, HloInstruction*>> ready_late;
+  std::set<std::pair<int64_t, HloInstruction*>> ready;
+  auto make_ready = [&](HloInstruction* instr) {
+    auto entry = std::make_pair(priority.at(instr), instr);
+    if (IsIssuedEarly(*instr)) {
+      ready_early.insert(entry);
+    } else if (IsRetiredLate(*instr)) {
+      ready_late.insert(entry);
+    } else {
+      ready.insert(entry);
+    }
+  };
+  for (HloInstruction* instr : input) {
+    if (unscheduled_predecessors.at(instr) == 0) {
+      make_ready(instr);
+    }
+  }
+
+  // Simulated times of the compute and communication streams, and estimated
+  // completion times of the issued all-reduces.
+  double compute_time = 0;
+  double collective_time = 0;
+  absl::flat_hash_map<const HloInstruction*, double> finish_time;
+  auto finish_time_of = [&](const HloInstruction& late) {
+    if (late.opcode() == HloOpcode::kAllReduceDone) {
+      auto it = finish_time.find(late.operand(0));
+      if (it != finish_time.end()) {
+        return it->second;
+      }
+    }
+    return std::numeric_limits<double>::infinity();
+  };
+
+  HloInstructionSequence result;
+  auto schedule = [&](std::set<std::pair<int64_t, HloInstruction*>>& from,
+                      std::set<std::pair<int64_t, HloInstruction*>>::iterator
+                          it) {
+    HloInstruction* instr = it->second;
+    from.erase(it);
+    result.push_back(instr);
+    if (instr->opcode() == HloOpcode::kAllReduceStart) {
+      collective_time = std::max(compute_time, collective_time) +
+                        CollectiveSeconds(*instr);
+      finish_time[instr] = collective_time;
+    } else if (instr->opcode() == HloOpcode::kAllReduceDone) {
+      compute_time = std::max(compute_time, finish_time_of(*instr));
+    } else {
+      compute_time += ComputeSeconds(*instr);
+    }
+    for (HloInstruction* successor : successors[instr]) {
+      if (--unscheduled_predecessors.at(successor) == 0) {
+        make_ready(successor);
+      }
+    }
+  };
+
+  while (result.size() < input.size()) {
+    if (!ready_early.empty()) {
+      schedule(ready_early, ready_early.begin());
+      continue;
+    }
+    // Retire the collectives that have completed by now.
+    auto completed = absl::c_find_if(ready_late, [&](const auto& entry) {
+      return finish_time_of(*entry.second) <= compute_time;
+    });
+    if (completed != ready_late.end()) {
+      schedule(ready_late, completed);
+      continue;
+    }
+    if (!ready.empty()) {
+      schedule(ready, ready.begin());
+      continue;
+    }
+    // Everything left waits for a collective; wait for the first to finish.
+    CHECK(!ready_late.empty()) << "Cycle in the input sequence";
+    schedule(ready_late,
+             absl::c_min_element(ready_late, [&](const auto& a,
+                                                 const auto& b) {
+               return finish_time_of(*a.second) < finish_time_of(*b.second);
+             }));
+  }
+  return result;
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,78 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_LATENCY_HIDING_SCHEDULER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_LATENCY_HIDING_SCHEDULER_H_
+
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_schedule.h"
+
+namespace xla {
+namespace gpu {
+
+// Reorders a single-stream schedule so that the compute stream keeps busy
+// while asynchronous all-reduces run on the communication stream.
+//
+// All-reduce-starts (and SCHEDULE_EARLIEST custom-calls) are issued as soon as
+// their operands are ready. The scheduler then simulates both streams with a
+// simple cost model: compute instructions take the time given by the cost
+// analysis, and all-reduces take a fixed latency plus their ring traffic at
+// the collective bandwidth, one after another. While an all-reduce is in
+// flight, instructions that do not depend on it are scheduled in the order of
+// the input sequence; its all-reduce-done is scheduled once it is estimated
+// to have finished, or when nothing else is left to run. Without collectives
+// in flight the input order is preserved, so the memory-minimizing order it
+// usually comes from is kept wherever there is no latency to hide.
+// SCHEDULE_LATEST custom-calls are scheduled when nothing else is left to run.
+class LatencyHidingScheduler {
+ public:
+  // Throughput and latency assumptions of the cost model. The defaults are in
+  // the range of a recent data center GPU with an NVLink interconnect; only
+  // their ratios affect the schedule.
+  struct Config {
+    double flops_per_second = 1e13;
+    double bytes_per_second = 5e11;
+    double kernel_launch_seconds = 5e-6;
+    double collective_bytes_per_second = 5e10;
+    double collective_latency_seconds = 2e-5;
+  };
+
+  // `cost_analysis` must have been run on the scheduled computation. If it is
+  // null, every compute instruction costs kernel_launch_seconds.
+  explicit LatencyHidingScheduler(const HloCostAnalysis* cost_analysis);
+  LatencyHidingScheduler(const HloCostAnalysis* cost_analysis, Config config)
+      : cost_analysis_(cost_analysis), config_(config) {}
+
+  // Returns a reordering of `sequence` that respects data and control
+  // dependencies.
+  HloInstructionSequence Schedule(const HloInstructionSequence& sequence) const;
+
+  // Estimated execution time of `instr` on the compute stream.
+  double ComputeSeconds(const HloInstruction& instr) const;
+
+  // Estimated time from issuing the all-reduce-start `start` on an idle
+  // communication stream until it completes.
+  double CollectiveSeconds(const HloInstruction& start) const;
+
+ private:
+  const HloCostAnalysis* cost_analysis_;
+  const Config config_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_LATENCY_HIDING_SCHEDULER_H_
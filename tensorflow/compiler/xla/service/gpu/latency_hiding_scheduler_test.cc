@@ -0,0 +1,162 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/latency_hiding_scheduler.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class LatencyHidingSchedulerTest : public HloTestBase {
+ protected:
+  // Every compute instruction takes 1us and every all-reduce 2.2us.
+  LatencyHidingScheduler::Config TestConfig() {
+    LatencyHidingScheduler::Config config;
+    config.kernel_launch_seconds = 1e-6;
+    config.collective_latency_seconds = 2.2e-6;
+    config.collective_bytes_per_second = 1e15;
+    return config;
+  }
+
+  HloInstructionSequence MakeSequence(HloModule* module,
+                                      const std::vector<std::string>& names) {
+    HloInstructionSequence sequence;
+    for (const std::string& name : names) {
+      sequence.push_back(FindInstruction(module, name));
+    }
+    return sequence;
+  }
+
+  std::vector<std::string> Names(const HloInstructionSequence& sequence) {
+    std::vector<std::string> names;
+    for (const HloInstruction* instr : sequence.instructions()) {
+      names.push_back(instr->name());
+    }
+    return names;
+  }
+};
+
+TEST_F(LatencyHidingSchedulerTest, OverlapsAllReduceWithIndependentCompute) {
+  constexpr char kHloString[] = R"(
+HloModule test
+
+add {
+  x = f32[] parameter(0)
+  y = f32[] parameter(1)
+  ROOT add = f32[] add(x, y)
+}
+
+ENTRY main {
+  p0 = f32[4] parameter(0)
+  p1 = f32[4] parameter(1)
+  start = f32[4] all-reduce-start(p0), to_apply=add
+  done = f32[4] all-reduce-done(start)
+  u = f32[4] negate(done)
+  c0 = f32[4] negate(p1)
+  c1 = f32[4] negate(c0)
+  c2 = f32[4] negate(c1)
+  c3 = f32[4] negate(c2)
+  c4 = f32[4] negate(c3)
+  ROOT t = (f32[4], f32[4]) tuple(u, c4)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kHloString));
+  HloInstructionSequence input =
+      MakeSequence(module.get(), {"p0", "p1", "start", "done", "u", "c0", "c1",
+                                  "c2", "c3", "c4", "t"});
+  HloInstructionSequence result =
+      LatencyHidingScheduler(/*cost_analysis=*/nullptr, TestConfig())
+          .Schedule(input);
+  // The done waits until three compute instructions have covered the 2.2us
+  // of the all-reduce, after which the input order resumes.
+  EXPECT_THAT(Names(result),
+              ::testing::ElementsAre("p0", "start", "p1", "c0", "c1", "c2",
+                                     "done", "u", "c3", "c4", "t"));
+}
+
+TEST_F(LatencyHidingSchedulerTest, SerializesAllReducesOnCommunicationStream) {
+  constexpr char kHloString[] = R"(
+HloModule test
+
+add {
+  x = f32[] parameter(0)
+  y = f32[] parameter(1)
+  ROOT add = f32[] add(x, y)
+}
+
+ENTRY main {
+  p0 = f32[4] parameter(0)
+  p1 = f32[4] parameter(1)
+  p2 = f32[4] parameter(2)
+  s0 = f32[4] all-reduce-start(p0), to_apply=add
+  d0 = f32[4] all-reduce-done(s0)
+  u0 = f32[4] negate(d0)
+  s1 = f32[4] all-reduce-start(p1), to_apply=add
+  d1 = f32[4] all-reduce-done(s1)
+  u1 = f32[4] negate(d1)
+  c0 = f32[4] negate(p2)
+  c1 = f32[4] negate(c0)
+  c2 = f32[4] negate(c1)
+  c3 = f32[4] negate(c2)
+  c4 = f32[4] negate(c3)
+  ROOT t = (f32[4], f32[4], f32[4]) tuple(u0, u1, c4)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kHloString));
+  HloInstructionSequence input = MakeSequence(
+      module.get(), {"p0", "p1", "p2", "s0", "d0", "u0", "s1", "d1", "u1",
+                     "c0", "c1", "c2", "c3", "c4", "t"});
+  HloInstructionSequence result =
+      LatencyHidingScheduler(/*cost_analysis=*/nullptr, TestConfig())
+          .Schedule(input);
+  // Both starts are issued up front, but the second all-reduce only finishes
+  // 4.4us in, after the first one.
+  EXPECT_THAT(Names(result),
+              ::testing::ElementsAre("p0", "s0", "p1", "s1", "p2", "c0", "c1",
+                                     "c2", "d0", "u0", "c3", "d1", "u1", "c4",
+                                     "t"));
+}
+
+TEST_F(LatencyHidingSchedulerTest, KeepsOrderWithoutCollectives) {
+  constexpr char kHloString[] = R"(
+HloModule test
+
+ENTRY main {
+  p0 = f32[4] parameter(0)
+  a = f32[4] negate(p0)
+  b = f32[4] exponential(p0)
+  ROOT c = f32[4] add(a, b)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kHloString));
+  HloInstructionSequence input =
+      MakeSequence(module.get(), {"p0", "b", "a", "c"});
+  HloInstructionSequence result =
+      LatencyHidingScheduler(/*cost_analysis=*/nullptr).Schedule(input);
+  EXPECT_THAT(Names(result), ::testing::ElementsAre("p0", "b", "a", "c"));
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
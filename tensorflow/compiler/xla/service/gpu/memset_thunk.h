@@ -36,6 +36,7 @@ class MemzeroThunk : public Thunk {
       : Thunk(Kind::kMemzero, thunk_info), dest_(dest) {}
 
   Status ExecuteOnStream(const ExecuteParams& params) override;
+  bool SupportsGraphCapture() const override { return true; }
 
   const BufferAllocation::Slice& destination() const { return dest_; }
 
@@ -54,6 +55,7 @@ class Memset32BitValueThunk : public Thunk {
         dest_(dest) {}
 
   Status ExecuteOnStream(const ExecuteParams& params) override;
+  bool SupportsGraphCapture() const override { return true; }
 
   const BufferAllocation::Slice& destination() const { return dest_; }
   uint32_t value() const { return value_; }
@@ -27,11 +27,13 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/algebraic_simplifier.h"
 #include "tensorflow/compiler/xla/service/call_inliner.h"
 #include "tensorflow/compiler/xla/service/dump.h"
+#include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/cublas_pad_for_gemms.h"
 #include "tensorflow/compiler/xla/service/gpu/cudnn_fused_conv_rewriter.h"
 #include "tensorflow/compiler/xla/service/gpu/cudnn_pad_for_convolutions.h"
 #include "tensorflow/compiler/xla/service/gpu/cudnn_vectorize_convolutions.h"
 #include "tensorflow/compiler/xla/service/gpu/cusolver_rewriter.h"
+#include "tensorflow/compiler/xla/service/gpu/fused_attention_rewriter.h"
 #include "tensorflow/compiler/xla/service/gpu/gemm_algorithm_picker.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_asm_opts_util.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_conv_padding_legalization.h"
@@ -42,6 +44,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/llvm_gpu_backend/gpu_backend_lib.h"
 #include "tensorflow/compiler/xla/service/gpu/metrics.h"
 #include "tensorflow/compiler/xla/service/gpu/nvptx_helper.h"
+#include "tensorflow/compiler/xla/service/gpu/quantized_dot_conv_rewriter.h"
 #include "tensorflow/compiler/xla/service/gpu/target_constants.h"
 #include "tensorflow/compiler/xla/service/gpu/triangular_solve_rewriter.h"
 #include "tensorflow/compiler/xla/service/hlo_constant_folding.h"
@@ -76,6 +79,18 @@ Status NVPTXCompiler::OptimizeHloConvolutionCanonicalization(
       /*layout_sensitive=*/false,
       /*allow_mixed_precision=*/false);
   pipeline.AddPass<GpusolverRewriter>();
+  if (hlo_module->config().debug_options().xla_gpu_enable_fused_attention()) {
+    pipeline.AddPass<FusedAttentionRewriter>();
+  }
+  // Run dots and convolutions over dequantized int8 operands on the int8
+  // cuBLAS/cuDNN paths.  Padding int8 gemms for cuBLAS requires Volta, see
+  // OptimizeHloPostLayoutAssignment.  Constant folding turns the hoisted
+  // scales into constants that CudnnFusedConvRewriter can fuse as alpha.
+  if (stream_exec->GetDeviceDescription().cuda_compute_capability().IsAtLeast(
+          se::CudaComputeCapability::VOLTA)) {
+    pipeline.AddPass<QuantizedDotConvRewriter>();
+    pipeline.AddPass<HloConstantFolding>();
+  }
   pipeline.AddPass<GpuConvRewriter>();
   pipeline.AddPass<CudnnFusedConvRewriter>();
   pipeline.AddPass<GpuConvPaddingLegalization>();
@@ -177,9 +192,15 @@ absl::optional<bool> CanShareBufferHint(const HloInstruction* user,
              (user_index.size() == 1 &&
               user->operand(user_index[0]) == operand);
     case HloOpcode::kCustomCall:
-      // Share the bias buffer with the parent instruction.
+      // Share the bias buffer with the parent instruction, unless the bias is
+      // a vector consumed by a cuBLASLt epilogue.
       if (user->custom_call_target() == kGemmCallTarget) {
-        return user->operand_count() == 3 && user->operand(2) == operand;
+        if (user->operand_count() != 3 || user->operand(2) != operand) {
+          return false;
+        }
+        auto config = user->backend_config<GemmBackendConfig>();
+        return config.ok() &&
+               config.ValueOrDie().epilogue() == GemmBackendConfig::DEFAULT;
       }
       // The operand of cholesky can be shared with the first output.
       if (user->custom_call_target() == kCusolverCholeskyCallTarget) {
@@ -80,6 +80,501 @@ LBB0_2:
 }
 )";
 
+// GPU kernels for fused multi-head attention,
+//
+//   out = softmax(scale * q * k^T) * v,
+//
+// for row-major q, out: [batch, seq_q, head_dim] and k, v: [batch, seq_k,
+// head_dim], with head_dim <= 128.  Every block of 64 threads handles 64 rows
+// of q, one per thread.  The blocks stream k and v through shared memory in
+// tiles of 32 rows and keep a running max and sum of the softmax (the "online
+// softmax" of flash attention), so the [seq_q, seq_k] score matrix never
+// exists in memory.  Accumulation is in f32 for both element types.
+//
+// The PTX below was produced by LLVM's NVPTX backend from the equivalent of
+// the following CUDA code, with T = float for __xla_FusedAttentionF32 and
+// T = half for __xla_FusedAttentionF16.
+//
+// extern "C" {
+// __global__ void __xla_FusedAttention(const T* q, const T* k, const T* v,
+//                                      T* out, int seq_q, int seq_k,
+//                                      int head_dim, float scale) {
+//   __shared__ float k_tile[32 * 128], v_tile[32 * 128];
+//   float q_row[128], acc[128];
+//   int row = blockIdx.x * 64 + threadIdx.x;
+//   bool active = row < seq_q;
+//   int64_t q_offset =
+//       (int64_t{blockIdx.y} * seq_q + (active ? row : 0)) * head_dim;
+//   int64_t kv_offset = int64_t{blockIdx.y} * seq_k;
+//   for (int d = 0; d < head_dim; ++d) {
+//     acc[d] = 0;
+//     q_row[d] = active ? float(q[q_offset + d]) * scale : 0;
+//   }
+//   float m = -INFINITY, l = 0;
+//   for (int start = 0; start < seq_k; start += 32) {
+//     int tile = min(seq_k - start, 32);
+//     __syncthreads();
+//     for (int i = threadIdx.x; i < tile * head_dim; i += 64) {
+//       k_tile[i] = k[(kv_offset + start) * head_dim + i];
+//       v_tile[i] = v[(kv_offset + start) * head_dim + i];
+//     }
+//     __syncthreads();
+//     for (int j = 0; j < tile; ++j) {
+//       float s = 0;
+//       for (int d = 0; d < head_dim; ++d) {
+//         s += q_row[d] * k_tile[j * head_dim + d];
+//       }
+//       float m_new = fmaxf(m, s);
+//       float correction = exp2f_approx((m - m_new) * M_LOG2E);
+//       float p = exp2f_approx((s - m_new) * M_LOG2E);
+//       l = l * correction + p;
+//       for (int d = 0; d < head_dim; ++d) {
+//         acc[d] = acc[d] * correction + p * v_tile[j * head_dim + d];
+//       }
+//       m = m_new;
+//     }
+//   }
+//   if (!active) return;
+//   for (int d = 0; d < head_dim; ++d) {
+//     out[q_offset + d] = T(acc[d] / l);
+//   }
+// }
+// }
+constexpr const char* kFusedAttentionPtx = R"(
+.version 4.2
+.target sm_35
+.address_size 64
+.shared .align 4 .b8 k_tile[16384];
+.shared .align 4 .b8 v_tile[16384];
+.visible .entry __xla_FusedAttentionF32(
+        .param .u64 __xla_FusedAttentionF32_param_0,
+        .param .u64 __xla_FusedAttentionF32_param_1,
+        .param .u64 __xla_FusedAttentionF32_param_2,
+        .param .u64 __xla_FusedAttentionF32_param_3,
+        .param .u32 __xla_FusedAttentionF32_param_4,
+        .param .u32 __xla_FusedAttentionF32_param_5,
+        .param .u32 __xla_FusedAttentionF32_param_6,
+        .param .f32 __xla_FusedAttentionF32_param_7
+)
+.maxntid 64, 1, 1
+{
+        .local .align 4 .b8 __local_depot0[1024];
+        .reg .b64       %SP;
+        .reg .b64       %SPL;
+        .reg .pred      %p<19>;
+        .reg .b32       %r<51>;
+        .reg .f32       %f<50>;
+        .reg .b64       %rd<84>;
+        mov.u64         %SPL, __local_depot0;
+        ld.param.u32    %r50, [__xla_FusedAttentionF32_param_6];
+        ld.param.u32    %r27, [__xla_FusedAttentionF32_param_5];
+        ld.param.u32    %r26, [__xla_FusedAttentionF32_param_4];
+        add.u64         %rd5, %SPL, 0;
+        add.s64         %rd6, %rd5, 4;
+        add.u64         %rd82, %SPL, 512;
+        add.s64         %rd83, %rd82, 4;
+        mov.u32         %r1, %tid.x;
+        mov.u32         %r29, %ctaid.x;
+        mov.u32         %r30, %ctaid.y;
+        shl.b32         %r31, %r29, 6;
+        add.s32         %r2, %r31, %r1;
+        setp.lt.s32     %p1, %r2, %r26;
+        selp.b32        %r32, %r2, 0, %p1;
+        cvt.s64.s32     %rd48, %r32;
+        cvt.s64.s32     %rd12, %r50;
+        mul.wide.s32    %rd49, %r26, %r30;
+        add.s64         %rd50, %rd49, %rd48;
+        mul.lo.s64      %rd13, %rd50, %rd12;
+        setp.lt.s32     %p2, %r50, 1;
+        shl.b64         %rd71, %rd13, 2;
+        @%p2 bra        LBB0_3;
+        ld.param.f32    %f15, [__xla_FusedAttentionF32_param_7];
+        ld.param.u64    %rd42, [__xla_FusedAttentionF32_param_0];
+        cvta.to.global.u64 %rd4, %rd42;
+        add.s64         %rd72, %rd4, %rd71;
+        mov.u64         %rd73, %rd5;
+        mov.u64         %rd74, %rd82;
+        mov.u32         %r41, %r50;
+        mov.u64         %rd75, %rd83;
+        mov.u64         %rd76, %rd6;
+LBB0_2:
+        mov.u32         %r33, 0;
+        st.local.u32    [%rd74], %r33;
+        ld.global.f32   %f16, [%rd72];
+        mul.rn.f32      %f17, %f16, %f15;
+        selp.f32        %f18, %f17, 0f00000000, %p1;
+        st.local.f32    [%rd73], %f18;
+        add.s32         %r41, %r41, -1;
+        add.s64         %rd22, %rd75, 4;
+        add.s64         %rd24, %rd76, 4;
+        add.s64         %rd72, %rd72, 4;
+        setp.eq.s32     %p4, %r41, 0;
+        mov.u64         %rd73, %rd76;
+        mov.u64         %rd74, %rd75;
+        mov.u64         %rd75, %rd22;
+        mov.u64         %rd76, %rd24;
+        @%p4 bra        LBB0_3;
+        bra.uni         LBB0_2;
+LBB0_3:
+        setp.lt.s32     %p5, %r27, 1;
+        mov.f32         %f48, 0f00000000;
+        @%p5 bra        LBB0_18;
+        ld.param.u64    %rd44, [__xla_FusedAttentionF32_param_1];
+        ld.param.u64    %rd45, [__xla_FusedAttentionF32_param_2];
+        cvta.to.global.u64 %rd2, %rd45;
+        cvta.to.global.u64 %rd3, %rd44;
+        mul.wide.s32    %rd14, %r27, %r30;
+        mov.u32         %r43, 0;
+        mov.f32         %f47, 0fFF800000;
+        mov.f32         %f48, 0f00000000;
+        mov.u64         %rd60, k_tile;
+        mov.u64         %rd62, v_tile;
+        mov.u32         %r42, %r27;
+        bra.uni         LBB0_5;
+LBB0_17:
+        add.s32         %r43, %r43, 32;
+        add.s32         %r42, %r42, -32;
+        setp.lt.s32     %p14, %r43, %r27;
+        @%p14 bra       LBB0_5;
+        bra.uni         LBB0_18;
+LBB0_5:
+        sub.s32         %r8, %r27, %r43;
+        min.s32         %r36, %r8, 32;
+        bar.sync        0;
+        mul.lo.s32      %r9, %r36, %r50;
+        setp.ge.s32     %p6, %r1, %r9;
+        @%p6 bra        LBB0_8;
+        cvt.s64.s32     %rd52, %r43;
+        add.s64         %rd53, %rd14, %rd52;
+        mul.lo.s64      %rd26, %rd53, %rd12;
+        mov.u32         %r44, %r1;
+LBB0_7:
+        cvt.s64.s32     %rd54, %r44;
+        add.s64         %rd55, %rd26, %rd54;
+        shl.b64         %rd56, %rd55, 2;
+        add.s64         %rd57, %rd3, %rd56;
+        ld.global.f32   %f22, [%rd57];
+        add.s64         %rd58, %rd2, %rd56;
+        ld.global.f32   %f23, [%rd58];
+        mul.wide.s32    %rd59, %r44, 4;
+        add.s64         %rd61, %rd60, %rd59;
+        st.shared.f32   [%rd61], %f22;
+        add.s64         %rd63, %rd62, %rd59;
+        st.shared.f32   [%rd63], %f23;
+        add.s32         %r44, %r44, 64;
+        setp.lt.s32     %p7, %r44, %r9;
+        @%p7 bra        LBB0_7;
+LBB0_8:
+        bar.sync        0;
+        setp.lt.s32     %p8, %r8, 1;
+        @%p8 bra        LBB0_17;
+        min.s32         %r35, %r42, 32;
+        max.s32         %r7, %r35, 1;
+        mov.u32         %r45, 0;
+        mov.f32         %f44, %f47;
+        mov.u32         %r46, %r45;
+        bra.uni         LBB0_10;
+LBB0_16:
+        mul.rn.f32      %f33, %f48, %f9;
+        add.rn.f32      %f48, %f33, %f10;
+        add.s32         %r46, %r46, 1;
+        add.s32         %r45, %r45, %r50;
+        setp.ne.s32     %p13, %r46, %r7;
+        mov.f32         %f44, %f47;
+        @%p13 bra       LBB0_10;
+        bra.uni         LBB0_17;
+LBB0_10:
+        mov.f32         %f46, 0f00000000;
+        @%p2 bra        LBB0_13;
+        mov.f32         %f46, 0f00000000;
+        mov.u64         %rd77, %rd5;
+        mov.u32         %r47, %r45;
+        mov.u32         %r48, %r50;
+        mov.u64         %rd78, %rd6;
+LBB0_12:
+        ld.local.f32    %f26, [%rd77];
+        mul.wide.s32    %rd64, %r47, 4;
+        add.s64         %rd66, %rd60, %rd64;
+        ld.shared.f32   %f27, [%rd66];
+        mul.rn.f32      %f28, %f26, %f27;
+        add.rn.f32      %f46, %f46, %f28;
+        add.s32         %r48, %r48, -1;
+        add.s32         %r47, %r47, 1;
+        add.s64         %rd30, %rd78, 4;
+        setp.ne.s32     %p10, %r48, 0;
+        mov.u64         %rd77, %rd78;
+        mov.u64         %rd78, %rd30;
+        @%p10 bra       LBB0_12;
+LBB0_13:
+        max.f32         %f47, %f44, %f46;
+        sub.rn.f32      %f29, %f44, %f47;
+        mul.rn.f32      %f30, %f29, 0f3FB8AA3B;
+        ex2.approx.f32  %f9, %f30;
+        sub.rn.f32      %f31, %f46, %f47;
+        mul.rn.f32      %f32, %f31, 0f3FB8AA3B;
+        ex2.approx.f32  %f10, %f32;
+        @%p2 bra        LBB0_16;
+        mov.u32         %r49, 0;
+        mov.u64         %rd79, %rd82;
+        mov.u64         %rd80, %rd83;
+LBB0_15:
+        ld.local.f32    %f34, [%rd79];
+        add.s32         %r39, %r45, %r49;
+        mul.wide.s32    %rd67, %r39, 4;
+        add.s64         %rd69, %rd62, %rd67;
+        ld.shared.f32   %f35, [%rd69];
+        mul.rn.f32      %f36, %f9, %f34;
+        mul.rn.f32      %f37, %f10, %f35;
+        add.rn.f32      %f38, %f36, %f37;
+        st.local.f32    [%rd79], %f38;
+        add.s32         %r49, %r49, 1;
+        add.s64         %rd34, %rd80, 4;
+        setp.ne.s32     %p12, %r50, %r49;
+        mov.u64         %rd79, %rd80;
+        mov.u64         %rd80, %rd34;
+        @%p12 bra       LBB0_15;
+        bra.uni         LBB0_16;
+LBB0_18:
+        setp.gt.s32     %p15, %r50, 0;
+        and.pred        %p17, %p1, %p15;
+        @!%p17 bra      LBB0_21;
+        bra.uni         LBB0_19;
+LBB0_19:
+        ld.param.u64    %rd43, [__xla_FusedAttentionF32_param_3];
+        cvta.to.global.u64 %rd1, %rd43;
+        add.s64         %rd81, %rd1, %rd71;
+LBB0_20:
+        ld.local.f32    %f39, [%rd82];
+        div.rn.f32      %f40, %f39, %f48;
+        st.global.f32   [%rd81], %f40;
+        add.s32         %r50, %r50, -1;
+        add.s64         %rd40, %rd83, 4;
+        add.s64         %rd81, %rd81, 4;
+        setp.ne.s32     %p18, %r50, 0;
+        mov.u64         %rd82, %rd83;
+        mov.u64         %rd83, %rd40;
+        @%p18 bra       LBB0_20;
+LBB0_21:
+        ret;
+}
+.visible .entry __xla_FusedAttentionF16(
+        .param .u64 __xla_FusedAttentionF16_param_0,
+        .param .u64 __xla_FusedAttentionF16_param_1,
+        .param .u64 __xla_FusedAttentionF16_param_2,
+        .param .u64 __xla_FusedAttentionF16_param_3,
+        .param .u32 __xla_FusedAttentionF16_param_4,
+        .param .u32 __xla_FusedAttentionF16_param_5,
+        .param .u32 __xla_FusedAttentionF16_param_6,
+        .param .f32 __xla_FusedAttentionF16_param_7
+)
+.maxntid 64, 1, 1
+{
+        .local .align 4 .b8 __local_depot1[1024];
+        .reg .b64       %SP;
+        .reg .b64       %SPL;
+        .reg .pred      %p<19>;
+        .reg .b16       %h<5>;
+        .reg .b32       %r<51>;
+        .reg .f32       %f<50>;
+        .reg .b64       %rd<84>;
+        mov.u64         %SPL, __local_depot1;
+        ld.param.u32    %r50, [__xla_FusedAttentionF16_param_6];
+        ld.param.u32    %r27, [__xla_FusedAttentionF16_param_5];
+        ld.param.u32    %r26, [__xla_FusedAttentionF16_param_4];
+        add.u64         %rd5, %SPL, 0;
+        add.s64         %rd6, %rd5, 4;
+        add.u64         %rd82, %SPL, 512;
+        add.s64         %rd83, %rd82, 4;
+        mov.u32         %r1, %tid.x;
+        mov.u32         %r29, %ctaid.x;
+        mov.u32         %r30, %ctaid.y;
+        shl.b32         %r31, %r29, 6;
+        add.s32         %r2, %r31, %r1;
+        setp.lt.s32     %p1, %r2, %r26;
+        selp.b32        %r32, %r2, 0, %p1;
+        cvt.s64.s32     %rd48, %r32;
+        cvt.s64.s32     %rd12, %r50;
+        mul.wide.s32    %rd49, %r26, %r30;
+        add.s64         %rd50, %rd49, %rd48;
+        mul.lo.s64      %rd13, %rd50, %rd12;
+        setp.lt.s32     %p2, %r50, 1;
+        shl.b64         %rd71, %rd13, 1;
+        @%p2 bra        LBB1_3;
+        ld.param.f32    %f15, [__xla_FusedAttentionF16_param_7];
+        ld.param.u64    %rd42, [__xla_FusedAttentionF16_param_0];
+        cvta.to.global.u64 %rd4, %rd42;
+        add.s64         %rd72, %rd4, %rd71;
+        mov.u64         %rd73, %rd5;
+        mov.u64         %rd74, %rd82;
+        mov.u32         %r41, %r50;
+        mov.u64         %rd75, %rd83;
+        mov.u64         %rd76, %rd6;
+LBB1_2:
+        mov.u32         %r33, 0;
+        st.local.u32    [%rd74], %r33;
+        ld.global.b16   %h1, [%rd72];
+        cvt.f32.f16     %f16, %h1;
+        mul.rn.f32      %f17, %f16, %f15;
+        selp.f32        %f18, %f17, 0f00000000, %p1;
+        st.local.f32    [%rd73], %f18;
+        add.s32         %r41, %r41, -1;
+        add.s64         %rd22, %rd75, 4;
+        add.s64         %rd24, %rd76, 4;
+        add.s64         %rd72, %rd72, 2;
+        setp.eq.s32     %p4, %r41, 0;
+        mov.u64         %rd73, %rd76;
+        mov.u64         %rd74, %rd75;
+        mov.u64         %rd75, %rd22;
+        mov.u64         %rd76, %rd24;
+        @%p4 bra        LBB1_3;
+        bra.uni         LBB1_2;
+LBB1_3:
+        setp.lt.s32     %p5, %r27, 1;
+        mov.f32         %f48, 0f00000000;
+        @%p5 bra        LBB1_18;
+        ld.param.u64    %rd44, [__xla_FusedAttentionF16_param_1];
+        ld.param.u64    %rd45, [__xla_FusedAttentionF16_param_2];
+        cvta.to.global.u64 %rd2, %rd45;
+        cvta.to.global.u64 %rd3, %rd44;
+        mul.wide.s32    %rd14, %r27, %r30;
+        mov.u32         %r43, 0;
+        mov.f32         %f47, 0fFF800000;
+        mov.f32         %f48, 0f00000000;
+        mov.u64         %rd60, k_tile;
+        mov.u64         %rd62, v_tile;
+        mov.u32         %r42, %r27;
+        bra.uni         LBB1_5;
+LBB1_17:
+        add.s32         %r43, %r43, 32;
+        add.s32         %r42, %r42, -32;
+        setp.lt.s32     %p14, %r43, %r27;
+        @%p14 bra       LBB1_5;
+        bra.uni         LBB1_18;
+LBB1_5:
+        sub.s32         %r8, %r27, %r43;
+        min.s32         %r36, %r8, 32;
+        bar.sync        0;
+        mul.lo.s32      %r9, %r36, %r50;
+        setp.ge.s32     %p6, %r1, %r9;
+        @%p6 bra        LBB1_8;
+        cvt.s64.s32     %rd52, %r43;
+        add.s64         %rd53, %rd14, %rd52;
+        mul.lo.s64      %rd26, %rd53, %rd12;
+        mov.u32         %r44, %r1;
+LBB1_7:
+        cvt.s64.s32     %rd54, %r44;
+        add.s64         %rd55, %rd26, %rd54;
+        shl.b64         %rd56, %rd55, 1;
+        add.s64         %rd57, %rd3, %rd56;
+        ld.global.b16   %h2, [%rd57];
+        cvt.f32.f16     %f22, %h2;
+        add.s64         %rd58, %rd2, %rd56;
+        ld.global.b16   %h3, [%rd58];
+        cvt.f32.f16     %f23, %h3;
+        mul.wide.s32    %rd59, %r44, 4;
+        add.s64         %rd61, %rd60, %rd59;
+        st.shared.f32   [%rd61], %f22;
+        add.s64         %rd63, %rd62, %rd59;
+        st.shared.f32   [%rd63], %f23;
+        add.s32         %r44, %r44, 64;
+        setp.lt.s32     %p7, %r44, %r9;
+        @%p7 bra        LBB1_7;
+LBB1_8:
+        bar.sync        0;
+        setp.lt.s32     %p8, %r8, 1;
+        @%p8 bra        LBB1_17;
+        min.s32         %r35, %r42, 32;
+        max.s32         %r7, %r35, 1;
+        mov.u32         %r45, 0;
+        mov.f32         %f44, %f47;
+        mov.u32         %r46, %r45;
+        bra.uni         LBB1_10;
+LBB1_16:
+        mul.rn.f32      %f33, %f48, %f9;
+        add.rn.f32      %f48, %f33, %f10;
+        add.s32         %r46, %r46, 1;
+        add.s32         %r45, %r45, %r50;
+        setp.ne.s32     %p13, %r46, %r7;
+        mov.f32         %f44, %f47;
+        @%p13 bra       LBB1_10;
+        bra.uni         LBB1_17;
+LBB1_10:
+        mov.f32         %f46, 0f00000000;
+        @%p2 bra        LBB1_13;
+        mov.f32         %f46, 0f00000000;
+        mov.u64         %rd77, %rd5;
+        mov.u32         %r47, %r45;
+        mov.u32         %r48, %r50;
+        mov.u64         %rd78, %rd6;
+LBB1_12:
+        ld.local.f32    %f26, [%rd77];
+        mul.wide.s32    %rd64, %r47, 4;
+        add.s64         %rd66, %rd60, %rd64;
+        ld.shared.f32   %f27, [%rd66];
+        mul.rn.f32      %f28, %f26, %f27;
+        add.rn.f32      %f46, %f46, %f28;
+        add.s32         %r48, %r48, -1;
+        add.s32         %r47, %r47, 1;
+        add.s64         %rd30, %rd78, 4;
+        setp.ne.s32     %p10, %r48, 0;
+        mov.u64         %rd77, %rd78;
+        mov.u64         %rd78, %rd30;
+        @%p10 bra       LBB1_12;
+LBB1_13:
+        max.f32         %f47, %f44, %f46;
+        sub.rn.f32      %f29, %f44, %f47;
+        mul.rn.f32      %f30, %f29, 0f3FB8AA3B;
+        ex2.approx.f32  %f9, %f30;
+        sub.rn.f32      %f31, %f46, %f47;
+        mul.rn.f32      %f32, %f31, 0f3FB8AA3B;
+        ex2.approx.f32  %f10, %f32;
+        @%p2 bra        LBB1_16;
+        mov.u32         %r49, 0;
+        mov.u64         %rd79, %rd82;
+        mov.u64         %rd80, %rd83;
+LBB1_15:
+        ld.local.f32    %f34, [%rd79];
+        add.s32         %r39, %r45, %r49;
+        mul.wide.s32    %rd67, %r39, 4;
+        add.s64         %rd69, %rd62, %rd67;
+        ld.shared.f32   %f35, [%rd69];
+        mul.rn.f32      %f36, %f9, %f34;
+        mul.rn.f32      %f37, %f10, %f35;
+        add.rn.f32      %f38, %f36, %f37;
+        st.local.f32    [%rd79], %f38;
+        add.s32         %r49, %r49, 1;
+        add.s64         %rd34, %rd80, 4;
+        setp.ne.s32     %p12, %r50, %r49;
+        mov.u64         %rd79, %rd80;
+        mov.u64         %rd80, %rd34;
+        @%p12 bra       LBB1_15;
+        bra.uni         LBB1_16;
+LBB1_18:
+        setp.gt.s32     %p15, %r50, 0;
+        and.pred        %p17, %p1, %p15;
+        @!%p17 bra      LBB1_21;
+        bra.uni         LBB1_19;
+LBB1_19:
+        ld.param.u64    %rd43, [__xla_FusedAttentionF16_param_3];
+        cvta.to.global.u64 %rd1, %rd43;
+        add.s64         %rd81, %rd1, %rd71;
+LBB1_20:
+        ld.local.f32    %f39, [%rd82];
+        div.rn.f32      %f40, %f39, %f48;
+        cvt.rn.f16.f32  %h4, %f40;
+        st.global.b16   [%rd81], %h4;
+        add.s32         %r50, %r50, -1;
+        add.s64         %rd40, %rd83, 4;
+        add.s64         %rd81, %rd81, 2;
+        setp.ne.s32     %p18, %r50, 0;
+        mov.u64         %rd82, %rd83;
+        mov.u64         %rd83, %rd40;
+        @%p18 bra       LBB1_20;
+LBB1_21:
+        ret;
+}
+)";
+
 // Lazily compiles ptx kernel, once per StreamExecutor.
 //
 // Thread-safe.
@@ -159,5 +654,45 @@ Status MakeBatchPointers(se::Stream* stream, const se::GpuAsmOpts& asm_opts,
   return Status::OK();
 }
 
+Status RunFusedAttention(se::Stream* stream, const se::GpuAsmOpts& asm_opts,
+                         PrimitiveType element_type, se::DeviceMemoryBase q,
+                         se::DeviceMemoryBase k, se::DeviceMemoryBase v,
+                         se::DeviceMemoryBase out, int batch, int seq_q,
+                         int seq_k, int head_dim, float scale) {
+  using FusedAttentionKernel =
+      LazyKernel<se::DeviceMemoryBase /*q*/, se::DeviceMemoryBase /*k*/,
+                 se::DeviceMemoryBase /*v*/, se::DeviceMemoryBase /*out*/,
+                 int /*seq_q*/, int /*seq_k*/, int /*head_dim*/,
+                 float /*scale*/>;
+  static auto* f32_kernel = new FusedAttentionKernel(
+      "__xla_FusedAttentionF32", kFusedAttentionPtx, asm_opts);
+  static auto* f16_kernel = new FusedAttentionKernel(
+      "__xla_FusedAttentionF16", kFusedAttentionPtx, asm_opts);
+
+  FusedAttentionKernel* lazy_kernel;
+  switch (element_type) {
+    case F32:
+      lazy_kernel = f32_kernel;
+      break;
+    case F16:
+      lazy_kernel = f16_kernel;
+      break;
+    default:
+      return Unimplemented("Fused attention does not support %s.",
+                           PrimitiveType_Name(element_type));
+  }
+  if (head_dim > kFusedAttentionMaxHeadDim) {
+    return InvalidArgument("Fused attention supports head_dim up to %d, got %d",
+                           kFusedAttentionMaxHeadDim, head_dim);
+  }
+  TF_ASSIGN_OR_RETURN(auto kernel, lazy_kernel->Get(stream->parent()));
+
+  constexpr int kThreads = 64;
+  stream->ThenLaunch(se::ThreadDim(kThreads, 1, 1),
+                     se::BlockDim(CeilOfRatio(seq_q, kThreads), batch, 1),
+                     *kernel, q, k, v, out, seq_q, seq_k, head_dim, scale);
+  return Status::OK();
+}
+
 }  // namespace gpu
 }  // namespace xla
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/status.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/compiler/xla/xla_data.pb.h"
 #include "tensorflow/stream_executor/device_memory.h"
 #include "tensorflow/stream_executor/gpu/gpu_asm_opts.h"
 #include "tensorflow/stream_executor/stream.h"
@@ -55,6 +56,23 @@ Status MakeBatchPointers(se::Stream* stream, const se::GpuAsmOpts& asm_opts,
                          se::DeviceMemoryBase base_ptr, int stride_bytes, int n,
                          se::DeviceMemoryBase ptrs_out);
 
+// Largest head dimension supported by RunFusedAttention.
+constexpr int kFusedAttentionMaxHeadDim = 128;
+
+// Computes
+//
+//   out[b] = softmax(scale * q[b] * k[b]^T) * v[b]
+//
+// for every b in [0, batch) without materializing the [seq_q, seq_k] score
+// matrix.  All buffers are row-major: q and out are [batch, seq_q, head_dim],
+// k and v are [batch, seq_k, head_dim].  element_type must be F32 or F16, and
+// head_dim must not exceed kFusedAttentionMaxHeadDim.
+Status RunFusedAttention(se::Stream* stream, const se::GpuAsmOpts& asm_opts,
+                         PrimitiveType element_type, se::DeviceMemoryBase q,
+                         se::DeviceMemoryBase k, se::DeviceMemoryBase v,
+                         se::DeviceMemoryBase out, int batch, int seq_q,
+                         int seq_k, int head_dim, float scale);
+
 }  // namespace gpu
 }  // namespace xla
 #endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_PRECOMPILED_KERNELS_H_
@@ -0,0 +1,183 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/quantized_dot_conv_rewriter.h"
+
+#include "tensorflow/compiler/xla/service/dfs_hlo_visitor_with_default.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_creation_utils.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/pattern_matcher.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/status_macros.h"
+#include "tensorflow/compiler/xla/window_util.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace m = match;
+
+// An operand of the form convert_fp(s8) * broadcast(scale), with `scale`
+// being nullptr if the operand is not scaled.
+struct DequantizedOperand {
+  HloInstruction* s8 = nullptr;
+  HloInstruction* scale = nullptr;
+};
+
+bool MatchDequantized(HloInstruction* instr, DequantizedOperand* out) {
+  PrimitiveType type = instr->shape().element_type();
+  if (type != F16 && type != BF16 && type != F32) {
+    return false;
+  }
+  auto quantized = m::Convert(m::Op(&out->s8).WithElementType(S8));
+  if (Match(instr, quantized)) {
+    out->scale = nullptr;
+    return true;
+  }
+  return Match(instr,
+               m::MultiplyAnyOrder(
+                   quantized, m::Broadcast(m::Op(&out->scale).WithShape(
+                                  m::Shape().IsEffectiveScalar()))));
+}
+
+// Returns the product of the scales of `lhs` and `rhs` as an f32 scalar, or
+// nullptr if neither operand is scaled.
+StatusOr<HloInstruction*> CombinedScale(const DequantizedOperand& lhs,
+                                        const DequantizedOperand& rhs) {
+  HloInstruction* combined = nullptr;
+  for (HloInstruction* scale : {lhs.scale, rhs.scale}) {
+    if (scale == nullptr) {
+      continue;
+    }
+    if (scale->shape().rank() != 0) {
+      TF_ASSIGN_OR_RETURN(
+          scale,
+          MakeReshapeHlo(
+              ShapeUtil::MakeShape(scale->shape().element_type(), {}), scale));
+    }
+    if (scale->shape().element_type() != F32) {
+      scale = MakeConvertToHlo(scale, F32);
+    }
+    if (combined == nullptr) {
+      combined = scale;
+    } else {
+      TF_ASSIGN_OR_RETURN(combined,
+                          MakeBinaryHlo(HloOpcode::kMultiply, combined, scale));
+    }
+  }
+  return combined;
+}
+
+// Whether cuBLAS can run `dot` as an int8 GEMM: exactly one contracting and
+// one non-contracting dimension per operand, besides the batch dimensions.
+bool IsInt8GemmCompatible(const HloInstruction* dot) {
+  const DotDimensionNumbers& dnums = dot->dot_dimension_numbers();
+  int64_t num_batch_dims = dnums.lhs_batch_dimensions_size();
+  return dnums.lhs_contracting_dimensions_size() == 1 &&
+         dnums.rhs_contracting_dimensions_size() == 1 &&
+         dot->operand(0)->shape().rank() == num_batch_dims + 2 &&
+         dot->operand(1)->shape().rank() == num_batch_dims + 2 &&
+         !ShapeUtil::IsZeroElementArray(dot->shape());
+}
+
+// Whether cuDNN can run `conv` as a forward int8 convolution.  Dilated,
+// reversed and grouped convolutions may be rewritten to backward convolutions
+// or need a layout cuDNN does not offer for int8, so we leave them alone.
+bool IsInt8ConvCompatible(const HloInstruction* conv) {
+  const ConvolutionDimensionNumbers& dnums =
+      conv->convolution_dimension_numbers();
+  return dnums.input_spatial_dimensions_size() == 2 &&
+         !window_util::HasDilation(conv->window()) &&
+         !window_util::HasWindowReversal(conv->window()) &&
+         conv->feature_group_count() == 1 && conv->batch_group_count() == 1 &&
+         !ShapeUtil::IsZeroElementArray(conv->operand(0)->shape()) &&
+         !ShapeUtil::IsZeroElementArray(conv->operand(1)->shape());
+}
+
+class QuantizedDotConvVisitor : public DfsHloRewriteVisitor {
+ public:
+  Status HandleDot(HloInstruction* dot) override {
+    DequantizedOperand lhs, rhs;
+    if (!MatchDequantized(dot->mutable_operand(0), &lhs) ||
+        !MatchDequantized(dot->mutable_operand(1), &rhs) ||
+        !IsInt8GemmCompatible(dot)) {
+      return Status::OK();
+    }
+    TF_ASSIGN_OR_RETURN(
+        HloInstruction * int_dot,
+        MakeDotHlo(lhs.s8, rhs.s8, dot->dot_dimension_numbers(),
+                   dot->precision_config(),
+                   /*preferred_element_type=*/S32));
+    return ReplaceWithScaled(dot, int_dot, lhs, rhs);
+  }
+
+  Status HandleConvolution(HloInstruction* conv) override {
+    DequantizedOperand lhs, rhs;
+    if (!MatchDequantized(conv->mutable_operand(0), &lhs) ||
+        !MatchDequantized(conv->mutable_operand(1), &rhs) ||
+        !IsInt8ConvCompatible(conv)) {
+      return Status::OK();
+    }
+    // CudnnFusedConvRewriter expects s32 convolutions over operands that are
+    // losslessly convertible to s8.
+    HloInstruction* int_conv = conv->parent()->AddInstruction(
+        conv->CloneWithNewOperands(
+            ShapeUtil::ChangeElementType(conv->shape(), S32),
+            {MakeConvertToHlo(lhs.s8, S32), MakeConvertToHlo(rhs.s8, S32)}));
+    return ReplaceWithScaled(conv, int_conv, lhs, rhs);
+  }
+
+ private:
+  // Replaces `old_instr` with convert(`int_instr`) scaled by the product of
+  // the operand scales.  The scaling is done in f32 so that large integer
+  // accumulators do not overflow narrower floating-point types.
+  Status ReplaceWithScaled(HloInstruction* old_instr,
+                           HloInstruction* int_instr,
+                           const DequantizedOperand& lhs,
+                           const DequantizedOperand& rhs) {
+    PrimitiveType type = old_instr->shape().element_type();
+    HloInstruction* result = MakeConvertToHlo(int_instr, F32);
+    TF_ASSIGN_OR_RETURN(HloInstruction * scale, CombinedScale(lhs, rhs));
+    if (scale != nullptr) {
+      HloInstruction* broadcast = MakeBroadcastHlo(
+          scale, /*broadcast_dimensions=*/{}, result->shape());
+      TF_ASSIGN_OR_RETURN(
+          result, MakeBinaryHlo(HloOpcode::kMultiply, result, broadcast));
+    }
+    if (type != F32) {
+      result = MakeConvertToHlo(result, type);
+    }
+    VLOG(2) << "Rewrote " << old_instr->ToString() << " to int8 "
+            << int_instr->ToString();
+    return ReplaceInstruction(old_instr, result);
+  }
+};
+
+}  // namespace
+
+StatusOr<bool> QuantizedDotConvRewriter::Run(HloModule* module) {
+  bool changed = false;
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    QuantizedDotConvVisitor visitor;
+    TF_RETURN_IF_ERROR(computation->Accept(&visitor));
+    changed |= visitor.changed();
+  }
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,61 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_QUANTIZED_DOT_CONV_REWRITER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_QUANTIZED_DOT_CONV_REWRITER_H_
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace gpu {
+
+// Rewrites dots and convolutions over symmetrically dequantized int8 operands
+// into integer dots and convolutions that cuBLAS and cuDNN run on their int8
+// paths.  A dequantized operand is spelled
+//
+//   convert_fp(x_s8) * broadcast(scale_fp)
+//
+// where scale_fp is a scalar (a per-tensor scale), or just convert_fp(x_s8).
+// The scales are hoisted out of the contraction:
+//
+//   dot(convert_fp(x_s8) * sx, convert_fp(w_s8) * sw)
+//     => convert_fp(dot_s32(x_s8, w_s8)) * broadcast(sx * sw)
+//
+//   conv(convert_fp(x_s8) * sx, convert_fp(w_s8) * sw)
+//     => convert_fp(conv_s32(convert_s32(x_s8), convert_s32(w_s8))) *
+//        broadcast(sx * sw)
+//
+// The integer dot is lowered to cuBLAS by GemmRewriter and the scaling folds
+// into the surrounding elementwise fusion.  The convolution form is the
+// "int8 -> fp32" idiom of CudnnFusedConvRewriter, which also folds a constant
+// scale into the cuDNN call as alpha.  Accumulating in s32 is exact, so the
+// result matches the dequantized one up to the rounding of the floating-point
+// accumulation.
+//
+// This pass must run before GpuConvRewriter and layout assignment.
+class QuantizedDotConvRewriter : public HloModulePass {
+ public:
+  absl::string_view name() const override {
+    return "quantized-dot-conv-rewriter";
+  }
+
+  StatusOr<bool> Run(HloModule* module) override;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_QUANTIZED_DOT_CONV_REWRITER_H_
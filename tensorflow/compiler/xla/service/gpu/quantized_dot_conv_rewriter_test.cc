@@ -0,0 +1,141 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/quantized_dot_conv_rewriter.h"
+
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+class QuantizedDotConvRewriterTest : public HloTestBase {};
+
+TEST_F(QuantizedDotConvRewriterTest, HoistsPerTensorScalesOutOfDot) {
+  const char* hlo_string = R"(
+HloModule test
+
+ENTRY main {
+  x = s8[32,64] parameter(0)
+  w = s8[64,16] parameter(1)
+  sx = f32[] parameter(2)
+  sw = f32[] parameter(3)
+  x_f32 = f32[32,64] convert(x)
+  x_scale = f32[32,64] broadcast(sx), dimensions={}
+  x_dq = f32[32,64] multiply(x_f32, x_scale)
+  w_f32 = f32[64,16] convert(w)
+  w_scale = f32[64,16] broadcast(sw), dimensions={}
+  w_dq = f32[64,16] multiply(w_scale, w_f32)
+  ROOT dot = f32[32,16] dot(x_dq, w_dq), lhs_contracting_dims={1},
+                                         rhs_contracting_dims={0}
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          QuantizedDotConvRewriter().Run(module.get()));
+  EXPECT_TRUE(changed);
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Multiply(op::Convert(op::Dot(op::Parameter(0),
+                                                     op::Parameter(1))),
+                                 op::Broadcast(op::Multiply(
+                                     op::Parameter(2), op::Parameter(3)))));
+  EXPECT_EQ(root->operand(0)->operand(0)->shape().element_type(), S32);
+}
+
+TEST_F(QuantizedDotConvRewriterTest, RewritesUnscaledF16Dot) {
+  const char* hlo_string = R"(
+HloModule test
+
+ENTRY main {
+  x = s8[32,64] parameter(0)
+  w = s8[64,16] parameter(1)
+  x_f16 = f16[32,64] convert(x)
+  w_f16 = f16[64,16] convert(w)
+  ROOT dot = f16[32,16] dot(x_f16, w_f16), lhs_contracting_dims={1},
+                                           rhs_contracting_dims={0}
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          QuantizedDotConvRewriter().Run(module.get()));
+  EXPECT_TRUE(changed);
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Convert(op::Convert(
+                        op::Dot(op::Parameter(0), op::Parameter(1)))));
+  EXPECT_EQ(root->operand(0)->shape().element_type(), F32);
+}
+
+TEST_F(QuantizedDotConvRewriterTest, RewritesConvToInt8Idiom) {
+  const char* hlo_string = R"(
+HloModule test
+
+ENTRY main {
+  x = s8[1,16,16,64] parameter(0)
+  w = s8[3,3,64,32] parameter(1)
+  x_f32 = f32[1,16,16,64] convert(x)
+  w_f32 = f32[3,3,64,32] convert(w)
+  scale = f32[] constant(0.25)
+  w_scale = f32[3,3,64,32] broadcast(scale), dimensions={}
+  w_dq = f32[3,3,64,32] multiply(w_f32, w_scale)
+  ROOT conv = f32[1,16,16,32] convolution(x_f32, w_dq),
+      window={size=3x3 pad=1_1x1_1}, dim_labels=b01f_01io->b01f
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          QuantizedDotConvRewriter().Run(module.get()));
+  EXPECT_TRUE(changed);
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root,
+              op::Multiply(op::Convert(op::Convolution(
+                               op::Convert(op::Parameter(0)),
+                               op::Convert(op::Parameter(1)))),
+                           op::Broadcast(op::Constant())));
+  EXPECT_EQ(root->operand(0)->operand(0)->shape().element_type(), S32);
+}
+
+TEST_F(QuantizedDotConvRewriterTest, IgnoresNonScalarScales) {
+  const char* hlo_string = R"(
+HloModule test
+
+ENTRY main {
+  x = s8[32,64] parameter(0)
+  w = s8[64,16] parameter(1)
+  sw = f32[16] parameter(2)
+  x_f32 = f32[32,64] convert(x)
+  w_f32 = f32[64,16] convert(w)
+  w_scale = f32[64,16] broadcast(sw), dimensions={1}
+  w_dq = f32[64,16] multiply(w_f32, w_scale)
+  ROOT dot = f32[32,16] dot(x_f32, w_dq), lhs_contracting_dims={1},
+                                          rhs_contracting_dims={0}
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          QuantizedDotConvRewriter().Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
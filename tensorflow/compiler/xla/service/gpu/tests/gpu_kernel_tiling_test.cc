@@ -13,8 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <string>
+#include <tuple>
 #include <utility>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
+
 #include "tensorflow/compiler/xla/service/gpu/tests/gpu_codegen_test.h"
 #include "tensorflow/compiler/xla/service/hlo_module_config.h"
 #include "tensorflow/compiler/xla/service/hlo_parser.h"
@@ -778,6 +783,89 @@ TEST_F(GpuKernelTilingTest, RowReductionCorrectShmemUsage) {
                      /*match_optimized_ir=*/true);
 }
 
+TEST_F(GpuKernelTilingTest, ShortRowReductionPacksRowsIntoWarps) {
+  const char *const kHloString = R"(
+  HloModule ShortRowReduce
+
+  Sum {
+    x.1 = f32[] parameter(0)
+    y.1 = f32[] parameter(1)
+    ROOT add.1 = f32[] add(x.1, y.1)
+  }
+
+  ENTRY reduce.1 {
+    parameter = f32[1024,16] parameter(0)
+    init_value = f32[] constant(0)
+    ROOT reduce = f32[1024] reduce(parameter, init_value), dimensions={1}, to_apply=Sum
+  }
+  )";
+  // Rows of 16 elements are reduced by 8 lanes loading two elements each, so
+  // four rows share a warp and the shuffles start at a distance of 4. No
+  // shared memory or block-level synchronization is needed.
+  auto hlo_module = ParseAndReturnVerifiedModule(kHloString).ValueOrDie();
+  if (!is_built_with_rocm_) {
+    CompileAndVerifyIr(std::move(hlo_module), R"(
+; CHECK-NOT: shared_cache
+; CHECK-LABEL: define void @reduce
+; CHECK-NOT: call void @llvm.nvvm.barrier0
+; CHECK: call float @llvm.nvvm.shfl.sync.down.f32(i32 -1, float %{{.*}}, i32 4, i32 31)
+; CHECK-NOT: call void @llvm.nvvm.barrier0
+; CHECK: }
+)",
+                       /*match_optimized_ir=*/true);
+  }
+  EXPECT_TRUE(RunAndCompareNoHloPasses(kHloString, ErrorSpec{1e-5, 1e-5}));
+}
+
+// Row lengths and types found in layer norms and softmaxes, including rows
+// that do not fill a power-of-two number of lanes and rows that are processed
+// by a whole warp.
+class ShortRowReductionTest
+    : public GpuKernelTilingTest,
+      public ::testing::WithParamInterface<std::tuple<const char *, int64_t>> {
+};
+
+TEST_P(ShortRowReductionTest, LayerNormAndSoftmaxStatistics) {
+  const char *type = std::get<0>(GetParam());
+  int64_t row_size = std::get<1>(GetParam());
+  // Mean and max over the feature dimension, as a multi-output fusion would
+  // compute them for a layer norm and a softmax respectively.
+  const char *const kHloTemplate = R"(
+  HloModule ShortRowReduce
+
+  Sum {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT add = f32[] add(x, y)
+  }
+
+  Max {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT max = f32[] maximum(x, y)
+  }
+
+  ENTRY main {
+    p = TYPE[37,100,ROW] parameter(0)
+    c = f32[37,100,ROW] convert(p)
+    zero = f32[] constant(0)
+    min = f32[] constant(-inf)
+    sum = f32[37,100] reduce(c, zero), dimensions={2}, to_apply=Sum
+    max = f32[37,100] reduce(c, min), dimensions={2}, to_apply=Max
+    ROOT t = (f32[37,100], f32[37,100]) tuple(sum, max)
+  }
+  )";
+  std::string hlo_string = absl::StrReplaceAll(
+      kHloTemplate, {{"TYPE", type}, {"ROW", absl::StrCat(row_size)}});
+  EXPECT_TRUE(RunAndCompare(hlo_string, ErrorSpec{1e-3, 1e-3}));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ShortRowReductionTestInstantiation, ShortRowReductionTest,
+    ::testing::Combine(::testing::Values("f32", "f16"),
+                       ::testing::Values(1, 3, 16, 24, 32, 48, 64, 96, 128,
+                                         130, 512)));
+
 TEST_F(GpuKernelTilingTest, ReductionInputTooLarge) {
   const char *const kHloString = R"(
   HloModule RowReduce
@@ -78,6 +78,8 @@ StatusOr<GlobalDeviceId> Thunk::ExecuteParams::GetGlobalDeviceId() const {
       return "kNcclAllToAll";
     case Thunk::kFft:
       return "kFft";
+    case Thunk::kFusedAttention:
+      return "kFusedAttention";
     case Thunk::kGemm:
       return "kGemm";
     case Thunk::kInfeed:
@@ -51,6 +51,7 @@ class Thunk {
     kCopy,
     kCustomCall,
     kFft,
+    kFusedAttention,
     kGemm,
     kInfeed,
     kKernel,
@@ -125,6 +126,13 @@ class Thunk {
   // Precondition: Initialize(stream->parent()) has been called.
   virtual Status ExecuteOnStream(const ExecuteParams& params) = 0;
 
+  // Returns true if the work ExecuteOnStream enqueues can be recorded into a
+  // CUDA graph and replayed later. This requires that ExecuteOnStream only
+  // enqueue device work on params.stream, without synchronizing with the host
+  // or allocating memory, and that it enqueue the same work on every call
+  // given the same buffer addresses.
+  virtual bool SupportsGraphCapture() const { return false; }
+
   static absl::string_view KindToString(Thunk::Kind kind);
 
  protected:
@@ -1246,6 +1246,10 @@ ExtractGemmBackendConfigProps(const gpu::GemmBackendConfig& config,
   if (config.batch_size() > 1) {
     props.emplace_back("batch_size", StrCat(config.batch_size()));
   }
+  if (config.epilogue() != gpu::GemmBackendConfig::DEFAULT) {
+    props.emplace_back(
+        "epilogue", gpu::GemmBackendConfig::Epilogue_Name(config.epilogue()));
+  }
   if (show_strides) {
     props.emplace_back("lhs_stride", StrCat(config.lhs_stride()));
     props.emplace_back("rhs_stride", StrCat(config.rhs_stride()));
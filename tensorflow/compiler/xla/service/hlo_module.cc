@@ -44,6 +44,15 @@ limitations under the License.
 
 namespace xla {
 
+namespace {
+
+// The task of the current thread and the number of computations it added
+// during a concurrent mutation. See HloModule::ConcurrentMutationTask.
+thread_local int64_t current_concurrent_mutation_task = -1;
+thread_local int64_t next_concurrent_mutation_sequence = 0;
+
+}  // namespace
+
 HloModule::HloModule(const std::string& name, HloModuleConfig config)
     : name_(NameUniquer::GetSanitizedName(name)),
       config_(std::move(config)),
@@ -70,6 +79,7 @@ void HloModule::ReplaceEntryComputation(HloComputation* entry_computation) {
 HloComputation* HloModule::AddComputationInternal(
     std::unique_ptr<HloComputation> computation, bool is_entry,
     bool uniquify_identifiers, bool preserve_entry_layouts) {
+  absl::MutexLockMaybe lock(concurrent_mutation_mu());
   if (is_entry) {
     CHECK_EQ(nullptr, entry_computation_);
     entry_computation_ = computation.get();
@@ -95,7 +105,7 @@ HloComputation* HloModule::AddComputationInternal(
 
     // Pick unique IDs for each instruction.
     for (auto* instruction : computation->instructions()) {
-      instruction->SetUniqueId(NewUniqueInstructionId());
+      instruction->SetUniqueId(next_unique_id_++);
     }
     // Set unique id to this computation.
     CHECK_NE(computation->root_instruction()->unique_id(), -1)
@@ -118,10 +128,76 @@ HloComputation* HloModule::AddComputationInternal(
   }
 
   computation->set_parent(this);
+  if (concurrent_mutation_) {
+    concurrent_mutation_computation_order_[computation.get()] = {
+        current_concurrent_mutation_task, next_concurrent_mutation_sequence++};
+  }
   computations_.push_back(std::move(computation));
   return computations_.back().get();
 }
 
+void HloModule::UniquifyInstructionNameAndId(HloInstruction* instruction) {
+  absl::MutexLockMaybe lock(concurrent_mutation_mu());
+  instruction->UniquifyName(&instruction_name_uniquer_);
+  instruction->SetUniqueId(next_unique_id_++);
+}
+
+void HloModule::BeginConcurrentMutation() {
+  CHECK(!concurrent_mutation_);
+  concurrent_mutation_ = true;
+  concurrent_mutation_first_id_ = next_unique_id_;
+  concurrent_mutation_num_computations_ = computations_.size();
+}
+
+void HloModule::EndConcurrentMutation() {
+  CHECK(concurrent_mutation_);
+  concurrent_mutation_ = false;
+  CHECK_GE(computations_.size(), concurrent_mutation_num_computations_)
+      << "Computations were removed during a concurrent mutation";
+
+  // Order the added computations by the task that added them, rather than by
+  // the time at which they were added.
+  auto first_added = computations_.begin() +
+                     concurrent_mutation_num_computations_;
+  std::stable_sort(first_added, computations_.end(),
+                   [&](const std::unique_ptr<HloComputation>& a,
+                       const std::unique_ptr<HloComputation>& b) {
+                     return concurrent_mutation_computation_order_.at(
+                                a.get()) <
+                            concurrent_mutation_computation_order_.at(b.get());
+                   });
+  concurrent_mutation_computation_order_.clear();
+
+  // Then rename and renumber the added instructions in that order. Every name
+  // that was handed out is still registered with the uniquer, so the new names
+  // do not collide with them.
+  for (const auto& computation : computations_) {
+    for (HloInstruction* instruction : computation->instructions()) {
+      if (instruction->unique_id() < concurrent_mutation_first_id_) {
+        continue;
+      }
+      instruction->ClearUniqueIdInternal();
+      instruction->SetUniqueId(next_unique_id_++);
+      instruction->UniquifyName(&instruction_name_uniquer_);
+    }
+  }
+  for (auto it = first_added; it != computations_.end(); ++it) {
+    HloComputation* computation = it->get();
+    computation->ClearUniqueIdInternal();
+    computation->SetUniqueId(computation->root_instruction()->unique_id());
+    computation->UniquifyName(&computation_name_uniquer_);
+  }
+}
+
+HloModule::ConcurrentMutationTask::ConcurrentMutationTask(int64_t task) {
+  current_concurrent_mutation_task = task;
+  next_concurrent_mutation_sequence = 0;
+}
+
+HloModule::ConcurrentMutationTask::~ConcurrentMutationTask() {
+  current_concurrent_mutation_task = -1;
+}
+
 HloComputation* HloModule::AddEntryComputation(
     std::unique_ptr<HloComputation> computation) {
   return AddComputationInternal(std::move(computation), /*is_entry=*/true,
@@ -25,9 +25,11 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/cord.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "tensorflow/compiler/xla/iterator_util.h"
 #include "tensorflow/compiler/xla/service/dynamic_parameter_binding.h"
@@ -316,11 +318,41 @@ class HloModule {
 
   // Assign a new unique dense id for an instruction
   int NewUniqueInstructionId() {
+    absl::MutexLockMaybe lock(concurrent_mutation_mu());
     int result = next_unique_id_;
     next_unique_id_++;
     return result;
   }
 
+  // Uniquifies the name of `instruction` and assigns it a new unique id, as it
+  // is added to one of the computations of this module.
+  void UniquifyInstructionNameAndId(HloInstruction* instruction);
+
+  // Between BeginConcurrentMutation() and EndConcurrentMutation(), passes may
+  // run concurrently over different computations of this module, so adding
+  // instructions and computations to the module is thread-safe. Nothing else
+  // about the module is, so each pass must only modify the computation that it
+  // runs on, and must not add or remove computations other than by embedding
+  // new ones.
+  //
+  // EndConcurrentMutation() renames and renumbers the instructions and
+  // computations added in between in a deterministic order, so that the module
+  // does not depend on how the passes were scheduled.
+  void BeginConcurrentMutation();
+  void EndConcurrentMutation();
+
+  // While alive, orders the computations that the current thread adds during a
+  // concurrent mutation by `task`, which must not depend on the scheduling of
+  // the threads, e.g. the index of the computation the pass is running on.
+  class ConcurrentMutationTask {
+   public:
+    explicit ConcurrentMutationTask(int64_t task);
+    ~ConcurrentMutationTask();
+
+    ConcurrentMutationTask(const ConcurrentMutationTask&) = delete;
+    ConcurrentMutationTask& operator=(const ConcurrentMutationTask&) = delete;
+  };
+
   // input_output_alias_config indicates the list of aliased buffers that are
   // expected from the module.
   HloInputOutputAliasConfig& input_output_alias_config() {
@@ -369,6 +401,7 @@ class HloModule {
   }
 
   void SetAndUniquifyInstrName(HloInstruction* instr, absl::string_view name) {
+    absl::MutexLockMaybe lock(concurrent_mutation_mu());
     instr->SetAndSanitizeName(name);
     instr->UniquifyName(&instruction_name_uniquer_);
   }
@@ -482,6 +515,22 @@ class HloModule {
   NameUniquer instruction_name_uniquer_{/*separator=*/"."};
   int next_unique_id_ = 0;
 
+  // Returns the mutex that guards the identifiers and the computations of this
+  // module during a concurrent mutation, or null otherwise.
+  absl::Mutex* concurrent_mutation_mu() {
+    return concurrent_mutation_ ? &concurrent_mutation_mu_ : nullptr;
+  }
+
+  // State of the concurrent mutation, if any. See BeginConcurrentMutation().
+  bool concurrent_mutation_ = false;
+  absl::Mutex concurrent_mutation_mu_;
+  int concurrent_mutation_first_id_ = 0;
+  int64_t concurrent_mutation_num_computations_ = 0;
+  // The task that added each computation during the concurrent mutation, and
+  // the order in which it added them.
+  absl::flat_hash_map<const HloComputation*, std::pair<int64_t, int64_t>>
+      concurrent_mutation_computation_order_;
+
   // Used to keep track of the next unique module id that should be assigned.
   static std::atomic<int> next_unique_module_id_;
   // A unique id to label modules with.
@@ -19,9 +19,23 @@ limitations under the License.
 
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mem.h"
 
 namespace xla {
 
+namespace {
+
+// Returns the host memory in use, in bytes, or 0 if it is not known.
+int64_t HostMemoryUsedBytes() {
+  tensorflow::port::MemoryInfo info = tensorflow::port::GetMemoryInfo();
+  if (info.total == INT64_MAX || info.free == INT64_MAX) {
+    return 0;
+  }
+  return info.total - info.free;
+}
+
+}  // namespace
+
 StatusOr<HloPassMetadata*> HloModuleMetadata::GetCurrentHloPassMetadata() {
   if (running_passes_.empty()) {
     return NotFound(
@@ -45,6 +59,7 @@ void HloModuleMetadata::RecordPassStart() {
   HloPassMetadata* pass_metadata = module_metadata_.add_pass_metadata();
   pass_metadata->set_pass_id(next_pass_id_++);
   pass_metadata->set_start_timestamp_usec(env_->NowMicros());
+  pass_metadata->set_host_memory_used_bytes_before(HostMemoryUsedBytes());
   running_passes_.push_back(pass_metadata);
 }
 
@@ -52,6 +67,7 @@ Status HloModuleMetadata::RecordPassEnd() {
   TF_ASSIGN_OR_RETURN(HloPassMetadata * pass_metadata,
                       GetCurrentHloPassMetadata());
   pass_metadata->set_end_timestamp_usec(env_->NowMicros());
+  pass_metadata->set_host_memory_used_bytes_after(HostMemoryUsedBytes());
   running_passes_.pop_back();
   return Status::OK();
 }
@@ -98,6 +98,18 @@ class HloModuleMetadata {
           pass_metadata->set_module_id(module_id);
         });
   }
+  Status set_current_pass_instruction_count_before(int64_t count) {
+    return MutateCurrentHloPassMetadata(
+        [&count](HloPassMetadata* pass_metadata) {
+          pass_metadata->set_instruction_count_before(count);
+        });
+  }
+  Status set_current_pass_instruction_count_after(int64_t count) {
+    return MutateCurrentHloPassMetadata(
+        [&count](HloPassMetadata* pass_metadata) {
+          pass_metadata->set_instruction_count_after(count);
+        });
+  }
   Status add_current_pass_module_group_module_id(int64_t module_id) {
     return MutateCurrentHloPassMetadata(
         [&module_id](HloPassMetadata* pass_metadata) {
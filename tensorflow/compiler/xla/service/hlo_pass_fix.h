@@ -54,6 +54,22 @@ class HloPassFix : public Pass {
     return !run_state.changed.empty();
   }
 
+  StatusOr<bool> RunOnSingleComputation(HloComputation* computation) override {
+    bool changed = false;
+    for (int64_t iteration = 0; iteration < kIterationLimit; ++iteration) {
+      TF_ASSIGN_OR_RETURN(bool changed_this_iteration,
+                          Pass::RunOnSingleComputation(computation));
+      if (!changed_this_iteration) {
+        return changed;
+      }
+      changed = true;
+    }
+    VLOG(1) << "Unexpectedly high number of iterations in HLO passes '"
+            << Pass::name() << "' for computation '" << computation->name()
+            << "'. Exiting fixed point loop.";
+    return changed;
+  }
+
   StatusOr<bool> RunOnModuleGroup(HloModuleGroup* module_group) override {
     bool changed = false;
     bool changed_this_iteration = true;
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/compiler/xla/util.h"
 
 namespace xla {
 
@@ -91,6 +92,22 @@ class HloPassInterface {
   virtual StatusOr<bool> RunOnModuleGroup(HloModuleGroup* module_group) = 0;
 
   virtual bool IsPassPipeline() { return false; }
+
+  // Returns whether running the pass on a module is equivalent to running
+  // RunOnSingleComputation() on each of its non-fusion computations, callees
+  // first.
+  // HloPassPipeline may then run the pass concurrently over computations that
+  // do not call one another (see HloModule::BeginConcurrentMutation()). Such a
+  // pass must only modify the computation that it runs on and the fusion
+  // computations that it calls, and may only read the other computations that
+  // it calls.
+  virtual bool IsComputationLocal() const { return false; }
+
+  // Runs the pass on a single computation of a module. Returns whether it
+  // modified the computation. Only called if IsComputationLocal() is true.
+  virtual StatusOr<bool> RunOnSingleComputation(HloComputation* computation) {
+    return Unimplemented("%s does not run on single computations", name());
+  }
 };
 
 // Base class for passes which are module-scoped.
@@ -15,11 +15,13 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 
+#include <algorithm>
 #include <functional>
 #include <string>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/compiler/xla/service/dump.h"
@@ -28,19 +30,37 @@ limitations under the License.
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
 
 namespace xla {
 
 namespace {
 
+int64_t InstructionCount(const HloModule& module) {
+  return module.instruction_count();
+}
+
+int64_t InstructionCount(const HloModuleGroup& module_group) {
+  int64_t count = 0;
+  for (const HloModule* module : module_group.modules()) {
+    count += module->instruction_count();
+  }
+  return count;
+}
+
 void RecordPassStartMetadata(HloModule& module, const std::string& pass_name,
                              const std::string& pipeline_name) {
   module.metadata()->RecordPassStart();
   // An HloPassMetadata was just created so Status should always be OK.
   TF_CHECK_OK(module.metadata()->set_current_pass_name(pass_name));
   TF_CHECK_OK(module.metadata()->set_current_pass_pipeline_name(pipeline_name));
+  TF_CHECK_OK(module.metadata()->set_current_pass_instruction_count_before(
+      module.instruction_count()));
 }
 
 void RecordPassStartMetadata(HloModuleGroup& module_group,
@@ -60,6 +80,9 @@ Status AttemptRecordPassEndMetadata(HloModule& module,
       module.metadata()->set_current_pass_module_id(module.unique_id()));
   TF_RETURN_IF_ERROR(
       module.metadata()->set_current_pass_module_changed(module_changed));
+  TF_RETURN_IF_ERROR(
+      module.metadata()->set_current_pass_instruction_count_after(
+          module.instruction_count()));
   TF_RETURN_IF_ERROR(module.metadata()->RecordPassEnd());
   return Status::OK();
 }
@@ -143,6 +166,95 @@ Status HloPassPipeline::RunInvariantCheckers(
   return Status::OK();
 }
 
+StatusOr<bool> HloPassPipeline::RunPass(HloPassInterface* pass,
+                                        HloModule* module) {
+  int num_threads = module->config().debug_options().xla_hlo_pass_threads();
+  // The schedule refers to instructions by their ids, which running passes
+  // concurrently renumbers.
+  if (num_threads > 1 && pass->IsComputationLocal() &&
+      !module->has_schedule()) {
+    return RunComputationLocalPass(pass, module, num_threads);
+  }
+  return RunHelper(pass, module);
+}
+
+StatusOr<bool> HloPassPipeline::RunComputationLocalPass(HloPassInterface* pass,
+                                                        HloModule* module,
+                                                        int num_threads) {
+  // Group the non-fusion computations into waves, such that each computation
+  // is in a later wave than the non-fusion computations it calls, directly or
+  // through fusion computations. The computations of a wave then do not call
+  // one another, and the pass has finished with their callees.
+  std::vector<HloComputation*> post_order = module->MakeComputationPostOrder();
+  absl::flat_hash_map<const HloComputation*, int64_t> waves;
+  std::vector<std::vector<std::pair<int64_t, HloComputation*>>> tasks;
+  for (int64_t i = 0; i < post_order.size(); ++i) {
+    HloComputation* computation = post_order[i];
+    int64_t wave = 0;
+    for (const HloInstruction* instruction : computation->instructions()) {
+      for (const HloComputation* callee : instruction->called_computations()) {
+        int64_t callee_wave = waves.at(callee);
+        wave = std::max(wave, callee->IsFusionComputation() ? callee_wave
+                                                            : callee_wave + 1);
+      }
+    }
+    waves[computation] = wave;
+    if (!computation->IsFusionComputation()) {
+      if (tasks.size() <= wave) {
+        tasks.resize(wave + 1);
+      }
+      // The position of the computation in the post order identifies its task,
+      // which orders the computations that the pass adds deterministically.
+      tasks[wave].emplace_back(i, computation);
+    }
+  }
+
+  if (thread_pool_ == nullptr) {
+    thread_pool_ = absl::make_unique<tensorflow::thread::ThreadPool>(
+        tensorflow::Env::Default(), "hlo_pass_pipeline", num_threads);
+  }
+  VLOG(1) << "    Running " << pass->name() << " over "
+          << post_order.size() << " computations in " << tasks.size()
+          << " waves";
+
+  bool changed = false;
+  Status status;
+  module->BeginConcurrentMutation();
+  for (const auto& wave_tasks : tasks) {
+    std::vector<StatusOr<bool>> results(wave_tasks.size(), false);
+    const auto run_task = [&](int64_t i) {
+      HloModule::ConcurrentMutationTask task(wave_tasks[i].first);
+      results[i] = pass->RunOnSingleComputation(wave_tasks[i].second);
+    };
+    if (wave_tasks.size() == 1) {
+      run_task(0);
+    } else {
+      tensorflow::BlockingCounter counter(wave_tasks.size());
+      for (int64_t i = 0; i < wave_tasks.size(); ++i) {
+        thread_pool_->Schedule([&, i] {
+          run_task(i);
+          counter.DecrementCount();
+        });
+      }
+      counter.Wait();
+    }
+    for (const StatusOr<bool>& result : results) {
+      if (!result.ok()) {
+        status = result.status();
+        break;
+      }
+      changed |= result.ValueOrDie();
+    }
+    if (!status.ok()) {
+      break;
+    }
+  }
+  module->EndConcurrentMutation();
+  TF_RETURN_IF_ERROR(status);
+  module->Cleanup();
+  return changed;
+}
+
 template <typename HloT>
 StatusOr<bool> HloPassPipeline::RunPassesInternal(
     HloT* hlo, const DebugOptions& debug_options) {
@@ -173,11 +285,26 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
     std::string pass_name = std::string(pass->name());
     VLOG(1) << "  HLO pass " << pass_name;
     VLOG(2) << "  Module hash " << absl::HashOf(*hlo);
+    tensorflow::profiler::TraceMe traceme(
+        [&] {
+          return tensorflow::profiler::TraceMeEncode(
+              absl::StrCat("HLO pass: ", pass_name),
+              {{"pipeline", pipeline_name}});
+        },
+        tensorflow::profiler::TraceMeLevel::kInfo);
+    int64_t instruction_count_before = InstructionCount(*hlo);
     if (!pass->IsPassPipeline()) {
       compilation_stats_->StartPass(pass_name);
     }
     RecordPassStartMetadata(*hlo, pass_name, pipeline_name);
-    TF_ASSIGN_OR_RETURN(bool pass_changed, RunHelper(pass, hlo));
+    TF_ASSIGN_OR_RETURN(bool pass_changed, RunPass(pass, hlo));
+    int64_t instruction_count_after = InstructionCount(*hlo);
+    traceme.AppendMetadata([&] {
+      return tensorflow::profiler::TraceMeEncode(
+          {{"changed", pass_changed},
+           {"instructions_before", instruction_count_before},
+           {"instructions_after", instruction_count_after}});
+    });
     SetInstructionMetadata(*hlo);
     if (!dump_regex.empty() && (pass_changed || dump_regex != ".*")) {
       MaybeDumpHloAndSaveFilenames(*hlo,
@@ -194,6 +321,8 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
     TF_RETURN_IF_ERROR(RunInvariantCheckers(hlo, pass_name));
     if (!pass->IsPassPipeline()) {
       compilation_stats_->EndPass(pass_name);
+      compilation_stats_->RecordInstructionCountDelta(
+          pass_name, instruction_count_after - instruction_count_before);
     }
   }
   return changed;
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace xla {
 
@@ -131,6 +132,15 @@ class HloPassPipeline : public HloPassInterface {
     return changed;
   }
 
+  // Runs the given pass, concurrently over independent computations if the
+  // pass is computation-local and DebugOptions::xla_hlo_pass_threads allows.
+  StatusOr<bool> RunPass(HloPassInterface* pass, HloModule* module);
+  StatusOr<bool> RunPass(HloPassInterface* pass, HloModuleGroup* module_group) {
+    return RunHelper(pass, module_group);
+  }
+  StatusOr<bool> RunComputationLocalPass(HloPassInterface* pass,
+                                         HloModule* module, int num_threads);
+
   const std::string name_;
   std::vector<std::unique_ptr<HloPassInterface>> passes_;
   std::vector<std::unique_ptr<HloPassInterface>> invariant_checkers_;
@@ -141,6 +151,9 @@ class HloPassPipeline : public HloPassInterface {
   // Use via compilation_stats_, not directly.
   std::unique_ptr<CompilationStats> empty_compilation_stats_;
 
+  // Runs computation-local passes. Created on first use.
+  std::unique_ptr<tensorflow::thread::ThreadPool> thread_pool_;
+
   // Allow PhaseOrderPipeline to modify private passes_ member in order to
   // perform PhaseOrdering.
   friend class ::xla::PhaseOrderPipeline;
@@ -99,6 +99,31 @@ class BarBlowerUpper : public HloModulePass {
   }
 };
 
+// A computation-local pass which wraps the root of every non-fusion
+// computation in a pair of negates.
+class DoubleNegateRootPass : public HloModulePass {
+  absl::string_view name() const override { return "double-negate-root"; }
+
+  bool IsComputationLocal() const override { return true; }
+
+  StatusOr<bool> RunOnSingleComputation(HloComputation* computation) override {
+    HloInstruction* root = computation->root_instruction();
+    HloInstruction* negate = computation->AddInstruction(
+        HloInstruction::CreateUnary(root->shape(), HloOpcode::kNegate, root));
+    computation->set_root_instruction(
+        computation->AddInstruction(HloInstruction::CreateUnary(
+            root->shape(), HloOpcode::kNegate, negate)));
+    return true;
+  }
+
+  StatusOr<bool> Run(HloModule* module) override {
+    for (HloComputation* computation : module->MakeNonfusionComputations()) {
+      TF_RETURN_IF_ERROR(RunOnSingleComputation(computation).status());
+    }
+    return true;
+  }
+};
+
 TEST_F(HloPassPipelineTest, ModulePassChanged) {
   // Test an HLO module pass which changes a module.
   const std::string module_str = R"(
@@ -260,6 +285,85 @@ ENTRY main {
 }
 
 // Test that metadata is set when a module group goes through a pass pipeline.
+TEST_F(HloPassPipelineTest, ConcurrentComputationLocalPassIsDeterministic) {
+  const std::string module_str = R"(
+HloModule ConcurrentComputationLocalPass
+
+add {
+  x = f32[] parameter(0)
+  y = f32[] parameter(1)
+  ROOT sum = f32[] add(x, y)
+}
+
+mul {
+  x = f32[] parameter(0)
+  y = f32[] parameter(1)
+  ROOT product = f32[] multiply(x, y)
+}
+
+ENTRY main {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  c = f32[] call(a, b), to_apply=add
+  d = f32[] call(a, b), to_apply=mul
+  ROOT e = f32[] subtract(c, d)
+}
+)";
+  auto run_with_threads =
+      [&](int num_threads,
+          const HloPrintOptions& options) -> StatusOr<std::string> {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<VerifiedHloModule> module,
+                        ParseAndReturnVerifiedModule(module_str));
+    DebugOptions debug_options = module->config().debug_options();
+    debug_options.set_xla_hlo_pass_threads(num_threads);
+    module->config().set_debug_options(debug_options);
+    HloPassPipeline pipeline(TestName());
+    pipeline.AddPass<DoubleNegateRootPass>();
+    TF_ASSIGN_OR_RETURN(bool changed, pipeline.Run(module.get()));
+    EXPECT_TRUE(changed);
+    return module->ToString(options);
+  };
+
+  // Concurrent runs assign the same names and ids regardless of scheduling.
+  TF_ASSERT_OK_AND_ASSIGN(std::string first,
+                          run_with_threads(4, HloPrintOptions()));
+  TF_ASSERT_OK_AND_ASSIGN(std::string second,
+                          run_with_threads(4, HloPrintOptions()));
+  EXPECT_EQ(first, second);
+
+  // And they produce the same module as the sequential pipeline, modulo
+  // naming.
+  TF_ASSERT_OK_AND_ASSIGN(std::string sequential,
+                          run_with_threads(1, HloPrintOptions::Canonical()));
+  TF_ASSERT_OK_AND_ASSIGN(std::string concurrent,
+                          run_with_threads(4, HloPrintOptions::Canonical()));
+  EXPECT_EQ(sequential, concurrent);
+}
+
+TEST_F(HloPassPipelineTest, RecordsInstructionCountsInMetadata) {
+  const std::string module_str = R"(
+HloModule RecordsInstructionCountsInMetadata
+
+ENTRY main {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT foo = f32[] multiply(a, b)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          ParseAndReturnVerifiedModule(module_str));
+  HloPassPipeline pipeline(TestName());
+  pipeline.AddPass<DoubleNegateRootPass>();
+  TF_ASSERT_OK(pipeline.Run(module.get()).status());
+
+  const HloModuleMetadataProto& metadata = module->metadata()->proto();
+  ASSERT_THAT(metadata.pass_metadata(), SizeIs(2));
+  const HloPassMetadata& pass_metadata = metadata.pass_metadata(1);
+  EXPECT_THAT(pass_metadata.pass_name(), StrEq("double-negate-root"));
+  EXPECT_EQ(pass_metadata.instruction_count_before(), 3);
+  EXPECT_EQ(pass_metadata.instruction_count_after(), 5);
+}
+
 TEST_F(HloPassPipelineTest, SetHloModuleMetadata) {
   HloModuleGroup module_group(TestName());
   module_group.push_back(CreateNewVerifiedModule());
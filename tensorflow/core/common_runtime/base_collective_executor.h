@@ -109,6 +109,12 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
 
   void StartAbort(const Status& s) override TF_LOCKS_EXCLUDED(status_mu_);
 
+  // Launches one collective per call.  Concurrent reductions are not fused
+  // here: every member of a group would first have to agree on which
+  // instances share a bucket, since pending sets differ from device to
+  // device, and a mismatch would deadlock.  Callers that want fewer launches
+  // should pack tensors before the op, as tf.distribute does with
+  // CommunicationOptions(bytes_per_pack=...).
   void ExecuteAsync(OpKernelContext* ctx, const CollectiveParams* col_params,
                     const string& exec_key, StatusCallback done) override;
 
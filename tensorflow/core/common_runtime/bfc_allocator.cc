@@ -21,10 +21,12 @@ limitations under the License.
 
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -40,6 +42,22 @@ namespace tensorflow {
 
 constexpr BFCAllocator::ChunkHandle BFCAllocator::kInvalidChunkHandle;
 
+struct BFCAllocator::Telemetry {
+  explicit Telemetry(const string& name)
+      : allocation_size(metrics::GetBfcAllocatorAllocationSizeSampler(name)),
+        fragmentation(metrics::GetBfcAllocatorFragmentationSampler(name)),
+        lock_wait(metrics::GetBfcAllocatorLockWaitCounter(name)) {
+    for (int b = 0; b < kNumBins; ++b) {
+      bin_bytes_in_use[b] = metrics::GetBfcAllocatorBinBytesInUseGauge(name, b);
+    }
+  }
+
+  monitoring::SamplerCell* const allocation_size;
+  monitoring::SamplerCell* const fragmentation;
+  monitoring::CounterCell* const lock_wait;
+  std::array<monitoring::GaugeCell<int64_t>*, kNumBins> bin_bytes_in_use;
+};
+
 BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
                            size_t total_memory, const string& name,
                            const Options& opts)
@@ -80,6 +98,18 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
       CHECK_NE(BinForSize(bin_size * 2), BinFromIndex(b));
     }
   }
+
+  if (opts.small_chunk_cache_bytes > 0) {
+    CHECK_LE(opts.small_chunk_cache_max_chunk_bytes,
+             BinNumToSize(kNumBins - 1))
+        << "small_chunk_cache_max_chunk_bytes is too large";
+    small_chunk_caches_.reset(new SmallChunkCache[kNumSmallChunkCacheShards]);
+    live_chunk_shards_.reset(new LiveChunkShard[kNumSmallChunkCacheShards]);
+  }
+
+  if (opts.enable_telemetry) {
+    telemetry_ = std::make_unique<Telemetry>(name);
+  }
 }
 
 BFCAllocator::~BFCAllocator() {
@@ -255,10 +285,135 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
   }
 }
 
+BFCAllocator::SmallChunkCache* BFCAllocator::CurrentThreadSmallChunkCache() {
+  // Threads are assigned to caches round-robin the first time they touch any
+  // BFCAllocator, so that a fixed pool of worker threads spreads evenly.
+  static std::atomic<int> next_thread_index{0};
+  thread_local const int thread_index =
+      next_thread_index.fetch_add(1, std::memory_order_relaxed);
+  return &small_chunk_caches_[thread_index % kNumSmallChunkCacheShards];
+}
+
+BFCAllocator::LiveChunkShard* BFCAllocator::LiveChunkShardFor(
+    const void* ptr) const {
+  const uint64 p = reinterpret_cast<std::uintptr_t>(ptr) >> kMinAllocationBits;
+  return &live_chunk_shards_[((p * 0x9E3779B97F4A7C15ull) >> 32) %
+                             kNumSmallChunkCacheShards];
+}
+
+void* BFCAllocator::AllocateFromSmallChunkCache(BinNum bin_num,
+                                                size_t num_bytes) {
+  SmallChunkCache* cache = CurrentThreadSmallChunkCache();
+  void* ptr = nullptr;
+  {
+    mutex_lock l(cache->mu);
+    std::vector<void*>& free_ptrs = cache->free_ptrs[bin_num];
+    if (free_ptrs.empty()) return nullptr;
+    ptr = free_ptrs.back();
+    free_ptrs.pop_back();
+    cache->cached_bytes -= BinNumToSize(bin_num);
+  }
+  LiveChunkShard* shard = LiveChunkShardFor(ptr);
+  mutex_lock l(shard->mu);
+  shard->chunks[ptr] = {bin_num, num_bytes};
+  return ptr;
+}
+
+bool BFCAllocator::DeallocateToSmallChunkCache(void* ptr) {
+  BinNum bin_num;
+  {
+    LiveChunkShard* shard = LiveChunkShardFor(ptr);
+    mutex_lock l(shard->mu);
+    auto it = shard->chunks.find(ptr);
+    if (it == shard->chunks.end()) return false;
+    bin_num = it->second.first;
+    shard->chunks.erase(it);
+  }
+  std::vector<void*> to_release;
+  {
+    SmallChunkCache* cache = CurrentThreadSmallChunkCache();
+    mutex_lock l(cache->mu);
+    cache->free_ptrs[bin_num].push_back(ptr);
+    cache->cached_bytes += BinNumToSize(bin_num);
+    if (cache->cached_bytes > opts_.small_chunk_cache_bytes) {
+      // Evict the largest classes first until the cache is at half of its
+      // limit, so that a single burst does not cause a flush on every free.
+      for (BinNum b = kNumBins - 1;
+           b >= 0 && cache->cached_bytes > opts_.small_chunk_cache_bytes / 2;
+           --b) {
+        std::vector<void*>& free_ptrs = cache->free_ptrs[b];
+        while (!free_ptrs.empty() &&
+               cache->cached_bytes > opts_.small_chunk_cache_bytes / 2) {
+          to_release.push_back(free_ptrs.back());
+          free_ptrs.pop_back();
+          cache->cached_bytes -= BinNumToSize(b);
+        }
+      }
+    }
+  }
+  if (!to_release.empty()) {
+    ReleaseCachedChunks(to_release);
+  }
+  return true;
+}
+
+void BFCAllocator::ReleaseCachedChunks(const std::vector<void*>& ptrs) {
+  for (void* ptr : ptrs) {
+    DeallocateRawInternal(ptr);
+  }
+  retry_helper_.NotifyDealloc();
+}
+
+int64_t BFCAllocator::FlushSmallChunkCaches() {
+  if (small_chunk_caches_ == nullptr) return 0;
+  std::vector<void*> to_release;
+  for (int i = 0; i < kNumSmallChunkCacheShards; ++i) {
+    SmallChunkCache* cache = &small_chunk_caches_[i];
+    mutex_lock l(cache->mu);
+    for (std::vector<void*>& free_ptrs : cache->free_ptrs) {
+      to_release.insert(to_release.end(), free_ptrs.begin(), free_ptrs.end());
+      free_ptrs.clear();
+    }
+    cache->cached_bytes = 0;
+  }
+  if (!to_release.empty()) {
+    ReleaseCachedChunks(to_release);
+  }
+  return to_release.size();
+}
+
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes;
-  void* result = [&] {
+  if (telemetry_) telemetry_->allocation_size->Add(num_bytes);
+  if (UseSmallChunkCache(num_bytes, allocation_attr)) {
+    const BinNum bin_num = SmallChunkCacheClass(num_bytes);
+    void* result = AllocateFromSmallChunkCache(bin_num, num_bytes);
+    if (result == nullptr) {
+      // Cache miss: carve a chunk of the full class size out of the shared
+      // bins so that it can later be reused for any request of this class.
+      result = AllocateRawInternal(unused_alignment, BinNumToSize(bin_num),
+                                   /*dump_log_on_failure=*/false,
+                                   /*freed_before=*/0);
+      if (result == nullptr && FlushSmallChunkCaches() > 0) {
+        result = AllocateRawInternal(unused_alignment, BinNumToSize(bin_num),
+                                     /*dump_log_on_failure=*/false,
+                                     /*freed_before=*/0);
+      }
+      if (result != nullptr) {
+        LiveChunkShard* shard = LiveChunkShardFor(result);
+        mutex_lock l(shard->mu);
+        shard->chunks[result] = {bin_num, num_bytes};
+      }
+    }
+    if (result != nullptr) {
+      VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " "
+              << result;
+      return result;
+    }
+    // Fall through to the regular path, which handles retries and logging.
+  }
+  auto allocate = [&] {
     if (!opts_.allow_retry_on_failure || !allocation_attr.retry_on_failure) {
       // If we have globally disabled retry-on-failure and fail to allocate an
       // "important" alloc, we want to print a log, because the program may be
@@ -303,7 +458,13 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
       return AllocateRawInternalWithRetry(unused_alignment, num_bytes,
                                           allocation_attr);
     }
-  }();
+  };
+  void* result = allocate();
+  if (result == nullptr && FlushSmallChunkCaches() > 0) {
+    // Memory parked in the per-thread caches may be enough to satisfy this
+    // request once it is returned to the shared bins.
+    result = allocate();
+  }
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " " << result;
   return result;
 }
@@ -408,6 +569,101 @@ void BFCAllocator::DeallocateRegions(
   }
 }
 
+size_t BFCAllocator::ReleaseFreeChunks(size_t rounded_bytes)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+  const size_t granularity = sub_allocator_->FreeGranularity();
+  if (granularity == 0) {
+    return 0;
+  }
+  // Returns the granule-aligned range [*start, *end) inside chunk c.
+  auto releasable_range = [granularity](const Chunk* c, char** start,
+                                        char** end) {
+    const std::uintptr_t ptr = reinterpret_cast<std::uintptr_t>(c->ptr);
+    *start = reinterpret_cast<char*>((ptr + granularity - 1) / granularity *
+                                     granularity);
+    *end = reinterpret_cast<char*>((ptr + c->size) / granularity * granularity);
+  };
+
+  // Searching for free chunks that span whole granules. Chunks that are held
+  // back by the timing counter may still be in use on the device.
+  std::vector<ChunkHandle> free_chunks;
+  size_t total_free_bytes = 0;
+  for (const AllocationRegion& region : region_manager_.regions()) {
+    ChunkHandle h = region_manager_.get_handle(region.ptr());
+    while (h != kInvalidChunkHandle) {
+      const Chunk* c = ChunkFromHandle(h);
+      char* start;
+      char* end;
+      releasable_range(c, &start, &end);
+      if (!c->in_use() && c->freed_at_count == 0 && start < end) {
+        free_chunks.push_back(h);
+        total_free_bytes += end - start;
+      }
+      h = c->next;
+    }
+  }
+
+  if (total_free_bytes == 0) {
+    return 0;
+  }
+
+  // Rough estimation to check whether releasing can help.
+  size_t available_bytes =
+      memory_limit_ - total_region_allocated_bytes_ + total_free_bytes;
+  if (rounded_bytes > available_bytes) {
+    return 0;
+  }
+
+  for (ChunkHandle h : free_chunks) {
+    char* start;
+    char* end;
+    releasable_range(ChunkFromHandle(h), &start, &end);
+    const size_t bytes = end - start;
+
+    // Split off the parts of the chunk before and after the range, which stay
+    // in the bins.
+    RemoveFreeChunkFromBin(h);
+    if (start > ChunkFromHandle(h)->ptr) {
+      SplitChunk(h, start - static_cast<char*>(ChunkFromHandle(h)->ptr));
+      InsertFreeChunkIntoBin(h);
+      h = ChunkFromHandle(h)->next;
+      RemoveFreeChunkFromBin(h);
+    }
+    if (ChunkFromHandle(h)->size > bytes) {
+      SplitChunk(h, bytes);
+    }
+
+    // The neighbors of the chunk end up in different regions.
+    Chunk* c = ChunkFromHandle(h);
+    if (c->prev != kInvalidChunkHandle) {
+      ChunkFromHandle(c->prev)->next = kInvalidChunkHandle;
+    }
+    if (c->next != kInvalidChunkHandle) {
+      ChunkFromHandle(c->next)->prev = kInvalidChunkHandle;
+    }
+    DeleteChunk(h);
+    region_manager_.RemoveRange(start, bytes);
+
+    VLOG(2) << "Release free memory at " << static_cast<void*>(start) << " of "
+            << strings::HumanReadableNumBytes(bytes);
+    sub_allocator_->Free(start, bytes);
+    total_region_allocated_bytes_ -= bytes;
+  }
+  VLOG(1) << "Released " << strings::HumanReadableNumBytes(total_free_bytes)
+          << " of free memory in " << free_chunks.size() << " chunks for "
+          << Name() << ".";
+  return total_free_bytes;
+}
+
+int64_t BFCAllocator::Compact() {
+  FlushSmallChunkCaches();
+  mutex_lock l(lock_);
+  if (!timestamped_chunks_.empty()) {
+    MergeTimestampedChunks(0);
+  }
+  return ReleaseFreeChunks(/*rounded_bytes=*/0);
+}
+
 void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
                                         size_t num_bytes,
                                         bool dump_log_on_failure,
@@ -424,7 +680,9 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
   // The BFC allocator tries to find the best fit first.
   BinNum bin_num = BinNumForSize(rounded_bytes);
 
+  const uint64 lock_start_nanos = TelemetryLockStartNanos();
   mutex_lock l(lock_);
+  RecordLockAcquired(lock_start_nanos);
   if (!timestamped_chunks_.empty()) {
     // Merge timestamped chunks whose counts have become safe for general use.
     MergeTimestampedChunks(0);
@@ -471,6 +729,27 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     }
   }
 
+  // If the sub-allocator coalesces regions, the free memory is rarely a whole
+  // region. Give back the memory backing the free chunks instead, so that the
+  // sub-allocator can return it as one contiguous region.
+  if (opts_.garbage_collection && ReleaseFreeChunks(rounded_bytes) > 0) {
+    LOG(WARNING) << "Garbage collection: released the memory of free chunks to"
+                 << " re-allocate it as a larger region and avoid OOM due to"
+                 << " memory fragmentation. If you see this message frequently,"
+                 << " you are running near the threshold of the available"
+                 << " device memory and re-allocation may incur great"
+                 << " performance overhead."
+                 << " Set TF_ENABLE_GPU_GARBAGE_COLLECTION=false if you'd like"
+                 << " to disable this feature.";
+    if (Extend(unused_alignment, rounded_bytes)) {
+      ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+      if (ptr != nullptr) {
+        AddTraceMe("MemoryAllocation", ptr);
+        return ptr;
+      }
+    }
+  }
+
   // We searched all bins for an existing free chunk to use and
   // couldn't find one.  This means we must have run out of memory,
   // Dump the memory log for analysis.
@@ -509,6 +788,35 @@ double BFCAllocator::GetFragmentation() {
          bytes_available;
 }
 
+uint64 BFCAllocator::TelemetryLockStartNanos() const {
+  return telemetry_ ? EnvTime::NowNanos() : 0;
+}
+
+void BFCAllocator::RecordLockAcquired(uint64 start_nanos) {
+  if (!telemetry_) return;
+  lock_wait_nanos_ += EnvTime::NowNanos() - start_nanos;
+  if (++telemetry_events_ % kTelemetryExportInterval == 0) {
+    ExportTelemetryLocked();
+  }
+}
+
+void BFCAllocator::ExportTelemetry() {
+  if (!telemetry_) return;
+  mutex_lock l(lock_);
+  ExportTelemetryLocked();
+}
+
+void BFCAllocator::ExportTelemetryLocked() {
+  for (int b = 0; b < kNumBins; ++b) {
+    telemetry_->bin_bytes_in_use[b]->Set(bin_bytes_in_use_[b]);
+  }
+  if (total_region_allocated_bytes_ > stats_.bytes_in_use) {
+    telemetry_->fragmentation->Add(GetFragmentation());
+  }
+  telemetry_->lock_wait->IncrementBy(lock_wait_nanos_ / 1000);
+  lock_wait_nanos_ %= 1000;
+}
+
 void BFCAllocator::AddTraceMe(absl::string_view traceme_name, const void* ptr) {
   BFCAllocator::Chunk* chunk = ChunkFromHandle(region_manager_.get_handle(ptr));
   AddTraceMe(traceme_name, chunk->ptr, chunk->requested_size, chunk->size);
@@ -538,6 +846,7 @@ void BFCAllocator::AddTraceMe(absl::string_view traceme_name,
                                {"id", annotation.pending_step_id},
                                {"region_type", annotation.pending_region_type},
                                {"data_type", annotation.pending_data_type},
+                               {"tensor_name", annotation.PendingTensorName()},
                                {"shape", annotation.pending_shape_func()}});
           },
       /*level=*/profiler::TraceMeLevel::kInfo);
@@ -597,6 +906,9 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
             std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
         stats_.largest_alloc_size =
             std::max<std::size_t>(stats_.largest_alloc_size, chunk->size);
+        if (telemetry_) {
+          bin_bytes_in_use_[BinNumForSize(chunk->size)] += chunk->size;
+        }
 
 #ifdef TENSORFLOW_MEM_DEBUG
         if (ShouldRecordOpName()) {
@@ -672,6 +984,10 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(3) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
+  if (small_chunk_caches_ != nullptr && ptr != nullptr &&
+      DeallocateToSmallChunkCache(ptr)) {
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -681,7 +997,9 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     VLOG(2) << "tried to deallocate nullptr";
     return;
   }
+  const uint64 lock_start_nanos = TelemetryLockStartNanos();
   mutex_lock l(lock_);
+  RecordLockAcquired(lock_start_nanos);
 
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
@@ -691,6 +1009,7 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   void* chunk_ptr = chunk->ptr;
   int64_t req_bytes = chunk->requested_size;
   int64_t alloc_bytes = chunk->size;
+  if (telemetry_) bin_bytes_in_use_[BinNumForSize(alloc_bytes)] -= alloc_bytes;
 
   MarkFree(h);
 
@@ -925,6 +1244,12 @@ bool BFCAllocator::TracksAllocationSizes() const { return true; }
 
 size_t BFCAllocator::RequestedSize(const void* ptr) const {
   CHECK(ptr);
+  if (live_chunk_shards_ != nullptr) {
+    LiveChunkShard* shard = LiveChunkShardFor(ptr);
+    mutex_lock l(shard->mu);
+    auto it = shard->chunks.find(ptr);
+    if (it != shard->chunks.end()) return it->second.second;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -23,6 +23,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
@@ -66,6 +67,28 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If > 0, freed chunks of at most `small_chunk_cache_max_chunk_bytes` are
+    // parked in a small per-thread cache instead of being returned to the
+    // shared bins, so that subsequent small allocations from the same thread
+    // can be served without taking the allocator lock. Each cache holds at
+    // most this many bytes before it is flushed back to the shared bins.
+    //
+    // Cached chunks still count towards bytes_in_use in GetStats(). The cache
+    // is bypassed for allocations that carry a freed_by_func and for
+    // allocators with a timing counter.
+    size_t small_chunk_cache_bytes = 0;
+
+    // Largest allocation, in bytes, that is eligible for the per-thread cache.
+    size_t small_chunk_cache_max_chunk_bytes = 4096;
+
+    // If true, the allocator exports a histogram of requested allocation
+    // sizes, the bytes in use per bin, a fragmentation ratio and the time
+    // spent waiting for its lock through the "/tensorflow/core/bfc_allocator/"
+    // metrics in framework/metrics.h. The per-bin and fragmentation metrics
+    // are sampled every kTelemetryExportInterval allocations and
+    // deallocations.
+    bool enable_telemetry = false;
   };
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
@@ -105,6 +128,22 @@ class BFCAllocator : public Allocator {
 
   MemoryDump RecordMemoryMap();
 
+  // Returns all chunks held in the per-thread small chunk caches to the
+  // shared bins. Returns the number of chunks that were released.
+  int64_t FlushSmallChunkCaches();
+
+  // Compacts the memory of the allocator at a quiescent point, e.g. between
+  // the requests of a long-running server: if the sub-allocator can free
+  // ranges in the middle of its allocations (SubAllocator::FreeGranularity),
+  // the memory backing free chunks is given back to it, so that fragmented
+  // free memory can be returned as one contiguous region by the next Extend.
+  // Live allocations are not moved. Returns the number of bytes given back.
+  int64_t Compact();
+
+  // Exports the periodically sampled telemetry immediately. No-op unless
+  // Options::enable_telemetry is set.
+  void ExportTelemetry();
+
  private:
   struct Bin;
 
@@ -318,6 +357,24 @@ class BFCAllocator : public Allocator {
           (memory_size_ + kMinAllocationSize - 1) / kMinAllocationSize;
       handles_.resize(n_handles, kInvalidChunkHandle);
     }
+    // Moves the memory from `p` to the end of the region into a new region,
+    // which is returned.
+    AllocationRegion Split(void* p) {
+      const size_t index = IndexFor(p);
+      AllocationRegion tail;
+      tail.ptr_ = p;
+      tail.memory_size_ =
+          static_cast<size_t>(static_cast<char*>(end_ptr_) -
+                              static_cast<char*>(p));
+      tail.end_ptr_ = end_ptr_;
+      tail.handles_.assign(handles_.begin() + index, handles_.end());
+      DCHECK_EQ(0, tail.memory_size_ % kMinAllocationSize);
+
+      memory_size_ -= tail.memory_size_;
+      end_ptr_ = p;
+      handles_.resize(index);
+      return tail;
+    }
     ChunkHandle get_handle(const void* p) const {
       return handles_[IndexFor(p)];
     }
@@ -406,6 +463,26 @@ class BFCAllocator : public Allocator {
       return regions_.erase(it);
     }
 
+    // Removes [ptr, ptr + memory_size) from the region that contains it,
+    // splitting the region in two if the range is in its middle. The range
+    // must not hold any chunks.
+    void RemoveRange(void* ptr, size_t memory_size) {
+      auto it =
+          std::upper_bound(regions_.begin(), regions_.end(), ptr, &Comparator);
+      void* end_ptr = static_cast<char*>(ptr) + memory_size;
+      DCHECK(it != regions_.end());
+      DCHECK(it->ptr() <= ptr && end_ptr <= it->end_ptr());
+      AllocationRegion tail;
+      if (end_ptr < it->end_ptr()) tail = it->Split(end_ptr);
+      it->Split(ptr);
+      if (it->memory_size() == 0) {
+        it = regions_.erase(it);
+      } else {
+        ++it;
+      }
+      if (tail.memory_size() > 0) regions_.insert(it, std::move(tail));
+    }
+
     ChunkHandle get_handle(const void* p) const {
       return RegionFor(p)->get_handle(p);
     }
@@ -442,6 +519,60 @@ class BFCAllocator : public Allocator {
     std::vector<AllocationRegion> regions_;
   };
 
+  // Per-thread small chunk cache (see Options::small_chunk_cache_bytes).
+  //
+  // Chunks in a cache remain "in use" from the point of view of the shared
+  // bins, so no Chunk metadata needs to be touched to hand them out again.
+  // Each eligible request is rounded up to a power of two so that any cached
+  // chunk of the same size class satisfies it.
+  static constexpr int kNumSmallChunkCacheShards = 32;
+
+  struct SmallChunkCache {
+    mutex mu;
+    std::array<std::vector<void*>, kNumBins> free_ptrs TF_GUARDED_BY(mu);
+    size_t cached_bytes TF_GUARDED_BY(mu) = 0;
+  };
+
+  // Records the size class and requested size of each live pointer handed out
+  // through the cache path, sharded by pointer.
+  struct LiveChunkShard {
+    mutex mu;
+    absl::flat_hash_map<const void*, std::pair<BinNum, size_t>> chunks
+        TF_GUARDED_BY(mu);
+  };
+
+  bool UseSmallChunkCache(size_t num_bytes,
+                          const AllocationAttributes& allocation_attr) const {
+    return opts_.small_chunk_cache_bytes > 0 &&
+           num_bytes <= opts_.small_chunk_cache_max_chunk_bytes &&
+           num_bytes > 0 && allocation_attr.freed_by_func == nullptr &&
+           timing_counter_ == nullptr;
+  }
+
+  // Returns the size class used by the cache for a request of `num_bytes`.
+  BinNum SmallChunkCacheClass(size_t num_bytes) {
+    const size_t rounded = RoundedBytes(num_bytes);
+    BinNum b = BinNumForSize(rounded);
+    if (BinNumToSize(b) < rounded) ++b;
+    return b;
+  }
+
+  SmallChunkCache* CurrentThreadSmallChunkCache();
+  LiveChunkShard* LiveChunkShardFor(const void* ptr) const;
+
+  // Pops a cached chunk of size class `bin_num` for the calling thread, or
+  // returns nullptr if there is none.
+  void* AllocateFromSmallChunkCache(BinNum bin_num, size_t num_bytes);
+
+  // Returns true if `ptr` was handed out through the cache path, in which
+  // case the chunk has been parked in the calling thread's cache (and the
+  // cache maybe flushed).
+  bool DeallocateToSmallChunkCache(void* ptr);
+
+  // Returns cached `ptrs` to the shared bins.
+  void ReleaseCachedChunks(const std::vector<void*>& ptrs)
+      TF_LOCKS_EXCLUDED(lock_);
+
   // Returns 'bytes' rounded up to the next highest kMinAllocationSize.
   static size_t RoundedBytes(size_t bytes);
 
@@ -463,6 +594,15 @@ class BFCAllocator : public Allocator {
   void DeallocateRegions(const absl::flat_hash_set<void*>& region_ptrs)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Gives back the memory backing free chunks to a sub-allocator that supports
+  // freeing parts of its allocations, splitting the regions around it. Unlike
+  // DeallocateFreeRegions, this also helps when one region holds all the
+  // memory, as with sub-allocators that support coalescing. Does nothing and
+  // returns 0 if that cannot free enough memory for 'rounded_bytes'.
+  // Otherwise returns the number of bytes given back.
+  size_t ReleaseFreeChunks(size_t rounded_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Returns a pointer to an underlying allocated chunk of size
   // 'rounded_bytes'.
   void* FindChunkPtr(BinNum bin_num, size_t rounded_bytes, size_t num_bytes,
@@ -596,6 +736,10 @@ class BFCAllocator : public Allocator {
 
   std::atomic<uint64> safe_frontier_ = {0};
 
+  // Only allocated when Options::small_chunk_cache_bytes > 0.
+  std::unique_ptr<SmallChunkCache[]> small_chunk_caches_;
+  std::unique_ptr<LiveChunkShard[]> live_chunk_shards_;
+
   // Structures mutable after construction
   mutable mutex lock_;
   RegionManager region_manager_ TF_GUARDED_BY(lock_);
@@ -611,6 +755,24 @@ class BFCAllocator : public Allocator {
 
   // Stats.
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
+
+  // Metric cells, only allocated when Options::enable_telemetry is set.
+  struct Telemetry;
+  std::unique_ptr<Telemetry> telemetry_;
+  static constexpr int64_t kTelemetryExportInterval = 1024;
+
+  // Returns the current time if telemetry is enabled, to be passed to
+  // RecordLockAcquired() once `lock_` is held.
+  uint64 TelemetryLockStartNanos() const;
+  void RecordLockAcquired(uint64 start_nanos)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void ExportTelemetryLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Bytes in use by chunks of each bin size, maintained when telemetry is
+  // enabled.
+  std::array<int64_t, kNumBins> bin_bytes_in_use_ TF_GUARDED_BY(lock_) = {};
+  uint64 lock_wait_nanos_ TF_GUARDED_BY(lock_) = 0;
+  int64_t telemetry_events_ TF_GUARDED_BY(lock_) = 0;
 #ifdef TENSORFLOW_MEM_DEBUG
   int64 action_counter_ = 0 TF_GUARDED_BY(lock_);
 #define MEM_DEBUG_SIZE_HISTORY_SIZE 4096
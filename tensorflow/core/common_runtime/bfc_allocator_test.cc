@@ -0,0 +1,178 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<SubAllocator> CreateCPUSubAllocator() {
+  return std::make_unique<BasicCPUAllocator>(port::kNUMANoAffinity,
+                                             std::vector<SubAllocator::Visitor>(),
+                                             std::vector<SubAllocator::Visitor>());
+}
+
+BFCAllocator::Options CacheOptions(size_t cache_bytes) {
+  BFCAllocator::Options opts;
+  opts.allow_growth = true;
+  opts.small_chunk_cache_bytes = cache_bytes;
+  return opts;
+}
+
+TEST(BFCAllocatorTest, SmallChunkCacheReusesFreedChunk) {
+  BFCAllocator a(CreateCPUSubAllocator(), 1 << 24, "cpu_bfc",
+                 CacheOptions(1 << 16));
+  void* p1 = a.AllocateRaw(64, 1000);
+  ASSERT_NE(p1, nullptr);
+  EXPECT_EQ(a.RequestedSize(p1), 1000);
+  a.DeallocateRaw(p1);
+
+  // A request of the same size class is served from the cache.
+  void* p2 = a.AllocateRaw(64, 900);
+  EXPECT_EQ(p1, p2);
+  EXPECT_EQ(a.RequestedSize(p2), 900);
+  EXPECT_GE(a.AllocatedSize(p2), 1024);
+  a.DeallocateRaw(p2);
+
+  // Cached chunks are still accounted as in use until flushed.
+  EXPECT_GT(a.GetStats()->bytes_in_use, 0);
+  EXPECT_EQ(a.FlushSmallChunkCaches(), 1);
+  EXPECT_EQ(a.GetStats()->bytes_in_use, 0);
+}
+
+TEST(BFCAllocatorTest, SmallChunkCacheSkipsLargeAllocations) {
+  BFCAllocator a(CreateCPUSubAllocator(), 1 << 24, "cpu_bfc",
+                 CacheOptions(1 << 16));
+  void* p = a.AllocateRaw(64, 1 << 20);
+  ASSERT_NE(p, nullptr);
+  a.DeallocateRaw(p);
+  EXPECT_EQ(a.GetStats()->bytes_in_use, 0);
+  EXPECT_EQ(a.FlushSmallChunkCaches(), 0);
+}
+
+TEST(BFCAllocatorTest, SmallChunkCacheFlushesOverLimit) {
+  BFCAllocator a(CreateCPUSubAllocator(), 1 << 24, "cpu_bfc",
+                 CacheOptions(8 * 1024));
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; ++i) {
+    ptrs.push_back(a.AllocateRaw(64, 1024));
+    ASSERT_NE(ptrs.back(), nullptr);
+  }
+  for (void* p : ptrs) {
+    a.DeallocateRaw(p);
+  }
+  // At most the cache limit remains parked in the cache.
+  EXPECT_LE(a.GetStats()->bytes_in_use, 8 * 1024);
+  a.FlushSmallChunkCaches();
+  EXPECT_EQ(a.GetStats()->bytes_in_use, 0);
+}
+
+TEST(BFCAllocatorTest, SmallChunkCacheFlushedOnOutOfMemory) {
+  BFCAllocator::Options opts = CacheOptions(1 << 20);
+  opts.small_chunk_cache_max_chunk_bytes = 1 << 16;
+  opts.allow_growth = false;
+  opts.allow_retry_on_failure = false;
+  BFCAllocator a(CreateCPUSubAllocator(), 1 << 18, "cpu_bfc", opts);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 4; ++i) {
+    ptrs.push_back(a.AllocateRaw(64, 1 << 16));
+    ASSERT_NE(ptrs.back(), nullptr);
+  }
+  for (void* p : ptrs) {
+    a.DeallocateRaw(p);
+  }
+  // The whole arena is parked in the cache as 64KiB chunks; a request of a
+  // different class only succeeds once the cache is flushed.
+  void* p = a.AllocateRaw(64, 1 << 17);
+  EXPECT_NE(p, nullptr);
+  a.DeallocateRaw(p);
+}
+
+TEST(BFCAllocatorTest, TelemetryExportsMetrics) {
+  BFCAllocator::Options opts;
+  opts.enable_telemetry = true;
+  const string name = "cpu_bfc_telemetry";
+  BFCAllocator a(CreateCPUSubAllocator(), 1 << 24, name, opts);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 4; ++i) {
+    ptrs.push_back(a.AllocateRaw(64, 1024));
+    ASSERT_NE(ptrs.back(), nullptr);
+  }
+  a.ExportTelemetry();
+
+  EXPECT_EQ(
+      4, metrics::GetBfcAllocatorAllocationSizeSampler(name)->value().num());
+  // 1KiB chunks belong to bin 2 (bins start at 256 bytes and double).
+  EXPECT_EQ(4 * 1024,
+            metrics::GetBfcAllocatorBinBytesInUseGauge(name, 2)->value());
+  EXPECT_EQ(0, metrics::GetBfcAllocatorBinBytesInUseGauge(name, 3)->value());
+  EXPECT_EQ(1,
+            metrics::GetBfcAllocatorFragmentationSampler(name)->value().num());
+
+  for (void* p : ptrs) a.DeallocateRaw(p);
+  a.ExportTelemetry();
+  EXPECT_EQ(0, metrics::GetBfcAllocatorBinBytesInUseGauge(name, 2)->value());
+}
+
+void BM_SmallAllocationContention(::testing::benchmark::State& state) {
+  const int num_threads = state.range(0);
+  const size_t cache_bytes = state.range(1);
+  constexpr int kSubIters = 1000;
+
+  for (auto s : state) {
+    state.PauseTiming();
+    BFCAllocator a(CreateCPUSubAllocator(), 1uLL << 30, "cpu_bfc",
+                   CacheOptions(cache_bytes));
+    thread::ThreadPool pool(Env::Default(), "test", num_threads);
+    BlockingCounter done(num_threads);
+    state.ResumeTiming();
+    for (int t = 0; t < num_threads; t++) {
+      pool.Schedule([&a, &done]() {
+        const size_t sizes[] = {64, 256, 512, 1024, 2048, 4096};
+        void* live[4] = {nullptr, nullptr, nullptr, nullptr};
+        for (int i = 0; i < kSubIters; i++) {
+          void*& slot = live[i % 4];
+          if (slot != nullptr) a.DeallocateRaw(slot);
+          slot = a.AllocateRaw(64, sizes[i % 6]);
+        }
+        for (void* p : live) a.DeallocateRaw(p);
+        done.DecrementCount();
+      });
+    }
+    done.Wait();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_threads * kSubIters);
+}
+BENCHMARK(BM_SmallAllocationContention)
+    ->ArgPair(1, 0)
+    ->ArgPair(1, 1 << 16)
+    ->ArgPair(8, 0)
+    ->ArgPair(8, 1 << 16)
+    ->ArgPair(64, 0)
+    ->ArgPair(64, 1 << 16);
+
+}  // namespace
+}  // namespace tensorflow
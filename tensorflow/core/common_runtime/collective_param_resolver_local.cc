@@ -686,13 +686,27 @@ void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
   //
   // After enough testing, we may simplify this logic to use NCCL whenever
   // available.
+  //
+  // A `nccl_hierarchical` hint selects the two-level NCCL + ring all-reduce for
+  // reductions spanning several tasks with the same number of GPUs each, and
+  // otherwise falls back to plain NCCL.
+  const string& hint = cp->instance.impl_details.communication_hint;
   CollectiveImplementationInterface* col_impl;
   bool use_nccl =
-      (nccl_ || cp->instance.impl_details.communication_hint == "nccl") &&
+      (nccl_ || hint == "nccl" || hint == "nccl_hierarchical") &&
       cp->group.device_type == DEVICE_GPU &&
       CollectiveRegistry::LookupParamResolverInstance("NcclReduce", &col_impl)
           .ok();
-  cp->instance.impl_details.collective_name = GetCollectiveName(cp, use_nccl);
+  if (use_nccl && hint == "nccl_hierarchical" &&
+      cp->instance.type == REDUCTION_COLLECTIVE && cp->group.num_tasks > 1 &&
+      cp->group.same_num_devices_per_task &&
+      CollectiveRegistry::LookupParamResolverInstance("NcclHierarchicalReduce",
+                                                      &col_impl)
+          .ok()) {
+    cp->instance.impl_details.collective_name = "NcclHierarchicalReduce";
+  } else {
+    cp->instance.impl_details.collective_name = GetCollectiveName(cp, use_nccl);
+  }
   VLOG(1) << "AssignCollectiveType "
           << cp->instance.impl_details.collective_name;
 }
@@ -95,6 +95,8 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
       polling_active_delay_usecs_(gpu_options.polling_active_delay_usecs()
                                       ? gpu_options.polling_active_delay_usecs()
                                       : 10),
+      use_host_callbacks_(
+          gpu_options.experimental().event_mgr_use_host_callbacks()),
       threadpool_(Env::Default(), "Device_Event_Manager", kNumThreads) {
   device_event_mgr::InitThreadpoolLabels(&threadpool_);
   StartPollingLoop();
@@ -102,6 +104,10 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
 
 EventMgr::~EventMgr() {
   StopPollingLoop();
+  {
+    mutex_lock l(mu_);
+    while (num_pending_host_callbacks_ > 0) host_callbacks_done_.wait(l);
+  }
 
   // Events are owned by this object.
   for (auto& e : free_events_) {
@@ -166,6 +172,31 @@ void EventMgr::PollLoop() {
   polling_stopped_->Notify();
 }
 
+void EventMgr::ThenExecuteWithHostCallback(se::Stream* stream,
+                                           std::function<void()> func) {
+  {
+    mutex_lock l(mu_);
+    ++num_pending_host_callbacks_;
+  }
+  stream->ThenDoHostCallback([this, func = std::move(func)]() mutable {
+    mutex_lock l(mu_);
+    if (completed_funcs_.empty()) {
+      threadpool_.Schedule([this]() { RunCompletedFuncs(); });
+    }
+    completed_funcs_.push_back(std::move(func));
+    if (--num_pending_host_callbacks_ == 0) host_callbacks_done_.notify_all();
+  });
+}
+
+void EventMgr::RunCompletedFuncs() {
+  std::vector<std::function<void()>> funcs;
+  {
+    mutex_lock l(mu_);
+    funcs.swap(completed_funcs_);
+  }
+  for (auto& func : funcs) func();
+}
+
 void EventMgr::QueueInUse(se::Stream* stream, InUse in_use) {
   VLOG(2) << "QueueInUse  free_events_ " << free_events_.size()
           << " used_events_ " << used_events_.size();
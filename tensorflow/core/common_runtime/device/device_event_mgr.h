@@ -71,6 +71,10 @@ class EventMgr {
   // func must be brief and non-blocking since it executes in the one
   // thread used for all such callbacks and also buffer deletions.
   inline void ThenExecute(se::Stream* stream, std::function<void()> func) {
+    if (use_host_callbacks_ && stream->ok()) {
+      ThenExecuteWithHostCallback(stream, std::move(func));
+      return;
+    }
     ToFreeVector to_free;
     {
       mutex_lock l(mu_);
@@ -86,6 +90,7 @@ class EventMgr {
   friend class EventMgrFactory;
   se::StreamExecutor* const exec_;
   const int32 polling_active_delay_usecs_;
+  const bool use_host_callbacks_;
   mutex mu_;
   condition_variable events_pending_ TF_GUARDED_BY(mu_);
 
@@ -128,6 +133,16 @@ class EventMgr {
   // straggler Events.
   void PollLoop();
 
+  // Enqueues a host callback on `stream` that hands `func` to the threadpool,
+  // since host callbacks must not call into the driver.
+  void ThenExecuteWithHostCallback(se::Stream* stream,
+                                   std::function<void()> func);
+
+  // Runs the funcs in `completed_funcs_`. Scheduled on the threadpool by the
+  // first host callback that finds the queue empty, so that the funcs of
+  // callbacks that complete together run in one batch.
+  void RunCompletedFuncs();
+
   // Setup/Teardown functions for the polling loop.
   void StartPollingLoop();
   void StopPollingLoop();
@@ -138,6 +153,12 @@ class EventMgr {
   // A FIFO queue of InUse events and associated tensors.
   std::deque<InUse> used_events_ TF_GUARDED_BY(mu_);
 
+  // The funcs whose host callbacks ran, and the number of host callbacks
+  // that have not run yet.
+  std::vector<std::function<void()>> completed_funcs_ TF_GUARDED_BY(mu_);
+  int64 num_pending_host_callbacks_ TF_GUARDED_BY(mu_) = 0;
+  condition_variable host_callbacks_done_;
+
   bool stop_polling_ TF_GUARDED_BY(mu_);
   std::unique_ptr<Notification> polling_stopped_;
 
@@ -138,6 +138,33 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+TEST(EventMgr, HostCallbacks) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  GPUOptions gpu_options;
+  gpu_options.mutable_experimental()->set_event_mgr_use_host_callbacks(true);
+  TEST_EventMgr em(stream_exec, gpu_options);
+  TEST_EventMgrHelper th(&em);
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  const int kNumFuncs = 100;
+  std::atomic<int> counter(0);
+  std::atomic<bool> in_callback_thread(true);
+  Notification note;
+  for (int i = 0; i < kNumFuncs; ++i) {
+    em.ThenExecute(stream.get(), [&counter, &in_callback_thread, &note]() {
+      bool hit = false;
+      device_event_mgr::WarnIfInCallback([&hit] { hit = true; });
+      if (!hit) in_callback_thread = false;
+      if (counter.fetch_add(1) + 1 == kNumFuncs) note.Notify();
+    });
+  }
+  // No events are polled in this mode.
+  EXPECT_EQ(0, th.queue_size());
+  note.WaitForNotification();
+  EXPECT_TRUE(in_callback_thread);
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
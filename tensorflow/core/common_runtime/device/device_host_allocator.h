@@ -16,13 +16,21 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_DEVICE_DEVICE_HOST_ALLOCATOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_DEVICE_DEVICE_HOST_ALLOCATOR_H_
 
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/stream_executor.h"
 
 namespace tensorflow {
 // Allocator for pinned CPU RAM that is made known to a StreamExecutor-based
 // device for the purpose of efficient DMA with the device.
+//
+// If the host has several NUMA nodes, the memory is allocated on `numa_node`,
+// which should be the node the device is attached to, and then registered
+// with the device. Otherwise the device allocates it, on the node of the
+// calling thread.
 class DeviceHostAllocator : public SubAllocator {
  public:
   // Note: stream_exec cannot be null.
@@ -31,7 +39,9 @@ class DeviceHostAllocator : public SubAllocator {
                                const std::vector<Visitor>& free_visitors)
       : SubAllocator(alloc_visitors, free_visitors),
         stream_exec_(stream_exec),
-        numa_node_(numa_node) {
+        numa_node_(numa_node),
+        bind_to_numa_node_(numa_node != port::kNUMANoAffinity &&
+                           port::NUMAEnabled() && port::NUMANumNodes() > 1) {
     CHECK(stream_exec_ != nullptr);
   }
   ~DeviceHostAllocator() override {}
@@ -41,7 +51,8 @@ class DeviceHostAllocator : public SubAllocator {
     void* ptr = nullptr;
     *bytes_received = num_bytes;
     if (num_bytes > 0) {
-      ptr = stream_exec_->HostMemoryAllocate(num_bytes);
+      if (bind_to_numa_node_) ptr = AllocOnNumaNode(alignment, num_bytes);
+      if (ptr == nullptr) ptr = stream_exec_->HostMemoryAllocate(num_bytes);
       if (ptr == nullptr) {
         LOG(WARNING) << "could not allocate pinned host memory of size: "
                      << num_bytes;
@@ -55,6 +66,16 @@ class DeviceHostAllocator : public SubAllocator {
   void Free(void* ptr, size_t num_bytes) override {
     if (ptr != nullptr) {
       VisitFree(ptr, numa_node_, num_bytes);
+      if (bind_to_numa_node_) {
+        mutex_lock l(mu_);
+        if (numa_allocations_.erase(ptr) > 0) {
+          if (!stream_exec_->HostMemoryUnregister(ptr)) {
+            LOG(WARNING) << "could not unregister pinned host memory";
+          }
+          port::NUMAFree(ptr, num_bytes);
+          return;
+        }
+      }
       stream_exec_->HostMemoryDeallocate(ptr);
     }
   }
@@ -66,8 +87,28 @@ class DeviceHostAllocator : public SubAllocator {
   }
 
  private:
+  // Returns memory on `numa_node_` that is registered with the device, or
+  // nullptr if it could not be allocated or registered.
+  void* AllocOnNumaNode(size_t alignment, size_t num_bytes) {
+    void* ptr = port::NUMAMalloc(numa_node_, num_bytes, alignment);
+    if (ptr == nullptr) return nullptr;
+    if (!stream_exec_->HostMemoryRegister(ptr, num_bytes)) {
+      LOG(WARNING) << "could not register host memory of size: " << num_bytes
+                   << " on NUMA node " << numa_node_;
+      port::NUMAFree(ptr, num_bytes);
+      return nullptr;
+    }
+    mutex_lock l(mu_);
+    numa_allocations_.insert(ptr);
+    return ptr;
+  }
+
   se::StreamExecutor* stream_exec_;  // not owned, non-null
   const int numa_node_;
+  const bool bind_to_numa_node_;
+  mutex mu_;
+  // The allocations made by AllocOnNumaNode().
+  absl::flat_hash_set<void*> numa_allocations_ TF_GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(DeviceHostAllocator);
 };
@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -69,10 +70,12 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/nccl/collective_communicator.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
@@ -144,6 +147,28 @@ thread::ThreadPool* GlobalThreadPool(const SessionOptions& options) {
   return thread_pool;
 }
 
+// Returns whether the session gets one inter op thread pool per NUMA node
+// instead of a single pool.
+bool UseNUMAThreadPools(const SessionOptions& options) {
+  return options.config.session_inter_op_thread_pool_size() == 0 &&
+         options.config.experimental().use_numa_affinity() &&
+         port::NUMAEnabled();
+}
+
+// Returns the process-wide inter op thread pools, one per NUMA node, whose
+// threads are pinned to their node.
+const std::vector<thread::ThreadPool*>& GlobalNUMAThreadPools(
+    const SessionOptions& options) {
+  static const std::vector<thread::ThreadPool*>* const thread_pools = [&] {
+    auto* pools = new std::vector<thread::ThreadPool*>;
+    for (int node = 0; node < port::NUMANumNodes(); ++node) {
+      pools->push_back(NewThreadPoolFromSessionOptions(options, node));
+    }
+    return pools;
+  }();
+  return *thread_pools;
+}
+
 // TODO(vrv): Figure out how to unify the many different functions
 // that generate RendezvousKey, since many of them have to be
 // consistent with each other.
@@ -335,10 +360,23 @@ DirectSession::DirectSession(const SessionOptions& options,
       thread_pools_.emplace_back(pool, owned);
     }
   } else if (options_.config.use_per_session_threads()) {
-    thread_pools_.emplace_back(NewThreadPoolFromSessionOptions(options_),
-                               true /* owned */);
+    if (UseNUMAThreadPools(options_)) {
+      for (int node = 0; node < port::NUMANumNodes(); ++node) {
+        thread_pools_.emplace_back(
+            NewThreadPoolFromSessionOptions(options_, node), true /* owned */);
+      }
+    } else {
+      thread_pools_.emplace_back(NewThreadPoolFromSessionOptions(options_),
+                                 true /* owned */);
+    }
   } else {
-    thread_pools_.emplace_back(GlobalThreadPool(options), false /* owned */);
+    if (UseNUMAThreadPools(options_)) {
+      for (thread::ThreadPool* pool : GlobalNUMAThreadPools(options_)) {
+        thread_pools_.emplace_back(pool, false /* owned */);
+      }
+    } else {
+      thread_pools_.emplace_back(GlobalThreadPool(options), false /* owned */);
+    }
     // Run locally if environment value of TF_NUM_INTEROP_THREADS is negative
     // and config.inter_op_parallelism_threads is unspecified or negative.
     static const int env_num_threads = NumInterOpThreadsFromEnvironment();
@@ -658,11 +696,21 @@ Status DirectSession::RunInternal(
   args.session_handle = session_handle_;
   args.tensor_store = &run_state.tensor_store;
   args.step_container = &run_state.step_container;
+  args.use_step_allocator =
+      options_.config.experimental().use_step_arena_allocator();
   args.sync_on_finish = sync_on_finish_;
   args.user_intra_op_threadpool = threadpool_options.intra_op_threadpool;
   args.run_all_kernels_inline = pool == nullptr;
   args.start_time_usecs = start_time_usecs;
   args.deadline = deadline;
+  args.low_priority_batching =
+      run_options.experimental().low_priority_batching();
+  args.memmap_restored_tensors =
+      run_options.experimental().memmap_restored_tensors();
+  StepResourceUsage resource_usage;
+  if (run_options.experimental().collect_resource_usage()) {
+    args.resource_usage = &resource_usage;
+  }
 
   const bool do_trace = (run_options.trace_level() > RunOptions::NO_TRACE);
 
@@ -784,6 +832,13 @@ Status DirectSession::RunInternal(
     run_state.collector->Finalize();
   }
 
+  if (args.resource_usage != nullptr && run_metadata != nullptr) {
+    RunMetadata::ResourceUsage* usage = run_metadata->mutable_resource_usage();
+    usage->set_num_ops(resource_usage.num_ops);
+    usage->set_op_cpu_time_micros(resource_usage.op_cpu_time_nanos / 1000);
+    usage->set_allocated_bytes(resource_usage.allocated_bytes);
+  }
+
   // Build and return the cost model as instructed.
   if (update_cost_model) {
     // Build the cost model
@@ -1009,6 +1064,8 @@ Status DirectSession::PRunSetup(const std::vector<string>& input_names,
   args.session_handle = session_handle_;
   args.tensor_store = &run_state->tensor_store;
   args.step_container = &run_state->step_container;
+  args.use_step_allocator =
+      options_.config.experimental().use_step_arena_allocator();
   if (LogMemory::IsEnabled()) {
     LogMemory::RecordStep(args.step_id, run_state_args.handle);
   }
@@ -1382,6 +1439,9 @@ Status DirectSession::CreateExecutors(
     LocalExecutorParams params;
     params.device = device;
     params.session_metadata = session_metadata;
+    params.enable_memory_planning =
+        options_.config.experimental().use_static_memory_plan() &&
+        device->device_type() == DEVICE_CPU;
     params.function_library = lib;
     auto opseg = device->op_segment();
     params.create_kernel =
@@ -1586,19 +1646,14 @@ Status DirectSession::GetOrCreateExecutors(
   return Status::OK();
 }
 
-Status DirectSession::CreateGraphs(
-    const BuildGraphOptions& subgraph_options,
-    std::unordered_map<string, std::unique_ptr<Graph>>* outputs,
-    std::unique_ptr<FunctionLibraryDefinition>* flib_def,
-    RunStateArgs* run_state_args, DataTypeVector* input_types,
-    DataTypeVector* output_types, int64_t* collective_graph_key) {
-  mutex_lock l(graph_state_lock_);
+Status DirectSession::BuildClientGraph(
+    const BuildGraphOptions& subgraph_options, RunStateArgs* run_state_args,
+    std::unique_ptr<ClientGraph>* client_graph,
+    std::unordered_map<string, string>* stateful_placements) {
   if (finalized_) {
     return errors::FailedPrecondition("Session has been finalized.");
   }
 
-  std::unique_ptr<ClientGraph> client_graph;
-
   std::unique_ptr<GraphExecutionState> temp_exec_state_holder;
   GraphExecutionState* execution_state = nullptr;
   if (options_.config.graph_options().place_pruned_graph()) {
@@ -1612,37 +1667,29 @@ Status DirectSession::CreateGraphs(
     prune_options.session_handle = session_handle_;
     TF_RETURN_IF_ERROR(GraphExecutionState::MakeForPrunedGraph(
         *execution_state_, prune_options, subgraph_options,
-        &temp_exec_state_holder, &client_graph));
+        &temp_exec_state_holder, client_graph));
     execution_state = temp_exec_state_holder.get();
   } else {
     execution_state = execution_state_.get();
     TF_RETURN_IF_ERROR(
-        execution_state->BuildGraph(subgraph_options, &client_graph));
+        execution_state->BuildGraph(subgraph_options, client_graph));
   }
-  *collective_graph_key = client_graph->collective_graph_key;
+  *stateful_placements = execution_state->GetStatefulPlacements();
 
-  if (subgraph_options.callable_options.feed_size() !=
-      client_graph->feed_types.size()) {
-    return errors::Internal(
-        "Graph pruning failed: requested number of feed endpoints = ",
-        subgraph_options.callable_options.feed_size(),
-        " versus number of pruned feed endpoints = ",
-        client_graph->feed_types.size());
-  }
-  if (subgraph_options.callable_options.fetch_size() !=
-      client_graph->fetch_types.size()) {
-    return errors::Internal(
-        "Graph pruning failed: requested number of fetch endpoints = ",
-        subgraph_options.callable_options.fetch_size(),
-        " versus number of pruned fetch endpoints = ",
-        client_graph->fetch_types.size());
+  // Remember the graph in run state if this is a partial run.
+  if (run_state_args->is_partial_run) {
+    run_state_args->graph.reset(new Graph(flib_def_.get()));
+    CopyGraph(*execution_state->full_graph(), run_state_args->graph.get());
   }
+  return Status::OK();
+}
 
-  auto current_stateful_placements = execution_state->GetStatefulPlacements();
+Status DirectSession::UpdateStatefulPlacements(
+    const std::unordered_map<string, string>& stateful_placements) {
   // Update our current state based on the execution_state's
   // placements.  If there are any mismatches for a node,
   // we should fail, as this should never happen.
-  for (const auto& placement_pair : current_stateful_placements) {
+  for (const auto& placement_pair : stateful_placements) {
     const string& node_name = placement_pair.first;
     const string& placement = placement_pair.second;
     auto iter = stateful_placements_.find(node_name);
@@ -1656,12 +1703,55 @@ Status DirectSession::CreateGraphs(
     }
   }
 
-  stateful_placements_ = execution_state->GetStatefulPlacements();
+  stateful_placements_ = stateful_placements;
+  return Status::OK();
+}
 
-  // Remember the graph in run state if this is a partial run.
-  if (run_state_args->is_partial_run) {
-    run_state_args->graph.reset(new Graph(flib_def_.get()));
-    CopyGraph(*execution_state->full_graph(), run_state_args->graph.get());
+Status DirectSession::CreateGraphs(
+    const BuildGraphOptions& subgraph_options,
+    std::unordered_map<string, std::unique_ptr<Graph>>* outputs,
+    std::unique_ptr<FunctionLibraryDefinition>* flib_def,
+    RunStateArgs* run_state_args, DataTypeVector* input_types,
+    DataTypeVector* output_types, int64_t* collective_graph_key) {
+  std::unique_ptr<ClientGraph> client_graph;
+  std::unordered_map<string, string> stateful_placements;
+  if (options_.config.graph_options().place_pruned_graph()) {
+    // The placement of a pruned graph depends on the stateful placements of
+    // the graphs placed before it, so these graphs are built one at a time.
+    mutex_lock l(graph_state_lock_);
+    TF_RETURN_IF_ERROR(BuildClientGraph(subgraph_options, run_state_args,
+                                        &client_graph, &stateful_placements));
+    TF_RETURN_IF_ERROR(UpdateStatefulPlacements(stateful_placements));
+  } else {
+    // The graph is pruned from the full graph, which was placed when it was
+    // created and is only read here. So the graphs of different signatures are
+    // built concurrently, and only the stateful placements are updated one at
+    // a time.
+    {
+      tf_shared_lock l(graph_state_lock_);
+      TF_RETURN_IF_ERROR(BuildClientGraph(subgraph_options, run_state_args,
+                                          &client_graph, &stateful_placements));
+    }
+    mutex_lock l(graph_state_lock_);
+    TF_RETURN_IF_ERROR(UpdateStatefulPlacements(stateful_placements));
+  }
+  *collective_graph_key = client_graph->collective_graph_key;
+
+  if (subgraph_options.callable_options.feed_size() !=
+      client_graph->feed_types.size()) {
+    return errors::Internal(
+        "Graph pruning failed: requested number of feed endpoints = ",
+        subgraph_options.callable_options.feed_size(),
+        " versus number of pruned feed endpoints = ",
+        client_graph->feed_types.size());
+  }
+  if (subgraph_options.callable_options.fetch_size() !=
+      client_graph->fetch_types.size()) {
+    return errors::Internal(
+        "Graph pruning failed: requested number of fetch endpoints = ",
+        subgraph_options.callable_options.fetch_size(),
+        " versus number of pruned fetch endpoints = ",
+        client_graph->fetch_types.size());
   }
 
   // Partition the graph across devices.
@@ -1783,6 +1873,8 @@ DirectSession::RunState::RunState(int64_t step_id,
           }
           ScopedAllocatorMgr* sam = d->GetScopedAllocatorMgr();
           if (sam) sam->Cleanup(step_id);
+          StepArenaAllocatorMgr* samgr = d->GetStepArenaAllocatorMgr();
+          if (samgr) samgr->Cleanup(step_id);
         }
       }) {}
 
@@ -1868,6 +1960,51 @@ Status DirectSession::MakeCallable(const CallableOptions& callable_options,
   return Status::OK();
 }
 
+Status DirectSession::PrewarmRunExecutors(
+    const std::vector<CallableOptions>& signatures) {
+  TF_RETURN_IF_ERROR(CheckNotClosed());
+  TF_RETURN_IF_ERROR(CheckGraphCreated("PrewarmRunExecutors()"));
+
+  auto prewarm = [this](const CallableOptions& signature) {
+    const RunOptions& run_options = signature.run_options();
+    std::vector<string> inputs(signature.feed().begin(),
+                               signature.feed().end());
+    std::vector<string> outputs(signature.fetch().begin(),
+                                signature.fetch().end());
+    std::vector<string> targets(signature.target().begin(),
+                                signature.target().end());
+    ExecutorsAndKeys* executors_and_keys;
+    RunStateArgs run_state_args(run_options.debug_options());
+    run_state_args.collective_graph_key =
+        run_options.experimental().collective_graph_key();
+    return GetOrCreateExecutors(inputs, outputs, targets, &executors_and_keys,
+                                &run_state_args);
+  };
+  if (signatures.size() <= 1 || thread_pools_.empty()) {
+    for (const CallableOptions& signature : signatures) {
+      TF_RETURN_IF_ERROR(prewarm(signature));
+    }
+    return Status::OK();
+  }
+
+  // The executors of different signatures are created concurrently, see
+  // CreateGraphs().
+  std::vector<Status> statuses(signatures.size());
+  BlockingCounter counter(signatures.size());
+  thread::ThreadPool* pool = thread_pools_[0].first;
+  for (size_t i = 0; i < signatures.size(); ++i) {
+    pool->Schedule([&, i]() {
+      statuses[i] = prewarm(signatures[i]);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  for (const Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return Status::OK();
+}
+
 class DirectSession::RunCallableCallFrame : public CallFrameInterface {
  public:
   RunCallableCallFrame(DirectSession* session,
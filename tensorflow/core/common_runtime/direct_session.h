@@ -133,6 +133,9 @@ class DirectSession : public Session {
 
   ::tensorflow::Status ReleaseCallable(CallableHandle handle) override;
 
+  ::tensorflow::Status PrewarmRunExecutors(
+      const std::vector<CallableOptions>& signatures) override;
+
   ::tensorflow::Status Finalize() override;
 
   const SessionOptions& options() const { return options_; }
@@ -253,6 +256,20 @@ class DirectSession : public Session {
       std::unique_ptr<FunctionInfo>* out_func_info,
       RunStateArgs* run_state_args);
 
+  // Prunes and optimizes the graph of `options` from the full graph, and
+  // returns the stateful placements of the graph it was placed in.
+  ::tensorflow::Status BuildClientGraph(
+      const BuildGraphOptions& options, RunStateArgs* run_state_args,
+      std::unique_ptr<ClientGraph>* client_graph,
+      std::unordered_map<string, string>* stateful_placements)
+      TF_SHARED_LOCKS_REQUIRED(graph_state_lock_);
+
+  // Merges the `stateful_placements` of a newly built graph into
+  // `stateful_placements_`, and fails if they disagree.
+  ::tensorflow::Status UpdateStatefulPlacements(
+      const std::unordered_map<string, string>& stateful_placements)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(graph_state_lock_);
+
   // Creates several graphs given the existing graph_def_ and the
   // input feeds and fetches, given 'devices'. The graphs share a common
   // function library 'flib_def'.
@@ -44,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/test.h"
@@ -229,6 +230,48 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_OptimizeForStaticGraph) {
       absl::StrContains(s.error_message(), "optimize_for_static_graph"));
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_StepArenaAllocator) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options(DefaultSessionOptions());
+  options.config.mutable_experimental()->set_use_step_arena_allocator(true);
+  auto session = absl::WrapUnique(NewSession(options));
+
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  std::vector<std::pair<string, Tensor>> inputs;
+  std::vector<string> output_names = {y_ + ":0"};
+  std::vector<string> target_nodes = {y_neg_};
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run(inputs, output_names, target_nodes, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    auto mat = outputs[0].matrix<float>();
+    EXPECT_FLOAT_EQ(5.0, mat(0, 0));
+  }
+}
+
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_StaticMemoryPlan) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options(DefaultSessionOptions());
+  options.config.mutable_experimental()->set_use_static_memory_plan(true);
+  auto session = absl::WrapUnique(NewSession(options));
+
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  std::vector<std::pair<string, Tensor>> inputs;
+  std::vector<string> output_names = {y_ + ":0"};
+  std::vector<string> target_nodes = {y_neg_};
+  // The first step records the output sizes, and later steps are served from
+  // the plan.
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run(inputs, output_names, target_nodes, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    auto mat = outputs[0].matrix<float>();
+    EXPECT_FLOAT_EQ(5.0, mat(0, 0));
+  }
+}
+
 TEST_F(DirectSessionMinusAXTest,
        RunSimpleNetwork_DisableOutputPartitionGraphs) {
   Initialize({3, 2, -1, 0});
@@ -337,6 +380,45 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_FinalizeWithRun) {
       absl::StrContains(s.error_message(), "Session has been finalized."));
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_FinalizeWithPrewarm) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  std::vector<CallableOptions> signatures(2);
+  signatures[0].add_fetch(y_ + ":0");
+  signatures[0].add_target(y_neg_);
+  signatures[1].add_fetch(z_ + ":0");
+  TF_ASSERT_OK(session->PrewarmRunExecutors(signatures));
+
+  // The prewarmed subgraphs still run after finalization.
+  TF_ASSERT_OK(session->Finalize());
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {y_neg_}, &outputs));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+  TF_ASSERT_OK(session->Run({}, {z_ + ":0"}, {}, &outputs));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(-5.0, outputs[0].matrix<float>()(0, 0));
+
+  // Running a subgraph that was not prewarmed fails.
+  Status s = session->Run({}, {y_ + ":0"}, {}, &outputs);
+  EXPECT_TRUE(errors::IsFailedPrecondition(s));
+}
+
+TEST_F(DirectSessionMinusAXTest, PrewarmInvalidSignature) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  std::vector<CallableOptions> signatures(2);
+  signatures[0].add_fetch(y_ + ":0");
+  signatures[1].add_fetch("missing:0");
+  EXPECT_FALSE(session->PrewarmRunExecutors(signatures).ok());
+}
+
 TEST_F(DirectSessionMinusAXTest, TestTensorConnection) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
@@ -773,6 +855,41 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithOpts_Callable) {
   EXPECT_EQ(run_metadata.step_stats().dev_stats_size(), 2);
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithResourceUsage) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  std::vector<std::pair<string, Tensor>> inputs;
+
+  std::vector<string> output_names = {y_ + ":0"};
+  std::vector<string> target_nodes = {y_neg_};
+  std::vector<Tensor> outputs;
+
+  RunOptions run_options;
+  run_options.mutable_experimental()->set_collect_resource_usage(true);
+  RunMetadata run_metadata;
+  TF_ASSERT_OK(session->Run(run_options, inputs, output_names, target_nodes,
+                            &outputs, &run_metadata));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+
+  // The MatMul allocates at least its 2x1 float output.
+  ASSERT_TRUE(run_metadata.has_resource_usage());
+  EXPECT_GT(run_metadata.resource_usage().num_ops(), 0);
+  EXPECT_GE(run_metadata.resource_usage().allocated_bytes(),
+            static_cast<int64_t>(2 * sizeof(float)));
+  EXPECT_GE(run_metadata.resource_usage().op_cpu_time_micros(), 0);
+  // Tracing is not turned on.
+  EXPECT_EQ(run_metadata.step_stats().dev_stats_size(), 0);
+
+  // Without the option, nothing is collected.
+  run_metadata.Clear();
+  TF_ASSERT_OK(session->Run(RunOptions(), inputs, output_names, target_nodes,
+                            &outputs, &run_metadata));
+  EXPECT_FALSE(run_metadata.has_resource_usage());
+}
+
 TEST_F(DirectSessionMinusAXTest, UseRunHandlerPool) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
@@ -2153,6 +2270,49 @@ TEST(DirectSessionTest, TestSessionInterOpThreadsInvalidOptions) {
   }
 }
 
+TEST(DirectSessionTest, TestNUMAAffinityInterOpThreadPools) {
+  Graph g(OpRegistry::Global());
+  Tensor t(DT_FLOAT, TensorShape({}));
+  t.scalar<float>()() = {1.2f};
+  Node* x = test::graph::Constant(&g, t);
+  GraphDef def;
+  g.ToGraphDef(&def);
+
+  SessionOptions options;
+  options.config.mutable_experimental()->set_use_numa_affinity(true);
+  (*options.config.mutable_device_count())["GPU"] = 0;
+  const int num_numa_nodes = port::NUMANumNodes();
+  for (bool use_per_session_threads : {false, true}) {
+    options.config.set_use_per_session_threads(use_per_session_threads);
+    std::unique_ptr<Session> session(NewSession(options));
+    TF_ASSERT_OK(session->Create(def));
+
+    // There is one CPU device per NUMA node.
+    std::vector<DeviceAttributes> devices;
+    TF_ASSERT_OK(session->ListDevices(&devices));
+    int num_cpu_devices = 0;
+    for (const DeviceAttributes& d : devices) {
+      if (d.device_type() == "CPU") ++num_cpu_devices;
+    }
+    EXPECT_EQ(num_cpu_devices, num_numa_nodes);
+
+    // Each NUMA node has an inter-op thread pool.
+    for (int pool_num = 0; pool_num <= num_numa_nodes; ++pool_num) {
+      RunOptions run_options;
+      run_options.set_inter_op_thread_pool(pool_num);
+      std::vector<Tensor> outputs;
+      Status s = session->Run(run_options, {} /* inputs */,
+                              {x->name() + ":0"} /* output_names */, {},
+                              &outputs, nullptr /* run_metadata */);
+      if (pool_num < num_numa_nodes) {
+        TF_EXPECT_OK(s);
+      } else {
+        EXPECT_EQ(s.code(), error::INVALID_ARGUMENT);
+      }
+    }
+  }
+}
+
 TEST(DirectSessionTest, TestDirectSessionRunClose) {
   // Construct a graph with a variable and a single assign.
   Graph g(OpRegistry::Global());
@@ -486,6 +486,7 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
   mutex_lock ml(cache_mu_);
   default_executor_.WaitForAllPendingNodes().IgnoreError();
   kernel_cache_.clear();
+  kernel_cache_generation_.fetch_add(1, std::memory_order_release);
   for (auto& entry : registered_functions_) {
     entry.second->cached_kernel_keys->clear();
   }
@@ -987,6 +988,7 @@ Status EagerContext::RemoveFunction(const string& func) {
     for (auto& key : *registered_function->cached_kernel_keys) {
       kernel_cache_.erase(key);
     }
+    kernel_cache_generation_.fetch_add(1, std::memory_order_release);
     registered_functions_.erase(func);
   }
   registered_function->Unref();
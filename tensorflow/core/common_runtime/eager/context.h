@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_CONTEXT_H_
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <map>
 #include <memory>
@@ -263,6 +264,14 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   void AddKernelToCache(Fprint128 cache_key, KernelAndDevice* kernel);
 
+  // Returns a counter that is incremented whenever kernels are removed from
+  // the kernel cache. Caches of kernels found in the kernel cache (see
+  // EagerOperation::GetCachedKernel) record it to detect when their entries
+  // become stale.
+  int64_t kernel_cache_generation() const {
+    return kernel_cache_generation_.load(std::memory_order_acquire);
+  }
+
   bool LogDevicePlacement() const { return log_device_placement_; }
   void SetLogDevicePlacement(bool enable) override {
     log_device_placement_ = enable;
@@ -716,6 +725,7 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
       kernel_cache_ TF_GUARDED_BY(cache_mu_);
   std::unordered_map<string, RegisteredFunction*> registered_functions_
       TF_GUARDED_BY(cache_mu_);
+  std::atomic<int64_t> kernel_cache_generation_{0};
 
   // Whether we should compute RunMetadata.
   std::atomic<bool> should_store_graphs_{false};
@@ -315,22 +315,34 @@ Status EagerOperation::Reset(
     const absl::optional<EagerFunctionParams> eager_func_params) {
   DCHECK(inputs_.empty());
   ClearInferenceState();
-  bool is_function = false;
-  TF_RETURN_IF_ERROR(AttrTypeMapForOp(op, &attr_types_, &is_function));
-
-  // Don't update the device of direct function calls.
-  // Particularly, if the user did not explicitly request any device for this
-  // function, picking a device would result in this device being the default
-  // for nodes inside the function. This is undesirable for multi-device
-  // functions since the not-explicitly-placed nodes inside the body will all
-  // end up on this default device.
-  colocation_exempt_ = is_function;
-  if (!is_function) {
-    const auto& exempt_ops = InputColocationExemptionRegistry::Global()->Get();
-    colocation_exempt_ = exempt_ops.find(op) != exempt_ops.end();
-
-    TF_RETURN_IF_ERROR(OpDefForOp(op, &op_def_));
-  } else if (!remote && !ctx_.FindFunctionByName(op)) {
+  // The registry lookups below only depend on the op name, so they are skipped
+  // when the op is reset to the op it already is (e.g. by the Python fast path,
+  // which reuses one operation per thread).
+  const AttrTypeMap* attr_types = attr_types_;
+  const tensorflow::OpDef* op_def = registered_op_def_;
+  bool is_function = is_function_;
+  bool colocation_exempt = colocation_exempt_;
+  if (attr_types == nullptr || attrs_.op_name() != op) {
+    op_def = nullptr;
+    is_function = false;
+    TF_RETURN_IF_ERROR(AttrTypeMapForOp(op, &attr_types, &is_function));
+
+    // Don't update the device of direct function calls.
+    // Particularly, if the user did not explicitly request any device for this
+    // function, picking a device would result in this device being the default
+    // for nodes inside the function. This is undesirable for multi-device
+    // functions since the not-explicitly-placed nodes inside the body will all
+    // end up on this default device.
+    colocation_exempt = is_function;
+    if (!is_function) {
+      const auto& exempt_ops =
+          InputColocationExemptionRegistry::Global()->Get();
+      colocation_exempt = exempt_ops.find(op) != exempt_ops.end();
+
+      TF_RETURN_IF_ERROR(OpDefForOp(op, &op_def));
+    }
+  }
+  if (is_function && !remote && !ctx_.FindFunctionByName(op)) {
     return errors::NotFound(
         "'", op,
         "' is neither a type of a primitive operation nor a name "
@@ -339,6 +351,10 @@ Status EagerOperation::Reset(
         ". Make sure the operation or function is "
         "registered in the binary running in this process.");
   }
+  attr_types_ = attr_types;
+  registered_op_def_ = op_def;
+  op_def_ = op_def;
+  colocation_exempt_ = colocation_exempt;
   attrs_.Reset(op);
   stack_trace_.reset();
   is_function_ = is_function;
@@ -508,6 +524,26 @@ string EagerOperation::DebugString() const {
   return out;
 }
 
+core::RefCountPtr<KernelAndDevice> EagerOperation::GetCachedKernel(
+    const Fprint128& cache_key) const {
+  const CachedKernel& entry =
+      cached_kernels_[cache_key.low64 % kNumCachedKernels];
+  if (!(entry.cache_key == cache_key) ||
+      entry.generation != ctx_.kernel_cache_generation()) {
+    return nullptr;
+  }
+  return entry.kernel.GetNewRef();
+}
+
+void EagerOperation::SetCachedKernel(const Fprint128& cache_key,
+                                     int64_t generation,
+                                     KernelAndDevice* kernel) {
+  CachedKernel& entry = cached_kernels_[cache_key.low64 % kNumCachedKernels];
+  entry.cache_key = cache_key;
+  entry.generation = generation;
+  entry.kernel = core::WeakPtr<KernelAndDevice>(kernel);
+}
+
 void EagerOperation::AddTensorHandle(ImmediateExecutionTensorHandle* h) {
   h->Ref();
   inputs_.push_back(h);
@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_EAGER_OPERATION_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_EAGER_OPERATION_H_
 
+#include <array>
+
 #include "absl/container/inlined_vector.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
@@ -29,6 +31,8 @@ limitations under the License.
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/managed_stack_trace.h"
 
@@ -215,6 +219,20 @@ class EagerOperation : public ImmediateExecutionOperation {
   // Op name recorded for memory debugging purpose.
   const char* op_name() const { return op_name_; }
 
+  // Returns the kernel that an earlier execution of this op found in, or added
+  // to, the context's kernel cache under `cache_key`, or nullptr if there is
+  // none or the kernel cache has changed since. This lets repeated executions
+  // of an op, including ones that reset it to the same op each time, skip the
+  // lookup in the context's kernel cache.
+  core::RefCountPtr<KernelAndDevice> GetCachedKernel(
+      const Fprint128& cache_key) const;
+
+  // Records that `kernel` was found in, or added to, the context's kernel cache
+  // under `cache_key` when `ctx.kernel_cache_generation()` was `generation`.
+  // Does not take a reference on `kernel`.
+  void SetCachedKernel(const Fprint128& cache_key, int64_t generation,
+                       KernelAndDevice* kernel);
+
   // For LLVM style RTTI.
   static bool classof(const AbstractOperation* ptr) {
     return ptr->getKind() == kEager;
@@ -242,7 +260,10 @@ class EagerOperation : public ImmediateExecutionOperation {
   tensorflow::EagerContext& ctx_;
   const char* op_name_ = nullptr;
   AttrBuilder attrs_;
-  const AttrTypeMap* attr_types_;
+  const AttrTypeMap* attr_types_ = nullptr;
+  // The OpDef found by the last call to Reset, or nullptr for functions.
+  // Resetting the op to the same op again reuses it and `attr_types_`.
+  const tensorflow::OpDef* registered_op_def_ = nullptr;
 
   // The number of custom device TensorHandle inputs. These inputs need to be
   // processed by CustomDeviceOpHandler first.
@@ -272,7 +293,7 @@ class EagerOperation : public ImmediateExecutionOperation {
 
   absl::optional<ManagedStackTrace> stack_trace_;
   bool is_function_;  // Conceptually const, but can't be because of Reset
-  bool colocation_exempt_;
+  bool colocation_exempt_ = false;
   CancellationManager* cancellation_manager_ = nullptr;  // Not owned.
   EagerExecutor* executor_;                              // Not owned.
 
@@ -283,6 +304,17 @@ class EagerOperation : public ImmediateExecutionOperation {
   int inference_arg_idx_;  // arg definition index for the next input to be
                            // added
   gtl::FlatSet<std::string> inference_attrs_;  // attributes inferred so far
+
+  // A small direct-mapped cache of the kernels this op has run with, indexed
+  // by their kernel cache key. Entries are weak references, so they never
+  // outlive the context's kernel cache entries.
+  struct CachedKernel {
+    Fprint128 cache_key = {0, 0};
+    int64_t generation = -1;
+    core::WeakPtr<KernelAndDevice> kernel{nullptr};
+  };
+  static constexpr int kNumCachedKernels = 8;
+  std::array<CachedKernel, kNumCachedKernels> cached_kernels_;
 };
 
 inline void EagerOperation::UpdateInput(int i, TensorHandle* h) {
@@ -77,5 +77,74 @@ TEST(EagerOperationTest, EagerFunctionParamsAndStepId) {
   ctx->Unref();
 }
 
+TEST(EagerOperationTest, ResetToSameOpKeepsOpDef) {
+  StaticDeviceMgr device_mgr(DeviceFactory::NewDevice(
+      "CPU", {}, "/job:localhost/replica:0/task:0/device:CPU:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_SILENT, false,
+      &device_mgr, false, nullptr, nullptr);
+
+  auto op = new EagerOperation(ctx);
+  TF_ASSERT_OK(op->Reset("Identity", nullptr));
+  const OpDef* op_def = op->OpDef();
+  ASSERT_NE(op_def, nullptr);
+  EXPECT_EQ("Identity", op_def->name());
+
+  op->Clear();
+  TF_ASSERT_OK(op->Reset("Identity", nullptr));
+  EXPECT_EQ(op_def, op->OpDef());
+  EXPECT_FALSE(op->is_function());
+
+  op->Clear();
+  TF_ASSERT_OK(op->Reset("Neg", nullptr));
+  ASSERT_NE(op->OpDef(), nullptr);
+  EXPECT_EQ("Neg", op->OpDef()->name());
+
+  // A failed reset leaves the op as it was.
+  op->Clear();
+  EXPECT_FALSE(op->Reset("NotARegisteredFunction", nullptr).ok());
+  TF_ASSERT_OK(op->Reset("Neg", nullptr));
+  EXPECT_EQ("Neg", op->OpDef()->name());
+
+  delete op;
+  ctx->Unref();
+}
+
+TEST(EagerOperationTest, CachedKernel) {
+  StaticDeviceMgr device_mgr(DeviceFactory::NewDevice(
+      "CPU", {}, "/job:localhost/replica:0/task:0/device:CPU:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_SILENT, false,
+      &device_mgr, false, nullptr, nullptr);
+
+  auto op = new EagerOperation(ctx);
+  const Fprint128 key = Fingerprint128("key");
+  const Fprint128 other_key = Fingerprint128("other_key");
+  EXPECT_EQ(op->GetCachedKernel(key), nullptr);
+
+  core::RefCountPtr<KernelAndDevice> kernel(
+      new KernelAndDeviceOp(nullptr, false, nullptr, nullptr, nullptr,
+                            ctx->HostCPU()));
+  ctx->AddKernelToCache(key, kernel.get());
+  op->SetCachedKernel(key, ctx->kernel_cache_generation(), kernel.get());
+  EXPECT_EQ(op->GetCachedKernel(key).get(), kernel.get());
+  EXPECT_EQ(op->GetCachedKernel(other_key), nullptr);
+
+  // Clearing the kernel cache invalidates the op's cache, even though the
+  // kernel is still alive.
+  ctx->ClearCachesAndThreadExecutors();
+  EXPECT_EQ(op->GetCachedKernel(key), nullptr);
+
+  // The op's cache does not keep the kernel alive.
+  op->SetCachedKernel(key, ctx->kernel_cache_generation(), kernel.get());
+  kernel.reset();
+  EXPECT_EQ(op->GetCachedKernel(key), nullptr);
+
+  delete op;
+  ctx->Unref();
+}
+
 }  // namespace
 }  // namespace tensorflow
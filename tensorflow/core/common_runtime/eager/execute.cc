@@ -63,6 +63,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 #if !defined(IS_MOBILE_PLATFORM)
 #include "tensorflow/core/distributed_runtime/eager/eager_client.h"
 #include "tensorflow/core/distributed_runtime/eager/remote_copy_node.h"
@@ -952,7 +953,17 @@ Status GetOrCreateKernelAndDevice(
       GetKernelCacheKey(*op, op->MutableAttrs()->CacheKey(op->DeviceName()),
                         input_dev_ptrs,
                         input_resource_variable_dtypes_and_shapes));
-  core::RefCountPtr<KernelAndDevice> kernel = ctx.GetCachedKernel(cache_key);
+  // Repeated executions of an op first look in the op's own cache of kernels,
+  // which avoids taking the lock of the context's kernel cache.
+  core::RefCountPtr<KernelAndDevice> kernel = op->GetCachedKernel(cache_key);
+  const int64_t kernel_cache_generation = ctx.kernel_cache_generation();
+  if (kernel == nullptr) {
+    kernel = ctx.GetCachedKernel(cache_key);
+    if (kernel != nullptr) {
+      op->SetCachedKernel(cache_key, kernel_cache_generation, kernel.get());
+    }
+  }
+  EagerOperation* const original_op = op;
   AbstractOperationPtr wrapped_op_releaser;
   // We can eliminate some overhead by running simple functions using regular
   // CallOp kernel. However, it is tricky to figure out which functions should
@@ -1120,9 +1131,8 @@ Status GetOrCreateKernelAndDevice(
     TF_RETURN_IF_ERROR(
         kernel->Init(ctx.LogDevicePlacement(), ndef, graph_collector));
 
-    if (op->is_function()) {
-      ctx.AddKernelToCache(cache_key, kernel.get());
-    } else {
+    bool cache_kernel = true;
+    if (!op->is_function()) {
       // Exclude tf.data op kernels from being cached. The reason for this is
       // that tf.data op kernels that accept a user-defined function will have a
       // unique cache key every time they are executed (because the user-defined
@@ -1131,9 +1141,12 @@ Status GetOrCreateKernelAndDevice(
       // programs that build input pipeline graphs in a loop.
       const OpDef* op_def;
       TF_RETURN_IF_ERROR(OpDefForOp(op->Name().data(), &op_def));
-      if (KernelCacheEnabled(*op_def)) {
-        ctx.AddKernelToCache(cache_key, kernel.get());
-      }
+      cache_kernel = KernelCacheEnabled(*op_def);
+    }
+    if (cache_kernel) {
+      ctx.AddKernelToCache(cache_key, kernel.get());
+      original_op->SetCachedKernel(cache_key, kernel_cache_generation,
+                                   kernel.get());
     }
   }
 
@@ -1372,21 +1385,41 @@ Status MaybePackInputTensor(EagerOperation* op) {
 }
 
 #if !defined(IS_MOBILE_PLATFORM)
+// Whether remote ops whose definition a worker already has are sent by the id
+// of the definition rather than by name, attrs and device.
+bool SendRemoteOpDefinitionIds() {
+  static const bool send_definition_ids = [] {
+    bool value;
+    TF_CHECK_OK(tensorflow::ReadBoolFromEnvVar(
+        "TF_EAGER_REMOTE_OP_DEFINITION_IDS", true, &value));
+    return value;
+  }();
+  return send_definition_ids;
+}
+
 void PrepareRemoteOp(eager::Operation* remote_op, EagerOperation* op) {
   EagerContext& ctx = op->EagerContext();
 
   remote_op->set_id(ctx.RemoteMgr()->NextOpId());
+  const string& device_name = absl::get<Device*>(op->Device())->name();
+  if (SendRemoteOpDefinitionIds()) {
+    bool registered = false;
+    remote_op->set_definition_id(ctx.RemoteMgr()->GetOperationDefinitionId(
+        op->MutableAttrs()->CacheKey(device_name), ctx.GetContextViewId(),
+        &registered));
+    if (registered) return;
+  }
   remote_op->set_name(op->Name());
 
   op->Attrs().FillAttrValueMapWithoutDefaults(remote_op->mutable_attrs());
-  remote_op->set_device(absl::get<Device*>(op->Device())->name());
+  remote_op->set_device(device_name);
   remote_op->set_is_function(op->is_function());
 }
 
-Status StoreResourceDtypesAndShapes(const eager::Operation& remote_op,
+Status StoreResourceDtypesAndShapes(const EagerOperation& op,
                                     const DataTypeVector& output_dtypes,
                                     TensorHandle** retvals) {
-  if (remote_op.name() == "VarHandleOp") {
+  if (op.Name() == "VarHandleOp") {
     if (output_dtypes.size() != 1) {
       return errors::Internal("VarHandleOp should only have one output.");
     }
@@ -1394,7 +1427,9 @@ Status StoreResourceDtypesAndShapes(const eager::Operation& remote_op,
       return errors::Internal(
           "The output of VarHandleOp should be a DT_RESOURCE.");
     }
-    AttrSlice attr_slice = AttrSlice(&remote_op.attrs());
+    AttrValueMap attrs;
+    op.Attrs().FillAttrValueMapWithoutDefaults(&attrs);
+    AttrSlice attr_slice = AttrSlice(&attrs);
     const AttrValue* dtype;
     TF_RETURN_IF_ERROR(attr_slice.Find("dtype", &dtype));
     const AttrValue* shape;
@@ -1534,7 +1569,7 @@ Status EagerRemoteExecute(EagerOperation* op, TensorHandle** retvals,
   // shape on eager master and sent them to the default function device along
   // with the EnqueueRequest.
   TF_RETURN_IF_ERROR(
-      StoreResourceDtypesAndShapes(*remote_op, output_dtypes, retvals));
+      StoreResourceDtypesAndShapes(*op, output_dtypes, retvals));
 
   auto& executor = op->Executor();
   VLOG(4) << "Execute remote eager op: " << op->Name()
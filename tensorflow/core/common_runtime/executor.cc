@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/executor.h"
 
+#include <time.h>
+
 #include <atomic>
 #include <memory>
 #include <vector>
@@ -27,11 +29,14 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
+#include "tensorflow/core/common_runtime/memory_plan.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/common_runtime/static_schedule_propagator_state.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/common_runtime/work_stealing_ready_queue.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
@@ -58,6 +63,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -70,6 +76,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/annotated_traceme.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
+#include "tensorflow/core/profiler/lib/scoped_memory_debug_annotation.h"
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
@@ -125,6 +132,19 @@ void SetMemory(NodeExecStatsInterface* stats, OpKernelContext* ctx) {
 
 }  // namespace nodestats
 
+// Returns the CPU time consumed by the calling thread, in nanoseconds, or 0 if
+// the platform has no per-thread CPU clock.
+int64_t ThreadCpuTimeNanos() {
+#if defined(__linux__) || defined(__APPLE__)
+  timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+    return static_cast<int64_t>(ts.tv_sec) * EnvTime::kSecondsToNanos +
+           ts.tv_nsec;
+  }
+#endif
+  return 0;
+}
+
 // Time the execution of kernels (in CPU cycles).  Used to dynamically identify
 // inexpensive kernels which can be dispatched inline.
 struct KernelTimer {
@@ -139,13 +159,53 @@ struct KernelTimer {
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
+// Selects the optional scheduling strategies of `ExecutorImpl`.
+struct ExecutorImplOptions {
+  // If true, expensive ready nodes are dispatched through per-worker
+  // work-stealing deques instead of one closure per node (see
+  // WorkStealingReadyQueue).
+  bool use_work_stealing = false;
+
+  // If true, and the graph does not require control flow support, a static
+  // schedule is computed once at construction and replayed on every run (see
+  // ImmutableExecutorState::StaticSchedule).
+  bool use_static_schedule = false;
+};
+
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        const ExecutorImplOptions& options = {})
+      : immutable_state_(p), options_(options) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
     kernel_stats_.Initialize(immutable_state_.graph_view());
+    if (options_.use_static_schedule) {
+      if (immutable_state_.requires_control_flow_support()) {
+        VLOG(1) << "Not using a static schedule for a graph that requires "
+                   "control flow support.";
+      } else {
+        TF_RETURN_IF_ERROR(
+            immutable_state_.BuildStaticSchedule(port::MaxParallelism()));
+      }
+    }
+    if (immutable_state_.params().enable_memory_planning) {
+      if (immutable_state_.requires_control_flow_support()) {
+        VLOG(1) << "Not using a memory plan for a graph that requires control "
+                   "flow support.";
+      } else if (immutable_state_.has_node_device_contexts()) {
+        // The plan reuses buffers in the order of a single stream.
+        VLOG(1) << "Not using a memory plan for a graph whose nodes run with "
+                   "different device contexts.";
+      } else {
+        TF_RETURN_IF_ERROR(MemoryPlan::Create(
+            immutable_state_,
+            immutable_state_.params().device->GetAllocator(
+                AllocatorAttributes()),
+            &memory_plan_));
+      }
+    }
     return Status::OK();
   }
 
@@ -220,6 +280,11 @@ class ExecutorImpl : public Executor {
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
 
+  const ExecutorImplOptions options_;
+
+  // Set if `LocalExecutorParams::enable_memory_planning` is true.
+  core::RefCountPtr<MemoryPlan> memory_plan_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ExecutorImpl);
 };
 
@@ -277,7 +342,9 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                bool use_work_stealing = false,
+                MemoryPlan* memory_plan = nullptr);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -335,6 +402,12 @@ class ExecutorState {
   template <typename Closure>
   void RunTask(Closure&& c);
 
+  // Work-stealing dispatch. Pushes `tagged_node` onto the calling thread's
+  // deque in `work_queue_`.
+  void PushToWorkQueue(const TaggedNode& tagged_node, int64_t scheduled_nsec);
+  // Starts up to `max_new_workers` closures that drain `work_queue_`.
+  void MaybeStartWorkers(int max_new_workers);
+
   // Clean up when this executor is done.
   void Finish();
   void ScheduleFinish();
@@ -352,6 +425,9 @@ class ExecutorState {
   int64_t start_time_usecs_ = 0;
   // The deadline for the session to complete by. Empty if unspecified.
   absl::optional<absl::Time> deadline_;
+  const bool low_priority_batching_;
+  const bool memmap_restored_tensors_;
+  StepResourceUsage* const resource_usage_;  // Not owned.
 
   // Not owned.
   RendezvousInterface* rendezvous_;
@@ -380,6 +456,16 @@ class ExecutorState {
   Executor::Args::Runner runner_;
   bool sync_on_finish_;
   const bool run_all_kernels_inline_;
+  const bool use_step_allocator_;
+  MemoryPlan* const memory_plan_;  // Not owned.
+
+  struct StealableNode {
+    TaggedNode node;
+    int64_t scheduled_nsec;
+  };
+  // Only set in work-stealing mode. Shared with the worker closures, which may
+  // still be unwinding after this ExecutorState has been deleted.
+  std::shared_ptr<WorkStealingReadyQueue<StealableNode>> work_queue_;
 
   PropagatorStateType propagator_;
 
@@ -401,12 +487,16 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, bool use_work_stealing,
+    MemoryPlan* memory_plan)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
       start_time_usecs_(args.start_time_usecs),
       deadline_(args.deadline),
+      low_priority_batching_(args.low_priority_batching),
+      memmap_restored_tensors_(args.memmap_restored_tensors),
+      resource_usage_(args.resource_usage),
       rendezvous_(args.rendezvous),
       collective_executor_(args.collective_executor),
       session_state_(args.session_state),
@@ -428,6 +518,8 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       runner_(args.runner),
       sync_on_finish_(args.sync_on_finish),
       run_all_kernels_inline_(args.run_all_kernels_inline),
+      use_step_allocator_(args.use_step_allocator),
+      memory_plan_(memory_plan),
       propagator_(immutable_state, step_id_, vlog_),
       num_outstanding_ops_(0) {
   if (args.user_intra_op_threadpool != nullptr) {
@@ -435,6 +527,10 @@ ExecutorState<PropagatorStateType>::ExecutorState(
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  if (use_work_stealing && !run_all_kernels_inline_) {
+    work_queue_ = std::make_shared<WorkStealingReadyQueue<StealableNode>>(
+        port::MaxParallelism());
+  }
 }
 
 template <class PropagatorStateType>
@@ -469,6 +565,29 @@ void ExecutorState<PropagatorStateType>::RunTask(Closure&& c) {
   });
 }
 
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::PushToWorkQueue(
+    const TaggedNode& tagged_node, int64_t scheduled_nsec) {
+  work_queue_->Push(StealableNode{tagged_node, scheduled_nsec});
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::MaybeStartWorkers(
+    int max_new_workers) {
+  for (int i = 0; i < max_new_workers && work_queue_->TryStartWorker(); ++i) {
+    // The closure only dereferences `this` after popping a node. Since the
+    // node keeps `num_outstanding_ops_` above zero, the ExecutorState is still
+    // alive at that point; once the queue is drained only `queue` is touched.
+    RunTask([this, queue = work_queue_]() {
+      do {
+        while (absl::optional<StealableNode> item = queue->Pop()) {
+          Process(item->node, item->scheduled_nsec);
+        }
+      } while (queue->StopWorker());
+    });
+  }
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::RunAsync(Executor::DoneCallback done) {
   TaggedNodeSeq ready;
@@ -571,6 +690,12 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   OpKernel* op_kernel = item.kernel;
   Device* device = immutable_state_.params().device;
   const bool is_expensive = kernel_stats_->IsExpensive(item);
+  const int64_t cpu_start_nanos =
+      resource_usage_ != nullptr ? ThreadCpuTimeNanos() : 0;
+  // Attributes the allocations the kernel makes without allocate_output() or
+  // allocate_temp(), e.g. through the device allocator, to the node.
+  profiler::ScopedMemoryDebugAnnotation op_annotation(
+      op_kernel->name_view().data(), step_id_);
 
   if (TF_PREDICT_FALSE(MightTrace(event_collector_, is_expensive))) {
     tracing::ScopedRegion region(tracing::EventCategory::kCompute,
@@ -596,6 +721,11 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   } else {
     device->Compute(op_kernel, &ctx);
   }
+  if (resource_usage_ != nullptr) {
+    resource_usage_->num_ops.fetch_add(1, std::memory_order_relaxed);
+    resource_usage_->op_cpu_time_nanos.fetch_add(
+        ThreadCpuTimeNanos() - cpu_start_nanos, std::memory_order_relaxed);
+  }
   nodestats::SetOpEnd(stats);
   if (outputs->size() < item.num_outputs) outputs->resize(item.num_outputs);
   s = ProcessOutputs(item, &ctx, outputs->data(), stats);
@@ -619,6 +749,11 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
     Entry* first_input = state->first_input;       // Shorthand
 
     nodestats::SetOpEnd(stats);
+    // The CPU time of asynchronous kernels is not accounted: `this` and the
+    // step may be gone by the time ComputeAsync() returns.
+    if (resource_usage_ != nullptr) {
+      resource_usage_->num_ops.fetch_add(1, std::memory_order_relaxed);
+    }
     EntryVector outputs(state->item->num_outputs);
     Status s = ProcessOutputs(*state->item, &state->ctx, outputs.data(), stats);
     nodestats::SetMemory(stats, &state->ctx);
@@ -646,6 +781,8 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
   };
   nodestats::SetOpStart(stats);
   {
+    profiler::ScopedMemoryDebugAnnotation op_annotation(
+        async_kernel->name_view().data(), step_id_);
     profiler::AnnotatedTraceMe activity(
         [async_kernel, state] {
           return async_kernel->TraceString(
@@ -711,6 +848,10 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
   }
   params.start_time_usecs = start_time_usecs_;
   params.deadline = deadline_;
+  params.low_priority_batching = low_priority_batching_;
+  params.memmap_restored_tensors = memmap_restored_tensors_;
+  params.allocated_bytes =
+      resource_usage_ != nullptr ? &resource_usage_->allocated_bytes : nullptr;
   params.log_memory = log_memory_;
   params.rendezvous = rendezvous_;
   params.collective_executor = collective_executor_;
@@ -730,6 +871,7 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
   params.input_alloc_attrs = &input_alloc_attrs;
   params.runner = &runner_;
   params.run_all_kernels_inline = run_all_kernels_inline_;
+  params.use_step_allocator = use_step_allocator_;
   params.stats_collector = stats_collector_;
   params.inc_num_deferred_ops_function = [this]() {
     mutex_lock lock(num_deferred_ops_mu_);
@@ -817,9 +959,19 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
 
       // Set up compute params.
       params.op_kernel = item.kernel;
+      if (immutable_state_.has_node_device_contexts()) {
+        DeviceContext* node_device_context =
+            immutable_state_.node_device_context(id);
+        params.op_device_context = node_device_context != nullptr
+                                       ? node_device_context
+                                       : device_context_;
+      }
       params.frame_iter = propagator_.GetFrameAndIter(tagged_node);
       params.is_input_dead = is_input_dead;
       params.output_attr_array = item.output_attrs();
+      params.planned_output_allocators =
+          memory_plan_ != nullptr ? memory_plan_->output_allocators(id)
+                                  : nullptr;
       params.forward_from_array = item.forward_from();
       params.outputs_required_array = item.outputs_required.get();
 
@@ -1189,6 +1341,25 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         inline_ready->push_back(tagged_node);
       }
     }
+  } else if (work_queue_ != nullptr) {
+    // Work-stealing mode: inexpensive nodes still run inline on this thread,
+    // while expensive ones go to this thread's deque, from where this thread
+    // picks them up again once it runs out of inline work unless an idle
+    // worker steals them first.
+    int num_pushed = 0;
+    for (auto& tagged_node : *ready) {
+      if (inline_ready != nullptr &&
+          (tagged_node.get_is_dead() ||
+           !kernel_stats_->IsExpensive(*tagged_node.node_item))) {
+        inline_ready->push_back(tagged_node);
+      } else {
+        PushToWorkQueue(tagged_node, scheduled_nsec);
+        ++num_pushed;
+      }
+    }
+    if (num_pushed > 0) {
+      MaybeStartWorkers(num_pushed);
+    }
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
     if (inline_ready == nullptr) {
@@ -1258,6 +1429,10 @@ void ExecutorState<PropagatorStateType>::Finish() {
   CHECK(done_cb != nullptr);
   Device* device = immutable_state_.params().device;
 
+  if (memory_plan_ != nullptr && status.ok()) {
+    memory_plan_->StepDone();
+  }
+
   if (vlog_ && !status.ok() && VLOG_IS_ON(1)) {
     // Logs verbose information about the current state of active and pending
     // nodes in the propagator.
@@ -1364,24 +1539,36 @@ void ExecutorState<PropagatorStateType>::Finish() {
 
 void ExecutorImpl::RunAsync(const Args& args, DoneCallback done) {
   if (OpOrderDeterminismRequired()) {
-    (new ExecutorState<OrderedPropagatorState>(args, immutable_state_,
-                                               &kernel_stats_))
+    (new ExecutorState<OrderedPropagatorState>(
+         args, immutable_state_, &kernel_stats_,
+         /*use_work_stealing=*/false, memory_plan_.get()))
         ->RunAsync(std::move(done));
   } else if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        options_.use_work_stealing))
+        ->RunAsync(std::move(done));
+  } else if (immutable_state_.static_schedule() != nullptr) {
+    (new ExecutorState<StaticSchedulePropagatorState>(
+         args, immutable_state_, &kernel_stats_,
+         /*use_work_stealing=*/false, memory_plan_.get()))
         ->RunAsync(std::move(done));
   } else {
-    (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+    (new ExecutorState<SimplePropagatorState>(
+         args, immutable_state_, &kernel_stats_, options_.use_work_stealing,
+         memory_plan_.get()))
         ->RunAsync(std::move(done));
   }
 }
 
 }  // namespace
 
-Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
-                        Executor** executor) {
-  ExecutorImpl* impl = new ExecutorImpl(params);
+namespace {
+
+Status NewLocalExecutorImpl(const LocalExecutorParams& params,
+                            const Graph& graph,
+                            const ExecutorImplOptions& options,
+                            Executor** executor) {
+  ExecutorImpl* impl = new ExecutorImpl(params, options);
   const Status s = impl->Initialize(graph);
   if (s.ok()) {
     *executor = impl;
@@ -1391,6 +1578,13 @@ Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
   return s;
 }
 
+}  // namespace
+
+Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
+                        Executor** executor) {
+  return NewLocalExecutorImpl(params, graph, ExecutorImplOptions(), executor);
+}
+
 Status CreateNonCachedKernel(Device* device, FunctionLibraryRuntime* flib,
                              const std::shared_ptr<const NodeProperties>& props,
                              int graph_def_version, OpKernel** kernel) {
@@ -1426,6 +1620,54 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+// Registers the default executor with per-worker work-stealing ready queues
+// under "WORK_STEALING", so that it can be selected with
+// ConfigProto.Experimental.executor_type.
+class WorkStealingExecutorRegistrar {
+ public:
+  WorkStealingExecutorRegistrar() {
+    ExecutorFactory::Register("WORK_STEALING", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      ExecutorImplOptions options;
+      options.use_work_stealing = true;
+      Executor* ret = nullptr;
+      TF_RETURN_IF_ERROR(NewLocalExecutorImpl(params, graph, options, &ret));
+      out_executor->reset(ret);
+      return Status::OK();
+    }
+  };
+};
+static WorkStealingExecutorRegistrar work_stealing_registrar;
+
+// Registers the default executor with a precomputed static schedule under
+// "STATIC_SCHEDULE". Graphs that require control flow support fall back to
+// dynamic scheduling.
+class StaticScheduleExecutorRegistrar {
+ public:
+  StaticScheduleExecutorRegistrar() {
+    ExecutorFactory::Register("STATIC_SCHEDULE", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      ExecutorImplOptions options;
+      options.use_static_schedule = true;
+      Executor* ret = nullptr;
+      TF_RETURN_IF_ERROR(NewLocalExecutorImpl(params, graph, options, &ret));
+      out_executor->reset(ret);
+      return Status::OK();
+    }
+  };
+};
+static StaticScheduleExecutorRegistrar static_schedule_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EXECUTOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_EXECUTOR_H_
 
+#include <atomic>
+
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/device.h"
@@ -36,6 +38,14 @@ namespace tensorflow {
 
 class StepStatsCollector;
 
+// Accumulates the resources used by the ops of a step, across all the
+// executors that run it. Thread-safe.
+struct StepResourceUsage {
+  std::atomic<int64_t> num_ops{0};
+  std::atomic<int64_t> op_cpu_time_nanos{0};
+  std::atomic<int64_t> allocated_bytes{0};
+};
+
 // Executor runs a graph computation.
 // Example:
 //   Graph* graph = ...;
@@ -106,6 +116,12 @@ class Executor {
     int64_t start_time_usecs = 0;
     // The deadline for the kernel to complete by. Empty if unspecified.
     absl::optional<absl::Time> deadline;
+    // Whether batching ops batch their inputs as low-priority work.
+    bool low_priority_batching = false;
+    // Whether RestoreV2 ops memory-map large restored tensors.
+    bool memmap_restored_tensors = false;
+    // If not null, the resources used by the ops are added to it.
+    StepResourceUsage* resource_usage = nullptr;
     absl::optional<ManagedStackTrace> stack_trace = absl::nullopt;
 
     // If true, calls Sync() on the device.
@@ -118,6 +134,11 @@ class Executor {
     // If true, all kernels will be treated as "inexpensive", and hence executed
     // on the scheduling thread.
     bool run_all_kernels_inline = false;
+
+    // If true, temporaries allocated with OpKernelContext::allocate_temp are
+    // served by Device::GetStepAllocator(). The caller must arrange for the
+    // device's StepArenaAllocatorMgr to be cleaned up for `step_id`.
+    bool use_step_allocator = false;
   };
   typedef std::function<void(const Status&)> DoneCallback;
   virtual void RunAsync(const Args& args, DoneCallback done) = 0;
@@ -0,0 +1,198 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/function_shape_inference_cache.h"
+
+#include <algorithm>
+#include <map>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/coding.h"
+
+namespace tensorflow {
+namespace {
+
+// Large enough for the distinct calls of the functions of a few big models,
+// whose outputs take a few hundred bytes each.
+constexpr int64 kGlobalCapacity = 1 << 15;
+
+// Appends `s` with its length, so that the parts of a key are unambiguous.
+void AppendPart(StringPiece s, string* key) {
+  core::PutVarint64(key, s.size());
+  key->append(s.data(), s.size());
+}
+
+void AppendDeterministicProto(const protobuf::MessageLite& proto,
+                              string* key) {
+  string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  AppendPart(serialized, key);
+}
+
+}  // namespace
+
+FunctionShapeInferenceCache::KeyBuilder::KeyBuilder(StringPiece domain) {
+  AppendPart(domain, &key_);
+}
+
+void FunctionShapeInferenceCache::KeyBuilder::AddFunction(
+    const Fprint128& function_fingerprint) {
+  key_.push_back('f');
+  core::PutVarint64(&key_, function_fingerprint.low64);
+  core::PutVarint64(&key_, function_fingerprint.high64);
+}
+
+void FunctionShapeInferenceCache::KeyBuilder::AddAttrs(AttrSlice attrs) {
+  // The attributes are in a hash map, whose order is not deterministic.
+  std::map<StringPiece, const AttrValue*> sorted_attrs;
+  for (const auto& attr : attrs) {
+    sorted_attrs.emplace(attr.first, &attr.second);
+  }
+  key_.push_back('a');
+  core::PutVarint64(&key_, sorted_attrs.size());
+  for (const auto& attr : sorted_attrs) {
+    AppendPart(attr.first, &key_);
+    AppendDeterministicProto(*attr.second, &key_);
+  }
+}
+
+void FunctionShapeInferenceCache::KeyBuilder::AddInput(
+    DataType dtype, const TensorShapeProto& shape) {
+  key_.push_back('i');
+  core::PutVarint64(&key_, dtype);
+  AddProto(shape);
+}
+
+void FunctionShapeInferenceCache::KeyBuilder::AddInputHandleShapesAndTypes(
+    const std::vector<HandleShapeAndType>& handle_shapes_and_types) {
+  key_.push_back('h');
+  core::PutVarint64(&key_, handle_shapes_and_types.size());
+  for (const HandleShapeAndType& shape_and_type : handle_shapes_and_types) {
+    core::PutVarint64(&key_, shape_and_type.dtype);
+    AddProto(shape_and_type.shape);
+    AddProto(shape_and_type.type);
+  }
+}
+
+void FunctionShapeInferenceCache::KeyBuilder::AddInputValue(
+    const TensorProto& value) {
+  key_.push_back('v');
+  AddProto(value);
+}
+
+void FunctionShapeInferenceCache::KeyBuilder::AddProto(
+    const protobuf::MessageLite& proto) {
+  AppendDeterministicProto(proto, &key_);
+}
+
+Fprint128 FunctionShapeInferenceCache::KeyBuilder::Build() const {
+  return Fingerprint128(key_);
+}
+
+Fprint128 FunctionShapeInferenceCache::FingerprintFunction(
+    const FunctionDef& function_def,
+    const FunctionLibraryDefinition& library) {
+  string serialized;
+  AppendDeterministicProto(function_def, &serialized);
+  const FunctionLibraryDefinition reachable =
+      library.ReachableDefinitions(function_def);
+  std::vector<string> names = reachable.ListFunctionNames();
+  std::sort(names.begin(), names.end());
+  for (const string& name : names) {
+    AppendDeterministicProto(*reachable.Find(name), &serialized);
+  }
+  return Fingerprint128(serialized);
+}
+
+Status FunctionShapeInferenceCache::SetOutputShapes(
+    const Outputs& outputs, shape_inference::InferenceContext* c) {
+  if (static_cast<int>(outputs.size()) != c->num_outputs()) {
+    return errors::Internal("Cached ", outputs.size(),
+                            " function outputs for a call with ",
+                            c->num_outputs(), " outputs.");
+  }
+  for (int i = 0, end = outputs.size(); i < end; ++i) {
+    const Output& output = outputs[i];
+    shape_inference::ShapeHandle shape;
+    TF_RETURN_IF_ERROR(c->MakeShapeFromShapeProto(output.shape, &shape));
+    c->set_output(i, shape);
+    if (!output.handle_shapes_and_types.has_value()) continue;
+    std::vector<shape_inference::ShapeAndType> handle_shapes_and_types;
+    handle_shapes_and_types.reserve(output.handle_shapes_and_types->size());
+    for (const HandleShapeAndType& shape_and_type :
+         *output.handle_shapes_and_types) {
+      shape_inference::ShapeHandle handle_shape;
+      TF_RETURN_IF_ERROR(
+          c->MakeShapeFromShapeProto(shape_and_type.shape, &handle_shape));
+      handle_shapes_and_types.emplace_back(handle_shape, shape_and_type.dtype,
+                                           shape_and_type.type);
+    }
+    c->set_output_handle_shapes_and_types(i, handle_shapes_and_types);
+  }
+  return Status::OK();
+}
+
+FunctionShapeInferenceCache* FunctionShapeInferenceCache::Global() {
+  static FunctionShapeInferenceCache* cache =
+      new FunctionShapeInferenceCache(kGlobalCapacity);
+  return cache;
+}
+
+FunctionShapeInferenceCache::FunctionShapeInferenceCache(int64 capacity)
+    : capacity_(std::max<int64>(capacity, 1)) {}
+
+std::shared_ptr<const FunctionShapeInferenceCache::Outputs>
+FunctionShapeInferenceCache::Lookup(const Fprint128& key) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    ++num_misses_;
+    return nullptr;
+  }
+  ++num_hits_;
+  lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+  return it->second.outputs;
+}
+
+void FunctionShapeInferenceCache::Insert(const Fprint128& key,
+                                         Outputs outputs) {
+  auto shared_outputs = std::make_shared<const Outputs>(std::move(outputs));
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    it->second.outputs = std::move(shared_outputs);
+    lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+    return;
+  }
+  if (static_cast<int64>(entries_.size()) >= capacity_) {
+    entries_.erase(lru_.back());
+    lru_.pop_back();
+  }
+  lru_.push_front(key);
+  entries_[key] = Entry{std::move(shared_outputs), lru_.begin()};
+}
+
+int64 FunctionShapeInferenceCache::num_hits() const {
+  mutex_lock l(mu_);
+  return num_hits_;
+}
+
+int64 FunctionShapeInferenceCache::num_misses() const {
+  mutex_lock l(mu_);
+  return num_misses_;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,146 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_FUNCTION_SHAPE_INFERENCE_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_FUNCTION_SHAPE_INFERENCE_CACHE_H_
+
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+#include "tensorflow/core/framework/full_type.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A process-wide memo of the output shapes that shape inference computed for
+// the body of a function call, keyed by the fingerprint of the function and of
+// everything about its inputs that the inference propagates into the body.
+//
+// Graphs often call the same function many times with the same input shapes,
+// and the same functions are inferred again whenever a graph is retraced or
+// reloaded. Both ShapeRefiner and grappler's SymbolicShapeRefiner look up a
+// call here before they infer the function body, so that each distinct call is
+// inferred once. Since they propagate different information into function
+// bodies, each of them builds its keys in a domain of its own.
+class FunctionShapeInferenceCache {
+ public:
+  // The shape and type of the resource that a function output is a handle to.
+  struct HandleShapeAndType {
+    DataType dtype = DT_INVALID;
+    TensorShapeProto shape;
+    FullTypeDef type;
+  };
+
+  // What inference computed for one output of a function call.
+  struct Output {
+    TensorShapeProto shape;
+    // Set if the output has handle data, which may be empty.
+    absl::optional<std::vector<HandleShapeAndType>> handle_shapes_and_types;
+    // The value of the output, if inference could compute it.
+    absl::optional<TensorProto> value;
+  };
+  using Outputs = std::vector<Output>;
+
+  // Builds the key of a function call from its parts, which the caller must
+  // add in the same order for every call.
+  class KeyBuilder {
+   public:
+    // `domain` names the refiner and the options its results depend on.
+    explicit KeyBuilder(StringPiece domain);
+
+    // Adds the fingerprint of the function from FingerprintFunction().
+    void AddFunction(const Fprint128& function_fingerprint);
+    // Adds the attributes the function is instantiated with.
+    void AddAttrs(AttrSlice attrs);
+    // Adds an input of the call, and the handle data of the last input added
+    // if it has any.
+    void AddInput(DataType dtype, const TensorShapeProto& shape);
+    void AddInputHandleShapesAndTypes(
+        const std::vector<HandleShapeAndType>& handle_shapes_and_types);
+    // Adds the value of the last input added.
+    void AddInputValue(const TensorProto& value);
+
+    Fprint128 Build() const;
+
+   private:
+    void AddProto(const protobuf::MessageLite& proto);
+
+    string key_;
+  };
+
+  // Returns a fingerprint of `function_def` and of the functions in `library`
+  // that it calls, directly or not.
+  static Fprint128 FingerprintFunction(
+      const FunctionDef& function_def,
+      const FunctionLibraryDefinition& library);
+
+  // Sets the shapes and handle data of the outputs of `c` to `outputs`, which
+  // must have one element per output. Does not set their values.
+  static Status SetOutputShapes(const Outputs& outputs,
+                                shape_inference::InferenceContext* c);
+
+  // The cache that ShapeRefiner and SymbolicShapeRefiner share.
+  static FunctionShapeInferenceCache* Global();
+
+  // Holds at most `capacity` calls, and evicts the least recently used ones.
+  explicit FunctionShapeInferenceCache(int64 capacity);
+
+  // Returns what inference computed for the call, or nullptr if it is not
+  // cached.
+  std::shared_ptr<const Outputs> Lookup(const Fprint128& key)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  void Insert(const Fprint128& key, Outputs outputs) TF_LOCKS_EXCLUDED(mu_);
+
+  int64 num_hits() const TF_LOCKS_EXCLUDED(mu_);
+  int64 num_misses() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Entry {
+    std::shared_ptr<const Outputs> outputs;
+    // The position of the key in `lru_`.
+    std::list<Fprint128>::iterator lru_position;
+  };
+
+  const int64 capacity_;
+  mutable mutex mu_;
+  absl::flat_hash_map<Fprint128, Entry, Fprint128Hasher> entries_
+      TF_GUARDED_BY(mu_);
+  // The keys of `entries_`, most recently used first.
+  std::list<Fprint128> lru_ TF_GUARDED_BY(mu_);
+  int64 num_hits_ TF_GUARDED_BY(mu_) = 0;
+  int64 num_misses_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FunctionShapeInferenceCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_FUNCTION_SHAPE_INFERENCE_CACHE_H_
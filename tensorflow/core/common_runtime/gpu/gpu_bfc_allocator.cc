@@ -18,6 +18,7 @@ limitations under the License.
 #include <utility>
 
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -75,6 +76,18 @@ bool GetGarbageCollectionValue() {
       << " Using the default value \"true\".";
   return true;
 }
+
+// Telemetry is off by default. It can be turned on for all GPU BFC allocators
+// by setting TF_GPU_BFC_ALLOCATOR_TELEMETRY=true.
+bool GetTelemetryValue() {
+  bool enable_telemetry = false;
+  Status s = ReadBoolFromEnvVar("TF_GPU_BFC_ALLOCATOR_TELEMETRY",
+                                /*default_val=*/false, &enable_telemetry);
+  if (!s.ok()) {
+    LOG(ERROR) << s.error_message();
+  }
+  return enable_telemetry;
+}
 }  // anonymous namespace
 
 GPUBFCAllocator::GPUBFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
@@ -90,6 +103,7 @@ GPUBFCAllocator::GPUBFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
           o.garbage_collection = GetGarbageCollectionValue();
         }
         o.fragmentation_fraction = opts.fragmentation_fraction;
+        o.enable_telemetry = GetTelemetryValue();
         return o;
       }()) {}
 
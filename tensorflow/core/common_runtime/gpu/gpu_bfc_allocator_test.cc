@@ -624,6 +624,69 @@ TEST_F(GPUBFCAllocatorTest_SubAllocatorSpecific,
   void* big_alloc = a.AllocateRaw(1, k512MiB - size);
   EXPECT_NE(big_alloc, nullptr);
 }
+
+TEST_F(GPUBFCAllocatorTest_SubAllocatorSpecific,
+       VirtualAllocatorReleasesFragmentedMemory) {
+  GPUBFCAllocator::Options options;
+  options.allow_growth = true;
+  options.garbage_collection = true;
+
+  constexpr size_t k512MiB = 512ull << 20;
+
+  // 512 MiB allocator.
+  GPUBFCAllocator a(CreateVirtualMemorySubAllocator(1ull << 32), k512MiB,
+                    "GPU_0_bfc", options);
+  // Allocate 128 raw pointers of 4 megs.
+  const size_t size = 1LL << 22;
+  std::vector<void*> initial_ptrs;
+  for (size_t s = 0; s < 128; s++) {
+    void* raw = a.AllocateRaw(1, size);
+    initial_ptrs.push_back(raw);
+  }
+  // Deallocate all but one in the middle, so that no free chunk can hold
+  // more than half of the memory.
+  for (int i = 0; i < 128; ++i) {
+    if (i != 63) a.DeallocateRaw(initial_ptrs[i]);
+  }
+  void* big_alloc = a.AllocateRaw(1, 300ull << 20);
+  EXPECT_NE(big_alloc, nullptr);
+  EXPECT_EQ(a.RequestedSize(initial_ptrs[63]), size);
+  a.DeallocateRaw(big_alloc);
+  a.DeallocateRaw(initial_ptrs[63]);
+}
+
+TEST_F(GPUBFCAllocatorTest_SubAllocatorSpecific, VirtualAllocatorCompact) {
+  GPUBFCAllocator::Options options;
+  options.allow_growth = true;
+  options.garbage_collection = false;
+  options.allow_retry_on_failure = false;
+
+  constexpr size_t k512MiB = 512ull << 20;
+
+  // 512 MiB allocator.
+  GPUBFCAllocator a(CreateVirtualMemorySubAllocator(1ull << 32), k512MiB,
+                    "GPU_0_bfc", options);
+  // Allocate 128 raw pointers of 4 megs.
+  const size_t size = 1LL << 22;
+  std::vector<void*> initial_ptrs;
+  for (size_t s = 0; s < 128; s++) {
+    void* raw = a.AllocateRaw(1, size);
+    initial_ptrs.push_back(raw);
+  }
+  for (int i = 0; i < 128; ++i) {
+    if (i != 63) a.DeallocateRaw(initial_ptrs[i]);
+  }
+  // Without garbage collection, the fragmented memory cannot be reused.
+  EXPECT_EQ(a.AllocateRaw(1, 300ull << 20), nullptr);
+
+  EXPECT_EQ(a.Compact(), static_cast<int64_t>(127 * size));
+  EXPECT_EQ(a.Compact(), 0);
+  void* big_alloc = a.AllocateRaw(1, k512MiB - 2 * size);
+  EXPECT_NE(big_alloc, nullptr);
+  EXPECT_EQ(a.RequestedSize(initial_ptrs[63]), size);
+  a.DeallocateRaw(big_alloc);
+  a.DeallocateRaw(initial_ptrs[63]);
+}
 #endif
 
 TEST_F(GPUBFCAllocatorTest_SubAllocatorSpecific,
@@ -650,6 +713,8 @@ TEST_F(GPUBFCAllocatorTest_SubAllocatorSpecific,
   }
   void* big_alloc = a.AllocateRaw(1, k512MiB - size);
   EXPECT_EQ(big_alloc, nullptr);
+  // Device memory allocations cannot be freed in parts.
+  EXPECT_EQ(a.Compact(), 0);
 }
 
 // Tests that use private functions and cannot be trivially parameterized for
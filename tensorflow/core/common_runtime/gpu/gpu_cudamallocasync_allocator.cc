@@ -26,6 +26,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/profiler/lib/scoped_memory_debug_annotation.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
@@ -311,6 +313,7 @@ void* GpuCudaMallocAsyncAllocator::AllocateRaw(size_t alignment,
     stats_->largest_alloc_size =
         std::max<std::size_t>(stats_->largest_alloc_size, num_bytes);
     size_map_[ptr] = num_bytes;
+    AddTraceMe("MemoryAllocation", ptr, num_bytes, num_bytes);
   }
   VLOG(10) << Name() << " Allocated " << num_bytes << " at " << ptr;
   return ptr;
@@ -347,12 +350,46 @@ void GpuCudaMallocAsyncAllocator::DeallocateRaw(void* ptr) {
     size_t size = size_map_[ptr];
     stats_->bytes_in_use -= size;
     size_map_.erase(ptr);
+    AddTraceMe("MemoryDeallocation", ptr, 0, size);
   }
 
   VLOG(10) << Name() << " Freed ptr: " << ptr;
 #endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
 }
 
+void GpuCudaMallocAsyncAllocator::AddTraceMe(absl::string_view traceme_name,
+                                             const void* ptr,
+                                             int64_t req_bytes,
+                                             int64_t alloc_bytes) {
+  // The pool can grow beyond `bytes_limit`, so the available bytes are only a
+  // lower bound.
+  tensorflow::profiler::TraceMe::InstantActivity(
+      [this, traceme_name, ptr, req_bytes, alloc_bytes]()
+          TF_NO_THREAD_SAFETY_ANALYSIS {
+            const auto& annotation =
+                profiler::ScopedMemoryDebugAnnotation::CurrentAnnotation();
+            return tensorflow::profiler::TraceMeEncode(
+                traceme_name,
+                {{"allocator_name", name_},
+                 {"bytes_reserved", stats_->bytes_reserved},
+                 {"bytes_allocated", stats_->bytes_in_use},
+                 {"bytes_available",
+                  std::max<int64_t>(0, stats_->bytes_limit.value_or(0) -
+                                           stats_->bytes_in_use)},
+                 {"peak_bytes_in_use", stats_->peak_bytes_in_use},
+                 {"requested_bytes", req_bytes},
+                 {"allocation_bytes", alloc_bytes},
+                 {"addr", reinterpret_cast<uint64>(ptr)},
+                 {"tf_op", annotation.pending_op_name},
+                 {"id", annotation.pending_step_id},
+                 {"region_type", annotation.pending_region_type},
+                 {"data_type", annotation.pending_data_type},
+                 {"tensor_name", annotation.PendingTensorName()},
+                 {"shape", annotation.pending_shape_func()}});
+          },
+      /*level=*/profiler::TraceMeLevel::kInfo);
+}
+
 bool GpuCudaMallocAsyncAllocator::TracksAllocationSizes() const {
   return static_cast<bool>(stats_);
 }
@@ -124,6 +124,12 @@ class GpuCudaMallocAsyncAllocator : public Allocator {
 
   TF_DISALLOW_COPY_AND_ASSIGN(GpuCudaMallocAsyncAllocator);
 
+  // Records the allocation or deallocation of `ptr` for the memory profiler,
+  // attributed to the op that is currently annotated.
+  void AddTraceMe(absl::string_view traceme_name, const void* ptr,
+                  int64_t req_bytes, int64_t alloc_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Stats.
   // Structures mutable after construction
   mutable mutex lock_;
@@ -39,11 +39,14 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 #include "tensorflow/core/common_runtime/device/device_id_utils.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_ordered_allocator.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/common_runtime/local_device.h"
@@ -77,6 +80,7 @@ limitations under the License.
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/stream_executor_util.h"
+#include "tensorflow/stream_executor/gpu/gpu_driver.h"
 #include "tensorflow/stream_executor/gpu/gpu_stream.h"
 #include "tensorflow/stream_executor/platform/dso_loader.h"
 
@@ -216,6 +220,7 @@ class EigenGpuStreamDevice : public ::Eigen::StreamInterface {
       LogMemory::RecordRawDeallocation(data->operation_, data->step_id_,
                                        data->address_, data->allocator_, false);
     }
+    GPUStreamOrderedAllocator::ScopedInStreamCallback in_stream_callback;
     data->allocator_->DeallocateRaw(data->address_);
     delete data;
   }
@@ -233,6 +238,34 @@ class EigenGpuStreamDevice : public ::Eigen::StreamInterface {
   TF_DISALLOW_COPY_AND_ASSIGN(EigenGpuStreamDevice);
 };
 
+namespace {
+
+// The largest GPUOptions.experimental.num_compute_streams.
+constexpr int kMaxComputeStreams = 8;
+
+int NumComputeStreams(const GPUOptions& options) {
+  int num_compute_streams = options.experimental().num_compute_streams();
+  if (num_compute_streams == 0) num_compute_streams = 1;
+  if (num_compute_streams < 1 || num_compute_streams > kMaxComputeStreams) {
+    LOG(ERROR) << "Illegal GPUOptions.experimental.num_compute_streams="
+               << num_compute_streams << " set to 1 instead.";
+    num_compute_streams = 1;
+  }
+  return num_compute_streams;
+}
+
+// Inputs smaller than this are left to page faults, which are cheaper than a
+// prefetch call for a few pages.
+constexpr size_t kMinUnifiedMemoryPrefetchBytes = 256 << 10;
+
+bool PrefetchesUnifiedMemory(const GPUOptions& options) {
+  return options.experimental().prefetch_unified_memory() &&
+         (options.per_process_gpu_memory_fraction() > 1.0 ||
+          options.experimental().use_unified_memory());
+}
+
+}  // namespace
+
 // This factory helps to ensure that different GPU device objects that refer to
 // the same physical device and stream group id use the same stream group
 // object (and therefore the same CUDA streams). This is necessary since there
@@ -299,6 +332,39 @@ class BaseGPUDevice::StreamGroupFactory {
         VLOG(2) << "Created device_to_device_stream[" << stream_group_within_gpu
                 << "] = " << group->device_to_device.back();
       }
+
+      int num_h2d_streams =
+          options.experimental().num_host_to_device_copy_streams();
+      if (num_h2d_streams == 0) num_h2d_streams = 1;
+      if (num_h2d_streams < 1 || num_h2d_streams > 4) {
+        LOG(ERROR) << "Illegal "
+                   << "GPUOptions.experimental.num_host_to_device_copy_streams="
+                   << num_h2d_streams << " set to 1 instead.";
+        num_h2d_streams = 1;
+      }
+      for (int i = 1; i < num_h2d_streams; ++i) {
+        se::Stream* stream = GetStream(executor, priority);
+        stream->Init();
+        group->extra_host_to_device.push_back(stream);
+        VLOG(2) << "Created host_to_device_stream[" << stream_group_within_gpu
+                << "][" << i << "] = " << stream;
+      }
+
+      const int num_compute_streams = NumComputeStreams(options);
+      for (int i = 1; i < num_compute_streams; ++i) {
+        se::Stream* stream = GetStream(executor, priority);
+        stream->Init();
+        group->extra_compute.push_back(stream);
+        VLOG(2) << "Created compute_stream[" << stream_group_within_gpu << "]["
+                << i << "] = " << stream;
+      }
+
+      if (PrefetchesUnifiedMemory(options)) {
+        group->prefetch = GetStream(executor, priority);
+        group->prefetch->Init();
+        VLOG(2) << "Created prefetch_stream[" << stream_group_within_gpu
+                << "] = " << group->prefetch;
+      }
     }
     return group;
   }
@@ -340,6 +406,12 @@ class BaseGPUDevice::StreamGroupFactory {
         }
         stream.device_to_device.pop_back();
       }
+      for (se::Stream* extra : stream.extra_compute) delete extra;
+      stream.extra_compute.clear();
+      for (se::Stream* extra : stream.extra_host_to_device) delete extra;
+      stream.extra_host_to_device.clear();
+      delete stream.prefetch;
+      stream.prefetch = nullptr;
     }
     streams_.clear();
   }
@@ -406,14 +478,18 @@ BaseGPUDevice::BaseGPUDevice(const SessionOptions& options, const string& name,
 
 BaseGPUDevice::~BaseGPUDevice() {
   delete accelerator_device_info_;
-  if (scratch_) gpu_allocator_->DeallocateRaw(scratch_);
+  for (char* scratch : scratch_) gpu_allocator_->DeallocateRaw(scratch);
   device_context_->Unref();
+  mutex_lock l(node_device_contexts_mu_);
+  for (auto& entry : node_device_contexts_) entry.second->Unref();
 }
 
 // This should be idempotent if already initialized.
 Status BaseGPUDevice::InitScratchBuffers() {
   mutex_lock l(scratch_init_mutex_);
-  if (!scratch_) {
+  // Each compute stream has its own scratch buffer, since the semaphore in it
+  // is only reset to 0 once the kernel that uses it completes.
+  while (scratch_.size() < compute_streams_.size()) {
     DCHECK(stream_);
     size_t scratch_buffer_size = Eigen::kGpuScratchSize + sizeof(unsigned int);
     profiler::ScopedMemoryDebugAnnotation op_annotation("ScratchBuffer");
@@ -428,7 +504,7 @@ Status BaseGPUDevice::InitScratchBuffers() {
         se::DeviceMemoryBase(scratch_buffer, scratch_buffer_size));
     TF_RETURN_IF_ERROR(executor_->SynchronousMemZero(
         &mem, Eigen::kGpuScratchSize + sizeof(unsigned int)));
-    scratch_ = static_cast<char*>(scratch_buffer);
+    scratch_.push_back(static_cast<char*>(scratch_buffer));
   }
   return Status::OK();
 }
@@ -450,18 +526,36 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
   AllocatorAttributes attr;
   attr.set_on_host(true);
   attr.set_gpu_compatible(true);
-  Allocator* host_memory_allocator = GetAllocator(attr);
+  host_memory_allocator_ = GetAllocator(attr);
 
+  host_to_device_streams_.push_back(stream_->host_to_device);
+  host_to_device_streams_.insert(host_to_device_streams_.end(),
+                                 stream_->extra_host_to_device.begin(),
+                                 stream_->extra_host_to_device.end());
   device_context_ =
       new GPUDeviceContext(0, stream_->compute,
 #if TENSORFLOW_USE_ROCM
                            stream_->nccl,
 #endif
-                           stream_->host_to_device, stream_->device_to_host,
-                           stream_->device_to_device, host_memory_allocator);
+                           host_to_device_streams_, stream_->device_to_host,
+                           stream_->device_to_device, host_memory_allocator_);
+  compute_streams_.push_back(stream_->compute);
+  compute_streams_.insert(compute_streams_.end(),
+                          stream_->extra_compute.begin(),
+                          stream_->extra_compute.end());
 
   em_ = EventMgrFactory::Singleton()->GetEventMgr(executor_,
                                                   options.config.gpu_options());
+#if GOOGLE_CUDA
+  // The stream group is shared by the devices of the GPU, and only has a
+  // prefetch stream if the first of them asked for it.
+  if (PrefetchesUnifiedMemory(options.config.gpu_options()) &&
+      stream_->prefetch != nullptr) {
+    VLOG(1) << "Prefetching the inputs of the ops of " << name()
+            << " from unified memory";
+    prefetch_unified_memory_ = true;
+  }
+#endif  // GOOGLE_CUDA
 
   GPUKernelTracker::Params tracker_params(
       options.config.gpu_options().experimental().kernel_tracker_max_interval(),
@@ -487,6 +581,26 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
         tracker_params, Env::Default(), stream_->compute, timing_counter,
         timestamped_allocator_ ? gpu_allocator_ : nullptr, em_));
   }
+  if (compute_streams_.size() > 1) {
+    VLOG(1) << "Running kernels of " << name() << " on "
+            << compute_streams_.size() << " compute streams";
+    // Never deleted, since the buffers of tensors may outlive the device.
+    stream_ordered_allocator_ =
+        new GPUStreamOrderedAllocator(gpu_allocator_, compute_streams_);
+    gpu_allocator_ = stream_ordered_allocator_;
+  }
+
+  if (options.config.gpu_options()
+          .experimental()
+          .batch_host_to_device_copies()) {
+    for (se::Stream* stream : host_to_device_streams_) {
+      host_to_device_copy_batchers_.push_back(
+          std::make_unique<GPUHostToDeviceCopyBatcher>(
+              stream, em_, host_memory_allocator_, gpu_allocator_));
+    }
+    device_context_->set_host_to_device_copy_batchers(
+        host_to_device_copy_batchers());
+  }
 
   accelerator_device_info_ = new DeviceBase::AcceleratorDeviceInfo;
   accelerator_device_info_->stream = stream_->compute;
@@ -672,6 +786,10 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
     }
   }
   ScopedActivateExecutorContext scoped_activation{stream->parent()};
+  GPUStreamOrderedAllocator::ScopedStream scoped_stream(
+      stream_ordered_allocator_, stream_id);
+  WaitForInputStreams(gpu_device_context, context);
+  PrefetchInputs(context);
   profiler::ScopedMemoryDebugAnnotation op_annotation(
       op_kernel->name_view().data(), context->step_id());
   bool should_log_inputs_and_outputs = ShouldLogInputsAndOutputs(op_kernel);
@@ -726,6 +844,64 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
   }
 }
 
+void BaseGPUDevice::WaitForInputStreams(GPUDeviceContext* gpu_device_context,
+                                        OpKernelContext* context) {
+  if (gpu_device_context->wait_streams().empty()) return;
+  se::Stream* stream = gpu_device_context->stream();
+  for (se::Stream* wait_stream : gpu_device_context->wait_streams()) {
+    stream->ThenWaitFor(wait_stream);
+  }
+  // Some inputs come from other streams, which the stream-ordered allocator
+  // must not let reuse their memory until this stream is done with it.
+  for (int i = 0; i < context->num_inputs(); ++i) {
+    if (!context->has_input(i) || context->input_is_ref(i) ||
+        context->input_memory_type(i) != DEVICE_MEMORY) {
+      continue;
+    }
+    Tensor input = context->input(i);
+    TensorBuffer* buffer = DMAHelper::buffer(&input);
+    if (buffer == nullptr) continue;
+    stream_ordered_allocator_->RecordStreamUse(buffer->root_buffer()->data(),
+                                               gpu_device_context->stream_id());
+  }
+}
+
+gtl::InlinedVector<GPUHostToDeviceCopyBatcher*, 4>
+BaseGPUDevice::host_to_device_copy_batchers() const {
+  gtl::InlinedVector<GPUHostToDeviceCopyBatcher*, 4> batchers;
+  for (const auto& batcher : host_to_device_copy_batchers_) {
+    batchers.push_back(batcher.get());
+  }
+  return batchers;
+}
+
+void BaseGPUDevice::PrefetchInputs(OpKernelContext* context) {
+#if GOOGLE_CUDA
+  if (!prefetch_unified_memory_.load(std::memory_order_relaxed)) return;
+  auto* gpu_context = reinterpret_cast<se::gpu::GpuContext*>(
+      executor_->implementation()->GpuContextHack());
+  for (int i = 0; i < context->num_inputs(); ++i) {
+    if (!context->has_input(i) || context->input_is_ref(i) ||
+        context->input_memory_type(i) != DEVICE_MEMORY) {
+      continue;
+    }
+    const Tensor& input = context->input(i);
+    const size_t bytes = input.TotalBytes();
+    if (bytes < kMinUnifiedMemoryPrefetchBytes) continue;
+    Status s = se::gpu::GpuDriver::PrefetchUnifiedMemoryAsync(
+        gpu_context,
+        reinterpret_cast<se::gpu::GpuDevicePtr>(DMAHelper::base(&input)),
+        bytes, se::gpu::AsGpuStreamValue(stream_->prefetch));
+    if (!s.ok()) {
+      LOG(WARNING) << "Disabling the prefetching of unified memory on "
+                   << name() << ": " << s;
+      prefetch_unified_memory_ = false;
+      return;
+    }
+  }
+#endif  // GOOGLE_CUDA
+}
+
 Status BaseGPUDevice::Sync() {
   DCHECK_NE(stream_, nullptr);
 
@@ -735,7 +911,10 @@ Status BaseGPUDevice::Sync() {
   // enqueued the operation has completed.  We do use other streams for copies
   // and collectives, but in those cases the (Async)OpKernels themselves block
   // until the queued operation has finished.
-  return stream_->compute->BlockHostUntilDone();
+  for (se::Stream* stream : compute_streams_) {
+    TF_RETURN_IF_ERROR(stream->BlockHostUntilDone());
+  }
+  return Status::OK();
 }
 
 void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
@@ -766,6 +945,10 @@ void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
   }
 
   ScopedActivateExecutorContext scoped_activation{stream->parent()};
+  GPUStreamOrderedAllocator::ScopedStream scoped_stream(
+      stream_ordered_allocator_, stream_id);
+  WaitForInputStreams(gpu_device_context, context);
+  PrefetchInputs(context);
   op_kernel->ComputeAsync(context, std::move(done));
 }
 
@@ -1136,11 +1319,11 @@ void BaseGPUDevice::ReinitializeDevice(OpKernelContext* context,
   ConcretePerOpGpuDevice* concrete_device =
       static_cast<ConcretePerOpGpuDevice*>(device);
   DCHECK(concrete_device);
-  DCHECK_EQ(stream_id, 0);
+  DCHECK_LT(stream_id, compute_streams_.size());
   const gpuStream_t* gpu_stream = reinterpret_cast<const gpuStream_t*>(
-      stream_->compute->implementation()->GpuStreamMemberHack());
+      compute_streams_[stream_id]->implementation()->GpuStreamMemberHack());
   concrete_device->Reinitialize(context, gpu_stream, tf_device_id_, allocator,
-                                scratch_);
+                                scratch_[stream_id]);
 }
 
 PerOpGpuDevice* BaseGPUDevice::MakeGpuDevice() {
@@ -1157,7 +1340,6 @@ Status BaseGPUDevice::ReinitializeGpuDevice(OpKernelContext* context,
     const int stream_id = gpu_dc->stream_id();
     VLOG(1) << "  eigen_gpu_device(" << dc << ") => stream[" << stream_id
             << "]";
-    CHECK_EQ(stream_id, 0);
     ReinitializeDevice(context, device, stream_id, allocator);
   } else {
     ReinitializeDevice(context, device, 0, allocator);
@@ -1165,6 +1347,50 @@ Status BaseGPUDevice::ReinitializeGpuDevice(OpKernelContext* context,
   return Status::OK();
 }
 
+Status BaseGPUDevice::AssignNodeDeviceContexts(
+    const Graph& graph, std::vector<DeviceContext*>* node_contexts) {
+  if (compute_streams_.size() == 1) return Status::OK();
+  gpu_stream_util::AssignStreamsOpts opts;
+  opts.max_streams = compute_streams_.size();
+  std::vector<int> node_to_stream;
+  TF_RETURN_IF_ERROR(
+      gpu_stream_util::AssignStreams(&graph, opts, &node_to_stream));
+
+  node_contexts->assign(graph.num_node_ids(), nullptr);
+  mutex_lock l(node_device_contexts_mu_);
+  for (const Node* node : graph.nodes()) {
+    const int stream_id = node_to_stream[node->id()];
+    // The streams of the inputs of `node` other than its own.
+    uint32 wait_mask = 0;
+    for (const Edge* edge : node->in_edges()) {
+      if (edge->src()->IsSource()) continue;
+      const int src_stream_id = node_to_stream[edge->src()->id()];
+      if (src_stream_id != stream_id) wait_mask |= 1u << src_stream_id;
+    }
+    if (stream_id == 0 && wait_mask == 0) continue;
+    GPUDeviceContext*& context =
+        node_device_contexts_[std::make_pair(stream_id, wait_mask)];
+    if (context == nullptr) {
+      context = new GPUDeviceContext(stream_id, compute_streams_[stream_id],
+#if TENSORFLOW_USE_ROCM
+                                     stream_->nccl,
+#endif
+                                     host_to_device_streams_,
+                                     stream_->device_to_host,
+                                     stream_->device_to_device,
+                                     host_memory_allocator_);
+      gtl::InlinedVector<se::Stream*, 4> wait_streams;
+      for (size_t i = 0; i < compute_streams_.size(); ++i) {
+        if (wait_mask & (1u << i)) wait_streams.push_back(compute_streams_[i]);
+      }
+      context->set_wait_streams(std::move(wait_streams));
+      context->set_host_to_device_copy_batchers(host_to_device_copy_batchers());
+    }
+    (*node_contexts)[node->id()] = context;
+  }
+  return Status::OK();
+}
+
 Allocator* BaseGPUDevice::GetScopedAllocator(AllocatorAttributes attr,
                                              int64_t step_id) {
   if (attr.scope_id > 0) {
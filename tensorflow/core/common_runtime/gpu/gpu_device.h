@@ -20,15 +20,19 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_DEVICE_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_DEVICE_H_
 
+#include <atomic>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/common_runtime/device/device_id_utils.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_host_to_device_copy_batcher.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
@@ -53,6 +57,7 @@ class StreamInterface;
 
 namespace tensorflow {
 class GPUKernelTracker;
+class GPUStreamOrderedAllocator;
 
 class ConcretePerOpGpuDevice : public PerOpGpuDevice {
  public:
@@ -108,6 +113,11 @@ class BaseGPUDevice : public LocalDevice {
                                DeviceContext* dc,
                                Allocator* allocator) override;
 
+  // Spreads the nodes of `graph` over the compute streams if
+  // GPUOptions.experimental.num_compute_streams is greater than 1.
+  Status AssignNodeDeviceContexts(
+      const Graph& graph, std::vector<DeviceContext*>* node_contexts) override;
+
   // Returns the platform GPU id of this device within the native driver system;
   // e.g., for CUDA and ROCm this is the ordinal of the GPU within the system.
   int gpu_id() const {
@@ -165,14 +175,38 @@ class BaseGPUDevice : public LocalDevice {
     se::Stream* host_to_device = nullptr;
     se::Stream* device_to_host = nullptr;
     gtl::InlinedVector<se::Stream*, 4> device_to_device;
+    // The compute streams other than `compute`, if
+    // GPUOptions.experimental.num_compute_streams is greater than 1.
+    gtl::InlinedVector<se::Stream*, 4> extra_compute;
+    // The host-to-device streams other than `host_to_device`, if
+    // GPUOptions.experimental.num_host_to_device_copy_streams is greater
+    // than 1.
+    gtl::InlinedVector<se::Stream*, 4> extra_host_to_device;
+    // The stream that prefetches unified memory, if
+    // GPUOptions.experimental.prefetch_unified_memory is set.
+    se::Stream* prefetch = nullptr;
     int priority = 0;
   };
   class StreamGroupFactory;
 
   StreamGroup* stream_;
+  // `stream_->compute` followed by `stream_->extra_compute`.
+  gtl::InlinedVector<se::Stream*, 4> compute_streams_;
+  // `stream_->host_to_device` followed by `stream_->extra_host_to_device`.
+  gtl::InlinedVector<se::Stream*, 4> host_to_device_streams_;
   mutex scratch_init_mutex_;
-  char* scratch_ = nullptr;
+  // The scratch buffer of each compute stream.
+  gtl::InlinedVector<char*, 4> scratch_;
   GPUDeviceContext* device_context_;
+  Allocator* host_memory_allocator_ = nullptr;  // not owned
+  // Wraps the allocator of the device if it has several compute streams.
+  // Not owned.
+  GPUStreamOrderedAllocator* stream_ordered_allocator_ = nullptr;
+  mutex node_device_contexts_mu_;
+  // The contexts of the nodes that do not run on stream 0 or wait for other
+  // streams, by stream id and mask of the streams they wait for.
+  std::map<std::pair<int, uint32>, GPUDeviceContext*> node_device_contexts_
+      TF_GUARDED_BY(node_device_contexts_mu_);
   DeviceBase::AcceleratorDeviceInfo* accelerator_device_info_ = nullptr;
   mutex trace_mu_;
   TfDeviceId tf_device_id_;
@@ -183,10 +217,30 @@ class BaseGPUDevice : public LocalDevice {
   int32 pending_cap_ = 0;
   bool timestamped_allocator_ = false;
   NodeFileWriter* node_file_writer_ = nullptr;  // not owned
+  // Cleared if the driver fails to prefetch, e.g. because the GPU does not
+  // support concurrent access to unified memory.
+  std::atomic<bool> prefetch_unified_memory_{false};
+  // The batchers of the copies to `host_to_device_streams_`, if
+  // GPUOptions.experimental.batch_host_to_device_copies is set.
+  std::vector<std::unique_ptr<GPUHostToDeviceCopyBatcher>>
+      host_to_device_copy_batchers_;
 
   // Initialize scratch buffers used by Eigen.
   Status InitScratchBuffers();
 
+  // Makes the stream of `gpu_device_context` wait for the streams that
+  // produce the inputs of `context`.
+  void WaitForInputStreams(GPUDeviceContext* gpu_device_context,
+                           OpKernelContext* context);
+
+  // Enqueues the migration of the large inputs of `context` to the GPU on
+  // `stream_->prefetch`, if unified memory is prefetched.
+  void PrefetchInputs(OpKernelContext* context);
+
+  // Returns the batchers to pass to the device contexts.
+  gtl::InlinedVector<GPUHostToDeviceCopyBatcher*, 4>
+  host_to_device_copy_batchers() const;
+
   void ReinitializeDevice(OpKernelContext* context, PerOpGpuDevice* device,
                           int stream_id, Allocator* allocator);
 
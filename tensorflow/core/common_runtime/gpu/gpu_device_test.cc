@@ -21,12 +21,15 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_cudamallocasync_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace {
@@ -517,6 +520,110 @@ TEST_F(GPUDeviceTest, CopyTensorInSameDevice) {
   }
 }
 
+TEST_F(GPUDeviceTest, MultipleHostToDeviceStreams) {
+  SessionOptions opts = MakeSessionOptions("0");
+  opts.config.mutable_gpu_options()
+      ->mutable_experimental()
+      ->set_num_host_to_device_copy_streams(3);
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+  Device* device = devices[0].get();
+  auto* device_context = static_cast<GPUDeviceContext*>(
+      device->tensorflow_accelerator_device_info()->default_context);
+  se::Stream* streams[3] = {device_context->next_host_to_device_stream(),
+                            device_context->next_host_to_device_stream(),
+                            device_context->next_host_to_device_stream()};
+  EXPECT_NE(streams[0], streams[1]);
+  EXPECT_NE(streams[1], streams[2]);
+  EXPECT_NE(streams[0], streams[2]);
+  EXPECT_EQ(device_context->next_host_to_device_stream(), streams[0]);
+
+  // Copies that are in flight on different streams all land.
+  constexpr int kNumElements = 1 << 20;
+  constexpr int kNumTensors = 6;
+  Allocator* allocator = device->GetAllocator(AllocatorAttributes());
+  std::vector<Tensor> cpu_tensors;
+  std::vector<Tensor> gpu_tensors;
+  for (int i = 0; i < kNumTensors; ++i) {
+    cpu_tensors.emplace_back(cpu_allocator(), DT_FLOAT,
+                             TensorShape({kNumElements}));
+    InitCPUTensor(&cpu_tensors.back(), kNumElements, i);
+    gpu_tensors.emplace_back(allocator, DT_FLOAT, TensorShape({kNumElements}));
+  }
+  BlockingCounter counter(kNumTensors);
+  for (int i = 0; i < kNumTensors; ++i) {
+    device_context->CopyCPUTensorToDevice(&cpu_tensors[i], device,
+                                          &gpu_tensors[i],
+                                          [&counter](const Status& s) {
+                                            TF_ASSERT_OK(s);
+                                            counter.DecrementCount();
+                                          });
+  }
+  counter.Wait();
+  for (int i = 0; i < kNumTensors; ++i) {
+    Tensor output(cpu_allocator(), DT_FLOAT, TensorShape({kNumElements}));
+    CopyGPUToCPU(&gpu_tensors[i], &output, device, device_context);
+    auto values = output.tensor<float, 1>();
+    EXPECT_EQ(values(0), i);
+    EXPECT_EQ(values(kNumElements - 1), i);
+  }
+}
+
+TEST_F(GPUDeviceTest, BatchHostToDeviceCopies) {
+  SessionOptions opts = MakeSessionOptions("0");
+  opts.config.mutable_gpu_options()
+      ->mutable_experimental()
+      ->set_batch_host_to_device_copies(true);
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+  Device* device = devices[0].get();
+  auto* device_context = static_cast<GPUDeviceContext*>(
+      device->tensorflow_accelerator_device_info()->default_context);
+  EXPECT_NE(device_context->host_to_device_copy_batcher(
+                device_context->host_to_device_stream()),
+            nullptr);
+
+  // Small copies issued concurrently are batched, and land along with a copy
+  // too large to be batched. The sizes are not multiples of 16 bytes.
+  constexpr int kNumTensors = 64;
+  Allocator* allocator = device->GetAllocator(AllocatorAttributes());
+  std::vector<Tensor> cpu_tensors;
+  std::vector<Tensor> gpu_tensors;
+  for (int i = 0; i < kNumTensors; ++i) {
+    const int num_elements = i == 0 ? 1 << 20 : 1 + 37 * i;
+    cpu_tensors.emplace_back(cpu_allocator(), DT_FLOAT,
+                             TensorShape({num_elements}));
+    InitCPUTensor(&cpu_tensors.back(), num_elements, i);
+    gpu_tensors.emplace_back(allocator, DT_FLOAT, TensorShape({num_elements}));
+  }
+  BlockingCounter counter(kNumTensors);
+  {
+    thread::ThreadPool pool(Env::Default(), "copies", 8);
+    for (int i = 0; i < kNumTensors; ++i) {
+      pool.Schedule([&, i]() {
+        device_context->CopyCPUTensorToDevice(&cpu_tensors[i], device,
+                                              &gpu_tensors[i],
+                                              [&counter](const Status& s) {
+                                                TF_ASSERT_OK(s);
+                                                counter.DecrementCount();
+                                              });
+      });
+    }
+    counter.Wait();
+  }
+  for (int i = 0; i < kNumTensors; ++i) {
+    const int num_elements = gpu_tensors[i].NumElements();
+    Tensor output(cpu_allocator(), DT_FLOAT, TensorShape({num_elements}));
+    CopyGPUToCPU(&gpu_tensors[i], &output, device, device_context);
+    auto values = output.tensor<float, 1>();
+    for (int j = 0; j < num_elements; ++j) {
+      ASSERT_EQ(values(j), i) << "tensor " << i << ", element " << j;
+    }
+  }
+}
+
 TEST_F(GPUDeviceTest, DeviceDetails) {
   DeviceFactory* factory = DeviceFactory::GetFactory("GPU");
   std::vector<string> devices;
@@ -0,0 +1,191 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
+    (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
+
+#include "tensorflow/core/common_runtime/gpu/gpu_host_to_device_copy_batcher.h"
+
+#include <cstring>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/device/device_event_mgr.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_scatter_copy.h"
+#include "tensorflow/core/platform/logging.h"
+#if GOOGLE_CUDA
+#include "tensorflow/stream_executor/cuda/cuda_activation.h"
+#elif TENSORFLOW_USE_ROCM
+#include "tensorflow/core/platform/rocm.h"
+#endif
+
+namespace tensorflow {
+
+#if GOOGLE_CUDA
+using se::cuda::ScopedActivateExecutorContext;
+#elif TENSORFLOW_USE_ROCM
+using se::rocm::ScopedActivateExecutorContext;
+#endif
+
+namespace {
+
+// The size of the staging buffers, which bounds the bytes of a batch.
+constexpr size_t kStagingBytes = 1 << 20;
+constexpr size_t kMaxBatchSize = 256;
+// A batch starts with the descriptors of its copies.
+constexpr size_t kDescriptorBytes = kMaxBatchSize * sizeof(GpuScatterCopy);
+// The alignment of the data of each copy in the staging buffers.
+constexpr size_t kCopyAlignment = 64;
+
+static_assert(kDescriptorBytes % kCopyAlignment == 0,
+              "The data of the copies must be aligned");
+static_assert(kDescriptorBytes + GPUHostToDeviceCopyBatcher::kMaxCopyBytes <=
+                  kStagingBytes,
+              "Every copy must fit into a batch of its own");
+
+size_t AlignedSize(size_t bytes) {
+  return (bytes + kCopyAlignment - 1) / kCopyAlignment * kCopyAlignment;
+}
+
+}  // namespace
+
+GPUHostToDeviceCopyBatcher::GPUHostToDeviceCopyBatcher(
+    se::Stream* stream, EventMgr* event_mgr, Allocator* host_allocator,
+    Allocator* device_allocator)
+    : stream_(stream),
+      event_mgr_(event_mgr),
+      host_allocator_(host_allocator),
+      device_allocator_(device_allocator) {
+  device_staging_ = static_cast<char*>(
+      device_allocator_->AllocateRaw(kCopyAlignment, kStagingBytes));
+  if (device_staging_ == nullptr) {
+    LOG(WARNING) << "Could not allocate " << kStagingBytes
+                 << " bytes to stage host-to-device copies, which are "
+                    "copied one by one instead.";
+  }
+}
+
+GPUHostToDeviceCopyBatcher::~GPUHostToDeviceCopyBatcher() {
+  if (device_staging_ != nullptr) {
+    // The batches in flight may still use the staging buffer.
+    stream_->BlockHostUntilDone().IgnoreError();
+    device_allocator_->DeallocateRaw(device_staging_);
+  }
+}
+
+void GPUHostToDeviceCopyBatcher::Copy(const void* src, void* dst, size_t bytes,
+                                      std::function<void()> done) {
+  DCHECK_LE(bytes, kMaxCopyBytes);
+  {
+    mutex_lock l(mu_);
+    pending_.push_back({src, dst, bytes, std::move(done)});
+    if (issuing_) return;
+    issuing_ = true;
+  }
+  // Issues the copies that arrive meanwhile as well, so that they do not
+  // wait for the next caller.
+  while (true) {
+    std::vector<PendingCopy> batch;
+    {
+      mutex_lock l(mu_);
+      if (pending_.empty()) {
+        issuing_ = false;
+        return;
+      }
+      batch = TakeBatch();
+    }
+    Issue(std::move(batch));
+  }
+}
+
+std::vector<GPUHostToDeviceCopyBatcher::PendingCopy>
+GPUHostToDeviceCopyBatcher::TakeBatch() {
+  std::vector<PendingCopy> batch;
+  size_t staging_bytes = kDescriptorBytes;
+  while (!pending_.empty() && batch.size() < kMaxBatchSize) {
+    staging_bytes += AlignedSize(pending_.front().bytes);
+    if (staging_bytes > kStagingBytes) break;
+    batch.push_back(std::move(pending_.front()));
+    pending_.pop_front();
+  }
+  return batch;
+}
+
+void GPUHostToDeviceCopyBatcher::Issue(std::vector<PendingCopy> batch) {
+  // A single copy, or a batch without a staging buffer on the device, is
+  // copied to its destination directly.
+  const bool scatter = batch.size() > 1 && device_staging_ != nullptr;
+  size_t staging_bytes = scatter ? kDescriptorBytes : 0;
+  for (const PendingCopy& copy : batch) {
+    staging_bytes += AlignedSize(copy.bytes);
+  }
+  char* host_staging = static_cast<char*>(
+      host_allocator_->AllocateRaw(kCopyAlignment, staging_bytes));
+  if (host_staging == nullptr) {
+    // The callers keep the sources alive until the copies are done.
+    for (const PendingCopy& copy : batch) {
+      se::DeviceMemoryBase dst(copy.dst, copy.bytes);
+      stream_->ThenMemcpy(&dst, copy.src, copy.bytes);
+    }
+  } else {
+    GpuScatterCopy* descriptors =
+        reinterpret_cast<GpuScatterCopy*>(host_staging);
+    size_t offset = scatter ? kDescriptorBytes : 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+      const PendingCopy& copy = batch[i];
+      std::memcpy(host_staging + offset, copy.src, copy.bytes);
+      if (scatter) {
+        descriptors[i] = {reinterpret_cast<uint64>(copy.dst), offset,
+                          copy.bytes};
+      } else {
+        se::DeviceMemoryBase dst(copy.dst, copy.bytes);
+        stream_->ThenMemcpy(&dst, host_staging + offset, copy.bytes);
+      }
+      offset += AlignedSize(copy.bytes);
+    }
+    if (scatter) {
+      se::DeviceMemoryBase device_staging(device_staging_, staging_bytes);
+      stream_->ThenMemcpy(&device_staging, host_staging, staging_bytes);
+      ScopedActivateExecutorContext scoped_activation{stream_->parent()};
+      Status s = LaunchGpuScatterCopies(stream_, device_staging_,
+                                        static_cast<int>(batch.size()));
+      if (!s.ok()) {
+        LOG(ERROR) << "Could not scatter a batch of host-to-device copies, "
+                   << "which are copied one by one instead: " << s;
+        for (size_t i = 0; i < batch.size(); ++i) {
+          se::DeviceMemoryBase dst(batch[i].dst, batch[i].bytes);
+          stream_->ThenMemcpy(&dst, host_staging + descriptors[i].src_offset,
+                              batch[i].bytes);
+        }
+      }
+    }
+  }
+
+  se::Stream* stream = stream_;
+  Allocator* host_allocator = host_allocator_;
+  event_mgr_->ThenExecute(stream, [stream, host_allocator, host_staging,
+                                   batch = std::move(batch)]() {
+    if (host_staging != nullptr) {
+      host_allocator->DeallocateRaw(host_staging);
+    }
+    if (!stream->ok()) {
+      LOG(FATAL) << "CPU->GPU Memcpy failed";
+    }
+    for (const PendingCopy& copy : batch) copy.done();
+  });
+}
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
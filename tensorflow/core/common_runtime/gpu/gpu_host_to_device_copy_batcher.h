@@ -0,0 +1,93 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_HOST_TO_DEVICE_COPY_BATCHER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_HOST_TO_DEVICE_COPY_BATCHER_H_
+
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+class EventMgr;
+
+// Batches the small host-to-device copies of a stream.
+//
+// A copy that finds no other copy being issued to the stream is issued right
+// away, so that batching adds no latency. The copies that arrive while it is
+// being issued, e.g. the many small tensors that a step receives at once, are
+// then issued together: they are staged in one pinned host buffer, copied to
+// the device with a single DMA and scattered to their destinations by one
+// kernel, which costs far less than a DMA of its own for each copy.
+class GPUHostToDeviceCopyBatcher {
+ public:
+  // Larger copies are issued by the caller without staging them twice.
+  static constexpr size_t kMaxCopyBytes = 64 << 10;
+
+  // Does not take ownership of the arguments. `device_allocator` allocates
+  // the staging buffer on the device, and the batcher copies each copy
+  // directly if it cannot.
+  GPUHostToDeviceCopyBatcher(se::Stream* stream, EventMgr* event_mgr,
+                             Allocator* host_allocator,
+                             Allocator* device_allocator);
+  ~GPUHostToDeviceCopyBatcher();
+
+  se::Stream* stream() const { return stream_; }
+
+  // Copies the `bytes` bytes at `src` in host memory to `dst` on the device
+  // once the work enqueued on the stream so far, e.g. a wait for the stream
+  // that allocated `dst`, is done, and then calls `done`. `bytes` must be at
+  // most kMaxCopyBytes, and `src` must remain valid until `done` is called.
+  void Copy(const void* src, void* dst, size_t bytes,
+            std::function<void()> done);
+
+ private:
+  struct PendingCopy {
+    const void* src;
+    void* dst;
+    size_t bytes;
+    std::function<void()> done;
+  };
+
+  // Takes the pending copies that fit into one staging buffer.
+  std::vector<PendingCopy> TakeBatch() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void Issue(std::vector<PendingCopy> batch);
+
+  se::Stream* const stream_;
+  EventMgr* const event_mgr_;
+  Allocator* const host_allocator_;
+  Allocator* const device_allocator_;
+  // The buffer on the device that the batches are copied to, or nullptr if
+  // it could not be allocated. The stream orders the batches that use it.
+  char* device_staging_ = nullptr;
+
+  mutex mu_;
+  std::deque<PendingCopy> pending_ TF_GUARDED_BY(mu_);
+  // Whether a thread is issuing the pending copies.
+  bool issuing_ TF_GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GPUHostToDeviceCopyBatcher);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_HOST_TO_DEVICE_COPY_BATCHER_H_
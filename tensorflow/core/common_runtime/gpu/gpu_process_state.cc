@@ -305,12 +305,12 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
     tf_shared_lock lock(mu_);
 
     if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types &&
-        !gpu_host_allocators_.empty() &&
-        gpu_host_allocators_[0].recording_allocator != nullptr) {
-      return gpu_host_allocators_[0].recording_allocator.get();
+        static_cast<int>(gpu_host_allocators_.size()) > numa_node &&
+        gpu_host_allocators_[numa_node].recording_allocator != nullptr) {
+      return gpu_host_allocators_[numa_node].recording_allocator.get();
     }
     if (static_cast<int>(gpu_host_allocators_.size()) > numa_node) {
-      return gpu_host_allocators_[0].allocator.get();
+      return gpu_host_allocators_[numa_node].allocator.get();
     }
   }
 
@@ -335,15 +335,18 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
   CHECK_NE(nullptr, se);
 
   while (static_cast<int>(gpu_host_allocators_.size()) <= numa_node) {
-    while (gpu_host_alloc_visitors_.size() <= numa_node) {
+    // Each NUMA node has its own pool, so that devices stage their copies in
+    // the memory of the node they are attached to.
+    const int node = gpu_host_allocators_.size();
+    while (gpu_host_alloc_visitors_.size() <= node) {
       gpu_host_alloc_visitors_.push_back({});
     }
-    while (gpu_host_free_visitors_.size() <= numa_node) {
+    while (gpu_host_free_visitors_.size() <= node) {
       gpu_host_free_visitors_.push_back({});
     }
     SubAllocator* sub_allocator = new DeviceHostAllocator(
-        se, numa_node, gpu_host_alloc_visitors_[numa_node],
-        gpu_host_free_visitors_[numa_node]);
+        se, node, gpu_host_alloc_visitors_[node],
+        gpu_host_free_visitors_[node]);
     // TODO(zheng-xq): evaluate whether 64GB by default is the best choice.
     int64_t gpu_host_mem_limit_in_mb = -1;
     Status status = ReadInt64FromEnvVar("TF_GPU_HOST_MEM_LIMIT_IN_MB",
@@ -383,9 +386,9 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
     }
   }
   if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types) {
-    return gpu_host_allocators_[0].recording_allocator.get();
+    return gpu_host_allocators_[numa_node].recording_allocator.get();
   } else {
-    return gpu_host_allocators_[0].allocator.get();
+    return gpu_host_allocators_[numa_node].allocator.get();
   }
 }
 
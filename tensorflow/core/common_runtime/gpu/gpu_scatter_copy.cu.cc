@@ -0,0 +1,70 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include <algorithm>
+
+#include "tensorflow/core/common_runtime/gpu/gpu_scatter_copy.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+#include "tensorflow/stream_executor/gpu/gpu_stream.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kThreadsPerBlock = 256;
+constexpr int kMaxBlocks = 1024;
+
+// Each block performs one copy at a time, in 16-byte words if the destination
+// is aligned and byte by byte otherwise.
+__global__ void GpuScatterCopyKernel(const char* staging, int num_copies) {
+  const GpuScatterCopy* copies =
+      reinterpret_cast<const GpuScatterCopy*>(staging);
+  for (int i = blockIdx.x; i < num_copies; i += gridDim.x) {
+    const GpuScatterCopy copy = copies[i];
+    const char* src = staging + copy.src_offset;
+    char* dst = reinterpret_cast<char*>(copy.dst);
+    uint64 begin = 0;
+    if (copy.dst % sizeof(uint4) == 0) {
+      const uint64 num_words = copy.bytes / sizeof(uint4);
+      const uint4* src_words = reinterpret_cast<const uint4*>(src);
+      uint4* dst_words = reinterpret_cast<uint4*>(dst);
+      for (uint64 j = threadIdx.x; j < num_words; j += blockDim.x) {
+        dst_words[j] = src_words[j];
+      }
+      begin = num_words * sizeof(uint4);
+    }
+    for (uint64 j = begin + threadIdx.x; j < copy.bytes; j += blockDim.x) {
+      dst[j] = src[j];
+    }
+  }
+}
+
+}  // namespace
+
+Status LaunchGpuScatterCopies(se::Stream* stream, const char* staging,
+                              int num_copies) {
+  if (num_copies <= 0) return Status::OK();
+  return GpuLaunchKernel(GpuScatterCopyKernel,
+                         std::min(num_copies, kMaxBlocks), kThreadsPerBlock, 0,
+                         se::gpu::AsGpuStreamValue(stream), staging,
+                         num_copies);
+}
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
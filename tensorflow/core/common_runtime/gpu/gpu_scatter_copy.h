@@ -0,0 +1,40 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_SCATTER_COPY_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_SCATTER_COPY_H_
+
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A copy of `bytes` bytes at `src_offset` in a staging buffer to `dst`.
+struct GpuScatterCopy {
+  uint64 dst;
+  uint64 src_offset;
+  uint64 bytes;
+};
+
+// Launches a kernel on `stream` that performs the `num_copies` copies whose
+// descriptors are at the start of `staging`, a buffer on the device whose
+// offsets are multiples of 16. The context of the stream must be active.
+Status LaunchGpuScatterCopies(se::Stream* stream, const char* staging,
+                              int num_copies);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_SCATTER_COPY_H_
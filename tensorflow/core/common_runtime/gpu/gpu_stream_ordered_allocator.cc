@@ -0,0 +1,241 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_ordered_allocator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+thread_local const GPUStreamOrderedAllocator* current_allocator = nullptr;
+thread_local int current_stream_id = -1;
+thread_local bool in_stream_callback = false;
+
+// The largest fraction of a reused chunk that may be left unused.
+constexpr size_t kMaxReuseWasteFraction = 4;
+
+}  // namespace
+
+GPUStreamOrderedAllocator::ScopedStream::ScopedStream(
+    GPUStreamOrderedAllocator* allocator, int stream_id)
+    : previous_allocator_(current_allocator),
+      previous_stream_id_(current_stream_id) {
+  current_allocator = allocator;
+  current_stream_id = stream_id;
+}
+
+GPUStreamOrderedAllocator::ScopedStream::~ScopedStream() {
+  current_allocator = previous_allocator_;
+  current_stream_id = previous_stream_id_;
+}
+
+GPUStreamOrderedAllocator::ScopedInStreamCallback::ScopedInStreamCallback()
+    : previous_(in_stream_callback) {
+  in_stream_callback = true;
+}
+
+GPUStreamOrderedAllocator::ScopedInStreamCallback::~ScopedInStreamCallback() {
+  in_stream_callback = previous_;
+}
+
+GPUStreamOrderedAllocator::GPUStreamOrderedAllocator(
+    Allocator* allocator, gtl::InlinedVector<se::Stream*, 4> streams)
+    : allocator_(allocator),
+      streams_(std::move(streams)),
+      all_streams_(streams_.size() >= 32 ? ~0u
+                                         : (1u << streams_.size()) - 1),
+      free_lists_(streams_.size()) {
+  CHECK_LE(streams_.size(), 32u);
+}
+
+GPUStreamOrderedAllocator::~GPUStreamOrderedAllocator() {
+  ReleaseAll();
+  mutex_lock l(mu_);
+  for (se::Event* event : free_events_) delete event;
+}
+
+void GPUStreamOrderedAllocator::RecordStreamUse(const void* ptr,
+                                                int stream_id) {
+  DCHECK_LT(static_cast<size_t>(stream_id), streams_.size());
+  mutex_lock l(mu_);
+  auto it = allocations_.find(const_cast<void*>(ptr));
+  if (it != allocations_.end()) it->second.used_streams |= 1u << stream_id;
+}
+
+void* GPUStreamOrderedAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  const int stream_id = current_allocator == this ? current_stream_id : -1;
+  std::vector<void*> to_release;
+  void* ptr = nullptr;
+  bool has_freed_chunks;
+  {
+    mutex_lock l(mu_);
+    for (void* freed : deferred_frees_) FreeLocked(freed, &to_release);
+    deferred_frees_.clear();
+    PollLocked(&to_release);
+    if (stream_id >= 0) ptr = ReuseLocked(stream_id, alignment, num_bytes);
+    has_freed_chunks = !pending_.empty();
+  }
+  Release(to_release);
+
+  if (ptr == nullptr) {
+    if (has_freed_chunks) {
+      // Return the freed chunks before waiting for memory.
+      AllocationAttributes no_retry(/*retry_on_failure=*/false,
+                                    allocation_attr.allocation_will_be_logged,
+                                    allocation_attr.freed_by_func);
+      ptr = allocator_->AllocateRaw(alignment, num_bytes, no_retry);
+      if (ptr == nullptr) ReleaseAll();
+    }
+    if (ptr == nullptr) {
+      ptr = allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+    }
+    if (ptr == nullptr) return nullptr;
+  }
+  mutex_lock l(mu_);
+  allocations_[ptr] = {stream_id,
+                       stream_id >= 0 ? 1u << stream_id : all_streams_};
+  return ptr;
+}
+
+void GPUStreamOrderedAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  std::vector<void*> to_release;
+  {
+    mutex_lock l(mu_);
+    if (in_stream_callback) {
+      deferred_frees_.push_back(ptr);
+      return;
+    }
+    FreeLocked(ptr, &to_release);
+    PollLocked(&to_release);
+  }
+  Release(to_release);
+}
+
+void GPUStreamOrderedAllocator::FreeLocked(void* ptr,
+                                           std::vector<void*>* to_release) {
+  auto it = allocations_.find(ptr);
+  if (it == allocations_.end()) {
+    // Allocated before this allocator wrapped `allocator_`.
+    to_release->push_back(ptr);
+    return;
+  }
+  const Allocation allocation = it->second;
+  allocations_.erase(it);
+
+  FreedChunk* chunk = new FreedChunk;
+  chunk->ptr = ptr;
+  for (size_t i = 0; i < streams_.size(); ++i) {
+    if ((allocation.used_streams & (1u << i)) == 0) continue;
+    se::Event* event;
+    if (free_events_.empty()) {
+      event = new se::Event(streams_[i]->parent());
+      event->Init();
+    } else {
+      event = free_events_.back();
+      free_events_.pop_back();
+    }
+    streams_[i]->ThenRecordEvent(event);
+    chunk->events.push_back(event);
+  }
+  if (allocation.stream_id >= 0 &&
+      allocation.used_streams == 1u << allocation.stream_id &&
+      allocator_->TracksAllocationSizes()) {
+    chunk->stream_id = allocation.stream_id;
+    chunk->in_free_list = true;
+    chunk->free_list_it = free_lists_[allocation.stream_id].emplace(
+        allocator_->AllocatedSize(ptr), chunk);
+  }
+  pending_.push_back(chunk);
+}
+
+void GPUStreamOrderedAllocator::PollLocked(std::vector<void*>* to_release) {
+  while (!pending_.empty()) {
+    FreedChunk* chunk = pending_.front();
+    bool complete = true;
+    for (se::Event* event : chunk->events) {
+      const se::Event::Status status = event->PollForStatus();
+      if (status == se::Event::Status::kPending) {
+        complete = false;
+        break;
+      }
+      if (status != se::Event::Status::kComplete) {
+        LOG(ERROR) << "Unexpected Event status: " << static_cast<int>(status);
+      }
+    }
+    // Sweep up to the first chunk that is still in use, as EventMgr does.
+    if (!complete) break;
+    free_events_.insert(free_events_.end(), chunk->events.begin(),
+                        chunk->events.end());
+    if (!chunk->reused) {
+      if (chunk->in_free_list) {
+        free_lists_[chunk->stream_id].erase(chunk->free_list_it);
+      }
+      to_release->push_back(chunk->ptr);
+    }
+    delete chunk;
+    pending_.pop_front();
+  }
+}
+
+void* GPUStreamOrderedAllocator::ReuseLocked(int stream_id, size_t alignment,
+                                             size_t num_bytes) {
+  std::multimap<size_t, FreedChunk*>& free_list = free_lists_[stream_id];
+  const size_t max_bytes =
+      num_bytes + std::max<size_t>(num_bytes / kMaxReuseWasteFraction, 256);
+  for (auto it = free_list.lower_bound(num_bytes);
+       it != free_list.end() && it->first <= max_bytes; ++it) {
+    FreedChunk* chunk = it->second;
+    if (reinterpret_cast<uintptr_t>(chunk->ptr) % alignment != 0) continue;
+    free_list.erase(it);
+    chunk->in_free_list = false;
+    chunk->reused = true;
+    return chunk->ptr;
+  }
+  return nullptr;
+}
+
+void GPUStreamOrderedAllocator::ReleaseAll() {
+  std::vector<void*> to_release;
+  {
+    mutex_lock l(mu_);
+    for (void* freed : deferred_frees_) FreeLocked(freed, &to_release);
+    deferred_frees_.clear();
+  }
+  // Once the streams are done, the events of all chunks freed so far have
+  // completed.
+  for (se::Stream* stream : streams_) {
+    Status status = stream->BlockHostUntilDone();
+    if (!status.ok()) LOG(ERROR) << "Failed to synchronize stream: " << status;
+  }
+  {
+    mutex_lock l(mu_);
+    PollLocked(&to_release);
+  }
+  Release(to_release);
+}
+
+void GPUStreamOrderedAllocator::Release(const std::vector<void*>& to_release) {
+  for (void* ptr : to_release) allocator_->DeallocateRaw(ptr);
+}
+
+}  // namespace tensorflow
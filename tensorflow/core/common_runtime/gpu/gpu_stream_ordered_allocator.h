@@ -0,0 +1,184 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_ORDERED_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_ORDERED_ALLOCATOR_H_
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Gives the allocator of a GPU device that runs kernels on several compute
+// streams stream-ordered semantics.
+//
+// The allocator of a device reuses freed memory right away, which is only
+// safe while the kernels that used the memory are ordered before the kernels
+// that reuse it. This allocator instead keeps freed memory until the streams
+// that used it have reached the point of the free:
+//
+// - Memory that only the stream that allocated it used goes to the free list
+//   of that stream, from which the stream can reuse it right away, since the
+//   stream runs the kernels that reuse the memory after the kernels that used
+//   it.
+// - All freed memory returns to the wrapped allocator once the events that
+//   were recorded at the time of the free on the streams that used it have
+//   completed, unless its stream reused it before.
+//
+// The stream of an allocation is the one set by ScopedStream on the calling
+// thread, i.e. the stream of the kernel that is running. Memory allocated
+// without a stream is taken to be used by all streams. Kernels that use
+// memory allocated on another stream must call RecordStreamUse().
+class GPUStreamOrderedAllocator : public Allocator {
+ public:
+  // Does not take ownership of `allocator` or `streams`. There must be at
+  // most 32 streams.
+  GPUStreamOrderedAllocator(Allocator* allocator,
+                            gtl::InlinedVector<se::Stream*, 4> streams);
+  ~GPUStreamOrderedAllocator() override;
+
+  // Sets the stream of the allocations that the calling thread makes with
+  // `allocator`, which may be nullptr, for the lifetime of the object.
+  class ScopedStream {
+   public:
+    ScopedStream(GPUStreamOrderedAllocator* allocator, int stream_id);
+    ~ScopedStream();
+
+   private:
+    const GPUStreamOrderedAllocator* const previous_allocator_;
+    const int previous_stream_id_;
+
+    TF_DISALLOW_COPY_AND_ASSIGN(ScopedStream);
+  };
+
+  // Marks the calling thread as a stream callback, which must not call into
+  // the driver, for the lifetime of the object. The events of the
+  // deallocations it makes are recorded by the next call on another thread.
+  class ScopedInStreamCallback {
+   public:
+    ScopedInStreamCallback();
+    ~ScopedInStreamCallback();
+
+   private:
+    const bool previous_;
+
+    TF_DISALLOW_COPY_AND_ASSIGN(ScopedInStreamCallback);
+  };
+
+  // Records that the kernels of `stream_id` use `ptr`, which was returned by
+  // AllocateRaw().
+  void RecordStreamUse(const void* ptr, int stream_id);
+
+  std::string Name() override { return allocator_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+  bool TracksAllocationSizes() const override {
+    return allocator_->TracksAllocationSizes();
+  }
+  size_t RequestedSize(const void* ptr) const override {
+    return allocator_->RequestedSize(ptr);
+  }
+  size_t AllocatedSize(const void* ptr) const override {
+    return allocator_->AllocatedSize(ptr);
+  }
+  int64_t AllocationId(const void* ptr) const override {
+    return allocator_->AllocationId(ptr);
+  }
+  absl::optional<AllocatorStats> GetStats() override {
+    return allocator_->GetStats();
+  }
+  bool ClearStats() override { return allocator_->ClearStats(); }
+  void SetSafeFrontier(uint64 count) override {
+    allocator_->SetSafeFrontier(count);
+  }
+  AllocatorMemoryType GetMemoryType() const override {
+    return allocator_->GetMemoryType();
+  }
+
+ private:
+  struct Allocation {
+    // The stream that allocated the memory, or -1.
+    int stream_id;
+    // The mask of the streams that use the memory.
+    uint32 used_streams;
+  };
+
+  struct FreedChunk {
+    void* ptr;
+    // The stream whose free list holds the chunk, if any.
+    int stream_id = -1;
+    std::vector<se::Event*> events;
+    // Set while the chunk is in the free list of its stream.
+    bool in_free_list = false;
+    // Set once its stream reused the chunk.
+    bool reused = false;
+    std::multimap<size_t, FreedChunk*>::iterator free_list_it;
+  };
+
+  // Records the events of the deallocation of `ptr`, and adds it to the free
+  // list of its stream if only that stream used it.
+  void FreeLocked(void* ptr, std::vector<void*>* to_release)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Appends the chunks whose events completed to `*to_release`, in the order
+  // of their deallocation.
+  void PollLocked(std::vector<void*>* to_release)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns a chunk of at least `num_bytes` from the free list of
+  // `stream_id`, or nullptr.
+  void* ReuseLocked(int stream_id, size_t alignment, size_t num_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Waits for all streams and returns all freed chunks to `allocator_`.
+  void ReleaseAll();
+
+  void Release(const std::vector<void*>& to_release);
+
+  Allocator* const allocator_;  // Not owned.
+  const gtl::InlinedVector<se::Stream*, 4> streams_;
+  const uint32 all_streams_;
+
+  mutex mu_;
+  absl::flat_hash_map<void*, Allocation> allocations_ TF_GUARDED_BY(mu_);
+  // The free list of each stream, by chunk size.
+  std::vector<std::multimap<size_t, FreedChunk*>> free_lists_
+      TF_GUARDED_BY(mu_);
+  // The freed chunks that wait for their events, oldest first.
+  std::deque<FreedChunk*> pending_ TF_GUARDED_BY(mu_);
+  // The deallocations made in stream callbacks.
+  std::vector<void*> deferred_frees_ TF_GUARDED_BY(mu_);
+  std::vector<se::Event*> free_events_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GPUStreamOrderedAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_ORDERED_ALLOCATOR_H_
@@ -0,0 +1,154 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_ordered_allocator.h"
+
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Allocates host memory, which is enough since the tests don't access it.
+class FakeAllocator : public Allocator {
+ public:
+  std::string Name() override { return "fake"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    void* ptr = port::AlignedMalloc(num_bytes, alignment);
+    mutex_lock l(mu_);
+    sizes_[ptr] = num_bytes;
+    return ptr;
+  }
+  void DeallocateRaw(void* ptr) override {
+    {
+      mutex_lock l(mu_);
+      sizes_.erase(ptr);
+      ++num_deallocations_;
+    }
+    port::AlignedFree(ptr);
+  }
+  bool TracksAllocationSizes() const override { return true; }
+  size_t RequestedSize(const void* ptr) const override {
+    mutex_lock l(mu_);
+    return sizes_.at(const_cast<void*>(ptr));
+  }
+  int num_deallocations() const {
+    mutex_lock l(mu_);
+    return num_deallocations_;
+  }
+
+ private:
+  mutable mutex mu_;
+  absl::flat_hash_map<void*, size_t> sizes_ TF_GUARDED_BY(mu_);
+  int num_deallocations_ TF_GUARDED_BY(mu_) = 0;
+};
+
+class GPUStreamOrderedAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    se::StreamExecutor* executor =
+        GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+    for (int i = 0; i < 2; ++i) {
+      streams_.emplace_back(new se::Stream(executor));
+      streams_.back()->Init();
+    }
+    allocator_.reset(new GPUStreamOrderedAllocator(
+        &base_, {streams_[0].get(), streams_[1].get()}));
+  }
+
+  // Keeps `stream` busy until `done` is notified.
+  void Block(int stream, Notification* done) {
+    streams_[stream]->ThenDoHostCallback(
+        [done]() { done->WaitForNotification(); });
+  }
+
+  FakeAllocator base_;
+  std::vector<std::unique_ptr<se::Stream>> streams_;
+  std::unique_ptr<GPUStreamOrderedAllocator> allocator_;
+};
+
+TEST_F(GPUStreamOrderedAllocatorTest, SameStreamReusesMemory) {
+  Notification done;
+  Block(0, &done);
+  {
+    GPUStreamOrderedAllocator::ScopedStream scoped_stream(allocator_.get(), 0);
+    void* ptr = allocator_->AllocateRaw(64, 1024);
+    allocator_->DeallocateRaw(ptr);
+    EXPECT_EQ(allocator_->AllocateRaw(64, 1000), ptr);
+    allocator_->DeallocateRaw(ptr);
+  }
+  EXPECT_EQ(base_.num_deallocations(), 0);
+  done.Notify();
+  allocator_.reset();
+  EXPECT_EQ(base_.num_deallocations(), 1);
+}
+
+TEST_F(GPUStreamOrderedAllocatorTest, OtherStreamWaitsForEvents) {
+  Notification done;
+  Block(0, &done);
+  void* ptr;
+  {
+    GPUStreamOrderedAllocator::ScopedStream scoped_stream(allocator_.get(), 0);
+    ptr = allocator_->AllocateRaw(64, 1024);
+    allocator_->DeallocateRaw(ptr);
+  }
+  {
+    GPUStreamOrderedAllocator::ScopedStream scoped_stream(allocator_.get(), 1);
+    void* other = allocator_->AllocateRaw(64, 1024);
+    EXPECT_NE(other, ptr);
+    allocator_->DeallocateRaw(other);
+  }
+  EXPECT_EQ(base_.num_deallocations(), 0);
+  done.Notify();
+  allocator_.reset();
+  EXPECT_EQ(base_.num_deallocations(), 2);
+}
+
+TEST_F(GPUStreamOrderedAllocatorTest, CrossStreamUseIsNotReused) {
+  Notification done;
+  Block(0, &done);
+  Block(1, &done);
+  GPUStreamOrderedAllocator::ScopedStream scoped_stream(allocator_.get(), 0);
+  void* ptr = allocator_->AllocateRaw(64, 1024);
+  allocator_->RecordStreamUse(ptr, 1);
+  allocator_->DeallocateRaw(ptr);
+  void* other = allocator_->AllocateRaw(64, 1024);
+  EXPECT_NE(other, ptr);
+  allocator_->DeallocateRaw(other);
+  done.Notify();
+}
+
+TEST_F(GPUStreamOrderedAllocatorTest, ReleasesAfterEvents) {
+  void* ptr = allocator_->AllocateRaw(64, 1024);
+  allocator_->DeallocateRaw(ptr);
+  ASSERT_TRUE(streams_[0]->BlockHostUntilDone().ok());
+  ASSERT_TRUE(streams_[1]->BlockHostUntilDone().ok());
+  // The next call polls the events of the deallocation.
+  allocator_->DeallocateRaw(allocator_->AllocateRaw(64, 1024));
+  EXPECT_GE(base_.num_deallocations(), 1);
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -0,0 +1,78 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+namespace {
+
+// Returns true if `node` must run on stream 0.
+bool MustRunOnFirstStream(const Node* node) {
+  if (!node->IsOp() || node->IsSend() || node->IsRecv() || node->IsArg() ||
+      node->IsRetval() || node->IsControlFlow() || node->IsCollective()) {
+    return true;
+  }
+  if (absl::StartsWith(node->type_string(), "Nccl") ||
+      absl::StartsWith(node->type_string(), "Collective")) {
+    return true;
+  }
+  for (const DataType dtype : node->input_types()) {
+    if (IsRefType(dtype) || dtype == DT_RESOURCE) return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
+                     std::vector<int>* node_to_stream) {
+  if (opts.max_streams < 1) {
+    return errors::InvalidArgument("max_streams must be positive, got ",
+                                   opts.max_streams);
+  }
+  node_to_stream->assign(graph->num_node_ids(), 0);
+  std::vector<Node*> order;
+  GetReversePostOrder(*graph, &order);
+  int next_stream = 0;
+  for (const Node* node : order) {
+    int& stream = (*node_to_stream)[node->id()];
+    if (opts.max_streams == 1 || MustRunOnFirstStream(node)) {
+      stream = 0;
+      continue;
+    }
+    stream = -1;
+    for (const Edge* edge : node->in_edges()) {
+      if (edge->IsControlEdge() || !edge->src()->IsOp()) continue;
+      if (edge->src()->out_edges().size() == 1) {
+        stream = (*node_to_stream)[edge->src()->id()];
+        break;
+      }
+    }
+    if (stream < 0) {
+      stream = next_stream;
+      next_stream = (next_stream + 1) % opts.max_streams;
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
@@ -0,0 +1,97 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/cc/ops/state_ops.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+namespace {
+
+TEST(GpuStreamUtilTest, OneStream) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  auto a = ops::Const(root.WithOpName("a"), 1.0f, {2});
+  auto b = ops::Neg(root.WithOpName("b"), a);
+  Graph graph(OpRegistry::Global());
+  TF_ASSERT_OK(root.ToGraph(&graph));
+
+  std::vector<int> node_to_stream;
+  TF_ASSERT_OK(AssignStreams(&graph, AssignStreamsOpts(), &node_to_stream));
+  ASSERT_EQ(node_to_stream.size(), graph.num_node_ids());
+  for (const int stream : node_to_stream) EXPECT_EQ(stream, 0);
+}
+
+TEST(GpuStreamUtilTest, InvalidMaxStreams) {
+  Graph graph(OpRegistry::Global());
+  AssignStreamsOpts opts;
+  opts.max_streams = 0;
+  std::vector<int> node_to_stream;
+  EXPECT_FALSE(AssignStreams(&graph, opts, &node_to_stream).ok());
+}
+
+TEST(GpuStreamUtilTest, ChainsShareStreams) {
+  // Two independent chains a -> b -> c and x -> y -> z.
+  Scope root = Scope::NewRootScope().ExitOnError();
+  auto a = ops::Const(root.WithOpName("a"), 1.0f, {2});
+  auto b = ops::Neg(root.WithOpName("b"), a);
+  auto c = ops::Neg(root.WithOpName("c"), b);
+  auto x = ops::Const(root.WithOpName("x"), 1.0f, {2});
+  auto y = ops::Neg(root.WithOpName("y"), x);
+  auto z = ops::Neg(root.WithOpName("z"), y);
+  Graph graph(OpRegistry::Global());
+  TF_ASSERT_OK(root.ToGraph(&graph));
+
+  AssignStreamsOpts opts;
+  opts.max_streams = 2;
+  std::vector<int> node_to_stream;
+  TF_ASSERT_OK(AssignStreams(&graph, opts, &node_to_stream));
+  std::map<string, int> streams;
+  for (const Node* node : graph.op_nodes()) {
+    streams[node->name()] = node_to_stream[node->id()];
+  }
+  EXPECT_EQ(streams["a"], streams["b"]);
+  EXPECT_EQ(streams["b"], streams["c"]);
+  EXPECT_EQ(streams["x"], streams["y"]);
+  EXPECT_EQ(streams["y"], streams["z"]);
+  EXPECT_NE(streams["a"], streams["x"]);
+}
+
+TEST(GpuStreamUtilTest, RefInputsUseFirstStream) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  auto v = ops::Variable(root.WithOpName("v"), {2}, DT_FLOAT);
+  auto one = ops::Const(root.WithOpName("one"), 1.0f, {2});
+  auto add = ops::AssignAdd(root.WithOpName("add"), v, one);
+  Graph graph(OpRegistry::Global());
+  TF_ASSERT_OK(root.ToGraph(&graph));
+
+  AssignStreamsOpts opts;
+  opts.max_streams = 4;
+  std::vector<int> node_to_stream;
+  TF_ASSERT_OK(AssignStreams(&graph, opts, &node_to_stream));
+  for (const Node* node : graph.op_nodes()) {
+    if (node->name() == "add") EXPECT_EQ(node_to_stream[node->id()], 0);
+  }
+}
+
+}  // namespace
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
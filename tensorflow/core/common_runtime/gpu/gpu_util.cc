@@ -19,8 +19,10 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_host_to_device_copy_batcher.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_reference.h"
@@ -30,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/tensor_coding.h"
@@ -148,7 +151,8 @@ void GPUUtil::SetProtoFromGPU(const Tensor& tensor, Device* dev,
   const int64_t total_bytes = is_dead ? 0 : tensor.TotalBytes();
   if (total_bytes > 0) {
     profiler::ScopedAnnotation annotation("SetProtoFromGPU");
-    alloc = GPUProcessState::singleton()->GetGpuHostAllocator(0);
+    alloc = GPUProcessState::singleton()->GetGpuHostAllocator(
+        dev->attributes().locality().numa_node());
     buf = static_cast<char*>(
         alloc->AllocateRaw(Allocator::kAllocatorAlignment, total_bytes));
     if (LogMemory::IsEnabled()) {
@@ -322,9 +326,10 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
     return;
   }
 
+  const GPUDeviceContext* gpu_device_context =
+      static_cast<const GPUDeviceContext*>(device_context);
   auto recv_host_to_device_stream =
-      static_cast<const GPUDeviceContext*>(device_context)
-          ->host_to_device_stream();
+      gpu_device_context->next_host_to_device_stream();
   if (recv_host_to_device_stream == nullptr) {
     done(errors::Internal("No send gpu copy-out-stream is available."));
     return;
@@ -336,12 +341,33 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
 
   const int64_t total_bytes = cpu_tensor->TotalBytes();
 
+  // Small copies are batched with the other copies to the stream, if any.
+  GPUHostToDeviceCopyBatcher* batcher =
+      gpu_device_context->host_to_device_copy_batcher(
+          recv_host_to_device_stream);
+  if (batcher != nullptr && total_bytes > 0 &&
+      total_bytes <= GPUHostToDeviceCopyBatcher::kMaxCopyBytes) {
+    // Use of cpu_tensor may outlive stack scope, so keep a ref.
+    TensorReference input_ref(*cpu_tensor);
+    const uint64 start_us = Env::Default()->NowMicros();
+    batcher->Copy(GetBase(cpu_tensor), GetBase(gpu_tensor), total_bytes,
+                  [done, input_ref, gpu_device, total_bytes, start_us]() {
+                    input_ref.Unref();
+                    metrics::RecordGpuHostToDeviceCopy(
+                        gpu_device->name(), total_bytes,
+                        Env::Default()->NowMicros() - start_us);
+                    done(Status::OK());
+                  });
+    return;
+  }
+
   bool do_staging = false;
   void* staging_buffer = nullptr;
   Allocator* host_memory_allocator = device_context->host_memory_allocator();
 
   // Use of cpu_tensor may outlive stack scope, so keep a ref.
   TensorReference input_ref(*cpu_tensor);
+  const uint64 start_us = Env::Default()->NowMicros();
 
   // Note that 0-size tensors have no backing buffer.
   if (total_bytes > 0) {
@@ -376,7 +402,7 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
   dev_info->event_mgr->ThenExecute(
       recv_host_to_device_stream,
       [recv_host_to_device_stream, done, input_ref, do_staging, staging_buffer,
-       host_memory_allocator]() {
+       host_memory_allocator, gpu_device, total_bytes, start_us]() {
         if (do_staging) {
           host_memory_allocator->DeallocateRaw(staging_buffer);
         } else {
@@ -385,6 +411,11 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
         if (!recv_host_to_device_stream->ok()) {
           LOG(FATAL) << "CPU->GPU Memcpy failed";
         }
+        if (total_bytes > 0) {
+          metrics::RecordGpuHostToDeviceCopy(
+              gpu_device->name(), total_bytes,
+              Env::Default()->NowMicros() - start_us);
+        }
         done(Status::OK());
       });
 }
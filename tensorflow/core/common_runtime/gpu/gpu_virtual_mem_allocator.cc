@@ -147,25 +147,37 @@ void* GpuVirtualMemAllocator::Alloc(size_t alignment, size_t num_bytes,
     return nullptr;
   }
 
-  // Create physical memory backing allocation.
-  auto maybe_handle =
-      GpuDriver::CreateMemoryHandle(&gpu_context_, padded_bytes);
-  if (!maybe_handle.ok()) {
-    LOG(ERROR) << maybe_handle.status();
-    return nullptr;
-  }
-  GpuDriver::GenericMemoryHandle handle = std::move(maybe_handle).ValueOrDie();
-
-  // Map VAs for this physical memory.
-  auto status =
-      GpuDriver::MapMemory(&gpu_context_, next_va, handle, access_gpu_handles_);
-  if (!status.ok()) {
-    LOG(ERROR) << status;
-    GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(handle));
-    return nullptr;
+  // Back the allocation with one physical memory handle per granule, so that
+  // Free can later release any granule-aligned range of it.
+  const size_t first_mapping = mappings_.size();
+  for (size_t offset = 0; offset < padded_bytes; offset += granularity_) {
+    auto maybe_handle =
+        GpuDriver::CreateMemoryHandle(&gpu_context_, granularity_);
+    auto status = maybe_handle.status();
+    if (status.ok()) {
+      // Map VAs for this physical memory.
+      status = GpuDriver::MapMemory(&gpu_context_, next_va + offset,
+                                    maybe_handle.ValueOrDie(),
+                                    access_gpu_handles_);
+      if (!status.ok()) {
+        GpuDriver::ReleaseMemoryHandle(
+            &gpu_context_, std::move(maybe_handle).ValueOrDie());
+      }
+    }
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+      for (auto it = mappings_.begin() + first_mapping; it != mappings_.end();
+           ++it) {
+        GpuDriver::UnmapMemory(&gpu_context_, it->va, it->physical.bytes);
+        GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(it->physical));
+      }
+      mappings_.erase(mappings_.begin() + first_mapping, mappings_.end());
+      return nullptr;
+    }
+    mappings_.push_back(
+        {next_va + offset, std::move(maybe_handle).ValueOrDie()});
   }
-  next_alloc_offset_ += handle.bytes;
-  mappings_.push_back({next_va, std::move(handle)});
+  next_alloc_offset_ += padded_bytes;
   VisitAlloc(reinterpret_cast<void*>(next_va), gpu_id_.value(), padded_bytes);
   *bytes_received = padded_bytes;
   return reinterpret_cast<void*>(next_va);
@@ -187,7 +199,7 @@ void GpuVirtualMemAllocator::Free(void* ptr, size_t num_bytes) {
   }
 
   int num_mappings_to_free = 0;
-  int total_bytes = 0;
+  size_t total_bytes = 0;
   for (auto it = mapping_it; it != mappings_.end() && total_bytes < num_bytes;
        ++it) {
     ++num_mappings_to_free;
@@ -196,7 +208,17 @@ void GpuVirtualMemAllocator::Free(void* ptr, size_t num_bytes) {
   if (total_bytes != num_bytes) {
     LOG(ERROR) << "Invalid size requested for freeing GPU vmem mapping. Got "
                << strings::HumanReadableNumBytes(num_bytes) << " but expected "
-               << strings::HumanReadableNumBytes(mapping_it->physical.bytes);
+               << strings::HumanReadableNumBytes(total_bytes);
+    return;
+  }
+
+  // The BFC allocator hands back the memory of chunks that were freed on the
+  // host while work using them may still be queued on the device, so wait for
+  // that work before unmapping the pages.
+  if (!GpuDriver::SynchronizeContext(&gpu_context_)) {
+    LOG(ERROR) << "Could not synchronize the GPU context before freeing GPU "
+                  "vmem mappings at "
+               << reinterpret_cast<uintptr_t>(ptr);
     return;
   }
 
@@ -64,12 +64,18 @@ class GpuVirtualMemAllocator : public SubAllocator {
   // next_alloc_offset_. To accommodate this, the virtual_address_space_size
   // should be much larger than the max physical size of the allocator.
   //
-  // In practice, since the BFC allocator coalesces adjacent AllocationRegions,
-  // this free function should never be invoked.
+  // Since the BFC allocator coalesces adjacent AllocationRegions, this is only
+  // invoked to release the granules backing free chunks (see
+  // FreeGranularity), which a fragmented allocator does to remap the memory at
+  // the end of the virtual address space. It synchronizes the GPU context.
   void Free(void* ptr, size_t num_bytes) override;
 
   bool SupportsCoalescing() const override { return true; }
 
+  // Every granule is backed by its own physical memory handle, so any
+  // granule-aligned range can be freed.
+  size_t FreeGranularity() const override { return granularity_; }
+
  private:
   GpuVirtualMemAllocator(
       const std::vector<Visitor>& alloc_visitors,
@@ -101,7 +107,7 @@ class GpuVirtualMemAllocator : public SubAllocator {
     stream_executor::gpu::GpuDevicePtr va;
     stream_executor::gpu::GpuDriver::GenericMemoryHandle physical;
   };
-  // List of mappings, sorted by va.
+  // List of mappings of one granule each, sorted by va.
   std::vector<Mapping> mappings_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(GpuVirtualMemAllocator);
@@ -179,6 +179,24 @@ TEST(GpuVirtualMemAllocatorTest, FreeRange) {
   ASSERT_EQ(re_alloc, first_alloc);
 }
 
+TEST(GpuVirtualMemAllocatorTest, FreeInsideAlloc) {
+  auto allocator = CreateAllocator();
+  EXPECT_EQ(allocator->FreeGranularity(), k2MiB);
+  size_t bytes_received;  // Ignored in this test.
+  void* first_alloc = allocator->Alloc(
+      /*alignment=*/0, /*num_bytes=*/3 * k2MiB, &bytes_received);
+  ASSERT_NE(first_alloc, nullptr);
+
+  // Frees the granule in the middle of the allocation.
+  allocator->Free(reinterpret_cast<char*>(first_alloc) + k2MiB, k2MiB);
+
+  void* second_alloc =
+      allocator->Alloc(/*alignment=*/0, /*num_bytes=*/k2MiB, &bytes_received);
+  ASSERT_NE(second_alloc, nullptr);
+  ASSERT_EQ(second_alloc,
+            reinterpret_cast<const char*>(first_alloc) + 3 * k2MiB);
+}
+
 }  // namespace
 }  // namespace tensorflow
 
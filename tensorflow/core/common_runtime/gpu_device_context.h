@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_DEVICE_CONTEXT_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_DEVICE_CONTEXT_H_
 
+#include <atomic>
+#include <utility>
+
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -26,6 +29,8 @@ class Stream;
 
 namespace tensorflow {
 
+class GPUHostToDeviceCopyBatcher;
+
 class GPUDeviceContext : public DeviceContext {
  public:
   // Does not take ownership of streams.
@@ -33,7 +38,7 @@ class GPUDeviceContext : public DeviceContext {
 #if TENSORFLOW_USE_ROCM
                    se::Stream* nccl_stream,
 #endif
-                   se::Stream* host_to_device_stream,
+                   gtl::InlinedVector<se::Stream*, 4> host_to_device_stream,
                    se::Stream* device_to_host_stream,
                    gtl::InlinedVector<se::Stream*, 4> device_to_device_stream,
                    Allocator* host_memory_allocator)
@@ -54,12 +59,47 @@ class GPUDeviceContext : public DeviceContext {
 #if TENSORFLOW_USE_ROCM
   se::Stream* nccl_stream() const { return nccl_stream_; }
 #endif
-  se::Stream* host_to_device_stream() const { return host_to_device_stream_; }
+  se::Stream* host_to_device_stream() const {
+    return host_to_device_stream_[0];
+  }
+  // Returns the host-to-device streams round robin, so that consecutive copies
+  // to the device can overlap.
+  se::Stream* next_host_to_device_stream() const {
+    return host_to_device_stream_[next_host_to_device_stream_.fetch_add(
+                                      1, std::memory_order_relaxed) %
+                                  host_to_device_stream_.size()];
+  }
+  // Returns the batcher of the copies to `host_to_device_stream`, or nullptr
+  // if they are not batched.
+  GPUHostToDeviceCopyBatcher* host_to_device_copy_batcher(
+      se::Stream* host_to_device_stream) const {
+    for (size_t i = 0; i < host_to_device_copy_batchers_.size(); ++i) {
+      if (host_to_device_stream_[i] == host_to_device_stream) {
+        return host_to_device_copy_batchers_[i];
+      }
+    }
+    return nullptr;
+  }
+  // Batches the copies to each host-to-device stream with the batcher at the
+  // same index. Does not take ownership of the batchers.
+  void set_host_to_device_copy_batchers(
+      gtl::InlinedVector<GPUHostToDeviceCopyBatcher*, 4> batchers) {
+    host_to_device_copy_batchers_ = std::move(batchers);
+  }
   se::Stream* device_to_host_stream() const { return device_to_host_stream_; }
   se::Stream* device_to_device_stream(int index) const {
     return device_to_device_stream_[index % device_to_device_stream_.size()];
   }
   int stream_id() const { return stream_id_; }
+
+  // The compute streams that `stream()` must wait for before it runs a kernel
+  // with this context, i.e. the streams that produce the kernel's inputs.
+  const gtl::InlinedVector<se::Stream*, 4>& wait_streams() const {
+    return wait_streams_;
+  }
+  void set_wait_streams(gtl::InlinedVector<se::Stream*, 4> wait_streams) {
+    wait_streams_ = std::move(wait_streams);
+  }
   Allocator* host_memory_allocator() const override {
     return host_memory_allocator_;
   }
@@ -91,12 +131,18 @@ class GPUDeviceContext : public DeviceContext {
   // The stream to use for nccl operations.
   se::Stream* nccl_stream_;
 #endif
-  // The stream to use for copying data from host into GPU.
-  se::Stream* host_to_device_stream_;
+  // Streams to use for copying data from host into GPU.
+  gtl::InlinedVector<se::Stream*, 4> host_to_device_stream_;
+  mutable std::atomic<uint32> next_host_to_device_stream_{0};
+  // The batchers of the copies to `host_to_device_stream_`, if any.
+  gtl::InlinedVector<GPUHostToDeviceCopyBatcher*, 4>
+      host_to_device_copy_batchers_;
   // The stream to use for copying data from GPU to host.
   se::Stream* device_to_host_stream_;
   // Streams to use for copying data between GPUs.
   gtl::InlinedVector<se::Stream*, 4> device_to_device_stream_;
+  // Compute streams that `stream_` waits for before each kernel.
+  gtl::InlinedVector<se::Stream*, 4> wait_streams_;
   // The allocator to use for allocating pinned host memory.
   // Not owned.
   Allocator* host_memory_allocator_;
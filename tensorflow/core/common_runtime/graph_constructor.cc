@@ -23,6 +23,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
@@ -48,6 +49,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
@@ -98,7 +100,8 @@ class GraphConstructor {
           importing(false),
           validate_nodes(in.validate_nodes),
           validate_colocation_constraints(false),
-          add_default_attributes(in.add_default_attributes) {}
+          add_default_attributes(in.add_default_attributes),
+          thread_pool(in.thread_pool) {}
     Options(const ImportGraphDefOptions& in)  // NOLINT(runtime/explicit)
         : allow_internal_ops(false),
           expect_device_spec(false),
@@ -151,6 +154,9 @@ class GraphConstructor {
     bool add_default_attributes = true;
 
     string default_device;
+
+    // Only used when not `importing`.
+    thread::ThreadPool* thread_pool = nullptr;
   };
 
   typedef gtl::ArraySlice<const NodeDef*> NodeDefSlice;
@@ -211,6 +217,9 @@ class GraphConstructor {
   Status BuildNodeIndex();
   Status InitFromEdges();
   Status Convert();
+  // Consumes all the NodeDefs into `prepared_node_defs_` on
+  // `opts_.thread_pool`, adding their default attrs and validating them.
+  void PrepareNodeDefs();
   Status AddBackEdges();
   Status UpdateVersionDef();
   Status PopulateReturnTensors();
@@ -387,6 +396,11 @@ class GraphConstructor {
   };
   std::vector<EdgeInfo> back_edges_;
 
+  // The NodeDefs consumed by PrepareNodeDefs(), if any, and the status of
+  // their validation.
+  std::vector<NodeDef> prepared_node_defs_;
+  std::vector<Status> prepared_node_statuses_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GraphConstructor);
 };
 
@@ -453,7 +467,9 @@ class NodeDefMovingGraphConstructor : public GraphConstructor {
   }
 
   GraphDef graph_def_;
-  std::vector<bool> is_consumed_;
+  // Not a vector<bool>, so that PrepareNodeDefs() can consume the NodeDefs
+  // concurrently.
+  std::vector<char> is_consumed_;
 };
 
 bool ForwardCompatibilityWindowPassed(const VersionDef& versions) {
@@ -1123,6 +1139,10 @@ Status GraphConstructor::Convert() {
     TF_RETURN_IF_ERROR(g_->AddFunctionLibrary(*library()));
   }
 
+  if (opts_.thread_pool != nullptr && !opts_.importing) {
+    PrepareNodeDefs();
+  }
+
   std::vector<InputInfo> inputs;
   int processed = 0;
 
@@ -1139,7 +1159,9 @@ Status GraphConstructor::Convert() {
     inputs.clear();
     bool has_data_back_edge = false;
 
-    NodeDef node_def = consume_node_def(o);
+    NodeDef node_def = prepared_node_defs_.empty()
+                           ? consume_node_def(o)
+                           : std::move(prepared_node_defs_[o]);
 
     // input_already_exists[i] is true iff the i-th input of the node we're
     // importing refers to a preexisting node in g_ (i.e. input[i] existed prior
@@ -1235,6 +1257,8 @@ Status GraphConstructor::Convert() {
 
     if (opts_.importing) {
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
+    } else if (!prepared_node_defs_.empty()) {
+      TF_RETURN_IF_ERROR(prepared_node_statuses_[o]);
     } else {
       const OpDef* op_def;
       TF_RETURN_IF_ERROR(
@@ -1284,7 +1308,10 @@ Status GraphConstructor::Convert() {
                  << " NODES IN A CYCLE";
     for (int64_t i = 0; i < node_def_count(); i++) {
       if (pending_count_[i] != 0) {
-        LOG(WARNING) << "PENDING: " << SummarizeNodeDef(get_node_def(i))
+        const NodeDef& node_def = prepared_node_defs_.empty()
+                                      ? get_node_def(i)
+                                      : prepared_node_defs_[i];
+        LOG(WARNING) << "PENDING: " << SummarizeNodeDef(node_def)
                      << " WITH PENDING COUNT = " << pending_count_[i];
       }
     }
@@ -1296,6 +1323,44 @@ Status GraphConstructor::Convert() {
   return Status::OK();
 }
 
+void GraphConstructor::PrepareNodeDefs() {
+  const int num_nodes = node_def_count();
+  // Looks up each op once, since the registry takes a lock for every lookup.
+  absl::flat_hash_map<string, const OpDef*> op_defs;
+  for (int i = 0; i < num_nodes; ++i) {
+    const string& op = get_node_def(i).op();
+    if (op_defs.contains(op)) continue;
+    const OpDef* op_def = nullptr;
+    if (!g_->op_registry()->LookUpOpDef(op, &op_def).ok()) op_def = nullptr;
+    op_defs.emplace(op, op_def);
+  }
+
+  prepared_node_defs_.resize(num_nodes);
+  prepared_node_statuses_.resize(num_nodes);
+  auto prepare = [this, &op_defs](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      NodeDef& node_def = prepared_node_defs_[i];
+      node_def = consume_node_def(i);
+      const OpDef* op_def = op_defs.at(node_def.op());
+      if (op_def == nullptr) {
+        // Looks the op up again for the error.
+        prepared_node_statuses_[i] =
+            g_->op_registry()->LookUpOpDef(node_def.op(), &op_def);
+        continue;
+      }
+      if (opts_.add_default_attributes) {
+        AddDefaultsToNodeDef(*op_def, &node_def);
+      }
+      if (opts_.validate_nodes) {
+        prepared_node_statuses_[i] = ValidateNodeDef(node_def, *op_def);
+      }
+    }
+  };
+  // A NodeDef takes a few microseconds to copy and validate.
+  constexpr int64_t kCostPerNode = 10000;
+  opts_.thread_pool->ParallelFor(num_nodes, kCostPerNode, prepare);
+}
+
 Status GraphConstructor::AddBackEdges() {
   // Add the back edges after all nodes are created.
   for (const auto& e : back_edges_) {
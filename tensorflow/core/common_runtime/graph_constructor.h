@@ -24,6 +24,10 @@ limitations under the License.
 namespace tensorflow {
 class ShapeRefiner;
 
+namespace thread {
+class ThreadPool;
+}  // namespace thread
+
 // Construct a Graph *g out of a GraphDef gdef. Returns non-OK on
 // error, in which case *g is left in an incomplete state.
 //
@@ -52,6 +56,12 @@ struct GraphConstructorOptions {
   // If true, GraphConstructor will add attributes with their default
   // value to the Node when they are missing from the NodeDef.
   bool add_default_attributes = true;
+
+  // If non-null, the NodeDefs are copied, completed with their default
+  // attributes and validated on this thread pool before the nodes are added
+  // to the graph on the calling thread, which speeds up the conversion of
+  // very large GraphDefs. Not owned.
+  thread::ThreadPool* thread_pool = nullptr;
 };
 extern Status ConvertGraphDefToGraph(const GraphConstructorOptions& opts,
                                      const GraphDef& gdef, Graph* g);
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <vector>
 
+#include "absl/strings/match.h"
 #include "tensorflow/core/common_runtime/shape_refiner.h"
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -33,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/version.h"
 
@@ -914,6 +916,69 @@ TEST_F(GraphConstructorTest, SimpleModelWithControlEdges) {
   EXPECT_TRUE(HasControlEdge("t1", "t2"));
 }
 
+TEST_F(GraphConstructorTest, ConvertOnThreadPool) {
+  GraphDef def;
+  NodeDef* node = def.add_node();
+  node->set_name("W1");
+  node->set_op("TestParams");
+  node = def.add_node();
+  node->set_name("input");
+  node->set_op("TestInput");
+  constexpr int kNumNodes = 1000;
+  for (int i = 0; i < kNumNodes; ++i) {
+    node = def.add_node();
+    node->set_name(strings::StrCat("t", i));
+    node->set_op("TestMul");
+    node->add_input(i == 0 ? "W1" : strings::StrCat("t", i - 1));
+    node->add_input("input:1");
+    node = def.add_node();
+    node->set_name(strings::StrCat("d", i));
+    node->set_op("TestDefaultAttr");
+  }
+
+  thread::ThreadPool thread_pool(Env::Default(), "convert", 4);
+  GraphConstructorOptions opts;
+  opts.validate_nodes = true;
+  opts.thread_pool = &thread_pool;
+  TF_ASSERT_OK(ConvertGraphDefToGraph(opts, def, &graph_));
+  EXPECT_TRUE(HasEdge("W1", 0, "t0", 0));
+  for (int i = 1; i < kNumNodes; ++i) {
+    EXPECT_TRUE(HasEdge(strings::StrCat("t", i - 1), 0, strings::StrCat("t", i),
+                        0));
+    EXPECT_TRUE(HasEdge("input", 1, strings::StrCat("t", i), 1));
+  }
+  Node* d = FindNode("d0");
+  ASSERT_TRUE(d != nullptr);
+  int64_t default_int;
+  TF_EXPECT_OK(GetNodeAttr(d->attrs(), "default_int", &default_int));
+  EXPECT_EQ(default_int, 31415);
+}
+
+TEST_F(GraphConstructorTest, ConvertOnThreadPool_InvalidNode) {
+  GraphDef def;
+  ASSERT_TRUE(protobuf::TextFormat::ParseFromString(
+      "node { name: 'W1' op: 'TestParams' }"
+      "node { name: 'input' op: 'TestInput' }"
+      "node { name: 't1' op: 'TestMul' input: [ 'W1', 'input:1' ]"
+      "       attr { key: 'unknown' value { i: 1 } } }",
+      &def));
+  const string original_graph_description = GraphDebugString();
+  thread::ThreadPool thread_pool(Env::Default(), "convert", 4);
+  GraphConstructorOptions opts;
+  opts.validate_nodes = true;
+  opts.thread_pool = &thread_pool;
+  Status s = ConvertGraphDefToGraph(opts, def, &graph_);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  EXPECT_TRUE(absl::StrContains(s.error_message(), "'unknown'")) << s;
+  EXPECT_EQ(original_graph_description, GraphDebugString());
+
+  ASSERT_TRUE(protobuf::TextFormat::ParseFromString(
+      "node { name: 'a' op: 'DoesNotExist' }", &def));
+  s = ConvertGraphDefToGraph(opts, std::move(def), &graph_);
+  EXPECT_TRUE(errors::IsNotFound(s)) << s;
+  EXPECT_EQ(original_graph_description, GraphDebugString());
+}
+
 TEST_F(GraphConstructorTest, Error_ControlEdgeBeforeRealInput) {
   ExpectError(
       "node { name: 'W1' op: 'TestParams' }"
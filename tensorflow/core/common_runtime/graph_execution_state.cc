@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/optimization_registry.h"
 #include "tensorflow/core/common_runtime/placer.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/cost_graph.pb.h"
 #include "tensorflow/core/framework/device_factory.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/function.pb.h"
@@ -50,9 +51,13 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 #ifndef IS_MOBILE_PLATFORM
@@ -64,10 +69,47 @@ limitations under the License.
 namespace tensorflow {
 
 namespace {
+// Returns the profile named by the TF_PLACER_COST_GRAPH environment variable,
+// a text or binary CostGraphDef, which the placer uses to choose between the
+// devices that a node can be placed on. Returns nullptr if the variable is
+// unset or the profile cannot be read.
+const CostGraphDef* PlacementCostGraph() {
+  static const CostGraphDef* cost_graph = []() -> const CostGraphDef* {
+    string path;
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_PLACER_COST_GRAPH", "", &path));
+    if (path.empty()) {
+      return nullptr;
+    }
+    auto* cost_graph = new CostGraphDef();
+    Status status = ReadTextOrBinaryProto(Env::Default(), path, cost_graph);
+    if (!status.ok()) {
+      LOG(WARNING) << "Ignoring the placement cost graph in " << path << ": "
+                   << status;
+      delete cost_graph;
+      return nullptr;
+    }
+    return cost_graph;
+  }();
+  return cost_graph;
+}
+
 bool IsCollectiveV2(const string& op) {
   return op == "CollectiveReduceV2" || op == "CollectiveGatherV2" ||
          op == "CollectiveBcastRecvV2" || op == "CollectiveBcastSendV2";
 }
+
+// GraphDefs with at least this many nodes are converted to graphs with the
+// help of a thread pool.
+constexpr int kMinNodesForParallelConversion = 1 << 14;
+
+// Returns the thread pool to pass to ConvertGraphDefToGraph() for
+// `graph_def`, or nullptr if it is too small to benefit from one.
+std::unique_ptr<thread::ThreadPool> MaybeCreateConversionThreadPool(
+    const GraphDef& graph_def) {
+  if (graph_def.node_size() < kMinNodesForParallelConversion) return nullptr;
+  return absl::make_unique<thread::ThreadPool>(
+      Env::Default(), "graph_conversion", port::MaxParallelism());
+}
 }  // namespace
 
 GraphExecutionState::GraphExecutionState(
@@ -111,8 +153,12 @@ GraphExecutionState::~GraphExecutionState() {
     // construct a Graph* in this case.
     if (!options.session_options->config.graph_options().place_pruned_graph()) {
       auto base_graph = absl::make_unique<Graph>(OpRegistry::Global());
-      TF_RETURN_IF_ERROR(ConvertGraphDefToGraph({}, *ret->original_graph_def_,
-                                                base_graph.get()));
+      std::unique_ptr<thread::ThreadPool> thread_pool =
+          MaybeCreateConversionThreadPool(*ret->original_graph_def_);
+      GraphConstructorOptions opts;
+      opts.thread_pool = thread_pool.get();
+      TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(
+          opts, *ret->original_graph_def_, base_graph.get()));
       TF_RETURN_IF_ERROR(ret->InitBaseGraph(std::move(base_graph)));
     }
     *out_state = std::move(ret);
@@ -120,8 +166,12 @@ GraphExecutionState::~GraphExecutionState() {
     auto ret = absl::WrapUnique(
         new GraphExecutionState(nullptr, std::move(flib_def), options));
     auto base_graph = absl::make_unique<Graph>(OpRegistry::Global());
+    std::unique_ptr<thread::ThreadPool> thread_pool =
+        MaybeCreateConversionThreadPool(graph_def);
+    GraphConstructorOptions opts;
+    opts.thread_pool = thread_pool.get();
     TF_RETURN_IF_ERROR(
-        ConvertGraphDefToGraph({}, std::move(graph_def), base_graph.get()));
+        ConvertGraphDefToGraph(opts, std::move(graph_def), base_graph.get()));
     TF_RETURN_IF_ERROR(ret->InitBaseGraph(std::move(base_graph)));
     *out_state = std::move(ret);
   }
@@ -626,6 +676,7 @@ Status GraphExecutionState::InitBaseGraph(std::unique_ptr<Graph>&& new_graph) {
                     session_options_->config.allow_soft_placement(),
                 session_options_ != nullptr &&
                     session_options_->config.log_device_placement());
+  placer.set_cost_graph(PlacementCostGraph());
   // TODO(mrry): Consider making the Placer cancellable.
   TF_RETURN_IF_ERROR(placer.Run());
 
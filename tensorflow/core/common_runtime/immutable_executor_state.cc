@@ -96,6 +96,17 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
 
   pending_ids_.resize(gview_.num_nodes());
 
+  TF_RETURN_IF_ERROR(
+      params_.device->AssignNodeDeviceContexts(graph, &node_device_contexts_));
+  if (!node_device_contexts_.empty() &&
+      node_device_contexts_.size() !=
+          static_cast<size_t>(graph.num_node_ids())) {
+    return errors::Internal("Device ", params_.device->name(), " assigned ",
+                            node_device_contexts_.size(),
+                            " device contexts to a graph of ",
+                            graph.num_node_ids(), " nodes.");
+  }
+
   // Preprocess every node in the graph to create an instance of op
   // kernel for each node.
   requires_control_flow_ = false;
@@ -378,4 +389,120 @@ void ImmutableExecutorState::InitializePending(const Graph* graph,
     }
   }
 }
+
+Status ImmutableExecutorState::GetTopologicalOrder(
+    std::vector<int32>* order) const {
+  if (requires_control_flow_) {
+    return errors::FailedPrecondition(
+        "A topological order cannot be computed for a graph that requires "
+        "control flow support.");
+  }
+  const std::vector<const NodeItem*>& nodes = *root_frame_info_->nodes;
+  std::vector<int32> num_pending(gview_.num_nodes(), 0);
+  for (const NodeItem* item : nodes) {
+    for (const EdgeInfo& e : item->output_edges()) {
+      ++num_pending[e.dst_id];
+    }
+    for (const ControlEdgeInfo& e : item->output_control_edges()) {
+      ++num_pending[e.dst_id];
+    }
+  }
+  order->clear();
+  order->reserve(nodes.size());
+  for (const NodeItem* item : root_nodes_) {
+    order->push_back(item->node_id);
+  }
+  for (size_t i = 0; i < order->size(); ++i) {
+    const NodeItem* item = gview_.node((*order)[i]);
+    for (const EdgeInfo& e : item->output_edges()) {
+      if (--num_pending[e.dst_id] == 0) order->push_back(e.dst_id);
+    }
+    for (const ControlEdgeInfo& e : item->output_control_edges()) {
+      if (--num_pending[e.dst_id] == 0) order->push_back(e.dst_id);
+    }
+  }
+  if (order->size() != nodes.size()) {
+    return errors::InvalidArgument("Graph had ", nodes.size(),
+                                   " nodes but its topological order had ",
+                                   order->size());
+  }
+  return Status::OK();
+}
+
+Status ImmutableExecutorState::BuildStaticSchedule(int num_lanes) {
+  if (requires_control_flow_) {
+    return errors::FailedPrecondition(
+        "A static schedule cannot be built for a graph that requires control "
+        "flow support.");
+  }
+  if (num_lanes < 1) {
+    return errors::InvalidArgument("Invalid number of lanes: ", num_lanes);
+  }
+  const int num_nodes = gview_.num_nodes();
+  const std::vector<const NodeItem*>& nodes = *root_frame_info_->nodes;
+
+  // Compute a topological order of the nodes, along with their immediate
+  // predecessors.
+  std::vector<std::vector<int32>> predecessors(num_nodes);
+  for (const NodeItem* item : nodes) {
+    for (const EdgeInfo& e : item->output_edges()) {
+      predecessors[e.dst_id].push_back(item->node_id);
+    }
+    for (const ControlEdgeInfo& e : item->output_control_edges()) {
+      predecessors[e.dst_id].push_back(item->node_id);
+    }
+  }
+  std::vector<int32> order;
+  TF_RETURN_IF_ERROR(GetTopologicalOrder(&order));
+
+  // Assign each node to a lane. A node preferably extends the lane whose last
+  // node is one of its predecessors, so that chains of dependent nodes need
+  // no synchronization. Otherwise it starts a new lane, or, if all lanes are
+  // in use, extends the lane whose last node came earliest in the order and
+  // is therefore the most likely to have completed.
+  auto schedule = absl::make_unique<StaticSchedule>();
+  schedule->lane.assign(num_nodes, -1);
+  schedule->lane_successor.assign(num_nodes, -1);
+  schedule->pending_counts.assign(num_nodes, 0);
+  std::vector<int32> position(num_nodes, -1);
+  std::vector<int32> lane_tails;
+  for (size_t i = 0; i < order.size(); ++i) {
+    const int32 id = order[i];
+    position[id] = i;
+    int32 lane = -1;
+    for (int32 pred : predecessors[id]) {
+      const int32 pred_lane = schedule->lane[pred];
+      if (lane_tails[pred_lane] == pred) {
+        lane = pred_lane;
+        break;
+      }
+    }
+    if (lane < 0) {
+      if (lane_tails.size() < static_cast<size_t>(num_lanes)) {
+        lane = lane_tails.size();
+        lane_tails.push_back(-1);
+        schedule->lanes.emplace_back();
+      } else {
+        lane = 0;
+        for (int32 l = 1; l < num_lanes; ++l) {
+          if (position[lane_tails[l]] < position[lane_tails[lane]]) lane = l;
+        }
+      }
+    }
+    const int32 tail = lane_tails[lane];
+    if (tail >= 0) {
+      schedule->lane_successor[tail] = id;
+      ++schedule->pending_counts[id];
+    }
+    for (int32 pred : predecessors[id]) {
+      if (schedule->lane[pred] != lane) ++schedule->pending_counts[id];
+    }
+    schedule->lane[id] = lane;
+    schedule->lanes[lane].push_back(id);
+    lane_tails[lane] = id;
+  }
+  schedule->num_lanes = schedule->lanes.size();
+  static_schedule_ = std::move(schedule);
+  return Status::OK();
+}
 }  // namespace tensorflow
@@ -74,6 +74,31 @@ class ImmutableExecutorState {
     int32 parallel_iterations;
   };
 
+  // A precomputed execution plan for graphs that do not require control flow
+  // support. The nodes are partitioned into at most `num_lanes` lanes, each of
+  // which is a subsequence of one topological order of the graph. The nodes
+  // in a lane run one after another, so only edges between different lanes
+  // (and the hand-off from each node to its successor in the same lane) need
+  // to be tracked at run time.
+  struct StaticSchedule {
+    int num_lanes = 0;
+
+    // The node IDs of each lane, in execution order.
+    std::vector<std::vector<int32>> lanes;
+
+    // The lane of each node, indexed by node ID.
+    std::vector<int32> lane;
+
+    // The node ID of the next node in the same lane, or -1 if the node is the
+    // last node of its lane. Indexed by node ID.
+    std::vector<int32> lane_successor;
+
+    // The number of events that must happen before each node is runnable,
+    // indexed by node ID: one for the completion of the preceding node in its
+    // lane (if any), plus one for each input edge from another lane.
+    std::vector<int32> pending_counts;
+  };
+
   explicit ImmutableExecutorState(const LocalExecutorParams& p)
       : params_(p), gview_() {}
   ~ImmutableExecutorState();
@@ -101,6 +126,34 @@ class ImmutableExecutorState {
 
   bool requires_control_flow_support() const { return requires_control_flow_; }
 
+  // Returns true if the device assigned its own DeviceContext to some nodes.
+  bool has_node_device_contexts() const {
+    return !node_device_contexts_.empty();
+  }
+
+  // Returns the DeviceContext the device assigned to node `id`, or nullptr if
+  // the node uses the context of the executor. Not owned.
+  DeviceContext* node_device_context(int id) const {
+    return node_device_contexts_.empty() ? nullptr : node_device_contexts_[id];
+  }
+
+  // Stores the IDs of the nodes in this graph in `*order`, in one topological
+  // order that starts with `root_nodes()`.
+  //
+  // REQUIRES: `!requires_control_flow_support()`.
+  Status GetTopologicalOrder(std::vector<int32>* order) const;
+
+  // Computes a `StaticSchedule` with at most `num_lanes` lanes for this graph.
+  //
+  // REQUIRES: `!requires_control_flow_support()`.
+  Status BuildStaticSchedule(int num_lanes);
+
+  // Returns the schedule computed by `BuildStaticSchedule()`, or nullptr if
+  // none has been computed.
+  const StaticSchedule* static_schedule() const {
+    return static_schedule_.get();
+  }
+
   // Copies the pending counts for nodes in this graph to the given array.
   //
   // This method provides a more efficient way of initializing
@@ -133,6 +186,8 @@ class ImmutableExecutorState {
   GraphView gview_;
   bool requires_control_flow_;
   std::vector<PendingCounts::Handle> pending_ids_;
+  // Indexed by node id, or empty. Owned by the device.
+  std::vector<DeviceContext*> node_device_contexts_;
 
   // Root nodes (with no in edges) that should form the initial ready queue
   std::vector<const NodeItem*> root_nodes_;
@@ -155,6 +210,9 @@ class ImmutableExecutorState {
   // Shallow copies of the constant tensors used in the graph.
   std::vector<Tensor> const_tensors_;
 
+  // Set by `BuildStaticSchedule()`.
+  std::unique_ptr<StaticSchedule> static_schedule_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ImmutableExecutorState);
 };
 
@@ -50,6 +50,11 @@ struct LocalExecutorParams {
 
   // Whether control flow nodes are allowed to be executed synchronously.
   bool allow_control_flow_sync_execution = false;
+
+  // If true, and the graph does not require control flow support, the
+  // outputs of its kernels are served from a static memory plan (see
+  // MemoryPlan) once the first step has completed.
+  bool enable_memory_planning = false;
 };
 
 }  // end namespace tensorflow
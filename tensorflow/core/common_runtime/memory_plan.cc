@@ -0,0 +1,230 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/memory_plan.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/common_runtime/graph_view.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+// Serves the allocations of one slot.
+class MemoryPlan::SlotAllocator : public Allocator {
+ public:
+  SlotAllocator(MemoryPlan* plan, int32 slot) : plan_(plan), slot_(slot) {}
+
+  std::string Name() override { return "memory_plan"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return plan_->Allocate(slot_, alignment, num_bytes);
+  }
+
+  void DeallocateRaw(void* ptr) override { plan_->Deallocate(slot_, ptr); }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return plan_->backing_allocator_->GetMemoryType();
+  }
+
+ private:
+  MemoryPlan* const plan_;  // Not owned.
+  const int32 slot_;
+};
+
+MemoryPlan::MemoryPlan(Allocator* backing_allocator)
+    : backing_allocator_(backing_allocator) {}
+
+MemoryPlan::~MemoryPlan() {
+  for (Allocator* a : slot_allocators_) delete a;
+  if (arena_ != nullptr) backing_allocator_->DeallocateRaw(arena_);
+}
+
+/* static */
+Status MemoryPlan::Create(const ImmutableExecutorState& immutable_state,
+                          Allocator* backing_allocator,
+                          core::RefCountPtr<MemoryPlan>* out_plan) {
+  const GraphView& gview = immutable_state.graph_view();
+  std::vector<int32> order;
+  TF_RETURN_IF_ERROR(immutable_state.GetTopologicalOrder(&order));
+  std::vector<int32> position(gview.num_nodes(), -1);
+  for (size_t i = 0; i < order.size(); ++i) position[order[i]] = i;
+
+  core::RefCountPtr<MemoryPlan> plan(new MemoryPlan(backing_allocator));
+  plan->output_base_.assign(gview.num_nodes(), -1);
+  std::vector<Slot> slots;
+  for (int32 id : order) {
+    const NodeItem* item = gview.node(id);
+    if (item->kernel == nullptr || item->num_outputs == 0 ||
+        item->is_transfer_node) {
+      continue;
+    }
+    const int32 base = slots.size();
+    slots.resize(base + item->num_outputs);
+    std::vector<bool> escapes(item->num_outputs, false);
+    for (int i = 0; i < item->num_outputs; ++i) {
+      slots[base + i].first_use = position[id];
+      slots[base + i].last_use = position[id];
+    }
+    for (const EdgeInfo& e : item->output_edges()) {
+      const NodeItem* dst = gview.node(e.dst_id);
+      if (dst->kernel == nullptr || dst->is_transfer_node ||
+          dst->kernel->type_string_view() == "_Retval") {
+        escapes[e.output_slot] = true;
+      }
+      Slot& slot = slots[base + e.output_slot];
+      slot.last_use = std::max(slot.last_use, position[e.dst_id]);
+    }
+    bool any_planned = false;
+    for (int i = 0; i < item->num_outputs; ++i) {
+      if (escapes[i] || IsRefType(item->output_type(i))) {
+        plan->slot_allocators_.push_back(nullptr);
+      } else {
+        plan->slot_allocators_.push_back(
+            new SlotAllocator(plan.get(), base + i));
+        any_planned = true;
+      }
+    }
+    if (any_planned) plan->output_base_[id] = base;
+  }
+  {
+    mutex_lock l(plan->mu_);
+    plan->slots_ = std::move(slots);
+  }
+  *out_plan = std::move(plan);
+  return Status::OK();
+}
+
+void* MemoryPlan::Allocate(int32 slot, size_t alignment, size_t num_bytes) {
+  {
+    mutex_lock l(mu_);
+    Slot& s = slots_[slot];
+    if (!finalized_) {
+      s.max_bytes = std::max(s.max_bytes, num_bytes);
+    } else if (s.offset != kUnplanned && num_bytes <= s.size &&
+               alignment <= Allocator::kAllocatorAlignment &&
+               !OverlapsLiveRange(s.offset, s.size)) {
+      live_ranges_.emplace(s.offset, s.offset + s.size);
+      Ref();
+      return arena_ + s.offset;
+    } else {
+      ++num_fallback_allocations_;
+    }
+  }
+  void* ptr = backing_allocator_->AllocateRaw(alignment, num_bytes);
+  if (ptr != nullptr) Ref();
+  return ptr;
+}
+
+void MemoryPlan::Deallocate(int32 slot, void* ptr) {
+  bool in_arena;
+  {
+    mutex_lock l(mu_);
+    in_arena =
+        arena_ != nullptr && ptr >= arena_ && ptr < arena_ + arena_bytes_;
+    if (in_arena) live_ranges_.erase(slots_[slot].offset);
+  }
+  if (!in_arena) backing_allocator_->DeallocateRaw(ptr);
+  // NOTE: This may delete `this`, along with the calling `SlotAllocator`.
+  Unref();
+}
+
+bool MemoryPlan::OverlapsLiveRange(size_t offset, size_t size) const {
+  auto it = live_ranges_.lower_bound(offset);
+  if (it != live_ranges_.end() && it->first < offset + size) return true;
+  if (it != live_ranges_.begin() && std::prev(it)->second > offset) {
+    return true;
+  }
+  return false;
+}
+
+void MemoryPlan::StepDone() {
+  mutex_lock l(mu_);
+  if (!finalized_) Finalize();
+}
+
+void MemoryPlan::Finalize() {
+  finalized_ = true;
+
+  // Place the slots greedily in decreasing order of size, each at the lowest
+  // offset that does not overlap an already placed slot whose lifetime
+  // overlaps its own.
+  std::vector<int32> order;
+  for (int32 i = 0; i < static_cast<int32>(slots_.size()); ++i) {
+    Slot& s = slots_[i];
+    if (s.max_bytes == 0) continue;
+    s.size = (s.max_bytes + Allocator::kAllocatorAlignment - 1) &
+             ~(Allocator::kAllocatorAlignment - 1);
+    order.push_back(i);
+  }
+  std::stable_sort(order.begin(), order.end(), [this](int32 a, int32 b) {
+    return slots_[a].size > slots_[b].size;
+  });
+  // The placed slots, in increasing order of offset.
+  std::vector<int32> placed;
+  size_t total_bytes = 0;
+  for (int32 i : order) {
+    Slot& s = slots_[i];
+    size_t offset = 0;
+    for (int32 j : placed) {
+      const Slot& other = slots_[j];
+      if (other.last_use < s.first_use || s.last_use < other.first_use) {
+        continue;
+      }
+      if (other.offset >= offset + s.size) break;
+      offset = std::max(offset, other.offset + other.size);
+    }
+    s.offset = offset;
+    auto insert_pos = std::upper_bound(
+        placed.begin(), placed.end(), offset,
+        [this](size_t offset, int32 j) { return offset < slots_[j].offset; });
+    placed.insert(insert_pos, i);
+    total_bytes = std::max(total_bytes, offset + s.size);
+  }
+
+  if (total_bytes > 0) {
+    arena_ = static_cast<char*>(backing_allocator_->AllocateRaw(
+        Allocator::kAllocatorAlignment, total_bytes));
+  }
+  if (arena_ == nullptr) {
+    if (total_bytes > 0) {
+      LOG(WARNING) << "Failed to allocate a memory plan arena of "
+                   << total_bytes << " bytes; all allocations will use "
+                   << backing_allocator_->Name();
+    }
+    for (Slot& s : slots_) s.offset = kUnplanned;
+    return;
+  }
+  arena_bytes_ = total_bytes;
+  VLOG(1) << "Planned " << order.size() << " outputs in an arena of "
+          << arena_bytes_ << " bytes";
+}
+
+bool MemoryPlan::finalized() const {
+  mutex_lock l(mu_);
+  return finalized_;
+}
+
+size_t MemoryPlan::arena_bytes() const {
+  mutex_lock l(mu_);
+  return arena_bytes_;
+}
+
+int64_t MemoryPlan::num_fallback_allocations() const {
+  mutex_lock l(mu_);
+  return num_fallback_allocations_;
+}
+
+}  // namespace tensorflow
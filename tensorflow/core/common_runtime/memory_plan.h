@@ -0,0 +1,141 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLAN_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLAN_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/immutable_executor_state.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A static memory layout for the kernel outputs of one executor's graph.
+//
+// Every output of every kernel is a "slot", which is live from the position
+// of its producer to the position of its last consumer in a topological order
+// of the graph. The plan runs in two phases:
+//
+// 1. While recording, allocations are forwarded to the backing allocator and
+//    the largest size requested for each slot is recorded.
+// 2. After the first successful step, each slot is assigned an offset in a
+//    single arena, such that slots with overlapping lifetimes do not overlap
+//    in memory. From then on, a slot is served from its range of the arena.
+//
+// Since the executor may run nodes in any order consistent with the graph,
+// and tensors may outlive their last consumer (e.g. when they are forwarded
+// or stored in a resource), a range is only handed out if no other live
+// allocation overlaps it. Requests that do not fit, and requests for a range
+// that is still in use, fall back to the backing allocator, so the plan is
+// safe for any graph; it only avoids allocator calls when shapes are fixed.
+//
+// Outputs that escape the step through a `_Retval` node or a transfer node
+// are never planned.
+//
+// Every allocation holds a reference on the plan, so tensors may outlive the
+// executor that owns it.
+class MemoryPlan : public core::RefCounted {
+ public:
+  // Creates a plan for the graph of `immutable_state`, which must not require
+  // control flow support. The backing allocator must outlive the plan.
+  static Status Create(const ImmutableExecutorState& immutable_state,
+                       Allocator* backing_allocator,
+                       core::RefCountPtr<MemoryPlan>* out_plan);
+
+  ~MemoryPlan() override;
+
+  // Returns an array, indexed by output number, of allocators for the outputs
+  // of the node `node_id`, or nullptr if none of its outputs are planned. An
+  // entry is nullptr if the corresponding output is not planned.
+  //
+  // The allocators must only be used for allocations with default
+  // `AllocatorAttributes`.
+  Allocator* const* output_allocators(int32 node_id) const {
+    const int32 base = output_base_[node_id];
+    return base < 0 ? nullptr : slot_allocators_.data() + base;
+  }
+
+  // Must be called after each successful step. The first call computes the
+  // layout and allocates the arena.
+  void StepDone();
+
+  // Returns true if the layout has been computed.
+  bool finalized() const;
+
+  // Returns the size of the arena, or 0 if the layout has not been computed.
+  size_t arena_bytes() const;
+
+  // Returns the number of allocations since the layout was computed that
+  // were forwarded to the backing allocator.
+  int64_t num_fallback_allocations() const;
+
+ private:
+  class SlotAllocator;
+
+  static constexpr size_t kUnplanned = ~static_cast<size_t>(0);
+
+  struct Slot {
+    // Positions of the producer and the last consumer in the topological
+    // order.
+    int32 first_use = 0;
+    int32 last_use = 0;
+    // The largest size requested while recording.
+    size_t max_bytes = 0;
+    // The offset in the arena, or `kUnplanned`.
+    size_t offset = kUnplanned;
+    size_t size = 0;
+  };
+
+  explicit MemoryPlan(Allocator* backing_allocator);
+
+  void* Allocate(int32 slot, size_t alignment, size_t num_bytes);
+  void Deallocate(int32 slot, void* ptr);
+
+  // Returns true if `[offset, offset + size)` overlaps a live range.
+  bool OverlapsLiveRange(size_t offset, size_t size) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  void Finalize() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const backing_allocator_;  // Not owned.
+
+  // Indexed by node ID. The index of the node's first slot, or -1.
+  std::vector<int32> output_base_;
+  // Indexed by slot. Owned, or nullptr for outputs that are not planned.
+  std::vector<Allocator*> slot_allocators_;
+
+  mutable mutex mu_;
+  bool finalized_ TF_GUARDED_BY(mu_) = false;
+  std::vector<Slot> slots_ TF_GUARDED_BY(mu_);
+  char* arena_ TF_GUARDED_BY(mu_) = nullptr;
+  size_t arena_bytes_ TF_GUARDED_BY(mu_) = 0;
+  // Maps the offset of each arena range that is in use to its end.
+  std::map<size_t, size_t> live_ranges_ TF_GUARDED_BY(mu_);
+  int64_t num_fallback_allocations_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MemoryPlan);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLAN_H_
@@ -0,0 +1,175 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/memory_plan.h"
+
+#include <cstdlib>
+#include <memory>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor.h"
+#include "tensorflow/core/common_runtime/immutable_executor_state.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+// Counts outstanding allocations made through the backing allocator.
+class CountingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++live_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    --live_;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+  int live() const { return live_; }
+
+ private:
+  int live_ = 0;
+};
+
+class MemoryPlanTest : public ::testing::Test {
+ protected:
+  MemoryPlanTest()
+      : device_(DeviceFactory::NewDevice("CPU", {},
+                                         "/job:localhost/replica:0/task:0")),
+        graph_(OpRegistry::Global()) {
+    // a -> b -> c -> d -> _Retval, where each output is live until the next
+    // node has run. d escapes through the _Retval node.
+    Tensor t(DT_FLOAT, TensorShape({}));
+    t.scalar<float>()() = 1.0;
+    a_ = test::graph::Constant(&graph_, t);
+    b_ = test::graph::Unary(&graph_, "Neg", a_);
+    c_ = test::graph::Unary(&graph_, "Neg", b_);
+    d_ = test::graph::Unary(&graph_, "Neg", c_);
+    test::graph::Retval(&graph_, 0, d_);
+
+    const int version = graph_.versions().producer();
+    LocalExecutorParams params;
+    params.device = device_.get();
+    params.create_kernel =
+        [this, version](const std::shared_ptr<const NodeProperties>& props,
+                        OpKernel** kernel) {
+          return CreateNonCachedKernel(device_.get(), nullptr, props, version,
+                                       kernel);
+        };
+    params.delete_kernel = [](OpKernel* kernel) {
+      DeleteNonCachedKernel(kernel);
+    };
+    state_ = absl::make_unique<ImmutableExecutorState>(params);
+    TF_CHECK_OK(state_->Initialize(graph_));
+    TF_CHECK_OK(MemoryPlan::Create(*state_, &backing_, &plan_));
+  }
+
+  Allocator* OutputAllocator(const Node* node) {
+    Allocator* const* allocators = plan_->output_allocators(node->id());
+    return allocators == nullptr ? nullptr : allocators[0];
+  }
+
+  // Allocates and frees 100 bytes for each planned output, as the first step
+  // would, and computes the layout.
+  void RecordStep() {
+    for (const Node* node : {a_, b_, c_}) {
+      Allocator* a = OutputAllocator(node);
+      ASSERT_NE(a, nullptr);
+      void* ptr = a->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+      ASSERT_NE(ptr, nullptr);
+      a->DeallocateRaw(ptr);
+    }
+    plan_->StepDone();
+  }
+
+  std::unique_ptr<Device> device_;
+  Graph graph_;
+  Node* a_;
+  Node* b_;
+  Node* c_;
+  Node* d_;
+  CountingAllocator backing_;
+  std::unique_ptr<ImmutableExecutorState> state_;
+  core::RefCountPtr<MemoryPlan> plan_;
+};
+
+TEST_F(MemoryPlanTest, EscapingOutputsAreNotPlanned) {
+  EXPECT_NE(OutputAllocator(c_), nullptr);
+  EXPECT_EQ(OutputAllocator(d_), nullptr);
+}
+
+TEST_F(MemoryPlanTest, RecordsThenServesFromArena) {
+  EXPECT_FALSE(plan_->finalized());
+  RecordStep();
+  EXPECT_TRUE(plan_->finalized());
+  // a and c have disjoint lifetimes and share the first 128 bytes.
+  EXPECT_EQ(256, plan_->arena_bytes());
+  EXPECT_EQ(1, backing_.live());
+
+  void* a = OutputAllocator(a_)->AllocateRaw(Allocator::kAllocatorAlignment,
+                                             100);
+  void* b = OutputAllocator(b_)->AllocateRaw(Allocator::kAllocatorAlignment,
+                                             100);
+  EXPECT_EQ(128, std::abs(static_cast<char*>(a) - static_cast<char*>(b)));
+  EXPECT_EQ(1, backing_.live());
+  OutputAllocator(a_)->DeallocateRaw(a);
+  void* c = OutputAllocator(c_)->AllocateRaw(Allocator::kAllocatorAlignment,
+                                             100);
+  EXPECT_EQ(a, c);
+  OutputAllocator(b_)->DeallocateRaw(b);
+  OutputAllocator(c_)->DeallocateRaw(c);
+  EXPECT_EQ(0, plan_->num_fallback_allocations());
+}
+
+TEST_F(MemoryPlanTest, FallsBackOnConflictOrOversizedRequest) {
+  RecordStep();
+  Allocator* a = OutputAllocator(a_);
+  Allocator* c = OutputAllocator(c_);
+
+  // c shares its range with a, which is still in use.
+  void* a_ptr = a->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  void* c_ptr = c->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  EXPECT_EQ(1, plan_->num_fallback_allocations());
+  EXPECT_EQ(2, backing_.live());
+  c->DeallocateRaw(c_ptr);
+  a->DeallocateRaw(a_ptr);
+
+  // The request is larger than the recorded size.
+  void* big = a->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  EXPECT_EQ(2, plan_->num_fallback_allocations());
+  EXPECT_EQ(2, backing_.live());
+  a->DeallocateRaw(big);
+  EXPECT_EQ(1, backing_.live());
+}
+
+TEST_F(MemoryPlanTest, AllocationsOutliveOwner) {
+  RecordStep();
+  Tensor t(OutputAllocator(b_), DT_FLOAT, TensorShape({25}));
+  plan_.reset();
+  EXPECT_EQ(1, backing_.live());
+  t = Tensor();
+  // Freeing the last allocation releases the arena.
+  EXPECT_EQ(0, backing_.live());
+}
+
+}  // namespace
+}  // namespace tensorflow
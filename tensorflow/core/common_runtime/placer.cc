@@ -15,9 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/placer.h"
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
 #include "tensorflow/core/common_runtime/colocation_graph.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/attr_value_util.h"
@@ -28,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/graph_node_util.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/port.h"
 
@@ -139,6 +143,90 @@ Status AssignAndLog(int assigned_device, Node* node,
   return Status::OK();
 }
 
+// The assumed bandwidth of copies between devices, in bytes per microsecond,
+// which is roughly that of a PCIe 3.0 x16 link.
+constexpr double kCrossDeviceBytesPerMicrosecond = 12000;
+
+// The profiled costs of the nodes of a graph, keyed by node name.
+class PlacementCostModel {
+ public:
+  explicit PlacementCostModel(const CostGraphDef& cost_graph) {
+    for (const CostGraphDef::Node& cost_node : cost_graph.node()) {
+      NodeCosts& costs = nodes_[cost_node.name()];
+      DeviceNameUtils::ParsedName parsed_name;
+      if (DeviceNameUtils::ParseFullName(cost_node.device(), &parsed_name) &&
+          parsed_name.has_type) {
+        costs.compute_micros[parsed_name.type] = cost_node.compute_cost();
+      }
+      if (costs.output_bytes.size() <
+          static_cast<size_t>(cost_node.output_info_size())) {
+        costs.output_bytes.resize(cost_node.output_info_size());
+      }
+      for (int i = 0; i < cost_node.output_info_size(); ++i) {
+        costs.output_bytes[i] =
+            std::max(costs.output_bytes[i], cost_node.output_info(i).size());
+      }
+    }
+  }
+
+  // Returns the device in "devices" that minimizes the profiled compute time
+  // of "node" plus the time to copy its inputs from the devices of their
+  // producers, or nullptr if "node" has not been profiled on at least two of
+  // the device types in "devices".
+  const Device* ChooseDevice(const Node& node,
+                             const std::vector<Device*>& devices) const {
+    auto it = nodes_.find(node.name());
+    if (it == nodes_.end()) {
+      return nullptr;
+    }
+    const NodeCosts& costs = it->second;
+    const Device* best_device = nullptr;
+    double best_micros = 0;
+    int num_profiled_devices = 0;
+    for (const Device* device : devices) {
+      auto compute = costs.compute_micros.find(device->device_type());
+      if (compute == costs.compute_micros.end()) {
+        continue;
+      }
+      ++num_profiled_devices;
+      double micros = compute->second;
+      for (const Edge* edge : node.in_edges()) {
+        const Node* src = edge->src();
+        if (edge->IsControlEdge() || !src->has_assigned_device_name() ||
+            src->assigned_device_name() == device->name()) {
+          continue;
+        }
+        micros += OutputBytes(*src, edge->src_output()) /
+                  kCrossDeviceBytesPerMicrosecond;
+      }
+      if (best_device == nullptr || micros < best_micros) {
+        best_device = device;
+        best_micros = micros;
+      }
+    }
+    return num_profiled_devices > 1 ? best_device : nullptr;
+  }
+
+ private:
+  struct NodeCosts {
+    // The profiled compute time, keyed by device type.
+    absl::flat_hash_map<string, int64_t> compute_micros;
+    // The largest profiled size of each output.
+    std::vector<int64_t> output_bytes;
+  };
+
+  int64_t OutputBytes(const Node& node, int output) const {
+    auto it = nodes_.find(node.name());
+    if (it == nodes_.end() || output < 0 ||
+        output >= static_cast<int>(it->second.output_bytes.size())) {
+      return 0;
+    }
+    return it->second.output_bytes[output];
+  }
+
+  absl::flat_hash_map<string, NodeCosts> nodes_;
+};
+
 }  // namespace
 
 Placer::Placer(Graph* graph, const string& function_name,
@@ -188,6 +276,11 @@ Status Placer::Run() {
 
   TF_RETURN_IF_ERROR(colocation_graph.Initialize());
 
+  std::unique_ptr<PlacementCostModel> cost_model;
+  if (cost_graph_ != nullptr) {
+    cost_model = absl::make_unique<PlacementCostModel>(*cost_graph_);
+  }
+
   // For each node, assign a device based on the constraints in the disjoint
   // node set.
   std::vector<Node*> second_pass;
@@ -250,6 +343,15 @@ Status Placer::Run() {
       }
     }
 
+    // Heuristic C: If the node has been profiled on several of its candidate
+    // devices, choose the one that is expected to finish it first.
+    if (assigned_device == -1 && cost_model != nullptr) {
+      const Device* device = cost_model->ChooseDevice(*node, *devices);
+      if (device != nullptr) {
+        assigned_device = graph_->InternDeviceName(device->name());
+      }
+    }
+
     // Provide the default, if necessary.
     if (assigned_device == -1) {
       assigned_device = graph_->InternDeviceName((*devices)[0]->name());
@@ -19,6 +19,7 @@ limitations under the License.
 #include <string>
 
 #include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/framework/cost_graph.pb.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -80,6 +81,18 @@ class Placer {
 
   ~Placer();
 
+  // Uses the profiled costs in "cost_graph" (e.g. from RunMetadata) to choose
+  // between the devices a node may be placed on, once the hard constraints
+  // above have been applied. A node is placed on the device that minimizes
+  // its profiled compute time plus the time to copy its inputs from other
+  // devices. Only nodes that have been profiled on more than one of their
+  // candidate device types are affected.
+  //
+  // "cost_graph" is borrowed by this Placer, and must outlive it.
+  void set_cost_graph(const CostGraphDef* cost_graph) {
+    cost_graph_ = cost_graph;
+  }
+
   // Assigns each node in this Placer's graph to a device in its
   // set of devices.
   //
@@ -100,6 +113,7 @@ class Placer {
   const Device* default_local_device_;               // Not owned.
   const bool allow_soft_placement_;
   const bool log_device_placement_;
+  const CostGraphDef* cost_graph_ = nullptr;  // Not owned.
 
   TF_DISALLOW_COPY_AND_ASSIGN(Placer);
 };
@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/graph_def_builder_util.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/cost_graph.pb.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/function_testlib.h"
@@ -430,6 +431,51 @@ TEST_F(PlacerTest, TestNoConstraints) {
   EXPECT_DEVICE_TYPE(g, "n2", "FakeGPU");
 }
 
+// Test that a profiled cost graph overrides the device priority when a node is
+// expected to finish sooner on a lower priority device, taking the cost of
+// copying its inputs into account.
+TEST_F(PlacerTest, TestCostGraph) {
+  Graph g(OpRegistry::Global());
+  {  // Scope for temporary variables used to construct g.
+    GraphDefBuilder b(GraphDefBuilder::kFailImmediately);
+    Node* input = ops::SourceOp("TestInput", b.opts().WithName("in"));
+    ops::UnaryOp("TestRelu", ops::NodeOut(input, 0), b.opts().WithName("n1"));
+    ops::UnaryOp("TestRelu", ops::NodeOut(input, 1), b.opts().WithName("n2"));
+    ops::UnaryOp("TestRelu", ops::NodeOut(input, 1), b.opts().WithName("n3"));
+    TF_EXPECT_OK(BuildGraph(b, &g));
+  }
+
+  CostGraphDef cost_graph;
+  auto add_cost_node = [&cost_graph](const string& name, const string& device,
+                                     int64_t compute_micros) {
+    CostGraphDef::Node* node = cost_graph.add_node();
+    node->set_name(name);
+    node->set_device(device);
+    node->set_compute_cost(compute_micros);
+    return node;
+  };
+  CostGraphDef::Node* in =
+      add_cost_node("in", "/job:a/replica:0/task:0/device:FakeCPU:0", 1);
+  in->add_output_info()->set_size(4);
+  in->add_output_info()->set_size(int64_t{1} << 30);
+  // "n1" is faster on the CPU.
+  add_cost_node("n1", "/job:a/replica:0/task:0/device:FakeCPU:0", 10);
+  add_cost_node("n1", "/job:a/replica:0/task:0/device:FakeGPU:0", 100);
+  // "n2" is faster on the GPU, but not by enough to copy its input there.
+  add_cost_node("n2", "/job:a/replica:0/task:0/device:FakeCPU:0", 100);
+  add_cost_node("n2", "/job:a/replica:0/task:0/device:FakeGPU:0", 10);
+  // "n3" has only been profiled on one device type, so it is unaffected.
+  add_cost_node("n3", "/job:a/replica:0/task:0/device:FakeCPU:0", 10);
+
+  Placer placer(&g, "", &g.flib_def(), &devices_);
+  placer.set_cost_graph(&cost_graph);
+  TF_EXPECT_OK(placer.Run());
+  EXPECT_DEVICE_TYPE(g, "in", "FakeCPU");
+  EXPECT_DEVICE_TYPE(g, "n1", "FakeCPU");
+  EXPECT_DEVICE_TYPE(g, "n2", "FakeCPU");
+  EXPECT_DEVICE_TYPE(g, "n3", "FakeGPU");
+}
+
 // Test that a graph with no constraints but using kernels that have a specified
 // device priority will successfully assign nodes to the device with higher
 // priority
@@ -50,9 +50,13 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/dump_graph.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/ptr_util.h"
 #include "tensorflow/core/util/reffed_status_callback.h"
 #if !defined(IS_MOBILE_PLATFORM)
@@ -671,8 +675,125 @@ Status ValidateMultiDeviceOptions(
   return Status::OK();
 }
 
+// Returns the key of a multi-device function in the shared function cache.
+// `graph_def` is the instantiated function body, including the library it
+// reaches.
+Fprint128 SharedFunctionCacheKey(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const GraphDef& graph_def, const DeviceSet& dev_set,
+    const std::vector<string>& composite_device_names) {
+  // The library is identified by its contents in `graph_def`, rather than by
+  // its address.
+  FunctionLibraryRuntime::InstantiateOptions key_options = options;
+  key_options.lib_def = nullptr;
+  string key = Canonicalize(function_name, attrs, key_options);
+
+  // Options that are not part of the canonical key, but affect optimization or
+  // partitioning.
+  strings::StrAppend(
+      &key, "|", options.is_component_function ? 1 : 0,
+      options.default_device_to_target ? 1 : 0,
+      options.allow_small_function_optimizations ? 1 : 0,
+      options.allow_control_flow_sync_execution ? 1 : 0,
+      options.int_args_and_retvals_on_device ? 1 : 0,
+      options.shape_inference_on_tfe_dialect_import ? 1 : 0,
+      options.optimize_graph_fn ? 1 : 0, "|", options.xla_compile_device_type);
+  std::vector<string> composite_devices;
+  for (const auto& it : options.composite_devices) {
+    composite_devices.push_back(
+        strings::StrCat(it.first, "=", absl::StrJoin(*it.second, ",")));
+  }
+  std::sort(composite_devices.begin(), composite_devices.end());
+  strings::StrAppend(&key, "|", absl::StrJoin(composite_devices, ";"), "|",
+                     absl::StrJoin(composite_device_names, ";"));
+
+  std::vector<string> devices;
+  for (const Device* d : dev_set.devices()) {
+    devices.push_back(strings::StrCat(d->name(), "=", d->device_type()));
+  }
+  std::sort(devices.begin(), devices.end());
+  strings::StrAppend(&key, "|", absl::StrJoin(devices, ";"), "|");
+
+  string serialized_graph_def;
+  SerializeToStringDeterministic(graph_def, &serialized_graph_def);
+  const Fprint128 graph_fingerprint = Fingerprint128(serialized_graph_def);
+  strings::StrAppend(&key, graph_fingerprint.high64, ":",
+                     graph_fingerprint.low64);
+  return Fingerprint128(key);
+}
+
 }  // anonymous namespace
 
+/* static */
+ProcessFunctionLibraryRuntime::SharedFunctionCache*
+ProcessFunctionLibraryRuntime::SharedFunctionCache::Global() {
+  static SharedFunctionCache* cache = [] {
+    auto* cache = new SharedFunctionCache(/*capacity=*/256);
+    bool enabled = false;
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_ENABLE_SHARED_FUNCTION_CACHE", false, &enabled));
+    cache->set_enabled(enabled);
+    return cache;
+  }();
+  return cache;
+}
+
+std::shared_ptr<const ProcessFunctionLibraryRuntime::SharedFunctionCache::Entry>
+ProcessFunctionLibraryRuntime::SharedFunctionCache::Lookup(
+    const Fprint128& key) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    ++num_misses_;
+    return nullptr;
+  }
+  ++num_hits_;
+  lru_.splice(lru_.begin(), lru_, it->second.second);
+  return it->second.first;
+}
+
+void ProcessFunctionLibraryRuntime::SharedFunctionCache::Insert(
+    const Fprint128& key, std::shared_ptr<const Entry> entry) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    // Another runtime has instantiated the same function concurrently.
+    lru_.splice(lru_.begin(), lru_, it->second.second);
+    return;
+  }
+  if (entries_.size() >= capacity_ && !lru_.empty()) {
+    entries_.erase(lru_.back());
+    lru_.pop_back();
+  }
+  lru_.push_front(key);
+  entries_.emplace(key, std::make_pair(std::move(entry), lru_.begin()));
+}
+
+void ProcessFunctionLibraryRuntime::SharedFunctionCache::Clear() {
+  mutex_lock l(mu_);
+  entries_.clear();
+  lru_.clear();
+  num_hits_ = 0;
+  num_misses_ = 0;
+}
+
+size_t ProcessFunctionLibraryRuntime::SharedFunctionCache::size() const {
+  mutex_lock l(mu_);
+  return entries_.size();
+}
+
+int64_t ProcessFunctionLibraryRuntime::SharedFunctionCache::num_hits() const {
+  mutex_lock l(mu_);
+  return num_hits_;
+}
+
+int64_t ProcessFunctionLibraryRuntime::SharedFunctionCache::num_misses()
+    const {
+  mutex_lock l(mu_);
+  return num_misses_;
+}
+
 ProcessFunctionLibraryRuntime::AsyncAttributes::Summary
 ProcessFunctionLibraryRuntime::AsyncAttributes::Summarize(const Graph* graph) {
   bool has_send_op = false;
@@ -838,6 +959,66 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
 
   const std::shared_ptr<DeviceSet> dev_set = device_set();
 
+  SharedFunctionCache* shared_cache = SharedFunctionCache::Global();
+  const bool use_shared_cache =
+      shared_cache->enabled() && options.graph_collector == nullptr;
+  Fprint128 shared_cache_key;
+  if (use_shared_cache) {
+    std::vector<string> composite_device_names;
+    {
+      tf_shared_lock l(mu_);
+      for (const CompositeDevice* d : composite_devices_) {
+        composite_device_names.push_back(d->name());
+      }
+    }
+    shared_cache_key =
+        SharedFunctionCacheKey(function_name, attrs, options, graph_def,
+                               *dev_set, composite_device_names);
+    std::shared_ptr<const SharedFunctionCache::Entry> entry =
+        shared_cache->Lookup(shared_cache_key);
+    if (entry != nullptr) {
+      VLOG(1) << "Found MultiDevice function \"" << function_name
+              << "\" in the shared function cache";
+      auto data = absl::make_unique<MultiDeviceFunctionData>(
+          function_name, function_key, ret_node_names.size(),
+          FunctionLibraryDefinition(lib_def->default_registry(),
+                                    entry->library),
+          std::move(ret_types));
+      data->enable_sync_execution = entry->enable_sync_execution;
+      for (const auto& component : entry->components) {
+        data->glue_[component.first] = component.second.second;
+      }
+      StatusGroup group;
+      BlockingCounter counter(static_cast<int>(entry->components.size()));
+      mutex group_mu;
+      for (const auto& component : entry->components) {
+        const string& unique_name = component.second.first;
+        const FunctionDef* shard = data->lib_def_.Find(unique_name);
+        if (shard == nullptr) {
+          mutex_lock l(group_mu);
+          group.Update(errors::Internal("Missing component function ",
+                                        unique_name, " of ", function_name));
+          counter.DecrementCount();
+          continue;
+        }
+        InstantiateComponentFunction(
+            component.first, unique_name, AttrSlice(&shard->attr()), options,
+            data.get(), &data->glue_[component.first],
+            [&group, &group_mu, &counter](const Status& s) {
+              {
+                mutex_lock l(group_mu);
+                group.Update(s);
+              }
+              counter.DecrementCount();
+            });
+      }
+      counter.Wait();
+      TF_RETURN_IF_ERROR(group.as_summary_status());
+      *handle = AddMultiDeviceHandle(std::move(data), function_key);
+      return Status::OK();
+    }
+  }
+
   TF_RETURN_IF_ERROR(
       SetArgShape(options.input_resource_dtypes_and_shapes, arg_nodes));
   TF_RETURN_IF_ERROR(PinArgsAndRets(
@@ -1028,6 +1209,8 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
       data_lib_def, absl::StrCat(function_name, "_", random::New64()));
   auto num_subgraphs = subgraphs.size();
   gtl::InlinedVector<Status, 4> instantiate_status(num_subgraphs);
+  // Maps the device of each component function to its name.
+  std::unordered_map<string, string> component_names;
   BlockingCounter counter(static_cast<int>(num_subgraphs));
   auto runner = [this, num_subgraphs](std::function<void()> fn) {
     // NOTE: Only use thread pool to instantiate sub-function when there are
@@ -1060,6 +1243,7 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   for (const auto& pair : subgraphs) {
     Status* status = &instantiate_status[i];
     string unique_name = name_generator.GetName();
+    component_names[pair.first] = unique_name;
     ComponentFunctionData* comp_data = &data->glue_[pair.first];
     runner([this, &pair, dev_set, comp_data, unique_name, data_lib_def,
             &control_ret, &options, status, &counter, &data] {
@@ -1092,50 +1276,14 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
         counter.DecrementCount();
         return;
       }
-      FunctionLibraryRuntime::InstantiateOptions opts;
-      opts.executor_type = options.executor_type;
-      opts.target = target;
-      opts.lib_def = data_lib_def;
-      opts.create_kernels_eagerly = options.create_kernels_eagerly;
-      opts.state_handle = options.state_handle;
-      opts.allow_small_function_optimizations = data->enable_sync_execution;
-      opts.allow_control_flow_sync_execution =
-          options.allow_control_flow_sync_execution;
-      auto attrs = AttrSlice(&shard.attr());
-      VLOG(1) << "Start instantiating component function " << unique_name
-              << " on device " << target;
       VLOG(4) << DebugString(shard);
 
-      auto* component_handle = new FunctionLibraryRuntime::Handle;
-      auto done = [this, status, unique_name, comp_data, component_handle,
-                   &data, &counter](const Status& s) {
-        status->Update(s);
-
-        VLOG(1) << "Finished instantiating component function " << unique_name
-                << " with handle " << *component_handle << " status: " << s;
-        if (status->ok()) {
-          {
-            mutex_lock l(mu_);
-            if (function_data_[*component_handle]->is_cross_process()) {
-              data->is_cross_process_ = true;
-            }
-          }
-          comp_data->handle = *component_handle;
-        }
-        delete component_handle;
-        counter.DecrementCount();
-      };
-
-      FunctionLibraryRuntime* flr = GetFLR(opts.target);
-      if (flr != nullptr) {
-        // Initialize local function synchronously.
-        Status s = flr->Instantiate(unique_name, attrs, opts, component_handle);
-        done(s);
-      } else {
-        opts.ret_indices = comp_data->ret_indices;
-        // Initialize remote function asynchronously.
-        InstantiateRemote(unique_name, attrs, opts, component_handle, done);
-      }
+      InstantiateComponentFunction(target, unique_name, AttrSlice(&shard.attr()),
+                                   options, data.get(), comp_data,
+                                   [status, &counter](const Status& s) {
+                                     status->Update(s);
+                                     counter.DecrementCount();
+                                   });
     });
     i += 1;
   }
@@ -1146,12 +1294,75 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   }
   TF_RETURN_IF_ERROR(group.as_summary_status());
 
+  if (use_shared_cache) {
+    auto entry = std::make_shared<SharedFunctionCache::Entry>();
+    entry->library = data->lib_def_.ToProto();
+    entry->enable_sync_execution = data->enable_sync_execution;
+    for (const auto& pair : data->glue_) {
+      ComponentFunctionData comp_data = pair.second;
+      comp_data.handle = kInvalidHandle;
+      entry->components.emplace(
+          pair.first,
+          std::make_pair(component_names[pair.first], std::move(comp_data)));
+    }
+    shared_cache->Insert(shared_cache_key, std::move(entry));
+  }
+
   *handle = AddMultiDeviceHandle(std::move(data), function_key);
   VLOG(2) << "Instantiated MultiDevice function \"" << function_name
           << "\" with handle " << *handle;
   return Status::OK();
 }
 
+void ProcessFunctionLibraryRuntime::InstantiateComponentFunction(
+    const string& target, const string& unique_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    MultiDeviceFunctionData* data, ComponentFunctionData* comp_data,
+    FunctionLibraryRuntime::DoneCallback done) {
+  FunctionLibraryRuntime::InstantiateOptions opts;
+  opts.executor_type = options.executor_type;
+  opts.target = target;
+  opts.lib_def = &data->lib_def_;
+  opts.create_kernels_eagerly = options.create_kernels_eagerly;
+  opts.state_handle = options.state_handle;
+  opts.allow_small_function_optimizations = data->enable_sync_execution;
+  opts.allow_control_flow_sync_execution =
+      options.allow_control_flow_sync_execution;
+  VLOG(1) << "Start instantiating component function " << unique_name
+          << " on device " << target;
+
+  auto* component_handle = new FunctionLibraryRuntime::Handle;
+  auto instantiate_done = [this, unique_name, data, comp_data,
+                           component_handle,
+                           done = std::move(done)](const Status& s) {
+    VLOG(1) << "Finished instantiating component function " << unique_name
+            << " with handle " << *component_handle << " status: " << s;
+    if (s.ok()) {
+      {
+        mutex_lock l(mu_);
+        if (function_data_[*component_handle]->is_cross_process()) {
+          data->is_cross_process_ = true;
+        }
+      }
+      comp_data->handle = *component_handle;
+    }
+    delete component_handle;
+    done(s);
+  };
+
+  FunctionLibraryRuntime* flr = GetFLR(opts.target);
+  if (flr != nullptr) {
+    // Initialize local function synchronously.
+    Status s = flr->Instantiate(unique_name, attrs, opts, component_handle);
+    instantiate_done(s);
+  } else {
+    opts.ret_indices = comp_data->ret_indices;
+    // Initialize remote function asynchronously.
+    InstantiateRemote(unique_name, attrs, opts, component_handle,
+                      std::move(instantiate_done));
+  }
+}
+
 Status ProcessFunctionLibraryRuntime::GetOutputDevices(
     FunctionLibraryRuntime::Handle handle,
     std::vector<Device*>* output_devices) const {
@@ -15,7 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_FUNCTION_LIBRARY_RUNTIME_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_FUNCTION_LIBRARY_RUNTIME_H_
 
+#include <atomic>
 #include <functional>
+#include <list>
+#include <memory>
 #include <unordered_map>
 
 // clang-format off
@@ -23,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/platform/platform.h"
 // clang-format on
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/types/optional.h"
 #include "absl/types/variant.h"
 #include "tensorflow/core/common_runtime/composite_device.h"
@@ -31,6 +35,8 @@ limitations under the License.
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #if !defined(IS_MOBILE_PLATFORM)
 #include "tensorflow/core/protobuf/remote_tensor_handle.pb.h"
@@ -232,6 +238,9 @@ class ProcessFunctionLibraryRuntime {
     composite_devices_.push_back(d);
   }
 
+  // A process-wide cache of optimized and partitioned multi-device functions.
+  class SharedFunctionCache;
+
  protected:
   friend class FunctionLibraryRuntimeImpl;
 
@@ -388,6 +397,15 @@ class ProcessFunctionLibraryRuntime {
       const FunctionLibraryRuntime::InstantiateOptions& options,
       FunctionLibraryRuntime::Handle* handle);
 
+  // Instantiates the component function `unique_name` of `data`, which has
+  // already been added to `data->lib_def_`, on the device `target`. Sets
+  // `comp_data->handle` and calls `done` when finished.
+  void InstantiateComponentFunction(
+      const string& target, const string& unique_name, AttrSlice attrs,
+      const FunctionLibraryRuntime::InstantiateOptions& options,
+      MultiDeviceFunctionData* data, ComponentFunctionData* comp_data,
+      FunctionLibraryRuntime::DoneCallback done);
+
   void InstantiateRemote(
       const string& function_name, AttrSlice attrs,
       const FunctionLibraryRuntime::InstantiateOptions& options,
@@ -540,6 +558,73 @@ class ProcessFunctionLibraryRuntime {
   const int graph_def_version_;
 };
 
+// Caches the component functions of multi-device functions across instances
+// of ProcessFunctionLibraryRuntime.
+//
+// Instantiating a multi-device function runs the function optimization
+// passes, placement, the graph optimization passes (including grappler) and
+// partitioning, which can dominate the time to load a model. Runtimes that
+// instantiate the same function, e.g. when several versions of a SavedModel
+// or several sessions share a function library, reuse the result instead.
+// Entries are keyed by a fingerprint of the function body and the library it
+// reaches, the instantiation options and the device set.
+//
+// The global cache is disabled unless the TF_ENABLE_SHARED_FUNCTION_CACHE
+// environment variable is true, since the result of
+// `InstantiateOptions::optimize_graph_fn` is assumed to depend only on the
+// graph and the options.
+class ProcessFunctionLibraryRuntime::SharedFunctionCache {
+ public:
+  struct Entry {
+    // The library of the multi-device function, including its components.
+    FunctionDefLibrary library;
+    bool enable_sync_execution = false;
+    // Maps the device of each component function to its function name and
+    // its data. The handles in the data are not set.
+    std::unordered_map<string, std::pair<string, ComponentFunctionData>>
+        components;
+  };
+
+  explicit SharedFunctionCache(size_t capacity) : capacity_(capacity) {}
+
+  static SharedFunctionCache* Global();
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+  void set_enabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+
+  // Returns the entry for `key`, or nullptr.
+  std::shared_ptr<const Entry> Lookup(const Fprint128& key)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Adds `entry` for `key`, evicting the least recently used entry if the
+  // cache is full.
+  void Insert(const Fprint128& key, std::shared_ptr<const Entry> entry)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  void Clear() TF_LOCKS_EXCLUDED(mu_);
+
+  size_t size() const TF_LOCKS_EXCLUDED(mu_);
+  int64_t num_hits() const TF_LOCKS_EXCLUDED(mu_);
+  int64_t num_misses() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  const size_t capacity_;
+  std::atomic<bool> enabled_{false};
+
+  mutable mutex mu_;
+  // Keys in order of use, most recent first.
+  std::list<Fprint128> lru_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<Fprint128,
+                      std::pair<std::shared_ptr<const Entry>,
+                                std::list<Fprint128>::iterator>,
+                      Fprint128Hasher>
+      entries_ TF_GUARDED_BY(mu_);
+  int64_t num_hits_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_misses_ TF_GUARDED_BY(mu_) = 0;
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_FUNCTION_LIBRARY_RUNTIME_H_
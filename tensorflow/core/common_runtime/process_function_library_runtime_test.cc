@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -788,6 +789,41 @@ TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_FlipBoth) {
       this, MakeOptions("CPU:0", {"GPU:0", "CPU:0"}, {"GPU:0", "CPU:0"}));
 }
 
+TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_SharedFunctionCache) {
+  auto* cache = ProcessFunctionLibraryRuntime::SharedFunctionCache::Global();
+  cache->Clear();
+  cache->set_enabled(true);
+  auto cleanup = gtl::MakeCleanup([cache]() {
+    cache->set_enabled(false);
+    cache->Clear();
+  });
+  FunctionLibraryRuntime::InstantiateOptions inst_opts =
+      MakeOptions("CPU:0", {"CPU:1"}, {"CPU:0"});
+  FunctionLibraryRuntime::Options opts;
+  const Tensor x = test::AsTensor<float>({1, 2, 3});
+  Tensor y;
+
+  Init({test::function::XTimesTwo()});
+  TF_CHECK_OK(Run("XTimesTwo", opts, {{"T", DT_FLOAT}}, inst_opts, {x}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6}));
+  EXPECT_EQ(0, cache->num_hits());
+  EXPECT_EQ(1, cache->size());
+
+  // A new runtime over an identical library reuses the component functions.
+  Init({test::function::XTimesTwo()});
+  TF_CHECK_OK(Run("XTimesTwo", opts, {{"T", DT_FLOAT}}, inst_opts, {x}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6}));
+  EXPECT_EQ(1, cache->num_hits());
+  EXPECT_EQ(1, cache->size());
+
+  // Different instantiation options miss.
+  inst_opts.output_devices = CompleteDevices({"CPU:1"});
+  TF_CHECK_OK(Run("XTimesTwo", opts, {{"T", DT_FLOAT}}, inst_opts, {x}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6}));
+  EXPECT_EQ(1, cache->num_hits());
+  EXPECT_EQ(2, cache->size());
+}
+
 TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_EmptyBodySwap) {
   if (gpu_device_ == nullptr) {
     GTEST_SKIP() << "No GPUs available";
@@ -71,6 +71,8 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
 
   mutex_lock lock(mu_);
   while (cpu_allocators_.size() <= static_cast<size_t>(numa_node)) {
+    // The allocator for the node at index `node` of `cpu_allocators_`.
+    const int node = cpu_allocators_.size();
     // If visitors have been defined we need an Allocator built from
     // a SubAllocator.  Prefer BFCAllocator, but fall back to PoolAllocator
     // depending on env var setting.
@@ -86,7 +88,7 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
     SubAllocator* sub_allocator =
         (numa_enabled_ || alloc_visitors_defined || use_bfc_allocator)
             ? new BasicCPUAllocator(
-                  numa_enabled_ ? numa_node : port::kNUMANoAffinity,
+                  numa_enabled_ ? node : port::kNUMANoAffinity,
                   cpu_alloc_visitors_, cpu_free_visitors_)
             : nullptr;
     if (use_bfc_allocator) {
@@ -116,7 +118,7 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
                             sub_allocator, new NoopRounder, "cpu_pool");
       VLOG(2) << "Using PoolAllocator for ProcessState CPU allocator "
               << "numa_enabled_=" << numa_enabled_
-              << " numa_node=" << numa_node;
+              << " numa_node=" << node;
     } else {
       DCHECK(!sub_allocator);
       allocator = cpu_allocator_base();
@@ -22,7 +22,10 @@ limitations under the License.
 #endif  // defined(ENABLE_MKL) && defined(ENABLE_ONEDNN_OPENMP)
 #include <string.h>
 
+#include <algorithm>
+
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
@@ -154,12 +157,23 @@ int32 NumInterOpThreadsFromSessionOptions(const SessionOptions& options) {
 }
 
 thread::ThreadPool* NewThreadPoolFromSessionOptions(
-    const SessionOptions& options) {
-  const int32_t num_threads = NumInterOpThreadsFromSessionOptions(options);
-  VLOG(1) << "Session inter op parallelism threads: " << num_threads;
+    const SessionOptions& options, int numa_node) {
+  int32_t num_threads = NumInterOpThreadsFromSessionOptions(options);
+  if (numa_node == port::kNUMANoAffinity) {
+    VLOG(1) << "Session inter op parallelism threads: " << num_threads;
+    return new thread::ThreadPool(
+        options.env, ThreadOptions(), "Compute", num_threads,
+        !options.config.experimental().disable_thread_spinning(),
+        /*allocator=*/nullptr);
+  }
+  num_threads = std::min(num_threads, port::MaxParallelism(numa_node));
+  VLOG(1) << "Session inter op parallelism threads for NUMA node "
+          << numa_node << ": " << num_threads;
+  ThreadOptions thread_opts;
+  thread_opts.numa_node = numa_node;
   return new thread::ThreadPool(
-      options.env, ThreadOptions(), "Compute", num_threads,
-      !options.config.experimental().disable_thread_spinning(),
+      options.env, thread_opts, strings::StrCat("numa_", numa_node, "_Compute"),
+      num_threads, !options.config.experimental().disable_thread_spinning(),
       /*allocator=*/nullptr);
 }
 
@@ -19,6 +19,7 @@ limitations under the License.
 #include <functional>
 
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/public/session_options.h"
 
 // TODO(vrv, mrry): Remove this library: its interface circumvents the
@@ -44,9 +45,11 @@ int32 NumIntraOpThreadsFromEnvironment();
 // on the number of schedulable CPUs, and any MKL and OpenMP configurations.
 int32 NumInterOpThreadsFromSessionOptions(const SessionOptions& options);
 
-// Creates a thread pool with number of inter op threads.
+// Creates a thread pool with number of inter op threads. If `numa_node` is not
+// kNUMANoAffinity, the threads are pinned to that NUMA node and there are at
+// most as many as the node has schedulable CPUs.
 thread::ThreadPool* NewThreadPoolFromSessionOptions(
-    const SessionOptions& options);
+    const SessionOptions& options, int numa_node = port::kNUMANoAffinity);
 
 // Schedule "closure" in the default thread queue.
 void SchedClosure(std::function<void()> closure);
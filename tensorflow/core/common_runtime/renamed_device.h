@@ -68,6 +68,15 @@ class RenamedDevice : public Device {
     return underlying_device_->GetScopedAllocatorMgr();
   }
 
+  Allocator* GetStepAllocator(AllocatorAttributes attr,
+                              int64_t step_id) override {
+    return underlying_device_->GetStepAllocator(attr, step_id);
+  }
+
+  StepArenaAllocatorMgr* GetStepArenaAllocatorMgr() const override {
+    return underlying_device_->GetStepArenaAllocatorMgr();
+  }
+
   const Eigen::ThreadPoolDevice* eigen_cpu_device() override {
     // Use the underlying threadpool only if the underlying device supports
     // eigen_cpu_device.
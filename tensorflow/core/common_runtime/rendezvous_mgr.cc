@@ -155,8 +155,8 @@ void IntraProcessRecvAsyncImpl(const DeviceMgr* device_mgr,
 }  // namespace
 
 RefCountedIntraProcessRendezvous::RefCountedIntraProcessRendezvous(
-    const DeviceMgr* device_mgr)
-    : device_mgr_(device_mgr), local_(this) {}
+    const DeviceMgr* device_mgr, int num_shards)
+    : device_mgr_(device_mgr), local_(this, num_shards) {}
 
 RefCountedIntraProcessRendezvous::~RefCountedIntraProcessRendezvous() {}
 
@@ -184,8 +184,8 @@ Status RefCountedIntraProcessRendezvous::GetLocalRendezvousStatus() {
 }
 
 PrivateIntraProcessRendezvous::PrivateIntraProcessRendezvous(
-    const DeviceMgr* device_mgr)
-    : device_mgr_(device_mgr), local_(nullptr) {}
+    const DeviceMgr* device_mgr, int num_shards)
+    : device_mgr_(device_mgr), local_(nullptr, num_shards) {}
 
 PrivateIntraProcessRendezvous::~PrivateIntraProcessRendezvous() {}
 
@@ -42,7 +42,9 @@ namespace tensorflow {
 // Reference-counted implementation that may be shared between multiple threads.
 class RefCountedIntraProcessRendezvous : public Rendezvous {
  public:
-  explicit RefCountedIntraProcessRendezvous(const DeviceMgr* device_mgr);
+  // `num_shards` is forwarded to the underlying `LocalRendezvous`.
+  explicit RefCountedIntraProcessRendezvous(const DeviceMgr* device_mgr,
+                                            int num_shards = 1);
 
   // Implementation of RendezvousInterface methods.
   Status Send(const ParsedKey& key, const Rendezvous::Args& args,
@@ -77,7 +79,9 @@ using IntraProcessRendezvous = RefCountedIntraProcessRendezvous;
 // Prefer to use PrivateIntraProcessRendezvous in new code.
 class PrivateIntraProcessRendezvous : public RendezvousInterface {
  public:
-  explicit PrivateIntraProcessRendezvous(const DeviceMgr* device_mgr);
+  // `num_shards` is forwarded to the underlying `LocalRendezvous`.
+  explicit PrivateIntraProcessRendezvous(const DeviceMgr* device_mgr,
+                                         int num_shards = 1);
   ~PrivateIntraProcessRendezvous() override;
 
   // Implementation of RendezvousInterface methods.
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <atomic>
 #include <functional>
+#include <memory>
 #include <utility>
 
 #include "tensorflow/core/common_runtime/collective_rma_local.h"
@@ -73,6 +74,28 @@ string RingAlgBufKey(const string& name, const string& exec_key, int pass,
   }
 }
 
+// Converts the float values of `src` to `dst`, which has the wire dtype.
+void ConvertToWire(const Tensor& src, Tensor* dst) {
+  auto src_flat = src.unaligned_flat<float>();
+  if (dst->dtype() == DT_HALF) {
+    dst->unaligned_flat<Eigen::half>() = src_flat.cast<Eigen::half>();
+  } else {
+    DCHECK_EQ(dst->dtype(), DT_BFLOAT16);
+    dst->unaligned_flat<bfloat16>() = src_flat.cast<bfloat16>();
+  }
+}
+
+// Converts `src`, which has the wire dtype, back to the float values of `dst`.
+void ConvertFromWire(const Tensor& src, Tensor* dst) {
+  auto dst_flat = dst->unaligned_flat<float>();
+  if (src.dtype() == DT_HALF) {
+    dst_flat = src.unaligned_flat<Eigen::half>().cast<float>();
+  } else {
+    DCHECK_EQ(src.dtype(), DT_BFLOAT16);
+    dst_flat = src.unaligned_flat<bfloat16>().cast<float>();
+  }
+}
+
 }  // namespace
 
 void RingAlg::PCQueue::Enqueue(RingField* rf) {
@@ -404,13 +427,29 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
   int send_to_rank = (rf->rank + 1) % group_size_;
   int send_to_dev_idx = col_params_->instance.impl_details
                             .subdiv_permutations[rf->subdiv_idx][send_to_rank];
+  const Tensor* send_tensor = &rf->chunk;
+  StatusCallback send_done = done;
+  if (wire_dtype_ != DT_INVALID) {
+    auto wire_chunk = std::make_shared<Tensor>(
+        col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0)),
+        wire_dtype_, rf->chunk.shape());
+    ConvertToWire(rf->chunk, wire_chunk.get());
+    if (rf->second_pass) {
+      // Peers only ever see the converted final value, so round the local
+      // copy as well to keep the result identical on all devices.
+      ConvertFromWire(*wire_chunk, &rf->chunk);
+    }
+    send_tensor = wire_chunk.get();
+    // Keep the wire chunk alive until the send completes.
+    send_done = [wire_chunk, done](const Status& s) { done(s); };
+  }
   col_ctx_->col_exec->remote_access()->PostToPeer(
       col_params_->group.members[send_to_dev_idx].device.name(),
       col_params_->group.members[send_to_dev_idx].task, send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
+      col_ctx_->op_ctx->output_alloc_attr(0), send_tensor,
       col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
-      done);
+      send_done);
 }
 
 void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
@@ -424,14 +463,28 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
   Tensor* dst_tensor = (!rf->second_pass && (col_params_->merge_op != nullptr))
                            ? &rf->tmp_chunk
                            : &rf->chunk;
+  Tensor* recv_tensor = dst_tensor;
+  StatusCallback recv_done = done;
+  if (wire_dtype_ != DT_INVALID) {
+    auto wire_chunk = std::make_shared<Tensor>(
+        col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0)),
+        wire_dtype_, dst_tensor->shape());
+    recv_tensor = wire_chunk.get();
+    recv_done = [wire_chunk, dst_tensor, done](const Status& s) {
+      if (s.ok()) {
+        ConvertFromWire(*wire_chunk, dst_tensor);
+      }
+      done(s);
+    };
+  }
   col_ctx_->col_exec->remote_access()->RecvFromPeer(
       col_params_->group.members[rf->recv_dev_idx].device.name(),
       col_params_->group.members[rf->recv_dev_idx].task,
       col_params_->group.members[rf->recv_dev_idx].is_local, recv_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), dst_tensor,
+      col_ctx_->op_ctx->output_alloc_attr(0), recv_tensor,
       col_ctx_->device_locality, rf->subdiv_idx,
-      col_ctx_->op_ctx->cancellation_manager(), done);
+      col_ctx_->op_ctx->cancellation_manager(), recv_done);
 }
 
 string RingAlg::FieldState() {
@@ -114,6 +114,10 @@ class RingAlg : public CollectiveImplementationInterface {
   mutex status_mu_;
   Status status_ TF_GUARDED_BY(status_mu_);
   std::vector<RingField> rfv_;
+  // If not DT_INVALID, float chunks are converted to this type before being
+  // sent to a peer and converted back after being received, trading precision
+  // for less traffic.  Must agree across all members of the group.
+  DataType wire_dtype_ = DT_INVALID;
 };
 
 }  // namespace tensorflow
@@ -42,6 +42,17 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme.h"
 
 namespace tensorflow {
+namespace {
+
+// Returns the dtype float chunks are sent as for `communication_hint`, or
+// DT_INVALID if chunks are sent uncompressed.
+DataType WireDtypeFromCommunicationHint(const string& communication_hint) {
+  if (communication_hint == "ring_fp16") return DT_HALF;
+  if (communication_hint == "ring_bf16") return DT_BFLOAT16;
+  return DT_INVALID;
+}
+
+}  // namespace
 
 RingReducer::~RingReducer() { group_size_tensor_ready_.WaitForNotification(); }
 
@@ -64,6 +75,19 @@ void RingReducer::Run(StatusCallback done) {
   num_subdivs_ = static_cast<int>(
       col_params_->instance.impl_details.subdiv_permutations.size());
   CHECK_GT(num_subdivs_, 0);
+  wire_dtype_ = WireDtypeFromCommunicationHint(
+      col_params_->instance.impl_details.communication_hint);
+  if (wire_dtype_ != DT_INVALID &&
+      (col_params_->instance.data_type != DT_FLOAT ||
+       col_params_->group.device_type != "CPU")) {
+    // Conversion is done on the host, so it is only applied to float tensors
+    // that reside in host memory.
+    VLOG(1) << "Ignoring communication_hint "
+            << col_params_->instance.impl_details.communication_hint
+            << " for " << DataTypeString(col_params_->instance.data_type)
+            << " on " << col_params_->group.device_type;
+    wire_dtype_ = DT_INVALID;
+  }
 
   if (VLOG_IS_ON(1)) {
     string buf;
@@ -154,6 +154,35 @@ class RingReducerTest : public ::testing::Test {
     }
   }
 
+  // Reduces small integer values that are exactly representable in half
+  // and bfloat16, so that compressed chunks must give the exact result.
+  void RunCompressedTest(const string& communication_hint, int num_devices,
+                         int tensor_len) {
+    Init(/*num_workers=*/1, num_devices, DT_FLOAT, TensorShape({tensor_len}),
+         DEVICE_CPU, /*num_subdivs=*/1, /*fail_after=*/0);
+    std::vector<float> expected(tensor_len);
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      instances_[di]->col_params_->instance.impl_details.communication_hint =
+          communication_hint;
+      instances_[di]->InitTensor([&expected, di](Tensor* t) {
+        for (size_t i = 0; i < t->NumElements(); ++i) {
+          float value = di + (i % 16);
+          t->flat<float>()(i) = value;
+          expected[i] += value;
+        }
+      });
+    }
+    Reduce(/*fail_after=*/0);
+    for (int i = 0; i < tensor_len; ++i) {
+      expected[i] /= static_cast<float>(num_devices);
+    }
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      TF_EXPECT_OK(instances_[di]->status_);
+      test::ExpectTensorEqual<float>(test::AsTensor<float>(expected),
+                                     instances_[di]->tensor());
+    }
+  }
+
   class DeviceInstance {
    public:
     DeviceInstance(int rank, int num_subdivs, DataType dtype,
@@ -428,6 +457,14 @@ DEF_TEST(INT64, CPU, 2, 8, 3, 4095, 0)
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 1)
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 7)
 DEF_TEST(FLOAT, CPU, 2, 8, 2, 9408, 11)
+
+TEST_F(RingReducerTest, Fp16WireCompression) {
+  RunCompressedTest("ring_fp16", /*num_devices=*/4, /*tensor_len=*/1001);
+}
+
+TEST_F(RingReducerTest, Bf16WireCompression) {
+  RunCompressedTest("ring_bf16", /*num_devices=*/4, /*tensor_len=*/1001);
+}
 #endif
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 
 namespace tensorflow {
 
@@ -157,6 +158,18 @@ Status ShapeRefiner::InferShapesForFunctionSubNode(
 Status ShapeRefiner::InferShapesForFunction(
     const FunctionDef* function_def, AttrSlice attributes,
     ExtendedInferenceContext* outer_context) {
+  // Calls with the same inputs, which most graphs with many calls of a
+  // function have, are inferred once.
+  FunctionShapeInferenceCache* cache = FunctionShapeInferenceCache::Global();
+  const Fprint128 key =
+      FunctionCallKey(function_def, attributes, outer_context);
+  std::shared_ptr<const FunctionShapeInferenceCache::Outputs> cached_outputs =
+      cache->Lookup(key);
+  if (cached_outputs != nullptr) {
+    return FunctionShapeInferenceCache::SetOutputShapes(
+        *cached_outputs, outer_context->get_context());
+  }
+
   const Graph* graph;
   auto it = functions_.find(function_def);
   if (it != functions_.end()) {
@@ -201,9 +214,76 @@ Status ShapeRefiner::InferShapesForFunction(
     node_to_context_.erase(node);
   }
 
+  if (inference_status.ok()) {
+    absl::optional<FunctionShapeInferenceCache::Outputs> outputs =
+        FunctionOutputsToCache(outer_context->get_context());
+    if (outputs.has_value()) cache->Insert(key, *std::move(outputs));
+  }
   return inference_status;
 }
 
+Fprint128 ShapeRefiner::FunctionCallKey(
+    const FunctionDef* function_def, AttrSlice attributes,
+    ExtendedInferenceContext* outer_context) {
+  auto it = function_fingerprints_.find(function_def);
+  if (it == function_fingerprints_.end()) {
+    it = function_fingerprints_
+             .emplace(function_def,
+                      FunctionShapeInferenceCache::FingerprintFunction(
+                          *function_def, *function_library_))
+             .first;
+  }
+
+  // The results depend on the options that shape inference in the function
+  // body runs with. Constant values are not propagated into function bodies.
+  FunctionShapeInferenceCache::KeyBuilder key(strings::StrCat(
+      "ShapeRefiner/", graph_def_version_, "/", require_shape_inference_fns_,
+      "/", disable_constant_propagation_));
+  key.AddFunction(it->second);
+  key.AddAttrs(attributes);
+  InferenceContext* c = outer_context->get_context();
+  for (int i = 0; i < c->num_inputs(); ++i) {
+    TensorShapeProto shape;
+    c->ShapeHandleToProto(c->input(i), &shape);
+    key.AddInput(outer_context->input_type(i), shape);
+    const std::vector<ShapeAndType>* handle_shapes_and_types =
+        c->input_handle_shapes_and_types(i);
+    if (handle_shapes_and_types == nullptr) continue;
+    std::vector<FunctionShapeInferenceCache::HandleShapeAndType> handle_data(
+        handle_shapes_and_types->size());
+    for (int j = 0, end = handle_data.size(); j < end; ++j) {
+      const ShapeAndType& shape_and_type = (*handle_shapes_and_types)[j];
+      handle_data[j].dtype = shape_and_type.dtype;
+      c->ShapeHandleToProto(shape_and_type.shape, &handle_data[j].shape);
+      handle_data[j].type = shape_and_type.type;
+    }
+    key.AddInputHandleShapesAndTypes(handle_data);
+  }
+  return key.Build();
+}
+
+absl::optional<FunctionShapeInferenceCache::Outputs>
+ShapeRefiner::FunctionOutputsToCache(InferenceContext* c) {
+  FunctionShapeInferenceCache::Outputs outputs(c->num_outputs());
+  for (int i = 0; i < c->num_outputs(); ++i) {
+    // An output that the function body did not set cannot be restored.
+    if (!c->output(i).IsSet()) return absl::nullopt;
+    c->ShapeHandleToProto(c->output(i), &outputs[i].shape);
+    const std::vector<ShapeAndType>* handle_shapes_and_types =
+        c->output_handle_shapes_and_types(i);
+    if (handle_shapes_and_types == nullptr) continue;
+    outputs[i].handle_shapes_and_types.emplace();
+    for (const ShapeAndType& shape_and_type : *handle_shapes_and_types) {
+      outputs[i].handle_shapes_and_types->emplace_back();
+      auto& handle_data = outputs[i].handle_shapes_and_types->back();
+      handle_data.dtype = shape_and_type.dtype;
+      c->ShapeHandleToProto(shape_and_type.shape, &handle_data.shape);
+      handle_data.type = shape_and_type.type;
+    }
+  }
+  return outputs;
+}
+
 Status ShapeRefiner::AddNode(const Node* node) {
   return AddNodeInternal(node, /*outer_context=*/nullptr);
 }
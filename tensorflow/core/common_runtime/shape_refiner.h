@@ -18,6 +18,8 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+#include "tensorflow/core/common_runtime/function_shape_inference_cache.h"
 #include "tensorflow/core/common_runtime/graph_runner.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/shape_inference.h"
@@ -184,6 +186,16 @@ class ShapeRefiner {
                                 AttrSlice attributes,
                                 ExtendedInferenceContext* outer_context);
 
+  // Returns the key of the call of `function_def` with `attributes` under
+  // FunctionShapeInferenceCache, from the inputs of `outer_context`.
+  Fprint128 FunctionCallKey(const FunctionDef* function_def,
+                            AttrSlice attributes,
+                            ExtendedInferenceContext* outer_context);
+
+  // Returns the outputs of `c` to cache, or nullopt if they cannot be cached.
+  static absl::optional<FunctionShapeInferenceCache::Outputs>
+  FunctionOutputsToCache(shape_inference::InferenceContext* c);
+
   // Performs shape inference for a node inside a function.
   //
   // 'outer_context' is the 'InferenceContext' for the function's call op.
@@ -326,6 +338,11 @@ class ShapeRefiner {
                       hash<const FunctionDef*>>
       functions_;
 
+  // The FunctionShapeInferenceCache::FingerprintFunction() of each function
+  // definition for which shapes are refined.
+  absl::flat_hash_map<const FunctionDef*, Fprint128, hash<const FunctionDef*>>
+      function_fingerprints_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ShapeRefiner);
 };
 
@@ -1494,6 +1494,38 @@ TEST_F(ShapeRefinerTest, FunctionShapeInferenceFallback) {
   EXPECT_SHAPE("?", m, x2, 0);
 }
 
+TEST_F(ShapeRefinerTest, FunctionShapeInferenceIsCached) {
+  FunctionDefLibrary f_lib_proto;
+  *(f_lib_proto.add_function()) = test::function::XTimesTwo();
+  FunctionLibraryDefinition f_lib(OpRegistry::Global(), f_lib_proto);
+
+  Scope root = Scope::NewRootScope();
+  TF_ASSERT_OK(root.graph()->AddFunctionLibrary(f_lib_proto));
+  auto x = ops::Placeholder(root, DT_FLOAT, ops::Placeholder::Shape({7, 11}));
+  auto y = ops::Placeholder(root, DT_FLOAT, ops::Placeholder::Shape({7, 11}));
+  auto z = ops::Placeholder(root, DT_FLOAT, ops::Placeholder::Shape({13}));
+  auto x2 = test::function::Call(&root, "x2", "XTimesTwo", {x});
+  auto y2 = test::function::Call(&root, "y2", "XTimesTwo", {y});
+  auto z2 = test::function::Call(&root, "z2", "XTimesTwo", {z});
+
+  FunctionShapeInferenceCache* cache = FunctionShapeInferenceCache::Global();
+  for (int refiner = 0; refiner < 2; ++refiner) {
+    ShapeRefiner m(TF_GRAPH_DEF_VERSION, &f_lib);
+    m.set_function_library_for_shape_inference(&f_lib);
+    const int64 num_hits = cache->num_hits();
+    for (const Output& output : std::vector<Output>{x, y, z, x2, y2, z2}) {
+      TF_ASSERT_OK(m.AddNode(output.node()));
+    }
+
+    EXPECT_SHAPE("[7,11]", m, x2, 0);
+    EXPECT_SHAPE("[7,11]", m, y2, 0);
+    EXPECT_SHAPE("[13]", m, z2, 0);
+    // The first refiner infers the body of XTimesTwo for both input shapes,
+    // and the second one infers none.
+    EXPECT_EQ(cache->num_hits() - num_hits, refiner == 0 ? 1 : 3);
+  }
+}
+
 TEST_F(ShapeRefinerTest, ChainedFunctionShapeInferenceWithMultipleInputs) {
   FunctionDefLibrary f_lib_proto;
   *(f_lib_proto.add_function()) = test::function::XTimesTwo();
@@ -0,0 +1,111 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/static_schedule_propagator_state.h"
+
+#include "tensorflow/core/common_runtime/propagator_debug_utils.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+
+StaticSchedulePropagatorState::StaticSchedulePropagatorState(
+    const ImmutableExecutorState& immutable_state, int64_t step_id, bool vlog)
+    : immutable_state_(immutable_state),
+      schedule_(*immutable_state.static_schedule()),
+      gview_(immutable_state.graph_view()),
+      step_id_(step_id),
+      vlog_(vlog || VLOG_IS_ON(1)),
+      input_tensors_(immutable_state.get_root_frame_info().total_inputs),
+      pending_(new std::atomic<int32>[gview_.num_nodes()]),
+      active_(vlog_ ? new std::vector<bool>(gview_.num_nodes()) : nullptr) {
+  for (int32_t i = 0; i < gview_.num_nodes(); ++i) {
+    pending_[i].store(schedule_.pending_counts[i], std::memory_order_relaxed);
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+StaticSchedulePropagatorState::~StaticSchedulePropagatorState() {}
+
+void StaticSchedulePropagatorState::ActivateRoots(
+    gtl::ArraySlice<const NodeItem*> roots, TaggedNodeSeq* ready) {
+  for (const NodeItem* item : roots) {
+    DCHECK_EQ(item->num_inputs, 0);
+    if (schedule_.pending_counts[item->node_id] == 0) {
+      ready->push_back(TaggedNode{item});
+    }
+  }
+}
+
+void StaticSchedulePropagatorState::PropagateOutputs(
+    const TaggedNode& tagged_node, EntryVector* outputs,
+    TaggedNodeSeq* ready) {
+  profiler::TraceMe activity(
+      [&]() {
+        return strings::StrCat(
+            "ExecutorPropagateOutputs#", "id=", step_id_,
+            ",kernel_name=", tagged_node.node_item->kernel->name_view(),
+            ",num_output_edges=", tagged_node.node_item->num_output_edges,
+            ",num_output_control_edges=",
+            tagged_node.node_item->num_output_control_edges, "#");
+      },
+      profiler::GetTFTraceMeLevel(/*is_expensive=*/false));
+
+  DCHECK(ready->empty());
+
+  const NodeItem* item = tagged_node.node_item;
+  const int32 lane = schedule_.lane[item->node_id];
+
+  for (const EdgeInfo& e : item->output_edges()) {
+    // NOTE: The write to `input_tensors_[dst_loc]` must happen before the
+    // pending count update (or, for a destination in the same lane, before
+    // the hand-off to the next node in the lane below).
+    if (e.is_last) {
+      input_tensors_[e.input_slot] = std::move((*outputs)[e.output_slot]);
+    } else {
+      input_tensors_[e.input_slot] = (*outputs)[e.output_slot];
+    }
+    if (schedule_.lane[e.dst_id] != lane) DecrementPending(e.dst_id, ready);
+  }
+
+  for (const ControlEdgeInfo& e : item->output_control_edges()) {
+    if (schedule_.lane[e.dst_id] != lane) DecrementPending(e.dst_id, ready);
+  }
+
+  const int32 successor = schedule_.lane_successor[item->node_id];
+  if (successor >= 0) DecrementPending(successor, ready);
+}
+
+void StaticSchedulePropagatorState::DumpState() {
+  mutex_lock l(mu_);
+  const std::vector<const NodeItem*>& nodes =
+      *immutable_state_.get_root_frame_info().nodes;
+  // Dump any waiting nodes that are holding on to tensors.
+  for (const NodeItem* node : nodes) {
+    if (schedule_.pending_counts[node->node_id] > 1 &&
+        pending_[node->node_id]) {
+      DumpPendingNodeState(*node, input_tensors_.data(), false);
+    }
+  }
+  // Then the active nodes.
+  if (active_ != nullptr) {
+    for (const NodeItem* node : nodes) {
+      if ((*active_)[node->node_id]) {
+        DumpActiveNodeState(*node, input_tensors_.data());
+      }
+    }
+  }
+}
+
+}  // namespace tensorflow
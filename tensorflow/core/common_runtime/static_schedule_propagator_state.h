@@ -0,0 +1,131 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_SCHEDULE_PROPAGATOR_STATE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_SCHEDULE_PROPAGATOR_STATE_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/entry.h"
+#include "tensorflow/core/common_runtime/immutable_executor_state.h"
+#include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/framework/control_flow.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Represents the ephemeral "edge state" associated with one invocation of
+// `Executor::Run()` that replays the `StaticSchedule` of an
+// `ImmutableExecutorState`.
+//
+// Like `SimplePropagatorState`, this does not support "v1-style" control flow.
+// Unlike `SimplePropagatorState`, it does not count every input edge: a node
+// becomes runnable when the preceding node in its lane has completed and its
+// inputs from other lanes have arrived. Edges between nodes of the same lane
+// are implied by the lane order and carry no atomic update, and a node whose
+// inputs all come from its own lane is dispatched directly by its lane
+// predecessor.
+class StaticSchedulePropagatorState {
+ public:
+  StaticSchedulePropagatorState(const ImmutableExecutorState& immutable_state,
+                                int64_t step_id, bool vlog);
+  ~StaticSchedulePropagatorState();
+
+  typedef SimplePropagatorState::TaggedNode TaggedNode;
+  typedef SimplePropagatorState::TaggedNodeReadyQueue TaggedNodeReadyQueue;
+  typedef SimplePropagatorState::TaggedNodeSeq TaggedNodeSeq;
+
+  // Adds the first node of each lane that has no inputs to `*ready`. The
+  // remaining nodes in `roots` are dispatched in lane order.
+  void ActivateRoots(gtl::ArraySlice<const NodeItem*> roots,
+                     TaggedNodeSeq* ready);
+
+  // After processing the outputs, propagates the outputs to their dsts.
+  // Contents of *outputs are left in an indeterminate state after
+  // returning from this method.
+  void PropagateOutputs(const TaggedNode& tagged_node, EntryVector* outputs,
+                        TaggedNodeSeq* ready);
+
+  // Returns an array of `Entry` objects corresponding to the inputs of
+  // `tagged_node`.
+  Entry* GetInputTensors(const TaggedNode& tagged_node) {
+    return input_tensors_.data() + tagged_node.node_item->input_start;
+  }
+
+  FrameAndIter GetFrameAndIter(const TaggedNode& tagged_node) const {
+    return {0, 0};
+  }
+
+  // Provide debugging output of the state of the executor.
+  void DumpState();
+
+  // For debugging/logging only.
+  void MaybeMarkStarted(const TaggedNode& tagged_node) {
+    if (TF_PREDICT_FALSE(vlog_) && VLOG_IS_ON(1)) {
+      mutex_lock l(mu_);
+      (*active_)[tagged_node.node_item->node_id] = true;
+    }
+  }
+  void MaybeMarkCompleted(const TaggedNode& tagged_node) {
+    if (TF_PREDICT_FALSE(vlog_) && VLOG_IS_ON(1)) {
+      mutex_lock l(mu_);
+      (*active_)[tagged_node.node_item->node_id] = false;
+    }
+  }
+
+ private:
+  // Records that one of the events that `dst_id` waits for has happened, and
+  // adds it to `*ready` if it is now runnable.
+  void DecrementPending(int32 dst_id, TaggedNodeSeq* ready) {
+    if (schedule_.pending_counts[dst_id] == 1 ||
+        pending_[dst_id].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      ready->emplace_back(&gview_.node_ref(dst_id));
+    }
+  }
+
+  const ImmutableExecutorState& immutable_state_;
+  const ImmutableExecutorState::StaticSchedule& schedule_;
+  const GraphView& gview_;
+  const int64_t step_id_;
+  const bool vlog_;
+
+  // The i-th node's j-th input is stored at
+  // `input_tensors[impl_->nodes[i].input_start + j]`.
+  //
+  // NOTE: As in `SimplePropagatorState`, each element is written once by the
+  // source of an edge and cleared by its destination, which always runs
+  // later.
+  std::vector<Entry> input_tensors_;
+
+  // Only the entries of nodes with more than one pending event are used.
+  std::unique_ptr<std::atomic<int32>[]> pending_;
+
+  // If `vlog_` is true, this stores a bit vector of active nodes, indexed by
+  // node ID.
+  mutex mu_;
+  std::unique_ptr<std::vector<bool>> active_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticSchedulePropagatorState);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_SCHEDULE_PROPAGATOR_STATE_H_
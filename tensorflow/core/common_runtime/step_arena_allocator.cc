@@ -0,0 +1,149 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+
+namespace {
+
+size_t RoundUp(size_t n, size_t alignment) {
+  return (n + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+StepArenaAllocator::StepArenaAllocator(Allocator* base, int64_t step_id,
+                                       size_t slab_bytes,
+                                       size_t max_arena_bytes)
+    : base_(base),
+      step_id_(step_id),
+      slab_bytes_(slab_bytes),
+      max_arena_bytes_(max_arena_bytes) {}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  for (void* slab : slabs_) {
+    base_->DeallocateRaw(slab);
+  }
+}
+
+std::string StepArenaAllocator::Name() {
+  return strings::StrCat(base_->Name(), "_step_arena_", step_id_);
+}
+
+size_t StepArenaAllocator::SlabBytes() const {
+  mutex_lock l(mu_);
+  return reserved_bytes_;
+}
+
+void* StepArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  alignment = std::max<size_t>(alignment, Allocator::kAllocatorAlignment);
+  // The header sits immediately before the returned pointer; padding it to
+  // `alignment` keeps the returned pointer aligned.
+  const size_t header_bytes = RoundUp(sizeof(Header), alignment);
+  const size_t total_bytes = header_bytes + RoundUp(num_bytes, alignment);
+
+  char* start = nullptr;
+  if (total_bytes <= slab_bytes_ / 4) {
+    mutex_lock l(mu_);
+    char* aligned = limit_ == nullptr
+                        ? nullptr
+                        : reinterpret_cast<char*>(RoundUp(
+                              reinterpret_cast<uintptr_t>(cursor_), alignment));
+    if (aligned == nullptr || aligned + total_bytes > limit_) {
+      aligned = nullptr;
+      if (reserved_bytes_ + slab_bytes_ <= max_arena_bytes_) {
+        void* slab = base_->AllocateRaw(Allocator::kAllocatorAlignment,
+                                        slab_bytes_);
+        if (slab != nullptr) {
+          slabs_.push_back(slab);
+          reserved_bytes_ += slab_bytes_;
+          cursor_ = static_cast<char*>(slab);
+          limit_ = cursor_ + slab_bytes_;
+          aligned = reinterpret_cast<char*>(
+              RoundUp(reinterpret_cast<uintptr_t>(cursor_), alignment));
+          if (aligned + total_bytes > limit_) aligned = nullptr;
+        }
+      }
+    }
+    if (aligned != nullptr) {
+      cursor_ = aligned + total_bytes;
+      start = aligned;
+    }
+  }
+
+  Header header{nullptr};
+  if (start == nullptr) {
+    header.base_ptr = base_->AllocateRaw(alignment, total_bytes);
+    if (header.base_ptr == nullptr) return nullptr;
+    start = static_cast<char*>(header.base_ptr);
+  }
+  char* ptr = start + header_bytes;
+  *(reinterpret_cast<Header*>(ptr) - 1) = header;
+  Ref();
+  return ptr;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  const Header* header = reinterpret_cast<const Header*>(ptr) - 1;
+  if (header->base_ptr != nullptr) {
+    base_->DeallocateRaw(header->base_ptr);
+  }
+  Unref();
+}
+
+StepArenaAllocatorMgr::~StepArenaAllocatorMgr() {
+  mutex_lock l(mu_);
+  for (auto& it : per_step_map_) {
+    it.second->Unref();
+  }
+  per_step_map_.clear();
+}
+
+Allocator* StepArenaAllocatorMgr::GetAllocator(int64_t step_id) {
+  {
+    tf_shared_lock l(mu_);
+    auto it = per_step_map_.find(step_id);
+    if (it != per_step_map_.end()) return it->second;
+  }
+  mutex_lock l(mu_);
+  StepArenaAllocator*& arena = per_step_map_[step_id];
+  if (arena == nullptr) {
+    VLOG(2) << "Creating step arena for step " << step_id;
+    arena = new StepArenaAllocator(base_, step_id);
+  }
+  return arena;
+}
+
+void StepArenaAllocatorMgr::Cleanup(int64_t step_id) {
+  StepArenaAllocator* arena = nullptr;
+  {
+    mutex_lock l(mu_);
+    auto it = per_step_map_.find(step_id);
+    if (it == per_step_map_.end()) return;
+    arena = it->second;
+    per_step_map_.erase(it);
+  }
+  VLOG(2) << "Releasing step arena for step " << step_id << " with "
+          << arena->SlabBytes() << " slab bytes";
+  arena->Unref();
+}
+
+}  // namespace tensorflow
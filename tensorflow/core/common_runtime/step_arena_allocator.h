@@ -0,0 +1,107 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A bump allocator that serves the temporaries of a single step out of large
+// slabs obtained from a base allocator.
+//
+// Individual deallocations only drop a reference; the slabs are returned to
+// the base allocator all at once when the step has been cleaned up (see
+// StepArenaAllocatorMgr::Cleanup) and every tensor allocated from the arena
+// has been released. Since a temporary may legitimately outlive its step
+// (e.g. when a kernel forwards it to an output), a Ref is held for every
+// outstanding allocation and the arena deletes itself when the last one is
+// dropped.
+//
+// Requests that are large relative to the slab size, or that would grow the
+// arena beyond `max_arena_bytes`, are forwarded to the base allocator.
+class StepArenaAllocator : public Allocator, public core::RefCounted {
+ public:
+  static constexpr size_t kDefaultSlabBytes = 1 << 20;
+  static constexpr size_t kDefaultMaxArenaBytes = 64 << 20;
+
+  StepArenaAllocator(Allocator* base, int64_t step_id,
+                     size_t slab_bytes = kDefaultSlabBytes,
+                     size_t max_arena_bytes = kDefaultMaxArenaBytes);
+
+  std::string Name() override;
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+  // Returns the number of bytes currently reserved in slabs.
+  size_t SlabBytes() const;
+
+ private:
+  ~StepArenaAllocator() override;
+
+  // Every allocation is preceded by a header that records whether it was
+  // forwarded to the base allocator.
+  struct Header {
+    void* base_ptr;  // Non-null iff forwarded to `base_`.
+  };
+
+  Allocator* const base_;  // Not owned.
+  const int64_t step_id_;
+  const size_t slab_bytes_;
+  const size_t max_arena_bytes_;
+
+  mutable mutex mu_;
+  std::vector<void*> slabs_ TF_GUARDED_BY(mu_);
+  char* cursor_ TF_GUARDED_BY(mu_) = nullptr;
+  char* limit_ TF_GUARDED_BY(mu_) = nullptr;
+  size_t reserved_bytes_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaAllocator);
+};
+
+// At most one of these exists per device. Hands out one StepArenaAllocator
+// per step id.
+class StepArenaAllocatorMgr {
+ public:
+  explicit StepArenaAllocatorMgr(Allocator* base) : base_(base) {}
+  ~StepArenaAllocatorMgr();
+
+  // Returns the arena for `step_id`, creating it if necessary. The returned
+  // allocator stays valid while there are outstanding allocations from it.
+  Allocator* GetAllocator(int64_t step_id);
+
+  // Drops the manager's reference to the arena of `step_id`, if any.
+  void Cleanup(int64_t step_id);
+
+ private:
+  Allocator* const base_;  // Not owned.
+  mutex mu_;
+  absl::flat_hash_map<int64_t, StepArenaAllocator*> per_step_map_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
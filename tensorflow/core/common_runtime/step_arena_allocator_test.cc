@@ -0,0 +1,97 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Counts outstanding allocations made through the base allocator.
+class CountingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++live_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    --live_;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+  int live() const { return live_; }
+
+ private:
+  int live_ = 0;
+};
+
+TEST(StepArenaAllocatorTest, SmallAllocationsShareSlab) {
+  CountingAllocator base;
+  StepArenaAllocatorMgr mgr(&base);
+  Allocator* a = mgr.GetAllocator(1);
+  EXPECT_EQ(a, mgr.GetAllocator(1));
+  EXPECT_NE(a, mgr.GetAllocator(2));
+  mgr.Cleanup(2);
+
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 100; ++i) {
+    void* p = a->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+    ASSERT_NE(p, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % Allocator::kAllocatorAlignment,
+              0);
+    ptrs.push_back(p);
+  }
+  // All 100 allocations fit in the first slab.
+  EXPECT_EQ(base.live(), 1);
+  for (void* p : ptrs) a->DeallocateRaw(p);
+  EXPECT_EQ(base.live(), 1);
+  mgr.Cleanup(1);
+  EXPECT_EQ(base.live(), 0);
+}
+
+TEST(StepArenaAllocatorTest, LargeAllocationsForwardedToBase) {
+  CountingAllocator base;
+  StepArenaAllocatorMgr mgr(&base);
+  Allocator* a = mgr.GetAllocator(1);
+  void* p = a->AllocateRaw(Allocator::kAllocatorAlignment,
+                           StepArenaAllocator::kDefaultSlabBytes);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(base.live(), 1);
+  a->DeallocateRaw(p);
+  EXPECT_EQ(base.live(), 0);
+  mgr.Cleanup(1);
+}
+
+TEST(StepArenaAllocatorTest, ArenaOutlivesStepWhileTensorsAreLive) {
+  CountingAllocator base;
+  StepArenaAllocatorMgr mgr(&base);
+  Tensor t;
+  {
+    Tensor temp(mgr.GetAllocator(7), DT_FLOAT, TensorShape({16}));
+    temp.flat<float>().setConstant(3.0f);
+    t = temp;
+  }
+  mgr.Cleanup(7);
+  // The slab stays alive until the escaped tensor is released.
+  EXPECT_EQ(base.live(), 1);
+  EXPECT_EQ(t.flat<float>()(15), 3.0f);
+  t = Tensor();
+  EXPECT_EQ(base.live(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
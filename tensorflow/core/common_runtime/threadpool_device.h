@@ -36,6 +36,11 @@ class ThreadPoolDevice : public LocalDevice {
   ScopedAllocatorMgr* GetScopedAllocatorMgr() const override {
     return scoped_allocator_mgr_.get();
   }
+  Allocator* GetStepAllocator(AllocatorAttributes attr,
+                              int64_t step_id) override;
+  StepArenaAllocatorMgr* GetStepArenaAllocatorMgr() const override {
+    return step_arena_allocator_mgr_.get();
+  }
   Status MakeTensorFromProto(const TensorProto& tensor_proto,
                              const AllocatorAttributes alloc_attrs,
                              Tensor* tensor) override;
@@ -55,6 +60,8 @@ class ThreadPoolDevice : public LocalDevice {
 
   Allocator* allocator_;  // Not owned
   std::unique_ptr<ScopedAllocatorMgr> scoped_allocator_mgr_;
+  // Only set if ConfigProto.Experimental.use_step_arena_allocator is true.
+  std::unique_ptr<StepArenaAllocatorMgr> step_arena_allocator_mgr_;
   NodeFileWriter* node_file_writer_ = nullptr;  // not owned
 };
 
@@ -0,0 +1,140 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_READY_QUEUE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_READY_QUEUE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+
+#include "absl/types/optional.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A set of per-worker deques of ready work items, used by the work-stealing
+// executor.
+//
+// A thread pushes items onto its own deque and pops them back in LIFO order,
+// so that a node's successors tend to run on the thread that produced their
+// inputs while those are still in cache. Idle workers steal from the other
+// end of the other deques.
+//
+// Threads are mapped onto deques by a per-thread index, so any number of
+// threads may use the queue; threads beyond `num_queues` share deques.
+//
+// The queue also tracks the number of active workers draining it, so that the
+// owner can start just enough workers for the available work without losing
+// wake-ups (see TryStartWorker() and StopWorker()).
+template <typename T>
+class WorkStealingReadyQueue {
+ public:
+  explicit WorkStealingReadyQueue(int num_queues)
+      : num_queues_(std::max(num_queues, 1)),
+        queues_(new Queue[num_queues_]) {}
+
+  // Pushes `item` onto the calling thread's deque.
+  void Push(T item) {
+    Queue& q = queues_[ThreadSlot() % num_queues_];
+    {
+      mutex_lock l(q.mu);
+      q.items.push_back(std::move(item));
+    }
+    size_.fetch_add(1);
+  }
+
+  // Pops the most recently pushed item of the calling thread's deque, or
+  // steals the oldest item of another deque. Returns nullopt if all deques
+  // are empty.
+  absl::optional<T> Pop() {
+    if (Empty()) return absl::nullopt;
+    const int self = ThreadSlot() % num_queues_;
+    {
+      Queue& q = queues_[self];
+      mutex_lock l(q.mu);
+      if (!q.items.empty()) {
+        absl::optional<T> item(std::move(q.items.back()));
+        q.items.pop_back();
+        size_.fetch_sub(1);
+        return item;
+      }
+    }
+    for (int i = 1; i < num_queues_; ++i) {
+      Queue& q = queues_[(self + i) % num_queues_];
+      mutex_lock l(q.mu);
+      if (!q.items.empty()) {
+        absl::optional<T> item(std::move(q.items.front()));
+        q.items.pop_front();
+        size_.fetch_sub(1);
+        return item;
+      }
+    }
+    return absl::nullopt;
+  }
+
+  // Pushes, pops and worker registration are sequentially consistent so that
+  // a worker that stops concurrently with a Push() always observes the new
+  // item or is observed by the pusher.
+  bool Empty() const { return size_.load() == 0; }
+
+  int num_queues() const { return num_queues_; }
+
+  // Registers a new worker if fewer than `num_queues()` workers are active
+  // and there is queued work. Returns true if the caller must start a worker.
+  bool TryStartWorker() {
+    int workers = num_workers_.load();
+    while (workers < num_queues_ && !Empty()) {
+      if (num_workers_.compare_exchange_weak(workers, workers + 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Unregisters the calling worker after Pop() returned nullopt. Returns true
+  // if work arrived in the meantime and the caller has been re-registered and
+  // must keep draining the queue.
+  bool StopWorker() {
+    num_workers_.fetch_sub(1);
+    return TryStartWorker();
+  }
+
+ private:
+  struct alignas(64) Queue {
+    mutex mu;
+    std::deque<T> items TF_GUARDED_BY(mu);
+  };
+
+  static int ThreadSlot() {
+    static std::atomic<int> next_slot{0};
+    thread_local const int slot =
+        next_slot.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+  }
+
+  const int num_queues_;
+  std::unique_ptr<Queue[]> queues_;
+  std::atomic<int64_t> size_{0};
+  std::atomic<int> num_workers_{0};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(WorkStealingReadyQueue);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_READY_QUEUE_H_
@@ -0,0 +1,106 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/work_stealing_ready_queue.h"
+
+#include <atomic>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(WorkStealingReadyQueueTest, OwnerPopsLifo) {
+  WorkStealingReadyQueue<int> queue(4);
+  EXPECT_TRUE(queue.Empty());
+  for (int i = 0; i < 3; ++i) queue.Push(i);
+  EXPECT_FALSE(queue.Empty());
+  for (int i = 2; i >= 0; --i) {
+    absl::optional<int> item = queue.Pop();
+    ASSERT_TRUE(item.has_value());
+    EXPECT_EQ(i, *item);
+  }
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_FALSE(queue.Pop().has_value());
+}
+
+TEST(WorkStealingReadyQueueTest, ThiefStealsFifo) {
+  WorkStealingReadyQueue<int> queue(4);
+  for (int i = 0; i < 3; ++i) queue.Push(i);
+  std::vector<int> stolen;
+  std::unique_ptr<Thread> thief(Env::Default()->StartThread(
+      ThreadOptions(), "thief", [&queue, &stolen]() {
+        while (auto item = queue.Pop()) stolen.push_back(*item);
+      }));
+  thief.reset();
+  EXPECT_EQ(std::vector<int>({0, 1, 2}), stolen);
+  EXPECT_TRUE(queue.Empty());
+}
+
+TEST(WorkStealingReadyQueueTest, WorkerRegistration) {
+  WorkStealingReadyQueue<int> queue(2);
+  // No worker is needed while the queue is empty.
+  EXPECT_FALSE(queue.TryStartWorker());
+  queue.Push(0);
+  EXPECT_TRUE(queue.TryStartWorker());
+  EXPECT_TRUE(queue.TryStartWorker());
+  // At most `num_queues()` workers may be active.
+  EXPECT_FALSE(queue.TryStartWorker());
+  ASSERT_TRUE(queue.Pop().has_value());
+  EXPECT_FALSE(queue.StopWorker());
+  // A stopping worker is re-registered if work arrived in the meantime.
+  queue.Push(1);
+  EXPECT_TRUE(queue.StopWorker());
+  ASSERT_TRUE(queue.Pop().has_value());
+  EXPECT_FALSE(queue.StopWorker());
+}
+
+TEST(WorkStealingReadyQueueTest, Concurrent) {
+  constexpr int kThreads = 8;
+  constexpr int kItemsPerThread = 10000;
+  WorkStealingReadyQueue<int> queue(kThreads);
+  std::atomic<int64_t> sum{0};
+  std::atomic<int> popped{0};
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kThreads);
+    for (int t = 0; t < kThreads; ++t) {
+      pool.Schedule([&queue, &sum, &popped]() {
+        for (int i = 1; i <= kItemsPerThread; ++i) {
+          queue.Push(i);
+          if (i % 2 == 0) {
+            while (auto item = queue.Pop()) {
+              sum += *item;
+              ++popped;
+            }
+          }
+        }
+      });
+    }
+  }
+  while (auto item = queue.Pop()) {
+    sum += *item;
+    ++popped;
+  }
+  EXPECT_EQ(kThreads * kItemsPerThread, popped.load());
+  EXPECT_EQ(static_cast<int64_t>(kThreads) * kItemsPerThread *
+                (kItemsPerThread + 1) / 2,
+            sum.load());
+}
+
+}  // namespace
+}  // namespace tensorflow
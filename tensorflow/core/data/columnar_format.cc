@@ -0,0 +1,242 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/columnar_format.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "tensorflow/core/lib/io/table_options.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Sorts after the key of any chunk.
+const char kMetadataKey[] = "\xff\xff\xff\xff\xff\xff\xff\xff";
+constexpr size_t kChunkPrefixSize = sizeof(uint64);
+
+// Blocks are kept small, so that a feature is stored in few blocks that
+// hold little of any other feature.
+constexpr size_t kBlockSize = 4 << 10;
+
+string ChunkPrefix(int64_t chunk_index) {
+  string prefix(kChunkPrefixSize, '\0');
+  for (size_t i = 0; i < kChunkPrefixSize; ++i) {
+    prefix[i] = static_cast<char>(static_cast<uint64>(chunk_index) >>
+                                  (8 * (kChunkPrefixSize - 1 - i)));
+  }
+  return prefix;
+}
+
+// Moves the rows of the serialized column `value` of feature `name` into
+// `rows`.
+Status AddColumn(const string& name, StringPiece value,
+                 std::vector<Example>* rows) {
+  FeatureList column;
+  if (!column.ParseFromArray(value.data(), value.size()) ||
+      column.feature_size() != static_cast<int>(rows->size())) {
+    return errors::DataLoss("corrupted column ", name);
+  }
+  for (int i = 0; i < column.feature_size(); ++i) {
+    if (column.feature(i).kind_case() == Feature::KIND_NOT_SET) continue;
+    (*(*rows)[i].mutable_features()->mutable_feature())[name].Swap(
+        column.mutable_feature(i));
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+/* static */ constexpr int64_t ColumnarWriter::kDefaultRowsPerChunk;
+
+ColumnarWriter::ColumnarWriter(std::unique_ptr<WritableFile> file,
+                               int64_t rows_per_chunk)
+    : file_(std::move(file)), rows_per_chunk_(rows_per_chunk) {
+  table::Options options;
+  options.block_size = kBlockSize;
+  options.compression = table::kSnappyCompression;
+  builder_ = absl::make_unique<table::TableBuilder>(options, file_.get());
+}
+
+ColumnarWriter::~ColumnarWriter() {
+  if (!closed_) {
+    LOG(WARNING) << "ColumnarWriter::Close() not called. Possible data loss";
+    builder_->Abandon();
+  }
+}
+
+Status ColumnarWriter::Create(Env* env, const string& filename,
+                              int64_t rows_per_chunk,
+                              std::unique_ptr<ColumnarWriter>* writer) {
+  if (rows_per_chunk <= 0) {
+    return errors::InvalidArgument("`rows_per_chunk` must be > 0, got ",
+                                   rows_per_chunk);
+  }
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+  writer->reset(new ColumnarWriter(std::move(file), rows_per_chunk));
+  return Status::OK();
+}
+
+Status ColumnarWriter::Write(const Example& example) {
+  if (closed_) {
+    return errors::FailedPrecondition("Write() called after Close()");
+  }
+  for (const auto& feature : example.features().feature()) {
+    FeatureList& column = chunk_[feature.first];
+    while (column.feature_size() < chunk_rows_) {
+      column.add_feature();
+    }
+    *column.add_feature() = feature.second;
+    columns_.insert(feature.first);
+  }
+  ++chunk_rows_;
+  ++num_rows_;
+  if (chunk_rows_ == rows_per_chunk_) {
+    return FlushChunk();
+  }
+  return Status::OK();
+}
+
+Status ColumnarWriter::FlushChunk() {
+  if (chunk_rows_ == 0) return Status::OK();
+  const string prefix = ChunkPrefix(num_chunks_);
+  string value;
+  // `chunk_` is sorted by name, so the keys are added in order.
+  for (auto& column : chunk_) {
+    while (column.second.feature_size() < chunk_rows_) {
+      column.second.add_feature();
+    }
+    column.second.SerializeToString(&value);
+    builder_->Add(strings::StrCat(prefix, column.first), value);
+  }
+  chunk_.clear();
+  chunk_rows_ = 0;
+  ++num_chunks_;
+  return builder_->status();
+}
+
+Status ColumnarWriter::Close() {
+  if (closed_) return Status::OK();
+  TF_RETURN_IF_ERROR(FlushChunk());
+
+  string metadata;
+  core::PutVarint64(&metadata, num_rows_);
+  core::PutVarint64(&metadata, rows_per_chunk_);
+  core::PutVarint64(&metadata, columns_.size());
+  for (const string& name : columns_) {
+    core::PutVarint64(&metadata, name.size());
+    metadata.append(name);
+  }
+  builder_->Add(kMetadataKey, metadata);
+  closed_ = true;
+  TF_RETURN_IF_ERROR(builder_->Finish());
+  return file_->Close();
+}
+
+ColumnarReader::ColumnarReader(std::unique_ptr<RandomAccessFile> file,
+                               std::unique_ptr<table::Table> table)
+    : file_(std::move(file)),
+      table_(std::move(table)),
+      iter_(table_->NewIterator()) {}
+
+Status ColumnarReader::Open(Env* env, const string& filename,
+                            std::unique_ptr<ColumnarReader>* reader) {
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  table::Table* table;
+  TF_RETURN_IF_ERROR(
+      table::Table::Open(table::Options(), file.get(), file_size, &table));
+  reader->reset(new ColumnarReader(std::move(file),
+                                   std::unique_ptr<table::Table>(table)));
+  Status s = (*reader)->ReadMetadata();
+  if (!s.ok()) {
+    reader->reset();
+    errors::AppendToMessage(&s, "while reading ", filename);
+    return s;
+  }
+  return Status::OK();
+}
+
+Status ColumnarReader::ReadMetadata() {
+  iter_->Seek(kMetadataKey);
+  TF_RETURN_IF_ERROR(iter_->status());
+  if (!iter_->Valid() || iter_->key() != kMetadataKey) {
+    return errors::DataLoss("missing columnar metadata");
+  }
+  StringPiece metadata = iter_->value();
+  uint64 num_rows, rows_per_chunk, num_columns;
+  if (!core::GetVarint64(&metadata, &num_rows) ||
+      !core::GetVarint64(&metadata, &rows_per_chunk) ||
+      !core::GetVarint64(&metadata, &num_columns) || rows_per_chunk == 0) {
+    return errors::DataLoss("corrupted columnar metadata");
+  }
+  num_rows_ = num_rows;
+  rows_per_chunk_ = rows_per_chunk;
+  columns_.clear();
+  for (uint64 i = 0; i < num_columns; ++i) {
+    uint64 size;
+    if (!core::GetVarint64(&metadata, &size) || size > metadata.size()) {
+      return errors::DataLoss("corrupted columnar metadata");
+    }
+    columns_.emplace_back(metadata.data(), size);
+    metadata.remove_prefix(size);
+  }
+  return Status::OK();
+}
+
+Status ColumnarReader::ReadChunk(int64_t chunk_index,
+                                 const std::vector<string>& columns,
+                                 std::vector<Example>* rows) {
+  if (chunk_index < 0 || chunk_index >= num_chunks()) {
+    return errors::OutOfRange("chunk ", chunk_index, " is out of range [0, ",
+                              num_chunks(), ")");
+  }
+  rows->clear();
+  rows->resize(std::min(rows_per_chunk_,
+                        num_rows_ - chunk_index * rows_per_chunk_));
+  const string prefix = ChunkPrefix(chunk_index);
+  if (columns.empty()) {
+    for (iter_->Seek(prefix);
+         iter_->Valid() && absl::StartsWith(iter_->key(), prefix);
+         iter_->Next()) {
+      StringPiece name = iter_->key();
+      name.remove_prefix(kChunkPrefixSize);
+      TF_RETURN_IF_ERROR(AddColumn(string(name), iter_->value(), rows));
+    }
+    return iter_->status();
+  }
+  for (const string& name : columns) {
+    const string key = strings::StrCat(prefix, name);
+    iter_->Seek(key);
+    TF_RETURN_IF_ERROR(iter_->status());
+    // Chunks without any row having the feature have no entry for it.
+    if (iter_->Valid() && iter_->key() == key) {
+      TF_RETURN_IF_ERROR(AddColumn(name, iter_->value(), rows));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace data
+}  // namespace tensorflow
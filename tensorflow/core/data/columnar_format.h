@@ -0,0 +1,127 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_COLUMNAR_FORMAT_H_
+#define TENSORFLOW_CORE_DATA_COLUMNAR_FORMAT_H_
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/lib/io/table.h"
+#include "tensorflow/core/lib/io/table_builder.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// A columnar file format for `tf.Example`s.
+//
+// The rows of a file are split into chunks of `rows_per_chunk` examples, and
+// each feature of a chunk is stored as its own entry of a `table::Table`:
+//
+//   key:   <chunk index as big-endian fixed64><feature name>
+//   value: serialized `FeatureList` with one `Feature` per row of the chunk;
+//          rows without the feature hold a `Feature` with no kind set.
+//
+// Names, row count, and chunk size are stored in a metadata entry that sorts
+// after all chunks. The table blocks are small, so that reading a subset of
+// the features of a chunk only reads and decompresses the blocks of these
+// features.
+class ColumnarWriter {
+ public:
+  static constexpr int64_t kDefaultRowsPerChunk = 1024;
+
+  // Creates a writer for a new file at `filename`.
+  static Status Create(Env* env, const string& filename,
+                       int64_t rows_per_chunk,
+                       std::unique_ptr<ColumnarWriter>* writer);
+
+  ~ColumnarWriter();
+
+  // Appends `example` as the next row.
+  Status Write(const Example& example);
+
+  // Writes the last chunk and the metadata. Must be called before the writer
+  // is destroyed, or the file will not be readable.
+  Status Close();
+
+ private:
+  ColumnarWriter(std::unique_ptr<WritableFile> file, int64_t rows_per_chunk);
+
+  // Writes the buffered rows as the next chunk.
+  Status FlushChunk();
+
+  std::unique_ptr<WritableFile> file_;
+  std::unique_ptr<table::TableBuilder> builder_;
+  const int64_t rows_per_chunk_;
+  bool closed_ = false;
+
+  int64_t num_rows_ = 0;
+  int64_t num_chunks_ = 0;
+  // The rows of the current chunk, by feature. Features not set in a row are
+  // padded with empty values when the row count is known.
+  std::map<string, FeatureList> chunk_;
+  int64_t chunk_rows_ = 0;
+  // The names of all features written so far.
+  std::set<string> columns_;
+};
+
+// Reads the chunks of a file written by `ColumnarWriter`.
+class ColumnarReader {
+ public:
+  // Opens the file at `filename`.
+  static Status Open(Env* env, const string& filename,
+                     std::unique_ptr<ColumnarReader>* reader);
+
+  int64_t num_rows() const { return num_rows_; }
+  int64_t rows_per_chunk() const { return rows_per_chunk_; }
+  int64_t num_chunks() const {
+    return (num_rows_ + rows_per_chunk_ - 1) / rows_per_chunk_;
+  }
+  // The names of the features in the file, sorted.
+  const std::vector<string>& columns() const { return columns_; }
+
+  // Reads the rows of chunk `chunk_index`, restricted to the features in
+  // `columns`, or all features if `columns` is empty. Only the requested
+  // features are read from the file. Features not in the file are ignored.
+  Status ReadChunk(int64_t chunk_index, const std::vector<string>& columns,
+                   std::vector<Example>* rows);
+
+ private:
+  ColumnarReader(std::unique_ptr<RandomAccessFile> file,
+                 std::unique_ptr<table::Table> table);
+
+  // Parses the metadata entry.
+  Status ReadMetadata();
+
+  std::unique_ptr<RandomAccessFile> file_;
+  std::unique_ptr<table::Table> table_;
+  std::unique_ptr<table::Iterator> iter_;
+
+  int64_t num_rows_ = 0;
+  int64_t rows_per_chunk_ = 1;
+  std::vector<string> columns_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_COLUMNAR_FORMAT_H_
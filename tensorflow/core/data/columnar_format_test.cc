@@ -0,0 +1,149 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/columnar_format.h"
+
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+using ::testing::ElementsAre;
+
+// Row `i` has an int64 "a", a float "c", and a bytes "b" on even rows only.
+Example MakeExample(int64_t i) {
+  Example example;
+  auto& features = *example.mutable_features()->mutable_feature();
+  features["a"].mutable_int64_list()->add_value(i);
+  if (i % 2 == 0) {
+    features["b"].mutable_bytes_list()->add_value(strings::StrCat("b", i));
+  }
+  features["c"].mutable_float_list()->add_value(i * 0.5f);
+  return example;
+}
+
+void ExpectEqualExamples(const Example& actual, const Example& expected) {
+  const auto& features = actual.features().feature();
+  ASSERT_EQ(features.size(), expected.features().feature_size());
+  for (const auto& feature : expected.features().feature()) {
+    ASSERT_EQ(features.count(feature.first), 1) << feature.first;
+    EXPECT_EQ(features.at(feature.first).DebugString(),
+              feature.second.DebugString());
+  }
+}
+
+string WriteFile(const string& name, int64_t num_rows,
+                 int64_t rows_per_chunk) {
+  const string filename = io::JoinPath(::testing::TempDir(), name);
+  std::unique_ptr<ColumnarWriter> writer;
+  TF_CHECK_OK(ColumnarWriter::Create(Env::Default(), filename, rows_per_chunk,
+                                     &writer));
+  for (int64_t i = 0; i < num_rows; ++i) {
+    TF_CHECK_OK(writer->Write(MakeExample(i)));
+  }
+  TF_CHECK_OK(writer->Close());
+  return filename;
+}
+
+TEST(ColumnarFormatTest, ReadAllColumns) {
+  const string filename = WriteFile("all_columns", 7, 3);
+  std::unique_ptr<ColumnarReader> reader;
+  TF_ASSERT_OK(ColumnarReader::Open(Env::Default(), filename, &reader));
+  EXPECT_EQ(reader->num_rows(), 7);
+  EXPECT_EQ(reader->num_chunks(), 3);
+  EXPECT_THAT(reader->columns(), ElementsAre("a", "b", "c"));
+
+  int64_t row = 0;
+  std::vector<Example> rows;
+  for (int64_t chunk = 0; chunk < reader->num_chunks(); ++chunk) {
+    TF_ASSERT_OK(reader->ReadChunk(chunk, {}, &rows));
+    for (const Example& example : rows) {
+      ExpectEqualExamples(example, MakeExample(row));
+      ++row;
+    }
+  }
+  EXPECT_EQ(row, 7);
+}
+
+TEST(ColumnarFormatTest, ReadProjectedColumns) {
+  const string filename = WriteFile("projected_columns", 5, 2);
+  std::unique_ptr<ColumnarReader> reader;
+  TF_ASSERT_OK(ColumnarReader::Open(Env::Default(), filename, &reader));
+
+  std::vector<Example> rows;
+  // Chunk 2 holds the single, even row 4.
+  TF_ASSERT_OK(reader->ReadChunk(2, {"b", "missing"}, &rows));
+  ASSERT_EQ(rows.size(), 1);
+  ASSERT_EQ(rows[0].features().feature_size(), 1);
+  EXPECT_EQ(rows[0].features().feature().at("b").bytes_list().value(0), "b4");
+
+  TF_ASSERT_OK(reader->ReadChunk(0, {"a", "b"}, &rows));
+  ASSERT_EQ(rows.size(), 2);
+  EXPECT_EQ(rows[0].features().feature_size(), 2);
+  ASSERT_EQ(rows[1].features().feature_size(), 1);
+  EXPECT_EQ(rows[1].features().feature().at("a").int64_list().value(0), 1);
+}
+
+TEST(ColumnarFormatTest, FeatureMissingFromChunk) {
+  const string filename = io::JoinPath(::testing::TempDir(), "sparse_feature");
+  std::unique_ptr<ColumnarWriter> writer;
+  TF_ASSERT_OK(ColumnarWriter::Create(Env::Default(), filename,
+                                      /*rows_per_chunk=*/2, &writer));
+  Example empty;
+  TF_ASSERT_OK(writer->Write(empty));
+  TF_ASSERT_OK(writer->Write(empty));
+  TF_ASSERT_OK(writer->Write(empty));
+  TF_ASSERT_OK(writer->Write(MakeExample(0)));
+  TF_ASSERT_OK(writer->Close());
+
+  std::unique_ptr<ColumnarReader> reader;
+  TF_ASSERT_OK(ColumnarReader::Open(Env::Default(), filename, &reader));
+  std::vector<Example> rows;
+  TF_ASSERT_OK(reader->ReadChunk(0, {"a"}, &rows));
+  ASSERT_EQ(rows.size(), 2);
+  EXPECT_EQ(rows[0].features().feature_size(), 0);
+  EXPECT_EQ(rows[1].features().feature_size(), 0);
+  TF_ASSERT_OK(reader->ReadChunk(1, {"a"}, &rows));
+  ASSERT_EQ(rows.size(), 2);
+  EXPECT_EQ(rows[0].features().feature_size(), 0);
+  EXPECT_EQ(rows[1].features().feature().at("a").int64_list().value(0), 0);
+}
+
+TEST(ColumnarFormatTest, EmptyFile) {
+  const string filename = WriteFile("empty", 0, 4);
+  std::unique_ptr<ColumnarReader> reader;
+  TF_ASSERT_OK(ColumnarReader::Open(Env::Default(), filename, &reader));
+  EXPECT_EQ(reader->num_rows(), 0);
+  EXPECT_EQ(reader->num_chunks(), 0);
+  std::vector<Example> rows;
+  EXPECT_THAT(reader->ReadChunk(0, {}, &rows), StatusIs(error::OUT_OF_RANGE));
+}
+
+TEST(ColumnarFormatTest, InvalidRowsPerChunk) {
+  std::unique_ptr<ColumnarWriter> writer;
+  EXPECT_THAT(
+      ColumnarWriter::Create(Env::Default(),
+                             io::JoinPath(::testing::TempDir(), "invalid"),
+                             /*rows_per_chunk=*/0, &writer),
+      StatusIs(error::INVALID_ARGUMENT));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -14,18 +14,35 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <zlib.h>
+
+#include <algorithm>
 #include <limits>
+#include <string>
 
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
 namespace data {
 
-Status CompressElement(const std::vector<Tensor>& element,
-                       CompressedElement* out) {
+namespace {
+
+// The number of bytes that the ADAPTIVE codec compresses to decide whether to
+// compress an element.
+constexpr size_t kAdaptiveSampleBytes = 64 << 10;
+// The ADAPTIVE codec compresses an element if its sample compresses to at
+// most this fraction of its size.
+constexpr double kAdaptiveMaxRatio = 0.9;
+
+// Writes the components of `element` to `uncompressed`, and their metadata to
+// `out`.
+void SerializeElement(const std::vector<Tensor>& element, tstring* uncompressed,
+                      CompressedElement* out) {
   // Step 1: Determine the total uncompressed size. This requires serializing
   // non-memcopyable tensors, which we save to use again later.
   std::vector<TensorProto> non_memcpy_components;
@@ -43,12 +60,11 @@ Status CompressElement(const std::vector<Tensor>& element,
     }
   }
 
-  // Step 2: Write the tensor data to a buffer, and compress that buffer.
-  // We use tstring for access to resize_uninitialized.
-  tstring uncompressed;
-  uncompressed.resize_uninitialized(total_size);
+  // Step 2: Write the tensor data to a buffer. We use tstring for access to
+  // resize_uninitialized.
+  uncompressed->resize_uninitialized(total_size);
   // Position in `uncompressed` to write the next component.
-  char* position = uncompressed.mdata();
+  char* position = uncompressed->mdata();
   int non_memcpy_component_index = 0;
   for (auto& component : element) {
     CompressedComponentMetadata* metadata =
@@ -68,21 +84,166 @@ Status CompressElement(const std::vector<Tensor>& element,
     }
     position += metadata->tensor_size_bytes();
   }
-  if (total_size > kuint32max) {
-    return errors::OutOfRange("Encountered dataset element of size ",
-                              total_size, ", exceeding the 4GB Snappy limit.");
+  DCHECK_EQ(position, uncompressed->mdata() + total_size);
+}
+
+// Returns whether a sample of `uncompressed` shrinks when compressed with
+// snappy.
+bool IsCompressible(const tstring& uncompressed) {
+  const size_t sample_size =
+      std::min(uncompressed.size(), kAdaptiveSampleBytes);
+  string compressed_sample;
+  if (sample_size == 0 || !port::Snappy_Compress(uncompressed.data(),
+                                                 sample_size,
+                                                 &compressed_sample)) {
+    return false;
+  }
+  return compressed_sample.size() <= kAdaptiveMaxRatio * sample_size;
+}
+
+Status ZlibCompress(const tstring& uncompressed, int level, string* out) {
+  uLongf compressed_size = compressBound(uncompressed.size());
+  out->resize(compressed_size);
+  const int status =
+      compress2(reinterpret_cast<Bytef*>(&(*out)[0]), &compressed_size,
+                reinterpret_cast<const Bytef*>(uncompressed.data()),
+                uncompressed.size(), level);
+  if (status != Z_OK) {
+    return errors::Internal("Failed to compress using zlib: error ", status);
+  }
+  out->resize(compressed_size);
+  return Status::OK();
+}
+
+Status SnappyUncompress(const string& compressed_data, int64_t total_size,
+                        const struct iovec* iov, size_t iov_cnt) {
+  size_t uncompressed_size;
+  if (!port::Snappy_GetUncompressedLength(
+          compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
+    return errors::Internal(
+        "Could not get snappy uncompressed length. Compressed data size: ",
+        compressed_data.size());
+  }
+  if (uncompressed_size != static_cast<size_t>(total_size)) {
+    return errors::Internal(
+        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
+        " whereas the tensor metadata suggests ", total_size);
+  }
+  if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
+                                      compressed_data.size(), iov, iov_cnt)) {
+    return errors::Internal("Failed to perform snappy decompression.");
+  }
+  return Status::OK();
+}
+
+Status CopyToIOVec(const string& data, int64_t total_size,
+                   const struct iovec* iov, size_t iov_cnt) {
+  if (data.size() != static_cast<size_t>(total_size)) {
+    return errors::Internal("Uncompressed size mismatch. Element has ",
+                            data.size(),
+                            " bytes whereas the tensor metadata suggests ",
+                            total_size);
+  }
+  const char* position = data.data();
+  for (size_t i = 0; i < iov_cnt; ++i) {
+    memcpy(iov[i].iov_base, position, iov[i].iov_len);
+    position += iov[i].iov_len;
+  }
+  return Status::OK();
+}
+
+Status ZlibUncompress(const string& compressed_data, int64_t total_size,
+                      const struct iovec* iov, size_t iov_cnt) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (inflateInit(&stream) != Z_OK) {
+    return errors::Internal("Failed to initialize zlib decompression.");
+  }
+  auto cleanup = gtl::MakeCleanup([&stream] { inflateEnd(&stream); });
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(compressed_data.data()));
+  stream.avail_in = compressed_data.size();
+  int status = Z_OK;
+  for (size_t i = 0; i < iov_cnt; ++i) {
+    stream.next_out = static_cast<Bytef*>(iov[i].iov_base);
+    stream.avail_out = iov[i].iov_len;
+    while (stream.avail_out > 0) {
+      status = inflate(&stream, Z_NO_FLUSH);
+      if (status == Z_STREAM_END && stream.avail_out > 0) {
+        return errors::Internal(
+            "Uncompressed size mismatch. zlib produced ", stream.total_out,
+            " bytes whereas the tensor metadata suggests ", total_size);
+      }
+      if (status != Z_OK && status != Z_STREAM_END) {
+        return errors::Internal("Failed to perform zlib decompression: error ",
+                                status);
+      }
+    }
+  }
+  if (status != Z_STREAM_END) {
+    // All expected bytes were produced; the stream should end here.
+    char extra;
+    stream.next_out = reinterpret_cast<Bytef*>(&extra);
+    stream.avail_out = 1;
+    status = inflate(&stream, Z_FINISH);
+    if (status != Z_STREAM_END || stream.avail_out != 1) {
+      return errors::Internal(
+          "Uncompressed size mismatch. zlib produced more than the ",
+          total_size, " bytes suggested by the tensor metadata.");
+    }
   }
-  DCHECK_EQ(position, uncompressed.mdata() + total_size);
+  return Status::OK();
+}
 
-  if (!port::Snappy_Compress(uncompressed.mdata(), total_size,
-                             out->mutable_data())) {
-    return errors::Internal("Failed to compress using snappy.");
+}  // namespace
+
+Status CompressElement(const std::vector<Tensor>& element,
+                       const CompressionOptions& options,
+                       CompressedElement* out) {
+  tstring uncompressed;
+  SerializeElement(element, &uncompressed, out);
+  const size_t total_size = uncompressed.size();
+
+  std::string codec = options.codec;
+  if (codec == kAdaptiveCodec) {
+    codec = IsCompressible(uncompressed) ? kSnappyCodec : kNoneCodec;
+  }
+  if (codec == kSnappyCodec) {
+    if (total_size > kuint32max) {
+      return errors::OutOfRange("Encountered dataset element of size ",
+                                total_size,
+                                ", exceeding the 4GB Snappy limit.");
+    }
+    if (!port::Snappy_Compress(uncompressed.mdata(), total_size,
+                               out->mutable_data())) {
+      return errors::Internal("Failed to compress using snappy.");
+    }
+    out->set_codec(CompressedElement::SNAPPY);
+  } else if (codec == kZlibCodec) {
+    if (total_size > kuint32max) {
+      return errors::OutOfRange("Encountered dataset element of size ",
+                                total_size, ", exceeding the 4GB zlib limit.");
+    }
+    TF_RETURN_IF_ERROR(
+        ZlibCompress(uncompressed, options.level, out->mutable_data()));
+    out->set_codec(CompressedElement::ZLIB);
+  } else if (codec == kNoneCodec) {
+    out->set_data(uncompressed.data(), total_size);
+    out->set_codec(CompressedElement::UNCOMPRESSED);
+  } else {
+    return errors::InvalidArgument("Unknown element compression codec: ",
+                                   options.codec);
   }
   VLOG(3) << "Compressed element from " << total_size << " bytes to "
-          << out->data().size() << " bytes";
+          << out->data().size() << " bytes with codec " << codec;
   return Status::OK();
 }
 
+Status CompressElement(const std::vector<Tensor>& element,
+                       CompressedElement* out) {
+  return CompressElement(element, CompressionOptions(), out);
+}
+
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out) {
   int num_components = compressed.component_metadata_size();
@@ -125,23 +286,22 @@ Status UncompressElement(const CompressedElement& compressed,
   }
 
   // Step 2: Uncompress into the iovec.
-  const std::string& compressed_data = compressed.data();
-  size_t uncompressed_size;
-  if (!port::Snappy_GetUncompressedLength(
-          compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
-    return errors::Internal(
-        "Could not get snappy uncompressed length. Compressed data size: ",
-        compressed_data.size());
-  }
-  if (uncompressed_size != static_cast<size_t>(total_size)) {
-    return errors::Internal(
-        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
-        " whereas the tensor metadata suggests ", total_size);
-  }
-  if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
-                                      compressed_data.size(), iov.data(),
-                                      num_components)) {
-    return errors::Internal("Failed to perform snappy decompression.");
+  switch (compressed.codec()) {
+    case CompressedElement::SNAPPY:
+      TF_RETURN_IF_ERROR(SnappyUncompress(compressed.data(), total_size,
+                                          iov.data(), num_components));
+      break;
+    case CompressedElement::UNCOMPRESSED:
+      TF_RETURN_IF_ERROR(CopyToIOVec(compressed.data(), total_size, iov.data(),
+                                     num_components));
+      break;
+    case CompressedElement::ZLIB:
+      TF_RETURN_IF_ERROR(ZlibUncompress(compressed.data(), total_size,
+                                        iov.data(), num_components));
+      break;
+    default:
+      return errors::Unimplemented("Unknown element compression codec: ",
+                                   compressed.codec());
   }
 
   // Step 3: Deserialize tensor proto strings to tensors.
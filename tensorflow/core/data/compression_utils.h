@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_COMPRESSION_UTILS_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_COMPRESSION_UTILS_H_
 
+#include <string>
+
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/data/dataset.pb.h"
 #include "tensorflow/core/platform/status.h"
@@ -22,12 +24,35 @@ limitations under the License.
 namespace tensorflow {
 namespace data {
 
+// Codecs for compressing elements.
+constexpr char kSnappyCodec[] = "SNAPPY";
+constexpr char kNoneCodec[] = "NONE";
+constexpr char kZlibCodec[] = "ZLIB";
+// Compresses a sample of each element with snappy, and stores the element
+// uncompressed if the sample does not shrink by at least 10%. This avoids
+// spending CPU on elements that are already compressed, such as encoded
+// images.
+constexpr char kAdaptiveCodec[] = "ADAPTIVE";
+
+struct CompressionOptions {
+  // One of the codecs above.
+  std::string codec = kSnappyCodec;
+  // The compression level of the ZLIB codec, from 0 to 9, or -1 for the zlib
+  // default. Ignored by the other codecs.
+  int level = -1;
+};
+
 // Compresses the components of `element` into the `CompressedElement` proto.
 //
 // In addition to writing the actual compressed bytes, `Compress` fills
 // out the per-component metadata for the `CompressedElement`.
 //
 // Returns an error if the uncompressed size of the element exceeds 4GB.
+Status CompressElement(const std::vector<Tensor>& element,
+                       const CompressionOptions& options,
+                       CompressedElement* out);
+
+// Same as above, using the SNAPPY codec.
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out);
 
@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -36,6 +38,31 @@ TEST(CompressionUtilsTest, Exceeds4GB) {
                        HasSubstr("exceeding the 4GB Snappy limit")));
 }
 
+TEST(CompressionUtilsTest, AdaptiveSkipsIncompressibleElements) {
+  random::PhiloxRandom philox(/*seed=*/42);
+  random::SimplePhilox rng(&philox);
+  Tensor noise(DT_INT64, TensorShape{1 << 14});
+  for (int i = 0; i < noise.NumElements(); ++i) {
+    noise.flat<int64_t>()(i) = rng.Rand64();
+  }
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement({noise}, {kAdaptiveCodec, -1}, &compressed));
+  EXPECT_EQ(compressed.codec(), CompressedElement::UNCOMPRESSED);
+
+  Tensor zeros(DT_INT64, TensorShape{1 << 14});
+  zeros.flat<int64_t>().setZero();
+  TF_ASSERT_OK(CompressElement({zeros}, {kAdaptiveCodec, -1}, &compressed));
+  EXPECT_EQ(compressed.codec(), CompressedElement::SNAPPY);
+}
+
+TEST(CompressionUtilsTest, UnknownCodec) {
+  CompressedElement compressed;
+  EXPECT_THAT(CompressElement(CreateTensors<int64_t>(TensorShape{1}, {{1}}),
+                              {"LZMA", -1}, &compressed),
+              StatusIs(error::INVALID_ARGUMENT,
+                       HasSubstr("Unknown element compression codec")));
+}
+
 class ParameterizedCompressionUtilsTest
     : public DatasetOpsTestBase,
       public ::testing::WithParamInterface<std::vector<Tensor>> {};
@@ -50,6 +77,24 @@ TEST_P(ParameterizedCompressionUtilsTest, RoundTrip) {
       ExpectEqual(element, round_trip_element, /*compare_order=*/true));
 }
 
+TEST_P(ParameterizedCompressionUtilsTest, RoundTripWithCodec) {
+  std::vector<Tensor> element = GetParam();
+  for (const auto& options : std::vector<CompressionOptions>{
+           {kSnappyCodec, -1},
+           {kNoneCodec, -1},
+           {kZlibCodec, -1},
+           {kZlibCodec, 1},
+           {kZlibCodec, 9},
+           {kAdaptiveCodec, -1}}) {
+    CompressedElement compressed;
+    TF_ASSERT_OK(CompressElement(element, options, &compressed));
+    std::vector<Tensor> round_trip_element;
+    TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+    TF_EXPECT_OK(
+        ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+  }
+}
+
 std::vector<std::vector<Tensor>> TestCases() {
   return {
       CreateTensors<int64_t>(TensorShape{1}, {{1}}),           // int64
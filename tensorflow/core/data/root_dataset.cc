@@ -153,6 +153,8 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
 
   ~Iterator() override { cancellation_manager_->StartCancel(); }
 
+  std::shared_ptr<model::Model> model() const override { return model_; }
+
   Status Initialize(IteratorContext* ctx) override {
     return dataset()->input_->MakeIterator(IteratorContext(CreateParams(ctx)),
                                            this, prefix(), &input_impl_);
@@ -91,6 +91,7 @@ Status DataServiceDispatcherClient::GetDatasetDef(int64_t dataset_id,
 
 Status DataServiceDispatcherClient::GetSplit(int64_t job_id, int64_t iteration,
                                              int64_t split_provider_index,
+                                             const std::string& worker_address,
                                              Tensor& split,
                                              bool& end_of_splits) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
@@ -98,6 +99,7 @@ Status DataServiceDispatcherClient::GetSplit(int64_t job_id, int64_t iteration,
   req.set_job_id(job_id);
   req.set_iteration(iteration);
   req.set_split_provider_index(split_provider_index);
+  req.set_worker_address(worker_address);
   GetSplitResponse resp;
   grpc::ClientContext client_ctx;
   grpc::Status status = stub_->GetSplit(&client_ctx, req, &resp);
@@ -60,9 +60,10 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
   Status GetDatasetDef(int64_t dataset_id, DatasetDef& dataset_def);
 
   // Gets the next split for the specified job id, iteration, and split
-  // provider index.
+  // provider index, on behalf of the worker at `worker_address`.
   Status GetSplit(int64_t job_id, int64_t iteration,
-                  int64_t split_provider_index, Tensor& split,
+                  int64_t split_provider_index,
+                  const std::string& worker_address, Tensor& split,
                   bool& end_of_splits);
 
   // Registers a dataset with the tf.data service, and stores the generated
@@ -356,24 +356,26 @@ Status DataServiceDispatcherImpl::WorkerUpdate(
     const WorkerUpdateRequest* request, WorkerUpdateResponse* response) {
   TF_RETURN_IF_ERROR(CheckStarted());
   mutex_lock l(mu_);
-  for (auto& update : request->updates()) {
-    int64_t task_id = update.task_id();
-    std::shared_ptr<const Task> task;
-    TF_RETURN_IF_ERROR(state_.TaskFromId(task_id, task));
-    if (update.completed()) {
-      if (task->finished) {
-        VLOG(1) << "Received completion update for already-finished task "
-                << task->task_id << " on worker " << task->worker_address;
-        continue;
+  return ApplyBatched([&]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    for (auto& update : request->updates()) {
+      int64_t task_id = update.task_id();
+      std::shared_ptr<const Task> task;
+      TF_RETURN_IF_ERROR(state_.TaskFromId(task_id, task));
+      if (update.completed()) {
+        if (task->finished) {
+          VLOG(1) << "Received completion update for already-finished task "
+                  << task->task_id << " on worker " << task->worker_address;
+          continue;
+        }
+        Update update;
+        update.mutable_finish_task()->set_task_id(task_id);
+        TF_RETURN_IF_ERROR(Apply(update));
+        VLOG(3) << "Task " << task_id << " from job " << task->job->job_id
+                << " completed";
       }
-      Update update;
-      update.mutable_finish_task()->set_task_id(task_id);
-      TF_RETURN_IF_ERROR(Apply(update));
-      VLOG(3) << "Task " << task_id << " from job " << task->job->job_id
-              << " completed";
     }
-  }
-  return Status::OK();
+    return Status::OK();
+  });
 }
 
 Status DataServiceDispatcherImpl::GetDatasetDef(
@@ -413,25 +415,77 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
             << iteration;
     return Status::OK();
   }
-  SplitProvider* split_provider =
-      split_providers_[job_id][provider_index].get();
-  DCHECK(split_provider != nullptr);
   Tensor split;
   bool end_of_splits = false;
-  TF_RETURN_IF_ERROR(split_provider->GetNext(&split, &end_of_splits));
-  TF_RETURN_IF_ERROR(RecordSplitProduced(
-      job_id, iteration, request->split_provider_index(), end_of_splits));
-  response->set_end_of_splits(end_of_splits);
-  if (end_of_splits) {
-    // Reset the split provider to prepare for the next iteration.
-    TF_RETURN_IF_ERROR(split_providers_[job_id][provider_index]->Reset());
+  if (config_.split_locality_window() > 0) {
+    TF_RETURN_IF_ERROR(GetSplitFromAssigner(job_id, iteration, provider_index,
+                                            request->worker_address(), split,
+                                            end_of_splits));
   } else {
+    SplitProvider* split_provider =
+        split_providers_[job_id][provider_index].get();
+    DCHECK(split_provider != nullptr);
+    TF_RETURN_IF_ERROR(split_provider->GetNext(&split, &end_of_splits));
+    TF_RETURN_IF_ERROR(RecordSplitProduced(
+        job_id, iteration, request->split_provider_index(), end_of_splits));
+    if (end_of_splits) {
+      // Reset the split provider to prepare for the next iteration.
+      TF_RETURN_IF_ERROR(split_providers_[job_id][provider_index]->Reset());
+    }
+  }
+  response->set_end_of_splits(end_of_splits);
+  if (!end_of_splits) {
     split.AsProtoTensorContent(response->mutable_split());
   }
   VLOG(3) << "Returning from GetSplit, end_of_splits=" << end_of_splits;
   return Status::OK();
 }
 
+Status DataServiceDispatcherImpl::GetSplitFromAssigner(
+    int64_t job_id, int64_t iteration, int64_t provider_index,
+    const std::string& worker_address, Tensor& split, bool& end_of_splits)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::vector<std::unique_ptr<SplitProvider>>& split_providers =
+      split_providers_[job_id];
+  std::vector<SplitAssigner>& assigners = split_assigners_[job_id];
+  while (assigners.size() < split_providers.size()) {
+    assigners.emplace_back(config_.split_locality_window());
+  }
+  SplitProvider* split_provider = split_providers[provider_index].get();
+  DCHECK(split_provider != nullptr);
+  SplitAssigner& assigner = assigners[provider_index];
+  while (assigner.NeedsSplits()) {
+    Tensor next;
+    bool provider_end_of_splits = false;
+    TF_RETURN_IF_ERROR(split_provider->GetNext(&next, &provider_end_of_splits));
+    if (provider_end_of_splits) {
+      assigner.MarkExhausted();
+      break;
+    }
+    // Splits are recorded when they are read, so that a restarted dispatcher
+    // doesn't produce them again.
+    TF_RETURN_IF_ERROR(RecordSplitProduced(job_id, iteration, provider_index,
+                                           /*finished=*/false));
+    assigner.AddSplit(next);
+  }
+  if (!assigner.HasPendingSplits()) {
+    end_of_splits = true;
+    TF_RETURN_IF_ERROR(RecordSplitProduced(job_id, iteration, provider_index,
+                                           /*finished=*/true));
+    assigner.EndEpoch();
+    // Reset the split provider to prepare for the next iteration.
+    return split_provider->Reset();
+  }
+  std::vector<std::string> worker_tags;
+  std::shared_ptr<const Worker> worker;
+  if (state_.WorkerFromAddress(worker_address, worker).ok()) {
+    worker_tags = worker->tags;
+  }
+  split = assigner.Assign(worker_address, worker_tags);
+  end_of_splits = false;
+  return Status::OK();
+}
+
 Status DataServiceDispatcherImpl::MakeSplitProviders(
     int64_t dataset_id,
     std::vector<std::unique_ptr<SplitProvider>>& split_providers)
@@ -687,18 +741,20 @@ Status DataServiceDispatcherImpl::CreateJob(
 Status DataServiceDispatcherImpl::CreateTasksForWorker(
     const std::string& worker_address) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   std::vector<std::shared_ptr<const Job>> jobs = state_.ListJobs();
-  for (const auto& job : jobs) {
-    if (job->finished) {
-      continue;
-    }
-    if (job->num_consumers.has_value()) {
-      TF_RETURN_IF_ERROR(CreatePendingTask(job, worker_address));
-      continue;
+  return ApplyBatched([&]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    for (const auto& job : jobs) {
+      if (job->finished) {
+        continue;
+      }
+      if (job->num_consumers.has_value()) {
+        TF_RETURN_IF_ERROR(CreatePendingTask(job, worker_address));
+        continue;
+      }
+      std::shared_ptr<const Task> task;
+      TF_RETURN_IF_ERROR(CreateTask(job, worker_address, task));
     }
-    std::shared_ptr<const Task> task;
-    TF_RETURN_IF_ERROR(CreateTask(job, worker_address, task));
-  }
-  return Status::OK();
+    return Status::OK();
+  });
 }
 
 Status DataServiceDispatcherImpl::AcquireJobClientId(
@@ -723,12 +779,14 @@ Status DataServiceDispatcherImpl::CreateTasksForJob(
   std::vector<std::shared_ptr<const Worker>> workers = state_.ListWorkers();
   tasks.clear();
   tasks.reserve(workers.size());
-  for (const auto& worker : workers) {
-    std::shared_ptr<const Task> task;
-    TF_RETURN_IF_ERROR(CreateTask(job, worker->address, task));
-    tasks.push_back(task);
-  }
-  return Status::OK();
+  return ApplyBatched([&]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    for (const auto& worker : workers) {
+      std::shared_ptr<const Task> task;
+      TF_RETURN_IF_ERROR(CreateTask(job, worker->address, task));
+      tasks.push_back(task);
+    }
+    return Status::OK();
+  });
 }
 
 Status DataServiceDispatcherImpl::CreatePendingTask(
@@ -1007,11 +1065,28 @@ Status DataServiceDispatcherImpl::ApplyWithoutJournaling(const Update& update)
 Status DataServiceDispatcherImpl::Apply(const Update& update)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   if (journal_writer_.has_value()) {
-    TF_RETURN_IF_ERROR(journal_writer_.value()->Write(update));
+    if (defer_journal_sync_) {
+      TF_RETURN_IF_ERROR(journal_writer_.value()->WriteUnsynced(update));
+    } else {
+      TF_RETURN_IF_ERROR(journal_writer_.value()->Write(update));
+    }
   }
   return state_.Apply(update);
 }
 
+Status DataServiceDispatcherImpl::ApplyBatched(
+    const std::function<Status()>& f) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (!journal_writer_.has_value() || defer_journal_sync_) {
+    return f();
+  }
+  defer_journal_sync_ = true;
+  Status s = f();
+  defer_journal_sync_ = false;
+  Status sync_status = journal_writer_.value()->Sync();
+  TF_RETURN_IF_ERROR(s);
+  return sync_status;
+}
+
 void DataServiceDispatcherImpl::JobGcThread() {
   int64_t next_check_micros = 0;
   while (true) {
@@ -1045,20 +1120,22 @@ void DataServiceDispatcherImpl::JobGcThread() {
 Status DataServiceDispatcherImpl::ReleaseMissingClients()
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   int64_t now = env_->NowMicros();
-  for (const auto& client_id : state_.ListActiveClientIds()) {
-    if (absl::FromUnixMicros(now) >
-        latest_client_heartbeats_time_[client_id] +
-            absl::Milliseconds(config_.client_timeout_ms())) {
-      LOG(INFO) << "Releasing timed-out client with id " << client_id;
-      Update update;
-      ReleaseJobClientUpdate* release_client =
-          update.mutable_release_job_client();
-      release_client->set_job_client_id(client_id);
-      release_client->set_time_micros(now);
-      TF_RETURN_IF_ERROR(Apply(update));
+  return ApplyBatched([&]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    for (const auto& client_id : state_.ListActiveClientIds()) {
+      if (absl::FromUnixMicros(now) >
+          latest_client_heartbeats_time_[client_id] +
+              absl::Milliseconds(config_.client_timeout_ms())) {
+        LOG(INFO) << "Releasing timed-out client with id " << client_id;
+        Update update;
+        ReleaseJobClientUpdate* release_client =
+            update.mutable_release_job_client();
+        release_client->set_job_client_id(client_id);
+        release_client->set_time_micros(now);
+        TF_RETURN_IF_ERROR(Apply(update));
+      }
     }
-  }
-  return Status::OK();
+    return Status::OK();
+  });
 }
 
 Status DataServiceDispatcherImpl::GcOldJobs() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_DISPATCHER_IMPL_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_DISPATCHER_IMPL_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -29,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/dataset_store.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/dispatcher_state.h"
+#include "tensorflow/core/data/service/split_assigner.h"
 #include "tensorflow/core/data/service/task_remover.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -264,12 +266,25 @@ class DataServiceDispatcherImpl {
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Checks that the dispatcher has started, returning UNAVAILABLE if it hasn't.
   Status CheckStarted() TF_LOCKS_EXCLUDED(mu_);
+  // Gets the next split of the split provider at `provider_index` for the
+  // worker at `worker_address`, reading ahead into the provider's
+  // `SplitAssigner` and letting it choose the split.
+  Status GetSplitFromAssigner(int64_t job_id, int64_t iteration,
+                              int64_t provider_index,
+                              const std::string& worker_address, Tensor& split,
+                              bool& end_of_splits)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Records that a split was produced by a call to `GetSplit`.
   Status RecordSplitProduced(int64_t job_id, int64_t iteration,
                              int64_t split_provider_index, bool finished)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Applies a state update, updating both the journal and the in-memory state.
   Status Apply(const Update& update) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Runs `f`, which may apply several updates, with journal syncs deferred,
+  // then syncs the journal once. Written updates are synced even if `f`
+  // fails, since they have already been applied to the in-memory state.
+  Status ApplyBatched(const std::function<Status()>& f)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Applies a state update, but doesn't update the journal. Only meant to be
   // used when recovering state when the dispatcher starts.
   Status ApplyWithoutJournaling(const Update& update)
@@ -306,6 +321,12 @@ class DataServiceDispatcherImpl {
   // Mapping from job id to the split providers for the job.
   absl::flat_hash_map<int64_t, std::vector<std::unique_ptr<SplitProvider>>>
       split_providers_ TF_GUARDED_BY(mu_);
+  // Mapping from job id to the split assigners for the job's split providers,
+  // used when `config_.split_locality_window()` is positive. They buffer
+  // splits that have been recorded as produced, so the buffered splits are
+  // lost if the dispatcher restarts.
+  absl::flat_hash_map<int64_t, std::vector<SplitAssigner>> split_assigners_
+      TF_GUARDED_BY(mu_);
   // Mapping from round robin job id to the round the job is currently on. This
   // is based on the data provided by client heartbeats, and may be stale.
   absl::flat_hash_map<int64_t, int64_t> round_robin_rounds_ TF_GUARDED_BY(mu_);
@@ -318,6 +339,9 @@ class DataServiceDispatcherImpl {
 
   absl::optional<std::unique_ptr<JournalWriter>> journal_writer_
       TF_GUARDED_BY(mu_);
+  // Whether `Apply` should leave journal syncing to an enclosing
+  // `ApplyBatched`.
+  bool defer_journal_sync_ TF_GUARDED_BY(mu_) = false;
   DispatcherState state_ TF_GUARDED_BY(mu_);
   // Condition variable for waking up the job gc thread.
   condition_variable job_gc_thread_cv_;
@@ -74,6 +74,11 @@ Status FileJournalWriter::EnsureInitialized() {
 }
 
 Status FileJournalWriter::Write(const Update& update) {
+  TF_RETURN_IF_ERROR(WriteUnsynced(update));
+  return Sync();
+}
+
+Status FileJournalWriter::WriteUnsynced(const Update& update) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
   std::string s = update.SerializeAsString();
   if (s.empty()) {
@@ -81,14 +86,18 @@ Status FileJournalWriter::Write(const Update& update) {
                             " to string");
   }
   TF_RETURN_IF_ERROR(writer_->WriteRecord(s));
-  TF_RETURN_IF_ERROR(writer_->Flush());
-  TF_RETURN_IF_ERROR(file_->Sync());
   if (VLOG_IS_ON(4)) {
     VLOG(4) << "Wrote journal entry: " << update.DebugString();
   }
   return Status::OK();
 }
 
+Status FileJournalWriter::Sync() {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  TF_RETURN_IF_ERROR(writer_->Flush());
+  return file_->Sync();
+}
+
 FileJournalReader::FileJournalReader(Env* env, StringPiece journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
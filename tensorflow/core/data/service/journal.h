@@ -36,6 +36,11 @@ class JournalWriter {
   virtual ~JournalWriter() = default;
   // Writes and syncs an update to the journal.
   virtual Status Write(const Update& update) = 0;
+  // Writes an update to the journal without syncing it. The update becomes
+  // durable with the next call to `Sync` or `Write`.
+  virtual Status WriteUnsynced(const Update& update) = 0;
+  // Flushes and syncs all updates written so far.
+  virtual Status Sync() = 0;
   // Initializes the writer if it is not yet initialized.
   virtual Status EnsureInitialized() = 0;
 };
@@ -54,8 +59,9 @@ class JournalWriter {
 // When the writer is created, it lists the directory to find the next available
 // journal file name. For example, if the journal directory contains
 // "journal_0", "journal_1", and "journal_2", the writer will write to
-// "journal_3". The writer will flush updates as they are written, so that they
-// can be stored durably in case of machine failure.
+// "journal_3". `Write` flushes updates as they are written, so that they can be
+// stored durably in case of machine failure. Callers writing many updates at
+// once can use `WriteUnsynced` followed by a single `Sync` instead.
 class FileJournalWriter : public JournalWriter {
  public:
   // Creates a journal writer to write to the given journal directory.
@@ -66,6 +72,8 @@ class FileJournalWriter : public JournalWriter {
   FileJournalWriter& operator=(const FileJournalWriter&) = delete;
 
   Status Write(const Update& update) override;
+  Status WriteUnsynced(const Update& update) override;
+  Status Sync() override;
   Status EnsureInitialized() override;
 
  private:
@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERVICE_MULTI_TRAINER_CACHE_H_
 
 #include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <functional>
 #include <limits>
@@ -46,6 +47,8 @@ namespace data {
 // cache requests additional data. It has a bounded size. Elements are garbage
 // collected when the cache becomes full. Consequently, trainers read from a
 // sliding window through the dataset and may not read the full dataset.
+// `GetTrainerStats` reports how often each trainer hit the cache and how many
+// elements it skipped by lagging behind the window.
 //
 // The `MultiTrainerCache` class is thread-safe.
 //
@@ -119,6 +122,21 @@ class MultiTrainerCache {
   // Returns true if the cache has been cancelled.
   bool IsCancelled() const;
 
+  // Per-trainer read statistics.
+  struct TrainerStats {
+    // Number of reads served without this trainer extending the cache.
+    int64_t num_hits = 0;
+    // Number of reads for which this trainer extended the cache.
+    int64_t num_misses = 0;
+    // Number of elements evicted before this trainer read them, because it
+    // lagged more than the cache size behind the fastest trainer.
+    int64_t num_skipped_elements = 0;
+  };
+
+  // Returns the statistics of `trainer_id`. Unknown trainers have all-zero
+  // statistics.
+  TrainerStats GetTrainerStats(const std::string& trainer_id) const;
+
  private:
   // Returns true if element is ready for `trainer_id`. An element is ready if
   // other trainers have read the data and the data remains in the cache. If the
@@ -129,9 +147,10 @@ class MultiTrainerCache {
   // the cached elements).
   size_t GetElementIndex(const std::string& trainer_id);
 
-  // Returns the next element for `trainer_id`.
+  // Returns the next element for `trainer_id`. `cache_hit` is recorded in the
+  // trainer's statistics.
   StatusOr<std::shared_ptr<const ElementType>> GetElement(
-      const std::string& trainer_id);
+      const std::string& trainer_id, bool cache_hit);
 
   // Reads a new element and writes it into the cache.
   Status ExtendCache();
@@ -166,6 +185,10 @@ class MultiTrainerCache {
   // `trainer_to_element_index_map_[trainer_id] - cache_start_index_`.
   absl::flat_hash_map<std::string, size_t> trainer_to_element_index_map_
       TF_GUARDED_BY(mu_);
+
+  // Maps trainer IDs to their read statistics.
+  absl::flat_hash_map<std::string, TrainerStats> trainer_stats_
+      TF_GUARDED_BY(mu_);
 };
 
 template <class ElementType>
@@ -197,7 +220,7 @@ MultiTrainerCache<ElementType>::Get(const std::string& trainer_id)
       if (IsElementReady(trainer_id)) {
         metrics::RecordTFDataServiceMultiTrainerCacheQuery(
             /*cache_hit=*/!should_extend_cache);
-        return GetElement(trainer_id);
+        return GetElement(trainer_id, /*cache_hit=*/!should_extend_cache);
       }
 
       // Extends the cache or waits for another thread to extend the cache. When
@@ -230,9 +253,23 @@ bool MultiTrainerCache<ElementType>::IsElementReady(
 
 template <class ElementType>
 StatusOr<std::shared_ptr<const ElementType>>
-MultiTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
+MultiTrainerCache<ElementType>::GetElement(const std::string& trainer_id,
+                                           bool cache_hit)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   size_t element_index = GetElementIndex(trainer_id);
+  TrainerStats& stats = trainer_stats_[trainer_id];
+  if (cache_hit) {
+    ++stats.num_hits;
+  } else {
+    ++stats.num_misses;
+  }
+  auto it = trainer_to_element_index_map_.find(trainer_id);
+  if (it != trainer_to_element_index_map_.end() &&
+      it->second < element_index) {
+    const size_t num_skipped = element_index - it->second;
+    stats.num_skipped_elements += num_skipped;
+    metrics::RecordTFDataServiceMultiTrainerCacheSkippedElements(num_skipped);
+  }
   if (element_index >= std::numeric_limits<size_t>::max()) {
     return errors::Internal(
         "tf.data service caching element index exceeds integer limit. Got ",
@@ -248,7 +285,9 @@ MultiTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
 template <class ElementType>
 size_t MultiTrainerCache<ElementType>::GetElementIndex(
     const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-  size_t element_index = trainer_to_element_index_map_[trainer_id];
+  auto it = trainer_to_element_index_map_.find(trainer_id);
+  size_t element_index =
+      it == trainer_to_element_index_map_.end() ? 0 : it->second;
   if (element_index < cache_start_index_) {
     element_index = cache_start_index_;
   }
@@ -313,6 +352,15 @@ bool MultiTrainerCache<ElementType>::IsCancelled() const
   mutex_lock l(mu_);
   return !status_.ok();
 }
+
+template <class ElementType>
+typename MultiTrainerCache<ElementType>::TrainerStats
+MultiTrainerCache<ElementType>::GetTrainerStats(
+    const std::string& trainer_id) const TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  auto it = trainer_stats_.find(trainer_id);
+  return it == trainer_stats_.end() ? TrainerStats() : it->second;
+}
 }  // namespace data
 }  // namespace tensorflow
 
@@ -191,6 +191,38 @@ TEST(MultiTrainerCacheTest, SlowTrainersSkipData) {
   EXPECT_THAT(cache.Get("Slow trainer 2"), IsOkAndHolds(Pointee(Gt(94))));
 }
 
+TEST(MultiTrainerCacheTest, TrainerStats) {
+  MultiTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      absl::make_unique<InfiniteRange>());
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(15)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(16)));
+  for (int i = 20; i < 30; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  // The slow trainer was at 17 and the cache now holds 25 to 29.
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(25)));
+
+  auto fast_stats = cache.GetTrainerStats("Fast trainer");
+  EXPECT_EQ(fast_stats.num_hits, 0);
+  EXPECT_EQ(fast_stats.num_misses, 30);
+  EXPECT_EQ(fast_stats.num_skipped_elements, 0);
+
+  // A trainer's first read does not count as skipping.
+  auto slow_stats = cache.GetTrainerStats("Slow trainer");
+  EXPECT_EQ(slow_stats.num_hits, 3);
+  EXPECT_EQ(slow_stats.num_misses, 0);
+  EXPECT_EQ(slow_stats.num_skipped_elements, 8);
+
+  auto unknown_stats = cache.GetTrainerStats("Unknown trainer");
+  EXPECT_EQ(unknown_stats.num_hits, 0);
+  EXPECT_EQ(unknown_stats.num_misses, 0);
+  EXPECT_EQ(unknown_stats.num_skipped_elements, 0);
+}
+
 TEST(MultiTrainerCacheTest, NewTrainersStartLate) {
   MultiTrainerCache<int64_t> cache(
       /*max_cache_size_bytes=*/5 * sizeof(int64_t),
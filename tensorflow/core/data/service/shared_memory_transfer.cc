@@ -0,0 +1,607 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/service/shared_memory_transfer.h"
+
+#include "tensorflow/core/platform/platform.h"
+
+#if !defined(PLATFORM_WINDOWS)
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/dataset.pb.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// The smallest shared memory segment created for a connection.
+constexpr uint64_t kMinSegmentBytes = 1 << 20;
+
+// How a component is laid out in the shared memory segment.
+enum class Encoding : uint8_t {
+  // The bytes of a tensor whose type can be copied with memcpy.
+  kRaw = 0,
+  // A serialized TensorProto.
+  kTensorProto = 1,
+  // A serialized CompressedElement.
+  kCompressedElement = 2,
+};
+
+// Precedes each component in the shared memory segment, followed by `rank`
+// int64_t dimensions and `num_bytes` bytes of data.
+struct ComponentHeader {
+  Encoding encoding;
+  int32_t dtype;
+  uint32_t rank;
+  uint64_t num_bytes;
+};
+
+// Sent by the server in response to each request, followed by `message_size`
+// bytes of the error message and `segment_name_size` bytes of the name of the
+// shared memory segment that the element was written to. The name is only
+// sent when the segment changes.
+struct ResponseHeader {
+  int32_t code;
+  uint32_t message_size;
+  uint32_t segment_name_size;
+  uint8_t end_of_sequence;
+  uint8_t skip;
+  int64_t element_index;
+  uint64_t num_components;
+};
+
+Status IoError(absl::string_view context) {
+  return errors::Unavailable(context, ": ", strerror(errno));
+}
+
+Status WriteAll(int fd, const void* data, size_t n) {
+  const char* p = static_cast<const char*>(data);
+  while (n > 0) {
+    int flags = 0;
+#ifdef MSG_NOSIGNAL
+    flags |= MSG_NOSIGNAL;
+#endif
+    ssize_t written = send(fd, p, n, flags);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return IoError("Failed to write to shared memory transfer socket");
+    }
+    p += written;
+    n -= written;
+  }
+  return Status::OK();
+}
+
+Status ReadAll(int fd, void* data, size_t n) {
+  char* p = static_cast<char*>(data);
+  while (n > 0) {
+    ssize_t read = recv(fd, p, n, 0);
+    if (read < 0) {
+      if (errno == EINTR) continue;
+      return IoError("Failed to read from shared memory transfer socket");
+    }
+    if (read == 0) {
+      return errors::Unavailable("Shared memory transfer socket was closed.");
+    }
+    p += read;
+    n -= read;
+  }
+  return Status::OK();
+}
+
+Status WriteMessage(int fd, const std::string& message) {
+  const uint32_t size = message.size();
+  TF_RETURN_IF_ERROR(WriteAll(fd, &size, sizeof(size)));
+  return WriteAll(fd, message.data(), message.size());
+}
+
+Status ReadMessage(int fd, std::string* message) {
+  uint32_t size;
+  TF_RETURN_IF_ERROR(ReadAll(fd, &size, sizeof(size)));
+  message->resize(size);
+  return ReadAll(fd, &(*message)[0], size);
+}
+
+// A memory mapping of a POSIX shared memory segment.
+class SharedMemorySegment {
+ public:
+  // Creates a new segment of `size` bytes and maps it for writing.
+  static Status Create(const std::string& name, uint64_t size,
+                       std::unique_ptr<SharedMemorySegment>* out) {
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+      return IoError(absl::StrCat("Failed to create shared memory ", name));
+    }
+    if (ftruncate(fd, size) != 0) {
+      Status s = IoError(absl::StrCat("Failed to resize shared memory ", name));
+      close(fd);
+      shm_unlink(name.c_str());
+      return s;
+    }
+    return Map(name, fd, size, PROT_READ | PROT_WRITE, /*owned=*/true, out);
+  }
+
+  // Maps the existing segment `name` for reading.
+  static Status Open(const std::string& name,
+                     std::unique_ptr<SharedMemorySegment>* out) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+      return IoError(absl::StrCat("Failed to open shared memory ", name));
+    }
+    off_t size = lseek(fd, 0, SEEK_END);
+    if (size < 0) {
+      Status s = IoError(absl::StrCat("Failed to size shared memory ", name));
+      close(fd);
+      return s;
+    }
+    return Map(name, fd, size, PROT_READ, /*owned=*/false, out);
+  }
+
+  ~SharedMemorySegment() {
+    munmap(data_, size_);
+    if (owned_) {
+      shm_unlink(name_.c_str());
+    }
+  }
+
+  const std::string& name() const { return name_; }
+  char* data() const { return data_; }
+  uint64_t size() const { return size_; }
+
+ private:
+  SharedMemorySegment(std::string name, char* data, uint64_t size, bool owned)
+      : name_(std::move(name)), data_(data), size_(size), owned_(owned) {}
+
+  static Status Map(const std::string& name, int fd, uint64_t size, int prot,
+                    bool owned, std::unique_ptr<SharedMemorySegment>* out) {
+    void* data = mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+    Status s;
+    if (data == MAP_FAILED) {
+      s = IoError(absl::StrCat("Failed to map shared memory ", name));
+    }
+    close(fd);
+    if (!s.ok()) {
+      if (owned) shm_unlink(name.c_str());
+      return s;
+    }
+    out->reset(new SharedMemorySegment(name, static_cast<char*>(data), size,
+                                       owned));
+    return Status::OK();
+  }
+
+  const std::string name_;
+  char* const data_;
+  const uint64_t size_;
+  // Whether the segment is unlinked when it is unmapped.
+  const bool owned_;
+};
+
+// A component of an element, ready to be written to shared memory.
+struct EncodedComponent {
+  ComponentHeader header;
+  const Tensor* tensor = nullptr;
+  // Points to the bytes to write for raw tensors, and to `serialized` for
+  // TensorProtos.
+  const char* data = nullptr;
+  std::string serialized;
+  const CompressedElement* compressed = nullptr;
+
+  uint64_t EncodedBytes() const {
+    return sizeof(header) + header.rank * sizeof(int64_t) + header.num_bytes;
+  }
+};
+
+Status EncodeElement(const std::vector<Tensor>& element,
+                     std::vector<EncodedComponent>* components) {
+  components->resize(element.size());
+  for (size_t i = 0; i < element.size(); ++i) {
+    const Tensor& tensor = element[i];
+    EncodedComponent& component = (*components)[i];
+    component.tensor = &tensor;
+    component.header.dtype = tensor.dtype();
+    component.header.rank = tensor.dims();
+    if (element.size() == 1 && tensor.dtype() == DT_VARIANT &&
+        TensorShapeUtils::IsScalar(tensor.shape()) &&
+        tensor.scalar<Variant>()().get<CompressedElement>() != nullptr) {
+      component.header.encoding = Encoding::kCompressedElement;
+      component.compressed =
+          tensor.scalar<Variant>()().get<CompressedElement>();
+      component.header.num_bytes = component.compressed->ByteSizeLong();
+    } else if (DataTypeCanUseMemcpy(tensor.dtype())) {
+      component.header.encoding = Encoding::kRaw;
+      component.data = tensor.tensor_data().data();
+      component.header.num_bytes = tensor.tensor_data().size();
+    } else {
+      component.header.encoding = Encoding::kTensorProto;
+      TensorProto proto;
+      tensor.AsProtoTensorContent(&proto);
+      if (!proto.SerializeToString(&component.serialized)) {
+        return errors::Internal("Failed to serialize tensor.");
+      }
+      component.data = component.serialized.data();
+      component.header.num_bytes = component.serialized.size();
+    }
+  }
+  return Status::OK();
+}
+
+void WriteElement(const std::vector<EncodedComponent>& components,
+                  char* dest) {
+  for (const auto& component : components) {
+    memcpy(dest, &component.header, sizeof(component.header));
+    dest += sizeof(component.header);
+    for (int d = 0; d < component.header.rank; ++d) {
+      const int64_t dim = component.tensor->dim_size(d);
+      memcpy(dest, &dim, sizeof(dim));
+      dest += sizeof(dim);
+    }
+    if (component.compressed != nullptr) {
+      component.compressed->SerializeWithCachedSizesToArray(
+          reinterpret_cast<uint8_t*>(dest));
+    } else {
+      memcpy(dest, component.data, component.header.num_bytes);
+    }
+    dest += component.header.num_bytes;
+  }
+}
+
+Status ReadElement(const SharedMemorySegment& segment, uint64_t num_components,
+                   std::vector<Tensor>* element) {
+  const char* src = segment.data();
+  const char* end = segment.data() + segment.size();
+  auto read = [&src, end](void* dest, uint64_t n) {
+    if (static_cast<uint64_t>(end - src) < n) {
+      return errors::DataLoss("Element exceeds its shared memory segment.");
+    }
+    memcpy(dest, src, n);
+    src += n;
+    return Status::OK();
+  };
+  for (uint64_t i = 0; i < num_components; ++i) {
+    ComponentHeader header;
+    TF_RETURN_IF_ERROR(read(&header, sizeof(header)));
+    TensorShape shape;
+    for (uint32_t d = 0; d < header.rank; ++d) {
+      int64_t dim;
+      TF_RETURN_IF_ERROR(read(&dim, sizeof(dim)));
+      TF_RETURN_IF_ERROR(shape.AddDimWithStatus(dim));
+    }
+    if (static_cast<uint64_t>(end - src) < header.num_bytes) {
+      return errors::DataLoss("Element exceeds its shared memory segment.");
+    }
+    switch (header.encoding) {
+      case Encoding::kRaw: {
+        Tensor tensor(static_cast<DataType>(header.dtype), shape);
+        if (tensor.TotalBytes() != header.num_bytes) {
+          return errors::DataLoss("Unexpected size of tensor in shared memory");
+        }
+        memcpy(const_cast<char*>(tensor.tensor_data().data()), src,
+               header.num_bytes);
+        element->push_back(std::move(tensor));
+        break;
+      }
+      case Encoding::kTensorProto: {
+        TensorProto proto;
+        element->emplace_back();
+        if (!proto.ParseFromArray(src, header.num_bytes) ||
+            !element->back().FromProto(proto)) {
+          return errors::Internal("Failed to parse tensor.");
+        }
+        break;
+      }
+      case Encoding::kCompressedElement: {
+        CompressedElement compressed;
+        if (!compressed.ParseFromArray(src, header.num_bytes)) {
+          return errors::Internal("Failed to parse compressed element.");
+        }
+        Tensor tensor(DT_VARIANT, TensorShape{});
+        tensor.scalar<Variant>()() = std::move(compressed);
+        element->push_back(std::move(tensor));
+        break;
+      }
+      default:
+        return errors::DataLoss("Unknown encoding of element in shared memory");
+    }
+    src += header.num_bytes;
+  }
+  return Status::OK();
+}
+
+class SharedMemoryDataTransferServer : public DataTransferServer {
+ public:
+  explicit SharedMemoryDataTransferServer(GetElementT get_element)
+      : get_element_(std::move(get_element)) {}
+
+  ~SharedMemoryDataTransferServer() override {
+    if (listen_fd_ >= 0) {
+      shutdown(listen_fd_, SHUT_RDWR);
+    }
+    accept_thread_.reset();
+    {
+      mutex_lock l(mu_);
+      cancelled_ = true;
+      for (int fd : connection_fds_) {
+        shutdown(fd, SHUT_RDWR);
+      }
+    }
+    connection_threads_.clear();
+    if (listen_fd_ >= 0) {
+      close(listen_fd_);
+    }
+  }
+
+  Status Start() override {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+      return IoError("Failed to create shared memory transfer socket");
+    }
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t addr_len = sizeof(addr);
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), addr_len) != 0 ||
+        listen(listen_fd_, SOMAXCONN) != 0 ||
+        getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr),
+                    &addr_len) != 0) {
+      return IoError("Failed to listen for shared memory transfer clients");
+    }
+    port_ = ntohs(addr.sin_port);
+    accept_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+        {}, "tf_data_shm_accept", [this]() { AcceptLoop(); }));
+    return Status::OK();
+  }
+
+  int get_port() override { return port_; }
+
+ private:
+  void AcceptLoop() {
+    while (true) {
+      int fd = accept(listen_fd_, nullptr, nullptr);
+      if (fd < 0) {
+        if (errno == EINTR) continue;
+        // The listening socket was shut down.
+        return;
+      }
+      mutex_lock l(mu_);
+      if (cancelled_) {
+        close(fd);
+        return;
+      }
+      connection_fds_.push_back(fd);
+      const int64_t connection_id = next_connection_id_++;
+      connection_threads_.push_back(
+          absl::WrapUnique(Env::Default()->StartThread(
+              {}, "tf_data_shm_connection",
+              [this, fd, connection_id]() { Serve(fd, connection_id); })));
+    }
+  }
+
+  // Serves the requests of one client until it disconnects.
+  void Serve(int fd, int64_t connection_id) {
+    std::unique_ptr<SharedMemorySegment> segment;
+    int64_t num_segments = 0;
+    std::string request_bytes;
+    while (ReadMessage(fd, &request_bytes).ok()) {
+      GetElementRequest request;
+      GetElementResult result;
+      std::vector<EncodedComponent> components;
+      Status s = request.ParseFromString(request_bytes)
+                     ? get_element_(&request, &result)
+                     : errors::InvalidArgument("Failed to parse request.");
+      if (s.ok()) {
+        s = EncodeElement(result.components, &components);
+      }
+      uint64_t element_bytes = 0;
+      for (const auto& component : components) {
+        element_bytes += component.EncodedBytes();
+      }
+      std::string segment_name;
+      if (s.ok() && element_bytes > 0 &&
+          (!segment || segment->size() < element_bytes)) {
+        segment_name = absl::StrCat("/tf_data_shm_", getpid(), "_", port_, "_",
+                                    connection_id, "_", num_segments++);
+        // The previous segment, if any, is unlinked here, which is safe as
+        // the client only maps the latest segment.
+        segment.reset();
+        s = SharedMemorySegment::Create(
+            segment_name, std::max(2 * element_bytes, kMinSegmentBytes),
+            &segment);
+        if (!s.ok()) segment_name.clear();
+      }
+      if (s.ok() && element_bytes > 0) {
+        WriteElement(components, segment->data());
+      }
+
+      ResponseHeader header;
+      memset(&header, 0, sizeof(header));
+      header.code = s.code();
+      header.message_size = s.error_message().size();
+      header.segment_name_size = segment_name.size();
+      header.end_of_sequence = result.end_of_sequence;
+      header.skip = result.skip;
+      header.element_index = result.element_index;
+      header.num_components = components.size();
+      if (!WriteAll(fd, &header, sizeof(header)).ok() ||
+          !WriteAll(fd, s.error_message().data(), header.message_size).ok() ||
+          !WriteAll(fd, segment_name.data(), segment_name.size()).ok()) {
+        break;
+      }
+    }
+    mutex_lock l(mu_);
+    connection_fds_.erase(
+        std::find(connection_fds_.begin(), connection_fds_.end(), fd));
+    close(fd);
+  }
+
+  const GetElementT get_element_;
+  int listen_fd_ = -1;
+  int port_ = 0;
+
+  mutex mu_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  int64_t next_connection_id_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<int> connection_fds_ TF_GUARDED_BY(mu_);
+  // Only modified by the accept thread. Must be destroyed before the members
+  // above, which the threads use.
+  std::vector<std::unique_ptr<Thread>> connection_threads_;
+  std::unique_ptr<Thread> accept_thread_;
+};
+
+class SharedMemoryDataTransferClient : public DataTransferClient {
+ public:
+  // Connects to the server listening on the port in `address`.
+  static Status Connect(absl::string_view address,
+                        std::unique_ptr<DataTransferClient>* out) {
+    const size_t colon = address.rfind(':');
+    int port;
+    if (colon == absl::string_view::npos ||
+        !absl::SimpleAtoi(address.substr(colon + 1), &port)) {
+      return errors::InvalidArgument(
+          "Expected the shared memory transfer address to be of the form "
+          "host:port, but got ",
+          address);
+    }
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+      return IoError("Failed to create shared memory transfer socket");
+    }
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+      Status s = IoError(absl::StrCat(
+          "Failed to connect to shared memory transfer server at ", address));
+      close(fd);
+      return s;
+    }
+    VLOG(2) << "Create SharedMemoryDataTransferClient for worker " << address
+            << ".";
+    out->reset(new SharedMemoryDataTransferClient(fd));
+    return Status::OK();
+  }
+
+  ~SharedMemoryDataTransferClient() override { close(fd_); }
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override {
+    VLOG(3) << "GetElement for task " << req.task_id()
+            << " from shared memory worker server.";
+    mutex_lock l(mu_);
+    if (cancelled_) {
+      return errors::Cancelled("Client was cancelled.");
+    }
+    TF_RETURN_IF_ERROR(WriteMessage(fd_, req.SerializeAsString()));
+    ResponseHeader header;
+    TF_RETURN_IF_ERROR(ReadAll(fd_, &header, sizeof(header)));
+    std::string message(header.message_size, '\0');
+    TF_RETURN_IF_ERROR(ReadAll(fd_, &message[0], message.size()));
+    if (header.code != error::OK) {
+      return Status(static_cast<error::Code>(header.code), message);
+    }
+    if (header.segment_name_size > 0) {
+      std::string segment_name(header.segment_name_size, '\0');
+      TF_RETURN_IF_ERROR(ReadAll(fd_, &segment_name[0], segment_name.size()));
+      segment_.reset();
+      TF_RETURN_IF_ERROR(SharedMemorySegment::Open(segment_name, &segment_));
+    }
+    result.end_of_sequence = header.end_of_sequence;
+    result.skip = header.skip;
+    result.element_index = header.element_index;
+    if (header.num_components > 0) {
+      if (!segment_) {
+        return errors::Internal("Received an element without shared memory.");
+      }
+      TF_RETURN_IF_ERROR(
+          ReadElement(*segment_, header.num_components, &result.components));
+    }
+    return Status::OK();
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel SharedMemoryDataTransferClient.";
+    cancelled_ = true;
+    // Unblocks the request in progress, if any.
+    shutdown(fd_, SHUT_RDWR);
+  }
+
+ private:
+  explicit SharedMemoryDataTransferClient(int fd) : fd_(fd) {}
+
+  const int fd_;
+  std::atomic<bool> cancelled_{false};
+  // Serializes requests, as the protocol allows one at a time per connection.
+  mutex mu_;
+  std::unique_ptr<SharedMemorySegment> segment_ TF_GUARDED_BY(mu_);
+};
+
+class SharedMemoryTransferRegistrar {
+ public:
+  SharedMemoryTransferRegistrar() {
+    DataTransferServer::Register(
+        kSharedMemoryTransferProtocol,
+        [](DataTransferServer::GetElementT get_element) {
+          return std::make_shared<SharedMemoryDataTransferServer>(
+              std::move(get_element));
+        });
+    DataTransferClient::Register(
+        kSharedMemoryTransferProtocol,
+        [](DataTransferClient::Config config,
+           std::unique_ptr<DataTransferClient>* out) {
+          return SharedMemoryDataTransferClient::Connect(config.address, out);
+        });
+  }
+};
+static SharedMemoryTransferRegistrar shared_memory_transfer_registrar;
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // !defined(PLATFORM_WINDOWS)
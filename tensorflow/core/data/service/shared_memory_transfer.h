@@ -0,0 +1,41 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHARED_MEMORY_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHARED_MEMORY_TRANSFER_H_
+
+namespace tensorflow {
+namespace data {
+
+// Data transfer protocol for tf.data service workers and clients that run on
+// the same host but in different processes. The worker writes each element
+// into a shared memory segment that the client maps, so that element bytes
+// are neither serialized into a GetElementResponse nor copied through a
+// socket. Only the requests and the sizes of the elements are exchanged over
+// a loopback TCP connection to the port returned by
+// `DataTransferServer::get_port()`.
+//
+// Workers enable it by setting `data_transfer_protocol` to this value and
+// `data_transfer_address` to "localhost:%port%" in their `WorkerConfig`.
+// Clients in the same process as the worker should keep using the "local"
+// protocol, which does not copy elements at all.
+//
+// The protocol is not available on Windows.
+constexpr const char kSharedMemoryTransferProtocol[] = "shared_memory";
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHARED_MEMORY_TRANSFER_H_
@@ -0,0 +1,133 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/service/shared_memory_transfer.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+class SharedMemoryTransferTest : public ::testing::Test {
+ protected:
+  // Starts a server whose elements are produced by `get_element` and connects
+  // a client to it.
+  void Start(DataTransferServer::GetElementT get_element) {
+    TF_ASSERT_OK(DataTransferServer::Build(kSharedMemoryTransferProtocol,
+                                           std::move(get_element), &server_));
+    TF_ASSERT_OK(server_->Start());
+    TF_ASSERT_OK(DataTransferClient::Build(
+        kSharedMemoryTransferProtocol,
+        {"grpc", absl::StrCat("localhost:", server_->get_port())}, &client_));
+  }
+
+  std::shared_ptr<DataTransferServer> server_;
+  std::unique_ptr<DataTransferClient> client_;
+};
+
+TEST_F(SharedMemoryTransferTest, GetElements) {
+  int64_t num_calls = 0;
+  Start([&num_calls](const GetElementRequest* request,
+                     GetElementResult* result) {
+    if (num_calls == 2) {
+      result->end_of_sequence = true;
+      return Status::OK();
+    }
+    result->components.push_back(
+        test::AsTensor<int64_t>({num_calls, 1, 2}, TensorShape({3})));
+    result->components.push_back(test::AsScalar<tstring>("element"));
+    result->element_index = num_calls++;
+    return Status::OK();
+  });
+
+  for (int64_t i = 0; i < 2; ++i) {
+    GetElementRequest request;
+    GetElementResult result;
+    TF_ASSERT_OK(client_->GetElement(request, result));
+    EXPECT_FALSE(result.end_of_sequence);
+    EXPECT_EQ(result.element_index, i);
+    ASSERT_EQ(result.components.size(), 2);
+    test::ExpectEqual(result.components[0],
+                      test::AsTensor<int64_t>({i, 1, 2}, TensorShape({3})));
+    test::ExpectEqual(result.components[1], test::AsScalar<tstring>("element"));
+  }
+  GetElementRequest request;
+  GetElementResult result;
+  TF_ASSERT_OK(client_->GetElement(request, result));
+  EXPECT_TRUE(result.end_of_sequence);
+  EXPECT_TRUE(result.components.empty());
+}
+
+TEST_F(SharedMemoryTransferTest, ElementLargerThanSegment) {
+  // The last element does not fit in the first segment.
+  const std::vector<int64_t> sizes = {16, 1024, 1 << 20};
+  int64_t num_calls = 0;
+  Start([&](const GetElementRequest* request, GetElementResult* result) {
+    Tensor tensor(DT_FLOAT, TensorShape({sizes[num_calls++]}));
+    test::FillIota<float>(&tensor, 0.0f);
+    result->components.push_back(tensor);
+    return Status::OK();
+  });
+
+  for (int64_t expected_size : sizes) {
+    GetElementRequest request;
+    GetElementResult result;
+    TF_ASSERT_OK(client_->GetElement(request, result));
+    ASSERT_EQ(result.components.size(), 1);
+    Tensor expected(DT_FLOAT, TensorShape({expected_size}));
+    test::FillIota<float>(&expected, 0.0f);
+    test::ExpectEqual(result.components[0], expected);
+  }
+}
+
+TEST_F(SharedMemoryTransferTest, PropagatesErrors) {
+  Start([](const GetElementRequest* request, GetElementResult* result) {
+    return errors::NotFound("No such task.");
+  });
+  GetElementRequest request;
+  GetElementResult result;
+  Status s = client_->GetElement(request, result);
+  EXPECT_TRUE(errors::IsNotFound(s)) << s;
+  EXPECT_EQ(s.error_message(), "No such task.");
+}
+
+TEST_F(SharedMemoryTransferTest, Cancel) {
+  Start([](const GetElementRequest* request, GetElementResult* result) {
+    result->end_of_sequence = true;
+    return Status::OK();
+  });
+  client_->TryCancel();
+  GetElementRequest request;
+  GetElementResult result;
+  EXPECT_TRUE(errors::IsCancelled(client_->GetElement(request, result)));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,92 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/split_assigner.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace data {
+
+SplitAssigner::SplitAssigner(int64_t window_size)
+    : window_size_(std::max<int64_t>(window_size, 1)) {}
+
+bool SplitAssigner::NeedsSplits() const {
+  return !exhausted_ && static_cast<int64_t>(pending_.size()) < window_size_;
+}
+
+void SplitAssigner::AddSplit(const Tensor& split) {
+  TensorProto proto;
+  split.AsProtoTensorContent(&proto);
+  pending_.emplace_back(proto.SerializeAsString(), split);
+}
+
+void SplitAssigner::MarkExhausted() { exhausted_ = true; }
+
+bool SplitAssigner::HasPendingSplits() const { return !pending_.empty(); }
+
+Tensor SplitAssigner::Assign(const std::string& worker_address,
+                             const std::vector<std::string>& worker_tags) {
+  DCHECK(HasPendingSplits());
+  auto best = pending_.begin();
+  int best_score = -1;
+  for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+    const int score = Score(it->first, worker_address, worker_tags);
+    if (score > best_score) {
+      best = it;
+      best_score = score;
+      if (score == 2) break;
+    }
+  }
+  current_owners_[best->first] = Owner{worker_address, worker_tags};
+  Tensor split = std::move(best->second);
+  pending_.erase(best);
+  return split;
+}
+
+void SplitAssigner::EndEpoch() {
+  previous_owners_ = std::move(current_owners_);
+  current_owners_.clear();
+  exhausted_ = false;
+}
+
+int SplitAssigner::Score(const std::string& split_key,
+                         const std::string& worker_address,
+                         const std::vector<std::string>& worker_tags) const {
+  auto it = previous_owners_.find(split_key);
+  if (it == previous_owners_.end()) {
+    return 1;
+  }
+  const Owner& owner = it->second;
+  if (owner.address == worker_address) {
+    return 2;
+  }
+  for (const std::string& tag : owner.tags) {
+    if (std::find(worker_tags.begin(), worker_tags.end(), tag) !=
+        worker_tags.end()) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace data
+}  // namespace tensorflow
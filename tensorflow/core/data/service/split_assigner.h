@@ -0,0 +1,95 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SPLIT_ASSIGNER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SPLIT_ASSIGNER_H_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/tensor.h"
+
+namespace tensorflow {
+namespace data {
+
+// A `SplitAssigner` decides which worker reads each split of one split
+// provider in a dynamically sharded job. Instead of handing out splits in
+// request order, it buffers a window of splits and gives a worker the one it
+// is best placed to read:
+//  1. A split the same worker read in the previous epoch, whose data it may
+//     have cached.
+//  2. A split no worker read in the previous epoch, or one read by a worker
+//     that shares a tag (e.g. a host or zone) with this worker.
+//  3. Otherwise, the oldest split, so that workers steal the splits left over
+//     by slower workers instead of waiting for them, in particular at the end
+//     of an epoch.
+//
+// The dispatcher reads splits from the split provider into the assigner while
+// `NeedsSplits()`, and calls `EndEpoch()` once the provider is exhausted and
+// all its splits are assigned.
+//
+// Not thread-safe.
+class SplitAssigner {
+ public:
+  explicit SplitAssigner(int64_t window_size);
+
+  // Returns whether the dispatcher should read another split from the split
+  // provider: the window is not full and the provider isn't exhausted.
+  bool NeedsSplits() const;
+  // Adds a split read from the split provider.
+  void AddSplit(const Tensor& split);
+  // Records that the split provider has no more splits this epoch.
+  void MarkExhausted();
+  // Returns whether there are splits waiting to be assigned.
+  bool HasPendingSplits() const;
+
+  // Removes the pending split best suited to the worker at `worker_address`
+  // with tags `worker_tags`. Requires `HasPendingSplits()`.
+  Tensor Assign(const std::string& worker_address,
+                const std::vector<std::string>& worker_tags);
+
+  // Starts a new epoch. The assignments of the ending epoch become the
+  // previous assignments that the next epoch prefers.
+  void EndEpoch();
+
+ private:
+  // A worker that read a split.
+  struct Owner {
+    std::string address;
+    std::vector<std::string> tags;
+  };
+
+  // Returns how well the worker suits the split with key `split_key`, from 0
+  // (another worker's split) to 2 (this worker's split).
+  int Score(const std::string& split_key, const std::string& worker_address,
+            const std::vector<std::string>& worker_tags) const;
+
+  const int64_t window_size_;
+  bool exhausted_ = false;
+  // Splits read from the split provider but not yet assigned, oldest first,
+  // with their keys (serialized split tensors).
+  std::deque<std::pair<std::string, Tensor>> pending_;
+  // Who read each split in the previous and in the current epoch.
+  absl::flat_hash_map<std::string, Owner> previous_owners_;
+  absl::flat_hash_map<std::string, Owner> current_owners_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SPLIT_ASSIGNER_H_
@@ -0,0 +1,119 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/split_assigner.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Reads splits 0, ..., `num_splits` - 1 into `assigner` while it needs them,
+// starting at `*next`.
+void FillAssigner(SplitAssigner& assigner, int64_t num_splits, int64_t* next) {
+  while (assigner.NeedsSplits()) {
+    if (*next == num_splits) {
+      assigner.MarkExhausted();
+      return;
+    }
+    assigner.AddSplit(Tensor((*next)++));
+  }
+}
+
+int64_t Assign(SplitAssigner& assigner, const std::string& worker_address,
+               const std::vector<std::string>& worker_tags = {}) {
+  return assigner.Assign(worker_address, worker_tags).scalar<int64_t>()();
+}
+
+TEST(SplitAssignerTest, FirstEpochAssignsInOrder) {
+  SplitAssigner assigner(/*window_size=*/2);
+  int64_t next = 0;
+  std::vector<int64_t> assigned;
+  for (const std::string& worker : {"w0", "w1", "w0", "w1"}) {
+    FillAssigner(assigner, /*num_splits=*/4, &next);
+    assigned.push_back(Assign(assigner, worker));
+  }
+  EXPECT_EQ(assigned, std::vector<int64_t>({0, 1, 2, 3}));
+  FillAssigner(assigner, /*num_splits=*/4, &next);
+  EXPECT_FALSE(assigner.HasPendingSplits());
+}
+
+TEST(SplitAssignerTest, PrefersSplitsOfThePreviousEpoch) {
+  SplitAssigner assigner(/*window_size=*/4);
+  int64_t next = 0;
+  FillAssigner(assigner, /*num_splits=*/4, &next);
+  EXPECT_EQ(Assign(assigner, "w0"), 0);
+  EXPECT_EQ(Assign(assigner, "w1"), 1);
+  EXPECT_EQ(Assign(assigner, "w0"), 2);
+  EXPECT_EQ(Assign(assigner, "w1"), 3);
+  assigner.EndEpoch();
+
+  next = 0;
+  FillAssigner(assigner, /*num_splits=*/4, &next);
+  EXPECT_EQ(Assign(assigner, "w1"), 1);
+  EXPECT_EQ(Assign(assigner, "w1"), 3);
+  EXPECT_EQ(Assign(assigner, "w0"), 0);
+  EXPECT_EQ(Assign(assigner, "w0"), 2);
+}
+
+TEST(SplitAssignerTest, StealsSplitsOfOtherWorkers) {
+  SplitAssigner assigner(/*window_size=*/4);
+  int64_t next = 0;
+  FillAssigner(assigner, /*num_splits=*/2, &next);
+  EXPECT_EQ(Assign(assigner, "w0"), 0);
+  EXPECT_EQ(Assign(assigner, "w1"), 1);
+  assigner.EndEpoch();
+
+  // `w1` is slow, so `w0` reads its split too.
+  next = 0;
+  FillAssigner(assigner, /*num_splits=*/2, &next);
+  EXPECT_EQ(Assign(assigner, "w0"), 0);
+  EXPECT_EQ(Assign(assigner, "w0"), 1);
+  EXPECT_FALSE(assigner.HasPendingSplits());
+}
+
+TEST(SplitAssignerTest, PrefersSplitsOfWorkersWithSharedTags) {
+  SplitAssigner assigner(/*window_size=*/3);
+  int64_t next = 0;
+  FillAssigner(assigner, /*num_splits=*/3, &next);
+  EXPECT_EQ(Assign(assigner, "w0", {"host_a"}), 0);
+  EXPECT_EQ(Assign(assigner, "w1", {"host_b"}), 1);
+  EXPECT_EQ(Assign(assigner, "w2", {"host_a"}), 2);
+  assigner.EndEpoch();
+
+  next = 0;
+  FillAssigner(assigner, /*num_splits=*/3, &next);
+  EXPECT_EQ(Assign(assigner, "w3", {"host_b"}), 1);
+  EXPECT_EQ(Assign(assigner, "w3", {"host_b"}), 0);
+}
+
+TEST(SplitAssignerTest, WindowBoundsBufferedSplits) {
+  SplitAssigner assigner(/*window_size=*/1);
+  int64_t next = 0;
+  FillAssigner(assigner, /*num_splits=*/2, &next);
+  EXPECT_FALSE(assigner.NeedsSplits());
+  EXPECT_EQ(next, 1);
+  EXPECT_EQ(Assign(assigner, "w0"), 0);
+  EXPECT_TRUE(assigner.NeedsSplits());
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
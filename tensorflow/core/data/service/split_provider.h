@@ -30,15 +30,20 @@ namespace tensorflow {
 namespace data {
 
 // SplitProvider which reads splits from a tf.data service dispatcher over RPC.
+// `worker_address` is the address of the worker reading the splits, which the
+// dispatcher may use to assign it splits it read before.
 class DataServiceSplitProvider : public SplitProvider {
  public:
   DataServiceSplitProvider(const std::string& address,
                            const std::string& protocol, int64_t job_id,
-                           int64_t split_provider_index, int64_t timeout_ms)
+                           int64_t split_provider_index,
+                           const std::string& worker_address,
+                           int64_t timeout_ms)
       : address_(address),
         protocol_(protocol),
         job_id_(job_id),
         split_provider_index_(split_provider_index),
+        worker_address_(worker_address),
         timeout_ms_(timeout_ms) {}
 
   Status GetNext(Tensor* split, bool* end_of_splits) override;
@@ -53,6 +58,7 @@ class DataServiceSplitProvider : public SplitProvider {
   const std::string protocol_;
   const int64_t job_id_;
   const int64_t split_provider_index_;
+  const std::string worker_address_;
   const int64_t timeout_ms_;
 
   mutex mu_;
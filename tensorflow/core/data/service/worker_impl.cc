@@ -350,7 +350,7 @@ DataServiceWorkerImpl::MakeDatasetIterator(standalone::Dataset& dataset,
     for (int i = 0; i < task_def.num_split_providers(); ++i) {
       split_providers.push_back(absl::make_unique<DataServiceSplitProvider>(
           config_.dispatcher_address(), config_.protocol(), task_def.job_id(),
-          i, config_.dispatcher_timeout_ms()));
+          i, task_def.worker_address(), config_.dispatcher_timeout_ms()));
     }
     TF_RETURN_IF_ERROR(
         dataset.MakeIterator(std::move(split_providers), &iterator));
@@ -36,12 +36,14 @@ limitations under the License.
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
 #include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/snapshot.pb.h"
 
@@ -58,12 +60,27 @@ constexpr const char* const kCurrentCheckpointID = "current_checkpoint_id";
 constexpr const char* const kIndex = "index";
 constexpr const char* const kStartIndex = "start_index";
 
+// The number of blocks of a block compressed file ("SNAPPY_BLOCK" or
+// "ZLIB_BLOCK") that a TFRecordWriter compresses in parallel, and the number
+// of reads a TFRecordReader keeps in flight ahead of its position.
+constexpr int kNumOutstandingBlocks = 8;
+constexpr int kNumOutstandingReads = 4;
+
+// Compresses, prefetches and decompresses for the TFRecord writers and
+// readers. It is shared as a snapshot spreads its I/O over many shards.
+thread::ThreadPool* GetTFRecordThreadPool() {
+  static thread::ThreadPool* thread_pool = new thread::ThreadPool(
+      Env::Default(), "tf_data_snapshot_io", port::MaxParallelism());
+  return thread_pool;
+}
+
 }  // namespace
 
 /* static */ constexpr const int64_t
     CustomReader::kSnappyReaderInputBufferSizeBytes;
 /* static */ constexpr const int64_t
     CustomReader::kSnappyReaderOutputBufferSizeBytes;
+/* static */ constexpr const int64_t AsyncWriter::kMaxBufferedBytes;
 
 std::string HashDirectory(const std::string& path, uint64 hash) {
   return io::JoinPath(
@@ -123,9 +140,12 @@ TFRecordWriter::TFRecordWriter(const std::string& filename,
 Status TFRecordWriter::Initialize(tensorflow::Env* env) {
   TF_RETURN_IF_ERROR(env->NewAppendableFile(filename_, &dest_));
 
-  record_writer_ = absl::make_unique<io::RecordWriter>(
-      dest_.get(), io::RecordWriterOptions::CreateRecordWriterOptions(
-                       /*compression_type=*/compression_type_));
+  io::RecordWriterOptions options =
+      io::RecordWriterOptions::CreateRecordWriterOptions(
+          /*compression_type=*/compression_type_);
+  options.num_outstanding_blocks = kNumOutstandingBlocks;
+  options.compression_thread_pool = GetTFRecordThreadPool();
+  record_writer_ = absl::make_unique<io::RecordWriter>(dest_.get(), options);
   return Status::OK();
 }
 
@@ -717,9 +737,14 @@ TFRecordReader::TFRecordReader(const std::string& filename,
 Status TFRecordReader::Initialize(Env* env) {
   TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename_, &file_));
 
-  record_reader_ = absl::make_unique<io::RecordReader>(
-      file_.get(), io::RecordReaderOptions::CreateRecordReaderOptions(
-                       /*compression_type=*/compression_type_));
+  // Snapshot files are read sequentially, so reading ahead hides the latency
+  // of the file system.
+  io::RecordReaderOptions options =
+      io::RecordReaderOptions::CreateRecordReaderOptions(
+          /*compression_type=*/compression_type_);
+  options.num_outstanding_reads = kNumOutstandingReads;
+  options.read_thread_pool = GetTFRecordThreadPool();
+  record_reader_ = absl::make_unique<io::RecordReader>(file_.get(), options);
   return Status::OK();
 }
 
@@ -1038,15 +1063,27 @@ AsyncWriter::AsyncWriter(Env* env, int64_t file_index,
       ThreadOptions(), absl::StrCat("writer_thread_", file_index),
       [this, env, shard_directory, checkpoint_id, compression, version,
        &output_types, done = std::move(done)] {
-        done(WriterThread(env, shard_directory, checkpoint_id, compression,
-                          version, output_types));
+        Status s = WriterThread(env, shard_directory, checkpoint_id,
+                                compression, version, output_types);
+        {
+          mutex_lock l(mu_);
+          writer_finished_ = true;
+        }
+        done(s);
       }));
 }
 
 void AsyncWriter::Write(const std::vector<Tensor>& tensors) {
   mutex_lock l(mu_);
+  mu_.Await(tensorflow::Condition(this, &AsyncWriter::CanBuffer));
+  // The writer thread has reported its error, the element would never be
+  // written.
+  if (writer_finished_) return;
   ElementOrEOF element;
   element.value = tensors;
+  for (const Tensor& tensor : tensors) {
+    buffered_bytes_ += tensor.TotalBytes();
+  }
   deque_.push_back(std::move(element));
 }
 
@@ -1060,12 +1097,21 @@ void AsyncWriter::SignalEOF() {
 void AsyncWriter::Consume(ElementOrEOF* be) {
   mutex_lock l(mu_);
   mu_.Await(tensorflow::Condition(this, &AsyncWriter::ElementAvailable));
-  *be = deque_.front();
+  *be = std::move(deque_.front());
   deque_.pop_front();
+  for (const Tensor& tensor : be->value) {
+    buffered_bytes_ -= tensor.TotalBytes();
+  }
 }
 
 bool AsyncWriter::ElementAvailable() { return !deque_.empty(); }
 
+bool AsyncWriter::CanBuffer() {
+  // A single element larger than the limit can still be written.
+  return writer_finished_ || deque_.empty() ||
+         buffered_bytes_ < kMaxBufferedBytes;
+}
+
 Status AsyncWriter::WriterThread(Env* env, const std::string& shard_directory,
                                  uint64 checkpoint_id,
                                  const std::string& compression,
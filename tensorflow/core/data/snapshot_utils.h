@@ -356,8 +356,12 @@ class AsyncWriter {
                        const DataTypeVector& output_types,
                        std::function<void(Status)> done);
 
-  // Writes the given tensors. The method is non-blocking and returns without
-  // waiting for the element to be written.
+  // The elements waiting to be written are limited to this many bytes.
+  static constexpr int64_t kMaxBufferedBytes = 64 << 20;
+
+  // Writes the given tensors. The method returns without waiting for the
+  // element to be written, but blocks while `kMaxBufferedBytes` of elements
+  // wait to be written, so that a slow file system bounds the memory use.
   void Write(const std::vector<Tensor>& tensors) TF_LOCKS_EXCLUDED(mu_);
 
   // Signals the end of input. The method is non-blocking and returns without
@@ -367,12 +371,18 @@ class AsyncWriter {
  private:
   void Consume(ElementOrEOF* be) TF_LOCKS_EXCLUDED(mu_);
   bool ElementAvailable() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  bool CanBuffer() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   Status WriterThread(Env* env, const std::string& shard_directory,
                       uint64 checkpoint_id, const std::string& compression,
                       int64_t version, DataTypeVector output_types);
 
   mutex mu_;
   std::deque<ElementOrEOF> deque_ TF_GUARDED_BY(mu_);
+  // The total size of the tensors in `deque_`.
+  int64_t buffered_bytes_ TF_GUARDED_BY(mu_) = 0;
+  // Whether the writer thread has returned, possibly with an error, and
+  // consumes no more elements.
+  bool writer_finished_ TF_GUARDED_BY(mu_) = false;
 
   // This has to be last. During destruction, we need to make sure that the
   // Thread object is destroyed first as its destructor blocks on thread
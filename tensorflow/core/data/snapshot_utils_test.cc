@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -89,6 +90,46 @@ TEST(SnapshotUtilTest, CombinationRoundTripTest) {
   SnapshotRoundTrip(io::compression::kNone, 2);
   SnapshotRoundTrip(io::compression::kGzip, 2);
   SnapshotRoundTrip(io::compression::kSnappy, 2);
+  SnapshotRoundTrip(io::compression::kSnappyBlock, 2);
+  SnapshotRoundTrip(io::compression::kZlibBlock, 2);
+}
+
+TEST(SnapshotUtilTest, AsyncWriterRoundTrip) {
+  std::vector<Tensor> tensors;
+  tensorflow::DataTypeVector dtypes;
+  GenerateTensorVector(dtypes, tensors);
+  const std::string shard_directory =
+      io::JoinPath(testing::TmpDir(), "async_writer_round_trip");
+
+  const int64_t num_elements = 100;
+  Status status;
+  {
+    AsyncWriter writer(Env::Default(), /*file_index=*/0, shard_directory,
+                       /*checkpoint_id=*/0, io::compression::kSnappyBlock,
+                       /*version=*/2, dtypes,
+                       [&status](Status s) { status = s; });
+    for (int64_t i = 0; i < num_elements; ++i) {
+      writer.Write(tensors);
+    }
+    writer.SignalEOF();
+  }
+  TF_ASSERT_OK(status);
+
+  std::unique_ptr<Reader> reader;
+  TF_ASSERT_OK(Reader::Create(Env::Default(),
+                              GetCheckpointFileName(shard_directory, 0),
+                              io::compression::kSnappyBlock, /*version=*/2,
+                              dtypes, &reader));
+  std::vector<Tensor> read_tensors;
+  for (int64_t i = 0; i < num_elements; ++i) {
+    read_tensors.clear();
+    TF_ASSERT_OK(reader->ReadTensors(&read_tensors));
+    ASSERT_EQ(read_tensors.size(), tensors.size());
+  }
+  EXPECT_EQ(read_tensors[0].scalar<tstring>()(),
+            tensors[0].scalar<tstring>()());
+  read_tensors.clear();
+  EXPECT_EQ(reader->ReadTensors(&read_tensors).code(), error::OUT_OF_RANGE);
 }
 
 void SnapshotReaderBenchmarkLoop(::testing::benchmark::State& state,
@@ -45,8 +45,10 @@ static void StartAbortRendevous(Rendezvous* rendez, const Status& s) {
   rendez->Unref();
 }
 
-BaseRendezvousMgr::BaseRendezvousMgr(const WorkerEnv* worker_env)
-    : worker_env_(worker_env) {}
+BaseRendezvousMgr::BaseRendezvousMgr(const WorkerEnv* worker_env,
+                                     int num_local_rendezvous_shards)
+    : worker_env_(worker_env),
+      num_local_rendezvous_shards_(num_local_rendezvous_shards) {}
 
 BaseRendezvousMgr::~BaseRendezvousMgr() {
   for (auto& p : table_) {
@@ -84,6 +86,21 @@ void BaseRendezvousMgr::RecvLocalAsync(int64_t step_id,
   rendez->RecvLocalAsync(parsed, std::move(done_cb));
 }
 
+void BaseRendezvousMgr::RecvLocalAsync(int64_t step_id,
+                                       const Rendezvous::ParsedKey& parsed,
+                                       const Rendezvous::Args& recv_args,
+                                       Rendezvous::DoneCallback done) {
+  auto rendez = FindOrCreate(step_id);
+  auto done_cb = [rendez, done = std::move(done)](
+                     const Status& s, const Rendezvous::Args& send_args,
+                     const Rendezvous::Args& recv_args, const Tensor& v,
+                     bool dead) {
+    rendez->Unref();
+    done(s, send_args, recv_args, v, dead);
+  };
+  rendez->RecvLocalAsync(parsed, recv_args, std::move(done_cb));
+}
+
 Status BaseRendezvousMgr::RecvLocal(int64_t step_id,
                                     const Rendezvous::ParsedKey& parsed,
                                     Tensor* val, bool* is_dead) {
@@ -126,10 +143,11 @@ void BaseRendezvousMgr::CleanupAll() {
 }
 
 BaseRemoteRendezvous::BaseRemoteRendezvous(const WorkerEnv* env,
-                                           int64_t step_id)
+                                           int64_t step_id,
+                                           int num_local_shards)
     : env_(env),
       step_id_(step_id),
-      local_(NewLocalRendezvous()),
+      local_(NewLocalRendezvous(num_local_shards)),
       session_(nullptr) {}
 
 BaseRemoteRendezvous::~BaseRemoteRendezvous() {
@@ -168,7 +186,7 @@ Status BaseRemoteRendezvous::Initialize(WorkerSession* session) {
     std::swap(deferred_calls, deferred_calls_);
   }
   for (auto& call : deferred_calls) {
-    RecvLocalAsyncInternal(call.parsed, std::move(call.done));
+    RecvLocalAsyncInternal(call.parsed, call.args, std::move(call.done));
   }
   return Status::OK();
 }
@@ -356,6 +374,12 @@ void BaseRemoteRendezvous::RecvAsync(const ParsedKey& parsed,
 
 void BaseRemoteRendezvous::RecvLocalAsync(const ParsedKey& parsed,
                                           DoneCallback done) {
+  RecvLocalAsync(parsed, Args(), std::move(done));
+}
+
+void BaseRemoteRendezvous::RecvLocalAsync(const ParsedKey& parsed,
+                                          const Rendezvous::Args& args,
+                                          DoneCallback done) {
   // Test whether the rendezvous is initialized using a shared lock, to avoid
   // the need for exclusive access in the common case.
   if (TF_PREDICT_FALSE(!is_initialized())) {
@@ -368,22 +392,23 @@ void BaseRemoteRendezvous::RecvLocalAsync(const ParsedKey& parsed,
       // rendezvous logic. At some point after Initialize() is called, a Tensor
       // is produced locally that will then be sent in response to the incoming
       // RPC.
-      DeferredCall call(parsed, std::move(done));
+      DeferredCall call(parsed, args, std::move(done));
       deferred_calls_.push_back(call);
       return;
     }
   }
-  RecvLocalAsyncInternal(parsed, std::move(done));
+  RecvLocalAsyncInternal(parsed, args, std::move(done));
 }
 
 void BaseRemoteRendezvous::RecvLocalAsyncInternal(const ParsedKey& parsed,
+                                                  const Rendezvous::Args& args,
                                                   DoneCallback done) {
   Status s = ValidateDevices(parsed, true /* is_src */);
   if (!s.ok()) {
-    done(s, Args(), Args(), Tensor(), false);
+    done(s, Args(), args, Tensor(), false);
     return;
   }
-  local_->RecvAsync(parsed, Args(), std::move(done));
+  local_->RecvAsync(parsed, args, std::move(done));
 }
 
 void BaseRemoteRendezvous::StartAbort(const Status& s) {
@@ -482,7 +507,8 @@ void BaseRemoteRendezvous::DeregisterCall(BaseRecvTensorCall* call,
 }
 
 BaseRemoteRendezvous::DeferredCall::DeferredCall(const ParsedKey& parsed,
+                                                 const Rendezvous::Args& args,
                                                  DoneCallback done)
-    : parsed(parsed), done(std::move(done)) {}
+    : parsed(parsed), args(args), done(std::move(done)) {}
 
 }  // end namespace tensorflow
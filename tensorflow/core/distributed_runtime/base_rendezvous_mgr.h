@@ -61,7 +61,10 @@ class CancellationManager;
 // RendezvousMgr must have keys generated by Rendezvous::CreateKey().
 class BaseRendezvousMgr : public RendezvousMgrInterface {
  public:
-  explicit BaseRendezvousMgr(const WorkerEnv* worker_env);
+  // `num_local_rendezvous_shards` is the number of shards of the local
+  // rendezvous table of each step (see LocalRendezvous).
+  explicit BaseRendezvousMgr(const WorkerEnv* worker_env,
+                             int num_local_rendezvous_shards = 1);
 
   ~BaseRendezvousMgr() override;
 
@@ -80,6 +83,10 @@ class BaseRendezvousMgr : public RendezvousMgrInterface {
   void RecvLocalAsync(int64_t step_id, const Rendezvous::ParsedKey& parsed,
                       Rendezvous::DoneCallback done) override;
 
+  void RecvLocalAsync(int64_t step_id, const Rendezvous::ParsedKey& parsed,
+                      const Rendezvous::Args& recv_args,
+                      Rendezvous::DoneCallback done) override;
+
   // Synchronous wrapper for RecvLocalAsync.
   Status RecvLocal(int64_t step_id, const Rendezvous::ParsedKey& parsed,
                    Tensor* val, bool* is_dead) override;
@@ -97,6 +104,10 @@ class BaseRendezvousMgr : public RendezvousMgrInterface {
   virtual BaseRemoteRendezvous* Create(int64_t step_id,
                                        const WorkerEnv* worker_env) = 0;
 
+  int num_local_rendezvous_shards() const {
+    return num_local_rendezvous_shards_;
+  }
+
  private:
   // Maps step_id to rendezvous.
   typedef absl::flat_hash_map<int64_t, BaseRemoteRendezvous*> Table;
@@ -104,6 +115,8 @@ class BaseRendezvousMgr : public RendezvousMgrInterface {
   // Not owned.
   const WorkerEnv* const worker_env_;
 
+  const int num_local_rendezvous_shards_;
+
   mutex mu_;
   Table table_ TF_GUARDED_BY(mu_);
 
@@ -120,7 +133,8 @@ class BaseRendezvousMgr : public RendezvousMgrInterface {
 // functionality to coordinate with remote workers.
 class BaseRemoteRendezvous : public RemoteRendezvous {
  public:
-  BaseRemoteRendezvous(const WorkerEnv* env, int64_t step_id);
+  BaseRemoteRendezvous(const WorkerEnv* env, int64_t step_id,
+                       int num_local_shards = 1);
 
   // Upgrades the BaseRemoteRendezvous to full initialization.
   Status Initialize(WorkerSession* session) override;
@@ -158,6 +172,10 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   // REQUIRES: "parsed" is one that will be Saved into the local rendezvous.
   void RecvLocalAsync(const ParsedKey& parsed, DoneCallback done);
 
+  // As above, but the receive is made with "recv_args".
+  void RecvLocalAsync(const ParsedKey& parsed, const Rendezvous::Args& args,
+                      DoneCallback done);
+
  protected:
   virtual void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
                                    const Rendezvous::Args& args,
@@ -203,9 +221,11 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   // Data structures to handle calls when partially initialized.
   struct DeferredCall {
     const ParsedKey parsed;
+    const Rendezvous::Args args;
     DoneCallback done;
 
-    DeferredCall(const ParsedKey& parsed, DoneCallback done);
+    DeferredCall(const ParsedKey& parsed, const Rendezvous::Args& args,
+                 DoneCallback done);
   };
   std::vector<DeferredCall> deferred_calls_ TF_GUARDED_BY(mu_);
 
@@ -238,7 +258,8 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
                           Tensor* out, StatusCallback done);
 
   // Must be called only if fully initialized.
-  void RecvLocalAsyncInternal(const ParsedKey& parsed, DoneCallback done);
+  void RecvLocalAsyncInternal(const ParsedKey& parsed,
+                              const Rendezvous::Args& args, DoneCallback done);
 
   TF_DISALLOW_COPY_AND_ASSIGN(BaseRemoteRendezvous);
 };
@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/distributed_runtime/collective_param_resolver_distributed.h"
 
+#include <memory>
+#include <utility>
+
 #include "absl/strings/escaping.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -21,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/device_resolver_distributed.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -51,6 +55,30 @@ class CompleteGroupCall : public CancellableCall {
   CompleteGroupResponse resp_;
 };
 
+// The most instance resolutions that are sent in one CompleteInstanceBatch
+// RPC.
+constexpr int kMaxInstanceBatchSize = 256;
+
+void PopulateCompleteInstanceRequest(const CollGroupParams& group,
+                                     const CollInstanceParams& instance,
+                                     const string& node_name,
+                                     const string& device_name, bool is_source,
+                                     CompleteInstanceRequest* req) {
+  req->set_name(node_name);
+  req->set_type(instance.type);
+  req->set_data_type(instance.data_type);
+  instance.shape.AsProto(req->mutable_shape());
+  req->set_group_key(group.group_key);
+  req->set_group_size(group.group_size);
+  req->set_instance_key(instance.instance_key);
+  req->set_device_type(group.device_type.type_string());
+  for (int32_t offset : instance.impl_details.subdiv_offsets) {
+    req->add_subdiv_offset(offset);
+  }
+  req->set_device(device_name);
+  req->set_is_source(is_source);
+}
+
 class CompleteInstanceCall : public CancellableCall {
  public:
   CompleteInstanceCall(const CollGroupParams& group,
@@ -59,19 +87,8 @@ class CompleteInstanceCall : public CancellableCall {
                        bool is_source, CancellationManager* cancel_mgr,
                        const string& remote_worker, WorkerCacheInterface* wc)
       : CancellableCall(cancel_mgr, remote_worker, wc) {
-    req_.set_name(node_name);
-    req_.set_type(instance.type);
-    req_.set_data_type(instance.data_type);
-    instance.shape.AsProto(req_.mutable_shape());
-    req_.set_group_key(group.group_key);
-    req_.set_group_size(group.group_size);
-    req_.set_instance_key(instance.instance_key);
-    req_.set_device_type(group.device_type.type_string());
-    for (int32_t offset : instance.impl_details.subdiv_offsets) {
-      req_.add_subdiv_offset(offset);
-    }
-    req_.set_device(device_name);
-    req_.set_is_source(is_source);
+    PopulateCompleteInstanceRequest(group, instance, node_name, device_name,
+                                    is_source, &req_);
   }
 
   ~CompleteInstanceCall() override {}
@@ -84,6 +101,21 @@ class CompleteInstanceCall : public CancellableCall {
   CompleteInstanceResponse resp_;
 };
 
+class CompleteInstanceBatchCall : public CancellableCall {
+ public:
+  CompleteInstanceBatchCall(const string& remote_worker,
+                            WorkerCacheInterface* wc)
+      : CancellableCall(/*cancel_mgr=*/nullptr, remote_worker, wc) {}
+  ~CompleteInstanceBatchCall() override {}
+
+  void IssueCall(const StatusCallback& done) override {
+    wi_->CompleteInstanceBatchAsync(&opts_, &req_, &resp_, done);
+  }
+
+  CompleteInstanceBatchRequest req_;
+  CompleteInstanceBatchResponse resp_;
+};
+
 }  // namespace
 
 CollectiveParamResolverDistributed::CollectiveParamResolverDistributed(
@@ -96,7 +128,9 @@ CollectiveParamResolverDistributed::CollectiveParamResolverDistributed(
       worker_cache_(worker_cache),
       group_leader_(task_name == config.experimental().collective_group_leader()
                         ? ""
-                        : config.experimental().collective_group_leader()) {
+                        : config.experimental().collective_group_leader()),
+      instance_batch_window_micros_(
+          config.experimental().collective_instance_batch_window_micros()) {
   VLOG(1) << "CompleteParamResolverDistributed ctor task={" << task_name
           << "} config.collective_group_leader={"
           << config.experimental().collective_group_leader() << "}"
@@ -104,6 +138,14 @@ CollectiveParamResolverDistributed::CollectiveParamResolverDistributed(
           << config.experimental().collective_nccl() << "}";
 }
 
+CollectiveParamResolverDistributed::~CollectiveParamResolverDistributed() {
+  // Wait for the scheduled flushes of instance batches, which use `this`.
+  mutex_lock l(batch_mu_);
+  while (num_scheduled_flushes_ > 0) {
+    batch_cv_.wait(l);
+  }
+}
+
 void CollectiveParamResolverDistributed::CompleteParamsAsync(
     const DeviceAttributes& device, CollectiveParams* cp,
     CancellationManager* cancel_mgr, const StatusCallback& done) {
@@ -368,33 +410,148 @@ void CollectiveParamResolverDistributed::CompleteInstanceDistributed(
     return CompleteInstanceLocal(device, cp, done);
   } else if (InstanceIsCached(cp->group.group_key, cp->instance.instance_key)) {
     return CompleteInstanceLocal(device, cp, done);
+  } else if (instance_batch_window_micros_ > 0 &&
+             cp->instance.type != BROADCAST_COLLECTIVE &&
+             !batching_unsupported_.load(std::memory_order_relaxed)) {
+    // Broadcasts are not batched since the group leader only answers them once
+    // every member of the instance is known, which would hold up the batch.
+    return CompleteInstanceBatched(device, cp, cancel_mgr, done);
   } else {
-    CompleteInstanceCall* call = new CompleteInstanceCall(
-        cp->group, cp->instance, cp->name, device, cp->is_source, cancel_mgr,
-        group_leader_, worker_cache_);
-    CancellationToken abortion_token =
-        abortion_cancel_mgr_.get_cancellation_token();
-    bool already_aborted = !abortion_cancel_mgr_.RegisterCallback(
-        abortion_token, [call] { call->Cancel(); });
-    if (already_aborted) {
-      done(errors::Cancelled("collective ops already aborted"));
-      delete call;
+    return CompleteInstanceRemote(device, cp, cancel_mgr, done);
+  }
+}
+
+void CollectiveParamResolverDistributed::CompleteInstanceRemote(
+    const string& device, CollectiveParams* cp, CancellationManager* cancel_mgr,
+    const StatusCallback& done) {
+  CompleteInstanceCall* call = new CompleteInstanceCall(
+      cp->group, cp->instance, cp->name, device, cp->is_source, cancel_mgr,
+      group_leader_, worker_cache_);
+  CancellationToken abortion_token =
+      abortion_cancel_mgr_.get_cancellation_token();
+  bool already_aborted = !abortion_cancel_mgr_.RegisterCallback(
+      abortion_token, [call] { call->Cancel(); });
+  if (already_aborted) {
+    done(errors::Cancelled("collective ops already aborted"));
+    delete call;
+    return;
+  }
+  call->Start([this, device, cp, call, abortion_token, done](Status s) {
+    abortion_cancel_mgr_.DeregisterCallback(abortion_token);
+    if (s.ok()) {
+      s = UpdateInstanceCache(cp, call->resp_);
+    }
+    if (s.ok()) {
+      CompleteInstanceLocal(device, cp, done);
+    } else {
+      done(s);
+    }
+    delete call;
+  });
+}
+
+void CollectiveParamResolverDistributed::CompleteInstanceBatched(
+    const string& device, CollectiveParams* cp, CancellationManager* cancel_mgr,
+    const StatusCallback& done) {
+  std::vector<PendingInstance> full_batch;
+  int64_t new_batch_id = -1;
+  {
+    mutex_lock l(batch_mu_);
+    if (pending_instances_.empty()) {
+      new_batch_id = ++instance_batch_id_;
+      ++num_scheduled_flushes_;
+    }
+    pending_instances_.push_back({device, cp, cancel_mgr, done});
+    if (pending_instances_.size() >= size_t{kMaxInstanceBatchSize}) {
+      full_batch.swap(pending_instances_);
+    }
+  }
+  if (new_batch_id >= 0) {
+    Env::Default()->SchedClosureAfter(
+        instance_batch_window_micros_, [this, new_batch_id]() {
+          FlushInstanceBatch(new_batch_id);
+          mutex_lock l(batch_mu_);
+          --num_scheduled_flushes_;
+          batch_cv_.notify_all();
+        });
+  }
+  if (!full_batch.empty()) {
+    SendInstanceBatch(std::move(full_batch));
+  }
+}
+
+void CollectiveParamResolverDistributed::FlushInstanceBatch(int64_t batch_id) {
+  std::vector<PendingInstance> batch;
+  {
+    mutex_lock l(batch_mu_);
+    // The batch was already sent if it filled up.
+    if (batch_id != instance_batch_id_) {
       return;
     }
-    call->Start([this, device, cp, call, abortion_token, done](Status s) {
-      abortion_cancel_mgr_.DeregisterCallback(abortion_token);
-      if (s.ok()) {
-        s = UpdateInstanceCache(cp, call->resp_);
+    batch.swap(pending_instances_);
+  }
+  if (!batch.empty()) {
+    SendInstanceBatch(std::move(batch));
+  }
+}
+
+void CollectiveParamResolverDistributed::SendInstanceBatch(
+    std::vector<PendingInstance> batch) {
+  auto pending = std::make_shared<std::vector<PendingInstance>>(
+      std::move(batch));
+  CompleteInstanceBatchCall* call =
+      new CompleteInstanceBatchCall(group_leader_, worker_cache_);
+  for (const PendingInstance& p : *pending) {
+    PopulateCompleteInstanceRequest(p.cp->group, p.cp->instance, p.cp->name,
+                                    p.device, p.cp->is_source,
+                                    call->req_.add_request());
+  }
+  CancellationToken abortion_token =
+      abortion_cancel_mgr_.get_cancellation_token();
+  bool already_aborted = !abortion_cancel_mgr_.RegisterCallback(
+      abortion_token, [call] { call->Cancel(); });
+  if (already_aborted) {
+    delete call;
+    for (const PendingInstance& p : *pending) {
+      p.done(errors::Cancelled("collective ops already aborted"));
+    }
+    return;
+  }
+  VLOG(2) << "Resolving " << pending->size() << " collective instances with "
+          << group_leader_;
+  call->Start([this, call, abortion_token, pending](Status s) {
+    abortion_cancel_mgr_.DeregisterCallback(abortion_token);
+    const int num_instances = pending->size();
+    if (s.ok() && call->resp_.response_size() != num_instances) {
+      s = errors::Internal("CompleteInstanceBatch returned ",
+                           call->resp_.response_size(), " responses for ",
+                           num_instances, " requests");
+    }
+    if (!s.ok()) {
+      delete call;
+      // The batch fails as a whole. Resolve the instances one by one, which
+      // gives each of them its own status, and stop batching if the group
+      // leader does not support it.
+      if (errors::IsUnimplemented(s)) {
+        VLOG(1) << "Disabling batched instance resolution: " << s;
+        batching_unsupported_.store(true, std::memory_order_relaxed);
       }
-      if (s.ok()) {
-        CompleteInstanceLocal(device, cp, done);
+      for (const PendingInstance& p : *pending) {
+        CompleteInstanceRemote(p.device, p.cp, p.cancel_mgr, p.done);
+      }
+      return;
+    }
+    for (int i = 0; i < num_instances; ++i) {
+      const PendingInstance& p = (*pending)[i];
+      Status status = UpdateInstanceCache(p.cp, call->resp_.response(i));
+      if (status.ok()) {
+        CompleteInstanceLocal(p.device, p.cp, p.done);
       } else {
-        done(s);
+        p.done(status);
       }
-      delete call;
-    });
-    return;
-  }
+    }
+    delete call;
+  });
 }
 
 void CollectiveParamResolverDistributed::StartAbort(const Status& s) {
@@ -15,6 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_COLLECTIVE_PARAM_RESOLVER_DISTRIBUTED_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_COLLECTIVE_PARAM_RESOLVER_DISTRIBUTED_H_
 
+#include <atomic>
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/collective_param_resolver_local.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
@@ -33,6 +37,7 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
       DeviceResolverDistributed* dev_resolver,
       NcclCommunicatorInterface* nccl_communicator,
       WorkerCacheInterface* worker_cache, const string& task_name);
+  ~CollectiveParamResolverDistributed() override;
 
   void CompleteParamsAsync(const DeviceAttributes& device, CollectiveParams* cp,
                            CancellationManager* cancel_mgr,
@@ -87,9 +92,48 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
                                    const StatusCallback& done)
       TF_LOCKS_EXCLUDED(instance_mu_, group_mu_);
 
+  // Resolves *cp with the group leader in a CompleteInstance RPC of its own.
+  void CompleteInstanceRemote(const string& device, CollectiveParams* cp,
+                              CancellationManager* cancel_mgr,
+                              const StatusCallback& done)
+      TF_LOCKS_EXCLUDED(instance_mu_, group_mu_);
+
+  // An instance resolution waiting to be sent to the group leader in a
+  // CompleteInstanceBatch RPC.
+  struct PendingInstance {
+    string device;
+    CollectiveParams* cp;
+    CancellationManager* cancel_mgr;
+    StatusCallback done;
+  };
+
+  // Resolves *cp with the group leader in the batch of the instances that are
+  // resolved within instance_batch_window_micros_.
+  void CompleteInstanceBatched(const string& device, CollectiveParams* cp,
+                               CancellationManager* cancel_mgr,
+                               const StatusCallback& done)
+      TF_LOCKS_EXCLUDED(batch_mu_);
+
+  // Sends the pending instances if they still form batch `batch_id`.
+  void FlushInstanceBatch(int64_t batch_id) TF_LOCKS_EXCLUDED(batch_mu_);
+
+  // Resolves `batch` in one RPC, or one by one if the RPC fails.
+  void SendInstanceBatch(std::vector<PendingInstance> batch)
+      TF_LOCKS_EXCLUDED(batch_mu_);
+
   WorkerCacheInterface* worker_cache_;  // Not owned
   const string group_leader_;
   CancellationManager abortion_cancel_mgr_;
+
+  const int64_t instance_batch_window_micros_;
+  // Set once the group leader turns out not to support batches.
+  std::atomic<bool> batching_unsupported_{false};
+  mutex batch_mu_;
+  condition_variable batch_cv_;
+  std::vector<PendingInstance> pending_instances_ TF_GUARDED_BY(batch_mu_);
+  // Identifies the batch that pending_instances_ belong to.
+  int64_t instance_batch_id_ TF_GUARDED_BY(batch_mu_) = 0;
+  int num_scheduled_flushes_ TF_GUARDED_BY(batch_mu_) = 0;
 };
 
 }  // namespace tensorflow
@@ -127,6 +127,8 @@ class DeviceResDistTest : public ::testing::Test {
     config.mutable_experimental()->set_collective_group_leader(
         "/job:worker/replica:0/task:0");
     config.mutable_experimental()->set_collective_nccl(nccl);
+    config.mutable_experimental()->set_collective_instance_batch_window_micros(
+        instance_batch_window_micros_);
 
     std::vector<std::unique_ptr<Device>> devices;
     for (int i = 0; i < num_devices; ++i) {
@@ -299,6 +301,7 @@ class DeviceResDistTest : public ::testing::Test {
   }
 
   FakeCache wc_;
+  int64_t instance_batch_window_micros_ = 0;
   FakeNcclCommunicator nccl_communicator_;
   CancellationManager cm_;
   // Below are keyed by task names.
@@ -381,5 +384,27 @@ TEST_F(DeviceResDistTest, Workers4Devices3) {
   ValidateCollectiveParams(num_workers, num_devices);
 }
 
+TEST_F(DeviceResDistTest, Workers4Devices3BatchedInstances) {
+  const int num_workers = 4;
+  const int num_devices = 3;
+  instance_batch_window_micros_ = 1000;
+  DefineWorkers(num_workers, num_devices, "CPU", /*nccl*/ false);
+  DefineCollectiveParams(num_workers, num_devices, "CPU");
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+}
+
+TEST_F(DeviceResDistTest, BroadcastWithBatchedInstances) {
+  const int num_workers = 2;
+  const int num_devices = 2;
+  const int source_rank = 3;
+  instance_batch_window_micros_ = 1000;
+  DefineWorkers(num_workers, num_devices, "CPU", /*nccl*/ false);
+  DefineCollectiveParams(num_workers, num_devices, "CPU", BROADCAST_COLLECTIVE,
+                         source_rank);
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -104,17 +104,27 @@ Status GetEagerOperationAndNumRetvals(const Operation& operation,
                                       EagerExecutor* eager_executor,
                                       EagerOperation* eager_op,
                                       int* num_retvals) {
-  const char* name = operation.name().c_str();  // Shorthand
+  // An op whose definition the worker already has only carries the id of the
+  // definition, along with its own id and inputs.
+  const RemoteMgr::OperationDefinition* cached_definition = nullptr;
+  if (operation.definition_id() != 0 && operation.name().empty()) {
+    TF_RETURN_IF_ERROR(eager_context->RemoteMgr()->GetOperationDefinition(
+        operation.definition_id(), &cached_definition));
+  }
+  const Operation& definition = cached_definition != nullptr
+                                    ? cached_definition->operation
+                                    : operation;
+  const char* name = definition.name().c_str();  // Shorthand
   absl::optional<tensorflow::EagerFunctionParams> remote_func_params =
       absl::nullopt;
-  if (operation.is_function()) {
+  if (definition.is_function()) {
     if (operation.is_component_function()) {
       remote_func_params = {operation.id(), operation.func_step_id()};
     } else {
       remote_func_params = {operation.id(), absl::nullopt};
     }
   }
-  TF_RETURN_IF_ERROR(eager_op->Reset(name, operation.device().c_str(), false,
+  TF_RETURN_IF_ERROR(eager_op->Reset(name, definition.device().c_str(), false,
                                      eager_executor, remote_func_params));
 
   {
@@ -143,13 +153,23 @@ Status GetEagerOperationAndNumRetvals(const Operation& operation,
     }
   }
 
-  for (const auto& attr : operation.attrs()) {
+  for (const auto& attr : definition.attrs()) {
     eager_op->MutableAttrs()->Set(attr.first, attr.second);
   }
 
-  // TODO(nareshmodi): Consider caching this.
-  return GetNumRetvals(eager_context, operation.name(), operation.attrs(),
-                       num_retvals);
+  if (cached_definition != nullptr) {
+    *num_retvals += cached_definition->num_retvals;
+    return Status::OK();
+  }
+  int op_num_retvals = 0;
+  TF_RETURN_IF_ERROR(GetNumRetvals(eager_context, operation.name(),
+                                   operation.attrs(), &op_num_retvals));
+  if (operation.definition_id() != 0) {
+    eager_context->RemoteMgr()->AddOperationDefinition(operation,
+                                                       op_num_retvals);
+  }
+  *num_retvals += op_num_retvals;
+  return Status::OK();
 }
 
 Status TensorHandleProto(TensorHandle* handle, TensorProto* proto) {
@@ -462,6 +462,103 @@ TEST_F(EagerServiceImplTest, BasicTest) {
                                                &close_context_response));
 }
 
+// Test that ops can refer to the definition of an earlier op by id.
+TEST_F(EagerServiceImplTest, OperationDefinitionIdTest) {
+  TestEagerServiceImpl eager_service_impl(&worker_env_);
+
+  uint64 context_id = random::New64();
+
+  CreateContextRequest request;
+  request.mutable_server_def()->set_job_name("localhost");
+  request.mutable_server_def()->set_task_index(0);
+  request.set_context_id(context_id);
+  CreateContextResponse response;
+
+  TF_ASSERT_OK(eager_service_impl.CreateContext(&request, &response));
+
+  EnqueueRequest remote_enqueue_request;
+  remote_enqueue_request.set_context_id(context_id);
+  EnqueueResponse remote_enqueue_response;
+
+  std::unordered_map<string, AttrValue> const_attrs;
+  AttrValue val;
+  val.set_type(tensorflow::DataType::DT_FLOAT);
+  const_attrs.insert({"dtype", val});
+  val.Clear();
+  SetTensorProto(val.mutable_tensor());
+  const_attrs.insert({"value", val});
+
+  AddOperationToEnqueueRequest(1, "Const", {}, const_attrs,
+                               "/job:localhost/replica:0/task:0/device:CPU:0",
+                               &remote_enqueue_request);
+
+  std::unordered_map<string, AttrValue> attrs;
+  val.Clear();
+  val.set_type(tensorflow::DataType::DT_FLOAT);
+  attrs.insert({"T", val});
+  val.Clear();
+  val.set_b(false);
+  attrs.insert({"transpose_a", val});
+  attrs.insert({"transpose_b", val});
+
+  const int64_t kMatMulDefinitionId = 7;
+  AddOperationToEnqueueRequest(
+      2, "MatMul", {std::make_pair(1, 0), std::make_pair(1, 0)}, attrs,
+      "/job:localhost/replica:0/task:0/device:CPU:0", &remote_enqueue_request);
+  remote_enqueue_request.mutable_queue(1)
+      ->mutable_operation()
+      ->set_definition_id(kMatMulDefinitionId);
+
+  // The third op only carries the id of the MatMul definition.
+  Operation* compact_op =
+      remote_enqueue_request.add_queue()->mutable_operation();
+  compact_op->set_id(3);
+  compact_op->set_definition_id(kMatMulDefinitionId);
+  for (int i = 0; i < 2; ++i) {
+    auto* input = compact_op->add_op_inputs()->mutable_remote_handle();
+    input->set_op_id(2);
+    input->set_output_num(0);
+    input->set_op_device("/job:localhost/replica:0/task:0/device:CPU:0");
+    input->set_device("/job:localhost/replica:0/task:0/device:CPU:0");
+  }
+
+  TF_ASSERT_OK(eager_service_impl.Enqueue(nullptr, &remote_enqueue_request,
+                                          &remote_enqueue_response));
+  ASSERT_EQ(remote_enqueue_response.queue_response(2).shape_size(), 1);
+
+  tensorflow::TensorHandle* tensor_handle;
+  TF_ASSERT_OK(eager_service_impl.GetTensorHandle(
+      context_id, RemoteTensorHandleInternal(3, 0), &tensor_handle));
+  const tensorflow::Tensor* t = nullptr;
+  TF_ASSERT_OK(tensor_handle->Tensor(&t));
+  auto actual = t->flat<float>();
+  ASSERT_EQ(4, actual.size());
+  // [[7, 10], [15, 22]] squared.
+  EXPECT_EQ(199, actual(0));
+  EXPECT_EQ(290, actual(1));
+  EXPECT_EQ(435, actual(2));
+  EXPECT_EQ(634, actual(3));
+
+  // An unknown definition id is an error.
+  EnqueueRequest unknown_definition_request;
+  unknown_definition_request.set_context_id(context_id);
+  Operation* unknown_op =
+      unknown_definition_request.add_queue()->mutable_operation();
+  unknown_op->set_id(4);
+  unknown_op->set_definition_id(kMatMulDefinitionId + 1);
+  EnqueueResponse unknown_definition_response;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      eager_service_impl.Enqueue(nullptr, &unknown_definition_request,
+                                 &unknown_definition_response)));
+
+  CloseContextRequest close_context_request;
+  close_context_request.set_context_id(context_id);
+  close_context_request.set_context_view_id(0);
+  CloseContextResponse close_context_response;
+  TF_ASSERT_OK(eager_service_impl.CloseContext(&close_context_request,
+                                               &close_context_response));
+}
+
 class EagerServiceImplFunctionTest : public EagerServiceImplTest {
  public:
   EagerServiceImplFunctionTest() : EagerServiceImplTest() {}
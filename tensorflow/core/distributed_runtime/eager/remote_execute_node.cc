@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "tensorflow/core/distributed_runtime/eager/remote_mgr.h"
 
 namespace tensorflow {
 namespace eager {
@@ -37,7 +38,10 @@ void RemoteExecuteNode::RunAsync(StatusCallback done) {
     ops.reserve(request_->queue_size());
     for (const QueueItem& item : request_->queue()) {
       if (item.has_operation()) {
-        ops.push_back(item.operation().name());
+        ops.push_back(item.operation().name().empty()
+                          ? absl::StrCat("Definition(",
+                                         item.operation().definition_id(), ")")
+                          : item.operation().name());
       } else {
         ops.push_back(absl::StrCat("DeleteHandle(",
                                    item.handle_to_decref().op_id(), ":",
@@ -75,14 +79,27 @@ void RemoteExecuteNode::RunAsync(StatusCallback done) {
     handle->Ref();
   }
 
+  // Once the op has completed, the worker has the definition it carries and
+  // later ops can refer to it by id.
+  uint64 definition_id = 0;
+  if (request_->queue_size() == 1 && request_->queue(0).has_operation() &&
+      !request_->queue(0).operation().name().empty()) {
+    definition_id = request_->queue(0).operation().definition_id();
+  }
+  RemoteMgr* remote_mgr = eager_context_->RemoteMgr();
+
   eager_client_->StreamingEnqueueAsync(
       call_opts.get(), request_.get(), response.get(),
       [inputs, retvals, call_opts, response, device,
        context_view_id = context_view_id_, rpc_description, cm, token,
-       done](const Status& status) {
+       definition_id, remote_mgr, done](const Status& status) {
         if (cm != nullptr) {
           cm->TryDeregisterCallback(token);
         }
+        if (status.ok() && definition_id != 0) {
+          remote_mgr->MarkOperationDefinitionRegistered(definition_id,
+                                                        context_view_id);
+        }
         for (auto handle : inputs) {
           handle->Unref();
         }
@@ -201,6 +201,56 @@ Status RemoteMgr::DeserializeRemoteTensorHandle(const RemoteTensorHandle& in,
   return Status::OK();
 }
 
+uint64 RemoteMgr::GetOperationDefinitionId(const Fprint128& cache_key,
+                                           uint64 context_view_id,
+                                           bool* registered) {
+  DCHECK(is_master_);
+  mutex_lock l(operation_definitions_mu_);
+  auto it = definition_ids_.find(cache_key);
+  if (it == definition_ids_.end()) {
+    it = definition_ids_.emplace(cache_key, next_definition_id_++).first;
+  }
+  auto registered_it = registered_definitions_.find(it->second);
+  *registered = registered_it != registered_definitions_.end() &&
+                registered_it->second == context_view_id;
+  return it->second;
+}
+
+void RemoteMgr::MarkOperationDefinitionRegistered(uint64 definition_id,
+                                                  uint64 context_view_id) {
+  mutex_lock l(operation_definitions_mu_);
+  registered_definitions_[definition_id] = context_view_id;
+}
+
+void RemoteMgr::AddOperationDefinition(const Operation& operation,
+                                       int num_retvals) {
+  mutex_lock l(operation_definitions_mu_);
+  if (operation_definitions_.find(operation.definition_id()) !=
+      operation_definitions_.end()) {
+    return;
+  }
+  OperationDefinition& definition =
+      operation_definitions_[operation.definition_id()];
+  definition.operation.set_name(operation.name());
+  *definition.operation.mutable_attrs() = operation.attrs();
+  definition.operation.set_device(operation.device());
+  definition.operation.set_is_function(operation.is_function());
+  definition.num_retvals = num_retvals;
+}
+
+Status RemoteMgr::GetOperationDefinition(
+    uint64 definition_id, const OperationDefinition** definition) {
+  tf_shared_lock l(operation_definitions_mu_);
+  auto it = operation_definitions_.find(definition_id);
+  if (it == operation_definitions_.end()) {
+    return errors::InvalidArgument(
+        "Unable to find the definition of operation with definition id ",
+        definition_id, ". It must be sent before an op refers to it.");
+  }
+  *definition = &it->second;
+  return Status::OK();
+}
+
 EagerExecutor& RemoteMgr::GetOrCreateExecutorForStream(uint64 stream_id) {
   mutex_lock l(executor_map_mu_);
   auto it = executor_map_.find(stream_id);
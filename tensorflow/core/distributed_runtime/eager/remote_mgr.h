@@ -22,7 +22,9 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
 #include "tensorflow/core/distributed_runtime/eager/remote_tensor_handle.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
 
 namespace tensorflow {
 namespace eager {
@@ -75,6 +77,35 @@ class RemoteMgr {
   Status DeserializeRemoteTensorHandle(const RemoteTensorHandle& in,
                                        TensorHandle** out);
 
+  // On the client, returns the id of the op definition, i.e. name, attrs and
+  // device, fingerprinted by `cache_key`, and assigns one if it is new.
+  // `registered` is set to whether a worker has acknowledged the definition in
+  // `context_view_id`, in which case ops may only send its id.
+  uint64 GetOperationDefinitionId(const Fprint128& cache_key,
+                                  uint64 context_view_id, bool* registered);
+
+  // On the client, records that an op carrying the definition with
+  // `definition_id` completed on its worker in `context_view_id`.
+  void MarkOperationDefinitionRegistered(uint64 definition_id,
+                                         uint64 context_view_id);
+
+  // An op definition cached by a worker, along with the number of outputs of
+  // the op.
+  struct OperationDefinition {
+    Operation operation;
+    int num_retvals = 0;
+  };
+
+  // On the worker, caches the name, attrs, device and is_function of
+  // `operation` under its definition_id, unless there already is a definition
+  // with that id.
+  void AddOperationDefinition(const Operation& operation, int num_retvals);
+
+  // On the worker, finds the definition cached under `definition_id`. The
+  // definition lives as long as this RemoteMgr.
+  Status GetOperationDefinition(uint64 definition_id,
+                                const OperationDefinition** definition);
+
   EagerExecutor& GetOrCreateExecutorForStream(uint64 stream_id);
 
   void DeleteExecutorForStream(uint64 stream_id);
@@ -125,6 +156,19 @@ class RemoteMgr {
 
   EagerContext* parent_;  // not owned.
 
+  mutex operation_definitions_mu_;
+  // On the client, the ids of the op definitions sent to workers, and the
+  // context view in which each registered definition was acknowledged.
+  uint64 next_definition_id_ TF_GUARDED_BY(operation_definitions_mu_) = 1;
+  std::unordered_map<Fprint128, uint64, Fprint128Hasher> definition_ids_
+      TF_GUARDED_BY(operation_definitions_mu_);
+  std::unordered_map<uint64, uint64> registered_definitions_
+      TF_GUARDED_BY(operation_definitions_mu_);
+  // On the worker, the op definitions by id. Entries are never replaced, so
+  // pointers to them stay valid.
+  std::unordered_map<uint64, OperationDefinition> operation_definitions_
+      TF_GUARDED_BY(operation_definitions_mu_);
+
   mutex executor_map_mu_;
   std::unordered_map<uint64, EagerExecutor> executor_map_
       TF_GUARDED_BY(executor_map_mu_);
@@ -151,6 +151,52 @@ TEST_F(RemoteMgrTest, SetRemoteShapeWithClusterUpdate) {
   handle->Unref();
 }
 
+TEST_F(RemoteMgrTest, OperationDefinitionIdRegisteredPerContextView) {
+  RemoteMgr remote_mgr(true, ctx_);
+  const Fprint128 matmul_key = Fingerprint128("MatMul");
+  const Fprint128 add_key = Fingerprint128("Add");
+
+  bool registered = true;
+  const uint64 matmul_id =
+      remote_mgr.GetOperationDefinitionId(matmul_key, 0, &registered);
+  EXPECT_FALSE(registered);
+  const uint64 add_id =
+      remote_mgr.GetOperationDefinitionId(add_key, 0, &registered);
+  EXPECT_FALSE(registered);
+  EXPECT_NE(matmul_id, add_id);
+
+  remote_mgr.MarkOperationDefinitionRegistered(matmul_id, 0);
+  EXPECT_EQ(matmul_id,
+            remote_mgr.GetOperationDefinitionId(matmul_key, 0, &registered));
+  EXPECT_TRUE(registered);
+  // A registration does not carry over to a new view of the cluster.
+  EXPECT_EQ(matmul_id,
+            remote_mgr.GetOperationDefinitionId(matmul_key, 1, &registered));
+  EXPECT_FALSE(registered);
+}
+
+TEST_F(RemoteMgrTest, CacheOperationDefinition) {
+  RemoteMgr remote_mgr(false, ctx_);
+  Operation operation;
+  operation.set_id(5);
+  operation.set_definition_id(2);
+  operation.set_name("MatMul");
+  operation.set_device(remote_device_->name());
+  (*operation.mutable_attrs())["transpose_a"].set_b(true);
+  remote_mgr.AddOperationDefinition(operation, /*num_retvals=*/1);
+
+  const RemoteMgr::OperationDefinition* definition = nullptr;
+  TF_ASSERT_OK(remote_mgr.GetOperationDefinition(2, &definition));
+  EXPECT_EQ(definition->operation.name(), "MatMul");
+  EXPECT_EQ(definition->operation.device(), remote_device_->name());
+  EXPECT_TRUE(definition->operation.attrs().at("transpose_a").b());
+  EXPECT_EQ(definition->operation.id(), 0);
+  EXPECT_EQ(definition->num_retvals, 1);
+
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      remote_mgr.GetOperationDefinition(3, &definition)));
+}
+
 }  // namespace
 }  // namespace eager
 }  // namespace tensorflow
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/worker_env.h"
 #include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -90,6 +91,19 @@ class RendezvousMgrInterface {
                               const Rendezvous::ParsedKey& parsed,
                               Rendezvous::DoneCallback done) = 0;
 
+  // As above, but the receive is made with "recv_args". In particular, the
+  // receive may be cancelled through "recv_args.cancellation_manager", in
+  // which case the tensor is not consumed.
+  //
+  // This method is used by the rpc handler of RecvTensorBatch.
+  virtual void RecvLocalAsync(int64_t step_id,
+                              const Rendezvous::ParsedKey& parsed,
+                              const Rendezvous::Args& recv_args,
+                              Rendezvous::DoneCallback done) {
+    done(errors::Unimplemented("RecvLocalAsync with Args is not supported."),
+         Rendezvous::Args(), recv_args, Tensor(), false);
+  }
+
   // Synchronous wrapper for RecvLocalAsync.
   virtual Status RecvLocal(int64_t step_id, const Rendezvous::ParsedKey& parsed,
                            Tensor* val, bool* is_dead) = 0;
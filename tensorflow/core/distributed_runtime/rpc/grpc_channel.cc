@@ -18,6 +18,7 @@ limitations under the License.
 #include <cstdlib>
 #include <limits>
 #include <map>
+#include <memory>
 #include <unordered_map>
 
 #include "grpcpp/create_channel.h"
@@ -132,6 +133,12 @@ const ::grpc::ChannelArguments* GetDefaultChannelArguments() {
     if (rpc_options->disable_session_connection_sharing()) {
       VLOG(5) << "Disabling TCP connection sharing";
       args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, true);
+    } else if (rpc_options->num_channels_per_target() > 1) {
+      // Channels with the same arguments to the same target share a single
+      // TCP connection through the global subchannel pool, which would defeat
+      // the purpose of opening several channels per target.
+      VLOG(5) << "Opening a TCP connection per channel";
+      args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, true);
     }
   }
   return args;
@@ -151,11 +158,16 @@ Status NewHostPortGrpcChannel(const string& target,
 
 ChannelCreationFunction ConvertToChannelCreationFunction(
     const std::function<Status(string, const RPCOptions*,
-                               SharedGrpcChannelPtr*)>& new_channel_func_ptr) {
-  return [new_channel_func_ptr](const string& target) -> SharedGrpcChannelPtr {
+                               SharedGrpcChannelPtr*)>& new_channel_func_ptr,
+    const RPCOptions* rpc_options) {
+  std::shared_ptr<const RPCOptions> options;
+  if (rpc_options != nullptr) {
+    options = std::make_shared<const RPCOptions>(*rpc_options);
+  }
+  return [new_channel_func_ptr,
+          options](const string& target) -> SharedGrpcChannelPtr {
     SharedGrpcChannelPtr channel_ptr;
-    if (new_channel_func_ptr(target, /*rpc_options=*/nullptr, &channel_ptr)
-            .ok()) {
+    if (new_channel_func_ptr(target, options.get(), &channel_ptr).ok()) {
       return channel_ptr;
     } else {
       return nullptr;
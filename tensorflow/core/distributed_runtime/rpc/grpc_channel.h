@@ -89,9 +89,12 @@ GrpcChannelCache* NewGrpcChannelCache(
 
 ::grpc::ChannelArguments GetChannelArguments(const RPCOptions* rpc_options);
 
+// If `rpc_options` is not nullptr, a copy of it is passed to
+// `new_channel_func_ptr` for every channel.
 ChannelCreationFunction ConvertToChannelCreationFunction(
     const std::function<Status(string, const RPCOptions*,
-                               SharedGrpcChannelPtr*)>& new_channel_func_ptr);
+                               SharedGrpcChannelPtr*)>& new_channel_func_ptr,
+    const RPCOptions* rpc_options = nullptr);
 
 Status NewHostPortGrpcChannel(const string& target,
                               const RPCOptions* rpc_options,
@@ -352,6 +352,26 @@ TEST(GrpcChannelTest, SparseHostPorts) {
   }
 }
 
+TEST(GrpcChannelTest, ChannelCreationFunctionPassesRPCOptions) {
+  RPCOptions rpc_options;
+  rpc_options.set_num_channels_per_target(4);
+  std::vector<int> num_channels_per_target;
+  ChannelCreationFunction channel_func = ConvertToChannelCreationFunction(
+      [&num_channels_per_target](string target, const RPCOptions* options,
+                                 SharedGrpcChannelPtr* channel) {
+        num_channels_per_target.push_back(
+            options == nullptr ? -1 : options->num_channels_per_target());
+        return NewHostPortGrpcChannel(target, options, channel);
+      },
+      &rpc_options);
+  rpc_options.set_num_channels_per_target(1);
+  EXPECT_NE(channel_func("localhost:2222"), nullptr);
+  EXPECT_NE(ConvertToChannelCreationFunction(NewHostPortGrpcChannel)(
+                "localhost:2222"),
+            nullptr);
+  EXPECT_EQ(num_channels_per_target, std::vector<int>({4}));
+}
+
 TEST(GrpcChannelTest, NewHostPortGrpcChannelValidation) {
   SharedGrpcChannelPtr mock_ptr;
 
@@ -66,6 +66,8 @@ class GrpcRemoteWorker : public WorkerInterface {
         instancesource_(Method(GrpcWorkerMethod::kCompleteInstance)),
         getstepsequence_(Method(GrpcWorkerMethod::kGetStepSequence)),
         markrecvfinished_(Method(GrpcWorkerMethod::kMarkRecvFinished)),
+        recvtensorbatch_(Method(GrpcWorkerMethod::kRecvTensorBatch)),
+        instancebatch_(Method(GrpcWorkerMethod::kCompleteInstanceBatch)),
         logger_(logger),
         target_(target) {}
 
@@ -189,6 +191,14 @@ class GrpcRemoteWorker : public WorkerInterface {
                  call_opts);
   }
 
+  void CompleteInstanceBatchAsync(CallOptions* call_opts,
+                                  const CompleteInstanceBatchRequest* request,
+                                  CompleteInstanceBatchResponse* response,
+                                  StatusCallback done) override {
+    IssueRequest(request, response, instancebatch_, std::move(done),
+                 call_opts);
+  }
+
   void GetStepSequenceAsync(const GetStepSequenceRequest* request,
                             GetStepSequenceResponse* response,
                             StatusCallback done) override {
@@ -256,6 +266,16 @@ class GrpcRemoteWorker : public WorkerInterface {
     IssueRequest(request, response, recvtensor_, callback, call_opts);
   }
 
+  void RecvTensorBatchAsync(CallOptions* call_opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override {
+    VLOG(1) << "RecvTensorBatchAsync req: step_id=" << request->step_id()
+            << " num_keys=" << request->rendezvous_key_size();
+    IssueRequest(request, response, recvtensorbatch_, std::move(done),
+                 call_opts);
+  }
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override {
     IssueRequest(request, response, logging_, done);
@@ -329,6 +349,8 @@ class GrpcRemoteWorker : public WorkerInterface {
   const ::grpc::string instancesource_;
   const ::grpc::string getstepsequence_;
   const ::grpc::string markrecvfinished_;
+  const ::grpc::string recvtensorbatch_;
+  const ::grpc::string instancebatch_;
 
   // Support for logging.
   WorkerCacheLogger* logger_;
@@ -19,9 +19,11 @@ limitations under the License.
 #include <limits>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/match.h"
 #include "grpcpp/grpcpp.h"
 #include "grpcpp/security/credentials.h"
 #include "grpcpp/server_builder.h"
@@ -89,13 +91,51 @@ class ReusePortOption : public ::grpc::ServerBuilderOption {
                          plugins) override {}
 };
 
+mutex* GetTensorTransportsLock() {
+  static mutex* lock = new mutex();
+  return lock;
+}
+
+std::unordered_map<string, GrpcTensorTransport>* GetTensorTransports() {
+  static auto* transports =
+      new std::unordered_map<string, GrpcTensorTransport>();
+  return transports;
+}
+
+// Returns true and fills *transport if `protocol` names a registered
+// "grpc+<name>" tensor transport.
+bool LookupTensorTransport(const string& protocol,
+                           GrpcTensorTransport* transport) {
+  constexpr char kPrefix[] = "grpc+";
+  if (!absl::StartsWith(protocol, kPrefix)) return false;
+  mutex_lock l(*GetTensorTransportsLock());
+  auto it = GetTensorTransports()->find(protocol.substr(strlen(kPrefix)));
+  if (it == GetTensorTransports()->end()) return false;
+  *transport = it->second;
+  return true;
+}
+
 // static utility function
-RendezvousMgrInterface* NewRpcRendezvousMgr(const WorkerEnv* env) {
-  return new RpcRendezvousMgr(env);
+RendezvousMgrCreationFunction NewRpcRendezvousMgrFunc(
+    const ConfigProto& config) {
+  const int64_t recv_batch_window_micros =
+      config.rpc_options().recv_tensor_batch_window_micros();
+  return [recv_batch_window_micros](const WorkerEnv* env) {
+    return new RpcRendezvousMgr(env, /*num_local_rendezvous_shards=*/1,
+                                recv_batch_window_micros);
+  };
 }
 
 }  // namespace
 
+void RegisterGrpcTensorTransport(const string& name,
+                                 GrpcTensorTransport transport) {
+  mutex_lock l(*GetTensorTransportsLock());
+  if (!GetTensorTransports()->emplace(name, std::move(transport)).second) {
+    LOG(ERROR) << "Tensor transport " << name << " registered twice";
+  }
+}
+
 GrpcServer::GrpcServer(const ServerDef& server_def, Env* env)
     : env_(env), state_(NEW), server_def_(server_def) {}
 
@@ -190,6 +230,8 @@ Status GrpcServer::Init(const GrpcServerOptions& opts) {
   VLOG(3) << "Grpc Server Init Definition: " << server_def_.DebugString();
   ConfigProto config = server_def_.default_session_config();
   sess_opts.config = config;
+  worker_channel_options_.set_num_channels_per_target(
+      config.rpc_options().num_channels_per_target());
 
   // Configure shared devices between master and worker.
   string name_prefix =
@@ -207,9 +249,10 @@ Status GrpcServer::Init(const GrpcServerOptions& opts) {
   }
   worker_env_.local_devices = worker_env_.device_mgr->ListDevices();
   master_env_.local_devices = worker_env_.device_mgr->ListDevices();
-  worker_env_.rendezvous_mgr = opts.rendezvous_mgr_func == nullptr
-                                   ? new RpcRendezvousMgr(&worker_env_)
-                                   : opts.rendezvous_mgr_func(&worker_env_);
+  worker_env_.rendezvous_mgr =
+      opts.rendezvous_mgr_func == nullptr
+          ? NewRpcRendezvousMgrFunc(config)(&worker_env_)
+          : opts.rendezvous_mgr_func(&worker_env_);
   string unused;
   string default_worker_name;
   if (!DeviceNameUtils::SplitDeviceName(master_env_.local_devices[0]->name(),
@@ -559,7 +602,8 @@ std::shared_ptr<::grpc::ServerCredentials> GrpcServer::GetServerCredentials(
 ChannelCreationFunction GrpcServer::GetChannelCreationFunction() const {
   // We can do this because SparseGrpcChannelCache is robust to nullptr being
   // returned by the channel creation function
-  return ConvertToChannelCreationFunction(NewHostPortGrpcChannel);
+  return ConvertToChannelCreationFunction(NewHostPortGrpcChannel,
+                                          &worker_channel_options_);
 }
 
 std::unique_ptr<Master> GrpcServer::CreateMaster(MasterEnv* master_env) {
@@ -573,7 +617,14 @@ Status GrpcServer::Create(const ServerDef& server_def, Env* env,
   std::unique_ptr<GrpcServer> ret(
       new GrpcServer(server_def, env == nullptr ? Env::Default() : env));
   GrpcServerOptions options;
-  options.rendezvous_mgr_func = NewRpcRendezvousMgr;
+  GrpcTensorTransport transport;
+  if (LookupTensorTransport(server_def.protocol(), &transport)) {
+    options.rendezvous_mgr_func = transport.rendezvous_mgr_func;
+    options.service_func = transport.service_func;
+  } else {
+    options.rendezvous_mgr_func =
+        NewRpcRendezvousMgrFunc(server_def.default_session_config());
+  }
   options.local_device_mgr = local_device_mgr;
   Status s = ret->Init(options);
   if (!s.ok()) {
@@ -607,7 +658,9 @@ namespace {
 class GrpcServerFactory : public ServerFactory {
  public:
   bool AcceptsOptions(const ServerDef& server_def) override {
-    return server_def.protocol() == "grpc";
+    GrpcTensorTransport unused;
+    return server_def.protocol() == "grpc" ||
+           LookupTensorTransport(server_def.protocol(), &unused);
   }
 
   Status NewServer(const ServerDef& server_def, const Options& options,
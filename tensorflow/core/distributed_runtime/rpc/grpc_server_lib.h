@@ -62,6 +62,23 @@ typedef std::function<std::unique_ptr<GrpcWorker>(WorkerEnv*,
                                                   const ConfigProto& config)>
     WorkerCreationFunction;
 
+// A tensor transport that moves RecvTensor payloads over another fabric, such
+// as RDMA verbs, while the server keeps gRPC for all control messages.  A
+// registered transport is used by servers whose ServerDef protocol is
+// "grpc+<name>".
+struct GrpcTensorTransport {
+  // Creates the rendezvous manager that performs remote tensor transfers.
+  RendezvousMgrCreationFunction rendezvous_mgr_func = nullptr;
+  // Optionally registers extra services, e.g. to exchange memory region keys
+  // between workers before the first transfer.
+  ServiceInitFunction service_func = nullptr;
+};
+
+// Registers `transport` under `name`.  Must be called before any server that
+// uses it is created, typically from a static registrar object.
+void RegisterGrpcTensorTransport(const string& name,
+                                 GrpcTensorTransport transport);
+
 struct GrpcServerOptions {
   ServiceInitFunction service_func = nullptr;
   RendezvousMgrCreationFunction rendezvous_mgr_func = nullptr;
@@ -179,6 +196,10 @@ class GrpcServer : public ServerInterface {
   // The host name of this server
   string host_name_;
 
+  // The options of the channels to other tasks, which only carry the number of
+  // channels per target of the ServerDef the server was initialized with.
+  RPCOptions worker_channel_options_;
+
   // Guards server configuration, server, and state.
   mutex mu_;
 
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/random/random.h"
 
 namespace tensorflow {
@@ -31,8 +33,53 @@ double GenerateUniformRandomNumberBetween(double a, double b) {
   return a + GenerateUniformRandomNumber() * (b - a);
 }
 
+// Tensor storage aliasing part of a received grpc slice.
+class GrpcSliceBuffer : public TensorBuffer {
+ public:
+  GrpcSliceBuffer(const ::grpc::Slice& slice, size_t offset, size_t num_bytes)
+      : TensorBuffer(const_cast<uint8_t*>(slice.begin()) + offset),
+        slice_(slice),
+        size_(num_bytes) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("grpc_slice");
+  }
+  // The slice may alias memory owned by gRPC or by the sender, so it must
+  // never be forwarded to an op output and written in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const ::grpc::Slice slice_;
+  const size_t size_;
+};
+
 }  // namespace
 
+TensorBuffer* GrpcByteSource::ShareRange(int64_t offset, size_t num_bytes) {
+  if (slices_.empty() && !buffer_->Dump(&slices_).ok()) {
+    slices_.clear();
+    return nullptr;
+  }
+  for (const ::grpc::Slice& slice : slices_) {
+    if (offset >= static_cast<int64_t>(slice.size())) {
+      offset -= slice.size();
+      continue;
+    }
+    if (offset + num_bytes > slice.size() || 2 * num_bytes < slice.size()) {
+      return nullptr;
+    }
+    const uint8_t* data = slice.begin() + offset;
+    if (reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+      return nullptr;
+    }
+    return new GrpcSliceBuffer(slice, offset, num_bytes);
+  }
+  return nullptr;
+}
+
 int64_t ComputeBackoffMicroseconds(int current_retry_attempt, int64_t min_delay,
                                    int64_t max_delay) {
   DCHECK_GE(current_retry_attempt, 0);
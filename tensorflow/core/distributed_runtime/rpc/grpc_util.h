@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "grpcpp/grpcpp.h"
 #include "grpcpp/impl/codegen/proto_utils.h"
@@ -57,6 +58,11 @@ class GrpcByteSource : public TensorResponse::Source {
     return stream_;
   }
 
+  // Shares the range when it lies within a single aligned slice that it
+  // covers at least half of, so that a small tensor cannot pin a much larger
+  // receive buffer.  The returned buffer holds a ref on that slice.
+  TensorBuffer* ShareRange(int64_t offset, size_t num_bytes) override;
+
  private:
   void DeleteStream() {
     if (stream_) {
@@ -67,6 +73,8 @@ class GrpcByteSource : public TensorResponse::Source {
   ::grpc::ByteBuffer* buffer_;  // Not owned
   Reader* stream_ = nullptr;    // Points into space_ if non-nullptr
   char space_[sizeof(Reader)];
+  // Refs on the slices of buffer_, filled by the first ShareRange call.
+  std::vector<::grpc::Slice> slices_;
 };
 
 constexpr char kStreamRemovedMessage[] = "Stream removed";
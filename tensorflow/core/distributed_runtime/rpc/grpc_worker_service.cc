@@ -148,6 +148,8 @@ class GrpcWorkerServiceThread {
     SETUP_FOR_REQUEST(RunGraph, 100, true);
     SETUP_FOR_REQUEST(CleanupGraph, 100, false);
     SETUP_FOR_REQUEST(MarkRecvFinished, 10, false);
+    SETUP_FOR_REQUEST(RecvTensorBatch, 100, true);
+    SETUP_FOR_REQUEST(CompleteInstanceBatch, 10, true);
 
     // TODO(ncteisen): Determine a better policy for enqueuing the
     // appropriate number of each request type.
@@ -301,6 +303,25 @@ class GrpcWorkerServiceThread {
     ENQUEUE_REQUEST(RecvBuf, true);
   }
 
+  void RecvTensorBatchHandler(
+      WorkerCall<RecvTensorBatchRequest, RecvTensorBatchResponse>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+      worker_->RecvTensorBatchAsync(
+          call_opts, &call->request, &call->response,
+          [call, call_opts](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            if (!s.ok()) {
+              VLOG(3) << "Bad response from RecvTensorBatch:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    ENQUEUE_REQUEST(RecvTensorBatch, true);
+  }
+
   void CompleteGroupHandler(
       WorkerCall<CompleteGroupRequest, CompleteGroupResponse>* call) {
     Schedule([this, call]() {
@@ -338,6 +359,26 @@ class GrpcWorkerServiceThread {
     });
     ENQUEUE_REQUEST(CompleteInstance, false);
   }
+
+  void CompleteInstanceBatchHandler(
+      WorkerCall<CompleteInstanceBatchRequest, CompleteInstanceBatchResponse>*
+          call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+      worker_->CompleteInstanceBatchAsync(
+          call_opts, &call->request, &call->response,
+          [call, call_opts](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            if (!s.ok()) {
+              VLOG(3) << "Bad response from CompleteInstanceBatch:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    ENQUEUE_REQUEST(CompleteInstanceBatch, false);
+  }
 #undef ENQUEUE_REQUEST
 
   void EnqueueRecvTensorRequestRaw() {
@@ -561,6 +602,55 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
 }
 
 namespace {
+// The state shared by the receives of one RecvTensorBatch call.
+class RecvTensorBatchState : public core::RefCounted {
+ public:
+  RecvTensorBatchState(int num_pending, int64_t linger_micros,
+                       StatusCallback done)
+      : num_pending_(num_pending),
+        linger_micros_(linger_micros),
+        done_(std::move(done)) {}
+
+  CancellationManager* cancellation_manager() { return &cm_; }
+
+  // Called when a receive has finished with status "s". Returns the delay
+  // after which the remaining receives should be cancelled, or -1. Sets
+  // "*last" if this was the last pending receive, and "*status" to the status
+  // of the batch.
+  int64_t ItemDone(const Status& s, bool* last, Status* status) {
+    mutex_lock l(mu_);
+    int64_t cancel_after_micros = -1;
+    if (s.ok()) {
+      if (!cancelling_ && linger_micros_ > 0 && num_pending_ > 1) {
+        cancelling_ = true;
+        cancel_after_micros = linger_micros_;
+      }
+    } else if (!(cancelling_ && errors::IsCancelled(s))) {
+      // The batch has failed, so there is no point in waiting for the others.
+      status_.Update(s);
+      if (!cancelling_ && num_pending_ > 1) {
+        cancelling_ = true;
+        cancel_after_micros = 0;
+      }
+    }
+    *last = --num_pending_ == 0;
+    *status = status_;
+    return cancel_after_micros;
+  }
+
+  void Done(const Status& s) { done_(s); }
+
+ private:
+  CancellationManager cm_;
+  mutex mu_;
+  int num_pending_ TF_GUARDED_BY(mu_);
+  // True once the remaining receives are due to be cancelled.
+  bool cancelling_ TF_GUARDED_BY(mu_) = false;
+  Status status_ TF_GUARDED_BY(mu_);
+  const int64_t linger_micros_;
+  StatusCallback done_;
+};
+
 // If RecvBufRespExtra.tensor_content is a single large string, then gRPC
 // can stall on the recv side when the string buffer needs to be enlarged,
 // since the size is not sent in advance.  Changing this field to a sequence
@@ -588,6 +678,113 @@ void SetTensorInRecvBufResp(int64_t max_chunk_bytes, const Tensor* tensor,
 }
 }  // namespace
 
+void GrpcWorker::RecvTensorBatchAsync(CallOptions* opts,
+                                      const RecvTensorBatchRequest* request,
+                                      RecvTensorBatchResponse* response,
+                                      StatusCallback done) {
+  const int64_t step_id = request->step_id();
+  Status s = recent_request_ids_.TrackUnique(
+      request->request_id(), "RecvTensorBatch (GrpcWorker)", *request);
+  const int num_keys = request->rendezvous_key_size();
+  std::vector<Rendezvous::ParsedKey> parsed(num_keys);
+  std::vector<Device*> src_devs(num_keys, nullptr);
+  for (int i = 0; s.ok() && i < num_keys; ++i) {
+    s = Rendezvous::ParseKey(request->rendezvous_key(i), &parsed[i]);
+    if (s.ok()) {
+      s = PrepareRecvTensor(parsed[i], &src_devs[i]);
+    }
+  }
+  if (!s.ok() || num_keys == 0) {
+    done(s);
+    return;
+  }
+  TRACEPRINTF("RecvTensorBatch: %lld %d", step_id, num_keys);
+  for (int i = 0; i < num_keys; ++i) {
+    response->add_item();
+  }
+
+  // Each receive is made with the batch's cancellation manager. Once the first
+  // tensor is available, the remaining receives are given the linger period
+  // to complete, and are then cancelled without consuming their tensors.
+  RecvTensorBatchState* state = new RecvTensorBatchState(
+      num_keys, request->linger_micros(), [opts, done](const Status& s) {
+        opts->ClearCancelCallback();
+        done(s);
+      });
+  // As in GrpcRecvTensorAsync, an RPC cancellation aborts the step.
+  opts->SetCancelCallback([this, step_id]() {
+    LOG(WARNING) << "RecvTensorBatch cancelled for " << step_id;
+    AbortStep(step_id);
+  });
+  Rendezvous::Args recv_args;
+  recv_args.cancellation_manager = state->cancellation_manager();
+  for (int i = 0; i < num_keys; ++i) {
+    RecvTensorBatchResponse::Item* item = response->mutable_item(i);
+    auto item_done = [this, state, item](const Tensor& tensor, bool is_dead,
+                                         const Status& status) {
+      if (status.ok()) {
+        RecvTensorResponse* tensor_response = item->mutable_response();
+        if (!is_dead) {
+          tensor.AsProtoTensorContent(tensor_response->mutable_tensor());
+        }
+        tensor_response->set_is_dead(is_dead);
+        tensor_response->set_send_start_micros(Env::Default()->NowMicros());
+        item->set_ready(true);
+      }
+      bool last;
+      Status batch_status;
+      const int64_t cancel_after_micros =
+          state->ItemDone(status, &last, &batch_status);
+      if (cancel_after_micros == 0) {
+        // The cancelled receives may finish the batch, so keep "state" alive.
+        state->Ref();
+        state->cancellation_manager()->StartCancel();
+        state->Unref();
+      } else if (cancel_after_micros > 0) {
+        state->Ref();
+        env_->env->SchedClosureAfter(cancel_after_micros, [state]() {
+          state->cancellation_manager()->StartCancel();
+          state->Unref();
+        });
+      }
+      if (last) {
+        state->Done(batch_status);
+        state->Unref();
+      }
+    };
+    Device* src_dev = src_devs[i];
+    const string& key = request->rendezvous_key(i);
+    env_->rendezvous_mgr->RecvLocalAsync(
+        step_id, parsed[i], recv_args,
+        [item_done, src_dev, &key](const Status& status,
+                                   const Rendezvous::Args& send_args,
+                                   const Rendezvous::Args& recv_args,
+                                   const Tensor& val, const bool is_dead) {
+          if (status.ok() && src_dev->tensorflow_accelerator_device_info() &&
+              !send_args.alloc_attrs.on_host()) {
+            // "val" is on an accelerator device, so copy it to the host
+            // before encoding it.
+            AllocatorAttributes alloc_attrs;
+            alloc_attrs.set_gpu_compatible(true);
+            alloc_attrs.set_on_host(true);
+            Allocator* alloc = src_dev->GetAllocator(alloc_attrs);
+            Tensor* copy = new Tensor(alloc, val.dtype(), val.shape());
+            CHECK(send_args.device_context)
+                << "send dev name: " << src_dev->name();
+            StatusCallback copy_ready = [item_done, copy,
+                                         is_dead](const Status& s) {
+              item_done(*copy, is_dead, s);
+              delete copy;
+            };
+            CopyDeviceToHost(&val, alloc, alloc, key, src_dev, copy,
+                             send_args.device_context, copy_ready);
+            return;
+          }
+          item_done(val, is_dead, status);
+        });
+  }
+}
+
 void GrpcWorker::RecvBufAsync(CallOptions* opts, const RecvBufRequest* request,
                               RecvBufResponse* response, StatusCallback done) {
   const int64_t request_id = request->request_id();
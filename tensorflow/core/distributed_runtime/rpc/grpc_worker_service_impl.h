@@ -86,10 +86,12 @@ enum class GrpcWorkerMethod {
   kCompleteInstance,
   kGetStepSequence,
   kMarkRecvFinished,
+  kRecvTensorBatch,
+  kCompleteInstanceBatch,
 };
 
 static const int kGrpcNumWorkerMethods =
-    static_cast<int>(GrpcWorkerMethod::kMarkRecvFinished) + 1;
+    static_cast<int>(GrpcWorkerMethod::kCompleteInstanceBatch) + 1;
 
 const char* GrpcWorkerMethodName(GrpcWorkerMethod id);
 
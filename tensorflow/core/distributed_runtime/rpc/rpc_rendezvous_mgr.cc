@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <atomic>
+#include <map>
+#include <utility>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -36,10 +41,14 @@ namespace tensorflow {
 
 namespace {
 
+class RpcRecvTensorBatchCall;
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
-  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id,
+                      int num_local_shards, int64_t recv_batch_window_micros)
+      : BaseRemoteRendezvous(env, step_id, num_local_shards),
+        recv_batch_window_micros_(recv_batch_window_micros) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -47,8 +56,38 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
                            DoneCallback done) override;
 
  private:
+  // Receives that can share a RecvTensorBatch RPC are keyed by their source
+  // worker and their cancellation manager.
+  typedef std::pair<string, CancellationManager*> BatchKey;
+
+  // The maximum number of receives in one RecvTensorBatch RPC.
+  static constexpr int kMaxBatchSize = 256;
+
   ~RpcRemoteRendezvous() override {}
 
+  // Adds the receive to the open batch for its source worker.
+  void BatchRecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
+                                const Rendezvous::Args& recv_args,
+                                DoneCallback done);
+
+  // Starts the open batch for "key" if its id is "batch_id".
+  void FlushBatch(const BatchKey& key, int64_t batch_id);
+
+  void StartBatch(RpcRecvTensorBatchCall* call);
+
+  // Runs the callbacks of the receives in "call", and deletes it.
+  void BatchDone(RpcRecvTensorBatchCall* call, const Status& s);
+
+  const int64_t recv_batch_window_micros_;
+
+  // Set if the source worker of a batch does not support RecvTensorBatch.
+  std::atomic<bool> batching_unsupported_{false};
+
+  mutex batch_mu_;
+  int64_t next_batch_id_ TF_GUARDED_BY(batch_mu_) = 0;
+  std::map<BatchKey, RpcRecvTensorBatchCall*> open_batches_
+      TF_GUARDED_BY(batch_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRemoteRendezvous);
 };
 
@@ -228,10 +267,120 @@ static RpcRecvTensorFreeList* get_call_freelist() {
   return call_freelist;
 }
 
+// Used to retrieve several tensors from the same remote process in one RPC.
+// All receives in a batch share the same cancellation manager.
+class RpcRecvTensorBatchCall : public BaseRecvTensorCall {
+ public:
+  // A receive waiting for the response.
+  struct Recv {
+    Rendezvous::ParsedKey parsed;
+    Device* dst_device;
+    Rendezvous::Args recv_args;
+    Rendezvous::DoneCallback done;
+  };
+
+  RpcRecvTensorBatchCall(int64_t batch_id, const string& src_worker,
+                         int64_t step_id, int64_t linger_micros,
+                         const Rendezvous::Args& recv_args)
+      : batch_id_(batch_id),
+        src_worker_(src_worker),
+        wi_(nullptr),
+        recv_args_(recv_args) {
+    req_.set_step_id(step_id);
+    req_.set_linger_micros(linger_micros);
+    req_.set_request_id(GetUniqueRequestId());
+  }
+
+  ~RpcRecvTensorBatchCall() override {
+    CHECK_EQ(static_cast<WorkerInterface*>(nullptr), wi_)
+        << "Leaking WorkerInterface in RpcRecvTensorBatchCall destructor.";
+  }
+
+  void Add(const Rendezvous::ParsedKey& parsed, Device* dst_device,
+           const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done) {
+    req_.add_rendezvous_key(parsed.FullKey().data(), parsed.FullKey().size());
+    recvs_.push_back({parsed, dst_device, recv_args, std::move(done)});
+  }
+
+  void set_worker(WorkerInterface* wi) { wi_ = wi; }
+
+  void Start(std::function<void()> recv_done) override {
+    auto abort_checked = std::make_shared<Notification>();
+    auto cb = [this, abort_checked,
+               recv_done = std::move(recv_done)](const Status& s) {
+      abort_checked->WaitForNotification();
+      if (!s.ok()) {
+        mutex_lock l(mu_);
+        status_.Update(s);
+      }
+      recv_done();
+    };
+    wi_->RecvTensorBatchAsync(&opts_, &req_, &resp_, std::move(cb));
+
+    // NOTE: As in `RpcRecvTensorCall::StartRTCall()`, check for an abort that
+    // happened before the RPC registered its cancellation callback.
+    Status s;
+    {
+      mutex_lock l(mu_);
+      s = status_;
+    }
+    if (!s.ok()) {
+      opts_.StartCancel();
+    }
+    abort_checked->Notify();
+  }
+
+  void StartAbort(const Status& s) override {
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    opts_.StartCancel();
+  }
+
+  Status status() const override {
+    mutex_lock l(mu_);
+    return status_;
+  }
+
+  void ReleaseWorker(WorkerCacheInterface* worker_cache) {
+    DCHECK_NE(static_cast<WorkerInterface*>(nullptr), wi_)
+        << "RpcRecvTensorBatchCall::ReleaseWorker() called twice.";
+    worker_cache->ReleaseWorker(src_worker_, wi_);
+    wi_ = nullptr;
+  }
+
+  int64_t batch_id() const { return batch_id_; }
+  const string& src_worker() const { return src_worker_; }
+  const Rendezvous::Args& recv_args() const { return recv_args_; }
+  std::vector<Recv>* recvs() { return &recvs_; }
+  const RecvTensorBatchResponse& response() const { return resp_; }
+
+ private:
+  const int64_t batch_id_;
+  const string src_worker_;
+  WorkerInterface* wi_;  // Not owned.
+  const Rendezvous::Args recv_args_;
+  std::vector<Recv> recvs_;
+  CallOptions opts_;
+  RecvTensorBatchRequest req_;
+  RecvTensorBatchResponse resp_;
+
+  mutable mutex mu_;
+  Status status_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RpcRecvTensorBatchCall);
+};
+
 void RpcRemoteRendezvous::RecvFromRemoteAsync(
     const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
     DoneCallback done) {
   CHECK(is_initialized());
+  if (recv_batch_window_micros_ > 0 &&
+      !batching_unsupported_.load(std::memory_order_relaxed)) {
+    BatchRecvFromRemoteAsync(parsed, recv_args, std::move(done));
+    return;
+  }
   Status s;
 
   // Prepare a RecvTensor call that can handle being aborted.
@@ -303,14 +452,164 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
   });
 }
 
+void RpcRemoteRendezvous::BatchRecvFromRemoteAsync(
+    const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    DoneCallback done) {
+  string src_worker;
+  string src_rel_device;
+  Status s;
+  if (!DeviceNameUtils::SplitDeviceName(parsed.src_device, &src_worker,
+                                        &src_rel_device)) {
+    s = errors::Internal(parsed.src_device,
+                         " is invalid remote source device.");
+  }
+  Device* dst_device;
+  if (s.ok()) {
+    s = session()->device_mgr()->LookupDevice(parsed.dst_device, &dst_device);
+  }
+  if (!s.ok()) {
+    done(s, Args(), recv_args, Tensor{}, false);
+    return;
+  }
+
+  const BatchKey key(src_worker, recv_args.cancellation_manager);
+  RpcRecvTensorBatchCall* full_batch = nullptr;
+  int64_t new_batch_id = -1;
+  {
+    mutex_lock l(batch_mu_);
+    RpcRecvTensorBatchCall*& batch = open_batches_[key];
+    if (batch == nullptr) {
+      new_batch_id = next_batch_id_++;
+      batch = new RpcRecvTensorBatchCall(new_batch_id, src_worker, step_id_,
+                                         recv_batch_window_micros_, recv_args);
+    }
+    batch->Add(parsed, dst_device, recv_args, std::move(done));
+    if (batch->recvs()->size() >= kMaxBatchSize) {
+      full_batch = batch;
+      open_batches_.erase(key);
+    }
+  }
+  if (new_batch_id >= 0 && full_batch == nullptr) {
+    Ref();
+    env_->env->SchedClosureAfter(recv_batch_window_micros_,
+                                 [this, key, new_batch_id]() {
+                                   FlushBatch(key, new_batch_id);
+                                   Unref();
+                                 });
+  }
+  if (full_batch != nullptr) StartBatch(full_batch);
+}
+
+void RpcRemoteRendezvous::FlushBatch(const BatchKey& key, int64_t batch_id) {
+  RpcRecvTensorBatchCall* batch = nullptr;
+  {
+    mutex_lock l(batch_mu_);
+    auto it = open_batches_.find(key);
+    // The batch may have been started because it was full.
+    if (it == open_batches_.end() || it->second->batch_id() != batch_id) {
+      return;
+    }
+    batch = it->second;
+    open_batches_.erase(it);
+  }
+  StartBatch(batch);
+}
+
+void RpcRemoteRendezvous::StartBatch(RpcRecvTensorBatchCall* call) {
+  WorkerSession* sess = session();
+  std::shared_ptr<WorkerCacheInterface> worker_cache =
+      sess->GetSharedWorkerCache();
+  WorkerInterface* rwi = worker_cache->GetOrCreateWorker(call->src_worker());
+  if (rwi == nullptr) {
+    BatchDone(call, errors::Internal("No worker known as ", call->src_worker()));
+    return;
+  }
+  call->set_worker(rwi);
+
+  // Record "call" in calls_ so that it can be aborted cleanly.
+  RegisterCall(call, call->recv_args());
+
+  // RendezvousMgr already aborted, shouldn't send RPC call any more
+  if (!call->status().ok()) {
+    DeregisterCall(call, call->recv_args());
+    call->ReleaseWorker(sess->worker_cache());
+    BatchDone(call, call->status());
+    return;
+  }
+
+  Ref();
+  call->Start([this, call, worker_cache]() {
+    // Removes "call" from calls_. Prevent StartAbort().
+    DeregisterCall(call, call->recv_args());
+    Status s = call->status();
+    call->ReleaseWorker(session()->worker_cache());
+    BatchDone(call, s);
+    Unref();
+  });
+}
+
+void RpcRemoteRendezvous::BatchDone(RpcRecvTensorBatchCall* call,
+                                    const Status& s) {
+  std::unique_ptr<RpcRecvTensorBatchCall> owned_call(call);
+  std::vector<RpcRecvTensorBatchCall::Recv>& recvs = *call->recvs();
+  if (errors::IsUnimplemented(s)) {
+    // The source worker does not support RecvTensorBatch, so receive the
+    // tensors one at a time from now on.
+    VLOG(1) << "Disabling batched receives: " << s;
+    batching_unsupported_.store(true, std::memory_order_relaxed);
+    for (auto& recv : recvs) {
+      RecvFromRemoteAsync(recv.parsed, recv.recv_args, std::move(recv.done));
+    }
+    return;
+  }
+  const RecvTensorBatchResponse& response = call->response();
+  if (s.ok() && response.item_size() != static_cast<int>(recvs.size())) {
+    Status error = errors::Internal(
+        "RecvTensorBatch returned ", response.item_size(), " items for ",
+        recvs.size(), " keys from ", call->src_worker());
+    for (auto& recv : recvs) {
+      recv.done(error, Args(), recv.recv_args, Tensor(), false);
+    }
+    return;
+  }
+  for (int i = 0; i < static_cast<int>(recvs.size()); ++i) {
+    auto& recv = recvs[i];
+    if (!s.ok()) {
+      recv.done(s, Args(), recv.recv_args, Tensor(), false);
+      continue;
+    }
+    const RecvTensorBatchResponse::Item& item = response.item(i);
+    if (!item.ready()) {
+      // The tensor was not consumed, so request it again.
+      BatchRecvFromRemoteAsync(recv.parsed, recv.recv_args,
+                               std::move(recv.done));
+      continue;
+    }
+    const RecvTensorResponse& tensor_response = item.response();
+    Tensor val;
+    Status decode_status;
+    if (!tensor_response.is_dead()) {
+      decode_status = recv.dst_device->MakeTensorFromProto(
+          tensor_response.tensor(), recv.recv_args.alloc_attrs, &val);
+    }
+    recv.done(decode_status, Args(), recv.recv_args, val,
+              tensor_response.is_dead());
+  }
+}
+
 }  // namespace
 
-RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
-    : BaseRendezvousMgr(env) {}
+RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env,
+                                   int num_local_rendezvous_shards,
+                                   int64_t recv_batch_window_micros)
+    : BaseRendezvousMgr(env, num_local_rendezvous_shards),
+      recv_batch_window_micros_(recv_batch_window_micros) {}
 
 BaseRemoteRendezvous* RpcRendezvousMgr::Create(int64_t step_id,
                                                const WorkerEnv* worker_env) {
-  return new RpcRemoteRendezvous(worker_env, step_id);
+  return new RpcRemoteRendezvous(worker_env, step_id,
+                                 num_local_rendezvous_shards(),
+                                 recv_batch_window_micros_);
 }
 
 }  // end namespace tensorflow
@@ -42,14 +42,22 @@ class DeviceMgr;
 //
 // Tensors sent and recved through rendezvous managed by this
 // RendezvousMgr must have keys generated by Rendezvous::CreateKey.
+//
+// If "recv_batch_window_micros" is positive, the remote receives issued for
+// the same source worker within that window are fetched in a single
+// RecvTensorBatch RPC.
 class RpcRendezvousMgr : public BaseRendezvousMgr {
  public:
-  explicit RpcRendezvousMgr(const WorkerEnv* env);
+  explicit RpcRendezvousMgr(const WorkerEnv* env,
+                            int num_local_rendezvous_shards = 1,
+                            int64_t recv_batch_window_micros = 0);
 
  protected:
   BaseRemoteRendezvous* Create(int64_t step_id, const WorkerEnv* worker_env);
 
  private:
+  const int64_t recv_batch_window_micros_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRendezvousMgr);
 };
 
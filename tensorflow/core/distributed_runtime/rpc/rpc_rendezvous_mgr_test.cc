@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <atomic>
+
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/test_utils.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -22,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
@@ -99,12 +102,72 @@ class DummyWorkerCache : public WorkerCacheInterface {
   DummyWorker* dummy_remote_worker_ = nullptr;
 };
 
+// A worker that serves RecvTensorBatch requests with the rendezvous key as
+// the value of each tensor. The last tensor of each batch with more than one
+// tensor is not ready, so that it has to be requested again.
+class BatchingWorker : public TestWorkerInterface {
+ public:
+  void RecvTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
+                       TensorResponse* response, StatusCallback done) override {
+    num_recv_tensor_calls_++;
+    done(Status::OK());
+  }
+
+  void RecvTensorBatchAsync(CallOptions* opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override {
+    if (!supports_batching_) {
+      done(errors::Unimplemented("RecvTensorBatch"));
+      return;
+    }
+    num_batch_calls_++;
+    const int num_keys = request->rendezvous_key_size();
+    SchedClosure([request, response, num_keys, done = std::move(done)]() {
+      for (int i = 0; i < num_keys; ++i) {
+        RecvTensorBatchResponse::Item* item = response->add_item();
+        if (num_keys > 1 && i == num_keys - 1) continue;
+        item->set_ready(true);
+        V(request->rendezvous_key(i))
+            .AsProtoField(item->mutable_response()->mutable_tensor());
+      }
+      done(Status::OK());
+    });
+  }
+
+  bool supports_batching_ = true;
+  std::atomic<int> num_batch_calls_{0};
+  std::atomic<int> num_recv_tensor_calls_{0};
+};
+
+// A worker cache that always returns the same worker.
+class SingleWorkerCache : public DummyWorkerCache {
+ public:
+  explicit SingleWorkerCache(BatchingWorker* worker) : worker_(worker) {}
+
+  WorkerInterface* GetOrCreateWorker(const string& target) override {
+    return worker_;
+  }
+  void ReleaseWorker(const string& target, WorkerInterface* worker) override {}
+
+ private:
+  BatchingWorker* const worker_;  // Not owned.
+};
+
 static Device* CreateDevice(const char* type, const char* name) {
   class FakeDevice : public Device {
    public:
     explicit FakeDevice(const DeviceAttributes& attr) : Device(nullptr, attr) {}
     Status Sync() override { return Status::OK(); }
     Allocator* GetAllocator(AllocatorAttributes) override { return nullptr; }
+    Status MakeTensorFromProto(const TensorProto& tensor_proto,
+                               const AllocatorAttributes alloc_attrs,
+                               Tensor* tensor) override {
+      if (!tensor->FromProto(tensor_proto)) {
+        return errors::InvalidArgument("Cannot parse tensor from proto");
+      }
+      return Status::OK();
+    }
   };
   DeviceAttributes attr;
   attr.set_name(name);
@@ -348,4 +411,74 @@ TEST_F(RpcRendezvousMgrTest, RemoteRecvAsyncMany) {
   rmgr_.Cleanup(step_id);
 }
 
+class RpcRendezvousMgrBatchTest : public ::testing::Test {
+ protected:
+  RpcRendezvousMgrBatchTest()
+      : worker_session_("rpc_session", "/job:mnist/replica:1/task:2",
+                        std::unique_ptr<WorkerCacheInterface>(
+                            new SingleWorkerCache(&worker_)),
+                        std::unique_ptr<DeviceMgr>(CreateDeviceMgr()),
+                        std::unique_ptr<GraphMgr>(), nullptr),
+        rmgr_(&env_, /*num_local_rendezvous_shards=*/1,
+              /*recv_batch_window_micros=*/100000) {
+    env_.env = Env::Default();
+  }
+
+  // Receives "num_requests" distinct tensors from a remote worker, and
+  // returns the status of the receives.
+  Status RecvMany(int num_requests) {
+    const int64_t step_id = 123;
+    RemoteRendezvous* rendez = rmgr_.Find(step_id);
+    TF_RETURN_IF_ERROR(rendez->Initialize(&worker_session_));
+    mutex mu;
+    Status status;
+    BlockingCounter counter(num_requests);
+    for (int i = 0; i < num_requests; i++) {
+      const string key = Rendezvous::CreateKey(
+          "/job:worker/replica:1/task:2/cpu:0", 7890,
+          "/job:mnist/replica:1/task:2/cpu:1", strings::StrCat("foo", i),
+          FrameAndIter(0, 0));
+      rendez->RecvAsync(
+          MakeKey(key), Rendezvous::Args(),
+          [this, key, &mu, &status, &counter](
+              const Status& s, const Rendezvous::Args&,
+              const Rendezvous::Args&, const Tensor& val, const bool) {
+            {
+              mutex_lock l(mu);
+              status.Update(s);
+              if (s.ok() && worker_.supports_batching_) {
+                EXPECT_EQ(key, V(val));
+              }
+            }
+            counter.DecrementCount();
+          });
+    }
+    counter.Wait();
+    rendez->Unref();
+    rmgr_.Cleanup(step_id);
+    return status;
+  }
+
+  BatchingWorker worker_;
+  WorkerEnv env_;
+  WorkerSession worker_session_;
+  RpcRendezvousMgr rmgr_;
+};
+
+TEST_F(RpcRendezvousMgrBatchTest, RemoteRecvBatched) {
+  const int num_requests = 100;
+  TF_ASSERT_OK(RecvMany(num_requests));
+  EXPECT_GE(worker_.num_batch_calls_, 2);
+  EXPECT_LT(worker_.num_batch_calls_, num_requests);
+  EXPECT_EQ(0, worker_.num_recv_tensor_calls_);
+}
+
+TEST_F(RpcRendezvousMgrBatchTest, FallsBackIfBatchingIsUnsupported) {
+  worker_.supports_batching_ = false;
+  const int num_requests = 10;
+  TF_ASSERT_OK(RecvMany(num_requests));
+  EXPECT_EQ(0, worker_.num_batch_calls_);
+  EXPECT_EQ(num_requests, worker_.num_recv_tensor_calls_);
+}
+
 }  // namespace tensorflow
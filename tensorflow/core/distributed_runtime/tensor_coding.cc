@@ -114,6 +114,10 @@ enum WireType {
   WIRETYPE_VARINT = 0,
   WIRETYPE_LENGTH_DELIMITED = 2,
 };
+
+// Tensor contents at least this large are shared with the Source when it
+// allows it, instead of being copied into a fresh allocation.
+constexpr int kShareTensorContentBytes = 64 << 10;
 inline int GetTagFieldNumber(uint32 tag) { return tag >> 3; }
 inline WireType GetTagWireType(uint32 tag) {
   return static_cast<WireType>(tag & 0x7);
@@ -144,7 +148,8 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
 }  // namespace
 
 bool TensorResponse::ParseTensorSubmessage(
-    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta) {
+    Source* source, protobuf::io::CodedInputStream* input,
+    TensorProto* tensor_meta) {
   bool seen_tensor_content = false;
   while (true) {
     auto p = input->ReadTagWithCutoff(127);
@@ -195,12 +200,24 @@ bool TensorResponse::ParseTensorSubmessage(
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
         TensorShape shape(tensor_meta->tensor_shape());
+        // Adopt large payloads in place when the source can share them.
+        // Memory that must be registered with a device (e.g. pinned for
+        // DMA) still needs to come from allocator_.
+        if (num_bytes >= kShareTensorContentBytes &&
+            !alloc_attrs_.gpu_compatible() &&
+            static_cast<size_t>(num_bytes) ==
+                shape.num_elements() * DataTypeSize(tensor_meta->dtype())) {
+          core::RefCountPtr<TensorBuffer> shared(
+              source->ShareRange(input->CurrentPosition(), num_bytes));
+          if (shared) {
+            if (!input->Skip(num_bytes)) return false;
+            tensor_ = Tensor(tensor_meta->dtype(), shape, std::move(shared));
+            break;
+          }
+        }
         Tensor t(allocator_, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
-        // TODO(jeff,sanjay): Figure out a way to avoid this copy if
-        // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
         if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
           return false;
         tensor_ = std::move(t);
@@ -233,7 +250,7 @@ bool TensorResponse::ParseFast(Source* source) {
         std::pair<protobuf::io::CodedInputStream::Limit, int> p =
             input.IncrementRecursionDepthAndPushLimit(length);
         if (p.second < 0 ||
-            !ParseTensorSubmessage(&input, meta_.mutable_tensor())) {
+            !ParseTensorSubmessage(source, &input, meta_.mutable_tensor())) {
           return false;
         }
         if (!input.DecrementRecursionDepthAndPopLimit(p.first)) {
@@ -27,6 +27,7 @@ namespace tensorflow {
 
 class Allocator;
 class DeviceBase;
+class TensorBuffer;
 class TensorProto;
 
 // TensorResponse can be used as the destination of an RPC that returns
@@ -64,6 +65,17 @@ class TensorResponse {
     // Ownership of the returned stream is retained by the Source and
     // should not be deleted by the caller.
     virtual ::tensorflow::protobuf::io::ZeroCopyInputStream* contents() = 0;
+
+    // Returns a buffer that aliases, without copying, the `num_bytes` of
+    // data starting `offset` bytes into the serialized RecvTensorResponse,
+    // or nullptr if this range cannot be shared.  A shared buffer must be
+    // aligned to EIGEN_MAX_ALIGN_BYTES and keep the received data alive for
+    // as long as it is referenced.  The caller owns the returned reference.
+    //
+    // The default implementation never shares, so ParseFrom copies.
+    virtual TensorBuffer* ShareRange(int64_t offset, size_t num_bytes) {
+      return nullptr;
+    }
   };
 
   // Parse the RecvTensorResponse encoded in the data yielded by
@@ -92,7 +104,8 @@ class TensorResponse {
   DeviceBase* device() const { return device_; }
 
  private:
-  bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
+  bool ParseTensorSubmessage(Source* source,
+                             protobuf::io::CodedInputStream* input,
                              TensorProto* tensor_meta);
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
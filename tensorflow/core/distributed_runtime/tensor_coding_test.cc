@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -156,6 +158,51 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+// Shares ranges by handing back a copy of them and counts the requests.
+class SharingStringSource : public StringSource {
+ public:
+  explicit SharingStringSource(const string* s)
+      : StringSource(s, 1024), s_(s) {}
+
+  TensorBuffer* ShareRange(int64_t offset, size_t num_bytes) override {
+    ++num_shared_;
+    Tensor copy(DT_UINT8, TensorShape({static_cast<int64_t>(num_bytes)}));
+    memcpy(copy.flat<uint8>().data(), s_->data() + offset, num_bytes);
+    TensorBuffer* buf = DMAHelper::buffer(&copy);
+    buf->Ref();
+    return buf;
+  }
+
+  int num_shared() const { return num_shared_; }
+
+ private:
+  const string* s_;
+  int num_shared_ = 0;
+};
+
+TEST_F(TensorResponseTest, SharesLargeTensorContent) {
+  DummyDevice cpu_device(Env::Default());
+  for (int num_elems : {1000, 100000}) {
+    std::vector<int8> v(num_elems);
+    for (int i = 0; i < num_elems; i++) {
+      v[i] = i % 10;
+    }
+    Tensor src(DT_INT8, TensorShape({1, num_elems}));
+    test::FillValues<int8>(&src, v);
+    RecvTensorResponse proto;
+    src.AsProtoTensorContent(proto.mutable_tensor());
+    string encoded;
+    proto.AppendToString(&encoded);
+
+    SharingStringSource source(&encoded);
+    TensorResponse response;
+    response.InitAlloc(&cpu_device, AllocatorAttributes());
+    TF_ASSERT_OK(response.ParseFrom(&source));
+    EXPECT_EQ(source.num_shared(), num_elems >= 65536 ? 1 : 0);
+    test::ExpectTensorEqual<int8>(response.tensor(), src);
+  }
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
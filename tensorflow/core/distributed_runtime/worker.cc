@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
 #include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/profiler/lib/device_profiler_session.h"
 #include "tensorflow/core/protobuf/distributed_runtime_payloads.pb.h"
@@ -449,6 +450,50 @@ void Worker::CompleteInstanceAsync(CallOptions* opts,
   }
 }
 
+void Worker::CompleteInstanceBatchAsync(
+    CallOptions* opts, const CompleteInstanceBatchRequest* request,
+    CompleteInstanceBatchResponse* response, StatusCallback done) {
+  if (!env_->collective_executor_mgr) {
+    done(
+        errors::Internal("Runtime not initialized with CollectiveExecutorMgr"));
+    return;
+  }
+  const int num_requests = request->request_size();
+  if (num_requests == 0) {
+    done(Status::OK());
+    return;
+  }
+  for (int i = 0; i < num_requests; ++i) {
+    response->add_response();
+  }
+  struct BatchState {
+    mutex mu;
+    int num_pending TF_GUARDED_BY(mu);
+    Status status TF_GUARDED_BY(mu);
+    StatusCallback done;
+  };
+  BatchState* state = new BatchState;
+  state->num_pending = num_requests;
+  state->done = std::move(done);
+  ParamResolverInterface* resolver =
+      env_->collective_executor_mgr->GetParamResolver();
+  for (int i = 0; i < num_requests; ++i) {
+    resolver->CompleteInstanceAsync(
+        &request->request(i), response->mutable_response(i),
+        &cancellation_manager_, [state](const Status& s) {
+          Status status;
+          {
+            mutex_lock l(state->mu);
+            state->status.Update(s);
+            if (--state->num_pending > 0) return;
+            status = state->status;
+          }
+          state->done(status);
+          delete state;
+        });
+  }
+}
+
 void Worker::GetStepSequenceAsync(const GetStepSequenceRequest* request,
                                   GetStepSequenceResponse* response,
                                   StatusCallback done) {
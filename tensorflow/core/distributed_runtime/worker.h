@@ -104,6 +104,11 @@ class Worker : public WorkerInterface {
                              CompleteInstanceResponse* response,
                              StatusCallback done) override;
 
+  void CompleteInstanceBatchAsync(CallOptions* opts,
+                                  const CompleteInstanceBatchRequest* request,
+                                  CompleteInstanceBatchResponse* response,
+                                  StatusCallback done) override;
+
   void GetStepSequenceAsync(const GetStepSequenceRequest* request,
                             GetStepSequenceResponse* response,
                             StatusCallback done) override;
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/call_options.h"
 #include "tensorflow/core/distributed_runtime/message_wrappers.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/types.h"
@@ -106,6 +107,16 @@ class WorkerInterface {
                                TensorResponse* response,
                                StatusCallback done) = 0;
 
+  // Receives several tensors in one call. Workers that do not support
+  // batching fail with `Unimplemented`, in which case the caller should fall
+  // back to RecvTensorAsync.
+  virtual void RecvTensorBatchAsync(CallOptions* opts,
+                                    const RecvTensorBatchRequest* request,
+                                    RecvTensorBatchResponse* response,
+                                    StatusCallback done) {
+    done(errors::Unimplemented("RecvTensorBatch is not supported."));
+  }
+
   virtual void LoggingAsync(const LoggingRequest* request,
                             LoggingResponse* response, StatusCallback done) = 0;
 
@@ -125,6 +136,15 @@ class WorkerInterface {
                                      CompleteInstanceResponse* response,
                                      StatusCallback done) = 0;
 
+  // Completes several collective instances in one call. Workers that do not
+  // support batching fail with `Unimplemented`, in which case the caller
+  // should fall back to CompleteInstanceAsync.
+  virtual void CompleteInstanceBatchAsync(
+      CallOptions* opts, const CompleteInstanceBatchRequest* request,
+      CompleteInstanceBatchResponse* response, StatusCallback done) {
+    done(errors::Unimplemented("CompleteInstanceBatch is not supported."));
+  }
+
   virtual void GetStepSequenceAsync(const GetStepSequenceRequest* request,
                                     GetStepSequenceResponse* response,
                                     StatusCallback done) = 0;
@@ -398,6 +398,12 @@ class SubAllocator {
   // returned by this allocator.
   virtual bool SupportsCoalescing() const = 0;
 
+  // Returns a granularity such that Free() can release any range aligned to it
+  // in the middle of memory returned by Alloc(), or 0 if Free() only accepts
+  // whole allocations. The BFC allocator uses it to give back the memory
+  // backing free chunks of a region that still holds live allocations.
+  virtual size_t FreeGranularity() const { return 0; }
+
   // Returns the type of the memory allocated by this SubAllocator.
   virtual AllocatorMemoryType GetMemoryType() const {
     return AllocatorMemoryType::kUnknown;
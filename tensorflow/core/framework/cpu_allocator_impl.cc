@@ -139,6 +139,7 @@ class CPUAllocator : public Allocator {
                              {"id", annotation.pending_step_id},
                              {"region_type", annotation.pending_region_type},
                              {"data_type", annotation.pending_data_type},
+                             {"tensor_name", annotation.PendingTensorName()},
                              {"shape", annotation.pending_shape_func()}});
         },
         /*level=*/profiler::TraceMeLevel::kInfo);
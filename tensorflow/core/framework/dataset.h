@@ -753,6 +753,10 @@ class IteratorBase {
   // this iterator.
   virtual const string& prefix() const = 0;
 
+  // Returns the performance model of the input pipeline if this iterator owns
+  // it, e.g. because it is the root of the pipeline, and nullptr otherwise.
+  virtual std::shared_ptr<model::Model> model() const { return nullptr; }
+
   // Performs initialization that needs to happen outside of a constructor to
   // properly propagate errors.
   virtual Status Initialize(IteratorContext* ctx) { return Status::OK(); }
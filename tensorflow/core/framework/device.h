@@ -151,6 +151,19 @@ class Device : public DeviceBase {
     return Status::OK();
   }
 
+  // Optionally fills `node_contexts`, indexed by node id, with the
+  // DeviceContext* to execute each node of `graph` with, e.g. to run
+  // independent nodes on different streams. Nodes whose entry is nullptr, or
+  // all nodes if `node_contexts` is left empty, use the context returned by
+  // TryGetDeviceContext().
+  //
+  // The device keeps ownership of the contexts, which must outlive the
+  // executors of the graph.
+  virtual Status AssignNodeDeviceContexts(
+      const Graph& /*graph*/, std::vector<DeviceContext*>* /*node_contexts*/) {
+    return Status::OK();
+  }
+
   // Returns the op segment of this device.  The caller can reuse op
   // kernels registered for the same session running on this device.
   OpSegment* op_segment() { return &op_seg_; }
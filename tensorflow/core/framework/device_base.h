@@ -48,6 +48,7 @@ class EventMgr;
 class OpKernelContext;
 class ResourceMgr;
 class ScopedAllocatorMgr;
+class StepArenaAllocatorMgr;
 class TensorProto;
 
 namespace thread {
@@ -187,13 +188,18 @@ class DeviceBase {
     return nullptr;
   }
 
-  // This method is provided for backwards compatibility, and will be removed
-  // in a future release.
-  ABSL_DEPRECATED("Use `this->GetAllocator()` or `this->GetScopedAllocator()`.")
-  Allocator* GetStepAllocator(AllocatorAttributes attr, ResourceMgr*) {
+  // Return the Allocator to use for temporaries that do not outlive the step
+  // `step_id`. Devices that support step-scoped arenas return an allocator
+  // owned by the StepArenaAllocatorMgr; by default this is GetAllocator().
+  virtual Allocator* GetStepAllocator(AllocatorAttributes attr,
+                                      int64_t step_id) {
     return GetAllocator(attr);
   }
 
+  virtual StepArenaAllocatorMgr* GetStepArenaAllocatorMgr() const {
+    return nullptr;
+  }
+
   // Return an Allocator prepared for use in particular places by graph
   // optimization
   virtual Allocator* GetScopedAllocator(AllocatorAttributes attr,
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/local_rendezvous.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -23,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/refcount.h"
@@ -97,17 +100,26 @@ void LocalRendezvous::ItemQueue::push_back(Item* item) {
   }
 }
 
+LocalRendezvous::LocalRendezvous(Rendezvous* owner, int num_shards)
+    : rc_owner_(owner),
+      num_shards_(std::max(num_shards, 1)),
+      shards_(new TableShard[num_shards_]),
+      aborted_(false),
+      pending_callback_counter_(0) {}
+
 LocalRendezvous::~LocalRendezvous() {
   // Before destroying this rendezvous instance, make sure all the done-callback
   // calls have finished and the tensors have been released from the queue.
-  {
-    mutex_lock l(mu_);
-    while (pending_callback_counter_ != 0) {
-      pending_callback_cond_var_.wait_for(l, std::chrono::milliseconds(50));
-    }
+  while (pending_callback_counter_.load(std::memory_order_acquire) != 0) {
+    Env::Default()->SleepForMicroseconds(50);
   }
 
-  if (!table_.empty()) {
+  bool empty = true;
+  for (int i = 0; i < num_shards_; ++i) {
+    mutex_lock l(shards_[i].mu);
+    empty = empty && shards_[i].table.empty();
+  }
+  if (!empty) {
     StartAbort(errors::Cancelled("LocalRendezvous deleted"));
   }
 }
@@ -116,6 +128,30 @@ namespace {
 uint64 KeyHash(const StringPiece& k) { return Hash64(k.data(), k.size()); }
 }  // namespace
 
+bool LocalRendezvous::IsAborted(Status* s) {
+  if (TF_PREDICT_TRUE(!aborted_.load(std::memory_order_acquire))) {
+    return false;
+  }
+  *s = status();
+  return true;
+}
+
+template <typename Fn>
+void LocalRendezvous::RunCallback(Fn&& fn) {
+  // Make sure the ref-count of the rendezvous won't reach 0 while the
+  // done_callback is running, which would otherwise become deadlock:
+  // the done_callback waits for the Unref() to return, while the destructor
+  // wiats for the pending_callback_counter to reach 0.
+  core::RefCountPtr<const Rendezvous> rc_owner_ref;
+  if (rc_owner_) {
+    rc_owner_ref.reset(rc_owner_);
+    rc_owner_->Ref();
+  }
+  pending_callback_counter_.fetch_add(1, std::memory_order_relaxed);
+  fn();
+  pending_callback_counter_.fetch_sub(1, std::memory_order_release);
+}
+
 Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
                              const Rendezvous::Args& send_args,
                              const Tensor& val, const bool is_dead) {
@@ -132,15 +168,16 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
         ->IncrementBy(1);
   }
 
-  mu_.lock();
-  if (!status_.ok()) {
+  TableShard* shard = GetShard(key_hash);
+  shard->mu.lock();
+  Status s;
+  if (IsAborted(&s)) {
     // Rendezvous has been aborted.
-    Status s = status_;
-    mu_.unlock();
+    shard->mu.unlock();
     return s;
   }
 
-  ItemQueue* queue = &table_[key_hash];
+  ItemQueue* queue = &shard->table[key_hash];
   if (queue->head == nullptr || queue->head->type == Item::kSend) {
     // There is no waiter for this message. Append the message
     // into the queue. The waiter will pick it up when arrives.
@@ -149,7 +186,7 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
     // the lock.
     DVLOG(2) << "Enqueue Send Item (key:" << key.FullKey() << "). ";
     queue->push_back(new Item(send_args, val, is_dead));
-    mu_.unlock();
+    shard->mu.unlock();
     return Status::OK();
   }
 
@@ -160,33 +197,19 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
   // Delete the queue when the last element has been consumed.
   if (item->next == nullptr) {
     DVLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
-    table_.erase(key_hash);
+    shard->table.erase(key_hash);
   } else {
     queue->head = item->next;
   }
+  shard->mu.unlock();
 
-  // Make sure the ref-count of the rendezvous won't reach 0 while the
-  // done_callback is running, which would otherwise become deadlock:
-  // the done_callback waits for the Unref() to return, while the destructor
-  // wiats for the pending_callback_counter to reach 0.
-  core::RefCountPtr<const Rendezvous> rc_owner_ref;
-  if (rc_owner_) {
-    rc_owner_ref.reset(rc_owner_);
-    rc_owner_->Ref();
-  }
-  pending_callback_counter_++;
   // Invoke the done-callback, without holding the lock.
-  mu_.unlock();
   DCHECK_EQ(item->type, Item::kRecv);
-  (*item->recv_state.waiter)(Status::OK(), send_args, item->args, val, is_dead);
-  delete item;
-  {
-    mutex_lock l(mu_);
-    pending_callback_counter_--;
-    if (pending_callback_counter_ == 0) {
-      pending_callback_cond_var_.notify_all();
-    }
-  }
+  RunCallback([&]() {
+    (*item->recv_state.waiter)(Status::OK(), send_args, item->args, val,
+                               is_dead);
+    delete item;
+  });
   return Status::OK();
 }
 
@@ -196,16 +219,17 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
   uint64 key_hash = KeyHash(key.FullKey());
   DVLOG(2) << "Recv " << this << " " << key_hash << " " << key.FullKey();
 
-  mu_.lock();
-  if (!status_.ok()) {
+  TableShard* shard = GetShard(key_hash);
+  shard->mu.lock();
+  Status s;
+  if (IsAborted(&s)) {
     // Rendezvous has been aborted.
-    Status s = status_;
-    mu_.unlock();
+    shard->mu.unlock();
     done(s, Rendezvous::Args(), recv_args, Tensor(), false);
     return;
   }
 
-  ItemQueue* queue = &table_[key_hash];
+  ItemQueue* queue = &shard->table[key_hash];
   if (queue->head == nullptr || queue->head->type == Item::kRecv) {
     // There is no message to pick up.
     // Only recv-related fields need to be filled.
@@ -231,8 +255,9 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
       already_cancelled = !cm->RegisterCallback(token, [this, token, key_hash] {
         Item* item = nullptr;
         {
-          mutex_lock l(mu_);
-          ItemQueue* queue = &table_[key_hash];
+          TableShard* shard = GetShard(key_hash);
+          mutex_lock l(shard->mu);
+          ItemQueue* queue = &shard->table[key_hash];
           // Find an item in the queue with a cancellation token that matches
           // `token`, and remove it.
           if (queue->head != nullptr && queue->head->type == Item::kRecv) {
@@ -243,7 +268,7 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
                 if (queue->head->next == nullptr) {
                   // We have a single-element queue, so we can erase it from
                   // the table.
-                  table_.erase(key_hash);
+                  shard->table.erase(key_hash);
                 } else {
                   // Remove the current item from the queue.
                   if (curr == queue->head) {
@@ -275,7 +300,7 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
       });
     }
     if (already_cancelled) {
-      mu_.unlock();
+      shard->mu.unlock();
       // Unref case (2)
       if (rc_owner_) rc_owner_->Unref();
       done(StatusGroup::MakeDerived(
@@ -312,7 +337,7 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
       queue->push_back(new Item(recv_args, std::move(done), token));
     }
 
-    mu_.unlock();
+    shard->mu.unlock();
     return;
   }
 
@@ -324,63 +349,52 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
   // Delete the queue when the last element has been consumed.
   if (item->next == nullptr) {
     DVLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
-    table_.erase(key_hash);
+    shard->table.erase(key_hash);
   } else {
     queue->head = item->next;
   }
+  shard->mu.unlock();
 
-  // Make sure the ref-count of the rendezvous won't reach 0 while the
-  // done_callback is running, which would otherwise become deadlock:
-  // the done_callback waits for the Unref() to return, while the destructor
-  // wiats for the pending_callback_counter to reach 0.
-  core::RefCountPtr<const Rendezvous> rc_owner_ref;
-  if (rc_owner_) {
-    rc_owner_ref.reset(rc_owner_);
-    rc_owner_->Ref();
-  }
-  pending_callback_counter_++;
   // Invoke the done-callback, without holding the lock.
-  mu_.unlock();
   DCHECK_EQ(item->type, Item::kSend);
-  done(Status::OK(), item->args, recv_args, *item->send_state.value,
-       item->send_state.is_dead);
-  delete item;
-  {
-    mutex_lock l(mu_);
-    pending_callback_counter_--;
-    if (pending_callback_counter_ == 0) {
-      pending_callback_cond_var_.notify_all();
-    }
-  }
+  RunCallback([&]() {
+    done(Status::OK(), item->args, recv_args, *item->send_state.value,
+         item->send_state.is_dead);
+    delete item;
+  });
 }
 
 void LocalRendezvous::StartAbort(const Status& status) {
   CHECK(!status.ok());
-  Table table;
   {
-    mutex_lock l(mu_);
+    mutex_lock l(status_mu_);
     status_.Update(status);
-    table_.swap(table);
+    aborted_.store(true, std::memory_order_release);
   }
-  for (auto& p : table) {
-    Item* item = p.second.head;
-    while (item != nullptr) {
-      if (item->type == Item::kRecv) {
-        (*item->recv_state.waiter)(status, Rendezvous::Args(),
-                                   Rendezvous::Args(), Tensor(), false);
+  for (int i = 0; i < num_shards_; ++i) {
+    Table table;
+    {
+      mutex_lock l(shards_[i].mu);
+      shards_[i].table.swap(table);
+    }
+    for (auto& p : table) {
+      Item* item = p.second.head;
+      while (item != nullptr) {
+        if (item->type == Item::kRecv) {
+          (*item->recv_state.waiter)(status, Rendezvous::Args(),
+                                     Rendezvous::Args(), Tensor(), false);
+        }
+        Item* to_delete = item;
+        item = item->next;
+        delete to_delete;
       }
-      Item* to_delete = item;
-      item = item->next;
-      delete to_delete;
     }
   }
 }
 
 Status LocalRendezvous::status() {
-  mu_.lock();
-  Status s = status_;
-  mu_.unlock();
-  return s;
+  mutex_lock l(status_mu_);
+  return status_;
 }
 
 }  // namespace tensorflow
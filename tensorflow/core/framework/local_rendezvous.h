@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include <atomic>
+#include <memory>
+
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -33,14 +36,17 @@ namespace tensorflow {
 // IntraProcessRendezvous or RemoteRendezvous. This class does not implement
 // RendezvousInterface because virtual dispatch to LocalRendezvous methods
 // is not expected to be needed.
+//
+// The pending items are partitioned by key hash into `num_shards` tables,
+// each with its own lock, so that sends and receives on different keys (e.g.
+// the many `_Send`/`_Recv` pairs between a CPU and a GPU) rarely contend.
 class LocalRendezvous {
  public:
   // If the class wrapping LocalRendezvous is refcounted (i.e., extending
   // Rendezvous), pass in its pointer in constructor so the LocalRendezvous
   // can make sure it outlives the async recv requests.
   // Pass in nullptr if the wrapping class is not refcounted.
-  explicit LocalRendezvous(Rendezvous* owner)
-      : rc_owner_(owner), pending_callback_counter_(0) {}
+  explicit LocalRendezvous(Rendezvous* owner, int num_shards = 1);
   ~LocalRendezvous();
 
   Status Send(const Rendezvous::ParsedKey& key,
@@ -68,16 +74,41 @@ class LocalRendezvous {
 
   typedef gtl::FlatMap<uint64, ItemQueue> Table;
 
+  struct alignas(64) TableShard {
+    mutex mu;
+    Table table TF_GUARDED_BY(mu);
+  };
+
+  TableShard* GetShard(uint64 key_hash) {
+    // The low bits of `key_hash` also select the bucket within `Table`, so use
+    // the high bits to select the shard.
+    return &shards_[(key_hash >> 32) % num_shards_];
+  }
+
+  // Returns true and sets `*s` to the abort status if `StartAbort()` has been
+  // called.
+  bool IsAborted(Status* s);
+
+  // Invokes a done callback outside of any lock, keeping `rc_owner_` alive and
+  // the destructor blocked until `fn` has returned.
+  template <typename Fn>
+  void RunCallback(Fn&& fn);
+
   // Pointer to the owner class of this LocalRendezvous if it is refcounted.
   const Rendezvous* rc_owner_;
 
-  // TODO(zhifengc): shard table_.
-  mutex mu_;
-  Table table_ TF_GUARDED_BY(mu_);
-  Status status_ TF_GUARDED_BY(mu_);
-  // Track the number of pening callbacks using a counter.
-  int pending_callback_counter_ TF_GUARDED_BY(mu_);
-  condition_variable pending_callback_cond_var_ TF_GUARDED_BY(mu_);
+  const int num_shards_;
+  std::unique_ptr<TableShard[]> shards_;
+
+  // Set under `status_mu_` by `StartAbort()` before the tables are drained, so
+  // that a send or receive that observes `aborted_ == false` while holding a
+  // shard lock will be drained by any concurrent abort.
+  std::atomic<bool> aborted_;
+  mutex status_mu_;
+  Status status_ TF_GUARDED_BY(status_mu_);
+
+  // Track the number of pending callbacks using a counter.
+  std::atomic<int> pending_callback_counter_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(LocalRendezvous);
 };
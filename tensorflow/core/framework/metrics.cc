@@ -15,13 +15,20 @@ limitations under the License.
 
 #include "tensorflow/core/framework/metrics.h"
 
+#include <atomic>
+#include <memory>
 #include <string>
 
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/data_service.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace metrics {
@@ -48,6 +55,13 @@ auto* graph_pending_queue_length_histogram = monitoring::Sampler<0>::New(
     // Power of 1.5 with bucket count 30 (> 191k)
     {monitoring::Buckets::Exponential(1, 1.5, 30)});
 
+auto* run_handler_queueing_delay_usecs = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/run_handler/queueing_delay_usecs",
+     "The mean time the inter-op closures of a request scheduled on a "
+     "RunHandlerPool waited in the queue before running, in microseconds."},
+    // Power of 2 with bucket count 24 (> 8s)
+    {monitoring::Buckets::Exponential(1, 2, 24)});
+
 auto* graph_run_input_tensor_bytes = monitoring::Sampler<0>::New(
     {"/tensorflow/core/graph_run_input_tensor_bytes",
      "The size of input tensors in bytes."},
@@ -157,6 +171,12 @@ auto* tf_data_service_multi_trainer_cache_queries_counter =
         "hit or miss.",
         "cache_hit");
 
+auto* tf_data_service_multi_trainer_cache_skipped_elements_counter =
+    monitoring::Counter<0>::New(
+        "/tensorflow/data/service/multi_trainer_cache_skipped_elements",
+        "tf.data service multi-trainer cache elements evicted before a lagging "
+        "trainer read them.");
+
 auto* tf_data_filename_counter = monitoring::Counter<2>::New(
     "/tensorflow/data/filename", "The file name read by a tf.data Dataset.",
     "name", "filename");
@@ -165,6 +185,13 @@ auto* tf_data_model_gauge =
     monitoring::Gauge<std::function<std::string()>, 1>::New(
         "/tensorflow/data/model", "tf.data autotuning model proto.", "id");
 
+auto* tf_data_bottleneck_gauge =
+    monitoring::Gauge<std::function<std::string()>, 1>::New(
+        "/tensorflow/data/bottleneck",
+        "The bottleneck of a tf.data input pipeline, its slack, and suggested "
+        "parameter changes.",
+        "id");
+
 auto* tf_data_auto_shard = monitoring::Gauge<int64, 2>::New(
     "/tensorflow/data/autoshard", "tf.data autoshard statistics.", "id",
     "name");
@@ -236,6 +263,42 @@ auto* bfc_allocator_delay =
                                 "The total time spent running each graph "
                                 "optimization pass in microseconds.");
 
+auto* bfc_allocator_allocation_size_bytes = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/bfc_allocator/allocation_size_bytes",
+     "The distribution of requested allocation sizes in bytes.", "allocator"},
+    // Power of 4 with bucket boundaries up to 64GiB.
+    {monitoring::Buckets::Exponential(1, 4, 19)});
+
+auto* bfc_allocator_fragmentation = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/bfc_allocator/fragmentation",
+     "The fraction of free bytes that are not part of the largest free chunk, "
+     "sampled periodically.",
+     "allocator"},
+    {monitoring::Buckets::Explicit(
+        {0.05, 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 0.95})});
+
+auto* bfc_allocator_bin_bytes_in_use = monitoring::Gauge<int64_t, 2>::New(
+    "/tensorflow/core/bfc_allocator/bin_bytes_in_use",
+    "The number of bytes in use by chunks of each bin, sampled periodically.",
+    "allocator", "bin");
+
+auto* bfc_allocator_lock_wait_usecs = monitoring::Counter<1>::New(
+    "/tensorflow/core/bfc_allocator/lock_wait_usecs",
+    "The total time spent waiting for the allocator lock in microseconds.",
+    "allocator");
+
+auto* gpu_host_to_device_bytes = monitoring::Counter<1>::New(
+    "/tensorflow/core/gpu/host_to_device_bytes",
+    "The number of bytes copied from the host to the device.", "device");
+
+auto* gpu_host_to_device_bandwidth = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/gpu/host_to_device_bandwidth",
+     "The distribution of the bandwidth, in MB/s, achieved by the copies from "
+     "the host to the device, from when they are enqueued until they complete.",
+     "device"},
+    // Power of 2 with bucket boundaries up to 512GB/s.
+    {monitoring::Buckets::Exponential(1, 2, 20)});
+
 auto* tpu_variable_distribution_time_usecs = monitoring::Counter<0>::New(
     "/tensorflow/tpu/variable_distribution_time",
     "Time spent sending variables from primary task to other worker tasks "
@@ -246,6 +309,90 @@ auto* test_counters =
     monitoring::Counter<2>::New("/tensorflow/core/test_counters",
                                 "Counters used for testing.", "name", "label");
 
+auto* thread_pool_queue_time_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/thread_pool/queue_time_usecs",
+     "The time tasks wait in the queue of a thread pool in microseconds.",
+     "pool"},
+    // Power of 2 with bucket boundaries up to about 1 hour.
+    {monitoring::Buckets::Exponential(1, 2, 32)});
+
+auto* thread_pool_run_time_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/thread_pool/run_time_usecs",
+     "The time tasks run on a thread pool in microseconds.", "pool"},
+    {monitoring::Buckets::Exponential(1, 2, 32)});
+
+auto* thread_pool_queue_depth = monitoring::Gauge<int64_t, 1>::New(
+    "/tensorflow/core/thread_pool/queue_depth",
+    "The number of tasks waiting in the queue of a thread pool.", "pool");
+
+auto* thread_pool_active_threads = monitoring::Gauge<int64_t, 1>::New(
+    "/tensorflow/core/thread_pool/active_threads",
+    "The number of threads of a thread pool that are running a task.", "pool");
+
+// The metrics of a thread pool. The pools with the same name share the
+// counts.
+class ThreadPoolMetricsImpl : public thread::ThreadPoolMetrics {
+ public:
+  struct Counts {
+    std::atomic<int64_t> queue_depth{0};
+    std::atomic<int64_t> active_threads{0};
+  };
+
+  ThreadPoolMetricsImpl(const string& name, Counts* counts)
+      : counts_(counts),
+        queue_time_(thread_pool_queue_time_usecs->GetCell(name)),
+        run_time_(thread_pool_run_time_usecs->GetCell(name)),
+        queue_depth_(thread_pool_queue_depth->GetCell(name)),
+        active_threads_(thread_pool_active_threads->GetCell(name)) {}
+
+  void TaskQueued() override {
+    queue_depth_->Set(counts_->queue_depth.fetch_add(1) + 1);
+  }
+
+  void TaskStarted(uint64 queue_time_us) override {
+    queue_depth_->Set(counts_->queue_depth.fetch_sub(1) - 1);
+    active_threads_->Set(counts_->active_threads.fetch_add(1) + 1);
+    queue_time_->Add(queue_time_us);
+  }
+
+  void TaskDone(uint64 run_time_us) override {
+    active_threads_->Set(counts_->active_threads.fetch_sub(1) - 1);
+    run_time_->Add(run_time_us);
+  }
+
+ private:
+  Counts* const counts_;
+  monitoring::SamplerCell* const queue_time_;
+  monitoring::SamplerCell* const run_time_;
+  monitoring::GaugeCell<int64_t>* const queue_depth_;
+  monitoring::GaugeCell<int64_t>* const active_threads_;
+};
+
+std::unique_ptr<thread::ThreadPoolMetrics> CreateThreadPoolMetrics(
+    const string& name) {
+  static mutex* mu = new mutex;
+  static auto* counts =
+      new absl::flat_hash_map<string,
+                              std::unique_ptr<ThreadPoolMetricsImpl::Counts>>;
+  mutex_lock l(*mu);
+  auto& pool_counts = (*counts)[name];
+  if (pool_counts == nullptr) {
+    pool_counts = absl::make_unique<ThreadPoolMetricsImpl::Counts>();
+  }
+  return absl::make_unique<ThreadPoolMetricsImpl>(name, pool_counts.get());
+}
+
+// Instruments the thread pools from the start if
+// TF_ENABLE_THREAD_POOL_METRICS is true.
+const bool thread_pool_metrics_enabled_from_env = [] {
+  bool enabled = false;
+  Status status =
+      ReadBoolFromEnvVar("TF_ENABLE_THREAD_POOL_METRICS", false, &enabled);
+  if (!status.ok()) LOG(ERROR) << status;
+  if (enabled) EnableThreadPoolMetrics();
+  return enabled;
+}();
+
 }  // namespace
 
 auto* tpu_op_error_counter = monitoring::Counter<2>::New(
@@ -291,6 +438,11 @@ monitoring::GaugeCell<std::function<std::string()>>* GetTFDataModelGauge(
   return tf_data_model_gauge->GetCell(id);
 }
 
+monitoring::GaugeCell<std::function<std::string()>>* GetTFDataBottleneckGauge(
+    const string& id) {
+  return tf_data_bottleneck_gauge->GetCell(id);
+}
+
 void RecordTFDataBytesFetched(int64_t num_bytes) {
   tf_data_bytes_fetched_counter->GetCell()->IncrementBy(num_bytes);
 }
@@ -383,6 +535,11 @@ void RecordTFDataServiceMultiTrainerCacheQuery(bool cache_hit) {
       ->IncrementBy(1);
 }
 
+void RecordTFDataServiceMultiTrainerCacheSkippedElements(int64_t num_elements) {
+  tf_data_service_multi_trainer_cache_skipped_elements_counter->GetCell()
+      ->IncrementBy(num_elements);
+}
+
 void RecordTFDataFilename(const string& name, const string& filename) {
   tf_data_filename_counter->GetCell(name, filename)->IncrementBy(1);
 }
@@ -462,6 +619,12 @@ void UpdateGraphPendingQueueLength(uint64 len) {
   graph_pending_queue_length_cell->Add(len);
 }
 
+void UpdateRunHandlerQueueingDelay(const uint64 delay_usecs) {
+  static auto* run_handler_queueing_delay_cell =
+      run_handler_queueing_delay_usecs->GetCell();
+  run_handler_queueing_delay_cell->Add(delay_usecs);
+}
+
 void UpdateGraphBuildTime(const uint64 running_time_usecs) {
   if (running_time_usecs > 0) {
     static auto* build_graph_calls_cell = build_graph_calls->GetCell();
@@ -496,10 +659,46 @@ void UpdateBfcAllocatorDelayTime(const uint64 delay_usecs) {
   }
 }
 
+monitoring::SamplerCell* GetBfcAllocatorAllocationSizeSampler(
+    const string& allocator_name) {
+  return bfc_allocator_allocation_size_bytes->GetCell(allocator_name);
+}
+
+monitoring::SamplerCell* GetBfcAllocatorFragmentationSampler(
+    const string& allocator_name) {
+  return bfc_allocator_fragmentation->GetCell(allocator_name);
+}
+
+monitoring::GaugeCell<int64_t>* GetBfcAllocatorBinBytesInUseGauge(
+    const string& allocator_name, int bin) {
+  return bfc_allocator_bin_bytes_in_use->GetCell(allocator_name,
+                                                 absl::StrCat(bin));
+}
+
+monitoring::CounterCell* GetBfcAllocatorLockWaitCounter(
+    const string& allocator_name) {
+  return bfc_allocator_lock_wait_usecs->GetCell(allocator_name);
+}
+
+void RecordGpuHostToDeviceCopy(const string& device_name, int64_t num_bytes,
+                               uint64 duration_us) {
+  gpu_host_to_device_bytes->GetCell(device_name)->IncrementBy(num_bytes);
+  constexpr int64_t kMinSampledBytes = 64 << 10;
+  if (num_bytes >= kMinSampledBytes && duration_us > 0) {
+    // Bytes per microsecond are MB/s.
+    gpu_host_to_device_bandwidth->GetCell(device_name)
+        ->Add(static_cast<double>(num_bytes) / duration_us);
+  }
+}
+
 void RecordUnusedOutput(const string& op_name) {
   graph_unused_outputs->GetCell(op_name)->IncrementBy(1);
 }
 
+void EnableThreadPoolMetrics() {
+  thread::SetThreadPoolMetricsFactory(&CreateThreadPoolMetrics);
+}
+
 void IncrementTestCounter(const string& name, const string& label) {
   test_counters->GetCell(name, label)->IncrementBy(1);
 }
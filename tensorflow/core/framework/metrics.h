@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/types.h"
@@ -65,6 +66,13 @@ monitoring::CounterCell* GetTFDataElementsCounter(const string& name);
 monitoring::GaugeCell<std::function<std::string()>>* GetTFDataModelGauge(
     const string& id);
 
+// Returns a gauge than can be used to record the current bottleneck of the
+// input pipeline, as estimated from its performance model.
+//
+// The `id` argument represents the (unique) model ID.
+monitoring::GaugeCell<std::function<std::string()>>* GetTFDataBottleneckGauge(
+    const string& id);
+
 // Records the number of bytes fetched from tf.data.Dataset iterator.
 void RecordTFDataBytesFetched(int64_t num_bytes);
 
@@ -126,6 +134,10 @@ void RecordTFDataServiceClientIterators(
 // Records tf.data service multi-trainer cache queries.
 void RecordTFDataServiceMultiTrainerCacheQuery(bool cache_hit);
 
+// Records `num_elements` evicted from the tf.data service multi-trainer cache
+// before a lagging trainer read them.
+void RecordTFDataServiceMultiTrainerCacheSkippedElements(int64_t num_elements);
+
 // Records the file name read by a tf.data Dataset.
 //
 // The `name` argument identifies the Dataset type (e.g. "TFRecordDataset").
@@ -171,6 +183,10 @@ void RecordTPUXlaSpmdCoresPerReplica(int64_t cores_per_replica);
 void UpdateGraphExecTime(const uint64 running_time_usecs);
 void UpdateGraphPendingQueueLength(uint64 len);
 
+// Records the mean time the inter-op closures of a request scheduled on a
+// RunHandlerPool waited in the queue before running.
+void UpdateRunHandlerQueueingDelay(const uint64 delay_usecs);
+
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
@@ -302,6 +318,41 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs);
 // Updates the metrics stored about time BFC allocator spents during delay.
 void UpdateBfcAllocatorDelayTime(const uint64 delay_usecs);
 
+// Returns a sampler that records the distribution of requested allocation
+// sizes, in bytes, of the BFC allocator identified by `allocator_name`.
+monitoring::SamplerCell* GetBfcAllocatorAllocationSizeSampler(
+    const string& allocator_name);
+
+// Returns a sampler that records the fragmentation ratio of the free memory
+// of the BFC allocator identified by `allocator_name`, i.e. the fraction of
+// free bytes outside of the largest free chunk.
+monitoring::SamplerCell* GetBfcAllocatorFragmentationSampler(
+    const string& allocator_name);
+
+// Returns a gauge that holds the number of bytes in use by chunks of bin `bin`
+// of the BFC allocator identified by `allocator_name`.
+monitoring::GaugeCell<int64_t>* GetBfcAllocatorBinBytesInUseGauge(
+    const string& allocator_name, int bin);
+
+// Returns a counter that accumulates the time, in microseconds, that threads
+// waited to acquire the lock of the BFC allocator identified by
+// `allocator_name`.
+monitoring::CounterCell* GetBfcAllocatorLockWaitCounter(
+    const string& allocator_name);
+
+// Records a copy of `num_bytes` from the host to the GPU `device_name` that
+// took `duration_us` from when it was enqueued until it completed. The
+// achieved bandwidth is only sampled for copies of at least 64KiB, as smaller
+// ones are bound by latency.
+void RecordGpuHostToDeviceCopy(const string& device_name, int64_t num_bytes,
+                               uint64 duration_us);
+
+// Instruments the thread pools constructed from now on, e.g. the inter-op,
+// intra-op and tf.data pools, to export the time tasks wait in the queue and
+// run, the queue depth and the number of active threads of each pool by name.
+// Also enabled at startup by setting TF_ENABLE_THREAD_POOL_METRICS=true.
+void EnableThreadPoolMetrics();
+
 // Increments (by 1) a simple integer counter that is exposed for testing.
 void IncrementTestCounter(const string& name, const string& label);
 
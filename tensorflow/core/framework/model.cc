@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/framework/model.h"
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <memory>
 
 #include "absl/time/clock.h"
@@ -1155,6 +1157,47 @@ class AsyncUnknownRatio : public AsyncRatio {
   }
 };
 
+// Divides `budget` among `demands` by max-min fairness, where a negative demand
+// is unbounded. Whatever is left once all demands are met is split evenly.
+std::vector<double> FairShares(const std::vector<double>& demands,
+                               double budget) {
+  std::vector<size_t> order(demands.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  auto demand = [&demands](size_t i) {
+    return demands[i] < 0 ? std::numeric_limits<double>::infinity()
+                          : demands[i];
+  };
+  std::sort(order.begin(), order.end(),
+            [&demand](size_t a, size_t b) { return demand(a) < demand(b); });
+  std::vector<double> shares(demands.size());
+  double remaining = budget;
+  for (size_t i = 0; i < order.size(); ++i) {
+    const double share =
+        std::min(demand(order[i]), remaining / (order.size() - i));
+    shares[order[i]] = share;
+    remaining -= share;
+  }
+  for (double& share : shares) {
+    share += remaining / shares.size();
+  }
+  return shares;
+}
+
+// Returns the names of the nodes on the path from the output of the model to
+// `node`, which identifies the position of `node` across re-creations of the
+// iterators that own it.
+string NodePath(const Node& node) {
+  std::vector<string> names = {node.name()};
+  for (const Node* output = node.output(); output != nullptr;
+       output = output->output()) {
+    names.push_back(output->name());
+  }
+  std::reverse(names.begin(), names.end());
+  return str_util::Join(names, "/");
+}
+
 }  // namespace
 
 thread_local int64_t Node::work_start_;
@@ -1378,6 +1421,42 @@ Node::ModelParameters Node::CollectTunableParameters() const {
   return CollectTunableParametersLocked();
 }
 
+absl::flat_hash_map<string, double> Node::TunableParameterValues() const {
+  std::vector<std::shared_ptr<Parameter>> parameters;
+  {
+    tf_shared_lock l(mu_);
+    for (const auto& pair : parameters_) {
+      if (pair.second->state != nullptr && pair.second->state->tunable) {
+        parameters.push_back(pair.second);
+      }
+    }
+  }
+  absl::flat_hash_map<string, double> values;
+  for (const auto& parameter : parameters) {
+    mutex_lock l(*parameter->state->mu);
+    values[parameter->name] = parameter->state->value;
+  }
+  return values;
+}
+
+void Node::SetTunableParameterValues(
+    const absl::flat_hash_map<string, double>& values) {
+  ModelParameters parameters;
+  {
+    tf_shared_lock l(mu_);
+    for (const auto& pair : parameters_) {
+      auto it = values.find(pair.first);
+      if (it != values.end() && pair.second->state != nullptr &&
+          pair.second->state->tunable) {
+        pair.second->value = std::min(
+            pair.second->max, std::max(pair.second->min, it->second));
+        parameters.push_back(std::make_pair(long_name(), pair.second));
+      }
+    }
+  }
+  UpdateStateValues(&parameters);
+}
+
 string Node::DebugString() const {
   absl::flat_hash_map<string, string> debug_strings;
   tf_shared_lock l(mu_);
@@ -1855,6 +1934,9 @@ Model::Model() : optimization_period_ms_(kOptimizationPeriodMinMs) {
   model_gauge_cell_ = metrics::GetTFDataModelGauge(
       strings::StrCat(reinterpret_cast<uint64>(this)));
   model_gauge_cell_->Set([&]() { return DebugString(); });
+  bottleneck_gauge_cell_ = metrics::GetTFDataBottleneckGauge(
+      strings::StrCat(reinterpret_cast<uint64>(this)));
+  bottleneck_gauge_cell_->Set([&]() { return BottleneckDebugString(); });
 }
 
 Model::~Model() {
@@ -1862,6 +1944,7 @@ Model::~Model() {
   // prevent race condition where the gauge callback is called after the Model
   // is destroyed.
   model_gauge_cell_->Set([]() { return std::string(); });
+  bottleneck_gauge_cell_->Set([]() { return std::string(); });
 }
 
 void Model::AddNode(Node::Factory factory, const string& name,
@@ -1875,6 +1958,11 @@ void Model::AddNode(Node::Factory factory, const string& name,
   if (!output_) {
     output_ = node;
   }
+  auto retained = retained_parameter_values_.find(NodePath(*node));
+  if (retained != retained_parameter_values_.end()) {
+    VLOG(3) << "Restoring tuned parameters of " << node->long_name();
+    node->SetTunableParameterValues(retained->second);
+  }
   if (parent) {
     VLOG(3) << "Adding " << node->long_name() << " as input for "
             << parent->long_name();
@@ -1933,6 +2021,9 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64_t cpu_budget,
       OptimizeGradientDescent(snapshot, optimization_params,
                               cancellation_manager);
       break;
+    case AutotuneAlgorithm::STAGE_BASED:
+      OptimizeStageBased(snapshot, optimization_params, cancellation_manager);
+      break;
     default:
       VLOG(2) << "Autotuning algorithm was not recognized. Aborting "
                  "optimization.";
@@ -1941,6 +2032,14 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64_t cpu_budget,
 }
 
 void Model::RemoveNode(std::shared_ptr<Node> node) {
+  if (node && node->num_elements() > 0) {
+    // Only retain values that have been used, and so possibly tuned.
+    auto values = node->TunableParameterValues();
+    if (!values.empty()) {
+      mutex_lock l(mu_);
+      retained_parameter_values_[NodePath(*node)] = std::move(values);
+    }
+  }
   mutex_lock l(mu_);
   if (node) {
     if (node->output()) {
@@ -1993,6 +2092,13 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm, int64_t cpu_budget,
       },
       /*deregister_fn=*/&unused));
 
+  BudgetArbiter* arbiter = BudgetArbiter::Global();
+  arbiter->Register(this);
+  auto unregister =
+      gtl::MakeCleanup([this, arbiter]() { arbiter->Unregister(this); });
+  int64_t last_report_ns = 0;
+  int64_t last_processing_time_ns = 0;
+
   int64_t last_optimization_ms = 0;
   int64_t current_time_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
   while (true) {
@@ -2011,8 +2117,31 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm, int64_t cpu_budget,
       }
     }
 
+    // Reports the number of cores the pipeline kept busy since the last
+    // optimization, and the memory its buffers may hold.
+    std::shared_ptr<Node> root = output();
+    int64_t processing_time_ns = 0;
+    for (const auto& node :
+         CollectNodes(root, TraversalOrder::BFS, IsAnyNode)) {
+      processing_time_ns += node->processing_time();
+    }
+    const int64_t now_ns = EnvTime::NowNanos();
+    if (root && last_report_ns > 0 && now_ns > last_report_ns) {
+      arbiter->ReportDemand(
+          this,
+          std::max<int64_t>(processing_time_ns - last_processing_time_ns, 0) /
+              static_cast<double>(now_ns - last_report_ns),
+          TotalMaximumBufferedBytes(root));
+    }
+    last_report_ns = now_ns;
+    last_processing_time_ns = processing_time_ns;
+
+    int64_t cpu_share;
+    int64_t ram_share;
+    arbiter->GetBudget(this, cpu_budget, ram_budget, &cpu_share, &ram_share);
+
     int64_t start_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
-    Optimize(algorithm, cpu_budget, ram_budget, /*model_input_time=*/0,
+    Optimize(algorithm, cpu_share, ram_share, /*model_input_time=*/0,
              cancellation_manager);
     int64_t end_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
     VLOG(2) << "Optimized for " << end_ms - start_ms << " ms.";
@@ -2207,6 +2336,157 @@ void Model::OptimizeMaxParallelism(
                           should_stop);
 }
 
+void Model::OptimizeStageBased(std::shared_ptr<Node> snapshot,
+                               const OptimizationParams& optimization_params,
+                               CancellationManager* cancellation_manager) {
+  VLOG(2) << "Starting optimization of tunable parameters with Stage Based.";
+  auto parameters = CollectTunableParameters(snapshot);
+  if (parameters.empty()) {
+    VLOG(2) << "There are no tunable parameters.";
+    return;
+  }
+  VLOG(2) << "Number of tunable parameters: " << parameters.size();
+
+  // A stage is the subtree of synchronous nodes rooted in an asynchronous
+  // node (or the output node), whose tunable parameters belong to the root.
+  struct Stage {
+    // The time it takes the stage without parallelism to produce the elements
+    // needed for one output element.
+    double total_time_nsec = 0.0;
+    Parameter* parallelism = nullptr;
+    Parameter* buffer_size = nullptr;
+
+    double Time() const {
+      return parallelism == nullptr
+                 ? total_time_nsec
+                 : total_time_nsec / std::max(parallelism->value, 1.0);
+    }
+  };
+  absl::flat_hash_map<string, Stage> stages;
+  ModelTiming model_timing(snapshot);
+  double total_time_nsec = 0.0;
+  for (const auto& root : model_timing.GetStageRoots()) {
+    const ModelTiming::NodeTiming* timing = model_timing.GetTiming(root.get());
+    if (timing == nullptr) {
+      continue;
+    }
+    stages[root->long_name()].total_time_nsec = timing->total_time_nsec;
+    total_time_nsec += timing->total_time_nsec;
+  }
+  double parallelism_used = 0.0;
+  for (auto& pair : parameters) {
+    auto it = stages.find(pair.first);
+    if (it == stages.end()) {
+      continue;
+    }
+    if (pair.second->name == kParallelism) {
+      it->second.parallelism = pair.second.get();
+      parallelism_used += pair.second->value;
+    } else if (pair.second->name == kBufferSize) {
+      it->second.buffer_size = pair.second.get();
+    }
+  }
+
+  // The pipeline cannot produce an element faster than this, even if all of
+  // the CPU budget is used.
+  const double min_time_nsec =
+      total_time_nsec / optimization_params.cpu_budget();
+
+  // Returns the stage other than `bottleneck` whose time after lowering its
+  // parallelism by one is the smallest, if that time is below `max_time_nsec`.
+  auto find_donor = [&stages](const Stage* bottleneck,
+                              double max_time_nsec) -> Stage* {
+    Stage* donor = nullptr;
+    double donor_time_nsec = max_time_nsec;
+    for (auto& pair : stages) {
+      Stage* stage = &pair.second;
+      if (stage == bottleneck || stage->parallelism == nullptr ||
+          stage->parallelism->value - 1 < stage->parallelism->min) {
+        continue;
+      }
+      const double time_nsec =
+          stage->total_time_nsec / std::max(stage->parallelism->value - 1, 1.0);
+      if (time_nsec < donor_time_nsec) {
+        donor = stage;
+        donor_time_nsec = time_nsec;
+      }
+    }
+    return donor;
+  };
+  auto ram_budget_exceeded = [&]() {
+    if (TotalMaximumBufferedBytes(snapshot) >
+        optimization_params.ram_budget()) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("max_buffered_bytes");
+      return true;
+    }
+    return false;
+  };
+
+  // Maximum number of parameter updates for one optimization.
+  constexpr int64_t kMaxIterations = 1000;
+  for (int64_t i = 0; i < kMaxIterations; ++i) {
+    if (cancellation_manager->IsCancelled()) {
+      break;
+    }
+    Stage* bottleneck = nullptr;
+    for (auto& pair : stages) {
+      if (bottleneck == nullptr || pair.second.Time() > bottleneck->Time()) {
+        bottleneck = &pair.second;
+      }
+    }
+    if (bottleneck == nullptr) {
+      break;
+    }
+    // Give back CPU from stages that can spare it when oversubscribed.
+    if (parallelism_used > optimization_params.cpu_budget()) {
+      Stage* donor = find_donor(bottleneck, bottleneck->Time());
+      if (donor != nullptr) {
+        donor->parallelism->value--;
+        parallelism_used--;
+        continue;
+      }
+    }
+    if (bottleneck->Time() <= min_time_nsec) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("output_time");
+      break;
+    }
+    Parameter* parallelism = bottleneck->parallelism;
+    if (parallelism != nullptr && parallelism->value + 1 <= parallelism->max) {
+      Stage* donor = nullptr;
+      if (parallelism_used + 1 > optimization_params.cpu_budget()) {
+        donor = find_donor(bottleneck, bottleneck->total_time_nsec /
+                                           (parallelism->value + 1));
+        if (donor == nullptr) {
+          break;
+        }
+        donor->parallelism->value--;
+        parallelism_used--;
+      }
+      parallelism->value++;
+      parallelism_used++;
+      if (ram_budget_exceeded()) {
+        parallelism->value--;
+        if (donor != nullptr) {
+          donor->parallelism->value++;
+        }
+        break;
+      }
+      continue;
+    }
+    // Without parallelism to tune, a larger buffer can only absorb variance
+    // in the bottleneck, so only add one element per optimization.
+    Parameter* buffer_size = bottleneck->buffer_size;
+    if (buffer_size != nullptr && buffer_size->value + 1 <= buffer_size->max) {
+      buffer_size->value++;
+      if (ram_budget_exceeded()) {
+        buffer_size->value--;
+      }
+    }
+    break;
+  }
+  UpdateStateValues(&parameters);
+}
+
 double Model::OutputTime(std::shared_ptr<Node> node, double model_input_time,
                          Model::ParameterGradients* gradients) {
   // To store the input time for each node.
@@ -2299,6 +2579,26 @@ std::string Model::DebugString() {
   return cached_debug_string_;
 }
 
+BottleneckReport Model::AnalyzeBottleneck() {
+  std::shared_ptr<Node> snapshot;
+  {
+    tf_shared_lock l(mu_);
+    if (!output_) return BottleneckReport();
+    snapshot = output_->Snapshot();
+  }
+  return model::AnalyzeBottleneck(snapshot);
+}
+
+std::string Model::BottleneckDebugString() {
+  constexpr int64_t kMinSecondsBetweenCalls = 10;
+  mutex_lock l(bottleneck_mu_);
+  if (absl::Now() < bottleneck_cache_until_) return cached_bottleneck_string_;
+  cached_bottleneck_string_ = AnalyzeBottleneck().DebugString();
+  bottleneck_cache_until_ =
+      absl::Now() + absl::Seconds(kMinSecondsBetweenCalls);
+  return cached_bottleneck_string_;
+}
+
 Node::NodeVector Model::CollectNodes(
     std::shared_ptr<Node> root, TraversalOrder order,
     bool collect_node(const std::shared_ptr<Node>)) {
@@ -2317,13 +2617,69 @@ Node::NodeVector Model::CollectNodes(
   return nodes;
 }
 
-ModelTiming::ModelTiming(std::shared_ptr<Model> model) : model_(model) {
+BudgetArbiter* BudgetArbiter::Global() {
+  static BudgetArbiter* arbiter = new BudgetArbiter();
+  return arbiter;
+}
+
+void BudgetArbiter::Register(const Model* model) {
+  mutex_lock l(mu_);
+  demands_[model] = Demand();
+}
+
+void BudgetArbiter::Unregister(const Model* model) {
+  mutex_lock l(mu_);
+  demands_.erase(model);
+}
+
+void BudgetArbiter::ReportDemand(const Model* model, double cpu_demand,
+                                 int64_t ram_demand) {
+  mutex_lock l(mu_);
+  auto it = demands_.find(model);
+  if (it == demands_.end()) {
+    return;
+  }
+  it->second.cpu = cpu_demand * kDemandHeadroom;
+  it->second.ram = ram_demand * kDemandHeadroom;
+}
+
+void BudgetArbiter::GetBudget(const Model* model, int64_t cpu_budget,
+                              int64_t ram_budget, int64_t* cpu_share,
+                              int64_t* ram_share) {
+  *cpu_share = cpu_budget;
+  *ram_share = ram_budget;
+  std::vector<double> cpu_demands;
+  std::vector<double> ram_demands;
+  size_t index = 0;
+  {
+    mutex_lock l(mu_);
+    if (demands_.size() < 2 || !demands_.contains(model)) {
+      return;
+    }
+    for (const auto& pair : demands_) {
+      if (pair.first == model) {
+        index = cpu_demands.size();
+      }
+      cpu_demands.push_back(pair.second.cpu);
+      ram_demands.push_back(pair.second.ram);
+    }
+  }
+  *cpu_share = std::max<int64_t>(
+      1, std::round(FairShares(cpu_demands, cpu_budget)[index]));
+  *ram_share = FairShares(ram_demands, ram_budget)[index];
+  VLOG(2) << "Budget share of CPU: " << *cpu_share << " of " << cpu_budget
+          << ", RAM: " << *ram_share << " of " << ram_budget << " bytes.";
+}
+
+ModelTiming::ModelTiming(std::shared_ptr<Model> model)
+    : ModelTiming(model->output()) {}
+
+ModelTiming::ModelTiming(std::shared_ptr<Node> root) : root_(root) {
   ComputeTiming();
 }
 
 void ModelTiming::ComputeTiming() {
-  auto nodes =
-      model_->CollectNodes(model_->output(), TraversalOrder::BFS, IsAnyNode);
+  auto nodes = Model::CollectNodes(root_, TraversalOrder::BFS, IsAnyNode);
   ComputeTimingComponents(nodes);
   std::reverse(nodes.begin(), nodes.end());
   ComputeTotalTimes(nodes);
@@ -2411,8 +2767,7 @@ void ModelTiming::ComputeTotalTimes(const Node::NodeVector& reverse_bfs_nodes) {
 }
 
 std::vector<std::shared_ptr<Node>> ModelTiming::GetStageRoots() const {
-  auto bfs_nodes =
-      model_->CollectNodes(model_->output(), TraversalOrder::BFS, IsAnyNode);
+  auto bfs_nodes = Model::CollectNodes(root_, TraversalOrder::BFS, IsAnyNode);
   std::vector<std::shared_ptr<Node>> roots;
   if (!bfs_nodes.empty() && !bfs_nodes[0]->IsAsync()) {
     roots.push_back(bfs_nodes[0]);
@@ -2427,7 +2782,149 @@ std::vector<std::shared_ptr<Node>> ModelTiming::GetStageRoots() const {
 
 std::vector<std::shared_ptr<Node>> ModelTiming::GetStageNodes(
     std::shared_ptr<Node> root) const {
-  return model_->CollectNodes(root, TraversalOrder::BFS, IsSyncNode);
+  return Model::CollectNodes(root, TraversalOrder::BFS, IsSyncNode);
+}
+
+namespace {
+
+// Returns the value the pipeline currently uses for `parameter`.
+double CurrentValue(const Parameter& parameter) {
+  if (parameter.state == nullptr) return parameter.value;
+  mutex_lock l(*parameter.state->mu);
+  return parameter.state->value == kAutotune ? parameter.value
+                                             : parameter.state->value;
+}
+
+}  // namespace
+
+string BottleneckReport::DebugString() const {
+  if (stages.empty() || stages[0].time_nsec <= 0) {
+    return "No processing time recorded yet.";
+  }
+  string result = strings::Printf("Bottleneck: %s, slack: %.1f%%\nStages:\n",
+                                  stages[0].name.c_str(),
+                                  100 * bottleneck_slack);
+  for (const Stage& stage : stages) {
+    strings::Appendf(&result, "  %s: %.0f ns per element, slack %.0f ns",
+                     stage.name.c_str(), stage.time_nsec, stage.slack_nsec);
+    if (stage.parallelism > 0) {
+      strings::Appendf(&result, ", parallelism %g of %g", stage.parallelism,
+                       stage.max_parallelism);
+    }
+    if (stage.buffer_utilization >= 0) {
+      strings::Appendf(&result, ", buffer %.0f%% full",
+                       100 * stage.buffer_utilization);
+    }
+    strings::StrAppend(&result, ", slowest node ", stage.slowest_node, "\n");
+  }
+  if (!suggestions.empty()) {
+    strings::StrAppend(&result, "Suggestions:\n");
+    for (const string& suggestion : suggestions) {
+      strings::StrAppend(&result, "  ", suggestion, "\n");
+    }
+  }
+  return result;
+}
+
+BottleneckReport AnalyzeBottleneck(std::shared_ptr<Node> root) {
+  BottleneckReport report;
+  if (root == nullptr) return report;
+  ModelTiming model_timing(root);
+  for (const auto& stage_root : model_timing.GetStageRoots()) {
+    const ModelTiming::NodeTiming* timing =
+        model_timing.GetTiming(stage_root.get());
+    if (timing == nullptr) continue;
+    BottleneckReport::Stage stage;
+    stage.name = stage_root->long_name();
+    double slowest_time_nsec = -1.0;
+    for (const auto& node : model_timing.GetStageNodes(stage_root)) {
+      const ModelTiming::NodeTiming* node_timing =
+          model_timing.GetTiming(node.get());
+      if (node_timing != nullptr &&
+          node_timing->self_time_nsec > slowest_time_nsec) {
+        slowest_time_nsec = node_timing->self_time_nsec;
+        stage.slowest_node = node->long_name();
+      }
+    }
+    std::shared_ptr<Parameter> parallelism =
+        stage_root->parameter(kParallelism);
+    double effective_parallelism = 1.0;
+    if (parallelism != nullptr) {
+      stage.parallelism = CurrentValue(*parallelism);
+      stage.max_parallelism = parallelism->max;
+      effective_parallelism = std::max(stage.parallelism, 1.0);
+    }
+    stage.time_nsec = timing->total_time_nsec / effective_parallelism;
+    std::shared_ptr<Parameter> buffer = stage_root->parameter(kBufferSize);
+    if (buffer == nullptr) buffer = parallelism;
+    if (buffer != nullptr && stage_root->IsAsync()) {
+      stage.buffered_elements = stage_root->buffered_elements();
+      const double capacity = CurrentValue(*buffer);
+      if (capacity > 0) {
+        stage.buffer_utilization =
+            std::min(1.0, stage.buffered_elements / capacity);
+      }
+    }
+    report.stages.push_back(std::move(stage));
+  }
+  std::stable_sort(report.stages.begin(), report.stages.end(),
+                   [](const BottleneckReport::Stage& a,
+                      const BottleneckReport::Stage& b) {
+                     return a.time_nsec > b.time_nsec;
+                   });
+  if (report.stages.empty() || report.stages[0].time_nsec <= 0) {
+    return report;
+  }
+
+  const BottleneckReport::Stage& bottleneck = report.stages[0];
+  for (auto& stage : report.stages) {
+    stage.slack_nsec = bottleneck.time_nsec - stage.time_nsec;
+  }
+  const double next_time_nsec =
+      report.stages.size() > 1 ? report.stages[1].time_nsec : 0.0;
+  report.bottleneck_slack =
+      (bottleneck.time_nsec - next_time_nsec) / bottleneck.time_nsec;
+
+  if (bottleneck.parallelism <= 0) {
+    report.suggestions.push_back(strings::StrCat(
+        "Parallelize the stage of ", bottleneck.name,
+        ", e.g. with num_parallel_calls, or speed up its slowest node ",
+        bottleneck.slowest_node, "."));
+  } else if (bottleneck.parallelism >= bottleneck.max_parallelism) {
+    report.suggestions.push_back(strings::StrCat(
+        "The parallelism of ", bottleneck.name, " is at its maximum of ",
+        bottleneck.max_parallelism, ": speed up its slowest node ",
+        bottleneck.slowest_node, " or move work out of the stage."));
+  } else {
+    // The parallelism at which the stage stops being the bottleneck.
+    double target = bottleneck.max_parallelism;
+    if (next_time_nsec > 0) {
+      target = std::min(target, std::ceil(bottleneck.time_nsec *
+                                          bottleneck.parallelism /
+                                          next_time_nsec));
+    }
+    if (target > bottleneck.parallelism) {
+      report.suggestions.push_back(
+          strings::StrCat("Raise the parallelism of ", bottleneck.name,
+                          " from ", bottleneck.parallelism, " to ", target,
+                          "."));
+    }
+  }
+  for (size_t i = 1; i < report.stages.size(); ++i) {
+    const BottleneckReport::Stage& stage = report.stages[i];
+    if (stage.parallelism <= 1) continue;
+    // The lowest parallelism at which the stage stays faster than the
+    // bottleneck.
+    const double needed = std::max(
+        1.0, std::ceil(stage.time_nsec * stage.parallelism /
+                       bottleneck.time_nsec));
+    if (needed < stage.parallelism) {
+      report.suggestions.push_back(strings::StrCat(
+          "Lower the parallelism of ", stage.name, " from ", stage.parallelism,
+          " to ", needed, " to free CPU for the bottleneck."));
+    }
+  }
+  return report;
 }
 
 }  // namespace model
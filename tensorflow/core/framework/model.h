@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -259,12 +260,29 @@ class Node {
   // Returns the node output.
   Node* output() const { return output_; }
 
+  // Returns the values of the tunable parameters, keyed by parameter name.
+  absl::flat_hash_map<string, double> TunableParameterValues() const
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Sets the tunable parameters named in `values` to the given values, and
+  // notifies the node's iterator of the change.
+  void SetTunableParameterValues(
+      const absl::flat_hash_map<string, double>& values) TF_LOCKS_EXCLUDED(mu_);
+
   // Returns the parameter value.
   double parameter_value(const string& name) const TF_LOCKS_EXCLUDED(mu_) {
     tf_shared_lock l(mu_);
     return parameters_.at(name)->state->value;
   }
 
+  // Returns the parameter with the given name, or nullptr if there is none.
+  std::shared_ptr<Parameter> parameter(const string& name) const
+      TF_LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    auto it = parameters_.find(name);
+    return it == parameters_.end() ? nullptr : it->second;
+  }
+
   // Returns the aggregate processing time.
   int64_t processing_time() const TF_LOCKS_EXCLUDED(mu_) {
     return processing_time_;
@@ -650,6 +668,49 @@ std::shared_ptr<Node> MakeAsyncUnknownRatioNode(
 // as pass-through between inputs and output.
 std::shared_ptr<Node> MakeUnknownNode(Node::Args args);
 
+// The current bottleneck of an input pipeline, estimated from its model.
+//
+// A stage is the subtree of synchronous nodes rooted in an asynchronous node
+// (or the output node). Stages run concurrently, so the slowest one bounds the
+// throughput of the pipeline.
+struct BottleneckReport {
+  struct Stage {
+    // The long name of the root of the stage.
+    string name;
+    // The long name of the node of the stage with the largest self time.
+    string slowest_node;
+    // The time it takes the stage, given its parallelism, to produce the
+    // elements needed for one output element.
+    double time_nsec = 0.0;
+    // How much slower the stage could be without becoming the bottleneck.
+    double slack_nsec = 0.0;
+    // The parallelism of the root and its maximum, or 0 if it has none.
+    double parallelism = 0.0;
+    double max_parallelism = 0.0;
+    // The number of elements the root buffers and the share of its buffer
+    // they fill, or -1 if the root has no buffer.
+    int64_t buffered_elements = 0;
+    double buffer_utilization = -1.0;
+  };
+
+  // The stages from slowest to fastest. The first one is the bottleneck.
+  std::vector<Stage> stages;
+  // The share of its time by which the bottleneck has to speed up for another
+  // stage to become the bottleneck. 1 if there is a single stage.
+  double bottleneck_slack = 0.0;
+  // Human-readable changes of the pipeline parameters that should speed it up.
+  std::vector<string> suggestions;
+
+  // Returns the name of the bottleneck, or an empty string if unknown.
+  string bottleneck() const { return stages.empty() ? "" : stages[0].name; }
+
+  string DebugString() const;
+};
+
+// Estimates the bottleneck of the pipeline rooted in `root`, e.g. a snapshot
+// of a model, from the processing times recorded so far.
+BottleneckReport AnalyzeBottleneck(std::shared_ptr<Node> root);
+
 // Abstract representation of a TensorFlow input pipeline that can be used
 // for collecting runtime information and optimizing performance. It collects
 // runtime information about execution of the input pipeline that is used to
@@ -686,8 +747,13 @@ class Model {
   // recomputation, the implementation caches the result.
   std::string DebugString();
 
+  // Returns the current bottleneck of the input pipeline.
+  BottleneckReport AnalyzeBottleneck() TF_LOCKS_EXCLUDED(mu_);
+
   // Uses the given algorithm and resource budgets to periodically perform the
-  // autotuning optimization.
+  // autotuning optimization. While the loop runs, the model is registered with
+  // `BudgetArbiter::Global()`, and each optimization only uses the model's
+  // share of the budgets.
   //
   // To terminate the execution of the optimization loop, the caller needs to
   // invoke `cancellation_mgr->StartCancel()`.
@@ -708,6 +774,11 @@ class Model {
                     ParameterGradients* gradients);
 
   // Removes the given node.
+  //
+  // The values of the tunable parameters of the node are retained, and
+  // assigned to the next node added at the same position in the model, so that
+  // an iterator re-created for a new epoch or input element starts from the
+  // values tuned for its predecessor.
   void RemoveNode(std::shared_ptr<Node> node) TF_LOCKS_EXCLUDED(mu_);
 
   // Produces a proto for this model.
@@ -727,9 +798,9 @@ class Model {
   static Status Load(const string& fname, std::unique_ptr<Model>* model,
                      OptimizationParams* optimization_params);
 
-  Node::NodeVector CollectNodes(std::shared_ptr<Node> root,
-                                TraversalOrder order,
-                                bool collect_node(const std::shared_ptr<Node>));
+  static Node::NodeVector CollectNodes(
+      std::shared_ptr<Node> root, TraversalOrder order,
+      bool collect_node(const std::shared_ptr<Node>));
 
  private:
   // Determines whether optimization should stop given total processing time,
@@ -748,6 +819,10 @@ class Model {
   // Flushes metrics recorded by the model.
   void FlushMetrics() TF_LOCKS_EXCLUDED(mu_);
 
+  // Returns `AnalyzeBottleneck().DebugString()`, recomputed at most every few
+  // seconds, for the bottleneck gauge.
+  std::string BottleneckDebugString() TF_LOCKS_EXCLUDED(bottleneck_mu_);
+
   // This optimization algorithm starts by setting all tunable parallelism
   // parameters to the minimum value. It then improves current parameters by
   // making a step in the direction opposite to the gradient of `OutputTime` and
@@ -783,6 +858,22 @@ class Model {
                               const OptimizationParams& optimization_params,
                               CancellationManager* cancellation_manager);
 
+  // This optimization algorithm starts from the current parameter values. It
+  // splits the pipeline into stages, each rooted in an asynchronous node (or
+  // the output node), and estimates the time a stage takes to produce the
+  // elements needed for one output element as its total processing time
+  // divided by its parallelism. It then repeatedly raises the parallelism of
+  // the stage that takes the longest, i.e. the bottleneck. When this would
+  // exceed the CPU budget, it instead moves parallelism to the bottleneck from
+  // a stage that can spare it without becoming the bottleneck itself. If the
+  // bottleneck stage has no parallelism to tune, its buffer size is raised by
+  // one instead. The optimization stops once the bottleneck cannot be
+  // improved, or takes no longer than the total processing time divided by
+  // the CPU budget, or when the RAM budget would be exceeded.
+  void OptimizeStageBased(std::shared_ptr<Node> snapshot,
+                          const OptimizationParams& optimization_params,
+                          CancellationManager* cancellation_manager);
+
   // Determines if we should stop the gradient descent optimization iterations
   // based on number of increasable parameters, CPU budget, RAM budget and
   // current resource usage.
@@ -813,6 +904,10 @@ class Model {
   condition_variable optimize_cond_var_;
   int64_t id_counter_ TF_GUARDED_BY(mu_) = 1;
   std::shared_ptr<Node> output_ TF_GUARDED_BY(mu_) = nullptr;
+  // The tunable parameter values of removed nodes, keyed by the names of the
+  // nodes on the path from the output to the removed node.
+  absl::flat_hash_map<string, absl::flat_hash_map<string, double>>
+      retained_parameter_values_ TF_GUARDED_BY(mu_);
 
   // Determines the time the optimization loop should wait between
   // running optimizations.
@@ -827,6 +922,61 @@ class Model {
   // Cached result of the `DebugString()` invocation used to implement rate
   // limitting of the computation.
   std::string cached_debug_string_ = "";
+  // Gauge cell that exports the bottleneck of the pipeline.
+  monitoring::GaugeCell<std::function<std::string()>>* bottleneck_gauge_cell_ =
+      nullptr;
+  mutex bottleneck_mu_;
+  // Time used to rate limit the recomputation of the exported bottleneck.
+  absl::Time bottleneck_cache_until_ TF_GUARDED_BY(bottleneck_mu_) =
+      absl::InfinitePast();
+  std::string cached_bottleneck_string_ TF_GUARDED_BY(bottleneck_mu_);
+};
+
+// Divides the CPU and RAM budgets among the models whose optimization loops
+// are running in the process, so that concurrent input pipelines do not each
+// autotune as if they owned the whole machine.
+//
+// Each model periodically reports its demand: the number of cores its input
+// pipeline kept busy and the number of bytes its buffers may hold. A budget is
+// divided by max-min fairness over the demands, with some headroom so that a
+// pipeline can grow into a larger share: models that need less than an equal
+// share get what they need, and the rest of the budget is split evenly among
+// all models. A model that is the only one registered gets the whole budget,
+// and so does a model that has not reported a demand yet among models that
+// have not either.
+class BudgetArbiter {
+ public:
+  BudgetArbiter() = default;
+
+  // Returns the arbiter shared by all models of the process.
+  static BudgetArbiter* Global();
+
+  void Register(const Model* model) TF_LOCKS_EXCLUDED(mu_);
+  void Unregister(const Model* model) TF_LOCKS_EXCLUDED(mu_);
+
+  // Records the number of cores and bytes that `model` currently uses.
+  void ReportDemand(const Model* model, double cpu_demand, int64_t ram_demand)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the shares of `cpu_budget` and `ram_budget` that `model` may use.
+  // The CPU share is at least one core.
+  void GetBudget(const Model* model, int64_t cpu_budget, int64_t ram_budget,
+                 int64_t* cpu_share, int64_t* ram_share) TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // The factor by which a reported demand is raised.
+  static constexpr double kDemandHeadroom = 1.25;
+
+  struct Demand {
+    // Negative until the model reports its demand.
+    double cpu = -1;
+    double ram = -1;
+  };
+
+  mutex mu_;
+  absl::flat_hash_map<const Model*, Demand> demands_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BudgetArbiter);
 };
 
 // Class to compute timing information for a model.
@@ -851,6 +1001,10 @@ class ModelTiming {
 
   explicit ModelTiming(std::shared_ptr<Model> model);
 
+  // Computes the timing of the subtree rooted in `root`, e.g. a snapshot of a
+  // model.
+  explicit ModelTiming(std::shared_ptr<Node> root);
+
   // Returns the timing data for `node`.
   const NodeTiming* GetTiming(Node* node) const;
 
@@ -878,7 +1032,7 @@ class ModelTiming {
   double ComputeNodePipelineWeight(const NodeTiming& output_timing,
                                    const Node* node, const Node* output);
 
-  std::shared_ptr<Model> model_;
+  std::shared_ptr<Node> root_;
 
   // Holds a mapping from node to its timing node.
   absl::flat_hash_map<const Node*, NodeTiming> timing_nodes_;
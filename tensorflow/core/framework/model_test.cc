@@ -1031,6 +1031,54 @@ TEST(SnapshotTest, Model) {
   }
 }
 
+TEST(RetainParameterValuesTest, Model) {
+  model::Model model;
+  auto mu = std::make_shared<mutex>();
+  auto cond_var = std::make_shared<condition_variable>();
+  auto make_state = [&mu, &cond_var]() {
+    return std::make_shared<SharedState>(model::kAutotune, mu, cond_var);
+  };
+  std::shared_ptr<Node> root;
+  model.AddNode(
+      [](model::Node::Args args) { return model::MakeUnknownNode(args); },
+      "unknown", nullptr, &root);
+
+  auto state = make_state();
+  auto factory = [&state](model::Node::Args args) {
+    return model::MakeAsyncKnownRatioNode(
+        std::move(args), 1,
+        {model::MakeParameter("parallelism", state, /*min=*/1, /*max=*/8)});
+  };
+  std::shared_ptr<Node> node;
+  model.AddNode(factory, "Prefix::ParallelMap", root, &node);
+  state->value = 6;
+  node->record_element();
+  model.RemoveNode(node);
+
+  // A node added at the same position starts from the retained value.
+  state = make_state();
+  model.AddNode(factory, "Prefix::ParallelMap", root, &node);
+  EXPECT_EQ(6, state->value);
+  EXPECT_EQ(6, node->parameter_value("parallelism"));
+  model.RemoveNode(node);
+
+  // Values are not retained for nodes that have not produced an element.
+  state = make_state();
+  model.AddNode(factory, "Prefix::ParallelMap", root, &node);
+  EXPECT_EQ(6, state->value);
+  state->value = 3;
+  model.RemoveNode(node);
+  state = make_state();
+  model.AddNode(factory, "Prefix::ParallelMap", root, &node);
+  EXPECT_EQ(6, state->value);
+
+  // Nodes at a different position are unaffected.
+  state = make_state();
+  std::shared_ptr<Node> other;
+  model.AddNode(factory, "Prefix::ParallelMap", node, &other);
+  EXPECT_EQ(model::kAutotune, state->value);
+}
+
 TEST(SaveModelTest, Model) {
   model::Model model;
   std::shared_ptr<Node> root = model::MakeUnknownNode({0, "unknown0", nullptr});
@@ -1302,7 +1350,139 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 }
 
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
-                         ::testing::Values(0, 1, 2, 3));
+                         ::testing::Values(0, 1, 2, 3, 4));
+
+class OptimizeStageBasedTest : public ::testing::Test {
+ protected:
+  static std::shared_ptr<SharedState> MakeState(int64_t value) {
+    return std::make_shared<SharedState>(value, std::make_shared<mutex>(),
+                                         std::make_shared<condition_variable>());
+  }
+
+  // Builds a pipeline of two parallel maps, where the input map takes 9 times
+  // as long per element as the output map.
+  void BuildModel(int64_t output_parallelism, int64_t input_parallelism) {
+    output_ = model::MakeAsyncKnownRatioNode(
+        {1, "output", nullptr}, 1,
+        {model::MakeParameter("parallelism", MakeState(output_parallelism),
+                              /*min=*/1, /*max=*/16)});
+    output_->record_element();
+    output_->add_processing_time(100);
+    input_ = model::MakeAsyncKnownRatioNode(
+        {2, "input", output_}, 1,
+        {model::MakeParameter("parallelism", MakeState(input_parallelism),
+                              /*min=*/1, /*max=*/16)});
+    input_->record_element();
+    input_->add_processing_time(900);
+    model_.AddNode([this](model::Node::Args args) { return output_; },
+                   "output", nullptr, &output_);
+    model_.AddNode([this](model::Node::Args args) { return input_; }, "input",
+                   output_, &input_);
+  }
+
+  model::Model model_;
+  std::shared_ptr<Node> output_;
+  std::shared_ptr<Node> input_;
+};
+
+TEST_F(OptimizeStageBasedTest, RaisesParallelismOfBottleneck) {
+  BuildModel(/*output_parallelism=*/1, /*input_parallelism=*/1);
+  CancellationManager cancellation_manager;
+  model_.Optimize(AutotuneAlgorithm::STAGE_BASED, /*cpu_budget=*/10,
+                  /*ram_budget=*/1 << 30, /*model_input_time=*/0,
+                  &cancellation_manager);
+  // The input stage stops being the bottleneck once it uses 9 threads, and
+  // the pipeline then uses all of the CPU budget.
+  EXPECT_EQ(output_->parameter_value("parallelism"), 1);
+  EXPECT_EQ(input_->parameter_value("parallelism"), 9);
+}
+
+TEST_F(OptimizeStageBasedTest, MovesParallelismWhenOversubscribed) {
+  BuildModel(/*output_parallelism=*/8, /*input_parallelism=*/2);
+  CancellationManager cancellation_manager;
+  model_.Optimize(AutotuneAlgorithm::STAGE_BASED, /*cpu_budget=*/4,
+                  /*ram_budget=*/1 << 30, /*model_input_time=*/0,
+                  &cancellation_manager);
+  EXPECT_EQ(output_->parameter_value("parallelism"), 1);
+  EXPECT_EQ(input_->parameter_value("parallelism"), 3);
+}
+
+TEST_F(OptimizeStageBasedTest, ReportsBottleneck) {
+  BuildModel(/*output_parallelism=*/1, /*input_parallelism=*/1);
+  BottleneckReport report = model_.AnalyzeBottleneck();
+  ASSERT_EQ(report.stages.size(), 2);
+  EXPECT_EQ(report.bottleneck(), "input(id:2)");
+  EXPECT_EQ(report.stages[0].slowest_node, "input(id:2)");
+  EXPECT_DOUBLE_EQ(report.stages[0].time_nsec, 900);
+  EXPECT_DOUBLE_EQ(report.stages[1].slack_nsec, 800);
+  EXPECT_NEAR(report.bottleneck_slack, 8.0 / 9, 1e-6);
+  ASSERT_FALSE(report.suggestions.empty());
+  EXPECT_NE(report.suggestions[0].find("from 1 to 9"), string::npos);
+}
+
+class BudgetArbiterTest : public ::testing::Test {
+ protected:
+  void ExpectBudget(const Model* model, int64_t expected_cpu,
+                    int64_t expected_ram) {
+    int64_t cpu_share;
+    int64_t ram_share;
+    arbiter_.GetBudget(model, /*cpu_budget=*/16, /*ram_budget=*/1000,
+                       &cpu_share, &ram_share);
+    EXPECT_EQ(cpu_share, expected_cpu);
+    EXPECT_EQ(ram_share, expected_ram);
+  }
+
+  BudgetArbiter arbiter_;
+  Model a_;
+  Model b_;
+};
+
+TEST_F(BudgetArbiterTest, SingleModelGetsWholeBudget) {
+  arbiter_.Register(&a_);
+  arbiter_.ReportDemand(&a_, /*cpu_demand=*/2, /*ram_demand=*/100);
+  ExpectBudget(&a_, 16, 1000);
+}
+
+TEST_F(BudgetArbiterTest, ModelsWithoutDemandSplitEvenly) {
+  arbiter_.Register(&a_);
+  arbiter_.Register(&b_);
+  ExpectBudget(&a_, 8, 500);
+  ExpectBudget(&b_, 8, 500);
+}
+
+TEST_F(BudgetArbiterTest, SmallDemandLeavesRestToOthers) {
+  arbiter_.Register(&a_);
+  arbiter_.Register(&b_);
+  arbiter_.ReportDemand(&a_, /*cpu_demand=*/4, /*ram_demand=*/100);
+  ExpectBudget(&a_, 5, 125);
+  ExpectBudget(&b_, 11, 875);
+}
+
+TEST_F(BudgetArbiterTest, LargeDemandsSplitEvenly) {
+  arbiter_.Register(&a_);
+  arbiter_.Register(&b_);
+  arbiter_.ReportDemand(&a_, /*cpu_demand=*/12, /*ram_demand=*/800);
+  arbiter_.ReportDemand(&b_, /*cpu_demand=*/20, /*ram_demand=*/2000);
+  ExpectBudget(&a_, 8, 500);
+  ExpectBudget(&b_, 8, 500);
+}
+
+TEST_F(BudgetArbiterTest, LeftoverIsSplitEvenly) {
+  arbiter_.Register(&a_);
+  arbiter_.Register(&b_);
+  arbiter_.ReportDemand(&a_, /*cpu_demand=*/2, /*ram_demand=*/100);
+  arbiter_.ReportDemand(&b_, /*cpu_demand=*/4, /*ram_demand=*/200);
+  ExpectBudget(&a_, 7, 437);
+  ExpectBudget(&b_, 9, 562);
+}
+
+TEST_F(BudgetArbiterTest, UnregisteredModelReleasesItsShare) {
+  arbiter_.Register(&a_);
+  arbiter_.Register(&b_);
+  ExpectBudget(&a_, 8, 500);
+  arbiter_.Unregister(&b_);
+  ExpectBudget(&a_, 16, 1000);
+}
 
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
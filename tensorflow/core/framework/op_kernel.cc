@@ -685,9 +685,8 @@ Status OpKernelContext::allocate_output(StringPiece name,
 }
 
 Status OpKernelContext::allocate_tensor(
-    DataType type, const TensorShape& shape, Tensor* out_tensor,
-    AllocatorAttributes attr, const AllocationAttributes& allocation_attr) {
-  Allocator* a = get_allocator(attr);
+    Allocator* a, DataType type, const TensorShape& shape, Tensor* out_tensor,
+    const AllocationAttributes& allocation_attr) {
   Tensor new_tensor(
       a, type, shape,
       AllocationAttributes(
@@ -704,6 +703,10 @@ Status OpKernelContext::allocate_tensor(
     LogMemory::RecordTensorAllocation(params_->op_kernel->name(),
                                       params_->step_id, new_tensor);
   }
+  if (params_->allocated_bytes != nullptr) {
+    params_->allocated_bytes->fetch_add(new_tensor.TotalBytes(),
+                                        std::memory_order_relaxed);
+  }
   *out_tensor = std::move(new_tensor);
   return Status::OK();
 }
@@ -743,10 +746,20 @@ Status OpKernelContext::allocate_output(int index, const TensorShape& shape,
     }
   }
   profiler::ScopedMemoryDebugAnnotation op_annotation(
-      op_kernel().name_view().data(), step_id(), "output", type,
+      op_kernel().name_view().data(), step_id(), "output", type, index,
       [&shape]() { return shape.DebugString(); });
   auto output_tensor = MakeUnique<Tensor>();
-  Status s = allocate_tensor(type, shape, output_tensor.get(), attr);
+  // Outputs may come from a static memory plan, except when allocations are
+  // being tracked, which requires the wrapped device allocator.
+  Allocator* planned_allocator =
+      (params_->planned_output_allocators != nullptr &&
+       attr.value == 0 && attr.scope_id == 0 && !track_allocations())
+          ? params_->planned_output_allocators[index]
+          : nullptr;
+  Status s = planned_allocator != nullptr
+                 ? allocate_tensor(planned_allocator, type, shape,
+                                   output_tensor.get(), AllocationAttributes())
+                 : allocate_tensor(type, shape, output_tensor.get(), attr);
   if (s.ok()) {
     outputs_[index] = TensorValue(output_tensor.release());
     *output = outputs_[index].tensor;
@@ -776,8 +789,13 @@ Status OpKernelContext::allocate_temp(
   profiler::ScopedMemoryDebugAnnotation op_annotation(
       op_kernel().name_view().data(), step_id(), "temp", type,
       [&shape]() { return shape.DebugString(); });
-  Status s =
-      allocate_tensor(type, shape, out_temp, allocator_attr, allocation_attr);
+  // Temporaries may come from a step-scoped arena, except when allocations are
+  // being tracked, which requires the wrapped device allocator.
+  Allocator* a =
+      (params_->use_step_allocator && !track_allocations())
+          ? params_->device->GetStepAllocator(allocator_attr, step_id())
+          : get_allocator(allocator_attr);
+  Status s = allocate_tensor(a, type, shape, out_temp, allocation_attr);
   if (track_allocations() && s.ok() && out_temp->TotalBytes() > 0) {
     Allocator* a = get_allocator(allocator_attr);
     if (a->TracksAllocationSizes()) {
@@ -868,7 +886,7 @@ bool OpKernelContext::maybe_set_output_by_allocate_and_copy(
             << output_alloc_attr(index).scope_id;
     profiler::ScopedMemoryDebugAnnotation op_annotation(
         op_kernel().name_view().data(), step_id(), "output", tensor.dtype(),
-        [&tensor]() { return tensor.shape().DebugString(); });
+        index, [&tensor]() { return tensor.shape().DebugString(); });
     auto new_tensor = MakeUnique<Tensor>();
     Status s = allocate_tensor(tensor.dtype(), tensor.shape(), new_tensor.get(),
                                output_alloc_attr(index));
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_OP_KERNEL_H_
 #define TENSORFLOW_CORE_FRAMEWORK_OP_KERNEL_H_
 
+#include <atomic>
 #include <functional>
 #include <unordered_set>
 #include <utility>
@@ -570,6 +571,16 @@ class OpKernelContext {
     // The deadline for the session to complete by. Empty if unspecified.
     absl::optional<absl::Time> deadline;
 
+    // Whether batching ops batch their inputs as low-priority work.
+    bool low_priority_batching = false;
+
+    // Whether RestoreV2 ops memory-map large restored tensors.
+    bool memmap_restored_tensors = false;
+
+    // If not null, the bytes of the tensors allocated by the kernel are added
+    // to it.
+    std::atomic<int64_t>* allocated_bytes = nullptr;
+
     // The op kernel being computed.
     OpKernel* op_kernel = nullptr;
 
@@ -608,6 +619,11 @@ class OpKernelContext {
     // Array indexed by output number for this node
     const AllocatorAttributes* output_attr_array = nullptr;
 
+    // If not null, an array indexed by output number for this node. A
+    // non-null entry is used by allocate_output() instead of the device
+    // allocator when the output is allocated with default attributes.
+    Allocator* const* planned_output_allocators = nullptr;
+
     // Shared resources accessible by this op kernel invocation.
     ResourceMgr* resource_manager = nullptr;
 
@@ -659,6 +675,10 @@ class OpKernelContext {
     StepStatsCollectorInterface* stats_collector = nullptr;
     GraphCollector* graph_collector = nullptr;
     bool run_all_kernels_inline = false;
+
+    // If true, allocate_temp() allocates from device->GetStepAllocator().
+    bool use_step_allocator = false;
+
     const std::string* executor_type = nullptr;
 
     // TensorSliceReaderCache support.
@@ -699,6 +719,16 @@ class OpKernelContext {
   // RunOptions.
   absl::optional<absl::Time> deadline() const { return params_->deadline; }
 
+  // Whether batching ops batch their inputs as low-priority work, as set in
+  // RunOptions.
+  bool low_priority_batching() const { return params_->low_priority_batching; }
+
+  // Whether RestoreV2 ops memory-map large restored tensors, as set in
+  // RunOptions.
+  bool memmap_restored_tensors() const {
+    return params_->memmap_restored_tensors;
+  }
+
   const OpKernel& op_kernel() const { return *params_->op_kernel; }
 
   // Stack trace of where the op was defined (if defined in eager mode).
@@ -1248,6 +1278,13 @@ class OpKernelContext {
 
   Status allocate_tensor(DataType type, const TensorShape& shape,
                          Tensor* out_tensor, AllocatorAttributes allocator_attr,
+                         const AllocationAttributes& allocation_attr) {
+    return allocate_tensor(get_allocator(allocator_attr), type, shape,
+                           out_tensor, allocation_attr);
+  }
+
+  Status allocate_tensor(Allocator* a, DataType type, const TensorShape& shape,
+                         Tensor* out_tensor,
                          const AllocationAttributes& allocation_attr);
 
   // Helpers for `set_output()`.
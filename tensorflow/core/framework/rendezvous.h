@@ -181,7 +181,10 @@ class Rendezvous : public RendezvousInterface, public core::RefCounted {
 // Returns a Rendezvous instance that is limited to use only by
 // producers and consumers in the local process.  The caller assumes
 // ownership of one Ref() on the returned object.
-Rendezvous* NewLocalRendezvous();
+//
+// `num_shards` is the number of independently locked tables over which the
+// pending sends and receives are partitioned (see LocalRendezvous).
+Rendezvous* NewLocalRendezvous(int num_shards = 1);
 
 }  // end namespace tensorflow
 
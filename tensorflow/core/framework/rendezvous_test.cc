@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -65,10 +66,11 @@ TEST(RendezvousTest, Key) {
       Rendezvous::ParseKey(strings::StrCat(key, ";", key), &parsed).ok());
 }
 
-class LocalRendezvousTest : public ::testing::Test {
+// The parameter is the number of shards of the rendezvous table.
+class LocalRendezvousTest : public ::testing::TestWithParam<int> {
  public:
   LocalRendezvousTest() : threads_(Env::Default(), "test", 16) {
-    rendez_ = NewLocalRendezvous();
+    rendez_ = NewLocalRendezvous(GetParam());
   }
 
   ~LocalRendezvousTest() override { rendez_->Unref(); }
@@ -116,7 +118,7 @@ const Rendezvous::ParsedKey& KeyBar() {
   return *key;
 }
 
-TEST_F(LocalRendezvousTest, SendRecv) {
+TEST_P(LocalRendezvousTest, SendRecv) {
   Rendezvous::Args args;
   TF_ASSERT_OK(rendez_->Send(KeyFoo(), args, V("hello"), false));
   Tensor val(DT_STRING);
@@ -125,7 +127,7 @@ TEST_F(LocalRendezvousTest, SendRecv) {
   EXPECT_EQ("hello", V(val));
 }
 
-TEST_F(LocalRendezvousTest, RecvSend) {
+TEST_P(LocalRendezvousTest, RecvSend) {
   SchedClosure([this]() {
     Env::Default()->SleepForMicroseconds(10000);
     Rendezvous::Args args;
@@ -138,7 +140,7 @@ TEST_F(LocalRendezvousTest, RecvSend) {
   EXPECT_EQ("hello", V(val));
 }
 
-TEST_F(LocalRendezvousTest, PingPong) {
+TEST_P(LocalRendezvousTest, PingPong) {
   SchedClosure([this]() {
     Tensor t(DT_STRING);
     bool is_dead = false;
@@ -155,7 +157,7 @@ TEST_F(LocalRendezvousTest, PingPong) {
   EXPECT_EQ("secret msg", V(val));
 }
 
-TEST_F(LocalRendezvousTest, CancelBeforeRecv) {
+TEST_P(LocalRendezvousTest, CancelBeforeRecv) {
   auto* cm = new CancellationManager();
   Tensor val(DT_STRING);
   bool is_dead = false;
@@ -169,7 +171,7 @@ TEST_F(LocalRendezvousTest, CancelBeforeRecv) {
   delete cm;
 }
 
-TEST_F(LocalRendezvousTest, CancelAfterRecv) {
+TEST_P(LocalRendezvousTest, CancelAfterRecv) {
   auto* cm = new CancellationManager();
   Notification n;
   SchedClosure([cm, &n]() {
@@ -189,7 +191,7 @@ TEST_F(LocalRendezvousTest, CancelAfterRecv) {
   delete cm;
 }
 
-TEST_F(LocalRendezvousTest, CancelEmptyQueue) {
+TEST_P(LocalRendezvousTest, CancelEmptyQueue) {
   auto* cm = new CancellationManager();
   Notification n;
   SchedClosure([this, cm, &n]() {
@@ -209,7 +211,7 @@ TEST_F(LocalRendezvousTest, CancelEmptyQueue) {
   delete cm;
 }
 
-TEST_F(LocalRendezvousTest, CancelMultiple) {
+TEST_P(LocalRendezvousTest, CancelMultiple) {
   auto* cm = new CancellationManager();
   SchedClosure([this, cm]() {
     Env::Default()->SleepForMicroseconds(10000);
@@ -284,7 +286,7 @@ struct BlockingState {
   Notification done;
 };
 
-TEST_F(LocalRendezvousTest, RandomSendRecv) {
+TEST_P(LocalRendezvousTest, RandomSendRecv) {
   // We are scheduling 2*N closures in the this->threads_, which is
   // configured with only 16 threads. Furthermore, because the
   // threadpool may execute the closures in an arbitrary order, we
@@ -337,7 +339,7 @@ void RandomSleep() {
   }
 }
 
-TEST_F(LocalRendezvousTest, MultiSends) {
+TEST_P(LocalRendezvousTest, MultiSends) {
   static const int N = 100;
   const auto& key_foo = KeyFoo();
   Rendezvous::Args args;
@@ -355,7 +357,7 @@ TEST_F(LocalRendezvousTest, MultiSends) {
   }
 }
 
-TEST_F(LocalRendezvousTest, RecvAbort) {
+TEST_P(LocalRendezvousTest, RecvAbort) {
   rendez_->Ref();
   SchedClosure([this]() {
     rendez_->StartAbort(errors::Aborted(""));  // abort
@@ -370,7 +372,7 @@ TEST_F(LocalRendezvousTest, RecvAbort) {
 
 // Similar to RecvAbort. But this test case ensures the main thread
 // Recv() call happens after StartAbort().
-TEST_F(LocalRendezvousTest, RecvSleepAbort) {
+TEST_P(LocalRendezvousTest, RecvSleepAbort) {
   rendez_->Ref();
   SchedClosure([this]() {
     Env::Default()->SleepForMicroseconds(1000000);
@@ -384,7 +386,7 @@ TEST_F(LocalRendezvousTest, RecvSleepAbort) {
   EXPECT_TRUE(errors::IsAborted(status));
 }
 
-TEST_F(LocalRendezvousTest, AbortThenRecvOrSend) {
+TEST_P(LocalRendezvousTest, AbortThenRecvOrSend) {
   rendez_->StartAbort(errors::Aborted(""));
   Tensor val(DT_STRING);
   bool val_dead = false;
@@ -410,7 +412,7 @@ class DummyDeviceContext : public DeviceContext {
   const int stream_id_;
 };
 
-TEST_F(LocalRendezvousTest, TransferDummyDeviceContext) {
+TEST_P(LocalRendezvousTest, TransferDummyDeviceContext) {
   Rendezvous::Args args;
   args.device_context = new DummyDeviceContext(123);
 
@@ -434,6 +436,9 @@ TEST_F(LocalRendezvousTest, TransferDummyDeviceContext) {
   args1.device_context->Unref();
 }
 
+INSTANTIATE_TEST_SUITE_P(Shards, LocalRendezvousTest,
+                         ::testing::Values(1, 16));
+
 void BM_SendRecv(::testing::benchmark::State& state) {
   Rendezvous* rendez = NewLocalRendezvous();
   Tensor orig = V("val");
@@ -518,5 +523,48 @@ void BM_PingPong(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_PingPong)->Arg(100)->Arg(200)->Arg(300);
 
+// Each of `num_threads` threads repeatedly sends and receives on its own
+// keys, so that the only contention is on the rendezvous table itself.
+void BM_ConcurrentSendRecv(::testing::benchmark::State& state) {
+  const int num_threads = state.range(0);
+  const int num_shards = state.range(1);
+  constexpr int kPairsPerThread = 1000;
+  std::vector<Rendezvous::ParsedKey> keys;
+  for (int i = 0; i < num_threads; ++i) {
+    keys.push_back(MakeKey(strings::StrCat("key", i)));
+  }
+  thread::ThreadPool pool(Env::Default(), "test", num_threads);
+
+  for (auto s : state) {
+    Rendezvous* rendez = NewLocalRendezvous(num_shards);
+    BlockingCounter counter(num_threads);
+    for (int i = 0; i < num_threads; ++i) {
+      pool.Schedule([rendez, &key = keys[i], &counter]() {
+        Tensor orig = V("val");
+        Tensor val;
+        bool is_dead = false;
+        Rendezvous::Args args;
+        for (int j = 0; j < kPairsPerThread; ++j) {
+          TF_CHECK_OK(rendez->Send(key, args, orig, is_dead));
+          TF_CHECK_OK(rendez->Recv(key, args, &val, &is_dead));
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    rendez->Unref();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(num_threads) *
+                          kPairsPerThread * state.iterations());
+}
+BENCHMARK(BM_ConcurrentSendRecv)
+    ->UseRealTime()
+    ->ArgPair(1, 1)
+    ->ArgPair(4, 1)
+    ->ArgPair(16, 1)
+    ->ArgPair(1, 16)
+    ->ArgPair(4, 16)
+    ->ArgPair(16, 16);
+
 }  // namespace
 }  // namespace tensorflow
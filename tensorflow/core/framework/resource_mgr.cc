@@ -30,6 +30,37 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace internal {
+
+ReaderShardedMutex::ReaderShardedMutex() : shards_(new Shard[kNumShards]) {}
+
+ReaderShardedMutex::Shard& ReaderShardedMutex::ThreadShard(Shard* shards) {
+  // Threads are assigned shards round robin when they first take a lock.
+  static std::atomic<uint32> next_shard{0};
+  thread_local const uint32 shard =
+      next_shard.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+  return shards[shard];
+}
+
+void ReaderShardedMutex::lock() TF_NO_THREAD_SAFETY_ANALYSIS {
+  // Always in the same order, so that writers do not deadlock.
+  for (int i = 0; i < kNumShards; ++i) shards_[i].mu.lock();
+}
+
+void ReaderShardedMutex::unlock() TF_NO_THREAD_SAFETY_ANALYSIS {
+  for (int i = kNumShards - 1; i >= 0; --i) shards_[i].mu.unlock();
+}
+
+void ReaderShardedMutex::lock_shared() TF_NO_THREAD_SAFETY_ANALYSIS {
+  ThreadShard(shards_.get()).mu.lock_shared();
+}
+
+void ReaderShardedMutex::unlock_shared() TF_NO_THREAD_SAFETY_ANALYSIS {
+  ThreadShard(shards_.get()).mu.unlock_shared();
+}
+
+}  // namespace internal
+
 ResourceHandle MakeResourceHandle(
     const string& container, const string& name, const DeviceBase& device,
     const TypeIndex& type_index,
@@ -140,7 +171,7 @@ void ResourceMgr::Clear() {
   // in case any of the destructors access the resource manager.
   absl::flat_hash_map<string, Container*> tmp_containers;
   {
-    mutex_lock l(mu_);
+    internal::ReaderShardedMutex::WriterLock l(mu_);
     tmp_containers = std::move(containers_);
   }
   for (const auto& p : tmp_containers) {
@@ -150,7 +181,7 @@ void ResourceMgr::Clear() {
 }
 
 string ResourceMgr::DebugString() const {
-  mutex_lock l(mu_);
+  internal::ReaderShardedMutex::WriterLock l(mu_);
   struct Line {
     const string* container;
     const string type;
@@ -201,7 +232,7 @@ Status ResourceMgr::DoCreate(const string& container_name, TypeIndex type,
     resource_and_name.resource = core::RefCountPtr<ResourceBase>(resource);
   } else {
     auto cleanup_fn = [this, container, type, borrowed_name]() {
-      mutex_lock l(mu_);
+      internal::ReaderShardedMutex::WriterLock l(mu_);
       auto iter = container->find({type.hash_code(), borrowed_name});
       if (iter != container->end()) {
         container->erase(iter);
@@ -225,7 +256,7 @@ Status ResourceMgr::DoCreate(const string& container_name, TypeIndex type,
 
 Status ResourceMgr::Lookup(const ResourceHandle& handle,
                            ResourceBase** resource) const {
-  tf_shared_lock l(mu_);
+  internal::ReaderShardedMutex::ReaderLock l(mu_);
   return DoLookup(handle.container(), handle.hash_code(),
                   /*type_name=*/"ResourceBase", handle.name(), resource);
 }
@@ -265,7 +296,7 @@ Status ResourceMgr::PopResourceAndName(const string& container,
                                        const string& resource_name,
                                        const string& type_name,
                                        ResourceAndName& resource_and_name) {
-  mutex_lock l(mu_);
+  internal::ReaderShardedMutex::WriterLock l(mu_);
   Container* b = gtl::FindPtrOrNull(containers_, container);
   if (b == nullptr) {
     return errors::NotFound("Container ", container, " does not exist.");
@@ -310,7 +341,7 @@ Status ResourceMgr::Delete(const ResourceHandle& handle) {
 
 Status ResourceMgr::Cleanup(const string& container) {
   {
-    tf_shared_lock l(mu_);
+    internal::ReaderShardedMutex::ReaderLock l(mu_);
     if (!gtl::FindOrNull(containers_, container)) {
       // Nothing to cleanup.
       return Status::OK();
@@ -318,7 +349,7 @@ Status ResourceMgr::Cleanup(const string& container) {
   }
   Container* b = nullptr;
   {
-    mutex_lock l(mu_);
+    internal::ReaderShardedMutex::WriterLock l(mu_);
     auto iter = containers_.find(container);
     if (iter == containers_.end()) {
       // Nothing to cleanup, it's OK (concurrent cleanup).
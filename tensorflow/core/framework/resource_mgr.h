@@ -145,6 +145,67 @@ class ScopedStepContainer {
   mutable std::atomic<bool> dirty_ TF_GUARDED_BY(mu_);
 };
 
+namespace internal {
+
+// A readers-writer mutex for data that is read far more often than it is
+// written, such as the resources of a ResourceMgr, which every op that uses a
+// variable looks up. A reader takes only one of several shared locks, picked
+// by its thread, so that concurrent readers do not all update the same lock
+// word. A writer takes all of them.
+class TF_LOCKABLE ReaderShardedMutex {
+ public:
+  ReaderShardedMutex();
+
+  void lock() TF_EXCLUSIVE_LOCK_FUNCTION();
+  void unlock() TF_UNLOCK_FUNCTION();
+
+  void lock_shared() TF_SHARED_LOCK_FUNCTION();
+  void unlock_shared() TF_UNLOCK_FUNCTION();
+
+  class TF_SCOPED_LOCKABLE WriterLock {
+   public:
+    explicit WriterLock(ReaderShardedMutex& mu) TF_EXCLUSIVE_LOCK_FUNCTION(mu)
+        : mu_(mu) {
+      mu_.lock();
+    }
+    ~WriterLock() TF_UNLOCK_FUNCTION() { mu_.unlock(); }
+
+   private:
+    ReaderShardedMutex& mu_;
+    TF_DISALLOW_COPY_AND_ASSIGN(WriterLock);
+  };
+
+  class TF_SCOPED_LOCKABLE ReaderLock {
+   public:
+    explicit ReaderLock(ReaderShardedMutex& mu) TF_SHARED_LOCK_FUNCTION(mu)
+        : mu_(mu) {
+      mu_.lock_shared();
+    }
+    ~ReaderLock() TF_UNLOCK_FUNCTION() { mu_.unlock_shared(); }
+
+   private:
+    ReaderShardedMutex& mu_;
+    TF_DISALLOW_COPY_AND_ASSIGN(ReaderLock);
+  };
+
+ private:
+  static constexpr int kNumShards = 16;
+
+  // Each shard has a cache line of its own.
+  struct alignas(64) Shard {
+    mutex mu;
+  };
+
+  // Returns the shard of the calling thread.
+  static Shard& ThreadShard(Shard* shards);
+
+  const std::unique_ptr<Shard[]> shards_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ReaderShardedMutex);
+};
+
+}  // namespace internal
+
 class ResourceMgr {
  public:
   ResourceMgr();
@@ -272,7 +333,7 @@ class ResourceMgr {
       Container;
 
   const std::string default_container_;
-  mutable mutex mu_;
+  mutable internal::ReaderShardedMutex mu_;
   absl::flat_hash_map<string, Container*> containers_ TF_GUARDED_BY(mu_);
 
   template <typename T, bool use_dynamic_cast = false>
@@ -632,7 +693,7 @@ Status ResourceMgr::Create(const std::string& container,
                            const std::string& name, T* resource) {
   CheckDeriveFromResourceBase<T>();
   CHECK(resource != nullptr);
-  mutex_lock l(mu_);
+  internal::ReaderShardedMutex::WriterLock l(mu_);
   return DoCreate(container, TypeIndex::Make<T>(), name, resource,
                   /* owns_resource */ true);
 }
@@ -641,7 +702,7 @@ template <typename T>
 Status ResourceMgr::CreateUnowned(const std::string& container,
                                   const std::string& name, T* resource) {
   CheckDeriveFromResourceBase<T>();
-  mutex_lock l(mu_);
+  internal::ReaderShardedMutex::WriterLock l(mu_);
   return DoCreate(container, TypeIndex::Make<T>(), name, resource,
                   /* owns_resource */ false);
 }
@@ -650,7 +711,7 @@ template <typename T, bool use_dynamic_cast>
 Status ResourceMgr::Lookup(const std::string& container,
                            const std::string& name, T** resource) const {
   CheckDeriveFromResourceBase<T>();
-  tf_shared_lock l(mu_);
+  internal::ReaderShardedMutex::ReaderLock l(mu_);
   return LookupInternal<T, use_dynamic_cast>(container, name, resource);
 }
 
@@ -660,7 +721,7 @@ Status ResourceMgr::LookupMany(
         containers_and_names,
     std::vector<std::unique_ptr<T, core::RefCountDeleter>>* resources) const {
   CheckDeriveFromResourceBase<T>();
-  tf_shared_lock l(mu_);
+  internal::ReaderShardedMutex::ReaderLock l(mu_);
   resources->resize(containers_and_names.size());
   for (size_t i = 0; i < containers_and_names.size(); ++i) {
     T* resource;
@@ -707,11 +768,11 @@ Status ResourceMgr::LookupOrCreate(const std::string& container,
   *resource = nullptr;
   Status s;
   {
-    tf_shared_lock l(mu_);
+    internal::ReaderShardedMutex::ReaderLock l(mu_);
     s = LookupInternal<T, use_dynamic_cast>(container, name, resource);
     if (s.ok()) return s;
   }
-  mutex_lock l(mu_);
+  internal::ReaderShardedMutex::WriterLock l(mu_);
   s = LookupInternal<T, use_dynamic_cast>(container, name, resource);
   if (s.ok()) return s;
   TF_RETURN_IF_ERROR(creator(resource));
@@ -248,6 +248,38 @@ TEST(ResourceMgrTest, CreateOrLookupRaceCondition) {
   EXPECT_EQ(1, atomic_int);
 }
 
+TEST(ResourceMgrTest, ConcurrentLookupsAndDeletes) {
+  ResourceMgr rm;
+  TF_CHECK_OK(rm.Create("container", "stable", new Resource("stable")));
+  {
+    thread::ThreadPool threads(Env::Default(), "lookups", 8);
+    // Readers on different lock shards see every resource that exists.
+    for (int i = 0; i < 7; ++i) {
+      threads.Schedule([&rm] {
+        for (int j = 0; j < 1000; ++j) {
+          Resource* r;
+          TF_CHECK_OK(rm.Lookup("container", "stable", &r));
+          EXPECT_EQ("R/stable", r->DebugString());
+          r->Unref();
+          if (rm.Lookup("container", "churn", &r).ok()) {
+            EXPECT_EQ("R/churn", r->DebugString());
+            r->Unref();
+          }
+        }
+      });
+    }
+    // A writer excludes all of them.
+    threads.Schedule([&rm] {
+      for (int j = 0; j < 1000; ++j) {
+        TF_CHECK_OK(rm.Create("container", "churn", new Resource("churn")));
+        TF_CHECK_OK(rm.Delete<Resource>("container", "churn"));
+      }
+    });
+  }
+  Resource* r;
+  EXPECT_FALSE(rm.Lookup("container", "churn", &r).ok());
+}
+
 Status ComputePolicy(const string& attr_container,
                      const string& attr_shared_name,
                      bool use_node_name_as_default, string* result) {
@@ -23,6 +23,7 @@ limitations under the License.
 #include <memory>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/run_handler_util.h"
 #include "tensorflow/core/lib/core/threadpool_interface.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -77,6 +78,7 @@ RunHandlerEnvironment::Task RunHandlerEnvironment::CreateTask(
           std::move(f),
           Context(ContextKind::kThread),
           id,
+          /*enqueue_time_us=*/0,
       }),
   };
 }
@@ -131,6 +133,9 @@ ThreadWorkSource::ThreadWorkSource()
       blocking_inflight_(0),
       non_blocking_inflight_(0),
       traceme_id_(0),
+      num_queued_tasks_(0),
+      total_queueing_delay_us_(0),
+      max_queueing_delay_us_(0),
       version_(0),
       sub_thread_pool_waiter_(nullptr) {
   queue_waiters_.next = &queue_waiters_;
@@ -302,12 +307,40 @@ unsigned ThreadWorkSource::NonBlockingWorkShardingFactor() {
   return non_blocking_work_sharding_factor_;
 }
 
+void ThreadWorkSource::RecordQueueingDelay(uint64 delay_us) {
+  num_queued_tasks_.fetch_add(1, std::memory_order_relaxed);
+  total_queueing_delay_us_.fetch_add(delay_us, std::memory_order_relaxed);
+  uint64 max_delay_us = max_queueing_delay_us_.load(std::memory_order_relaxed);
+  while (delay_us > max_delay_us &&
+         !max_queueing_delay_us_.compare_exchange_weak(
+             max_delay_us, delay_us, std::memory_order_relaxed)) {
+  }
+}
+
+uint64 ThreadWorkSource::MeanQueueingDelayMicros() {
+  const uint64 num_tasks = num_queued_tasks_.load(std::memory_order_relaxed);
+  if (num_tasks == 0) return 0;
+  return total_queueing_delay_us_.load(std::memory_order_relaxed) / num_tasks;
+}
+
+uint64 ThreadWorkSource::MaxQueueingDelayMicros() {
+  return max_queueing_delay_us_.load(std::memory_order_relaxed);
+}
+
+void ThreadWorkSource::ResetQueueingDelay() {
+  num_queued_tasks_ = 0;
+  total_queueing_delay_us_ = 0;
+  max_queueing_delay_us_ = 0;
+}
+
 std::string ThreadWorkSource::ToString() {
   return strings::StrCat("traceme_id = ", GetTracemeId(),
                          ", inter queue size = ", TaskQueueSize(true),
                          ", inter inflight = ", GetInflightTaskCount(true),
                          ", intra queue size = ", TaskQueueSize(false),
-                         ", intra inflight = ", GetInflightTaskCount(false));
+                         ", intra inflight = ", GetInflightTaskCount(false),
+                         ", mean inter queueing delay = ",
+                         MeanQueueingDelayMicros(), " us");
 }
 
 RunHandlerThreadPool::RunHandlerThreadPool(
@@ -392,6 +425,9 @@ void RunHandlerThreadPool::AddWorkToQueue(ThreadWorkSource* tws,
                                           bool is_blocking,
                                           std::function<void()> fn) {
   Task t = env_.CreateTask(std::move(fn));
+  if (is_blocking) {
+    t.f->enqueue_time_us = EnvTime::NowMicros();
+  }
   t = tws->EnqueueTask(std::move(t), is_blocking);
   if (t.f) {
     VLOG(3) << "Running " << (is_blocking ? "inter" : "intra") << " work for "
@@ -632,6 +668,11 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
           profiler::TraceMeLevel::kInfo);
       VLOG(2) << "Running " << (task_from_blocking_queue ? "inter" : "intra")
               << " work from " << tws->GetTracemeId();
+      if (task_from_blocking_queue && t.f->enqueue_time_us > 0) {
+        const uint64 now = EnvTime::NowMicros();
+        tws->RecordQueueingDelay(
+            now > t.f->enqueue_time_us ? now - t.f->enqueue_time_us : 0);
+      }
       tws->IncrementInflightTaskCount(task_from_blocking_queue);
       env_.ExecuteTask(t);
       tws->DecrementInflightTaskCount(task_from_blocking_queue);
@@ -749,6 +790,14 @@ class RunHandler::Impl {
 
   int64_t priority() { return options_.priority(); }
 
+  // Returns the priority of the request aged by the time it has been running:
+  // it grows by one every "priority_aging_ms" milliseconds.
+  double AgedPriority(uint64 now_us, int64_t priority_aging_ms) {
+    const uint64 elapsed_us =
+        now_us > start_time_us_ ? now_us - start_time_us_ : 0;
+    return priority() + elapsed_us / (1000.0 * priority_aging_ms);
+  }
+
  private:
   class ThreadPoolInterfaceWrapper : public thread::ThreadPoolInterface {
    public:
@@ -779,6 +828,8 @@ class RunHandlerPool::Impl {
   explicit Impl(int num_inter_op_threads, int num_intra_op_threads)
       : max_handlers_(static_cast<int32>(ParamFromEnvWithDefault(
             "TF_RUN_HANDLER_MAX_CONCURRENT_HANDLERS", kMaxConcurrentHandlers))),
+        priority_aging_ms_(static_cast<int64_t>(
+            ParamFromEnvWithDefault("TF_RUN_HANDLER_PRIORITY_AGING_MS", 0))),
         waiters_mu_(
             ParamFromEnvWithDefault("TF_RUN_HANDLER_NUM_SUB_THREAD_POOL", 2)),
         queue_waiters_(
@@ -874,12 +925,21 @@ class RunHandlerPool::Impl {
 
       num_active_requests = sorted_active_handlers_.size() + 1;
       thread_work_sources->resize(num_active_requests);
-      int priority = options.priority();
+      const uint64 now_us = priority_aging_ms_ > 0 ? EnvTime::NowMicros() : 0;
+      if (priority_aging_ms_ > 0) {
+        // The active requests have aged since the last Get(). The sort is
+        // stable, so requests of the same priority stay in arrival order.
+        sorted_active_handlers_.sort(
+            [this, now_us](RunHandler::Impl* a, RunHandler::Impl* b) {
+              return SortKey(a, now_us) > SortKey(b, now_us);
+            });
+      }
+      const double priority = SortKey(handler_impl, now_us);
       auto it = sorted_active_handlers_.cbegin();
       bool new_handler_inserted = false;
       for (int i = 0; i < num_active_requests; ++i) {
         if (!new_handler_inserted && (it == sorted_active_handlers_.cend() ||
-                                      priority > (*it)->priority())) {
+                                      priority > SortKey(*it, now_us))) {
           sorted_active_handlers_.insert(it, handler_impl);
           new_handler_inserted = true;
           // Point to the newly added handler.
@@ -904,6 +964,9 @@ class RunHandlerPool::Impl {
     uint64 now = tensorflow::EnvTime::NowMicros();
     double elapsed = (now - handler->start_time_us()) / 1000.0;
     time_hist_.Add(elapsed);
+    const uint64 queueing_delay_us = handler->tws()->MeanQueueingDelayMicros();
+    queueing_delay_hist_.Add(queueing_delay_us / 1000.0);
+    metrics::UpdateRunHandlerQueueingDelay(queueing_delay_us);
 
     // Erase from and update sorted_active_handlers_. Add it to the end of
     // free_handlers_.
@@ -943,18 +1006,30 @@ class RunHandlerPool::Impl {
 
   void LogInfo() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns the key by which the active handlers are sorted, in decreasing
+  // order.
+  double SortKey(RunHandler::Impl* handler, uint64 now_us) {
+    return priority_aging_ms_ > 0
+               ? handler->AgedPriority(now_us, priority_aging_ms_)
+               : handler->priority();
+  }
+
   // Maximum number of handlers pre-created during pool construction time. The
   // number has been chosen expecting each handler might at least want 1
   // inter-op thread for execution (during compute intensive workloads like
   // inference).
   const int max_handlers_;
 
+  // If positive, the priority of a request grows by one every that many
+  // milliseconds it has been running. See RunHandler.
+  const int64_t priority_aging_ms_;
+
   Eigen::MaxSizeVector<mutex> waiters_mu_;
   Eigen::MaxSizeVector<internal::Waiter> queue_waiters_;
 
   std::unique_ptr<internal::RunHandlerThreadPool> run_handler_thread_pool_;
   // Thread compatible part used only by lock under RunHandlerPool.
-  // Handlers are sorted by start time.
+  // Handlers are sorted by (aged) priority, then by start time.
   // TODO(azaks): sort by the remaining latency budget.
   // TODO(chaox): Consider other data structure for maintaining the sorted
   // active handlers if the searching overhead(currently O(n)) becomes the
@@ -965,6 +1040,9 @@ class RunHandlerPool::Impl {
 
   // Histogram of elapsed runtime of every handler (in ms).
   histogram::Histogram time_hist_ TF_GUARDED_BY(mu_);
+  // Histogram of the mean time the inter-op closures of every handler waited
+  // in the queue before running (in ms).
+  histogram::Histogram queueing_delay_hist_ TF_GUARDED_BY(mu_);
 
   int64_t iterations_ TF_GUARDED_BY(mu_);
   mutex mu_;
@@ -1020,6 +1098,8 @@ void RunHandlerPool::Impl::LogInfo() {
   if (iterations_++ % 50000 == 10 && VLOG_IS_ON(1)) {
     int num_active_requests = sorted_active_handlers_.size();
     VLOG(1) << "Printing time histogram: " << time_hist_.ToString();
+    VLOG(1) << "Printing queueing delay histogram: "
+            << queueing_delay_hist_.ToString();
     VLOG(1) << "Active session runs: " << num_active_requests;
     uint64 now = tensorflow::Env::Default()->NowMicros();
     string times_str = "";
@@ -1082,6 +1162,7 @@ void RunHandler::Impl::Reset(
   step_id_ = step_id;
   options_ = options;
   tws_.SetTracemeId(step_id);
+  tws_.ResetQueueingDelay();
 }
 
 RunHandlerPool::RunHandlerPool(int num_inter_op_threads)
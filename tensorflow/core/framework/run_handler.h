@@ -82,7 +82,12 @@ class RunHandlerPool {
 // RunHandler can be used to schedule inter/intra-op closures to run on a global
 // pool shared across all Session::Run(s). The closures are enqueued to a
 // handler specific queue, from which the work is stolen in a priority order
-// (time of the Get() call).
+// (RunHandlerPoolOptions.priority, then time of the Get() call).
+//
+// If TF_RUN_HANDLER_PRIORITY_AGING_MS is set to a positive value, the priority
+// of a request grows by one every that many milliseconds it has been running,
+// so that long running low priority requests are not starved under overload.
+// The order is updated every time a handler is requested.
 //
 // It can only be created via RunHandlerPool::Get().
 //
@@ -116,6 +121,8 @@ class RunHandlerEnvironment {
     std::function<void()> f;
     Context context;
     uint64 trace_id;
+    // Time the task was enqueued, in microseconds, or 0 if not tracked.
+    uint64 enqueue_time_us;
   };
   Env* const env_;
   const ThreadOptions thread_options_;
@@ -184,6 +191,17 @@ class ThreadWorkSource {
 
   unsigned NonBlockingWorkShardingFactor();
 
+  // Records that an inter-op task waited "delay_us" microseconds in the queue
+  // before it started to run.
+  void RecordQueueingDelay(uint64 delay_us);
+
+  // Mean and maximum queueing delay, in microseconds, of the inter-op tasks
+  // run since the last ResetQueueingDelay().
+  uint64 MeanQueueingDelayMicros();
+  uint64 MaxQueueingDelayMicros();
+
+  void ResetQueueingDelay();
+
   std::string ToString();
 
  private:
@@ -206,6 +224,10 @@ class ThreadWorkSource {
   Waiter queue_waiters_ TF_GUARDED_BY(waiters_mu_);
   std::atomic<int64_t> traceme_id_;
 
+  std::atomic<uint64> num_queued_tasks_;
+  std::atomic<uint64> total_queueing_delay_us_;
+  std::atomic<uint64> max_queueing_delay_us_;
+
   mutex run_handler_waiter_mu_;
   uint64 version_ TF_GUARDED_BY(run_handler_waiter_mu_);
   mutex* sub_thread_pool_waiter_mu_ TF_GUARDED_BY(run_handler_waiter_mu_);
@@ -113,6 +113,32 @@ TEST(RunHandlerUtilTest, PrioritySchedulingTest) {
   EXPECT_EQ(sorted_active_list[3], 1);
 }
 
+TEST(RunHandlerUtilTest, PriorityAgingTest) {
+  ASSERT_EQ(setenv("TF_RUN_HANDLER_PRIORITY_AGING_MS", "10", true), 0);
+  int num_threads = 2;
+  std::unique_ptr<RunHandlerPool> pool(
+      new RunHandlerPool(num_threads, num_threads));
+  ASSERT_EQ(unsetenv("TF_RUN_HANDLER_PRIORITY_AGING_MS"), 0);
+
+  RunOptions::Experimental::RunHandlerPoolOptions options =
+      RunOptions::Experimental::RunHandlerPoolOptions();
+  options.set_priority(1);
+  auto handler1 = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options);
+  // After 50ms the first request has an aged priority of at least 6.
+  Env::Default()->SleepForMicroseconds(50 * 1000);
+  options.set_priority(3);
+  auto handler2 = pool->Get(/*step_id=*/2, /*timeout_in_ms=*/0, options);
+  options.set_priority(100);
+  auto handler3 = pool->Get(/*step_id=*/3, /*timeout_in_ms=*/0, options);
+
+  std::vector<int64_t> sorted_active_list =
+      pool->GetActiveHandlerPrioritiesForTesting();
+  ASSERT_EQ(sorted_active_list.size(), 3);
+  EXPECT_EQ(sorted_active_list[0], 100);
+  EXPECT_EQ(sorted_active_list[1], 1);
+  EXPECT_EQ(sorted_active_list[2], 3);
+}
+
 TEST(RunHandlerThreadPool, EnqueueTask) {
   Eigen::MaxSizeVector<mutex> waiters_mu(2);
   waiters_mu.resize(2);
@@ -146,6 +172,19 @@ TEST(RunHandlerThreadPool, EnqueueTask) {
   EXPECT_EQ(result, 2);
 }
 
+TEST(RunHandlerThreadPool, QueueingDelay) {
+  internal::ThreadWorkSource tws;
+  EXPECT_EQ(tws.MeanQueueingDelayMicros(), 0);
+  tws.RecordQueueingDelay(10);
+  tws.RecordQueueingDelay(30);
+  tws.RecordQueueingDelay(20);
+  EXPECT_EQ(tws.MeanQueueingDelayMicros(), 20);
+  EXPECT_EQ(tws.MaxQueueingDelayMicros(), 30);
+  tws.ResetQueueingDelay();
+  EXPECT_EQ(tws.MeanQueueingDelayMicros(), 0);
+  EXPECT_EQ(tws.MaxQueueingDelayMicros(), 0);
+}
+
 TEST(RunHandlerThreadPool, FindTask) {
   Eigen::MaxSizeVector<mutex> waiters_mu(2);
   waiters_mu.resize(2);
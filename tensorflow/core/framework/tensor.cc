@@ -150,6 +150,58 @@ class Buffer : public BufferBase {
   TF_DISALLOW_COPY_AND_ASSIGN(Buffer);
 };
 
+// Tensors of at most this many bytes keep their elements inline in their
+// InlineBuffer, when they can.
+constexpr size_t kMaxInlineBytes = 16;
+
+// A ref-counted buffer that stores up to kMaxInlineBytes of elements of a type
+// that can be memcpy'd in the buffer object itself. Scalars and tiny tensors
+// such as shapes, indices and loop counters thus take a single allocation,
+// which does not go through the allocator they are allocated with.
+class InlineBuffer : public TensorBuffer {
+ public:
+  static InlineBuffer* New(Allocator* alloc, size_t size) {
+    void* ptr =
+        port::AlignedMalloc(sizeof(InlineBuffer), alignof(InlineBuffer));
+    if (ptr == nullptr) return nullptr;
+    return new (ptr) InlineBuffer(alloc, size);
+  }
+
+  // Override `operator delete` so that calling `delete this` in
+  // `core::Refcounted::Unref()` frees the memory from New().
+  static void operator delete(void* ptr) { port::AlignedFree(ptr); }
+  static void operator delete(void*, void*) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+
+  bool GetAllocatedBytes(size_t* out_bytes) const override { return false; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name(alloc_->Name());
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+    if (RefCountIsOne()) {
+      proto->set_has_single_reference(true);
+    }
+  }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return alloc_->GetMemoryType();
+  }
+
+ private:
+  InlineBuffer(Allocator* alloc, size_t size)
+      : TensorBuffer(data_), alloc_(alloc), size_(size) {}
+  ~InlineBuffer() override {}
+
+  Allocator* const alloc_;
+  const size_t size_;
+  alignas(EIGEN_MAX_ALIGN_BYTES) char data_[kMaxInlineBytes];
+
+  TF_DISALLOW_COPY_AND_ASSIGN(InlineBuffer);
+};
+
 void LogUnexpectedSize(int64_t actual, int64_t expected) {
   LOG(ERROR) << "Input size was " << actual << " and expected " << expected;
 }
@@ -814,11 +866,24 @@ bool Tensor::RefCountIsOne() const {
   CASES_WITH_DEFAULT(TYPE_ENUM, STMTS, LOG(FATAL) << "Type not set"; \
                      , LOG(FATAL) << "Unexpected type: " << TYPE_ENUM;)
 
+// Returns whether a tensor of `num_elements` of `type` that is allocated with
+// `a` can use an InlineBuffer. Only the allocations of the default CPU
+// allocator that it would neither record nor log are skipped, since other
+// allocators may give memory that devices can access, or account for it.
+static bool UseInlineBuffer(Allocator* a, DataType type, int64_t num_elements) {
+  return num_elements > 0 && DataTypeCanUseMemcpy(type) &&
+         num_elements * DataTypeSize(type) <= kMaxInlineBytes &&
+         a == cpu_allocator_base() && !CPUAllocatorStatsEnabled() &&
+         !MemoryLoggingEnabled();
+}
+
 Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape)
     : shape_(shape), buf_(nullptr) {
   set_dtype(type);
   CHECK_NOTNULL(a);
-  if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
+  if (UseInlineBuffer(a, type, shape_.num_elements())) {
+    buf_ = InlineBuffer::New(a, shape_.num_elements() * DataTypeSize(type));
+  } else if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
     CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
   }
   if (MemoryLoggingEnabled() && buf_ != nullptr && buf_->data() != nullptr) {
@@ -832,7 +897,10 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape,
     : shape_(shape), buf_(nullptr) {
   set_dtype(type);
   CHECK_NOTNULL(a);
-  if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
+  if (allocation_attr.freed_by_func == nullptr &&
+      UseInlineBuffer(a, type, shape_.num_elements())) {
+    buf_ = InlineBuffer::New(a, shape_.num_elements() * DataTypeSize(type));
+  } else if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
     CASES(type, buf_ = new Buffer<T>(a, shape.num_elements(), allocation_attr));
   }
   if (MemoryLoggingEnabled() && !allocation_attr.allocation_will_be_logged &&
@@ -1173,6 +1173,37 @@ TEST(Tensor, SharesBufferWith) {
   EXPECT_TRUE(a.SharesBufferWith(copy));
 }
 
+TEST(Tensor, SmallTensors) {
+  for (const TensorShape& shape :
+       {TensorShape({}), TensorShape({4}), TensorShape({5})}) {
+    Tensor t(DT_FLOAT, shape);
+    ASSERT_TRUE(t.IsInitialized());
+    EXPECT_TRUE(t.IsAligned());
+    EXPECT_EQ(t.TotalBytes(), shape.num_elements() * sizeof(float));
+    auto flat = t.flat<float>();
+    for (int i = 0; i < flat.size(); ++i) flat(i) = i;
+
+    Tensor copy(t);
+    EXPECT_TRUE(copy.SharesBufferWith(t));
+    EXPECT_EQ(copy.flat<float>()(flat.size() - 1), flat.size() - 1);
+    if (shape.dims() > 0) {
+      Tensor slice = t.Slice(1, 2);
+      EXPECT_TRUE(slice.SharesBufferWith(t));
+      EXPECT_EQ(slice.flat<float>()(0), 1);
+    }
+  }
+
+  // The default CPU allocator still sees the allocations it records.
+  EnableCPUAllocatorStats();
+  Allocator* allocator = cpu_allocator_base();
+  const int64_t num_allocs = allocator->GetStats()->num_allocs;
+  {
+    Tensor t(DT_INT32, TensorShape({}));
+    EXPECT_EQ(allocator->GetStats()->num_allocs, num_allocs + 1);
+  }
+  DisableCPUAllocatorStats();
+}
+
 TEST(Tensor, FailureToAllocate) {
   TensorShape shape({1});
   DummyCPUAllocator allocator;
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/common_runtime/function_shape_inference_cache.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/function.pb.h"
@@ -807,6 +808,18 @@ class SymbolicShapeRefiner {
       return Status::OK();
     }
 
+    // Calls that propagate the same shapes and values into the function body
+    // are inferred once.
+    FunctionShapeInferenceCache* cache = FunctionShapeInferenceCache::Global();
+    Fprint128 key;
+    TF_RETURN_IF_ERROR(FunctionCallKey(function_node, function.name(),
+                                       *maybe_grappler_function_item, &key));
+    std::shared_ptr<const FunctionShapeInferenceCache::Outputs> cached_outputs =
+        cache->Lookup(key);
+    if (cached_outputs != nullptr) {
+      return SetFunctionOutputs(function_node, *cached_outputs);
+    }
+
     // Copy (not reference) so that changes we make here (e.g., replacing
     // _Arg with Const and _Retval with Identity) don't affect one in
     // fun_to_grappler_function_item_.
@@ -818,32 +831,12 @@ class SymbolicShapeRefiner {
          ++i) {
       auto& fun_input = grappler_function_item.input(i);
       NodeDef* fun_node = gv.GetNode(fun_input.node_name);
-      const TensorId input_tensor = ParseTensorName(function_node->input(i));
-
-      if (IsControlInput(input_tensor)) {
-        return errors::FailedPrecondition(
-            "Function inputs should not contain control nodes.");
-      }
-
-      const NodeDef* input_node = graph_.GetNode(input_tensor.node());
-      if (input_node == nullptr) {
-        return errors::FailedPrecondition(input_tensor.node(),
-                                          " was not found in the graph.");
-      }
-
-      InferenceContext* input_ic = GetContext(input_node);
-      if (input_ic == nullptr) {
-        return errors::FailedPrecondition(
-            "Inference context has not been created for ", input_tensor.node());
-      }
-
-      int output_port_num = input_tensor.index();
-      AttrValue attr_output_shape;
-      TensorShapeProto proto;
-      const auto handle = input_ic->output(output_port_num);
-      input_ic->ShapeHandleToProto(handle, &proto);
-      // There may be dim.size < -1 in SymbolicShapeRefiner. Change those to -1.
-      NormalizeShapeForOutput(&proto);
+      const NodeDef* input_node;
+      InferenceContext* input_ic;
+      int output_port_num;
+      TF_RETURN_IF_ERROR(GetFunctionInput(function_node, i, &input_node,
+                                          &input_ic, &output_port_num));
+      TensorShapeProto proto = FunctionInputShape(input_ic, output_port_num);
       // _Arg op's output shape uses _output_shapes attr.
       AttrValue output_attr;
       output_attr.mutable_list()->add_shape()->Swap(&proto);
@@ -894,30 +887,9 @@ class SymbolicShapeRefiner {
 
     // Replace input nodes with Consts, if values are known. Note that
     // we don't check exceptions here as it's done in the above loop.
-    auto* ctx = GetNodeContext(function_node);
-    auto* ic = ctx->inference_context.get();
     for (int i = grappler_function_item.inputs().size() - 1; i >= 0; --i) {
-      const string& input = function_node->input(i);
-      const string node_name = NodeName(input);
-      const NodeDef* input_node = graph_.GetNode(node_name);
-      if (IsConstant(*input_node)) {
-        TF_CHECK_OK(
-            ReplaceInputWithConst(*input_node, i, &grappler_function_item));
-      } else if (static_cast<int>(ctx->input_tensor_protos.size()) > i &&
-                 ctx->input_tensor_protos[i] != nullptr) {
-        NodeDef const_input_node = MakeConstNodeDefFromTensorProto(
-            ic, *ctx->input_tensor_protos[i], ctx->input_types[i]);
-        TF_CHECK_OK(ReplaceInputWithConst(const_input_node, i,
-                                          &grappler_function_item));
-      } else if (static_cast<int>(ic->input_tensors_as_shapes().size()) > i &&
-                 IsShapeFullyDefinedIntegerVectorOrScalar(
-                     ic, ic->input(i), ic->input_tensors_as_shapes()[i],
-                     ctx->input_types[i])) {
-        // We have fully defined input_tensors_as_shapes for this input; use it
-        // as a const input to the function node.
-        NodeDef const_input_node = MakeConstNodeDefFromShape(
-            ic, ic->input(i), ic->input_tensors_as_shapes()[i],
-            ctx->input_types[i]);
+      NodeDef const_input_node;
+      if (FunctionInputConst(function_node, i, &const_input_node)) {
         TF_CHECK_OK(ReplaceInputWithConst(const_input_node, i,
                                           &grappler_function_item));
       }
@@ -942,10 +914,8 @@ class SymbolicShapeRefiner {
         /*include_tensor_values=*/true));
 
     // Add return nodes for output shapes.
-    int output = 0;
-    ctx->output_tensors_as_shapes.resize(grappler_function_item.output_size());
-    ctx->output_tensor_protos.resize(grappler_function_item.output_size(),
-                                     nullptr);
+    FunctionShapeInferenceCache::Outputs outputs;
+    outputs.reserve(grappler_function_item.output_size());
     for (auto const& out_arg : grappler_function_item.outputs()) {
       // It is guaranteed that output_tensors does not contain any control
       // inputs, so port_id >= 0.
@@ -966,21 +936,161 @@ class SymbolicShapeRefiner {
             " (output_properties.size() = ", output_properties.size(), ").");
       }
       auto& outprop = output_properties[out_tensor.index()];
-      TensorShapeProto shape = outprop.shape();
-      NormalizeShapeForOutput(&shape);
-      ShapeHandle out;
-      TF_RETURN_IF_ERROR(ic->MakeShapeFromShapeProto(shape, &out));
-      ic->set_output(output, out);
-      if (outprop.has_value()) {
-        // Forward tensor value to output_tensors_as_shape.
-        MaybeTensorProtoToShape(ic, outprop.value(),
-                                &ctx->output_tensors_as_shapes[output]);
-        const_tensors_to_propagate_.push_back(outprop.value());
-        ctx->output_tensor_protos[output] = &const_tensors_to_propagate_.back();
+      outputs.emplace_back();
+      outputs.back().shape = outprop.shape();
+      NormalizeShapeForOutput(&outputs.back().shape);
+      if (outprop.has_value()) outputs.back().value = outprop.value();
+    }
+
+    TF_RETURN_IF_ERROR(SetFunctionOutputs(function_node, outputs));
+    cache->Insert(key, std::move(outputs));
+    return Status::OK();
+  }
+
+  // Returns the node and the inference context of the tensor that feeds input
+  // `i` of `function_node`, and its output port.
+  Status GetFunctionInput(const NodeDef* function_node, int i,
+                          const NodeDef** input_node,
+                          InferenceContext** input_ic, int* output_port_num) {
+    const TensorId input_tensor = ParseTensorName(function_node->input(i));
+
+    if (IsControlInput(input_tensor)) {
+      return errors::FailedPrecondition(
+          "Function inputs should not contain control nodes.");
+    }
+
+    *input_node = graph_.GetNode(input_tensor.node());
+    if (*input_node == nullptr) {
+      return errors::FailedPrecondition(input_tensor.node(),
+                                        " was not found in the graph.");
+    }
+
+    *input_ic = GetContext(*input_node);
+    if (*input_ic == nullptr) {
+      return errors::FailedPrecondition(
+          "Inference context has not been created for ", input_tensor.node());
+    }
+
+    *output_port_num = input_tensor.index();
+    return Status::OK();
+  }
+
+  // Returns the shape of a function input that the function body sees.
+  static TensorShapeProto FunctionInputShape(InferenceContext* input_ic,
+                                             int output_port_num) {
+    TensorShapeProto proto;
+    input_ic->ShapeHandleToProto(input_ic->output(output_port_num), &proto);
+    // There may be dim.size < -1 in SymbolicShapeRefiner. Change those to -1.
+    NormalizeShapeForOutput(&proto);
+    return proto;
+  }
+
+  // Sets `const_node` to a Const that replaces input `i` of `function_node`
+  // in the function body, and returns true, if the value of the input is
+  // known.
+  bool FunctionInputConst(const NodeDef* function_node, int i,
+                          NodeDef* const_node) {
+    const NodeDef* input_node =
+        graph_.GetNode(NodeName(function_node->input(i)));
+    auto* ctx = GetNodeContext(function_node);
+    auto* ic = ctx->inference_context.get();
+    if (IsConstant(*input_node)) {
+      *const_node = *input_node;
+    } else if (static_cast<int>(ctx->input_tensor_protos.size()) > i &&
+               ctx->input_tensor_protos[i] != nullptr) {
+      *const_node = MakeConstNodeDefFromTensorProto(
+          ic, *ctx->input_tensor_protos[i], ctx->input_types[i]);
+    } else if (static_cast<int>(ic->input_tensors_as_shapes().size()) > i &&
+               IsShapeFullyDefinedIntegerVectorOrScalar(
+                   ic, ic->input(i), ic->input_tensors_as_shapes()[i],
+                   ctx->input_types[i])) {
+      // We have fully defined input_tensors_as_shapes for this input; use it
+      // as a const input to the function node.
+      *const_node = MakeConstNodeDefFromShape(
+          ic, ic->input(i), ic->input_tensors_as_shapes()[i],
+          ctx->input_types[i]);
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  // Computes the key of a call of `function_item` under
+  // FunctionShapeInferenceCache from what UpdateFunction() propagates into the
+  // function body: the shapes of the inputs, the shapes and types of the
+  // resources they are handles to, and their values.
+  Status FunctionCallKey(const NodeDef* function_node,
+                         const string& function_name,
+                         const GrapplerFunctionItem& function_item,
+                         Fprint128* key) {
+    auto it = function_fingerprints_.find(function_name);
+    if (it == function_fingerprints_.end()) {
+      const FunctionDef* function_def =
+          CHECK_NOTNULL(function_library_.Find(function_name));
+      it = function_fingerprints_
+               .emplace(function_name,
+                        FunctionShapeInferenceCache::FingerprintFunction(
+                            *function_def, function_library_))
+               .first;
+    }
+
+    FunctionShapeInferenceCache::KeyBuilder key_builder(
+        strings::StrCat("SymbolicShapeRefiner/", graph_def_version_, "/",
+                        aggressive_shape_inference_));
+    key_builder.AddFunction(it->second);
+    for (int i = 0, end = function_item.inputs().size(); i < end; ++i) {
+      const NodeDef* input_node;
+      InferenceContext* input_ic;
+      int output_port_num;
+      TF_RETURN_IF_ERROR(GetFunctionInput(function_node, i, &input_node,
+                                          &input_ic, &output_port_num));
+      const DataType dtype = function_item.input(i).data_type;
+      key_builder.AddInput(dtype,
+                           FunctionInputShape(input_ic, output_port_num));
+      if (dtype == DT_RESOURCE) {
+        auto* shapes_and_types =
+            input_ic->output_handle_shapes_and_types(output_port_num);
+        if (shapes_and_types != nullptr && !shapes_and_types->empty()) {
+          std::vector<FunctionShapeInferenceCache::HandleShapeAndType>
+              handle_data(shapes_and_types->size());
+          for (int j = 0, num = handle_data.size(); j < num; ++j) {
+            handle_data[j].dtype = (*shapes_and_types)[j].dtype;
+            input_ic->ShapeHandleToProto((*shapes_and_types)[j].shape,
+                                         &handle_data[j].shape);
+          }
+          key_builder.AddInputHandleShapesAndTypes(handle_data);
+        }
+      }
+      NodeDef const_input_node;
+      if (FunctionInputConst(function_node, i, &const_input_node)) {
+        auto value = const_input_node.attr().find("value");
+        if (value != const_input_node.attr().end()) {
+          key_builder.AddInputValue(value->second.tensor());
+        }
       }
-      output++;
     }
+    *key = key_builder.Build();
+    return Status::OK();
+  }
 
+  // Sets the output shapes and values of `function_node` to `outputs`.
+  Status SetFunctionOutputs(
+      const NodeDef* function_node,
+      const FunctionShapeInferenceCache::Outputs& outputs) {
+    auto* ctx = GetNodeContext(function_node);
+    auto* ic = ctx->inference_context.get();
+    TF_RETURN_IF_ERROR(
+        FunctionShapeInferenceCache::SetOutputShapes(outputs, ic));
+    ctx->output_tensors_as_shapes.resize(outputs.size());
+    ctx->output_tensor_protos.resize(outputs.size(), nullptr);
+    for (int i = 0, end = outputs.size(); i < end; ++i) {
+      if (!outputs[i].value.has_value()) continue;
+      // Forward tensor value to output_tensors_as_shape.
+      MaybeTensorProtoToShape(ic, *outputs[i].value,
+                              &ctx->output_tensors_as_shapes[i]);
+      const_tensors_to_propagate_.push_back(*outputs[i].value);
+      ctx->output_tensor_protos[i] = &const_tensors_to_propagate_.back();
+    }
     return Status::OK();
   }
 
@@ -2049,6 +2159,9 @@ class SymbolicShapeRefiner {
   // instantiation failed it will have an `absl::nullopt`.
   absl::flat_hash_map<string, absl::optional<GrapplerFunctionItem>>
       fun_to_grappler_function_item_;
+  // The FunctionShapeInferenceCache::FingerprintFunction() of the functions in
+  // fun_to_grappler_function_item_.
+  absl::flat_hash_map<string, Fprint128> function_fingerprints_;
   FunctionLibraryDefinition function_library_;
   const absl::flat_hash_map<string, absl::flat_hash_set<int>>& fed_ports_;
   // Store TensorProtos for tensor value propagation. Note that we use deque,
@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/cc/framework/scope.h"
 #include "tensorflow/cc/ops/functional_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/common_runtime/function_shape_inference_cache.h"
 #include "tensorflow/core/framework/graph_def_util.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.pb.h"  // NOLINT
@@ -1748,6 +1749,31 @@ TEST_F(GraphPropertiesTest, SimpleFunctionStaticShapeInference) {
   EXPECT_EQ("float: [1,2]", PropToString(in_prop1));
 }
 
+TEST_F(GraphPropertiesTest, FunctionStaticShapeInferenceIsCached) {
+  GrapplerItem item;
+  string filename = io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataPath,
+                                 "simple_function.pbtxt");
+  TF_ASSERT_OK(ReadGraphDefFromFile(filename, &item.graph));
+  GraphProperties properties(item);
+  TF_ASSERT_OK(properties.InferStatically(false));
+
+  // The calls of MyAdd are not inferred again for the same graph.
+  FunctionShapeInferenceCache* cache = FunctionShapeInferenceCache::Global();
+  const int64 num_hits = cache->num_hits();
+  GraphProperties cached_properties(item);
+  TF_ASSERT_OK(cached_properties.InferStatically(false));
+  EXPECT_GE(cache->num_hits() - num_hits, 2);
+  for (const NodeDef& node : item.graph.node()) {
+    const auto out_props = properties.GetOutputProperties(node.name());
+    const auto cached_out_props =
+        cached_properties.GetOutputProperties(node.name());
+    ASSERT_EQ(out_props.size(), cached_out_props.size());
+    for (int i = 0, end = out_props.size(); i < end; ++i) {
+      EXPECT_EQ(PropToString(out_props[i]), PropToString(cached_out_props[i]));
+    }
+  }
+}
+
 TEST_F(GraphPropertiesTest, LargeFunctionStaticShapeInference) {
   GrapplerItem item;
   string filename = io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataPath,
@@ -0,0 +1,129 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/measured_op_level_cost_estimator.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// Averages the compute costs of the measurements with the same key.
+std::shared_ptr<const absl::flat_hash_map<std::string, int64_t>>
+MeanComputeCosts(const OpPerformanceList& measurements) {
+  absl::flat_hash_map<std::string, std::pair<int64_t, int64_t>> totals;
+  for (const OpPerformance& perf : measurements.op_performance()) {
+    if (perf.compute_cost() <= 0) continue;
+    auto& total =
+        totals[MeasuredOpLevelCostEstimator::MeasurementKey(perf.op())];
+    total.first += perf.compute_cost();
+    ++total.second;
+  }
+  auto compute_costs =
+      std::make_shared<absl::flat_hash_map<std::string, int64_t>>();
+  for (const auto& total : totals) {
+    (*compute_costs)[total.first] = total.second.first / total.second.second;
+  }
+  return compute_costs;
+}
+
+}  // namespace
+
+MeasuredOpLevelCostEstimator::MeasuredOpLevelCostEstimator(
+    const OpPerformanceList& measurements)
+    : MeasuredOpLevelCostEstimator(MeanComputeCosts(measurements)) {}
+
+MeasuredOpLevelCostEstimator::MeasuredOpLevelCostEstimator(
+    std::shared_ptr<const ComputeCostMap> compute_costs)
+    : compute_costs_(std::move(compute_costs)) {}
+
+Status MeasuredOpLevelCostEstimator::Load(
+    Env* env, const std::string& path,
+    std::unique_ptr<MeasuredOpLevelCostEstimator>* estimator) {
+  OpPerformanceList measurements;
+  TF_RETURN_IF_ERROR(ReadTextOrBinaryProto(env, path, &measurements));
+  estimator->reset(new MeasuredOpLevelCostEstimator(measurements));
+  return Status::OK();
+}
+
+std::string MeasuredOpLevelCostEstimator::MeasurementKey(
+    const OpInfo& op_info) {
+  std::string key = absl::StrCat(op_info.op(), "@", op_info.device().type());
+  for (const auto& input : op_info.inputs()) {
+    absl::StrAppend(&key, ";", DataTypeString(input.dtype()),
+                    PartialTensorShape::DebugString(input.shape()));
+  }
+  return key;
+}
+
+Costs MeasuredOpLevelCostEstimator::PredictCosts(
+    const OpContext& op_context) const {
+  Costs costs = OpLevelCostEstimator::PredictCosts(op_context);
+  auto it = compute_costs_->find(MeasurementKey(op_context.op_info));
+  if (it == compute_costs_->end()) {
+    return costs;
+  }
+  // The measurement covers both the computation and the memory accesses of
+  // the op, so it replaces the whole analytical time estimate. The memory
+  // usage estimates are kept.
+  costs.compute_time = Costs::NanoSeconds(it->second);
+  costs.memory_time = Costs::Duration::zero();
+  costs.intermediate_memory_time = Costs::Duration::zero();
+  costs.intermediate_memory_read_time = Costs::Duration::zero();
+  costs.intermediate_memory_write_time = Costs::Duration::zero();
+  costs.execution_time = costs.compute_time;
+  costs.inaccurate = false;
+  return costs;
+}
+
+std::unique_ptr<OpLevelCostEstimator> CreateDefaultOpLevelCostEstimator() {
+  static const auto* compute_costs = []()
+      -> std::shared_ptr<const MeasuredOpLevelCostEstimator::ComputeCostMap>* {
+    std::string path;
+    Status s = ReadStringFromEnvVar(kMeasuredOpCostsEnvVar, "", &path);
+    if (!s.ok() || path.empty()) {
+      return nullptr;
+    }
+    OpPerformanceList measurements;
+    s = ReadTextOrBinaryProto(Env::Default(), path, &measurements);
+    if (!s.ok()) {
+      LOG(ERROR) << "Failed to read measured op costs from " << path << ": "
+                 << s;
+      return nullptr;
+    }
+    VLOG(1) << "Read " << measurements.op_performance_size()
+            << " measured op costs from " << path;
+    return new std::shared_ptr<
+        const MeasuredOpLevelCostEstimator::ComputeCostMap>(
+        MeanComputeCosts(measurements));
+  }();
+  if (compute_costs == nullptr) {
+    return absl::make_unique<OpLevelCostEstimator>();
+  }
+  return std::unique_ptr<OpLevelCostEstimator>(
+      new MeasuredOpLevelCostEstimator(*compute_costs));
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,79 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_OP_LEVEL_COST_ESTIMATOR_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_OP_LEVEL_COST_ESTIMATOR_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// The environment variable that names an OpPerformanceList file, whose
+// measurements are used by the default op-level cost estimator.
+constexpr char kMeasuredOpCostsEnvVar[] = "TF_GRAPPLER_MEASURED_OP_COSTS";
+
+// Estimates the cost of ops from measured compute costs, e.g. those collected
+// from a RunMetadata cost graph with CostGraphToOpPerformanceData(). Ops are
+// matched by type, device type, and input types and shapes. Ops without a
+// measurement fall back to the analytical estimates of OpLevelCostEstimator.
+class MeasuredOpLevelCostEstimator : public OpLevelCostEstimator {
+ public:
+  // Uses the mean compute cost of the measurements of each op.
+  explicit MeasuredOpLevelCostEstimator(const OpPerformanceList& measurements);
+
+  // Reads measurements from a binary or text OpPerformanceList at `path`.
+  static Status Load(Env* env, const std::string& path,
+                     std::unique_ptr<MeasuredOpLevelCostEstimator>* estimator);
+
+  Costs PredictCosts(const OpContext& op_context) const override;
+
+  // Returns the number of distinct ops with a measurement.
+  int num_measured_ops() const { return compute_costs_->size(); }
+
+  // Returns the key that identifies the measurements of `op_info`.
+  static std::string MeasurementKey(const OpInfo& op_info);
+
+ private:
+  using ComputeCostMap = absl::flat_hash_map<std::string, int64_t>;
+
+  explicit MeasuredOpLevelCostEstimator(
+      std::shared_ptr<const ComputeCostMap> compute_costs);
+
+  // The mean measured compute cost in nanoseconds, keyed by MeasurementKey().
+  // Shared between the copies of an estimator loaded from the same file.
+  std::shared_ptr<const ComputeCostMap> compute_costs_;
+
+  friend std::unique_ptr<OpLevelCostEstimator>
+  CreateDefaultOpLevelCostEstimator();
+};
+
+// Returns the op-level cost estimator used by default by cost-driven grappler
+// passes: a MeasuredOpLevelCostEstimator over the file named by
+// TF_GRAPPLER_MEASURED_OP_COSTS if it is set, and an OpLevelCostEstimator
+// otherwise. The file is read once per process.
+std::unique_ptr<OpLevelCostEstimator> CreateDefaultOpLevelCostEstimator();
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_OP_LEVEL_COST_ESTIMATOR_H_
@@ -0,0 +1,97 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/measured_op_level_cost_estimator.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+OpContext DescribeMatMul(int m, int n, int k) {
+  OpContext op_context;
+  OpInfo& op_info = op_context.op_info;
+  op_info.set_op("MatMul");
+  auto* device = op_info.mutable_device();
+  device->set_type("CPU");
+  device->set_num_cores(10);
+  device->set_bandwidth(10000000);
+  device->set_frequency(1000);
+  for (auto dims : {std::make_pair(m, k), std::make_pair(k, n)}) {
+    auto* input = op_info.add_inputs();
+    input->set_dtype(DT_FLOAT);
+    input->mutable_shape()->add_dim()->set_size(dims.first);
+    input->mutable_shape()->add_dim()->set_size(dims.second);
+  }
+  return op_context;
+}
+
+OpPerformanceList MatMulMeasurements() {
+  OpPerformanceList measurements;
+  for (int64_t compute_cost : {1000, 3000}) {
+    OpPerformance* perf = measurements.add_op_performance();
+    *perf->mutable_op() = DescribeMatMul(10, 10, 10).op_info;
+    perf->set_compute_cost(compute_cost);
+  }
+  return measurements;
+}
+
+TEST(MeasuredOpLevelCostEstimatorTest, UsesMeanMeasuredCost) {
+  MeasuredOpLevelCostEstimator estimator(MatMulMeasurements());
+  EXPECT_EQ(1, estimator.num_measured_ops());
+  Costs costs = estimator.PredictCosts(DescribeMatMul(10, 10, 10));
+  EXPECT_EQ(Costs::NanoSeconds(2000), costs.compute_time);
+  EXPECT_EQ(Costs::Duration::zero(), costs.memory_time);
+  EXPECT_EQ(Costs::NanoSeconds(2000), costs.execution_time);
+  EXPECT_FALSE(costs.inaccurate);
+}
+
+TEST(MeasuredOpLevelCostEstimatorTest, FallsBackToAnalyticalCost) {
+  MeasuredOpLevelCostEstimator estimator(MatMulMeasurements());
+  OpLevelCostEstimator analytical;
+  const OpContext op_context = DescribeMatMul(20, 10, 10);
+  EXPECT_EQ(analytical.PredictCosts(op_context).execution_time,
+            estimator.PredictCosts(op_context).execution_time);
+}
+
+TEST(MeasuredOpLevelCostEstimatorTest, MatchesDeviceType) {
+  OpInfo op_info = DescribeMatMul(10, 10, 10).op_info;
+  const std::string cpu_key =
+      MeasuredOpLevelCostEstimator::MeasurementKey(op_info);
+  op_info.mutable_device()->set_type("GPU");
+  EXPECT_NE(cpu_key, MeasuredOpLevelCostEstimator::MeasurementKey(op_info));
+}
+
+TEST(MeasuredOpLevelCostEstimatorTest, Load) {
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "measured_op_costs.pb");
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(), path, MatMulMeasurements()));
+  std::unique_ptr<MeasuredOpLevelCostEstimator> estimator;
+  TF_ASSERT_OK(
+      MeasuredOpLevelCostEstimator::Load(Env::Default(), path, &estimator));
+  EXPECT_EQ(1, estimator->num_measured_ops());
+  EXPECT_FALSE(
+      MeasuredOpLevelCostEstimator::Load(
+          Env::Default(), io::JoinPath(testing::TmpDir(), "missing.pb"),
+          &estimator)
+          .ok());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
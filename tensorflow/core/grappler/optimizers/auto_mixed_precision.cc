@@ -22,11 +22,14 @@ limitations under the License.
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/costs/virtual_placer.h"
 #include "tensorflow/core/grappler/devices.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -41,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/env_var.h"
+#include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -102,6 +106,60 @@ bool HasFastFP16Support(const DeviceProperties& props) {
   return false;
 }
 
+// Returns true if the CPU has native bfloat16 instructions. Elsewhere the
+// bfloat16 kernels of oneDNN are emulated with float32 arithmetic, so they are
+// slower than the float32 kernels once the casts are paid for.
+bool HasFastBF16Support() {
+  return port::TestCPUFeature(port::CPUFeature::AVX512_BF16) ||
+         port::TestCPUFeature(port::CPUFeature::AMX_BF16);
+}
+
+// A CPU contraction with fewer flops than this per element of its inputs and
+// output does not gain enough from bfloat16 to pay for casting them. A cast
+// touches each element once, while a bfloat16 dot product saves a fraction of
+// a cycle per flop.
+constexpr double kMinBF16FlopsPerCastElement = 16;
+
+// Returns the flops of the contraction `node` per element of its inputs and
+// output, or -1 if it is not a contraction or its shapes are unknown.
+double ContractionFlopsPerElement(const NodeDef& node,
+                                  const GraphProperties& properties) {
+  const auto& inputs = properties.GetInputProperties(node.name());
+  const auto& outputs = properties.GetOutputProperties(node.name());
+  if (inputs.size() < 2 || outputs.empty()) return -1;
+  const PartialTensorShape x(inputs[0].shape());
+  const PartialTensorShape y(inputs[1].shape());
+  const PartialTensorShape out(outputs[0].shape());
+  if (!x.IsFullyDefined() || !y.IsFullyDefined() || !out.IsFullyDefined() ||
+      x.dims() < 2 || y.dims() < 2) {
+    return -1;
+  }
+
+  // The number of multiply-adds per output element.
+  int64_t reduction_size = 1;
+  const string& op = node.op();
+  if (op == "MatMul" || op == "BatchMatMul" || op == "BatchMatMulV2") {
+    bool adj_x = false;
+    if (!TryGetNodeAttr(node, op == "MatMul" ? "transpose_a" : "adj_x",
+                        &adj_x)) {
+      return -1;
+    }
+    reduction_size = x.dim_size(adj_x ? x.dims() - 2 : x.dims() - 1);
+  } else if (op == "Conv2D" || op == "Conv3D") {
+    // The filter is [spatial..., in_channels, out_channels].
+    for (int i = 0; i < y.dims() - 1; ++i) reduction_size *= y.dim_size(i);
+  } else if (op == "DepthwiseConv2dNative") {
+    // The filter is [spatial..., in_channels, channel_multiplier].
+    for (int i = 0; i < y.dims() - 2; ++i) reduction_size *= y.dim_size(i);
+  } else {
+    return -1;
+  }
+  const int64_t num_elements =
+      x.num_elements() + y.num_elements() + out.num_elements();
+  if (num_elements == 0) return -1;
+  return 2.0 * out.num_elements() * reduction_size / num_elements;
+}
+
 // Instances of this class represent unique type attribute identifiers within a
 // node. It handles regular type attributes, list type attributes (where
 // type_index is set to the index in the type list), and fixed types.
@@ -979,12 +1037,14 @@ class AutoMixedPrecisionImpl {
   //   FP32: cast to float32
   //   AUTO: cast to a data type that matches the required data type at fanouts
   enum class CastType { FP16, FP32, AUTO };
-  AutoMixedPrecisionImpl(Cluster* cluster,
-                         const std::unordered_set<string>& nodes_to_preserve,
-                         GraphDef* graph, string id,
-                         AutoMixedPrecisionMode mode)
+  // Allowlist ops in `small_contractions` are left in float32.
+  AutoMixedPrecisionImpl(
+      Cluster* cluster, const std::unordered_set<string>& nodes_to_preserve,
+      GraphDef* graph, string id, AutoMixedPrecisionMode mode,
+      absl::flat_hash_set<string> small_contractions = {})
       : virtual_placer_(cluster->GetDevices()),
         nodes_to_preserve_(nodes_to_preserve),
+        small_contractions_(std::move(small_contractions)),
         graph_(graph),
         function_library_(OpRegistry::Global(), graph->library()),
         id_(id),
@@ -1072,6 +1132,7 @@ class AutoMixedPrecisionImpl {
 
   VirtualPlacer virtual_placer_;
   std::unordered_set<string> nodes_to_preserve_;
+  absl::flat_hash_set<string> small_contractions_;
   GraphDef* graph_;
   FunctionLibraryDefinition function_library_;
   string id_;
@@ -1622,6 +1683,11 @@ void AutoMixedPrecisionImpl::AddAllowlistOps(
     const NodeTypeId& root = *graph_type_view_.GetNode(root_idx);
     if (!ShouldProcess(*root.node)) continue;
     bool force_allow = force_all_fp16_ && CanForceFP16(*root.node);
+    if (!force_allow && small_contractions_.contains(root.node->name())) {
+      VLOG(2) << "Not painting node " << root.node->name()
+              << " ALLOW because it does too little work to pay for the casts";
+      continue;
+    }
     if (f16_allowlist_.count(root.node->op()) || force_allow) {
       bool inserted = allow_set->insert(root_idx).second;
       if (VLOG_IS_ON(2) && inserted) {
@@ -2202,6 +2268,28 @@ int GetNumGPUs(const Cluster& cluster) {
   return num_gpus;
 }
 
+// Returns the contractions of `item` on CPU that are too small to gain from
+// bfloat16.
+absl::flat_hash_set<string> FindSmallCpuContractions(const GrapplerItem& item) {
+  absl::flat_hash_set<string> small_contractions;
+  GraphProperties properties(item);
+  Status status = properties.InferStatically(/*assume_valid_feeds=*/false);
+  if (!status.ok()) {
+    VLOG(1) << "Could not infer shapes, converting contractions of any size: "
+            << status;
+    return small_contractions;
+  }
+  for (const NodeDef& node : item.graph.node()) {
+    const double flops_per_element =
+        ContractionFlopsPerElement(node, properties);
+    if (flops_per_element >= 0 &&
+        flops_per_element < kMinBF16FlopsPerCastElement) {
+      small_contractions.insert(node.name());
+    }
+  }
+  return small_contractions;
+}
+
 }  // end namespace
 
 Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
@@ -2233,9 +2321,22 @@ Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
     return Status::OK();
   }
 
+  absl::flat_hash_set<string> small_contractions;
+  if (mode_ == AutoMixedPrecisionMode::MKL && !ShouldIgnorePerformance()) {
+    // oneDNN only has fast bfloat16 kernels on some CPUs, and Eigen has none:
+    // its bfloat16 contractions compute in float32.
+    if (!IsMKLEnabled() || !HasFastBF16Support()) {
+      LOG(WARNING) << "No native bfloat16 support detected, skipping "
+                   << name() << " graph optimizer";
+      return Status::OK();
+    }
+    small_contractions = FindSmallCpuContractions(item);
+  }
+
   // Optimize the output graph in-place.
   AutoMixedPrecisionImpl optimizer(cluster, item.NodesToPreserve(), output,
-                                   item.id, mode_);
+                                   item.id, mode_,
+                                   std::move(small_contractions));
   if (item.id == "tf_graph") {
     LOG(INFO) << "Running " << name() << " graph optimizer";
   } else {
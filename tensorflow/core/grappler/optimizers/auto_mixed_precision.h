@@ -34,7 +34,9 @@ class AutoMixedPrecision : public GraphOptimizer {
  public:
   // If 'mode' is CUDA, converts nodes to float16 on Nvidia GPUs. If MKL,
   // converts nodes to bfloat16 on CPUs in order to take advantage of MKL
-  // performance improvements with bfloat16.
+  // performance improvements with bfloat16. This is only done if oneDNN is
+  // enabled and the CPU has native bfloat16 instructions, and contractions
+  // too small to pay for their casts are left in float32.
   explicit AutoMixedPrecision(
       AutoMixedPrecisionMode mode = AutoMixedPrecisionMode::CUDA)
       : mode_(mode) {}
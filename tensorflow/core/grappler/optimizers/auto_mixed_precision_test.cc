@@ -1354,10 +1354,17 @@ TEST_F(AutoMixedPrecisionCpuTest, MixedFanout) {
 class AutoMixedPrecisionMklTest : public GrapplerTest {
  protected:
   void SetUp() override {
+    if (!IsMKLEnabled() ||
+        !(port::TestCPUFeature(port::CPUFeature::AVX512_BF16) ||
+          port::TestCPUFeature(port::CPUFeature::AMX_BF16))) {
+      GTEST_SKIP() << "Test only applicable to CPUs with native bfloat16.";
+    }
     virtual_cluster_.reset(new SingleMachine(/* timeout_s = */ 10, 1, 0));
     TF_CHECK_OK(virtual_cluster_->Provision());
   }
-  void TearDown() override { TF_CHECK_OK(virtual_cluster_->Shutdown()); }
+  void TearDown() override {
+    if (virtual_cluster_) TF_CHECK_OK(virtual_cluster_->Shutdown());
+  }
 
   std::unique_ptr<Cluster> virtual_cluster_;
 };
@@ -1451,6 +1458,32 @@ TEST_F(AutoMixedPrecisionMklTest, Simple) {
   }
 }
 
+TEST_F(AutoMixedPrecisionMklTest, SmallContractionStaysFloat) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  // A matrix-vector product does 2 flops per element of its inputs, too few
+  // to pay for casting them, unlike the product of the square matrices.
+  Output input = ops::Const(s.WithOpName("input"), 1.f / 64, {64, 64});
+  Output vector = ops::Const(s.WithOpName("vector"), 1.f, {64, 1});
+  Output allow1 = ops::MatMul(s.WithOpName("allow1"), input, input);
+  Output small1 = ops::MatMul(s.WithOpName("small1"), input, vector);
+  Output fetch1 = ops::Identity(s.WithOpName("fetch1"), allow1);
+  Output fetch2 = ops::Identity(s.WithOpName("fetch2"), small1);
+
+  GrapplerItem item;
+  item.fetch = {"fetch1", "fetch2"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  AutoMixedPrecision optimizer{AutoMixedPrecisionMode::MKL};
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+  VLOG(1) << output.DebugString();
+
+  GraphView output_view(&output);
+  EXPECT_EQ(output_view.GetNode("allow1")->attr().at("T").type(), DT_BFLOAT16);
+  EXPECT_EQ(output_view.GetNode("small1")->attr().at("T").type(), DT_FLOAT);
+}
+
 TEST_F(AutoMixedPrecisionMklTest, TensorListSetGet) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
       "/job:localhost/replica:0/task:0/device:CPU:0");
@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 
 #include <cmath>
+#include <map>
 
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
@@ -25,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_def.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
@@ -45,7 +47,9 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/coding.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/denormal.h"
 #include "tensorflow/core/platform/env.h"
@@ -59,10 +63,42 @@ namespace tensorflow {
 namespace grappler {
 using TensorVector = gtl::InlinedVector<TensorValue, 4>;
 
-// We only fold/materialize constants smaller than 100kB.
+// We only fold/materialize constants smaller than 100kB, unless they are small
+// compared with the graph and expensive to compute (see
+// MaxFoldedConstantSize()).
 const int64_t kMaxConstantSize = 100 * 1024;
 
 namespace {
+
+// Constants may take up to this fraction of the size of the graph to optimize.
+constexpr int64_t kGraphSizeToMaxConstantSizeRatio = 10;
+
+// A constant larger than kMaxConstantSize is only folded if computing it took
+// at least this long per byte. Outputs that are filled or broadcast at memory
+// bandwidth are cheaper to recompute at run time than to store in the graph.
+constexpr int64_t kMinEvaluationNanosPerFoldedByte = 1;
+
+// The outputs that ConstantFoldingCache::Global() holds.
+constexpr int64_t kFoldingCacheCapacityBytes = 128 << 20;
+
+// The attributes that do not affect the outputs of a node.
+bool IsMetadataAttr(StringPiece attr_name) {
+  return attr_name == kColocationAttrName || attr_name == "_output_shapes";
+}
+
+// Appends `s` with its length, so that the parts of a key are unambiguous.
+void AppendKeyPart(string* key, StringPiece s) {
+  core::PutVarint64(key, s.size());
+  key->append(s.data(), s.size());
+}
+
+int64_t TensorBytes(const std::vector<absl::optional<Tensor>>& tensors) {
+  int64_t bytes = 0;
+  for (const absl::optional<Tensor>& tensor : tensors) {
+    if (tensor.has_value()) bytes += tensor->TotalBytes();
+  }
+  return bytes;
+}
 template <typename T>
 bool AllValuesAre(const TensorProto& proto, const T& value) {
   Tensor tensor;
@@ -194,7 +230,8 @@ ConstantFolding::ConstantFolding(RewriterConfig::Toggle opt_level,
       cpu_device_(cpu_device),
       disable_compressed_tensor_optimization_(
           disable_compressed_tensor_optimization),
-      fold_quantization_emulation_(fold_quantization_emulation) {
+      fold_quantization_emulation_(fold_quantization_emulation),
+      max_constant_size_(kMaxConstantSize) {
   resource_mgr_.reset(new ResourceMgr());
 }
 
@@ -205,6 +242,71 @@ ConstantFolding::ConstantFolding(DeviceBase* cpu_device,
                       disable_compressed_tensor_optimization,
                       fold_quantization_ops) {}
 
+ConstantFoldingCache* ConstantFoldingCache::Global() {
+  static ConstantFoldingCache* cache =
+      new ConstantFoldingCache(kFoldingCacheCapacityBytes);
+  return cache;
+}
+
+ConstantFoldingCache::ConstantFoldingCache(int64_t capacity_bytes)
+    : capacity_bytes_(capacity_bytes) {}
+
+// static
+Fprint128 ConstantFoldingCache::Key(
+    const NodeDef& node, const std::vector<const TensorProto*>& inputs) {
+  string key;
+  AppendKeyPart(&key, node.op());
+  // The attributes are in a hash map, whose order is not deterministic.
+  std::map<StringPiece, const AttrValue*> attrs;
+  for (const auto& attr : node.attr()) {
+    if (!IsMetadataAttr(attr.first)) attrs.emplace(attr.first, &attr.second);
+  }
+  string serialized;
+  for (const auto& attr : attrs) {
+    AppendKeyPart(&key, attr.first);
+    SerializeToStringDeterministic(*attr.second, &serialized);
+    AppendKeyPart(&key, serialized);
+  }
+  for (const TensorProto* input : inputs) {
+    SerializeToStringDeterministic(*input, &serialized);
+    AppendKeyPart(&key, serialized);
+  }
+  return Fingerprint128(key);
+}
+
+std::shared_ptr<const ConstantFoldingCache::Result>
+ConstantFoldingCache::Lookup(const Fprint128& key) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return nullptr;
+  ++num_hits_;
+  lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+  return it->second.result;
+}
+
+void ConstantFoldingCache::Insert(const Fprint128& key, Result result) {
+  const int64_t bytes = TensorBytes(result.outputs);
+  // A single result may not evict much of the cache.
+  if (bytes > capacity_bytes_ / 8) return;
+  auto shared_result = std::make_shared<const Result>(std::move(result));
+  mutex_lock l(mu_);
+  if (entries_.contains(key)) return;
+  while (!lru_.empty() && bytes_ + bytes > capacity_bytes_) {
+    auto it = entries_.find(lru_.back());
+    bytes_ -= it->second.bytes;
+    entries_.erase(it);
+    lru_.pop_back();
+  }
+  lru_.push_front(key);
+  entries_[key] = Entry{std::move(shared_result), bytes, lru_.begin()};
+  bytes_ += bytes;
+}
+
+int64_t ConstantFoldingCache::num_hits() const {
+  mutex_lock l(mu_);
+  return num_hits_;
+}
+
 // static
 string ConstantFolding::AddControlDependency(const string& input_name,
                                              GraphDef* graph,
@@ -1026,7 +1128,7 @@ bool ConstantFolding::IsFoldableUncached(
       if (output_shape.IsFullyDefined()) {
         const int64_t num_bytes =
             output_shape.num_elements() * DataTypeSize(output_prop.dtype());
-        if (num_bytes > input_size_bytes && num_bytes > kMaxConstantSize) {
+        if (num_bytes > input_size_bytes && num_bytes > max_constant_size_) {
           // Do not fold nodes if the in-memory size of output is too large.
           // Notice that this is not exactly the same check used in
           // CreateNodeDef() where the actual encoded size is checked.
@@ -1347,6 +1449,7 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
   });
 
   size_t total_inputs_size = 0;
+  std::vector<const TensorProto*> input_protos;
   for (const auto& input : node.input()) {
     const TensorId input_tensor = ParseTensorName(input);
     if (input_tensor.index() < 0) {
@@ -1381,13 +1484,42 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
                                      raw_val.tensor_shape().DebugString());
     }
     inputs.emplace_back(value);
+    input_protos.push_back(&raw_val);
     total_inputs_size += value->TotalBytes();
   }
 
-  TF_RETURN_IF_ERROR(EvaluateNode(node, inputs, &output_tensors));
+  // The same nodes are folded again in later iterations of the meta optimizer
+  // and in the functions of the library.
+  ConstantFoldingCache* cache = ConstantFoldingCache::Global();
+  const Fprint128 key = ConstantFoldingCache::Key(node, input_protos);
+  std::shared_ptr<const ConstantFoldingCache::Result> cached_result =
+      cache->Lookup(key);
+  int64_t evaluation_nanos;
+  if (cached_result != nullptr) {
+    for (const absl::optional<Tensor>& output : cached_result->outputs) {
+      output_tensors.emplace_back(output.has_value() ? new Tensor(*output)
+                                                     : nullptr);
+    }
+    evaluation_nanos = cached_result->evaluation_nanos;
+  } else {
+    const uint64 start_nanos = Env::Default()->NowNanos();
+    TF_RETURN_IF_ERROR(EvaluateNode(node, inputs, &output_tensors));
+    evaluation_nanos = Env::Default()->NowNanos() - start_nanos;
+    ConstantFoldingCache::Result result;
+    for (const TensorValue& output : output_tensors) {
+      result.outputs.push_back(output.tensor != nullptr
+                                   ? absl::make_optional(*output.tensor)
+                                   : absl::nullopt);
+    }
+    result.evaluation_nanos = evaluation_nanos;
+    cache->Insert(key, std::move(result));
+  }
   if (output_tensors.empty()) {
     return Status(error::INVALID_ARGUMENT, "Expected at least one output.");
   }
+  // Outputs that do not grow the graph are always folded.
+  const size_t max_folded_size = std::max<size_t>(
+      total_inputs_size, MaxFoldedConstantSize(evaluation_nanos));
 
   outputs->resize(output_tensors.size());
   for (size_t i = 0; i < output_tensors.size(); i++) {
@@ -1397,7 +1529,7 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
     }
     if (output_tensors[i].tensor) {
       Status s = CreateNodeDef(node_name, output_tensors[i], &outputs->at(i),
-                               total_inputs_size);
+                               max_folded_size);
       if (!s.ok()) {
         *result_too_large = true;
         return s;
@@ -1411,6 +1543,13 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
   return Status::OK();
 }
 
+int64_t ConstantFolding::MaxFoldedConstantSize(int64_t evaluation_nanos) const {
+  return std::max(
+      kMaxConstantSize,
+      std::min(max_constant_size_,
+               evaluation_nanos / kMinEvaluationNanosPerFoldedByte));
+}
+
 Status ConstantFolding::FoldMergeNode(NodeDef* node, GraphDef* output_graph) {
   // Merge nodes are special, in the sense that they execute as soon as one of
   // their input is ready. We can therefore fold a merge node iff it has at
@@ -4046,6 +4185,9 @@ Status ConstantFolding::Optimize(Cluster* cluster, const GrapplerItem& item,
   }
 
   has_fetch_ = !item.fetch.empty();
+  max_constant_size_ =
+      std::max<int64_t>(kMaxConstantSize, item.graph.ByteSizeLong() /
+                                              kGraphSizeToMaxConstantSizeRatio);
   GrapplerItem item_to_optimize = item;
   GraphProperties properties(item_to_optimize);
   // It's possible to feed a placeholder with a tensor of any shape: make sure
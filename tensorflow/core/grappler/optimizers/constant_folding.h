@@ -16,8 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CONSTANT_FOLDING_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CONSTANT_FOLDING_H_
 
+#include <list>
+#include <memory>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -26,6 +31,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 
 namespace tensorflow {
@@ -35,6 +43,58 @@ const char kConstantFoldingConst[] = "ConstantFolding";
 const char kConstantFoldingCtrl[] = "ConstantFoldingCtrl";
 extern const int64_t kMaxConstantSize;
 
+// A process-wide cache of the outputs of the nodes that constant folding
+// evaluated, keyed by a fingerprint of the node and of its constant inputs.
+// The meta optimizer runs constant folding several times on each graph and on
+// each function of its library, which often evaluates the same nodes again.
+class ConstantFoldingCache {
+ public:
+  struct Result {
+    // The outputs of the node, or nullopt for its dead outputs.
+    std::vector<absl::optional<Tensor>> outputs;
+    // How long the evaluation of the node took.
+    int64_t evaluation_nanos = 0;
+  };
+
+  // Returns the cache that ConstantFolding uses.
+  static ConstantFoldingCache* Global();
+
+  // Holds at most `capacity_bytes` of outputs, and evicts the least recently
+  // used results.
+  explicit ConstantFoldingCache(int64_t capacity_bytes);
+
+  // Returns the key of `node` with the values of its inputs.
+  static Fprint128 Key(const NodeDef& node,
+                       const std::vector<const TensorProto*>& inputs);
+
+  // Returns the cached result for `key`, or nullptr.
+  std::shared_ptr<const Result> Lookup(const Fprint128& key)
+      TF_LOCKS_EXCLUDED(mu_);
+  // Caches `result` unless its outputs are too large.
+  void Insert(const Fprint128& key, Result result) TF_LOCKS_EXCLUDED(mu_);
+
+  int64_t num_hits() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Entry {
+    std::shared_ptr<const Result> result;
+    int64_t bytes;
+    // The position of the key in `lru_`.
+    std::list<Fprint128>::iterator lru_position;
+  };
+
+  const int64_t capacity_bytes_;
+  mutable mutex mu_;
+  absl::flat_hash_map<Fprint128, Entry, Fprint128Hasher> entries_
+      TF_GUARDED_BY(mu_);
+  // The keys of `entries_`, most recently used first.
+  std::list<Fprint128> lru_ TF_GUARDED_BY(mu_);
+  int64_t bytes_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_hits_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ConstantFoldingCache);
+};
+
 // Constant folding optimization for a graph.
 class ConstantFolding : public GraphOptimizer {
  public:
@@ -95,6 +155,11 @@ class ConstantFolding : public GraphOptimizer {
   Status EvaluateOneFoldable(const NodeDef& node, std::vector<NodeDef>* outputs,
                              bool* result_too_large);
 
+  // Returns the largest size, in bytes, of the constants that a node whose
+  // evaluation took `evaluation_nanos` may be folded into, even if they are
+  // larger than its inputs.
+  int64_t MaxFoldedConstantSize(int64_t evaluation_nanos) const;
+
   Status FoldMergeNode(NodeDef* node, GraphDef* output_graph);
   Status FoldNode(NodeDef* node, GraphDef* output_graph,
                   bool* result_too_large);
@@ -340,6 +405,9 @@ class ConstantFolding : public GraphOptimizer {
   bool graph_contains_assign_or_inplace_op_;
   bool disable_compressed_tensor_optimization_;
   bool fold_quantization_emulation_;
+  // The largest constant that may be folded, which grows with the size of the
+  // graph being optimized.
+  int64_t max_constant_size_;
 };
 
 }  // end namespace grappler
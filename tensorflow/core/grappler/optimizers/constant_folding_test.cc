@@ -3001,6 +3001,38 @@ TEST_F(ConstantFoldingTest, Packing) {
   EXPECT_GT(8000, output.ByteSizeLong());
 }
 
+TEST_F(ConstantFoldingTest, CachedFolding) {
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  Output a = ops::Const(scope.WithOpName("a"), 2.5f, {7, 3});
+  Output b = ops::Const(scope.WithOpName("b"), 1.25f, {7, 3});
+  Output add = ops::Add(scope.WithOpName("add"), a, b);
+  Output out = ops::Identity(scope.WithOpName("out"), add);
+
+  GrapplerItem item;
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+  item.fetch.push_back("out");
+
+  ConstantFolding optimizer(/*cpu_device=*/nullptr);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+
+  // Folding the same graph again reuses the evaluation of "add".
+  ConstantFoldingCache* cache = ConstantFoldingCache::Global();
+  const int64_t num_hits = cache->num_hits();
+  ConstantFolding cached_optimizer(/*cpu_device=*/nullptr);
+  GraphDef cached_output;
+  TF_EXPECT_OK(
+      cached_optimizer.Optimize(/*cluster=*/nullptr, item, &cached_output));
+  EXPECT_GE(cache->num_hits(), num_hits + 1);
+  CompareGraphs(output, cached_output);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(cached_output, item.fetch);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+}
+
 TEST_F(ConstantFoldingTest, LargeConstantNoSizeIncrease) {
   // Build a simple graph with a large constant with size greater than
   // kMaxConstantSize that can be folded because the resulting size does not
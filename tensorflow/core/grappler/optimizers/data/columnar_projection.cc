@@ -0,0 +1,218 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/columnar_projection.h"
+
+#include <array>
+#include <set>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kColumnarDataset[] = "ColumnarDataset";
+constexpr char kColumnsAttr[] = "columns";
+
+// Datasets that pass the elements of their input through without looking at
+// them.
+constexpr std::array<const char*, 11> kPassThroughDatasetOps = {
+    "BatchDataset",      "BatchDatasetV2",     "PrefetchDataset",
+    "RepeatDataset",     "ShardDataset",       "ShuffleDataset",
+    "ShuffleDatasetV2",  "ShuffleDatasetV3",   "ShuffleAndRepeatDataset",
+    "SkipDataset",       "TakeDataset"};
+
+constexpr std::array<const char*, 3> kMapDatasetOps = {
+    "MapDataset", "ParallelMapDataset", "ParallelMapDatasetV2"};
+
+bool IsOneOf(const string& op, absl::Span<const char* const> ops) {
+  for (const char* candidate : ops) {
+    if (op == candidate) return true;
+  }
+  return false;
+}
+
+// Adds the strings of the constant `input` of `function` to `keys`. Returns
+// false if `input` is not a constant string tensor.
+bool AddConstKeys(const string& input, const FunctionDef& function,
+                  std::set<string>* keys) {
+  const int index = function_utils::FindFunctionNodeWithName(
+      function_utils::FunctionDefTensorDesc(input).node_name, function);
+  if (index == -1) return false;
+  const NodeDef& node = function.node_def(index);
+  if (node.op() != "Const" || !node.attr().count("value")) return false;
+  Tensor tensor;
+  if (!tensor.FromProto(node.attr().at("value").tensor()) ||
+      tensor.dtype() != DT_STRING) {
+    return false;
+  }
+  for (const tstring& key : tensor.flat<tstring>()) {
+    keys->insert(key);
+  }
+  return true;
+}
+
+// Adds the features parsed by `node` to `keys`. Returns false if the keys are
+// not constant.
+bool AddParsedFeatures(const NodeDef& node, const FunctionDef& function,
+                       std::set<string>* keys) {
+  if (node.op() == "ParseExampleV2") {
+    // Inputs are serialized, names, sparse_keys, dense_keys, ragged_keys, and
+    // dense_defaults.
+    if (node.input_size() < 5) return false;
+    for (int i = 2; i < 5; ++i) {
+      if (!AddConstKeys(node.input(i), function, keys)) return false;
+    }
+    return true;
+  }
+  if (node.op() == "ParseExample") {
+    // Inputs are serialized, names, the Nsparse sparse keys, the Ndense dense
+    // keys, and dense_defaults.
+    if (!node.attr().count("Nsparse") || !node.attr().count("Ndense")) {
+      return false;
+    }
+    const int num_keys =
+        node.attr().at("Nsparse").i() + node.attr().at("Ndense").i();
+    if (node.input_size() < 2 + num_keys) return false;
+    for (int i = 2; i < 2 + num_keys; ++i) {
+      if (!AddConstKeys(node.input(i), function, keys)) return false;
+    }
+    return true;
+  }
+  if (node.op() == "ParseSingleExample") {
+    for (const char* attr : {"sparse_keys", "dense_keys"}) {
+      if (!node.attr().count(attr)) return false;
+      for (const string& key : node.attr().at(attr).list().s()) {
+        keys->insert(key);
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+// Adds the features parsed from the element by the map function `function` to
+// `keys`. Returns false if the function uses the element for anything but the
+// `serialized` input of parse ops, as it then depends on the other features.
+bool GetParsedFeatures(const FunctionDef& function, std::set<string>* keys) {
+  if (function.signature().input_arg_size() == 0) return false;
+
+  // The tensors that are the element: the argument and its identities.
+  absl::flat_hash_set<string> element = {
+      function.signature().input_arg(0).name()};
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (const NodeDef& node : function.node_def()) {
+      if (node.op() != "Identity" || node.input_size() == 0 ||
+          !element.contains(node.input(0))) {
+        continue;
+      }
+      changed |= element.insert(strings::StrCat(node.name(), ":output:0"))
+                     .second;
+    }
+  }
+
+  bool parsed = false;
+  for (const NodeDef& node : function.node_def()) {
+    for (int i = 0; i < node.input_size(); ++i) {
+      if (!element.contains(node.input(i))) continue;
+      if (node.op() == "Identity") continue;
+      if (i != 0 || !AddParsedFeatures(node, function, keys)) return false;
+      parsed = true;
+    }
+  }
+  for (const auto& ret : function.ret()) {
+    if (element.contains(ret.second)) return false;
+  }
+  return parsed;
+}
+
+// Returns the features parsed from the elements of the `ColumnarDataset`
+// `node`, or false if the elements are used in other ways.
+bool GetProjectedColumns(const NodeDef& node, const MutableGraphView& graph,
+                         const FunctionLibraryDefinition& function_library,
+                         std::set<string>* columns) {
+  const NodeDef* current = &node;
+  while (true) {
+    const auto fanouts = graph.GetFanouts(*current,
+                                          /*include_controlled_nodes=*/false);
+    if (fanouts.size() != 1) return false;
+    const auto& fanout = *fanouts.begin();
+    if (fanout.port_id != 0) return false;
+    current = fanout.node;
+    if (IsOneOf(current->op(), kPassThroughDatasetOps)) continue;
+    if (!IsOneOf(current->op(), kMapDatasetOps)) return false;
+
+    const FunctionDef* function =
+        function_library.Find(current->attr().at("f").func().name());
+    return function != nullptr && GetParsedFeatures(*function, columns) &&
+           !columns->empty();
+  }
+}
+
+}  // namespace
+
+Status ColumnarProjection::OptimizeAndCollectStats(Cluster* cluster,
+                                                   const GrapplerItem& item,
+                                                   GraphDef* output,
+                                                   OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+
+  for (NodeDef& node : *output->mutable_node()) {
+    if (node.op() != kColumnarDataset) continue;
+    // Datasets that already read a subset of the features are left as is.
+    if (node.attr().count(kColumnsAttr) &&
+        node.attr().at(kColumnsAttr).list().s_size() > 0) {
+      continue;
+    }
+
+    std::set<string> columns;
+    if (!GetProjectedColumns(node, graph, function_library, &columns)) {
+      continue;
+    }
+    VLOG(2) << "Projecting " << node.name() << " to "
+            << absl::StrJoin(columns, ", ");
+    AttrValue::ListValue* list =
+        (*node.mutable_attr())[kColumnsAttr].mutable_list();
+    for (const string& column : columns) {
+      list->add_s(column);
+    }
+    stats->num_changes++;
+  }
+  return Status::OK();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(ColumnarProjection, "columnar_projection");
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,55 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_COLUMNAR_PROJECTION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_COLUMNAR_PROJECTION_H_
+
+#include "tensorflow/core/grappler/optimizers/data/optimizer_base.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// This optimization pushes the features parsed from the elements of a
+// `ColumnarDataset` down into the dataset, so that only these features are
+// read from its files.
+//
+// It applies when the elements of the dataset, possibly after a chain of
+// datasets that do not look at them (e.g. batch, shuffle, or prefetch), are
+// mapped by a function that only passes them to `ParseExample` ops with
+// constant keys. The `columns` of the dataset are then set to the union of the
+// dense, sparse, and ragged keys of these ops.
+class ColumnarProjection : public TFDataOptimizerBase {
+ public:
+  ColumnarProjection() = default;
+  ~ColumnarProjection() override = default;
+
+  string name() const override { return "columnar_projection"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return Status::OK();
+  }
+
+  Status OptimizeAndCollectStats(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* output,
+                                 OptimizationStats* stats) override;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_COLUMNAR_PROJECTION_H_
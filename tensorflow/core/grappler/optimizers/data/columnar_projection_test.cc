@@ -0,0 +1,158 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/columnar_projection.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using graph_tests_utils::MakeMapNode;
+using graph_tests_utils::MakePrefetchNode;
+using test::function::NDef;
+using ::testing::ElementsAre;
+
+constexpr char kParseFunction[] = "ParseFeatures";
+constexpr char kParseAndReturnFunction[] = "ParseAndReturnElement";
+
+Status OptimizeWithColumnarProjection(const GrapplerItem& item,
+                                      GraphDef* output) {
+  ColumnarProjection optimizer;
+  return optimizer.Optimize(nullptr, item, output);
+}
+
+// Parses the dense features "a" and "c" and the sparse feature "b" of its
+// argument. With `return_element`, also returns the argument.
+FunctionDef ParseFeatures(bool return_element) {
+  auto string_const = [](const string& name,
+                         const std::vector<tstring>& values) {
+    return FunctionDefHelper::Node{
+        {name},
+        "Const",
+        {},
+        {{"value", test::AsTensor<tstring>(
+                       values, {static_cast<int64_t>(values.size())})},
+         {"dtype", DT_STRING}}};
+  };
+  std::vector<string> outputs = {"a: int64"};
+  std::vector<std::pair<string, string>> rets = {
+      {"a", "parsed:dense_values:0"}};
+  if (return_element) {
+    outputs.push_back("element: string");
+    rets.emplace_back("element", "identity:output:0");
+  }
+  return FunctionDefHelper::Create(
+      return_element ? kParseAndReturnFunction : kParseFunction,
+      {"serialized: string"}, outputs, {},
+      {string_const("names", {}), string_const("sparse_keys", {"b"}),
+       string_const("dense_keys", {"c", "a"}),
+       string_const("ragged_keys", {}),
+       {{"identity"}, "Identity", {"serialized"}, {{"T", DT_STRING}}},
+       {{"parsed"},
+        "ParseExampleV2",
+        {"identity:output:0", "names:output:0", "sparse_keys:output:0",
+         "dense_keys:output:0", "ragged_keys:output:0"},
+        {}}},
+      rets);
+}
+
+NodeDef MakeColumnarNode(const string& name,
+                         const std::vector<string>& columns) {
+  return NDef(name, "ColumnarDataset", {"filenames"}, {{"columns", columns}});
+}
+
+std::vector<string> GetColumns(const GraphDef& graph, const string& name) {
+  const NodeDef& node =
+      graph.node(graph_utils::FindGraphNodeWithName(name, graph));
+  const auto& columns = node.attr().at("columns").list().s();
+  return {columns.begin(), columns.end()};
+}
+
+TEST(ColumnarProjectionTest, ProjectsParsedFeatures) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("filenames", "Const", {}, {{"value", ""}, {"dtype", DT_STRING}}),
+       NDef("buffer_size", "Const", {}, {{"value", 1}, {"dtype", DT_INT64}}),
+       MakeColumnarNode("columnar", {}),
+       MakePrefetchNode("prefetch", "columnar", "buffer_size"),
+       MakeMapNode("map", "prefetch", kParseFunction),
+       NDef("Sink", "Identity", {"map"}, {})},
+      {ParseFeatures(/*return_element=*/false)});
+  item.fetch.push_back("Sink");
+
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithColumnarProjection(item, &output));
+  EXPECT_THAT(GetColumns(output, "columnar"), ElementsAre("a", "b", "c"));
+}
+
+TEST(ColumnarProjectionTest, ElementReturnedByFunction) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("filenames", "Const", {}, {{"value", ""}, {"dtype", DT_STRING}}),
+       MakeColumnarNode("columnar", {}),
+       MakeMapNode("map", "columnar", kParseAndReturnFunction),
+       NDef("Sink", "Identity", {"map"}, {})},
+      {ParseFeatures(/*return_element=*/true)});
+  item.fetch.push_back("Sink");
+
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithColumnarProjection(item, &output));
+  EXPECT_TRUE(GetColumns(output, "columnar").empty());
+}
+
+TEST(ColumnarProjectionTest, ElementsConsumedTwice) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("filenames", "Const", {}, {{"value", ""}, {"dtype", DT_STRING}}),
+       MakeColumnarNode("columnar", {}),
+       MakeMapNode("map", "columnar", kParseFunction),
+       NDef("Sink", "Identity", {"map"}, {}),
+       NDef("Sink2", "Identity", {"columnar"}, {})},
+      {ParseFeatures(/*return_element=*/false)});
+  item.fetch.push_back("Sink");
+  item.fetch.push_back("Sink2");
+
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithColumnarProjection(item, &output));
+  EXPECT_TRUE(GetColumns(output, "columnar").empty());
+}
+
+TEST(ColumnarProjectionTest, KeepsExistingProjection) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("filenames", "Const", {}, {{"value", ""}, {"dtype", DT_STRING}}),
+       MakeColumnarNode("columnar", {"x"}),
+       MakeMapNode("map", "columnar", kParseFunction),
+       NDef("Sink", "Identity", {"map"}, {})},
+      {ParseFeatures(/*return_element=*/false)});
+  item.fetch.push_back("Sink");
+
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithColumnarProjection(item, &output));
+  EXPECT_THAT(GetColumns(output, "columnar"), ElementsAre("x"));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
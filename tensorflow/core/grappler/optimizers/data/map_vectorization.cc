@@ -0,0 +1,299 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kMapDataset[] = "MapDataset";
+constexpr char kParallelMapDataset[] = "ParallelMapDataset";
+constexpr char kParallelMapDatasetV2[] = "ParallelMapDatasetV2";
+constexpr char kBatchDataset[] = "BatchDataset";
+constexpr char kBatchDatasetV2[] = "BatchDatasetV2";
+constexpr char kMapDefun[] = "MapDefun";
+constexpr char kDecodeJpeg[] = "DecodeJpeg";
+constexpr char kBatchDecodeJpeg[] = "BatchDecodeJpeg";
+constexpr char kOutputShapes[] = "output_shapes";
+constexpr char kOutputTypes[] = "output_types";
+
+bool IsMap(const NodeDef& node) {
+  return node.op() == kMapDataset || node.op() == kParallelMapDataset ||
+         node.op() == kParallelMapDatasetV2;
+}
+
+bool IsBatch(const NodeDef& node) {
+  return node.op() == kBatchDataset || node.op() == kBatchDatasetV2;
+}
+
+// Sets the `output_types` and `output_shapes` attributes of `spec` to those of
+// the elements produced by `node`. Returns false if the elements can not be
+// safely batched, i.e. if their shapes are not fully defined or they contain
+// variants or resources.
+bool GetBatchableElementSpec(const NodeDef& node, NodeDef* spec) {
+  if (!graph_utils::CopyShapesAndTypesAttrs(node, spec)) {
+    return false;
+  }
+  const auto& types = spec->attr().at(kOutputTypes).list();
+  const auto& shapes = spec->attr().at(kOutputShapes).list();
+  if (types.type_size() == 0 || types.type_size() != shapes.shape_size()) {
+    return false;
+  }
+  for (int i = 0; i < types.type_size(); ++i) {
+    if (types.type(i) == DT_VARIANT || types.type(i) == DT_RESOURCE ||
+        !PartialTensorShape(shapes.shape(i)).IsFullyDefined()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns a function that applies the function of `map_node` to each element
+// of a batch with the given element types, using a single `MapDefun` op.
+FunctionDef MakeVectorizedFunction(const NodeDef& map_node,
+                                   const NodeDef& element_spec,
+                                   const FunctionDefLibrary& library) {
+  FunctionDef function;
+  graph_utils::SetUniqueGraphFunctionName("vectorized_map", &library,
+                                          &function);
+  OpDef* signature = function.mutable_signature();
+  NodeDef* map_defun = function.add_node_def();
+  map_defun->set_name("map_defun");
+  map_defun->set_op(kMapDefun);
+
+  const auto& element_types = element_spec.attr().at(kOutputTypes);
+  for (int i = 0; i < element_types.list().type_size(); ++i) {
+    auto* arg = signature->add_input_arg();
+    arg->set_name(strings::StrCat("arg_", i));
+    arg->set_type(element_types.list().type(i));
+    map_defun->add_input(arg->name());
+  }
+  const auto& captured_types = map_node.attr().at("Targuments");
+  for (int i = 0; i < captured_types.list().type_size(); ++i) {
+    auto* arg = signature->add_input_arg();
+    arg->set_name(strings::StrCat("captured_", i));
+    arg->set_type(captured_types.list().type(i));
+    map_defun->add_input(arg->name());
+  }
+  const auto& output_types = map_node.attr().at(kOutputTypes);
+  for (int i = 0; i < output_types.list().type_size(); ++i) {
+    auto* arg = signature->add_output_arg();
+    arg->set_name(strings::StrCat("output_", i));
+    arg->set_type(output_types.list().type(i));
+    (*function.mutable_ret())[arg->name()] =
+        strings::StrCat(map_defun->name(), ":output:", i);
+  }
+
+  auto* attr = map_defun->mutable_attr();
+  (*attr)["Targuments"] = element_types;
+  (*attr)["Tcaptured"] = captured_types;
+  graph_utils::CopyAttribute(kOutputTypes, map_node, map_defun);
+  graph_utils::CopyAttribute(kOutputShapes, map_node, map_defun);
+  graph_utils::CopyAttribute("f", map_node, map_defun);
+  return function;
+}
+
+// Returns `tensor` of `function`, looking through the `Identity` nodes that
+// produce it.
+string SkipIdentities(string tensor, const FunctionDef& function) {
+  while (true) {
+    const int index = function_utils::FindFunctionNodeWithName(
+        function_utils::FunctionDefTensorDesc(tensor).node_name, function);
+    if (index == -1 || !IsIdentity(function.node_def(index))) return tensor;
+    tensor = function.node_def(index).input(0);
+  }
+}
+
+// Returns the `DecodeJpeg` node of `function` if the function only returns the
+// decoded image of its single argument, and nullptr otherwise.
+const NodeDef* GetDecodeJpegNode(const FunctionDef& function) {
+  const OpDef& signature = function.signature();
+  if (signature.input_arg_size() != 1 || signature.output_arg_size() != 1) {
+    return nullptr;
+  }
+  const auto ret = function.ret().find(signature.output_arg(0).name());
+  if (ret == function.ret().end()) return nullptr;
+  const int index = function_utils::FindFunctionNodeWithName(
+      function_utils::FunctionDefTensorDesc(
+          SkipIdentities(ret->second, function))
+          .node_name,
+      function);
+  if (index == -1) return nullptr;
+  const NodeDef& node = function.node_def(index);
+  // Control inputs would be dropped by the rewrite.
+  if (node.op() != kDecodeJpeg || node.input_size() != 1) return nullptr;
+  if (SkipIdentities(node.input(0), function) !=
+      signature.input_arg(0).name()) {
+    return nullptr;
+  }
+  return &node;
+}
+
+// Returns a function that decodes a batch of images with the attributes of
+// `decode_node` using a single `BatchDecodeJpeg` op, which decodes the images
+// in parallel and directly into the batch.
+FunctionDef MakeBatchDecodeJpegFunction(const NodeDef& decode_node,
+                                        const FunctionDefLibrary& library) {
+  FunctionDef function;
+  graph_utils::SetUniqueGraphFunctionName("vectorized_decode_jpeg", &library,
+                                          &function);
+  OpDef* signature = function.mutable_signature();
+  auto* contents = signature->add_input_arg();
+  contents->set_name("contents");
+  contents->set_type(DT_STRING);
+  auto* image = signature->add_output_arg();
+  image->set_name("image");
+  image->set_type(DT_UINT8);
+
+  NodeDef* batch_decode = function.add_node_def();
+  batch_decode->set_name("batch_decode_jpeg");
+  batch_decode->set_op(kBatchDecodeJpeg);
+  batch_decode->add_input(contents->name());
+  for (const auto& attr : decode_node.attr()) {
+    // Internal attributes such as `_output_shapes` describe a single image.
+    if (absl::StartsWith(attr.first, "_")) continue;
+    (*batch_decode->mutable_attr())[attr.first] = attr.second;
+  }
+  (*function.mutable_ret())[image->name()] =
+      strings::StrCat(batch_decode->name(), ":image:0");
+  return function;
+}
+
+// Returns a copy of `batch_node` that batches the input of `map_node`, whose
+// elements are described by `element_spec`.
+NodeDef MakeBatchNode(const NodeDef& batch_node, const NodeDef& map_node,
+                      const NodeDef& element_spec, MutableGraphView* graph) {
+  NodeDef new_node = batch_node;
+  graph_utils::SetUniqueGraphNodeName(batch_node.op(), graph->graph(),
+                                      &new_node);
+  new_node.set_input(0, map_node.input(0));
+
+  int64_t batch_dim = -1;
+  const auto& batch_shapes = batch_node.attr().at(kOutputShapes).list();
+  if (batch_shapes.shape_size() > 0 && !batch_shapes.shape(0).unknown_rank() &&
+      batch_shapes.shape(0).dim_size() > 0) {
+    batch_dim = batch_shapes.shape(0).dim(0).size();
+  }
+  graph_utils::CopyAttribute(kOutputTypes, element_spec, &new_node);
+  auto* shapes = (*new_node.mutable_attr())[kOutputShapes].mutable_list();
+  shapes->clear_shape();
+  for (const auto& element_shape :
+       element_spec.attr().at(kOutputShapes).list().shape()) {
+    TensorShapeProto* shape = shapes->add_shape();
+    shape->add_dim()->set_size(batch_dim);
+    for (const auto& dim : element_shape.dim()) {
+      *shape->add_dim() = dim;
+    }
+  }
+  return new_node;
+}
+
+// Returns a copy of `map_node` that applies `function` to the batches produced
+// by `batch_input`, which replaces `batch_node`.
+NodeDef MakeMapNode(const NodeDef& map_node, const NodeDef& batch_node,
+                    const NodeDef& batch_input, const FunctionDef& function,
+                    MutableGraphView* graph) {
+  NodeDef new_node = map_node;
+  graph_utils::SetUniqueGraphNodeName(map_node.op(), graph->graph(),
+                                      &new_node);
+  new_node.set_input(0, batch_input.name());
+  AttrValue f;
+  f.mutable_func()->set_name(function.signature().name());
+  (*new_node.mutable_attr())["f"] = std::move(f);
+  graph_utils::CopyShapesAndTypesAttrs(batch_node, &new_node);
+  return new_node;
+}
+
+}  // namespace
+
+Status MapVectorization::OptimizeAndCollectStats(Cluster* cluster,
+                                                 const GrapplerItem& item,
+                                                 GraphDef* output,
+                                                 OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+
+  for (const NodeDef& node : item.graph.node()) {
+    if (!IsBatch(node)) continue;
+    const NodeDef& batch_node = node;
+    NodeDef* map_node = graph_utils::GetInputNode(batch_node, graph);
+    if (!IsMap(*map_node)) continue;
+    // The map must only feed the batch, which it is moved behind.
+    if (graph.GetFanouts(*map_node, /*include_controlled_nodes=*/true)
+            .size() != 1) {
+      continue;
+    }
+    const FunctionDef* function =
+        function_library.Find(map_node->attr().at("f").func().name());
+    if (function == nullptr ||
+        function_utils::IsFunctionStateful(function_library, *function)) {
+      continue;
+    }
+    NodeDef element_spec;
+    if (!GetBatchableElementSpec(*graph_utils::GetInputNode(*map_node, graph),
+                                 &element_spec)) {
+      VLOG(1) << "Not vectorizing " << map_node->name()
+              << " because its input elements can not be batched.";
+      continue;
+    }
+
+    // Decoding JPEGs has a batched kernel, which is used instead of applying
+    // the function to each element of the batch.
+    const NodeDef* decode_node = GetDecodeJpegNode(*function);
+    FunctionDef vectorized_function =
+        decode_node != nullptr
+            ? MakeBatchDecodeJpegFunction(*decode_node, output->library())
+            : MakeVectorizedFunction(*map_node, element_spec,
+                                     output->library());
+    auto* new_batch_node = graph.AddNode(
+        MakeBatchNode(batch_node, *map_node, element_spec, &graph));
+    auto* new_map_node = graph.AddNode(MakeMapNode(
+        *map_node, batch_node, *new_batch_node, vectorized_function, &graph));
+    TF_RETURN_IF_ERROR(
+        graph.UpdateFanouts(batch_node.name(), new_map_node->name()));
+    *output->mutable_library()->add_function() = std::move(vectorized_function);
+
+    nodes_to_delete.insert(map_node->name());
+    nodes_to_delete.insert(batch_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return Status::OK();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapVectorization, "map_vectorization");
+
+}  // namespace grappler
+}  // namespace tensorflow
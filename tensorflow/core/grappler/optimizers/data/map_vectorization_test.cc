@@ -0,0 +1,200 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+// Returns range(10).map(`function_name`).batch(5), where the elements of the
+// range have the given shape.
+GrapplerItem MakeMapAndBatchItem(const string& function_name,
+                                 const PartialTensorShape& element_shape) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT64}}),
+       NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT64}}),
+       NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT64}}),
+       NDef("range", "RangeDataset", {"start", "stop", "step"},
+            {{"output_shapes", gtl::ArraySlice<PartialTensorShape>{
+                                   element_shape}},
+             {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}}),
+       NDef("map", "MapDataset", {"range"},
+            {{"f", FunctionDefHelper::FunctionRef(function_name,
+                                                  {{"T", DT_INT64}})},
+             {"Targuments", gtl::ArraySlice<DataType>{}},
+             {"output_shapes",
+              gtl::ArraySlice<PartialTensorShape>{element_shape}},
+             {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}}),
+       NDef("batch_size", "Const", {}, {{"value", 5}, {"dtype", DT_INT64}}),
+       NDef("drop_remainder", "Const", {},
+            {{"value", false}, {"dtype", DT_BOOL}}),
+       NDef("batch", "BatchDatasetV2", {"map", "batch_size", "drop_remainder"},
+            {{"parallel_copy", false},
+             {"output_shapes", gtl::ArraySlice<PartialTensorShape>{
+                                   PartialTensorShape({-1})}},
+             {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}}),
+       NDef("Sink", "Identity", {"batch"}, {})},
+      // FunctionLib
+      {
+          test::function::XTimesTwo(),
+          test::function::RandomUniformLess(),
+      });
+  item.fetch.push_back("Sink");
+  return item;
+}
+
+TEST(MapVectorizationTest, MovesMapBehindBatch) {
+  GrapplerItem item = MakeMapAndBatchItem("XTimesTwo", PartialTensorShape({}));
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("batch", output));
+  const NodeDef& map_node =
+      output.node(graph_utils::FindGraphNodeWithOp("MapDataset", output));
+  const NodeDef& batch_node =
+      output.node(graph_utils::FindGraphNodeWithOp("BatchDatasetV2", output));
+  EXPECT_EQ(batch_node.input(0), "range");
+  EXPECT_EQ(map_node.input(0), batch_node.name());
+  const NodeDef& sink_node =
+      output.node(graph_utils::FindGraphNodeWithName("Sink", output));
+  EXPECT_EQ(sink_node.input(0), map_node.name());
+
+  // The batch produces batches of the range elements, and the map keeps the
+  // shapes of the original batch.
+  EXPECT_EQ(batch_node.attr().at("output_shapes").list().shape(0).dim(0).size(),
+            -1);
+  EXPECT_TRUE(AreAttrValuesEqual(
+      map_node.attr().at("output_shapes"),
+      item.graph.node(graph_utils::FindGraphNodeWithName("batch", item.graph))
+          .attr()
+          .at("output_shapes")));
+
+  // The map function applies the original function with `MapDefun`.
+  const int index = graph_utils::FindGraphFunctionWithName(
+      map_node.attr().at("f").func().name(), output.library());
+  ASSERT_NE(index, -1);
+  const FunctionDef& function = output.library().function(index);
+  ASSERT_TRUE(function_utils::ContainsFunctionNodeWithOp("MapDefun", function));
+  const NodeDef& map_defun = function.node_def(
+      function_utils::FindFunctionNodeWithOp("MapDefun", function));
+  EXPECT_EQ(map_defun.attr().at("f").func().name(), "XTimesTwo");
+}
+
+// Returns a function that decodes its argument with `DecodeJpeg`.
+FunctionDef DecodeJpeg() {
+  return FunctionDefHelper::Create(
+      "DecodeJpegFunction", {"contents: string"}, {"image: uint8"}, {},
+      {{{"decode"}, "DecodeJpeg", {"contents"}, {{"channels", 3}}},
+       {{"identity"}, "Identity", {"decode:image:0"}, {{"T", DT_UINT8}}}},
+      {{"image", "identity:output:0"}});
+}
+
+TEST(MapVectorizationTest, BatchesJpegDecoding) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("contents", "Const", {},
+            {{"value", test::AsTensor<tstring>({"a", "b"}, {2})},
+             {"dtype", DT_STRING}}),
+       NDef("slices", "TensorSliceDataset", {"contents"},
+            {{"Toutput_types", gtl::ArraySlice<DataType>{DT_STRING}},
+             {"output_shapes",
+              gtl::ArraySlice<PartialTensorShape>{PartialTensorShape({})}},
+             {"output_types", gtl::ArraySlice<DataType>{DT_STRING}}}),
+       NDef("map", "MapDataset", {"slices"},
+            {{"f", FunctionDefHelper::FunctionRef("DecodeJpegFunction")},
+             {"Targuments", gtl::ArraySlice<DataType>{}},
+             {"output_shapes", gtl::ArraySlice<PartialTensorShape>{
+                                   PartialTensorShape({-1, -1, 3})}},
+             {"output_types", gtl::ArraySlice<DataType>{DT_UINT8}}}),
+       NDef("batch_size", "Const", {}, {{"value", 2}, {"dtype", DT_INT64}}),
+       NDef("drop_remainder", "Const", {},
+            {{"value", false}, {"dtype", DT_BOOL}}),
+       NDef("batch", "BatchDatasetV2", {"map", "batch_size", "drop_remainder"},
+            {{"parallel_copy", false},
+             {"output_shapes", gtl::ArraySlice<PartialTensorShape>{
+                                   PartialTensorShape({-1, -1, -1, 3})}},
+             {"output_types", gtl::ArraySlice<DataType>{DT_UINT8}}}),
+       NDef("Sink", "Identity", {"batch"}, {})},
+      {DecodeJpeg()});
+  item.fetch.push_back("Sink");
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  const NodeDef& map_node =
+      output.node(graph_utils::FindGraphNodeWithOp("MapDataset", output));
+  const int index = graph_utils::FindGraphFunctionWithName(
+      map_node.attr().at("f").func().name(), output.library());
+  ASSERT_NE(index, -1);
+  const FunctionDef& function = output.library().function(index);
+  EXPECT_FALSE(
+      function_utils::ContainsFunctionNodeWithOp("MapDefun", function));
+  ASSERT_TRUE(
+      function_utils::ContainsFunctionNodeWithOp("BatchDecodeJpeg", function));
+  const NodeDef& batch_decode = function.node_def(
+      function_utils::FindFunctionNodeWithOp("BatchDecodeJpeg", function));
+  EXPECT_EQ(batch_decode.attr().at("channels").i(), 3);
+}
+
+TEST(MapVectorizationTest, StatefulFunction) {
+  GrapplerItem item =
+      MakeMapAndBatchItem("RandomUniformLess", PartialTensorShape({}));
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapVectorizationTest, InputShapeNotFullyDefined) {
+  GrapplerItem item =
+      MakeMapAndBatchItem("XTimesTwo", PartialTensorShape({-1}));
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapVectorizationTest, MapWithSeveralConsumers) {
+  GrapplerItem item = MakeMapAndBatchItem("XTimesTwo", PartialTensorShape({}));
+  *item.graph.add_node() = NDef("Sink2", "Identity", {"map"}, {});
+  item.fetch.push_back("Sink2");
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
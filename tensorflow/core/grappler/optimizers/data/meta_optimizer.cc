@@ -36,8 +36,9 @@ using ConfigMap =
     std::map<string, tensorflow::RewriterConfig_CustomGraphOptimizer>;
 
 // tf.data optimizations, in the order we want to perform them.
-constexpr std::array<const char*, 20> kTFDataOptimizations = {
+constexpr std::array<const char*, 22> kTFDataOptimizations = {
     "noop_elimination",
+    "columnar_projection",
     "disable_intra_op_parallelism",
     "use_private_thread_pool",
     "shuffle_and_repeat_fusion",
@@ -45,6 +46,7 @@ constexpr std::array<const char*, 20> kTFDataOptimizations = {
     "filter_fusion",
     "map_and_filter_fusion",
     "map_parallelization",
+    "map_vectorization",
     "map_and_batch_fusion",
     "batch_parallelization",
     "filter_parallelization",
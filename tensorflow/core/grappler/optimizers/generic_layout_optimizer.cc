@@ -15,13 +15,19 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer.h"
 
+#include <algorithm>
+#include <tuple>
 #include <utility>
+#include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -39,6 +45,8 @@ constexpr char kNHWC[] = "NHWC";
 constexpr char kNCHW[] = "NCHW";
 constexpr float kVoltaGPURatioThreshold = 0.5;
 constexpr float kConvGPUFP16Threshold = 0.5;
+// A transpose reads and writes every element of its input once.
+constexpr int64 kTransposeTrafficPerByte = 2;
 
 struct MutableNodeViewFormatter {
   void operator()(std::string* out, utils::MutableNodeView* node_view) const {
@@ -69,6 +77,16 @@ inline std::pair<int, int> GetNumGPUs(const Cluster& cluster) {
   return {num_gpus, num_volta};
 }
 
+inline bool IsOnDevice(const TransposeContext& context, const NodeDef& node,
+                       absl::string_view device) {
+  const string& device_name = GetDeviceName(context.virtual_placer.get(), node);
+  string device_type;
+  string task;
+  return DeviceNameUtils::SplitDeviceName(device_name, &task, &device_type) &&
+         absl::StrContains(absl::AsciiStrToLower(device_type),
+                           absl::AsciiStrToLower(device));
+}
+
 inline bool NumConvOnDeviceWithDataTypeOverThreshold(
     const TransposeContext& context, absl::string_view device,
     const DataType& data_type) {
@@ -80,13 +98,7 @@ inline bool NumConvOnDeviceWithDataTypeOverThreshold(
     if (!IsConv2D(*node_def) && !IsConv3D(*node_def)) {
       continue;
     }
-    const string& device_name =
-        GetDeviceName(context.virtual_placer.get(), *node_def);
-    string device_type;
-    string task;
-    if (!DeviceNameUtils::SplitDeviceName(device_name, &task, &device_type) ||
-        !absl::StrContains(absl::AsciiStrToLower(device_type),
-                           absl::AsciiStrToLower(device))) {
+    if (!IsOnDevice(context, *node_def, device)) {
       continue;
     }
     num_conv_gpu++;
@@ -105,6 +117,144 @@ inline bool NumConvOnDeviceWithDataTypeOverThreshold(
           static_cast<float>(num_conv_gpu)) >= kConvGPUFP16Threshold;
 }
 
+// Returns the size in bytes of the output `port` of `node` if it is a 4D or 5D
+// tensor, and 0 otherwise since the layout optimizer only transposes those.
+// Unknown dimensions count as 1: the costs are only compared to each other.
+int64 DataTensorBytes(const TransposeContext& context,
+                      const utils::MutableNodeView& node, int port) {
+  const GraphProperties& properties = *context.graph_properties;
+  if (!properties.HasOutputProperties(node.GetName())) return 0;
+  const auto& outputs = properties.GetOutputProperties(node.GetName());
+  if (port < 0 || port >= static_cast<int>(outputs.size())) return 0;
+  const TensorShapeProto& shape = outputs[port].shape();
+  if (shape.unknown_rank() || (shape.dim_size() != 4 && shape.dim_size() != 5))
+    return 0;
+  int64 num_elements = 1;
+  for (const auto& dim : shape.dim()) {
+    num_elements *= std::max<int64>(dim.size(), 1);
+  }
+  return num_elements * DataTypeSize(outputs[port].dtype());
+}
+
+// The analytic cost of the layout sensitive ops on a device if all of them run
+// in NHWC or all of them run in NCHW, in bytes of memory traffic.
+struct LayoutCosts {
+  int num_convs = 0;
+  int64 nhwc = 0;
+  int64 nchw = 0;
+};
+
+// Estimates the costs of the layouts per cluster of layout sensitive and
+// agnostic ops, i.e. per set of ops that the optimizer converts together.
+// Converting a cluster costs the transposes of the 4D and 5D tensors other than
+// filters that cross its boundary. A convolution in the layout its kernels do
+// not prefer costs the transposes that cuDNN then does internally: NHWC is
+// preferred for fp16 on GPUs with tensor cores, and NCHW otherwise. The other
+// ops are assumed to be as fast in both layouts.
+LayoutCosts EstimateLayoutCosts(const TransposeContext& context,
+                                absl::string_view device,
+                                bool has_tensor_cores) {
+  const utils::MutableGraphView& graph_view = *context.graph_view;
+  const int num_nodes = graph_view.NumNodes();
+  std::vector<int> cluster(num_nodes, -1);
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = *graph_view.GetNode(i)->node();
+    if ((IsLayoutSensitiveOp(node) || IsLayoutAgnosticOp(node)) &&
+        IsOnDevice(context, node, device) &&
+        !context.nodes_to_preserve.contains(node.name())) {
+      cluster[i] = i;
+    }
+  }
+  auto find = [&cluster](int i) {
+    while (cluster[i] != i) {
+      cluster[i] = cluster[cluster[i]];
+      i = cluster[i];
+    }
+    return i;
+  };
+  for (int i = 0; i < num_nodes; ++i) {
+    if (cluster[i] < 0) continue;
+    for (const auto& fanin : graph_view.GetNode(i)->GetRegularFanins()) {
+      if (cluster[fanin.node_index()] >= 0) {
+        cluster[find(fanin.node_index())] = find(i);
+      }
+    }
+  }
+
+  LayoutCosts costs;
+  std::vector<int64> boundary_bytes(num_nodes, 0);
+  std::vector<bool> has_nhwc_ops(num_nodes, false);
+  std::vector<bool> has_nchw_ops(num_nodes, false);
+  absl::flat_hash_set<std::tuple<int, int, int>> boundary_tensors;
+  for (int i = 0; i < num_nodes; ++i) {
+    if (cluster[i] < 0) continue;
+    const int root = find(i);
+    const auto* node_view = graph_view.GetNode(i);
+    const NodeDef& node = *node_view->node();
+    const auto& fanins = node_view->GetRegularFanins();
+    for (int port = 0; port < static_cast<int>(fanins.size()); ++port) {
+      // The filters of convolutions are not transposed.
+      if (port == 1 && absl::StrContains(node.op(), "Conv")) continue;
+      const auto& fanin = fanins[port];
+      const int fanin_index = fanin.node_index();
+      if ((cluster[fanin_index] < 0 || find(fanin_index) != root) &&
+          boundary_tensors.emplace(root, fanin_index, fanin.index()).second) {
+        boundary_bytes[root] +=
+            DataTensorBytes(context, *fanin.node_view(), fanin.index());
+      }
+    }
+    const auto& fanouts = node_view->GetRegularFanouts();
+    for (int port = 0; port < static_cast<int>(fanouts.size()); ++port) {
+      const bool leaves_cluster = absl::c_any_of(
+          fanouts[port], [&](const utils::MutableFaninView& fanout) {
+            return cluster[fanout.node_index()] < 0 ||
+                   find(fanout.node_index()) != root;
+          });
+      if (leaves_cluster) {
+        boundary_bytes[root] += DataTensorBytes(context, *node_view, port);
+      }
+    }
+
+    if (!IsLayoutSensitiveOp(node)) continue;
+    const auto* data_format = node_view->GetAttr("data_format");
+    if (data_format == nullptr) continue;
+    const bool is_nhwc =
+        data_format->s() == "NHWC" || data_format->s() == "NDHWC";
+    const bool is_nchw =
+        data_format->s() == "NCHW" || data_format->s() == "NCDHW";
+    has_nhwc_ops[root] = has_nhwc_ops[root] || is_nhwc;
+    has_nchw_ops[root] = has_nchw_ops[root] || is_nchw;
+
+    const auto* t_attr = node_view->GetAttr("T");
+    if ((!IsConv2D(node) && !IsConv3D(node)) ||
+        node_view->NumRegularFanins() < 1 || t_attr == nullptr ||
+        !DataTypeIsFloating(t_attr->type())) {
+      continue;
+    }
+    const auto& input = node_view->GetRegularFanin(0);
+    const int64 conv_bytes =
+        DataTensorBytes(context, *input.node_view(), input.index()) +
+        DataTensorBytes(context, *node_view, 0);
+    if (has_tensor_cores && t_attr->type() == DT_HALF) {
+      costs.nchw += kTransposeTrafficPerByte * conv_bytes;
+    } else {
+      costs.nhwc += kTransposeTrafficPerByte * conv_bytes;
+    }
+    ++costs.num_convs;
+  }
+
+  for (int i = 0; i < num_nodes; ++i) {
+    if (cluster[i] != i) continue;
+    if (has_nhwc_ops[i]) {
+      costs.nchw += kTransposeTrafficPerByte * boundary_bytes[i];
+    }
+    if (has_nchw_ops[i]) {
+      costs.nhwc += kTransposeTrafficPerByte * boundary_bytes[i];
+    }
+  }
+  return costs;
+}
+
 inline std::pair<string, string> GetSrcAndDstDataFormats(
     const TransposeContext& context, int num_gpus, int num_voltas) {
   string src_format = kNHWC;
@@ -112,9 +262,11 @@ inline std::pair<string, string> GetSrcAndDstDataFormats(
 
   const bool is_NHWC_enforced =
       (!context.enforced_layout.empty() && context.enforced_layout == "NHWC");
+  const bool has_tensor_cores =
+      (static_cast<float>(num_voltas) / static_cast<float>(num_gpus)) >=
+      kVoltaGPURatioThreshold;
   const bool should_swap =
-      ((static_cast<float>(num_voltas) / static_cast<float>(num_gpus)) >=
-       kVoltaGPURatioThreshold) &&
+      has_tensor_cores &&
       NumConvOnDeviceWithDataTypeOverThreshold(context, kGPU, DT_HALF);
   // We swap only if NHWC is enforced or no layout is enforced and the devices
   // config meet the thresholds
@@ -122,6 +274,20 @@ inline std::pair<string, string> GetSrcAndDstDataFormats(
     std::swap(src_format, dst_format);
   }
 
+  // Without an enforced layout, the thresholds only break ties of the cost
+  // model, which also accounts for the transposes that a conversion adds.
+  if (context.enforced_layout.empty()) {
+    const LayoutCosts costs =
+        EstimateLayoutCosts(context, kGPU, has_tensor_cores);
+    VLOG(2) << "Estimated layout costs of " << costs.num_convs
+            << " convolutions: NHWC " << costs.nhwc << ", NCHW " << costs.nchw;
+    const int64 dst_cost = dst_format == kNCHW ? costs.nchw : costs.nhwc;
+    const int64 src_cost = dst_format == kNCHW ? costs.nhwc : costs.nchw;
+    if (costs.num_convs > 0 && src_cost < dst_cost) {
+      std::swap(src_format, dst_format);
+    }
+  }
+
   return {src_format, dst_format};
 }
 
@@ -404,7 +570,8 @@ Status EraseOutputShapeAttrs(TransposeContext* context) {
 
 }  // namespace
 
-// When there is a GPU, the computation graph is converted to NCHW format.
+// When there is a GPU, the computation graph is converted to the format with
+// the lowest estimated cost, NCHW unless fp16 convolutions run on tensor cores.
 // When there is only CPU, there will be no conversion by default, unless user
 // chose to convert the graph to a desired format. Currently, NCHW -> NHWC
 // format conversion is available on CPU.
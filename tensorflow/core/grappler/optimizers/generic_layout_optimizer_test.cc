@@ -334,6 +334,38 @@ TEST_F(GenericLayoutOptimizerTest, GPUDevice) {
   VerifyDataFormatAttributeMatch(conv_node, "NCHW");
 }
 
+TEST_F(GenericLayoutOptimizerTest, GPUDeviceTransposesCostMoreThanConv) {
+#if !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+  GTEST_SKIP() << "Neither CUDA nor ROCm is enabled";
+#endif  // !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  const string device = "/job:w/replica:0/task:0/device:GPU:0";
+  auto conv = SimpleConv2D(&s, 4, 2, "VALID", device);
+  // Converting the cluster {Conv2D, add} to NCHW transposes the input, the
+  // addend and the output, which costs more than running the fp32 Conv2D in
+  // NHWC.
+  Tensor addend_data(DT_FLOAT, TensorShape({8, 3, 3, 2}));
+  test::FillIota<float>(&addend_data, 1.0f);
+  auto addend = ops::Const(s.WithOpName("addend"), addend_data);
+  auto add = ops::Add(s.WithOpName("add").WithDevice(device), conv, addend);
+  auto reshape = ops::Reshape(s.WithOpName("reshape"), add, {-1});
+  Output fetch = ops::Identity(s.WithOpName("Fetch"), {reshape});
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  GenericLayoutOptimizer optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+
+  Status status;
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+  auto* conv_node = graph_view.GetNode("Conv2D");
+  ASSERT_NE(conv_node, nullptr);
+  VerifyDataFormatAttributeMatch(conv_node, "NHWC");
+  EXPECT_EQ(output.node_size(), item.graph.node_size());
+}
+
 TEST_F(GenericLayoutOptimizerTest, CPUDevice) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   auto conv = SimpleConv2D(&s, 4, 2, "VALID", "/CPU:0");
@@ -343,6 +343,11 @@ Status LoopInvariantNodeMotionOptimizer::FindInvariantNodes(
       if (invariant_nodes_.count(consumer) || ModifiesFrameInfo(*consumer)) {
         continue;
       }
+      // Stateful nodes may produce a different value in every iteration, and
+      // nodes with side effects must run once per iteration.
+      if (!IsFreeOfSideEffect(*consumer)) {
+        continue;
+      }
       bool is_invariant = true;
       for (const auto& input : consumer->input()) {
         if (!IsControlInput(input)) {
@@ -411,7 +416,11 @@ Status LoopInvariantNodeMotionOptimizer::Optimize() {
         }
         loop_cond_[frame_ids.back()] = &node;
       }
-      if (IsEnter(node) && node.attr().at("is_constant").b()) {
+      // The variable or ref behind a loop invariant resource or ref may still
+      // be updated in the loop, so the nodes reading it are not invariant.
+      if (IsEnter(node) && node.attr().at("is_constant").b() &&
+          node.op() != "RefEnter" &&
+          node.attr().at("T").type() != DT_RESOURCE) {
         invariant_enters_[frame_ids.back()].push_back(
             const_cast<NodeDef*>(&node));
       }
@@ -725,7 +734,7 @@ LoopOptimizer::LoopOptimizer(RewriterConfig::Toggle opt_level,
                              DeviceBase* cpu_device)
     : opt_level_(opt_level),
       cpu_device_(cpu_device),
-      options_(LoopOptimizerOptions::Default(RewriterConfig::ON)) {
+      options_(LoopOptimizerOptions::Default(opt_level)) {
   resource_mgr_.reset(new ResourceMgr());
 }
 
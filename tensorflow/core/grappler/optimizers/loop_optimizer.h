@@ -56,6 +56,10 @@ class LoopOptimizer : public GraphOptimizer {
 
     static LoopOptimizerOptions Default(RewriterConfig::Toggle opt_level) {
       LoopOptimizerOptions options;
+      // Hoisting invariant nodes out of loops keeps their outputs alive for
+      // the whole loop, so it is only done at the aggressive level.
+      options.enable_loop_invariant_node_motion =
+          opt_level == RewriterConfig::AGGRESSIVE;
       return options;
     }
   };
@@ -65,6 +65,12 @@ class LoopOptimizerTest : public GrapplerTest {
     optimizer->options_.enable_loop_invariant_node_motion = true;
   }
 
+  bool DefaultEnablesLoopInvariantNodeMotion(
+      RewriterConfig::Toggle opt_level) const {
+    return LoopOptimizer::LoopOptimizerOptions::Default(opt_level)
+        .enable_loop_invariant_node_motion;
+  }
+
   void EnableOnlyStackPushRemoval(LoopOptimizer* optimizer) {
     DisableAllStages(optimizer);
     optimizer->options_.enable_stack_push_removal = true;
@@ -146,6 +152,75 @@ TEST_F(LoopOptimizerTest, Basic) {
   }
 }
 
+TEST_F(LoopOptimizerTest, StatefulAndResourceNodesStayInLoop) {
+  GraphDef graph;
+  AddSimpleNode("In", "Identity", {}, &graph);
+  AddSimpleNode("Resource", "VarHandleOp", {}, &graph);
+  AddEnterNode("InvariantEnter", "while/while_context", true, 1, {"In"},
+               &graph);
+  {
+    std::vector<std::pair<string, AttrValue>> attributes;
+    AttrValue type;
+    type.set_type(DT_RESOURCE);
+    attributes.emplace_back("T", type);
+    AttrValue frame_name;
+    frame_name.set_s("while/while_context");
+    attributes.emplace_back("frame_name", frame_name);
+    AttrValue is_const;
+    is_const.set_b(true);
+    attributes.emplace_back("is_constant", is_const);
+    AttrValue parallel_iterations;
+    parallel_iterations.set_i(1);
+    attributes.emplace_back("parallel_iterations", parallel_iterations);
+    AddNode("ResourceEnter", "Enter", {"Resource"}, attributes, &graph);
+  }
+  AddSimpleNode("InvariantAdd", "Add", {"InvariantEnter", "InvariantEnter"},
+                &graph);
+  AddSimpleNode("Random", "RandomUniform", {"InvariantEnter"}, &graph);
+  AddSimpleNode("Read", "ReadVariableOp", {"ResourceEnter"}, &graph);
+  AddSimpleNode("VariantAdd", "AddN",
+                {"InvariantAdd", "Random", "Read", "Identity"}, &graph);
+  AddEnterNode("VariantEnter", "while/while_context", false, 1, {"In"}, &graph);
+  AddSimpleNode("Merge", "Merge", {"VariantEnter", "NextIteration"}, &graph);
+  AddSimpleNode("Less/y", "Const", {"^Identity"}, &graph);
+  AddSimpleNode("Less", "Less", {"VariantAdd", "Less/y"}, &graph);
+  AddSimpleNode("LoopCond", "LoopCond", {"Less"}, &graph);
+  AddSimpleNode("Switch", "Switch", {"Merge", "LoopCond"}, &graph);
+  AddSimpleNode("Identity", "Identity", {"Switch:1"}, &graph);
+  AddSimpleNode("NextIteration", "NextIteration", {"VariantAdd"}, &graph);
+  AddSimpleNode("Exit", "Exit", {"Switch"}, &graph);
+  AddSimpleNode("Out", "Identity", {"Exit"}, &graph);
+
+  GrapplerItem item;
+  item.graph = graph;
+
+  LoopOptimizer optimizer;
+  EnableOnlyLoopInvariantNodeMotion(&optimizer);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  Status status;
+  utils::GraphView view(&output, &status);
+  TF_ASSERT_OK(status);
+  FrameView frames;
+  TF_EXPECT_OK(frames.InferFromGraphView(view));
+  const auto frames_of = [&](const string& name) {
+    const auto* node = view.GetNode(name);
+    EXPECT_NE(node, nullptr);
+    if (node == nullptr) return -1;
+    return static_cast<int>(frames.Frames(*node->node()).size());
+  };
+  EXPECT_EQ(frames_of("InvariantAdd"), 0);
+  EXPECT_EQ(frames_of("Random"), 1);
+  EXPECT_EQ(frames_of("Read"), 1);
+}
+
+TEST_F(LoopOptimizerTest, InvariantNodeMotionOnlyWhenAggressive) {
+  EXPECT_FALSE(DefaultEnablesLoopInvariantNodeMotion(RewriterConfig::ON));
+  EXPECT_TRUE(
+      DefaultEnablesLoopInvariantNodeMotion(RewriterConfig::AGGRESSIVE));
+}
+
 TEST_F(LoopOptimizerTest, Const) {
   GraphDef graph;
   AddSimpleNode("In", "Identity", {}, &graph);
@@ -440,6 +440,37 @@ void RecomputeSubgraph(
   }
 }
 
+// Returns a predicate matching the nodes whose inputs we may want to recompute.
+// This matches node names that contain recomputation_targets_name_scope as a
+// name scope, meaning it either begins with or contains the name scope.
+// Defaults to "gradients/" which will match any node names that begins with
+// "gradients/" or contains "/gradients/".
+std::function<bool(const NodeDef&)> RecomputationTargetPredicate(
+    const string& recomputation_targets_name_scope) {
+  return [recomputation_targets_name_scope](const NodeDef& node) {
+    return absl::StartsWith(node.name(), recomputation_targets_name_scope) ||
+           static_cast<int>(node.name().find(
+               "/" + recomputation_targets_name_scope)) != -1;
+  };
+}
+
+// Duplicates `recomputed_subgraphs` and sets up their control dependencies.
+//
+// REQUIRES: `graph` is topologically sorted, and `node_map` indexes it.
+void RecomputeOpGroups(
+    const std::vector<RecomputedSubGraph>& recomputed_subgraphs,
+    const NodeMap& node_map, GraphDef* graph) {
+  std::unordered_map<const NodeDef*, int> topological_numbering;
+  for (int node_number = 0; node_number < graph->node().size(); ++node_number) {
+    topological_numbering[graph->mutable_node(node_number)] =
+        graph->node().size() - node_number - 1;
+  }
+  for (const RecomputedSubGraph& subgraph : recomputed_subgraphs) {
+    RecomputeSubgraph(subgraph.recomputed_source_nodes, subgraph.target_nodes,
+                      node_map, topological_numbering, graph);
+  }
+}
+
 void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                                 const string& recomputation_targets_name_scope,
                                 GraphDef* graph, const GrapplerItem& item) {
@@ -460,17 +491,7 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
     feeds.insert(NodeName(feed.first));
   }
   std::function<bool(const NodeDef&)> is_target =
-      [&recomputation_targets_name_scope](const NodeDef& node) {
-        // Nodes whose inputs we may want to recompute. This matches node names
-        // that contain recomputation_targets_name_scope as a name scope,
-        // meaning it either begins with or contains the name scope.
-        // Defaults to "gradients/" which will match any node names that begins
-        // with "gradients/" or contains "/gradients/".
-        return absl::StartsWith(node.name(),
-                                recomputation_targets_name_scope) ||
-               static_cast<int>(node.name().find(
-                   "/" + recomputation_targets_name_scope)) != -1;
-      };
+      RecomputationTargetPredicate(recomputation_targets_name_scope);
 
   if (optimization_level == RewriterConfig::RECOMPUTATION_HEURISTICS ||
       optimization_level == RewriterConfig::HEURISTICS) {
@@ -498,18 +519,208 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
         is_target);
   }
   if (!recomputed_subgraphs.empty()) {
-    std::unordered_map<const NodeDef*, int> topological_numbering;
-    for (int node_number = 0; node_number < graph->node().size();
-         ++node_number) {
-      topological_numbering[graph->mutable_node(node_number)] =
-          graph->node().size() - node_number - 1;
+    RecomputeOpGroups(recomputed_subgraphs, node_map, graph);
+  }
+}
+
+struct RecomputeInfo {
+  string node;
+  int64_t memory_used;
+  double fitness;
+
+  bool operator<(const RecomputeInfo& other) const {
+    return fitness > other.fitness;
+  }
+};
+
+// Selects the nodes to recompute so that the estimated peak memory usage of
+// each device fits within `budget_bytes`. Only the outputs that are live at the
+// peak and whose remaining uses are all by target nodes are considered, and
+// those freeing the most memory per unit of compute are picked first.
+bool IdentifyRecomputationCandidates(
+    Cluster* cluster, int64_t budget_bytes,
+    const std::function<bool(const NodeDef&)>& is_target, GrapplerItem* item,
+    std::unique_ptr<GraphMemory>* memory_ptr,
+    std::unordered_set<string>* nodes_to_recompute) {
+  if ((*memory_ptr) == nullptr) {
+    memory_ptr->reset(new GraphMemory(*item));
+    Status s = (*memory_ptr)->InferStatically(cluster->GetDevices());
+    if (!s.ok()) {
+      memory_ptr->reset();
+      VLOG(1) << "Failed to infer memory usage: " << s.error_message();
+      return false;
+    }
+  }
+  const GraphMemory& memory = **memory_ptr;
+
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+
+  // The completion and compute times of each op in the simulated schedule,
+  // filled lazily since most graphs fit within the budget.
+  std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
+  std::unordered_map<string, int64_t> op_compute_micros;
+  bool simulated = false;
+
+  MutableGraphView graph(&item->graph);
+  bool updated_graph = false;
+  for (const auto& device : cluster->GetDevices()) {
+    const string& name = device.first;
+    const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
+    if (mem_usage.used_memory <= budget_bytes) {
+      continue;
+    }
+    int64_t required_savings = mem_usage.used_memory - budget_bytes;
+
+    if (!simulated) {
+      VirtualCluster vcluster(cluster->GetDevices());
+      if (!vcluster.Provision().ok()) {
+        return false;
+      }
+      if (!vcluster.Initialize(*item).ok()) {
+        return false;
+      }
+      RunMetadata metadata;
+      Status s = vcluster.Run(item->graph, item->feed, item->fetch, &metadata);
+      if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+        return false;
+      }
+      for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+        for (const auto& node_stats : dev_stats.node_stats()) {
+          Costs::NanoSeconds exec_time =
+              Costs::NanoSeconds(1) +
+              Costs::MicroSeconds(node_stats.all_start_micros() +
+                                  node_stats.op_end_rel_micros());
+          op_completion_times.emplace(node_stats.node_name(), exec_time);
+          op_compute_micros.emplace(node_stats.node_name(),
+                                    node_stats.op_end_rel_micros() -
+                                        node_stats.op_start_rel_micros());
+        }
+      }
+      simulated = true;
+    }
+
+    Costs::Duration peak_time = -1;
+    std::unordered_set<string> live_at_peak;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      if (live_tensor.allocation_time > peak_time) {
+        peak_time = live_tensor.allocation_time;
+      }
+      live_at_peak.insert(
+          strings::StrCat(live_tensor.node, ":", live_tensor.output_id));
     }
-    // Duplicate the indicated sub-graphs and set up control dependencies
-    for (const RecomputedSubGraph& subgraph : recomputed_subgraphs) {
-      RecomputeSubgraph(subgraph.recomputed_source_nodes, subgraph.target_nodes,
-                        node_map, topological_numbering, graph);
+
+    std::vector<RecomputeInfo> candidates;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      if (live_tensor.memory_used <= 1024) {
+        // Don't bother with small tensors.
+        continue;
+      }
+      NodeDef* node = graph.GetNode(live_tensor.node);
+      if (node == nullptr || is_target(*node) ||
+          feeds.count(node->name()) != 0 ||
+          absl::StartsWith(node->name(), kRecomputedNodePrefix) ||
+          IsControlFlow(*node) || !IsFreeOfSideEffect(*node)) {
+        continue;
+      }
+      // Recomputation only frees the tensor if every use after the peak can
+      // consume the recomputed copy instead.
+      bool valid = true;
+      bool used_after_peak = false;
+      MutableGraphView::OutputPort port =
+          graph.GetOutputPort(live_tensor.node, live_tensor.output_id);
+      for (const MutableGraphView::InputPort& input : graph.GetFanout(port)) {
+        auto it = op_completion_times.find(input.node->name());
+        if (it == op_completion_times.end()) {
+          valid = false;
+          break;
+        }
+        if (it->second <= peak_time) {
+          continue;
+        }
+        if (!is_target(*input.node)) {
+          valid = false;
+          break;
+        }
+        used_after_peak = true;
+      }
+      if (!valid || !used_after_peak) {
+        continue;
+      }
+      // The recomputed node keeps its inputs alive until it runs, so only
+      // recompute nodes whose inputs are resident at the peak anyway.
+      for (const MutableGraphView::OutputPort& fanin :
+           graph.GetFanins(*node, /*include_controlling_fanins=*/false)) {
+        if (IsVariable(*fanin.node) || IsConstant(*fanin.node)) {
+          continue;
+        }
+        if (live_at_peak.count(strings::StrCat(fanin.node->name(), ":",
+                                               fanin.port_id)) == 0) {
+          valid = false;
+          break;
+        }
+      }
+      if (!valid) {
+        continue;
+      }
+      RecomputeInfo info;
+      info.node = node->name();
+      info.memory_used = live_tensor.memory_used;
+      info.fitness = static_cast<double>(live_tensor.memory_used) /
+                     (1 + op_compute_micros[node->name()]);
+      candidates.push_back(info);
+    }
+
+    // Sort by fitness
+    std::sort(candidates.begin(), candidates.end());
+
+    for (const RecomputeInfo& info : candidates) {
+      if (!nodes_to_recompute->insert(info.node).second) {
+        continue;
+      }
+      VLOG(1) << "Will recompute " << info.node << " to save "
+              << info.memory_used << " bytes on " << name;
+      required_savings -= info.memory_used;
+      updated_graph = true;
+      if (required_savings < 0) {
+        break;
+      }
     }
   }
+  return updated_graph;
+}
+
+// Recomputes the activations needed to bring the estimated peak memory usage
+// of each device within `budget_bytes`. Returns true if the graph changed.
+bool BudgetedRecomputationPass(Cluster* cluster, int64_t budget_bytes,
+                               const string& recomputation_targets_name_scope,
+                               std::unique_ptr<GraphMemory>* memory,
+                               GrapplerItem* item) {
+  std::function<bool(const NodeDef&)> is_target =
+      RecomputationTargetPredicate(recomputation_targets_name_scope);
+  std::unordered_set<string> nodes_to_recompute;
+  if (!IdentifyRecomputationCandidates(cluster, budget_bytes, is_target, item,
+                                       memory, &nodes_to_recompute)) {
+    return false;
+  }
+  GraphDef* graph = &item->graph;
+  if (!TopologicalSort(graph).ok()) {
+    return false;
+  }
+  NodeMap node_map(graph);
+  std::vector<RecomputedSubGraph> recomputed_subgraphs = GetOpGroupsToRecompute(
+      graph, node_map,
+      [&nodes_to_recompute](const NodeDef& node) {
+        return nodes_to_recompute.count(node.name()) > 0;
+      },
+      is_target);
+  if (recomputed_subgraphs.empty()) {
+    return false;
+  }
+  RecomputeOpGroups(recomputed_subgraphs, node_map, graph);
+  return true;
 }
 
 bool SchedulingPass(Cluster* cluster, std::unique_ptr<GraphMemory>* memory_ptr,
@@ -1394,8 +1605,16 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   GrapplerItem optimized_item(item);
   RelaxAssignNodes(nodes_to_relax, &optimized_item.graph);
 
+  bool run_budgeted_recomputation_pass =
+      recomputation_budget_bytes_ > 0 &&
+      (optimization_level_ == RewriterConfig::RECOMPUTATION_HEURISTICS ||
+       optimization_level_ == RewriterConfig::HEURISTICS);
   if (run_recomputation_pass) {
-    RecomputationRewritingPass(optimization_level_,
+    // With a budget, the heuristics pick the nodes to recompute below, so only
+    // the manual annotations are applied upfront.
+    RecomputationRewritingPass(run_budgeted_recomputation_pass
+                                   ? RewriterConfig::MANUAL
+                                   : optimization_level_,
                                recomputation_targets_name_scope_,
                                &optimized_item.graph, item);
   }
@@ -1422,6 +1641,16 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
         }
       }
 
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      if (run_budgeted_recomputation_pass &&
+          BudgetedRecomputationPass(cluster, recomputation_budget_bytes_,
+                                    recomputation_targets_name_scope_, &memory,
+                                    &optimized_item)) {
+        // Reset the inferred memory usage since the graph changed.
+        memory.reset();
+        updated_graph = true;
+      }
+
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
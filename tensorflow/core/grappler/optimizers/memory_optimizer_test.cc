@@ -346,6 +346,51 @@ TEST_F(MemoryOptimizerTest, SwappingHeuristics) {
 #endif
 }
 
+TEST_F(MemoryOptimizerTest, BudgetedRecomputation) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Variable(s.WithOpName("a").WithDevice("/gpu:0"), {128, 128},
+                           DT_FLOAT);
+  Output b = ops::Sqrt(s.WithOpName("b").WithDevice("/gpu:0"), a);
+  Output c = ops::Sqrt(s.WithOpName("c").WithDevice("/gpu:0"), b);
+  Output d = ops::Sqrt(s.WithOpName("d").WithDevice("/gpu:0"), c);
+  Output e = ops::Sqrt(s.WithOpName("e").WithDevice("/gpu:0"), d);
+  Output g1 = ops::AddN(s.WithOpName("gradients/g1").WithDevice("/gpu:0"), {e});
+  Output g2 =
+      ops::AddN(s.WithOpName("gradients/g2").WithDevice("/gpu:0"), {g1, b});
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gradients/g2"};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  // The graph fits within a large budget, so nothing is recomputed even though
+  // the recomputation heuristics alone would recompute the cheap ops.
+  {
+    MemoryOptimizer optimizer(RewriterConfig::RECOMPUTATION_HEURISTICS,
+                              "gradients/", int64_t{1} << 30);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+    EXPECT_EQ(item.graph.node_size(), output.node_size());
+  }
+
+  // With a tiny budget, the activation that is live across the peak is
+  // recomputed for the gradient that uses it.
+  {
+    MemoryOptimizer optimizer(RewriterConfig::RECOMPUTATION_HEURISTICS,
+                              "gradients/", 1);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+    NodeMap node_map(&output);
+    const NodeDef* recomputed_b = node_map.GetNode("Recomputed/b");
+    ASSERT_NE(nullptr, recomputed_b);
+    EXPECT_EQ("a", recomputed_b->input(0));
+    const NodeDef* new_g2 = node_map.GetNode("gradients/g2");
+    ASSERT_NE(nullptr, new_g2);
+    EXPECT_EQ("Recomputed/b", new_g2->input(1));
+  }
+}
+
 TEST_F(MemoryOptimizerTest, UnswappableInputs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
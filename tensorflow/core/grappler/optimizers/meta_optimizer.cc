@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 
+#include <algorithm>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/substitute.h"
@@ -51,9 +55,15 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/grappler/utils/tpu.h"
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/util/dump_graph.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/ptr_util.h"
 #include "tensorflow/core/util/util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
@@ -176,6 +186,74 @@ Status GetGraphDevice(const GraphDef& g_def, std::set<std::string>* devices) {
   return Status::OK();
 }
 
+// Optimized function bodies, keyed by a fingerprint of everything that their
+// optimization depends on. The cache is shared by all meta optimizers in the
+// process, so that retracing a function or loading a model whose library
+// overlaps with an already optimized one skips the unchanged functions.
+class FunctionOptimizationCache {
+ public:
+  struct Entry {
+    FunctionDef optimized_func;
+    // The specialized functions that optimizing the body added to the library.
+    std::vector<FunctionDef> added_funcs;
+  };
+
+  static FunctionOptimizationCache* Global() {
+    static FunctionOptimizationCache* cache = new FunctionOptimizationCache();
+    return cache;
+  }
+
+  bool Lookup(const Fprint128& key, Entry* entry) {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      return false;
+    }
+    *entry = it->second;
+    return true;
+  }
+
+  void Insert(const Fprint128& key, Entry entry) {
+    mutex_lock l(mu_);
+    // Bound the memory held by the cache. Libraries that overflow it are
+    // unlikely to be optimized again in their entirety.
+    if (entries_.size() >= kMaxEntries) {
+      entries_.clear();
+    }
+    entries_[key] = std::move(entry);
+  }
+
+ private:
+  static constexpr int kMaxEntries = 16384;
+
+  mutex mu_;
+  absl::flat_hash_map<Fprint128, Entry, Fprint128Hasher> entries_
+      TF_GUARDED_BY(mu_);
+};
+
+// Returns the number of threads to optimize the functions of a library with.
+int NumFunctionOptimizationThreads() {
+  static const int num_threads = [] {
+    int64_t num_threads;
+    TF_CHECK_OK(tensorflow::ReadInt64FromEnvVar(
+        "TF_GRAPPLER_FUNCTION_OPTIMIZATION_THREADS",
+        std::min(port::MaxParallelism(), 8), &num_threads));
+    return std::max<int>(num_threads, 1);
+  }();
+  return num_threads;
+}
+
+bool FunctionOptimizationCacheEnabled() {
+  static const bool enabled = [] {
+    bool enabled;
+    TF_CHECK_OK(tensorflow::ReadBoolFromEnvVar(
+        "TF_GRAPPLER_FUNCTION_OPTIMIZATION_CACHE", /*default_val=*/true,
+        &enabled));
+    return enabled;
+  }();
+  return enabled;
+}
+
 }  // namespace
 
 #define MK_OPT(NAME, CONFIG, VALUE)                                    \
@@ -431,15 +509,15 @@ Status MetaOptimizer::InitializeOptimizers(
   if (MemoryOptimizerEnabled(cfg_.memory_optimization(),
                              xla_auto_clustering_on_) &&
       PLUGIN_NOT_OFF(memory_optimization)) {
-    if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
-      optimizers->push_back(
-          // Use the default target node name prefix "gradients/"
-          MakeUnique<MemoryOptimizer>(cfg_.memory_optimization()));
-    } else {
-      optimizers->push_back(MakeUnique<MemoryOptimizer>(
-          cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
+    string target_node_name_scope =
+        cfg_.memory_optimizer_target_node_name_scope();
+    if (target_node_name_scope.empty()) {
+      // Use the default target node name prefix "gradients/"
+      target_node_name_scope = "gradients/";
     }
+    optimizers->push_back(MakeUnique<MemoryOptimizer>(
+        cfg_.memory_optimization(), target_node_name_scope,
+        cfg_.memory_optimizer_recomputation_budget_bytes()));
   }
   if (cfg_.auto_parallel().enable() && PLUGIN_IS_ON(auto_parallel)) {
     optimizers->push_back(
@@ -701,7 +779,11 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
 }
 
 Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
-                                    GraphDef* optimized_graph) {
+                                    GraphDef* optimized_graph,
+                                    bool* fully_optimized) {
+  if (fully_optimized != nullptr) {
+    *fully_optimized = false;
+  }
   int min_graph_nodes = cfg_.min_graph_nodes() == 0 ? kDefaultMinGraphNodes
                                                     : cfg_.min_graph_nodes();
   if (item.graph.node_size() < min_graph_nodes) {
@@ -842,8 +924,19 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
                                      return result.status.ok();
                                    }) != optimization_result.results.end();
 
+  if (fully_optimized != nullptr) {
+    *fully_optimized = std::all_of(optimization_result.results.begin(),
+                                   optimization_result.results.end(),
+                                   [](const OptimizerResult& result) {
+                                     return result.status.ok();
+                                   });
+  }
+
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -1093,12 +1186,163 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   // Propagate `_tf_data_function` attributes from functions to their callees.
   PropagateTFDataAttrs(flib, *optimized_graph->mutable_library());
 
+  // Functions are only optimized concurrently, and their optimized bodies
+  // cached, when running the built-in optimizers, which are known to be
+  // thread-safe and to be deterministic functions of their inputs.
+  const bool only_builtin_optimizers =
+      cfg_.optimizers().empty() && cfg_.custom_optimizers().empty();
+
+  // Everything besides the function itself and the functions reachable from
+  // it that the optimization of a function body depends on.
+  string function_key_prefix;
+  const bool use_function_cache = FunctionOptimizationCacheEnabled() &&
+                                  only_builtin_optimizers &&
+                                  optimize_function_library;
+  if (use_function_cache) {
+    string config;
+    SerializeToStringDeterministic(config_proto_, &config);
+    std::vector<string> devices;
+    if (cluster != nullptr) {
+      for (const auto& device : cluster->GetDevices()) {
+        devices.push_back(
+            strings::StrCat(device.first, "=", device.second.type()));
+      }
+      std::sort(devices.begin(), devices.end());
+    }
+    function_key_prefix = strings::StrCat(
+        producer, ";", cpu_device_ != nullptr, ";", xla_auto_clustering_on_,
+        ";", IsTPUGraphDef(*optimized_graph), ";", absl::StrJoin(devices, ","),
+        ";", config);
+  }
+  const auto function_key = [&](const FunctionDef& func,
+                                bool allow_non_differentiable_rewrites) {
+    string key = strings::StrCat(function_key_prefix, ";",
+                                 allow_non_differentiable_rewrites, ";");
+    string serialized_func;
+    SerializeToStringDeterministic(func, &serialized_func);
+    strings::StrAppend(&key, serialized_func);
+    FunctionLibraryDefinition reachable = flib.ReachableDefinitions(func);
+    std::vector<string> reachable_names = reachable.ListFunctionNames();
+    std::sort(reachable_names.begin(), reachable_names.end());
+    for (const string& name : reachable_names) {
+      strings::StrAppend(&key, ";", name, "=",
+                         FunctionDefHash(*reachable.Find(name)));
+    }
+    return Fingerprint128(key);
+  };
+
+  // The result of optimizing a single function body.
+  struct OptimizedFunction {
+    Status status;
+    Fprint128 key;
+    // Set if the optimized function was found in the cache.
+    bool cached = false;
+    FunctionOptimizationCache::Entry entry;
+    // Set if the function body was optimized in this pass.
+    GrapplerFunctionItem func_item;
+    bool fully_optimized = false;
+  };
+
+  // Optimizes the body of `func`. Only reads `flib`, so that several functions
+  // can be optimized concurrently.
+  const auto optimize_function = [&](const FunctionDef& func,
+                                     OptimizedFunction* result) -> Status {
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+    const string& func_name = func.signature().name();
+
+    // If we need to compute the gradient of optimized function at runtime, we
+    // can't perform non-differentiable rewrites.
+    const bool allow_non_differentiable_rewrites =
+        !differentiable_functions.contains(func_name);
+    if (use_function_cache) {
+      result->key = function_key(func, allow_non_differentiable_rewrites);
+      if (FunctionOptimizationCache::Global()->Lookup(result->key,
+                                                       &result->entry)) {
+        VLOG(3) << "Reuse optimized function: function=" << func_name;
+        result->cached = true;
+        return Status::OK();
+      }
+    }
+
+    // Make a GrapplerItem from a FunctionDef.
+    GrapplerFunctionItem& func_item = result->func_item;
+    TF_RETURN_IF_ERROR(
+        MakeGrapplerFunctionItem(func, flib, producer, &func_item));
+    func_item.optimization_options().allow_non_differentiable_rewrites =
+        allow_non_differentiable_rewrites;
+
+    // Device set available to the function is defined only by the runtime,
+    // when we instantiate and execute the function. We can't use all devices
+    // available to the main graph, because after partitioning the function
+    // call node might execute on a remote worker.
+    if (!func_item.devices().empty()) {
+      return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    }
+
+    // We are not allowed to prune certain types of ops from the graph
+    // instantiated by the function definition, because we must guarantee
+    // function execution semantics wrt side effects (see
+    // function_optimizer.cc).
+    func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
+        false;
+
+    // Optimize function body graph.
+    GraphDef optimized_func_graph;
+    if (IsTPUGraphDef(*optimized_graph)) {
+      // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+      // passes do not handle TPU functions correctly in a variety of ways
+      // (Note that due to the pre-placement TPU graph rewriting passes, the
+      // TPU-related ops are encapsulated away into functions). For example,
+      // TPU graphs contain TPUReplicateMetadata node that carries relevant
+      // TPU metadata and Grappler passes could prune that away. Grappler
+      // passes could also cause issues around shape inference. Since the
+      // desired and existing behavior is to not optimize TPU functions with
+      // Grappler, this check preserves that. The only exception is
+      // implementation selector what is required to swap in some TPU specific
+      // lowering code and is verified the work correctly on TPUs.
+      ImplementationSelector implementation_selector;
+
+      // Implementation selector needs to have access to valid function
+      // signature and attributes, and it doesn't need actual function body.
+      std::unique_ptr<FunctionDefLibrary> func_item_function_library(
+          func_item.graph.release_library());
+      *func_item.graph.mutable_library() =
+          GetFunctionDefLibraryStub(*func_item_function_library);
+
+      TF_RETURN_IF_ERROR(implementation_selector.Optimize(
+          cluster, func_item, &optimized_func_graph));
+      result->fully_optimized = true;
+    } else {
+      GrapplerFunctionItem func_item_copy = func_item;
+      TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
+                                       &optimized_func_graph,
+                                       &result->fully_optimized));
+    }
+
+    // Function body optimization might have created new specialized
+    // functions for each instantiation context. Keep only those, rather than a
+    // copy of the whole library per function.
+    for (FunctionDef& func_def :
+         *optimized_func_graph.mutable_library()->mutable_function()) {
+      if (flib.Find(func_def.signature().name()) == nullptr) {
+        result->entry.added_funcs.push_back(std::move(func_def));
+      }
+    }
+    optimized_func_graph.clear_library();
+    func_item.SwapFunctionBody(std::move(optimized_func_graph));
+    return Status::OK();
+  };
+
+  const bool optimize_functions_concurrently =
+      NumFunctionOptimizationThreads() > 1 && only_builtin_optimizers;
+  std::unique_ptr<thread::ThreadPool> function_thread_pool;
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
 
-    int function_idx = 0;
+    std::vector<const FunctionDef*> funcs_to_optimize;
     for (const FunctionDef& func : optimized_graph->library().function()) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
 
@@ -1121,87 +1365,68 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       // and in function instantiation.
       if (data::IsTFDataFunction(func)) continue;
 
-      VLOG(3) << "Optimize function: function=" << func_name << " ["
-              << function_idx++ << " of "
-              << optimized_graph->library().function_size() << "]";
-
       // Function optimization might specialize nested function calls, so we
       // have to reset the flag and do at least one more pass over the library.
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
+      funcs_to_optimize.push_back(&func);
+    }
 
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
-
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    std::vector<OptimizedFunction> results(funcs_to_optimize.size());
+    const auto optimize_function_at = [&](int i) {
+      VLOG(3) << "Optimize function: function="
+              << funcs_to_optimize[i]->signature().name() << " [" << i
+              << " of " << funcs_to_optimize.size() << "]";
+      results[i].status = optimize_function(*funcs_to_optimize[i], &results[i]);
+    };
+    if (optimize_functions_concurrently && funcs_to_optimize.size() > 1) {
+      if (function_thread_pool == nullptr) {
+        function_thread_pool = absl::make_unique<thread::ThreadPool>(
+            Env::Default(), "grappler_function_optimization",
+            NumFunctionOptimizationThreads());
       }
-
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (IsTPUGraphDef(*optimized_graph)) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        std::unique_ptr<FunctionDefLibrary> func_item_function_library(
-            func_item.graph.release_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(*func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+      BlockingCounter counter(funcs_to_optimize.size());
+      for (int i = 0; i < funcs_to_optimize.size(); ++i) {
+        function_thread_pool->Schedule([&, i] {
+          optimize_function_at(i);
+          counter.DecrementCount();
+        });
       }
+      counter.Wait();
+    } else {
+      for (int i = 0; i < funcs_to_optimize.size(); ++i) {
+        optimize_function_at(i);
+        TF_RETURN_IF_ERROR(results[i].status);
+      }
+    }
+
+    // Update the library in the order the functions appear in it, so that the
+    // result does not depend on the order in which they were optimized.
+    for (int i = 0; i < funcs_to_optimize.size(); ++i) {
+      OptimizedFunction& result = results[i];
+      TF_RETURN_IF_ERROR(result.status);
+      const string& func_name = funcs_to_optimize[i]->signature().name();
 
-      // Function body optimization might have created new specialized
-      // functions for each instantiation context. Add them to the library.
-      for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
+      // Add the specialized functions that the body optimization created.
+      for (const FunctionDef& func_def : result.entry.added_funcs) {
         if (flib.Find(func_def.signature().name()) == nullptr) {
           TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
         }
       }
 
       // Convert optimized graph back to FunctionDef.
-      FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
+      if (!result.cached) {
+        TF_RETURN_IF_ERROR(MakeFunctionDef(result.func_item, flib,
+                                           &result.entry.optimized_func));
+        if (use_function_cache && result.fully_optimized) {
+          FunctionOptimizationCache::Global()->Insert(result.key,
+                                                      result.entry);
+        }
+      }
 
       // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+      TF_RETURN_IF_ERROR(
+          flib.ReplaceFunction(func_name, result.entry.optimized_func));
     }
 
     // If optimized at least one function, update the graph library.
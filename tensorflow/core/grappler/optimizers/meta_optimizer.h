@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/verifiers/graph_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/protobuf/verifier_config.pb.h"
@@ -90,9 +91,12 @@ class MetaOptimizer : public GraphOptimizer {
   void PrintUserAndPluginConfigs(const std::set<string>& device_types) const;
 
   // Run optimization pass over a single GrapplerItem. Meta optimizer might run
-  // multiple such passes: 1) for the main graph 2) for the function library
+  // multiple such passes: 1) for the main graph 2) for the function library.
+  // If `fully_optimized` is not null, sets it to whether every optimizer ran
+  // to completion. May be called concurrently for different items.
   Status OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
-                       GraphDef* optimized_graph);
+                       GraphDef* optimized_graph,
+                       bool* fully_optimized = nullptr);
 
   DeviceBase* const cpu_device_;  // may be NULL
   ConfigProto config_proto_;
@@ -115,6 +119,8 @@ class MetaOptimizer : public GraphOptimizer {
                       GrapplerItem* optimized_item, GraphDef* optimized_graph,
                       GraphOptimizationResult* optimization_result);
 
+  // Guards optimization_results_ while functions are optimized concurrently.
+  mutex optimization_results_mu_;
   std::vector<GraphOptimizationResult> optimization_results_;
 };
 
@@ -420,6 +420,74 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibrary) {
   test::ExpectTensorEqual<int>(tensors_expected[1], tensors[1]);
 }
 
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryReusesOptimizedFunctions) {
+  using test::function::NDef;
+
+  // Run the default optimizers, which allows the optimized functions to be
+  // cached and optimized concurrently.
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.set_function_optimization(RewriterConfig::ON);
+  rewriter_config.set_min_graph_nodes(-1);
+
+  FunctionDef mul_func = FunctionDefHelper::Create(
+      "MyMul", {"x:T", "y:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"mul"}, "Mul", {"x", "y"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "mul:z:0"}});
+  (*mul_func.mutable_attr())["_noinline"].set_b(true);
+
+  FunctionDef square_func = FunctionDefHelper::Create(
+      "MySquare", {"x:float"}, {"z:float"}, {},
+      {{{"my_mul"}, "MyMul", {"x", "x"}, {{"T", DT_FLOAT}}}},
+      /*ret_def=*/
+      {{"z", "my_mul:z:0"}});
+  (*square_func.mutable_attr())["_noinline"].set_b(true);
+
+  FunctionDef cube_func = FunctionDefHelper::Create(
+      "MyCube", {"x:float"}, {"z:float"}, {},
+      {{{"square"}, "MySquare", {"x"}, {}},
+       {{"cube"}, "MyMul", {"x", "square:z"}, {{"T", DT_FLOAT}}}},
+      /*ret_def=*/
+      {{"z", "cube:z:0"}});
+  (*cube_func.mutable_attr())["_noinline"].set_b(true);
+
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(
+      {NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("square", "MySquare", {"a"}, {}, kDevice),
+       NDef("cube", "MyCube", {"a"}, {}, kDevice),
+       NDef("out_s", "Identity", {"square:0"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("out_c", "Identity", {"cube:0"}, {{"T", DT_FLOAT}}, kDevice)},
+      /*funcs=*/
+      {mul_func, square_func, cube_func});
+  item.fetch = {"out_s", "out_c"};
+
+  // The second optimization reuses the function bodies optimized by the first,
+  // and must produce the same library.
+  GraphDef first_output;
+  MetaOptimizer first_optimizer(nullptr, config_proto);
+  TF_EXPECT_OK(first_optimizer.Optimize(nullptr, item, &first_output));
+  GraphDef second_output;
+  MetaOptimizer second_optimizer(nullptr, config_proto);
+  TF_EXPECT_OK(second_optimizer.Optimize(nullptr, item, &second_output));
+
+  CompareGraphs(first_output, second_output);
+  FunctionLibraryDefinition first_flib(OpRegistry::Global(),
+                                       first_output.library());
+  FunctionLibraryDefinition second_flib(OpRegistry::Global(),
+                                        second_output.library());
+  ASSERT_EQ(first_flib.num_functions(), second_flib.num_functions());
+  for (const string& name : first_flib.ListFunctionNames()) {
+    const FunctionDef* second_func = second_flib.Find(name);
+    ASSERT_NE(second_func, nullptr) << name;
+    EXPECT_TRUE(FunctionDefsEqual(*first_flib.Find(name), *second_func))
+        << name;
+  }
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryPruneUnusedOutputs) {
   using test::function::NDef;
 
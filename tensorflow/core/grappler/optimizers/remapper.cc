@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/graph_view.h"
@@ -57,8 +60,14 @@ namespace grappler {
 //   (1) FusedBatchNorm + <Activation>
 //   (2) FusedBatchNorm + SideInput + <Activation>
 //
+// ResourceGather + SparseSegment{Sum,Mean,SqrtN} ->
+//   _ResourceSparseSegmentReduction  // This fusion only works on CPU.
+//
 // Sigmoid + Mul -> _MklSwish  // This fusion only works on Intel CPU.
 //
+// Chain of elementwise ops, e.g. Mul + Add + Tanh -> _FusedElementwise
+//   // This fusion only works on CPU.
+//
 //
 // In all cases, the supported activation functions are Relu, Relu6, and Elu.
 //
@@ -73,6 +82,11 @@ constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
 constexpr char kFusedBatchNormGradEx[] = "_FusedBatchNormGradEx";
 constexpr char kTensorToHashBucket[] = "_TensorToHashBucketFast";
+constexpr char kResourceSparseSegmentReduction[] =
+    "_ResourceSparseSegmentReduction";
+constexpr char kFusedElementwise[] = "_FusedElementwise";
+constexpr char kGroupedMatMul[] = "_GroupedMatMul";
+constexpr char kUnaryOpsComposition[] = "_UnaryOpsComposition";
 
 constexpr char kDataFormat[] = "data_format";
 constexpr char kIsTraining[] = "is_training";
@@ -143,6 +157,31 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// ResourceGather whose only consumer is a SparseSegment{Sum,Mean,SqrtN} that
+// reduces the gathered rows. Can be replaced with
+// _ResourceSparseSegmentReduction, which reads the rows from the variable.
+struct ResourceGatherWithSegmentReduction {
+  ResourceGatherWithSegmentReduction() = default;
+  ResourceGatherWithSegmentReduction(int gather, int segment_reduction)
+      : gather(gather), segment_reduction(segment_reduction) {}
+
+  int gather = kMissingIndex;
+  int segment_reduction = kMissingIndex;
+};
+
+// Chain of elementwise ops on CPU, where each op reads the result of the
+// previous one, and the other operand of each binary op is either a tensor of
+// the shape of the result or a scalar. Can be replaced with _FusedElementwise.
+struct ElementwiseChain {
+  // Nodes from the first op of the chain to the root.
+  std::vector<int> nodes;
+  // Names of the fused ops, in the same order.
+  std::vector<string> fused_ops;
+  // Inputs of the fused node: the input of the chain, then the other operand
+  // of each binary op.
+  std::vector<string> args;
+};
+
 // Pad followed by Conv3D/FusedConv3D
 struct PadWithConv3D {
   PadWithConv3D() = default;
@@ -436,10 +475,8 @@ bool IsDeviceCompatible(const RemapperContext& ctx, Pattern& matched) {
 }
 
 bool IsSupportedActivation(const NodeDef& node) {
-  bool is_default_supported =
-      IsRelu(node) || IsRelu6(node) || IsElu(node) || IsLeakyRelu(node);
-  bool is_mkl_specific = IsMKLEnabled() && (IsTanh(node) || IsSigmoid(node));
-  return (is_default_supported || is_mkl_specific);
+  return IsRelu(node) || IsRelu6(node) || IsElu(node) || IsLeakyRelu(node) ||
+         IsTanh(node) || IsSigmoid(node);
 }
 
 inline bool HasControlFaninOrFanout(const utils::MutableNodeView& node_view) {
@@ -624,8 +661,8 @@ bool FindContractionWithBiasAndActivation(
       bias_add_node_view->GetRegularFanin(1 - base.bias_port).node_view();
   const auto* contraction_node_def = contraction_node_view->node();
 
-  // Currently, only matmul + bias + (tanh or Sigmoid) is enabled
-  if (!IsMatMul(*contraction_node_def) &&
+  // Currently, oneDNN enables only matmul + bias + (tanh or Sigmoid).
+  if (IsMKLEnabled() && !IsMatMul(*contraction_node_def) &&
       (IsTanh(*node_def) || IsSigmoid(*node_def)))
     return false;
 
@@ -772,6 +809,9 @@ bool FindConv2DWithBatchNormAndActivation(
   // this activation TODO(intel-tf)
   if (IsSigmoid(*node_def)) return false;
 
+  // The Eigen kernels do not fuse Tanh after FusedBatchNorm.
+  if (!IsMKLEnabled() && IsTanh(*node_def)) return false;
+
   // And input to the activation node must match Conv2DWithBatchNorm pattern.
   if (node_view->NumRegularFanins() < 1) return false;
   const auto& regular_fanin_0 = node_view->GetRegularFanin(0);
@@ -897,7 +937,11 @@ bool FindContractionWithBiasAddAndAdd(const RemapperContext& ctx,
     }
   }
 
-  // We successfully found a {Conv2D,Conv3D}+BiasAdd+{AddN,Add} pattern.
+  // Without oneDNN, the residual Add is fused by the Eigen output kernels of
+  // _FusedConv2D and _FusedMatMul.
+  if (!IsMKLEnabled() && !IsCpuCompatible(ctx, base)) return false;
+
+  // We successfully found a {Conv2D,Conv3D,MatMul}+BiasAdd+{AddN,Add} pattern.
   matched->contraction = base.contraction;
   matched->bias_add = base.bias_add;
   matched->add = node_view.node_index();
@@ -927,12 +971,12 @@ bool FindContractionWithBiasAndAddActivation(
 
   if (!NodeIsOnCpu(node_def)) return false;
 
-  // Currently, Contraction + Bias + Add + Tanh pattern is not supported
-  if (IsTanh(*node_def)) return false;
+  // Currently, oneDNN does not support Contraction + Bias + Add + Tanh.
+  if (IsMKLEnabled() && IsTanh(*node_def)) return false;
 
   // Need to test and enable in Kernel Op before enabling
   // this activation. TODO(intel-tf)
-  if (IsSigmoid(*node_def)) return false;
+  if (IsMKLEnabled() && IsSigmoid(*node_def)) return false;
 
   // MKL activation op only supports float and bfloat16 data types.
   if (!HasDataType(node_def, DT_FLOAT) && !HasDataType(node_def, DT_BFLOAT16))
@@ -956,15 +1000,13 @@ bool FindContractionWithBiasAndAddActivation(
       bias_add_node_view->GetRegularFanin(0).node_view();
   const auto* contraction_node_def = contraction_node_view->node();
 
-  // Currently, only conv + bias + add + leakyrelu is enabled
-  if (!(IsConv2D(*contraction_node_def) || IsConv3D(*contraction_node_def)) &&
-      IsLeakyRelu(*node_def))
-    return false;
+  // Currently, oneDNN enables only conv + bias + add + activation.
+  if (IsMKLEnabled() && IsMatMul(*contraction_node_def)) return false;
   // Conv3D fusion is available with oneDNN enabled
   if (IsConv3D(*contraction_node_def) && !IsMKLEnabled()) return false;
 
-  // We successfully found a Conv2D+BiasAdd+AddN+activation pattern
-  // or Conv3D+BiasAdd+AddN+activation pattern
+  // We successfully found a {Conv2D,Conv3D,MatMul}+BiasAdd+AddN+activation
+  // pattern.
   const ContractionWithBiasAndAddActivation pattern{
       base.contraction, base.bias_add, base.add,
       base.port_id,     node_index,    base.bias_port};
@@ -1009,9 +1051,6 @@ bool FindMatMulBiasAddAndGelu(RemapperContext* ctx, int node_index,
                               std::map<string, int>* matched_nodes_map,
                               std::set<int>* remove_node_indices,
                               bool* is_gelu_approximate) {
-  // Gelu fusion is enabled only with oneDNN library.
-  if (!IsMKLEnabled()) return false;
-
   using utils::MatchingDirection;
   using utils::NodeStatus;
   // clang-format off
@@ -1146,6 +1185,8 @@ bool FindMatMulBiasAddAndGelu(RemapperContext* ctx, int node_index,
         ctx->graph_view.GetNode(matched_nodes_map->at("matmul"))->node();
 
     if (!NodeIsOnCpu(matmul_node)) return false;
+    // The Eigen _FusedMatMul kernel is registered only for float.
+    if (!IsMKLEnabled() && !HasDataType(matmul_node, DT_FLOAT)) return false;
 
     // Check if _FusedMatMul contains only BiasAdd
     auto fused_ops = matmul_node->attr().at("fused_ops").list().s();
@@ -1737,6 +1778,215 @@ bool FindTensorToHashBucket(const RemapperContext& ctx, int node_index,
   return true;
 }
 
+// Returns the "combiner" attr of _ResourceSparseSegmentReduction matching
+// "node", or nullptr if it is not a SparseSegment{Sum,Mean,SqrtN}.
+const char* GetSparseSegmentCombiner(const NodeDef& node) {
+  if (node.op() == "SparseSegmentSum") return "sum";
+  if (node.op() == "SparseSegmentMean") return "mean";
+  if (node.op() == "SparseSegmentSqrtN") return "sqrtn";
+  return nullptr;
+}
+
+bool FindResourceGatherWithSegmentReduction(
+    const RemapperContext& ctx, int node_index,
+    ResourceGatherWithSegmentReduction* matched) {
+  // Root of the pattern must be a SparseSegment{Sum,Mean,SqrtN} on CPU.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+
+  if (GetSparseSegmentCombiner(*node_def) == nullptr ||
+      !NodeIsOnCpu(node_def) || node_view->NumRegularFanins() < 3) {
+    return false;
+  }
+  if (!HasDataType(node_def, DT_FLOAT) && !HasDataType(node_def, DT_DOUBLE) &&
+      !HasDataType(node_def, DT_HALF) && !HasDataType(node_def, DT_BFLOAT16)) {
+    return false;
+  }
+
+  // Input to the reduction must be a ResourceGather that is consumed only by
+  // it. Control fanins of the gather are moved to the fused node.
+  const auto& regular_fanin_0 = node_view->GetRegularFanin(0);
+  const auto* gather_node_view = regular_fanin_0.node_view();
+  const auto* gather_node_def = gather_node_view->node();
+  if (gather_node_def->op() != "ResourceGather" ||
+      !NodeIsOnCpu(gather_node_def) ||
+      gather_node_view->NumControlledFanouts() > 0 ||
+      !HasAtMostOneFanoutAtPort0(*gather_node_view) ||
+      IsInPreserveSet(ctx, gather_node_def)) {
+    return false;
+  }
+
+  int32_t batch_dims;
+  if (!TryGetNodeAttr(*gather_node_def, "batch_dims", &batch_dims) ||
+      batch_dims != 0) {
+    return false;
+  }
+  if (GetDataTypeFromAttr(*gather_node_def, "dtype") !=
+          GetDataTypeFromAttr(*node_def, "T") ||
+      GetDataTypeFromAttr(*gather_node_def, "Tindices") !=
+          GetDataTypeFromAttr(*node_def, "Tidx")) {
+    return false;
+  }
+
+  // The fused kernel reads gather_indices as a vector, so their rank must be
+  // known to be 1.
+  if (!ctx.inferred_graph_properties) return false;
+  const auto& props =
+      ctx.graph_properties.GetInputProperties(gather_node_def->name());
+  if (props.size() < 2 || props[1].shape().unknown_rank() ||
+      props[1].shape().dim_size() != 1) {
+    return false;
+  }
+
+  *matched = ResourceGatherWithSegmentReduction(gather_node_view->node_index(),
+                                                node_index);
+  return true;
+}
+
+// WARN: This should be consistent with fused_elementwise_op.cc.
+bool IsElementwiseChainUnaryOp(const string& op) {
+  static const auto* const ops = new absl::flat_hash_set<string>(
+      {"Abs", "Exp", "Inv", "Log", "Neg", "Reciprocal", "Relu", "Relu6",
+       "Rsqrt", "Sigmoid", "Sqrt", "Square", "Tanh"});
+  return ops->contains(op);
+}
+
+bool IsElementwiseChainBinaryOp(const string& op) {
+  static const auto* const ops = new absl::flat_hash_set<string>(
+      {"Add", "AddV2", "Div", "Maximum", "Minimum", "Mul", "RealDiv",
+       "SquaredDifference", "Sub"});
+  return ops->contains(op);
+}
+
+bool IsCommutativeElementwiseChainOp(const string& op) {
+  return op == "Add" || op == "AddV2" || op == "Maximum" || op == "Minimum" ||
+         op == "Mul" || op == "SquaredDifference";
+}
+
+// Appends the names of the ops that "node" contributes to an elementwise
+// chain, or returns false if it can not be part of one. A _UnaryOpsComposition
+// created by the ArithmeticOptimizer contributes its own chain of unary ops.
+bool GetElementwiseChainOps(const NodeDef& node,
+                            std::vector<string>* fused_ops) {
+  if (IsElementwiseChainUnaryOp(node.op()) ||
+      IsElementwiseChainBinaryOp(node.op())) {
+    fused_ops->push_back(node.op());
+    return true;
+  }
+  if (node.op() != kUnaryOpsComposition) return false;
+  std::vector<string> op_names;
+  if (!TryGetNodeAttr(node, "op_names", &op_names) || op_names.empty() ||
+      !absl::c_all_of(op_names, IsElementwiseChainUnaryOp)) {
+    return false;
+  }
+  fused_ops->insert(fused_ops->end(), op_names.begin(), op_names.end());
+  return true;
+}
+
+bool FindElementwiseChain(const RemapperContext& ctx, int node_index,
+                          ElementwiseChain* matched) {
+  // Root of the pattern must be an elementwise op on CPU or GPU. On GPU the
+  // fused op runs the chain in a single kernel launch. XLA does its own
+  // elementwise fusion.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  std::vector<string> root_ops;
+  const bool is_on_gpu = NodeIsOnGpu(node_def);
+  if (!GetElementwiseChainOps(*node_def, &root_ops) ||
+      !(NodeIsOnCpu(node_def) || is_on_gpu) || ctx.xla_auto_clustering_on ||
+      !ctx.inferred_graph_properties) {
+    return false;
+  }
+  const DataType dtype = GetDataTypeFromAttr(*node_def, "T");
+  if (dtype != DT_FLOAT && dtype != DT_DOUBLE && dtype != DT_HALF &&
+      (dtype != DT_BFLOAT16 || is_on_gpu)) {
+    return false;
+  }
+  const auto& output_props =
+      ctx.graph_properties.GetOutputProperties(node_def->name());
+  if (output_props.empty()) return false;
+  const TensorShapeProto& shape = output_props[0].shape();
+
+  // Returns true if "view" can be followed into the chain, below the root.
+  const auto can_follow = [&](const utils::MutableNodeView& view) {
+    const NodeDef* node = view.node();
+    std::vector<string> unused;
+    return GetElementwiseChainOps(*node, &unused) &&
+           node->device() == node_def->device() &&
+           GetDataTypeFromAttr(*node, "T") == dtype &&
+           !HasControlFaninOrFanout(view) && HasAtMostOneFanoutAtPort0(view) &&
+           !IsInPreserveSet(ctx, node);
+  };
+
+  // Returns the input port that carries the result of the chain into "view",
+  // or -1 if "view" can not be part of the chain. Ops that read a contraction,
+  // a BiasAdd or a FusedBatchNorm are left to the other remapper fusions.
+  const auto chain_port = [&](const utils::MutableNodeView& view) -> int {
+    for (int i = 0; i < view.NumRegularFanins(); ++i) {
+      const NodeDef* fanin = view.GetRegularFanin(i).node_view()->node();
+      if (IsConvOrMatMul(*fanin) || IsBiasAdd(*fanin) ||
+          IsFusedBatchNorm(*fanin)) {
+        return -1;
+      }
+    }
+    const NodeDef* node = view.node();
+    if (!IsElementwiseChainBinaryOp(node->op())) {
+      return view.NumRegularFanins() == 1 ? 0 : -1;
+    }
+    const auto& props = ctx.graph_properties.GetInputProperties(node->name());
+    if (props.size() != 2 || view.NumRegularFanins() != 2) return -1;
+    const auto is_full = [&](int port) {
+      return ShapesSymbolicallyEqual(props[port].shape(), shape);
+    };
+    const auto is_scalar = [&](int port) {
+      return !props[port].shape().unknown_rank() &&
+             props[port].shape().dim_size() == 0;
+    };
+    const bool is_commutative = IsCommutativeElementwiseChainOp(node->op());
+    if (is_full(0) && (is_full(1) || is_scalar(1))) {
+      // Follow the second input if only it continues the chain.
+      if (is_commutative && is_full(1) &&
+          !can_follow(*view.GetRegularFanin(0).node_view()) &&
+          can_follow(*view.GetRegularFanin(1).node_view())) {
+        return 1;
+      }
+      return 0;
+    }
+    if (is_commutative && is_full(1) && is_scalar(0)) return 1;
+    return -1;
+  };
+
+  // Walk up from the root for as long as the chain can be extended.
+  std::vector<const utils::MutableNodeView*> chain;
+  std::vector<int> ports;
+  const utils::MutableNodeView* view = node_view;
+  int port = chain_port(*view);
+  while (port >= 0) {
+    chain.push_back(view);
+    ports.push_back(port);
+    const auto* producer = view->GetRegularFanin(port).node_view();
+    if (!can_follow(*producer)) break;
+    view = producer;
+    port = chain_port(*view);
+  }
+  if (chain.size() < 2) return false;
+
+  ElementwiseChain pattern;
+  const NodeDef* first = chain.back()->node();
+  pattern.args.push_back(first->input(ports.back()));
+  for (int i = static_cast<int>(chain.size()) - 1; i >= 0; --i) {
+    const NodeDef* node = chain[i]->node();
+    pattern.nodes.push_back(chain[i]->node_index());
+    GetElementwiseChainOps(*node, &pattern.fused_ops);
+    if (IsElementwiseChainBinaryOp(node->op())) {
+      pattern.args.push_back(node->input(1 - ports[i]));
+    }
+  }
+
+  *matched = std::move(pattern);
+  return true;
+}
+
 bool FindFusedBatchMatMul(RemapperContext* ctx, int node_index,
                           std::map<string, int>* matched_nodes_map,
                           std::set<int>* remove_node_indices) {
@@ -2322,9 +2572,11 @@ Status AddFusedContractionNode(
     RemapperContext* ctx, const ContractionWithBiasAndAddActivation& matched,
     std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
   const GraphDef* graph = ctx->graph_view.graph();
-  // MKL version only support fusion for Conv2D
+  // MKL version only support fusion for Conv2D and Conv3D, Eigen for Conv2D and
+  // MatMul.
   const NodeDef& contraction = graph->node(matched.contraction);
-  DCHECK(IsConv2D(contraction) || IsConv3D(contraction));
+  DCHECK(IsConv2D(contraction) || IsConv3D(contraction) ||
+         IsMatMul(contraction));
   const NodeDef& activation = graph->node(matched.activation);
 
   NodeDef fused_conv;
@@ -2337,10 +2589,13 @@ Status AddFusedContractionNode(
 
   if (IsConv2D(contraction)) {
     fused_conv.set_op(kFusedConv2D);
-    CopyConv2DAttributes(contraction, &fused_conv);
+    CopyConv2DAttributes(contraction, &fused_conv, &activation);
   } else if (IsConv3D(contraction)) {
     fused_conv.set_op(kFusedConv3D);
-    CopyConv3DAttributes(contraction, &fused_conv);
+    CopyConv3DAttributes(contraction, &fused_conv, &activation);
+  } else if (IsMatMul(contraction)) {
+    fused_conv.set_op(kFusedMatMul);
+    CopyMatMulAttributes(contraction, &fused_conv, &activation);
   }
 
   // Add OP has two inputs, one is conv+bias pattern matched previously,
@@ -2850,6 +3105,198 @@ Status AddTensorToHashBucketNode(RemapperContext* ctx,
   return Status::OK();
 }
 
+Status AddResourceSparseSegmentReductionNode(
+    RemapperContext* ctx, const ResourceGatherWithSegmentReduction& matched,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& gather = graph->node(matched.gather);
+  const NodeDef& segment_reduction = graph->node(matched.segment_reduction);
+  VLOG(2) << "Fuse ResourceGather with " << segment_reduction.op() << ":"
+          << " gather=" << gather.name()
+          << " segment_reduction=" << segment_reduction.name()
+          << " on device=" << segment_reduction.device();
+
+  NodeDef fused_op;
+  fused_op.set_name(segment_reduction.name());
+  fused_op.set_device(segment_reduction.device());
+  fused_op.add_input(gather.input(0));             // 0: resource
+  fused_op.add_input(gather.input(1));             // 1: gather_indices
+  fused_op.add_input(segment_reduction.input(1));  // 2: indices
+  fused_op.add_input(segment_reduction.input(2));  // 3: segment_ids
+  absl::flat_hash_set<string> control_inputs;
+  for (const NodeDef* node : {&gather, &segment_reduction}) {
+    for (const string& input : node->input()) {
+      if (IsControlInput(input) && control_inputs.insert(input).second) {
+        fused_op.add_input(input);
+      }
+    }
+  }
+  fused_op.set_op(kResourceSparseSegmentReduction);
+
+  auto* attr = fused_op.mutable_attr();
+  auto& src_attr = segment_reduction.attr();
+  (*attr)["dtype"] = gather.attr().at("dtype");
+  for (const char* name : {"Tidx", "Tsegmentids"}) {
+    auto it = src_attr.find(name);
+    if (it != src_attr.end()) (*attr)[name] = it->second;
+  }
+  (*attr)["combiner"].set_s(GetSparseSegmentCombiner(segment_reduction));
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.segment_reduction] = true;
+  (*nodes_to_delete)[matched.gather] = true;
+
+  return Status::OK();
+}
+
+Status AddFusedElementwiseNode(RemapperContext* ctx,
+                               const ElementwiseChain& matched,
+                               std::vector<bool>* invalidated_nodes,
+                               std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& root = graph->node(matched.nodes.back());
+  VLOG(2) << "Fuse elementwise ops: root=" << root.name() << " fused_ops=["
+          << absl::StrJoin(matched.fused_ops, ", ") << "]"
+          << " on device=" << root.device();
+
+  NodeDef fused_op;
+  fused_op.set_name(root.name());
+  fused_op.set_device(root.device());
+  for (const string& arg : matched.args) fused_op.add_input(arg);
+  // Only the root of the chain may have control fanins.
+  for (const string& input : root.input()) {
+    if (IsControlInput(input)) fused_op.add_input(input);
+  }
+  fused_op.set_op(kFusedElementwise);
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = root.attr().at("T");
+  SetAttrValue(static_cast<int>(matched.args.size()), &(*attr)["num_args"]);
+  SetAttrValue(matched.fused_ops, &(*attr)["fused_ops"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.nodes.back()] = true;
+  for (size_t i = 0; i + 1 < matched.nodes.size(); ++i) {
+    (*nodes_to_delete)[matched.nodes[i]] = true;
+  }
+
+  return Status::OK();
+}
+
+bool IsGroupedMatMulCandidate(const RemapperContext& ctx,
+                              const utils::MutableNodeView& node_view) {
+  const NodeDef* node = node_view.node();
+  if (!IsMatMul(*node) || !NodeIsOnGpu(node) || IsInPreserveSet(ctx, node)) {
+    return false;
+  }
+  const DataType dtype = GetDataTypeFromAttr(*node, "T");
+  return dtype == DT_FLOAT || dtype == DT_HALF || dtype == DT_DOUBLE;
+}
+
+// Replaces MatMuls on GPU that do not depend on each other with a
+// _GroupedMatMul, which computes the products of the same shape with one
+// batched GEMM launch. Each MatMul becomes an Identity of the corresponding
+// output of the _GroupedMatMul, so that its fanouts are unchanged.
+//
+// Two MatMuls at the same depth, i.e. the same length of the longest path from
+// a source node, can not depend on each other, so grouping them can not create
+// a cycle. Graphs with control flow are skipped, because the MatMuls might be
+// in different frames or branches.
+Status AddGroupedMatMulNodes(RemapperContext* ctx) {
+  TF_RETURN_IF_ERROR(
+      ctx->graph_view.SortTopologically(/*ignore_cycles=*/false, {}));
+  const int num_nodes = ctx->graph_view.NumNodes();
+
+  std::vector<int> depth(num_nodes, 0);
+  std::map<std::tuple<int, string, DataType, bool, bool>, std::vector<int>>
+      groups;
+  for (int i = 0; i < num_nodes; ++i) {
+    const auto* node_view = ctx->graph_view.GetNode(i);
+    if (IsControlFlow(*node_view->node())) return Status::OK();
+    for (const auto& fanin : node_view->GetRegularFanins()) {
+      depth[i] = std::max(depth[i], depth[fanin.node_index()] + 1);
+    }
+    for (const auto& fanin : node_view->GetControllingFanins()) {
+      depth[i] = std::max(depth[i], depth[fanin.node_index()] + 1);
+    }
+    if (!IsGroupedMatMulCandidate(*ctx, *node_view)) continue;
+
+    const NodeDef* node = node_view->node();
+    bool transpose_a = false;
+    bool transpose_b = false;
+    if (!TryGetNodeAttr(*node, "transpose_a", &transpose_a) ||
+        !TryGetNodeAttr(*node, "transpose_b", &transpose_b)) {
+      continue;
+    }
+    groups[std::make_tuple(depth[i], node->device(),
+                           GetDataTypeFromAttr(*node, "T"), transpose_a,
+                           transpose_b)]
+        .push_back(i);
+  }
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  for (const auto& group : groups) {
+    const std::vector<int>& members = group.second;
+    if (members.size() < 2) continue;
+    const NodeDef* first = ctx->graph_view.GetNode(members[0])->node();
+    const string grouped_name = absl::StrCat(first->name(), "/grouped");
+    if (ctx->graph_view.GetNode(grouped_name) != nullptr) continue;
+    VLOG(2) << "Group " << members.size() << " MatMuls into " << grouped_name
+            << " on device=" << first->device();
+
+    NodeDef grouped;
+    grouped.set_name(grouped_name);
+    grouped.set_device(first->device());
+    grouped.set_op(kGroupedMatMul);
+    for (int port = 0; port < 2; ++port) {
+      for (int member : members) {
+        grouped.add_input(ctx->graph_view.GetNode(member)->node()->input(port));
+      }
+    }
+    absl::flat_hash_set<string> control_inputs;
+    for (int member : members) {
+      const NodeDef* matmul = ctx->graph_view.GetNode(member)->node();
+      for (const string& input : matmul->input()) {
+        if (IsControlInput(input) && control_inputs.insert(input).second) {
+          grouped.add_input(input);
+        }
+      }
+    }
+    auto* attr = grouped.mutable_attr();
+    (*attr)["T"] = first->attr().at("T");
+    (*attr)["transpose_a"] = first->attr().at("transpose_a");
+    (*attr)["transpose_b"] = first->attr().at("transpose_b");
+    SetAttrValue(static_cast<int>(members.size()), &(*attr)["N"]);
+
+    for (int i = 0; i < static_cast<int>(members.size()); ++i) {
+      const NodeDef* matmul = ctx->graph_view.GetNode(members[i])->node();
+      NodeDef identity;
+      identity.set_name(matmul->name());
+      identity.set_device(matmul->device());
+      identity.set_op("Identity");
+      identity.add_input(absl::StrCat(grouped_name, ":", i));
+      (*identity.mutable_attr())["T"] = matmul->attr().at("T");
+      Status status;
+      mutation->AddNode(std::move(identity), &status);
+      TF_RETURN_IF_ERROR(status);
+    }
+    Status status;
+    mutation->AddNode(std::move(grouped), &status);
+    TF_RETURN_IF_ERROR(status);
+  }
+  return mutation->Apply();
+}
+
 Status AddFusedBatchMatMul(RemapperContext* ctx,
                            const std::map<string, int>& matched_nodes_map,
                            const std::set<int>& remove_node_indices,
@@ -3053,7 +3500,7 @@ Status ReplaceSoftplusTanhAndMulWithMish(
 //   (1) Splitting FusedBatchNorm into primitives.
 //   (2) Fusing side input and/or activation into FusedBatchNorm.
 //   (3) Fusing Conv2D biasadd and relu on GPU
-//   (4) INTEL_MKL specific: Conv2D -> Add or Conv2D -> BiasAdd -> Add.
+//   (4) Conv2D -> Add or Conv2D -> BiasAdd -> Add.
 //   (5) Fusing side output and/or activation into FusedBatchNormGrad.
 bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
   // Candidate for a FusedBatchNorm splitting.
@@ -3144,13 +3591,37 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
     return false;
   };
 
+  // Candidate for a ResourceGather + SparseSegment{Sum,Mean,SqrtN} fusion.
+  const auto is_resource_gather_segment_reduction_candidate = [&]() -> bool {
+    if (GetSparseSegmentCombiner(*node_def) == nullptr) return false;
+    if (node_view->NumRegularFanins() < 1) return false;
+    const auto& fanin_0 = node_view->GetRegularFanin(0);
+    return fanin_0.node_view()->node()->op() == "ResourceGather";
+  };
+
+  // Candidate for an elementwise chain fusion.
+  const auto is_elementwise_chain_candidate = [&]() -> bool {
+    std::vector<string> unused;
+    if (!GetElementwiseChainOps(*node_def, &unused)) return false;
+    for (int i = 0; i < node_view->NumRegularFanins(); ++i) {
+      const auto* fanin_def = node_view->GetRegularFanin(i).node_view()->node();
+      if (GetElementwiseChainOps(*fanin_def, &unused)) return true;
+    }
+    return false;
+  };
+
   if (IsMKLEnabled())
     return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
-           IsContractionWithAdd(ctx, node_index);
+           IsContractionWithAdd(ctx, node_index) ||
+           is_resource_gather_segment_reduction_candidate() ||
+           is_elementwise_chain_candidate();
 
   return is_relu_biasadd_conv_candidate() || is_batch_norm_candidate() ||
          is_batch_norm_fusion_candidate() ||
-         is_batch_norm_grad_fusion_candidate();
+         IsContractionWithAdd(ctx, node_index) ||
+         is_batch_norm_grad_fusion_candidate() ||
+         is_resource_gather_segment_reduction_candidate() ||
+         is_elementwise_chain_candidate();
 }
 }  // namespace
 
@@ -3197,26 +3668,27 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     ContractionWithBiasAddAndAdd contract_with_bias_and_add;
     ContractionWithBiasAndAddActivation contract_with_bias_and_add_activation;
 
-    if (IsMKLEnabled()) {
-      // Remap Conv2D+BiasAdd+Add+relu into the _FusedConv2D.
-      // or Remap Conv3D+BiasAdd+Add+relu into _FusedConv3D
-      if (FindContractionWithBiasAndAddActivation(
-              ctx, i, &contract_with_bias_and_add_activation)) {
-        TF_RETURN_IF_ERROR(
-            AddFusedContractionNode(&ctx, contract_with_bias_and_add_activation,
-                                    &invalidated_nodes, &nodes_to_delete));
-        continue;
-      }
+    // Remap {Conv2D,Conv3D,MatMul}+BiasAdd+Add+activation into the
+    // _Fused{Conv2D,Conv3D,MatMul}.
+    if (FindContractionWithBiasAndAddActivation(
+            ctx, i, &contract_with_bias_and_add_activation)) {
+      TF_RETURN_IF_ERROR(
+          AddFusedContractionNode(&ctx, contract_with_bias_and_add_activation,
+                                  &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
 
-      // Remap {Conv2D,Conv3D}+BiasAdd+Add into the _FusedConv2D/3D.
-      if (FindContractionWithBiasAddAndAdd(ctx, i,
-                                           &contract_with_bias_and_add)) {
-        TF_RETURN_IF_ERROR(
-            AddFusedContractionNode(&ctx, contract_with_bias_and_add,
-                                    &invalidated_nodes, &nodes_to_delete));
-        continue;
-      }
+    // Remap {Conv2D,Conv3D,MatMul}+BiasAdd+Add into the
+    // _Fused{Conv2D,Conv3D,MatMul}.
+    if (FindContractionWithBiasAddAndAdd(ctx, i,
+                                         &contract_with_bias_and_add)) {
+      TF_RETURN_IF_ERROR(
+          AddFusedContractionNode(&ctx, contract_with_bias_and_add,
+                                  &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
 
+    if (IsMKLEnabled()) {
       PadWithConv3D pad_with_conv3d;
       // Remap Pad+{Conv3D,_FusedConv3D} into the _FusedConv3D.
       if (FindPadWithConv3D(ctx, i, &pad_with_conv3d)) {
@@ -3224,20 +3696,21 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
             &ctx, pad_with_conv3d, &invalidated_nodes, &nodes_to_delete));
         continue;
       }
+    }
 
-      // Remap MatMul + BiasAdd + gelu-subgraph
-      std::map<string, int> matched_nodes_map;
-      std::set<int> remove_node_indices;
-      bool is_gelu_approximate = false;
-      if (FindMatMulBiasAddAndGelu(&ctx, i, &matched_nodes_map,
-                                   &remove_node_indices,
-                                   &is_gelu_approximate)) {
-        TF_RETURN_IF_ERROR(AddFusedMatMulBiasAddAndGelu(
-            &ctx, matched_nodes_map, remove_node_indices, &invalidated_nodes,
-            &nodes_to_delete, is_gelu_approximate));
-        continue;
-      }
+    // Remap MatMul + BiasAdd + gelu-subgraph
+    std::map<string, int> matched_nodes_map;
+    std::set<int> remove_node_indices;
+    bool is_gelu_approximate = false;
+    if (FindMatMulBiasAddAndGelu(&ctx, i, &matched_nodes_map,
+                                 &remove_node_indices, &is_gelu_approximate)) {
+      TF_RETURN_IF_ERROR(AddFusedMatMulBiasAddAndGelu(
+          &ctx, matched_nodes_map, remove_node_indices, &invalidated_nodes,
+          &nodes_to_delete, is_gelu_approximate));
+      continue;
+    }
 
+    if (IsMKLEnabled()) {
       // Softplus + Tanh + Mul to Mish conversion
       matched_nodes_map.clear();
       remove_node_indices.clear();
@@ -3378,6 +3851,27 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Remap ResourceGather+SparseSegment{Sum,Mean,SqrtN} into the
+    // _ResourceSparseSegmentReduction.
+    ResourceGatherWithSegmentReduction resource_gather_with_segment_reduction;
+    if (allow_non_differentiable_rewrites &&
+        FindResourceGatherWithSegmentReduction(
+            ctx, i, &resource_gather_with_segment_reduction)) {
+      TF_RETURN_IF_ERROR(AddResourceSparseSegmentReductionNode(
+          &ctx, resource_gather_with_segment_reduction, &invalidated_nodes,
+          &nodes_to_delete));
+      continue;
+    }
+
+    // Remap chains of elementwise ops into the _FusedElementwise.
+    ElementwiseChain elementwise_chain;
+    if (allow_non_differentiable_rewrites &&
+        FindElementwiseChain(ctx, i, &elementwise_chain)) {
+      TF_RETURN_IF_ERROR(AddFusedElementwiseNode(
+          &ctx, elementwise_chain, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
@@ -3396,6 +3890,13 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
   }
   TF_RETURN_IF_ERROR(mutation->Apply());
 
+  // Remap independent MatMuls on GPU into the _GroupedMatMul. This needs the
+  // final graph, so that MatMuls fused with their fanouts above are not
+  // grouped.
+  if (allow_non_differentiable_rewrites && !ctx.xla_auto_clustering_on) {
+    TF_RETURN_IF_ERROR(AddGroupedMatMulNodes(&ctx));
+  }
+
   *optimized_graph = std::move(mutable_item.graph);
 
   return Status::OK();
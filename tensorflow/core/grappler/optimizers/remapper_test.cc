@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/cc/ops/nn_ops_internal.h"
+#include "tensorflow/cc/ops/resource_variable_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
@@ -1350,6 +1352,265 @@ TEST_F(RemapperTensorToHashBucketTest, I32) { RunTest<DT_INT32>(); }
 
 TEST_F(RemapperTensorToHashBucketTest, I64) { RunTest<DT_INT64>(); }
 
+TEST_F(RemapperTest, FuseResourceGatherWithSparseSegmentMean) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output embeddings = ops::Const(s.WithOpName("embeddings"),
+                                 {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f}, {3, 2});
+  Output ids = ops::Const(s.WithOpName("ids"), {2, 0, 1, 2});
+  Output indices = ops::Const(s.WithOpName("indices"), {0, 1, 1, 2, 3});
+  Output segment_ids = ops::Const(s.WithOpName("segment_ids"), {0, 0, 1, 1, 3});
+
+  auto var =
+      ops::VarHandleOp(s.WithOpName("var"), DT_FLOAT, TensorShape({3, 2}));
+  ops::AssignVariableOp assign_op(s.WithOpName("assign"), var, embeddings);
+  Output gathered = ops::ResourceGather(
+      s.WithOpName("gathered")
+          .WithControlDependencies(std::vector<Operation>{assign_op}),
+      var, ids, DT_FLOAT);
+  Output result = ops::SparseSegmentMean(s.WithOpName("result"), gathered,
+                                         indices, segment_ids);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), result);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "gathered");
+    if (node.name() == "result") {
+      EXPECT_EQ(node.op(), "_ResourceSparseSegmentReduction");
+      ASSERT_EQ(node.input_size(), 5);
+      EXPECT_EQ(node.input(0), "var");
+      EXPECT_EQ(node.input(1), "ids");
+      EXPECT_EQ(node.input(2), "indices");
+      EXPECT_EQ(node.input(3), "segment_ids");
+      EXPECT_EQ(node.input(4), "^assign");
+      EXPECT_EQ(node.attr().at("combiner").s(), "mean");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(RemapperTest, FuseElementwiseChain) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto shape = ops::Placeholder::Shape({4, 8});
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT, shape);
+  auto y = Placeholder(s.WithOpName("y"), DT_FLOAT, shape);
+  auto z = Placeholder(s.WithOpName("z"), DT_FLOAT, shape);
+  auto c = ops::Const(s.WithOpName("c"), 0.5f, {});
+
+  auto mul = ops::Mul(s.WithOpName("mul"), x, y);
+  auto add = ops::AddV2(s.WithOpName("add"), c, mul);
+  auto tanh = ops::Tanh(s.WithOpName("tanh"), add);
+  auto sub = ops::Sub(s.WithOpName("sub"), tanh, z);
+  // Sub is not commutative, so the chain can not continue through its second
+  // input.
+  auto sub_rev = ops::Sub(s.WithOpName("sub_rev"), z, sub);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), sub_rev);
+
+  auto x_t = GenerateRandomTensor<DT_FLOAT>({4, 8});
+  auto y_t = GenerateRandomTensor<DT_FLOAT>({4, 8});
+  auto z_t = GenerateRandomTensor<DT_FLOAT>({4, 8});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"x", x_t}, {"y", y_t}, {"z", z_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "mul");
+    EXPECT_NE(node.name(), "add");
+    EXPECT_NE(node.name(), "tanh");
+    if (node.name() == "sub") {
+      EXPECT_EQ(node.op(), "_FusedElementwise");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "x");
+      EXPECT_EQ(node.input(1), "y");
+      EXPECT_EQ(node.input(2), "c");
+      EXPECT_EQ(node.input(3), "z");
+      EXPECT_EQ(node.attr().at("num_args").i(), 4);
+      const auto fused_ops = node.attr().at("fused_ops").list().s();
+      ASSERT_EQ(fused_ops.size(), 4);
+      EXPECT_EQ(fused_ops[0], "Mul");
+      EXPECT_EQ(fused_ops[1], "AddV2");
+      EXPECT_EQ(fused_ops[2], "Tanh");
+      EXPECT_EQ(fused_ops[3], "Sub");
+      found++;
+    }
+    if (node.name() == "sub_rev") {
+      EXPECT_EQ(node.op(), "Sub");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 2);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(RemapperTest, FuseElementwiseChainOnGpu) {
+#if !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+  GTEST_SKIP() << "Neither CUDA nor ROCm is enabled";
+#endif  // !GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto shape = ops::Placeholder::Shape({4, 8});
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT, shape);
+  auto y = Placeholder(s.WithOpName("y"), DT_FLOAT, shape);
+
+  auto mul = ops::Mul(s.WithOpName("mul"), x, y);
+  auto relu = ops::Relu(s.WithOpName("relu"), mul);
+  auto sigmoid = ops::Sigmoid(s.WithOpName("sigmoid"), relu);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), sigmoid);
+
+  auto x_t = GenerateRandomTensor<DT_FLOAT>({4, 8});
+  auto y_t = GenerateRandomTensor<DT_FLOAT>({4, 8});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"x", x_t}, {"y", y_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:GPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "mul");
+    EXPECT_NE(node.name(), "relu");
+    if (node.name() == "sigmoid") {
+      EXPECT_EQ(node.op(), "_FusedElementwise");
+      EXPECT_EQ(node.device(), "/device:GPU:0");
+      ASSERT_EQ(node.input_size(), 2);
+      const auto fused_ops = node.attr().at("fused_ops").list().s();
+      ASSERT_EQ(fused_ops.size(), 3);
+      EXPECT_EQ(fused_ops[0], "Mul");
+      EXPECT_EQ(fused_ops[1], "Relu");
+      EXPECT_EQ(fused_ops[2], "Sigmoid");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(RemapperTest, GroupIndependentMatMuls) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto shape = ops::Placeholder::Shape({4, 8});
+  auto x0 = Placeholder(s.WithOpName("x0"), DT_FLOAT, shape);
+  auto x1 = Placeholder(s.WithOpName("x1"), DT_FLOAT, shape);
+  auto x2 = Placeholder(s.WithOpName("x2"), DT_FLOAT, shape);
+  auto w0 = ops::Const(s.WithOpName("w0"), Input::Initializer(1.0f, {8, 16}));
+  auto w1 = ops::Const(s.WithOpName("w1"), Input::Initializer(2.0f, {8, 16}));
+  auto w2 = ops::Const(s.WithOpName("w2"), Input::Initializer(3.0f, {8, 4}));
+  auto w3 = ops::Const(s.WithOpName("w3"), Input::Initializer(4.0f, {16, 2}));
+
+  auto matmul0 = ops::MatMul(s.WithOpName("matmul0"), x0, w0);
+  auto matmul1 = ops::MatMul(s.WithOpName("matmul1"), x1, w1);
+  auto matmul2 = ops::MatMul(s.WithOpName("matmul2"), x2, w2);
+  // Depends on matmul0, so it can not be grouped with it.
+  auto matmul3 = ops::MatMul(s.WithOpName("matmul3"), matmul0, w3);
+  auto fetch1 = ops::Identity(s.WithOpName("fetch1"), matmul1);
+  auto fetch2 = ops::Identity(s.WithOpName("fetch2"), matmul2);
+  auto fetch3 = ops::Identity(s.WithOpName("fetch3"), matmul3);
+
+  auto x0_t = GenerateRandomTensor<DT_FLOAT>({4, 8});
+  auto x1_t = GenerateRandomTensor<DT_FLOAT>({4, 8});
+  auto x2_t = GenerateRandomTensor<DT_FLOAT>({4, 8});
+
+  GrapplerItem item;
+  item.fetch = {"fetch1", "fetch2", "fetch3"};
+  item.feed = {{"x0", x0_t}, {"x1", x1_t}, {"x2", x2_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:GPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef* grouped = nullptr;
+  for (const NodeDef& node : output.node()) {
+    if (node.op() == "_GroupedMatMul") {
+      EXPECT_EQ(grouped, nullptr);
+      grouped = &node;
+    }
+    if (node.name() == "matmul3") EXPECT_EQ(node.op(), "MatMul");
+  }
+  ASSERT_NE(grouped, nullptr);
+  EXPECT_EQ(grouped->attr().at("N").i(), 3);
+  ASSERT_EQ(grouped->input_size(), 6);
+
+  // Each MatMul reads the output of the _GroupedMatMul whose inputs are its
+  // own inputs.
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    for (int i = 0; i < 3; ++i) {
+      if (node.name() != absl::StrCat("matmul", i)) continue;
+      EXPECT_EQ(node.op(), "Identity");
+      ASSERT_EQ(node.input_size(), 1);
+      for (int j = 0; j < 3; ++j) {
+        if (node.input(0) != absl::StrCat(grouped->name(), ":", j)) continue;
+        EXPECT_EQ(grouped->input(j), absl::StrCat("x", i));
+        EXPECT_EQ(grouped->input(3 + j), absl::StrCat("w", i));
+        found++;
+      }
+    }
+  }
+  EXPECT_EQ(found, 3);
+
+  if (GetNumAvailableGPUs() > 0) {
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 3);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 3);
+    for (int i = 0; i < 3; ++i) {
+      test::ExpectTensorNear<float>(tensors[i], tensors_expected[i], 1e-5);
+    }
+  }
+}
+
 class RemapperFuseMatMulWithBiasTest : public RemapperTest {
  public:
   template <DataType DTYPE>
@@ -1507,12 +1768,8 @@ class RemapperFuseMatMulWithBiasAndActivationTest : public RemapperTest {
   void RunTest() {
     using ::tensorflow::ops::Placeholder;
 
-#if defined(INTEL_MKL) && defined(ENABLE_MKL)
     std::vector<string> activations = {"Relu", "Relu6", "Elu", "Tanh",
                                        "LeakyRelu"};
-#else
-    std::vector<string> activations = {"Relu", "Relu6", "Elu", "LeakyRelu"};
-#endif
 
     for (const string& activation : activations) {
       tensorflow::Scope s = tensorflow::Scope::NewRootScope();
@@ -1619,6 +1876,76 @@ TEST_F(RemapperFuseMatMulWithBiasAndActivationTest, Bf16) {
   RunTest<DT_BFLOAT16>();  // NOLINT
 }
 
+TEST_F(RemapperTest, FuseMatMulWithBiasAddAndAddTanh) {
+  if (IsMKLEnabled()) GTEST_SKIP() << "Test not applicable to oneDNN.";
+  using ::tensorflow::ops::Placeholder;
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto lhs = Placeholder(s.WithOpName("lhs"), DT_FLOAT,
+                         ops::Placeholder::Shape({8, 32}));
+  auto rhs = Placeholder(s.WithOpName("rhs"), DT_FLOAT,
+                         ops::Placeholder::Shape({32, 64}));
+  auto bias = Placeholder(s.WithOpName("bias"), DT_FLOAT,
+                          ops::Placeholder::Shape({64}));
+  auto residual = Placeholder(s.WithOpName("residual"), DT_FLOAT,
+                              ops::Placeholder::Shape({8, 64}));
+
+  auto matmul = ops::MatMul(s.WithOpName("matmul"), lhs, rhs);
+  auto bias_add = ops::BiasAdd(s.WithOpName("bias_add"), matmul, bias);
+  auto add = ops::Add(s.WithOpName("add"), bias_add, residual);
+  auto tanh = ops::Tanh(s.WithOpName("tanh"), add);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), tanh);
+
+  auto lhs_t = GenerateRandomTensor<DT_FLOAT>({8, 32});
+  auto rhs_t = GenerateRandomTensor<DT_FLOAT>({32, 64});
+  auto bias_t = GenerateRandomTensor<DT_FLOAT>({64});
+  auto residual_t = GenerateRandomTensor<DT_FLOAT>({8, 64});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"lhs", lhs_t},
+               {"rhs", rhs_t},
+               {"bias", bias_t},
+               {"residual", residual_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "tanh") {
+      EXPECT_EQ(node.op(), "_FusedMatMul");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "lhs");
+      EXPECT_EQ(node.input(1), "rhs");
+      EXPECT_EQ(node.input(2), "bias");
+      EXPECT_EQ(node.input(3), "residual");
+      EXPECT_EQ(node.attr().at("num_args").i(), 2);
+
+      const auto fused_ops = node.attr().at("fused_ops").list().s();
+      ASSERT_EQ(fused_ops.size(), 3);
+      EXPECT_EQ(fused_ops[0], "BiasAdd");
+      EXPECT_EQ(fused_ops[1], "Add");
+      EXPECT_EQ(fused_ops[2], "Tanh");
+      found++;
+    }
+  }
+  EXPECT_EQ(1, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectClose(tensors[0], tensors_expected[0], 1e-6);
+}
+
 TEST_F(RemapperTest, FuseConv2DWithBatchNorm) {
   using ops::Placeholder;
 
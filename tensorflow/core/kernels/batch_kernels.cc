@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batch_kernels.h"
 
+#include <algorithm>
+
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/framework/function.h"
@@ -47,6 +50,8 @@ constexpr char kMinInflightBatchesAttr[] = "_min_inflight_batches";
 constexpr char kInitialInflightBatchesAttr[] = "_initial_inflight_batches";
 constexpr char kMaxInflightBatchesAttr[] = "_max_inflight_batches";
 constexpr char kBatchesToAverageOverAttr[] = "_batches_to_average_over";
+constexpr char kRaggedInputsAttr[] = "_ragged_inputs";
+constexpr char kRaggedOutputsAttr[] = "_ragged_outputs";
 
 // Default thread count in the per-process batching thread pool.
 constexpr int64_t kBatchThreadPoolSize = 128;
@@ -137,6 +142,7 @@ class BatchResource : public serving::BatchResourceBase {
                        FunctionLibraryRuntime::Handle fhandle,
                        FunctionLibraryRuntime* flib,
                        bool enable_large_batch_splitting,
+                       RaggedBatchingOptions ragged_batching_options,
                        std::unique_ptr<BatchResource>* resource) {
     BatcherT::Options batcher_options;
     batcher_options.num_batch_threads = num_batch_threads;
@@ -149,7 +155,7 @@ class BatchResource : public serving::BatchResourceBase {
                                batch_timeout_micros, max_enqueued_batches,
                                allowed_batch_sizes,
                                enable_large_batch_splitting),
-        allowed_batch_sizes));
+        allowed_batch_sizes, std::move(ragged_batching_options)));
     return Status::OK();
   }
 
@@ -159,6 +165,7 @@ class BatchResource : public serving::BatchResourceBase {
       int32_t max_enqueued_batches,
       const std::vector<int32>& allowed_batch_sizes,
       FunctionLibraryRuntime::Handle fhandle, FunctionLibraryRuntime* flib,
+      RaggedBatchingOptions ragged_batching_options,
       std::unique_ptr<BatchResource>* resource) {
     std::shared_ptr<AdaptiveBatcherT> batcher;
     TF_RETURN_IF_ERROR(AdaptiveBatcherT::Create(
@@ -169,7 +176,7 @@ class BatchResource : public serving::BatchResourceBase {
         GetAdaptiveBatcherQueueOptions(
             max_batch_size, batch_timeout_micros, max_enqueued_batches,
             true /* enable large batch split */, allowed_batch_sizes),
-        allowed_batch_sizes));
+        allowed_batch_sizes, std::move(ragged_batching_options)));
     return Status::OK();
   }
 
@@ -179,11 +186,13 @@ class BatchResource : public serving::BatchResourceBase {
   BatchResource(FunctionLibraryRuntime::Handle fhandle,
                 FunctionLibraryRuntime* flib, std::shared_ptr<BatcherT> batcher,
                 const BatcherT::QueueOptions& batcher_queue_options,
-                std::vector<int32> allowed_batch_sizes)
+                std::vector<int32> allowed_batch_sizes,
+                RaggedBatchingOptions ragged_batching_options)
       : BatchResourceBase(
             /*has_process_batch_function=*/fhandle != kInvalidHandle,
             std::move(batcher), batcher_queue_options,
-            std::move(allowed_batch_sizes)),
+            std::move(allowed_batch_sizes),
+            std::move(ragged_batching_options)),
         fhandle_(fhandle),
         flib_(flib) {}
 
@@ -191,11 +200,13 @@ class BatchResource : public serving::BatchResourceBase {
                 FunctionLibraryRuntime* flib,
                 std::shared_ptr<AdaptiveBatcherT> batcher,
                 const AdaptiveBatcherT::QueueOptions& batcher_queue_options,
-                std::vector<int32> allowed_batch_sizes)
+                std::vector<int32> allowed_batch_sizes,
+                RaggedBatchingOptions ragged_batching_options)
       : BatchResourceBase(
             /*has_process_batch_function=*/fhandle != kInvalidHandle,
             std::move(batcher), batcher_queue_options,
-            std::move(allowed_batch_sizes)),
+            std::move(allowed_batch_sizes),
+            std::move(ragged_batching_options)),
         fhandle_(fhandle),
         flib_(flib) {}
 
@@ -247,6 +258,17 @@ BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
   OP_REQUIRES_OK(c, c->GetAttr("f", &func_));
   flib_ = c->function_library();
 
+  if (c->HasAttr(kRaggedInputsAttr)) {
+    OP_REQUIRES_OK(c, c->GetAttr(kRaggedInputsAttr, &ragged_input_indices_));
+  }
+  if (c->HasAttr(kRaggedOutputsAttr)) {
+    OP_REQUIRES_OK(c,
+                   c->GetAttr(kRaggedOutputsAttr, &ragged_output_indices_));
+  }
+  DataTypeVector in_types;
+  OP_REQUIRES_OK(c, c->GetAttr("Tin", &in_types));
+  OP_REQUIRES_OK(c, ValidateRaggedIndices(in_types.size(), c->num_outputs()));
+
   if (c->HasAttr("enable_large_batch_splitting")) {
     OP_REQUIRES_OK(c, c->GetAttr("enable_large_batch_splitting",
                                  &enable_large_batch_splitting_));
@@ -297,8 +319,12 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
   FunctionLibraryRuntime::Handle handle;
   OP_REQUIRES_OK_ASYNC(c, GetOrCreateFunctionHandle(c, &handle), done);
 
+  serving::BatchResourceBase::RaggedBatchingOptions ragged_batching_options;
+  ragged_batching_options.input_indices = ragged_input_indices_;
+  ragged_batching_options.output_indices = ragged_output_indices_;
+
   if (adaptive_batch_scheduler_options_ != absl::nullopt) {
-    creator = [this, handle](BatchResource** r) {
+    creator = [this, handle, ragged_batching_options](BatchResource** r) {
       serving::AdaptiveSharedBatchScheduler<
           serving::BatchResourceBase::BatchTask>::Options
           adaptive_shared_batch_scheduler_options;
@@ -331,17 +357,18 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
       TF_RETURN_IF_ERROR(BatchResource::Create(
           adaptive_shared_batch_scheduler_options, max_batch_size_,
           batch_timeout_micros_, max_enqueued_batches_, allowed_batch_sizes_,
-          handle, flib_, &new_resource));
+          handle, flib_, ragged_batching_options, &new_resource));
       *r = new_resource.release();
       return Status::OK();
     };
   } else {
-    creator = [this, handle](BatchResource** r) {
+    creator = [this, handle, ragged_batching_options](BatchResource** r) {
       std::unique_ptr<BatchResource> new_resource;
       TF_RETURN_IF_ERROR(BatchResource::Create(
           num_batch_threads_, max_batch_size_, batch_timeout_micros_,
           max_enqueued_batches_, allowed_batch_sizes_, handle, flib_,
-          enable_large_batch_splitting_, &new_resource));
+          enable_large_batch_splitting_, ragged_batching_options,
+          &new_resource));
       *r = new_resource.release();
       return Status::OK();
     };
@@ -394,6 +421,11 @@ Status BatchFunctionKernel::InstantiateFunction(
       // Currently, inputs are on CPU since they are concatenated on CPU
       opts.input_devices.push_back(cpu_device->name());
     }
+    // Ragged inputs are followed by their row splits.
+    if (std::find(ragged_input_indices_.begin(), ragged_input_indices_.end(),
+                  i) != ragged_input_indices_.end()) {
+      opts.input_devices.push_back(cpu_device->name());
+    }
   }
   OpInputList captured_tensors;
   TF_RETURN_IF_ERROR(c->input_list("captured_tensors", &captured_tensors));
@@ -459,6 +491,34 @@ Status BatchFunctionKernel::ValidateAllowedBatchSizes() const {
   return Status::OK();
 }
 
+Status BatchFunctionKernel::ValidateRaggedIndices(int num_in_tensors,
+                                                  int num_out_tensors) const {
+  auto validate = [](const std::vector<int32>& indices, int num_tensors,
+                     absl::string_view attr_name) -> Status {
+    for (size_t i = 0; i < indices.size(); ++i) {
+      if (indices[i] < 0 || indices[i] >= num_tensors) {
+        return errors::InvalidArgument(attr_name, " entry ", indices[i],
+                                       " is out of range [0, ", num_tensors,
+                                       ")");
+      }
+      if (i > 0 && indices[i] <= indices[i - 1]) {
+        return errors::InvalidArgument(
+            attr_name, " entries must be monotonically increasing");
+      }
+    }
+    return Status::OK();
+  };
+  TF_RETURN_IF_ERROR(
+      validate(ragged_input_indices_, num_in_tensors, kRaggedInputsAttr));
+  TF_RETURN_IF_ERROR(
+      validate(ragged_output_indices_, num_out_tensors, kRaggedOutputsAttr));
+  if (!ragged_output_indices_.empty() && ragged_input_indices_.empty()) {
+    return errors::InvalidArgument(kRaggedOutputsAttr, " requires ",
+                                   kRaggedInputsAttr);
+  }
+  return Status::OK();
+}
+
 // Initialize vars by reading from op-kernel-construction.
 // Vars
 // - enable_adaptive_batch_threads_
@@ -563,7 +623,8 @@ class BatchKernel : public AsyncOpKernel {
       TF_RETURN_IF_ERROR(BatchResource::Create(
           num_batch_threads_, max_batch_size_, batch_timeout_micros_,
           max_enqueued_batches_, allowed_batch_sizes_, kInvalidHandle,
-          /*flib=*/nullptr, false, &new_resource));
+          /*flib=*/nullptr, false, /*ragged_batching_options=*/{},
+          &new_resource));
       *r = new_resource.release();
       return Status::OK();
     };
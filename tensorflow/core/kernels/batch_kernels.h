@@ -63,6 +63,12 @@ class BatchFunctionKernel : public AsyncOpKernel {
   // to `max_batch_size_`.
   Status ValidateAllowedBatchSizes() const;
 
+  // Validates 'ragged_input_indices_' and 'ragged_output_indices_'. The entries
+  // must increase monotonically and index the 'num_in_tensors' inputs and the
+  // 'num_out_tensors' outputs respectively. Ragged outputs require a ragged
+  // input.
+  Status ValidateRaggedIndices(int num_in_tensors, int num_out_tensors) const;
+
   // Creates the function handle if it isn't initialized yet; and re-use it
   // afterwards.
   Status GetOrCreateFunctionHandle(OpKernelContext* c,
@@ -89,6 +95,10 @@ class BatchFunctionKernel : public AsyncOpKernel {
   int32 batch_timeout_micros_;
   int32 max_enqueued_batches_;
   std::vector<int32> allowed_batch_sizes_;
+  // The inputs and outputs that are batched without padding, see
+  // `BatchResourceBase::RaggedBatchingOptions`.
+  std::vector<int32> ragged_input_indices_;
+  std::vector<int32> ragged_output_indices_;
   NameAttrList func_;
   absl::optional<FunctionLibraryRuntime::Handle> fhandle_ TF_GUARDED_BY(mu_);
   FunctionLibraryRuntime* flib_;
@@ -15,8 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batch_kernels.h"
 
+#include <vector>
+
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/kernels/batch_kernel_test_util.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -33,4 +38,50 @@ TEST_P(BatchFunctionKernelTest, EnableAdaptiveScheduler) {
 
 INSTANTIATE_TEST_SUITE_P(Params, BatchFunctionKernelTest, ::testing::Bool());
 
+class BatchFunctionKernelRaggedTest : public OpsTestBase {
+ protected:
+  // Creates a BatchFunction with two inputs and two outputs.
+  Status Init(const std::vector<int32>& ragged_inputs,
+              const std::vector<int32>& ragged_outputs) {
+    NameAttrList f;
+    f.set_name("func_to_batch");
+    TF_CHECK_OK(
+        NodeDefBuilder("batch_function", "BatchFunction")
+            .Attr("max_batch_size", 8)
+            .Attr("num_batch_threads", 8)
+            .Attr("allowed_batch_sizes", {2, 4, 8})
+            .Attr("batch_timeout_micros", 1000)
+            .Attr("Tin", {DT_INT64, DT_FLOAT})
+            .Input(std::vector<NodeDefBuilder::NodeOut>{
+                {"ids", 0, DT_INT64}, {"weights", 0, DT_FLOAT}})
+            .Attr("Tcaptured", std::vector<DataType>{})
+            .Input(std::vector<NodeDefBuilder::NodeOut>{})
+            .Attr("Tout", {DT_FLOAT, DT_FLOAT})
+            .Attr("f", f)
+            .Attr("_ragged_inputs", ragged_inputs)
+            .Attr("_ragged_outputs", ragged_outputs)
+            .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(BatchFunctionKernelRaggedTest, ValidRaggedIndices) {
+  TF_EXPECT_OK(Init(/*ragged_inputs=*/{0, 1}, /*ragged_outputs=*/{1}));
+}
+
+TEST_F(BatchFunctionKernelRaggedTest, RaggedInputOutOfRange) {
+  const Status status = Init(/*ragged_inputs=*/{2}, /*ragged_outputs=*/{});
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+}
+
+TEST_F(BatchFunctionKernelRaggedTest, RaggedInputsNotIncreasing) {
+  const Status status = Init(/*ragged_inputs=*/{1, 0}, /*ragged_outputs=*/{});
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+}
+
+TEST_F(BatchFunctionKernelRaggedTest, RaggedOutputsRequireRaggedInputs) {
+  const Status status = Init(/*ragged_inputs=*/{}, /*ragged_outputs=*/{0});
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+}
+
 }  // namespace tensorflow
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batching_util/batch_resource_base.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
@@ -223,6 +226,8 @@ BatchResourceBase::BatchTask::CreateSplitTask(
   task->status = this->status;
   task->is_partial = true;
   task->start_time = this->start_time;
+  task->deadline = this->deadline;
+  task->low_priority = this->low_priority;
   task->request_cost = this->request_cost;
 
   return task;
@@ -238,6 +243,8 @@ Status BatchResourceBase::RegisterInput(
   std::unique_ptr<BatchTask> batch_components;
   TF_RETURN_IF_ERROR(CreateBatchTask(context, &batch_components));
   batch_components->start_time = EnvTime::NowNanos();
+  batch_components->deadline = context->deadline();
+  batch_components->low_priority = context->low_priority_batching();
   batch_components->guid = guid;
   batch_components->propagated_context = Context(ContextKind::kThread);
   OpInputList tensors;
@@ -256,6 +263,13 @@ Status BatchResourceBase::RegisterInput(
     }
     batch_components->inputs.push_back(tensor);
   }
+  for (int32 input_index : ragged_batching_options_.input_indices) {
+    if (input_index >= tensors.size() || tensors[input_index].dims() < 2) {
+      return errors::InvalidArgument(
+          "Ragged batching input ", input_index,
+          " must have at least two dimensions");
+    }
+  }
   RecordInputBatchSize(tensors[0].shape().dim_size(0), GetModelName(context),
                        context->op_kernel().name_view().data());
   RecordInputBatchSizeV2(tensors[0].shape().dim_size(0), GetModelName(context),
@@ -324,6 +338,7 @@ BatchResourceBase::GetBatcherQueueOptions(
   batcher_queue_options.batch_timeout_micros = batch_timeout_micros;
   batcher_queue_options.enable_large_batch_splitting =
       enable_large_batch_splitting;
+  batcher_queue_options.allowed_batch_sizes = allowed_batch_sizes;
   if (enable_large_batch_splitting) {
     batcher_queue_options.split_input_task_func =
         [](std::unique_ptr<BatchTask>* input_task,
@@ -435,6 +450,16 @@ Status BatchResourceBase::ConcatInputTensors(
 
   // Process each input one at a time (the typical case has just one).
   for (int i = 0; i < num_inputs; ++i) {
+    if (IsRaggedInput(i)) {
+      Tensor values;
+      Tensor row_splits;
+      TF_RETURN_IF_ERROR(ConcatRaggedInputTensors(
+          batch, i, padding_amount, context, &values, &row_splits));
+      concatenated_tensors->push_back(values);
+      concatenated_tensors->push_back(row_splits);
+      continue;
+    }
+
     // Concatenate the tasks ith input tensors into a big output tensor.
     std::vector<Tensor> to_concatenate;
     to_concatenate.reserve(batch.num_tasks());
@@ -472,6 +497,54 @@ Status BatchResourceBase::ConcatInputTensors(
   return Status::OK();
 }
 
+bool BatchResourceBase::IsRaggedInput(int input_index) const {
+  const std::vector<int32>& indices = ragged_batching_options_.input_indices;
+  return std::find(indices.begin(), indices.end(), input_index) !=
+         indices.end();
+}
+
+/*static*/ Status BatchResourceBase::ConcatRaggedInputTensors(
+    const BatchT& batch, int input_index, int padding_amount,
+    OpKernelContext* context, Tensor* values, Tensor* row_splits) {
+  const int num_rows = batch.size() + padding_amount;
+  AllocatorAttributes cpu_alloc;
+  cpu_alloc.set_on_host(true);
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DT_INT64, TensorShape({num_rows + 1}), row_splits, cpu_alloc));
+  auto row_splits_flat = row_splits->vec<int64_t>();
+  int row = 0;
+  int64_t offset = 0;
+  row_splits_flat(0) = 0;
+
+  std::vector<Tensor> to_concatenate;
+  to_concatenate.reserve(batch.num_tasks());
+  for (int task_idx = 0; task_idx < batch.num_tasks(); ++task_idx) {
+    // Every row of a task is as long as its 1st dimension.
+    const Tensor& input = batch.task(task_idx).inputs.at(input_index);
+    const int64_t num_task_rows = input.dim_size(0);
+    const int64_t row_length = input.dim_size(1);
+    TensorShape values_shape = input.shape();
+    values_shape.RemoveDim(1);
+    values_shape.set_dim(0, num_task_rows * row_length);
+    Tensor task_values;
+    if (!task_values.CopyFrom(input, values_shape)) {
+      return errors::Internal("Failed to reshape ragged input ", input_index,
+                              " from ", input.shape().DebugString(), " to ",
+                              values_shape.DebugString());
+    }
+    to_concatenate.push_back(std::move(task_values));
+    for (int64_t j = 0; j < num_task_rows; ++j) {
+      offset += row_length;
+      row_splits_flat(++row) = offset;
+    }
+  }
+  // The padding rows are empty.
+  for (int j = 0; j < padding_amount; ++j) {
+    row_splits_flat(++row) = offset;
+  }
+  return Concat(context, to_concatenate, values);
+}
+
 /*static*/ Status BatchResourceBase::SplitInputTask(
     std::unique_ptr<BatchTask>* input_task_ptr, int open_batch_remaining_slot,
     int max_batch_size, std::vector<std::unique_ptr<BatchTask>>* output_tasks) {
@@ -602,27 +675,33 @@ Status BatchResourceBase::SplitOutputTensors(
       return errors::FailedPrecondition(
           "Batched output tensor has 0 dimensions");
     }
-    if (output_tensor.shape().dim_size(0) !=
-        static_cast<int64_t>(batch->size() + padding_size)) {
-      return errors::FailedPrecondition(
-          "Batched output tensor's 0th dimension does not equal the sum of "
-          "the 0th dimension sizes of the input tensors");
-    }
 
     std::vector<Tensor> split_tensor;
-    const Status split_status = tensor::Split(
-        output_tensor, task_sizes_plus_optional_padding, &split_tensor);
-    DCHECK(split_status.ok()) << split_status.ToString();
-    if (!split_status.ok()) {
-      return errors::Internal("Tensor split operation failed: ",
-                              split_status.error_message());
-    }
-    DCHECK_EQ(split_tensor.size(), task_sizes_plus_optional_padding.size());
-    if (split_tensor.size() != task_sizes_plus_optional_padding.size()) {
-      return errors::Internal(
-          "Tensor split operation did not work as expected; got ",
-          split_tensor.size(), " splits; expected ",
-          task_sizes_plus_optional_padding.size());
+    if (IsRaggedOutput(i)) {
+      TF_RETURN_IF_ERROR(
+          SplitRaggedOutputTensor(*batch, output_tensor, &split_tensor));
+    } else {
+      if (output_tensor.shape().dim_size(0) !=
+          static_cast<int64_t>(batch->size() + padding_size)) {
+        return errors::FailedPrecondition(
+            "Batched output tensor's 0th dimension does not equal the sum of "
+            "the 0th dimension sizes of the input tensors");
+      }
+
+      const Status split_status = tensor::Split(
+          output_tensor, task_sizes_plus_optional_padding, &split_tensor);
+      DCHECK(split_status.ok()) << split_status.ToString();
+      if (!split_status.ok()) {
+        return errors::Internal("Tensor split operation failed: ",
+                                split_status.error_message());
+      }
+      DCHECK_EQ(split_tensor.size(), task_sizes_plus_optional_padding.size());
+      if (split_tensor.size() != task_sizes_plus_optional_padding.size()) {
+        return errors::Internal(
+            "Tensor split operation did not work as expected; got ",
+            split_tensor.size(), " splits; expected ",
+            task_sizes_plus_optional_padding.size());
+      }
     }
 
     // Ignore a possible final split_tensors entry containing the padding.
@@ -640,7 +719,52 @@ Status BatchResourceBase::SplitOutputTensors(
   return Status::OK();
 }
 
+bool BatchResourceBase::IsRaggedOutput(int output_index) const {
+  const std::vector<int32>& indices = ragged_batching_options_.output_indices;
+  return std::find(indices.begin(), indices.end(), output_index) !=
+         indices.end();
+}
+
+Status BatchResourceBase::SplitRaggedOutputTensor(
+    const BatchT& batch, const Tensor& output_tensor,
+    std::vector<Tensor>* split_tensors) const {
+  // The rows are those of the first ragged input.
+  const int input_index = ragged_batching_options_.input_indices.at(0);
+  std::vector<int64_t> task_lengths;
+  task_lengths.reserve(batch.num_tasks());
+  int64_t total_length = 0;
+  for (int i = 0; i < batch.num_tasks(); ++i) {
+    const Tensor& input = batch.task(i).inputs.at(input_index);
+    task_lengths.push_back(input.dim_size(0) * input.dim_size(1));
+    total_length += task_lengths.back();
+  }
+  if (output_tensor.shape().dim_size(0) != total_length) {
+    return errors::FailedPrecondition(
+        "Ragged batched output tensor's 0th dimension does not equal the "
+        "total length of the rows of the ragged input tensors");
+  }
+
+  std::vector<Tensor> task_values;
+  TF_RETURN_IF_ERROR(tensor::Split(output_tensor, task_lengths, &task_values));
+  split_tensors->reserve(batch.num_tasks());
+  for (int i = 0; i < batch.num_tasks(); ++i) {
+    const Tensor& input = batch.task(i).inputs.at(input_index);
+    TensorShape task_shape = task_values[i].shape();
+    task_shape.set_dim(0, input.dim_size(1));
+    task_shape.InsertDim(0, input.dim_size(0));
+    Tensor split_tensor;
+    if (!split_tensor.CopyFrom(task_values[i], task_shape)) {
+      return errors::Internal("Failed to reshape ragged output from ",
+                              task_values[i].shape().DebugString(), " to ",
+                              task_shape.DebugString());
+    }
+    split_tensors->push_back(std::move(split_tensor));
+  }
+  return Status::OK();
+}
+
 void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
+  DropExpiredTasks(absl::Now(), &batch);
   if (batch->empty()) {
     return;
   }
@@ -743,6 +867,7 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
 
 // Processes a batch of one or more BatchTask entries.
 void BatchResourceBase::ProcessBatch(std::unique_ptr<BatchT> batch) const {
+  DropExpiredTasks(absl::Now(), &batch);
   if (batch->empty()) {
     return;
   }
@@ -845,6 +970,39 @@ void BatchResourceBase::ProcessBatch(std::unique_ptr<BatchT> batch) const {
   return Status::OK();
 }
 
+/*static*/ void BatchResourceBase::DropExpiredTasks(
+    absl::Time now, std::unique_ptr<BatchT>* batch) {
+  auto expired = [now](const BatchTask& task) {
+    return task.deadline.has_value() && *task.deadline <= now;
+  };
+  bool has_expired_tasks = false;
+  for (int i = 0; i < (*batch)->num_tasks(); ++i) {
+    has_expired_tasks |= expired((*batch)->task(i));
+  }
+  if (!has_expired_tasks) {
+    return;
+  }
+
+  auto live_batch = absl::make_unique<BatchT>((*batch)->traceme_context_id());
+  for (std::unique_ptr<BatchTask>& task : (*batch)->RemoveAllTasks()) {
+    if (!expired(*task)) {
+      live_batch->AddTask(std::move(task));
+      continue;
+    }
+    const Status status = errors::DeadlineExceeded(
+        "The deadline of the request passed before its batch was processed");
+    WithContext wc(task->propagated_context);
+    if (task->is_partial) {
+      task->status->Update(status);
+    } else {
+      task->context->SetStatus(status);
+    }
+    task->done_callback();
+  }
+  live_batch->Close();
+  *batch = std::move(live_batch);
+}
+
 // Looks up the batcher queue for 'queue_name'. If it did't previously exist,
 // creates it.
 Status BatchResourceBase::LookupOrCreateBatcherQueue(const string& queue_name,
@@ -19,6 +19,8 @@ limitations under the License.
 #include <map>
 
 #include "absl/strings/str_join.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/cost_measurement_registry.h"
 #include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -93,8 +95,17 @@ class BatchResourceBase : public ResourceBase {
 
     uint64 start_time;
 
+    // The deadline of the request that this task belongs to. The task is
+    // dropped if it passes before the task's batch is processed.
+    absl::optional<absl::Time> deadline;
+
+    // Whether the request that this task belongs to is low-priority work.
+    bool low_priority = false;
+
     size_t size() const override { return inputs[0].shape().dim_size(0); }
 
+    bool is_low_priority() const override { return low_priority; }
+
     // Create a split task from this one. The caller needs to setup the inputs
     // of the new task
     std::unique_ptr<BatchTask> CreateSplitTask(
@@ -126,25 +137,46 @@ class BatchResourceBase : public ResourceBase {
   using BatcherQueueT = BatchScheduler<BatchResourceBase::BatchTask>;
   using BatchT = Batch<BatchResourceBase::BatchTask>;
 
+  // Describes the inputs and outputs of the batch function that are batched
+  // without padding them to a common length.
+  struct RaggedBatchingOptions {
+    // The indices of the inputs that may differ in their 1st dimension
+    // between tasks. Each of them is passed to the batch function as two
+    // arguments: the rows of the batch concatenated along the 0th dimension,
+    // i.e. as a tensor of shape [total_length, ...], followed by the int64
+    // row splits of the batch, in the layout of a RaggedTensor.
+    std::vector<int32> input_indices;
+
+    // The indices of the outputs of the batch function that hold a value for
+    // each row element of the first ragged input, i.e. whose 0th dimension is
+    // `total_length`. They are split back into tasks according to the length
+    // of their rows.
+    std::vector<int32> output_indices;
+  };
+
   BatchResourceBase(bool has_process_batch_function,
                     std::shared_ptr<BatcherT> batcher,
                     const BatcherT::QueueOptions& batcher_queue_options,
-                    std::vector<int32> allowed_batch_sizes)
+                    std::vector<int32> allowed_batch_sizes,
+                    RaggedBatchingOptions ragged_batching_options = {})
       : has_process_batch_function_(has_process_batch_function),
         batcher_(std::move(batcher)),
         batcher_queue_options_(batcher_queue_options),
-        allowed_batch_sizes_(std::move(allowed_batch_sizes)) {
+        allowed_batch_sizes_(std::move(allowed_batch_sizes)),
+        ragged_batching_options_(std::move(ragged_batching_options)) {
     allowed_batch_sizes_str_ = absl::StrJoin(allowed_batch_sizes_, ",");
   }
 
   BatchResourceBase(bool has_process_batch_function,
                     std::shared_ptr<AdaptiveBatcherT> batcher,
                     const AdaptiveBatcherT::QueueOptions& batcher_queue_options,
-                    std::vector<int32> allowed_batch_sizes)
+                    std::vector<int32> allowed_batch_sizes,
+                    RaggedBatchingOptions ragged_batching_options = {})
       : has_process_batch_function_(has_process_batch_function),
         adaptive_batcher_(std::move(batcher)),
         adaptive_batcher_queue_options_(batcher_queue_options),
-        allowed_batch_sizes_(std::move(allowed_batch_sizes)) {}
+        allowed_batch_sizes_(std::move(allowed_batch_sizes)),
+        ragged_batching_options_(std::move(ragged_batching_options)) {}
 
   static BatcherT::QueueOptions GetBatcherQueueOptions(
       int32_t num_batch_threads, int32_t max_batch_size,
@@ -196,6 +228,10 @@ class BatchResourceBase : public ResourceBase {
       std::vector<std::unique_ptr<CostMeasurement>>& batch_cost_measurements,
       const int64_t processed_size, BatchT& batch);
 
+  // Removes the tasks whose deadline is at or before `now` from the closed
+  // `batch`, and finishes them with a DEADLINE_EXCEEDED error.
+  static void DropExpiredTasks(absl::Time now, std::unique_ptr<BatchT>* batch);
+
  private:
   // Implementation of calling the process batch function.
   virtual void ProcessFuncBatchImpl(
@@ -220,9 +256,30 @@ class BatchResourceBase : public ResourceBase {
   Status ConcatInputTensors(const BatchT& batch, OpKernelContext* context,
                             std::vector<Tensor>* concatenated_tensors) const;
 
+  // Returns true if input 'input_index' is ragged, see RaggedBatchingOptions.
+  bool IsRaggedInput(int input_index) const;
+
+  // Concatenates the rows of ragged input 'input_index' of the tasks in
+  // 'batch', and computes their row splits, with 'padding_amount' empty rows
+  // at the end.
+  static Status ConcatRaggedInputTensors(const BatchT& batch, int input_index,
+                                         int padding_amount,
+                                         OpKernelContext* context,
+                                         Tensor* values, Tensor* row_splits);
+
   Status SplitOutputTensors(const std::vector<Tensor>& combined_outputs,
                             BatchT* batch) const;
 
+  // Returns true if output 'output_index' is ragged, see
+  // RaggedBatchingOptions.
+  bool IsRaggedOutput(int output_index) const;
+
+  // Splits ragged 'output_tensor' into one tensor of shape [rows, length, ...]
+  // for each task in 'batch'.
+  Status SplitRaggedOutputTensor(const BatchT& batch,
+                                 const Tensor& output_tensor,
+                                 std::vector<Tensor>* split_tensors) const;
+
   void ProcessFuncBatch(std::unique_ptr<BatchT> batch) const;
 
   // Processes a batch of one or more BatchTask entries.
@@ -264,6 +321,8 @@ class BatchResourceBase : public ResourceBase {
   // A concatenated string of <allowed_batch_sizes_>, separated by ",". This is
   // used to record batching parameter.
   string allowed_batch_sizes_str_;
+
+  const RaggedBatchingOptions ragged_batching_options_;
 };
 
 }  // namespace serving
@@ -16,9 +16,13 @@ limitations under the License.
 #include "tensorflow/core/kernels/batching_util/batch_resource_base.h"
 
 #include "absl/time/time.h"
+#include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/cost_measurement.h"
 #include "tensorflow/core/common_runtime/cost_measurement_registry.h"
 #include "tensorflow/core/common_runtime/no_op_cost_measurement.h"
+#include "tensorflow/core/kernels/batching_util/threadsafe_status.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -164,6 +168,57 @@ TEST(SplitBatchCostTest, SplitMultiCostTypes) {
                            Pair("test_gcu_no_smear", absl::Milliseconds(90))));
 }
 
+// Makes a split task that counts its completions in `num_done`.
+std::unique_ptr<BatchResourceBase::BatchTask> MakeTaskWithDeadline(
+    const int64_t task_size, absl::optional<absl::Time> deadline,
+    std::shared_ptr<ThreadSafeStatus> status, int* num_done) {
+  auto task = MakeBatchTask(task_size, /*request_cost=*/nullptr);
+  task->is_partial = true;
+  task->deadline = deadline;
+  task->status = std::move(status);
+  task->done_callback = [num_done] { ++*num_done; };
+  return task;
+}
+
+TEST(DropExpiredTasksTest, KeepsBatchWithoutExpiredTasks) {
+  const absl::Time now = absl::Now();
+  auto status = std::make_shared<ThreadSafeStatus>();
+  int num_done = 0;
+  auto batch = absl::make_unique<BatchResourceBase::BatchT>();
+  batch->AddTask(MakeTaskWithDeadline(1, absl::nullopt, status, &num_done));
+  batch->AddTask(
+      MakeTaskWithDeadline(2, now + absl::Seconds(1), status, &num_done));
+  batch->Close();
+  const BatchResourceBase::BatchT* original_batch = batch.get();
+
+  BatchResourceBase::DropExpiredTasks(now, &batch);
+  EXPECT_EQ(original_batch, batch.get());
+  EXPECT_EQ(2, batch->num_tasks());
+  EXPECT_EQ(0, num_done);
+  TF_EXPECT_OK(status->status());
+}
+
+TEST(DropExpiredTasksTest, FinishesExpiredTasks) {
+  const absl::Time now = absl::Now();
+  auto status = std::make_shared<ThreadSafeStatus>();
+  int num_done = 0;
+  auto batch = absl::make_unique<BatchResourceBase::BatchT>();
+  batch->AddTask(MakeTaskWithDeadline(1, absl::nullopt, status, &num_done));
+  batch->AddTask(MakeTaskWithDeadline(2, now, status, &num_done));
+  batch->AddTask(
+      MakeTaskWithDeadline(3, now + absl::Seconds(1), status, &num_done));
+  batch->Close();
+
+  BatchResourceBase::DropExpiredTasks(now, &batch);
+  ASSERT_EQ(2, batch->num_tasks());
+  EXPECT_TRUE(batch->IsClosed());
+  EXPECT_EQ(1, batch->task(0).size());
+  EXPECT_EQ(3, batch->task(1).size());
+  EXPECT_EQ(4, batch->size());
+  EXPECT_EQ(1, num_done);
+  EXPECT_TRUE(errors::IsDeadlineExceeded(status->status()));
+}
+
 }  // namespace
 }  // namespace serving
 }  // namespace tensorflow
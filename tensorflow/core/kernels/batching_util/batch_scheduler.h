@@ -64,6 +64,11 @@ class BatchTask {
   // Returns the size of the task, in terms of how much it contributes to the
   // size of a batch. (A batch's size is the sum of its task sizes.)
   virtual size_t size() const = 0;
+
+  // Returns true if the task is to be batched as low-priority work, which
+  // queues that support it only process once they have no high-priority
+  // work waiting, or in the padding of high-priority batches.
+  virtual bool is_low_priority() const { return false; }
 };
 
 // A thread-safe collection of BatchTasks, to be executed together in some
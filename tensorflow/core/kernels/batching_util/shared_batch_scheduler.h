@@ -18,6 +18,8 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
+#include <cmath>
 #include <deque>
 #include <functional>
 #include <list>
@@ -100,6 +102,14 @@ namespace serving {
 // For bulk processing jobs and throughput-oriented benchmarks, you may want to
 // set the maximum queue size to a large value.
 //
+// Tasks for which BatchTask::is_low_priority() is true are kept apart from the
+// others, in a low-priority lane of their queue, and do not delay them: the
+// lane only forms batches of its own while no other task is enqueued, or once
+// the queue is closed. Until then, its tasks are added to the other batches in
+// the slots that are left over after rounding these up to the next size in
+// `allowed_batch_sizes`, i.e. that would otherwise be padding. (Queues with
+// `enable_lazy_split` treat every task as a high-priority one.)
+//
 // TODO(b/26539183): Support queue servicing policies other than round-robin.
 // E.g. let each queue specify a "share" (an int >= 1), so e.g. with queues A
 // and B having shares 1 and 2 respectively, the servicing pattern is ABBABB...
@@ -218,6 +228,25 @@ class SharedBatchScheduler
     // submit batches whose size is in a small set of allowed sizes, that can be
     // done by adding padding in the process-batch callback.
     size_t max_execution_batch_size = 1000;
+
+    // If positive, the queue adapts the size and the age at which the open
+    // batch becomes schedulable to the observed load, aiming to keep the time
+    // from a task's arrival to the end of the processing of its batch under
+    // this target, in the tail.
+    //
+    // The queue tracks the rate at which tasks arrive and the processing
+    // latency of its batches for each batch size. The open batch is scheduled
+    // once it reaches the largest size that is expected to both fill up and be
+    // processed within the target, or once it has waited for what is left of
+    // the target after processing it. `batch_timeout_micros` remains an upper
+    // bound for that wait, so it should be set to the largest acceptable
+    // timeout.
+    int64_t target_latency_micros = 0;
+
+    // The sizes, in increasing order, that the process-batch callback pads
+    // batches up to, if any. Low-priority tasks are added to a batch as long
+    // as they fit within the next allowed size at scheduling time.
+    std::vector<int32> allowed_batch_sizes;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -279,6 +308,131 @@ class SharedBatchScheduler
 
 namespace internal {
 
+// Online estimates of the arrival rate of a queue's tasks and of the processing
+// latency of its batches, used to meet QueueOptions::target_latency_micros.
+// Not thread-safe.
+class LatencyTargetEstimator {
+ public:
+  LatencyTargetEstimator(int64_t target_latency_micros,
+                         int64_t max_batch_timeout_micros,
+                         size_t max_batch_size)
+      : target_latency_micros_(target_latency_micros),
+        max_batch_timeout_micros_(max_batch_timeout_micros),
+        max_batch_size_(max_batch_size),
+        latencies_(Bucket(max_batch_size) + 1) {}
+
+  // Records that a task of size `task_size` arrived at `now_micros`.
+  void RecordArrival(uint64 now_micros, size_t task_size) {
+    if (has_last_arrival_ && task_size > 0) {
+      const double gap =
+          now_micros > last_arrival_micros_
+              ? static_cast<double>(now_micros - last_arrival_micros_) /
+                    task_size
+              : 0;
+      if (has_arrival_rate_) {
+        micros_per_item_ += (gap - micros_per_item_) / 8;
+      } else {
+        micros_per_item_ = gap;
+        has_arrival_rate_ = true;
+      }
+    }
+    last_arrival_micros_ = now_micros;
+    has_last_arrival_ = true;
+  }
+
+  // Records that a batch of size `batch_size` took `latency_micros` to
+  // process. The mean and the mean deviation are smoothed as for the TCP
+  // retransmission timer (RFC 6298), so that their sum tracks the tail.
+  void RecordBatchLatency(size_t batch_size, int64_t latency_micros) {
+    LatencyStats& stats =
+        latencies_[Bucket(std::min(batch_size, max_batch_size_))];
+    const double latency = latency_micros;
+    if (!stats.valid) {
+      stats.mean = latency;
+      stats.deviation = latency / 2;
+      stats.valid = true;
+      return;
+    }
+    const double error = latency - stats.mean;
+    stats.mean += error / 8;
+    stats.deviation += (std::abs(error) - stats.deviation) / 4;
+  }
+
+  // Returns the estimated tail latency of processing a batch of size
+  // `batch_size`, or 0 if no batch has been processed yet. Sizes that have not
+  // been observed are extrapolated linearly from the nearest smaller observed
+  // size, which overestimates the latency of larger batches.
+  double EstimatedLatencyMicros(size_t batch_size) const {
+    const int bucket = Bucket(std::min(batch_size, max_batch_size_));
+    for (int i = bucket; i >= 0; --i) {
+      if (latencies_[i].valid) {
+        return latencies_[i].TailMicros() * (size_t{1} << (bucket - i));
+      }
+    }
+    for (int i = bucket + 1; i < static_cast<int>(latencies_.size()); ++i) {
+      if (latencies_[i].valid) return latencies_[i].TailMicros();
+    }
+    return 0;
+  }
+
+  // Returns the largest batch size that is expected to fill up at the current
+  // arrival rate and be processed within the target. Returns the maximum batch
+  // size until the arrival rate is known.
+  size_t BatchSizeLimit() const {
+    if (!has_arrival_rate_) return max_batch_size_;
+    size_t limit = 1;
+    for (size_t size = 1;; size = std::min(2 * size, max_batch_size_)) {
+      const double fill_micros = (size - 1) * micros_per_item_;
+      if (fill_micros + EstimatedLatencyMicros(size) <=
+          target_latency_micros_) {
+        limit = size;
+      }
+      if (size >= max_batch_size_) break;
+    }
+    return limit;
+  }
+
+  // Returns how long the open batch may wait for more tasks: what is left of
+  // the target after processing a batch of BatchSizeLimit(), at most the
+  // configured batch timeout.
+  int64_t BatchTimeoutMicros() const {
+    const double remaining_micros =
+        target_latency_micros_ - EstimatedLatencyMicros(BatchSizeLimit());
+    if (remaining_micros <= 0) return 0;
+    return std::min<int64_t>(static_cast<int64_t>(remaining_micros),
+                             max_batch_timeout_micros_);
+  }
+
+ private:
+  struct LatencyStats {
+    double TailMicros() const { return mean + 4 * deviation; }
+
+    bool valid = false;
+    double mean = 0;
+    double deviation = 0;
+  };
+
+  // Latencies are tracked per power-of-two bucket of batch sizes: bucket `i`
+  // holds the sizes in (2^(i-1), 2^i].
+  static int Bucket(size_t batch_size) {
+    int bucket = 0;
+    while ((size_t{1} << bucket) < batch_size) ++bucket;
+    return bucket;
+  }
+
+  const int64_t target_latency_micros_;
+  const int64_t max_batch_timeout_micros_;
+  const size_t max_batch_size_;
+
+  std::vector<LatencyStats> latencies_;
+
+  // Smoothed time between the arrival of two units of task size.
+  double micros_per_item_ = 0;
+  bool has_arrival_rate_ = false;
+  uint64 last_arrival_micros_ = 0;
+  bool has_last_arrival_ = false;
+};
+
 // A task queue for SharedBatchScheduler. Accepts tasks and accumulates them
 // into batches, and dispenses those batches to be processed via a "pull"
 // interface. The queue's behavior is governed by maximum batch size, timeout
@@ -328,6 +482,10 @@ class Queue {
   // dequeued (out of mutex-protected area).
   Status ScheduleWithLazySplit(std::unique_ptr<TaskType>* task);
 
+  // Enqueue low-priority `task` in the low-priority lane, split into tasks of
+  // at most `max_execution_batch_size()` if needed.
+  Status ScheduleLowPriority(std::unique_ptr<TaskType>* task);
+
   // Returns the number of enqueued tasks, with the same semantics as
   // BatchScheduler::NumEnqueuedTasks().
   size_t NumEnqueuedTasks() const;
@@ -421,6 +579,23 @@ class Queue {
   // Returns the number of enqueued batches.
   int64 num_enqueued_batches() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // The size and the age at which the open batch becomes schedulable.
+  size_t open_batch_size_limit() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  int64_t batch_timeout_micros() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Determines whether the low-priority lane should form a batch of its own,
+  // which requires that no high-priority task is enqueued.
+  bool IsLowPriorityBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Forms a closed batch from the tasks at the front of the low-priority lane.
+  std::unique_ptr<Batch<TaskType>> ScheduleLowPriorityBatch()
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Adds the tasks at the front of the low-priority lane to the closed
+  // `batch`, as long as they fit within the next allowed batch size.
+  void PadWithLowPriorityTasks(std::unique_ptr<Batch<TaskType>>* batch)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const typename SharedBatchScheduler<TaskType>::QueueOptions options_;
 
   // The environment to use.
@@ -462,6 +637,16 @@ class Queue {
   std::deque<std::unique_ptr<Batch<BatchInputTaskHandle<TaskType>>>>
       task_handle_batches_ TF_GUARDED_BY(mu_);
 
+  // The enqueued low-priority tasks, in arrival order, along with the time at
+  // which they were enqueued. Each task fits in a batch.
+  //
+  // Used iff `QueueOptions.enable_lazy_split` is false.
+  std::deque<std::pair<uint64, std::unique_ptr<TaskType>>> low_priority_tasks_
+      TF_GUARDED_BY(mu_);
+
+  // The sum of the sizes of the tasks in `low_priority_tasks_`.
+  size_t low_priority_tasks_size_ TF_GUARDED_BY(mu_) = 0;
+
   // The counter of the TraceMe context ids.
   uint64 traceme_context_id_counter_ TF_GUARDED_BY(mu_) = 0;
 
@@ -477,6 +662,10 @@ class Queue {
   // Incremented in ScheduleBatch() and decremented in ProcessBatch().
   int num_batches_being_processed_ TF_GUARDED_BY(mu_) = 0;
 
+  // Set iff `options_.target_latency_micros` is positive.
+  std::unique_ptr<LatencyTargetEstimator> latency_target_estimator_
+      TF_GUARDED_BY(mu_);
+
   // Used by CloseAndWaitUntilEmpty() to wait until the queue is empty, for
   // the case in which the queue is not empty when CloseAndWaitUntilEmpty()
   // starts. When ProcessBatch() dequeues the last batch and makes the queue
@@ -588,6 +777,11 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         "max_enqueued_batches must be positive; was ",
         options.max_enqueued_batches);
   }
+  if (options.target_latency_micros < 0) {
+    return errors::InvalidArgument(
+        "target_latency_micros must be non-negative; was ",
+        options.target_latency_micros);
+  }
 
   if (options.enable_large_batch_splitting &&
       options.split_input_task_func == nullptr) {
@@ -768,6 +962,11 @@ Queue<TaskType>::Queue(
   // time of the queue. This prevents the batches in different queues to have
   // the same traceme_context_id_counter_.
   traceme_context_id_counter_ = absl::GetCurrentTimeNanos() << 32;
+  if (options_.target_latency_micros > 0) {
+    latency_target_estimator_ = std::make_unique<LatencyTargetEstimator>(
+        options_.target_latency_micros, options_.batch_timeout_micros,
+        max_execution_batch_size_);
+  }
   // Create an initial, open batch.
   if (options_.enable_lazy_split) {
     task_handle_batches_.emplace_back(
@@ -800,6 +999,9 @@ Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
   if (options_.enable_lazy_split) {
     return ScheduleWithLazySplit(std::move(task));
   }
+  if ((*task)->is_low_priority()) {
+    return ScheduleLowPriority(std::move(task));
+  }
   return ScheduleWithoutOrEagerSplit(std::move(task));
 }
 
@@ -824,6 +1026,10 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
           "The batch scheduling queue to which this task was submitted is "
           "full");
     }
+    if (latency_target_estimator_ != nullptr) {
+      latency_target_estimator_->RecordArrival(env_->NowMicros(),
+                                               (*task)->size());
+    }
     const int64 open_batch_capacity =
         max_execution_batch_size - this->tail_batch_task_size();
 
@@ -903,6 +1109,10 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
         max_execution_batch_size() - batches_.back()->size();
 
     const int64_t input_task_size = (*task)->size();
+    if (latency_target_estimator_ != nullptr) {
+      latency_target_estimator_->RecordArrival(env_->NowMicros(),
+                                               input_task_size);
+    }
 
     std::vector<std::unique_ptr<TaskType>> output_tasks;
 
@@ -947,6 +1157,55 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
   return Status::OK();
 }
 
+template <typename TaskType>
+Status Queue<TaskType>::ScheduleLowPriority(std::unique_ptr<TaskType>* task) {
+  profiler::TraceMe trace_me([task] {
+    return profiler::TraceMeEncode(
+        "ScheduleLowPriority", {{"batching_input_task_size", (*task)->size()}});
+  });
+
+  bool notify_of_schedulable_batch = false;
+  {
+    mutex_lock l(mu_);
+
+    DCHECK(!closed_);
+
+    if (low_priority_tasks_size_ + (*task)->size() >
+        options_.max_enqueued_batches * max_execution_batch_size()) {
+      return errors::Unavailable(
+          "The low-priority lane of the batch scheduling queue to which this "
+          "task was submitted is full");
+    }
+
+    // Tasks larger than a batch are only accepted with large batch splitting.
+    std::vector<std::unique_ptr<TaskType>> output_tasks;
+    if ((*task)->size() <= max_execution_batch_size()) {
+      output_tasks.push_back(std::move(*task));
+    } else {
+      TF_RETURN_IF_ERROR(options_.split_input_task_func(
+          task, max_execution_batch_size(), max_execution_batch_size(),
+          &output_tasks));
+    }
+
+    const uint64 now_micros = env_->NowMicros();
+    for (auto& output_task : output_tasks) {
+      low_priority_tasks_size_ += output_task->size();
+      low_priority_tasks_.emplace_back(now_micros, std::move(output_task));
+    }
+
+    if (!schedulable_batch_ && IsLowPriorityBatchSchedulable()) {
+      schedulable_batch_ = true;
+      notify_of_schedulable_batch = true;
+    }
+  }
+
+  if (notify_of_schedulable_batch) {
+    schedulable_batch_callback_();
+  }
+
+  return Status::OK();
+}
+
 template <typename TaskType>
 size_t Queue<TaskType>::NumEnqueuedTasks() const {
   size_t num_enqueued_tasks = 0;
@@ -961,7 +1220,7 @@ size_t Queue<TaskType>::NumEnqueuedTasks() const {
   for (const auto& batch : batches_) {
     num_enqueued_tasks += batch->num_tasks();
   }
-  return num_enqueued_tasks;
+  return num_enqueued_tasks + low_priority_tasks_.size();
 }
 
 template <typename TaskType>
@@ -1031,6 +1290,10 @@ Queue<TaskType>::ScheduleBatchWithEagerSplit() {
       ++num_batches_being_processed_;
       batch_to_schedule = std::move(batches_.front());
       batches_.pop_front();
+      PadWithLowPriorityTasks(&batch_to_schedule);
+    } else if (IsLowPriorityBatchSchedulable()) {
+      ++num_batches_being_processed_;
+      batch_to_schedule = ScheduleLowPriorityBatch();
     } else {
       schedulable_batch_ = false;
     }
@@ -1081,10 +1344,16 @@ void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
       },
       profiler::ContextType::kSharedBatchScheduler,
       batch->traceme_context_id());
+  const size_t batch_size = batch->size();
+  const uint64 start_time_micros = env_->NowMicros();
   process_batch_callback_(std::move(batch));
 
   {
     mutex_lock l(mu_);
+    if (latency_target_estimator_ != nullptr) {
+      latency_target_estimator_->RecordBatchLatency(
+          batch_size, env_->NowMicros() - start_time_micros);
+    }
     --num_batches_being_processed_;
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
@@ -1122,7 +1391,7 @@ bool Queue<TaskType>::IsEmptyInternal() const {
            task_handle_batches_.back()->empty();
   }
   return num_batches_being_processed_ == 0 && batches_.size() == 1 &&
-         batches_.back()->empty();
+         batches_.back()->empty() && low_priority_tasks_.empty();
 }
 
 template <typename TaskType>
@@ -1154,9 +1423,9 @@ bool Queue<TaskType>::IsOpenBatchSchedulableAfterEagerSplit() const {
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= max_execution_batch_size() ||
+  return closed_ || open_batch->size() >= open_batch_size_limit() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + batch_timeout_micros();
 }
 
 template <typename TaskType>
@@ -1169,9 +1438,9 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= max_execution_batch_size() ||
+  return closed_ || open_batch->size() >= open_batch_size_limit() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + batch_timeout_micros();
 }
 
 template <typename TaskType>
@@ -1191,6 +1460,89 @@ int64 Queue<TaskType>::num_enqueued_batches() const {
   return batches_.size();
 }
 
+template <typename TaskType>
+size_t Queue<TaskType>::open_batch_size_limit() const {
+  if (latency_target_estimator_ == nullptr) return max_execution_batch_size();
+  return std::min(max_execution_batch_size(),
+                  latency_target_estimator_->BatchSizeLimit());
+}
+
+template <typename TaskType>
+int64_t Queue<TaskType>::batch_timeout_micros() const {
+  if (latency_target_estimator_ == nullptr) {
+    return options_.batch_timeout_micros;
+  }
+  return latency_target_estimator_->BatchTimeoutMicros();
+}
+
+template <typename TaskType>
+bool Queue<TaskType>::IsLowPriorityBatchSchedulable() const {
+  if (low_priority_tasks_.empty()) {
+    return false;
+  }
+  if (closed_) {
+    return true;
+  }
+  if (batches_.size() > 1 || !batches_.back()->empty()) {
+    return false;
+  }
+  return low_priority_tasks_size_ >= max_execution_batch_size() ||
+         env_->NowMicros() >= low_priority_tasks_.front().first +
+                                  options_.batch_timeout_micros;
+}
+
+template <typename TaskType>
+std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleLowPriorityBatch() {
+  auto batch =
+      std::make_unique<Batch<TaskType>>(++traceme_context_id_counter_);
+  while (!low_priority_tasks_.empty() &&
+         batch->size() + low_priority_tasks_.front().second->size() <=
+             max_execution_batch_size()) {
+    low_priority_tasks_size_ -= low_priority_tasks_.front().second->size();
+    batch->AddTask(std::move(low_priority_tasks_.front().second));
+    low_priority_tasks_.pop_front();
+  }
+  batch->Close();
+  return batch;
+}
+
+template <typename TaskType>
+void Queue<TaskType>::PadWithLowPriorityTasks(
+    std::unique_ptr<Batch<TaskType>>* batch) {
+  if (low_priority_tasks_.empty()) {
+    return;
+  }
+  const size_t batch_size = (*batch)->size();
+  size_t padded_batch_size = batch_size;
+  for (int32 allowed_batch_size : options_.allowed_batch_sizes) {
+    if (static_cast<size_t>(allowed_batch_size) >= batch_size) {
+      padded_batch_size =
+          std::min<size_t>(allowed_batch_size, max_execution_batch_size());
+      break;
+    }
+  }
+  if (batch_size + low_priority_tasks_.front().second->size() >
+      padded_batch_size) {
+    return;
+  }
+
+  // Tasks can't be added to a closed batch, so move them to a new one.
+  auto padded_batch =
+      std::make_unique<Batch<TaskType>>((*batch)->traceme_context_id());
+  for (auto& task : (*batch)->RemoveAllTasks()) {
+    padded_batch->AddTask(std::move(task));
+  }
+  while (!low_priority_tasks_.empty() &&
+         padded_batch->size() + low_priority_tasks_.front().second->size() <=
+             padded_batch_size) {
+    low_priority_tasks_size_ -= low_priority_tasks_.front().second->size();
+    padded_batch->AddTask(std::move(low_priority_tasks_.front().second));
+    low_priority_tasks_.pop_front();
+  }
+  padded_batch->Close();
+  *batch = std::move(padded_batch);
+}
+
 template <typename TaskType>
 QueueHandle<TaskType>::QueueHandle(
     std::shared_ptr<SharedBatchScheduler<TaskType>> scheduler,
@@ -42,14 +42,18 @@ namespace {
 
 class FakeTask : public BatchTask {
  public:
-  explicit FakeTask(size_t size) : size_(size) {}
+  explicit FakeTask(size_t size, bool is_low_priority = false)
+      : size_(size), is_low_priority_(is_low_priority) {}
 
   ~FakeTask() override = default;
 
   size_t size() const override { return size_; }
 
+  bool is_low_priority() const override { return is_low_priority_; }
+
  private:
   const size_t size_;
+  const bool is_low_priority_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(FakeTask);
 };
@@ -64,8 +68,9 @@ using SplitFunc =
 
 // Creates a FakeTask of size 'task_size', and calls 'scheduler->Schedule()' on
 // that task. Returns the resulting status.
-Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler) {
-  std::unique_ptr<FakeTask> task(new FakeTask(task_size));
+Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler,
+                    bool is_low_priority = false) {
+  std::unique_ptr<FakeTask> task(new FakeTask(task_size, is_low_priority));
   Status status = scheduler->Schedule(&task);
   // Schedule() should have consumed 'task' iff it returned Status::OK.
   CHECK_EQ(status.ok(), task == nullptr);
@@ -793,6 +798,109 @@ TEST_P(SharedBatchSchedulerTest, ZeroQueueRewrittenToOneQueue) {
 
 // TODO(b/161857471):
 // Add test coverage when input-split and no-split returns differently.
+TEST_P(SharedBatchSchedulerTest, InvalidTargetLatency) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {
+    // do nothing.
+  };
+
+  auto scheduler = CreateSharedBatchScheduler(2);
+
+  QueueOptions options = CreateQueueOptions(10, 10, 100, 2);
+  options.target_latency_micros = -1;
+  std::unique_ptr<Queue> queue;
+  EXPECT_THAT(scheduler->AddQueue(options, callback, &queue),
+              testing::StatusIs(
+                  error::INVALID_ARGUMENT,
+                  "target_latency_micros must be non-negative; was -1"));
+}
+
+// Tests that low-priority tasks only fill the padding of the high-priority
+// batches, and form batches of their own once no other task is enqueued.
+TEST(SharedBatchSchedulerPriorityTest, LowPriorityTasksFillPadding) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  mutex mu;
+  // The size and priority of the tasks of each batch.
+  std::vector<std::vector<std::pair<int, bool>>> callback_data;
+  Notification all_batches_processed;
+  auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+    ASSERT_TRUE(batch->IsClosed());
+    std::vector<std::pair<int, bool>> batch_data;
+    for (int i = 0; i < batch->num_tasks(); ++i) {
+      batch_data.emplace_back(batch->task(i).size(),
+                              batch->task(i).is_low_priority());
+    }
+    mutex_lock l(mu);
+    callback_data.push_back(batch_data);
+    if (callback_data.size() == 2) {
+      all_batches_processed.Notify();
+    }
+  };
+
+  {
+    auto scheduler = CreateSharedBatchScheduler(/*num_batch_threads=*/1, &env);
+    QueueOptions options = CreateQueueOptions(
+        /*max_execution_batch_size=*/8, /*input_batch_size_limit=*/8,
+        /*batch_timeout_micros=*/10, /*max_enqueued_batches=*/2,
+        /*enable_large_batch_splitting=*/false, /*enable_lazy_split=*/false,
+        /*split_func=*/nullptr);
+    options.allowed_batch_sizes = {4, 8};
+    auto queue = CreateQueue(scheduler, options, callback);
+
+    TF_ASSERT_OK(ScheduleTask(1, queue.get(), /*is_low_priority=*/true));
+    TF_ASSERT_OK(ScheduleTask(1, queue.get(), /*is_low_priority=*/true));
+    TF_ASSERT_OK(ScheduleTask(2, queue.get(), /*is_low_priority=*/true));
+    TF_ASSERT_OK(ScheduleTask(3, queue.get()));
+    EXPECT_EQ(4, queue->NumEnqueuedTasks());
+
+    // The high-priority batch is padded up to 4 with the first low-priority
+    // task, and the other two form a batch of their own afterwards.
+    env.AdvanceByMicroseconds(10);
+    all_batches_processed.WaitForNotification();
+    EXPECT_THAT(callback_data,
+                ::testing::ElementsAre(
+                    ::testing::ElementsAre(std::make_pair(3, false),
+                                           std::make_pair(1, true)),
+                    ::testing::ElementsAre(std::make_pair(1, true),
+                                           std::make_pair(2, true))));
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST(SharedBatchSchedulerPriorityTest, LowPriorityLaneIsBounded) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {
+    // do nothing.
+  };
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+  {
+    auto scheduler = CreateSharedBatchScheduler(/*num_batch_threads=*/1, &env);
+    auto queue = CreateQueue(
+        scheduler,
+        CreateQueueOptions(
+            /*max_execution_batch_size=*/4, /*input_batch_size_limit=*/4,
+            /*batch_timeout_micros=*/10, /*max_enqueued_batches=*/2,
+            /*enable_large_batch_splitting=*/false,
+            /*enable_lazy_split=*/false, /*split_func=*/nullptr),
+        callback);
+
+    // Keep the lane from being scheduled by enqueuing a high-priority task.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(4, queue.get(), /*is_low_priority=*/true));
+    TF_ASSERT_OK(ScheduleTask(4, queue.get(), /*is_low_priority=*/true));
+    EXPECT_EQ(error::UNAVAILABLE,
+              ScheduleTask(1, queue.get(), /*is_low_priority=*/true).code());
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 INSTANTIATE_TEST_SUITE_P(
     Parameter, SharedBatchSchedulerTest,
     ::testing::Values(std::make_tuple(/*enable_input_batch_split=*/true,
@@ -802,6 +910,62 @@ INSTANTIATE_TEST_SUITE_P(
                       std::make_tuple(/*enable_input_batch_split=*/false,
                                       /*enable_lazy_split=*/false)));
 
+// Feeds `estimator` with tasks of size 1 arriving every `arrival_gap_micros`,
+// and with batches of size 8 that take 400 microseconds to process.
+void FeedLatencyTargetEstimator(int64_t arrival_gap_micros,
+                                internal::LatencyTargetEstimator* estimator) {
+  for (int i = 0; i < 40; ++i) {
+    estimator->RecordArrival(i * arrival_gap_micros, 1);
+    estimator->RecordBatchLatency(8, 400);
+  }
+}
+
+TEST(LatencyTargetEstimatorTest, NoObservations) {
+  internal::LatencyTargetEstimator estimator(
+      /*target_latency_micros=*/1000, /*max_batch_timeout_micros=*/500,
+      /*max_batch_size=*/32);
+  EXPECT_EQ(estimator.BatchSizeLimit(), 32);
+  EXPECT_EQ(estimator.BatchTimeoutMicros(), 500);
+  EXPECT_EQ(estimator.EstimatedLatencyMicros(8), 0);
+}
+
+TEST(LatencyTargetEstimatorTest, ExtrapolatesLatency) {
+  internal::LatencyTargetEstimator estimator(1000, 500, 32);
+  FeedLatencyTargetEstimator(10, &estimator);
+  // Smaller batches are bounded by the observed latency, larger ones are
+  // extrapolated linearly.
+  EXPECT_NEAR(estimator.EstimatedLatencyMicros(1), 400, 1);
+  EXPECT_NEAR(estimator.EstimatedLatencyMicros(5), 400, 1);
+  EXPECT_NEAR(estimator.EstimatedLatencyMicros(8), 400, 1);
+  EXPECT_NEAR(estimator.EstimatedLatencyMicros(16), 800, 1);
+  EXPECT_NEAR(estimator.EstimatedLatencyMicros(32), 1600, 1);
+}
+
+TEST(LatencyTargetEstimatorTest, FastArrivalsFillLargerBatches) {
+  internal::LatencyTargetEstimator estimator(1000, 500, 32);
+  FeedLatencyTargetEstimator(10, &estimator);
+  // 16 tasks arrive in 150us and are processed in 800us, within the target.
+  // 32 tasks would take 1600us to process.
+  EXPECT_EQ(estimator.BatchSizeLimit(), 16);
+  // What is left of the target after processing a batch of 16.
+  EXPECT_NEAR(estimator.BatchTimeoutMicros(), 200, 1);
+}
+
+TEST(LatencyTargetEstimatorTest, SlowArrivalsGiveSmallerBatches) {
+  internal::LatencyTargetEstimator estimator(1000, 500, 32);
+  FeedLatencyTargetEstimator(100, &estimator);
+  // 8 tasks take 700us to arrive, so only 4 fit in the target.
+  EXPECT_EQ(estimator.BatchSizeLimit(), 4);
+  EXPECT_NEAR(estimator.BatchTimeoutMicros(), 500, 1);
+}
+
+TEST(LatencyTargetEstimatorTest, TimeoutIsZeroWhenTargetIsMissed) {
+  internal::LatencyTargetEstimator estimator(300, 500, 32);
+  FeedLatencyTargetEstimator(10, &estimator);
+  EXPECT_EQ(estimator.BatchSizeLimit(), 1);
+  EXPECT_EQ(estimator.BatchTimeoutMicros(), 0);
+}
+
 #ifdef PLATFORM_GOOGLE
 // This benchmark relies on https://github.com/google/benchmark features,
 // (in particular, `Benchmark::ThreadRange`) not available in open-sourced TF
@@ -0,0 +1,220 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/top_n.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+// A continuation of a beam: token `index % vocab_size` appended to beam
+// `index / vocab_size`.
+struct Candidate {
+  float score;
+  int64_t index;
+};
+
+// Ranks higher scores first, and the lower index first among equal scores,
+// so that the selected beams do not depend on the order of the pushes.
+struct CandidateGreater {
+  bool operator()(const Candidate& a, const Candidate& b) const {
+    return a.score > b.score || (a.score == b.score && a.index < b.index);
+  }
+};
+
+// Copies the rows of `src` into `dst` so that row `j` of each batch entry is
+// its row `parents[j]`. `src` and `dst` may be the same buffer, in which case
+// only the rows whose parent is another row are written.
+void ReorderRows(const char* src, char* dst, int64_t row_bytes,
+                 int beam_width, const int32* parents) {
+  if (src != dst) {
+    for (int j = 0; j < beam_width; ++j) {
+      std::memcpy(dst + j * row_bytes, src + parents[j] * row_bytes,
+                  row_bytes);
+    }
+    return;
+  }
+  // In place, the rows that are overwritten but still read as the parent of
+  // another row are saved first.
+  std::vector<bool> saved(beam_width, false);
+  for (int j = 0; j < beam_width; ++j) {
+    const int p = parents[j];
+    if (p != j && parents[p] != p) saved[p] = true;
+  }
+  std::vector<int> scratch_row(beam_width, -1);
+  int num_saved = 0;
+  for (int p = 0; p < beam_width; ++p) {
+    if (saved[p]) scratch_row[p] = num_saved++;
+  }
+  std::vector<char> scratch(num_saved * row_bytes);
+  for (int p = 0; p < beam_width; ++p) {
+    if (saved[p]) {
+      std::memcpy(scratch.data() + scratch_row[p] * row_bytes,
+                  src + p * row_bytes, row_bytes);
+    }
+  }
+  for (int j = 0; j < beam_width; ++j) {
+    const int p = parents[j];
+    if (p == j) continue;
+    const char* row = saved[p] ? scratch.data() + scratch_row[p] * row_bytes
+                               : src + p * row_bytes;
+    std::memcpy(dst + j * row_bytes, row, row_bytes);
+  }
+}
+
+}  // namespace
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+template <typename Device, typename T>
+class BeamSearchStepOp : public OpKernel {
+ public:
+  explicit BeamSearchStepOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& log_probs = context->input(0);
+    const Tensor& beam_scores = context->input(1);
+    OP_REQUIRES(context, log_probs.dims() == 3,
+                errors::InvalidArgument(
+                    "log_probs must be [batch, beam_width, vocab_size] but "
+                    "has shape ",
+                    log_probs.shape().DebugString()));
+    const int64_t batch_size = log_probs.dim_size(0);
+    const int64_t beam_width = log_probs.dim_size(1);
+    const int64_t vocab_size = log_probs.dim_size(2);
+    OP_REQUIRES(
+        context,
+        TensorShapeUtils::IsMatrix(beam_scores.shape()) &&
+            beam_scores.dim_size(0) == batch_size &&
+            beam_scores.dim_size(1) == beam_width,
+        errors::InvalidArgument("beam_scores must be [", batch_size, ", ",
+                                beam_width, "] but has shape ",
+                                beam_scores.shape().DebugString()));
+    OP_REQUIRES(context, beam_width <= kint32max,
+                errors::InvalidArgument("beam_width is too large: ",
+                                        beam_width));
+    OP_REQUIRES(context, beam_width == 0 || vocab_size > 0,
+                errors::InvalidArgument("vocab_size must be positive"));
+
+    const int num_states = context->num_inputs() - 2;
+    const int64_t num_rows = batch_size * beam_width;
+    for (int i = 0; i < num_states; ++i) {
+      const Tensor& state = context->input(i + 2);
+      OP_REQUIRES(context,
+                  state.dims() >= 1 && state.dim_size(0) == num_rows,
+                  errors::InvalidArgument(
+                      "State ", i, " must have batch * beam_width = ", num_rows,
+                      " rows but has shape ", state.shape().DebugString()));
+      OP_REQUIRES(context, DataTypeCanUseMemcpy(state.dtype()),
+                  errors::InvalidArgument("State ", i, " has unsupported type ",
+                                          DataTypeString(state.dtype())));
+    }
+
+    Tensor* scores = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, beam_scores.shape(), &scores));
+    Tensor* token_ids = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(1, beam_scores.shape(),
+                                                     &token_ids));
+    Tensor* parent_ids = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(2, beam_scores.shape(),
+                                                     &parent_ids));
+    if (num_rows == 0) {
+      for (int i = 0; i < num_states; ++i) {
+        context->set_output(i + 3, context->input(i + 2));
+      }
+      return;
+    }
+
+    const auto log_probs_t = log_probs.tensor<T, 3>();
+    const auto beam_scores_t = beam_scores.matrix<T>();
+    auto scores_t = scores->matrix<T>();
+    auto token_ids_t = token_ids->matrix<int32>();
+    auto parent_ids_t = parent_ids->matrix<int32>();
+
+    auto select_beams = [&](int64_t start, int64_t limit) {
+      gtl::TopN<Candidate, CandidateGreater> top_n(beam_width);
+      std::vector<Candidate> best;
+      for (int64_t b = start; b < limit; ++b) {
+        top_n.Reset();
+        for (int64_t k = 0; k < beam_width; ++k) {
+          const float beam_score = static_cast<float>(beam_scores_t(b, k));
+          for (int64_t v = 0; v < vocab_size; ++v) {
+            top_n.push(
+                {beam_score + static_cast<float>(log_probs_t(b, k, v)),
+                 k * vocab_size + v});
+          }
+        }
+        top_n.ExtractNondestructive(&best);
+        for (int64_t j = 0; j < beam_width; ++j) {
+          scores_t(b, j) = static_cast<T>(best[j].score);
+          token_ids_t(b, j) = static_cast<int32>(best[j].index % vocab_size);
+          parent_ids_t(b, j) = static_cast<int32>(best[j].index / vocab_size);
+        }
+      }
+    };
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          beam_width * vocab_size * 5, select_beams);
+
+    const int32* parents = parent_ids->flat<int32>().data();
+    for (int i = 0; i < num_states; ++i) {
+      const Tensor& state = context->input(i + 2);
+      Tensor* reordered = nullptr;
+      OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                  {i + 2}, i + 3, state.shape(), &reordered));
+      const int64_t row_bytes = state.TotalBytes() / num_rows;
+      if (row_bytes == 0) continue;
+      const char* src = state.tensor_data().data();
+      char* dst = const_cast<char*>(reordered->tensor_data().data());
+      auto reorder = [&](int64_t start, int64_t limit) {
+        for (int64_t b = start; b < limit; ++b) {
+          const int64_t offset = b * beam_width * row_bytes;
+          ReorderRows(src + offset, dst + offset, row_bytes, beam_width,
+                      parents + b * beam_width);
+        }
+      };
+      Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+            beam_width * row_bytes, reorder);
+    }
+  }
+};
+
+#define REGISTER_KERNEL(T)                                              \
+  REGISTER_KERNEL_BUILDER(                                              \
+      Name("BeamSearchStep").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      BeamSearchStepOp<CPUDevice, T>)
+
+TF_CALL_half(REGISTER_KERNEL);
+TF_CALL_bfloat16(REGISTER_KERNEL);
+TF_CALL_float(REGISTER_KERNEL);
+TF_CALL_double(REGISTER_KERNEL);
+
+#undef REGISTER_KERNEL
+
+}  // namespace tensorflow
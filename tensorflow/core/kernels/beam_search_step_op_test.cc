@@ -0,0 +1,96 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class BeamSearchStepOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(std::initializer_list<DataType> state_types) {
+    TF_ASSERT_OK(NodeDefBuilder("beam_search_step", "BeamSearchStep")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(state_types))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(BeamSearchStepOpTest, SelectsBeamsAndReordersStates) {
+  MakeOp({DT_FLOAT, DT_INT32});
+  // [batch = 2, beam_width = 2, vocab_size = 3]
+  AddInputFromArray<float>(TensorShape({2, 2, 3}),
+                           {-3, -2, -4, -0.5, -5, -0.2,  //
+                            -9, -9, -2, -0.1, -9, -9});
+  AddInputFromArray<float>(TensorShape({2, 2}), {0, -1, -1, 0});
+  AddInputFromArray<float>(TensorShape({4, 2}), {1, 2, 3, 4, 5, 6, 7, 8});
+  AddInputFromArray<int32>(TensorShape({4}), {10, 11, 12, 13});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected_scores(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected_scores, {-1.2, -1.5, -0.1, -3});
+  test::ExpectTensorNear<float>(expected_scores, *GetOutput(0), 1e-6);
+  Tensor expected_tokens(DT_INT32, TensorShape({2, 2}));
+  test::FillValues<int32>(&expected_tokens, {2, 0, 0, 2});
+  test::ExpectTensorEqual<int32>(expected_tokens, *GetOutput(1));
+  Tensor expected_parents(DT_INT32, TensorShape({2, 2}));
+  test::FillValues<int32>(&expected_parents, {1, 1, 1, 0});
+  test::ExpectTensorEqual<int32>(expected_parents, *GetOutput(2));
+
+  Tensor expected_state(DT_FLOAT, TensorShape({4, 2}));
+  test::FillValues<float>(&expected_state, {3, 4, 3, 4, 7, 8, 5, 6});
+  test::ExpectTensorEqual<float>(expected_state, *GetOutput(3));
+  Tensor expected_int_state(DT_INT32, TensorShape({4}));
+  test::FillValues<int32>(&expected_int_state, {11, 11, 13, 12});
+  test::ExpectTensorEqual<int32>(expected_int_state, *GetOutput(4));
+}
+
+TEST_F(BeamSearchStepOpTest, TiesPreferLowerBeamAndToken) {
+  MakeOp({});
+  AddInputFromArray<float>(TensorShape({1, 2, 2}), {0, 0, 0, 0});
+  AddInputFromArray<float>(TensorShape({1, 2}), {0, 0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected_tokens(DT_INT32, TensorShape({1, 2}));
+  test::FillValues<int32>(&expected_tokens, {0, 1});
+  test::ExpectTensorEqual<int32>(expected_tokens, *GetOutput(1));
+  Tensor expected_parents(DT_INT32, TensorShape({1, 2}));
+  test::FillValues<int32>(&expected_parents, {0, 0});
+  test::ExpectTensorEqual<int32>(expected_parents, *GetOutput(2));
+}
+
+TEST_F(BeamSearchStepOpTest, StateWithWrongNumberOfRows) {
+  MakeOp({DT_FLOAT});
+  AddInputFromArray<float>(TensorShape({1, 2, 2}), {0, 0, 0, 0});
+  AddInputFromArray<float>(TensorShape({1, 2}), {0, 0});
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  EXPECT_TRUE(absl::StrContains(s.error_message(), "rows")) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
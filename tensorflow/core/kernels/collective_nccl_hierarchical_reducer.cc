@@ -0,0 +1,247 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/collective_nccl_hierarchical_reducer.h"
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace {
+
+// Every sub-collective runs under its own exec key so that NCCL communicators
+// and rendezvous keys never collide with those of the parent collective.
+string SubExecKey(const string& exec_key, const string& phase) {
+  return strings::StrCat(exec_key, ":hierarchical_", phase);
+}
+
+}  // namespace
+
+Status NcclHierarchicalReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (type_ != col_params->instance.type ||
+      name_ != col_params->instance.impl_details.collective_name) {
+    return errors::Internal("Unexpected combination of collective type ",
+                            col_params->instance.type, " and collective name ",
+                            col_params->instance.impl_details.collective_name,
+                            ", expected name ", name_);
+  }
+  if (!col_params->group.same_num_devices_per_task) {
+    return errors::Internal(
+        name_, " requires the same number of devices on every task, got ",
+        col_params->group.ToString());
+  }
+  return Status::OK();
+}
+
+CollectiveParams* NcclHierarchicalReducer::MakeSubParams(
+    const std::vector<CollGroupMember>& members, int default_rank,
+    CollectiveType type, const string& collective_name) const {
+  CollectiveParams* params = new CollectiveParams();
+  params->name = col_params_->name;
+  params->group.group_key = col_params_->group.group_key;
+  params->group.group_size = members.size();
+  params->group.device_type = col_params_->group.device_type;
+  params->group.members = members;
+  for (const CollGroupMember& member : members) {
+    ++params->group.num_devices_per_task[member.task];
+  }
+  params->group.num_tasks = params->group.num_devices_per_task.size();
+  params->group.same_num_devices_per_task = true;
+  params->instance = col_params_->instance;
+  params->instance.type = type;
+  params->instance.impl_details.collective_name = collective_name;
+  params->instance.impl_details.subdiv_permutations.clear();
+  params->instance.impl_details.subdiv_offsets.clear();
+  params->instance.impl_details.subdiv_source_rank.clear();
+  params->default_rank = default_rank;
+  params->merge_op = col_params_->merge_op;
+  return params;
+}
+
+Status NcclHierarchicalReducer::RunLocalNccl(CollectiveParams* params,
+                                             const string& exec_key,
+                                             const Tensor* input,
+                                             Tensor* output) {
+  core::ScopedUnref unref(params);
+  auto ctx = std::make_shared<CollectiveContext>(
+      col_ctx_->col_exec, col_ctx_->nccl_communicator, col_ctx_->dev_mgr,
+      col_ctx_->op_ctx, col_ctx_->op_params, params, exec_key,
+      col_ctx_->step_id, input, output);
+  ctx->device = col_ctx_->device;
+  ctx->device_locality = col_ctx_->device_locality;
+  Notification note;
+  Status status;
+  col_ctx_->nccl_communicator->Enqueue(ctx, [&note, &status](const Status& s) {
+    status = s;
+    note.Notify();
+  });
+  note.WaitForNotification();
+  return status;
+}
+
+Status NcclHierarchicalReducer::RunInterTaskRing(Tensor* shard) {
+  CollectiveParams* params = MakeSubParams(peer_members_, task_rank_,
+                                           REDUCTION_COLLECTIVE, "RingReduce");
+  core::ScopedUnref unref_params(params);
+  params->instance.shape = shard->shape();
+  params->instance.impl_details.subdiv_offsets = {0};
+
+  CollectiveImplementationInterface* ring = nullptr;
+  TF_RETURN_IF_ERROR(CollectiveRegistry::Lookup("RingReduce", &ring));
+  core::ScopedUnref unref_ring(ring);
+  TF_RETURN_IF_ERROR(ring->InitializeCollectiveParams(params));
+  auto ctx = std::make_shared<CollectiveContext>(
+      col_ctx_->col_exec, /*nccl_communicator=*/nullptr, col_ctx_->dev_mgr,
+      col_ctx_->op_ctx, col_ctx_->op_params, params,
+      SubExecKey(col_ctx_->exec_key, "ring"), col_ctx_->step_id, shard, shard);
+  TF_RETURN_IF_ERROR(ring->InitializeCollectiveContext(ctx));
+  Notification note;
+  Status status;
+  ring->Run([&note, &status](const Status& s) {
+    status = s;
+    note.Notify();
+  });
+  note.WaitForNotification();
+  return status;
+}
+
+Status NcclHierarchicalReducer::RunFinalOp() {
+  const int group_size = col_params_->group.group_size;
+  const DataType dtype = col_ctx_->output->dtype();
+  Tensor group_size_val;
+  switch (dtype) {
+    case DT_HALF:
+      group_size_val = Tensor(static_cast<Eigen::half>(group_size));
+      break;
+    case DT_FLOAT:
+      group_size_val = Tensor(static_cast<float>(group_size));
+      break;
+    case DT_DOUBLE:
+      group_size_val = Tensor(static_cast<double>(group_size));
+      break;
+    case DT_INT32:
+      group_size_val = Tensor(static_cast<int32>(group_size));
+      break;
+    case DT_INT64:
+      group_size_val = Tensor(static_cast<int64_t>(group_size));
+      break;
+    default:
+      return errors::Internal("Unsupported type ", DataTypeString(dtype));
+  }
+  Tensor group_size_tensor(
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+      dtype, TensorShape({}));
+  Notification note;
+  Status status;
+  col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+      &group_size_val, col_ctx_->device, &group_size_tensor,
+      [&note, &status](const Status& s) {
+        status = s;
+        note.Notify();
+      });
+  note.WaitForNotification();
+  TF_RETURN_IF_ERROR(status);
+  return collective_util::ComputeBinOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->final_op, col_ctx_->output, &group_size_tensor);
+}
+
+void NcclHierarchicalReducer::Run(StatusCallback done) {
+  // Hold a ref to col_params for the rest of this function.
+  col_params_->Ref();
+  core::ScopedUnref unref(col_params_);
+
+  // Split the group into the devices of this task and, for the local rank of
+  // this device, its peers on every task.
+  const CollGroupParams& group = col_params_->group;
+  const string& task = group.members[col_params_->default_rank].task;
+  local_members_.clear();
+  for (int i = 0; i < group.group_size; ++i) {
+    if (group.members[i].task != task) continue;
+    if (i == col_params_->default_rank) local_rank_ = local_members_.size();
+    local_members_.push_back(group.members[i]);
+  }
+  peer_members_.clear();
+  std::unordered_map<string, int> seen_per_task;
+  for (const CollGroupMember& member : group.members) {
+    if (seen_per_task[member.task]++ != local_rank_) continue;
+    if (member.task == task) task_rank_ = peer_members_.size();
+    peer_members_.push_back(member);
+  }
+
+  // Shards are aliased out of a flat view of the output, with boundaries kept
+  // on alignment boundaries so the ring can chunk them further.
+  Tensor* output = col_ctx_->output;
+  const int64_t total_elts = output->NumElements();
+  Tensor flat_output;
+  if (!flat_output.CopyFrom(*output, TensorShape({total_elts}))) {
+    done(errors::Internal("Failed to flatten output of ", name_));
+    return;
+  }
+  const int num_local = local_members_.size();
+  const int64_t shard_elts = CollectiveAdapter::AlignedChunkElts(
+      DataTypeSize(output->dtype()), total_elts, num_local);
+  auto shard = [&](int i) {
+    const int64_t begin = std::min(total_elts, i * shard_elts);
+    return flat_output.Slice(begin, std::min(total_elts, begin + shard_elts));
+  };
+
+  Status status;
+  {
+    profiler::TraceMe activity("NcclLocalReduce",
+                               profiler::TraceMeLevel::kInfo);
+    status = RunLocalNccl(MakeSubParams(local_members_, local_rank_,
+                                        REDUCTION_COLLECTIVE, "NcclReduce"),
+                          SubExecKey(col_ctx_->exec_key, "reduce"),
+                          col_ctx_->input, output);
+  }
+  Tensor local_shard = shard(local_rank_);
+  if (status.ok() && peer_members_.size() > 1 &&
+      local_shard.NumElements() > 0) {
+    profiler::TraceMe activity("RingInterTaskReduce",
+                               profiler::TraceMeLevel::kInfo);
+    status = RunInterTaskRing(&local_shard);
+  }
+  for (int i = 0; status.ok() && i < num_local; ++i) {
+    Tensor shard_i = shard(i);
+    if (shard_i.NumElements() == 0) continue;
+    profiler::TraceMe activity("NcclLocalBroadcast",
+                               profiler::TraceMeLevel::kInfo);
+    CollectiveParams* params = MakeSubParams(
+        local_members_, local_rank_, BROADCAST_COLLECTIVE, "NcclBroadcast");
+    params->source_rank = i;
+    params->is_source = i == local_rank_;
+    status = RunLocalNccl(
+        params, SubExecKey(col_ctx_->exec_key, strings::StrCat("bcast_", i)),
+        &shard_i, &shard_i);
+  }
+  if (status.ok() && col_params_->final_op) {
+    status = RunFinalOp();
+  }
+  done(status);
+}
+
+REGISTER_COLLECTIVE(NcclHierarchicalReduce, NcclHierarchicalReducer);
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
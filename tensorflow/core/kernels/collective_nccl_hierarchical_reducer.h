@@ -0,0 +1,72 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_COLLECTIVE_NCCL_HIERARCHICAL_REDUCER_H_
+#define TENSORFLOW_CORE_KERNELS_COLLECTIVE_NCCL_HIERARCHICAL_REDUCER_H_
+
+#include "tensorflow/core/kernels/collective_nccl.h"
+
+namespace tensorflow {
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// Two-level all-reduce for groups that span several tasks with the same
+// number of GPUs each.  The tensor is first all-reduced over NCCL among the
+// devices of each task, then shard `i` of it is ring-reduced across tasks by
+// the `i`-th device of every task, and finally each shard is broadcast over
+// NCCL from its owner back to the other devices of the task.  This keeps the
+// bulk of the traffic on the intra-node links and sends only
+// 1/num_devices_per_task of the tensor over the network from every device.
+class NcclHierarchicalReducer : public NcclBase {
+ public:
+  NcclHierarchicalReducer()
+      : NcclBase(REDUCTION_COLLECTIVE, "NcclHierarchicalReduce") {}
+  ~NcclHierarchicalReducer() override = default;
+
+  // Checks that the group is laid out evenly over its tasks.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Runs the three phases in order and then applies `final_op`.  Blocks.
+  void Run(StatusCallback done) override;
+
+ private:
+  // Runs `params` as a NCCL collective among the devices of this task.
+  Status RunLocalNccl(CollectiveParams* params, const string& exec_key,
+                      const Tensor* input, Tensor* output);
+
+  // Ring-reduces `shard` in place among the peers of this device on the
+  // other tasks.
+  Status RunInterTaskRing(Tensor* shard);
+
+  // Divides the output by the group size on the device.
+  Status RunFinalOp();
+
+  // Returns sub-group parameters for a collective among `members`, with this
+  // device at `default_rank`.
+  CollectiveParams* MakeSubParams(const std::vector<CollGroupMember>& members,
+                                  int default_rank, CollectiveType type,
+                                  const string& collective_name) const;
+
+  // Devices of this task, in group order, and this device's index among them.
+  std::vector<CollGroupMember> local_members_;
+  int local_rank_ = -1;
+  // The device at `local_rank_` on every task, in group order, and the index
+  // of this task among them.
+  std::vector<CollGroupMember> peer_members_;
+  int task_rank_ = -1;
+};
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_COLLECTIVE_NCCL_HIERARCHICAL_REDUCER_H_
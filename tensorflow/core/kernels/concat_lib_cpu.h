@@ -19,9 +19,11 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include <vector>
+
+#include "absl/types/optional.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/concat_lib.h"
-#include "tensorflow/core/util/work_sharder.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 
@@ -50,13 +52,17 @@ void ConcatCPUImpl(
   // string data, as well).
   const int64_t estimated_total_cost = output->size() * cost_per_unit;
 
+  // The copy is memory bound, so the output is split into a few blocks per
+  // thread, each copying at least kMinBytesPerBlock.
+  const int64_t kMinBytesPerBlock = 32 << 10;
+  const int64_t kBlocksPerThread = 4;
   auto worker_threads = d->tensorflow_cpu_worker_threads();
-  int num_threads = std::min(4, worker_threads->num_threads);
-  num_threads = static_cast<int>(
-      std::min<int64_t>(num_threads, estimated_total_cost / 16384));
+  const int64_t num_blocks =
+      std::min<int64_t>(worker_threads->num_threads * kBlocksPerThread,
+                        estimated_total_cost / kMinBytesPerBlock);
   // Single threaded mode.
   // TODO(dga):  Deduplicate this code w.r.t. sharded code below.
-  if (num_threads == 0) {
+  if (worker_threads->num_threads <= 1 || num_blocks <= 1) {
     T* out = &(*output)(0, 0);
     std::vector<const T*> inp;
     inp.reserve(num_inputs);
@@ -126,8 +132,13 @@ void ConcatCPUImpl(
       }
     }
   };
-  Shard(worker_threads->num_threads, worker_threads->workers, output->size(),
-        cost_per_unit, work);
+  const int64_t block_size = (output->size() + num_blocks - 1) / num_blocks;
+  worker_threads->workers->ParallelFor(
+      output->size(),
+      thread::ThreadPool::SchedulingParams(
+          thread::ThreadPool::SchedulingStrategy::kFixedBlockSize,
+          absl::nullopt, block_size),
+      work);
 }
 
 }  // namespace tensorflow
@@ -222,12 +222,17 @@ struct LaunchFusedConv2DOp<CPUDevice, T> {
 
     BiasAddArgs<T> bias_add_args;
     if (BiasAddArgs<T>::IsSupported(fusion)) {
-      if (fusion == FusedComputationType::kBiasAddWithLeakyRelu) {
+      if (fusion == FusedComputationType::kBiasAddWithLeakyRelu ||
+          fusion == FusedComputationType::kBiasAddWithAddAndLeakyRelu) {
         OP_REQUIRES_OK(context, InitBiasAddArgs(context, &bias_add_args,
                                                 &fusion_args.leakyrelu_alpha));
       } else {
         OP_REQUIRES_OK(context, InitBiasAddArgs(context, &bias_add_args));
       }
+      if (HasResidualAdd(fusion)) {
+        OP_REQUIRES_OK(context,
+                       InitResidualAddArgs(context, *output, &bias_add_args));
+      }
     }
 
     FusedBatchNormArgs<T> fused_batch_norm_args;
@@ -249,29 +254,16 @@ struct LaunchFusedConv2DOp<CPUDevice, T> {
         dimensions.dilation_rows, dimensions.dilation_cols, params.padding,
         params.explicit_paddings);
 
+    if (BiasAddArgs<T>::IsSupported(fusion)) {
+      auto launch = [&](const auto& output_kernel) {
+        conv2d(output_kernel, context, input, filter, output);
+      };
+      OP_REQUIRES_OK(context, LaunchWithBiasAddOutputKernel(
+                                  fusion, bias_add_args, launch));
+      return;
+    }
+
     switch (fusion) {
-      case FusedComputationType::kUndefined:
-        OP_REQUIRES_OK(context, errors::Internal("Fusion type is undefined"));
-        break;
-      case FusedComputationType::kBiasAdd:
-        conv2d(WithBiasAdd<T>(bias_add_args), context, input, filter, output);
-        break;
-      case FusedComputationType::kBiasAddWithRelu:
-        conv2d(WithBiasAddAndRelu<T>(bias_add_args), context, input, filter,
-               output);
-        break;
-      case FusedComputationType::kBiasAddWithRelu6:
-        conv2d(WithBiasAddAndRelu6<T>(bias_add_args), context, input, filter,
-               output);
-        break;
-      case FusedComputationType::kBiasAddWithLeakyRelu:
-        conv2d(WithBiasAddAndLeakyRelu<T>(bias_add_args), context, input,
-               filter, output);
-        break;
-      case FusedComputationType::kBiasAddWithElu:
-        conv2d(WithBiasAddAndElu<T>(bias_add_args), context, input, filter,
-               output);
-        break;
       case FusedComputationType::kFusedBatchNorm:
         conv2d(
             WithFusedBatchNorm<T>(fusion_args.epsilon, fused_batch_norm_args),
@@ -297,6 +289,12 @@ struct LaunchFusedConv2DOp<CPUDevice, T> {
                                            fused_batch_norm_args),
                context, input, filter, output);
         break;
+      case FusedComputationType::kUndefined:
+        OP_REQUIRES_OK(context, errors::Internal("Fusion type is undefined"));
+        break;
+      default:
+        OP_REQUIRES_OK(context,
+                       errors::Internal("Fusion type is not supported"));
     }
   }
 };
@@ -645,6 +643,15 @@ class FusedConv2DOp : public OpKernel {
           {FCT::kBiasAddWithRelu6, {"BiasAdd", "Relu6"}},
           {FCT::kBiasAddWithElu, {"BiasAdd", "Elu"}},
           {FCT::kBiasAddWithLeakyRelu, {"BiasAdd", "LeakyRelu"}},
+          {FCT::kBiasAddWithTanh, {"BiasAdd", "Tanh"}},
+          {FCT::kBiasAddWithSigmoid, {"BiasAdd", "Sigmoid"}},
+          {FCT::kBiasAddWithAdd, {"BiasAdd", "Add"}},
+          {FCT::kBiasAddWithAddAndRelu, {"BiasAdd", "Add", "Relu"}},
+          {FCT::kBiasAddWithAddAndRelu6, {"BiasAdd", "Add", "Relu6"}},
+          {FCT::kBiasAddWithAddAndElu, {"BiasAdd", "Add", "Elu"}},
+          {FCT::kBiasAddWithAddAndLeakyRelu, {"BiasAdd", "Add", "LeakyRelu"}},
+          {FCT::kBiasAddWithAddAndTanh, {"BiasAdd", "Add", "Tanh"}},
+          {FCT::kBiasAddWithAddAndSigmoid, {"BiasAdd", "Add", "Sigmoid"}},
           {FCT::kFusedBatchNorm, {"FusedBatchNorm"}},
           {FCT::kFusedBatchNormWithRelu, {"FusedBatchNorm", "Relu"}},
           {FCT::kFusedBatchNormWithRelu6, {"FusedBatchNorm", "Relu6"}},
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_dataset_ops.h"
 
+#include <deque>
 #include <memory>
 #include <string>
 #include <utility>
@@ -46,6 +47,7 @@ namespace data {
 /* static */ constexpr const char* const CacheDatasetOp::kFileName;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputTypes;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const CacheDatasetOp::kMemoryBudget;
 
 namespace {
 
@@ -64,6 +66,11 @@ constexpr char kCacheCompleted[] = "cache_completed";
 constexpr char kIndex[] = "index";
 constexpr char kImpl[] = "Impl";
 constexpr char kCacheDataset[] = "CacheDataset";
+constexpr char kSpillNotSupportedErrorMessage[] =
+    "Saving the state of a memory cache that spilled elements to disk is not "
+    "supported. Increase the `memory_budget` of the cache or set it to 0.";
+// The number of spilled elements that a memory cache reader reads ahead.
+constexpr size_t kSpillPrefetchBufferSize = 8;
 constexpr char kIncompleteCacheErrorMessage[] =
     "The calling iterator did not fully read the dataset being cached. In "
     "order to avoid unexpected truncation of the dataset, the partially cached "
@@ -724,10 +731,12 @@ class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
 class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
  public:
   explicit MemoryDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
-                             std::shared_ptr<MemoryCache> cache)
+                             std::shared_ptr<MemoryCache> cache,
+                             int64_t memory_budget)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
-        cache_(std::move(cache)) {
+        cache_(std::move(cache)),
+        memory_budget_(memory_budget) {
     input_->Ref();
   }
 
@@ -822,6 +831,9 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                         IteratorStateWriter* writer) override {
       mutex_lock l(mu_);
       if (cache_->IsCompleted()) {
+        if (cache_->spilled() != nullptr) {
+          return errors::Unimplemented(kSpillNotSupportedErrorMessage);
+        }
         TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCacheCompleted), ""));
         TF_RETURN_IF_ERROR(
             WriteElementsToCheckpoint(writer, prefix(), cache_->data()));
@@ -852,10 +864,15 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
 
       ~MemoryWriterIterator() override {
         mutex_lock l(mu_);
-        if (!temp_cache_.empty() && !cache_->IsCompleted()) {
+        if ((!temp_cache_.empty() || num_spilled_ > 0) &&
+            !cache_->IsCompleted()) {
           LOG(WARNING) << kIncompleteCacheErrorMessage;
           cache_->Reset();
         }
+        if (spill_writer_ != nullptr) {
+          spill_writer_->Finish().IgnoreError();
+          SpilledElements::DeleteFiles(spill_env_, spill_prefix_);
+        }
       }
 
       Status Initialize(IteratorContext* ctx) override {
@@ -872,16 +889,27 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         if (*end_of_sequence) {
           if (!cache_->IsCompleted()) {
             VLOG(2) << "Finalizing the cache because EOF has been reached.";
-            cache_->Complete(std::move(temp_cache_));
+            TF_RETURN_IF_ERROR(CompleteCache());
           }
           return Status::OK();
         }
-        RecordBufferEnqueue(ctx, *out_tensors);
-        temp_cache_.emplace_back(*out_tensors);
-        if (temp_cache_.size() == dataset()->input_->Cardinality()) {
+        const int64_t num_bytes = GetTotalBytes(*out_tensors);
+        if (spill_writer_ == nullptr &&
+            (dataset()->memory_budget_ <= 0 ||
+             temp_cache_bytes_ + num_bytes <= dataset()->memory_budget_)) {
+          RecordBufferEnqueue(ctx, *out_tensors);
+          temp_cache_.emplace_back(*out_tensors);
+          temp_cache_bytes_ += num_bytes;
+        } else {
+          // Once an element does not fit in the budget, all later elements are
+          // spilled too, so that the cache is read back in order.
+          TF_RETURN_IF_ERROR(Spill(ctx, *out_tensors));
+        }
+        if (temp_cache_.size() + num_spilled_ ==
+            dataset()->input_->Cardinality()) {
           VLOG(2) << "Finalizing the cache because its size matches the "
                      "expected input cardinality.";
-          cache_->Complete(std::move(temp_cache_));
+          TF_RETURN_IF_ERROR(CompleteCache());
         }
         return Status::OK();
       }
@@ -897,6 +925,9 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                           IteratorStateWriter* writer) override {
         mutex_lock l(mu_);
         if (!cache_->IsCompleted()) {
+          if (num_spilled_ > 0) {
+            return errors::Unimplemented(kSpillNotSupportedErrorMessage);
+          }
           TF_RETURN_IF_ERROR(
               WriteElementsToCheckpoint(writer, prefix(), temp_cache_));
         }
@@ -909,15 +940,63 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         if (!reader->Contains(full_name(kCacheCompleted))) {
           TF_RETURN_IF_ERROR(
               ReadElementsFromCheckpoint(ctx, reader, prefix(), &temp_cache_));
+          temp_cache_bytes_ = 0;
+          for (const std::vector<Tensor>& element : temp_cache_) {
+            temp_cache_bytes_ += GetTotalBytes(element);
+          }
         }
         return RestoreInput(ctx, reader, input_impl_);
       }
 
      private:
+      // Appends `element` to the spill file, which is created on first use.
+      Status Spill(IteratorContext* ctx, const std::vector<Tensor>& element)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (spill_writer_ == nullptr) {
+          spill_env_ = ctx->env();
+          if (!spill_env_->LocalTempFilename(&spill_prefix_)) {
+            return errors::Unavailable(
+                "Failed to create a local file to spill the memory cache to.");
+          }
+          VLOG(2) << "The memory cache exceeded its budget of "
+                  << dataset()->memory_budget_
+                  << " bytes; spilling the remaining elements to "
+                  << spill_prefix_;
+          spill_writer_ =
+              absl::make_unique<BundleWriter>(spill_env_, spill_prefix_);
+        }
+        for (size_t i = 0; i < element.size(); ++i) {
+          TF_RETURN_IF_ERROR(spill_writer_->Add(
+              SpilledElements::Key(num_spilled_, i), element[i]));
+        }
+        num_spilled_++;
+        return Status::OK();
+      }
+
+      Status CompleteCache() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        std::shared_ptr<const SpilledElements> spilled;
+        if (spill_writer_ != nullptr) {
+          TF_RETURN_IF_ERROR(spill_writer_->Finish());
+          spill_writer_.reset();
+          // The spill file is now owned by `spilled`.
+          spilled = std::make_shared<SpilledElements>(
+              spill_env_, std::move(spill_prefix_), num_spilled_);
+        }
+        cache_->Complete(std::move(temp_cache_), std::move(spilled));
+        return Status::OK();
+      }
+
       mutex mu_;
       std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
       MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
       std::vector<std::vector<Tensor>> temp_cache_ TF_GUARDED_BY(mu_);
+      int64_t temp_cache_bytes_ TF_GUARDED_BY(mu_) = 0;
+      // The elements that did not fit in the memory budget are written to a
+      // tensor bundle with prefix `spill_prefix_`.
+      Env* spill_env_ TF_GUARDED_BY(mu_) = nullptr;
+      string spill_prefix_ TF_GUARDED_BY(mu_);
+      std::unique_ptr<BundleWriter> spill_writer_ TF_GUARDED_BY(mu_);
+      int64_t num_spilled_ TF_GUARDED_BY(mu_) = 0;
     };  // MemoryWriterIterator
 
     class MemoryReaderIterator : public DatasetIterator<MemoryDatasetBase> {
@@ -927,16 +1006,19 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
             cache_(cache),
             index_(0) {}
 
+      ~MemoryReaderIterator() override { StopPrefetchThread(); }
+
       Status Initialize(IteratorContext* ctx) override {
         // The memory allocated for the cache is owned by the parent
         // dataset but performance modeling uses the iterator abstraction and
         // thus we record the memory allocated for the cache here. The caveat
         // is that this is incorrect if there are concurrent instances of this
         // iterator.
-        tf_shared_lock l(mu_);
+        mutex_lock l(mu_);
         for (size_t i = 0; i < cache_->size(); ++i) {
           RecordBufferEnqueue(ctx, cache_->at(i));
         }
+        spilled_ = cache_->spilled();
         return Status::OK();
       }
 
@@ -944,6 +1026,18 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                              std::vector<Tensor>* out_tensors,
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
+        // Start reading the spilled elements while the first elements are
+        // served from memory.
+        if (spilled_ != nullptr && prefetch_thread_ == nullptr) {
+          const int64_t start =
+              std::max<int64_t>(0, static_cast<int64_t>(index_) -
+                                       static_cast<int64_t>(cache_->size()));
+          prefetch_thread_ = ctx->StartThread(
+              "tf_data_memory_cache_spill_reader",
+              [this, spilled = spilled_, start]() {
+                PrefetchThread(spilled, start);
+              });
+        }
         if (index_ < cache_->size()) {
           const std::vector<Tensor>& cache_tensors = cache_->at(index_);
           out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
@@ -951,10 +1045,25 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
           index_++;
           *end_of_sequence = false;
           return Status::OK();
-        } else {
+        }
+        if (spilled_ == nullptr ||
+            static_cast<int64_t>(index_ - cache_->size()) >=
+                spilled_->num_elements()) {
           *end_of_sequence = true;
           return Status::OK();
         }
+        while (prefetch_buffer_.empty()) {
+          cond_var_.wait(l);
+        }
+        SpilledElement element = std::move(prefetch_buffer_.front());
+        prefetch_buffer_.pop_front();
+        cond_var_.notify_all();
+        TF_RETURN_IF_ERROR(element.status);
+        out_tensors->insert(out_tensors->begin(), element.value.begin(),
+                            element.value.end());
+        index_++;
+        *end_of_sequence = false;
+        return Status::OK();
       }
 
      protected:
@@ -973,6 +1082,8 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
 
       Status RestoreInternal(IteratorContext* ctx,
                              IteratorStateReader* reader) override {
+        // The prefetched elements may not follow the restored position.
+        StopPrefetchThread();
         mutex_lock l(mu_);
         {
           // kIndex will not be set if we are restoring from a checkpoint
@@ -987,9 +1098,86 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       }
 
      private:
+      struct SpilledElement {
+        Status status;
+        std::vector<Tensor> value;
+      };
+
+      // Reads the spilled elements, beginning with element `start`, into
+      // `prefetch_buffer_`, keeping up to `kSpillPrefetchBufferSize` elements
+      // buffered. Stops after the first error.
+      void PrefetchThread(std::shared_ptr<const SpilledElements> spilled,
+                          int64_t start) {
+        BundleReader reader(spilled->env(), spilled->prefix());
+        if (reader.status().ok()) {
+          reader.Seek(SpilledElements::Key(start, 0));
+        }
+        for (int64_t i = start; i < spilled->num_elements(); ++i) {
+          {
+            mutex_lock l(mu_);
+            while (!cancelled_ &&
+                   prefetch_buffer_.size() >= kSpillPrefetchBufferSize) {
+              cond_var_.wait(l);
+            }
+            if (cancelled_) return;
+          }
+          SpilledElement element;
+          element.status =
+              ReadSpilledElement(*spilled, &reader, i, &element.value);
+          const bool ok = element.status.ok();
+          {
+            mutex_lock l(mu_);
+            prefetch_buffer_.push_back(std::move(element));
+            cond_var_.notify_all();
+          }
+          if (!ok) return;
+        }
+      }
+
+      Status ReadSpilledElement(const SpilledElements& spilled,
+                                BundleReader* reader, int64_t index,
+                                std::vector<Tensor>* element) {
+        TF_RETURN_IF_ERROR(reader->status());
+        const size_t num_components = dataset()->output_dtypes().size();
+        element->resize(num_components);
+        for (size_t i = 0; i < num_components; ++i) {
+          if (!reader->Valid() ||
+              reader->key() != SpilledElements::Key(index, i)) {
+            return errors::DataLoss("Component ", i, " of element ", index,
+                                    " is missing from the memory cache spill "
+                                    "file ",
+                                    spilled.prefix());
+          }
+          TF_RETURN_IF_ERROR(reader->ReadCurrent(&(*element)[i]));
+          reader->Next();
+        }
+        return reader->status();
+      }
+
+      void StopPrefetchThread() TF_LOCKS_EXCLUDED(mu_) {
+        std::unique_ptr<Thread> thread;
+        {
+          mutex_lock l(mu_);
+          cancelled_ = true;
+          cond_var_.notify_all();
+          thread = std::move(prefetch_thread_);
+        }
+        // Joins the thread.
+        thread.reset();
+        mutex_lock l(mu_);
+        cancelled_ = false;
+        prefetch_buffer_.clear();
+      }
+
       mutex mu_;
+      condition_variable cond_var_;
       MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
       size_t index_ TF_GUARDED_BY(mu_);
+      // The elements that follow those in `cache_`, or nullptr.
+      std::shared_ptr<const SpilledElements> spilled_ TF_GUARDED_BY(mu_);
+      std::unique_ptr<Thread> prefetch_thread_ TF_GUARDED_BY(mu_);
+      std::deque<SpilledElement> prefetch_buffer_ TF_GUARDED_BY(mu_);
+      bool cancelled_ TF_GUARDED_BY(mu_) = false;
     };  // MemoryReaderIterator
 
     Status InitializeIterator(IteratorContext* ctx)
@@ -1017,6 +1205,8 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
   mutable mutex mu_;
   const DatasetBase* const input_;
   const std::shared_ptr<MemoryCache> cache_;
+  // The number of bytes of elements to hold in memory, or 0 for no limit.
+  const int64_t memory_budget_;
   mutable std::unique_ptr<PartialCache> partial_cache_ TF_GUARDED_BY(mu_);
 };  // MemoryDatasetBase
 
@@ -1026,8 +1216,9 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
 class CacheDatasetOp::MemoryDataset : public CacheDatasetOp::MemoryDatasetBase {
  public:
   MemoryDataset(OpKernelContext* ctx, const DatasetBase* input,
-                MemoryCacheManager* manager, ResourceHandle&& resource_handle)
-      : MemoryDatasetBase(ctx, input, manager->get()),
+                MemoryCacheManager* manager, ResourceHandle&& resource_handle,
+                int64_t memory_budget)
+      : MemoryDatasetBase(ctx, input, manager->get(), memory_budget),
         manager_(manager),
         resource_handle_(std::move(resource_handle)),
         resource_mgr_(ctx->resource_manager()) {}
@@ -1049,8 +1240,11 @@ class CacheDatasetOp::MemoryDataset : public CacheDatasetOp::MemoryDatasetBase {
     TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_node));
     Node* filename_node = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(tstring(""), &filename_node));
-    TF_RETURN_IF_ERROR(
-        b->AddDataset(this, {input_node, filename_node}, output));
+    AttrValue memory_budget;
+    b->BuildAttrValue(memory_budget_, &memory_budget);
+    TF_RETURN_IF_ERROR(b->AddDataset(this, {input_node, filename_node},
+                                     {{kMemoryBudget, memory_budget}},
+                                     output));
     return Status::OK();
   }
 
@@ -1068,8 +1262,8 @@ class CacheDatasetOp::MemoryDatasetV2
  public:
   MemoryDatasetV2(OpKernelContext* ctx, const DatasetBase* input,
                   MemoryCacheManager* manager, ResourceHandle&& resource_handle,
-                  bool owns_resource)
-      : MemoryDatasetBase(ctx, input, manager->get()),
+                  bool owns_resource, int64_t memory_budget)
+      : MemoryDatasetBase(ctx, input, manager->get(), memory_budget),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -1098,8 +1292,11 @@ class CacheDatasetOp::MemoryDatasetV2
     Tensor handle(DT_RESOURCE, TensorShape({}));
     handle.scalar<ResourceHandle>()() = resource_handle_;
     TF_RETURN_IF_ERROR(b->AddTensor(handle, &resource_handle_node));
-    TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {input_node, filename_node, resource_handle_node}, output));
+    AttrValue memory_budget;
+    b->BuildAttrValue(memory_budget_, &memory_budget);
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this, {input_node, filename_node, resource_handle_node},
+                      {{kMemoryBudget, memory_budget}}, output));
     return Status::OK();
   }
 
@@ -1112,7 +1309,13 @@ class CacheDatasetOp::MemoryDatasetV2
 
 CacheDatasetOp::CacheDatasetOp(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kMemoryBudget, &memory_budget_));
+  OP_REQUIRES(ctx, memory_budget_ >= 0,
+              errors::InvalidArgument("`memory_budget` must be non-negative, "
+                                      "but got ",
+                                      memory_budget_));
+}
 
 void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                                  DatasetBase** output) {
@@ -1145,7 +1348,7 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       }
       // Ownership of manager is transferred onto `MemoryDatasetV2`.
       *output = new MemoryDatasetV2(ctx, input, manager, std::move(handle),
-                                    owns_resource);
+                                    owns_resource, memory_budget_);
     } else {
       MemoryCacheManager* manager;
       OP_REQUIRES_OK(
@@ -1157,7 +1360,8 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       auto handle =
           MakeResourceHandle<MemoryCacheManager>(ctx, container, name);
       // Ownership of manager is transferred onto `MemoryDataset`.
-      *output = new MemoryDataset(ctx, input, manager, std::move(handle));
+      *output = new MemoryDataset(ctx, input, manager, std::move(handle),
+                                  memory_budget_);
     }
   } else {
     if (op_version_ == 2) {
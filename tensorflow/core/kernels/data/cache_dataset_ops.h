@@ -30,6 +30,7 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
   static constexpr const char* const kFileName = "filename";
   static constexpr const char* const kOutputTypes = "output_types";
   static constexpr const char* const kOutputShapes = "output_shapes";
+  static constexpr const char* const kMemoryBudget = "memory_budget";
 
   explicit CacheDatasetOp(OpKernelConstruction* ctx);
 
@@ -44,6 +45,7 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
   class MemoryDatasetV2;
 
   const int op_version_;
+  int64_t memory_budget_;
 };
 
 }  // namespace data
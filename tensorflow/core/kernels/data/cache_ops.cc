@@ -22,6 +22,9 @@ limitations under the License.
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
 namespace data {
@@ -33,10 +36,37 @@ constexpr char kMemoryCache[] = "MemoryCache";
 
 string MemoryCacheManager::DebugString() const { return kMemoryCache; }
 
+SpilledElements::~SpilledElements() { DeleteFiles(env_, prefix_); }
+
+/* static */
+std::string SpilledElements::Key(int64_t index, size_t component) {
+  return strings::Printf("%020lld_%010zu", static_cast<long long>(index),
+                         component);
+}
+
+/* static */
+void SpilledElements::DeleteFiles(Env* env, const std::string& prefix) {
+  for (const std::string& filename :
+       {MetaFilename(prefix), DataFilename(prefix, 0, 1)}) {
+    if (!env->FileExists(filename).ok()) continue;
+    Status s = env->DeleteFile(filename);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete cache spill file " << filename << ": "
+                   << s.ToString();
+    }
+  }
+}
+
 void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache) {
+  Complete(std::move(cache), nullptr);
+}
+
+void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache,
+                           std::shared_ptr<const SpilledElements> spilled) {
   mutex_lock l(mu_);
   if (!completed_) {
     cache_ = std::move(cache);
+    spilled_ = std::move(spilled);
     completed_ = true;
   }
 }
@@ -50,6 +80,7 @@ void MemoryCache::Reset() {
   mutex_lock l(mu_);
   completed_ = false;
   cache_.clear();
+  spilled_.reset();
 }
 
 const std::vector<Tensor>& MemoryCache::at(int64_t index) {
@@ -63,6 +94,11 @@ size_t MemoryCache::size() {
   return cache_.size();
 }
 
+std::shared_ptr<const SpilledElements> MemoryCache::spilled() {
+  tf_shared_lock l(mu_);
+  return spilled_;
+}
+
 const std::vector<std::vector<Tensor>>& MemoryCache::data() {
   tf_shared_lock l(mu_);
   return cache_;
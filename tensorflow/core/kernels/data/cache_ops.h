@@ -16,17 +16,55 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 namespace data {
 
+// Dataset elements that a memory cache wrote to a local tensor bundle because
+// they did not fit in its memory budget. The bundle files are deleted when the
+// object is destroyed.
+class SpilledElements {
+ public:
+  SpilledElements(Env* env, std::string prefix, int64_t num_elements)
+      : env_(env), prefix_(std::move(prefix)), num_elements_(num_elements) {}
+
+  ~SpilledElements();
+
+  Env* env() const { return env_; }
+
+  // The prefix of the tensor bundle that holds the elements.
+  const std::string& prefix() const { return prefix_; }
+
+  int64_t num_elements() const { return num_elements_; }
+
+  // Returns the tensor bundle key of component `component` of the spilled
+  // element `index`. Keys sort in element and component order.
+  static std::string Key(int64_t index, size_t component);
+
+  // Deletes the files of the tensor bundle with prefix `prefix`, if any.
+  static void DeleteFiles(Env* env, const std::string& prefix);
+
+ private:
+  Env* const env_;
+  const std::string prefix_;
+  const int64_t num_elements_;
+};
+
 // A thread-safe data structure for caching dataset elements.
 //
 // The expected use is that a single `MemoryWriterIterator` populates the
 // cache with dataset elements. Once all elements are cached, the cache can
 // be used by one or more `MemoryReaderIterator`s.
+//
+// If the cache has a memory budget, the elements that come after the budget
+// is exhausted are kept in a `SpilledElements` object instead of in memory.
 class MemoryCache {
  public:
   MemoryCache() = default;
@@ -34,6 +72,11 @@ class MemoryCache {
   // Marks the cache as completed.
   void Complete(std::vector<std::vector<Tensor>>&& cache);
 
+  // Marks the cache as completed. The elements in `cache` are followed by the
+  // elements in `spilled`, which may be nullptr.
+  void Complete(std::vector<std::vector<Tensor>>&& cache,
+                std::shared_ptr<const SpilledElements> spilled);
+
   // Returns whether the cache is completed.
   bool IsCompleted();
 
@@ -43,9 +86,13 @@ class MemoryCache {
   // Returns the element at the given index.
   const std::vector<Tensor>& at(int64_t index);
 
-  // Returns the size of the cache.
+  // Returns the number of elements that are held in memory.
   size_t size();
 
+  // Returns the elements that follow the ones held in memory, or nullptr if
+  // there are none.
+  std::shared_ptr<const SpilledElements> spilled();
+
   // Returns a reference to the cache's data. The returned reference will be
   // invalidated by any call to Reset().
   const std::vector<std::vector<Tensor>>& data();
@@ -55,6 +102,7 @@ class MemoryCache {
   // Determines whether all elements of the dataset have been cached.
   bool completed_ TF_GUARDED_BY(mu_) = false;
   std::vector<std::vector<Tensor>> cache_ TF_GUARDED_BY(mu_);
+  std::shared_ptr<const SpilledElements> spilled_ TF_GUARDED_BY(mu_);
 };
 
 // A resource wrapping a shared instance of a memory cache.
@@ -0,0 +1,584 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/bucket_by_sequence_length_dataset_op.h"
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kInputDataset;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kBucketBoundaries;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kMaxTokensPerBatch;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kSortWindowSize;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kPaddingValues;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kLengthComponent;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kToutputTypes;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kOutputShapes;
+
+namespace {
+
+constexpr char kInputExhausted[] = "input_exhausted";
+constexpr char kWindow[] = "window";
+constexpr char kBucket[] = "bucket";
+constexpr char kMaxLength[] = "max_length";
+constexpr char kNumReadyBatches[] = "num_ready_batches";
+constexpr char kReadyBatch[] = "ready_batch";
+
+}  // namespace
+
+class BucketBySequenceLengthDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input,
+          std::vector<int64_t> bucket_boundaries, int64_t max_tokens_per_batch,
+          int64_t sort_window_size, std::vector<Tensor> padding_values,
+          int64_t length_component)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        bucket_boundaries_(std::move(bucket_boundaries)),
+        max_tokens_per_batch_(max_tokens_per_batch),
+        sort_window_size_(sort_window_size),
+        padding_values_(std::move(padding_values)),
+        length_component_(length_component),
+        traceme_metadata_(
+            {{"max_tokens_per_batch",
+              strings::Printf("%lld",
+                              static_cast<long long>(max_tokens_per_batch))},
+             {"num_buckets",
+              strings::Printf("%lld", static_cast<long long>(
+                                          bucket_boundaries_.size() + 1))},
+             {"sort_window_size",
+              strings::Printf("%lld",
+                              static_cast<long long>(sort_window_size))}}) {
+    input_->Ref();
+
+    // Every dimension is padded to the largest element of the batch, so each
+    // component keeps the rank and the static dimensions of its input.
+    const auto& input_shapes = input_->output_shapes();
+    output_shapes_.reserve(input_shapes.size());
+    for (const PartialTensorShape& input_shape : input_shapes) {
+      output_shapes_.push_back(
+          PartialTensorShape({-1}).Concatenate(input_shape));
+    }
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64_t CardinalityInternal() const override {
+    int64_t n = input_->Cardinality();
+    if (n == kInfiniteCardinality) {
+      return n;
+    }
+    return kUnknownCardinality;
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return Status::OK();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* bucket_boundaries = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(bucket_boundaries_, &bucket_boundaries));
+    Node* max_tokens_per_batch = nullptr;
+    TF_RETURN_IF_ERROR(
+        b->AddScalar(max_tokens_per_batch_, &max_tokens_per_batch));
+    Node* sort_window_size = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(sort_window_size_, &sort_window_size));
+
+    std::vector<Node*> padding_values;
+    padding_values.reserve(padding_values_.size());
+    for (const Tensor& t : padding_values_) {
+      Node* node;
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padding_values.emplace_back(node);
+    }
+
+    AttrValue length_component;
+    b->BuildAttrValue(length_component_, &length_component);
+
+    AttrValue output_types;
+    b->BuildAttrValue(output_dtypes(), &output_types);
+
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this,
+        {{0, input_graph_node},
+         {1, bucket_boundaries},
+         {2, max_tokens_per_batch},
+         {3, sort_window_size}},
+        {{4, padding_values}},
+        {{kLengthComponent, length_component}, {kToutputTypes, output_types}},
+        output));
+    return Status::OK();
+  }
+
+ private:
+  // Returns the length by which `element` is bucketed, i.e. the size of the
+  // 0th dimension of its `length_component_` component.
+  Status ElementLength(const std::vector<Tensor>& element,
+                       int64_t* length) const {
+    const Tensor& t = element[length_component_];
+    if (t.dims() < 1) {
+      return errors::InvalidArgument(
+          "Component ", length_component_,
+          " of the input elements must have rank at least 1 to be bucketed "
+          "by its length, but got an element with shape ",
+          t.shape().DebugString());
+    }
+    *length = t.dim_size(0);
+    return Status::OK();
+  }
+
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          buckets_(params.dataset->bucket_boundaries_.size() + 1) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      std::vector<std::vector<Tensor>> batch_elements;
+      {
+        mutex_lock l(mu_);
+        while (ready_batches_.empty() && input_impl_) {
+          std::vector<Tensor> element;
+          bool end_of_input;
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, &element, &end_of_input));
+          if (end_of_input) {
+            input_impl_.reset();
+            FlushWindow();
+            for (Bucket& bucket : buckets_) {
+              if (!bucket.elements.empty()) {
+                EmitBucket(&bucket);
+              }
+            }
+            break;
+          }
+          int64_t length;
+          TF_RETURN_IF_ERROR(dataset()->ElementLength(element, &length));
+          if (dataset()->sort_window_size_ > 1) {
+            window_.push_back(std::move(element));
+            if (window_.size() >=
+                static_cast<size_t>(dataset()->sort_window_size_)) {
+              FlushWindow();
+            }
+          } else {
+            AddToBucket(std::move(element), length);
+          }
+        }
+        if (ready_batches_.empty()) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        batch_elements = std::move(ready_batches_.front());
+        ready_batches_.pop_front();
+      }
+      *end_of_sequence = false;
+      return CopyBatch(ctx, batch_elements, out_tensors);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeUnknownRatioNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      if (input_impl_) {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      } else {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(kInputExhausted), ""));
+      }
+      TF_RETURN_IF_ERROR(SaveElements(writer, full_name(kWindow), window_));
+      for (int i = 0; i < buckets_.size(); ++i) {
+        const string name = full_name(strings::StrCat(kBucket, "[", i, "]"));
+        TF_RETURN_IF_ERROR(
+            SaveElements(writer, name, buckets_[i].elements));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            strings::StrCat(name, "_", kMaxLength), buckets_[i].max_length));
+      }
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kNumReadyBatches),
+                                             ready_batches_.size()));
+      for (int i = 0; i < ready_batches_.size(); ++i) {
+        TF_RETURN_IF_ERROR(SaveElements(
+            writer, full_name(strings::StrCat(kReadyBatch, "[", i, "]")),
+            ready_batches_[i]));
+      }
+      return Status::OK();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      if (reader->Contains(full_name(kInputExhausted))) {
+        input_impl_.reset();
+      } else {
+        TF_RETURN_IF_ERROR(
+            dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      }
+      TF_RETURN_IF_ERROR(
+          RestoreElements(ctx, reader, full_name(kWindow), &window_));
+      for (int i = 0; i < buckets_.size(); ++i) {
+        const string name = full_name(strings::StrCat(kBucket, "[", i, "]"));
+        TF_RETURN_IF_ERROR(
+            RestoreElements(ctx, reader, name, &buckets_[i].elements));
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(strings::StrCat(name, "_", kMaxLength),
+                               &buckets_[i].max_length));
+      }
+      int64_t num_ready_batches;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kNumReadyBatches),
+                                            &num_ready_batches));
+      ready_batches_.clear();
+      ready_batches_.resize(num_ready_batches);
+      for (int i = 0; i < num_ready_batches; ++i) {
+        TF_RETURN_IF_ERROR(RestoreElements(
+            ctx, reader, full_name(strings::StrCat(kReadyBatch, "[", i, "]")),
+            &ready_batches_[i]));
+      }
+      return Status::OK();
+    }
+
+    TraceMeMetadata GetTraceMeMetadata() const override {
+      return dataset()->traceme_metadata_;
+    }
+
+   private:
+    // The elements of a bucket that has not been emitted yet, and the largest
+    // length among them.
+    struct Bucket {
+      std::vector<std::vector<Tensor>> elements;
+      int64_t max_length = 0;
+    };
+
+    // Adds `element` to the bucket of its length. A bucket is emitted as soon
+    // as its padded size reaches `max_tokens_per_batch`, or before it takes
+    // an element that would make it exceed that size.
+    void AddToBucket(std::vector<Tensor> element, int64_t length)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const std::vector<int64_t>& boundaries = dataset()->bucket_boundaries_;
+      const size_t index =
+          std::upper_bound(boundaries.begin(), boundaries.end(), length) -
+          boundaries.begin();
+      Bucket& bucket = buckets_[index];
+      const int64_t max_tokens = dataset()->max_tokens_per_batch_;
+      // Empty sequences still take a row of the batch.
+      const int64_t tokens = std::max<int64_t>(length, 1);
+      const int64_t num_elements = bucket.elements.size();
+      if (num_elements > 0 &&
+          (num_elements + 1) * std::max(bucket.max_length, tokens) >
+              max_tokens) {
+        EmitBucket(&bucket);
+      }
+      bucket.elements.push_back(std::move(element));
+      bucket.max_length = std::max(bucket.max_length, tokens);
+      if (static_cast<int64_t>(bucket.elements.size()) * bucket.max_length >=
+          max_tokens) {
+        EmitBucket(&bucket);
+      }
+    }
+
+    // Sorts the elements of the window by their length, so that elements of
+    // similar length are batched together, and adds them to their buckets.
+    void FlushWindow() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64_t length_component = dataset()->length_component_;
+      std::stable_sort(window_.begin(), window_.end(),
+                       [length_component](const std::vector<Tensor>& a,
+                                          const std::vector<Tensor>& b) {
+                         return a[length_component].dim_size(0) <
+                                b[length_component].dim_size(0);
+                       });
+      for (std::vector<Tensor>& element : window_) {
+        const int64_t length = element[length_component].dim_size(0);
+        AddToBucket(std::move(element), length);
+      }
+      window_.clear();
+    }
+
+    void EmitBucket(Bucket* bucket) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      ready_batches_.push_back(std::move(bucket->elements));
+      bucket->elements.clear();
+      bucket->max_length = 0;
+    }
+
+    // Copies the elements of a batch into one output tensor per tuple
+    // component, padding every dimension to the largest element.
+    Status CopyBatch(IteratorContext* ctx,
+                     const std::vector<std::vector<Tensor>>& batch_elements,
+                     std::vector<Tensor>* out_tensors) {
+      const size_t num_tuple_components = batch_elements[0].size();
+      const int64_t num_batch_elements = batch_elements.size();
+      for (size_t component_index = 0; component_index < num_tuple_components;
+           ++component_index) {
+        const int rank = batch_elements[0][component_index].dims();
+        TensorShape batch_component_shape({num_batch_elements});
+        for (int dim = 0; dim < rank; ++dim) {
+          batch_component_shape.AddDim(0);
+        }
+        for (int64_t i = 0; i < num_batch_elements; ++i) {
+          const TensorShape& element_shape =
+              batch_elements[i][component_index].shape();
+          if (element_shape.dims() != rank) {
+            return errors::InvalidArgument(
+                "All elements in a batch must have the same rank for "
+                "component ",
+                component_index, ": expected rank ", rank,
+                " but got element with rank ", element_shape.dims());
+          }
+          for (int dim = 0; dim < rank; ++dim) {
+            if (element_shape.dim_size(dim) >
+                batch_component_shape.dim_size(dim + 1)) {
+              batch_component_shape.set_dim(dim + 1,
+                                            element_shape.dim_size(dim));
+            }
+          }
+        }
+
+        out_tensors->emplace_back(ctx->allocator({}),
+                                  output_dtypes()[component_index],
+                                  batch_component_shape);
+        Tensor& batch_component = out_tensors->back();
+        TF_RETURN_IF_ERROR(batch_util::SetElementZero(
+            &batch_component, dataset()->padding_values_[component_index]));
+
+        TensorShape component_shape(batch_component_shape);
+        component_shape.RemoveDim(0);
+        for (int64_t i = 0; i < num_batch_elements; ++i) {
+          const Tensor& element = batch_elements[i][component_index];
+          // Take the fast path if possible.
+          if (element.shape() == component_shape) {
+            TF_RETURN_IF_ERROR(
+                batch_util::CopyElementToSlice(element, &batch_component, i));
+          } else {
+            TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
+                element, &batch_component, i));
+          }
+        }
+      }
+      return Status::OK();
+    }
+
+    Status SaveElements(IteratorStateWriter* writer, const string& name,
+                        const std::vector<std::vector<Tensor>>& elements)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      TF_RETURN_IF_ERROR(writer->WriteScalar(strings::StrCat(name, "_size"),
+                                             elements.size()));
+      for (int i = 0; i < elements.size(); ++i) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            strings::StrCat(name, "[", i, "]_size"), elements[i].size()));
+        for (int j = 0; j < elements[i].size(); ++j) {
+          TF_RETURN_IF_ERROR(writer->WriteTensor(
+              strings::StrCat(name, "[", i, "][", j, "]"), elements[i][j]));
+        }
+      }
+      return Status::OK();
+    }
+
+    Status RestoreElements(IteratorContext* ctx, IteratorStateReader* reader,
+                           const string& name,
+                           std::vector<std::vector<Tensor>>* elements)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      int64_t num_elements;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(strings::StrCat(name, "_size"), &num_elements));
+      elements->clear();
+      elements->resize(num_elements);
+      for (int i = 0; i < num_elements; ++i) {
+        int64_t num_components;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            strings::StrCat(name, "[", i, "]_size"), &num_components));
+        (*elements)[i].resize(num_components);
+        for (int j = 0; j < num_components; ++j) {
+          TF_RETURN_IF_ERROR(reader->ReadTensor(
+              ctx->flr(), strings::StrCat(name, "[", i, "][", j, "]"),
+              &(*elements)[i][j]));
+        }
+      }
+      return Status::OK();
+    }
+
+    mutex mu_;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    // Elements that wait to be sorted by length, if `sort_window_size` > 1.
+    std::vector<std::vector<Tensor>> window_ TF_GUARDED_BY(mu_);
+    // One bucket per interval between the bucket boundaries.
+    std::vector<Bucket> buckets_ TF_GUARDED_BY(mu_);
+    // Full buckets, in the order they were emitted.
+    std::deque<std::vector<std::vector<Tensor>>> ready_batches_
+        TF_GUARDED_BY(mu_);
+  };
+
+  const DatasetBase* const input_;
+  const std::vector<int64_t> bucket_boundaries_;
+  const int64_t max_tokens_per_batch_;
+  const int64_t sort_window_size_;
+  const std::vector<Tensor> padding_values_;
+  const int64_t length_component_;
+  std::vector<PartialTensorShape> output_shapes_;
+  const TraceMeMetadata traceme_metadata_;
+};
+
+BucketBySequenceLengthDatasetOp::BucketBySequenceLengthDatasetOp(
+    OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kLengthComponent, &length_component_));
+}
+
+void BucketBySequenceLengthDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                                  DatasetBase* input,
+                                                  DatasetBase** output) {
+  const int64_t num_components = input->output_dtypes().size();
+  OP_REQUIRES(
+      ctx, length_component_ < num_components,
+      errors::InvalidArgument("`length_component` (", length_component_,
+                              ") must be less than the number of components "
+                              "in the input dataset's elements (",
+                              num_components, ")"));
+  const PartialTensorShape& length_shape =
+      input->output_shapes()[length_component_];
+  OP_REQUIRES(ctx, length_shape.unknown_rank() || length_shape.dims() > 0,
+              errors::InvalidArgument(
+                  "Component ", length_component_,
+                  " of the input dataset's elements must have rank at least "
+                  "1 to be bucketed by its length, but has shape ",
+                  length_shape.DebugString()));
+
+  std::vector<int64_t> bucket_boundaries;
+  OP_REQUIRES_OK(ctx, ParseVectorArgument<int64_t>(ctx, kBucketBoundaries,
+                                                   &bucket_boundaries));
+  for (size_t i = 0; i < bucket_boundaries.size(); ++i) {
+    OP_REQUIRES(ctx, bucket_boundaries[i] > 0,
+                errors::InvalidArgument(
+                    "Bucket boundaries must be greater than zero."));
+    OP_REQUIRES(
+        ctx, i == 0 || bucket_boundaries[i - 1] < bucket_boundaries[i],
+        errors::InvalidArgument("Bucket boundaries must be strictly "
+                                "increasing, but got ",
+                                bucket_boundaries[i - 1], " before ",
+                                bucket_boundaries[i]));
+  }
+
+  int64_t max_tokens_per_batch;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kMaxTokensPerBatch,
+                                                   &max_tokens_per_batch));
+  OP_REQUIRES(ctx, max_tokens_per_batch > 0,
+              errors::InvalidArgument(
+                  "Maximum number of tokens per batch must be greater than "
+                  "zero."));
+
+  int64_t sort_window_size;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kSortWindowSize,
+                                                   &sort_window_size));
+  OP_REQUIRES(ctx, sort_window_size >= 0,
+              errors::InvalidArgument(
+                  "Sort window size must be greater than or equal to zero."));
+
+  OpInputList padding_values_list;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddingValues, &padding_values_list));
+  OP_REQUIRES(ctx, padding_values_list.size() == input->output_dtypes().size(),
+              errors::InvalidArgument(
+                  "Number of padding values (", padding_values_list.size(),
+                  ") must match the number of components in the input "
+                  "dataset's elements (",
+                  input->output_dtypes().size(), ")"));
+  std::vector<Tensor> padding_values;
+  padding_values.reserve(padding_values_list.size());
+  for (int i = 0; i < padding_values_list.size(); ++i) {
+    const Tensor& padding_value_t = padding_values_list[i];
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(padding_value_t.shape()),
+                errors::InvalidArgument("All padding values must be scalars"));
+    OP_REQUIRES(ctx, padding_value_t.dtype() == input->output_dtypes()[i],
+                errors::InvalidArgument(
+                    "Mismatched type between padding value ", i,
+                    " and input dataset's component ", i, ": ",
+                    DataTypeString(padding_value_t.dtype()), " vs. ",
+                    DataTypeString(input->output_dtypes()[i])));
+    padding_values.push_back(tensor::DeepCopy(padding_value_t));
+  }
+
+  *output = new Dataset(ctx, input, std::move(bucket_boundaries),
+                        max_tokens_per_batch, sort_window_size,
+                        std::move(padding_values), length_component_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(
+    Name("BucketBySequenceLengthDataset").Device(DEVICE_CPU),
+    BucketBySequenceLengthDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
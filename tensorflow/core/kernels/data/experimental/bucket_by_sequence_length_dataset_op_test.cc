@@ -0,0 +1,308 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/bucket_by_sequence_length_dataset_op.h"
+
+#include "tensorflow/core/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "bucket_by_sequence_length_dataset";
+
+class BucketBySequenceLengthDatasetOpTest : public DatasetOpsTestBase {};
+
+class BucketBySequenceLengthDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  BucketBySequenceLengthDatasetParams(
+      T input_dataset_params, std::vector<int64_t> bucket_boundaries,
+      int64_t max_tokens_per_batch, int64_t sort_window_size,
+      std::vector<Tensor> padding_values, int64_t length_component,
+      DataTypeVector output_dtypes,
+      std::vector<PartialTensorShape> output_shapes, string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        bucket_boundaries_(std::move(bucket_boundaries)),
+        max_tokens_per_batch_(max_tokens_per_batch),
+        sort_window_size_(sort_window_size),
+        padding_values_(std::move(padding_values)),
+        length_component_(length_component) {
+    input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    std::vector<Tensor> input_tensors;
+    input_tensors.emplace_back(CreateTensor<int64_t>(
+        TensorShape({static_cast<int64_t>(bucket_boundaries_.size())}),
+        bucket_boundaries_));
+    input_tensors.emplace_back(
+        CreateTensor<int64_t>(TensorShape({}), {max_tokens_per_batch_}));
+    input_tensors.emplace_back(
+        CreateTensor<int64_t>(TensorShape({}), {sort_window_size_}));
+    for (auto& padding_value : padding_values_) {
+      input_tensors.emplace_back(padding_value);
+    }
+    return input_tensors;
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {BucketBySequenceLengthDatasetOp::kInputDataset,
+                    BucketBySequenceLengthDatasetOp::kBucketBoundaries,
+                    BucketBySequenceLengthDatasetOp::kMaxTokensPerBatch,
+                    BucketBySequenceLengthDatasetOp::kSortWindowSize};
+    for (int i = 0; i < padding_values_.size(); ++i) {
+      input_names->emplace_back(strings::StrCat(
+          BucketBySequenceLengthDatasetOp::kPaddingValues, "_", i));
+    }
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{"length_component", length_component_},
+                    {"Toutput_types", output_dtypes_},
+                    {"output_shapes", output_shapes_},
+                    {"metadata", ""}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override {
+    return BucketBySequenceLengthDatasetOp::kDatasetType;
+  }
+
+ private:
+  std::vector<int64_t> bucket_boundaries_;
+  int64_t max_tokens_per_batch_;
+  int64_t sort_window_size_;
+  std::vector<Tensor> padding_values_;
+  int64_t length_component_;
+};
+
+// Two sequences of length 3 followed by two sequences of length 1.
+ConcatenateDatasetParams SequenceDatasetParams() {
+  auto tensor_slice_dataset_params_0 = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64_t>(TensorShape{2, 3},
+                                            {{0, 1, 2, 3, 4, 5}}),
+      /*node_name=*/"tensor_slice_0");
+  auto tensor_slice_dataset_params_1 = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64_t>(TensorShape{2, 1}, {{6, 7}}),
+      /*node_name=*/"tensor_slice_1");
+  return ConcatenateDatasetParams(std::move(tensor_slice_dataset_params_0),
+                                  std::move(tensor_slice_dataset_params_1),
+                                  /*output_dtypes=*/{DT_INT64},
+                                  /*output_shapes=*/{PartialTensorShape({-1})},
+                                  /*node_name=*/"concatenate");
+}
+
+BucketBySequenceLengthDatasetParams SequenceBucketingParams(
+    std::vector<int64_t> bucket_boundaries, int64_t max_tokens_per_batch,
+    int64_t sort_window_size) {
+  return BucketBySequenceLengthDatasetParams(
+      /*input_dataset_params=*/SequenceDatasetParams(),
+      /*bucket_boundaries=*/std::move(bucket_boundaries),
+      /*max_tokens_per_batch=*/max_tokens_per_batch,
+      /*sort_window_size=*/sort_window_size,
+      /*padding_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*length_component=*/0,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+// Test case 1: the sequences of each length fill their own bucket.
+BucketBySequenceLengthDatasetParams BucketBySequenceLengthDatasetParams1() {
+  return SequenceBucketingParams(/*bucket_boundaries=*/{2},
+                                 /*max_tokens_per_batch=*/6,
+                                 /*sort_window_size=*/0);
+}
+
+// Test case 2: a single bucket, whose sequences are sorted by their length
+// before the token budget splits them into batches.
+BucketBySequenceLengthDatasetParams BucketBySequenceLengthDatasetParams2() {
+  return SequenceBucketingParams(/*bucket_boundaries=*/{},
+                                 /*max_tokens_per_batch=*/6,
+                                 /*sort_window_size=*/4);
+}
+
+// Test case 3: a single batch that pads the shorter sequences.
+BucketBySequenceLengthDatasetParams BucketBySequenceLengthDatasetParams3() {
+  return SequenceBucketingParams(/*bucket_boundaries=*/{},
+                                 /*max_tokens_per_batch=*/100,
+                                 /*sort_window_size=*/0);
+}
+
+BucketBySequenceLengthDatasetParams
+BucketBySequenceLengthDatasetParamsWithInvalidBoundaries() {
+  return SequenceBucketingParams(/*bucket_boundaries=*/{3, 2},
+                                 /*max_tokens_per_batch=*/6,
+                                 /*sort_window_size=*/0);
+}
+
+BucketBySequenceLengthDatasetParams
+BucketBySequenceLengthDatasetParamsWithInvalidMaxTokens() {
+  return SequenceBucketingParams(/*bucket_boundaries=*/{2},
+                                 /*max_tokens_per_batch=*/0,
+                                 /*sort_window_size=*/0);
+}
+
+BucketBySequenceLengthDatasetParams
+BucketBySequenceLengthDatasetParamsWithInvalidSortWindowSize() {
+  return SequenceBucketingParams(/*bucket_boundaries=*/{2},
+                                 /*max_tokens_per_batch=*/6,
+                                 /*sort_window_size=*/-1);
+}
+
+BucketBySequenceLengthDatasetParams
+BucketBySequenceLengthDatasetParamsWithInvalidLengthComponent() {
+  return BucketBySequenceLengthDatasetParams(
+      /*input_dataset_params=*/SequenceDatasetParams(),
+      /*bucket_boundaries=*/{2},
+      /*max_tokens_per_batch=*/6,
+      /*sort_window_size=*/0,
+      /*padding_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*length_component=*/1,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+BucketBySequenceLengthDatasetParams
+BucketBySequenceLengthDatasetParamsWithScalarInput() {
+  return BucketBySequenceLengthDatasetParams(
+      /*input_dataset_params=*/RangeDatasetParams(0, 10, 1),
+      /*bucket_boundaries=*/{2},
+      /*max_tokens_per_batch=*/6,
+      /*sort_window_size=*/0,
+      /*padding_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*length_component=*/0,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1})},
+      /*node_name=*/kNodeName);
+}
+
+BucketBySequenceLengthDatasetParams
+BucketBySequenceLengthDatasetParamsWithInvalidPaddingValuesDType() {
+  return BucketBySequenceLengthDatasetParams(
+      /*input_dataset_params=*/SequenceDatasetParams(),
+      /*bucket_boundaries=*/{2},
+      /*max_tokens_per_batch=*/6,
+      /*sort_window_size=*/0,
+      /*padding_values=*/{CreateTensor<tstring>(TensorShape{}, {"a"})},
+      /*length_component=*/0,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+std::vector<GetNextTestCase<BucketBySequenceLengthDatasetParams>>
+GetNextTestCases() {
+  return {{/*dataset_params=*/BucketBySequenceLengthDatasetParams1(),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{2, 3}, {0, 1, 2, 3, 4, 5}),
+            CreateTensor<int64_t>(TensorShape{2, 1}, {6, 7})}},
+          {/*dataset_params=*/BucketBySequenceLengthDatasetParams2(),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{2, 1}, {6, 7}),
+            CreateTensor<int64_t>(TensorShape{2, 3}, {0, 1, 2, 3, 4, 5})}},
+          {/*dataset_params=*/BucketBySequenceLengthDatasetParams3(),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{4, 3},
+                                  {0, 1, 2, 3, 4, 5, 6, -1, -1, 7, -1, -1})}}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(BucketBySequenceLengthDatasetOpTest,
+                         BucketBySequenceLengthDatasetParams,
+                         GetNextTestCases())
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = BucketBySequenceLengthDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = BucketBySequenceLengthDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(BucketBySequenceLengthDatasetOp::kDatasetType)));
+}
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, DatasetOutputShapes) {
+  auto dataset_params = BucketBySequenceLengthDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputShapes({PartialTensorShape({-1, -1})}));
+}
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, Cardinality) {
+  auto dataset_params = BucketBySequenceLengthDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(kUnknownCardinality));
+}
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, IteratorPrefix) {
+  auto dataset_params = BucketBySequenceLengthDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorPrefix(
+      name_utils::IteratorPrefix(BucketBySequenceLengthDatasetOp::kDatasetType,
+                                 dataset_params.iterator_prefix())));
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<BucketBySequenceLengthDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/BucketBySequenceLengthDatasetParams1(),
+           /*breakpoints=*/{0, 1, 3},
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{2, 3}, {0, 1, 2, 3, 4, 5}),
+            CreateTensor<int64_t>(TensorShape{2, 1}, {6, 7})}},
+          {/*dataset_params=*/BucketBySequenceLengthDatasetParams2(),
+           /*breakpoints=*/{0, 1, 3},
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{2, 1}, {6, 7}),
+            CreateTensor<int64_t>(TensorShape{2, 3}, {0, 1, 2, 3, 4, 5})}}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(BucketBySequenceLengthDatasetOpTest,
+                                 BucketBySequenceLengthDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+class ParameterizedInvalidArgumentTest
+    : public BucketBySequenceLengthDatasetOpTest,
+      public ::testing::WithParamInterface<
+          BucketBySequenceLengthDatasetParams> {};
+
+TEST_P(ParameterizedInvalidArgumentTest, InvalidArguments) {
+  auto dataset_params = GetParam();
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    BucketBySequenceLengthDatasetOpTest, ParameterizedInvalidArgumentTest,
+    ::testing::ValuesIn(
+        {BucketBySequenceLengthDatasetParamsWithInvalidBoundaries(),
+         BucketBySequenceLengthDatasetParamsWithInvalidMaxTokens(),
+         BucketBySequenceLengthDatasetParamsWithInvalidSortWindowSize(),
+         BucketBySequenceLengthDatasetParamsWithInvalidLengthComponent(),
+         BucketBySequenceLengthDatasetParamsWithScalarInput(),
+         BucketBySequenceLengthDatasetParamsWithInvalidPaddingValuesDType()}));
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,264 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/columnar_dataset_op.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/data/columnar_format.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/utils.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/protobuf.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const ColumnarDatasetOp::kDatasetType;
+/* static */ constexpr const char* const ColumnarDatasetOp::kFileNames;
+/* static */ constexpr const char* const ColumnarDatasetOp::kColumns;
+
+namespace {
+
+constexpr char kCurrentFileIndex[] = "current_file_index";
+constexpr char kRow[] = "row";
+
+}  // namespace
+
+class ColumnarDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+          std::vector<string> columns)
+      : DatasetBase(DatasetContext(ctx)),
+        filenames_(std::move(filenames)),
+        columns_(std::move(columns)),
+        sorted_columns_(columns_) {
+    // Reading the columns in file order keeps the reads of a chunk
+    // sequential.
+    std::sort(sorted_columns_.begin(), sorted_columns_.end());
+    sorted_columns_.erase(
+        std::unique(sorted_columns_.begin(), sorted_columns_.end()),
+        sorted_columns_.end());
+  }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    static DataTypeVector* dtypes = new DataTypeVector({DT_STRING});
+    return *dtypes;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    static std::vector<PartialTensorShape>* shapes =
+        new std::vector<PartialTensorShape>({{}});
+    return *shapes;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    return Status::OK();
+  }
+
+  Status CheckExternalState() const override { return Status::OK(); }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* filenames = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+    AttrValue columns;
+    b->BuildAttrValue(columns_, &columns);
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this, {filenames}, {{kColumns, columns}}, output));
+    return Status::OK();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      while (true) {
+        if (reader_ && row_ < reader_->num_rows()) {
+          const int64_t rows_per_chunk = reader_->rows_per_chunk();
+          if (chunk_index_ != row_ / rows_per_chunk) {
+            Status s = ReadChunkLocked(row_ / rows_per_chunk);
+            if (!s.ok()) {
+              // Move on to the next file so that the iterator works with
+              // `ignore_errors`, as for files that fail to open below.
+              ResetReaderLocked();
+              ++current_file_index_;
+              return s;
+            }
+          }
+          out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                    TensorShape({}));
+          tstring& record = out_tensors->back().scalar<tstring>()();
+          SerializeToTString(chunk_[row_ % rows_per_chunk], &record);
+          static monitoring::CounterCell* bytes_counter =
+              metrics::GetTFDataBytesReadCounter(kDatasetType);
+          bytes_counter->IncrementBy(record.size());
+          ++row_;
+          *end_of_sequence = false;
+          return Status::OK();
+        }
+        if (reader_) {
+          ResetReaderLocked();
+          ++current_file_index_;
+        }
+        if (current_file_index_ == dataset()->filenames_.size()) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        Status s = OpenReaderLocked(ctx->env());
+        if (!s.ok()) {
+          ++current_file_index_;
+          return s;
+        }
+        row_ = 0;
+      }
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCurrentFileIndex),
+                                             current_file_index_));
+      if (reader_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kRow), row_));
+      }
+      return Status::OK();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      ResetReaderLocked();
+      int64_t current_file_index;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kCurrentFileIndex),
+                                            &current_file_index));
+      current_file_index_ = current_file_index;
+      if (reader->Contains(full_name(kRow))) {
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kRow), &row_));
+        TF_RETURN_IF_ERROR(OpenReaderLocked(ctx->env()));
+      }
+      return Status::OK();
+    }
+
+   private:
+    // Opens the file at `current_file_index_`.
+    Status OpenReaderLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (current_file_index_ >= dataset()->filenames_.size()) {
+        return errors::InvalidArgument(
+            "current_file_index_:", current_file_index_,
+            " >= filenames_.size():", dataset()->filenames_.size());
+      }
+      return ColumnarReader::Open(
+          env, TranslateFileName(dataset()->filenames_[current_file_index_]),
+          &reader_);
+    }
+
+    // Reads the projected columns of chunk `chunk_index` of the current
+    // file.
+    Status ReadChunkLocked(int64_t chunk_index)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      chunk_index_ = -1;
+      TF_RETURN_IF_ERROR(
+          reader_->ReadChunk(chunk_index, dataset()->sorted_columns_, &chunk_));
+      chunk_index_ = chunk_index;
+      return Status::OK();
+    }
+
+    void ResetReaderLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      reader_.reset();
+      chunk_.clear();
+      chunk_index_ = -1;
+    }
+
+    mutex mu_;
+    size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
+    std::unique_ptr<ColumnarReader> reader_ TF_GUARDED_BY(mu_);
+    // The next row of the current file.
+    int64_t row_ TF_GUARDED_BY(mu_) = 0;
+    // The rows of chunk `chunk_index_` of the current file, or -1 if no chunk
+    // is buffered.
+    int64_t chunk_index_ TF_GUARDED_BY(mu_) = -1;
+    std::vector<Example> chunk_ TF_GUARDED_BY(mu_);
+  };
+
+  const std::vector<string> filenames_;
+  // The features to read, or all features if empty, as given to the op and
+  // as read from the files.
+  const std::vector<string> columns_;
+  std::vector<string> sorted_columns_;
+};
+
+ColumnarDatasetOp::ColumnarDatasetOp(OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kColumns, &columns_));
+}
+
+void ColumnarDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                    DatasetBase** output) {
+  const Tensor* filenames_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kFileNames, &filenames_tensor));
+  OP_REQUIRES(
+      ctx, filenames_tensor->dims() <= 1,
+      errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+  std::vector<string> filenames;
+  filenames.reserve(filenames_tensor->NumElements());
+  for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+    filenames.push_back(filenames_tensor->flat<tstring>()(i));
+    metrics::RecordTFDataFilename(kDatasetType, filenames[i]);
+  }
+  *output = new Dataset(ctx, std::move(filenames), columns_);
+}
+
+namespace {
+
+REGISTER_KERNEL_BUILDER(Name("ColumnarDataset").Device(DEVICE_CPU),
+                        ColumnarDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
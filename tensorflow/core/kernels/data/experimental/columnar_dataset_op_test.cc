@@ -0,0 +1,165 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/columnar_dataset_op.h"
+
+#include "tensorflow/core/data/columnar_format.h"
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "columnar_dataset";
+
+class ColumnarDatasetParams : public DatasetParams {
+ public:
+  ColumnarDatasetParams(std::vector<tstring> filenames,
+                        std::vector<string> columns, string node_name)
+      : DatasetParams({DT_STRING}, {PartialTensorShape({})},
+                      std::move(node_name)),
+        filenames_(std::move(filenames)),
+        columns_(std::move(columns)) {}
+
+  std::vector<Tensor> GetInputTensors() const override {
+    int num_files = filenames_.size();
+    return {CreateTensor<tstring>(TensorShape({num_files}), filenames_)};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {ColumnarDatasetOp::kFileNames};
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{ColumnarDatasetOp::kColumns, columns_}, {"metadata", ""}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override {
+    return ColumnarDatasetOp::kDatasetType;
+  }
+
+ private:
+  std::vector<tstring> filenames_;
+  std::vector<string> columns_;
+};
+
+class ColumnarDatasetOpTest : public DatasetOpsTestBase {};
+
+// Row `i` has an int64 "a" and a bytes "b". With `only_a`, only "a" is set.
+Example MakeExample(int64_t i, bool only_a) {
+  Example example;
+  auto& features = *example.mutable_features()->mutable_feature();
+  features["a"].mutable_int64_list()->add_value(i);
+  if (!only_a) {
+    features["b"].mutable_bytes_list()->add_value(strings::StrCat("b", i));
+  }
+  return example;
+}
+
+// The number of rows of each test file.
+std::vector<int64_t> TestFileSizes() { return {5, 0, 2}; }
+
+ColumnarDatasetParams MakeParams(const string& prefix,
+                                 std::vector<string> columns) {
+  std::vector<tstring> filenames;
+  int64_t row = 0;
+  for (int i = 0; i < TestFileSizes().size(); ++i) {
+    filenames.push_back(absl::StrCat(testing::TmpDir(), "/", prefix, "_", i));
+    std::unique_ptr<ColumnarWriter> writer;
+    Status s = ColumnarWriter::Create(Env::Default(), filenames.back(),
+                                      /*rows_per_chunk=*/2, &writer);
+    for (int64_t j = 0; s.ok() && j < TestFileSizes()[i]; ++j) {
+      s = writer->Write(MakeExample(row++, /*only_a=*/false));
+    }
+    if (s.ok()) s = writer->Close();
+    if (!s.ok()) {
+      VLOG(WARNING) << "Failed to create the test file " << filenames.back()
+                    << ": " << s;
+    }
+  }
+  return ColumnarDatasetParams(filenames, std::move(columns), kNodeName);
+}
+
+ColumnarDatasetParams ProjectedParams() {
+  return MakeParams("columnar_projected", {"a", "missing"});
+}
+
+std::vector<Tensor> ProjectedOutputs() {
+  std::vector<Tensor> outputs;
+  for (int64_t i = 0; i < 7; ++i) {
+    outputs.push_back(CreateTensor<tstring>(
+        TensorShape({}),
+        {MakeExample(i, /*only_a=*/true).SerializeAsString()}));
+  }
+  return outputs;
+}
+
+std::vector<GetNextTestCase<ColumnarDatasetParams>> GetNextTestCases() {
+  return {{/*dataset_params=*/ProjectedParams(),
+           /*expected_outputs=*/ProjectedOutputs()}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(ColumnarDatasetOpTest, ColumnarDatasetParams,
+                         GetNextTestCases())
+
+TEST_F(ColumnarDatasetOpTest, AllColumns) {
+  TF_ASSERT_OK(Initialize(MakeParams("columnar_all", {})));
+  bool end_of_sequence = false;
+  int64_t row = 0;
+  while (true) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                    &end_of_sequence));
+    if (end_of_sequence) break;
+    Example example;
+    ASSERT_TRUE(example.ParseFromString(out_tensors[0].scalar<tstring>()()));
+    EXPECT_EQ(example.features().feature_size(), 2);
+    EXPECT_EQ(example.features().feature().at("b").bytes_list().value(0),
+              strings::StrCat("b", row));
+    ++row;
+  }
+  EXPECT_EQ(row, 7);
+}
+
+TEST_F(ColumnarDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = ProjectedParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(ColumnarDatasetOp::kDatasetType)));
+}
+
+TEST_F(ColumnarDatasetOpTest, DatasetOutputShapes) {
+  auto dataset_params = ProjectedParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputShapes({PartialTensorShape({})}));
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<ColumnarDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/ProjectedParams(),
+           /*breakpoints=*/{0, 3, 5, 8},
+           /*expected_outputs=*/ProjectedOutputs()}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(ColumnarDatasetOpTest, ColumnarDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
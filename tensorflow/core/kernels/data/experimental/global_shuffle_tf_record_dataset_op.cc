@@ -0,0 +1,395 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/global_shuffle_tf_record_dataset_op.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/utils.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const
+    GlobalShuffleTFRecordDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    GlobalShuffleTFRecordDatasetOp::kFileNames;
+/* static */ constexpr const char* const
+    GlobalShuffleTFRecordDatasetOp::kBlockSize;
+/* static */ constexpr const char* const
+    GlobalShuffleTFRecordDatasetOp::kWindowSize;
+/* static */ constexpr const char* const GlobalShuffleTFRecordDatasetOp::kSeed;
+/* static */ constexpr const char* const
+    GlobalShuffleTFRecordDatasetOp::kSeed2;
+/* static */ constexpr const char* const
+    GlobalShuffleTFRecordDatasetOp::kReshuffleEachIteration;
+/* static */ constexpr const char* const
+    GlobalShuffleTFRecordDatasetOp::kIndexFileSuffix;
+
+namespace {
+
+constexpr char kEpoch[] = "epoch";
+constexpr char kPosition[] = "position";
+
+// The offsets of the records of all files.
+struct RecordIndex {
+  // `offsets[i][j]` is the offset of record j of file i.
+  std::vector<std::vector<uint64>> offsets;
+  // `file_starts[i]` is the number of records in the files before file i.
+  // Has one entry more than there are files, holding the total.
+  std::vector<int64_t> file_starts;
+
+  int64_t num_records() const { return file_starts.back(); }
+};
+
+// Loads the index of `filename` from its index file, or scans `filename` if
+// there is none.
+Status LoadOrBuildIndex(Env* env, const string& filename,
+                        std::vector<uint64>* offsets) {
+  const string index_filename = strings::StrCat(
+      filename, GlobalShuffleTFRecordDatasetOp::kIndexFileSuffix);
+  if (env->FileExists(index_filename).ok()) {
+    return io::ReadRecordIndex(env, index_filename, offsets);
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  io::RecordReader reader(file.get());
+  return reader.BuildIndex(offsets);
+}
+
+}  // namespace
+
+class GlobalShuffleTFRecordDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+          int64_t block_size, int64_t window_size, int64_t seed,
+          int64_t seed2, bool reshuffle_each_iteration)
+      : DatasetBase(DatasetContext(ctx)),
+        filenames_(std::move(filenames)),
+        block_size_(block_size),
+        window_size_(window_size),
+        seeds_(seed, seed2),
+        reshuffle_each_iteration_(reshuffle_each_iteration) {}
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    static DataTypeVector* dtypes = new DataTypeVector({DT_STRING});
+    return *dtypes;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    static std::vector<PartialTensorShape>* shapes =
+        new std::vector<PartialTensorShape>({{}});
+    return *shapes;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    return Status::OK();
+  }
+
+  Status CheckExternalState() const override { return Status::OK(); }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* filenames = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+    Node* block_size = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(block_size_, &block_size));
+    Node* window_size = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(window_size_, &window_size));
+    Node* seed = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(seeds_.first, &seed));
+    Node* seed2 = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(seeds_.second, &seed2));
+    AttrValue reshuffle_each_iteration;
+    b->BuildAttrValue(reshuffle_each_iteration_, &reshuffle_each_iteration);
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {filenames, block_size, window_size, seed, seed2},
+        {{kReshuffleEachIteration, reshuffle_each_iteration}}, output));
+    return Status::OK();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          seeds_(MaybeOverrideSeeds(dataset()->seeds_)) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(dataset()->GetIndex(ctx->env(), &index_));
+      if (dataset()->reshuffle_each_iteration_) {
+        epoch_ = dataset()->num_epochs_.fetch_add(1);
+      }
+      ComputePermutationLocked();
+      return Status::OK();
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      if (position_ >= static_cast<int64_t>(permutation_.size())) {
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+      if (position_ >= window_start_ + static_cast<int64_t>(window_.size())) {
+        TF_RETURN_IF_ERROR(ReadWindowLocked(ctx->env()));
+      }
+      out_tensors->reserve(1);
+      out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                TensorShape({}));
+      tstring& record = window_[position_ - window_start_];
+      static monitoring::CounterCell* bytes_counter =
+          metrics::GetTFDataBytesReadCounter(kDatasetType);
+      bytes_counter->IncrementBy(record.size());
+      out_tensors->back().scalar<tstring>()() = std::move(record);
+      ++position_;
+      *end_of_sequence = false;
+      return Status::OK();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kSeed), seeds_.first));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kSeed2), seeds_.second));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kEpoch), epoch_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kPosition), position_));
+      return Status::OK();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      // The seeds may have been chosen at random by the saved iterator.
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kSeed), &seeds_.first));
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kSeed2), &seeds_.second));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kEpoch), &epoch_));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kPosition), &position_));
+      ComputePermutationLocked();
+      // The window containing `position_` is read by the next call to
+      // GetNext().
+      window_.clear();
+      window_start_ = 0;
+      return Status::OK();
+    }
+
+   private:
+    // Computes the order of the records in `epoch_`. All records of all files
+    // are shuffled together, using memory proportional to their number.
+    void ComputePermutationLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64_t num_records = index_->num_records();
+      permutation_.resize(num_records);
+      for (int64_t i = 0; i < num_records; ++i) {
+        permutation_[i] = i;
+      }
+      // Each epoch consumes one sample of the seeded generator to seed its
+      // own generator, so that the orders of different epochs are unrelated.
+      random::PhiloxRandom seed_generator(seeds_.first, seeds_.second);
+      seed_generator.Skip(epoch_);
+      const random::PhiloxRandom::ResultType epoch_seeds = seed_generator();
+      random::PhiloxRandom parent_generator(
+          (static_cast<uint64>(epoch_seeds[0]) << 32) | epoch_seeds[1],
+          (static_cast<uint64>(epoch_seeds[2]) << 32) | epoch_seeds[3]);
+      random::SimplePhilox generator(&parent_generator);
+      for (int64_t i = num_records - 1; i > 0; --i) {
+        std::swap(permutation_[i], permutation_[generator.Uniform64(i + 1)]);
+      }
+    }
+
+    // Reads the window of `window_size_` records containing `position_`.
+    //
+    // The records are read in file order through a buffer of `block_size_`
+    // bytes, so that records in the same block of a file are fetched with a
+    // single read, and then returned in shuffled order.
+    Status ReadWindowLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64_t window_size = dataset()->window_size_;
+      window_start_ = position_ - position_ % window_size;
+      const int64_t window_end = std::min<int64_t>(
+          window_start_ + window_size, permutation_.size());
+      window_.clear();
+      window_.resize(window_end - window_start_);
+
+      // Pairs of (record, position in the window), in file order.
+      std::vector<std::pair<int64_t, int64_t>> reads;
+      reads.reserve(window_.size());
+      for (int64_t i = window_start_; i < window_end; ++i) {
+        reads.emplace_back(permutation_[i], i - window_start_);
+      }
+      std::sort(reads.begin(), reads.end());
+
+      io::RecordReaderOptions options;
+      options.buffer_size = dataset()->block_size_;
+      const std::vector<int64_t>& file_starts = index_->file_starts;
+      auto read = reads.begin();
+      while (read != reads.end()) {
+        const int64_t file_index =
+            std::upper_bound(file_starts.begin(), file_starts.end(),
+                             read->first) -
+            file_starts.begin() - 1;
+        std::unique_ptr<RandomAccessFile> file;
+        TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
+            TranslateFileName(dataset()->filenames_[file_index]), &file));
+        io::RecordReader reader(file.get(), options);
+        const std::vector<uint64>& offsets = index_->offsets[file_index];
+        for (; read != reads.end() && read->first < file_starts[file_index + 1];
+             ++read) {
+          uint64 offset = offsets[read->first - file_starts[file_index]];
+          TF_RETURN_IF_ERROR(
+              reader.ReadRecord(&offset, &window_[read->second]));
+        }
+      }
+      return Status::OK();
+    }
+
+    mutex mu_;
+    std::pair<int64_t, int64_t> seeds_ TF_GUARDED_BY(mu_);
+    std::shared_ptr<const RecordIndex> index_ TF_GUARDED_BY(mu_);
+    int64_t epoch_ TF_GUARDED_BY(mu_) = 0;
+    // The order in which the records are produced.
+    std::vector<int64_t> permutation_ TF_GUARDED_BY(mu_);
+    // The position in `permutation_` of the next record to produce.
+    int64_t position_ TF_GUARDED_BY(mu_) = 0;
+    // The records at positions [window_start_, window_start_ + window_.size())
+    // of `permutation_`.
+    int64_t window_start_ TF_GUARDED_BY(mu_) = 0;
+    std::vector<tstring> window_ TF_GUARDED_BY(mu_);
+  };
+
+  // Returns the index of all files, building it on first use. The index is
+  // shared by all iterators of this dataset.
+  Status GetIndex(Env* env, std::shared_ptr<const RecordIndex>* index) const {
+    mutex_lock l(mu_);
+    if (!index_) {
+      auto new_index = std::make_shared<RecordIndex>();
+      new_index->offsets.resize(filenames_.size());
+      new_index->file_starts.reserve(filenames_.size() + 1);
+      new_index->file_starts.push_back(0);
+      for (size_t i = 0; i < filenames_.size(); ++i) {
+        TF_RETURN_IF_ERROR(LoadOrBuildIndex(env,
+                                            TranslateFileName(filenames_[i]),
+                                            &new_index->offsets[i]));
+        new_index->file_starts.push_back(new_index->file_starts.back() +
+                                         new_index->offsets[i].size());
+      }
+      VLOG(2) << "Indexed " << new_index->num_records() << " records in "
+              << filenames_.size() << " files";
+      index_ = std::move(new_index);
+    }
+    *index = index_;
+    return Status::OK();
+  }
+
+  const std::vector<string> filenames_;
+  const int64_t block_size_;
+  const int64_t window_size_;
+  const std::pair<int64_t, int64_t> seeds_;
+  const bool reshuffle_each_iteration_;
+
+  // The number of iterators created so far, which seeds the order of the
+  // records of the next one if `reshuffle_each_iteration_` is set.
+  mutable std::atomic<int64_t> num_epochs_{0};
+  mutable mutex mu_;
+  mutable std::shared_ptr<const RecordIndex> index_ TF_GUARDED_BY(mu_);
+};
+
+GlobalShuffleTFRecordDatasetOp::GlobalShuffleTFRecordDatasetOp(
+    OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kReshuffleEachIteration,
+                                   &reshuffle_each_iteration_));
+}
+
+void GlobalShuffleTFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                                 DatasetBase** output) {
+  const Tensor* filenames_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kFileNames, &filenames_tensor));
+  OP_REQUIRES(
+      ctx, filenames_tensor->dims() <= 1,
+      errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+  std::vector<string> filenames;
+  filenames.reserve(filenames_tensor->NumElements());
+  for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+    filenames.push_back(filenames_tensor->flat<tstring>()(i));
+    metrics::RecordTFDataFilename(kDatasetType, filenames[i]);
+  }
+
+  int64_t block_size;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64_t>(ctx, kBlockSize, &block_size));
+  OP_REQUIRES(ctx, block_size > 0,
+              errors::InvalidArgument("`block_size` must be > 0"));
+
+  int64_t window_size;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64_t>(ctx, kWindowSize, &window_size));
+  OP_REQUIRES(ctx, window_size > 0,
+              errors::InvalidArgument("`window_size` must be > 0"));
+
+  int64_t seed;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kSeed, &seed));
+  int64_t seed2;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kSeed2, &seed2));
+
+  *output = new Dataset(ctx, std::move(filenames), block_size, window_size,
+                        seed, seed2, reshuffle_each_iteration_);
+}
+
+namespace {
+
+REGISTER_KERNEL_BUILDER(
+    Name("GlobalShuffleTFRecordDataset").Device(DEVICE_CPU),
+    GlobalShuffleTFRecordDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,272 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/global_shuffle_tf_record_dataset_op.h"
+
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "global_shuffle_tf_record_dataset";
+
+class GlobalShuffleTFRecordDatasetParams : public DatasetParams {
+ public:
+  GlobalShuffleTFRecordDatasetParams(std::vector<tstring> filenames,
+                                     int64_t block_size, int64_t window_size,
+                                     int64_t seed, int64_t seed2,
+                                     bool reshuffle_each_iteration,
+                                     string node_name)
+      : DatasetParams({DT_STRING}, {PartialTensorShape({})},
+                      std::move(node_name)),
+        filenames_(std::move(filenames)),
+        block_size_(block_size),
+        window_size_(window_size),
+        seed_(seed),
+        seed2_(seed2),
+        reshuffle_each_iteration_(reshuffle_each_iteration) {}
+
+  std::vector<Tensor> GetInputTensors() const override {
+    int num_files = filenames_.size();
+    return {CreateTensor<tstring>(TensorShape({num_files}), filenames_),
+            CreateTensor<int64_t>(TensorShape({}), {block_size_}),
+            CreateTensor<int64_t>(TensorShape({}), {window_size_}),
+            CreateTensor<int64_t>(TensorShape({}), {seed_}),
+            CreateTensor<int64_t>(TensorShape({}), {seed2_})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {GlobalShuffleTFRecordDatasetOp::kFileNames,
+                    GlobalShuffleTFRecordDatasetOp::kBlockSize,
+                    GlobalShuffleTFRecordDatasetOp::kWindowSize,
+                    GlobalShuffleTFRecordDatasetOp::kSeed,
+                    GlobalShuffleTFRecordDatasetOp::kSeed2};
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{GlobalShuffleTFRecordDatasetOp::kReshuffleEachIteration,
+                     reshuffle_each_iteration_},
+                    {"metadata", ""}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override {
+    return GlobalShuffleTFRecordDatasetOp::kDatasetType;
+  }
+
+ private:
+  std::vector<tstring> filenames_;
+  int64_t block_size_;
+  int64_t window_size_;
+  int64_t seed_;
+  int64_t seed2_;
+  bool reshuffle_each_iteration_;
+};
+
+class GlobalShuffleTFRecordDatasetOpTest : public DatasetOpsTestBase {
+ protected:
+  // Returns all records produced by `iterator_`.
+  Status GetRecords(std::vector<tstring>* records) {
+    records->clear();
+    bool end_of_sequence = false;
+    while (true) {
+      std::vector<Tensor> out_tensors;
+      TF_RETURN_IF_ERROR(
+          iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                             &end_of_sequence));
+      if (end_of_sequence) {
+        return Status::OK();
+      }
+      records->push_back(out_tensors[0].scalar<tstring>()());
+    }
+  }
+};
+
+// Writes `contents[i]` to `filenames[i]`. If `write_index` is true, also
+// writes an index file for each file.
+Status CreateTestFiles(const std::vector<tstring>& filenames,
+                       const std::vector<std::vector<string>>& contents,
+                       bool write_index) {
+  for (int i = 0; i < filenames.size(); ++i) {
+    CompressionParams params;
+    params.compression_type = CompressionType::UNCOMPRESSED;
+    std::vector<absl::string_view> records(contents[i].begin(),
+                                           contents[i].end());
+    TF_RETURN_IF_ERROR(WriteDataToTFRecordFile(filenames[i], records, params));
+    const string index_filename = strings::StrCat(
+        filenames[i], GlobalShuffleTFRecordDatasetOp::kIndexFileSuffix);
+    Env* env = Env::Default();
+    if (write_index) {
+      std::unique_ptr<RandomAccessFile> file;
+      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filenames[i], &file));
+      io::RecordReader reader(file.get());
+      std::vector<uint64> offsets;
+      TF_RETURN_IF_ERROR(reader.BuildIndex(&offsets));
+      TF_RETURN_IF_ERROR(io::WriteRecordIndex(env, index_filename, offsets));
+    } else if (env->FileExists(index_filename).ok()) {
+      TF_RETURN_IF_ERROR(env->DeleteFile(index_filename));
+    }
+  }
+  return Status::OK();
+}
+
+std::vector<std::vector<string>> TestContents() {
+  return {{"1", "22", "333"}, {}, {"a", "bb", "ccc", "dddd"}};
+}
+
+std::vector<Tensor> ExpectedOutputs() {
+  return CreateTensors<tstring>(
+      TensorShape({}),
+      {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}, {"dddd"}});
+}
+
+GlobalShuffleTFRecordDatasetParams MakeParams(const string& prefix,
+                                              int64_t block_size,
+                                              int64_t window_size,
+                                              bool write_index = false,
+                                              int64_t seed = 7,
+                                              int64_t seed2 = 11) {
+  std::vector<tstring> filenames;
+  for (int i = 0; i < TestContents().size(); ++i) {
+    filenames.push_back(absl::StrCat(testing::TmpDir(), "/", prefix, "_", i));
+  }
+  if (!CreateTestFiles(filenames, TestContents(), write_index).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return GlobalShuffleTFRecordDatasetParams(
+      filenames, block_size, window_size, seed, seed2,
+      /*reshuffle_each_iteration=*/false, kNodeName);
+}
+
+GlobalShuffleTFRecordDatasetParams SingleWindowParams() {
+  return MakeParams("global_shuffle_single_window", /*block_size=*/1024,
+                    /*window_size=*/100);
+}
+
+GlobalShuffleTFRecordDatasetParams SmallWindowParams() {
+  return MakeParams("global_shuffle_small_window", /*block_size=*/16,
+                    /*window_size=*/2);
+}
+
+GlobalShuffleTFRecordDatasetParams IndexFileParams() {
+  return MakeParams("global_shuffle_index_file", /*block_size=*/16,
+                    /*window_size=*/3, /*write_index=*/true);
+}
+
+std::vector<GetNextTestCase<GlobalShuffleTFRecordDatasetParams>>
+GetNextTestCases() {
+  return {{/*dataset_params=*/SingleWindowParams(),
+           /*expected_outputs=*/ExpectedOutputs(), /*compare_order=*/false},
+          {/*dataset_params=*/SmallWindowParams(),
+           /*expected_outputs=*/ExpectedOutputs(), /*compare_order=*/false},
+          {/*dataset_params=*/IndexFileParams(),
+           /*expected_outputs=*/ExpectedOutputs(), /*compare_order=*/false}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(GlobalShuffleTFRecordDatasetOpTest,
+                         GlobalShuffleTFRecordDatasetParams, GetNextTestCases())
+
+TEST_F(GlobalShuffleTFRecordDatasetOpTest, OrderDependsOnlyOnSeeds) {
+  std::vector<tstring> expected_records;
+  TF_ASSERT_OK(Initialize(SingleWindowParams()));
+  TF_ASSERT_OK(GetRecords(&expected_records));
+
+  // The window size changes how records are read, but not their order.
+  std::vector<tstring> records;
+  TF_ASSERT_OK(Initialize(SmallWindowParams()));
+  TF_ASSERT_OK(GetRecords(&records));
+  EXPECT_EQ(records, expected_records);
+}
+
+TEST_F(GlobalShuffleTFRecordDatasetOpTest, ShufflesAcrossFiles) {
+  // The records of all files are shuffled together, so for some seed the
+  // first record does not come from the first file.
+  bool interleaved = false;
+  for (int64_t seed = 1; seed <= 10 && !interleaved; ++seed) {
+    TF_ASSERT_OK(Initialize(MakeParams("global_shuffle_across_files",
+                                       /*block_size=*/1024,
+                                       /*window_size=*/100,
+                                       /*write_index=*/false, seed, seed)));
+    std::vector<tstring> records;
+    TF_ASSERT_OK(GetRecords(&records));
+    interleaved = records[0] != "1" && records[0] != "22" &&
+                  records[0] != "333";
+  }
+  EXPECT_TRUE(interleaved);
+}
+
+TEST_F(GlobalShuffleTFRecordDatasetOpTest, InvalidWindowSize) {
+  auto dataset_params = MakeParams("global_shuffle_invalid_window",
+                                   /*block_size=*/1024, /*window_size=*/0);
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
+TEST_F(GlobalShuffleTFRecordDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = SingleWindowParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(GlobalShuffleTFRecordDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = SingleWindowParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(GlobalShuffleTFRecordDatasetOp::kDatasetType)));
+}
+
+TEST_F(GlobalShuffleTFRecordDatasetOpTest, DatasetOutputDtypes) {
+  auto dataset_params = SingleWindowParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputDtypes({DT_STRING}));
+}
+
+TEST_F(GlobalShuffleTFRecordDatasetOpTest, DatasetOutputShapes) {
+  auto dataset_params = SingleWindowParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputShapes({PartialTensorShape({})}));
+}
+
+TEST_F(GlobalShuffleTFRecordDatasetOpTest, IteratorPrefix) {
+  auto dataset_params = SingleWindowParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorPrefix(name_utils::IteratorPrefix(
+      GlobalShuffleTFRecordDatasetOp::kDatasetType,
+      dataset_params.iterator_prefix())));
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<GlobalShuffleTFRecordDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/SingleWindowParams(),
+           /*breakpoints=*/{0, 2, 8},
+           /*expected_outputs=*/ExpectedOutputs(), /*compare_order=*/false},
+          {/*dataset_params=*/SmallWindowParams(),
+           /*breakpoints=*/{0, 3, 8},
+           /*expected_outputs=*/ExpectedOutputs(), /*compare_order=*/false}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(GlobalShuffleTFRecordDatasetOpTest,
+                                 GlobalShuffleTFRecordDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
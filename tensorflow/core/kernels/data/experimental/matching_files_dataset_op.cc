@@ -14,12 +14,12 @@ limitations under the License.
 ==============================================================================*/
 #include <queue>
 
+#include "absl/strings/strip.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
-#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
@@ -278,90 +278,25 @@ class MatchingFilesDatasetOp : public DatasetOpKernel {
         StringPiece fixed_prefix =
             StringPiece(eval_pattern)
                 .substr(0, eval_pattern.find_first_of("*?[\\"));
+        // Only the files under `dir` starting with `name_prefix` can match,
+        // which lets the file system filter the listing (on the server for
+        // GCS) instead of us walking and stat'ing every subdirectory.
+        StringPiece name_prefix;
+        if (absl::ConsumePrefix(&fixed_prefix, dir) &&
+            absl::ConsumePrefix(&fixed_prefix, "/")) {
+          name_prefix = fixed_prefix;
+        }
 
-        filepath_queue_.push(PathStatus(dir, true));
-        Status ret;  // Status to return
-
-        // DFS to find the first element in the iterator.
-        while (!filepath_queue_.empty()) {
-          const PathStatus current_path = filepath_queue_.top();
-
-          // All the files in the heap are matched with the pattern, so finish
-          // the search if current_path is a file.
-          if (!current_path.second) {
-            return Status::OK();
-          }
-
-          filepath_queue_.pop();
-
-          // If current_path is a directory, search its children.
-          const string& current_dir = current_path.first;
-          std::vector<string> children;
-          ret.Update(fs->GetChildren(current_dir, &children));
-
-          // Handle the error cases: 1) continue the search if the status is
-          // NOT_FOUND; 2) return the non-ok status immediately if it is not
-          // NOT_FOUND.
-          if (ret.code() == error::NOT_FOUND) {
-            continue;
-          } else if (!ret.ok()) {
-            return ret;
-          }
-
-          // children_dir_status holds is_dir status for children. It can have
-          // three possible values: OK for true; FAILED_PRECONDITION for false;
-          // CANCELLED if we don't calculate IsDirectory (we might do that
-          // because there isn't any point in exploring that child path).
-          std::vector<Status> children_dir_status;
-          children_dir_status.resize(children.size());
-
-          // This IsDirectory call can be expensive for some FS. Parallelizing
-          // it.
-          auto is_directory_fn = [fs, current_dir, &children, &fixed_prefix,
-                                  &children_dir_status](int i) {
-            const string child_path = io::JoinPath(current_dir, children[i]);
-            // In case the child_path doesn't start with the fixed_prefix, then
-            // we don't need to explore this path.
-            if (!absl::StartsWith(child_path, fixed_prefix)) {
-              children_dir_status[i] =
-                  errors::Cancelled("Operation not needed");
-            } else {
-              children_dir_status[i] = fs->IsDirectory(child_path);
-            }
-          };
-
-          BlockingCounter counter(children.size());
-          for (int i = 0; i < children.size(); i++) {
-            (*ctx->runner())([&is_directory_fn, &counter, i] {
-              is_directory_fn(i);
-              counter.DecrementCount();
-            });
-          }
-          counter.Wait();
-
-          for (int i = 0; i < children.size(); i++) {
-            const string& child_dir_path =
-                io::JoinPath(current_dir, children[i]);
-            const Status& child_dir_status = children_dir_status[i];
-
-            // If the IsDirectory call was cancelled we bail.
-            if (child_dir_status.code() == tensorflow::error::CANCELLED) {
-              continue;
-            }
-
-            if (child_dir_status.ok()) {
-              // push the child dir for next search
-              filepath_queue_.push(PathStatus(child_dir_path, true));
-            } else {
-              // This case will be a file: if the file matches the pattern, push
-              // it to the heap; otherwise, ignore it.
-              if (ctx->env()->MatchPath(child_dir_path, eval_pattern)) {
-                filepath_queue_.push(PathStatus(child_dir_path, false));
-              }
-            }
+        std::vector<string> files;
+        TF_RETURN_IF_ERROR(
+            fs->GetChildrenRecursive(dir, string(name_prefix), &files));
+        for (const string& file : files) {
+          const string path = io::JoinPath(dir, file);
+          if (ctx->env()->MatchPath(path, eval_pattern)) {
+            filepath_queue_.push(PathStatus(path, false));
           }
         }
-        return ret;
+        return Status::OK();
       }
 
       mutex mu_;
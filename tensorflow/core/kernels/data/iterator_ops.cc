@@ -191,6 +191,28 @@ Status IteratorResource::Save(SerializationContext* ctx,
       "saving it.");
 }
 
+Status IteratorResource::GetBottleneckReport(model::BottleneckReport* report) {
+  std::shared_ptr<State> captured_state;
+  {
+    tf_shared_lock l(mu_);
+    captured_state = iterator_state_;
+  }
+  auto iterator = captured_state->iterator();
+  if (!iterator) {
+    return errors::FailedPrecondition(
+        "GetBottleneckReport() failed because the iterator has not been "
+        "initialized.");
+  }
+  std::shared_ptr<model::Model> model = iterator->model();
+  if (!model) {
+    return errors::FailedPrecondition(
+        "The input pipeline of the iterator has no performance model, which "
+        "means that autotuning is disabled.");
+  }
+  *report = model->AnalyzeBottleneck();
+  return Status::OK();
+}
+
 Status IteratorResource::Restore(OpKernelContext* ctx,
                                  IteratorStateReader* reader) {
   const DatasetBase* dataset;
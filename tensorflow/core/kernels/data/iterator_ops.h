@@ -68,6 +68,10 @@ class IteratorResource : public ResourceBase {
   Status SetIteratorFromDataset(OpKernelContext* ctx,
                                 const DatasetBase* dataset);
 
+  // Analyzes the performance model of the input pipeline of the iterator and
+  // stores its current bottleneck in `report`.
+  Status GetBottleneckReport(model::BottleneckReport* report);
+
   string DebugString() const override { return "Iterator resource"; }
 
   const DataTypeVector& output_dtypes() const { return output_dtypes_; }
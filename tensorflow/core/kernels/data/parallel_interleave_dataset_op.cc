@@ -116,6 +116,11 @@ constexpr double kDefaultCyclePrefetchFactor = 2.0L;
 // match the behavior of the original implementation.
 constexpr double kDefaultPerIteratorPrefetchFactor = 2.0L;
 
+// When the cycle length is autotuned, the results buffer of an element also
+// stops growing once it holds this many bytes, so that the memory used by the
+// buffers stays bounded as the cycle length grows.
+constexpr int64_t kMaxBufferedBytesPerElement = 16 << 20;  // 16 MB
+
 // Period between reporting dataset statistics.
 constexpr int kStatsReportingPeriodMillis = 1000;
 
@@ -161,19 +166,23 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input,
           std::unique_ptr<CapturedFunction> captured_func, int64_t cycle_length,
-          int64_t block_length, int64_t buffer_output_elements,
-          int64_t prefetch_input_elements, int64_t num_parallel_calls,
-          DeterminismPolicy deterministic, const DataTypeVector& output_types,
+          bool autotune_cycle_length, int64_t block_length,
+          int64_t buffer_output_elements, int64_t prefetch_input_elements,
+          int64_t num_parallel_calls, DeterminismPolicy deterministic,
+          const DataTypeVector& output_types,
           const std::vector<PartialTensorShape>& output_shapes, int op_version)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         captured_func_(std::move(captured_func)),
         cycle_length_(cycle_length),
+        autotune_cycle_length_(autotune_cycle_length),
         block_length_(block_length),
         buffer_output_elements_(
             ComputeBufferOutputElements(buffer_output_elements, block_length)),
         prefetch_input_elements_(ComputePrefetchInputElements(
             prefetch_input_elements, cycle_length)),
+        autotune_prefetch_input_elements_(prefetch_input_elements ==
+                                          model::kAutotune),
         num_parallel_calls_(num_parallel_calls),
         deterministic_(deterministic),
         output_types_(output_types),
@@ -257,7 +266,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     list_inputs.emplace_back(input_index++, other_arguments);
 
     Node* cycle_length_node;
-    TF_RETURN_IF_ERROR(b->AddScalar(cycle_length_, &cycle_length_node));
+    TF_RETURN_IF_ERROR(b->AddScalar(
+        autotune_cycle_length_ ? model::kAutotune : cycle_length_,
+        &cycle_length_node));
     inputs.emplace_back(input_index++, cycle_length_node);
 
     Node* block_length_node;
@@ -315,6 +326,14 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           num_parallel_calls_(std::make_shared<model::SharedState>(
               params.dataset->num_parallel_calls_, mu_,
               num_parallel_calls_cond_var_)),
+          cycle_length_cond_var_(std::make_shared<condition_variable>()),
+          // Changing the cycle length changes the order of the outputs, so it
+          // is only tuned if they may be produced out of order.
+          cycle_length_(std::make_shared<model::SharedState>(
+              params.dataset->autotune_cycle_length_ && !deterministic
+                  ? model::kAutotune
+                  : params.dataset->cycle_length_,
+              mu_, cycle_length_cond_var_)),
           deterministic_(deterministic),
           current_elements_(params.dataset->cycle_length_) {}
 
@@ -347,6 +366,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         num_parallel_calls_->value = std::min(
             GetAutotuneDefaultParallelism(ctx), dataset()->cycle_length_);
       }
+      if (cycle_length_->value == model::kAutotune) {
+        // Start with one element per worker.
+        cycle_length_->value = num_parallel_calls_->value;
+      }
+      open_cycle_length_ = CycleLength();
       ctx_ = std::make_unique<IteratorContext>(*ctx);
       cancellation_manager_ = absl::make_unique<CancellationManager>();
       IteratorContext::Params params(ctx);
@@ -366,6 +390,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         mutex_lock l(*mu_);
         EnsureInitialElementsCreated();
         EnsureThreadsStarted();
+        MaybeUpdateCycleLength();
         while (!cancelled_ && !Consume(&result)) {
           RecordStop(ctx);
           if (deterministic_) {
@@ -376,6 +401,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             any_element_available_cond_var_.wait(l);
           }
           RecordStart(ctx);
+          MaybeUpdateCycleLength();
         }
         if (cancelled_) {
           return errors::Cancelled("Iterator was cancelled");
@@ -416,9 +442,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           std::move(args),
           {model::MakeParameter(kParallelism, num_parallel_calls_, /*min=*/min,
                                 /*max=*/dataset()->cycle_length_),
-           model::MakeParameter(kCycleLength, nullptr,
-                                /*min=*/dataset()->cycle_length_,
-                                /*max=*/dataset()->cycle_length_)});
+           model::MakeParameter(
+               kCycleLength, cycle_length_,
+               /*min=*/cycle_length_->tunable ? 1 : dataset()->cycle_length_,
+               /*max=*/dataset()->cycle_length_)});
     }
 
     // TODO(aaudibert): Refactor the implementations to avoid the need for
@@ -501,6 +528,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
              !current_elements_[last_valid_current_element_]) {
         last_valid_current_element_--;
       }
+      // The elements beyond the cycle length, if it was longer when the
+      // iterator was saved, are closed once they are exhausted.
+      open_cycle_length_ =
+          std::max(CycleLength(), last_valid_current_element_ + 1);
       VLOG(2) << "Parallel interleave iterator restored";
       VLOG(4) << "State after restore:\n" << DebugString();
       return Status::OK();
@@ -629,7 +660,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
 
     void EnsureInitialElementsCreated() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (!initial_elements_created_) {
-        for (int i = 0; i < dataset()->cycle_length_; ++i) {
+        for (int i = 0; i < open_cycle_length_; ++i) {
           current_elements_[i] = MakeElement();
           if (!current_elements_[i]) {
             break;
@@ -730,8 +761,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         }
         // We've consumed all results from the element. Get a new element from
         // future_elements, or create a new element if no future elements are
-        // available.
-        if (!future_elements_.empty()) {
+        // available. If autotuning shortened the cycle below this position,
+        // the position is closed instead.
+        const bool is_open = cycle_index_ < open_cycle_length_;
+        if (is_open && !future_elements_.empty()) {
           std::shared_ptr<Element> future_element =
               std::move(future_elements_.front());
           future_elements_.pop_front();
@@ -745,7 +778,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             current_workers_cond_var_.notify_one();
           }
         } else {
-          current_elements_[cycle_index_] = MakeElement();
+          current_elements_[cycle_index_] = is_open ? MakeElement() : nullptr;
           if (current_elements_[cycle_index_]) {
             current_elements_[cycle_index_]->cycle_index = cycle_index_;
             elements_to_process_.push_back(cycle_index_);
@@ -768,6 +801,63 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    int64_t CycleLength() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return static_cast<int64_t>(cycle_length_->value);
+    }
+
+    // Applies the cycle length chosen by autotuning. When the cycle grows, the
+    // new positions are filled with future elements or new elements right
+    // away. When it shrinks, the elements beyond the new cycle length keep
+    // producing results until they are exhausted, and are not replaced.
+    void MaybeUpdateCycleLength() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64_t cycle_length = CycleLength();
+      if (cycle_length == open_cycle_length_) {
+        return;
+      }
+      if (cycle_length > open_cycle_length_ && initial_elements_created_) {
+        for (int64_t i = open_cycle_length_; i < cycle_length; ++i) {
+          if (current_elements_[i]) {
+            // The element has not been exhausted since the cycle shrank.
+            continue;
+          }
+          std::shared_ptr<Element> element;
+          if (!future_elements_.empty()) {
+            element = std::move(future_elements_.front());
+            future_elements_.pop_front();
+            if (element->iterator) {
+              EnableAutotune(ctx_.get(), element->iterator.get());
+            }
+          } else {
+            element = MakeElement();
+            if (!element) {
+              break;
+            }
+          }
+          element->cycle_index = i;
+          current_elements_[i] = std::move(element);
+          elements_to_process_.push_back(i);
+          last_valid_current_element_ =
+              std::max(last_valid_current_element_, i);
+        }
+        current_workers_cond_var_.notify_all();
+      }
+      VLOG(2) << "Changing the cycle length from " << open_cycle_length_
+              << " to " << cycle_length;
+      open_cycle_length_ = cycle_length;
+      future_workers_cond_var_.notify_all();
+    }
+
+    // Returns the number of future elements to prefetch, which follows the
+    // cycle length unless it was configured.
+    int64_t FutureElementsPrefetch() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!cycle_length_->tunable ||
+          !dataset()->autotune_prefetch_input_elements_) {
+        return dataset()->prefetch_input_elements_;
+      }
+      return ComputePrefetchInputElements(model::kAutotune,
+                                          open_cycle_length_);
+    }
+
     // Creates a new element.
     std::shared_ptr<Element> MakeElement() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (end_of_input_) {
@@ -939,9 +1029,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
               current_workers_cond_var_.notify_one();
             }
           }
-          while (!cancelled_ && (future_elements_.size() >=
-                                     dataset()->prefetch_input_elements_ ||
-                                 wait_for_checkpoint_)) {
+          while (!cancelled_ &&
+                 (future_elements_.size() >= FutureElementsPrefetch() ||
+                  wait_for_checkpoint_)) {
             WaitWorkerThread(&future_workers_cond_var_, &l);
           }
           if (cancelled_) {
@@ -1010,7 +1100,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         mutex_lock l(*mu_);
         element->results.push_back(std::move(result));
         NotifyElementUpdate(element);
-        if (element->results.size() == dataset()->buffer_output_elements_) {
+        if (ResultsBufferFull(*element)) {
           break;
         }
       }
@@ -1111,8 +1201,24 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       if (!element->initialized) {
         return true;
       }
-      return element->iterator &&
-             element->results.size() < dataset()->buffer_output_elements_;
+      return element->iterator && !ResultsBufferFull(*element);
+    }
+
+    bool ResultsBufferFull(const Element& element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (element.results.size() >= dataset()->buffer_output_elements_) {
+        return true;
+      }
+      if (!cycle_length_->tunable) {
+        return false;
+      }
+      int64_t buffered_bytes = 0;
+      for (const auto& result : element.results) {
+        for (const Tensor& tensor : result->return_values) {
+          buffered_bytes += tensor.TotalBytes();
+        }
+      }
+      return buffered_bytes >= kMaxBufferedBytesPerElement;
     }
 
     inline void IncrementCurrentWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1544,6 +1650,18 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // Identifies the maximum number of parallel calls.
     const std::shared_ptr<model::SharedState> num_parallel_calls_;
 
+    // Notified by autotuning when `cycle_length_` changes. The change is
+    // applied by the consumer, which checks the cycle length on every call.
+    std::shared_ptr<condition_variable> cycle_length_cond_var_;
+
+    // Identifies the cycle length, which is tunable if the dataset's cycle
+    // length is autotuned and the outputs need not be deterministic.
+    const std::shared_ptr<model::SharedState> cycle_length_;
+
+    // The cycle length that the elements of `current_elements_` follow.
+    // Positions from `open_cycle_length_` on are not refilled.
+    int64_t open_cycle_length_ TF_GUARDED_BY(mu_) = 0;
+
     // The number of current workers currently alive or scheduled to be started.
     // This includes current workers which are blocked waiting for work.
     int num_current_workers_ TF_GUARDED_BY(mu_) = 0;
@@ -1616,10 +1734,13 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
 
   const DatasetBase* const input_;
   const std::unique_ptr<CapturedFunction> captured_func_;
+  // The cycle length, or its maximum if `autotune_cycle_length_` is true.
   const int64_t cycle_length_;
+  const bool autotune_cycle_length_;
   const int64_t block_length_;
   const int64_t buffer_output_elements_;
   const int64_t prefetch_input_elements_;
+  const bool autotune_prefetch_input_elements_;
   const int64_t num_parallel_calls_;
   const DeterminismPolicy deterministic_;
   const DataTypeVector output_types_;
@@ -1692,7 +1813,9 @@ void ParallelInterleaveDatasetOp::MakeDataset(OpKernelContext* ctx,
       errors::InvalidArgument("num_parallel_calls must be greater than zero."));
   int64_t cycle_length = 0;
   OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, kCycleLength, &cycle_length));
-  if (cycle_length == model::kAutotune) {
+  // An autotuned cycle length varies between 1 and the value computed below.
+  const bool autotune_cycle_length = cycle_length == model::kAutotune;
+  if (autotune_cycle_length) {
     if (num_parallel_calls != model::kAutotune) {
       cycle_length = std::min(num_parallel_calls,
                               static_cast<int64_t>(port::MaxParallelism()));
@@ -1722,10 +1845,11 @@ void ParallelInterleaveDatasetOp::MakeDataset(OpKernelContext* ctx,
     metrics::RecordTFDataAutotune(kDatasetType);
   }
 
-  *output = new Dataset(
-      ctx, input, std::move(captured_func), cycle_length, block_length,
-      buffer_output_elements, prefetch_input_elements, num_parallel_calls,
-      deterministic_, output_types_, output_shapes_, op_version_);
+  *output = new Dataset(ctx, input, std::move(captured_func), cycle_length,
+                        autotune_cycle_length, block_length,
+                        buffer_output_elements, prefetch_input_elements,
+                        num_parallel_calls, deterministic_, output_types_,
+                        output_shapes_, op_version_);
 }
 
 namespace {
@@ -14,8 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/repeat_dataset_op.h"
 
+#include <algorithm>
+#include <cmath>
 #include <utility>
 
+#include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -39,6 +42,9 @@ constexpr char kCurIteration[] = "i";
 constexpr char kInputImplEmpty[] = "input_impl_empty";
 constexpr char kUninitialized[] = "uninitialized";
 constexpr int64_t kKnownRatio = 1;
+// The fraction of an epoch, at the end of which the iterator for the next
+// epoch is created when warm starting.
+constexpr double kWarmStartFraction = 0.1;
 
 class RepeatDatasetOp::Dataset : public DatasetBase {
  public:
@@ -164,12 +170,81 @@ class RepeatDatasetOp::Dataset : public DatasetBase {
     }
   };
 
+  // Creates the input iterator for the next epoch shortly before the current
+  // epoch ends, so that its prefetching and interleaving buffers are already
+  // filling when the epoch boundary is reached.
+  //
+  // Warm starting is disabled when the input is split between consumers, as
+  // the split providers can only be reset once the current epoch has ended.
+  class WarmStarter {
+   public:
+    void Initialize(IteratorContext* ctx, const DatasetBase* input) {
+      enabled_ = GetExperiments().contains("warm_start_repeat") &&
+                 ctx->split_providers().empty();
+      epoch_length_ = input->Cardinality();
+      epoch_elements_ = 0;
+      next_input_impl_.reset();
+    }
+
+    // Records an element of the current epoch, and creates the iterator for
+    // the next epoch if the current one is about to end. `has_next_epoch`
+    // indicates whether there is an epoch after the current one.
+    void RecordElement(IteratorContext* ctx, const DatasetBase* input,
+                       IteratorBase* parent, const string& prefix,
+                       bool has_next_epoch) {
+      ++epoch_elements_;
+      if (!enabled_ || !has_next_epoch || next_input_impl_ ||
+          epoch_length_ <= 0) {
+        return;
+      }
+      const int64_t warm_start_elements = std::max<int64_t>(
+          1, std::ceil(epoch_length_ * kWarmStartFraction));
+      if (epoch_length_ - epoch_elements_ > warm_start_elements) {
+        return;
+      }
+      Status s = input->MakeIterator(ctx, parent, prefix, &next_input_impl_);
+      if (!s.ok()) {
+        // The iterator is created again at the epoch boundary, which reports
+        // the error if it persists.
+        LOG(WARNING) << "Failed to warm start the next epoch of " << prefix
+                     << ": " << s;
+        next_input_impl_.reset();
+        enabled_ = false;
+      }
+    }
+
+    // Ends the current epoch. Returns the iterator for the next epoch if it
+    // has already been created, and nullptr otherwise.
+    std::unique_ptr<IteratorBase> EndEpoch() {
+      epoch_length_ = epoch_elements_;
+      epoch_elements_ = 0;
+      return std::move(next_input_impl_);
+    }
+
+    // Discards the iterator for the next epoch. The iterator is not part of
+    // the checkpointed state, so it is discarded when the state is restored.
+    void Reset() {
+      epoch_length_ = kUnknownCardinality;
+      epoch_elements_ = 0;
+      next_input_impl_.reset();
+    }
+
+   private:
+    bool enabled_ = false;
+    // The number of elements in an epoch, or a negative value if unknown.
+    int64_t epoch_length_ = kUnknownCardinality;
+    int64_t epoch_elements_ = 0;
+    std::unique_ptr<IteratorBase> next_input_impl_;
+  };
+
   class FiniteIterator : public DatasetIterator<Dataset> {
    public:
     explicit FiniteIterator(const Params& params)
         : DatasetIterator<Dataset>(params), i_(0) {}
 
     Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      warm_starter_.Initialize(ctx, dataset()->input_);
       return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
     }
 
@@ -185,14 +260,20 @@ class RepeatDatasetOp::Dataset : public DatasetBase {
         TF_RETURN_IF_ERROR(
             input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
         if (!*end_of_sequence) {
+          warm_starter_.RecordElement(ctx, dataset()->input_, this, prefix(),
+                                      /*has_next_epoch=*/i_ + 1 <
+                                          dataset()->count_);
           return Status::OK();
         }
         ++i_;
         for (const auto& provider : ctx->split_providers()) {
           TF_RETURN_IF_ERROR(provider->Reset());
         }
-        TF_RETURN_IF_ERROR(
-            dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+        input_impl_ = warm_starter_.EndEpoch();
+        if (!input_impl_) {
+          TF_RETURN_IF_ERROR(dataset()->input_->MakeIterator(
+              ctx, this, prefix(), &input_impl_));
+        }
       }
       *end_of_sequence = true;
       input_impl_.reset();
@@ -221,6 +302,7 @@ class RepeatDatasetOp::Dataset : public DatasetBase {
     Status RestoreInternal(IteratorContext* ctx,
                            IteratorStateReader* reader) override {
       mutex_lock l(mu_);
+      warm_starter_.Reset();
       TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kCurIteration), &i_));
       if (!reader->Contains(full_name(kInputImplEmpty))) {
         TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
@@ -234,6 +316,7 @@ class RepeatDatasetOp::Dataset : public DatasetBase {
     mutex mu_;
     int64_t i_ TF_GUARDED_BY(mu_);
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    WarmStarter warm_starter_ TF_GUARDED_BY(mu_);
   };
 
   class ForeverIterator : public DatasetIterator<Dataset> {
@@ -245,6 +328,7 @@ class RepeatDatasetOp::Dataset : public DatasetBase {
 
     Status Initialize(IteratorContext* ctx) override {
       mutex_lock l(mu_);
+      warm_starter_.Initialize(ctx, dataset()->input_);
       return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
     }
 
@@ -270,12 +354,14 @@ class RepeatDatasetOp::Dataset : public DatasetBase {
         }
         first_call_ = false;
         if (!*end_of_sequence) {
+          warm_starter_.RecordElement(ctx, dataset()->input_, this, prefix(),
+                                      /*has_next_epoch=*/true);
           return Status::OK();
         }
         for (const auto& provider : ctx->split_providers()) {
           TF_RETURN_IF_ERROR(provider->Reset());
         }
-        input_impl_.reset();
+        input_impl_ = warm_starter_.EndEpoch();
         first_call_ = true;
       } while (true);
     }
@@ -300,6 +386,7 @@ class RepeatDatasetOp::Dataset : public DatasetBase {
     Status RestoreInternal(IteratorContext* ctx,
                            IteratorStateReader* reader) override {
       mutex_lock l(mu_);
+      warm_starter_.Reset();
       if (reader->Contains(full_name(kUninitialized))) {
         input_impl_.reset();
         first_call_ = true;
@@ -316,6 +403,7 @@ class RepeatDatasetOp::Dataset : public DatasetBase {
     mutex mu_;
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
     bool first_call_ TF_GUARDED_BY(mu_);
+    WarmStarter warm_starter_ TF_GUARDED_BY(mu_);
   };
 
   const int64_t count_;
@@ -14,12 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/repeat_dataset_op.h"
 
+#include <cstdlib>
 #include <string>
 #include <utility>
 
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 
 namespace tensorflow {
 namespace data {
@@ -181,6 +183,18 @@ INSTANTIATE_TEST_SUITE_P(RepeatDatasetOpTest,
                          ParameterizedIteratorGetNextOpTest,
                          ::testing::ValuesIn(GetNextTestCases()));
 
+TEST_F(RepeatDatasetOpTest, WarmStart) {
+  setenv("TF_DATA_EXPERIMENT_OPT_IN", "warm_start_repeat", 1);
+  auto cleanup =
+      gtl::MakeCleanup([] { unsetenv("TF_DATA_EXPERIMENT_OPT_IN"); });
+  // The iterator for the next epoch is created before the current one ends,
+  // without changing the produced elements.
+  auto test_case = GetNextTestCases()[0];
+  TF_ASSERT_OK(Initialize(test_case.dataset_params));
+  TF_ASSERT_OK(CheckIteratorGetNext(test_case.expected_outputs,
+                                    /*compare_order=*/true));
+}
+
 TEST_F(RepeatDatasetOpTest, DatasetNodeName) {
   auto dataset_params = FiniteRepeatDatasetParams();
   TF_ASSERT_OK(Initialize(dataset_params));
@@ -16,9 +16,11 @@ limitations under the License.
 
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/utils.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
@@ -36,6 +38,8 @@ namespace data {
 /* static */ constexpr const char* const TFRecordDatasetOp::kFileNames;
 /* static */ constexpr const char* const TFRecordDatasetOp::kCompressionType;
 /* static */ constexpr const char* const TFRecordDatasetOp::kBufferSize;
+/* static */ constexpr const char* const
+    TFRecordDatasetOp::kNumOutstandingReads;
 
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kOffset[] = "offset";
@@ -44,6 +48,28 @@ constexpr char kS3FsPrefix[] = "s3://";
 constexpr int64_t kCloudTpuBlockSize = 127LL << 20;  // 127MB.
 constexpr int64_t kS3BlockSize = kCloudTpuBlockSize;
 
+// The buffer of a scalar string tensor whose value may be a view of the
+// prefetched contents of a file, which the buffer keeps alive.
+class RecordViewTensorBuffer : public TensorBuffer {
+ public:
+  RecordViewTensorBuffer() : TensorBuffer(&record_) {}
+
+  tstring* record() { return &record_; }
+  core::RefCountPtr<core::RefCounted>* contents() { return &contents_; }
+
+  size_t size() const override { return sizeof(tstring); }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size());
+    proto->set_allocator_name("RecordViewTensorBuffer");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+ private:
+  core::RefCountPtr<core::RefCounted> contents_;
+  tstring record_;
+};
+
 bool is_cloud_tpu_gcs_fs() {
 #if (defined(PLATFORM_CLOUD_TPU) && defined(TPU_GCS_FS)) || \
     defined(LIBTPU_ON_GCE)
@@ -55,10 +81,12 @@ bool is_cloud_tpu_gcs_fs() {
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
-                   const string& compression_type, int64_t buffer_size)
+                   const string& compression_type, int64_t buffer_size,
+                   int64_t num_outstanding_reads)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
+        num_outstanding_reads_(num_outstanding_reads),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
             compression_type)) {
     if (buffer_size > 0) {
@@ -103,8 +131,11 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
     Node* buffer_size = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
-    TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {filenames, compression_type, buffer_size}, output));
+    AttrValue num_outstanding_reads;
+    b->BuildAttrValue(num_outstanding_reads_, &num_outstanding_reads);
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this, {filenames, compression_type, buffer_size},
+                      {{kNumOutstandingReads, num_outstanding_reads}}, output));
     return Status::OK();
   }
 
@@ -114,6 +145,14 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     explicit Iterator(const Params& params)
         : DatasetIterator<Dataset>(params) {}
 
+    Status Initialize(IteratorContext* ctx) override {
+      if (dataset()->num_outstanding_reads_ > 0) {
+        thread_pool_ = ctx->CreateThreadPool(
+            "tf_record_reads", dataset()->num_outstanding_reads_);
+      }
+      return Status::OK();
+    }
+
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
@@ -122,10 +161,18 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       do {
         // We are currently processing a file, so try to read the next record.
         if (reader_) {
-          out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
-                                    TensorShape({}));
-          Status s =
-              reader_->ReadRecord(&out_tensors->back().scalar<tstring>()());
+          Status s;
+          if (thread_pool_) {
+            // Avoid copying the prefetched record where possible.
+            auto* buffer = new RecordViewTensorBuffer();
+            out_tensors->emplace_back(DT_STRING, TensorShape({}),
+                                      core::RefCountPtr<TensorBuffer>(buffer));
+            s = reader_->ReadRecord(buffer->record(), buffer->contents());
+          } else {
+            out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                      TensorShape({}));
+            s = reader_->ReadRecord(&out_tensors->back().scalar<tstring>()());
+          }
           if (s.ok()) {
             static monitoring::CounterCell* bytes_counter =
                 metrics::GetTFDataBytesReadCounter(kDatasetType);
@@ -250,8 +297,13 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
           TranslateFileName(dataset()->filenames_[current_file_index_]),
           &file_));
-      reader_ = absl::make_unique<io::SequentialRecordReader>(
-          file_.get(), dataset()->options_);
+      io::RecordReaderOptions options = dataset()->options_;
+      if (thread_pool_) {
+        options.num_outstanding_reads = dataset()->num_outstanding_reads_;
+        options.read_thread_pool = thread_pool_.get();
+      }
+      reader_ = absl::make_unique<io::SequentialRecordReader>(file_.get(),
+                                                              options);
       return Status::OK();
     }
 
@@ -261,6 +313,10 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       file_.reset();
     }
 
+    // Runs the reads of `reader_` if `num_outstanding_reads_` is positive.
+    // Must outlive `reader_`.
+    std::unique_ptr<thread::ThreadPool> thread_pool_;
+
     mutex mu_;
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
 
@@ -272,11 +328,18 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
   const std::vector<string> filenames_;
   const tstring compression_type_;
+  const int64_t num_outstanding_reads_;
   io::RecordReaderOptions options_;
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
-    : DatasetOpKernel(ctx) {}
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx,
+                 ctx->GetAttr(kNumOutstandingReads, &num_outstanding_reads_));
+  OP_REQUIRES(ctx, num_outstanding_reads_ >= 0,
+              errors::InvalidArgument(
+                  "`num_outstanding_reads` must be >= 0 (0 == no prefetching)"));
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -324,8 +387,8 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     buffer_size = kS3BlockSize;
   }
 
-  *output =
-      new Dataset(ctx, std::move(filenames), compression_type, buffer_size);
+  *output = new Dataset(ctx, std::move(filenames), compression_type,
+                        buffer_size, num_outstanding_reads_);
 }
 
 namespace {
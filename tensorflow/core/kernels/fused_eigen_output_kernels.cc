@@ -61,7 +61,11 @@ Status InitializeFusedComputation(
       *fused_computation == FusedComputationType::kBiasAddWithRelu ||
       *fused_computation == FusedComputationType::kBiasAddWithRelu6 ||
       *fused_computation == FusedComputationType::kBiasAddWithElu ||
-      *fused_computation == FusedComputationType::kBiasAddWithLeakyRelu) {
+      *fused_computation == FusedComputationType::kBiasAddWithLeakyRelu ||
+      *fused_computation == FusedComputationType::kBiasAddWithTanh ||
+      *fused_computation == FusedComputationType::kBiasAddWithSigmoid ||
+      *fused_computation == FusedComputationType::kBiasAddWithGeluApproximate ||
+      *fused_computation == FusedComputationType::kBiasAddWithGeluExact) {
     if (num_args != 1) {
       return errors::InvalidArgument(
           "Fused ", kernel_name,
@@ -73,6 +77,20 @@ Status InitializeFusedComputation(
     }
   }
 
+  if (HasResidualAdd(*fused_computation)) {
+    if (num_args != 2) {
+      return errors::InvalidArgument(
+          "Fused ", kernel_name,
+          " with BiasAdd and Add must have two extra arguments: bias, "
+          "residual.");
+    }
+    if (*fused_computation ==
+        FusedComputationType::kBiasAddWithAddAndLeakyRelu) {
+      TF_RETURN_IF_ERROR(context->GetAttr(
+          "leakyrelu_alpha", &fused_computation_args->leakyrelu_alpha));
+    }
+  }
+
   if (*fused_computation == FusedComputationType::kFusedBatchNorm ||
       *fused_computation == FusedComputationType::kFusedBatchNormWithRelu ||
       *fused_computation == FusedComputationType::kFusedBatchNormWithRelu6 ||
@@ -97,4 +115,14 @@ Status InitializeFusedComputation(
   return Status::OK();
 }
 
+bool HasResidualAdd(FusedComputationType fusion) {
+  return fusion == FusedComputationType::kBiasAddWithAdd ||
+         fusion == FusedComputationType::kBiasAddWithAddAndRelu ||
+         fusion == FusedComputationType::kBiasAddWithAddAndRelu6 ||
+         fusion == FusedComputationType::kBiasAddWithAddAndElu ||
+         fusion == FusedComputationType::kBiasAddWithAddAndLeakyRelu ||
+         fusion == FusedComputationType::kBiasAddWithAddAndTanh ||
+         fusion == FusedComputationType::kBiasAddWithAddAndSigmoid;
+}
+
 }  // namespace tensorflow
@@ -19,9 +19,10 @@ limitations under the License.
 //
 // Supported fused computations:
 //   (1) {Conv2D/MatMul} + BiasAdd + <Activation>
-//   (2) {Conv2D/MatMul} + FusedBatchNorm + <Activation>
+//   (2) {Conv2D/MatMul} + BiasAdd + Add + <Activation>
+//   (3) {Conv2D/MatMul} + FusedBatchNorm + <Activation>
 //
-// Activation: Relu, Relu6, Elu, etc...
+// Activation: Relu, Relu6, Elu, Tanh, Sigmoid, etc...
 
 #ifndef TENSORFLOW_CORE_KERNELS_FUSED_EIGEN_OUTPUT_KERNELS_H_
 #define TENSORFLOW_CORE_KERNELS_FUSED_EIGEN_OUTPUT_KERNELS_H_
@@ -40,6 +41,17 @@ enum class FusedComputationType {
   kBiasAddWithRelu6,
   kBiasAddWithElu,
   kBiasAddWithLeakyRelu,
+  kBiasAddWithTanh,
+  kBiasAddWithSigmoid,
+  kBiasAddWithGeluApproximate,
+  kBiasAddWithGeluExact,
+  kBiasAddWithAdd,
+  kBiasAddWithAddAndRelu,
+  kBiasAddWithAddAndRelu6,
+  kBiasAddWithAddAndElu,
+  kBiasAddWithAddAndLeakyRelu,
+  kBiasAddWithAddAndTanh,
+  kBiasAddWithAddAndSigmoid,
   kFusedBatchNorm,
   kFusedBatchNormWithRelu,
   kFusedBatchNormWithRelu6,
@@ -66,6 +78,10 @@ Status InitializeFusedComputation(
     FusedComputationType* fused_computation,
     FusedComputationArgs* fused_computation_args);
 
+// Returns true if `fusion` adds a residual input, of the shape of the output,
+// after BiasAdd.
+bool HasResidualAdd(FusedComputationType fusion);
+
 // Type alias for the tensor contraction output mapper.
 template <typename Scalar, typename StorageIndex>
 using ContractionOutputMapper =
@@ -129,17 +145,73 @@ struct LeakyRelu {
   };
 };
 
+// Applies `Tanh` to the passed input expression.
+struct Tanh {
+  template <typename XprType>
+  static auto apply(XprType expr) -> decltype(expr.tanh()) {
+    return expr.tanh();
+  };
+};
+
+// Applies `Sigmoid` to the passed input expression.
+struct Sigmoid {
+  template <typename XprType>
+  static auto apply(XprType expr) -> decltype(expr.sigmoid()) {
+    return expr.sigmoid();
+  };
+};
+
+// Applies the tanh approximation of `Gelu` to the passed input expression:
+//   0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3)))
+struct GeluApproximate {
+  template <typename XprType>
+  static auto apply(XprType expr) {
+    using Scalar = typename XprType::Scalar;
+    const Scalar kSqrtTwoOverPi = static_cast<Scalar>(0.7978845608028654);
+    const Scalar kEmpiricalConst = static_cast<Scalar>(0.044715);
+    const Scalar kOneHalf = static_cast<Scalar>(0.5);
+    const Scalar kOne = static_cast<Scalar>(1);
+    return expr * kOneHalf *
+           (((expr + expr.cube() * kEmpiricalConst) * kSqrtTwoOverPi).tanh() +
+            kOne);
+  };
+};
+
+// Applies `Gelu` to the passed input expression:
+//   0.5 * x * (1 + erf(x / sqrt(2)))
+struct GeluExact {
+  template <typename XprType>
+  static auto apply(XprType expr) {
+    using Scalar = typename XprType::Scalar;
+    const Scalar kSqrtOneHalf = static_cast<Scalar>(0.7071067811865476);
+    const Scalar kOneHalf = static_cast<Scalar>(0.5);
+    const Scalar kOne = static_cast<Scalar>(1);
+    return expr * kOneHalf * ((expr * kSqrtOneHalf).erf() + kOne);
+  };
+};
+
 template <typename T>
 struct BiasAddArgs {
   const T* bias_add_data = nullptr;
   float leakyrelu_alpha;
 
+  // Used by the fusions with a residual Add only. The residual has the layout
+  // of the output, so the output kernel reads it at the offset of the output
+  // block from `output_data`.
+  const T* residual_data = nullptr;
+  const T* output_data = nullptr;
+
   static bool IsSupported(FusedComputationType fusion) {
     return fusion == FusedComputationType::kBiasAdd ||
            fusion == FusedComputationType::kBiasAddWithRelu ||
            fusion == FusedComputationType::kBiasAddWithRelu6 ||
            fusion == FusedComputationType::kBiasAddWithElu ||
-           fusion == FusedComputationType::kBiasAddWithLeakyRelu;
+           fusion == FusedComputationType::kBiasAddWithLeakyRelu ||
+           fusion == FusedComputationType::kBiasAddWithTanh ||
+           fusion == FusedComputationType::kBiasAddWithSigmoid ||
+           fusion == FusedComputationType::kBiasAddWithGeluApproximate ||
+           fusion == FusedComputationType::kBiasAddWithGeluExact ||
+           HasResidualAdd(fusion);
   }
 };
 
@@ -199,10 +271,15 @@ struct FusedBatchNormArgs {
 
 // Output kernel that fuses BiasAdd operation into the output of tensor
 // contraction + activation function defined by Activation.
+//
+// If the fusion has a residual Add, it is added after the bias, while the
+// output block is still in cache.
 template <typename T, typename Activation = Identity>
 struct BiasAddOutputKernel {
   explicit BiasAddOutputKernel(const BiasAddArgs<T>& args)
-      : bias_data(args.bias_add_data) {}
+      : bias_data(args.bias_add_data),
+        residual_data(args.residual_data),
+        output_data(args.output_data) {}
 
   template <typename StorageIndex, typename Scalar>
   EIGEN_ALWAYS_INLINE void operator()(
@@ -217,19 +294,31 @@ struct BiasAddOutputKernel {
     for (int col = 0; col < num_cols; ++col) {
       T* output_base = &output_mapper(0, col);
       typename TTypes<T>::UnalignedTensor output(output_base, num_rows);
-      const auto expr = output + bias;
-      output = Activation::template apply<decltype(expr)>(expr);
+      if (residual_data == nullptr) {
+        const auto expr = output + bias;
+        output = Activation::template apply<decltype(expr)>(expr);
+      } else {
+        typename TTypes<T>::UnalignedConstTensor residual(
+            residual_data + (output_base - output_data), num_rows);
+        const auto expr = output + bias + residual;
+        output = Activation::template apply<decltype(expr)>(expr);
+      }
     }
   }
 
  private:
   const T* bias_data;
+  const T* residual_data;
+  const T* output_data;
 };
 
 template <typename T>
 struct BiasAddOutputKernel<T, LeakyRelu> {
   explicit BiasAddOutputKernel(const BiasAddArgs<T>& args)
-      : bias_data(args.bias_add_data), leakyrelu_alpha(args.leakyrelu_alpha) {}
+      : bias_data(args.bias_add_data),
+        residual_data(args.residual_data),
+        output_data(args.output_data),
+        leakyrelu_alpha(args.leakyrelu_alpha) {}
 
   template <typename StorageIndex, typename Scalar>
   EIGEN_ALWAYS_INLINE void operator()(
@@ -244,13 +333,24 @@ struct BiasAddOutputKernel<T, LeakyRelu> {
     for (int col = 0; col < num_cols; ++col) {
       T* output_base = &output_mapper(0, col);
       typename TTypes<T>::UnalignedTensor output(output_base, num_rows);
-      const auto expr = output + bias;
-      output = LeakyRelu::template apply<decltype(expr)>(expr, leakyrelu_alpha);
+      if (residual_data == nullptr) {
+        const auto expr = output + bias;
+        output =
+            LeakyRelu::template apply<decltype(expr)>(expr, leakyrelu_alpha);
+      } else {
+        typename TTypes<T>::UnalignedConstTensor residual(
+            residual_data + (output_base - output_data), num_rows);
+        const auto expr = output + bias + residual;
+        output =
+            LeakyRelu::template apply<decltype(expr)>(expr, leakyrelu_alpha);
+      }
     }
   }
 
  private:
   const T* bias_data;
+  const T* residual_data;
+  const T* output_data;
   float leakyrelu_alpha;
 };
 
@@ -356,6 +456,14 @@ using WithBiasAddAndElu = BiasAddOutputKernel<T, Elu>;
 template <typename T>
 using WithBiasAddAndLeakyRelu = BiasAddOutputKernel<T, LeakyRelu>;
 template <typename T>
+using WithBiasAddAndTanh = BiasAddOutputKernel<T, Tanh>;
+template <typename T>
+using WithBiasAddAndSigmoid = BiasAddOutputKernel<T, Sigmoid>;
+template <typename T>
+using WithBiasAddAndGeluApproximate = BiasAddOutputKernel<T, GeluApproximate>;
+template <typename T>
+using WithBiasAddAndGeluExact = BiasAddOutputKernel<T, GeluExact>;
+template <typename T>
 using WithFusedBatchNorm = FusedBatchNormOutputKernel<T>;
 template <typename T>
 using WithFusedBatchNormAndRelu = FusedBatchNormOutputKernel<T, Relu>;
@@ -389,6 +497,73 @@ Status InitBiasAddArgs(OpKernelContext* context, BiasAddArgs<T>* args,
   return Status::OK();
 }
 
+// Initializes the residual Add of `args` from the input that follows the bias,
+// which must have the shape of `output`.
+template <typename T>
+Status InitResidualAddArgs(OpKernelContext* context, const Tensor& output,
+                           BiasAddArgs<T>* args) {
+  const Tensor& residual = context->input(3);
+
+  if (residual.shape() != output.shape())
+    return errors::InvalidArgument(
+        "residual must have the shape of the output ",
+        output.shape().DebugString(), ", got ", residual.shape().DebugString());
+
+  args->residual_data = residual.flat<T>().data();
+  args->output_data = output.flat<T>().data();
+
+  return Status::OK();
+}
+
+// Calls `launch` with the output kernel of `fusion`, which must be supported by
+// BiasAddArgs<T>. The fusions with and without a residual Add share an output
+// kernel, which adds the residual if `args` has one.
+template <typename T, typename Launch>
+Status LaunchWithBiasAddOutputKernel(FusedComputationType fusion,
+                                     const BiasAddArgs<T>& args,
+                                     Launch&& launch) {
+  using FCT = FusedComputationType;
+  switch (fusion) {
+    case FCT::kBiasAdd:
+    case FCT::kBiasAddWithAdd:
+      launch(WithBiasAdd<T>(args));
+      break;
+    case FCT::kBiasAddWithRelu:
+    case FCT::kBiasAddWithAddAndRelu:
+      launch(WithBiasAddAndRelu<T>(args));
+      break;
+    case FCT::kBiasAddWithRelu6:
+    case FCT::kBiasAddWithAddAndRelu6:
+      launch(WithBiasAddAndRelu6<T>(args));
+      break;
+    case FCT::kBiasAddWithElu:
+    case FCT::kBiasAddWithAddAndElu:
+      launch(WithBiasAddAndElu<T>(args));
+      break;
+    case FCT::kBiasAddWithLeakyRelu:
+    case FCT::kBiasAddWithAddAndLeakyRelu:
+      launch(WithBiasAddAndLeakyRelu<T>(args));
+      break;
+    case FCT::kBiasAddWithTanh:
+    case FCT::kBiasAddWithAddAndTanh:
+      launch(WithBiasAddAndTanh<T>(args));
+      break;
+    case FCT::kBiasAddWithSigmoid:
+    case FCT::kBiasAddWithAddAndSigmoid:
+      launch(WithBiasAddAndSigmoid<T>(args));
+      break;
+    case FCT::kBiasAddWithGeluApproximate:
+      launch(WithBiasAddAndGeluApproximate<T>(args));
+      break;
+    case FCT::kBiasAddWithGeluExact:
+      launch(WithBiasAddAndGeluExact<T>(args));
+      break;
+    default:
+      return errors::Internal("Fusion type is not a BiasAdd fusion");
+  }
+  return Status::OK();
+}
+
 template <typename T>
 Status InitFusedBatchNormArgs(OpKernelContext* context, float epsilon,
                               FusedBatchNormArgs<T>* args,
@@ -0,0 +1,409 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#define EIGEN_USE_GPU
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/strings/str_join.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/cwise_ops.h"
+#include "tensorflow/core/kernels/fused_elementwise_op.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+// Number of elements that go through all the fused ops at a time.
+constexpr int64_t kFusedElementwiseBlockSize = 2048;
+
+namespace {
+
+Status CheckNumFusedElementwiseInputs(OpKernelConstruction* context,
+                                      int num_binary_ops) {
+  if (context->num_inputs() != num_binary_ops + 1) {
+    return errors::InvalidArgument(
+        "_FusedElementwise with ", num_binary_ops, " binary ops must have ",
+        num_binary_ops + 1, " inputs, got ", context->num_inputs());
+  }
+  return Status::OK();
+}
+
+// The other operand of each binary op has the shape of the input, or is a
+// scalar that is applied to every element.
+template <typename T>
+Status GetFusedElementwiseArgs(OpKernelContext* ctx,
+                               std::vector<const T*>* args,
+                               std::vector<bool>* args_are_scalars) {
+  const TensorShape& shape = ctx->input(0).shape();
+  for (int i = 1; i < ctx->num_inputs(); ++i) {
+    const Tensor& arg = ctx->input(i);
+    const bool is_scalar = TensorShapeUtils::IsScalar(arg.shape());
+    if (!is_scalar && arg.shape() != shape) {
+      return errors::InvalidArgument(
+          "_FusedElementwise input ", i,
+          " must be a scalar or have the shape of input 0 ",
+          shape.DebugString(), ", got ", arg.shape().DebugString());
+    }
+    args->push_back(arg.flat<T>().data());
+    args_are_scalars->push_back(is_scalar);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+template <typename T>
+class FusedElementwiseOp : public OpKernel {
+ public:
+  using ConstBuffer = typename TTypes<T>::UnalignedConstFlat;
+  using Buffer = typename TTypes<T>::UnalignedFlat;
+
+  // Computes `out = f(x)`.
+  using UnaryFn = void (*)(const ConstBuffer& x, Buffer* out);
+  // Computes `out = f(x, y)`.
+  using BinaryFn = void (*)(const ConstBuffer& x, const ConstBuffer& y,
+                            Buffer* out);
+  // Computes `out = f(x, *y)`.
+  using BinaryScalarFn = void (*)(const ConstBuffer& x, const T* y,
+                                  Buffer* out);
+
+  explicit FusedElementwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> fused_ops;
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops));
+    OP_REQUIRES(context, !fused_ops.empty(),
+                errors::InvalidArgument(
+                    "_FusedElementwise must have at least one fused op"));
+
+    const auto& supported_ops = SupportedOps();
+    int num_binary_ops = 0;
+    for (const string& op_name : fused_ops) {
+      auto it = supported_ops.find(op_name);
+      OP_REQUIRES(context, it != supported_ops.end(),
+                  errors::InvalidArgument(
+                      "_FusedElementwise does not support op: ", op_name));
+      steps_.push_back(it->second);
+      cost_ += it->second.cost;
+      if (it->second.unary == nullptr) ++num_binary_ops;
+    }
+    OP_REQUIRES_OK(context,
+                   CheckNumFusedElementwiseInputs(context, num_binary_ops));
+
+    VLOG(2) << "Fused elementwise ops: [" << absl::StrJoin(fused_ops, ", ")
+            << "]; cost=" << cost_;
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& in = ctx->input(0);
+    std::vector<const T*> args;
+    std::vector<bool> args_are_scalars;
+    OP_REQUIRES_OK(ctx, GetFusedElementwiseArgs(ctx, &args, &args_are_scalars));
+
+    Tensor* out = nullptr;
+    OP_REQUIRES_OK(
+        ctx, ctx->forward_input_or_allocate_output({0}, 0, in.shape(), &out));
+    if (in.NumElements() == 0) return;
+
+    const T* in_data = in.flat<T>().data();
+    T* out_data = out->flat<T>().data();
+
+    // Runs all the ops on one block before moving on to the next, so that the
+    // intermediate results, kept in the output, stay in cache.
+    auto compute_fn = [this, in_data, out_data, &args, &args_are_scalars](
+                          int64_t start, int64_t limit) {
+      for (int64_t begin = start; begin < limit;
+           begin += kFusedElementwiseBlockSize) {
+        const int64_t len =
+            std::min<int64_t>(kFusedElementwiseBlockSize, limit - begin);
+        Buffer out_block(out_data + begin, len);
+        const ConstBuffer result_block(out_data + begin, len);
+
+        int arg_index = 0;
+        for (size_t i = 0; i < steps_.size(); ++i) {
+          const Step& step = steps_[i];
+          const ConstBuffer x =
+              i == 0 ? ConstBuffer(in_data + begin, len) : result_block;
+          if (step.unary != nullptr) {
+            step.unary(x, &out_block);
+          } else if (args_are_scalars[arg_index]) {
+            step.binary_scalar(x, args[arg_index], &out_block);
+            ++arg_index;
+          } else {
+            const ConstBuffer y(args[arg_index] + begin, len);
+            step.binary(x, y, &out_block);
+            ++arg_index;
+          }
+        }
+      }
+    };
+
+    const CPUDevice& device = ctx->eigen_device<CPUDevice>();
+    const int kOverheadCycles = static_cast<int>(steps_.size()) * 10;
+    Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(T) * ctx->num_inputs(),
+                             /*bytes_stored=*/sizeof(T),
+                             kOverheadCycles + cost_);
+    device.parallelFor(in.NumElements(), cost, std::move(compute_fn));
+  }
+
+ private:
+  // Exactly one of `unary` and `binary` is set. `binary_scalar` is set iff
+  // `binary` is.
+  struct Step {
+    UnaryFn unary;
+    BinaryFn binary;
+    BinaryScalarFn binary_scalar;
+    int cost;
+  };
+
+  template <typename Functor>
+  static void ComputeUnary(const ConstBuffer& x, Buffer* out) {
+    *out = x.unaryExpr(typename Functor::func());
+  }
+
+  template <typename Functor>
+  static void ComputeBinary(const ConstBuffer& x, const ConstBuffer& y,
+                            Buffer* out) {
+    *out = x.binaryExpr(y, typename Functor::func());
+  }
+
+  template <typename Functor>
+  static void ComputeBinaryScalar(const ConstBuffer& x, const T* y,
+                                  Buffer* out) {
+    using Binary = typename Functor::func;
+    *out = x.unaryExpr(Eigen::internal::scalar_right<T, T, Binary>(y));
+  }
+
+  // Same as the Relu and Relu6 functors in relu_op_functor.h.
+  static void ComputeRelu(const ConstBuffer& x, Buffer* out) {
+    *out = x.template cwiseMax<Eigen::PropagateNaN>(static_cast<T>(0));
+  }
+
+  static void ComputeRelu6(const ConstBuffer& x, Buffer* out) {
+    *out = x.template cwiseMax<Eigen::PropagateNaN>(static_cast<T>(0))
+               .template cwiseMin<Eigen::PropagateNaN>(static_cast<T>(6));
+  }
+
+  template <typename Functor>
+  static Step UnaryStep() {
+    return {ComputeUnary<Functor>, nullptr, nullptr,
+            Eigen::internal::functor_traits<typename Functor::func>::Cost};
+  }
+
+  template <typename Functor>
+  static Step BinaryStep() {
+    return {nullptr, ComputeBinary<Functor>, ComputeBinaryScalar<Functor>,
+            Eigen::internal::functor_traits<typename Functor::func>::Cost};
+  }
+
+  // WARN: This should be consistent with the elementwise chain fusion in
+  // grappler/optimizers/remapper.cc.
+  static const std::unordered_map<string, Step>& SupportedOps() {
+    using Max = Eigen::internal::scalar_max_op<T>;
+    static const auto* ops = new std::unordered_map<string, Step>({
+        // Unary ops.
+        {"Abs", UnaryStep<functor::abs<T>>()},
+        {"Exp", UnaryStep<functor::exp<T>>()},
+        {"Inv", UnaryStep<functor::inverse<T>>()},
+        {"Log", UnaryStep<functor::log<T>>()},
+        {"Neg", UnaryStep<functor::neg<T>>()},
+        {"Reciprocal", UnaryStep<functor::inverse<T>>()},
+        {"Relu",
+         {ComputeRelu, nullptr, nullptr,
+          Eigen::internal::functor_traits<Max>::Cost}},
+        {"Relu6",
+         {ComputeRelu6, nullptr, nullptr,
+          2 * Eigen::internal::functor_traits<Max>::Cost}},
+        {"Rsqrt", UnaryStep<functor::rsqrt<T>>()},
+        {"Sigmoid", UnaryStep<functor::sigmoid<T>>()},
+        {"Sqrt", UnaryStep<functor::sqrt<T>>()},
+        {"Square", UnaryStep<functor::square<T>>()},
+        {"Tanh", UnaryStep<functor::tanh<T>>()},
+        // Binary ops, the running result is their first operand.
+        {"Add", BinaryStep<functor::add<T>>()},
+        {"AddV2", BinaryStep<functor::add<T>>()},
+        {"Div", BinaryStep<functor::div<T>>()},
+        {"Maximum", BinaryStep<functor::maximum<T>>()},
+        {"Minimum", BinaryStep<functor::minimum<T>>()},
+        {"Mul", BinaryStep<functor::mul<T>>()},
+        {"RealDiv", BinaryStep<functor::div<T>>()},
+        {"SquaredDifference", BinaryStep<functor::squared_difference<T>>()},
+        {"Sub", BinaryStep<functor::sub<T>>()},
+    });
+    return *ops;
+  }
+
+  std::vector<Step> steps_;
+  int cost_ = 0;
+};
+
+#define REGISTER_CPU(T)                                                    \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("_FusedElementwise").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedElementwiseOp<T>);
+
+REGISTER_CPU(float);
+REGISTER_CPU(Eigen::half);
+REGISTER_CPU(bfloat16);
+REGISTER_CPU(double);
+
+#undef REGISTER_CPU
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+typedef Eigen::GpuDevice GPUDevice;
+
+// Runs the whole chain in one kernel launch instead of one launch per op, which
+// is what dominates the cost of a chain of ops on small tensors.
+template <typename T>
+class FusedElementwiseGpuOp : public OpKernel {
+ public:
+  explicit FusedElementwiseGpuOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> fused_ops;
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops));
+    OP_REQUIRES(context, !fused_ops.empty(),
+                errors::InvalidArgument(
+                    "_FusedElementwise must have at least one fused op"));
+
+    const auto& supported_ops = SupportedOps();
+    int num_binary_ops = 0;
+    for (const string& op_name : fused_ops) {
+      auto it = supported_ops.find(op_name);
+      OP_REQUIRES(context, it != supported_ops.end(),
+                  errors::InvalidArgument(
+                      "_FusedElementwise does not support op: ", op_name));
+      opcodes_.push_back(it->second);
+      if (it->second >= functor::FusedElementwiseOpcode::kAdd) {
+        ++num_binary_ops;
+      }
+    }
+    OP_REQUIRES_OK(context,
+                   CheckNumFusedElementwiseInputs(context, num_binary_ops));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& in = ctx->input(0);
+    std::vector<const T*> args;
+    std::vector<bool> args_are_scalars;
+    OP_REQUIRES_OK(ctx, GetFusedElementwiseArgs(ctx, &args, &args_are_scalars));
+
+    Tensor* out = nullptr;
+    OP_REQUIRES_OK(
+        ctx, ctx->forward_input_or_allocate_output({0}, 0, in.shape(), &out));
+    const int64_t size = in.NumElements();
+    if (size == 0) return;
+
+    // Chains longer than kMaxFusedElementwiseSteps continue in place on the
+    // output.
+    const T* in_data = in.flat<T>().data();
+    T* out_data = out->flat<T>().data();
+    functor::FusedElementwiseSteps<T> steps;
+    int arg_index = 0;
+    for (size_t i = 0; i < opcodes_.size(); ++i) {
+      const int s = steps.num_steps++;
+      steps.opcodes[s] = opcodes_[i];
+      steps.args[s] = nullptr;
+      steps.arg_is_scalar[s] = false;
+      if (opcodes_[i] >= functor::FusedElementwiseOpcode::kAdd) {
+        steps.args[s] = args[arg_index];
+        steps.arg_is_scalar[s] = args_are_scalars[arg_index];
+        ++arg_index;
+      }
+      if (steps.num_steps == functor::kMaxFusedElementwiseSteps ||
+          i + 1 == opcodes_.size()) {
+        functor::FusedElementwise<GPUDevice, T>()(
+            ctx->eigen_device<GPUDevice>(), size, in_data, steps, out_data);
+        in_data = out_data;
+        steps.num_steps = 0;
+      }
+    }
+  }
+
+ private:
+  // WARN: This should be consistent with FusedElementwiseOp::SupportedOps().
+  static const std::unordered_map<string, functor::FusedElementwiseOpcode>&
+  SupportedOps() {
+    using Opcode = functor::FusedElementwiseOpcode;
+    static const auto* ops = new std::unordered_map<string, Opcode>({
+        {"Abs", Opcode::kAbs},
+        {"Exp", Opcode::kExp},
+        {"Inv", Opcode::kInv},
+        {"Log", Opcode::kLog},
+        {"Neg", Opcode::kNeg},
+        {"Reciprocal", Opcode::kInv},
+        {"Relu", Opcode::kRelu},
+        {"Relu6", Opcode::kRelu6},
+        {"Rsqrt", Opcode::kRsqrt},
+        {"Sigmoid", Opcode::kSigmoid},
+        {"Sqrt", Opcode::kSqrt},
+        {"Square", Opcode::kSquare},
+        {"Tanh", Opcode::kTanh},
+        {"Add", Opcode::kAdd},
+        {"AddV2", Opcode::kAdd},
+        {"Div", Opcode::kDiv},
+        {"Maximum", Opcode::kMaximum},
+        {"Minimum", Opcode::kMinimum},
+        {"Mul", Opcode::kMul},
+        {"RealDiv", Opcode::kDiv},
+        {"SquaredDifference", Opcode::kSquaredDifference},
+        {"Sub", Opcode::kSub},
+    });
+    return *ops;
+  }
+
+  std::vector<functor::FusedElementwiseOpcode> opcodes_;
+};
+
+// Forward declarations of the functor specializations for GPU.
+namespace functor {
+#define DECLARE_GPU_SPEC(T)                                                \
+  template <>                                                              \
+  void FusedElementwise<GPUDevice, T>::operator()(                         \
+      const GPUDevice& d, int64_t size, const T* in,                       \
+      const FusedElementwiseSteps<T>& steps, T* out);                      \
+  extern template struct FusedElementwise<GPUDevice, T>;
+
+DECLARE_GPU_SPEC(float);
+DECLARE_GPU_SPEC(Eigen::half);
+DECLARE_GPU_SPEC(double);
+
+#undef DECLARE_GPU_SPEC
+}  // namespace functor
+
+#define REGISTER_GPU(T)                                                    \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("_FusedElementwise").Device(DEVICE_GPU).TypeConstraint<T>("T"), \
+      FusedElementwiseGpuOp<T>);
+
+REGISTER_GPU(float);
+REGISTER_GPU(Eigen::half);
+REGISTER_GPU(double);
+
+#undef REGISTER_GPU
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace tensorflow
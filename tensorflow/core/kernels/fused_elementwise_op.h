@@ -0,0 +1,77 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_FUSED_ELEMENTWISE_OP_H_
+#define TENSORFLOW_CORE_KERNELS_FUSED_ELEMENTWISE_OP_H_
+// Functor definition for the GPU FusedElementwiseOp, must be compilable by
+// nvcc.
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace functor {
+
+// The ops of a fused elementwise chain. Binary ops take the running result as
+// their first operand.
+enum class FusedElementwiseOpcode : int32 {
+  // Unary ops.
+  kAbs,
+  kExp,
+  kInv,
+  kLog,
+  kNeg,
+  kRelu,
+  kRelu6,
+  kRsqrt,
+  kSigmoid,
+  kSqrt,
+  kSquare,
+  kTanh,
+  // Binary ops.
+  kAdd,
+  kDiv,
+  kMaximum,
+  kMinimum,
+  kMul,
+  kSquaredDifference,
+  kSub,
+};
+
+// The ops that one kernel launch applies. Longer chains take several launches.
+constexpr int kMaxFusedElementwiseSteps = 16;
+
+// Passed to the kernel by value, so it must stay trivially copyable.
+template <typename T>
+struct FusedElementwiseSteps {
+  int num_steps = 0;
+  FusedElementwiseOpcode opcodes[kMaxFusedElementwiseSteps];
+  // The other operand of each binary step, unused for unary steps. It has
+  // `size` elements, or one if `arg_is_scalar` is set.
+  const T* args[kMaxFusedElementwiseSteps];
+  bool arg_is_scalar[kMaxFusedElementwiseSteps];
+};
+
+// Computes `out = steps(in)` for the `size` elements of `in` in a single
+// kernel launch. `in` and `out` may be the same buffer.
+template <typename Device, typename T>
+struct FusedElementwise {
+  void operator()(const Device& d, int64_t size, const T* in,
+                  const FusedElementwiseSteps<T>& steps, T* out);
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_FUSED_ELEMENTWISE_OP_H_
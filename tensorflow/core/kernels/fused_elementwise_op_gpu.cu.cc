@@ -0,0 +1,137 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include <algorithm>
+#include <limits>
+
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/cwise_ops.h"
+#include "tensorflow/core/kernels/fused_elementwise_op.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace functor {
+
+// Uses the same Eigen functors as the CPU kernel, so that both devices compute
+// the same results.
+template <typename T>
+__device__ EIGEN_ALWAYS_INLINE T ApplyFusedElementwiseStep(
+    FusedElementwiseOpcode opcode, T x, T y) {
+  switch (opcode) {
+    case FusedElementwiseOpcode::kAbs:
+      return typename abs<T>::func()(x);
+    case FusedElementwiseOpcode::kExp:
+      return typename exp<T>::func()(x);
+    case FusedElementwiseOpcode::kInv:
+      return typename inverse<T>::func()(x);
+    case FusedElementwiseOpcode::kLog:
+      return typename log<T>::func()(x);
+    case FusedElementwiseOpcode::kNeg:
+      return typename neg<T>::func()(x);
+    case FusedElementwiseOpcode::kRelu:
+      return Eigen::numext::isnan(x) || x > T(0) ? x : T(0);
+    case FusedElementwiseOpcode::kRelu6:
+      if (Eigen::numext::isnan(x)) return x;
+      return x < T(0) ? T(0) : (x > T(6) ? T(6) : x);
+    case FusedElementwiseOpcode::kRsqrt:
+      return typename rsqrt<T>::func()(x);
+    case FusedElementwiseOpcode::kSigmoid:
+      return typename sigmoid<T>::func()(x);
+    case FusedElementwiseOpcode::kSqrt:
+      return typename sqrt<T>::func()(x);
+    case FusedElementwiseOpcode::kSquare:
+      return typename square<T>::func()(x);
+    case FusedElementwiseOpcode::kTanh:
+      return typename tanh<T>::func()(x);
+    case FusedElementwiseOpcode::kAdd:
+      return typename add<T>::func()(x, y);
+    case FusedElementwiseOpcode::kDiv:
+      return typename div<T>::func()(x, y);
+    case FusedElementwiseOpcode::kMaximum:
+      return typename maximum<T>::func()(x, y);
+    case FusedElementwiseOpcode::kMinimum:
+      return typename minimum<T>::func()(x, y);
+    case FusedElementwiseOpcode::kMul:
+      return typename mul<T>::func()(x, y);
+    case FusedElementwiseOpcode::kSquaredDifference:
+      return typename squared_difference<T>::func()(x, y);
+    case FusedElementwiseOpcode::kSub:
+      return typename sub<T>::func()(x, y);
+  }
+  return x;
+}
+
+// Each thread keeps the running result of its elements in a register, so that
+// the intermediate results of the chain never go to global memory. `in` may
+// alias `out`, which is why neither is __restrict__.
+template <typename T>
+__global__ void FusedElementwiseKernel(int64_t size, const T* in,
+                                       const FusedElementwiseSteps<T> steps,
+                                       T* out) {
+  for (int64_t i : GpuGridRangeX<int64_t>(size)) {
+    T x = in[i];
+    for (int s = 0; s < steps.num_steps; ++s) {
+      const FusedElementwiseOpcode opcode = steps.opcodes[s];
+      T y = T(0);
+      if (opcode >= FusedElementwiseOpcode::kAdd) {
+        y = steps.args[s][steps.arg_is_scalar[s] ? 0 : i];
+      }
+      x = ApplyFusedElementwiseStep<T>(opcode, x, y);
+    }
+    out[i] = x;
+  }
+}
+
+template <typename T>
+void LaunchFusedElementwiseKernel(const GPUDevice& d, int64_t size, const T* in,
+                                  const FusedElementwiseSteps<T>& steps,
+                                  T* out) {
+  if (size == 0) return;
+  // The kernel loops over the elements, so the grid need not cover them all.
+  const int work = static_cast<int>(
+      std::min<int64_t>(size, std::numeric_limits<int>::max()));
+  GpuLaunchConfig config =
+      GetGpuLaunchConfig(work, d, FusedElementwiseKernel<T>, 0, 0);
+  TF_CHECK_OK(GpuLaunchKernel(FusedElementwiseKernel<T>, config.block_count,
+                              config.thread_per_block, 0, d.stream(), size, in,
+                              steps, out));
+}
+
+#define DEFINE_GPU_SPEC(T)                                              \
+  template <>                                                           \
+  void FusedElementwise<GPUDevice, T>::operator()(                      \
+      const GPUDevice& d, int64_t size, const T* in,                    \
+      const FusedElementwiseSteps<T>& steps, T* out) {                  \
+    LaunchFusedElementwiseKernel<T>(d, size, in, steps, out);           \
+  }                                                                     \
+  template struct FusedElementwise<GPUDevice, T>;
+
+DEFINE_GPU_SPEC(float);
+DEFINE_GPU_SPEC(Eigen::half);
+DEFINE_GPU_SPEC(double);
+
+#undef DEFINE_GPU_SPEC
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -0,0 +1,103 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedElementwiseOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(const std::vector<string>& fused_ops, int num_args) {
+    TF_ASSERT_OK(NodeDefBuilder("fused_elementwise", "_FusedElementwise")
+                     .Input(FakeInput(num_args, DT_FLOAT))
+                     .Attr("T", DT_FLOAT)
+                     .Attr("fused_ops", fused_ops)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(FusedElementwiseOpTest, UnaryAndBinaryOps) {
+  MakeOp({"Mul", "Add", "Tanh", "Sub"}, 4);
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({2, 2}), {0.5, 0.25, -0.5, 0});
+  AddInputFromArray<float>(TensorShape({}), {0.1});
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 1, 2, 2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {std::tanh(1 * 0.5f + 0.1f) - 1,
+                                     std::tanh(2 * 0.25f + 0.1f) - 1,
+                                     std::tanh(3 * -0.5f + 0.1f) - 2,
+                                     std::tanh(4 * 0.0f + 0.1f) - 2});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, SpansSeveralBlocks) {
+  const int size = 10000;
+  MakeOp({"Square", "Maximum", "Relu", "RealDiv"}, 3);
+  std::vector<float> x(size);
+  std::vector<float> y(size);
+  for (int i = 0; i < size; ++i) {
+    x[i] = static_cast<float>(i % 7) - 3;
+    y[i] = static_cast<float>(i % 5);
+  }
+  AddInputFromArray<float>(TensorShape({size}), x);
+  AddInputFromArray<float>(TensorShape({size}), y);
+  AddInputFromArray<float>(TensorShape({}), {2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::vector<float> values(size);
+  for (int i = 0; i < size; ++i) {
+    values[i] = std::max(0.0f, std::max(x[i] * x[i], y[i])) / 2;
+  }
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({size}));
+  test::FillValues<float>(&expected, values);
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, RejectsBroadcast) {
+  MakeOp({"Add"}, 2);
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  EXPECT_TRUE(absl::StrContains(s.error_message(), "must be a scalar")) << s;
+}
+
+TEST_F(FusedElementwiseOpTest, RejectsWrongNumberOfArgs) {
+  TF_ASSERT_OK(NodeDefBuilder("fused_elementwise", "_FusedElementwise")
+                   .Input(FakeInput(1, DT_FLOAT))
+                   .Attr("T", DT_FLOAT)
+                   .Attr("fused_ops", {"Mul", "Tanh"})
+                   .Finalize(node_def()));
+  Status s = InitOp();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,8 +15,10 @@ limitations under the License.
 
 // See docs in ../ops/image_ops.cc
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/lib/gtl/cleanup.h"
 
@@ -37,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -69,6 +72,37 @@ FileFormat ClassifyFileFormat(StringPiece data) {
   return kUnknownFormat;
 }
 
+// Reads the JPEG decoding attributes shared by `DecodeJpeg`,
+// `DecodeAndCropJpeg` and `BatchDecodeJpeg` into `flags`.
+Status GetJpegAttrs(OpKernelConstruction* context,
+                    jpeg::UncompressFlags* flags) {
+  TF_RETURN_IF_ERROR(context->GetAttr("ratio", &flags->ratio));
+  if (flags->ratio != 1 && flags->ratio != 2 && flags->ratio != 4 &&
+      flags->ratio != 8) {
+    return errors::InvalidArgument("ratio must be 1, 2, 4, or 8, got ",
+                                   flags->ratio);
+  }
+  TF_RETURN_IF_ERROR(
+      context->GetAttr("fancy_upscaling", &flags->fancy_upscaling));
+  TF_RETURN_IF_ERROR(context->GetAttr("try_recover_truncated",
+                                      &flags->try_recover_truncated_jpeg));
+  TF_RETURN_IF_ERROR(context->GetAttr("acceptable_fraction",
+                                      &flags->min_acceptable_fraction));
+  string dct_method;
+  TF_RETURN_IF_ERROR(context->GetAttr("dct_method", &dct_method));
+  // The TensorFlow-chosen default for JPEG decoding is IFAST, sacrificing
+  // image quality for speed.
+  if (dct_method.empty() || dct_method == "INTEGER_FAST") {
+    flags->dct_method = JDCT_IFAST;
+  } else if (dct_method == "INTEGER_ACCURATE") {
+    flags->dct_method = JDCT_ISLOW;
+  } else {
+    return errors::InvalidArgument(
+        "dct_method must be one of {'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}");
+  }
+  return Status::OK();
+}
+
 // Decode an image. Supported image formats are JPEG, PNG, GIF and BMP. This is
 // a newer version of `DecodeImageOp` for enabling image data parsing to take
 // place in kernels only, reducing security vulnerabilities and redundancy.
@@ -94,35 +128,7 @@ class DecodeImageV2Op : public OpKernel {
     // invocations. For `DecodeImage` op, set JPEG decoding setting to TF
     // default.
     if (op_type_ == "DecodeJpeg" || op_type_ == "DecodeAndCropJpeg") {
-      OP_REQUIRES_OK(context, context->GetAttr("ratio", &flags_.ratio));
-      OP_REQUIRES(context,
-                  flags_.ratio == 1 || flags_.ratio == 2 || flags_.ratio == 4 ||
-                      flags_.ratio == 8,
-                  errors::InvalidArgument("ratio must be 1, 2, 4, or 8, got ",
-                                          flags_.ratio));
-      OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
-                                               &flags_.fancy_upscaling));
-      OP_REQUIRES_OK(context,
-                     context->GetAttr("try_recover_truncated",
-                                      &flags_.try_recover_truncated_jpeg));
-      OP_REQUIRES_OK(context,
-                     context->GetAttr("acceptable_fraction",
-                                      &flags_.min_acceptable_fraction));
-      string dct_method;
-      OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
-      OP_REQUIRES(
-          context,
-          (dct_method.empty() || dct_method == "INTEGER_FAST" ||
-           dct_method == "INTEGER_ACCURATE"),
-          errors::InvalidArgument("dct_method must be one of "
-                                  "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
-      // The TensorFlow-chosen default for JPEG decoding is IFAST, sacrificing
-      // image quality for speed.
-      if (dct_method.empty() || dct_method == "INTEGER_FAST") {
-        flags_.dct_method = JDCT_IFAST;
-      } else if (dct_method == "INTEGER_ACCURATE") {
-        flags_.dct_method = JDCT_ISLOW;
-      }
+      OP_REQUIRES_OK(context, GetJpegAttrs(context, &flags_));
     } else {
       flags_ = jpeg::UncompressFlags();
       flags_.dct_method = JDCT_IFAST;
@@ -681,6 +687,114 @@ REGISTER_KERNEL_BUILDER(Name("DecodeImage").Device(DEVICE_CPU),
                         DecodeImageV2Op);
 REGISTER_KERNEL_BUILDER(Name("DecodeBmp").Device(DEVICE_CPU), DecodeImageV2Op);
 
+// Decodes a batch of JPEG images of the same decoded shape into a single 4-D
+// tensor. The images are decoded in parallel on the intra-op thread pool,
+// each straight into its slice of the output.
+class BatchDecodeJpegOp : public OpKernel {
+ public:
+  explicit BatchDecodeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, GetJpegAttrs(context, &flags_));
+    int channels;
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels));
+    OP_REQUIRES(context, channels == 0 || channels == 1 || channels == 3,
+                errors::InvalidArgument("`channels` must be 0, 1 or 3 but got ",
+                                        channels));
+    flags_.components = channels;
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsVector(contents.shape()),
+        errors::InvalidArgument("`contents` must be a vector but got shape ",
+                                contents.shape().DebugString()));
+    const auto inputs = contents.vec<tstring>();
+    const int64_t batch_size = inputs.size();
+    for (int64_t i = 0; i < batch_size; ++i) {
+      OP_REQUIRES(context, ClassifyFileFormat(inputs(i)) == kJpgFormat,
+                  errors::InvalidArgument("Image ", i,
+                                          " of the batch is not a JPEG."));
+      OP_REQUIRES(
+          context, inputs(i).size() <= std::numeric_limits<int>::max(),
+          errors::InvalidArgument("Image ", i, " of the batch is too large ",
+                                  "for int: ", inputs(i).size()));
+    }
+    Tensor* output = nullptr;
+    if (batch_size == 0) {
+      OP_REQUIRES_OK(context,
+                     context->allocate_output(
+                         0, TensorShape({0, 0, 0, flags_.components}),
+                         &output));
+      return;
+    }
+
+    // The first image determines the shape of the batch.
+    uint8* buffer = jpeg::Uncompress(
+        inputs(0).data(), inputs(0).size(), flags_, nullptr /* nwarn */,
+        [&](int width, int height, int channels) -> uint8* {
+          Status status = context->allocate_output(
+              0, TensorShape({batch_size, height, width, channels}), &output);
+          if (!status.ok()) {
+            VLOG(1) << status;
+            context->SetStatus(status);
+            return nullptr;
+          }
+          return output->flat<uint8>().data();
+        });
+    OP_REQUIRES(context, buffer,
+                errors::InvalidArgument("jpeg::Uncompress failed for image 0 "
+                                        "of the batch. Invalid JPEG data."));
+
+    const int64_t height = output->dim_size(1);
+    const int64_t width = output->dim_size(2);
+    const int64_t channels = output->dim_size(3);
+    const int64_t image_size = height * width * channels;
+    std::vector<Status> statuses(batch_size);
+    auto decode_images = [&](int64_t start, int64_t limit) {
+      for (int64_t i = start; i < limit; ++i) {
+        bool same_shape = true;
+        uint8* image = jpeg::Uncompress(
+            inputs(i).data(), inputs(i).size(), flags_, nullptr /* nwarn */,
+            [&](int w, int h, int c) -> uint8* {
+              if (h != height || w != width || c != channels) {
+                same_shape = false;
+                statuses[i] = errors::InvalidArgument(
+                    "Image ", i, " of the batch has shape [", h, ",", w, ",",
+                    c, "] but image 0 has shape [", height, ",", width, ",",
+                    channels, "]. The images of a batch must have the same ",
+                    "shape.");
+                return nullptr;
+              }
+              return output->flat<uint8>().data() + i * image_size;
+            });
+        if (image == nullptr && same_shape) {
+          statuses[i] = errors::InvalidArgument(
+              "jpeg::Uncompress failed for image ", i,
+              " of the batch. Invalid JPEG data.");
+        }
+      }
+    };
+    // Decoding costs some tens of cycles per output byte.
+    const int64_t cost_per_image = std::max<int64_t>(image_size, 1) * 50;
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size - 1,
+          cost_per_image, [&](int64_t start, int64_t limit) {
+            decode_images(start + 1, limit + 1);
+          });
+    for (const Status& status : statuses) {
+      OP_REQUIRES_OK(context, status);
+    }
+  }
+
+ private:
+  jpeg::UncompressFlags flags_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("BatchDecodeJpeg").Device(DEVICE_CPU),
+                        BatchDecodeJpegOp);
+
 void DecodeImageV2Op::DecodeBMP(const uint8* input, const int row_size,
                                 uint8* const output, const int width,
                                 const int height, const int output_channels,
@@ -62,6 +62,10 @@ constexpr int kNmsBoxesPerThreadShiftBits =
 constexpr int kNmsBlockDim = 16;
 constexpr int kNmsBlockDimMax = 128;
 constexpr int kNmsChunkSize = 2000;
+// The largest z dimension of a grid, and the threads per block that
+// CombinedNMSReduce uses to update the bitmask of a segment.
+constexpr int kMaxGridDimZ = 65535;
+constexpr int kCombinedNmsReduceThreads = 256;
 
 template <typename T>
 __device__ EIGEN_STRONG_INLINE void Swap(T& a, T& b) {
@@ -641,6 +645,546 @@ class NonMaxSuppressionV4GPUOp : public OpKernel {
   bool pad_to_max_output_size_;
 };
 
+// Kernels for CombinedNonMaxSuppression. Each (batch, class) pair is a
+// segment of num_boxes candidates, and all segments are processed by the same
+// kernel launches.
+
+// Writes the scores of each segment contiguously, with the box indices as the
+// values to sort along with them.
+__global__ void CombinedNMSTransposeScores(const int num_elements,
+                                           const int num_boxes,
+                                           const int num_classes,
+                                           const float* scores,
+                                           float* segment_scores,
+                                           int* segment_indices) {
+  for (int idx : GpuGridRangeX(num_elements)) {
+    const int segment = idx / num_boxes;
+    const int box = idx % num_boxes;
+    const int batch = segment / num_classes;
+    const int class_idx = segment % num_classes;
+    segment_scores[idx] =
+        scores[(batch * num_boxes + box) * num_classes + class_idx];
+    segment_indices[idx] = box;
+  }
+}
+
+__global__ void CombinedNMSSegmentOffsets(const int num_offsets,
+                                          const int segment_size,
+                                          int* offsets) {
+  for (int idx : GpuGridRangeX(num_offsets)) {
+    offsets[idx] = idx * segment_size;
+  }
+}
+
+// Gathers the boxes of each segment in sorted order, and counts the candidates
+// of each segment, i.e. the sorted scores above score_threshold.
+__global__ void CombinedNMSGatherBoxes(
+    const int num_elements, const int num_boxes, const int num_classes,
+    const int q, const float score_threshold, const float* boxes,
+    const float* sorted_scores, const int* sorted_indices, Box* sorted_boxes,
+    int* num_candidates, int* max_num_candidates) {
+  for (int idx : GpuGridRangeX(num_elements)) {
+    const int segment = idx / num_boxes;
+    const int batch = segment / num_classes;
+    const int class_idx = q > 1 ? segment % num_classes : 0;
+    const float* box =
+        boxes + ((batch * num_boxes + sorted_indices[idx]) * q + class_idx) * 4;
+    sorted_boxes[idx] = {box[0], box[1], box[2], box[3]};
+    // The scores are sorted, so the segment's last candidate is the one
+    // followed by a score at or below the threshold.
+    const int position = idx % num_boxes;
+    const bool is_candidate = sorted_scores[idx] > score_threshold;
+    const bool is_last = position == num_boxes - 1 ||
+                         !(sorted_scores[idx + 1] > score_threshold);
+    if (is_candidate && is_last) {
+      num_candidates[segment] = position + 1;
+      atomicMax(max_num_candidates, position + 1);
+    }
+  }
+}
+
+// The batched version of NMSKernel. blockIdx.z walks the segments, and within
+// each segment, the bitmask of box i has the bits of the later candidates j
+// that it suppresses.
+__launch_bounds__(kNmsBlockDim* kNmsBlockDim, 4) __global__
+    void CombinedNMSKernel(const Box* sorted_boxes, const int num_segments,
+                           const int num_boxes, const int* num_candidates,
+                           const int max_num_candidates,
+                           const float iou_threshold, const int bit_mask_len,
+                           int* delete_mask) {
+  __shared__ Box shared_i_boxes[kNmsBlockDim];
+  __shared__ float shared_i_areas[kNmsBlockDim];
+  for (int segment = blockIdx.z; segment < num_segments;
+       segment += gridDim.z) {
+    const Box* boxes = sorted_boxes + static_cast<int64_t>(segment) * num_boxes;
+    const int n = num_candidates[segment];
+    int* mask = delete_mask +
+                static_cast<int64_t>(segment) * max_num_candidates *
+                    bit_mask_len;
+    // The loop bounds are common to the block, so that __syncthreads() can be
+    // called inside the loop.
+    for (int i_block_offset = blockIdx.x * blockDim.x; i_block_offset < n;
+         i_block_offset += blockDim.x * gridDim.x) {
+      const int i = i_block_offset + threadIdx.x;
+      if (i < n && threadIdx.y == 0) {
+        Box box = boxes[i];
+        Flipped<true>(box);
+        shared_i_boxes[threadIdx.x] = box;
+        shared_i_areas[threadIdx.x] = (box.x2 - box.x1) * (box.y2 - box.y1);
+      }
+      __syncthreads();
+      for (int j_thread_offset =
+               kNmsBoxesPerThread * (blockIdx.y * blockDim.y + threadIdx.y);
+           j_thread_offset < n;
+           j_thread_offset += kNmsBoxesPerThread * blockDim.y * gridDim.y) {
+        int above_threshold = 0;
+        bool valid = false;
+        for (int ib = 0; ib < kNmsBoxesPerThread; ++ib) {
+          const int j = j_thread_offset + ib;
+          if (i >= j || i >= n || j >= n) continue;
+          valid = true;
+          Box j_box = boxes[j];
+          Flipped<true>(j_box);
+          if (OverThreshold<float>(&shared_i_boxes[threadIdx.x], &j_box,
+                                   shared_i_areas[threadIdx.x],
+                                   iou_threshold)) {
+            above_threshold |= (1U << ib);
+          }
+        }
+        if (valid) {
+          mask[i * bit_mask_len + j_thread_offset / kNmsBoxesPerThread] =
+              above_threshold;
+        }
+      }
+      __syncthreads();
+    }
+  }
+}
+
+// Greedily selects up to max_size_per_class candidates of each segment from
+// their bitmasks, with one block per segment. `removed` holds bit_mask_len
+// words of scratch per segment.
+__global__ void CombinedNMSReduce(const int* delete_mask,
+                                  const int* num_candidates,
+                                  const int max_num_candidates,
+                                  const int bit_mask_len,
+                                  const int max_size_per_class, int* removed,
+                                  int* selected, int* num_selected) {
+  const int segment = blockIdx.x;
+  const int n = num_candidates[segment];
+  const int* mask = delete_mask + static_cast<int64_t>(segment) *
+                                      max_num_candidates * bit_mask_len;
+  int* segment_removed = removed + static_cast<int64_t>(segment) * bit_mask_len;
+  int* segment_selected = selected + segment * max_size_per_class;
+  for (int word = threadIdx.x; word < bit_mask_len; word += blockDim.x) {
+    segment_removed[word] = 0;
+  }
+  __syncthreads();
+  int count = 0;
+  for (int box = 0; box < n && count < max_size_per_class; ++box) {
+    if (CheckBit(segment_removed, box)) continue;
+    if (threadIdx.x == 0) segment_selected[count] = box;
+    ++count;
+    // Only candidates after `box` can be suppressed by it.
+    const int* box_mask = mask + box * bit_mask_len;
+    for (int word = box / kNmsBoxesPerThread + threadIdx.x;
+         word < bit_mask_len; word += blockDim.x) {
+      segment_removed[word] |= box_mask[word];
+    }
+    __syncthreads();
+  }
+  if (threadIdx.x == 0) num_selected[segment] = count;
+}
+
+// Writes the selected candidates of each segment as the key-value pairs to
+// sort per batch: the score, and the candidate's index into the sorted boxes.
+// Unused slots get the lowest score and sort last.
+__global__ void CombinedNMSGatherSelected(
+    const int num_elements, const int num_boxes, const int max_size_per_class,
+    const float* sorted_scores, const int* selected, const int* num_selected,
+    float* selected_scores, int* selected_indices) {
+  for (int idx : GpuGridRangeX(num_elements)) {
+    const int segment = idx / max_size_per_class;
+    const int k = idx % max_size_per_class;
+    if (k < num_selected[segment]) {
+      const int index = segment * num_boxes + selected[idx];
+      selected_scores[idx] = sorted_scores[index];
+      selected_indices[idx] = index;
+    } else {
+      selected_scores[idx] = -Eigen::NumTraits<float>::infinity();
+      selected_indices[idx] = -1;
+    }
+  }
+}
+
+// Writes the per_batch_size best selected candidates of each batch, padded
+// with zeros, and the number of valid detections.
+__global__ void CombinedNMSWriteOutputs(
+    const int num_elements, const int num_boxes, const int num_classes,
+    const int max_size_per_class, const int per_batch_size,
+    const bool clip_boxes, const Box* sorted_boxes,
+    const float* sorted_selected_scores, const int* sorted_selected_indices,
+    const int* num_selected, float* nmsed_boxes, float* nmsed_scores,
+    float* nmsed_classes, int* valid_detections) {
+  for (int idx : GpuGridRangeX(num_elements)) {
+    const int batch = idx / per_batch_size;
+    const int j = idx % per_batch_size;
+    int num_valid = 0;
+    for (int c = 0; c < num_classes; ++c) {
+      num_valid += num_selected[batch * num_classes + c];
+    }
+    num_valid = min(num_valid, per_batch_size);
+    if (j == 0) valid_detections[batch] = num_valid;
+    float* box_out = nmsed_boxes + idx * 4;
+    if (j >= num_valid) {
+      box_out[0] = box_out[1] = box_out[2] = box_out[3] = 0.0f;
+      nmsed_scores[idx] = 0.0f;
+      nmsed_classes[idx] = 0.0f;
+      continue;
+    }
+    const int selected_idx = batch * num_classes * max_size_per_class + j;
+    const int index = sorted_selected_indices[selected_idx];
+    Box box = sorted_boxes[index];
+    if (clip_boxes) {
+      box.x1 = fminf(fmaxf(box.x1, 0.0f), 1.0f);
+      box.y1 = fminf(fmaxf(box.y1, 0.0f), 1.0f);
+      box.x2 = fminf(fmaxf(box.x2, 0.0f), 1.0f);
+      box.y2 = fminf(fmaxf(box.y2, 0.0f), 1.0f);
+    }
+    box_out[0] = box.x1;
+    box_out[1] = box.y1;
+    box_out[2] = box.x2;
+    box_out[3] = box.y2;
+    nmsed_scores[idx] = sorted_selected_scores[selected_idx];
+    nmsed_classes[idx] = (index / num_boxes) % num_classes;
+  }
+}
+
+// Sorts `num_segments` contiguous segments of `segment_size` key-value pairs
+// by descending key.
+Status SegmentedSortPairsDescending(OpKernelContext* context,
+                                    const float* keys_in, float* keys_out,
+                                    const int* values_in, int* values_out,
+                                    const int num_segments,
+                                    const int segment_size) {
+  auto device = context->eigen_gpu_device();
+  Tensor offsets;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_INT32, TensorShape({num_segments + 1}), &offsets));
+  int* offsets_ptr = offsets.flat<int>().data();
+  auto config = GetGpuLaunchConfig(num_segments + 1, device);
+  TF_CHECK_OK(GpuLaunchKernel(CombinedNMSSegmentOffsets, config.block_count,
+                              config.thread_per_block, 0, device.stream(),
+                              config.virtual_thread_count, segment_size,
+                              offsets_ptr));
+  const int num_items = num_segments * segment_size;
+  size_t temp_storage_bytes = 0;
+  cudaError_t cuda_ret = gpuprim::DeviceSegmentedRadixSort::SortPairsDescending(
+      nullptr, temp_storage_bytes, keys_in, keys_out, values_in, values_out,
+      num_items, num_segments, offsets_ptr, offsets_ptr + 1, 0,
+      8 * sizeof(float), device.stream());
+  TF_RETURN_IF_CUDA_ERROR(cuda_ret);
+  Tensor temp_storage;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_INT8, TensorShape({(int64)temp_storage_bytes}),
+      &temp_storage));
+  cuda_ret = gpuprim::DeviceSegmentedRadixSort::SortPairsDescending(
+      temp_storage.flat<int8>().data(), temp_storage_bytes, keys_in, keys_out,
+      values_in, values_out, num_items, num_segments, offsets_ptr,
+      offsets_ptr + 1, 0, 8 * sizeof(float), device.stream());
+  TF_RETURN_IF_CUDA_ERROR(cuda_ret);
+  return Status::OK();
+}
+
+Status DoCombinedNMS(OpKernelContext* context, const Tensor& boxes,
+                     const Tensor& scores, const int max_size_per_class,
+                     const int max_total_size_per_batch,
+                     const float iou_threshold, const float score_threshold,
+                     const bool pad_per_class, const bool clip_boxes) {
+  const int num_batches = boxes.dim_size(0);
+  const int num_boxes = boxes.dim_size(1);
+  const int q = boxes.dim_size(2);
+  const int num_classes = scores.dim_size(2);
+  const int size_per_class = std::min(max_size_per_class, num_boxes);
+  int per_batch_size = max_total_size_per_batch;
+  if (pad_per_class) {
+    per_batch_size =
+        std::min(max_total_size_per_batch, max_size_per_class * num_classes);
+  }
+  auto device = context->eigen_gpu_device();
+
+  Tensor* nmsed_boxes = nullptr;
+  TF_RETURN_IF_ERROR(context->allocate_output(
+      0, TensorShape({num_batches, per_batch_size, 4}), &nmsed_boxes));
+  Tensor* nmsed_scores = nullptr;
+  TF_RETURN_IF_ERROR(context->allocate_output(
+      1, TensorShape({num_batches, per_batch_size}), &nmsed_scores));
+  Tensor* nmsed_classes = nullptr;
+  TF_RETURN_IF_ERROR(context->allocate_output(
+      2, TensorShape({num_batches, per_batch_size}), &nmsed_classes));
+  Tensor* valid_detections = nullptr;
+  TF_RETURN_IF_ERROR(context->allocate_output(
+      3, TensorShape({num_batches}), &valid_detections));
+  if (num_batches == 0) {
+    return Status::OK();
+  }
+  const int num_segments = num_batches * num_classes;
+  const int64_t num_elements = static_cast<int64_t>(num_segments) * num_boxes;
+  if (num_elements == 0) {
+    // There are no boxes, so there are no detections either.
+    device.memset(nmsed_boxes->flat<float>().data(), 0,
+                  nmsed_boxes->NumElements() * sizeof(float));
+    device.memset(nmsed_scores->flat<float>().data(), 0,
+                  nmsed_scores->NumElements() * sizeof(float));
+    device.memset(nmsed_classes->flat<float>().data(), 0,
+                  nmsed_classes->NumElements() * sizeof(float));
+    device.memset(valid_detections->flat<int>().data(), 0,
+                  valid_detections->NumElements() * sizeof(int));
+    return Status::OK();
+  }
+  if (num_elements > std::numeric_limits<int>::max()) {
+    return errors::InvalidArgument(
+        "CombinedNonMaxSuppression on GPU supports at most 2^31 - 1 "
+        "batch * box * class scores, got ",
+        num_elements);
+  }
+
+  // Sort the scores of each segment, gather its boxes in that order, and count
+  // its candidates.
+  Tensor segment_scores, segment_indices, sorted_scores, sorted_indices;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_FLOAT, TensorShape({num_elements}), &segment_scores));
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_INT32, TensorShape({num_elements}), &segment_indices));
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_FLOAT, TensorShape({num_elements}), &sorted_scores));
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_INT32, TensorShape({num_elements}), &sorted_indices));
+  Tensor sorted_boxes, num_candidates, max_num_candidates;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_FLOAT, TensorShape({num_elements, 4}), &sorted_boxes));
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_INT32, TensorShape({num_segments}), &num_candidates));
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_INT32, TensorShape({1}), &max_num_candidates));
+  const float* sorted_scores_ptr = sorted_scores.flat<float>().data();
+  const Box* sorted_boxes_ptr =
+      reinterpret_cast<const Box*>(sorted_boxes.flat<float>().data());
+  int* num_candidates_ptr = num_candidates.flat<int>().data();
+
+  auto config = GetGpuLaunchConfig(num_elements, device);
+  TF_CHECK_OK(GpuLaunchKernel(
+      CombinedNMSTransposeScores, config.block_count, config.thread_per_block,
+      0, device.stream(), config.virtual_thread_count, num_boxes, num_classes,
+      scores.flat<float>().data(), segment_scores.flat<float>().data(),
+      segment_indices.flat<int>().data()));
+  TF_RETURN_IF_CUDA_ERROR(cudaGetLastError());
+  TF_RETURN_IF_ERROR(SegmentedSortPairsDescending(
+      context, segment_scores.flat<float>().data(),
+      sorted_scores.flat<float>().data(), segment_indices.flat<int>().data(),
+      sorted_indices.flat<int>().data(), num_segments, num_boxes));
+  device.memset(num_candidates_ptr, 0, num_segments * sizeof(int));
+  device.memset(max_num_candidates.flat<int>().data(), 0, sizeof(int));
+  TF_CHECK_OK(GpuLaunchKernel(
+      CombinedNMSGatherBoxes, config.block_count, config.thread_per_block, 0,
+      device.stream(), config.virtual_thread_count, num_boxes, num_classes, q,
+      score_threshold, boxes.flat<float>().data(), sorted_scores_ptr,
+      sorted_indices.flat<int>().data(),
+      reinterpret_cast<Box*>(sorted_boxes.flat<float>().data()),
+      num_candidates_ptr, max_num_candidates.flat<int>().data()));
+  TF_RETURN_IF_CUDA_ERROR(cudaGetLastError());
+
+  // The bitmasks are sized by the largest number of candidates in a segment,
+  // which is only known on the device.
+  Tensor h_max_num_candidates;
+  AllocatorAttributes pinned_alloc_attrs;
+  pinned_alloc_attrs.set_on_host(true);
+  pinned_alloc_attrs.set_gpu_compatible(true);
+  TF_RETURN_IF_ERROR(context->allocate_temp(DataType::DT_INT32,
+                                            TensorShape({1}),
+                                            &h_max_num_candidates,
+                                            pinned_alloc_attrs));
+  device.memcpyDeviceToHost(h_max_num_candidates.flat<int>().data(),
+                            max_num_candidates.flat<int>().data(), sizeof(int));
+  gpuEvent_t copy_done;
+  TF_RETURN_IF_CUDA_ERROR(
+      gpuEventCreateWithFlags(&copy_done, gpuEventDisableTiming));
+  TF_RETURN_IF_CUDA_ERROR(gpuEventRecord(copy_done, device.stream()));
+  TF_RETURN_IF_CUDA_ERROR(gpuEventSynchronize(copy_done));
+  gpuEventDestroy(copy_done);
+  const int max_candidates = *h_max_num_candidates.flat<int>().data();
+
+  // Select the boxes of each segment.
+  Tensor selected, num_selected;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_INT32, TensorShape({num_segments * size_per_class}),
+      &selected));
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_INT32, TensorShape({num_segments}), &num_selected));
+  int* num_selected_ptr = num_selected.flat<int>().data();
+  if (max_candidates == 0) {
+    device.memset(num_selected_ptr, 0, num_segments * sizeof(int));
+  } else {
+    const int bit_mask_len =
+        (max_candidates + kNmsBoxesPerThread - 1) / kNmsBoxesPerThread;
+    Tensor delete_mask, removed;
+    TF_RETURN_IF_ERROR(context->allocate_temp(
+        DataType::DT_INT32,
+        TensorShape({static_cast<int64_t>(num_segments) * max_candidates *
+                     bit_mask_len}),
+        &delete_mask));
+    TF_RETURN_IF_ERROR(context->allocate_temp(
+        DataType::DT_INT32,
+        TensorShape({static_cast<int64_t>(num_segments) * bit_mask_len}),
+        &removed));
+    device.memset(delete_mask.flat<int>().data(), 0,
+                  delete_mask.NumElements() * sizeof(int));
+    int num_blocks = (max_candidates + kNmsBlockDim - 1) / kNmsBlockDim;
+    num_blocks = std::max(std::min(num_blocks, kNmsBlockDimMax), 1);
+    const dim3 block_dim(num_blocks, num_blocks,
+                         std::min(num_segments, kMaxGridDimZ));
+    const dim3 thread_block(kNmsBlockDim, kNmsBlockDim, 1);
+    TF_CHECK_OK(GpuLaunchKernel(
+        CombinedNMSKernel, block_dim, thread_block, 0, device.stream(),
+        sorted_boxes_ptr, num_segments, num_boxes, num_candidates_ptr,
+        max_candidates, iou_threshold, bit_mask_len,
+        delete_mask.flat<int>().data()));
+    TF_RETURN_IF_CUDA_ERROR(cudaGetLastError());
+    TF_CHECK_OK(GpuLaunchKernel(
+        CombinedNMSReduce, num_segments, kCombinedNmsReduceThreads, 0,
+        device.stream(), delete_mask.flat<int>().data(), num_candidates_ptr,
+        max_candidates, bit_mask_len, size_per_class,
+        removed.flat<int>().data(), selected.flat<int>().data(),
+        num_selected_ptr));
+    TF_RETURN_IF_CUDA_ERROR(cudaGetLastError());
+  }
+
+  // Take the best selected boxes of each batch over all of its classes.
+  const int num_selected_elements = num_segments * size_per_class;
+  Tensor selected_scores, selected_indices;
+  Tensor sorted_selected_scores, sorted_selected_indices;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_FLOAT, TensorShape({num_selected_elements}),
+      &selected_scores));
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_INT32, TensorShape({num_selected_elements}),
+      &selected_indices));
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_FLOAT, TensorShape({num_selected_elements}),
+      &sorted_selected_scores));
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_INT32, TensorShape({num_selected_elements}),
+      &sorted_selected_indices));
+  if (num_selected_elements > 0) {
+    config = GetGpuLaunchConfig(num_selected_elements, device);
+    TF_CHECK_OK(GpuLaunchKernel(
+        CombinedNMSGatherSelected, config.block_count, config.thread_per_block,
+        0, device.stream(), config.virtual_thread_count, num_boxes,
+        size_per_class, sorted_scores_ptr, selected.flat<int>().data(),
+        num_selected_ptr, selected_scores.flat<float>().data(),
+        selected_indices.flat<int>().data()));
+    TF_RETURN_IF_CUDA_ERROR(cudaGetLastError());
+    TF_RETURN_IF_ERROR(SegmentedSortPairsDescending(
+        context, selected_scores.flat<float>().data(),
+        sorted_selected_scores.flat<float>().data(),
+        selected_indices.flat<int>().data(),
+        sorted_selected_indices.flat<int>().data(), num_batches,
+        num_classes * size_per_class));
+  }
+
+  const int num_outputs = num_batches * per_batch_size;
+  config = GetGpuLaunchConfig(num_outputs, device);
+  TF_CHECK_OK(GpuLaunchKernel(
+      CombinedNMSWriteOutputs, config.block_count, config.thread_per_block, 0,
+      device.stream(), config.virtual_thread_count, num_boxes, num_classes,
+      size_per_class, per_batch_size, clip_boxes, sorted_boxes_ptr,
+      sorted_selected_scores.flat<float>().data(),
+      sorted_selected_indices.flat<int>().data(), num_selected_ptr,
+      nmsed_boxes->flat<float>().data(), nmsed_scores->flat<float>().data(),
+      nmsed_classes->flat<float>().data(),
+      valid_detections->flat<int>().data()));
+  TF_RETURN_IF_CUDA_ERROR(cudaGetLastError());
+  return Status::OK();
+}
+
+class CombinedNonMaxSuppressionGPUOp : public OpKernel {
+ public:
+  explicit CombinedNonMaxSuppressionGPUOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("pad_per_class", &pad_per_class_));
+    OP_REQUIRES_OK(context, context->GetAttr("clip_boxes", &clip_boxes_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    // boxes: [batch_size, num_anchors, q, 4]
+    const Tensor& boxes = context->input(0);
+    // scores: [batch_size, num_anchors, num_classes]
+    const Tensor& scores = context->input(1);
+    OP_REQUIRES(context, boxes.dims() == 4,
+                errors::InvalidArgument("boxes must be 4-D",
+                                        boxes.shape().DebugString()));
+    OP_REQUIRES(context, scores.dims() == 3,
+                errors::InvalidArgument("scores must be 3-D",
+                                        scores.shape().DebugString()));
+    OP_REQUIRES(
+        context, (boxes.dim_size(0) == scores.dim_size(0)),
+        errors::InvalidArgument("boxes and scores must have same batch size"));
+    const int num_classes = scores.dim_size(2);
+    OP_REQUIRES(
+        context, boxes.dim_size(2) == 1 || boxes.dim_size(2) == num_classes,
+        errors::InvalidArgument(
+            "third dimension of boxes must be either 1 or num classes"));
+    OP_REQUIRES(context, boxes.dim_size(3) == 4,
+                errors::InvalidArgument("boxes must have 4 columns"));
+    OP_REQUIRES(context, scores.dim_size(1) == boxes.dim_size(1),
+                errors::InvalidArgument("scores has incompatible shape"));
+
+    // max_output_size: scalar
+    const Tensor& max_output_size = context->input(2);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsScalar(max_output_size.shape()),
+        errors::InvalidArgument("max_size_per_class must be 0-D, got shape ",
+                                max_output_size.shape().DebugString()));
+    const int max_size_per_class = max_output_size.scalar<int>()();
+    OP_REQUIRES(context, max_size_per_class > 0,
+                errors::InvalidArgument("max_size_per_class must be positive"));
+    // max_total_size: scalar
+    const Tensor& max_total_size = context->input(3);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsScalar(max_total_size.shape()),
+        errors::InvalidArgument("max_total_size must be 0-D, got shape ",
+                                max_total_size.shape().DebugString()));
+    const int max_total_size_per_batch = max_total_size.scalar<int>()();
+    OP_REQUIRES(context, max_total_size_per_batch > 0,
+                errors::InvalidArgument("max_total_size must be > 0"));
+    // iou_threshold: scalar
+    const Tensor& iou_threshold = context->input(4);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(iou_threshold.shape()),
+                errors::InvalidArgument("iou_threshold must be 0-D, got shape ",
+                                        iou_threshold.shape().DebugString()));
+    const float iou_threshold_val = iou_threshold.scalar<float>()();
+    OP_REQUIRES(context, iou_threshold_val >= 0 && iou_threshold_val <= 1,
+                errors::InvalidArgument("iou_threshold must be in [0, 1]"));
+    // score_threshold: scalar
+    const Tensor& score_threshold = context->input(5);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsScalar(score_threshold.shape()),
+        errors::InvalidArgument("score_threshold must be 0-D, got shape ",
+                                score_threshold.shape().DebugString()));
+    const float score_threshold_val = score_threshold.scalar<float>()();
+
+    OP_REQUIRES_OK(
+        context, DoCombinedNMS(context, boxes, scores, max_size_per_class,
+                               max_total_size_per_batch, iou_threshold_val,
+                               score_threshold_val, pad_per_class_,
+                               clip_boxes_));
+  }
+
+ private:
+  bool pad_per_class_;
+  bool clip_boxes_;
+};
+
 }  // anonymous namespace
 
 Status NmsGpu(const float* d_sorted_boxes_float_ptr, const int num_boxes,
@@ -780,5 +1324,13 @@ REGISTER_KERNEL_BUILDER(Name("NonMaxSuppressionV4")
                             .HostMemory("score_threshold"),
                         NonMaxSuppressionV4GPUOp);
 
+REGISTER_KERNEL_BUILDER(Name("CombinedNonMaxSuppression")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("max_output_size_per_class")
+                            .HostMemory("max_total_size")
+                            .HostMemory("iou_threshold")
+                            .HostMemory("score_threshold"),
+                        CombinedNonMaxSuppressionGPUOp);
+
 }  // namespace tensorflow
 #endif
@@ -22,11 +22,9 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/image/resize_bilinear_op.h"
 
-#ifdef __SSE4_1__
-#include <xmmintrin.h>
-#endif
-
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -105,112 +103,73 @@ inline void compute_interpolation_weights(const Scaler scaler,
   }
 }
 
-/**
- * Computes the bilinear interpolation from the appropriate 4 float points
- * and the linear interpolation weights.
- */
-inline float compute_lerp(const float top_left, const float top_right,
-                          const float bottom_left, const float bottom_right,
-                          const float x_lerp, const float y_lerp) {
-  const float top = top_left + (top_right - top_left) * x_lerp;
-  const float bottom = bottom_left + (bottom_right - bottom_left) * x_lerp;
-  return top + (bottom - top) * y_lerp;
-}
-
-#ifdef __SSE4_1__
-/* Vector version of the above */
-inline __m128 compute_lerp_v(const __m128 top_left, const __m128 top_right,
-                             const __m128 bottom_left,
-                             const __m128 bottom_right, const __m128 x_lerp,
-                             const __m128 y_lerp) {
-  const __m128 top =
-      _mm_add_ps(top_left, _mm_mul_ps(_mm_sub_ps(top_right, top_left), x_lerp));
-  const __m128 bottom = _mm_add_ps(
-      bottom_left, _mm_mul_ps(_mm_sub_ps(bottom_right, bottom_left), x_lerp));
-  return _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), y_lerp));
-}
-#endif
-
+// Interpolates one input row horizontally into `out_row`, which holds
+// `out_width * channels` values. `xs` holds the scaled x interpolation indices.
 template <typename T>
-void ResizeLineChannels(const T* const ys_input_lower_ptr,
-                        const T* const ys_input_upper_ptr,
-                        const CachedInterpolation* const xs,
-                        const float ys_lerp, const int64_t out_width,
-                        float* out_y, const int channels) {
+void ResizeRowHorizontally(const T* const input_row,
+                           const CachedInterpolation* const xs,
+                           const int64_t out_width, const int channels,
+                           float* out_row) {
+  if (channels == 3) {
+    // Unroll the channels of the common RGB case.
+    for (int64_t x = 0; x < out_width; ++x) {
+      const T* const left = input_row + xs[x].lower;
+      const T* const right = input_row + xs[x].upper;
+      const float xs_lerp = xs[x].lerp;
+      float* const out = out_row + x * 3;
+      out[0] = static_cast<float>(left[0]) +
+               (static_cast<float>(right[0]) - static_cast<float>(left[0])) *
+                   xs_lerp;
+      out[1] = static_cast<float>(left[1]) +
+               (static_cast<float>(right[1]) - static_cast<float>(left[1])) *
+                   xs_lerp;
+      out[2] = static_cast<float>(left[2]) +
+               (static_cast<float>(right[2]) - static_cast<float>(left[2])) *
+                   xs_lerp;
+    }
+    return;
+  }
   for (int64_t x = 0; x < out_width; ++x) {
-    const int64_t xs_lower = xs[x].lower;
-    const int64_t xs_upper = xs[x].upper;
+    const T* const left = input_row + xs[x].lower;
+    const T* const right = input_row + xs[x].upper;
     const float xs_lerp = xs[x].lerp;
-
     for (int c = 0; c < channels; ++c) {
-      const float top_left(ys_input_lower_ptr[xs_lower + c]);
-      const float top_right(ys_input_lower_ptr[xs_upper + c]);
-      const float bottom_left(ys_input_upper_ptr[xs_lower + c]);
-      const float bottom_right(ys_input_upper_ptr[xs_upper + c]);
-
-      out_y[x * channels + c] = compute_lerp(top_left, top_right, bottom_left,
-                                             bottom_right, xs_lerp, ys_lerp);
+      const float left_value(left[c]);
+      const float right_value(right[c]);
+      out_row[x * channels + c] =
+          left_value + (right_value - left_value) * xs_lerp;
     }
   }
 }
 
-#ifdef __SSE4_1__
-
-// Load 3 floats from the given buffer, which must be of size at least 4.
-template <typename T>
-inline __m128 load_3xfloat_v(T* values) {
-  return _mm_set_ps(0.0f, static_cast<float>(values[2]),
-                    static_cast<float>(values[1]),
-                    static_cast<float>(values[0]));
-}
-
-// Specialize cases that can be done more efficiently.
-template <>
-inline __m128 load_3xfloat_v(float* values) {
-  return _mm_loadu_ps(values);
-}
-
-template <typename T>
-void ResizeLine3ChannelsVector(const T* const ys_input_lower_ptr,
-                               const T* const ys_input_upper_ptr,
-                               const CachedInterpolation* const xs,
-                               const float ys_lerp, const int64_t out_width,
-                               float* out_y) {
-  const __m128 ys_lerp_v = _mm_set1_ps(ys_lerp);
-  // All pixels but the last one can overflow, vectorize the inside of the
-  // row.
-  int64_t x = 0;
-  for (x = 0; x < out_width - 1; ++x) {
-    const int64_t xs_lower = xs[x].lower;
-    const int64_t xs_upper = xs[x].upper;
-    const __m128 xs_lerp_v = _mm_set1_ps(xs[x].lerp);
-
-    const __m128 top_left_v = load_3xfloat_v(ys_input_lower_ptr + xs_lower);
-    const __m128 top_right_v = load_3xfloat_v(ys_input_lower_ptr + xs_upper);
-    const __m128 bottom_left_v = load_3xfloat_v(ys_input_upper_ptr + xs_lower);
-    const __m128 bottom_right_v = load_3xfloat_v(ys_input_upper_ptr + xs_upper);
-
-    _mm_storeu_ps(out_y + x * 3,
-                  compute_lerp_v(top_left_v, top_right_v, bottom_left_v,
-                                 bottom_right_v, xs_lerp_v, ys_lerp_v));
+// Interpolates two horizontally interpolated rows vertically. The rows are
+// contiguous, so the compiler vectorizes this loop for the target (SSE, AVX or
+// NEON).
+inline void ResizeRowVertically(const float* const top,
+                                const float* const bottom, const float ys_lerp,
+                                const int64_t size, float* out_row) {
+  for (int64_t i = 0; i < size; ++i) {
+    out_row[i] = top[i] + (bottom[i] - top[i]) * ys_lerp;
   }
-  // The last pixel of each row must be done in a non-vectorized way
-  // because we cannot overflow.
-  ResizeLineChannels(ys_input_lower_ptr, ys_input_upper_ptr, xs + out_width - 1,
-                     ys_lerp, 1, out_y + (out_width - 1) * 3, 3);
 }
-#endif
 
+// Resizes the images as a horizontal pass over the two input rows each output
+// row needs, followed by a vertical pass over the results. This computes the
+// same values as interpolating the four corners of each output pixel, but the
+// vertical pass vectorizes, and when upsampling, consecutive output rows reuse
+// the horizontally interpolated input rows. Output rows are sharded over the
+// device's threads.
 template <typename T>
 void resize_image(
-    typename TTypes<T, 4>::ConstTensor images, const int batch_size,
-    const int64_t in_height, const int64_t in_width, const int64_t out_height,
-    const int64_t out_width, const int channels,
+    const CPUDevice& d, typename TTypes<T, 4>::ConstTensor images,
+    const int batch_size, const int64_t in_height, const int64_t in_width,
+    const int64_t out_height, const int64_t out_width, const int channels,
     const std::vector<CachedInterpolation>& xs,
     const std::vector<CachedInterpolation>& ys,
     typename TTypes<float, 4>::Tensor output) TF_ATTRIBUTE_NOINLINE;
 template <typename T>
-void resize_image(typename TTypes<T, 4>::ConstTensor images,
+void resize_image(const CPUDevice& d,
+                  typename TTypes<T, 4>::ConstTensor images,
                   const int batch_size, const int64_t in_height,
                   const int64_t in_width, const int64_t out_height,
                   const int64_t out_width, const int channels,
@@ -221,41 +180,50 @@ void resize_image(typename TTypes<T, 4>::ConstTensor images,
   const int64_t in_batch_num_values = in_height * in_row_size;
   const int64_t out_row_size = out_width * channels;
 
-  const T* input_b_ptr = images.data();
-  const CachedInterpolation* xs = xs_vec.data();
-
-  if (channels == 3) {
-    float* output_y_ptr = output.data();
-    for (int b = 0; b < batch_size; ++b) {
-      for (int64_t y = 0; y < out_height; ++y) {
-        const T* ys_input_lower_ptr = input_b_ptr + ys[y].lower * in_row_size;
-        const T* ys_input_upper_ptr = input_b_ptr + ys[y].upper * in_row_size;
-#ifdef __SSE4_1__
-        ResizeLine3ChannelsVector(ys_input_lower_ptr, ys_input_upper_ptr, xs,
-                                  ys[y].lerp, out_width, output_y_ptr);
-#else
-        ResizeLineChannels(ys_input_lower_ptr, ys_input_upper_ptr, xs,
-                           ys[y].lerp, out_width, output_y_ptr, 3);
-#endif
-        output_y_ptr += out_row_size;
+  const T* const input_ptr = images.data();
+  float* const output_ptr = output.data();
+  const CachedInterpolation* const xs = xs_vec.data();
+
+  auto resize_rows = [&](int64_t start, int64_t end) {
+    // The horizontally interpolated input rows, and which rows they are, so
+    // that consecutive output rows of the same image can reuse them.
+    std::vector<float> top(out_row_size);
+    std::vector<float> bottom(out_row_size);
+    int64_t top_row = -1;
+    int64_t bottom_row = -1;
+    for (int64_t i = start; i < end; ++i) {
+      const int64_t b = i / out_height;
+      const int64_t y = i % out_height;
+      const T* const input_b_ptr = input_ptr + b * in_batch_num_values;
+      const int64_t lower = b * in_height + ys[y].lower;
+      const int64_t upper = b * in_height + ys[y].upper;
+      if (lower == bottom_row) {
+        top.swap(bottom);
+        std::swap(top_row, bottom_row);
       }
-      input_b_ptr += in_batch_num_values;
-    }
-  } else {
-    float* output_y_ptr = output.data();
-    for (int b = 0; b < batch_size; ++b) {
-      for (int64_t y = 0; y < out_height; ++y) {
-        const T* ys_input_lower_ptr = input_b_ptr + ys[y].lower * in_row_size;
-        const T* ys_input_upper_ptr = input_b_ptr + ys[y].upper * in_row_size;
-
-        ResizeLineChannels(ys_input_lower_ptr, ys_input_upper_ptr, xs,
-                           ys[y].lerp, out_width, output_y_ptr, channels);
-
-        output_y_ptr += out_row_size;
+      if (lower != top_row) {
+        ResizeRowHorizontally(input_b_ptr + ys[y].lower * in_row_size, xs,
+                              out_width, channels, top.data());
+        top_row = lower;
+      }
+      if (upper != top_row && upper != bottom_row) {
+        ResizeRowHorizontally(input_b_ptr + ys[y].upper * in_row_size, xs,
+                              out_width, channels, bottom.data());
+        bottom_row = upper;
       }
-      input_b_ptr += in_batch_num_values;
+      const float* const bottom_ptr =
+          upper == top_row ? top.data() : bottom.data();
+      ResizeRowVertically(top.data(), bottom_ptr, ys[y].lerp, out_row_size,
+                          output_ptr + i * out_row_size);
     }
-  }
+  };
+  // Each output row reads up to two input rows and writes one output row,
+  // and each value costs a few multiply-adds.
+  const Eigen::TensorOpCost cost(
+      /*bytes_loaded=*/2 * out_row_size * sizeof(T),
+      /*bytes_stored=*/out_row_size * sizeof(float),
+      /*compute_cycles=*/6 * out_row_size);
+  d.parallelFor(batch_size * out_height, cost, resize_rows);
 }
 
 // Casts from float16 to T.
@@ -324,7 +292,7 @@ struct ResizeBilinear<CPUDevice, T> {
       xs[i].upper *= channels;
     }
 
-    resize_image<T>(images, batch_size, in_height, in_width, out_height,
+    resize_image<T>(d, images, batch_size, in_height, in_width, out_height,
                     out_width, channels, xs, ys, output);
   }
 };
@@ -0,0 +1,345 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A curated suite of core kernel benchmarks at standard shapes and thread
+// counts, whose results are comparable between builds. Every benchmark is
+// named BM_Kernel<Op> and takes the size of the problem and the number of
+// intra-op threads as its two arguments. Run it with
+//
+// bazel run -c opt //tensorflow/core/kernels:kernel_benchmarks_test -- \
+//   --benchmark_filter=all --benchmark_repetitions=10 \
+//   --benchmark_report_aggregates_only=true \
+//   --benchmark_out_format=json --benchmark_out=/tmp/new.json
+//
+// and compare two runs with tensorflow/tools/benchmark:compare_benchmarks.
+//
+// Benchmarks should only be added to this file, never changed, so that the
+// results of older builds stay comparable.
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+// The intra-op thread counts every benchmark runs with.
+const std::vector<int64_t>& ThreadCounts() {
+  static const auto* threads = new std::vector<int64_t>({1, 4, 16});
+  return *threads;
+}
+
+SessionOptions GetOptions(int intra_threads) {
+  SessionOptions opts;
+  opts.config.set_intra_op_parallelism_threads(intra_threads);
+  opts.config.set_inter_op_parallelism_threads(1);
+  return opts;
+}
+
+// Runs `g` with `state.range(1)` intra-op threads and reports `items` items
+// and `bytes` bytes per iteration.
+void RunBenchmark(::testing::benchmark::State& state, Graph* g, int64_t items,
+                  int64_t bytes) {
+  const SessionOptions opts = GetOptions(state.range(1));
+  test::Benchmark("cpu", g, &opts, nullptr, nullptr, "",
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * items);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * bytes);
+}
+
+Tensor RandomFloats(const TensorShape& shape) {
+  Tensor tensor(DT_FLOAT, shape);
+  tensor.flat<float>().setRandom();
+  return tensor;
+}
+
+Node* Constant(Graph* g, const Tensor& tensor) {
+  return test::graph::Constant(g, tensor);
+}
+
+// Elementwise ops on `state.range(0)` floats.
+
+void BM_KernelAdd(::testing::benchmark::State& state) {
+  const int64_t n = state.range(0);
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Add(g, Constant(g, RandomFloats(TensorShape({n}))),
+                   Constant(g, RandomFloats(TensorShape({n}))));
+  RunBenchmark(state, g, n, 3 * n * sizeof(float));
+}
+BENCHMARK(BM_KernelAdd)
+    ->UseRealTime()
+    ->ArgsProduct({{1 << 10, 1 << 16, 1 << 20}, ThreadCounts()});
+
+// Adds a row vector to a matrix with `state.range(0)` columns and 512 rows.
+void BM_KernelAddBroadcast(::testing::benchmark::State& state) {
+  const int64_t cols = state.range(0);
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Add(g, Constant(g, RandomFloats(TensorShape({512, cols}))),
+                   Constant(g, RandomFloats(TensorShape({cols}))));
+  RunBenchmark(state, g, 512 * cols, 2 * 512 * cols * sizeof(float));
+}
+BENCHMARK(BM_KernelAddBroadcast)
+    ->UseRealTime()
+    ->ArgsProduct({{128, 1024}, ThreadCounts()});
+
+void BM_KernelTanh(::testing::benchmark::State& state) {
+  const int64_t n = state.range(0);
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Unary(g, "Tanh", Constant(g, RandomFloats(TensorShape({n}))));
+  RunBenchmark(state, g, n, 2 * n * sizeof(float));
+}
+BENCHMARK(BM_KernelTanh)
+    ->UseRealTime()
+    ->ArgsProduct({{1 << 10, 1 << 16, 1 << 20}, ThreadCounts()});
+
+// Reductions of a square matrix with `state.range(0)` rows.
+
+Graph* Reduction(const string& reduce, int64_t n, int axis) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor axes(DT_INT32, TensorShape({}));
+  axes.scalar<int32>()() = axis;
+  test::graph::Reduce(g, reduce, Constant(g, RandomFloats(TensorShape({n, n}))),
+                      Constant(g, axes));
+  return g;
+}
+
+void BM_KernelSumRows(::testing::benchmark::State& state) {
+  const int64_t n = state.range(0);
+  RunBenchmark(state, Reduction("Sum", n, 1), n * n, n * n * sizeof(float));
+}
+BENCHMARK(BM_KernelSumRows)
+    ->UseRealTime()
+    ->ArgsProduct({{64, 1024}, ThreadCounts()});
+
+void BM_KernelSumColumns(::testing::benchmark::State& state) {
+  const int64_t n = state.range(0);
+  RunBenchmark(state, Reduction("Sum", n, 0), n * n, n * n * sizeof(float));
+}
+BENCHMARK(BM_KernelSumColumns)
+    ->UseRealTime()
+    ->ArgsProduct({{64, 1024}, ThreadCounts()});
+
+void BM_KernelMaxRows(::testing::benchmark::State& state) {
+  const int64_t n = state.range(0);
+  RunBenchmark(state, Reduction("Max", n, 1), n * n, n * n * sizeof(float));
+}
+BENCHMARK(BM_KernelMaxRows)
+    ->UseRealTime()
+    ->ArgsProduct({{64, 1024}, ThreadCounts()});
+
+// Gathers and scatters `state.range(0)` rows of 64 floats from and to a table
+// of 100000 rows.
+
+Tensor RandomIndices(int64_t n, int64_t limit, const TensorShape& shape) {
+  Tensor indices(DT_INT32, shape);
+  auto flat = indices.flat<int32>();
+  for (int64_t i = 0; i < n; ++i) {
+    flat(i) = (i * 7919) % limit;
+  }
+  return indices;
+}
+
+constexpr int64_t kTableRows = 100000;
+constexpr int64_t kRowSize = 64;
+
+void BM_KernelGather(::testing::benchmark::State& state) {
+  const int64_t n = state.range(0);
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor axis(DT_INT32, TensorShape({}));
+  axis.scalar<int32>()() = 0;
+  test::graph::Gather(
+      g, Constant(g, RandomFloats(TensorShape({kTableRows, kRowSize}))),
+      Constant(g, RandomIndices(n, kTableRows, TensorShape({n}))),
+      Constant(g, axis));
+  RunBenchmark(state, g, n, 2 * n * kRowSize * sizeof(float));
+}
+BENCHMARK(BM_KernelGather)
+    ->UseRealTime()
+    ->ArgsProduct({{1 << 10, 1 << 14}, ThreadCounts()});
+
+void BM_KernelTensorScatterAdd(::testing::benchmark::State& state) {
+  const int64_t n = state.range(0);
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* node;
+  TF_CHECK_OK(
+      NodeBuilder(g->NewName("n"), "TensorScatterAdd")
+          .Input(Constant(g, RandomFloats(TensorShape({kTableRows, kRowSize}))))
+          .Input(Constant(g, RandomIndices(n, kTableRows, TensorShape({n, 1}))))
+          .Input(Constant(g, RandomFloats(TensorShape({n, kRowSize}))))
+          .Finalize(g, &node));
+  RunBenchmark(state, g, n, 3 * n * kRowSize * sizeof(float));
+}
+BENCHMARK(BM_KernelTensorScatterAdd)
+    ->UseRealTime()
+    ->ArgsProduct({{1 << 10, 1 << 14}, ThreadCounts()});
+
+void BM_KernelUnsortedSegmentSum(::testing::benchmark::State& state) {
+  const int64_t n = state.range(0);
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor num_segments(DT_INT32, TensorShape({}));
+  num_segments.scalar<int32>()() = 1024;
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "UnsortedSegmentSum")
+                  .Input(Constant(g, RandomFloats(TensorShape({n, kRowSize}))))
+                  .Input(Constant(g, RandomIndices(n, 1024, TensorShape({n}))))
+                  .Input(Constant(g, num_segments))
+                  .Finalize(g, &node));
+  RunBenchmark(state, g, n, n * kRowSize * sizeof(float));
+}
+BENCHMARK(BM_KernelUnsortedSegmentSum)
+    ->UseRealTime()
+    ->ArgsProduct({{1 << 10, 1 << 14}, ThreadCounts()});
+
+// Multiplies square matrices with `state.range(0)` rows. Items are FLOPs.
+void BM_KernelMatMul(::testing::benchmark::State& state) {
+  const int64_t n = state.range(0);
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Matmul(g, Constant(g, RandomFloats(TensorShape({n, n}))),
+                      Constant(g, RandomFloats(TensorShape({n, n}))),
+                      /*transpose_a=*/false, /*transpose_b=*/false);
+  RunBenchmark(state, g, 2 * n * n * n, 3 * n * n * sizeof(float));
+}
+BENCHMARK(BM_KernelMatMul)
+    ->UseRealTime()
+    ->ArgsProduct({{64, 256, 1024}, ThreadCounts()});
+
+// A 3x3 convolution of a batch of 8 NHWC images of `state.range(0)` squared
+// pixels with 64 input and output channels. Items are FLOPs.
+void BM_KernelConv2D(::testing::benchmark::State& state) {
+  const int64_t size = state.range(0);
+  constexpr int64_t kBatch = 8;
+  constexpr int64_t kChannels = 64;
+  Graph* g = new Graph(OpRegistry::Global());
+  const TensorShape input_shape({kBatch, size, size, kChannels});
+  const TensorShape filter_shape({3, 3, kChannels, kChannels});
+  test::graph::Conv2D(g, Constant(g, RandomFloats(input_shape)),
+                      Constant(g, RandomFloats(filter_shape)));
+  const int64_t outputs = kBatch * size * size * kChannels;
+  RunBenchmark(state, g, 2 * outputs * 3 * 3 * kChannels,
+               2 * outputs * sizeof(float));
+}
+BENCHMARK(BM_KernelConv2D)
+    ->UseRealTime()
+    ->ArgsProduct({{14, 56}, ThreadCounts()});
+
+// String ops on `state.range(0)` strings of 16 characters.
+
+Tensor Strings(int64_t n) {
+  Tensor strings(DT_STRING, TensorShape({n}));
+  auto flat = strings.flat<tstring>();
+  for (int64_t i = 0; i < n; ++i) {
+    flat(i) = strings::StrCat("string-", 100000000 + i);
+  }
+  return strings;
+}
+
+void BM_KernelStringToHashBucketFast(::testing::benchmark::State& state) {
+  const int64_t n = state.range(0);
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "StringToHashBucketFast")
+                  .Input(Constant(g, Strings(n)))
+                  .Attr("num_buckets", 1 << 20)
+                  .Finalize(g, &node));
+  RunBenchmark(state, g, n, n * 16);
+}
+BENCHMARK(BM_KernelStringToHashBucketFast)
+    ->UseRealTime()
+    ->ArgsProduct({{1 << 10, 1 << 16}, ThreadCounts()});
+
+void BM_KernelStringSplit(::testing::benchmark::State& state) {
+  const int64_t n = state.range(0);
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor delimiter(DT_STRING, TensorShape({}));
+  delimiter.scalar<tstring>()() = "-";
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "StringSplitV2")
+                  .Input(Constant(g, Strings(n)))
+                  .Input(Constant(g, delimiter))
+                  .Finalize(g, &node));
+  RunBenchmark(state, g, n, n * 16);
+}
+BENCHMARK(BM_KernelStringSplit)
+    ->UseRealTime()
+    ->ArgsProduct({{1 << 10, 1 << 16}, ThreadCounts()});
+
+// Parses `state.range(0)` tf.Examples with a dense float feature of 16 values,
+// a dense int64 feature, and a sparse bytes feature of 4 values.
+void BM_KernelParseExample(::testing::benchmark::State& state) {
+  const int64_t n = state.range(0);
+  Example example;
+  auto& features = *example.mutable_features()->mutable_feature();
+  for (int i = 0; i < 16; ++i) {
+    features["dense_float"].mutable_float_list()->add_value(i);
+  }
+  features["dense_int"].mutable_int64_list()->add_value(42);
+  for (int i = 0; i < 4; ++i) {
+    features["sparse_bytes"].mutable_bytes_list()->add_value(
+        strings::StrCat("value", i));
+  }
+  const string serialized_example = example.SerializeAsString();
+  Tensor serialized(DT_STRING, TensorShape({n}));
+  for (int64_t i = 0; i < n; ++i) {
+    serialized.flat<tstring>()(i) = serialized_example;
+  }
+
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor names(DT_STRING, TensorShape({0}));
+  Tensor sparse_keys(DT_STRING, TensorShape({1}));
+  sparse_keys.flat<tstring>()(0) = "sparse_bytes";
+  Tensor dense_keys(DT_STRING, TensorShape({2}));
+  dense_keys.flat<tstring>()(0) = "dense_float";
+  dense_keys.flat<tstring>()(1) = "dense_int";
+  Tensor ragged_keys(DT_STRING, TensorShape({0}));
+  std::vector<NodeBuilder::NodeOut> dense_defaults = {
+      Constant(g, Tensor(DT_FLOAT, TensorShape({0}))),
+      Constant(g, Tensor(DT_INT64, TensorShape({0})))};
+  const std::vector<DataType> sparse_types = {DT_STRING};
+  const std::vector<PartialTensorShape> dense_shapes = {
+      PartialTensorShape({16}), PartialTensorShape({})};
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "ParseExampleV2")
+                  .Input(Constant(g, serialized))
+                  .Input(Constant(g, names))
+                  .Input(Constant(g, sparse_keys))
+                  .Input(Constant(g, dense_keys))
+                  .Input(Constant(g, ragged_keys))
+                  .Input(dense_defaults)
+                  .Attr("num_sparse", 1)
+                  .Attr("sparse_types", sparse_types)
+                  .Attr("ragged_value_types", std::vector<DataType>())
+                  .Attr("ragged_split_types", std::vector<DataType>())
+                  .Attr("dense_shapes", dense_shapes)
+                  .Finalize(g, &node));
+  RunBenchmark(state, g, n, n * serialized_example.size());
+}
+BENCHMARK(BM_KernelParseExample)
+    ->UseRealTime()
+    ->ArgsProduct({{64, 4096}, ThreadCounts()});
+
+}  // namespace
+}  // namespace tensorflow
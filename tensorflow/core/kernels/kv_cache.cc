@@ -0,0 +1,259 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/kv_cache.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+
+namespace {
+
+int64_t NumPages(int64_t num_tokens, int64_t page_size) {
+  return (num_tokens + page_size - 1) / page_size;
+}
+
+Status CheckSequenceIds(const Tensor& sequence_ids) {
+  if (sequence_ids.dtype() != DT_INT64 ||
+      !TensorShapeUtils::IsVector(sequence_ids.shape())) {
+    return errors::InvalidArgument(
+        "sequence_ids must be an int64 vector but is a ",
+        DataTypeString(sequence_ids.dtype()), " tensor of shape ",
+        sequence_ids.shape().DebugString());
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+KVCache::KVCache(DataType dtype, int64_t num_heads, int64_t head_dim,
+                 int64_t page_size, int64_t max_pages)
+    : dtype_(dtype),
+      num_heads_(num_heads),
+      head_dim_(head_dim),
+      page_size_(page_size),
+      max_pages_(max_pages),
+      token_bytes_(num_heads * head_dim * DataTypeSize(dtype)) {}
+
+Status KVCache::Append(const Tensor& sequence_ids, const Tensor& keys,
+                       const Tensor& values) {
+  TF_RETURN_IF_ERROR(CheckSequenceIds(sequence_ids));
+  const int64_t batch_size = sequence_ids.NumElements();
+  if (keys.dtype() != dtype_ || values.dtype() != dtype_) {
+    return errors::InvalidArgument(
+        "The cache holds ", DataTypeString(dtype_), " but keys are ",
+        DataTypeString(keys.dtype()), " and values are ",
+        DataTypeString(values.dtype()));
+  }
+  const int rank = keys.dims();
+  if ((rank != 3 && rank != 4) || keys.dim_size(0) != batch_size ||
+      keys.dim_size(rank - 2) != num_heads_ ||
+      keys.dim_size(rank - 1) != head_dim_) {
+    return errors::InvalidArgument(
+        "keys must have shape [", batch_size, ", ", num_heads_, ", ",
+        head_dim_, "] or [", batch_size, ", num_tokens, ", num_heads_, ", ",
+        head_dim_, "] but have shape ", keys.shape().DebugString());
+  }
+  if (values.shape() != keys.shape()) {
+    return errors::InvalidArgument("values have shape ",
+                                   values.shape().DebugString(),
+                                   " but keys have shape ",
+                                   keys.shape().DebugString());
+  }
+  const int64_t num_tokens = rank == 4 ? keys.dim_size(1) : 1;
+  const auto ids = sequence_ids.vec<int64_t>();
+  const char* key_data = keys.tensor_data().data();
+  const char* value_data = values.tensor_data().data();
+
+  mutex_lock l(mu_);
+  // Checks that the pool has enough pages before appending anything.
+  std::unordered_map<int64_t, int64_t> lengths;
+  int64_t num_new_pages = 0;
+  for (int64_t b = 0; b < batch_size; ++b) {
+    auto inserted = lengths.emplace(ids(b), 0);
+    int64_t& length = inserted.first->second;
+    if (inserted.second) {
+      auto it = sequences_.find(ids(b));
+      if (it != sequences_.end()) length = it->second.length;
+    }
+    num_new_pages += NumPages(length + num_tokens, page_size_) -
+                     NumPages(length, page_size_);
+    length += num_tokens;
+  }
+  const int64_t num_available_pages =
+      max_pages_ == 0 ? std::numeric_limits<int64_t>::max()
+                      : static_cast<int64_t>(free_pages_.size()) + max_pages_ -
+                            num_allocated_pages_;
+  if (num_new_pages > num_available_pages) {
+    return errors::ResourceExhausted(
+        "The KV cache needs ", num_new_pages, " more pages but only ",
+        num_available_pages, " of its ", max_pages_, " pages are free");
+  }
+
+  for (int64_t b = 0; b < batch_size; ++b) {
+    Sequence& sequence = sequences_[ids(b)];
+    for (int64_t t = 0; t < num_tokens; ++t) {
+      const int64_t offset = sequence.length % page_size_;
+      if (offset == 0) sequence.pages.push_back(LockedTakePage());
+      char* page =
+          const_cast<char*>(sequence.pages.back().tensor_data().data());
+      const int64_t input_offset = (b * num_tokens + t) * token_bytes_;
+      std::memcpy(page + offset * token_bytes_, key_data + input_offset,
+                  token_bytes_);
+      std::memcpy(page + (page_size_ + offset) * token_bytes_,
+                  value_data + input_offset, token_bytes_);
+      ++sequence.length;
+    }
+  }
+  return Status::OK();
+}
+
+Status KVCache::Remove(const Tensor& sequence_ids) {
+  TF_RETURN_IF_ERROR(CheckSequenceIds(sequence_ids));
+  const auto ids = sequence_ids.vec<int64_t>();
+  mutex_lock l(mu_);
+  for (int64_t i = 0; i < ids.size(); ++i) {
+    if (sequences_.find(ids(i)) == sequences_.end()) {
+      return errors::NotFound("Sequence ", ids(i), " is not in the KV cache");
+    }
+  }
+  for (int64_t i = 0; i < ids.size(); ++i) {
+    auto it = sequences_.find(ids(i));
+    if (it == sequences_.end()) continue;  // A repeated id.
+    for (Tensor& page : it->second.pages) {
+      free_pages_.push_back(std::move(page));
+    }
+    sequences_.erase(it);
+  }
+  return Status::OK();
+}
+
+template <typename T>
+Status KVCache::Attend(int64_t sequence_id, const T* query, float scale,
+                       T* output) const {
+  if (DataTypeToEnum<T>::value != dtype_) {
+    return errors::InvalidArgument("The cache holds ", DataTypeString(dtype_),
+                                   " but the query is ",
+                                   DataTypeString(DataTypeToEnum<T>::value));
+  }
+  std::vector<float> max_score(num_heads_,
+                               -std::numeric_limits<float>::infinity());
+  std::vector<float> sum(num_heads_, 0);
+  std::vector<float> accumulator(num_heads_ * head_dim_, 0);
+
+  tf_shared_lock l(mu_);
+  auto it = sequences_.find(sequence_id);
+  if (it == sequences_.end() || it->second.length == 0) {
+    return errors::NotFound("Sequence ", sequence_id,
+                            " has no tokens in the KV cache");
+  }
+  const Sequence& sequence = it->second;
+  const int64_t head_size = num_heads_ * head_dim_;
+  // Computes the softmax in one pass over the tokens, rescaling the partial
+  // sums whenever a head sees a new maximum score.
+  for (int64_t i = 0; i < sequence.length; ++i) {
+    const T* page = reinterpret_cast<const T*>(
+        sequence.pages[i / page_size_].tensor_data().data());
+    const int64_t offset = i % page_size_;
+    const T* keys = page + offset * head_size;
+    const T* values = page + (page_size_ + offset) * head_size;
+    for (int64_t h = 0; h < num_heads_; ++h) {
+      const T* key = keys + h * head_dim_;
+      const T* head_query = query + h * head_dim_;
+      float score = 0;
+      for (int64_t d = 0; d < head_dim_; ++d) {
+        score += static_cast<float>(head_query[d]) * static_cast<float>(key[d]);
+      }
+      score *= scale;
+      float* head_accumulator = accumulator.data() + h * head_dim_;
+      if (score > max_score[h]) {
+        const float correction = std::exp(max_score[h] - score);
+        sum[h] *= correction;
+        for (int64_t d = 0; d < head_dim_; ++d) {
+          head_accumulator[d] *= correction;
+        }
+        max_score[h] = score;
+      }
+      const float weight = std::exp(score - max_score[h]);
+      sum[h] += weight;
+      const T* value = values + h * head_dim_;
+      for (int64_t d = 0; d < head_dim_; ++d) {
+        head_accumulator[d] += weight * static_cast<float>(value[d]);
+      }
+    }
+  }
+  for (int64_t h = 0; h < num_heads_; ++h) {
+    for (int64_t d = 0; d < head_dim_; ++d) {
+      output[h * head_dim_ + d] =
+          static_cast<T>(accumulator[h * head_dim_ + d] / sum[h]);
+    }
+  }
+  return Status::OK();
+}
+
+template Status KVCache::Attend<Eigen::half>(int64_t, const Eigen::half*,
+                                             float, Eigen::half*) const;
+template Status KVCache::Attend<bfloat16>(int64_t, const bfloat16*, float,
+                                          bfloat16*) const;
+template Status KVCache::Attend<float>(int64_t, const float*, float,
+                                       float*) const;
+
+int64_t KVCache::SequenceLength(int64_t sequence_id) const {
+  tf_shared_lock l(mu_);
+  auto it = sequences_.find(sequence_id);
+  return it == sequences_.end() ? 0 : it->second.length;
+}
+
+int64_t KVCache::num_allocated_pages() const {
+  tf_shared_lock l(mu_);
+  return num_allocated_pages_;
+}
+
+int64_t KVCache::num_free_pages() const {
+  tf_shared_lock l(mu_);
+  return free_pages_.size();
+}
+
+string KVCache::DebugString() const {
+  tf_shared_lock l(mu_);
+  return strings::StrCat("KVCache of ", sequences_.size(), " sequences in ",
+                         num_allocated_pages_ - free_pages_.size(), " of ",
+                         num_allocated_pages_, " pages");
+}
+
+int64_t KVCache::MemoryUsed() const {
+  tf_shared_lock l(mu_);
+  return num_allocated_pages_ * 2 * page_size_ * token_bytes_;
+}
+
+Tensor KVCache::LockedTakePage() {
+  if (!free_pages_.empty()) {
+    Tensor page = std::move(free_pages_.back());
+    free_pages_.pop_back();
+    return page;
+  }
+  ++num_allocated_pages_;
+  return Tensor(cpu_allocator(), dtype_,
+                TensorShape({2, page_size_, num_heads_, head_dim_}));
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,110 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_KV_CACHE_H_
+#define TENSORFLOW_CORE_KERNELS_KV_CACHE_H_
+
+// See docs in ../ops/data_flow_ops.cc.
+
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// The attention keys and values of the tokens of decoded sequences.
+//
+// The cache stores the keys and values of each sequence in pages of
+// `page_size` tokens, so that appending a token copies only that token and
+// never moves the tokens already cached. Pages come from a pool that is
+// shared by all sequences: removing a sequence returns its pages to the pool
+// and a new sequence reuses them, so that sequences can join and leave a
+// batch without copying or reallocating the others. The pool grows up to
+// `max_pages` pages, or without a limit if `max_pages` is 0.
+//
+// Each page is a tensor of shape [2, page_size, num_heads, head_dim] that
+// holds the keys and then the values of its tokens.
+class KVCache : public ResourceBase {
+ public:
+  KVCache(DataType dtype, int64_t num_heads, int64_t head_dim,
+          int64_t page_size, int64_t max_pages);
+
+  DataType dtype() const { return dtype_; }
+  int64_t num_heads() const { return num_heads_; }
+  int64_t head_dim() const { return head_dim_; }
+  int64_t page_size() const { return page_size_; }
+  int64_t max_pages() const { return max_pages_; }
+
+  // Appends tokens to the sequences in `sequence_ids`. `keys` and `values`
+  // have shape [batch, num_heads, head_dim] for one token per sequence, or
+  // [batch, num_tokens, num_heads, head_dim]. A sequence that is not in the
+  // cache is added. Nothing is appended if there are not enough free pages.
+  Status Append(const Tensor& sequence_ids, const Tensor& keys,
+                const Tensor& values) TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the pages of the sequences in `sequence_ids` to the pool.
+  Status Remove(const Tensor& sequence_ids) TF_LOCKS_EXCLUDED(mu_);
+
+  // Writes the attention of `query`, of shape [num_heads, head_dim], over the
+  // cached keys and values of a sequence to `output`, of the same shape:
+  // softmax(scale * query . keys) . values for every head.
+  template <typename T>
+  Status Attend(int64_t sequence_id, const T* query, float scale,
+                T* output) const TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of tokens of a sequence, or 0 if it is not cached.
+  int64_t SequenceLength(int64_t sequence_id) const TF_LOCKS_EXCLUDED(mu_);
+
+  int64_t num_allocated_pages() const TF_LOCKS_EXCLUDED(mu_);
+  int64_t num_free_pages() const TF_LOCKS_EXCLUDED(mu_);
+
+  string DebugString() const override;
+  int64_t MemoryUsed() const override;
+
+ private:
+  struct Sequence {
+    std::vector<Tensor> pages;
+    int64_t length = 0;
+  };
+
+  // Returns a page from the pool.
+  Tensor LockedTakePage() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const DataType dtype_;
+  const int64_t num_heads_;
+  const int64_t head_dim_;
+  const int64_t page_size_;
+  const int64_t max_pages_;
+  // The bytes of the key, or of the value, of one token.
+  const int64_t token_bytes_;
+
+  mutable mutex mu_;
+  std::unordered_map<int64_t, Sequence> sequences_ TF_GUARDED_BY(mu_);
+  std::vector<Tensor> free_pages_ TF_GUARDED_BY(mu_);
+  int64_t num_allocated_pages_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(KVCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_KV_CACHE_H_
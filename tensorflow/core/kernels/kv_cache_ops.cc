@@ -0,0 +1,185 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/data_flow_ops.cc.
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/kv_cache.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+class KVCacheOp : public ResourceOpKernel<KVCache> {
+ public:
+  explicit KVCacheOp(OpKernelConstruction* context)
+      : ResourceOpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("dtype", &dtype_));
+    OP_REQUIRES_OK(context, context->GetAttr("num_heads", &num_heads_));
+    OP_REQUIRES_OK(context, context->GetAttr("head_dim", &head_dim_));
+    OP_REQUIRES_OK(context, context->GetAttr("page_size", &page_size_));
+    OP_REQUIRES_OK(context, context->GetAttr("max_pages", &max_pages_));
+  }
+
+ private:
+  Status CreateResource(KVCache** resource) override
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    *resource =
+        new KVCache(dtype_, num_heads_, head_dim_, page_size_, max_pages_);
+    return Status::OK();
+  }
+
+  Status VerifyResource(KVCache* cache) override
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (cache->dtype() != dtype_ || cache->num_heads() != num_heads_ ||
+        cache->head_dim() != head_dim_ || cache->page_size() != page_size_ ||
+        cache->max_pages() != max_pages_) {
+      return errors::InvalidArgument("Shared KV cache '", cinfo_.name(),
+                                     "' has different attributes: ",
+                                     cache->DebugString());
+    }
+    return Status::OK();
+  }
+
+  DataType dtype_;
+  int64_t num_heads_;
+  int64_t head_dim_;
+  int64_t page_size_;
+  int64_t max_pages_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("KVCache").Device(DEVICE_CPU), KVCacheOp);
+
+class KVCacheAppendOp : public OpKernel {
+ public:
+  explicit KVCacheAppendOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    core::RefCountPtr<KVCache> cache;
+    OP_REQUIRES_OK(context, LookupResource(context, HandleFromInput(context, 0),
+                                           &cache));
+    OP_REQUIRES_OK(context, cache->Append(context->input(1), context->input(2),
+                                          context->input(3)));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("KVCacheAppend").Device(DEVICE_CPU),
+                        KVCacheAppendOp);
+
+class KVCacheRemoveOp : public OpKernel {
+ public:
+  explicit KVCacheRemoveOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    core::RefCountPtr<KVCache> cache;
+    OP_REQUIRES_OK(context, LookupResource(context, HandleFromInput(context, 0),
+                                           &cache));
+    OP_REQUIRES_OK(context, cache->Remove(context->input(1)));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("KVCacheRemove").Device(DEVICE_CPU),
+                        KVCacheRemoveOp);
+
+template <typename T>
+class KVCacheAttentionOp : public OpKernel {
+ public:
+  explicit KVCacheAttentionOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("scale", &scale_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    core::RefCountPtr<KVCache> cache;
+    OP_REQUIRES_OK(context, LookupResource(context, HandleFromInput(context, 0),
+                                           &cache));
+    const Tensor& sequence_ids = context->input(1);
+    const Tensor& queries = context->input(2);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(sequence_ids.shape()),
+                errors::InvalidArgument("sequence_ids must be a vector but has "
+                                        "shape ",
+                                        sequence_ids.shape().DebugString()));
+    const int64_t batch_size = sequence_ids.NumElements();
+    OP_REQUIRES(
+        context,
+        queries.dims() == 3 && queries.dim_size(0) == batch_size &&
+            queries.dim_size(1) == cache->num_heads() &&
+            queries.dim_size(2) == cache->head_dim(),
+        errors::InvalidArgument("queries must have shape [", batch_size, ", ",
+                                cache->num_heads(), ", ", cache->head_dim(),
+                                "] but have shape ",
+                                queries.shape().DebugString()));
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, queries.shape(), &output));
+    if (batch_size == 0) return;
+
+    const float scale =
+        scale_ != 0 ? scale_ : 1.0f / std::sqrt(cache->head_dim());
+    const auto ids = sequence_ids.vec<int64_t>();
+    int64_t num_tokens = 0;
+    for (int64_t b = 0; b < batch_size; ++b) {
+      num_tokens += cache->SequenceLength(ids(b));
+    }
+    const int64_t head_size = cache->num_heads() * cache->head_dim();
+    const T* query_data = queries.flat<T>().data();
+    T* output_data = output->flat<T>().data();
+
+    mutex mu;
+    Status status;
+    auto attend = [&](int64_t start, int64_t limit) {
+      for (int64_t b = start; b < limit; ++b) {
+        Status s = cache->Attend<T>(ids(b), query_data + b * head_size, scale,
+                                    output_data + b * head_size);
+        if (!s.ok()) {
+          mutex_lock l(mu);
+          status.Update(s);
+          return;
+        }
+      }
+    };
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          4 * head_size * (num_tokens / batch_size + 1), attend);
+    OP_REQUIRES_OK(context, status);
+  }
+
+ private:
+  float scale_;
+};
+
+#define REGISTER_KERNEL(T)                                                   \
+  REGISTER_KERNEL_BUILDER(                                                   \
+      Name("KVCacheAttention").Device(DEVICE_CPU).TypeConstraint<T>("dtype"), \
+      KVCacheAttentionOp<T>)
+
+TF_CALL_half(REGISTER_KERNEL);
+TF_CALL_bfloat16(REGISTER_KERNEL);
+TF_CALL_float(REGISTER_KERNEL);
+
+#undef REGISTER_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,102 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/kv_cache.h"
+
+#include <cmath>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Tensor Ids(std::initializer_list<int64_t> ids) {
+  return test::AsTensor<int64_t>(ids);
+}
+
+Tensor Tokens(std::initializer_list<float> values, const TensorShape& shape) {
+  return test::AsTensor<float>(values, shape);
+}
+
+TEST(KVCacheTest, AttendsOverPages) {
+  core::RefCountPtr<KVCache> cache(new KVCache(
+      DT_FLOAT, /*num_heads=*/1, /*head_dim=*/2, /*page_size=*/2,
+      /*max_pages=*/0));
+  // Two tokens at once, then a third one that starts a second page.
+  TF_ASSERT_OK(cache->Append(Ids({7}), Tokens({1, 0, 0, 1}, {1, 2, 1, 2}),
+                             Tokens({1, 2, 3, 4}, {1, 2, 1, 2})));
+  TF_ASSERT_OK(cache->Append(Ids({7}), Tokens({1, 1}, {1, 1, 2}),
+                             Tokens({5, 6}, {1, 1, 2})));
+  EXPECT_EQ(cache->SequenceLength(7), 3);
+  EXPECT_EQ(cache->num_allocated_pages(), 2);
+
+  const float query[] = {1, 0};
+  float output[2];
+  TF_ASSERT_OK(cache->Attend<float>(7, query, /*scale=*/1, output));
+  // The scores are 1, 0 and 1.
+  const float e = std::exp(1.0f);
+  EXPECT_NEAR(output[0], (e * 1 + 3 + e * 5) / (2 * e + 1), 1e-5);
+  EXPECT_NEAR(output[1], (e * 2 + 4 + e * 6) / (2 * e + 1), 1e-5);
+}
+
+TEST(KVCacheTest, RemovedSequencesReturnPagesToThePool) {
+  core::RefCountPtr<KVCache> cache(new KVCache(
+      DT_FLOAT, /*num_heads=*/1, /*head_dim=*/1, /*page_size=*/1,
+      /*max_pages=*/2));
+  TF_ASSERT_OK(cache->Append(Ids({1, 2}), Tokens({1, 2}, {2, 1, 1}),
+                             Tokens({1, 2}, {2, 1, 1})));
+  Status s = cache->Append(Ids({3}), Tokens({3}, {1, 1, 1}),
+                           Tokens({3}, {1, 1, 1}));
+  EXPECT_TRUE(errors::IsResourceExhausted(s)) << s;
+  EXPECT_EQ(cache->SequenceLength(3), 0);
+
+  TF_ASSERT_OK(cache->Remove(Ids({1})));
+  EXPECT_EQ(cache->num_free_pages(), 1);
+  TF_ASSERT_OK(cache->Append(Ids({3}), Tokens({3}, {1, 1, 1}),
+                             Tokens({30}, {1, 1, 1})));
+  EXPECT_EQ(cache->num_allocated_pages(), 2);
+  EXPECT_EQ(cache->num_free_pages(), 0);
+
+  float query = 1;
+  float output;
+  TF_ASSERT_OK(cache->Attend<float>(3, &query, /*scale=*/1, &output));
+  EXPECT_EQ(output, 30);
+}
+
+TEST(KVCacheTest, UnknownSequences) {
+  core::RefCountPtr<KVCache> cache(new KVCache(
+      DT_FLOAT, /*num_heads=*/1, /*head_dim=*/1, /*page_size=*/4,
+      /*max_pages=*/0));
+  float query = 1;
+  float output;
+  EXPECT_TRUE(errors::IsNotFound(cache->Attend<float>(5, &query, 1, &output)));
+  EXPECT_TRUE(errors::IsNotFound(cache->Remove(Ids({5}))));
+}
+
+TEST(KVCacheTest, WrongShape) {
+  core::RefCountPtr<KVCache> cache(new KVCache(
+      DT_FLOAT, /*num_heads=*/2, /*head_dim=*/1, /*page_size=*/4,
+      /*max_pages=*/0));
+  Status s = cache->Append(Ids({1}), Tokens({1, 2, 3}, {1, 3, 1}),
+                           Tokens({1, 2, 3}, {1, 3, 1}));
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
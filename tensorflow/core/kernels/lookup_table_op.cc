@@ -16,11 +16,16 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
@@ -427,11 +432,20 @@ TensorShape MaybeVectorizeShape(const TensorShape& shape) {
 
 }  // namespace
 
+template <class K, class V>
+class ShardedMutableDenseHashTable;
+
 // Modeled after densehashtable in https://github.com/sparsehash/sparsehash
 template <class K, class V>
 class MutableDenseHashTable final : public LookupInterface {
  public:
-  MutableDenseHashTable(OpKernelContext* ctx, OpKernel* kernel) {
+  MutableDenseHashTable(OpKernelContext* ctx, OpKernel* kernel)
+      : MutableDenseHashTable(ctx, kernel, /*num_shards=*/1) {}
+
+  // Creates one of the "num_shards" shards of a ShardedMutableDenseHashTable,
+  // starting with its share of the "initial_num_buckets" attr.
+  MutableDenseHashTable(OpKernelContext* ctx, OpKernel* kernel,
+                        int64_t num_shards) {
     OP_REQUIRES_OK(
         ctx, GetNodeAttr(kernel->def(), "max_load_factor", &max_load_factor_));
     OP_REQUIRES(ctx, max_load_factor_ > 0 && max_load_factor_ < 1,
@@ -488,6 +502,13 @@ class MutableDenseHashTable final : public LookupInterface {
     int64_t initial_num_buckets;
     OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "initial_num_buckets",
                                     &initial_num_buckets));
+    if (num_shards > 1) {
+      const int64_t shard_num_buckets = initial_num_buckets / num_shards;
+      initial_num_buckets = 4;
+      while (initial_num_buckets < shard_num_buckets) {
+        initial_num_buckets <<= 1;
+      }
+    }
     OP_REQUIRES_OK(ctx, AllocateBuckets(ctx, initial_num_buckets));
   }
 
@@ -876,8 +897,699 @@ class MutableDenseHashTable final : public LookupInterface {
   uint64 empty_key_hash_;
   Tensor deleted_key_;
   uint64 deleted_key_hash_;
+
+  friend class ShardedMutableDenseHashTable<K, V>;
+};
+
+// A MutableDenseHashTable split by key hash into "num_shards" independent
+// shards, each with its own lock and its own buckets. Concurrent lookups and
+// inserts only contend on the shards their keys fall into, and growing a shard
+// rehashes just that shard.
+//
+// Exported keys and values are the concatenated buckets of all shards. They
+// can be imported into a ShardedMutableDenseHashTable with any number of
+// shards, which also accepts the export of a MutableDenseHashTable.
+template <class K, class V>
+class ShardedMutableDenseHashTable final : public LookupInterface {
+ public:
+  ShardedMutableDenseHashTable(OpKernelContext* ctx, OpKernel* kernel) {
+    int64_t num_shards;
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "num_shards", &num_shards));
+    OP_REQUIRES(ctx, num_shards >= 1,
+                errors::InvalidArgument("num_shards must be at least 1, got: ",
+                                        num_shards));
+    shards_.reserve(num_shards);
+    for (int64_t i = 0; i < num_shards; ++i) {
+      shards_.emplace_back(
+          new MutableDenseHashTable<K, V>(ctx, kernel, num_shards));
+      if (!ctx->status().ok()) return;
+    }
+  }
+
+  size_t size() const override {
+    size_t size = 0;
+    for (const auto& shard : shards_) {
+      size += shard->size();
+    }
+    return size;
+  }
+
+  Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+              const Tensor& default_value) override {
+    if (shards_.size() == 1) {
+      return shards_[0]->Find(ctx, key, value, default_value);
+    }
+    TF_RETURN_IF_ERROR(CheckKeyBatch(key));
+    const std::vector<std::vector<int64_t>> rows = PartitionKeys(key);
+    for (int s = 0; s < shards_.size(); ++s) {
+      if (rows[s].empty()) continue;
+      Tensor shard_key, shard_value;
+      TF_RETURN_IF_ERROR(GatherRows<K>(ctx, key, rows[s], &shard_key));
+      TF_RETURN_IF_ERROR(AllocateRows<V>(ctx, *value, rows[s].size(),
+                                         &shard_value));
+      TF_RETURN_IF_ERROR(
+          shards_[s]->Find(ctx, shard_key, &shard_value, default_value));
+      ScatterRows<V>(shard_value, rows[s], value);
+    }
+    return Status::OK();
+  }
+
+  Status Insert(OpKernelContext* ctx, const Tensor& key,
+                const Tensor& value) override {
+    if (shards_.size() == 1) {
+      return shards_[0]->Insert(ctx, key, value);
+    }
+    TF_RETURN_IF_ERROR(CheckKeyBatch(key));
+    const std::vector<std::vector<int64_t>> rows = PartitionKeys(key);
+    for (int s = 0; s < shards_.size(); ++s) {
+      if (rows[s].empty()) continue;
+      Tensor shard_key, shard_value;
+      TF_RETURN_IF_ERROR(GatherRows<K>(ctx, key, rows[s], &shard_key));
+      TF_RETURN_IF_ERROR(GatherRows<V>(ctx, value, rows[s], &shard_value));
+      TF_RETURN_IF_ERROR(shards_[s]->Insert(ctx, shard_key, shard_value));
+    }
+    return Status::OK();
+  }
+
+  Status Remove(OpKernelContext* ctx, const Tensor& key) override {
+    if (shards_.size() == 1) {
+      return shards_[0]->Remove(ctx, key);
+    }
+    TF_RETURN_IF_ERROR(CheckKeyBatch(key));
+    const std::vector<std::vector<int64_t>> rows = PartitionKeys(key);
+    for (int s = 0; s < shards_.size(); ++s) {
+      if (rows[s].empty()) continue;
+      Tensor shard_key;
+      TF_RETURN_IF_ERROR(GatherRows<K>(ctx, key, rows[s], &shard_key));
+      TF_RETURN_IF_ERROR(shards_[s]->Remove(ctx, shard_key));
+    }
+    return Status::OK();
+  }
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override {
+    // "keys" holds the buckets of the exported table(s). Drops the empty and
+    // deleted buckets and re-partitions the remaining entries, as the number
+    // of shards may differ from the exporting table.
+    const MutableDenseHashTable<K, V>& shard0 = *shards_[0];
+    const int64_t key_size = shard0.key_shape_.num_elements();
+    const auto key_matrix = keys.shaped<K, 2>({keys.dim_size(0), key_size});
+    // IsEqualKey() takes a non-const bucket matrix.
+    Tensor key_buckets = keys;
+    const auto key_buckets_matrix =
+        key_buckets.shaped<K, 2>({keys.dim_size(0), key_size});
+    const auto empty_key_matrix =
+        shard0.empty_key_.template shaped<K, 2>({1, key_size});
+    const auto deleted_key_matrix =
+        shard0.deleted_key_.template shaped<K, 2>({1, key_size});
+    std::vector<std::vector<int64_t>> rows(shards_.size());
+    for (int64_t i = 0; i < keys.dim_size(0); ++i) {
+      if (shard0.IsEqualKey(key_buckets_matrix, i, empty_key_matrix, 0) ||
+          shard0.IsEqualKey(key_buckets_matrix, i, deleted_key_matrix, 0)) {
+        continue;
+      }
+      rows[ShardIndex(key_matrix, i)].push_back(i);
+    }
+    for (int s = 0; s < shards_.size(); ++s) {
+      MutableDenseHashTable<K, V>& shard = *shards_[s];
+      Tensor shard_keys, shard_values;
+      TF_RETURN_IF_ERROR(GatherRows<K>(ctx, keys, rows[s], &shard_keys));
+      TF_RETURN_IF_ERROR(GatherRows<V>(ctx, values, rows[s], &shard_values));
+      int64_t num_buckets = 4;
+      while (rows[s].size() > num_buckets * shard.max_load_factor_) {
+        num_buckets <<= 1;
+      }
+      mutex_lock l(shard.mu_);
+      TF_RETURN_IF_ERROR(shard.AllocateBuckets(ctx, num_buckets));
+      TF_RETURN_IF_ERROR(shard.DoInsert(ctx, shard_keys, shard_values,
+                                        /*ignore_empty_and_deleted_key=*/
+                                        false));
+    }
+    return Status::OK();
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override {
+    // Copies the buckets of one shard at a time, so an export concurrent with
+    // updates may see some of them in some shards only.
+    std::vector<Tensor> key_buckets(shards_.size());
+    std::vector<Tensor> value_buckets(shards_.size());
+    int64_t num_buckets = 0;
+    for (int s = 0; s < shards_.size(); ++s) {
+      tf_shared_lock l(shards_[s]->mu_);
+      key_buckets[s] = tensor::DeepCopy(shards_[s]->key_buckets_);
+      value_buckets[s] = tensor::DeepCopy(shards_[s]->value_buckets_);
+      num_buckets += key_buckets[s].dim_size(0);
+    }
+    const int64_t key_size = key_buckets[0].dim_size(1);
+    const int64_t value_size = value_buckets[0].dim_size(1);
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("keys", TensorShape({num_buckets, key_size}),
+                             &keys));
+    TF_RETURN_IF_ERROR(ctx->allocate_output(
+        "values", TensorShape({num_buckets, value_size}), &values));
+    auto keys_matrix = keys->matrix<K>();
+    auto values_matrix = values->matrix<V>();
+    int64_t offset = 0;
+    for (int s = 0; s < shards_.size(); ++s) {
+      const auto shard_keys = key_buckets[s].matrix<K>();
+      const auto shard_values = value_buckets[s].matrix<V>();
+      for (int64_t i = 0; i < key_buckets[s].dim_size(0); ++i, ++offset) {
+        for (int64_t j = 0; j < key_size; ++j) {
+          keys_matrix(offset, j) = shard_keys(i, j);
+        }
+        for (int64_t j = 0; j < value_size; ++j) {
+          values_matrix(offset, j) = shard_values(i, j);
+        }
+      }
+    }
+    return Status::OK();
+  }
+
+  Status CheckKeyAndValueTensorsForImport(const Tensor& keys,
+                                          const Tensor& values) override {
+    return shards_[0]->CheckKeyAndValueTensorsForImport(keys, values);
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const override { return shards_[0]->key_shape(); }
+
+  TensorShape value_shape() const override {
+    return shards_[0]->value_shape();
+  }
+
+  int64_t MemoryUsed() const override {
+    int64_t memory_used = sizeof(ShardedMutableDenseHashTable);
+    for (const auto& shard : shards_) {
+      memory_used += shard->MemoryUsed();
+    }
+    return memory_used;
+  }
+
+ private:
+  Status CheckKeyBatch(const Tensor& key) const {
+    const int64_t num_elements = (key.dims() == 0) ? 1 : key.dim_size(0);
+    if (key.NumElements() != num_elements * key_shape().num_elements()) {
+      TensorShape expected_shape({num_elements});
+      expected_shape.AppendShape(key_shape());
+      return errors::InvalidArgument("Expected key shape ",
+                                     expected_shape.DebugString(), " got ",
+                                     key.shape().DebugString());
+    }
+    return Status::OK();
+  }
+
+  // Maps a key to its shard. The shards index their buckets with the low
+  // bits of the key hash, which are identical for integer keys, so the shard
+  // is picked from the high bits of a multiplicative hash instead.
+  int ShardIndex(typename TTypes<K>::ConstMatrix key, int64_t index) const {
+    const uint64 hash = shards_[0]->HashKey(key, index);
+    return ((hash * 0x9E3779B97F4A7C15ULL) >> 32) % shards_.size();
+  }
+
+  // Returns the rows of "key" that fall into each shard.
+  std::vector<std::vector<int64_t>> PartitionKeys(const Tensor& key) const {
+    const int64_t num_elements = (key.dims() == 0) ? 1 : key.dim_size(0);
+    const auto key_matrix =
+        key.shaped<K, 2>({num_elements, key_shape().num_elements()});
+    std::vector<std::vector<int64_t>> rows(shards_.size());
+    for (int64_t i = 0; i < num_elements; ++i) {
+      rows[ShardIndex(key_matrix, i)].push_back(i);
+    }
+    return rows;
+  }
+
+  // Allocates "out" with "num_rows" rows shaped like the rows of "like".
+  template <typename T>
+  static Status AllocateRows(OpKernelContext* ctx, const Tensor& like,
+                             int64_t num_rows, Tensor* out) {
+    TensorShape shape({num_rows});
+    if (like.dims() > 1) {
+      TensorShape row_shape = like.shape();
+      row_shape.RemoveDim(0);
+      shape.AppendShape(row_shape);
+    }
+    return ctx->allocate_temp(DataTypeToEnum<T>::v(), shape, out);
+  }
+
+  // Copies the given rows of "in" into a newly allocated "out".
+  template <typename T>
+  static Status GatherRows(OpKernelContext* ctx, const Tensor& in,
+                           const std::vector<int64_t>& rows, Tensor* out) {
+    TF_RETURN_IF_ERROR(AllocateRows<T>(ctx, in, rows.size(), out));
+    const int64_t num_rows = (in.dims() == 0) ? 1 : in.dim_size(0);
+    const int64_t row_size = num_rows == 0 ? 0 : in.NumElements() / num_rows;
+    const auto in_matrix = in.shaped<T, 2>({num_rows, row_size});
+    auto out_matrix = out->shaped<T, 2>(
+        {static_cast<int64_t>(rows.size()), row_size});
+    for (int64_t i = 0; i < rows.size(); ++i) {
+      for (int64_t j = 0; j < row_size; ++j) {
+        out_matrix(i, j) = in_matrix(rows[i], j);
+      }
+    }
+    return Status::OK();
+  }
+
+  // Copies the rows of "in" back to the given rows of "out".
+  template <typename T>
+  static void ScatterRows(const Tensor& in, const std::vector<int64_t>& rows,
+                          Tensor* out) {
+    const int64_t num_rows = (out->dims() == 0) ? 1 : out->dim_size(0);
+    const int64_t row_size = num_rows == 0 ? 0 : out->NumElements() / num_rows;
+    const auto in_matrix =
+        in.shaped<T, 2>({static_cast<int64_t>(rows.size()), row_size});
+    auto out_matrix = out->shaped<T, 2>({num_rows, row_size});
+    for (int64_t i = 0; i < rows.size(); ++i) {
+      for (int64_t j = 0; j < row_size; ++j) {
+        out_matrix(rows[i], j) = in_matrix(i, j);
+      }
+    }
+  }
+
+  std::vector<core::RefCountPtr<MutableDenseHashTable<K, V>>> shards_;
 };
 
+// Tables are created and looked up as LookupInterfaces, and kernels are built
+// without RTTI, so the DynamicEmbeddingTables register themselves here to let
+// ops that need the concrete type check a table before downcasting it.
+namespace {
+
+mutex dynamic_embedding_tables_mu(LINKER_INITIALIZED);
+
+absl::flat_hash_set<const LookupInterface*>* LiveDynamicEmbeddingTables()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(dynamic_embedding_tables_mu) {
+  static auto* tables = new absl::flat_hash_set<const LookupInterface*>;
+  return tables;
+}
+
+}  // namespace
+
+// Hash table for embeddings of an open set of keys, e.g. for online training.
+//
+// The values of all keys, followed by "num_slots" optimizer slots of the same
+// shape (initialized to "slot_init_value"), are stored as rows of fixed-size
+// slabs, so the table does not allocate per key and the slots of a key are
+// next to its value.
+//
+// A key is admitted into the table by the "min_frequency"-th Insert of it;
+// until then inserts only count it and lookups return the default value. If
+// "capacity" is set, admitting a key into a full table first evicts the
+// least recently used ("lru"), least frequently inserted ("lfu") or, for
+// "ttl", least recently used entries. With "ttl", entries that were neither
+// found nor inserted in the last "ttl_steps" Insert calls are also evicted by
+// a sweep every "ttl_steps" Insert calls.
+//
+// Exported values are full rows, with the slots after the value. Imports
+// accept either full rows or just the values, which resets the slots.
+template <class K, class V>
+class DynamicEmbeddingTable final : public LookupInterface {
+ public:
+  DynamicEmbeddingTable(OpKernelContext* ctx, OpKernel* kernel) {
+    OP_REQUIRES_OK(ctx,
+                   GetNodeAttr(kernel->def(), "value_shape", &value_shape_));
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::IsVector(value_shape_),
+        errors::InvalidArgument("Default value must be a vector, got shape ",
+                                value_shape_.DebugString()));
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "num_slots", &num_slots_));
+    float slot_init_value;
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "slot_init_value",
+                                    &slot_init_value));
+    slot_init_value_ = static_cast<V>(slot_init_value);
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "capacity", &capacity_));
+    OP_REQUIRES_OK(
+        ctx, GetNodeAttr(kernel->def(), "min_frequency", &min_frequency_));
+    std::string eviction_policy;
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "eviction_policy",
+                                    &eviction_policy));
+    if (eviction_policy == "lru") {
+      eviction_policy_ = EvictionPolicy::kLru;
+    } else if (eviction_policy == "lfu") {
+      eviction_policy_ = EvictionPolicy::kLfu;
+    } else if (eviction_policy == "ttl") {
+      eviction_policy_ = EvictionPolicy::kTtl;
+    } else {
+      ctx->SetStatus(errors::InvalidArgument("Unknown eviction_policy: ",
+                                             eviction_policy));
+      return;
+    }
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "ttl_steps", &ttl_steps_));
+
+    value_dim_ = value_shape_.dim_size(0);
+    row_size_ = value_dim_ * (1 + num_slots_);
+    slab_rows_ = (capacity_ > 0 && capacity_ < kMaxSlabRows) ? capacity_
+                                                             : kMaxSlabRows;
+
+    mutex_lock l(dynamic_embedding_tables_mu);
+    LiveDynamicEmbeddingTables()->insert(this);
+  }
+
+  ~DynamicEmbeddingTable() override {
+    mutex_lock l(dynamic_embedding_tables_mu);
+    LiveDynamicEmbeddingTables()->erase(this);
+  }
+
+  size_t size() const override {
+    tf_shared_lock l(mu_);
+    return table_.size();
+  }
+
+  Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+              const Tensor& default_value) override {
+    const auto default_flat = default_value.flat_inner_dims<V, 2>();
+    const auto key_values = key.flat<K>();
+    auto value_values = value->flat_inner_dims<V, 2>();
+    const bool is_full_size_default =
+        (value_values.size() == default_flat.size());
+
+    // Not a shared lock, as lookups update the recency of the keys they find.
+    mutex_lock l(mu_);
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      auto it = table_.find(SubtleMustCopyIfIntegral(key_values(i)));
+      if (it != table_.end()) {
+        it->second.last_access = step_;
+        const V* row = Row(it->second.row);
+        for (int64_t j = 0; j < value_dim_; ++j) {
+          value_values(i, j) = row[j];
+        }
+      } else {
+        for (int64_t j = 0; j < value_dim_; ++j) {
+          value_values(i, j) =
+              is_full_size_default ? default_flat(i, j) : default_flat(0, j);
+        }
+      }
+    }
+    return Status::OK();
+  }
+
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
+    const auto key_values = keys.flat<K>();
+    const auto value_values = values.flat_inner_dims<V, 2>();
+
+    mutex_lock l(mu_);
+    ++step_;
+    if (eviction_policy_ == EvictionPolicy::kTtl && ttl_steps_ > 0 &&
+        step_ % ttl_steps_ == 0) {
+      EvictExpiredLocked();
+    }
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      const K key = SubtleMustCopyIfIntegral(key_values(i));
+      auto it = table_.find(key);
+      if (it == table_.end()) {
+        if (!AdmitLocked(key)) continue;
+        it = table_.emplace(key, NewEntryLocked(min_frequency_ - 1)).first;
+      }
+      ++it->second.frequency;
+      it->second.last_access = step_;
+      V* row = Row(it->second.row);
+      for (int64_t j = 0; j < value_dim_; ++j) {
+        row[j] = value_values(i, j);
+      }
+    }
+    return Status::OK();
+  }
+
+  Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
+    const auto key_values = keys.flat<K>();
+
+    mutex_lock l(mu_);
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      const K key = SubtleMustCopyIfIntegral(key_values(i));
+      auto it = table_.find(key);
+      if (it != table_.end()) {
+        free_rows_.push_back(it->second.row);
+        table_.erase(it);
+      }
+      pending_.erase(key);
+    }
+    return Status::OK();
+  }
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override {
+    const auto key_values = keys.flat<K>();
+    const auto value_values = values.matrix<V>();
+    const bool has_slots = values.dim_size(1) == row_size_;
+    if (capacity_ > 0 && key_values.size() > capacity_) {
+      return errors::InvalidArgument("Importing ", key_values.size(),
+                                     " keys into a table of capacity ",
+                                     capacity_);
+    }
+
+    mutex_lock l(mu_);
+    table_.clear();
+    pending_.clear();
+    free_rows_.clear();
+    num_rows_ = 0;
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      const K key = SubtleMustCopyIfIntegral(key_values(i));
+      auto it = table_.find(key);
+      if (it == table_.end()) {
+        it = table_.emplace(key, NewEntryLocked(min_frequency_)).first;
+      }
+      it->second.last_access = step_;
+      V* row = Row(it->second.row);
+      for (int64_t j = 0; j < (has_slots ? row_size_ : value_dim_); ++j) {
+        row[j] = value_values(i, j);
+      }
+    }
+    return Status::OK();
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override {
+    tf_shared_lock l(mu_);
+    const int64_t size = table_.size();
+
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("keys", TensorShape({size}), &keys));
+    TF_RETURN_IF_ERROR(ctx->allocate_output(
+        "values", TensorShape({size, row_size_}), &values));
+    auto keys_data = keys->flat<K>();
+    auto values_data = values->matrix<V>();
+    int64_t i = 0;
+    for (const auto& it : table_) {
+      keys_data(i) = it.first;
+      const V* row = Row(it.second.row);
+      for (int64_t j = 0; j < row_size_; ++j) {
+        values_data(i, j) = row[j];
+      }
+      ++i;
+    }
+    return Status::OK();
+  }
+
+  Status CheckKeyAndValueTensorsForImport(const Tensor& keys,
+                                          const Tensor& values) override {
+    TF_RETURN_IF_ERROR(CheckKeyAndValueTypes(keys, values));
+    if (!TensorShapeUtils::IsVector(keys.shape()) ||
+        !TensorShapeUtils::IsMatrix(values.shape()) ||
+        keys.dim_size(0) != values.dim_size(0) ||
+        (values.dim_size(1) != value_dim_ &&
+         values.dim_size(1) != row_size_)) {
+      return errors::InvalidArgument(
+          "Expected keys of shape [n] and values of shape [n, ", value_dim_,
+          "] or [n, ", row_size_, "], got ", keys.shape().DebugString(),
+          " and ", values.shape().DebugString());
+    }
+    return Status::OK();
+  }
+
+  // Applies an Adagrad update with learning rate "lr" to the values of
+  // "keys", accumulating the squared gradients in the first slot. Keys that
+  // are not in the table are skipped.
+  Status ApplyAdagrad(const Tensor& keys, const Tensor& grad, V lr,
+                      bool update_slots) {
+    if (num_slots_ < 1) {
+      return errors::FailedPrecondition(
+          "Adagrad needs a table with at least one slot");
+    }
+    if (grad.NumElements() != keys.NumElements() * value_dim_) {
+      return errors::InvalidArgument("Expected grad of shape [",
+                                     keys.NumElements(), ", ", value_dim_,
+                                     "], got ", grad.shape().DebugString());
+    }
+    const auto key_values = keys.flat<K>();
+    const auto grad_values = grad.shaped<V, 2>({key_values.size(), value_dim_});
+
+    mutex_lock l(mu_);
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      auto it = table_.find(SubtleMustCopyIfIntegral(key_values(i)));
+      if (it == table_.end()) continue;
+      it->second.last_access = step_;
+      V* var = Row(it->second.row);
+      V* accum = var + value_dim_;
+      for (int64_t j = 0; j < value_dim_; ++j) {
+        const V g = grad_values(i, j);
+        if (update_slots) {
+          accum[j] += g * g;
+        }
+        var[j] -= lr * g / std::sqrt(accum[j]);
+      }
+    }
+    return Status::OK();
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const final { return TensorShape(); }
+
+  TensorShape value_shape() const override { return value_shape_; }
+
+  int64_t MemoryUsed() const override {
+    tf_shared_lock l(mu_);
+    return sizeof(DynamicEmbeddingTable) +
+           slabs_.size() * slab_rows_ * row_size_ * sizeof(V) +
+           table_.capacity() * (sizeof(K) + sizeof(Entry)) +
+           pending_.capacity() * (sizeof(K) + sizeof(int64_t)) +
+           free_rows_.capacity() * sizeof(int64_t);
+  }
+
+ private:
+  enum class EvictionPolicy { kLru, kLfu, kTtl };
+
+  struct Entry {
+    int64_t row;
+    // Number of Insert calls that included the key.
+    int64_t frequency;
+    // Value of step_ when the key was last found or inserted.
+    int64_t last_access;
+  };
+
+  // Upper bound of the rows of a slab.
+  static constexpr int64_t kMaxSlabRows = 1024;
+
+  V* Row(int64_t row) TF_SHARED_LOCKS_REQUIRED(mu_) {
+    return slabs_[row / slab_rows_].template flat<V>().data() +
+           (row % slab_rows_) * row_size_;
+  }
+
+  // Counts an insert of a key that is not in the table, and returns whether
+  // it is now admitted, after making room for it.
+  bool AdmitLocked(const K& key) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (min_frequency_ > 1) {
+      auto it = pending_.find(key);
+      if (it == pending_.end()) {
+        // Bounds the memory of the keys that are never admitted.
+        if (capacity_ > 0 &&
+            static_cast<int64_t>(pending_.size()) >= capacity_) {
+          pending_.clear();
+        }
+        it = pending_.emplace(key, 0).first;
+      }
+      if (++it->second < min_frequency_) return false;
+      pending_.erase(it);
+    }
+    if (capacity_ > 0 && static_cast<int64_t>(table_.size()) >= capacity_) {
+      // Evicts in batches to amortize the scan of the table.
+      EvictLocked(std::max<int64_t>(1, capacity_ / 16));
+    }
+    return true;
+  }
+
+  // Returns an entry for a new key, with its slots initialized.
+  Entry NewEntryLocked(int64_t frequency) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    int64_t row;
+    if (!free_rows_.empty()) {
+      row = free_rows_.back();
+      free_rows_.pop_back();
+    } else {
+      if (num_rows_ == static_cast<int64_t>(slabs_.size()) * slab_rows_) {
+        slabs_.emplace_back(DataTypeToEnum<V>::v(),
+                            TensorShape({slab_rows_, row_size_}));
+      }
+      row = num_rows_++;
+    }
+    V* slots = Row(row) + value_dim_;
+    std::fill(slots, slots + num_slots_ * value_dim_, slot_init_value_);
+    return Entry{row, frequency, step_};
+  }
+
+  // Evicts the "num_to_evict" entries that come first in the eviction order.
+  void EvictLocked(int64_t num_to_evict) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    std::vector<std::pair<std::pair<int64_t, int64_t>, K>> candidates;
+    candidates.reserve(table_.size());
+    for (const auto& it : table_) {
+      const Entry& entry = it.second;
+      candidates.emplace_back(
+          eviction_policy_ == EvictionPolicy::kLfu
+              ? std::make_pair(entry.frequency, entry.last_access)
+              : std::make_pair(entry.last_access, entry.frequency),
+          it.first);
+    }
+    num_to_evict = std::min<int64_t>(num_to_evict, candidates.size());
+    std::nth_element(candidates.begin(), candidates.begin() + num_to_evict,
+                     candidates.end(),
+                     [](const auto& a, const auto& b) {
+                       return a.first < b.first;
+                     });
+    for (int64_t i = 0; i < num_to_evict; ++i) {
+      auto it = table_.find(candidates[i].second);
+      free_rows_.push_back(it->second.row);
+      table_.erase(it);
+    }
+  }
+
+  // Evicts the entries not accessed in the last ttl_steps_ steps, and forgets
+  // the counts of the keys that are not admitted yet.
+  void EvictExpiredLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    for (auto it = table_.begin(); it != table_.end();) {
+      if (step_ - it->second.last_access > ttl_steps_) {
+        free_rows_.push_back(it->second.row);
+        table_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+    pending_.clear();
+  }
+
+  TensorShape value_shape_;
+  int64_t value_dim_;
+  int64_t num_slots_;
+  V slot_init_value_;
+  int64_t row_size_;
+  int64_t capacity_;
+  int64_t min_frequency_;
+  EvictionPolicy eviction_policy_;
+  int64_t ttl_steps_;
+  int64_t slab_rows_;
+
+  mutable mutex mu_;
+  std::vector<Tensor> slabs_ TF_GUARDED_BY(mu_);
+  // Rows of slabs_ handed out so far, including the rows in free_rows_.
+  int64_t num_rows_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<int64_t> free_rows_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<K, Entry> table_ TF_GUARDED_BY(mu_);
+  // Insert counts of the keys that are not admitted yet.
+  absl::flat_hash_map<K, int64_t> pending_ TF_GUARDED_BY(mu_);
+  // Number of Insert calls so far.
+  int64_t step_ TF_GUARDED_BY(mu_) = 0;
+};
+
+// Returns "table" as a DynamicEmbeddingTable<K, V>, or nullptr if it is a
+// different kind of table.
+template <class K, class V>
+DynamicEmbeddingTable<K, V>* AsDynamicEmbeddingTable(LookupInterface* table) {
+  {
+    mutex_lock l(dynamic_embedding_tables_mu);
+    if (!LiveDynamicEmbeddingTables()->contains(table)) return nullptr;
+  }
+  if (table->key_dtype() != DataTypeToEnum<K>::v() ||
+      table->value_dtype() != DataTypeToEnum<V>::v()) {
+    return nullptr;
+  }
+  return static_cast<DynamicEmbeddingTable<K, V>*>(table);
+}
+
 }  // namespace lookup
 
 // Base class for kernels that take a LookupTable handle as the 0th input.
@@ -1217,6 +1929,14 @@ REGISTER_KERNEL(tstring, int64_t);
           .TypeConstraint<value_dtype>("value_dtype"),                      \
       LookupTableOp<lookup::MutableDenseHashTable<key_dtype, value_dtype>,  \
                     key_dtype, value_dtype>)                                \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("ShardedMutableDenseHashTable")                                  \
+          .Device(DEVICE_CPU)                                               \
+          .TypeConstraint<key_dtype>("key_dtype")                           \
+          .TypeConstraint<value_dtype>("value_dtype"),                      \
+      LookupTableOp<                                                        \
+          lookup::ShardedMutableDenseHashTable<key_dtype, value_dtype>,     \
+          key_dtype, value_dtype>)                                          \
   REGISTER_KERNEL_BUILDER(                                                  \
       Name("AnonymousMutableDenseHashTable")                                \
           .Device(DEVICE_CPU)                                               \
@@ -1244,4 +1964,66 @@ REGISTER_KERNEL(tstring, ResourceHandle);
 
 #undef REGISTER_KERNEL
 
+// Op that applies an Adagrad update to the values of a DynamicEmbeddingTable,
+// with the accumulators in its first slot.
+template <class K, class V>
+class DynamicEmbeddingSparseApplyAdagradOp : public LookupTableOpKernel {
+ public:
+  explicit DynamicEmbeddingSparseApplyAdagradOp(OpKernelConstruction* ctx)
+      : LookupTableOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("update_slots", &update_slots_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    lookup::LookupInterface* table;
+    OP_REQUIRES_OK(ctx, GetTable(ctx, &table));
+    core::ScopedUnref unref_me(table);
+    lookup::DynamicEmbeddingTable<K, V>* embedding_table =
+        lookup::AsDynamicEmbeddingTable<K, V>(table);
+    OP_REQUIRES(ctx, embedding_table != nullptr,
+                errors::InvalidArgument(
+                    "Expected a DynamicEmbeddingTable with ",
+                    DataTypeString(DataTypeToEnum<K>::v()), " keys and ",
+                    DataTypeString(DataTypeToEnum<V>::v()), " values"));
+
+    const Tensor& lr = ctx->input(1);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(lr.shape()),
+                errors::InvalidArgument("lr is not a scalar: ",
+                                        lr.shape().DebugString()));
+    const Tensor& grad = ctx->input(2);
+    const Tensor& indices = ctx->input(3);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(indices.shape()),
+                errors::InvalidArgument("indices must be one-dimensional: ",
+                                        indices.shape().DebugString()));
+    OP_REQUIRES_OK(ctx, embedding_table->ApplyAdagrad(
+                            indices, grad, lr.scalar<V>()(), update_slots_));
+  }
+
+ private:
+  bool update_slots_;
+};
+
+// Register the DynamicEmbeddingTable op and its optimizer ops.
+#define REGISTER_KERNEL(key_dtype, value_dtype)                             \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("DynamicEmbeddingTable")                                         \
+          .Device(DEVICE_CPU)                                               \
+          .TypeConstraint<key_dtype>("key_dtype")                           \
+          .TypeConstraint<value_dtype>("value_dtype"),                      \
+      LookupTableOp<lookup::DynamicEmbeddingTable<key_dtype, value_dtype>,  \
+                    key_dtype, value_dtype>)                                \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("DynamicEmbeddingSparseApplyAdagrad")                            \
+          .Device(DEVICE_CPU)                                               \
+          .TypeConstraint<value_dtype>("T")                                 \
+          .TypeConstraint<key_dtype>("Tindices"),                           \
+      DynamicEmbeddingSparseApplyAdagradOp<key_dtype, value_dtype>)
+
+REGISTER_KERNEL(int32, double);
+REGISTER_KERNEL(int32, float);
+REGISTER_KERNEL(int64_t, double);
+REGISTER_KERNEL(int64_t, float);
+
+#undef REGISTER_KERNEL
+
 }  // namespace tensorflow
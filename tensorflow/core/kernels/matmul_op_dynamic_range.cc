@@ -0,0 +1,290 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Implements _DynamicRangeQuantizedMatMul, a float MatMul with int8 weights
+// that quantizes the activations on the fly, multiplies in int8 and
+// dequantizes the int32 accumulators in one kernel:
+//  - MatMul
+//  - MatMul + BiasAdd + <Activation>
+//
+// Activation: Relu, Relu6.
+//
+// The int8 GEMM is an Eigen contraction of QInt8 and QUInt8, which uses the
+// MKL-DNN s8u8s32 gemm (VNNI where available) when the custom contraction
+// kernel is enabled, and the Eigen fixed point kernels otherwise.
+//
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_join.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+
+#if defined(TENSORFLOW_USE_CUSTOM_CONTRACTION_KERNEL)
+#include "tensorflow/core/kernels/eigen_contraction_kernel.h"
+#endif
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+// Activations are quantized to 7 bits, so that the pairwise int16 sums of the
+// s8u8 multiply instructions used without VNNI can't saturate.
+constexpr int32 kMaxQuantizedActivation = 127;
+
+enum class Activation { kNone, kRelu, kRelu6 };
+
+// The quantization of one row of `a`: real = scale * (quantized - zero_point).
+struct RowQuantization {
+  float scale;
+  int32 zero_point;
+};
+
+// Chooses the quantization of values in [min_value, max_value], which always
+// represents 0 exactly.
+RowQuantization ChooseRowQuantization(float min_value, float max_value) {
+  min_value = std::min(min_value, 0.0f);
+  max_value = std::max(max_value, 0.0f);
+  if (min_value == max_value) {
+    return {1.0f, 0};
+  }
+  const float scale = (max_value - min_value) / kMaxQuantizedActivation;
+  const int32 zero_point = std::min(
+      kMaxQuantizedActivation,
+      std::max(0, static_cast<int32>(std::round(-min_value / scale))));
+  return {scale, zero_point};
+}
+
+}  // namespace
+
+class DynamicRangeQuantizedMatMulOp : public OpKernel {
+ public:
+  explicit DynamicRangeQuantizedMatMulOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_a", &transpose_a_));
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_b", &transpose_b_));
+
+    std::vector<string> fused_ops;
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops));
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+    if (fused_ops.empty()) {
+      has_bias_ = false;
+    } else if (fused_ops == std::vector<string>({"BiasAdd"})) {
+      has_bias_ = true;
+    } else if (fused_ops == std::vector<string>({"BiasAdd", "Relu"})) {
+      has_bias_ = true;
+      activation_ = Activation::kRelu;
+    } else if (fused_ops == std::vector<string>({"BiasAdd", "Relu6"})) {
+      has_bias_ = true;
+      activation_ = Activation::kRelu6;
+    } else {
+      OP_REQUIRES(context, false,
+                  errors::Unimplemented("Fusion is not implemented: [",
+                                        absl::StrJoin(fused_ops, ","), "]"));
+    }
+    OP_REQUIRES(
+        context, num_args == (has_bias_ ? 1 : 0),
+        errors::InvalidArgument("Fused DynamicRangeQuantizedMatMul with [",
+                                absl::StrJoin(fused_ops, ","), "] must have ",
+                                has_bias_ ? 1 : 0, " extra arguments, got ",
+                                num_args));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& a = ctx->input(0);
+    const Tensor& b = ctx->input(1);
+    const Tensor& b_scales = ctx->input(2);
+
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::IsMatrix(a.shape()),
+        errors::InvalidArgument("In[0] is not a matrix. Instead it has shape ",
+                                a.shape().DebugString()));
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::IsMatrix(b.shape()),
+        errors::InvalidArgument("In[1] is not a matrix. Instead it has shape ",
+                                b.shape().DebugString()));
+    Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1> dim_pair;
+    // The product is computed transposed, as b^T * a^T, since the Eigen
+    // kernels multiply a signed left-hand side with an unsigned right-hand
+    // side.
+    dim_pair[0].first = transpose_b_ ? 1 : 0;
+    dim_pair[0].second = transpose_a_ ? 0 : 1;
+    const int64_t m = a.dim_size(transpose_a_ ? 1 : 0);
+    const int64_t k = a.dim_size(transpose_a_ ? 0 : 1);
+    const int64_t n = b.dim_size(transpose_b_ ? 0 : 1);
+    OP_REQUIRES(ctx, k == b.dim_size(dim_pair[0].first),
+                errors::InvalidArgument(
+                    "Matrix size-incompatible: In[0]: ", a.shape().DebugString(),
+                    ", In[1]: ", b.shape().DebugString()));
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsScalar(b_scales.shape()) ||
+                    (TensorShapeUtils::IsVector(b_scales.shape()) &&
+                     b_scales.NumElements() == n),
+                errors::InvalidArgument(
+                    "b_scales must be a scalar or have ", n,
+                    " elements, got shape ", b_scales.shape().DebugString()));
+    const float* bias = nullptr;
+    if (has_bias_) {
+      const Tensor& bias_tensor = ctx->input(3);
+      OP_REQUIRES(ctx,
+                  TensorShapeUtils::IsVector(bias_tensor.shape()) &&
+                      bias_tensor.NumElements() == n,
+                  errors::InvalidArgument(
+                      "bias must have shape [", n, "], got ",
+                      bias_tensor.shape().DebugString()));
+      bias = bias_tensor.flat<float>().data();
+    }
+
+    Tensor* out = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({m, n}), &out));
+    if (out->NumElements() == 0) {
+      return;
+    }
+
+    const CPUDevice& d = ctx->eigen_device<CPUDevice>();
+    auto a_matrix = a.matrix<float>();
+    auto b_matrix = b.matrix<qint8>();
+    // Element (i, j) of the logical, untransposed `a`.
+    auto a_at = [&](int64_t i, int64_t j) {
+      return transpose_a_ ? a_matrix(j, i) : a_matrix(i, j);
+    };
+
+    // Quantize each row of `a` with its own range.
+    Tensor a_quantized;
+    OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_QUINT8, a.shape(), &a_quantized));
+    auto a_quantized_matrix = a_quantized.matrix<quint8>();
+    std::vector<RowQuantization> rows(m);
+    auto quantize_rows = [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        float min_value = 0.0f;
+        float max_value = 0.0f;
+        for (int64_t j = 0; j < k; ++j) {
+          min_value = std::min(min_value, a_at(i, j));
+          max_value = std::max(max_value, a_at(i, j));
+        }
+        rows[i] = ChooseRowQuantization(min_value, max_value);
+        const float inverse_scale = 1.0f / rows[i].scale;
+        for (int64_t j = 0; j < k; ++j) {
+          const int32 q = static_cast<int32>(std::round(a_at(i, j) *
+                                                        inverse_scale)) +
+                          rows[i].zero_point;
+          const quint8 quantized(static_cast<uint8>(
+              std::min(kMaxQuantizedActivation, std::max(0, q))));
+          if (transpose_a_) {
+            a_quantized_matrix(j, i) = quantized;
+          } else {
+            a_quantized_matrix(i, j) = quantized;
+          }
+        }
+      }
+    };
+    d.parallelFor(m, Eigen::TensorOpCost(2 * k * sizeof(float), k, 8 * k),
+                  quantize_rows);
+
+    // The int32 products, transposed to [n, m].
+    Tensor accumulators;
+    OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_QINT32, TensorShape({n, m}),
+                                           &accumulators));
+    auto accumulators_matrix = accumulators.matrix<qint32>();
+    if (k == 0) {
+      accumulators.flat<qint32>().setZero();
+    } else {
+      accumulators_matrix.device(d) =
+          b_matrix.contract(a_quantized_matrix, dim_pair);
+    }
+
+    // (q - zero_point) * w sums to the accumulator minus zero_point times the
+    // sum of the weights of the output channel, which is only needed if some
+    // row of `a` has negative values.
+    const bool has_zero_points =
+        std::any_of(rows.begin(), rows.end(),
+                    [](const RowQuantization& row) {
+                      return row.zero_point != 0;
+                    });
+    std::vector<int32> b_sums(has_zero_points ? n : 0, 0);
+    if (has_zero_points) {
+      auto sum_columns = [&](int64_t begin, int64_t end) {
+        if (transpose_b_) {
+          for (int64_t c = begin; c < end; ++c) {
+            int32 sum = 0;
+            for (int64_t j = 0; j < k; ++j) sum += b_matrix(c, j).value;
+            b_sums[c] = sum;
+          }
+        } else {
+          for (int64_t j = 0; j < k; ++j) {
+            for (int64_t c = begin; c < end; ++c) {
+              b_sums[c] += b_matrix(j, c).value;
+            }
+          }
+        }
+      };
+      d.parallelFor(n, Eigen::TensorOpCost(k, sizeof(int32), k), sum_columns);
+    }
+
+    const float* scales = b_scales.flat<float>().data();
+    const bool per_channel = TensorShapeUtils::IsVector(b_scales.shape());
+    auto out_matrix = out->matrix<float>();
+    auto dequantize_rows = [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        const RowQuantization& row = rows[i];
+        for (int64_t c = 0; c < n; ++c) {
+          int32 accumulator = accumulators_matrix(c, i).value;
+          if (has_zero_points) accumulator -= row.zero_point * b_sums[c];
+          float value = static_cast<float>(accumulator) * row.scale *
+                        scales[per_channel ? c : 0];
+          if (bias != nullptr) value += bias[c];
+          if (activation_ == Activation::kRelu) {
+            value = std::max(value, 0.0f);
+          } else if (activation_ == Activation::kRelu6) {
+            value = std::min(std::max(value, 0.0f), 6.0f);
+          }
+          out_matrix(i, c) = value;
+        }
+      }
+    };
+    d.parallelFor(m,
+                  Eigen::TensorOpCost(n * (sizeof(int32) + sizeof(float)),
+                                      n * sizeof(float), 6 * n),
+                  dequantize_rows);
+  }
+
+ private:
+  bool transpose_a_;
+  bool transpose_b_;
+  bool has_bias_ = false;
+  Activation activation_ = Activation::kNone;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DynamicRangeQuantizedMatMulOp);
+};
+
+REGISTER_KERNEL_BUILDER(
+    Name("_DynamicRangeQuantizedMatMul").Device(DEVICE_CPU),
+    DynamicRangeQuantizedMatMulOp);
+
+}  // namespace tensorflow
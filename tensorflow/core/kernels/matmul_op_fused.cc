@@ -16,9 +16,10 @@ limitations under the License.
 // Implements matmul operations with other kernels baked into the
 // processing, to optimize latency and memory usage:
 //  - MatMul + BiasAdd + <Activation>
+//  - MatMul + BiasAdd + Add + <Activation>
 //  - MatMul + FusedBatchNorm + <Activation>
 //
-// Activation: Relu, Relu6, Elu, etc...
+// Activation: Relu, Relu6, Elu, Tanh, Sigmoid, Gelu, etc...
 //
 // Currently supported only on CPU device.
 
@@ -84,39 +85,28 @@ struct LaunchFusedMatMulOp<CPUDevice, T> {
       out.device(d) = lhs.contract(rhs, dim_pair, output_kernel_wrapper);
     };
 
-    BiasAddArgs<T> bias_add_args;
-    if (BiasAddArgs<T>::IsSupported(fusion)) {
-      if (fusion == FusedComputationType::kBiasAddWithLeakyRelu) {
-        OP_REQUIRES_OK(context, InitBiasAddArgs(context, &bias_add_args,
-                                                &fusion_args.leakyrelu_alpha));
-      } else {
-        OP_REQUIRES_OK(context, InitBiasAddArgs(context, &bias_add_args));
-      }
+    if (fusion == FusedComputationType::kUndefined) {
+      OP_REQUIRES_OK(context, errors::Internal("Fusion type is undefined"));
     }
+    OP_REQUIRES(context, BiasAddArgs<T>::IsSupported(fusion),
+                errors::Internal("Fusion type is not supported"));
 
-    switch (fusion) {
-      case FusedComputationType::kBiasAdd:
-        executeWithOutputKernel(WithBiasAdd<T>(bias_add_args));
-        break;
-      case FusedComputationType::kBiasAddWithRelu:
-        executeWithOutputKernel(WithBiasAddAndRelu<T>(bias_add_args));
-        break;
-      case FusedComputationType::kBiasAddWithRelu6:
-        executeWithOutputKernel(WithBiasAddAndRelu6<T>(bias_add_args));
-        break;
-      case FusedComputationType::kBiasAddWithElu:
-        executeWithOutputKernel(WithBiasAddAndElu<T>(bias_add_args));
-        break;
-      case FusedComputationType::kBiasAddWithLeakyRelu:
-        executeWithOutputKernel(WithBiasAddAndLeakyRelu<T>(bias_add_args));
-        break;
-      case FusedComputationType::kUndefined:
-        OP_REQUIRES_OK(context, errors::Internal("Fusion type is undefined"));
-        break;
-      default:
-        OP_REQUIRES_OK(context,
-                       errors::Internal("Fusion type is not supported"));
+    BiasAddArgs<T> bias_add_args;
+    if (fusion == FusedComputationType::kBiasAddWithLeakyRelu ||
+        fusion == FusedComputationType::kBiasAddWithAddAndLeakyRelu) {
+      OP_REQUIRES_OK(context, InitBiasAddArgs(context, &bias_add_args,
+                                              &fusion_args.leakyrelu_alpha));
+    } else {
+      OP_REQUIRES_OK(context, InitBiasAddArgs(context, &bias_add_args));
     }
+    if (HasResidualAdd(fusion)) {
+      OP_REQUIRES_OK(context,
+                     InitResidualAddArgs(context, *output, &bias_add_args));
+    }
+
+    OP_REQUIRES_OK(context,
+                   LaunchWithBiasAddOutputKernel(fusion, bias_add_args,
+                                                 executeWithOutputKernel));
   }
 
  private:
@@ -162,6 +152,17 @@ class FusedMatMulOp : public OpKernel {
           {FCT::kBiasAddWithRelu6, {"BiasAdd", "Relu6"}},
           {FCT::kBiasAddWithElu, {"BiasAdd", "Elu"}},
           {FCT::kBiasAddWithLeakyRelu, {"BiasAdd", "LeakyRelu"}},
+          {FCT::kBiasAddWithTanh, {"BiasAdd", "Tanh"}},
+          {FCT::kBiasAddWithSigmoid, {"BiasAdd", "Sigmoid"}},
+          {FCT::kBiasAddWithGeluApproximate, {"BiasAdd", "GeluApproximate"}},
+          {FCT::kBiasAddWithGeluExact, {"BiasAdd", "GeluExact"}},
+          {FCT::kBiasAddWithAdd, {"BiasAdd", "Add"}},
+          {FCT::kBiasAddWithAddAndRelu, {"BiasAdd", "Add", "Relu"}},
+          {FCT::kBiasAddWithAddAndRelu6, {"BiasAdd", "Add", "Relu6"}},
+          {FCT::kBiasAddWithAddAndElu, {"BiasAdd", "Add", "Elu"}},
+          {FCT::kBiasAddWithAddAndLeakyRelu, {"BiasAdd", "Add", "LeakyRelu"}},
+          {FCT::kBiasAddWithAddAndTanh, {"BiasAdd", "Add", "Tanh"}},
+          {FCT::kBiasAddWithAddAndSigmoid, {"BiasAdd", "Add", "Sigmoid"}},
       };
     }
 
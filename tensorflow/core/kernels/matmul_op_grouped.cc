@@ -0,0 +1,227 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Implements _GroupedMatMul, which computes several independent MatMuls in one
+// op. The op is created by the remapper from sibling MatMuls on GPU, where the
+// products of the same shape are computed by a single batched GEMM launch.
+//
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <map>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/kernels/matmul_op_impl.h"
+
+namespace tensorflow {
+
+// Indices of the products that have a non-empty output and a non-empty inner
+// dimension, i.e. that need a matrix multiply.
+using GroupedMatMulProducts = std::vector<int>;
+
+template <typename Device, typename T>
+struct LaunchGroupedMatMul;
+
+template <typename T>
+struct LaunchGroupedMatMul<CPUDevice, T> {
+  static void Launch(OpKernelContext* ctx, const OpInputList& a,
+                     const OpInputList& b, bool transpose_a, bool transpose_b,
+                     const GroupedMatMulProducts& products,
+                     OpOutputList* out) {
+    // Each contraction is multi-threaded on its own, so there is nothing to
+    // gain from grouping on CPU.
+    Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1> dim_pair;
+    dim_pair[0].first = transpose_a ? 0 : 1;
+    dim_pair[0].second = transpose_b ? 1 : 0;
+    const CPUDevice& d = ctx->eigen_device<CPUDevice>();
+    for (int i : products) {
+      (*out)[i]->matrix<T>().device(d) =
+          a[i].matrix<T>().contract(b[i].matrix<T>(), dim_pair);
+    }
+  }
+};
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+template <typename T>
+struct LaunchGroupedMatMul<GPUDevice, T> {
+  static void Launch(OpKernelContext* ctx, const OpInputList& a,
+                     const OpInputList& b, bool transpose_a, bool transpose_b,
+                     const GroupedMatMulProducts& products,
+                     OpOutputList* out) {
+    auto* stream = ctx->op_device_context()->stream();
+    OP_REQUIRES(ctx, stream, errors::Internal("No GPU stream available."));
+
+    // Products of the same shape go into the same batched GEMM.
+    std::map<std::tuple<uint64, uint64, uint64>, std::vector<int>> groups;
+    for (int i : products) {
+      const uint64 m = (*out)[i]->dim_size(0);
+      const uint64 n = (*out)[i]->dim_size(1);
+      const uint64 k = a[i].dim_size(transpose_a ? 0 : 1);
+      groups[std::make_tuple(m, n, k)].push_back(i);
+    }
+
+    const se::blas::Transpose blas_transpose_a =
+        transpose_a ? se::blas::Transpose::kTranspose
+                    : se::blas::Transpose::kNoTranspose;
+    const se::blas::Transpose blas_transpose_b =
+        transpose_b ? se::blas::Transpose::kTranspose
+                    : se::blas::Transpose::kNoTranspose;
+    using Coefficient =
+        typename std::conditional<std::is_same<T, Eigen::half>::value, float,
+                                  T>::type;
+
+    for (const auto& group : groups) {
+      uint64 m, n, k;
+      std::tie(m, n, k) = group.first;
+      const std::vector<int>& indices = group.second;
+      const int lda = transpose_a ? m : k;
+      const int ldb = transpose_b ? k : n;
+
+      std::vector<se::DeviceMemory<T>> a_device_memory;
+      std::vector<se::DeviceMemory<T>> b_device_memory;
+      std::vector<se::DeviceMemory<T>> c_device_memory;
+      a_device_memory.reserve(indices.size());
+      b_device_memory.reserve(indices.size());
+      c_device_memory.reserve(indices.size());
+      std::vector<se::DeviceMemory<T>*> a_ptrs;
+      std::vector<se::DeviceMemory<T>*> b_ptrs;
+      std::vector<se::DeviceMemory<T>*> c_ptrs;
+      for (int i : indices) {
+        a_device_memory.push_back(AsDeviceMemory(a[i].flat<T>().data()));
+        b_device_memory.push_back(AsDeviceMemory(b[i].flat<T>().data()));
+        c_device_memory.push_back(AsDeviceMemory((*out)[i]->flat<T>().data()));
+        a_ptrs.push_back(&a_device_memory.back());
+        b_ptrs.push_back(&b_device_memory.back());
+        c_ptrs.push_back(&c_device_memory.back());
+      }
+
+      // Blas does C = A x B in column major, so we compute C' = B' x A' to
+      // get the row-major output (see LaunchBatchMatMul).
+      if (indices.size() == 1) {
+        OP_REQUIRES_OK(ctx,
+                       stream->ThenBlasGemm(blas_transpose_b, blas_transpose_a,
+                                            n, m, k, *b_ptrs[0], ldb,
+                                            *a_ptrs[0], lda, c_ptrs[0], n));
+        continue;
+      }
+      BlasScratchAllocator scratch_allocator(ctx);
+      bool blas_launch_status =
+          stream
+              ->ThenBlasGemmBatchedWithScratch(
+                  blas_transpose_b, blas_transpose_a, n, m, k,
+                  static_cast<Coefficient>(1.0), b_ptrs, ldb, a_ptrs, lda,
+                  static_cast<Coefficient>(0.0), c_ptrs, n, indices.size(),
+                  &scratch_allocator)
+              .ok();
+      OP_REQUIRES(ctx, blas_launch_status,
+                  errors::Internal("Blas xGEMMBatched launch failed : m=", m,
+                                   ", n=", n, ", k=", k,
+                                   ", batch_size=", indices.size()));
+    }
+  }
+};
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+template <typename Device, typename T>
+class GroupedMatMulOp : public OpKernel {
+ public:
+  explicit GroupedMatMulOp(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_a", &transpose_a_));
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_b", &transpose_b_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    OpInputList a;
+    OpInputList b;
+    OP_REQUIRES_OK(ctx, ctx->input_list("a", &a));
+    OP_REQUIRES_OK(ctx, ctx->input_list("b", &b));
+    OpOutputList out;
+    OP_REQUIRES_OK(ctx, ctx->output_list("product", &out));
+
+    GroupedMatMulProducts products;
+    for (int i = 0; i < a.size(); ++i) {
+      OP_REQUIRES(ctx, TensorShapeUtils::IsMatrix(a[i].shape()),
+                  errors::InvalidArgument("In[0] of product ", i,
+                                          " is not a matrix: ",
+                                          a[i].shape().DebugString()));
+      OP_REQUIRES(ctx, TensorShapeUtils::IsMatrix(b[i].shape()),
+                  errors::InvalidArgument("In[1] of product ", i,
+                                          " is not a matrix: ",
+                                          b[i].shape().DebugString()));
+      const int64_t m = a[i].dim_size(transpose_a_ ? 1 : 0);
+      const int64_t k = a[i].dim_size(transpose_a_ ? 0 : 1);
+      const int64_t n = b[i].dim_size(transpose_b_ ? 0 : 1);
+      OP_REQUIRES(ctx, k == b[i].dim_size(transpose_b_ ? 1 : 0),
+                  errors::InvalidArgument(
+                      "Matrix size-incompatible in product ", i,
+                      ": In[0]: ", a[i].shape().DebugString(),
+                      ", In[1]: ", b[i].shape().DebugString()));
+      Tensor* product = nullptr;
+      OP_REQUIRES_OK(ctx, out.allocate(i, TensorShape({m, n}), &product));
+      if (product->NumElements() == 0) continue;
+      if (k == 0) {
+        // If a has shape [x, 0] and b has shape [0, y], the output shape is
+        // [x, y] where x and y are non-zero, so we fill the output with zeros.
+        functor::SetZeroFunctor<Device, T> f;
+        f(ctx->eigen_device<Device>(), product->flat<T>());
+        continue;
+      }
+      products.push_back(i);
+    }
+    if (products.empty()) return;
+
+    LaunchGroupedMatMul<Device, T>::Launch(ctx, a, b, transpose_a_,
+                                           transpose_b_, products, &out);
+  }
+
+ private:
+  bool transpose_a_;
+  bool transpose_b_;
+};
+
+#define REGISTER_CPU(T)                                                  \
+  REGISTER_KERNEL_BUILDER(                                               \
+      Name("_GroupedMatMul").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      GroupedMatMulOp<CPUDevice, T>);
+
+TF_CALL_half(REGISTER_CPU);
+TF_CALL_float(REGISTER_CPU);
+TF_CALL_double(REGISTER_CPU);
+#undef REGISTER_CPU
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#define REGISTER_GPU(T)                                                  \
+  REGISTER_KERNEL_BUILDER(                                               \
+      Name("_GroupedMatMul").Device(DEVICE_GPU).TypeConstraint<T>("T"), \
+      GroupedMatMulOp<GPUDevice, T>);
+
+TF_CALL_half(REGISTER_GPU);
+TF_CALL_float(REGISTER_GPU);
+TF_CALL_double(REGISTER_GPU);
+#undef REGISTER_GPU
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace tensorflow
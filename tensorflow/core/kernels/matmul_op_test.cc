@@ -16,9 +16,13 @@ limitations under the License.
 #include "absl/algorithm/container.h"
 #include "tensorflow/cc/ops/nn_ops_internal.h"
 #include "tensorflow/cc/ops/standard_ops.h"
+#include "absl/strings/match.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/ops_util.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
@@ -342,6 +346,176 @@ using FusedBiasAddDataTypes = ::testing::Types<float>;
 INSTANTIATE_TYPED_TEST_SUITE_P(Test, FusedMatMulWithBiasOpTest,
                                FusedBiasAddDataTypes);
 
+class GroupedMatMulOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(int num_products, bool transpose_a, bool transpose_b) {
+    TF_ASSERT_OK(NodeDefBuilder("grouped_matmul", "_GroupedMatMul")
+                     .Input(FakeInput(num_products, DT_FLOAT))
+                     .Input(FakeInput(num_products, DT_FLOAT))
+                     .Attr("T", DT_FLOAT)
+                     .Attr("transpose_a", transpose_a)
+                     .Attr("transpose_b", transpose_b)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(GroupedMatMulOpTest, ProductsOfDifferentShapes) {
+  MakeOp(3, false, false);
+  // a[0]: [2, 3], a[1]: [1, 2], a[2]: [2, 0].
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({1, 2}), {1, -1});
+  AddInputFromArray<float>(TensorShape({2, 0}), {});
+  // b[0]: [3, 1], b[1]: [2, 2], b[2]: [0, 2].
+  AddInputFromArray<float>(TensorShape({3, 1}), {1, 0, -1});
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({0, 2}), {});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected0(DT_FLOAT, TensorShape({2, 1}));
+  test::FillValues<float>(&expected0, {-2, -2});
+  test::ExpectTensorEqual<float>(expected0, *GetOutput(0));
+  Tensor expected1(DT_FLOAT, TensorShape({1, 2}));
+  test::FillValues<float>(&expected1, {-2, -2});
+  test::ExpectTensorEqual<float>(expected1, *GetOutput(1));
+  Tensor expected2(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected2, {0, 0, 0, 0});
+  test::ExpectTensorEqual<float>(expected2, *GetOutput(2));
+}
+
+TEST_F(GroupedMatMulOpTest, Transposed) {
+  MakeOp(2, true, true);
+  AddInputFromArray<float>(TensorShape({2, 1}), {1, 2});
+  AddInputFromArray<float>(TensorShape({2, 1}), {3, 4});
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 2}), {1, 1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected0(DT_FLOAT, TensorShape({1, 2}));
+  test::FillValues<float>(&expected0, {5, 11});
+  test::ExpectTensorEqual<float>(expected0, *GetOutput(0));
+  Tensor expected1(DT_FLOAT, TensorShape({1, 1}));
+  test::FillValues<float>(&expected1, {7});
+  test::ExpectTensorEqual<float>(expected1, *GetOutput(1));
+}
+
+TEST_F(GroupedMatMulOpTest, IncompatibleShapes) {
+  MakeOp(2, false, false);
+  AddInputFromArray<float>(TensorShape({1, 2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({1, 2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({2, 1}), {1, 2});
+  AddInputFromArray<float>(TensorShape({3, 1}), {1, 2, 3});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  EXPECT_TRUE(absl::StrContains(s.error_message(), "product 1")) << s;
+}
+
+class DynamicRangeQuantizedMatMulOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(bool transpose_a, bool transpose_b,
+                const std::vector<string>& fused_ops) {
+    TF_RETURN_IF_ERROR(
+        NodeDefBuilder("dynamic_range_quantized_matmul",
+                       "_DynamicRangeQuantizedMatMul")
+            .Input(FakeInput(DT_FLOAT))
+            .Input(FakeInput(DT_QINT8))
+            .Input(FakeInput(DT_FLOAT))
+            .Input(FakeInput(fused_ops.empty() ? 0 : 1, DT_FLOAT))
+            .Attr("transpose_a", transpose_a)
+            .Attr("transpose_b", transpose_b)
+            .Attr("fused_ops", fused_ops)
+            .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+// The rows of `a` below have the ranges [0, 127] and [-127, 0], so they are
+// quantized exactly and the products are exact.
+TEST_F(DynamicRangeQuantizedMatMulOpTest, PerChannelScales) {
+  TF_ASSERT_OK(MakeOp(false, false, {}));
+  AddInputFromArray<float>(TensorShape({2, 3}), {0, 64, 127, -127, -1, 0});
+  AddInputFromArray<qint8>(TensorShape({3, 2}), {1, -2, 3, 4, -5, 6});
+  AddInputFromArray<float>(TensorShape({2}), {0.5, 0.25});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {-221.5, 254.5, -65, 62.5});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(DynamicRangeQuantizedMatMulOpTest, TransposedWithScalarScale) {
+  TF_ASSERT_OK(MakeOp(true, true, {}));
+  AddInputFromArray<float>(TensorShape({3, 2}), {0, -127, 64, -1, 127, 0});
+  AddInputFromArray<qint8>(TensorShape({2, 3}), {1, 3, -5, -2, 4, 6});
+  AddInputFromArray<float>(TensorShape({}), {0.5});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {-221.5, 509, -65, 125});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(DynamicRangeQuantizedMatMulOpTest, WithBiasAndRelu) {
+  TF_ASSERT_OK(MakeOp(false, false, {"BiasAdd", "Relu"}));
+  AddInputFromArray<float>(TensorShape({2, 3}), {0, 64, 127, -127, -1, 0});
+  AddInputFromArray<qint8>(TensorShape({3, 2}), {1, -2, 3, 4, -5, 6});
+  AddInputFromArray<float>(TensorShape({2}), {0.5, 0.25});
+  AddInputFromArray<float>(TensorShape({2}), {1, -100});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {0, 154.5, 0, 0});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(DynamicRangeQuantizedMatMulOpTest, CloseToFloatMatMul) {
+  const int m = 4, k = 64, n = 8;
+  TF_ASSERT_OK(MakeOp(false, false, {}));
+  std::vector<float> a(m * k);
+  for (int i = 0; i < m * k; ++i) {
+    a[i] = (i * 7919 % 1000) / 250.0f - 1.0f;
+  }
+  std::vector<qint8> b(k * n);
+  for (int i = 0; i < k * n; ++i) {
+    b[i] = static_cast<int8>(i * 37 % 255 - 127);
+  }
+  AddInputFromArray<float>(TensorShape({m, k}), a);
+  AddInputFromArray<qint8>(TensorShape({k, n}), b);
+  AddInputFromArray<float>(TensorShape({}), {0.01});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Each activation is off by at most one quantization step, which is 4/127
+  // for the range [-1, 3) of `a`.
+  const auto out = GetOutput(0)->matrix<float>();
+  for (int i = 0; i < m; ++i) {
+    for (int c = 0; c < n; ++c) {
+      float expected = 0;
+      float tolerance = 0;
+      for (int j = 0; j < k; ++j) {
+        const float weight = b[j * n + c].value * 0.01f;
+        expected += a[i * k + j] * weight;
+        tolerance += std::abs(weight) * 4 / 127;
+      }
+      EXPECT_NEAR(expected, out(i, c), tolerance + 1e-4);
+    }
+  }
+}
+
+TEST_F(DynamicRangeQuantizedMatMulOpTest, UnsupportedFusion) {
+  Status s = MakeOp(false, false, {"BiasAdd", "Elu"});
+  EXPECT_TRUE(errors::IsUnimplemented(s)) << s;
+}
+
+TEST_F(DynamicRangeQuantizedMatMulOpTest, IncompatibleScales) {
+  TF_ASSERT_OK(MakeOp(false, false, {}));
+  AddInputFromArray<float>(TensorShape({1, 2}), {1, 2});
+  AddInputFromArray<qint8>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({3}), {1, 1, 1});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  EXPECT_TRUE(absl::StrContains(s.error_message(), "b_scales")) << s;
+}
+
 //----------------------------------------------------------------------------//
 // Performance benchmarks are below.                                          //
 //----------------------------------------------------------------------------//
@@ -72,6 +72,32 @@ struct FillPhiloxRandom {
   }
 };
 
+// Returns the groups of a PhiloxRandom in the same order, generating
+// `kBatchGroups` of them at a time with its vectorized GenerateMany().
+class BatchedPhiloxRandom {
+ public:
+  typedef PhiloxRandom::ResultType ResultType;
+  typedef PhiloxRandom::ResultElementType ResultElementType;
+  static constexpr int kResultElementCount = PhiloxRandom::kResultElementCount;
+  static constexpr int kElementCost = PhiloxRandom::kElementCost;
+  static constexpr int kBatchGroups = 16;
+
+  explicit BatchedPhiloxRandom(PhiloxRandom* gen) : gen_(gen) {}
+
+  ResultType operator()() {
+    if (next_ == kBatchGroups) {
+      gen_->GenerateMany<kBatchGroups>(groups_);
+      next_ = 0;
+    }
+    return groups_[next_++];
+  }
+
+ private:
+  PhiloxRandom* gen_;
+  ResultType groups_[kBatchGroups];
+  int next_ = kBatchGroups;
+};
+
 // A class to fill a specified range of random groups
 template <class Distribution, bool VariableSamplesPerOutput>
 struct FillPhiloxRandomTask;
@@ -87,11 +113,14 @@ struct FillPhiloxRandomTask<Distribution, false> {
 
     gen.Skip(start_group);
     int64_t offset = start_group * kGroupSize;
+    // Each output group takes one group of the generator, so the batched
+    // generator returns the same samples.
+    BatchedPhiloxRandom batched_gen(&gen);
 
     // First fill all the full-size groups
     int64_t limit_group_full = std::min(limit_group, size / kGroupSize);
     for (int64_t index = start_group; index < limit_group_full; ++index) {
-      auto samples = dist(&gen);
+      auto samples = dist(&batched_gen);
       std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
       offset += kGroupSize;
     }
@@ -99,7 +128,7 @@ struct FillPhiloxRandomTask<Distribution, false> {
     // If there are any remaining elements that need to be filled, process them
     if (limit_group_full < limit_group) {
       int64_t remaining_size = size - limit_group_full * kGroupSize;
-      auto samples = dist(&gen);
+      auto samples = dist(&batched_gen);
       std::copy(&samples[0], &samples[0] + remaining_size, data + offset);
     }
   }
@@ -156,14 +185,12 @@ struct FillPhiloxRandomTask<Distribution, true> {
 // It splits the work into several tasks and run them in parallel
 template <class Distribution>
 void FillPhiloxRandom<CPUDevice, Distribution>::operator()(
-    OpKernelContext* ctx, const CPUDevice&, const uint64* key,
+    OpKernelContext* ctx, const CPUDevice& d, const uint64* key,
     const uint64* counter, random::PhiloxRandom gen,
     typename Distribution::ResultElementType* data, int64_t size,
     Distribution dist) {
   const int kGroupSize = Distribution::kResultElementCount;
 
-  auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
-
   int64_t total_group_count = (size + kGroupSize - 1) / kGroupSize;
 
   const int kGroupCost =
@@ -174,15 +201,29 @@ void FillPhiloxRandom<CPUDevice, Distribution>::operator()(
     gen = GetPhiloxRandomFromCounterKeyMem(counter, key);
   }
 
-  Shard(worker_threads.num_threads, worker_threads.workers, total_group_count,
-        kGroupCost,
-        [&gen, data, size, dist](int64_t start_group, int64_t limit_group) {
-          FillPhiloxRandomTask<
-              Distribution,
-              Distribution::kVariableSamplesPerOutput>::Run(gen, data, size,
-                                                            start_group,
-                                                            limit_group, dist);
-        });
+  // The cost accounts for the bytes written as well as the cycles, so that
+  // large outputs are split into blocks that balance across the threads.
+  // Blocks of fixed-sample distributions start at a multiple of the batch of
+  // BatchedPhiloxRandom, so that none of its groups are generated twice.
+  const Eigen::TensorOpCost cost(
+      0, kGroupSize * sizeof(typename Distribution::ResultElementType),
+      kGroupCost);
+  const int64_t block_align = Distribution::kVariableSamplesPerOutput
+                                  ? 1
+                                  : BatchedPhiloxRandom::kBatchGroups;
+  d.parallelFor(
+      total_group_count, cost,
+      [block_align](Eigen::Index block_size) {
+        return (block_size + block_align - 1) / block_align * block_align;
+      },
+      [&gen, data, size, dist](Eigen::Index start_group,
+                               Eigen::Index limit_group) {
+        FillPhiloxRandomTask<
+            Distribution,
+            Distribution::kVariableSamplesPerOutput>::Run(gen, data, size,
+                                                          start_group,
+                                                          limit_group, dist);
+      });
 }
 
 }  // namespace functor
@@ -289,6 +289,9 @@ struct RestoreOp {
       status = reader.status();
       return;
     }
+    if (context->memmap_restored_tensors()) {
+      reader.set_memmap_large_tensors(true);
+    }
 
     status = run(&reader);
   }
@@ -379,6 +382,9 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
 
   BundleReader default_reader(Env::Default(), prefix_string);
   TF_RETURN_IF_ERROR(default_reader.status());
+  if (context->memmap_restored_tensors()) {
+    default_reader.set_memmap_large_tensors(true);
+  }
 
   TF_RETURN_IF_ERROR(default_reader.SortForSequentialAccess<RestoreOp>(
       restore_ops, [](const RestoreOp& op) { return op.tensor_name; }));
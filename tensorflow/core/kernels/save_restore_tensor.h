@@ -57,7 +57,8 @@ void RestoreTensor(OpKernelContext* context,
 
 // Invokes the V2 checkpoint read path to read tensors.
 //
-// "context" is only used for allocating outputs.  In particular, the inputs are
+// "context" is only used for allocating outputs and for
+// OpKernelContext::memmap_restored_tensors().  In particular, the inputs are
 // explicitly provided and not accessed via the "input(i)" methods.
 // REQUIRES:
 //   * "prefix" has 1 element, DT_STRING.
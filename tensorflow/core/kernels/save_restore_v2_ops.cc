@@ -108,7 +108,11 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
+    // Aligns large tensors so that RestoreV2 can memory-map them (see
+    // RunOptions.Experimental.memmap_restored_tensors).
+    BundleWriter::Options writer_options;
+    writer_options.large_tensor_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(Env::Default(), prefix_string, writer_options);
     OP_REQUIRES_OK(context, writer.status());
     VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
 
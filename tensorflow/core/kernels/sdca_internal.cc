@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sdca_internal.h"
 
+#include <algorithm>
 #include <limits>
 #include <numeric>
 #include <random>
@@ -76,6 +77,38 @@ void FeatureWeightsSparseStorage::UpdateSparseDeltaWeights(
   }
 }
 
+DeltaBuffer::DeltaBuffer(const ModelWeights& model_weights)
+    : sparse_deltas_(model_weights.sparse_weights().size()) {
+  dense_deltas_.reserve(model_weights.dense_weights().size());
+  for (const FeatureWeightsDenseStorage& dense_weights :
+       model_weights.dense_weights()) {
+    dense_deltas_.emplace_back(dense_weights.deltas().dimension(0),
+                               dense_weights.deltas().dimension(1));
+    dense_deltas_.back().setZero();
+  }
+}
+
+void DeltaBuffer::AddDeltaWeights(const Example& example,
+                                  const double normalized_bounded_dual_delta) {
+  for (size_t j = 0; j < sparse_deltas_.size(); ++j) {
+    const Example::SparseFeatures& sparse_features =
+        example.sparse_features_[j];
+    for (int64_t k = 0; k < sparse_features.indices->size(); ++k) {
+      const double feature_value = sparse_features.values == nullptr
+                                       ? 1.0
+                                       : (*sparse_features.values)(k);
+      sparse_deltas_[j][(*sparse_features.indices)(k)] +=
+          feature_value * normalized_bounded_dual_delta;
+    }
+  }
+  for (size_t j = 0; j < dense_deltas_.size(); ++j) {
+    dense_deltas_[j] +=
+        example.dense_vectors_[j]->RowAsMatrix() *
+        dense_deltas_[j].constant(normalized_bounded_dual_delta);
+  }
+  ++num_examples_;
+}
+
 void ModelWeights::UpdateDeltaWeights(
     const Eigen::ThreadPoolDevice& device, const Example& example,
     const std::vector<double>& normalized_bounded_dual_delta) {
@@ -92,6 +125,33 @@ void ModelWeights::UpdateDeltaWeights(
   }
 }
 
+void ModelWeights::MergeDeltaBuffer(const int first_group,
+                                    DeltaBuffer* const delta_buffer) {
+  const int num_sparse_groups = sparse_weights_.size();
+  const int num_groups = num_sparse_groups + dense_weights_.size();
+  for (int i = 0; i < num_groups; ++i) {
+    const int group = (first_group + i) % num_groups;
+    if (group < num_sparse_groups) {
+      auto& sparse_deltas = delta_buffer->sparse_deltas_[group];
+      if (sparse_deltas.empty()) continue;
+      mutex_lock l(group_mutexes_[group]);
+      for (const auto& index_and_delta : sparse_deltas) {
+        sparse_weights_[group].AddDelta(0, index_and_delta.first,
+                                        index_and_delta.second);
+      }
+      sparse_deltas.clear();
+    } else {
+      const int dense_group = group - num_sparse_groups;
+      auto& dense_deltas = delta_buffer->dense_deltas_[dense_group];
+      mutex_lock l(group_mutexes_[group]);
+      auto deltas = dense_weights_[dense_group].deltas();
+      deltas = deltas + dense_deltas;
+      dense_deltas.setZero();
+    }
+  }
+  delta_buffer->num_examples_ = 0;
+}
+
 Status ModelWeights::Initialize(OpKernelContext* const context) {
   OpInputList sparse_indices_inputs;
   TF_RETURN_IF_ERROR(
@@ -159,15 +219,20 @@ Status ModelWeights::Initialize(OpKernelContext* const context) {
         return Status::OK();
       };
 
-  return initialize_weights(dense_weights_inputs, &dense_weights_outputs,
-                            &dense_weights_);
+  TF_RETURN_IF_ERROR(initialize_weights(
+      dense_weights_inputs, &dense_weights_outputs, &dense_weights_));
+  group_mutexes_.reset(
+      new mutex[sparse_weights_.size() + dense_weights_.size()]);
+  return Status::OK();
 }
 
 // Computes the example statistics for given example, and model. Defined here
 // as we need definition of ModelWeights and Regularizations.
 const ExampleStatistics Example::ComputeWxAndWeightedExampleNorm(
     const int num_loss_partitions, const ModelWeights& model_weights,
-    const Regularizations& regularization, const int num_weight_vectors) const {
+    const Regularizations& regularization, const int num_weight_vectors,
+    const DeltaBuffer* const delta_buffer) const {
+  DCHECK(delta_buffer == nullptr || num_weight_vectors == 1);
   ExampleStatistics result(num_weight_vectors);
 
   result.normalized_squared_norm =
@@ -187,9 +252,12 @@ const ExampleStatistics Example::ComputeWxAndWeightedExampleNorm(
                                        : (*sparse_features.values)(k);
       for (int l = 0; l < num_weight_vectors; ++l) {
         const float sparse_weight = sparse_weights.nominals(l, feature_index);
+        float sparse_delta = sparse_weights.deltas(l, feature_index);
+        if (delta_buffer != nullptr) {
+          sparse_delta += delta_buffer->sparse_delta(j, feature_index);
+        }
         const double feature_weight =
-            sparse_weight +
-            sparse_weights.deltas(l, feature_index) * num_loss_partitions;
+            sparse_weight + sparse_delta * num_loss_partitions;
         result.prev_wx[l] +=
             feature_value * regularization.Shrink(sparse_weight);
         result.wx[l] += feature_value * regularization.Shrink(feature_weight);
@@ -204,10 +272,18 @@ const ExampleStatistics Example::ComputeWxAndWeightedExampleNorm(
     const FeatureWeightsDenseStorage& dense_weights =
         model_weights.dense_weights()[j];
 
-    const Eigen::Tensor<float, 2, Eigen::RowMajor> feature_weights =
-        dense_weights.nominals() +
-        dense_weights.deltas() *
-            dense_weights.deltas().constant(num_loss_partitions);
+    Eigen::Tensor<float, 2, Eigen::RowMajor> feature_weights;
+    if (delta_buffer == nullptr) {
+      feature_weights =
+          dense_weights.nominals() +
+          dense_weights.deltas() *
+              dense_weights.deltas().constant(num_loss_partitions);
+    } else {
+      feature_weights =
+          dense_weights.nominals() +
+          (dense_weights.deltas() + delta_buffer->dense_deltas(j)) *
+              dense_weights.deltas().constant(num_loss_partitions);
+    }
     if (num_weight_vectors == 1) {
       const Eigen::Tensor<float, 0, Eigen::RowMajor> prev_prediction =
           (dense_vector.Row() *
@@ -330,6 +406,50 @@ void Examples::RandomShuffle() {
   std::shuffle(sampled_index_.begin(), sampled_index_.end(), rng);
 }
 
+void Examples::PartitionByFeatureLocality(
+    const DeviceBase::CpuWorkerThreads& worker_threads,
+    const ModelWeights& model_weights, const int num_partitions) {
+  const std::vector<FeatureWeightsSparseStorage>& sparse_weights =
+      model_weights.sparse_weights();
+  int group = -1;
+  for (size_t j = 0; j < sparse_weights.size(); ++j) {
+    if (group < 0 ||
+        sparse_weights[j].num_weights() > sparse_weights[group].num_weights()) {
+      group = j;
+    }
+  }
+  if (group >= 0) {
+    // Examples without features in the group go last.
+    std::vector<int64_t> keys(num_examples(),
+                              std::numeric_limits<int64_t>::max());
+    auto compute_keys = [&](const int64_t begin, const int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        const UnalignedInt64Vector& indices =
+            *examples_[i].sparse_features_[group].indices;
+        for (int64_t k = 0; k < indices.size(); ++k) {
+          keys[i] = std::min(keys[i], sparse_weights[group].id(indices(k)));
+        }
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, num_examples(),
+          /*cost_per_unit=*/100, compute_keys);
+    std::stable_sort(sampled_index_.begin(), sampled_index_.end(),
+                     [&keys](const int lhs, const int rhs) {
+                       return keys[lhs] < keys[rhs];
+                     });
+  }
+
+  std::random_device rd;
+  std::mt19937 rng(rd());
+  const int64_t num_sampled = sampled_index_.size();
+  for (int64_t p = 0; p < num_partitions; ++p) {
+    const int64_t begin = num_sampled * p / num_partitions;
+    const int64_t end = num_sampled * (p + 1) / num_partitions;
+    std::shuffle(sampled_index_.begin() + begin, sampled_index_.begin() + end,
+                 rng);
+  }
+}
+
 // TODO(sibyl-Aix6ihai): Refactor/shorten this function.
 Status Examples::Initialize(OpKernelContext* const context,
                             const ModelWeights& weights,
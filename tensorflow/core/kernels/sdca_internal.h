@@ -27,6 +27,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -42,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/random/distribution_sampler.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/guarded_philox_random.h"
 #include "tensorflow/core/util/work_sharder.h"
 
@@ -120,6 +122,7 @@ class Regularizations {
   TF_DISALLOW_COPY_AND_ASSIGN(Regularizations);
 };
 
+class DeltaBuffer;
 class ModelWeights;
 
 // Struct describing a single example.
@@ -130,10 +133,12 @@ class Example {
   // in SDCA update.
   // For multiclass case, num_weight_vectors equals to the number of classes;
   // while for binary case, it is 1.
+  // If |delta_buffer| is not null, the delta weights it holds are added to
+  // those of |model_weights|. It is only supported in the binary case.
   const ExampleStatistics ComputeWxAndWeightedExampleNorm(
       const int num_loss_partitions, const ModelWeights& model_weights,
-      const Regularizations& regularization,
-      const int num_weight_vectors) const;
+      const Regularizations& regularization, const int num_weight_vectors,
+      const DeltaBuffer* delta_buffer = nullptr) const;
 
   float example_label() const { return example_label_; }
 
@@ -186,6 +191,9 @@ class Example {
 
   // ModelWeights use each example for model update w += \alpha * x_{i};
   friend class ModelWeights;
+
+  // DeltaBuffer too, for the buffered updates.
+  friend class DeltaBuffer;
 };
 
 // Weights related to features. For example, say you have two sets of sparse
@@ -257,6 +265,20 @@ class FeatureWeightsSparseStorage {
     return deltas_(class_id, it->second);
   }
 
+  // Adds |delta| to the delta weight of a feature index and class label.
+  void AddDelta(const int class_id, const int64_t index, const float delta) {
+    auto it = indices_to_id_.find(index);
+    deltas_(class_id, it->second) += delta;
+  }
+
+  // Position of the weights of a feature index in the underlying storage.
+  int64_t id(const int64_t index) const {
+    return indices_to_id_.find(index)->second;
+  }
+
+  // Number of features with weights.
+  int64_t num_weights() const { return deltas_.dimension(1); }
+
   // Updates delta weights based on active sparse features in the example and
   // the corresponding dual residual.
   void UpdateSparseDeltaWeights(
@@ -293,6 +315,13 @@ class ModelWeights {
       const Eigen::ThreadPoolDevice& device, const Example& example,
       const std::vector<double>& normalized_bounded_dual_delta);
 
+  // Adds the delta weights held by |delta_buffer| to the delta weights, and
+  // clears it. Each feature group is updated under its own lock, so that
+  // concurrent merges only wait for each other on the same group; they go
+  // through the groups starting with |first_group|, which callers vary to
+  // spread them over the groups.
+  void MergeDeltaBuffer(int first_group, DeltaBuffer* const delta_buffer);
+
   Status Initialize(OpKernelContext* const context);
 
   const std::vector<FeatureWeightsSparseStorage>& sparse_weights() const {
@@ -307,9 +336,54 @@ class ModelWeights {
   std::vector<FeatureWeightsSparseStorage> sparse_weights_;
   std::vector<FeatureWeightsDenseStorage> dense_weights_;
 
+  // One lock per feature group, sparse groups first, for MergeDeltaBuffer().
+  std::unique_ptr<mutex[]> group_mutexes_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ModelWeights);
 };
 
+// The delta weights of the examples trained by one worker, for binary SDCA
+// with buffered updates. The worker adds its updates here instead of to the
+// shared ModelWeights, reads them back when computing wx, and merges them
+// into the ModelWeights every few examples. Features that several of its
+// examples use then cost one write to the shared weights per merge, which
+// keeps the workers from contending for the same cache lines on every
+// example.
+class DeltaBuffer {
+ public:
+  explicit DeltaBuffer(const ModelWeights& model_weights);
+
+  // Adds the updates for |example| and the dual delta to the buffered deltas.
+  void AddDeltaWeights(const Example& example,
+                       const double normalized_bounded_dual_delta);
+
+  // The buffered delta of a feature index of sparse feature group |group|.
+  float sparse_delta(const int group, const int64_t index) const {
+    const auto it = sparse_deltas_[group].find(index);
+    return it == sparse_deltas_[group].end() ? 0.0f : it->second;
+  }
+
+  // The buffered deltas of dense feature group |group|, shaped like its delta
+  // weights.
+  const Eigen::Tensor<float, 2, Eigen::RowMajor>& dense_deltas(
+      const int group) const {
+    return dense_deltas_[group];
+  }
+
+  // Number of examples whose updates were added since the last merge.
+  int num_examples() const { return num_examples_; }
+
+ private:
+  friend class ModelWeights;
+
+  // Buffered deltas by feature index, for each sparse feature group.
+  std::vector<absl::flat_hash_map<int64_t, float>> sparse_deltas_;
+  std::vector<Eigen::Tensor<float, 2, Eigen::RowMajor>> dense_deltas_;
+  int num_examples_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DeltaBuffer);
+};
+
 // Examples contains all the training examples that SDCA uses for a mini-batch.
 class Examples {
  public:
@@ -334,6 +408,16 @@ class Examples {
 
   void RandomShuffle();
 
+  // Reorders the sampled examples for |num_partitions| workers, where worker
+  // p trains the sampled examples [p * n / num_partitions,
+  // (p + 1) * n / num_partitions) out of n. The examples are sorted by the
+  // lowest position of the weights they use in the sparse feature group with
+  // the most weights, so that each partition mostly updates its own range of
+  // these weights, and then shuffled within each partition.
+  void PartitionByFeatureLocality(
+      const DeviceBase::CpuWorkerThreads& worker_threads,
+      const ModelWeights& model_weights, int num_partitions);
+
   int num_examples() const { return examples_.size(); }
 
   int num_features() const { return num_features_; }
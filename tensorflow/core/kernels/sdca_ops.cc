@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <atomic>
 #include <limits>
 #include <memory>
@@ -27,6 +28,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/strings/str_format.h"
+#include "absl/types/optional.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/kernel_def_builder.h"
@@ -52,6 +54,7 @@ limitations under the License.
 #include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/work_sharder.h"
 
@@ -59,6 +62,7 @@ namespace tensorflow {
 
 namespace {
 
+using sdca::DeltaBuffer;
 using sdca::Example;
 using sdca::Examples;
 using sdca::ExampleStatistics;
@@ -112,6 +116,12 @@ struct ComputeOptions {
         context, context->GetAttr("num_loss_partitions", &num_loss_partitions));
     OP_REQUIRES_OK(context, context->GetAttr("num_inner_iterations",
                                              &num_inner_iterations));
+    // SdcaOptimizer does not have this attr, and always updates the shared
+    // delta weights after every example.
+    if (!context->GetAttr("delta_merge_interval", &delta_merge_interval)
+             .ok()) {
+      delta_merge_interval = 0;
+    }
     OP_REQUIRES_OK(context, regularizations.Initialize(context));
   }
 
@@ -121,6 +131,7 @@ struct ComputeOptions {
   int num_dense_features = 0;
   int num_inner_iterations = 0;
   int num_loss_partitions = 0;
+  int delta_merge_interval = 0;
   bool adaptive = true;
   Regularizations regularizations;
 };
@@ -164,69 +175,118 @@ void DoCompute(const ComputeOptions& options, OpKernelContext* const context) {
   } else {
     examples.RandomShuffle();
   }
-  struct {
-    mutex mu;
-    Status value TF_GUARDED_BY(mu);
-  } train_step_status;
-  std::atomic<std::int64_t> atomic_index(-1);
-  auto train_step = [&](const int64_t begin, const int64_t end) {
-    // The static_cast here is safe since begin and end can be at most
-    // num_examples which is an int.
-    for (int id = static_cast<int>(begin); id < end; ++id) {
-      const int64_t example_index = examples.sampled_index(++atomic_index);
-      const Example& example = examples.example(example_index);
-      const float dual = example_state_data(example_index, 0);
-      const float example_weight = example.example_weight();
-      float example_label = example.example_label();
-      const Status conversion_status =
-          options.loss_updater->ConvertLabel(&example_label);
-      if (!conversion_status.ok()) {
-        mutex_lock l(train_step_status.mu);
-        train_step_status.value = conversion_status;
-        // Return from this worker thread - the calling thread is
-        // responsible for checking context status and returning on error.
-        return;
-      }
-
-      // Compute wx, example norm weighted by regularization, dual loss,
-      // primal loss.
-      // For binary SDCA, num_weight_vectors should be one.
-      const ExampleStatistics example_statistics =
-          example.ComputeWxAndWeightedExampleNorm(
-              options.num_loss_partitions, model_weights,
-              options.regularizations, 1 /* num_weight_vectors */);
-
-      const double new_dual = options.loss_updater->ComputeUpdatedDual(
-          options.num_loss_partitions, example_label, example_weight, dual,
-          example_statistics.wx[0], example_statistics.normalized_squared_norm);
-
-      // Compute new weights.
-      const double normalized_bounded_dual_delta =
-          (new_dual - dual) * example_weight /
-          options.regularizations.symmetric_l2();
+  // Trains one example. Its delta weights go to |delta_buffer| if given, and
+  // to the shared delta weights otherwise.
+  auto train_example = [&](const int64_t example_index,
+                           DeltaBuffer* const delta_buffer) -> Status {
+    const Example& example = examples.example(example_index);
+    const float dual = example_state_data(example_index, 0);
+    const float example_weight = example.example_weight();
+    float example_label = example.example_label();
+    TF_RETURN_IF_ERROR(options.loss_updater->ConvertLabel(&example_label));
+
+    // Compute wx, example norm weighted by regularization, dual loss,
+    // primal loss.
+    // For binary SDCA, num_weight_vectors should be one.
+    const ExampleStatistics example_statistics =
+        example.ComputeWxAndWeightedExampleNorm(
+            options.num_loss_partitions, model_weights, options.regularizations,
+            1 /* num_weight_vectors */, delta_buffer);
+
+    const double new_dual = options.loss_updater->ComputeUpdatedDual(
+        options.num_loss_partitions, example_label, example_weight, dual,
+        example_statistics.wx[0], example_statistics.normalized_squared_norm);
+
+    // Compute new weights.
+    const double normalized_bounded_dual_delta =
+        (new_dual - dual) * example_weight /
+        options.regularizations.symmetric_l2();
+    if (delta_buffer != nullptr) {
+      delta_buffer->AddDeltaWeights(example, normalized_bounded_dual_delta);
+    } else {
       model_weights.UpdateDeltaWeights(
           context->eigen_cpu_device(), example,
           std::vector<double>{normalized_bounded_dual_delta});
-
-      // Update example data.
-      example_state_data(example_index, 0) = new_dual;
-      example_state_data(example_index, 1) =
-          options.loss_updater->ComputePrimalLoss(
-              example_statistics.prev_wx[0], example_label, example_weight);
-      example_state_data(example_index, 2) =
-          options.loss_updater->ComputeDualLoss(dual, example_label,
-                                                example_weight);
-      example_state_data(example_index, 3) = example_weight;
     }
+
+    // Update example data.
+    example_state_data(example_index, 0) = new_dual;
+    example_state_data(example_index, 1) =
+        options.loss_updater->ComputePrimalLoss(example_statistics.prev_wx[0],
+                                                example_label, example_weight);
+    example_state_data(example_index, 2) =
+        options.loss_updater->ComputeDualLoss(dual, example_label,
+                                              example_weight);
+    example_state_data(example_index, 3) = example_weight;
+    return Status::OK();
   };
-  // TODO(sibyl-Aix6ihai): Tune this properly based on sparsity of the data,
-  // number of cpus, and cost per example.
-  const int64_t kCostPerUnit = examples.num_features();
+
+  struct {
+    mutex mu;
+    Status value TF_GUARDED_BY(mu);
+  } train_step_status;
   const DeviceBase::CpuWorkerThreads& worker_threads =
       *context->device()->tensorflow_cpu_worker_threads();
-
-  Shard(worker_threads.num_threads, worker_threads.workers,
-        examples.num_examples(), kCostPerUnit, train_step);
+  const int num_partitions =
+      std::min(worker_threads.num_threads, examples.num_examples());
+  if (options.delta_merge_interval > 0 && num_partitions > 1) {
+    // Each thread trains the examples of its own partition, which mostly use
+    // their own weights, and only writes the shared delta weights every
+    // delta_merge_interval examples, rather than contending on every update.
+    examples.PartitionByFeatureLocality(worker_threads, model_weights,
+                                        num_partitions);
+    const int64_t num_examples = examples.num_examples();
+    auto train_partition = [&](const int64_t begin, const int64_t end) {
+      for (int64_t p = begin; p < end; ++p) {
+        DeltaBuffer delta_buffer(model_weights);
+        const int64_t first = num_examples * p / num_partitions;
+        const int64_t last = num_examples * (p + 1) / num_partitions;
+        for (int64_t id = first; id < last; ++id) {
+          const Status s =
+              train_example(examples.sampled_index(id), &delta_buffer);
+          if (!s.ok()) {
+            mutex_lock l(train_step_status.mu);
+            train_step_status.value = s;
+            return;
+          }
+          if (delta_buffer.num_examples() >= options.delta_merge_interval) {
+            // Partitions start merging at different groups, so that they
+            // do not all wait on the same lock.
+            model_weights.MergeDeltaBuffer(p, &delta_buffer);
+          }
+        }
+        model_weights.MergeDeltaBuffer(p, &delta_buffer);
+      }
+    };
+    worker_threads.workers->ParallelFor(
+        num_partitions,
+        thread::ThreadPool::SchedulingParams(
+            thread::ThreadPool::SchedulingStrategy::kFixedBlockSize,
+            absl::nullopt, /*block_size=*/1),
+        train_partition);
+  } else {
+    std::atomic<std::int64_t> atomic_index(-1);
+    auto train_step = [&](const int64_t begin, const int64_t end) {
+      // The static_cast here is safe since begin and end can be at most
+      // num_examples which is an int.
+      for (int id = static_cast<int>(begin); id < end; ++id) {
+        const Status s = train_example(
+            examples.sampled_index(++atomic_index), /*delta_buffer=*/nullptr);
+        if (!s.ok()) {
+          mutex_lock l(train_step_status.mu);
+          train_step_status.value = s;
+          // Return from this worker thread - the calling thread is
+          // responsible for checking context status and returning on error.
+          return;
+        }
+      }
+    };
+    // TODO(sibyl-Aix6ihai): Tune this properly based on sparsity of the data,
+    // number of cpus, and cost per example.
+    const int64_t kCostPerUnit = examples.num_features();
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          examples.num_examples(), kCostPerUnit, train_step);
+  }
   mutex_lock l(train_step_status.mu);
   OP_REQUIRES_OK(context, train_step_status.value);
 }
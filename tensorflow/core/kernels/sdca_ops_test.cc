@@ -124,7 +124,7 @@ void GetGraphs(const int32_t num_examples,
                const int32_t sparse_features_per_group,
                const int32_t num_dense_feature_groups,
                const int32_t dense_features_per_group, Graph** const init_g,
-               Graph** train_g) {
+               Graph** train_g, const int32_t delta_merge_interval = 0) {
   {
     // Build initialization graph
     Graph* g = new Graph(OpRegistry::Global());
@@ -201,10 +201,17 @@ void GetGraphs(const int32_t num_examples,
     Node* const labels = RandomZeroOrOne(g, num_examples);
     Node* const example_state_data = Zeros(g, TensorShape({num_examples, 4}));
 
+    // Only SdcaOptimizerV2 has the delta_merge_interval attr.
+    NodeBuilder builder(g->NewName("sdca"), delta_merge_interval > 0
+                                                ? "SdcaOptimizerV2"
+                                                : "SdcaOptimizer");
+    if (delta_merge_interval > 0) {
+      builder.Attr("adaptive", false)
+          .Attr("delta_merge_interval", delta_merge_interval);
+    }
     Node* sdca = nullptr;
     TF_CHECK_OK(
-        NodeBuilder(g->NewName("sdca"), "SdcaOptimizer")
-            .Attr("loss_type", "logistic_loss")
+        builder.Attr("loss_type", "logistic_loss")
             .Attr("num_sparse_features", num_sparse_feature_groups)
             .Attr("num_sparse_features_with_values", num_sparse_feature_groups)
             .Attr("num_dense_features", num_dense_feature_groups)
@@ -265,10 +272,43 @@ void BM_SDCA_LARGE_SPARSE(::testing::benchmark::State& state) {
                   /*old_benchmark_api*/ false)
       .Run(state);
 }
+
+// Training with state.range(0) intra-op threads, and either the shared delta
+// weights updated after every example (state.range(1) == 0) or thread-local
+// delta weights merged every state.range(1) examples.
+void BM_SDCA_PARTITIONED_SCALING(::testing::benchmark::State& state) {
+  const int num_threads = state.range(0);
+  const int delta_merge_interval = state.range(1);
+
+  Graph* init = nullptr;
+  Graph* train = nullptr;
+  GetGraphs(16384 /* examples */, 8 /* sparse feature groups */,
+            1e5 /* sparse features per group */, 0 /* dense feature groups*/,
+            0 /* dense features per group */, &init, &train,
+            delta_merge_interval);
+  SessionOptions options;
+  options.config.set_intra_op_parallelism_threads(num_threads);
+  options.config.set_inter_op_parallelism_threads(1);
+  test::Benchmark("cpu", train, &options, init, nullptr, "",
+                  /*old_benchmark_api*/ false)
+      .Run(state);
+}
 }  // namespace
 
 BENCHMARK(BM_SDCA)->Arg(128)->Arg(256)->Arg(512)->Arg(1024);
 BENCHMARK(BM_SDCA_LARGE_DENSE)->Arg(128)->Arg(256)->Arg(512)->Arg(1024);
 BENCHMARK(BM_SDCA_LARGE_SPARSE)->Arg(128)->Arg(256)->Arg(512)->Arg(1024);
+BENCHMARK(BM_SDCA_PARTITIONED_SCALING)
+    ->ArgPair(1, 0)
+    ->ArgPair(4, 0)
+    ->ArgPair(16, 0)
+    ->ArgPair(64, 0)
+    ->ArgPair(1, 64)
+    ->ArgPair(2, 64)
+    ->ArgPair(4, 64)
+    ->ArgPair(8, 64)
+    ->ArgPair(16, 64)
+    ->ArgPair(32, 64)
+    ->ArgPair(64, 64);
 
 }  // namespace tensorflow
@@ -539,7 +539,15 @@ class SparseSegmentReductionOpBase : public OpKernel {
     OP_REQUIRES_OK(
         context, internal::ValidateSparseSegmentReduction(
                      context, input, indices, segment_ids, has_num_segments_));
+    ReduceSegments(context, input, indices, segment_ids);
+  }
 
+ protected:
+  // Reduces the rows of "input" selected by "indices" into the segments given
+  // by "segment_ids" and writes them to output 0.  The arguments must have
+  // passed ValidateSparseSegmentReduction().
+  void ReduceSegments(OpKernelContext* context, const Tensor& input,
+                      const Tensor& indices, const Tensor& segment_ids) {
     Index output_rows = -1;
     if (has_num_segments_) {
       const Tensor& num_segments = context->input(3);
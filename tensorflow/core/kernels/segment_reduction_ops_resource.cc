@@ -0,0 +1,118 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/kernels/segment_reduction_ops_impl.h"
+#include "tensorflow/core/kernels/training_op_helpers.h"
+
+namespace tensorflow {
+
+// Fusion of ResourceGather and SparseSegment{Sum,Mean,SqrtN}: reduces the
+// variable rows gather_indices[indices[i]] straight into the segment outputs,
+// without materializing the [num_indices, ...] gathered tensor.
+template <class T, typename Index, typename SegmentId>
+class ResourceSparseSegmentReductionOp
+    : public SparseSegmentReductionOpBase<CPUDevice, T, Index, SegmentId> {
+ public:
+  explicit ResourceSparseSegmentReductionOp(OpKernelConstruction* context)
+      : SparseSegmentReductionOpBase<CPUDevice, T, Index, SegmentId>(
+            context, Combiner(context) == "mean",
+            Combiner(context) == "sqrtn", false /* has_num_segments */,
+            T(0) /* default_value */) {}
+
+  void Compute(OpKernelContext* context) override {
+    core::RefCountPtr<Var> v;
+    OP_REQUIRES_OK(context,
+                   LookupResource(context, HandleFromInput(context, 0), &v));
+    OP_REQUIRES_OK(context,
+                   EnsureSparseVariableAccess<CPUDevice, T>(context, v.get()));
+    // As in ResourceGather, hold the lock for the whole reduction rather than
+    // taking a reference to the variable's buffer, so that a concurrent
+    // update does not copy the (potentially very large) table.
+    tf_shared_lock ml(*v->mu());
+    const Tensor& params = *v->tensor();
+    const Tensor& gather_indices = context->input(1);
+    const Tensor& indices = context->input(2);
+    const Tensor& segment_ids = context->input(3);
+    OP_REQUIRES(context, params.dtype() == DataTypeToEnum<T>::v(),
+                errors::InvalidArgument(
+                    "Trying to read variable with wrong dtype. Expected ",
+                    DataTypeString(DataTypeToEnum<T>::v()), " got ",
+                    DataTypeString(params.dtype())));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(gather_indices.shape()),
+                errors::InvalidArgument("gather_indices should be a vector."));
+    OP_REQUIRES_OK(context, internal::ValidateSparseSegmentReduction(
+                                context, params, indices, segment_ids,
+                                false /* has_num_segments */));
+
+    // Resolves the indices into rows of the variable.  This only touches the
+    // index vectors; the rows themselves are read once, by the reduction.
+    const int64_t num_indices = indices.NumElements();
+    const int64_t num_gather_indices = gather_indices.NumElements();
+    const int64_t num_rows = params.dim_size(0);
+    Tensor rows(DataTypeToEnum<Index>::v(), TensorShape({num_indices}));
+    const auto gather_indices_vec = gather_indices.vec<Index>();
+    const auto indices_vec = indices.vec<Index>();
+    auto rows_vec = rows.vec<Index>();
+    for (int64_t i = 0; i < num_indices; ++i) {
+      const Index index = internal::SubtleMustCopy(indices_vec(i));
+      OP_REQUIRES(context, FastBoundsCheck(index, num_gather_indices),
+                  errors::InvalidArgument("indices[", i, "] = ", index,
+                                          " is not in [0, ",
+                                          num_gather_indices, ")"));
+      const Index row = internal::SubtleMustCopy(gather_indices_vec(index));
+      OP_REQUIRES(context, FastBoundsCheck(row, num_rows),
+                  errors::InvalidArgument("gather_indices[", index, "] = ",
+                                          row, " is not in [0, ", num_rows,
+                                          ")"));
+      rows_vec(i) = row;
+    }
+
+    this->ReduceSegments(context, params, rows, segment_ids);
+  }
+
+ private:
+  static string Combiner(OpKernelConstruction* context) {
+    string combiner;
+    // The op definition restricts the attr to "sum", "mean" and "sqrtn".
+    context->GetAttr("combiner", &combiner).IgnoreError();
+    return combiner;
+  }
+};
+
+#define REGISTER_CPU_SPARSE_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, index_type) \
+  REGISTER_CPU_SPARSE_KERNELS(type, index_type, int32)                         \
+  REGISTER_CPU_SPARSE_KERNELS(type, index_type, int64_t)
+#define REGISTER_CPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE(type)       \
+  REGISTER_CPU_SPARSE_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, int32) \
+  REGISTER_CPU_SPARSE_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, int64_t)
+
+#define REGISTER_CPU_SPARSE_KERNELS(type, index_type, segment_ids_type)       \
+  REGISTER_KERNEL_BUILDER(                                                    \
+      Name("_ResourceSparseSegmentReduction")                                 \
+          .Device(DEVICE_CPU)                                                 \
+          .TypeConstraint<type>("dtype")                                      \
+          .TypeConstraint<index_type>("Tidx")                                 \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),                   \
+      ResourceSparseSegmentReductionOp<type, index_type, segment_ids_type>);
+TF_CALL_FLOAT_TYPES(REGISTER_CPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE);
+#undef REGISTER_CPU_SPARSE_KERNELS
+
+#undef REGISTER_CPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE
+#undef REGISTER_CPU_SPARSE_KERNELS_FOR_EACH_SEGMENT_ID_TYPE
+
+}  // namespace tensorflow
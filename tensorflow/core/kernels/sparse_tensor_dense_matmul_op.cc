@@ -19,11 +19,14 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_tensor_dense_matmul_op.h"
 
+#include <vector>
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -250,12 +253,94 @@ Status MOutOfBoundsError(int64_t m, std::size_t i, int lhs_index_a,
                                  "] out of bounds (>=", out_dim0, ")");
 }
 
+// Computes the product for a wide right-hand side on the intra-op threads.
+// The nonzeros are bucketed by output row first (COO to CSR), so that each
+// thread owns a range of output rows. A row accumulates the rows of `b` of
+// its nonzeros in the order they appear in `a_indices`, which gives the same
+// sums as the nonzero-at-a-time loop.
+template <typename T, typename Tsum, typename Tindices, bool ADJ_A, bool ADJ_B>
+Status SparseTensorDenseMatMulCsrImpl(
+    const DeviceBase::CpuWorkerThreads& worker_threads,
+    typename TTypes<Tsum>::Matrix out,
+    typename TTypes<Tindices>::ConstMatrix a_indices,
+    typename TTypes<T>::ConstVec a_values, typename TTypes<T>::ConstMatrix b) {
+  const std::size_t nnz = a_values.size();
+  const std::size_t rhs_right = (ADJ_B ? b.dimension(0) : b.dimension(1));
+  const std::size_t lhs_right = (ADJ_B ? b.dimension(1) : b.dimension(0));
+  const int lhs_index_a = ADJ_A ? 1 : 0;
+  const int rhs_index_a = ADJ_A ? 0 : 1;
+  const int64_t out_rows = out.dimension(0);
+
+  // The indices are copied once so that they are only checked once.
+  std::vector<Tindices> rows(nnz);
+  std::vector<Tindices> cols(nnz);
+  std::vector<int64_t> row_start(out_rows + 1, 0);
+  for (std::size_t i = 0; i < nnz; ++i) {
+    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
+    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
+    if (!FastBoundsCheck(k, lhs_right)) {
+      return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
+    }
+    if (!FastBoundsCheck(m, out_rows)) {
+      return MOutOfBoundsError(m, i, lhs_index_a, out_rows);
+    }
+    rows[i] = m;
+    cols[i] = k;
+    ++row_start[m + 1];
+  }
+  for (int64_t m = 0; m < out_rows; ++m) {
+    row_start[m + 1] += row_start[m];
+  }
+  // The nonzeros of output row m are nonzeros[row_start[m], row_start[m + 1]).
+  std::vector<int64_t> nonzeros(nnz);
+  {
+    std::vector<int64_t> next(row_start.begin(), row_start.end() - 1);
+    for (std::size_t i = 0; i < nnz; ++i) {
+      nonzeros[next[rows[i]]++] = i;
+    }
+  }
+
+  // Row k of `b`, or of its adjoint, is contiguous in `b_data`.
+  Eigen::Tensor<T, 2, Eigen::ColMajor> col_major_conj_b;
+  const T* b_data = b.data();
+  if (ADJ_B) {
+    Eigen::array<int, 2> shuffle(1, 0);  // preserve dimension order
+    col_major_conj_b = b.swap_layout().shuffle(shuffle).conjugate();
+    b_data = col_major_conj_b.data();
+  }
+
+  auto compute_rows = [&](int64_t start_row, int64_t limit_row) {
+    for (int64_t m = start_row; m < limit_row; ++m) {
+      Tsum* out_row = &out(m, 0);
+      for (int64_t j = row_start[m]; j < row_start[m + 1]; ++j) {
+        const int64_t i = nonzeros[j];
+        const Tsum a_value =
+            static_cast<Tsum>(ADJ_A ? MaybeConj(a_values(i)) : a_values(i));
+        const T* b_row = b_data + static_cast<int64_t>(cols[i]) * rhs_right;
+        // Simple enough for the compiler to vectorize.
+        for (std::size_t n = 0; n < rhs_right; ++n) {
+          out_row[n] += a_value * static_cast<Tsum>(b_row[n]);
+        }
+      }
+    }
+  };
+  const int64_t cost_per_row =
+      (static_cast<int64_t>(nnz) / std::max<int64_t>(out_rows, 1) + 1) *
+      rhs_right *
+      (Eigen::TensorOpCost::AddCost<Tsum>() +
+       Eigen::TensorOpCost::MulCost<Tsum>());
+  Shard(worker_threads.num_threads, worker_threads.workers, out_rows,
+        cost_per_row, compute_rows);
+  return Status::OK();
+}
+
 template <typename T, typename Tsum, typename Tindices, bool ADJ_A, bool ADJ_B>
 Status SparseTensorDenseMatMulImpl(
+    const DeviceBase::CpuWorkerThreads& worker_threads,
     typename TTypes<Tsum>::Matrix out,
     typename TTypes<Tindices>::ConstMatrix a_indices,
     typename TTypes<T>::ConstVec a_values, typename TTypes<T>::ConstMatrix b) {
-  // Vectorize certain operations above this size.
+  // Vectorize and parallelize over output rows above this size.
   static constexpr std::size_t kNumVectorize = 32;
 
   const std::size_t nnz = a_values.size();
@@ -264,60 +349,28 @@ Status SparseTensorDenseMatMulImpl(
   const int lhs_index_a = ADJ_A ? 1 : 0;
   const int rhs_index_a = ADJ_A ? 0 : 1;
 
-  // TODO(ebrevdo): After many failed experiments, can't find a multi-threaded
-  // approach that achieves the performance of the single threaded
-  // one.  Perhaps Eigen threadpool implementation is just too slow?
+  if (rhs_right >= kNumVectorize) {
+    return SparseTensorDenseMatMulCsrImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
+        worker_threads, out, a_indices, a_values, b);
+  }
 
-  if (rhs_right < kNumVectorize) {
-    // Disable vectorization if the RHS of output is too small
-    auto maybe_adjoint_b = MaybeAdjoint<decltype(b), ADJ_B>(b);
+  // Disable vectorization if the RHS of output is too small
+  auto maybe_adjoint_b = MaybeAdjoint<decltype(b), ADJ_B>(b);
 
-    for (std::size_t i = 0; i < nnz; ++i) {
-      const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
-      const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
-      if (!FastBoundsCheck(k, lhs_right)) {
-        return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
-      }
-      if (!FastBoundsCheck(m, out.dimension(0))) {
-        return MOutOfBoundsError(m, i, lhs_index_a, out.dimension(0));
-      }
-      const T a_value = ADJ_A ? MaybeConj(a_values(i)) : a_values(i);
-      for (std::size_t n = 0; n < rhs_right; ++n) {
-        const T b_value = maybe_adjoint_b(k, n);
-        out(m, n) += static_cast<Tsum>(a_value) * static_cast<Tsum>(b_value);
-      }
+  for (std::size_t i = 0; i < nnz; ++i) {
+    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
+    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
+    if (!FastBoundsCheck(k, lhs_right)) {
+      return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
     }
-  } else {
-    // Vectorization via Eigen.
-    const int b_chip_index = ADJ_B ? 1 : 0;
-
-#define LOOP_NNZ(b_passed)                                                  \
-  for (std::size_t i = 0; i < nnz; ++i) {                                   \
-    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a)); \
-    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a)); \
-    const T a_value = (ADJ_A) ? MaybeConj(a_values(i)) : a_values(i);       \
-    if (!FastBoundsCheck(k, lhs_right)) {                                   \
-      return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);               \
-    }                                                                       \
-    if (!FastBoundsCheck(m, out.dimension(0))) {                            \
-      return MOutOfBoundsError(m, i, lhs_index_a, out.dimension(0));        \
-    }                                                                       \
-    out.template chip<0>(m) +=                                              \
-        b_passed.template chip<b_chip_index>(k).template cast<Tsum>() *     \
-        static_cast<Tsum>(a_value);                                         \
-  }
-
-    if (ADJ_B) {
-      // Perform transpose and conjugation on B once, since we chip out B's
-      // columns in the nnz loop.
-      Eigen::array<int, 2> shuffle(1, 0);  // preserve dimension order
-      Eigen::Tensor<T, 2, Eigen::ColMajor> col_major_conj_b =
-          b.swap_layout().shuffle(shuffle).conjugate();
-      LOOP_NNZ(col_major_conj_b);
-    } else {
-      LOOP_NNZ(b);
+    if (!FastBoundsCheck(m, out.dimension(0))) {
+      return MOutOfBoundsError(m, i, lhs_index_a, out.dimension(0));
+    }
+    const T a_value = ADJ_A ? MaybeConj(a_values(i)) : a_values(i);
+    for (std::size_t n = 0; n < rhs_right; ++n) {
+      const T b_value = maybe_adjoint_b(k, n);
+      out(m, n) += static_cast<Tsum>(a_value) * static_cast<Tsum>(b_value);
     }
-#undef LOOP_NNZ
   }
   return Status::OK();
 }
@@ -330,6 +383,8 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
                         typename TTypes<T>::ConstVec a_values,
                         typename TTypes<T>::ConstMatrix b) {
     using Tsum = typename SumType<T>::type;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
     Tensor temp_out_t;
     if (!std::is_same<T, Tsum>::value) {
       TF_RETURN_IF_ERROR(ctx->allocate_temp(
@@ -339,7 +394,7 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
       temp_out.setZero();
       TF_RETURN_IF_ERROR(
           SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              temp_out, a_indices, a_values, b));
+              worker_threads, temp_out, a_indices, a_values, b));
       out = temp_out.template cast<T>();
     } else {
       out.setZero();
@@ -349,7 +404,7 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
           *reinterpret_cast<typename TTypes<Tsum>::Matrix*>(&out);
       TF_RETURN_IF_ERROR(
           SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              out_workaround, a_indices, a_values, b));
+              worker_threads, out_workaround, a_indices, a_values, b));
     }
     return Status::OK();
   }
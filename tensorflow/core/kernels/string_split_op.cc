@@ -99,8 +99,10 @@ std::vector<StringPiece> Split(const tstring& str, const tstring& delimiter,
   return SplitOnCharSet(str, delimiter, predicate);
 }
 
-std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
-                                 int maxsplit) {
+// Calls `emit` on each token of `text` split by `sep`, in order. The tokens are
+// slices of `text`, so nothing is allocated per token.
+template <typename Emit>
+void SplitV2(StringPiece text, StringPiece sep, int maxsplit, Emit emit) {
   // This SplitV2 method matches the behavior of python's str.split:
   //   If sep is given, consecutive delimiters are not grouped together
   //   and are deemed to delimit empty strings (for example, '1,,2'.split(',')
@@ -115,12 +117,9 @@ std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
   //   splitting an empty string or a string consisting of just whitespace
   //   with a None separator returns [].
 
-  std::vector<StringPiece> result;
-
-  StringPiece text(str);
   if (maxsplit == 0) {
-    result.emplace_back(text);
-    return result;
+    emit(text);
+    return;
   }
 
   if (sep.empty()) {
@@ -129,32 +128,31 @@ std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
     str_util::RemoveLeadingWhitespace(&text);
     int split = 0;
     while (str_util::ConsumeNonWhitespace(&text, &token)) {
-      result.push_back(token);
+      emit(token);
       str_util::RemoveLeadingWhitespace(&text);
       ++split;
       if (maxsplit > 0 && split == maxsplit) {
-        result.push_back(text);
-        return result;
+        emit(text);
+        return;
       }
     }
-    return result;
+    return;
   }
-  auto p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
+  // A single character separator is the common case, and is scanned for with
+  // memchr, which is vectorized.
+  auto find_sep = [sep](StringPiece rest) {
+    return sep.size() == 1 ? rest.find(sep[0]) : rest.find(sep);
+  };
   int split = 0;
-  while (p != text.end()) {
-    StringPiece token = text.substr(0, p - text.begin());
-    result.push_back(token);
-    text.remove_prefix(token.size());
-    text.remove_prefix(sep.size());
+  for (size_t p = find_sep(text); p != StringPiece::npos; p = find_sep(text)) {
+    emit(text.substr(0, p));
+    text.remove_prefix(p + sep.size());
     ++split;
     if (maxsplit > 0 && split == maxsplit) {
-      result.push_back(StringPiece(text));
-      return result;
+      break;
     }
-    p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
   }
-  result.push_back(text);
-  return result;
+  emit(text);
 }
 
 }  // namespace
@@ -263,21 +261,17 @@ class StringSplitV2Op : public OpKernel {
                                         sep_tensor->shape().DebugString()));
     const auto sep_vec = sep_tensor->flat<tstring>();
     StringPiece sep(sep_vec(0));
-    std::vector<StringPiece> tokens;
-    // Guess that we'll be unpacking a handful of tokens per example.
-    static constexpr int kReserveSize = 4;
-    tokens.reserve(batch_size * kReserveSize);
 
+    // Counts the tokens first, so that they can be written straight into the
+    // outputs instead of being collected.
     int64_t output_size = 0;
     int64_t max_num_entries = 0;
-    std::vector<int64_t> num_indices(batch_size);
     for (int64_t i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts = SplitV2(input_vec(i), sep, maxsplit_);
-      int64_t n_entries = parts.size();
-      num_indices[i] = n_entries;
+      int64_t n_entries = 0;
+      SplitV2(input_vec(i), sep, maxsplit_,
+              [&n_entries](StringPiece) { ++n_entries; });
       output_size += n_entries;
       max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), parts.begin(), parts.end());
     }
 
     Tensor* sp_indices_t;
@@ -294,14 +288,15 @@ class StringSplitV2Op : public OpKernel {
     auto sp_shape = sp_shape_t->vec<int64_t>();
     sp_shape(0) = batch_size;
     sp_shape(1) = max_num_entries;
-    size_t c = 0;
-    for (size_t i = 0; i < batch_size; ++i) {
-      for (size_t j = 0; j < num_indices[i]; ++j) {
+    int64_t c = 0;
+    for (int64_t i = 0; i < batch_size; ++i) {
+      int64_t j = 0;
+      SplitV2(input_vec(i), sep, maxsplit_, [&](StringPiece token) {
         sp_indices(c, 0) = i;
-        sp_indices(c, 1) = j;
-        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
+        sp_indices(c, 1) = j++;
+        sp_tokens(c).assign(token.data(), token.size());
         ++c;
-      }
+      });
     }
   }
 
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/summary/schema.h"
 #include "tensorflow/core/summary/summary_db_writer.h"
 #include "tensorflow/core/summary/summary_file_writer.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/event.pb.h"
 
 namespace tensorflow {
@@ -33,7 +34,22 @@ REGISTER_KERNEL_BUILDER(Name("SummaryWriter").Device(DEVICE_CPU),
 class CreateSummaryFileWriterOp : public OpKernel {
  public:
   explicit CreateSummaryFileWriterOp(OpKernelConstruction* ctx)
-      : OpKernel(ctx) {}
+      : OpKernel(ctx) {
+    // Writes summaries on a background thread, so that they do not add to the
+    // step time, and optionally drops them instead of blocking the step when
+    // the thread falls behind.
+    OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar("TF_SUMMARY_WRITER_ASYNC",
+                                           /*default_val=*/false,
+                                           &options_.asynchronous));
+    bool drop_when_full;
+    OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar("TF_SUMMARY_WRITER_DROP_WHEN_FULL",
+                                           /*default_val=*/false,
+                                           &drop_when_full));
+    if (drop_when_full) {
+      options_.full_queue_policy =
+          SummaryFileWriterOptions::FullQueuePolicy::kDrop;
+    }
+  }
 
   void Compute(OpKernelContext* ctx) override {
     const Tensor* tmp;
@@ -57,13 +73,16 @@ class CreateSummaryFileWriterOp : public OpKernel {
     core::RefCountPtr<SummaryWriterInterface> s;
     OP_REQUIRES_OK(ctx, LookupOrCreateResource<SummaryWriterInterface>(
                             ctx, HandleFromInput(ctx, 0), &s,
-                            [max_queue, flush_millis, logdir, filename_suffix,
-                             ctx](SummaryWriterInterface** s) {
+                            [this, max_queue, flush_millis, logdir,
+                             filename_suffix, ctx](SummaryWriterInterface** s) {
                               return CreateSummaryFileWriter(
                                   max_queue, flush_millis, logdir,
-                                  filename_suffix, ctx->env(), s);
+                                  filename_suffix, ctx->env(), options_, s);
                             }));
   }
+
+ private:
+  SummaryFileWriterOptions options_;
 };
 REGISTER_KERNEL_BUILDER(Name("CreateSummaryFileWriter").Device(DEVICE_CPU),
                         CreateSummaryFileWriterOp);
@@ -17,6 +17,9 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_TENSOR_ARRAY_H_
 
 #include <limits.h>
+
+#include <cstring>
+#include <type_traits>
 #include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
@@ -152,6 +155,7 @@ class TensorArray : public ResourceBase {
         marked_size_(marked_size),
         element_shape_(element_shape),
         identical_element_shapes_(identical_element_shapes),
+        num_buffered_elements_(0),
         tensors_(N) {}
 
   // Write Tensor 'value' to index 'index'.
@@ -181,13 +185,21 @@ class TensorArray : public ResourceBase {
   //    - The gradients_disallowed flag is set true (GradientsAllowed()
   //      will now return false).
   //
+  // A CPU TensorArray with a fixed size, a fully defined element shape and a
+  // dtype that can be memcpy'd copies the values of single writes into one
+  // contiguous buffer of shape [N] + element_shape, allocated on the first
+  // write, instead of keeping a reference to them. This lets the producers'
+  // buffers be freed within the loop that fills the array, and lets
+  // ReadMany() return the whole buffer as the stacked elements.
+  //
   // Note, value is passed as a pointer because we its underlying
   // Tensor's shape is accessed.  Otherwise it is not modified.
   template <typename Device, typename T>
   Status WriteOrAggregate(OpKernelContext* ctx, const int32_t index,
                           const Tensor* value) {
     mutex_lock l(mu_);
-    return LockedWriteOrAggregate<Device, T>(ctx, index, value);
+    return LockedWriteOrAggregate<Device, T>(ctx, index, value,
+                                             /*write_into_buffer=*/true);
   }
 
   template <typename Device, typename T>
@@ -197,7 +209,8 @@ class TensorArray : public ResourceBase {
     mutex_lock l(mu_);
     int32_t i = 0;
     for (const int32_t ix : indices) {
-      Status s = LockedWriteOrAggregate<Device, T>(ctx, ix, &(*values)[i]);
+      Status s = LockedWriteOrAggregate<Device, T>(
+          ctx, ix, &(*values)[i], /*write_into_buffer=*/false);
       ++i;
       TF_RETURN_IF_ERROR(s);
     }
@@ -225,10 +238,19 @@ class TensorArray : public ResourceBase {
     return LockedRead<Device, T>(ctx, index, value);
   }
 
+  // Reads the elements at 'indices' like Read(). If 'stacked' is not null and
+  // 'indices' are 0, ..., N - 1 of elements that were all written into the
+  // contiguous buffer, also sets '*stacked' to the buffer, which then holds
+  // the elements stacked along a new first dimension without a copy.
   template <typename Device, typename T>
   Status ReadMany(OpKernelContext* ctx, const std::vector<int32>& indices,
-                  std::vector<Tensor>* values) {
+                  std::vector<Tensor>* values, Tensor* stacked = nullptr) {
     mutex_lock l(mu_);
+    if (stacked != nullptr && LockedBufferHoldsAll(indices)) {
+      // Taken before the reads, which may release the buffer when
+      // clear_after_read is true.
+      *stacked = buffer_;
+    }
     values->clear();
     values->resize(indices.size());
     int32_t i = 0;
@@ -337,6 +359,8 @@ class TensorArray : public ResourceBase {
   void ClearAndMarkClosed() {
     mutex_lock l(mu_);
     tensors_.clear();
+    buffer_ = Tensor();
+    num_buffered_elements_ = 0;
     closed_ = true;
   }
 
@@ -354,9 +378,38 @@ class TensorArray : public ResourceBase {
 
   template <typename Device, typename T>
   Status LockedWriteOrAggregate(OpKernelContext* ctx, const int32_t index,
-                                const Tensor* value)
+                                const Tensor* value, bool write_into_buffer)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns whether the first write to an index copies the value into the
+  // contiguous buffer. The elements must keep the buffer's alignment, since
+  // they are read as its slices.
+  template <typename Device>
+  bool LockedUsesBuffer() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (!std::is_same<Device, CPUDevice>::value || dynamic_size_ ||
+        multiple_writes_aggregate_ || is_grad_ || tensors_.empty() ||
+        !DataTypeCanUseMemcpy(dtype_) || !element_shape_.IsFullyDefined()) {
+      return false;
+    }
+    const int64_t element_bytes =
+        element_shape_.num_elements() * DataTypeSize(dtype_);
+    return element_bytes > 0 && element_bytes % EIGEN_MAX_ALIGN_BYTES == 0;
+  }
+
+  // Returns whether 'indices' are 0, ..., N - 1 and every element is a slice
+  // of the contiguous buffer.
+  bool LockedBufferHoldsAll(const std::vector<int32>& indices) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (!buffer_.IsInitialized() || indices.size() != tensors_.size() ||
+        num_buffered_elements_ != tensors_.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < indices.size(); ++i) {
+      if (static_cast<size_t>(indices[i]) != i) return false;
+    }
+    return true;
+  }
+
   template <typename Device, typename T>
   Status LockedRead(OpKernelContext* ctx, const int32_t index, Tensor* value)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -411,12 +464,22 @@ class TensorArray : public ResourceBase {
   // was not fully defined.
   const bool identical_element_shapes_;
 
+  // The contiguous buffer of shape [N] + element_shape_ that single writes
+  // copy their values into, if LockedUsesBuffer(), and the number of
+  // elements that are slices of it and have not been cleared.
+  Tensor buffer_ TF_GUARDED_BY(mu_);
+  size_t num_buffered_elements_ TF_GUARDED_BY(mu_);
+
   // TensorAndState is used to keep track of the Tensors stored in the
   // TensorArray, along with their shapes, and a boolean that determines whether
   // they have already been read or not.
   struct TensorAndState {
     TensorAndState()
-        : written(false), read(false), cleared(false), local_copy(false) {}
+        : written(false),
+          read(false),
+          cleared(false),
+          local_copy(false),
+          buffered(false) {}
     Tensor tensor;
     TensorShape shape;
     bool written;  // True if a Tensor has been written to the index.
@@ -431,6 +494,9 @@ class TensorArray : public ResourceBase {
     // aggregated value.  This flag marks that such a Tensor is being
     // used.  All future writes will aggregate to the existing local Tensor.
     bool local_copy;
+
+    // True if the Tensor is a slice of the contiguous buffer.
+    bool buffered;
   };
   // The list of underlying Tensors and states.
   std::vector<TensorAndState> tensors_ TF_GUARDED_BY(mu_);
@@ -439,7 +505,8 @@ class TensorArray : public ResourceBase {
 template <typename Device, typename T>
 Status TensorArray::LockedWriteOrAggregate(OpKernelContext* ctx,
                                            const int32_t index,
-                                           const Tensor* value) {
+                                           const Tensor* value,
+                                           bool write_into_buffer) {
   TF_RETURN_IF_ERROR(LockedReturnIfClosed());
   size_t index_size = static_cast<size_t>(index);
   if (index < 0 || (!dynamic_size_ && index_size >= tensors_.size())) {
@@ -530,6 +597,21 @@ Status TensorArray::LockedWriteOrAggregate(OpKernelContext* ctx,
     // We've aggregated the values, so disallow backprop on this
     // TensorArray.
     gradients_disallowed_ = true;
+  } else if (write_into_buffer && LockedUsesBuffer<Device>()) {
+    if (!buffer_.IsInitialized()) {
+      TensorShape buffer_shape;
+      element_shape_.AsTensorShape(&buffer_shape);  // Always succeeds.
+      buffer_shape.InsertDim(0, tensors_.size());
+      TF_RETURN_IF_ERROR(ctx->allocate_temp(dtype_, buffer_shape, &buffer_));
+    }
+    t.tensor = buffer_.SubSlice(index);
+    StringPiece data = t.tensor.tensor_data();
+    std::memcpy(const_cast<char*>(data.data()), value->tensor_data().data(),
+                data.size());
+    t.shape = value->shape();
+    t.written = true;
+    t.buffered = true;
+    ++num_buffered_elements_;
   } else {
     t.tensor = *value;
     t.shape = value->shape();
@@ -616,6 +698,9 @@ Status TensorArray::LockedRead(OpKernelContext* ctx, const int32_t index,
   if (clear_after_read_) {
     t.tensor = Tensor();
     t.cleared = true;
+    if (t.buffered && --num_buffered_elements_ == 0) {
+      buffer_ = Tensor();
+    }
   }
   t.read = true;
   return Status::OK();
@@ -650,7 +650,9 @@ class TensorArrayPackOrGatherOp : public OpKernel {
     }
 
     // Read all the Tensors into a vector to keep track of their memory.
-    Status s = tensor_array->ReadMany<Device, T>(ctx, indices, &values);
+    Tensor stacked;
+    Status s =
+        tensor_array->ReadMany<Device, T>(ctx, indices, &values, &stacked);
     OP_REQUIRES_OK(ctx, s);
 
     const Tensor* value_0_t = &values[0];
@@ -662,6 +664,13 @@ class TensorArrayPackOrGatherOp : public OpKernel {
                                 " which does not match the Tensor at index 0: ",
                                 value_0_t->shape().DebugString()));
 
+    // The elements were written into one contiguous buffer in this order, so
+    // it already holds the output.
+    if (stacked.IsInitialized()) {
+      ctx->set_output(0, stacked);
+      return;
+    }
+
     TensorShape output_shape(value_0_t->shape());
     output_shape.InsertDim(0, num_indices);
 
@@ -857,7 +866,9 @@ class TensorArrayConcatOp : public OpKernel {
     std::vector<Tensor> values;
     std::vector<int32> indices(array_size);
     std::iota(indices.begin(), indices.end(), 0);
-    Status s = tensor_array->ReadMany<Device, T>(ctx, indices, &values);
+    Tensor stacked;
+    Status s =
+        tensor_array->ReadMany<Device, T>(ctx, indices, &values, &stacked);
     OP_REQUIRES_OK(ctx, s);
 
     Tensor* lengths_tensor = nullptr;
@@ -906,6 +917,18 @@ class TensorArrayConcatOp : public OpKernel {
       }
     }
 
+    // The elements were written into one contiguous buffer in this order, so
+    // it already holds the output.
+    if (stacked.IsInitialized()) {
+      Tensor output_tensor;
+      OP_REQUIRES(ctx, output_tensor.CopyFrom(stacked, output_shape),
+                  errors::Internal("Could not reshape the TensorArray buffer ",
+                                   stacked.shape().DebugString(), " to ",
+                                   output_shape.DebugString()));
+      ctx->set_output(0, output_tensor);
+      return;
+    }
+
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output(0, output_shape, &output_tensor));
     ConstMatrixVector input_tensors_flat;
@@ -141,6 +141,19 @@ struct TopKFunctor<CPUDevice, T> {
       return Status::OK();
     }
 
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+
+    // Sharding over rows leaves most threads idle for a few very wide rows,
+    // so those are also split into blocks of columns.
+    const int64_t min_block_cols = std::max<int64_t>(1 << 14, 8 * k);
+    const int64_t blocks_per_row = std::min<int64_t>(
+        worker_threads.num_threads / num_rows, num_cols / min_block_cols);
+    if (k < num_cols && blocks_per_row > 1) {
+      ComputeByColumnBlocks(worker_threads, sorted, k, input, num_rows,
+                            num_cols, blocks_per_row, values, indices);
+      return Status::OK();
+    }
+
     auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
       for (int32_t b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
@@ -228,12 +241,100 @@ struct TopKFunctor<CPUDevice, T> {
     const int64_t final_cost = (total_cost >= static_cast<double>(kint64max))
                                    ? kint64max
                                    : static_cast<int64_t>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
     return Status::OK();
   }
+
+ private:
+  // Orders the columns of a row by decreasing value, and equal values by
+  // increasing column, like the TopN filter above.
+  struct StableComp {
+    const T* input_data;
+    bool operator()(const int32_t a, const int32_t b) const {
+      if (input_data[b] < input_data[a]) {
+        return true;
+      } else if (input_data[b] > input_data[a]) {
+        return false;
+      } else {
+        return a < b;
+      }
+    }
+  };
+
+  // Finds the top k of each of the "blocks_per_row" blocks of columns of each
+  // row in parallel, then the top k of each row among those of its blocks.
+  // Since each block keeps k columns, the result is the same as filtering the
+  // whole row.
+  static void ComputeByColumnBlocks(
+      const DeviceBase::CpuWorkerThreads& worker_threads, bool sorted, int k,
+      const typename TTypes<T, 2>::ConstTensor& input, const int64_t num_rows,
+      const int64_t num_cols, const int64_t blocks_per_row,
+      typename TTypes<T, 2>::Tensor values,
+      typename TTypes<int, 2>::Tensor indices) {
+    const int64_t block_cols = (num_cols + blocks_per_row - 1) / blocks_per_row;
+    const int64_t num_blocks = num_rows * blocks_per_row;
+    // The top columns of block i are candidates[i * k, i * k + num_top[i]).
+    std::vector<int32> candidates(num_blocks * k);
+    std::vector<int32> num_top(num_blocks);
+    worker_threads.workers->ParallelFor(
+        num_blocks,
+        thread::ThreadPool::SchedulingParams(
+            thread::ThreadPool::SchedulingStrategy::kFixedBlockSize,
+            absl::nullopt, /*block_size=*/1),
+        [&](int64_t start_block, int64_t limit_block) {
+          for (int64_t i = start_block; i < limit_block; ++i) {
+            const int64_t b = i / blocks_per_row;
+            const int32 col_start = (i % blocks_per_row) * block_cols;
+            const int32 col_limit =
+                std::min<int64_t>(num_cols, col_start + block_cols);
+            gtl::TopN<int32, StableComp> filter(k, StableComp{&input(b, 0)});
+            for (int32_t c = col_start; c < col_limit; ++c) {
+              filter.push(c);
+            }
+            int32* top = &candidates[i * k];
+            for (auto it = filter.unsorted_begin(); it != filter.unsorted_end();
+                 ++it) {
+              *top++ = *it;
+            }
+            num_top[i] = top - &candidates[i * k];
+          }
+        });
+
+    auto MergeBlocks = [&](int64_t start_batch, int64_t limit_batch) {
+      for (int64_t b = start_batch; b < limit_batch; ++b) {
+        gtl::TopN<int32, StableComp> filter(k, StableComp{&input(b, 0)});
+        for (int64_t i = b * blocks_per_row; i < (b + 1) * blocks_per_row;
+             ++i) {
+          for (int32 j = 0; j < num_top[i]; ++j) {
+            filter.push(candidates[i * k + j]);
+          }
+        }
+        int32_t i = 0;
+        if (sorted) {
+          std::unique_ptr<std::vector<int32>> top_k(filter.Extract());
+          for (const int32 c : *top_k) {
+            indices(b, i++) = c;
+          }
+        } else {
+          for (auto it = filter.unsorted_begin(); it != filter.unsorted_end();
+               ++it) {
+            indices(b, i++) = *it;
+          }
+        }
+        std::transform(
+            &indices(b, 0), &indices(b, k), &values(b, 0),
+            [b, &input](const int32_t loc) { return input(b, loc); });
+      }
+    };
+    const int64_t merge_cost =
+        blocks_per_row * k * Eigen::numext::log2(static_cast<float>(k + 1)) *
+        (3 * Eigen::TensorOpCost::AddCost<int32>() +
+         Eigen::TensorOpCost::AddCost<T>());
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          merge_cost, MergeBlocks);
+  }
 };
 
 }  // namespace functor
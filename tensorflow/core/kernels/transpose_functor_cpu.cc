@@ -15,6 +15,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -68,12 +69,170 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+// Transposes in tiles when the innermost dimension changes. Such transposes
+// read or write with a large stride, which Eigen's shuffle does one element at
+// a time. Only 4 and 8 byte types have a tiled implementation; Run() returns
+// false for the others and when the shape does not benefit from tiling.
+template <typename T>
+struct TiledTranspose {
+  static bool Run(const CPUDevice& device, const Tensor& in,
+                  const gtl::ArraySlice<int32> perm, Tensor* out) {
+    return false;
+  }
+};
+
+#ifdef EIGEN_VECTORIZE
+
+// Transposes a square block of one packet per row in registers. `Scalar` has
+// the size of the transposed type, only its bits are moved.
+template <typename Scalar>
+struct TransposeMicroKernel {
+  using Packet = typename Eigen::internal::packet_traits<Scalar>::type;
+  static constexpr int kSize = Eigen::internal::unpacket_traits<Packet>::size;
+
+  // Row i of the block starts at a + i * lda in the input and at b + i * ldb
+  // in the output.
+  static void Apply(const Scalar* a, int64_t lda, Scalar* b, int64_t ldb) {
+    Eigen::internal::PacketBlock<Packet, kSize> block;
+    for (int i = 0; i < kSize; ++i) {
+      block.packet[i] = Eigen::internal::ploadu<Packet>(a + i * lda);
+    }
+    Eigen::internal::ptranspose(block);
+    for (int i = 0; i < kSize; ++i) {
+      Eigen::internal::pstoreu<Scalar>(b + i * ldb, block.packet[i]);
+    }
+  }
+};
+
+template <typename T, typename Scalar>
+struct TiledTransposeImpl {
+  static_assert(sizeof(T) == sizeof(Scalar), "Scalar must have the size of T");
+  using MicroKernel = TransposeMicroKernel<Scalar>;
+
+  // Side of the square tiles that are processed as one unit of work.
+  static constexpr int64_t kTileSize = 256 / sizeof(T);
+
+  static bool Run(const CPUDevice& device, const Tensor& in,
+                  const gtl::ArraySlice<int32> perm, Tensor* out) {
+    constexpr int kBlockSize = MicroKernel::kSize;
+    if (kBlockSize < 2 || in.dims() < 2) return false;
+
+    internal::TransposePermsVec out_positions;
+    internal::TransposeDimsVec new_dims;
+    internal::ReduceTransposeDimensions(in.shape(), perm, &out_positions,
+                                        &new_dims);
+    // ReduceTransposeDimensions gives the output position of each combined
+    // input dimension; invert it to get the permutation.
+    const int ndims = new_dims.size();
+    internal::TransposePermsVec new_perm(ndims);
+    for (int i = 0; i < ndims; ++i) new_perm[out_positions[i]] = i;
+    const int last = ndims - 1;
+    // Input dimension `p` becomes the innermost output dimension, and the
+    // innermost input dimension becomes output dimension `k`.
+    if (ndims < 2 || new_perm[last] == last) return false;
+    const int p = new_perm[last];
+    const int64_t rows = new_dims[p];
+    const int64_t cols = new_dims[last];
+    if (rows < kBlockSize || cols < kBlockSize) return false;
+
+    internal::TransposeDimsVec in_strides(ndims, 1);
+    internal::TransposeDimsVec out_strides(ndims, 1);
+    for (int i = ndims - 2; i >= 0; --i) {
+      in_strides[i] = in_strides[i + 1] * new_dims[i + 1];
+      out_strides[i] = out_strides[i + 1] * new_dims[new_perm[i + 1]];
+    }
+    // Output stride of each input dimension.
+    internal::TransposeDimsVec out_strides_of_in(ndims);
+    for (int i = 0; i < ndims; ++i) {
+      out_strides_of_in[new_perm[i]] = out_strides[i];
+    }
+
+    // The other dimensions, in input order, are iterated over tile by tile.
+    internal::TransposeDimsVec outer_dims;
+    internal::TransposeDimsVec outer_in_strides;
+    internal::TransposeDimsVec outer_out_strides;
+    for (int i = 0; i < last; ++i) {
+      if (i == p) continue;
+      outer_dims.push_back(new_dims[i]);
+      outer_in_strides.push_back(in_strides[i]);
+      outer_out_strides.push_back(out_strides_of_in[i]);
+    }
+
+    const int64_t lda = in_strides[p];
+    const int64_t ldb = out_strides_of_in[last];
+    const int64_t row_tiles = (rows + kTileSize - 1) / kTileSize;
+    const int64_t col_tiles = (cols + kTileSize - 1) / kTileSize;
+    const int64_t num_outer = in.NumElements() / (rows * cols);
+
+    const Scalar* in_data =
+        reinterpret_cast<const Scalar*>(in.tensor_data().data());
+    Scalar* out_data =
+        reinterpret_cast<Scalar*>(const_cast<char*>(out->tensor_data().data()));
+
+    auto transpose_tiles = [&](int64_t begin, int64_t end) {
+      for (int64_t tile = begin; tile < end; ++tile) {
+        const int64_t col_tile = tile % col_tiles;
+        const int64_t row_tile = (tile / col_tiles) % row_tiles;
+        int64_t outer = tile / (col_tiles * row_tiles);
+        int64_t in_base = 0;
+        int64_t out_base = 0;
+        for (int i = static_cast<int>(outer_dims.size()) - 1; i >= 0; --i) {
+          const int64_t index = outer % outer_dims[i];
+          outer /= outer_dims[i];
+          in_base += index * outer_in_strides[i];
+          out_base += index * outer_out_strides[i];
+        }
+        const Scalar* a = in_data + in_base;
+        Scalar* b = out_data + out_base;
+
+        const int64_t row_begin = row_tile * kTileSize;
+        const int64_t row_end = std::min(rows, row_begin + kTileSize);
+        const int64_t col_begin = col_tile * kTileSize;
+        const int64_t col_end = std::min(cols, col_begin + kTileSize);
+        int64_t r = row_begin;
+        for (; r + kBlockSize <= row_end; r += kBlockSize) {
+          int64_t c = col_begin;
+          for (; c + kBlockSize <= col_end; c += kBlockSize) {
+            MicroKernel::Apply(a + r * lda + c, lda, b + c * ldb + r, ldb);
+          }
+          for (; c < col_end; ++c) {
+            for (int64_t i = r; i < r + kBlockSize; ++i) {
+              b[c * ldb + i] = a[i * lda + c];
+            }
+          }
+        }
+        for (; r < row_end; ++r) {
+          for (int64_t c = col_begin; c < col_end; ++c) {
+            b[c * ldb + r] = a[r * lda + c];
+          }
+        }
+      }
+    };
+    const int64_t tile_elements = kTileSize * kTileSize;
+    Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(T) * tile_elements,
+                             /*bytes_stored=*/sizeof(T) * tile_elements,
+                             /*compute_cycles=*/tile_elements);
+    device.parallelFor(num_outer * row_tiles * col_tiles, cost,
+                       std::move(transpose_tiles));
+    return true;
+  }
+};
+
+template <>
+struct TiledTranspose<uint32> : TiledTransposeImpl<uint32, float> {};
+
+template <>
+struct TiledTranspose<uint64> : TiledTransposeImpl<uint64, double> {};
+
+#endif  // EIGEN_VECTORIZE
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
+    if (!conjugate && TiledTranspose<T>::Run(d, in, perm, out)) return;
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
@@ -13,9 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace {
@@ -149,6 +152,11 @@ class UniqueOp : public OpKernel {
       // to them as in the general case.
       auto Tin = input.flat<T>();
       const int64_t N = static_cast<int64_t>(Tin.size());
+      if (N >= kMinParallelSize &&
+          context->device()->tensorflow_cpu_worker_threads()->num_threads > 1) {
+        ParallelUnique(context, Tin, input.shape(), axis, idx_vec);
+        return;
+      }
 
       typename UniqueOpHashMap<T, TIndex>::map_type uniq;
       uniq.reserve(2 * N);
@@ -237,6 +245,161 @@ class UniqueOp : public OpKernel {
       }
     }
   }
+
+ private:
+  // Inputs at least this large are uniquified in parallel, if the intra-op
+  // thread pool has more than one thread.
+  static constexpr int64_t kMinParallelSize = 1 << 16;
+
+  // Computes the unique elements of a large vector on the intra-op threads,
+  // in the order of their first occurrence like the serial implementation:
+  // 1. Groups the positions of the elements by a hash of the element into one
+  //    partition per thread, keeping them in order within each partition.
+  // 2. Builds a map per partition in parallel, finding the first occurrence
+  //    and the partition-local id of each element.
+  // 3. Numbers the first occurrences with a parallel prefix sum, which gives
+  //    each unique element its output index.
+  // 4. Writes the unique elements, their counts and the output indices.
+  void ParallelUnique(OpKernelContext* context,
+                      typename TTypes<T>::ConstFlat Tin,
+                      const TensorShape& input_shape, int64_t axis,
+                      typename TTypes<TIndex>::Vec idx_vec) {
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    const int64_t N = static_cast<int64_t>(Tin.size());
+    const int num_tasks = worker_threads.num_threads;
+    const int64_t block_size = (N + num_tasks - 1) / num_tasks;
+    // Runs `fn(task)` for each task in [0, num_tasks) on its own thread.
+    auto run_tasks = [&worker_threads, num_tasks](
+                         const std::function<void(int64_t)>& fn) {
+      worker_threads.workers->ParallelFor(
+          num_tasks,
+          thread::ThreadPool::SchedulingParams(
+              thread::ThreadPool::SchedulingStrategy::kFixedBlockSize,
+              absl::nullopt, /*block_size=*/1),
+          [&fn](int64_t start, int64_t limit) {
+            for (int64_t task = start; task < limit; ++task) {
+              fn(task);
+            }
+          });
+    };
+    auto block_start = [block_size, N](int64_t block) {
+      return std::min(block * block_size, N);
+    };
+    // std::hash is the identity for integers, so the hash is mixed before
+    // taking it modulo the number of partitions.
+    auto partition_of = [num_tasks](const T& value) {
+      const uint64 h = hash<T>{}(value);
+      return static_cast<int32>(((h * 0x9E3779B97F4A7C15ULL) >> 32) %
+                                num_tasks);
+    };
+
+    // 1. Each block of the input counts its elements per partition, then
+    //    scatters their positions to its range of each partition.
+    std::vector<int32> partition(N);
+    std::vector<int64_t> offsets(num_tasks * num_tasks, 0);
+    run_tasks([&](int64_t block) {
+      int64_t* block_counts = &offsets[block * num_tasks];
+      for (int64_t i = block_start(block); i < block_start(block + 1); ++i) {
+        partition[i] = partition_of(Tin(i));
+        ++block_counts[partition[i]];
+      }
+    });
+    // The positions of partition p are preceded by those of partitions < p,
+    // and then by those of the earlier blocks in partition p.
+    std::vector<int64_t> partition_start(num_tasks + 1, 0);
+    int64_t offset = 0;
+    for (int p = 0; p < num_tasks; ++p) {
+      partition_start[p] = offset;
+      for (int block = 0; block < num_tasks; ++block) {
+        const int64_t count = offsets[block * num_tasks + p];
+        offsets[block * num_tasks + p] = offset;
+        offset += count;
+      }
+    }
+    partition_start[num_tasks] = N;
+    std::vector<int32> positions(N);
+    run_tasks([&](int64_t block) {
+      int64_t* block_offsets = &offsets[block * num_tasks];
+      for (int64_t i = block_start(block); i < block_start(block + 1); ++i) {
+        positions[block_offsets[partition[i]]++] = i;
+      }
+    });
+
+    // 2. Each partition finds its unique elements. `local_id` reuses the
+    //    storage of `partition`, which is no longer needed.
+    std::vector<int32>& local_id = partition;
+    std::vector<std::vector<int32>> first_positions(num_tasks);
+    std::vector<std::vector<TIndex>> counts(num_tasks);
+    std::vector<char> is_first(N, 0);
+    run_tasks([&](int64_t p) {
+      typename UniqueOpHashMap<T, int32>::map_type uniq;
+      uniq.reserve(2 * (partition_start[p + 1] - partition_start[p]));
+      for (int64_t k = partition_start[p]; k < partition_start[p + 1]; ++k) {
+        const int32 i = positions[k];
+        auto it = uniq.emplace(Tin(i), first_positions[p].size());
+        if (it.second) {
+          first_positions[p].push_back(i);
+          counts[p].push_back(0);
+          is_first[i] = 1;
+        }
+        local_id[i] = it.first->second;
+        ++counts[p][it.first->second];
+      }
+    });
+
+    // 3. Each block numbers its first occurrences, starting after those of
+    //    the earlier blocks.
+    std::vector<int64_t> block_firsts(num_tasks + 1, 0);
+    run_tasks([&](int64_t block) {
+      int64_t num_firsts = 0;
+      for (int64_t i = block_start(block); i < block_start(block + 1); ++i) {
+        num_firsts += is_first[i];
+      }
+      block_firsts[block + 1] = num_firsts;
+    });
+    for (int block = 0; block < num_tasks; ++block) {
+      block_firsts[block + 1] += block_firsts[block];
+    }
+    const int64_t uniq_size = block_firsts[num_tasks];
+    std::vector<int32> rank(N);
+    run_tasks([&](int64_t block) {
+      int32 r = block_firsts[block];
+      for (int64_t i = block_start(block); i < block_start(block + 1); ++i) {
+        if (is_first[i]) rank[i] = r++;
+      }
+    });
+
+    // 4. Each partition writes its unique elements and the indices of its
+    //    positions.
+    TensorShape output_shape(input_shape);
+    output_shape.set_dim(axis, uniq_size);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    auto Tout = output->flat<T>();
+    TIndex* count_output = nullptr;
+    if (num_outputs() > 2) {
+      Tensor* count_tensor = nullptr;
+      OP_REQUIRES_OK(context, context->allocate_output(
+                                  2, TensorShape({uniq_size}), &count_tensor));
+      count_output = count_tensor->flat<TIndex>().data();
+    }
+    run_tasks([&](int64_t p) {
+      std::vector<TIndex> output_index(first_positions[p].size());
+      for (int64_t u = 0; u < first_positions[p].size(); ++u) {
+        const int32 i = first_positions[p][u];
+        output_index[u] = rank[i];
+        Tout(rank[i]) = Tin(i);
+        if (count_output != nullptr) {
+          count_output[rank[i]] = counts[p][u];
+        }
+      }
+      for (int64_t k = partition_start[p]; k < partition_start[p + 1]; ++k) {
+        const int32 i = positions[k];
+        idx_vec(i) = output_index[local_id[i]];
+      }
+    });
+  }
 };
 
 #define REGISTER_UNIQUE(type)                                      \
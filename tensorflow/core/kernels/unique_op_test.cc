@@ -15,11 +15,16 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
@@ -37,6 +42,46 @@ namespace {
 
 const int kMaxStrLen = 40;
 
+class UniqueOpTest : public OpsTestBase {};
+
+TEST_F(UniqueOpTest, LargeInputKeepsFirstOccurrenceOrder) {
+  TF_ASSERT_OK(NodeDefBuilder("op", "UniqueWithCounts")
+                   .Input(FakeInput(DT_INT64))
+                   .Attr("out_idx", DT_INT32)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  // Large enough to be uniquified in parallel, with repeated elements
+  // spread over the whole input.
+  const int64_t kSize = 1 << 18;
+  std::vector<int64_t> input(kSize);
+  for (int64_t i = 0; i < kSize; ++i) {
+    input[i] = (i * 7919) % 1000 * 1000;
+  }
+  std::vector<int64_t> expected_y;
+  std::vector<int32> expected_idx(kSize);
+  std::vector<int32> expected_count;
+  std::unordered_map<int64_t, int32> seen;
+  for (int64_t i = 0; i < kSize; ++i) {
+    auto it = seen.emplace(input[i], expected_y.size());
+    if (it.second) {
+      expected_y.push_back(input[i]);
+      expected_count.push_back(0);
+    }
+    expected_idx[i] = it.first->second;
+    ++expected_count[it.first->second];
+  }
+
+  AddInputFromArray<int64_t>(TensorShape({kSize}), input);
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int64_t>(test::AsTensor<int64_t>(expected_y),
+                                   *GetOutput(0));
+  test::ExpectTensorEqual<int32>(test::AsTensor<int32>(expected_idx),
+                                 *GetOutput(1));
+  test::ExpectTensorEqual<int32>(test::AsTensor<int32>(expected_count),
+                                 *GetOutput(2));
+}
+
 TensorProto GetRandomInt32TensorProto(int dim, int max_int) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_INT32);
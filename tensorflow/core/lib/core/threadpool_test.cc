@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 
 #include <atomic>
+#include <memory>
+#include <string>
 
 #include "absl/synchronization/barrier.h"
 #include "absl/synchronization/blocking_counter.h"
@@ -63,6 +65,56 @@ TEST(ThreadPool, DoWork) {
   }
 }
 
+struct TestMetricsCounts {
+  std::atomic<int> num_pools{0};
+  std::atomic<int> queued{0};
+  std::atomic<int> started{0};
+  std::atomic<int> done{0};
+};
+
+TestMetricsCounts* GetTestMetricsCounts() {
+  static TestMetricsCounts* counts = new TestMetricsCounts;
+  return counts;
+}
+
+class TestMetrics : public ThreadPoolMetrics {
+ public:
+  void TaskQueued() override { ++GetTestMetricsCounts()->queued; }
+  void TaskStarted(uint64 queue_time_us) override {
+    ++GetTestMetricsCounts()->started;
+  }
+  void TaskDone(uint64 run_time_us) override {
+    ++GetTestMetricsCounts()->done;
+  }
+};
+
+std::unique_ptr<ThreadPoolMetrics> CreateTestMetrics(const std::string& name) {
+  if (name != "instrumented") return nullptr;
+  ++GetTestMetricsCounts()->num_pools;
+  return std::make_unique<TestMetrics>();
+}
+
+TEST(ThreadPool, Metrics) {
+  const int kWorkItems = 100;
+  SetThreadPoolMetricsFactory(&CreateTestMetrics);
+  {
+    ThreadPool pool(Env::Default(), "instrumented", 4);
+    ThreadPool uninstrumented_pool(Env::Default(), "test", 4);
+    for (int i = 0; i < kWorkItems; i++) {
+      pool.Schedule([]() {});
+      uninstrumented_pool.Schedule([]() {});
+    }
+  }
+  SetThreadPoolMetricsFactory(nullptr);
+  { ThreadPool pool(Env::Default(), "instrumented", 4); }
+
+  TestMetricsCounts* counts = GetTestMetricsCounts();
+  EXPECT_EQ(counts->num_pools, 1);
+  EXPECT_EQ(counts->queued, kWorkItems);
+  EXPECT_EQ(counts->started, kWorkItems);
+  EXPECT_EQ(counts->done, kWorkItems);
+}
+
 void RunWithFixedBlockSize(int64_t block_size, int64_t total,
                            ThreadPool* threads) {
   mutex mu;
@@ -0,0 +1,209 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/block_compressed_inputstream.h"
+
+#include <algorithm>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+
+namespace tensorflow {
+namespace io {
+
+BlockCompressedInputStream::BlockCompressedInputStream(
+    InputStreamInterface* input_stream, bool owns_input_stream,
+    int num_outstanding_blocks, thread::ThreadPool* thread_pool)
+    : input_stream_(input_stream),
+      owns_input_stream_(owns_input_stream),
+      // Without a thread pool there is nothing to gain from reading ahead.
+      num_outstanding_blocks_(
+          thread_pool != nullptr ? std::max(num_outstanding_blocks, 1) : 1),
+      thread_pool_(thread_pool) {}
+
+BlockCompressedInputStream::~BlockCompressedInputStream() {
+  CancelPending();
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+void BlockCompressedInputStream::CancelPending() {
+  for (const auto& block : pending_) {
+    block->done.WaitForNotification();
+  }
+  pending_.clear();
+}
+
+Status BlockCompressedInputStream::ReadFrame(uint64 skip_limit,
+                                             uint64* skipped) {
+  tstring header;
+  Status s =
+      input_stream_->ReadNBytes(block_compression::kFrameHeaderSize, &header);
+  if (errors::IsOutOfRange(s)) {
+    if (!header.empty()) {
+      return errors::DataLoss("truncated block header at ",
+                              input_stream_->Tell());
+    }
+    // Files that were flushed but not closed end without an index.
+    eof_ = true;
+    return Status::OK();
+  }
+  TF_RETURN_IF_ERROR(s);
+
+  uint8 type;
+  uint64 length, uncompressed_length;
+  TF_RETURN_IF_ERROR(block_compression::DecodeFrameHeader(
+      header.data(), &type, &length, &uncompressed_length));
+  if (type == block_compression::kIndexFrameType) {
+    eof_ = true;
+    return Status::OK();
+  }
+
+  if (uncompressed_length <= skip_limit) {
+    // The data of skipped blocks is neither read nor verified.
+    s = input_stream_->SkipNBytes(length + block_compression::kFrameFooterSize);
+    if (errors::IsOutOfRange(s)) {
+      return errors::DataLoss("truncated block");
+    }
+    TF_RETURN_IF_ERROR(s);
+    *skipped += uncompressed_length;
+    return Status::OK();
+  }
+
+  auto block = absl::make_unique<PendingBlock>();
+  block->codec = type;
+  s = input_stream_->ReadNBytes(length + block_compression::kFrameFooterSize,
+                                &block->compressed);
+  if (errors::IsOutOfRange(s)) {
+    return errors::DataLoss("truncated block");
+  }
+  TF_RETURN_IF_ERROR(s);
+  const uint32 masked_crc =
+      core::DecodeFixed32(block->compressed.data() + length);
+  if (crc32c::Unmask(masked_crc) !=
+      crc32c::Value(block->compressed.data(), length)) {
+    return errors::DataLoss("corrupted block");
+  }
+  block->data.resize(uncompressed_length);
+
+  PendingBlock* pending_block = block.get();
+  pending_.push_back(std::move(block));
+  auto uncompress = [pending_block, length]() {
+    pending_block->status = block_compression::UncompressBlock(
+        pending_block->codec,
+        StringPiece(pending_block->compressed.data(), length),
+        pending_block->data.size(), &pending_block->data[0]);
+    pending_block->compressed.clear();
+    pending_block->done.Notify();
+  };
+  if (thread_pool_ != nullptr) {
+    thread_pool_->Schedule(std::move(uncompress));
+  } else {
+    uncompress();
+  }
+  return Status::OK();
+}
+
+Status BlockCompressedInputStream::FillPending() {
+  while (!eof_ &&
+         static_cast<int>(pending_.size()) < num_outstanding_blocks_) {
+    uint64 skipped = 0;
+    TF_RETURN_IF_ERROR(ReadFrame(/*skip_limit=*/0, &skipped));
+  }
+  return Status::OK();
+}
+
+Status BlockCompressedInputStream::NextBlock() {
+  TF_RETURN_IF_ERROR(FillPending());
+  if (pending_.empty()) {
+    return errors::OutOfRange("eof");
+  }
+  std::unique_ptr<PendingBlock> block = std::move(pending_.front());
+  pending_.pop_front();
+  block->done.WaitForNotification();
+  TF_RETURN_IF_ERROR(block->status);
+  block_ = std::move(block->data);
+  pos_ = 0;
+  return Status::OK();
+}
+
+Status BlockCompressedInputStream::ReadNBytes(int64_t bytes_to_read,
+                                              tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->clear();
+  while (static_cast<int64_t>(result->size()) < bytes_to_read) {
+    if (pos_ == block_.size()) {
+      Status s = NextBlock();
+      if (errors::IsOutOfRange(s)) {
+        return errors::OutOfRange("reached end of file");
+      }
+      TF_RETURN_IF_ERROR(s);
+      continue;
+    }
+    const size_t n = std::min<size_t>(bytes_to_read - result->size(),
+                                      block_.size() - pos_);
+    result->append(block_.data() + pos_, n);
+    pos_ += n;
+    bytes_read_ += n;
+  }
+  return Status::OK();
+}
+
+Status BlockCompressedInputStream::SkipNBytes(int64_t bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can't skip a negative number of bytes: ",
+                                   bytes_to_skip);
+  }
+  while (bytes_to_skip > 0) {
+    if (pos_ < block_.size()) {
+      const size_t n = std::min<size_t>(bytes_to_skip, block_.size() - pos_);
+      pos_ += n;
+      bytes_read_ += n;
+      bytes_to_skip -= n;
+    } else if (pending_.empty() && !eof_) {
+      uint64 skipped = 0;
+      TF_RETURN_IF_ERROR(ReadFrame(bytes_to_skip, &skipped));
+      bytes_read_ += skipped;
+      bytes_to_skip -= skipped;
+    } else {
+      Status s = NextBlock();
+      if (errors::IsOutOfRange(s)) {
+        return errors::OutOfRange("reached end of file");
+      }
+      TF_RETURN_IF_ERROR(s);
+    }
+  }
+  return Status::OK();
+}
+
+int64_t BlockCompressedInputStream::Tell() const { return bytes_read_; }
+
+Status BlockCompressedInputStream::Reset() {
+  CancelPending();
+  eof_ = false;
+  block_.clear();
+  pos_ = 0;
+  bytes_read_ = 0;
+  return input_stream_->Reset();
+}
+
+}  // namespace io
+}  // namespace tensorflow
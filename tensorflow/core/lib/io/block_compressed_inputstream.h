@@ -0,0 +1,113 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_BLOCK_COMPRESSED_INPUTSTREAM_H_
+#define TENSORFLOW_CORE_LIB_IO_BLOCK_COMPRESSED_INPUTSTREAM_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/lib/io/block_compression_options.h"
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// An InputStream that reads the uncompressed data of a block compressed
+// file, see block_compression_options.h for the format.
+//
+// Skipping past whole blocks only reads their headers, so seeking costs one
+// small read per skipped block instead of decompressing everything before the
+// target. If `thread_pool` is set, up to `num_outstanding_blocks` blocks
+// ahead of the current one are decompressed on it in parallel.
+//
+// A given instance of a BlockCompressedInputStream is NOT safe for concurrent
+// use by multiple threads.
+class BlockCompressedInputStream : public InputStreamInterface {
+ public:
+  // Creates a BlockCompressedInputStream for `input_stream`, which must be
+  // positioned at the start of the file. If `owns_input_stream`, the input
+  // stream is deleted with this stream. `thread_pool` is not owned and must
+  // outlive this stream.
+  BlockCompressedInputStream(InputStreamInterface* input_stream,
+                             bool owns_input_stream,
+                             int num_outstanding_blocks = 0,
+                             thread::ThreadPool* thread_pool = nullptr);
+
+  ~BlockCompressedInputStream() override;
+
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+  Status SkipNBytes(int64_t bytes_to_skip) override;
+
+  int64_t Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  // A block read from the input stream, decompressed inline or on the thread
+  // pool.
+  struct PendingBlock {
+    uint8 codec;
+    tstring compressed;
+    string data;
+    Status status;
+    Notification done;
+  };
+
+  // Reads the next frame. Data frames of at most `skip_limit` uncompressed
+  // bytes are skipped without reading their data and their size is added to
+  // `*skipped`; other data frames are added to `pending_`. Sets `eof_` at the
+  // index frame or the end of the input.
+  Status ReadFrame(uint64 skip_limit, uint64* skipped);
+
+  // Reads frames until `pending_` has `num_outstanding_blocks_` blocks or the
+  // end of the file is reached.
+  Status FillPending();
+
+  // Makes the first pending block the current block. Returns OUT_OF_RANGE at
+  // the end of the file.
+  Status NextBlock();
+
+  // Waits for all the pending blocks, so that none refer to this stream.
+  void CancelPending();
+
+  InputStreamInterface* input_stream_;
+  const bool owns_input_stream_;
+  const int num_outstanding_blocks_;
+  thread::ThreadPool* const thread_pool_;  // Not owned.
+
+  std::deque<std::unique_ptr<PendingBlock>> pending_;
+  bool eof_ = false;
+
+  // The current block and the position in it.
+  string block_;
+  size_t pos_ = 0;
+
+  // The uncompressed position of the stream.
+  int64_t bytes_read_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BlockCompressedInputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_BLOCK_COMPRESSED_INPUTSTREAM_H_
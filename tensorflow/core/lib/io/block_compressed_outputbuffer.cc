@@ -0,0 +1,183 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/block_compressed_outputbuffer.h"
+
+#include "absl/memory/memory.h"
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace io {
+
+BlockCompressedOutputBuffer::BlockCompressedOutputBuffer(
+    WritableFile* file, const BlockCompressionOptions& options,
+    int num_outstanding_blocks, thread::ThreadPool* thread_pool)
+    : file_(file),
+      options_(options),
+      num_outstanding_blocks_(num_outstanding_blocks),
+      thread_pool_(num_outstanding_blocks > 0 ? thread_pool : nullptr) {}
+
+BlockCompressedOutputBuffer::~BlockCompressedOutputBuffer() {
+  // Pending blocks refer to this buffer's options.
+  for (const auto& block : pending_) {
+    block->done.WaitForNotification();
+  }
+  if (!closed_ && (!block_.empty() || !pending_.empty())) {
+    LOG(WARNING) << "BlockCompressedOutputBuffer::Close() not called. "
+                 << "Possible data loss";
+  }
+}
+
+Status BlockCompressedOutputBuffer::Append(StringPiece data) {
+  if (closed_) {
+    return errors::FailedPrecondition("Append() called after Close()");
+  }
+  block_.append(data.data(), data.size());
+  return Status::OK();
+}
+
+Status BlockCompressedOutputBuffer::EndRecord() {
+  ++block_records_;
+  if (static_cast<int64_t>(block_.size()) >= options_.block_size) {
+    return FinishBlock();
+  }
+  return Status::OK();
+}
+
+Status BlockCompressedOutputBuffer::FinishBlock() {
+  if (block_.empty()) return Status::OK();
+  if (thread_pool_ == nullptr) {
+    TF_RETURN_IF_ERROR(
+        block_compression::CompressBlock(options_, block_, &compressed_));
+
+    block_compression::BlockHandle handle;
+    handle.offset = file_offset_;
+    handle.uncompressed_offset = uncompressed_offset_;
+    handle.num_records = block_records_;
+    TF_RETURN_IF_ERROR(WriteFrame(options_.codec, compressed_, block_.size()));
+    index_.push_back(handle);
+
+    uncompressed_offset_ += block_.size();
+    block_.clear();
+    block_records_ = 0;
+    return Status::OK();
+  }
+
+  // Bound the memory held by the pending blocks.
+  while (static_cast<int>(pending_.size()) >= num_outstanding_blocks_) {
+    TF_RETURN_IF_ERROR(WritePendingBlock());
+  }
+  auto block = absl::make_unique<PendingBlock>();
+  block->data.swap(block_);
+  block->num_records = block_records_;
+  block_records_ = 0;
+  PendingBlock* pending_block = block.get();
+  pending_.push_back(std::move(block));
+  thread_pool_->Schedule([this, pending_block]() {
+    pending_block->status = block_compression::CompressBlock(
+        options_, pending_block->data, &pending_block->compressed);
+    pending_block->done.Notify();
+  });
+  return Status::OK();
+}
+
+Status BlockCompressedOutputBuffer::WritePendingBlock() {
+  std::unique_ptr<PendingBlock> block = std::move(pending_.front());
+  pending_.pop_front();
+  block->done.WaitForNotification();
+  TF_RETURN_IF_ERROR(block->status);
+
+  block_compression::BlockHandle handle;
+  handle.offset = file_offset_;
+  handle.uncompressed_offset = uncompressed_offset_;
+  handle.num_records = block->num_records;
+  TF_RETURN_IF_ERROR(
+      WriteFrame(options_.codec, block->compressed, block->data.size()));
+  index_.push_back(handle);
+  uncompressed_offset_ += block->data.size();
+  return Status::OK();
+}
+
+Status BlockCompressedOutputBuffer::WriteAllBlocks() {
+  TF_RETURN_IF_ERROR(FinishBlock());
+  while (!pending_.empty()) {
+    TF_RETURN_IF_ERROR(WritePendingBlock());
+  }
+  return Status::OK();
+}
+
+Status BlockCompressedOutputBuffer::WriteFrame(uint8 type, StringPiece data,
+                                               uint64 uncompressed_length) {
+  char header[block_compression::kFrameHeaderSize];
+  char footer[block_compression::kFrameFooterSize];
+  block_compression::EncodeFrameHeader(type, data.size(), uncompressed_length,
+                                       header);
+  core::EncodeFixed32(footer,
+                      crc32c::Mask(crc32c::Value(data.data(), data.size())));
+  TF_RETURN_IF_ERROR(file_->Append(StringPiece(header, sizeof(header))));
+  TF_RETURN_IF_ERROR(file_->Append(data));
+  TF_RETURN_IF_ERROR(file_->Append(StringPiece(footer, sizeof(footer))));
+  file_offset_ += sizeof(header) + data.size() + sizeof(footer);
+  return Status::OK();
+}
+
+Status BlockCompressedOutputBuffer::Flush() {
+  TF_RETURN_IF_ERROR(WriteAllBlocks());
+  return file_->Flush();
+}
+
+Status BlockCompressedOutputBuffer::Close() {
+  if (closed_) return Status::OK();
+  TF_RETURN_IF_ERROR(WriteAllBlocks());
+
+  string index;
+  index.reserve(index_.size() * 3 * sizeof(uint64));
+  for (const auto& handle : index_) {
+    core::PutFixed64(&index, handle.offset);
+    core::PutFixed64(&index, handle.uncompressed_offset);
+    core::PutFixed64(&index, handle.num_records);
+  }
+  const uint64 index_offset = file_offset_;
+  TF_RETURN_IF_ERROR(
+      WriteFrame(block_compression::kIndexFrameType, index, index.size()));
+
+  string trailer;
+  core::PutFixed64(&trailer, index_offset);
+  core::PutFixed64(&trailer, block_compression::kBlockCompressionMagic);
+  TF_RETURN_IF_ERROR(file_->Append(trailer));
+  file_offset_ += trailer.size();
+  closed_ = true;
+  return file_->Flush();
+}
+
+Status BlockCompressedOutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status BlockCompressedOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(WriteAllBlocks());
+  return file_->Sync();
+}
+
+Status BlockCompressedOutputBuffer::Tell(int64_t* position) {
+  return file_->Tell(position);
+}
+
+}  // namespace io
+}  // namespace tensorflow
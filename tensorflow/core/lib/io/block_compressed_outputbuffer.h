@@ -0,0 +1,130 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_BLOCK_COMPRESSED_OUTPUTBUFFER_H_
+#define TENSORFLOW_CORE_LIB_IO_BLOCK_COMPRESSED_OUTPUTBUFFER_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/io/block_compression_options.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// Writes a block compressed file, see block_compression_options.h for the
+// format.
+//
+// Appended data is buffered until the caller marks a record boundary with
+// EndRecord() and the buffer holds at least `options.block_size` bytes; then
+// the buffer is compressed and written as one block. If `thread_pool` is set,
+// up to `num_outstanding_blocks` finished blocks are compressed on it in
+// parallel while more data is appended, and are written in order.
+//
+// A given instance of a BlockCompressedOutputBuffer is NOT safe for concurrent
+// use by multiple threads.
+class BlockCompressedOutputBuffer : public WritableFile {
+ public:
+  // Does not take ownership of `file`, which must be initially empty.
+  // `thread_pool` is not owned and must outlive this buffer.
+  BlockCompressedOutputBuffer(WritableFile* file,
+                              const BlockCompressionOptions& options,
+                              int num_outstanding_blocks = 0,
+                              thread::ThreadPool* thread_pool = nullptr);
+
+  ~BlockCompressedOutputBuffer() override;
+
+  Status Append(StringPiece data) override;
+
+  // Marks the end of a record: finishes the current block if it is full.
+  Status EndRecord();
+
+  // Finishes the current block, even if it is not full, and flushes the file.
+  Status Flush() override;
+
+  // Finishes the current block and writes the block index. This must be
+  // called before the destructor to avoid any data loss. Does not close the
+  // underlying file.
+  Status Close() override;
+
+  Status Name(StringPiece* result) const override;
+
+  // Finishes the current block and syncs the file.
+  Status Sync() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect the data of unfinished or pending blocks.
+  Status Tell(int64_t* position) override;
+
+ private:
+  // A finished block, compressed inline or on the thread pool.
+  struct PendingBlock {
+    string data;
+    uint64 num_records;
+    string compressed;
+    Status status;
+    Notification done;
+  };
+
+  // Compresses the buffered data, if any, and writes it as a block, or
+  // schedules its compression if there is a thread pool.
+  Status FinishBlock();
+
+  // Writes the oldest pending block once it is compressed.
+  Status WritePendingBlock();
+
+  // Finishes the current block and writes all the pending blocks.
+  Status WriteAllBlocks();
+
+  // Writes a frame of `type` holding `data`.
+  Status WriteFrame(uint8 type, StringPiece data, uint64 uncompressed_length);
+
+  WritableFile* file_;  // Not owned
+  const BlockCompressionOptions options_;
+  const int num_outstanding_blocks_;
+  thread::ThreadPool* const thread_pool_;  // Not owned.
+  bool closed_ = false;
+
+  // The uncompressed data of the current block.
+  string block_;
+  // The number of records that ended in the current block.
+  uint64 block_records_ = 0;
+  // Reused buffer for the compressed data.
+  string compressed_;
+  // Finished blocks that are not written yet, oldest first.
+  std::deque<std::unique_ptr<PendingBlock>> pending_;
+
+  // The number of bytes written to `file_`, and of uncompressed bytes in
+  // finished blocks.
+  uint64 file_offset_ = 0;
+  uint64 uncompressed_offset_ = 0;
+  std::vector<block_compression::BlockHandle> index_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BlockCompressedOutputBuffer);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_BLOCK_COMPRESSED_OUTPUTBUFFER_H_
@@ -0,0 +1,165 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/block_compression_options.h"
+
+#include <zlib.h>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/snappy.h"
+
+namespace tensorflow {
+namespace io {
+namespace block_compression {
+
+namespace {
+constexpr size_t kCrcOffset = sizeof(uint8) + 2 * sizeof(uint64);
+constexpr size_t kBlockHandleSize = 3 * sizeof(uint64);
+}  // namespace
+
+void EncodeFrameHeader(uint8 type, uint64 length, uint64 uncompressed_length,
+                       char* header) {
+  header[0] = static_cast<char>(type);
+  core::EncodeFixed64(header + sizeof(uint8), length);
+  core::EncodeFixed64(header + sizeof(uint8) + sizeof(uint64),
+                      uncompressed_length);
+  core::EncodeFixed32(header + kCrcOffset,
+                      crc32c::Mask(crc32c::Value(header, kCrcOffset)));
+}
+
+Status DecodeFrameHeader(const char* header, uint8* type, uint64* length,
+                         uint64* uncompressed_length) {
+  const uint32 masked_crc = core::DecodeFixed32(header + kCrcOffset);
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(header, kCrcOffset)) {
+    return errors::DataLoss("corrupted block header");
+  }
+  *type = static_cast<uint8>(header[0]);
+  *length = core::DecodeFixed64(header + sizeof(uint8));
+  *uncompressed_length =
+      core::DecodeFixed64(header + sizeof(uint8) + sizeof(uint64));
+  return Status::OK();
+}
+
+Status CompressBlock(const BlockCompressionOptions& options, StringPiece input,
+                     string* output) {
+  switch (options.codec) {
+    case BlockCompressionOptions::SNAPPY:
+      if (!port::Snappy_Compress(input.data(), input.size(), output)) {
+        return errors::Unimplemented("Snappy compression is not available");
+      }
+      return Status::OK();
+    case BlockCompressionOptions::ZLIB: {
+      uLongf length = compressBound(input.size());
+      output->resize(length);
+      const int error =
+          compress2(reinterpret_cast<Bytef*>(&(*output)[0]), &length,
+                    reinterpret_cast<const Bytef*>(input.data()), input.size(),
+                    options.zlib_compression_level);
+      if (error != Z_OK) {
+        return errors::Internal("zlib compression failed with error ", error);
+      }
+      output->resize(length);
+      return Status::OK();
+    }
+  }
+  return errors::InvalidArgument("Unknown block compression codec: ",
+                                 static_cast<int>(options.codec));
+}
+
+Status UncompressBlock(uint8 codec, StringPiece input,
+                       size_t uncompressed_length, char* output) {
+  switch (codec) {
+    case BlockCompressionOptions::SNAPPY: {
+      size_t length;
+      if (!port::Snappy_GetUncompressedLength(input.data(), input.size(),
+                                              &length) ||
+          length != uncompressed_length ||
+          !port::Snappy_Uncompress(input.data(), input.size(), output)) {
+        return errors::DataLoss("corrupted snappy block");
+      }
+      return Status::OK();
+    }
+    case BlockCompressionOptions::ZLIB: {
+      uLongf length = uncompressed_length;
+      const int error = uncompress(
+          reinterpret_cast<Bytef*>(output), &length,
+          reinterpret_cast<const Bytef*>(input.data()), input.size());
+      if (error != Z_OK || length != uncompressed_length) {
+        return errors::DataLoss("corrupted zlib block, error ", error);
+      }
+      return Status::OK();
+    }
+  }
+  return errors::DataLoss("unknown block compression codec: ",
+                          static_cast<int>(codec));
+}
+
+Status ReadBlockIndex(RandomAccessFile* file, uint64 file_size,
+                      std::vector<BlockHandle>* index) {
+  if (file_size < kTrailerSize + kFrameHeaderSize + kFrameFooterSize) {
+    return errors::DataLoss("file of ", file_size,
+                            " bytes is too small to have a block index");
+  }
+  char trailer[kTrailerSize];
+  StringPiece result;
+  TF_RETURN_IF_ERROR(
+      file->Read(file_size - kTrailerSize, kTrailerSize, &result, trailer));
+  if (core::DecodeFixed64(result.data() + sizeof(uint64)) !=
+      kBlockCompressionMagic) {
+    return errors::DataLoss("missing block index, the file was not closed");
+  }
+  const uint64 index_offset = core::DecodeFixed64(result.data());
+  if (index_offset + kFrameHeaderSize + kFrameFooterSize + kTrailerSize >
+      file_size) {
+    return errors::DataLoss("bad block index offset ", index_offset);
+  }
+
+  // The index frame spans everything up to the trailer.
+  const size_t frame_size = file_size - kTrailerSize - index_offset;
+  string frame(frame_size, '\0');
+  TF_RETURN_IF_ERROR(file->Read(index_offset, frame_size, &result, &frame[0]));
+  uint8 type;
+  uint64 length, uncompressed_length;
+  TF_RETURN_IF_ERROR(
+      DecodeFrameHeader(result.data(), &type, &length, &uncompressed_length));
+  if (type != kIndexFrameType ||
+      length != frame_size - kFrameHeaderSize - kFrameFooterSize ||
+      length % kBlockHandleSize != 0) {
+    return errors::DataLoss("corrupted block index");
+  }
+  const char* data = result.data() + kFrameHeaderSize;
+  const uint32 masked_crc = core::DecodeFixed32(data + length);
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(data, length)) {
+    return errors::DataLoss("corrupted block index");
+  }
+
+  index->clear();
+  index->reserve(length / kBlockHandleSize);
+  for (size_t i = 0; i < length; i += kBlockHandleSize) {
+    BlockHandle handle;
+    handle.offset = core::DecodeFixed64(data + i);
+    handle.uncompressed_offset = core::DecodeFixed64(data + i + 8);
+    handle.num_records = core::DecodeFixed64(data + i + 16);
+    index->push_back(handle);
+  }
+  return Status::OK();
+}
+
+}  // namespace block_compression
+}  // namespace io
+}  // namespace tensorflow
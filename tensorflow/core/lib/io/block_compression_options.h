@@ -0,0 +1,115 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_BLOCK_COMPRESSION_OPTIONS_H_
+#define TENSORFLOW_CORE_LIB_IO_BLOCK_COMPRESSION_OPTIONS_H_
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class RandomAccessFile;
+
+namespace io {
+
+// Block compressed files are a sequence of independently compressed blocks,
+// so that they can be decompressed in parallel and skipped through without
+// decompressing the skipped blocks. Record writers only finish a block after
+// a whole record, so each block also holds whole records.
+//
+// Format of a block compressed file:
+//  frame     data frames[num_blocks]
+//  frame     index frame
+//  fixed64   offset of the index frame
+//  fixed64   kBlockCompressionMagic
+//
+// Format of a single frame:
+//  uint8     type: a BlockCompressionOptions::Codec, or kIndexFrameType
+//  fixed64   length of data
+//  fixed64   uncompressed length of data
+//  uint32    masked crc of the 17 bytes above
+//  byte      data[length]
+//  uint32    masked crc of data
+//
+// The data of the index frame is not compressed and holds one BlockHandle,
+// as three fixed64, per data frame.
+struct BlockCompressionOptions {
+  enum Codec : uint8 {
+    SNAPPY = 1,
+    ZLIB = 2,
+  };
+  Codec codec = SNAPPY;
+
+  // A block is finished with the first record that makes it hold at least
+  // this many uncompressed bytes. Larger blocks compress better, smaller ones
+  // allow more parallelism and skip with a finer granularity.
+  int64_t block_size = 256 << 10;
+
+  // The zlib compression level of ZLIB blocks, Z_DEFAULT_COMPRESSION (-1) or
+  // between 0 and 9.
+  int zlib_compression_level = -1;
+};
+
+namespace block_compression {
+
+constexpr uint8 kIndexFrameType = 0xff;
+constexpr size_t kFrameHeaderSize = sizeof(uint8) + 2 * sizeof(uint64) +
+                                    sizeof(uint32);
+constexpr size_t kFrameFooterSize = sizeof(uint32);
+constexpr size_t kTrailerSize = 2 * sizeof(uint64);
+// "tfrblock" in little-endian.
+constexpr uint64 kBlockCompressionMagic = 0x6b636f6c62726674ull;
+
+// The location of a data frame in a block compressed file.
+struct BlockHandle {
+  // Offset of the frame in the file.
+  uint64 offset = 0;
+  // Offset of the block's first byte in the uncompressed stream.
+  uint64 uncompressed_offset = 0;
+  // Number of records that end in the block.
+  uint64 num_records = 0;
+};
+
+// Populates the frame header in "header[0,kFrameHeaderSize-1]".
+void EncodeFrameHeader(uint8 type, uint64 length, uint64 uncompressed_length,
+                       char* header);
+
+// Parses and verifies the frame header in "header[0,kFrameHeaderSize-1]".
+Status DecodeFrameHeader(const char* header, uint8* type, uint64* length,
+                         uint64* uncompressed_length);
+
+// Compresses `input` with the codec of `options` into `*output`.
+Status CompressBlock(const BlockCompressionOptions& options, StringPiece input,
+                     string* output);
+
+// Uncompresses `input`, compressed with `codec`, into
+// "output[0,uncompressed_length-1]".
+Status UncompressBlock(uint8 codec, StringPiece input,
+                       size_t uncompressed_length, char* output);
+
+// Reads the block index of the block compressed `file` of `file_size` bytes,
+// so that readers can find the block holding any uncompressed offset.
+Status ReadBlockIndex(RandomAccessFile* file, uint64 file_size,
+                      std::vector<BlockHandle>* index);
+
+}  // namespace block_compression
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_BLOCK_COMPRESSION_OPTIONS_H_
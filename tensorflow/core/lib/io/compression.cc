@@ -23,6 +23,8 @@ const char kNone[] = "";
 const char kGzip[] = "GZIP";
 const char kSnappy[] = "SNAPPY";
 const char kZlib[] = "ZLIB";
+const char kSnappyBlock[] = "SNAPPY_BLOCK";
+const char kZlibBlock[] = "ZLIB_BLOCK";
 
 }  // namespace compression
 }  // namespace io
@@ -24,6 +24,9 @@ extern const char kNone[];
 extern const char kGzip[];
 extern const char kSnappy[];
 extern const char kZlib[];
+// Block compressed files, see block_compression_options.h.
+extern const char kSnappyBlock[];
+extern const char kZlibBlock[];
 
 }  // namespace compression
 }  // namespace io
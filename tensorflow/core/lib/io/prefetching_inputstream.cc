@@ -0,0 +1,196 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/prefetching_inputstream.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace io {
+
+PrefetchingInputStream::PrefetchingInputStream(RandomAccessFile* file,
+                                               int64_t chunk_size,
+                                               int num_outstanding_reads,
+                                               thread::ThreadPool* thread_pool)
+    : file_(file),
+      chunk_size_(chunk_size),
+      num_outstanding_reads_(std::max(num_outstanding_reads, 1)),
+      thread_pool_(thread_pool) {}
+
+PrefetchingInputStream::~PrefetchingInputStream() {
+  mutex_lock l(mu_);
+  chunks_.clear();
+  while (num_pending_reads_ > 0) {
+    cond_var_.wait(l);
+  }
+}
+
+void PrefetchingInputStream::ScheduleReads() {
+  while (!end_of_file_ &&
+         chunks_.size() < static_cast<size_t>(num_outstanding_reads_)) {
+    auto chunk = std::make_shared<Chunk>(next_offset_);
+    next_offset_ += chunk_size_;
+    chunks_.push_back(chunk);
+    ++num_pending_reads_;
+    thread_pool_->Schedule([this, chunk]() {
+      core::RefCountPtr<ChunkData> data(new ChunkData);
+      tstring& bytes = data->bytes;
+      bytes.resize_uninitialized(chunk_size_);
+      StringPiece result;
+      Status s = file_->Read(chunk->offset, chunk_size_, &result, &bytes[0]);
+      if (result.data() != bytes.data()) {
+        memmove(&bytes[0], result.data(), result.size());
+      }
+      bytes.resize(result.size());
+      // A short read marks the end of the file, which the reader detects
+      // from the size of the chunk.
+      if (errors::IsOutOfRange(s)) s = Status::OK();
+      mutex_lock l(mu_);
+      chunk->data = std::move(data);
+      chunk->status = s;
+      chunk->done = true;
+      --num_pending_reads_;
+      cond_var_.notify_all();
+    });
+  }
+}
+
+Status PrefetchingInputStream::WaitForChunk(const Chunk& chunk,
+                                            mutex_lock& l) {
+  while (!chunk.done) {
+    cond_var_.wait(l);
+  }
+  TF_RETURN_IF_ERROR(chunk.status);
+  if (static_cast<int64_t>(chunk.bytes().size()) < chunk_size_) {
+    // Nothing can follow a short chunk, so discard the reads after it.
+    end_of_file_ = true;
+    chunks_.resize(1);
+  }
+  return Status::OK();
+}
+
+void PrefetchingInputStream::RestartAt(int64_t offset) {
+  chunks_.clear();
+  pos_ = offset;
+  next_offset_ = offset;
+  end_of_file_ = false;
+}
+
+Status PrefetchingInputStream::ReadNBytes(int64_t bytes_to_read,
+                                          tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Cannot read negative number of bytes");
+  }
+  result->clear();
+  result->reserve(bytes_to_read);
+  mutex_lock l(mu_);
+  while (static_cast<int64_t>(result->size()) < bytes_to_read) {
+    ScheduleReads();
+    if (chunks_.empty()) {
+      return errors::OutOfRange("reached end of file");
+    }
+    std::shared_ptr<Chunk> chunk = chunks_.front();
+    TF_RETURN_IF_ERROR(WaitForChunk(*chunk, l));
+    if (pos_ < chunk->end()) {
+      const int64_t n = std::min<int64_t>(bytes_to_read - result->size(),
+                                          chunk->end() - pos_);
+      result->append(chunk->bytes().data() + (pos_ - chunk->offset), n);
+      pos_ += n;
+    }
+    if (pos_ >= chunk->end()) {
+      chunks_.pop_front();
+    }
+  }
+  return Status::OK();
+}
+
+Status PrefetchingInputStream::ReadNBytesView(
+    int64_t bytes_to_read, tstring* result,
+    core::RefCountPtr<core::RefCounted>* buffer) {
+  buffer->reset();
+  if (bytes_to_read > 0 && bytes_to_read * kMaxViewOverhead >= chunk_size_) {
+    mutex_lock l(mu_);
+    ScheduleReads();
+    if (!chunks_.empty()) {
+      std::shared_ptr<Chunk> chunk = chunks_.front();
+      TF_RETURN_IF_ERROR(WaitForChunk(*chunk, l));
+      if (pos_ + bytes_to_read <= chunk->end()) {
+        result->assign_as_view(chunk->bytes().data() + (pos_ - chunk->offset),
+                               bytes_to_read);
+        chunk->data->Ref();
+        buffer->reset(chunk->data.get());
+        pos_ += bytes_to_read;
+        if (pos_ == chunk->end()) {
+          chunks_.pop_front();
+        }
+        return Status::OK();
+      }
+    }
+  }
+  return ReadNBytes(bytes_to_read, result);
+}
+
+Status PrefetchingInputStream::SkipNBytes(int64_t bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can't skip a negative number of bytes");
+  }
+  if (bytes_to_skip == 0) {
+    return Status::OK();
+  }
+  {
+    mutex_lock l(mu_);
+    const int64_t start = pos_;
+    const int64_t target = pos_ + bytes_to_skip;
+    // Keep the chunk that contains the last skipped byte, which tells us
+    // whether the file extends to `target`.
+    while (!chunks_.empty() &&
+           chunks_.front()->offset + chunk_size_ < target) {
+      chunks_.pop_front();
+    }
+    if (chunks_.empty()) {
+      RestartAt(target - 1);
+    }
+    ScheduleReads();
+    if (!chunks_.empty()) {
+      std::shared_ptr<Chunk> chunk = chunks_.front();
+      TF_RETURN_IF_ERROR(WaitForChunk(*chunk, l));
+      if (chunk->end() >= target) {
+        pos_ = target;
+        return Status::OK();
+      }
+    }
+    // The file ends before `target`. Read through the remainder from the
+    // original position, so that `Tell()` returns the length of the file.
+    RestartAt(start);
+  }
+  return InputStreamInterface::SkipNBytes(bytes_to_skip);
+}
+
+int64_t PrefetchingInputStream::Tell() const {
+  mutex_lock l(mu_);
+  return pos_;
+}
+
+Status PrefetchingInputStream::Reset() {
+  mutex_lock l(mu_);
+  RestartAt(0);
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
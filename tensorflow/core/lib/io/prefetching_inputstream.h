@@ -0,0 +1,128 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_PREFETCHING_INPUTSTREAM_H_
+#define TENSORFLOW_CORE_LIB_IO_PREFETCHING_INPUTSTREAM_H_
+
+#include <deque>
+#include <memory>
+
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace io {
+
+// Wraps a RandomAccessFile in an InputStreamInterface that keeps up to
+// `num_outstanding_reads` reads of `chunk_size` bytes ahead of the current
+// position in flight on `thread_pool`, so that the latency of a single read
+// is hidden when the file is consumed sequentially.
+//
+// Skipping within the prefetched range is cheap; skipping beyond it discards
+// the outstanding reads and restarts prefetching at the new position.
+//
+// A given instance of PrefetchingInputStream is NOT safe for concurrent use by
+// multiple threads.
+class PrefetchingInputStream : public InputStreamInterface {
+ public:
+  // Does not take ownership of `file` or `thread_pool`, which must outlive
+  // *this. `file` must be safe for concurrent reads.
+  PrefetchingInputStream(RandomAccessFile* file, int64_t chunk_size,
+                         int num_outstanding_reads,
+                         thread::ThreadPool* thread_pool);
+
+  // Blocks until all outstanding reads have finished.
+  ~PrefetchingInputStream() override;
+
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+  // Like ReadNBytes(), but avoids the copy when the bytes lie within a single
+  // prefetched chunk and make up at least 1/kMaxViewOverhead of it. In that
+  // case `result` is set to a view of the chunk, and `*buffer` to a reference
+  // that keeps the chunk alive for as long as the view is used. Otherwise the
+  // bytes are copied into `result` and `*buffer` is reset.
+  Status ReadNBytesView(int64_t bytes_to_read, tstring* result,
+                        core::RefCountPtr<core::RefCounted>* buffer);
+
+  Status SkipNBytes(int64_t bytes_to_skip) override;
+
+  int64_t Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  // Bounds the memory that a view can keep alive to this multiple of its size.
+  static constexpr int64_t kMaxViewOverhead = 16;
+
+  // The bytes of one chunk, which may be shared with views.
+  struct ChunkData : public core::RefCounted {
+    tstring bytes;
+  };
+
+  // The result of one read of up to `chunk_size_` bytes at `offset`.
+  struct Chunk {
+    explicit Chunk(int64_t offset) : offset(offset) {}
+
+    // Must only be called once the read is done.
+    const tstring& bytes() const { return data->bytes; }
+    int64_t end() const { return offset + data->bytes.size(); }
+
+    const int64_t offset;
+    core::RefCountPtr<ChunkData> data;
+    Status status;
+    bool done = false;
+  };
+
+  // Schedules reads until `num_outstanding_reads_` chunks are queued, or the
+  // end of the file has been seen.
+  void ScheduleReads() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Waits for `chunk` to be read. Returns the error of the read, if any.
+  Status WaitForChunk(const Chunk& chunk, mutex_lock& l)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Discards all queued chunks and restarts reading at `offset`.
+  void RestartAt(int64_t offset) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  RandomAccessFile* const file_;          // Not owned.
+  const int64_t chunk_size_;
+  const int num_outstanding_reads_;
+  thread::ThreadPool* const thread_pool_;  // Not owned.
+
+  mutable mutex mu_;
+  condition_variable cond_var_;
+  // The position of the next byte returned by `ReadNBytes()`.
+  int64_t pos_ TF_GUARDED_BY(mu_) = 0;
+  // The offset of the next chunk to be scheduled.
+  int64_t next_offset_ TF_GUARDED_BY(mu_) = 0;
+  // True if a short read has been seen, after which no reads are scheduled.
+  bool end_of_file_ TF_GUARDED_BY(mu_) = false;
+  // Chunks in increasing order of offset. The first chunk contains `pos_`.
+  std::deque<std::shared_ptr<Chunk>> chunks_ TF_GUARDED_BY(mu_);
+  // The number of reads scheduled on the thread pool that have not finished,
+  // including those for chunks that have been discarded.
+  int num_pending_reads_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PrefetchingInputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_PREFETCHING_INPUTSTREAM_H_
@@ -0,0 +1,150 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/prefetching_inputstream.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+static std::vector<int> ChunkSizes() { return {1, 2, 3, 4, 5, 7, 10, 16}; }
+
+class PrefetchingInputStreamTest : public ::testing::Test {
+ protected:
+  PrefetchingInputStreamTest()
+      : thread_pool_(Env::Default(), "prefetching_inputstream_test", 4) {}
+
+  void SetUp() override {
+    Env* env = Env::Default();
+    string fname = testing::TmpDir() + "/prefetching_inputstream_test";
+    TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+    TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_));
+  }
+
+  thread::ThreadPool thread_pool_;
+  std::unique_ptr<RandomAccessFile> file_;
+};
+
+TEST_F(PrefetchingInputStreamTest, ReadNBytes) {
+  for (int num_outstanding_reads : {1, 3}) {
+    for (auto chunk_size : ChunkSizes()) {
+      tstring read;
+      PrefetchingInputStream in(file_.get(), chunk_size, num_outstanding_reads,
+                                &thread_pool_);
+      TF_ASSERT_OK(in.ReadNBytes(3, &read));
+      EXPECT_EQ(read, "012");
+      EXPECT_EQ(3, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(0, &read));
+      EXPECT_EQ(read, "");
+      EXPECT_EQ(3, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(5, &read));
+      EXPECT_EQ(read, "34567");
+      EXPECT_EQ(8, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(20, &read)));
+      EXPECT_EQ(read, "89");
+      EXPECT_EQ(10, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+      EXPECT_EQ(read, "");
+      EXPECT_EQ(10, in.Tell());
+    }
+  }
+}
+
+TEST_F(PrefetchingInputStreamTest, ReadNBytesView) {
+  tstring read;
+  core::RefCountPtr<core::RefCounted> buffer;
+  {
+    PrefetchingInputStream in(file_.get(), 8, 2, &thread_pool_);
+    TF_ASSERT_OK(in.ReadNBytesView(4, &read, &buffer));
+    EXPECT_EQ(read, "0123");
+    EXPECT_EQ(read.type(), tstring::VIEW);
+    EXPECT_NE(buffer, nullptr);
+    EXPECT_EQ(4, in.Tell());
+
+    // The bytes span two chunks, so they are copied.
+    tstring copied;
+    core::RefCountPtr<core::RefCounted> no_buffer;
+    TF_ASSERT_OK(in.ReadNBytesView(5, &copied, &no_buffer));
+    EXPECT_EQ(copied, "45678");
+    EXPECT_NE(copied.type(), tstring::VIEW);
+    EXPECT_EQ(no_buffer, nullptr);
+    EXPECT_EQ(9, in.Tell());
+  }
+  // The view outlives the stream.
+  EXPECT_EQ(read, "0123");
+}
+
+TEST_F(PrefetchingInputStreamTest, ReadNBytesViewCopiesSmallReads) {
+  tstring read;
+  core::RefCountPtr<core::RefCounted> buffer;
+  PrefetchingInputStream in(file_.get(), 64, 2, &thread_pool_);
+  TF_ASSERT_OK(in.ReadNBytesView(3, &read, &buffer));
+  EXPECT_EQ(read, "012");
+  EXPECT_NE(read.type(), tstring::VIEW);
+  EXPECT_EQ(buffer, nullptr);
+}
+
+TEST_F(PrefetchingInputStreamTest, SkipNBytes) {
+  for (int num_outstanding_reads : {1, 3}) {
+    for (auto chunk_size : ChunkSizes()) {
+      tstring read;
+      PrefetchingInputStream in(file_.get(), chunk_size, num_outstanding_reads,
+                                &thread_pool_);
+      TF_ASSERT_OK(in.SkipNBytes(3));
+      EXPECT_EQ(3, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(2, &read));
+      EXPECT_EQ(read, "34");
+      TF_ASSERT_OK(in.SkipNBytes(0));
+      EXPECT_EQ(5, in.Tell());
+      TF_ASSERT_OK(in.SkipNBytes(4));
+      EXPECT_EQ(9, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(1, &read));
+      EXPECT_EQ(read, "9");
+      EXPECT_EQ(10, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(1)));
+      EXPECT_EQ(10, in.Tell());
+    }
+  }
+}
+
+TEST_F(PrefetchingInputStreamTest, SkipPastEndOfFile) {
+  for (auto chunk_size : ChunkSizes()) {
+    PrefetchingInputStream in(file_.get(), chunk_size, 2, &thread_pool_);
+    TF_ASSERT_OK(in.SkipNBytes(2));
+    EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(20)));
+    EXPECT_EQ(10, in.Tell());
+  }
+}
+
+TEST_F(PrefetchingInputStreamTest, Reset) {
+  for (auto chunk_size : ChunkSizes()) {
+    tstring read;
+    PrefetchingInputStream in(file_.get(), chunk_size, 2, &thread_pool_);
+    TF_ASSERT_OK(in.ReadNBytes(6, &read));
+    EXPECT_EQ(read, "012345");
+    TF_ASSERT_OK(in.Reset());
+    EXPECT_EQ(0, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(4, &read));
+    EXPECT_EQ(read, "0123");
+  }
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tensorflow
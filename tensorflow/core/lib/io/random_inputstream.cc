@@ -72,17 +72,19 @@ Status RandomAccessInputStream::SkipNBytes(int64_t bytes_to_skip) {
   if (bytes_to_skip < 0) {
     return errors::InvalidArgument("Can't skip a negative number of bytes");
   }
-  std::unique_ptr<char[]> scratch(new char[kMaxSkipSize]);
   // Try to read 1 bytes first, if we could complete the read then EOF is
   // not reached yet and we could return.
   if (bytes_to_skip > 0) {
     StringPiece data;
-    Status s = file_->Read(pos_ + bytes_to_skip - 1, 1, &data, scratch.get());
+    char last_byte;
+    Status s = file_->Read(pos_ + bytes_to_skip - 1, 1, &data, &last_byte);
     if ((s.ok() || errors::IsOutOfRange(s)) && data.size() == 1) {
       pos_ += bytes_to_skip;
       return Status::OK();
     }
   }
+  // Only allocate the scratch space when we have to read through to EOF.
+  std::unique_ptr<char[]> scratch(new char[kMaxSkipSize]);
   // Read kDefaultSkipSize at a time till bytes_to_skip.
   while (bytes_to_skip > 0) {
     int64_t bytes_to_read = std::min<int64_t>(kMaxSkipSize, bytes_to_skip);
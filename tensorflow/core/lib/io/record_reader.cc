@@ -46,6 +46,9 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
   } else if (compression_type == compression::kSnappy) {
     options.compression_type = io::RecordReaderOptions::SNAPPY_COMPRESSION;
+  } else if (compression_type == compression::kSnappyBlock ||
+             compression_type == compression::kZlibBlock) {
+    options.compression_type = io::RecordReaderOptions::BLOCK_COMPRESSION;
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
                << ". No compression will be used.";
@@ -59,10 +62,25 @@ RecordReader::RecordReader(RandomAccessFile* file,
     : options_(options),
       input_stream_(new RandomAccessInputStream(file)),
       last_read_failed_(false) {
-  if (options.buffer_size > 0) {
+  if (options.num_outstanding_reads > 0 &&
+      options.read_thread_pool != nullptr) {
+    int64_t chunk_size = options.buffer_size;
+    if (chunk_size <= 0) {
+      chunk_size = RecordReaderOptions::kDefaultPrefetchChunkSize;
+    }
+    prefetching_stream_ = new PrefetchingInputStream(
+        file, chunk_size, options.num_outstanding_reads,
+        options.read_thread_pool);
+    input_stream_.reset(prefetching_stream_);
+  } else if (options.buffer_size > 0) {
     input_stream_.reset(new BufferedInputStream(input_stream_.release(),
                                                 options.buffer_size, true));
   }
+  if (options.compression_type != RecordReaderOptions::NONE) {
+    // Records can only be views of the prefetched file contents if they are
+    // not compressed.
+    prefetching_stream_ = nullptr;
+  }
 #if defined(IS_SLIM_BUILD)
   if (options.compression_type != RecordReaderOptions::NONE) {
     LOG(FATAL) << "Compression is unsupported on mobile platforms.";
@@ -77,6 +95,11 @@ RecordReader::RecordReader(RandomAccessFile* file,
     input_stream_.reset(
         new SnappyInputStream(input_stream_.release(),
                               options.snappy_options.output_buffer_size, true));
+  } else if (options.compression_type ==
+             RecordReaderOptions::BLOCK_COMPRESSION) {
+    input_stream_.reset(new BlockCompressedInputStream(
+        input_stream_.release(), true, options.num_outstanding_reads,
+        options.read_thread_pool));
   } else if (options.compression_type == RecordReaderOptions::NONE) {
     // Nothing to do.
   } else {
@@ -90,13 +113,23 @@ RecordReader::RecordReader(RandomAccessFile* file,
 //
 // offset corresponds to the user-provided value to ReadRecord()
 // and is used only in error messages.
-Status RecordReader::ReadChecksummed(uint64 offset, size_t n, tstring* result) {
+//
+// If buffer is not nullptr, *result may be a view of the prefetched file
+// contents, which *buffer keeps alive.
+Status RecordReader::ReadChecksummed(
+    uint64 offset, size_t n, tstring* result,
+    core::RefCountPtr<core::RefCounted>* buffer) {
   if (n >= SIZE_MAX - sizeof(uint32)) {
     return errors::DataLoss("record size too large");
   }
 
   const size_t expected = n + sizeof(uint32);
-  TF_RETURN_IF_ERROR(input_stream_->ReadNBytes(expected, result));
+  if (buffer != nullptr && prefetching_stream_ != nullptr) {
+    TF_RETURN_IF_ERROR(
+        prefetching_stream_->ReadNBytesView(expected, result, buffer));
+  } else {
+    TF_RETURN_IF_ERROR(input_stream_->ReadNBytes(expected, result));
+  }
 
   if (result->size() != expected) {
     if (result->empty()) {
@@ -110,7 +143,12 @@ Status RecordReader::ReadChecksummed(uint64 offset, size_t n, tstring* result) {
   if (crc32c::Unmask(masked_crc) != crc32c::Value(result->data(), n)) {
     return errors::DataLoss("corrupted record at ", offset);
   }
-  result->resize(n);
+  if (result->type() == tstring::VIEW) {
+    // Resizing a view would copy it.
+    result->assign_as_view(result->data(), n);
+  } else {
+    result->resize(n);
+  }
   return Status::OK();
 }
 
@@ -122,48 +160,64 @@ Status RecordReader::GetMetadata(Metadata* md) {
 
   // Compute the metadata of the TFRecord file if not cached.
   if (!cached_metadata_) {
-    TF_RETURN_IF_ERROR(input_stream_->Reset());
+    TF_RETURN_IF_ERROR(ScanRecords(/*offsets=*/nullptr));
+  }
 
-    int64_t data_size = 0;
-    int64_t entries = 0;
-
-    // Within the loop, we always increment offset positively, so this
-    // loop should be guaranteed to either return after reaching EOF
-    // or encountering an error.
-    uint64 offset = 0;
-    tstring record;
-    while (true) {
-      // Read header, containing size of data.
-      Status s = ReadChecksummed(offset, sizeof(uint64), &record);
-      if (!s.ok()) {
-        if (errors::IsOutOfRange(s)) {
-          // We should reach out of range when the record file is complete.
-          break;
-        }
-        return s;
-      }
+  md->stats = cached_metadata_->stats;
+  return Status::OK();
+}
+
+Status RecordReader::BuildIndex(std::vector<uint64>* offsets) {
+  if (!offsets) {
+    return errors::InvalidArgument("offsets passed to BuildIndex() was null");
+  }
+  offsets->clear();
+  return ScanRecords(offsets);
+}
+
+Status RecordReader::ScanRecords(std::vector<uint64>* offsets) {
+  TF_RETURN_IF_ERROR(input_stream_->Reset());
 
-      // Read the length of the data.
-      const uint64 length = core::DecodeFixed64(record.data());
+  int64_t data_size = 0;
+  int64_t entries = 0;
 
-      // Skip reading the actual data since we just want the number
-      // of records and the size of the data.
-      TF_RETURN_IF_ERROR(input_stream_->SkipNBytes(length + kFooterSize));
-      offset += kHeaderSize + length + kFooterSize;
+  // Within the loop, we always increment offset positively, so this
+  // loop should be guaranteed to either return after reaching EOF
+  // or encountering an error.
+  uint64 offset = 0;
+  tstring record;
+  while (true) {
+    // Read header, containing size of data.
+    Status s = ReadChecksummed(offset, sizeof(uint64), &record);
+    if (!s.ok()) {
+      if (errors::IsOutOfRange(s)) {
+        // We should reach out of range when the record file is complete.
+        break;
+      }
+      return s;
+    }
+
+    // Read the length of the data.
+    const uint64 length = core::DecodeFixed64(record.data());
 
-      // Increment running stats.
-      data_size += length;
-      ++entries;
+    // Skip reading the actual data since we just want the number
+    // of records and the size of the data.
+    TF_RETURN_IF_ERROR(input_stream_->SkipNBytes(length + kFooterSize));
+    if (offsets) {
+      offsets->push_back(offset);
     }
+    offset += kHeaderSize + length + kFooterSize;
 
-    cached_metadata_.reset(new Metadata());
-    cached_metadata_->stats.entries = entries;
-    cached_metadata_->stats.data_size = data_size;
-    cached_metadata_->stats.file_size =
-        data_size + (kHeaderSize + kFooterSize) * entries;
+    // Increment running stats.
+    data_size += length;
+    ++entries;
   }
 
-  md->stats = cached_metadata_->stats;
+  cached_metadata_.reset(new Metadata());
+  cached_metadata_->stats.entries = entries;
+  cached_metadata_->stats.data_size = data_size;
+  cached_metadata_->stats.file_size =
+      data_size + (kHeaderSize + kFooterSize) * entries;
   return Status::OK();
 }
 
@@ -183,6 +237,12 @@ Status RecordReader::PositionInputStream(uint64 offset) {
 }
 
 Status RecordReader::ReadRecord(uint64* offset, tstring* record) {
+  return ReadRecord(offset, record, /*buffer=*/nullptr);
+}
+
+Status RecordReader::ReadRecord(uint64* offset, tstring* record,
+                                core::RefCountPtr<core::RefCounted>* buffer) {
+  if (buffer != nullptr) buffer->reset();
   TF_RETURN_IF_ERROR(PositionInputStream(*offset));
 
   // Read header data.
@@ -194,7 +254,7 @@ Status RecordReader::ReadRecord(uint64* offset, tstring* record) {
   const uint64 length = core::DecodeFixed64(record->data());
 
   // Read data
-  s = ReadChecksummed(*offset + kHeaderSize, length, record);
+  s = ReadChecksummed(*offset + kHeaderSize, length, record, buffer);
   if (!s.ok()) {
     last_read_failed_ = true;
     if (errors::IsOutOfRange(s)) {
@@ -241,6 +301,33 @@ Status RecordReader::SkipRecords(uint64* offset, int num_to_skip,
   return Status::OK();
 }
 
+Status WriteRecordIndex(Env* env, const string& fname,
+                        const std::vector<uint64>& offsets) {
+  string contents;
+  contents.reserve(offsets.size() * sizeof(uint64));
+  for (uint64 offset : offsets) {
+    core::PutFixed64(&contents, offset);
+  }
+  return WriteStringToFile(env, fname, contents);
+}
+
+Status ReadRecordIndex(Env* env, const string& fname,
+                       std::vector<uint64>* offsets) {
+  string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, fname, &contents));
+  if (contents.size() % sizeof(uint64) != 0) {
+    return errors::DataLoss("record index ", fname, " has ", contents.size(),
+                            " bytes, which is not a multiple of ",
+                            sizeof(uint64));
+  }
+  offsets->clear();
+  offsets->reserve(contents.size() / sizeof(uint64));
+  for (size_t i = 0; i < contents.size(); i += sizeof(uint64)) {
+    offsets->push_back(core::DecodeFixed64(contents.data() + i));
+  }
+  return Status::OK();
+}
+
 SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
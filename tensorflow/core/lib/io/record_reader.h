@@ -16,20 +16,27 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_LIB_IO_RECORD_READER_H_
 #define TENSORFLOW_CORE_LIB_IO_RECORD_READER_H_
 
+#include <vector>
+
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/lib/io/prefetching_inputstream.h"
 #if !defined(IS_SLIM_BUILD)
+#include "tensorflow/core/lib/io/block_compressed_inputstream.h"
 #include "tensorflow/core/lib/io/snappy/snappy_compression_options.h"
 #include "tensorflow/core/lib/io/snappy/snappy_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #endif  // IS_SLIM_BUILD
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
 
+class Env;
 class RandomAccessFile;
 
 namespace io {
@@ -38,7 +45,10 @@ struct RecordReaderOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    // Independently compressed blocks of records, with any codec, see
+    // block_compression_options.h.
+    BLOCK_COMPRESSION = 3
   };
   CompressionType compression_type = NONE;
 
@@ -47,6 +57,19 @@ struct RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64_t buffer_size = 0;
 
+  // If num_outstanding_reads is positive and read_thread_pool is set, up to
+  // num_outstanding_reads reads of buffer_size bytes (or
+  // kDefaultPrefetchChunkSize bytes, if buffer_size is zero) ahead of the
+  // current position are kept in flight on read_thread_pool. As with
+  // buffer_size, reads should be sequential for this to be effective. The
+  // thread pool is not owned and must outlive the reader.
+  //
+  // Block compressed files also decompress up to num_outstanding_reads blocks
+  // ahead of the current position on read_thread_pool.
+  static constexpr int64_t kDefaultPrefetchChunkSize = 256 << 10;
+  int num_outstanding_reads = 0;
+  thread::ThreadPool* read_thread_pool = nullptr;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -97,6 +120,14 @@ class RecordReader {
   // OUT_OF_RANGE for end of file, or something else for an error.
   Status ReadRecord(uint64* offset, tstring* record);
 
+  // Like ReadRecord(), but if the reader prefetches (see
+  // RecordReaderOptions::num_outstanding_reads) and the file is not
+  // compressed, *record may be a view of the prefetched file contents instead
+  // of a copy. In that case *buffer is set to a reference that keeps the
+  // contents alive while the view is in use; otherwise *buffer is reset.
+  Status ReadRecord(uint64* offset, tstring* record,
+                    core::RefCountPtr<core::RefCounted>* buffer);
+
   // Skip num_to_skip record starting at "*offset" and update *offset
   // to point to the offset of the next num_to_skip + 1 record.
   // Return OK on success, OUT_OF_RANGE for end of file, or something
@@ -115,12 +146,28 @@ class RecordReader {
   // 'metadata' must not be nullptr.
   Status GetMetadata(Metadata* md);
 
+  // Scans the file and sets *offsets to the offset of each of its records, so
+  // that record i can be read with ReadRecord(&(*offsets)[i], ...). Also
+  // caches the metadata returned by GetMetadata().
+  //
+  // For compressed files the offsets are positions in the uncompressed
+  // stream, and reading a record before the current position rereads the
+  // file from its start. Block compressed files only reread the headers of
+  // the blocks before the record, and decompress the record's block.
+  Status BuildIndex(std::vector<uint64>* offsets);
+
  private:
-  Status ReadChecksummed(uint64 offset, size_t n, tstring* result);
+  // Scans the file to compute `cached_metadata_`. If `offsets` is not
+  // nullptr, also appends the offset of each record to it.
+  Status ScanRecords(std::vector<uint64>* offsets);
+  Status ReadChecksummed(uint64 offset, size_t n, tstring* result,
+                         core::RefCountPtr<core::RefCounted>* buffer = nullptr);
   Status PositionInputStream(uint64 offset);
 
   RecordReaderOptions options_;
   std::unique_ptr<InputStreamInterface> input_stream_;
+  // Set if input_stream_ is an uncompressed PrefetchingInputStream.
+  PrefetchingInputStream* prefetching_stream_ = nullptr;  // Not owned.
   bool last_read_failed_;
 
   std::unique_ptr<Metadata> cached_metadata_;
@@ -128,6 +175,16 @@ class RecordReader {
   TF_DISALLOW_COPY_AND_ASSIGN(RecordReader);
 };
 
+// Writes `offsets`, as returned by RecordReader::BuildIndex(), to the index
+// file `fname`, so that it need not be computed again. Index files store one
+// little-endian fixed64 offset per record.
+Status WriteRecordIndex(Env* env, const string& fname,
+                        const std::vector<uint64>& offsets);
+
+// Reads the record offsets written by WriteRecordIndex() from `fname`.
+Status ReadRecordIndex(Env* env, const string& fname,
+                       std::vector<uint64>* offsets);
+
 // High-level interface to read TFRecord files.
 //
 // Note: this class is not thread safe; external synchronization required.
@@ -147,6 +204,13 @@ class SequentialRecordReader {
     return underlying_.ReadRecord(&offset_, record);
   }
 
+  // Like ReadRecord(), but *record may be a view that *buffer keeps alive.
+  // See RecordReader::ReadRecord().
+  Status ReadRecord(tstring* record,
+                    core::RefCountPtr<core::RefCounted>* buffer) {
+    return underlying_.ReadRecord(&offset_, record, buffer);
+  }
+
   // Skip the next num_to_skip record in the file. Return OK on success,
   // OUT_OF_RANGE for end of file, or something else for an error.
   // "*num_skipped" records the number of records that are actually skipped.
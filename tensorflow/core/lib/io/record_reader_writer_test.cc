@@ -23,9 +23,11 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/block_compression_options.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 
@@ -41,6 +43,9 @@ io::RecordReaderOptions GetMatchingReaderOptions(
   if (options.compression_type == io::RecordWriterOptions::ZLIB_COMPRESSION) {
     return io::RecordReaderOptions::CreateRecordReaderOptions("ZLIB");
   }
+  if (options.compression_type == io::RecordWriterOptions::BLOCK_COMPRESSION) {
+    return io::RecordReaderOptions::CreateRecordReaderOptions("SNAPPY_BLOCK");
+  }
   return io::RecordReaderOptions::CreateRecordReaderOptions("");
 }
 
@@ -117,6 +122,12 @@ TEST(RecordReaderWriterTest, TestZlibSyncFlush) {
   VerifyFlush(options);
 }
 
+TEST(RecordReaderWriterTest, TestBlockCompressionFlush) {
+  // Flush() finishes the current block, so the records written so far can be
+  // read before the file is closed.
+  VerifyFlush(io::RecordWriterOptions::CreateRecordWriterOptions("ZLIB_BLOCK"));
+}
+
 TEST(RecordReaderWriterTest, TestBasics) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_test";
@@ -194,6 +205,47 @@ TEST(RecordReaderWriterTest, TestSkipBasic) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestBuildIndex) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_index_test";
+  const std::vector<string> records = {"abc", "", "defg", "hij"};
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    for (const auto& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Flush());
+  }
+
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReader reader(read_file.get());
+  std::vector<uint64> offsets;
+  TF_ASSERT_OK(reader.BuildIndex(&offsets));
+  ASSERT_EQ(records.size(), offsets.size());
+  EXPECT_EQ(0, offsets[0]);
+
+  // The records can be read in any order.
+  tstring record;
+  for (int i : {2, 0, 3, 1}) {
+    uint64 offset = offsets[i];
+    TF_ASSERT_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(records[i], record);
+  }
+
+  io::RecordReader::Metadata md;
+  TF_ASSERT_OK(reader.GetMetadata(&md));
+  EXPECT_EQ(4, md.stats.entries);
+
+  const string index_fname = fname + ".index";
+  TF_ASSERT_OK(io::WriteRecordIndex(env, index_fname, offsets));
+  std::vector<uint64> read_offsets;
+  TF_ASSERT_OK(io::ReadRecordIndex(env, index_fname, &read_offsets));
+  EXPECT_EQ(offsets, read_offsets);
+}
+
 TEST(RecordReaderWriterTest, TestSkipOutOfRange) {
   Env* env = Env::Default();
   string fname =
@@ -305,6 +357,81 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+static void VerifyBlockCompression(const string& compression_type,
+                                   thread::ThreadPool* thread_pool) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_block_test";
+  std::vector<string> records;
+  for (int i = 0; i < 100; ++i) {
+    records.push_back(string(i % 7, 'a' + i % 26));
+  }
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriterOptions options =
+        io::RecordWriterOptions::CreateRecordWriterOptions(compression_type);
+    ASSERT_EQ(io::RecordWriterOptions::BLOCK_COMPRESSION,
+              options.compression_type);
+    options.block_options.block_size = 64;
+    options.num_outstanding_blocks = 4;
+    options.compression_thread_pool = thread_pool;
+    io::RecordWriter writer(file.get(), options);
+    for (const auto& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  std::vector<io::block_compression::BlockHandle> block_index;
+  TF_ASSERT_OK(io::block_compression::ReadBlockIndex(
+      read_file.get(), GetFileSize(fname), &block_index));
+  EXPECT_GT(block_index.size(), 1);
+  uint64 num_records = 0;
+  for (const auto& handle : block_index) {
+    num_records += handle.num_records;
+  }
+  EXPECT_EQ(records.size(), num_records);
+
+  io::RecordReaderOptions options =
+      io::RecordReaderOptions::CreateRecordReaderOptions(compression_type);
+  options.num_outstanding_reads = 4;
+  options.read_thread_pool = thread_pool;
+  io::RecordReader reader(read_file.get(), options);
+  uint64 offset = 0;
+  tstring record;
+  for (const auto& expected : records) {
+    TF_ASSERT_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(expected, record);
+  }
+  EXPECT_EQ(error::OUT_OF_RANGE, reader.ReadRecord(&offset, &record).code());
+
+  // Seeking backwards skips over the blocks before the record.
+  std::vector<uint64> offsets;
+  TF_ASSERT_OK(reader.BuildIndex(&offsets));
+  ASSERT_EQ(records.size(), offsets.size());
+  for (int i : {57, 3, 99, 0, 42}) {
+    offset = offsets[i];
+    TF_ASSERT_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(records[i], record);
+  }
+}
+
+TEST(RecordReaderWriterTest, TestSnappyBlockCompression) {
+  VerifyBlockCompression("SNAPPY_BLOCK", /*thread_pool=*/nullptr);
+}
+
+TEST(RecordReaderWriterTest, TestZlibBlockCompression) {
+  VerifyBlockCompression("ZLIB_BLOCK", /*thread_pool=*/nullptr);
+}
+
+TEST(RecordReaderWriterTest, TestBlockCompressionInParallel) {
+  thread::ThreadPool thread_pool(Env::Default(), "test", 4);
+  VerifyBlockCompression("ZLIB_BLOCK", &thread_pool);
+}
+
 TEST(RecordReaderWriterTest, TestUseAfterClose) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_flush_close_test";
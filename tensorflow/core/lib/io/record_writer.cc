@@ -30,6 +30,10 @@ bool IsZlibCompressed(const RecordWriterOptions& options) {
 bool IsSnappyCompressed(const RecordWriterOptions& options) {
   return options.compression_type == RecordWriterOptions::SNAPPY_COMPRESSION;
 }
+
+bool IsBlockCompressed(const RecordWriterOptions& options) {
+  return options.compression_type == RecordWriterOptions::BLOCK_COMPRESSION;
+}
 }  // namespace
 
 RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
@@ -49,6 +53,12 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
   } else if (compression_type == compression::kSnappy) {
     options.compression_type = io::RecordWriterOptions::SNAPPY_COMPRESSION;
+  } else if (compression_type == compression::kSnappyBlock) {
+    options.compression_type = io::RecordWriterOptions::BLOCK_COMPRESSION;
+    options.block_options.codec = io::BlockCompressionOptions::SNAPPY;
+  } else if (compression_type == compression::kZlibBlock) {
+    options.compression_type = io::RecordWriterOptions::BLOCK_COMPRESSION;
+    options.block_options.codec = io::BlockCompressionOptions::ZLIB;
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
                << ". No compression will be used.";
@@ -79,6 +89,10 @@ RecordWriter::RecordWriter(WritableFile* dest,
     dest_ =
         new SnappyOutputBuffer(dest, options.snappy_options.input_buffer_size,
                                options.snappy_options.output_buffer_size);
+  } else if (IsBlockCompressed(options)) {
+    dest_ = new BlockCompressedOutputBuffer(
+        dest, options.block_options, options.num_outstanding_blocks,
+        options.compression_thread_pool);
   } else if (options.compression_type == RecordWriterOptions::NONE) {
     // Nothing to do
   } else {
@@ -112,7 +126,8 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   PopulateFooter(footer, data.data(), data.size());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  return EndRecord();
 }
 
 #if defined(TF_CORD_SUPPORT)
@@ -132,13 +147,25 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
   PopulateFooter(footer, data);
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  return EndRecord();
 }
 #endif
 
+Status RecordWriter::EndRecord() {
+#if !defined(IS_SLIM_BUILD)
+  if (IsBlockCompressed(options_)) {
+    // Blocks only end after whole records.
+    return static_cast<BlockCompressedOutputBuffer*>(dest_)->EndRecord();
+  }
+#endif
+  return Status::OK();
+}
+
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return Status::OK();
-  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
+  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_) ||
+      IsBlockCompressed(options_)) {
     Status s = dest_->Close();
     delete dest_;
     dest_ = nullptr;
@@ -21,6 +21,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #if !defined(IS_SLIM_BUILD)
+#include "tensorflow/core/lib/io/block_compressed_outputbuffer.h"
+#include "tensorflow/core/lib/io/block_compression_options.h"
 #include "tensorflow/core/lib/io/snappy/snappy_compression_options.h"
 #include "tensorflow/core/lib/io/snappy/snappy_outputbuffer.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
@@ -28,6 +30,7 @@ limitations under the License.
 #endif  // IS_SLIM_BUILD
 #include "tensorflow/core/platform/cord.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -41,10 +44,20 @@ struct RecordWriterOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    // Independently compressed blocks of records, see
+    // block_compression_options.h.
+    BLOCK_COMPRESSION = 3
   };
   CompressionType compression_type = NONE;
 
+  // If num_outstanding_blocks is positive and compression_thread_pool is set,
+  // block compressed files compress up to num_outstanding_blocks blocks in
+  // parallel on compression_thread_pool while records are written. The
+  // thread pool is not owned and must outlive the writer.
+  int num_outstanding_blocks = 0;
+  thread::ThreadPool* compression_thread_pool = nullptr;
+
   static RecordWriterOptions CreateRecordWriterOptions(
       const string& compression_type);
 
@@ -52,6 +65,7 @@ struct RecordWriterOptions {
   // Options specific to compression.
   tensorflow::io::ZlibCompressionOptions zlib_options;
   tensorflow::io::SnappyCompressionOptions snappy_options;
+  tensorflow::io::BlockCompressionOptions block_options;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -111,6 +125,9 @@ class RecordWriter {
 #endif
 
  private:
+  // Called after each record is appended to `dest_`.
+  Status EndRecord();
+
   WritableFile* dest_;
   RecordWriterOptions options_;
 
@@ -68,6 +68,33 @@ TEST(PhiloxRandomTest, SkipMatchTest) {
   }
 }
 
+// This test checks that GenerateMany() returns the same groups as the same
+// number of calls of operator(), also when the low word of the counter wraps
+// around within the groups.
+TEST(PhiloxRandomTest, GenerateManyMatchTest) {
+  constexpr int kCount = 16;
+  const uint64 test_seed = GetTestSeed();
+  for (const uint64 skip : {uint64{0}, uint64{5}, uint64{0xFFFFFFFF} - 7,
+                            uint64{0xFFFFFFFF}}) {
+    PhiloxRandom gen1(test_seed);
+    gen1.Skip(skip);
+    PhiloxRandom gen2 = gen1;
+    for (int batch = 0; batch < 3; ++batch) {
+      PhiloxRandom::ResultType results[kCount];
+      gen1.GenerateMany<kCount>(results);
+      for (int i = 0; i < kCount; ++i) {
+        const PhiloxRandom::ResultType expected = gen2();
+        for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+          ASSERT_EQ(results[i][j], expected[j]);
+        }
+      }
+    }
+    for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+      ASSERT_EQ(gen1.counter()[j], gen2.counter()[j]);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace random
 }  // namespace tensorflow
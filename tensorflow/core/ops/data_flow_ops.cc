@@ -1461,4 +1461,62 @@ REGISTER_OP("RecordInput")
     .SetIsStateful()
     .SetShapeFn(shape_inference::UnknownShape);
 
+// --------------------------------------------------------------------------
+
+REGISTER_OP("KVCache")
+    .Output("handle: resource")
+    .Attr("dtype: {half, bfloat16, float}")
+    .Attr("num_heads: int >= 1")
+    .Attr("head_dim: int >= 1")
+    .Attr("page_size: int >= 1 = 16")
+    .Attr("max_pages: int >= 0 = 0")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::ScalarShape);
+
+REGISTER_OP("KVCacheAppend")
+    .Input("handle: resource")
+    .Input("sequence_ids: int64")
+    .Input("keys: dtype")
+    .Input("values: dtype")
+    .Attr("dtype: {half, bfloat16, float}")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle sequence_ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &sequence_ids));
+      ShapeHandle keys;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(2), 3, &keys));
+      TF_RETURN_IF_ERROR(c->WithRankAtMost(keys, 4, &keys));
+      TF_RETURN_IF_ERROR(c->Merge(keys, c->input(3), &keys));
+      DimensionHandle unused;
+      return c->Merge(c->Dim(sequence_ids, 0), c->Dim(keys, 0), &unused);
+    });
+
+REGISTER_OP("KVCacheAttention")
+    .Input("handle: resource")
+    .Input("sequence_ids: int64")
+    .Input("queries: dtype")
+    .Output("output: dtype")
+    .Attr("dtype: {half, bfloat16, float}")
+    .Attr("scale: float = 0")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle sequence_ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &sequence_ids));
+      ShapeHandle queries;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 3, &queries));
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(sequence_ids, 0), c->Dim(queries, 0), &unused));
+      c->set_output(0, queries);
+      return Status::OK();
+    });
+
+REGISTER_OP("KVCacheRemove")
+    .Input("handle: resource")
+    .Input("sequence_ids: int64")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      return c->WithRank(c->input(1), 1, &unused);
+    });
+
 }  // namespace tensorflow
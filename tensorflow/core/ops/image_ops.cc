@@ -469,6 +469,34 @@ REGISTER_OP("DecodeJpeg")
     .Output("image: uint8")
     .SetShapeFn(DecodeImageShapeFn);
 
+// --------------------------------------------------------------------------
+REGISTER_OP("BatchDecodeJpeg")
+    .Input("contents: string")
+    .Attr("channels: int = 0")
+    .Attr("ratio: int = 1")
+    .Attr("fancy_upscaling: bool = true")
+    .Attr("try_recover_truncated: bool = false")
+    .Attr("acceptable_fraction: float = 1.0")
+    .Attr("dct_method: string = ''")
+    .Output("image: uint8")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle contents;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &contents));
+      int32_t channels;
+      TF_RETURN_IF_ERROR(c->GetAttr("channels", &channels));
+      if (channels < 0) {
+        return errors::InvalidArgument("channels must be non-negative, got ",
+                                       channels);
+      }
+      DimensionHandle channels_dim =
+          channels == 0 ? c->UnknownDim() : c->MakeDim(channels);
+      c->set_output(0, c->MakeShape({c->Dim(contents, 0),
+                                     InferenceContext::kUnknownDim,
+                                     InferenceContext::kUnknownDim,
+                                     channels_dim}));
+      return Status::OK();
+    });
+
 // --------------------------------------------------------------------------
 REGISTER_OP("DecodeAndCropJpeg")
     .Input("contents: string")
@@ -440,6 +440,45 @@ REGISTER_OP("AnonymousMutableHashTableOfTensors")
     .SetIsStateful()
     .SetShapeFn(MutableHashTableOfTensorsShapeFn);
 
+REGISTER_OP("DynamicEmbeddingTable")
+    .Output("table_handle: resource")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("use_node_name_sharing: bool = false")
+    .Attr("key_dtype: {int32, int64}")
+    .Attr("value_dtype: {float, double}")
+    .Attr("value_shape: shape")
+    .Attr("num_slots: int >= 0 = 0")
+    .Attr("slot_init_value: float = 0")
+    .Attr("capacity: int >= 0 = 0")
+    .Attr("min_frequency: int >= 1 = 1")
+    .Attr("eviction_policy: {'lru', 'lfu', 'ttl'} = 'lru'")
+    .Attr("ttl_steps: int >= 0 = 0")
+    .SetIsStateful()
+    .SetShapeFn(MutableHashTableOfTensorsShapeFn);
+
+REGISTER_OP("DynamicEmbeddingSparseApplyAdagrad")
+    .Input("table_handle: resource")
+    .Input("lr: T")
+    .Input("grad: T")
+    .Input("indices: Tindices")
+    .Attr("T: {float, double}")
+    .Attr("Tindices: {int32, int64}")
+    .Attr("update_slots: bool = true")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      ShapeHandle grad;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(2), 1, &grad));
+      ShapeHandle indices;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &indices));
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(grad, 0), c->Dim(indices, 0), &unused_dim));
+      return Status::OK();
+    });
+
 REGISTER_OP("MutableDenseHashTable")
     .Input("empty_key: key_dtype")
     .Output("table_handle: Ref(string)")
@@ -469,6 +508,22 @@ REGISTER_OP("MutableDenseHashTableV2")
     .SetIsStateful()
     .SetShapeFn(MutableDenseHashTableShapeFn);
 
+REGISTER_OP("ShardedMutableDenseHashTable")
+    .Input("empty_key: key_dtype")
+    .Input("deleted_key: key_dtype")
+    .Output("table_handle: resource")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("use_node_name_sharing: bool = false")
+    .Attr("key_dtype: type")
+    .Attr("value_dtype: type")
+    .Attr("value_shape: shape = {}")
+    .Attr("initial_num_buckets: int = 131072")  // 2^17
+    .Attr("max_load_factor: float = 0.8")
+    .Attr("num_shards: int >= 1 = 16")
+    .SetIsStateful()
+    .SetShapeFn(MutableDenseHashTableShapeFn);
+
 REGISTER_OP("AnonymousMutableDenseHashTable")
     .Input("empty_key: key_dtype")
     .Input("deleted_key: key_dtype")
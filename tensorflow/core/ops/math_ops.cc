@@ -337,6 +337,27 @@ REGISTER_OP("_UnaryOpsComposition")
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_FusedElementwise")
+    .Input("args: num_args * T")
+    .Output("y: T")
+    .Attr("T: {bfloat16, half, float, double}")
+    .Attr("num_args: int >= 1")
+    .Attr("fused_ops: list(string)")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Performs a chain of elementwise ops in one pass over memory.
+
+The ops are specified by the `fused_ops` attribute, which is a list of TF op
+names (e.g. ["Mul", "Add", "Tanh"]). They are performed in order, where the
+first input to each op is the output of the preceding op, and the first input
+to the first op is `args[0]`. Each binary op takes its second input from the
+next element of `args`, which must be either a scalar or of the shape of
+`args[0]`.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 #undef UNARY
 #undef UNARY_REAL
 #undef UNARY_COMPLEX
@@ -1015,6 +1036,74 @@ _FusedConv2D output.
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_DynamicRangeQuantizedMatMul")
+    .Input("a: float")
+    .Input("b: qint8")
+    .Input("b_scales: float")
+    .Input("args: num_args * float")
+    .Output("product: float")
+    .Attr("transpose_a: bool = false")
+    .Attr("transpose_b: bool = false")
+    .Attr("num_args: int >= 0")
+    .Attr("fused_ops: list(string) = []")
+    .SetShapeFn([](InferenceContext* c) {
+      TF_RETURN_IF_ERROR(shape_inference::MatMulShape(c));
+      ShapeHandle unused;
+      return c->WithRankAtMost(c->input(2), 1, &unused);
+    })
+    .Doc(R"doc(
+Performs a MatMul of float `a` with int8 weights `b`, quantizing `a` on the fly.
+
+`b` is symmetrically quantized with `b_scales`, which is either a scalar or has
+one scale per output channel (column of the product). Each row of `a` is
+quantized to 7 bits with its own range, the product is accumulated in int32 and
+the result is dequantized to float. The MatMul may be followed by the ops in
+`fused_ops`: [], ["BiasAdd"], ["BiasAdd","Relu"] or ["BiasAdd","Relu6"], where
+the float bias is given in `args`.
+
+*NOTE*: Do not invoke this operator directly in Python. It is meant for graphs
+produced by the TF quantizer.
+)doc");
+
+REGISTER_OP("_GroupedMatMul")
+    .Input("a: N * T")
+    .Input("b: N * T")
+    .Output("product: N * T")
+    .Attr("transpose_a: bool = false")
+    .Attr("transpose_b: bool = false")
+    .Attr("T: {half, float, double}")
+    .Attr("N: int >= 1")
+    .SetShapeFn([](InferenceContext* c) {
+      bool transpose_a, transpose_b;
+      TF_RETURN_IF_ERROR(c->GetAttr("transpose_a", &transpose_a));
+      TF_RETURN_IF_ERROR(c->GetAttr("transpose_b", &transpose_b));
+      int n;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+      for (int i = 0; i < n; ++i) {
+        ShapeHandle a;
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 2, &a));
+        ShapeHandle b;
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(n + i), 2, &b));
+        DimensionHandle inner_a = c->Dim(a, transpose_a ? 0 : 1);
+        DimensionHandle inner_b = c->Dim(b, transpose_b ? 1 : 0);
+        DimensionHandle merged;
+        TF_RETURN_IF_ERROR(c->Merge(inner_a, inner_b, &merged));
+        c->set_output(i, c->Matrix(c->Dim(a, transpose_a ? 1 : 0),
+                                   c->Dim(b, transpose_b ? 0 : 1)));
+      }
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Performs N independent MatMuls, `product[i] = a[i] * b[i]`, in one op.
+
+The products may have different shapes. The transpose attributes apply to all
+of them. On GPU the products that have the same shape are computed by a single
+batched GEMM launch.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 // --------------------------------------------------------------------------
 
 // For operations where the output is a reduction function along some
@@ -1449,6 +1538,54 @@ REGISTER_OP("SparseSegmentSqrtNGrad")
     .Attr("Tsegmentids: {int32, int64} = DT_INT32")
     .SetShapeFn(SparseSegmentReductionGradShapeFn);
 
+REGISTER_OP("_ResourceSparseSegmentReduction")
+    .Input("resource: resource")
+    .Input("gather_indices: Tidx")
+    .Input("indices: Tidx")
+    .Input("segment_ids: Tsegmentids")
+    .Output("output: dtype")
+    .Attr("dtype: {bfloat16, half, float, double}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'}")
+    .SetShapeFn([](InferenceContext* c) {
+      std::vector<shape_inference::ShapeAndType> handle_shape_and_type;
+      TF_RETURN_IF_ERROR(shape_inference::ValidateVariableResourceHandle(
+          c, &handle_shape_and_type));
+      ShapeHandle data_shape;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(handle_shape_and_type[0].shape, 1,
+                                            &data_shape));
+
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      ShapeHandle indices_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &indices_shape));
+      ShapeHandle segment_ids_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &segment_ids_shape));
+      TF_RETURN_IF_ERROR(c->Merge(indices_shape, segment_ids_shape, &unused));
+
+      ShapeHandle subshape;
+      TF_RETURN_IF_ERROR(c->Subshape(data_shape, 1, &subshape));
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(c->Concatenate(
+          c->Vector(InferenceContext::kUnknownDim), subshape, &out));
+      c->set_output(0, out);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Internal operation which is a composition of gathering rows of a resource
+variable (ResourceGather) and reducing them into segments
+(SparseSegmentSum, SparseSegmentMean or SparseSegmentSqrtN, as selected by
+`combiner`): reserved for internal use.
+
+Computes the same result as
+`SparseSegment<Combiner>(ResourceGather(resource, gather_indices), indices,
+segment_ids)` without materializing the gathered rows.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("All")
     .Input("input: bool")
     .Input("reduction_indices: Tidx")
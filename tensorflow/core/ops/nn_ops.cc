@@ -1475,6 +1475,40 @@ REGISTER_OP("ApproxTopK")
     .Attr("T: {half, bfloat16, float}")
     .SetShapeFn(ApproxTopKShape);
 
+REGISTER_OP("BeamSearchStep")
+    .Input("log_probs: T")
+    .Input("beam_scores: T")
+    .Input("states: Tstates")
+    .Output("scores: T")
+    .Output("token_ids: int32")
+    .Output("parent_ids: int32")
+    .Output("reordered_states: Tstates")
+    .Attr("T: {half, bfloat16, float, double}")
+    .Attr("Tstates: list(type) >= 0")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle log_probs;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 3, &log_probs));
+      ShapeHandle beam_scores;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &beam_scores));
+      ShapeHandle batch_and_beam;
+      TF_RETURN_IF_ERROR(c->Subshape(log_probs, 0, 2, &batch_and_beam));
+      TF_RETURN_IF_ERROR(c->Merge(batch_and_beam, beam_scores, &beam_scores));
+      c->set_output(0, beam_scores);
+      c->set_output(1, beam_scores);
+      c->set_output(2, beam_scores);
+      DimensionHandle num_rows;
+      TF_RETURN_IF_ERROR(c->Multiply(c->Dim(beam_scores, 0),
+                                     c->Dim(beam_scores, 1), &num_rows));
+      for (int i = 2; i < c->num_inputs(); ++i) {
+        ShapeHandle state;
+        TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(i), 1, &state));
+        DimensionHandle unused;
+        TF_RETURN_IF_ERROR(c->Merge(c->Dim(state, 0), num_rows, &unused));
+        c->set_output(i + 1, state);
+      }
+      return Status::OK();
+    });
+
 // --------------------------------------------------------------------------
 
 REGISTER_OP("NthElement")
@@ -78,6 +78,7 @@ REGISTER_OP("SdcaOptimizerV2")
     .Attr("l2: float")
     .Attr("num_loss_partitions: int >= 1")
     .Attr("num_inner_iterations: int >= 1")
+    .Attr("delta_merge_interval: int >= 0 = 0")
     .Input("sparse_example_indices: num_sparse_features * int64")
     .Input("sparse_feature_indices: num_sparse_features * int64")
     .Input("sparse_feature_values: num_sparse_features_with_values * float")
@@ -0,0 +1,321 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/disk_file_block_cache.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_statistics.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/hash.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+
+namespace {
+
+constexpr char kBlockSuffix[] = ".blk";
+constexpr char kLockFilename[] = "LOCK";
+
+// An eviction pass leaves the cache at this fraction of its maximum size, so
+// that the directory isn't scanned again on the next insertion.
+constexpr double kEvictionLowWatermark = 0.9;
+
+// Holds an exclusive lock of a file for its lifetime. Does nothing if the file
+// can't be locked, in which case the evictions of several processes may
+// overlap, which only costs a few more deleted blocks.
+class ScopedFileLock {
+ public:
+  explicit ScopedFileLock(const string& path) {
+#ifndef _WIN32
+    fd_ = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ >= 0 && flock(fd_, LOCK_EX) != 0) {
+      close(fd_);
+      fd_ = -1;
+    }
+#endif
+  }
+
+  ~ScopedFileLock() {
+#ifndef _WIN32
+    if (fd_ >= 0) {
+      flock(fd_, LOCK_UN);
+      close(fd_);
+    }
+#endif
+  }
+
+ private:
+  int fd_ = -1;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ScopedFileLock);
+};
+
+// Marks the block at `path` as recently used.
+void TouchBlock(const string& path) {
+#ifndef _WIN32
+  utime(path.c_str(), nullptr);
+#endif
+}
+
+}  // namespace
+
+DiskFileBlockCache::DiskFileBlockCache(size_t block_size, size_t max_bytes,
+                                       const string& cache_dir,
+                                       BlockFetcher block_fetcher, Env* env)
+    : block_size_(block_size),
+      max_bytes_(max_bytes),
+      cache_dir_(cache_dir),
+      block_fetcher_(std::move(block_fetcher)),
+      env_(env) {
+  if (IsCacheEnabled()) {
+    Status status = env_->RecursivelyCreateDir(cache_dir_);
+    if (!status.ok()) {
+      LOG(WARNING) << "Could not create the block cache directory "
+                   << cache_dir_ << ": " << status;
+    }
+    // Trims the blocks left by earlier processes, and sets `cache_size_`.
+    Evict();
+  }
+  VLOG(1) << "Disk file block cache at " << cache_dir_ << " is "
+          << (IsCacheEnabled() ? "enabled" : "disabled")
+          << ", max bytes = " << max_bytes_;
+}
+
+string DiskFileBlockCache::BlockPath(const string& filename,
+                                     int64_t file_signature,
+                                     size_t offset) const {
+  return io::JoinPath(
+      cache_dir_,
+      strings::StrCat(strings::Hex(Hash64(filename), strings::kZeroPad16), "_",
+                      strings::Hex(static_cast<uint64>(file_signature)), "_",
+                      offset, kBlockSuffix));
+}
+
+Status DiskFileBlockCache::Read(const string& filename, size_t offset,
+                                size_t n, char* buffer,
+                                size_t* bytes_transferred) {
+  *bytes_transferred = 0;
+  if (n == 0) {
+    return Status::OK();
+  }
+  int64_t file_signature = 0;
+  bool has_signature = false;
+  if (IsCacheEnabled() && n <= max_bytes_) {
+    mutex_lock lock(mu_);
+    auto it = file_signature_map_.find(filename);
+    if (it != file_signature_map_.end()) {
+      file_signature = it->second;
+      has_signature = true;
+    }
+  }
+  if (!has_signature) {
+    // The blocks can't be matched to a version of the file, so we pass the
+    // read through to the fetcher without breaking it up into blocks.
+    return block_fetcher_(filename, offset, n, buffer, bytes_transferred);
+  }
+  // Calculate the block-aligned start and end of the read.
+  size_t start = block_size_ * (offset / block_size_);
+  size_t finish = block_size_ * ((offset + n) / block_size_);
+  if (finish < offset + n) {
+    finish += block_size_;
+  }
+  size_t total_bytes_transferred = 0;
+  string data;
+  // Now iterate through the blocks, reading them one at a time.
+  for (size_t pos = start; pos < finish; pos += block_size_) {
+    const string path = BlockPath(filename, file_signature, pos);
+    if (LookupBlock(path, &data)) {
+      if (cache_stats_ != nullptr) {
+        cache_stats_->RecordCacheHitBlockSize(data.size());
+      }
+    } else {
+      data.resize(block_size_);
+      size_t block_bytes_transferred = 0;
+      TF_RETURN_IF_ERROR(block_fetcher_(filename, pos, block_size_, &data[0],
+                                        &block_bytes_transferred));
+      data.resize(block_bytes_transferred);
+      if (cache_stats_ != nullptr) {
+        cache_stats_->RecordCacheMissBlockSize(block_bytes_transferred);
+      }
+      if (!data.empty()) {
+        InsertBlock(path, data);
+      }
+    }
+    if (offset >= pos + data.size()) {
+      // The requested offset is at or beyond the end of the file. This can
+      // happen if `offset` is not block-aligned, and the read returns the last
+      // block in the file, which does not extend all the way out to `offset`.
+      *bytes_transferred = total_bytes_transferred;
+      return errors::OutOfRange("EOF at offset ", offset, " in file ", filename,
+                                " at position ", pos, " with data size ",
+                                data.size());
+    }
+    size_t begin = offset > pos ? offset - pos : 0;
+    size_t end = std::min(data.size(), offset + n - pos);
+    if (begin < end) {
+      memcpy(&buffer[total_bytes_transferred], &data[begin], end - begin);
+      total_bytes_transferred += end - begin;
+    }
+    if (data.size() < block_size_) {
+      // The block was a partial block and thus signals EOF at its upper bound.
+      break;
+    }
+  }
+  *bytes_transferred = total_bytes_transferred;
+  return Status::OK();
+}
+
+bool DiskFileBlockCache::LookupBlock(const string& path, string* data) {
+  uint64 size = 0;
+  if (!env_->GetFileSize(path, &size).ok() || size == 0 ||
+      size > block_size_) {
+    return false;
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  if (!env_->NewRandomAccessFile(path, &file).ok()) {
+    // The block was evicted since it was found.
+    return false;
+  }
+  data->resize(size);
+  StringPiece result;
+  Status status = file->Read(0, size, &result, &(*data)[0]);
+  if (!status.ok() && !errors::IsOutOfRange(status)) {
+    return false;
+  }
+  if (result.size() != size) {
+    return false;
+  }
+  if (result.data() != data->data()) {
+    memmove(&(*data)[0], result.data(), result.size());
+  }
+  TouchBlock(path);
+  return true;
+}
+
+void DiskFileBlockCache::InsertBlock(const string& path, const string& data) {
+  // Readers never see a partial block: it is written to a file of its own and
+  // renamed into place. If several threads or processes fetch the same block,
+  // the last rename wins, with the same contents.
+  const string tmp_path = strings::StrCat(
+      path, ".", strings::Hex(random::New64(), strings::kZeroPad16), ".tmp");
+  Status status = WriteStringToFile(env_, tmp_path, data);
+  if (status.ok()) {
+    status = env_->RenameFile(tmp_path, path);
+  }
+  if (!status.ok()) {
+    env_->DeleteFile(tmp_path).IgnoreError();
+    LOG(WARNING) << "Could not write block " << path << ": " << status;
+    return;
+  }
+  bool cache_full;
+  {
+    mutex_lock lock(mu_);
+    cache_size_ += data.size();
+    cache_full = cache_size_ > max_bytes_;
+  }
+  if (cache_full) {
+    Evict();
+  }
+}
+
+void DiskFileBlockCache::Evict() {
+  mutex_lock evict_lock(evict_mu_);
+  ScopedFileLock file_lock(io::JoinPath(cache_dir_, kLockFilename));
+
+  std::vector<string> children;
+  if (!env_->GetChildren(cache_dir_, &children).ok()) {
+    return;
+  }
+  struct BlockInfo {
+    int64_t mtime_nsec;
+    int64_t length;
+    string path;
+  };
+  std::vector<BlockInfo> blocks;
+  size_t total_bytes = 0;
+  for (const string& child : children) {
+    if (!absl::EndsWith(child, kBlockSuffix)) continue;
+    FileStatistics stat;
+    const string path = io::JoinPath(cache_dir_, child);
+    if (!env_->Stat(path, &stat).ok()) continue;
+    blocks.push_back({stat.mtime_nsec, stat.length, path});
+    total_bytes += stat.length;
+  }
+  if (total_bytes > max_bytes_) {
+    const size_t target_bytes =
+        static_cast<size_t>(max_bytes_ * kEvictionLowWatermark);
+    std::sort(blocks.begin(), blocks.end(),
+              [](const BlockInfo& a, const BlockInfo& b) {
+                return a.mtime_nsec < b.mtime_nsec;
+              });
+    for (const BlockInfo& block : blocks) {
+      if (total_bytes <= target_bytes) break;
+      if (env_->DeleteFile(block.path).ok()) {
+        total_bytes -= block.length;
+      }
+    }
+  }
+  mutex_lock lock(mu_);
+  cache_size_ = total_bytes;
+}
+
+bool DiskFileBlockCache::ValidateAndUpdateFileSignature(
+    const string& filename, int64_t file_signature) {
+  mutex_lock lock(mu_);
+  auto it = file_signature_map_.find(filename);
+  if (it != file_signature_map_.end()) {
+    if (it->second == file_signature) {
+      return true;
+    }
+    it->second = file_signature;
+    return false;
+  }
+  file_signature_map_[filename] = file_signature;
+  return true;
+}
+
+void DiskFileBlockCache::RemoveFile(const string& filename) {
+  mutex_lock lock(mu_);
+  file_signature_map_.erase(filename);
+}
+
+void DiskFileBlockCache::Flush() {
+  mutex_lock lock(mu_);
+  file_signature_map_.clear();
+}
+
+size_t DiskFileBlockCache::CacheSize() const {
+  mutex_lock lock(mu_);
+  return cache_size_;
+}
+
+}  // namespace tensorflow
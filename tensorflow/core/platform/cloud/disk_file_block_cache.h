@@ -0,0 +1,146 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
+#define TENSORFLOW_CORE_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
+
+#include <map>
+#include <string>
+
+#include "tensorflow/core/platform/cloud/file_block_cache.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+/// \brief A persistent block cache of file contents, stored in a local
+/// directory.
+///
+/// Each block is a file in `cache_dir`, named after the remote filename, the
+/// file signature (e.g. the GCS generation) and the block offset, so a block
+/// is never served for a different version of the file. Blocks are written to
+/// a temporary file and renamed into place, which makes the directory safe to
+/// share by several processes on a host: repeated epochs and jobs read the
+/// blocks at local-disk speed, and the OS page cache keeps the hot ones in
+/// memory.
+///
+/// The total size of the blocks is bounded by `max_bytes`. When it is
+/// exceeded, the least recently used blocks (by modification time, which is
+/// refreshed on each hit) are deleted, under an exclusive lock of
+/// `cache_dir`/LOCK so that concurrent processes don't evict at the same time.
+///
+/// Blocks are only cached for files whose signature has been set with
+/// `ValidateAndUpdateFileSignature`; reads of other files go to the fetcher.
+class DiskFileBlockCache : public FileBlockCache {
+ public:
+  DiskFileBlockCache(size_t block_size, size_t max_bytes,
+                     const string& cache_dir, BlockFetcher block_fetcher,
+                     Env* env = Env::Default());
+
+  /// Read `n` bytes from `filename` starting at `offset` into `out`. This
+  /// method will return:
+  ///
+  /// 1) The error from the remote filesystem, if the read from the remote
+  ///    filesystem failed.
+  /// 2) OUT_OF_RANGE if the read from the remote filesystem succeeded, but
+  ///    the file contents do not extend past `offset` and thus nothing was
+  ///    placed in `out`.
+  /// 3) OK otherwise (i.e. the read succeeded, and at least one byte was placed
+  ///    in `out`).
+  ///
+  /// Failures to read or write the local cache are not errors: the block is
+  /// fetched from the remote filesystem instead.
+  Status Read(const string& filename, size_t offset, size_t n, char* buffer,
+              size_t* bytes_transferred) override;
+
+  // Validate the given file signature with the existing file signature in the
+  // cache. Returns true if the signature doesn't change or the file did not
+  // exist before. The blocks of older signatures are left to the LRU eviction.
+  bool ValidateAndUpdateFileSignature(const string& filename,
+                                      int64_t file_signature) override
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Stop serving the cached blocks of `filename` until its signature is set
+  /// again. The blocks themselves may be in use by other processes, so they
+  /// are left to the LRU eviction.
+  void RemoveFile(const string& filename) override TF_LOCKS_EXCLUDED(mu_);
+
+  /// Stop serving cached blocks until the file signatures are set again.
+  void Flush() override TF_LOCKS_EXCLUDED(mu_);
+
+  /// Accessors for cache parameters.
+  size_t block_size() const override { return block_size_; }
+  size_t max_bytes() const override { return max_bytes_; }
+  uint64 max_staleness() const override { return 0; }
+  const string& cache_dir() const { return cache_dir_; }
+
+  /// The size (in bytes) of the cache directory, as of the last eviction
+  /// pass, plus the blocks this process inserted since.
+  size_t CacheSize() const override TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns true if the cache is enabled. If false, the BlockFetcher callback
+  // is always executed during Read.
+  bool IsCacheEnabled() const override {
+    return block_size_ > 0 && max_bytes_ > 0 && !cache_dir_.empty();
+  }
+
+  /// Returns the path of the block of `filename` at `offset`.
+  string BlockPath(const string& filename, int64_t file_signature,
+                   size_t offset) const;
+
+ private:
+  /// Reads the block at `path` into `data`. Returns false on a cache miss.
+  bool LookupBlock(const string& path, string* data);
+
+  /// Writes the block at `path`, and evicts blocks if the cache is full.
+  void InsertBlock(const string& path, const string& data)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Removes the least recently used blocks until the cache directory fits
+  /// in `max_bytes_`, and updates `cache_size_`.
+  void Evict() TF_LOCKS_EXCLUDED(mu_);
+
+  /// The size of the blocks.
+  const size_t block_size_;
+
+  /// The maximum size (in bytes) of the cache directory.
+  const size_t max_bytes_;
+
+  /// The directory that holds the blocks.
+  const string cache_dir_;
+
+  /// The callback to read a block from the remote filesystem.
+  const BlockFetcher block_fetcher_;
+
+  Env* const env_;  // Not owned.
+
+  /// Serializes the eviction passes of this process.
+  mutex evict_mu_;
+
+  mutable mutex mu_;
+
+  /// The signatures of the files whose blocks are served from the cache.
+  std::map<string, int64_t> file_signature_map_ TF_GUARDED_BY(mu_);
+
+  /// The approximate size of the cache directory.
+  size_t cache_size_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
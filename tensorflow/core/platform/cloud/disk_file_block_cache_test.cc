@@ -0,0 +1,166 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/disk_file_block_cache.h"
+
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Status ReadCache(DiskFileBlockCache* cache, const string& filename,
+                 size_t offset, size_t n, std::vector<char>* out) {
+  out->clear();
+  out->resize(n, 0);
+  size_t bytes_transferred = 0;
+  Status status =
+      cache->Read(filename, offset, n, out->data(), &bytes_transferred);
+  EXPECT_LE(bytes_transferred, n);
+  out->resize(bytes_transferred, n);
+  return status;
+}
+
+// Returns an empty cache directory for the test.
+string CacheDir(const string& name) {
+  const string dir = io::JoinPath(testing::TmpDir(), "disk_fbc", name);
+  int64_t undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  return dir;
+}
+
+// Serves a file of `file_size` bytes, where each byte is its offset modulo 256,
+// and counts the calls.
+class FakeFetcher {
+ public:
+  explicit FakeFetcher(size_t file_size) : file_size_(file_size) {}
+
+  FileBlockCache::BlockFetcher fetcher() {
+    return [this](const string& filename, size_t offset, size_t n,
+                  char* buffer, size_t* bytes_transferred) {
+      ++calls_;
+      *bytes_transferred = 0;
+      for (size_t i = offset; i < offset + n && i < file_size_; ++i) {
+        buffer[(*bytes_transferred)++] = static_cast<char>(i % 256);
+      }
+      return Status::OK();
+    };
+  }
+
+  int calls() const { return calls_; }
+
+ private:
+  const size_t file_size_;
+  int calls_ = 0;
+};
+
+void ExpectContents(const std::vector<char>& out, size_t offset) {
+  for (size_t i = 0; i < out.size(); ++i) {
+    EXPECT_EQ(static_cast<char>((offset + i) % 256), out[i]) << i;
+  }
+}
+
+TEST(DiskFileBlockCacheTest, IsCacheEnabled) {
+  FakeFetcher fake(0);
+  const string dir = CacheDir("enabled");
+  EXPECT_FALSE(DiskFileBlockCache(0, 32, dir, fake.fetcher()).IsCacheEnabled());
+  EXPECT_FALSE(DiskFileBlockCache(16, 0, dir, fake.fetcher()).IsCacheEnabled());
+  EXPECT_FALSE(DiskFileBlockCache(16, 32, "", fake.fetcher()).IsCacheEnabled());
+  EXPECT_TRUE(DiskFileBlockCache(16, 32, dir, fake.fetcher()).IsCacheEnabled());
+}
+
+TEST(DiskFileBlockCacheTest, SharedByInstances) {
+  FakeFetcher fake(40);
+  const string dir = CacheDir("shared");
+  std::vector<char> out;
+  {
+    DiskFileBlockCache cache(16, 1024, dir, fake.fetcher());
+    EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("a", 1));
+    TF_EXPECT_OK(ReadCache(&cache, "a", 4, 30, &out));
+    EXPECT_EQ(30, out.size());
+    ExpectContents(out, 4);
+    // The blocks at 0 and 16 were fetched.
+    EXPECT_EQ(2, fake.calls());
+    EXPECT_EQ(32, cache.CacheSize());
+  }
+  // Another instance on the same directory, e.g. in another process, reads the
+  // blocks from disk.
+  DiskFileBlockCache cache(16, 1024, dir, fake.fetcher());
+  EXPECT_EQ(32, cache.CacheSize());
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("a", 1));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 32, &out));
+  EXPECT_EQ(32, out.size());
+  ExpectContents(out, 0);
+  EXPECT_EQ(2, fake.calls());
+  // The last block is partial, and signals EOF.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 30, 20, &out));
+  EXPECT_EQ(10, out.size());
+  ExpectContents(out, 30);
+  EXPECT_EQ(3, fake.calls());
+  EXPECT_TRUE(errors::IsOutOfRange(ReadCache(&cache, "a", 44, 4, &out)));
+  EXPECT_EQ(0, out.size());
+}
+
+TEST(DiskFileBlockCacheTest, SignatureChangeRefetches) {
+  FakeFetcher fake(32);
+  DiskFileBlockCache cache(16, 1024, CacheDir("signature"), fake.fetcher());
+  std::vector<char> out;
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("a", 1));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(1, fake.calls());
+  EXPECT_FALSE(cache.ValidateAndUpdateFileSignature("a", 2));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(2, fake.calls());
+}
+
+TEST(DiskFileBlockCacheTest, PassThroughWithoutSignature) {
+  FakeFetcher fake(32);
+  DiskFileBlockCache cache(16, 1024, CacheDir("pass_through"), fake.fetcher());
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(2, fake.calls());
+  EXPECT_EQ(0, cache.CacheSize());
+  // Blocks are no longer served after the file is removed.
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("a", 1));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  cache.RemoveFile("a");
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(4, fake.calls());
+}
+
+TEST(DiskFileBlockCacheTest, MaxBytes) {
+  FakeFetcher fake(1024);
+  DiskFileBlockCache cache(16, 64, CacheDir("max_bytes"), fake.fetcher());
+  std::vector<char> out;
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("a", 1));
+  for (size_t offset = 0; offset < 1024; offset += 16) {
+    TF_EXPECT_OK(ReadCache(&cache, "a", offset, 16, &out));
+    ExpectContents(out, offset);
+    EXPECT_LE(cache.CacheSize(), 64);
+  }
+  EXPECT_EQ(64, fake.calls());
+}
+
+}  // namespace
+}  // namespace tensorflow
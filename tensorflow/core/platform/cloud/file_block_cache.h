@@ -101,6 +101,10 @@ class FileBlockCache {
   virtual bool ValidateAndUpdateFileSignature(const string& filename,
                                               int64_t file_signature) = 0;
 
+  // Records the size of `filename`. Caches that prefetch blocks use it to bound
+  // the prefetched range; others ignore it.
+  virtual void SetFileSize(const string& filename, uint64 file_size) {}
+
   /// Remove all cached blocks for `filename`.
   virtual void RemoveFile(const string& filename) = 0;
 
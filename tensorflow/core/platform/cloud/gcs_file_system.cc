@@ -34,6 +34,7 @@ limitations under the License.
 #include "json/json.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/platform/cloud/curl_http_request.h"
+#include "tensorflow/core/platform/cloud/disk_file_block_cache.h"
 #include "tensorflow/core/platform/cloud/file_block_cache.h"
 #include "tensorflow/core/platform/cloud/google_auth_provider.h"
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
@@ -734,6 +735,314 @@ class GcsWritableFile : public WritableFile {
   const GenerationGetter generation_getter_;
 };
 
+/// \brief GCS-based implementation of a writeable file that uploads in parts.
+///
+/// The appended data is split into parts of `part_size` bytes, each staged in
+/// its own local tmp file. A part is uploaded as a temporary object on
+/// `thread_pool` as soon as it fills up, so the parts of a large file are
+/// uploaded concurrently while it is being written. Sync() waits for the
+/// pending uploads, uploads the last partial part, and composes the parts into
+/// the destination object. At most `max_pending_parts` parts are staged locally
+/// at any time, so the local disk usage stays bounded.
+class GcsParallelUploadWritableFile : public WritableFile {
+ public:
+  GcsParallelUploadWritableFile(
+      const string& bucket, const string& object, GcsFileSystem* filesystem,
+      GcsFileSystem::TimeoutConfig* timeouts,
+      std::function<void()> file_cache_erase, RetryConfig retry_config,
+      size_t part_size, thread::ThreadPool* thread_pool, int max_pending_parts,
+      SessionCreator session_creator, ObjectUploader object_uploader,
+      GenerationGetter generation_getter)
+      : bucket_(bucket),
+        object_(object),
+        filesystem_(filesystem),
+        timeouts_(timeouts),
+        file_cache_erase_(std::move(file_cache_erase)),
+        retry_config_(retry_config),
+        part_size_(part_size),
+        thread_pool_(thread_pool),
+        max_pending_parts_(max_pending_parts),
+        session_creator_(std::move(session_creator)),
+        object_uploader_(std::move(object_uploader)),
+        generation_getter_(std::move(generation_getter)) {
+    VLOG(3) << "GcsParallelUploadWritableFile: " << GetGcsPath();
+  }
+
+  ~GcsParallelUploadWritableFile() override {
+    Close().IgnoreError();
+    WaitForPendingParts().IgnoreError();
+    if (part_file_.is_open()) {
+      part_file_.close();
+      std::remove(part_filename_.c_str());
+    }
+  }
+
+  Status Append(StringPiece data) override {
+    TF_RETURN_IF_ERROR(CheckWritable());
+    VLOG(3) << "Append: " << GetGcsPath() << " size " << data.length();
+    sync_needed_ = true;
+    while (!data.empty()) {
+      if (!part_file_.is_open()) {
+        TF_RETURN_IF_ERROR(StartPart());
+      }
+      const size_t n = std::min(data.size(), part_size_ - part_bytes_);
+      part_file_.write(data.data(), n);
+      if (!part_file_.good()) {
+        return errors::Internal(
+            "Could not append to the internal temporary file.");
+      }
+      part_bytes_ += n;
+      offset_ += n;
+      data.remove_prefix(n);
+      if (part_bytes_ == part_size_) {
+        TF_RETURN_IF_ERROR(FinishPart());
+      }
+    }
+    return Status::OK();
+  }
+
+  Status Close() override {
+    VLOG(3) << "Close:" << GetGcsPath();
+    if (closed_) {
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(Sync());
+    closed_ = true;
+    return Status::OK();
+  }
+
+  Status Flush() override {
+    VLOG(3) << "Flush:" << GetGcsPath();
+    return Sync();
+  }
+
+  Status Name(StringPiece* result) const override {
+    return errors::Unimplemented(
+        "GcsParallelUploadWritableFile does not support Name()");
+  }
+
+  Status Sync() override {
+    VLOG(3) << "Sync started:" << GetGcsPath();
+    TF_RETURN_IF_ERROR(CheckWritable());
+    if (!sync_needed_) {
+      return Status::OK();
+    }
+    if (!composed_ && part_objects_.empty()) {
+      // The whole file fits in one part, so it is uploaded directly.
+      if (!part_file_.is_open()) {
+        // Create the empty object.
+        TF_RETURN_IF_ERROR(StartPart());
+      }
+      part_file_.close();
+      if (!part_file_.good()) {
+        return errors::Internal(
+            "Could not write to the internal temporary file.");
+      }
+      const Status status = UploadPart(part_filename_, part_bytes_, object_);
+      std::remove(part_filename_.c_str());
+      part_bytes_ = 0;
+      TF_RETURN_IF_ERROR(status);
+      composed_ = true;
+      file_cache_erase_();
+    } else {
+      if (part_file_.is_open()) {
+        TF_RETURN_IF_ERROR(FinishPart());
+      }
+      TF_RETURN_IF_ERROR(WaitForPendingParts());
+      TF_RETURN_IF_ERROR(ComposeParts());
+    }
+    VLOG(3) << "Sync finished " << GetGcsPath();
+    sync_needed_ = false;
+    return Status::OK();
+  }
+
+  Status Tell(int64_t* position) override {
+    *position = offset_;
+    return Status::OK();
+  }
+
+ private:
+  // The maximum number of source objects of a compose request.
+  static constexpr size_t kMaxComposeSources = 32;
+
+  Status CheckWritable() const {
+    if (closed_) {
+      return errors::FailedPrecondition("The file is already closed.");
+    }
+    return Status::OK();
+  }
+
+  /// Opens a new tmp file for the part starting at the current offset.
+  Status StartPart() {
+    TF_RETURN_IF_ERROR(GetTmpFilename(&part_filename_));
+    part_file_.open(part_filename_, std::ofstream::binary |
+                                        std::ofstream::trunc |
+                                        std::ofstream::out);
+    if (!part_file_.is_open()) {
+      return errors::Internal("Could not open the internal temporary file.");
+    }
+    part_offset_ = offset_;
+    part_bytes_ = 0;
+    return Status::OK();
+  }
+
+  /// Closes the current part and schedules its upload.
+  Status FinishPart() {
+    part_file_.close();
+    if (!part_file_.good()) {
+      std::remove(part_filename_.c_str());
+      return errors::Internal(
+          "Could not write to the internal temporary file.");
+    }
+    const string part_object =
+        strings::StrCat(io::Dirname(object_), "/.tmpcompose/",
+                        io::Basename(object_), ".part.", part_offset_);
+    {
+      mutex_lock l(mu_);
+      while (pending_parts_ >= max_pending_parts_) {
+        pending_parts_cv_.wait(l);
+      }
+      if (!upload_status_.ok()) {
+        std::remove(part_filename_.c_str());
+        return upload_status_;
+      }
+      ++pending_parts_;
+    }
+    part_objects_.push_back(part_object);
+    thread_pool_->Schedule([this, part_filename = part_filename_,
+                            part_bytes = part_bytes_, part_object]() {
+      const Status status = UploadPart(part_filename, part_bytes, part_object);
+      std::remove(part_filename.c_str());
+      mutex_lock l(mu_);
+      upload_status_.Update(status);
+      --pending_parts_;
+      pending_parts_cv_.notify_all();
+    });
+    part_bytes_ = 0;
+    return Status::OK();
+  }
+
+  /// Waits until all the scheduled parts are uploaded, and returns the first
+  /// error, if any.
+  Status WaitForPendingParts() {
+    mutex_lock l(mu_);
+    while (pending_parts_ > 0) {
+      pending_parts_cv_.wait(l);
+    }
+    return upload_status_;
+  }
+
+  /// Uploads `size` bytes in `part_filename` to `object`.
+  Status UploadPart(const string& part_filename, uint64 size,
+                    const string& object) {
+    const string gcs_path = GetGcsPathWithObject(object);
+    return RetryingUtils::CallWithRetries(
+        [&part_filename, size, &object, &gcs_path, this]() {
+          UploadSessionHandle session_handle;
+          TF_RETURN_IF_ERROR(session_creator_(0, object, bucket_, size,
+                                              gcs_path, &session_handle));
+          return object_uploader_(session_handle.session_uri, 0, 0,
+                                  part_filename, size, gcs_path);
+        },
+        retry_config_);
+  }
+
+  /// Composes the uploaded parts into the destination object, after its
+  /// current content, and deletes them.
+  Status ComposeParts() {
+    while (!part_objects_.empty()) {
+      const size_t num_parts =
+          std::min(part_objects_.size(),
+                   composed_ ? kMaxComposeSources - 1 : kMaxComposeSources);
+      string sources;
+      if (composed_) {
+        int64_t generation = 0;
+        TF_RETURN_IF_ERROR(
+            generation_getter_(GetGcsPath(), bucket_, object_, &generation));
+        sources = strings::StrCat(
+            "{'name': '", object_,
+            "','objectPrecondition':{'ifGenerationMatch':", generation, "}}");
+      }
+      for (size_t i = 0; i < num_parts; ++i) {
+        strings::StrAppend(&sources, sources.empty() ? "" : ",", "{'name': '",
+                           part_objects_[i], "'}");
+      }
+      const string request_body =
+          strings::StrCat("{'sourceObjects': [", sources, "]}");
+      TF_RETURN_IF_ERROR(RetryingUtils::CallWithRetries(
+          [&request_body, this]() {
+            std::unique_ptr<HttpRequest> request;
+            TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+            request->SetUri(strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                                            request->EscapeString(object_),
+                                            "/compose"));
+            request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                                 timeouts_->metadata);
+            request->AddHeader("content-type", "application/json");
+            request->SetPostFromBuffer(request_body.c_str(),
+                                       request_body.size());
+            TF_RETURN_WITH_CONTEXT_IF_ERROR(
+                request->Send(), " when composing to ", GetGcsPath());
+            return Status::OK();
+          },
+          retry_config_));
+      composed_ = true;
+      file_cache_erase_();
+
+      for (size_t i = 0; i < num_parts; ++i) {
+        const string part_path = GetGcsPathWithObject(part_objects_[i]);
+        TF_RETURN_IF_ERROR(RetryingUtils::DeleteWithRetries(
+            [&part_path, this]() {
+              return filesystem_->DeleteFile(part_path, nullptr);
+            },
+            retry_config_));
+      }
+      part_objects_.erase(part_objects_.begin(),
+                          part_objects_.begin() + num_parts);
+    }
+    return Status::OK();
+  }
+
+  string GetGcsPathWithObject(string object) const {
+    return strings::StrCat("gs://", bucket_, "/", object);
+  }
+  string GetGcsPath() const { return GetGcsPathWithObject(object_); }
+
+  const string bucket_;
+  const string object_;
+  GcsFileSystem* const filesystem_;  // Not owned.
+  GcsFileSystem::TimeoutConfig* timeouts_;
+  std::function<void()> file_cache_erase_;
+  const RetryConfig retry_config_;
+  const size_t part_size_;
+  thread::ThreadPool* const thread_pool_;  // Not owned.
+  const int max_pending_parts_;
+  // Callbacks to the file system used to upload object into GCS.
+  const SessionCreator session_creator_;
+  const ObjectUploader object_uploader_;
+  const GenerationGetter generation_getter_;
+
+  // The part being written, which starts at `part_offset_` of the file.
+  string part_filename_;
+  std::ofstream part_file_;
+  uint64 part_offset_ = 0;
+  size_t part_bytes_ = 0;
+  // The total number of bytes appended.
+  uint64 offset_ = 0;
+  // The temporary objects of the parts that are not yet composed, in order.
+  std::vector<string> part_objects_;
+  // Whether the destination object holds the data before `part_objects_`.
+  bool composed_ = false;
+  bool sync_needed_ = true;
+  bool closed_ = false;
+
+  mutex mu_;
+  condition_variable pending_parts_cv_;
+  int pending_parts_ TF_GUARDED_BY(mu_) = 0;
+  // The first error of the part uploads.
+  Status upload_status_ TF_GUARDED_BY(mu_);
+};
+
 class GcsReadOnlyMemoryRegion : public ReadOnlyMemoryRegion {
  public:
   GcsReadOnlyMemoryRegion(std::unique_ptr<char[]> data, uint64 length)
@@ -800,12 +1109,26 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   if (GetEnvVar(kMaxStaleness, strings::safe_strtou64, &value)) {
     max_staleness = value;
   }
+
+  if (GetEnvVar(kMaxPrefetchBlocks, strings::safe_strtou64, &value)) {
+    max_prefetch_blocks_ = value;
+  }
+
+  StringPiece disk_cache_dir;
+  if (make_default_cache &&
+      GetEnvVar(kDiskCacheDir, StringPieceIdentity, &disk_cache_dir)) {
+    disk_cache_dir_ = string(disk_cache_dir);
+  }
+  if (GetEnvVar(kDiskCacheMaxSize, strings::safe_strtou64, &value)) {
+    disk_cache_max_bytes_ = value * 1024 * 1024;
+  }
   if (!make_default_cache) {
     max_bytes = 0;
   }
   VLOG(1) << "GCS cache max size = " << max_bytes << " ; "
           << "block size = " << block_size_ << " ; "
-          << "max staleness = " << max_staleness;
+          << "max staleness = " << max_staleness << " ; "
+          << "max prefetch blocks = " << max_prefetch_blocks_;
   file_block_cache_ = MakeFileBlockCache(block_size_, max_bytes, max_staleness);
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
@@ -926,6 +1249,19 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   } else {
     compose_append_ = false;
   }
+
+  if (GetEnvVar(kParallelUploadPartSize, strings::safe_strtou64, &value) &&
+      value > 0) {
+    parallel_upload_part_size_ = value * 1024 * 1024;
+    int64_t num_threads = kDefaultParallelUploadThreads;
+    GetEnvVar(kParallelUploadThreads, strings::safe_strto64, &num_threads);
+    parallel_upload_thread_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "gcs_parallel_upload",
+        std::max<int64_t>(1, num_threads));
+    VLOG(1) << "GCS parallel composite uploads enabled: part size = "
+            << parallel_upload_part_size_
+            << ", threads = " << parallel_upload_thread_pool_->NumThreads();
+  }
 }
 
 GcsFileSystem::GcsFileSystem(
@@ -937,7 +1273,8 @@ GcsFileSystem::GcsFileSystem(
     size_t matching_paths_cache_max_entries, RetryConfig retry_config,
     TimeoutConfig timeouts, const std::unordered_set<string>& allowed_locations,
     std::pair<const string, const string>* additional_header,
-    bool compose_append)
+    bool compose_append, size_t parallel_upload_part_size,
+    int parallel_upload_threads)
     : timeouts_(timeouts),
       retry_config_(retry_config),
       auth_provider_(std::move(auth_provider)),
@@ -953,7 +1290,14 @@ GcsFileSystem::GcsFileSystem(
           kCacheNeverExpire, kBucketLocationCacheMaxEntries)),
       allowed_locations_(allowed_locations),
       compose_append_(compose_append),
-      additional_header_(additional_header) {}
+      parallel_upload_part_size_(parallel_upload_part_size),
+      additional_header_(additional_header) {
+  if (parallel_upload_part_size_ > 0) {
+    parallel_upload_thread_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "gcs_parallel_upload",
+        std::max(1, parallel_upload_threads));
+  }
+}
 
 Status GcsFileSystem::NewRandomAccessFile(
     const string& fname, TransactionToken* token,
@@ -980,6 +1324,7 @@ Status GcsFileSystem::NewRandomAccessFile(
             << "File signature has been changed. Refreshing the cache. Path: "
             << fname;
       }
+      file_block_cache_->SetFileSize(fname, stat.base.length);
       *result = StringPiece();
       size_t bytes_transferred;
       TF_RETURN_IF_ERROR(file_block_cache_->Read(fname, offset, n, scratch,
@@ -1027,13 +1372,27 @@ void GcsFileSystem::ResetFileBlockCache(size_t block_size_bytes,
 // A helper function to build a FileBlockCache for GcsFileSystem.
 std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
     size_t block_size, size_t max_bytes, uint64 max_staleness) {
+  if (!disk_cache_dir_.empty()) {
+    // The OS page cache keeps the hot blocks of the directory in memory, so
+    // there is no in-memory cache on top of it.
+    std::unique_ptr<FileBlockCache> file_block_cache(new DiskFileBlockCache(
+        block_size, disk_cache_max_bytes_, disk_cache_dir_,
+        [this](const string& filename, size_t offset, size_t n, char* buffer,
+               size_t* bytes_transferred) {
+          return LoadBufferFromGCS(filename, offset, n, buffer,
+                                   bytes_transferred);
+        }));
+    cache_enabled_ = file_block_cache->IsCacheEnabled();
+    return file_block_cache;
+  }
   std::unique_ptr<FileBlockCache> file_block_cache(new RamFileBlockCache(
       block_size, max_bytes, max_staleness,
       [this](const string& filename, size_t offset, size_t n, char* buffer,
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      Env::Default(), max_prefetch_blocks_));
 
   // Check if cache is enabled here to avoid unnecessary mutex contention.
   cache_enabled_ = file_block_cache->IsCacheEnabled();
@@ -1296,6 +1655,18 @@ Status GcsFileSystem::NewWritableFile(const string& fname,
     return Status::OK();
   };
 
+  if (parallel_upload_thread_pool_ != nullptr) {
+    // Stage up to two parts per upload thread, so the uploads don't wait for
+    // the writer.
+    result->reset(new GcsParallelUploadWritableFile(
+        bucket, object, this, &timeouts_,
+        [this, fname]() { ClearFileCaches(fname); }, retry_config_,
+        parallel_upload_part_size_, parallel_upload_thread_pool_.get(),
+        2 * parallel_upload_thread_pool_->NumThreads(), session_creator,
+        object_uploader, generation_getter));
+    return Status::OK();
+  }
+
   result->reset(new GcsWritableFile(
       bucket, object, this, &timeouts_,
       [this, fname]() { ClearFileCaches(fname); }, retry_config_,
@@ -1623,6 +1994,25 @@ Status GcsFileSystem::GetChildren(const string& dirname,
                             false /* include_self_directory_marker */);
 }
 
+Status GcsFileSystem::GetChildrenRecursive(const string& dirname,
+                                           const string& prefix,
+                                           TransactionToken* token,
+                                           std::vector<string>* result) {
+  result->clear();
+  // The objects are listed in one pass, instead of a request per directory.
+  std::vector<string> objects;
+  TF_RETURN_IF_ERROR(GetChildrenBounded(
+      dirname, UINT64_MAX, &objects, true /* recursively */,
+      false /* include_self_directory_marker */, prefix));
+  for (string& object : objects) {
+    // Skip the directory markers.
+    if (!absl::EndsWith(object, "/")) {
+      result->push_back(std::move(object));
+    }
+  }
+  return Status::OK();
+}
+
 Status GcsFileSystem::GetMatchingPaths(const string& pattern,
                                        TransactionToken* token,
                                        std::vector<string>* results) {
@@ -1637,10 +2027,14 @@ Status GcsFileSystem::GetMatchingPaths(const string& pattern,
           return errors::InvalidArgument(
               "A GCS pattern doesn't have a bucket name: ", pattern);
         }
+        // All the matches start with the fixed prefix, so only the objects
+        // that do are listed, e.g. only the "train-" objects of "train-*".
+        StringPiece name_prefix = StringPiece(fixed_prefix).substr(dir.size());
+        absl::ConsumePrefix(&name_prefix, "/");
         std::vector<string> all_files;
         TF_RETURN_IF_ERROR(GetChildrenBounded(
             dir, UINT64_MAX, &all_files, true /* recursively */,
-            false /* include_self_directory_marker */));
+            false /* include_self_directory_marker */, string(name_prefix)));
 
         const auto& files_and_folders = AddAllSubpaths(all_files);
 
@@ -1672,7 +2066,8 @@ Status GcsFileSystem::GetChildrenBounded(const string& dirname,
                                          uint64 max_results,
                                          std::vector<string>* result,
                                          bool recursive,
-                                         bool include_self_directory_marker) {
+                                         bool include_self_directory_marker,
+                                         const string& name_prefix) {
   if (!result) {
     return errors::InvalidArgument("'result' cannot be null");
   }
@@ -1696,9 +2091,10 @@ Status GcsFileSystem::GetChildrenBounded(const string& dirname,
                             "?fields=items%2Fname%2Cprefixes%2CnextPageToken");
       uri = strings::StrCat(uri, "&delimiter=%2F");
     }
-    if (!object_prefix.empty()) {
+    const string list_prefix = strings::StrCat(object_prefix, name_prefix);
+    if (!list_prefix.empty()) {
       uri = strings::StrCat(uri,
-                            "&prefix=", request->EscapeString(object_prefix));
+                            "&prefix=", request->EscapeString(list_prefix));
     }
     if (!nextPageToken.empty()) {
       uri = strings::StrCat(
@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/retrying_file_system.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 
@@ -62,6 +63,30 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that overrides the maximum number of blocks that
+// are fetched concurrently ahead of sequential reads. The readahead grows with
+// sequential access up to this limit and shrinks with random access. A value
+// of 0 (the default) disables prefetching.
+constexpr char kMaxPrefetchBlocks[] = "GCS_READ_CACHE_MAX_PREFETCH_BLOCKS";
+constexpr size_t kDefaultMaxPrefetchBlocks = 0;
+// The environment variable that enables the persistent block cache in a local
+// directory, e.g. on an NVMe drive. The directory can be shared by several
+// processes on the host. It replaces the in-memory block cache.
+constexpr char kDiskCacheDir[] = "GCS_READ_CACHE_DISK_DIR";
+// The environment variable that overrides the maximum size (in MB) of the
+// blocks in the persistent block cache directory.
+constexpr char kDiskCacheMaxSize[] = "GCS_READ_CACHE_DISK_MAX_SIZE_MB";
+constexpr size_t kDefaultDiskCacheMaxSize = 10ULL * 1024 * 1024 * 1024;
+// The environment variable that enables parallel composite uploads of
+// writable files. The data is uploaded concurrently in parts of this many MB,
+// which are composed into the object on Sync() and Close(). A value of 0 (the
+// default) uploads the whole file in one request.
+constexpr char kParallelUploadPartSize[] = "GCS_PARALLEL_UPLOAD_PART_SIZE_MB";
+constexpr size_t kDefaultParallelUploadPartSize = 0;
+// The environment variable that overrides the number of parts that are
+// uploaded concurrently.
+constexpr char kParallelUploadThreads[] = "GCS_PARALLEL_UPLOAD_THREADS";
+constexpr int kDefaultParallelUploadThreads = 8;
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -140,7 +165,8 @@ class GcsFileSystem : public FileSystem {
                 RetryConfig retry_config, TimeoutConfig timeouts,
                 const std::unordered_set<string>& allowed_locations,
                 std::pair<const string, const string>* additional_header,
-                bool compose_append);
+                bool compose_append, size_t parallel_upload_part_size = 0,
+                int parallel_upload_threads = kDefaultParallelUploadThreads);
 
   TF_USE_FILESYSTEM_METHODS_WITH_NO_TRANSACTION_SUPPORT;
 
@@ -166,6 +192,10 @@ class GcsFileSystem : public FileSystem {
   Status GetChildren(const string& dir, TransactionToken* token,
                      std::vector<string>* result) override;
 
+  Status GetChildrenRecursive(const string& dir, const string& prefix,
+                              TransactionToken* token,
+                              std::vector<string>* result) override;
+
   Status GetMatchingPaths(const string& pattern, TransactionToken* token,
                           std::vector<string>* results) override;
 
@@ -215,6 +245,9 @@ class GcsFileSystem : public FileSystem {
   }
 
   bool compose_append() const { return compose_append_; }
+  size_t parallel_upload_part_size() const {
+    return parallel_upload_part_size_;
+  }
   string additional_header_name() const {
     return additional_header_ ? additional_header_->first : "";
   }
@@ -390,9 +423,13 @@ class GcsFileSystem : public FileSystem {
   /// If 'include_self_directory_marker' is true and there is a GCS directory
   /// marker at the path 'dir', GetChildrenBound will return an empty string
   /// as one of the children that represents this marker.
+  ///
+  /// If 'name_prefix' is not empty, only the children whose name starts with
+  /// it are listed. The filtering is done by GCS.
   Status GetChildrenBounded(const string& dir, uint64 max_results,
                             std::vector<string>* result, bool recursively,
-                            bool include_self_directory_marker);
+                            bool include_self_directory_marker,
+                            const string& name_prefix = "");
 
   /// Retrieves file statistics assuming fname points to a GCS object. The data
   /// may be read from cache or from GCS directly.
@@ -415,6 +452,15 @@ class GcsFileSystem : public FileSystem {
   // Reads smaller than block_size_ will trigger a read of block_size_.
   uint64 block_size_;
 
+  // The maximum number of blocks the block cache prefetches after sequential
+  // reads.
+  size_t max_prefetch_blocks_ = kDefaultMaxPrefetchBlocks;
+
+  // The directory of the persistent block cache, and its maximum size. The
+  // persistent cache is disabled if the directory is empty.
+  string disk_cache_dir_;
+  size_t disk_cache_max_bytes_ = kDefaultDiskCacheMaxSize;
+
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
@@ -436,11 +482,19 @@ class GcsFileSystem : public FileSystem {
   std::unordered_set<string> allowed_locations_;
   bool compose_append_;
 
+  // The size in bytes of the parts of parallel composite uploads, 0 if they
+  // are disabled.
+  size_t parallel_upload_part_size_ = kDefaultParallelUploadPartSize;
+
   GcsStatsInterface* stats_ = nullptr;  // Not owned.
 
   // Additional header material to be transmitted with all GCS requests
   std::unique_ptr<std::pair<const string, const string>> additional_header_;
 
+  // Uploads the parts of parallel composite uploads. Only created if they are
+  // enabled.
+  std::unique_ptr<thread::ThreadPool> parallel_upload_thread_pool_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GcsFileSystem);
 };
 
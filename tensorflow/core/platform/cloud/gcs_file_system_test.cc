@@ -1341,6 +1341,122 @@ TEST(GcsFileSystemTest, NewWritableFile_NoObjectName) {
             fs.NewWritableFile("gs://bucket/", nullptr, &file).code());
 }
 
+TEST(GcsFileSystemTest, NewWritableFile_ParallelUpload) {
+  std::vector<HttpRequest*> requests;
+  // The parts are uploaded as temporary objects named by their offset.
+  const std::vector<std::pair<int, string>> parts(
+      {{0, "content1"}, {8, ",content"}, {16, "2"}});
+  for (const auto& part : parts) {
+    requests.push_back(new FakeHttpRequest(
+        strings::StrCat("Uri: https://www.googleapis.com/upload/storage/v1/b/"
+                        "bucket/o?uploadType=resumable&name=path%2F."
+                        "tmpcompose%2Fwriteable.part.",
+                        part.first,
+                        "\n"
+                        "Auth Token: fake_token\n"
+                        "Header X-Upload-Content-Length: ",
+                        part.second.size(),
+                        "\n"
+                        "Post: yes\n"
+                        "Timeouts: 5 1 10\n"),
+        "", {{"Location", "https://custom/upload/location"}}));
+    requests.push_back(new FakeHttpRequest(
+        strings::StrCat("Uri: https://custom/upload/location\n"
+                        "Auth Token: fake_token\n"
+                        "Header Content-Range: bytes 0-",
+                        part.second.size() - 1, "/", part.second.size(),
+                        "\n"
+                        "Timeouts: 5 1 30\n"
+                        "Put body: ",
+                        part.second, "\n"),
+        ""));
+  }
+  // Compose all the parts into the object.
+  requests.push_back(new FakeHttpRequest(
+      "Uri: https://www.googleapis.com/storage/v1/b/bucket/o/"
+      "path%2Fwriteable/compose\n"
+      "Auth Token: fake_token\n"
+      "Timeouts: 5 1 10\n"
+      "Header content-type: application/json\n"
+      "Post body: {'sourceObjects': ["
+      "{'name': 'path/.tmpcompose/writeable.part.0'},"
+      "{'name': 'path/.tmpcompose/writeable.part.8'},"
+      "{'name': 'path/.tmpcompose/writeable.part.16'}]}\n",
+      ""));
+  // Delete the temporary objects.
+  for (const auto& part : parts) {
+    requests.push_back(new FakeHttpRequest(
+        strings::StrCat("Uri: https://www.googleapis.com/storage/v1/b/bucket/o/"
+                        "path%2F.tmpcompose%2Fwriteable.part.",
+                        part.first,
+                        "\n"
+                        "Auth Token: fake_token\n"
+                        "Timeouts: 5 1 10\n"
+                        "Delete: yes\n"),
+        ""));
+  }
+  // A single upload thread keeps the order of the requests deterministic.
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 0 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */,
+      8 /* parallel upload part size */, 1 /* parallel upload threads */);
+
+  std::unique_ptr<WritableFile> wfile;
+  TF_EXPECT_OK(
+      fs.NewWritableFile("gs://bucket/path/writeable", nullptr, &wfile));
+  TF_EXPECT_OK(wfile->Append("content1,"));
+  TF_EXPECT_OK(wfile->Append("content2"));
+  int64_t pos;
+  TF_EXPECT_OK(wfile->Tell(&pos));
+  EXPECT_EQ(17, pos);
+  TF_EXPECT_OK(wfile->Close());
+  // Closing again is a no-op.
+  TF_EXPECT_OK(wfile->Close());
+}
+
+TEST(GcsFileSystemTest, NewWritableFile_ParallelUploadSinglePart) {
+  // A file smaller than a part is uploaded directly to the object.
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=resumable&name=path%2Fwriteable\n"
+           "Auth Token: fake_token\n"
+           "Header X-Upload-Content-Length: 9\n"
+           "Post: yes\n"
+           "Timeouts: 5 1 10\n",
+           "", {{"Location", "https://custom/upload/location"}}),
+       new FakeHttpRequest("Uri: https://custom/upload/location\n"
+                           "Auth Token: fake_token\n"
+                           "Header Content-Range: bytes 0-8/9\n"
+                           "Timeouts: 5 1 30\n"
+                           "Put body: content1,\n",
+                           "")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 0 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */,
+      16 /* parallel upload part size */, 1 /* parallel upload threads */);
+
+  std::unique_ptr<WritableFile> wfile;
+  TF_EXPECT_OK(
+      fs.NewWritableFile("gs://bucket/path/writeable", nullptr, &wfile));
+  TF_EXPECT_OK(wfile->Append("content1,"));
+  TF_EXPECT_OK(wfile->Close());
+}
+
 TEST(GcsFileSystemTest, NewAppendableFile) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
@@ -1934,10 +2050,38 @@ TEST(GcsFileSystemTest, GetChildren_Pagination) {
             children);
 }
 
+TEST(GcsFileSystemTest, GetChildrenRecursive) {
+  std::vector<HttpRequest*> requests({new FakeHttpRequest(
+      "Uri: https://www.googleapis.com/storage/v1/b/bucket/o?"
+      "fields=items%2Fname%2CnextPageToken&prefix=path%2Ffile\n"
+      "Auth Token: fake_token\n"
+      "Timeouts: 5 1 10\n",
+      "{\"items\": [ "
+      "  { \"name\": \"path/file1.txt\" },"
+      "  { \"name\": \"path/files/\" },"
+      "  { \"name\": \"path/files/file2.txt\" }]}")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 0 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+
+  std::vector<string> children;
+  TF_EXPECT_OK(
+      fs.GetChildrenRecursive("gs://bucket/path", "file", nullptr, &children));
+  EXPECT_EQ(std::vector<string>({"file1.txt", "files/file2.txt"}), children);
+}
+
 TEST(GcsFileSystemTest, GetMatchingPaths_NoWildcard) {
   std::vector<HttpRequest*> requests({new FakeHttpRequest(
       "Uri: https://www.googleapis.com/storage/v1/b/bucket/o?"
-      "fields=items%2Fname%2CnextPageToken&prefix=path%2Fsubpath%2F\n"
+      "fields=items%2Fname%2CnextPageToken&prefix=path%2Fsubpath%2F"
+      "file2.txt\n"
       "Auth Token: fake_token\n"
       "Timeouts: 5 1 10\n",
       "{\"items\": [ "
@@ -2017,6 +2161,37 @@ TEST(GcsFileSystemTest, GetMatchingPaths_FolderAndWildcard_Matches) {
             result);
 }
 
+TEST(GcsFileSystemTest, GetMatchingPaths_NamePrefix) {
+  // Only the objects that start with the fixed prefix of the pattern are
+  // listed.
+  std::vector<HttpRequest*> requests({new FakeHttpRequest(
+      "Uri: https://www.googleapis.com/storage/v1/b/bucket/o?"
+      "fields=items%2Fname%2CnextPageToken&prefix=path%2Ftrain-\n"
+      "Auth Token: fake_token\n"
+      "Timeouts: 5 1 10\n",
+      "{\"items\": [ "
+      "  { \"name\": \"path/train-00000-of-00002\" },"
+      "  { \"name\": \"path/train-00001-of-00002\" },"
+      "  { \"name\": \"path/train-stats/summary\" }]}")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 0 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+
+  std::vector<string> result;
+  TF_EXPECT_OK(
+      fs.GetMatchingPaths("gs://bucket/path/train-*-of-*", nullptr, &result));
+  EXPECT_EQ(std::vector<string>({"gs://bucket/path/train-00000-of-00002",
+                                 "gs://bucket/path/train-00001-of-00002"}),
+            result);
+}
+
 TEST(GcsFileSystemTest, GetMatchingPaths_SelfDirectoryMarker) {
   std::vector<HttpRequest*> requests({new FakeHttpRequest(
       "Uri: https://www.googleapis.com/storage/v1/b/bucket/o?"
@@ -2141,7 +2316,8 @@ TEST(GcsFileSystemTest, GetMatchingPaths_Cache) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
            "Uri: https://www.googleapis.com/storage/v1/b/bucket/o?"
-           "fields=items%2Fname%2CnextPageToken&prefix=path%2Fsubpath%2F\n"
+           "fields=items%2Fname%2CnextPageToken&prefix=path%2Fsubpath%2F"
+           "file2.txt\n"
            "Auth Token: fake_token\n"
            "Timeouts: 5 1 10\n",
            "{\"items\": [ "
@@ -2186,14 +2362,16 @@ TEST(GcsFileSystemTest, GetMatchingPaths_Cache_Flush) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
            "Uri: https://www.googleapis.com/storage/v1/b/bucket/o?"
-           "fields=items%2Fname%2CnextPageToken&prefix=path%2Fsubpath%2F\n"
+           "fields=items%2Fname%2CnextPageToken&prefix=path%2Fsubpath%2F"
+           "file2.txt\n"
            "Auth Token: fake_token\n"
            "Timeouts: 5 1 10\n",
            "{\"items\": [ "
            "  { \"name\": \"path/subpath/file2.txt\" }]}"),
        new FakeHttpRequest(
            "Uri: https://www.googleapis.com/storage/v1/b/bucket/o?"
-           "fields=items%2Fname%2CnextPageToken&prefix=path%2Fsubpath%2F\n"
+           "fields=items%2Fname%2CnextPageToken&prefix=path%2Fsubpath%2F"
+           "file2.txt\n"
            "Auth Token: fake_token\n"
            "Timeouts: 5 1 10\n",
            "{\"items\": [ "
@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
 #include <cstring>
 #include <memory>
+#include <utility>
+#include <vector>
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/env.h"
 
@@ -46,6 +48,11 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
     }
   }
 
+  return Insert_Locked(key);
+}
+
+std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Insert_Locked(
+    const Key& key) {
   // Insert a new empty block, setting the bookkeeping to sentinel values
   // in order to update them as appropriate.
   auto new_entry = std::make_shared<Block>();
@@ -58,6 +65,54 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
   return new_entry;
 }
 
+void RamFileBlockCache::MaybePrefetch(const string& filename, size_t offset,
+                                      size_t n, size_t start, size_t finish) {
+  if (prefetch_thread_pool_ == nullptr) return;
+  std::vector<std::pair<Key, std::shared_ptr<Block>>> blocks_to_fetch;
+  {
+    mutex_lock lock(mu_);
+    auto it = readahead_map_.find(filename);
+    if (it == readahead_map_.end()) {
+      // Without the file size we could fetch blocks past EOF, which would make
+      // the last partial block look inconsistent.
+      return;
+    }
+    ReadaheadState& state = it->second;
+    if (offset == state.next_offset) {
+      state.window = std::min(max_prefetch_blocks_,
+                              std::max<size_t>(1, 2 * state.window));
+    } else {
+      state.window /= 2;
+    }
+    state.next_offset = offset + n;
+
+    const uint64 limit =
+        std::min<uint64>(state.file_size, finish + state.window * block_size_);
+    // The first block is fetched by the reader itself.
+    for (uint64 pos = start + block_size_; pos < limit; pos += block_size_) {
+      Key key = std::make_pair(filename, pos);
+      if (block_map_.find(key) != block_map_.end()) continue;
+      blocks_to_fetch.emplace_back(key, Insert_Locked(key));
+    }
+  }
+
+  for (auto& key_and_block : blocks_to_fetch) {
+    prefetch_thread_pool_->Schedule(
+        [this, key = std::move(key_and_block.first),
+         block = std::move(key_and_block.second)]() {
+          {
+            mutex_lock l(block->mu);
+            // A reader got to the block first.
+            if (block->state != FetchState::CREATED) return;
+          }
+          // Errors are left to the reader, which will refetch the block.
+          if (MaybeFetch(key, block).ok()) {
+            UpdateLRU(key, block).IgnoreError();
+          }
+        });
+  }
+}
+
 // Remove blocks from the cache until we do not exceed our maximum size.
 void RamFileBlockCache::Trim() {
   while (!lru_list_.empty() && cache_size_ > max_bytes_) {
@@ -182,6 +237,7 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
   if (finish < offset + n) {
     finish += block_size_;
   }
+  MaybePrefetch(filename, offset, n, start, finish);
   size_t total_bytes_transferred = 0;
   // Now iterate through the blocks, reading them one at a time.
   for (size_t pos = start; pos < finish; pos += block_size_) {
@@ -244,6 +300,13 @@ bool RamFileBlockCache::ValidateAndUpdateFileSignature(const string& filename,
   return true;
 }
 
+void RamFileBlockCache::SetFileSize(const string& filename,
+                                    uint64 file_size) {
+  if (prefetch_thread_pool_ == nullptr) return;
+  mutex_lock lock(mu_);
+  readahead_map_[filename].file_size = file_size;
+}
+
 size_t RamFileBlockCache::CacheSize() const {
   mutex_lock lock(mu_);
   return cache_size_;
@@ -271,12 +334,14 @@ void RamFileBlockCache::Flush() {
   block_map_.clear();
   lru_list_.clear();
   lra_list_.clear();
+  readahead_map_.clear();
   cache_size_ = 0;
 }
 
 void RamFileBlockCache::RemoveFile(const string& filename) {
   mutex_lock lock(mu_);
   RemoveFile_Locked(filename);
+  readahead_map_.erase(filename);
 }
 
 void RamFileBlockCache::RemoveFile_Locked(const string& filename) {
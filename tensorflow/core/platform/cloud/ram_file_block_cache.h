@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 #define TENSORFLOW_CORE_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 
+#include <algorithm>
 #include <functional>
 #include <list>
 #include <map>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/stringpiece.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -38,6 +40,12 @@ namespace tensorflow {
 ///
 /// This class should be shared by read-only random access files on a remote
 /// filesystem (e.g. GCS).
+///
+/// If `max_prefetch_blocks` is positive, the blocks following a sequential read
+/// are fetched concurrently on a thread pool and land in the cache. The number
+/// of prefetched blocks doubles on each sequential read of a file, up to
+/// `max_prefetch_blocks`, and halves on each non-sequential read. Blocks are
+/// only prefetched for files whose size has been set with `SetFileSize`.
 class RamFileBlockCache : public FileBlockCache {
  public:
   /// The callback executed when a block is not found in the cache, and needs to
@@ -51,21 +59,36 @@ class RamFileBlockCache : public FileBlockCache {
       BlockFetcher;
 
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                    BlockFetcher block_fetcher, Env* env = Env::Default())
+                    BlockFetcher block_fetcher, Env* env = Env::Default(),
+                    size_t max_prefetch_blocks = 0)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
+        // Leave at least half of the cache to the blocks being read, so that
+        // prefetched blocks don't evict each other before they are read.
+        max_prefetch_blocks_(
+            block_size > 0
+                ? std::min(max_prefetch_blocks, max_bytes / block_size / 2)
+                : 0),
         block_fetcher_(block_fetcher),
         env_(env) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
     }
+    if (IsCacheEnabled() && max_prefetch_blocks_ > 0) {
+      prefetch_thread_pool_ = std::make_unique<thread::ThreadPool>(
+          env_, "TF_prefetch_FBC", max_prefetch_blocks_);
+    }
     VLOG(1) << "GCS file block cache is "
-            << (IsCacheEnabled() ? "enabled" : "disabled");
+            << (IsCacheEnabled() ? "enabled" : "disabled")
+            << ", max prefetch blocks = " << max_prefetch_blocks_;
   }
 
   ~RamFileBlockCache() override {
+    // Destroying prefetch_thread_pool_ will block until the pending prefetches
+    // are done.
+    prefetch_thread_pool_.reset();
     if (pruning_thread_) {
       stop_pruning_thread_.Notify();
       // Destroying pruning_thread_ will block until Prune() receives the above
@@ -99,6 +122,9 @@ class RamFileBlockCache : public FileBlockCache {
                                       int64_t file_signature) override
       TF_LOCKS_EXCLUDED(mu_);
 
+  void SetFileSize(const string& filename, uint64 file_size) override
+      TF_LOCKS_EXCLUDED(mu_);
+
   /// Remove all cached blocks for `filename`.
   void RemoveFile(const string& filename) override TF_LOCKS_EXCLUDED(mu_);
 
@@ -109,6 +135,7 @@ class RamFileBlockCache : public FileBlockCache {
   size_t block_size() const override { return block_size_; }
   size_t max_bytes() const override { return max_bytes_; }
   uint64 max_staleness() const override { return max_staleness_; }
+  size_t max_prefetch_blocks() const { return max_prefetch_blocks_; }
 
   /// The current size (in bytes) of the cache.
   size_t CacheSize() const override TF_LOCKS_EXCLUDED(mu_);
@@ -127,6 +154,8 @@ class RamFileBlockCache : public FileBlockCache {
   const size_t max_bytes_;
   /// The maximum staleness of any block in the LRU cache, in seconds.
   const uint64 max_staleness_;
+  /// The maximum number of blocks prefetched after a read.
+  const size_t max_prefetch_blocks_;
   /// The callback to read a block from the underlying filesystem.
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
@@ -188,6 +217,17 @@ class RamFileBlockCache : public FileBlockCache {
   /// The block map is an ordered map from Key to Block.
   typedef std::map<Key, std::shared_ptr<Block>> BlockMap;
 
+  /// \brief The readahead state of a file.
+  struct ReadaheadState {
+    /// The size of the file.
+    uint64 file_size = 0;
+    /// The offset right after the last read, which is where the next read
+    /// starts if the file is read sequentially.
+    size_t next_offset = 0;
+    /// The number of blocks to prefetch after the next read.
+    size_t window = 0;
+  };
+
   /// Prune the cache by removing files with expired blocks.
   void Prune() TF_LOCKS_EXCLUDED(mu_);
 
@@ -197,6 +237,17 @@ class RamFileBlockCache : public FileBlockCache {
   /// Look up a Key in the block cache.
   std::shared_ptr<Block> Lookup(const Key& key) TF_LOCKS_EXCLUDED(mu_);
 
+  /// Insert a new empty block for `key`, which must not be in the cache.
+  std::shared_ptr<Block> Insert_Locked(const Key& key)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Update the readahead state of `filename` for a read of `n` bytes at
+  /// `offset`, and schedule the fetches of the blocks in the readahead window,
+  /// as well as the blocks of the read other than the first. `start` and
+  /// `finish` are the block-aligned start and end of the read.
+  void MaybePrefetch(const string& filename, size_t offset, size_t n,
+                     size_t start, size_t finish) TF_LOCKS_EXCLUDED(mu_);
+
   Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
       TF_LOCKS_EXCLUDED(mu_);
 
@@ -243,6 +294,12 @@ class RamFileBlockCache : public FileBlockCache {
 
   // A filename->file_signature map.
   std::map<string, int64_t> file_signature_map_ TF_GUARDED_BY(mu_);
+
+  /// The readahead states of the files with a known size.
+  std::map<string, ReadaheadState> readahead_map_ TF_GUARDED_BY(mu_);
+
+  /// The thread pool running the prefetches. Null if prefetching is disabled.
+  std::unique_ptr<thread::ThreadPool> prefetch_thread_pool_;
 };
 
 }  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
 
 #include <cstring>
+#include <map>
 
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/blocking_counter.h"
@@ -566,5 +567,67 @@ TEST(RamFileBlockCacheTest, Flush) {
   EXPECT_EQ(calls, 2);
 }
 
+TEST(RamFileBlockCacheTest, PrefetchSequentialReads) {
+  const size_t block_size = 8;
+  const size_t file_size = 4 * block_size;
+  mutex mu;
+  std::map<size_t, int> fetches;
+  auto fetcher = [&mu, &fetches, file_size](
+                     const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    {
+      mutex_lock l(mu);
+      fetches[offset]++;
+    }
+    *bytes_transferred = std::min(n, file_size - std::min(offset, file_size));
+    memset(buffer, 'x', *bytes_transferred);
+    return Status::OK();
+  };
+  {
+    RamFileBlockCache cache(block_size, 8 * block_size, 0, fetcher,
+                            Env::Default(), /*max_prefetch_blocks=*/4);
+    EXPECT_EQ(cache.max_prefetch_blocks(), 4);
+    cache.SetFileSize("a", file_size);
+    std::vector<char> out;
+    // The first read prefetches one block, and the second one prefetches the
+    // two remaining blocks of the file.
+    TF_EXPECT_OK(ReadCache(&cache, "a", 0, block_size, &out));
+    TF_EXPECT_OK(ReadCache(&cache, "a", block_size, block_size, &out));
+    // The cache destructor waits for the pending prefetches.
+  }
+  std::map<size_t, int> expected = {{0, 1}, {8, 1}, {16, 1}, {24, 1}};
+  EXPECT_EQ(fetches, expected);
+}
+
+TEST(RamFileBlockCacheTest, PrefetchShrinksOnRandomReads) {
+  const size_t block_size = 8;
+  mutex mu;
+  std::map<size_t, int> fetches;
+  auto fetcher = [&mu, &fetches](const string& filename, size_t offset,
+                                 size_t n, char* buffer,
+                                 size_t* bytes_transferred) {
+    {
+      mutex_lock l(mu);
+      fetches[offset]++;
+    }
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  {
+    RamFileBlockCache cache(block_size, 8 * block_size, 0, fetcher,
+                            Env::Default(), /*max_prefetch_blocks=*/4);
+    cache.SetFileSize("a", 8 * block_size);
+    std::vector<char> out;
+    TF_EXPECT_OK(ReadCache(&cache, "a", 0, block_size, &out));
+    // A non-sequential read shuts the readahead window.
+    TF_EXPECT_OK(ReadCache(&cache, "a", 5 * block_size, block_size, &out));
+    // No prefetch for files of unknown size.
+    TF_EXPECT_OK(ReadCache(&cache, "b", 0, block_size, &out));
+  }
+  std::map<size_t, int> expected = {{0, 2}, {8, 1}, {40, 1}};
+  EXPECT_EQ(fetches, expected);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,1116 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/s3_file_system.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <utility>
+
+#include "absl/strings/match.h"
+#include "absl/strings/strip.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/cloud/curl_http_request.h"
+#include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
+#include "tensorflow/core/platform/cloud/time_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system_helper.h"
+#include "tensorflow/core/platform/hash.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numbers.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/retrying_utils.h"
+#include "tensorflow/core/platform/str_util.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+
+namespace {
+
+/// Reads the unsigned integer environment variable `varname` into `value`, and
+/// returns true if it is set and valid.
+bool GetEnvUint64(const char* varname, uint64* value) {
+  const char* env_value = std::getenv(varname);
+  return env_value != nullptr && strings::safe_strtou64(env_value, value);
+}
+
+/// Reads the string environment variable `varname` into `value`, and returns
+/// true if it is set and not empty.
+bool GetEnvString(const char* varname, string* value) {
+  const char* env_value = std::getenv(varname);
+  if (env_value == nullptr || *env_value == '\0') {
+    return false;
+  }
+  *value = env_value;
+  return true;
+}
+
+/// Appends a trailing slash if the name doesn't already have one.
+string MaybeAppendSlash(const string& name) {
+  if (name.empty() || name.back() == '/') {
+    return name;
+  }
+  return strings::StrCat(name, "/");
+}
+
+string XmlUnescape(StringPiece str) {
+  string result;
+  result.reserve(str.size());
+  while (!str.empty()) {
+    if (str[0] == '&') {
+      static const auto* const kEntities =
+          new std::vector<std::pair<StringPiece, char>>({{"&amp;", '&'},
+                                                         {"&lt;", '<'},
+                                                         {"&gt;", '>'},
+                                                         {"&quot;", '"'},
+                                                         {"&apos;", '\''}});
+      bool unescaped = false;
+      for (const auto& entity : *kEntities) {
+        if (absl::ConsumePrefix(&str, entity.first)) {
+          result.push_back(entity.second);
+          unescaped = true;
+          break;
+        }
+      }
+      if (unescaped) continue;
+    }
+    result.push_back(str[0]);
+    str.remove_prefix(1);
+  }
+  return result;
+}
+
+/// Returns the raw contents of the `tag` elements of `xml`, in order. The S3
+/// responses don't nest elements of the same tag, so no parser is needed.
+std::vector<StringPiece> XmlElements(StringPiece xml, const string& tag) {
+  const string open_tag = strings::StrCat("<", tag, ">");
+  const string close_tag = strings::StrCat("</", tag, ">");
+  std::vector<StringPiece> result;
+  while (true) {
+    const size_t begin = xml.find(open_tag);
+    if (begin == StringPiece::npos) break;
+    xml.remove_prefix(begin + open_tag.size());
+    const size_t end = xml.find(close_tag);
+    if (end == StringPiece::npos) break;
+    result.push_back(xml.substr(0, end));
+    xml.remove_prefix(end + close_tag.size());
+  }
+  return result;
+}
+
+/// Returns the unescaped contents of the first `tag` element of `xml`, or an
+/// empty string.
+string XmlElement(StringPiece xml, const string& tag) {
+  const std::vector<StringPiece> elements = XmlElements(xml, tag);
+  return elements.empty() ? "" : XmlUnescape(elements[0]);
+}
+
+/// S3 reports some errors of requests that started successfully in the body of
+/// a 200 response.
+Status CheckXmlError(StringPiece response, const string& context) {
+  if (!absl::StrContains(response, "<Error>")) {
+    return Status::OK();
+  }
+  return errors::Internal(XmlElement(response, "Code"), ": ",
+                          XmlElement(response, "Message"), " ", context);
+}
+
+/// An S3-based implementation of a random access file.
+class S3RandomAccessFile : public RandomAccessFile {
+ public:
+  using ReadFn =
+      std::function<Status(const string& filename, uint64 offset, size_t n,
+                           StringPiece* result, char* scratch)>;
+
+  S3RandomAccessFile(const string& filename, ReadFn read_fn)
+      : filename_(filename), read_fn_(std::move(read_fn)) {}
+
+  Status Name(StringPiece* result) const override {
+    *result = filename_;
+    return Status::OK();
+  }
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    return read_fn_(filename_, offset, n, result, scratch);
+  }
+
+ private:
+  const string filename_;
+  const ReadFn read_fn_;
+};
+
+/// An in-memory copy of an S3 object.
+class S3ReadOnlyMemoryRegion : public ReadOnlyMemoryRegion {
+ public:
+  S3ReadOnlyMemoryRegion(std::unique_ptr<char[]> data, uint64 length)
+      : data_(std::move(data)), length_(length) {}
+  const void* data() override { return reinterpret_cast<void*>(data_.get()); }
+  uint64 length() override { return length_; }
+
+ private:
+  std::unique_ptr<char[]> data_;
+  uint64 length_;
+};
+
+}  // namespace
+
+/// \brief S3-based implementation of a writeable file.
+///
+/// The data is staged in local tmp files of one part each. Once the first part
+/// fills up, a multipart upload is started and each full part is uploaded on
+/// the file system's thread pool while the next one is written. At most two
+/// parts per thread are staged at any time. Close() uploads the last part and
+/// completes the upload, or uploads the whole file with a single PUT if it
+/// fits in one part.
+class S3WritableFile : public WritableFile {
+ public:
+  S3WritableFile(const string& bucket, const string& object,
+                 S3FileSystem* filesystem)
+      : bucket_(bucket),
+        object_(object),
+        filesystem_(filesystem),
+        part_size_(
+            std::max<size_t>(1, filesystem->config_.multipart_part_size)),
+        max_pending_parts_(2 * filesystem->thread_pool_->NumThreads()) {}
+
+  ~S3WritableFile() override {
+    Close().IgnoreError();
+    if (part_file_.is_open()) {
+      part_file_.close();
+      std::remove(part_filename_.c_str());
+    }
+  }
+
+  Status Append(StringPiece data) override {
+    TF_RETURN_IF_ERROR(CheckWritable());
+    while (!data.empty()) {
+      if (!part_file_.is_open()) {
+        TF_RETURN_IF_ERROR(StartPart());
+      }
+      const size_t n = std::min(data.size(), part_size_ - part_bytes_);
+      part_file_.write(data.data(), n);
+      if (!part_file_.good()) {
+        return errors::Internal(
+            "Could not append to the internal temporary file.");
+      }
+      part_bytes_ += n;
+      offset_ += n;
+      data.remove_prefix(n);
+      if (part_bytes_ == part_size_) {
+        TF_RETURN_IF_ERROR(FinishPart());
+      }
+    }
+    return Status::OK();
+  }
+
+  Status Close() override {
+    if (closed_) {
+      return Status::OK();
+    }
+    closed_ = true;
+    Status status = Upload();
+    filesystem_->ClearFileCaches(GetS3Path());
+    return status;
+  }
+
+  // The object is only written on Close().
+  Status Flush() override { return CheckWritable(); }
+  Status Sync() override { return CheckWritable(); }
+
+  Status Name(StringPiece* result) const override {
+    return errors::Unimplemented("S3WritableFile does not support Name()");
+  }
+
+  Status Tell(int64_t* position) override {
+    *position = offset_;
+    return Status::OK();
+  }
+
+ private:
+  Status CheckWritable() const {
+    if (closed_) {
+      return errors::FailedPrecondition("The file is already closed.");
+    }
+    return Status::OK();
+  }
+
+  Status StartPart() {
+    part_filename_ = io::GetTempFilename("");
+    part_file_.open(part_filename_, std::ofstream::binary |
+                                        std::ofstream::trunc |
+                                        std::ofstream::out);
+    if (!part_file_.is_open()) {
+      return errors::Internal("Could not open the internal temporary file.");
+    }
+    part_bytes_ = 0;
+    return Status::OK();
+  }
+
+  /// Closes the current part and schedules its upload.
+  Status FinishPart() {
+    part_file_.close();
+    if (!part_file_.good()) {
+      std::remove(part_filename_.c_str());
+      return errors::Internal(
+          "Could not write to the internal temporary file.");
+    }
+    if (upload_id_.empty()) {
+      Status status = filesystem_->CreateMultipartUpload(bucket_, object_,
+                                                         &upload_id_);
+      if (!status.ok()) {
+        std::remove(part_filename_.c_str());
+        return status;
+      }
+    }
+    int part_number;
+    {
+      mutex_lock l(mu_);
+      while (pending_parts_ >= max_pending_parts_) {
+        pending_parts_cv_.wait(l);
+      }
+      if (!upload_status_.ok()) {
+        std::remove(part_filename_.c_str());
+        return upload_status_;
+      }
+      ++pending_parts_;
+      etags_.emplace_back();
+      part_number = etags_.size();
+    }
+    filesystem_->thread_pool_->Schedule(
+        [this, part_filename = part_filename_, part_number]() {
+          string etag;
+          const Status status = filesystem_->UploadPart(
+              bucket_, object_, upload_id_, part_number, part_filename, &etag);
+          std::remove(part_filename.c_str());
+          mutex_lock l(mu_);
+          etags_[part_number - 1] = etag;
+          upload_status_.Update(status);
+          --pending_parts_;
+          pending_parts_cv_.notify_all();
+        });
+    part_bytes_ = 0;
+    return Status::OK();
+  }
+
+  /// Waits until all the scheduled parts are uploaded, and returns the first
+  /// error, if any.
+  Status WaitForPendingParts() {
+    mutex_lock l(mu_);
+    while (pending_parts_ > 0) {
+      pending_parts_cv_.wait(l);
+    }
+    return upload_status_;
+  }
+
+  Status Upload() {
+    if (upload_id_.empty()) {
+      // The whole file fits in one part.
+      if (!part_file_.is_open()) {
+        // Create the empty object.
+        TF_RETURN_IF_ERROR(StartPart());
+      }
+      part_file_.close();
+      Status status =
+          part_file_.good()
+              ? filesystem_->PutObject(bucket_, object_, part_filename_)
+              : errors::Internal(
+                    "Could not write to the internal temporary file.");
+      std::remove(part_filename_.c_str());
+      return status;
+    }
+    Status status;
+    if (part_file_.is_open()) {
+      status = FinishPart();
+    }
+    status.Update(WaitForPendingParts());
+    if (status.ok()) {
+      mutex_lock l(mu_);
+      status = filesystem_->CompleteMultipartUpload(bucket_, object_,
+                                                    upload_id_, etags_);
+    }
+    if (!status.ok()) {
+      // Don't leave the uploaded parts behind, as they are billed.
+      filesystem_->AbortMultipartUpload(bucket_, object_, upload_id_)
+          .IgnoreError();
+    }
+    return status;
+  }
+
+  string GetS3Path() const {
+    return strings::StrCat("s3://", bucket_, "/", object_);
+  }
+
+  const string bucket_;
+  const string object_;
+  S3FileSystem* const filesystem_;  // Not owned.
+  const size_t part_size_;
+  const int max_pending_parts_;
+
+  string part_filename_;
+  std::ofstream part_file_;
+  size_t part_bytes_ = 0;
+  uint64 offset_ = 0;
+  // Set once the first part is full.
+  string upload_id_;
+  bool closed_ = false;
+
+  mutex mu_;
+  condition_variable pending_parts_cv_;
+  int pending_parts_ TF_GUARDED_BY(mu_) = 0;
+  // The ETags of the parts, indexed by part number - 1.
+  std::vector<string> etags_ TF_GUARDED_BY(mu_);
+  // The first error of the part uploads.
+  Status upload_status_ TF_GUARDED_BY(mu_);
+};
+
+void S3Config::SetEndpoint(StringPiece endpoint_str, bool use_https) {
+  StringPiece scheme = use_https ? "https" : "http";
+  if (absl::ConsumePrefix(&endpoint_str, "https://")) {
+    scheme = "https";
+  } else if (absl::ConsumePrefix(&endpoint_str, "http://")) {
+    scheme = "http";
+  }
+  absl::ConsumeSuffix(&endpoint_str, "/");
+  host = string(endpoint_str);
+  endpoint = strings::StrCat(scheme, "://", host);
+}
+
+S3Config S3Config::FromEnv() {
+  S3Config config;
+  uint64 value;
+  GetEnvString(kS3Region, &config.region);
+  string endpoint = strings::StrCat("s3.", config.region, ".amazonaws.com");
+  GetEnvString(kS3Endpoint, &endpoint);
+  config.SetEndpoint(endpoint,
+                     !GetEnvUint64(kS3UseHttps, &value) || value != 0);
+  GetEnvString(kS3AccessKeyId, &config.credentials.access_key_id);
+  GetEnvString(kS3SecretAccessKey, &config.credentials.secret_access_key);
+  GetEnvString(kS3SessionToken, &config.credentials.session_token);
+
+  if (GetEnvUint64(kS3BlockSize, &value)) {
+    config.block_size = value * 1024 * 1024;
+  }
+  if (GetEnvUint64(kS3MaxCacheSize, &value)) {
+    config.max_bytes = value * 1024 * 1024;
+  }
+  if (GetEnvUint64(kS3MaxStaleness, &value)) {
+    config.max_staleness = value;
+  }
+  if (GetEnvUint64(kS3MaxPrefetchBlocks, &value)) {
+    config.max_prefetch_blocks = value;
+  }
+  if (GetEnvUint64(kS3StatCacheMaxAge, &value)) {
+    config.stat_cache_max_age = value;
+  }
+  if (GetEnvUint64(kS3StatCacheMaxEntries, &value)) {
+    config.stat_cache_max_entries = value;
+  }
+  if (GetEnvUint64(kS3ParallelReadChunkSize, &value)) {
+    config.parallel_read_chunk_size = value * 1024 * 1024;
+  }
+  if (GetEnvUint64(kS3MultipartPartSize, &value)) {
+    // S3 rejects smaller parts.
+    config.multipart_part_size = std::max<uint64>(value, 5) * 1024 * 1024;
+  }
+  if (GetEnvUint64(kS3Threads, &value) && value > 0) {
+    config.num_threads = value;
+  }
+  return config;
+}
+
+S3FileSystem::S3FileSystem()
+    : S3FileSystem(std::make_unique<CurlHttpRequest::Factory>(),
+                   S3Config::FromEnv()) {
+  uint64 token_rate;
+  if (GetEnvUint64(kS3ThrottleRate, &token_rate)) {
+    GcsThrottleConfig throttle_config;
+    throttle_config.enabled = true;
+    throttle_config.token_rate = token_rate;
+    throttle_.SetConfig(throttle_config);
+  }
+}
+
+S3FileSystem::S3FileSystem(
+    std::unique_ptr<HttpRequest::Factory> http_request_factory,
+    const S3Config& config, Env* env)
+    : config_(config),
+      signer_(config.credentials, config.region),
+      http_request_factory_(std::move(http_request_factory)),
+      env_(env),
+      thread_pool_(std::make_unique<thread::ThreadPool>(
+          env, "s3_file_system", std::max(1, config.num_threads))),
+      stat_cache_(new StatCache(config.stat_cache_max_age,
+                                config.stat_cache_max_entries, env)) {
+  file_block_cache_.reset(new RamFileBlockCache(
+      config_.block_size, config_.max_bytes, config_.max_staleness,
+      [this](const string& filename, size_t offset, size_t n, char* buffer,
+             size_t* bytes_transferred) {
+        return LoadBufferFromS3(filename, offset, n, buffer,
+                                bytes_transferred);
+      },
+      env_, config_.max_prefetch_blocks));
+  VLOG(1) << "S3 endpoint = " << config_.endpoint
+          << " ; region = " << config_.region << " ; "
+          << (signer_.enabled() ? "signed" : "anonymous") << " requests";
+}
+
+Status S3FileSystem::ParseS3Path(StringPiece fname, bool empty_object_ok,
+                                 string* bucket, string* object) {
+  StringPiece scheme, bucketp, objectp;
+  io::ParseURI(fname, &scheme, &bucketp, &objectp);
+  if (scheme != "s3") {
+    return errors::InvalidArgument("S3 path doesn't start with 's3://': ",
+                                   fname);
+  }
+  *bucket = string(bucketp);
+  if (bucket->empty() || *bucket == ".") {
+    return errors::InvalidArgument("S3 path doesn't contain a bucket name: ",
+                                   fname);
+  }
+  absl::ConsumePrefix(&objectp, "/");
+  *object = string(objectp);
+  if (!empty_object_ok && object->empty()) {
+    return errors::InvalidArgument("S3 path doesn't contain an object name: ",
+                                   fname);
+  }
+  return Status::OK();
+}
+
+Status S3FileSystem::CreateHttpRequest(
+    const string& method, const string& bucket, const string& object,
+    const std::map<string, string>& query,
+    const std::map<string, string>& headers,
+    std::unique_ptr<HttpRequest>* request) {
+  std::unique_ptr<HttpRequest> new_request{http_request_factory_->Create()};
+  string canonical_uri = strings::StrCat("/", bucket);
+  if (!object.empty()) {
+    strings::StrAppend(&canonical_uri, "/",
+                       S3RequestSigner::UriEncode(object, false));
+  }
+  string uri = strings::StrCat(config_.endpoint, canonical_uri);
+  if (!query.empty()) {
+    strings::StrAppend(&uri, "?", S3RequestSigner::CanonicalQueryString(query));
+  }
+  new_request->SetUri(uri);
+  for (const auto& header : headers) {
+    new_request->AddHeader(header.first, header.second);
+  }
+  if (signer_.enabled()) {
+    for (const auto& header :
+         signer_.Sign(method, config_.host, canonical_uri, query, headers,
+                      kS3UnsignedPayload, env_->NowSeconds())) {
+      new_request->AddHeader(header.first, header.second);
+    }
+  }
+
+  if (!throttle_.AdmitRequest()) {
+    return errors::Unavailable("Request throttled");
+  }
+
+  *request = std::move(new_request);
+  return Status::OK();
+}
+
+Status S3FileSystem::LoadRange(const string& bucket, const string& object,
+                               size_t offset, size_t n, char* buffer,
+                               size_t* bytes_transferred) {
+  *bytes_transferred = 0;
+  std::unique_ptr<HttpRequest> request;
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(
+      CreateHttpRequest("GET", bucket, object, {}, {}, &request),
+      " when reading s3://", bucket, "/", object);
+  request->SetRange(offset, offset + n - 1);
+  request->SetResultBufferDirect(buffer, n);
+  request->SetTimeouts(config_.connect_timeout, config_.idle_timeout,
+                       config_.read_timeout);
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when reading s3://",
+                                  bucket, "/", object);
+  *bytes_transferred = request->GetResultBufferDirectBytesTransferred();
+  VLOG(1) << "Successful read of s3://" << bucket << "/" << object << " @ "
+          << offset << " of size: " << *bytes_transferred;
+  throttle_.RecordResponse(*bytes_transferred);
+  return Status::OK();
+}
+
+Status S3FileSystem::LoadBufferFromS3(const string& fname, size_t offset,
+                                      size_t n, char* buffer,
+                                      size_t* bytes_transferred) {
+  *bytes_transferred = 0;
+  string bucket, object;
+  TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
+  if (n == 0) {
+    return Status::OK();
+  }
+  const size_t chunk_size = config_.parallel_read_chunk_size;
+  if (chunk_size == 0 || n <= chunk_size) {
+    return LoadRange(bucket, object, offset, n, buffer, bytes_transferred);
+  }
+
+  // Fetch the chunks concurrently. A single connection rarely saturates the
+  // bandwidth of the object store.
+  const size_t num_chunks = (n + chunk_size - 1) / chunk_size;
+  std::vector<Status> statuses(num_chunks);
+  std::vector<size_t> chunk_bytes(num_chunks, 0);
+  BlockingCounter counter(num_chunks);
+  for (size_t i = 0; i < num_chunks; ++i) {
+    thread_pool_->Schedule([&, i]() {
+      const size_t chunk_offset = i * chunk_size;
+      statuses[i] =
+          LoadRange(bucket, object, offset + chunk_offset,
+                    std::min(chunk_size, n - chunk_offset),
+                    buffer + chunk_offset, &chunk_bytes[i]);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  for (size_t i = 0; i < num_chunks; ++i) {
+    TF_RETURN_IF_ERROR(statuses[i]);
+    *bytes_transferred += chunk_bytes[i];
+    if (chunk_bytes[i] < std::min(chunk_size, n - i * chunk_size)) {
+      // The file ends in this chunk.
+      break;
+    }
+  }
+  return Status::OK();
+}
+
+Status S3FileSystem::ListObjects(const string& bucket, const string& prefix,
+                                 const string& delimiter, uint64 max_keys,
+                                 const string& continuation_token,
+                                 ListResult* result) {
+  std::map<string, string> query = {{"list-type", "2"}, {"prefix", prefix}};
+  if (!delimiter.empty()) {
+    query["delimiter"] = delimiter;
+  }
+  if (max_keys < UINT64_MAX) {
+    query["max-keys"] = strings::StrCat(max_keys);
+  }
+  if (!continuation_token.empty()) {
+    query["continuation-token"] = continuation_token;
+  }
+  std::unique_ptr<HttpRequest> request;
+  TF_RETURN_IF_ERROR(CreateHttpRequest("GET", bucket, "", query, {}, &request));
+  std::vector<char> output_buffer;
+  request->SetResultBuffer(&output_buffer);
+  request->SetTimeouts(config_.connect_timeout, config_.idle_timeout,
+                       config_.metadata_timeout);
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when listing s3://",
+                                  bucket, "/", prefix);
+  const StringPiece response(output_buffer.data(), output_buffer.size());
+
+  result->objects.clear();
+  for (StringPiece contents : XmlElements(response, "Contents")) {
+    S3ObjectStat stat;
+    const string key = XmlElement(contents, "Key");
+    if (!strings::safe_strto64(XmlElement(contents, "Size"),
+                               &stat.base.length)) {
+      return errors::Internal("Unexpected size of s3://", bucket, "/", key);
+    }
+    TF_RETURN_IF_ERROR(ParseRfc3339Time(XmlElement(contents, "LastModified"),
+                                        &stat.base.mtime_nsec));
+    stat.base.is_directory = absl::EndsWith(key, "/");
+    stat.signature = Hash64(XmlElement(contents, "ETag"));
+    result->objects.emplace_back(key, stat);
+  }
+  result->prefixes.clear();
+  for (StringPiece common_prefix : XmlElements(response, "CommonPrefixes")) {
+    result->prefixes.push_back(XmlElement(common_prefix, "Prefix"));
+  }
+  result->next_continuation_token.clear();
+  if (XmlElement(response, "IsTruncated") == "true") {
+    result->next_continuation_token =
+        XmlElement(response, "NextContinuationToken");
+  }
+  return Status::OK();
+}
+
+Status S3FileSystem::StatForObject(const string& fname, const string& bucket,
+                                   const string& object, S3ObjectStat* stat) {
+  return stat_cache_->LookupOrCompute(
+      fname, stat,
+      [this, &bucket, &object](const string& fname, S3ObjectStat* stat) {
+        return UncachedStatForObject(bucket, object, stat);
+      });
+}
+
+Status S3FileSystem::UncachedStatForObject(const string& bucket,
+                                           const string& object,
+                                           S3ObjectStat* stat) {
+  // The object, if it exists, is the first one with its name as a prefix.
+  ListResult listing;
+  TF_RETURN_IF_ERROR(ListObjects(bucket, object, "", 1, "", &listing));
+  if (listing.objects.empty() || listing.objects[0].first != object) {
+    return errors::NotFound("Object s3://", bucket, "/", object,
+                            " does not exist.");
+  }
+  *stat = listing.objects[0].second;
+  return Status::OK();
+}
+
+Status S3FileSystem::FolderExists(const string& bucket,
+                                  const string& dirname) {
+  ListResult listing;
+  TF_RETURN_IF_ERROR(
+      ListObjects(bucket, MaybeAppendSlash(dirname), "/", 1, "", &listing));
+  if (dirname.empty() || !listing.objects.empty() ||
+      !listing.prefixes.empty()) {
+    return Status::OK();
+  }
+  return errors::NotFound("The specified folder s3://", bucket, "/", dirname,
+                          " was not found");
+}
+
+Status S3FileSystem::PutObject(const string& bucket, const string& object,
+                               const string& local_path) {
+  return RetryingUtils::CallWithRetries(
+      [&]() {
+        std::unique_ptr<HttpRequest> request;
+        TF_RETURN_IF_ERROR(
+            CreateHttpRequest("PUT", bucket, object, {}, {}, &request));
+        TF_RETURN_IF_ERROR(request->SetPutFromFile(local_path, 0));
+        request->SetTimeouts(config_.connect_timeout, config_.idle_timeout,
+                             config_.write_timeout);
+        TF_RETURN_WITH_CONTEXT_IF_ERROR(
+            request->Send(), " when uploading s3://", bucket, "/", object);
+        return Status::OK();
+      },
+      config_.retry_config);
+}
+
+Status S3FileSystem::CreateMultipartUpload(const string& bucket,
+                                           const string& object,
+                                           string* upload_id) {
+  return RetryingUtils::CallWithRetries(
+      [&]() {
+        std::unique_ptr<HttpRequest> request;
+        TF_RETURN_IF_ERROR(CreateHttpRequest(
+            "POST", bucket, object, {{"uploads", ""}}, {}, &request));
+        std::vector<char> output_buffer;
+        request->SetResultBuffer(&output_buffer);
+        request->SetPostEmptyBody();
+        request->SetTimeouts(config_.connect_timeout, config_.idle_timeout,
+                             config_.metadata_timeout);
+        TF_RETURN_WITH_CONTEXT_IF_ERROR(
+            request->Send(), " when starting the upload of s3://", bucket, "/",
+            object);
+        *upload_id = XmlElement(
+            StringPiece(output_buffer.data(), output_buffer.size()),
+            "UploadId");
+        if (upload_id->empty()) {
+          return errors::Internal("No UploadId in the response when starting ",
+                                  "the upload of s3://", bucket, "/", object);
+        }
+        return Status::OK();
+      },
+      config_.retry_config);
+}
+
+Status S3FileSystem::UploadPart(const string& bucket, const string& object,
+                                const string& upload_id, int part_number,
+                                const string& local_path, string* etag) {
+  return RetryingUtils::CallWithRetries(
+      [&]() {
+        std::unique_ptr<HttpRequest> request;
+        TF_RETURN_IF_ERROR(CreateHttpRequest(
+            "PUT", bucket, object,
+            {{"partNumber", strings::StrCat(part_number)},
+             {"uploadId", upload_id}},
+            {}, &request));
+        TF_RETURN_IF_ERROR(request->SetPutFromFile(local_path, 0));
+        request->SetTimeouts(config_.connect_timeout, config_.idle_timeout,
+                             config_.write_timeout);
+        TF_RETURN_WITH_CONTEXT_IF_ERROR(
+            request->Send(), " when uploading part ", part_number,
+            " of s3://", bucket, "/", object);
+        *etag = request->GetResponseHeader("ETag");
+        if (etag->empty()) {
+          return errors::Internal("No ETag in the response when uploading ",
+                                  "part ", part_number, " of s3://", bucket,
+                                  "/", object);
+        }
+        return Status::OK();
+      },
+      config_.retry_config);
+}
+
+Status S3FileSystem::CompleteMultipartUpload(const string& bucket,
+                                             const string& object,
+                                             const string& upload_id,
+                                             const std::vector<string>& etags) {
+  string request_body = "<CompleteMultipartUpload>";
+  for (size_t i = 0; i < etags.size(); ++i) {
+    strings::StrAppend(&request_body, "<Part><PartNumber>", i + 1,
+                       "</PartNumber><ETag>", etags[i], "</ETag></Part>");
+  }
+  strings::StrAppend(&request_body, "</CompleteMultipartUpload>");
+  return RetryingUtils::CallWithRetries(
+      [&]() {
+        std::unique_ptr<HttpRequest> request;
+        TF_RETURN_IF_ERROR(CreateHttpRequest(
+            "POST", bucket, object, {{"uploadId", upload_id}}, {}, &request));
+        std::vector<char> output_buffer;
+        request->SetResultBuffer(&output_buffer);
+        request->SetPostFromBuffer(request_body.data(), request_body.size());
+        request->SetTimeouts(config_.connect_timeout, config_.idle_timeout,
+                             config_.write_timeout);
+        const string context =
+            strings::StrCat(" when completing the upload of s3://", bucket, "/",
+                            object);
+        TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), context);
+        return CheckXmlError(
+            StringPiece(output_buffer.data(), output_buffer.size()), context);
+      },
+      config_.retry_config);
+}
+
+Status S3FileSystem::AbortMultipartUpload(const string& bucket,
+                                          const string& object,
+                                          const string& upload_id) {
+  return RetryingUtils::DeleteWithRetries(
+      [&]() {
+        std::unique_ptr<HttpRequest> request;
+        TF_RETURN_IF_ERROR(CreateHttpRequest(
+            "DELETE", bucket, object, {{"uploadId", upload_id}}, {}, &request));
+        request->SetDeleteRequest();
+        request->SetTimeouts(config_.connect_timeout, config_.idle_timeout,
+                             config_.metadata_timeout);
+        TF_RETURN_WITH_CONTEXT_IF_ERROR(
+            request->Send(), " when aborting the upload of s3://", bucket, "/",
+            object);
+        return Status::OK();
+      },
+      config_.retry_config);
+}
+
+void S3FileSystem::ClearFileCaches(const string& fname) {
+  file_block_cache_->RemoveFile(fname);
+  stat_cache_->Delete(fname);
+}
+
+Status S3FileSystem::NewRandomAccessFile(
+    const string& fname, TransactionToken* token,
+    std::unique_ptr<RandomAccessFile>* result) {
+  string bucket, object;
+  TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
+  if (file_block_cache_->IsCacheEnabled()) {
+    result->reset(new S3RandomAccessFile(
+        fname, [this, bucket, object](const string& fname, uint64 offset,
+                                      size_t n, StringPiece* result,
+                                      char* scratch) {
+          S3ObjectStat stat;
+          TF_RETURN_IF_ERROR(StatForObject(fname, bucket, object, &stat));
+          if (!file_block_cache_->ValidateAndUpdateFileSignature(
+                  fname, stat.signature)) {
+            VLOG(1) << "File signature has been changed. Refreshing the "
+                       "cache. Path: "
+                    << fname;
+          }
+          file_block_cache_->SetFileSize(fname, stat.base.length);
+          *result = StringPiece();
+          size_t bytes_transferred;
+          TF_RETURN_IF_ERROR(file_block_cache_->Read(fname, offset, n, scratch,
+                                                     &bytes_transferred));
+          *result = StringPiece(scratch, bytes_transferred);
+          if (bytes_transferred < n) {
+            return errors::OutOfRange("EOF reached, ", result->size(),
+                                      " bytes were read out of ", n,
+                                      " bytes requested.");
+          }
+          return Status::OK();
+        }));
+  } else {
+    result->reset(new S3RandomAccessFile(
+        fname, [this](const string& fname, uint64 offset, size_t n,
+                      StringPiece* result, char* scratch) {
+          *result = StringPiece();
+          size_t bytes_transferred;
+          TF_RETURN_IF_ERROR(LoadBufferFromS3(fname, offset, n, scratch,
+                                              &bytes_transferred));
+          *result = StringPiece(scratch, bytes_transferred);
+          if (bytes_transferred < n) {
+            return errors::OutOfRange("EOF reached, ", result->size(),
+                                      " bytes were read out of ", n,
+                                      " bytes requested.");
+          }
+          return Status::OK();
+        }));
+  }
+  return Status::OK();
+}
+
+Status S3FileSystem::NewWritableFile(const string& fname,
+                                     TransactionToken* token,
+                                     std::unique_ptr<WritableFile>* result) {
+  string bucket, object;
+  TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
+  result->reset(new S3WritableFile(bucket, object, this));
+  return Status::OK();
+}
+
+Status S3FileSystem::NewAppendableFile(const string& fname,
+                                       TransactionToken* token,
+                                       std::unique_ptr<WritableFile>* result) {
+  // S3 objects can't be appended to, so the new object starts with a copy of
+  // the old one.
+  std::unique_ptr<RandomAccessFile> reader;
+  TF_RETURN_IF_ERROR(NewRandomAccessFile(fname, token, &reader));
+  TF_RETURN_IF_ERROR(NewWritableFile(fname, token, result));
+  const size_t chunk_size = config_.multipart_part_size;
+  std::unique_ptr<char[]> buffer(new char[chunk_size]);
+  for (uint64 offset = 0;; offset += chunk_size) {
+    StringPiece data;
+    Status status = reader->Read(offset, chunk_size, &data, buffer.get());
+    if (status.ok() || errors::IsOutOfRange(status)) {
+      TF_RETURN_IF_ERROR((*result)->Append(data));
+    }
+    if (errors::IsNotFound(status) || errors::IsOutOfRange(status)) {
+      // The object doesn't exist, or has been copied entirely.
+      break;
+    }
+    TF_RETURN_IF_ERROR(status);
+  }
+  return Status::OK();
+}
+
+Status S3FileSystem::NewReadOnlyMemoryRegionFromFile(
+    const string& fname, TransactionToken* token,
+    std::unique_ptr<ReadOnlyMemoryRegion>* result) {
+  uint64 size;
+  TF_RETURN_IF_ERROR(GetFileSize(fname, token, &size));
+  std::unique_ptr<char[]> data(new char[size]);
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(NewRandomAccessFile(fname, token, &file));
+
+  StringPiece piece;
+  TF_RETURN_IF_ERROR(file->Read(0, size, &piece, data.get()));
+
+  result->reset(new S3ReadOnlyMemoryRegion(std::move(data), size));
+  return Status::OK();
+}
+
+Status S3FileSystem::FileExists(const string& fname, TransactionToken* token) {
+  FileStatistics stat;
+  return Stat(fname, token, &stat);
+}
+
+Status S3FileSystem::Stat(const string& fname, TransactionToken* token,
+                          FileStatistics* stat) {
+  string bucket, object;
+  TF_RETURN_IF_ERROR(ParseS3Path(fname, true, &bucket, &object));
+  if (!object.empty()) {
+    S3ObjectStat object_stat;
+    Status status = StatForObject(fname, bucket, object, &object_stat);
+    if (!errors::IsNotFound(status)) {
+      if (status.ok()) {
+        *stat = object_stat.base;
+      }
+      return status;
+    }
+  }
+  TF_RETURN_IF_ERROR(FolderExists(bucket, object));
+  *stat = FileStatistics(0, 0, true);
+  return Status::OK();
+}
+
+Status S3FileSystem::GetChildren(const string& dirname,
+                                 TransactionToken* token,
+                                 std::vector<string>* result) {
+  string bucket, object;
+  TF_RETURN_IF_ERROR(ParseS3Path(dirname, true, &bucket, &object));
+  const string prefix = MaybeAppendSlash(object);
+  string continuation_token;
+  do {
+    ListResult listing;
+    TF_RETURN_IF_ERROR(ListObjects(bucket, prefix, "/", UINT64_MAX,
+                                   continuation_token, &listing));
+    for (const auto& entry : listing.objects) {
+      StringPiece name = entry.first;
+      if (!absl::ConsumePrefix(&name, prefix) || name.empty()) {
+        // Skip the directory marker.
+        continue;
+      }
+      result->emplace_back(name);
+    }
+    for (StringPiece name : listing.prefixes) {
+      if (absl::ConsumePrefix(&name, prefix)) {
+        absl::ConsumeSuffix(&name, "/");
+        if (!name.empty()) {
+          result->emplace_back(name);
+        }
+      }
+    }
+    continuation_token = listing.next_continuation_token;
+  } while (!continuation_token.empty());
+  return Status::OK();
+}
+
+Status S3FileSystem::GetMatchingPaths(const string& pattern,
+                                      TransactionToken* token,
+                                      std::vector<string>* results) {
+  return internal::GetMatchingPaths(this, Env::Default(), pattern, results);
+}
+
+Status S3FileSystem::DeleteFile(const string& fname, TransactionToken* token) {
+  string bucket, object;
+  TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
+  std::unique_ptr<HttpRequest> request;
+  TF_RETURN_IF_ERROR(
+      CreateHttpRequest("DELETE", bucket, object, {}, {}, &request));
+  request->SetDeleteRequest();
+  request->SetTimeouts(config_.connect_timeout, config_.idle_timeout,
+                       config_.metadata_timeout);
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when deleting ", fname);
+  ClearFileCaches(fname);
+  return Status::OK();
+}
+
+Status S3FileSystem::CreateDir(const string& dirname, TransactionToken* token) {
+  string bucket, object;
+  TF_RETURN_IF_ERROR(ParseS3Path(dirname, true, &bucket, &object));
+  if (object.empty()) {
+    // Buckets are not created by the file system.
+    return FolderExists(bucket, "");
+  }
+  if (FolderExists(bucket, object).ok()) {
+    return errors::AlreadyExists(dirname);
+  }
+  // Writes a directory marker, as GcsFileSystem does.
+  std::unique_ptr<HttpRequest> request;
+  TF_RETURN_IF_ERROR(CreateHttpRequest("PUT", bucket, MaybeAppendSlash(object),
+                                       {}, {}, &request));
+  request->SetPutEmptyBody();
+  request->SetTimeouts(config_.connect_timeout, config_.idle_timeout,
+                       config_.metadata_timeout);
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when creating ", dirname);
+  return Status::OK();
+}
+
+Status S3FileSystem::DeleteDir(const string& dirname, TransactionToken* token) {
+  string bucket, object;
+  TF_RETURN_IF_ERROR(ParseS3Path(dirname, true, &bucket, &object));
+  const string prefix = MaybeAppendSlash(object);
+  ListResult listing;
+  TF_RETURN_IF_ERROR(ListObjects(bucket, prefix, "", 2, "", &listing));
+  for (const auto& entry : listing.objects) {
+    if (entry.first != prefix) {
+      return errors::FailedPrecondition("Cannot delete a non-empty directory.");
+    }
+  }
+  if (!object.empty() && !listing.objects.empty()) {
+    // Delete the directory marker.
+    return DeleteFile(MaybeAppendSlash(dirname), token);
+  }
+  return Status::OK();
+}
+
+Status S3FileSystem::GetFileSize(const string& fname, TransactionToken* token,
+                                 uint64* file_size) {
+  string bucket, object;
+  TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
+  S3ObjectStat stat;
+  TF_RETURN_IF_ERROR(StatForObject(fname, bucket, object, &stat));
+  *file_size = stat.base.length;
+  return Status::OK();
+}
+
+Status S3FileSystem::RenameFile(const string& src, const string& target,
+                                TransactionToken* token) {
+  string src_bucket, src_object, target_bucket, target_object;
+  TF_RETURN_IF_ERROR(ParseS3Path(src, false, &src_bucket, &src_object));
+  TF_RETURN_IF_ERROR(
+      ParseS3Path(target, false, &target_bucket, &target_object));
+
+  // The objects to rename, relative to `src`, which is a single object or a
+  // directory.
+  std::vector<string> names;
+  S3ObjectStat stat;
+  if (StatForObject(src, src_bucket, src_object, &stat).ok()) {
+    names.emplace_back();
+  } else {
+    const string prefix = MaybeAppendSlash(src_object);
+    string continuation_token;
+    do {
+      ListResult listing;
+      TF_RETURN_IF_ERROR(ListObjects(src_bucket, prefix, "", UINT64_MAX,
+                                     continuation_token, &listing));
+      for (const auto& entry : listing.objects) {
+        names.push_back(entry.first.substr(src_object.size()));
+      }
+      continuation_token = listing.next_continuation_token;
+    } while (!continuation_token.empty());
+    if (names.empty()) {
+      return errors::NotFound("The specified path ", src, " was not found.");
+    }
+  }
+
+  for (const string& name : names) {
+    const string source = strings::StrCat(src_object, name);
+    const string destination = strings::StrCat(target_object, name);
+    std::unique_ptr<HttpRequest> request;
+    TF_RETURN_IF_ERROR(CreateHttpRequest(
+        "PUT", target_bucket, destination, {},
+        {{"x-amz-copy-source",
+          strings::StrCat("/", src_bucket, "/",
+                          S3RequestSigner::UriEncode(source, false))}},
+        &request));
+    std::vector<char> output_buffer;
+    request->SetResultBuffer(&output_buffer);
+    request->SetPutEmptyBody();
+    request->SetTimeouts(config_.connect_timeout, config_.idle_timeout,
+                         config_.metadata_timeout);
+    const string context = strings::StrCat(" when copying s3://", src_bucket,
+                                           "/", source, " to ", target);
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), context);
+    TF_RETURN_IF_ERROR(CheckXmlError(
+        StringPiece(output_buffer.data(), output_buffer.size()), context));
+    ClearFileCaches(strings::StrCat("s3://", target_bucket, "/", destination));
+    TF_RETURN_IF_ERROR(RetryingUtils::DeleteWithRetries(
+        [this, &src_bucket, &source, token]() {
+          return DeleteFile(strings::StrCat("s3://", src_bucket, "/", source),
+                            token);
+        },
+        config_.retry_config));
+  }
+  return Status::OK();
+}
+
+Status S3FileSystem::IsDirectory(const string& fname,
+                                 TransactionToken* token) {
+  string bucket, object;
+  TF_RETURN_IF_ERROR(ParseS3Path(fname, true, &bucket, &object));
+  if (FolderExists(bucket, object).ok()) {
+    return Status::OK();
+  }
+  S3ObjectStat stat;
+  if (!object.empty() && StatForObject(fname, bucket, object, &stat).ok()) {
+    return errors::FailedPrecondition("The specified path ", fname,
+                                      " is not a directory.");
+  }
+  return errors::NotFound("The specified path ", fname, " was not found.");
+}
+
+void S3FileSystem::FlushCaches(TransactionToken* token) {
+  file_block_cache_->Flush();
+  stat_cache_->Clear();
+}
+
+}  // namespace tensorflow
+
+REGISTER_LEGACY_FILE_SYSTEM("s3", ::tensorflow::RetryingS3FileSystem);
@@ -0,0 +1,285 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_S3_FILE_SYSTEM_H_
+#define TENSORFLOW_CORE_PLATFORM_CLOUD_S3_FILE_SYSTEM_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/cloud/expiring_lru_cache.h"
+#include "tensorflow/core/platform/cloud/file_block_cache.h"
+#include "tensorflow/core/platform/cloud/gcs_throttle.h"
+#include "tensorflow/core/platform/cloud/http_request.h"
+#include "tensorflow/core/platform/cloud/s3_request_signer.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/retrying_file_system.h"
+#include "tensorflow/core/platform/retrying_utils.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+
+// The environment variable that overrides the S3 endpoint, as `host[:port]`
+// or as a `http://` or `https://` URL, e.g. for MinIO. Objects are addressed
+// with path-style URLs. Defaults to the AWS endpoint of the region.
+constexpr char kS3Endpoint[] = "S3_ENDPOINT";
+// The environment variable that disables TLS if set to 0, for endpoints given
+// without a scheme.
+constexpr char kS3UseHttps[] = "S3_USE_HTTPS";
+// The environment variables of the region and the credentials. Requests are
+// anonymous if no access key is set.
+constexpr char kS3Region[] = "AWS_REGION";
+constexpr char kS3DefaultRegion[] = "us-east-1";
+constexpr char kS3AccessKeyId[] = "AWS_ACCESS_KEY_ID";
+constexpr char kS3SecretAccessKey[] = "AWS_SECRET_ACCESS_KEY";
+constexpr char kS3SessionToken[] = "AWS_SESSION_TOKEN";
+// The environment variables of the block cache, as for GcsFileSystem. The
+// block cache is disabled by default.
+constexpr char kS3BlockSize[] = "S3_READ_CACHE_BLOCK_SIZE_MB";
+constexpr size_t kS3DefaultBlockSize = 64 * 1024 * 1024;
+constexpr char kS3MaxCacheSize[] = "S3_READ_CACHE_MAX_SIZE_MB";
+constexpr size_t kS3DefaultMaxCacheSize = 0;
+constexpr char kS3MaxStaleness[] = "S3_READ_CACHE_MAX_STALENESS";
+constexpr char kS3MaxPrefetchBlocks[] = "S3_READ_CACHE_MAX_PREFETCH_BLOCKS";
+// The environment variables of the stat cache.
+constexpr char kS3StatCacheMaxAge[] = "S3_STAT_CACHE_MAX_AGE";
+constexpr uint64 kS3DefaultStatCacheMaxAge = 5;
+constexpr char kS3StatCacheMaxEntries[] = "S3_STAT_CACHE_MAX_ENTRIES";
+constexpr size_t kS3DefaultStatCacheMaxEntries = 1024;
+// The environment variable that overrides the size (in MB) of the range GETs
+// that a large read is split into. The ranges are fetched concurrently.
+constexpr char kS3ParallelReadChunkSize[] = "S3_PARALLEL_READ_CHUNK_SIZE_MB";
+constexpr size_t kS3DefaultParallelReadChunkSize = 8 * 1024 * 1024;
+// The environment variable that overrides the size (in MB) of the parts of
+// multipart uploads. Files of up to one part are uploaded with a single PUT.
+// S3 requires parts of at least 5 MB, and at most 10000 parts per object.
+constexpr char kS3MultipartPartSize[] = "S3_MULTIPART_UPLOAD_PART_SIZE_MB";
+constexpr size_t kS3DefaultMultipartPartSize = 16 * 1024 * 1024;
+// The environment variable that overrides the number of concurrent range GETs
+// and part uploads.
+constexpr char kS3Threads[] = "S3_THREADS";
+constexpr int kS3DefaultThreads = 16;
+// The environment variable that enables request throttling with the given
+// token rate, as in GCS_REQUEST_THROTTLE_TOKEN_RATE for GcsFileSystem.
+constexpr char kS3ThrottleRate[] = "S3_REQUEST_THROTTLE_TOKEN_RATE";
+
+/// The configuration of an S3FileSystem.
+struct S3Config {
+  // The scheme and authority of the object URLs, e.g. "https://host:port".
+  string endpoint;
+  // The value of the Host header, i.e. the authority of `endpoint`.
+  string host;
+  string region = kS3DefaultRegion;
+  S3Credentials credentials;
+
+  size_t block_size = kS3DefaultBlockSize;
+  size_t max_bytes = kS3DefaultMaxCacheSize;
+  uint64 max_staleness = 0;
+  size_t max_prefetch_blocks = 0;
+
+  uint64 stat_cache_max_age = kS3DefaultStatCacheMaxAge;
+  size_t stat_cache_max_entries = kS3DefaultStatCacheMaxEntries;
+
+  size_t parallel_read_chunk_size = kS3DefaultParallelReadChunkSize;
+  size_t multipart_part_size = kS3DefaultMultipartPartSize;
+  int num_threads = kS3DefaultThreads;
+
+  // Request timeouts, in seconds.
+  uint32 connect_timeout = 120;
+  uint32 idle_timeout = 60;
+  uint32 metadata_timeout = 3600;
+  uint32 read_timeout = 3600;
+  uint32 write_timeout = 3600;
+  // The retries of the requests of writable files, which RetryingS3FileSystem
+  // can't retry individually.
+  RetryConfig retry_config = RetryConfig(100000 /* init_delay_time_us */);
+
+  /// Sets `endpoint` and `host` from `endpoint`, which has the format of
+  /// S3_ENDPOINT.
+  void SetEndpoint(StringPiece endpoint, bool use_https);
+
+  /// Returns the configuration from the environment variables above.
+  static S3Config FromEnv();
+};
+
+/// \brief S3 implementation of a file system, for AWS and S3-compatible object
+/// stores such as MinIO.
+///
+/// The clients of this class should use RetryingS3FileSystem, which adds retry
+/// logic to S3 operations. Like GcsFileSystem, it reads through a
+/// RamFileBlockCache (with concurrent readahead) when the block cache is
+/// enabled, caches the object stats, and splits large reads into concurrent
+/// range GETs. Written files are uploaded on Close(): with a single PUT if they
+/// fit in one part, and otherwise with a multipart upload whose parts are
+/// uploaded concurrently while the file is written. Flush() and Sync() don't
+/// upload anything, since S3 objects can't be appended to.
+class S3FileSystem : public FileSystem {
+ public:
+  // Main constructor used (via RetryingFileSystem) throughout Tensorflow.
+  S3FileSystem();
+  // Used mostly for unit testing or use cases which need to customize the
+  // filesystem from defaults.
+  S3FileSystem(std::unique_ptr<HttpRequest::Factory> http_request_factory,
+               const S3Config& config, Env* env = Env::Default());
+
+  TF_USE_FILESYSTEM_METHODS_WITH_NO_TRANSACTION_SUPPORT;
+
+  Status NewRandomAccessFile(
+      const string& fname, TransactionToken* token,
+      std::unique_ptr<RandomAccessFile>* result) override;
+
+  Status NewWritableFile(const string& fname, TransactionToken* token,
+                         std::unique_ptr<WritableFile>* result) override;
+
+  Status NewAppendableFile(const string& fname, TransactionToken* token,
+                           std::unique_ptr<WritableFile>* result) override;
+
+  Status NewReadOnlyMemoryRegionFromFile(
+      const string& fname, TransactionToken* token,
+      std::unique_ptr<ReadOnlyMemoryRegion>* result) override;
+
+  Status FileExists(const string& fname, TransactionToken* token) override;
+
+  Status Stat(const string& fname, TransactionToken* token,
+              FileStatistics* stat) override;
+
+  Status GetChildren(const string& dir, TransactionToken* token,
+                     std::vector<string>* result) override;
+
+  Status GetMatchingPaths(const string& pattern, TransactionToken* token,
+                          std::vector<string>* results) override;
+
+  Status DeleteFile(const string& fname, TransactionToken* token) override;
+
+  Status CreateDir(const string& dirname, TransactionToken* token) override;
+
+  Status DeleteDir(const string& dirname, TransactionToken* token) override;
+
+  Status GetFileSize(const string& fname, TransactionToken* token,
+                     uint64* file_size) override;
+
+  Status RenameFile(const string& src, const string& target,
+                    TransactionToken* token) override;
+
+  Status IsDirectory(const string& fname, TransactionToken* token) override;
+
+  void FlushCaches(TransactionToken* token) override;
+
+  /// Splits `fname` of the form `s3://bucket/object` into its parts.
+  static Status ParseS3Path(StringPiece fname, bool empty_object_ok,
+                            string* bucket, string* object);
+
+  const S3Config& config() const { return config_; }
+
+ private:
+  friend class S3WritableFile;
+
+  /// The stat of an object, with the ETag hash as its signature.
+  struct S3ObjectStat {
+    FileStatistics base;
+    int64_t signature = 0;
+  };
+
+  /// The result of a ListObjectsV2 request.
+  struct ListResult {
+    std::vector<std::pair<string, S3ObjectStat>> objects;
+    std::vector<string> prefixes;
+    string next_continuation_token;
+  };
+
+  /// Creates a signed request for `method` on `bucket`/`object` with the query
+  /// parameters `query`. `headers` are added to the request and signed.
+  Status CreateHttpRequest(const string& method, const string& bucket,
+                           const string& object,
+                           const std::map<string, string>& query,
+                           const std::map<string, string>& headers,
+                           std::unique_ptr<HttpRequest>* request);
+
+  /// Reads `n` bytes from `fname` at `offset`, with concurrent range GETs if
+  /// `n` spans several chunks.
+  Status LoadBufferFromS3(const string& fname, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred);
+
+  /// Reads `n` bytes from `bucket`/`object` at `offset` with one range GET.
+  Status LoadRange(const string& bucket, const string& object, size_t offset,
+                   size_t n, char* buffer, size_t* bytes_transferred);
+
+  /// Lists the objects whose name starts with `prefix`. If `delimiter` is not
+  /// empty, the names that have it after the prefix are rolled up in
+  /// `prefixes`.
+  Status ListObjects(const string& bucket, const string& prefix,
+                     const string& delimiter, uint64 max_keys,
+                     const string& continuation_token, ListResult* result);
+
+  /// Stats the object `fname` (through the stat cache).
+  Status StatForObject(const string& fname, const string& bucket,
+                       const string& object, S3ObjectStat* stat);
+  Status UncachedStatForObject(const string& bucket, const string& object,
+                               S3ObjectStat* stat);
+
+  /// Returns OK if `bucket`/`dirname` has objects, or is a bucket that exists.
+  Status FolderExists(const string& bucket, const string& dirname);
+
+  /// Uploads the local file `local_path` as `bucket`/`object`.
+  Status PutObject(const string& bucket, const string& object,
+                   const string& local_path);
+
+  /// The steps of a multipart upload.
+  Status CreateMultipartUpload(const string& bucket, const string& object,
+                               string* upload_id);
+  Status UploadPart(const string& bucket, const string& object,
+                    const string& upload_id, int part_number,
+                    const string& local_path, string* etag);
+  Status CompleteMultipartUpload(const string& bucket, const string& object,
+                                 const string& upload_id,
+                                 const std::vector<string>& etags);
+  Status AbortMultipartUpload(const string& bucket, const string& object,
+                              const string& upload_id);
+
+  /// Removes `fname` from the stat and block caches.
+  void ClearFileCaches(const string& fname);
+
+  const S3Config config_;
+  S3RequestSigner signer_;
+  std::unique_ptr<HttpRequest::Factory> http_request_factory_;
+  Env* const env_;  // Not owned.
+
+  // Runs the range GETs of large reads and the part uploads. Declared before
+  // the block cache, whose prefetches use it.
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+
+  std::unique_ptr<FileBlockCache> file_block_cache_;
+  GcsThrottle throttle_;
+
+  using StatCache = ExpiringLRUCache<S3ObjectStat>;
+  std::unique_ptr<StatCache> stat_cache_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(S3FileSystem);
+};
+
+/// S3 implementation of a file system with retry on failures.
+class RetryingS3FileSystem : public RetryingFileSystem<S3FileSystem> {
+ public:
+  RetryingS3FileSystem()
+      : RetryingFileSystem(std::unique_ptr<S3FileSystem>(new S3FileSystem),
+                           RetryConfig(100000 /* init_delay_time_us */)) {}
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_CLOUD_S3_FILE_SYSTEM_H_
@@ -0,0 +1,453 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/s3_file_system.h"
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/platform/cloud/http_request_fake.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/str_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+// Anonymous requests to a local endpoint, so that the requests are not signed.
+S3Config TestConfig() {
+  S3Config config;
+  config.SetEndpoint("http://localhost:9000", false);
+  config.connect_timeout = 5;
+  config.idle_timeout = 1;
+  config.metadata_timeout = 10;
+  config.read_timeout = 20;
+  config.write_timeout = 30;
+  // A single thread keeps the order of the requests deterministic.
+  config.num_threads = 1;
+  config.retry_config = RetryConfig(0 /* init_delay_time_us */,
+                                    0 /* max_delay_time_us */,
+                                    0 /* max_retries */);
+  return config;
+}
+
+TEST(S3FileSystemTest, ParseS3Path) {
+  string bucket, object;
+  TF_EXPECT_OK(S3FileSystem::ParseS3Path("s3://bucket/path/to/object", false,
+                                         &bucket, &object));
+  EXPECT_EQ("bucket", bucket);
+  EXPECT_EQ("path/to/object", object);
+
+  TF_EXPECT_OK(S3FileSystem::ParseS3Path("s3://bucket", true, &bucket,
+                                         &object));
+  EXPECT_EQ("bucket", bucket);
+  EXPECT_EQ("", object);
+
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      S3FileSystem::ParseS3Path("s3://bucket", false, &bucket, &object)));
+  EXPECT_TRUE(errors::IsInvalidArgument(S3FileSystem::ParseS3Path(
+      "gs://bucket/object", false, &bucket, &object)));
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      S3FileSystem::ParseS3Path("s3:///object", false, &bucket, &object)));
+}
+
+TEST(S3FileSystemTest, SetEndpoint) {
+  S3Config config;
+  config.SetEndpoint("minio:9000", true);
+  EXPECT_EQ("https://minio:9000", config.endpoint);
+  EXPECT_EQ("minio:9000", config.host);
+  config.SetEndpoint("http://minio:9000/", true);
+  EXPECT_EQ("http://minio:9000", config.endpoint);
+  EXPECT_EQ("minio:9000", config.host);
+}
+
+// The expected request of a range GET of random_access.txt.
+string RangeRequest(const string& range) {
+  return strings::StrCat(
+      "Uri: http://localhost:9000/bucket/random_access.txt\n"
+      "Range: ",
+      range,
+      "\n"
+      "Timeouts: 5 1 20\n");
+}
+
+TEST(S3FileSystemTest, NewRandomAccessFile_NoBlockCache) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(RangeRequest("0-5"), "012345"),
+       new FakeHttpRequest(RangeRequest("6-11"), "6789")});
+  S3FileSystem fs(std::unique_ptr<HttpRequest::Factory>(
+                      new FakeHttpRequestFactory(&requests)),
+                  TestConfig());
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_EXPECT_OK(
+      fs.NewRandomAccessFile("s3://bucket/random_access.txt", nullptr, &file));
+
+  char scratch[6];
+  StringPiece result;
+
+  // Read the first chunk.
+  TF_EXPECT_OK(file->Read(0, sizeof(scratch), &result, scratch));
+  EXPECT_EQ("012345", result);
+
+  // Read the second chunk.
+  EXPECT_TRUE(
+      errors::IsOutOfRange(file->Read(6, sizeof(scratch), &result, scratch)));
+  EXPECT_EQ("6789", result);
+}
+
+TEST(S3FileSystemTest, NewRandomAccessFile_ParallelRangeReads) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(RangeRequest("0-3"), "0123"),
+       new FakeHttpRequest(RangeRequest("4-7"), "4567"),
+       new FakeHttpRequest(RangeRequest("8-9"), "8")});
+  S3Config config = TestConfig();
+  config.parallel_read_chunk_size = 4;
+  S3FileSystem fs(std::unique_ptr<HttpRequest::Factory>(
+                      new FakeHttpRequestFactory(&requests)),
+                  config);
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_EXPECT_OK(
+      fs.NewRandomAccessFile("s3://bucket/random_access.txt", nullptr, &file));
+
+  // The read is split in three ranges, and the file ends in the last one.
+  char scratch[10];
+  StringPiece result;
+  EXPECT_TRUE(
+      errors::IsOutOfRange(file->Read(0, sizeof(scratch), &result, scratch)));
+  EXPECT_EQ("012345678", result);
+}
+
+TEST(S3FileSystemTest, Stat_Object) {
+  std::vector<HttpRequest*> requests({new FakeHttpRequest(
+      "Uri: http://localhost:9000/bucket?list-type=2&max-keys=1&"
+      "prefix=path%2Ffile.txt\n"
+      "Timeouts: 5 1 10\n",
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<ListBucketResult><Name>bucket</Name><Prefix>path/file.txt</Prefix>"
+      "<KeyCount>1</KeyCount><MaxKeys>1</MaxKeys>"
+      "<IsTruncated>true</IsTruncated>"
+      "<Contents><Key>path/file.txt</Key>"
+      "<LastModified>2016-04-29T23:15:24.896Z</LastModified>"
+      "<ETag>&quot;etag&quot;</ETag><Size>1010</Size></Contents>"
+      "</ListBucketResult>")});
+  S3FileSystem fs(std::unique_ptr<HttpRequest::Factory>(
+                      new FakeHttpRequestFactory(&requests)),
+                  TestConfig());
+
+  FileStatistics stat;
+  TF_EXPECT_OK(fs.Stat("s3://bucket/path/file.txt", nullptr, &stat));
+  EXPECT_EQ(1010, stat.length);
+  EXPECT_NEAR(1461971724896, stat.mtime_nsec / 1000 / 1000, 1);
+  EXPECT_FALSE(stat.is_directory);
+
+  // The stat is cached.
+  uint64 size;
+  TF_EXPECT_OK(fs.GetFileSize("s3://bucket/path/file.txt", nullptr, &size));
+  EXPECT_EQ(1010, size);
+}
+
+TEST(S3FileSystemTest, Stat_Folder) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+           "Uri: http://localhost:9000/bucket?list-type=2&max-keys=1&"
+           "prefix=path%2Fdir\n"
+           "Timeouts: 5 1 10\n",
+           "<ListBucketResult><Name>bucket</Name>"
+           "<Contents><Key>path/dir/file.txt</Key>"
+           "<LastModified>2016-04-29T23:15:24.896Z</LastModified>"
+           "<ETag>&quot;etag&quot;</ETag><Size>1010</Size></Contents>"
+           "</ListBucketResult>"),
+       new FakeHttpRequest(
+           "Uri: http://localhost:9000/bucket?delimiter=%2F&list-type=2&"
+           "max-keys=1&prefix=path%2Fdir%2F\n"
+           "Timeouts: 5 1 10\n",
+           "<ListBucketResult><Name>bucket</Name>"
+           "<CommonPrefixes><Prefix>path/dir/sub/</Prefix></CommonPrefixes>"
+           "</ListBucketResult>")});
+  S3FileSystem fs(std::unique_ptr<HttpRequest::Factory>(
+                      new FakeHttpRequestFactory(&requests)),
+                  TestConfig());
+
+  FileStatistics stat;
+  TF_EXPECT_OK(fs.Stat("s3://bucket/path/dir", nullptr, &stat));
+  EXPECT_EQ(0, stat.length);
+  EXPECT_TRUE(stat.is_directory);
+}
+
+TEST(S3FileSystemTest, Stat_NotFound) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+           "Uri: http://localhost:9000/bucket?list-type=2&max-keys=1&"
+           "prefix=missing\n"
+           "Timeouts: 5 1 10\n",
+           "<ListBucketResult><Name>bucket</Name></ListBucketResult>"),
+       new FakeHttpRequest(
+           "Uri: http://localhost:9000/bucket?delimiter=%2F&list-type=2&"
+           "max-keys=1&prefix=missing%2F\n"
+           "Timeouts: 5 1 10\n",
+           "<ListBucketResult><Name>bucket</Name></ListBucketResult>")});
+  S3FileSystem fs(std::unique_ptr<HttpRequest::Factory>(
+                      new FakeHttpRequestFactory(&requests)),
+                  TestConfig());
+
+  FileStatistics stat;
+  EXPECT_TRUE(
+      errors::IsNotFound(fs.Stat("s3://bucket/missing", nullptr, &stat)));
+}
+
+TEST(S3FileSystemTest, GetChildren) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+           "Uri: http://localhost:9000/bucket?delimiter=%2F&list-type=2&"
+           "prefix=path%2F\n"
+           "Timeouts: 5 1 10\n",
+           "<ListBucketResult><Name>bucket</Name>"
+           "<IsTruncated>true</IsTruncated>"
+           "<Contents><Key>path/</Key>"
+           "<LastModified>2016-04-29T23:15:24.896Z</LastModified>"
+           "<ETag>&quot;etag&quot;</ETag><Size>0</Size></Contents>"
+           "<Contents><Key>path/file1.txt</Key>"
+           "<LastModified>2016-04-29T23:15:24.896Z</LastModified>"
+           "<ETag>&quot;etag&quot;</ETag><Size>1</Size></Contents>"
+           "<CommonPrefixes><Prefix>path/subdir/</Prefix></CommonPrefixes>"
+           "<NextContinuationToken>token</NextContinuationToken>"
+           "</ListBucketResult>"),
+       new FakeHttpRequest(
+           "Uri: http://localhost:9000/bucket?continuation-token=token&"
+           "delimiter=%2F&list-type=2&prefix=path%2F\n"
+           "Timeouts: 5 1 10\n",
+           "<ListBucketResult><Name>bucket</Name>"
+           "<IsTruncated>false</IsTruncated>"
+           "<Contents><Key>path/file&amp;2.txt</Key>"
+           "<LastModified>2016-04-29T23:15:24.896Z</LastModified>"
+           "<ETag>&quot;etag&quot;</ETag><Size>1</Size></Contents>"
+           "</ListBucketResult>")});
+  S3FileSystem fs(std::unique_ptr<HttpRequest::Factory>(
+                      new FakeHttpRequestFactory(&requests)),
+                  TestConfig());
+
+  std::vector<string> children;
+  TF_EXPECT_OK(fs.GetChildren("s3://bucket/path", nullptr, &children));
+  EXPECT_EQ(std::vector<string>({"file1.txt", "subdir", "file&2.txt"}),
+            children);
+}
+
+TEST(S3FileSystemTest, NewWritableFile_SinglePut) {
+  std::vector<HttpRequest*> requests({new FakeHttpRequest(
+      "Uri: http://localhost:9000/bucket/path/writeable.txt\n"
+      "Put body: content1,content2\n"
+      "Timeouts: 5 1 30\n",
+      "")});
+  S3FileSystem fs(std::unique_ptr<HttpRequest::Factory>(
+                      new FakeHttpRequestFactory(&requests)),
+                  TestConfig());
+
+  std::unique_ptr<WritableFile> file;
+  TF_EXPECT_OK(
+      fs.NewWritableFile("s3://bucket/path/writeable.txt", nullptr, &file));
+  TF_EXPECT_OK(file->Append("content1,"));
+  TF_EXPECT_OK(file->Flush());
+  TF_EXPECT_OK(file->Append("content2"));
+  int64_t position;
+  TF_EXPECT_OK(file->Tell(&position));
+  EXPECT_EQ(17, position);
+  TF_EXPECT_OK(file->Close());
+}
+
+TEST(S3FileSystemTest, NewWritableFile_Multipart) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+          "Uri: http://localhost:9000/bucket/path/writeable.txt?uploads=\n"
+          "Post: yes\n"
+          "Timeouts: 5 1 10\n",
+          "<InitiateMultipartUploadResult><Bucket>bucket</Bucket>"
+          "<Key>path/writeable.txt</Key><UploadId>upload-id</UploadId>"
+          "</InitiateMultipartUploadResult>")});
+  const std::vector<string> parts({"content1", ",content", "2"});
+  for (int i = 0; i < parts.size(); ++i) {
+    requests.push_back(new FakeHttpRequest(
+        strings::StrCat("Uri: http://localhost:9000/bucket/path/writeable.txt"
+                        "?partNumber=",
+                        i + 1,
+                        "&uploadId=upload-id\n"
+                        "Put body: ",
+                        parts[i],
+                        "\n"
+                        "Timeouts: 5 1 30\n"),
+        "", {{"ETag", strings::StrCat("\"etag", i + 1, "\"")}}));
+  }
+  requests.push_back(new FakeHttpRequest(
+      "Uri: http://localhost:9000/bucket/path/writeable.txt"
+      "?uploadId=upload-id\n"
+      "Post body: <CompleteMultipartUpload>"
+      "<Part><PartNumber>1</PartNumber><ETag>\"etag1\"</ETag></Part>"
+      "<Part><PartNumber>2</PartNumber><ETag>\"etag2\"</ETag></Part>"
+      "<Part><PartNumber>3</PartNumber><ETag>\"etag3\"</ETag></Part>"
+      "</CompleteMultipartUpload>\n"
+      "Timeouts: 5 1 30\n",
+      "<CompleteMultipartUploadResult><Key>path/writeable.txt</Key>"
+      "</CompleteMultipartUploadResult>"));
+  S3Config config = TestConfig();
+  config.multipart_part_size = 8;
+  S3FileSystem fs(std::unique_ptr<HttpRequest::Factory>(
+                      new FakeHttpRequestFactory(&requests)),
+                  config);
+
+  std::unique_ptr<WritableFile> file;
+  TF_EXPECT_OK(
+      fs.NewWritableFile("s3://bucket/path/writeable.txt", nullptr, &file));
+  TF_EXPECT_OK(file->Append("content1,"));
+  TF_EXPECT_OK(file->Append("content2"));
+  TF_EXPECT_OK(file->Close());
+}
+
+TEST(S3FileSystemTest, NewWritableFile_MultipartAbortedOnError) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+           "Uri: http://localhost:9000/bucket/path/writeable.txt?uploads=\n"
+           "Post: yes\n"
+           "Timeouts: 5 1 10\n",
+           "<InitiateMultipartUploadResult><UploadId>upload-id</UploadId>"
+           "</InitiateMultipartUploadResult>"),
+       new FakeHttpRequest(
+           "Uri: http://localhost:9000/bucket/path/writeable.txt"
+           "?partNumber=1&uploadId=upload-id\n"
+           "Put body: content1\n"
+           "Timeouts: 5 1 30\n",
+           "", {{"ETag", "\"etag1\""}}),
+       new FakeHttpRequest(
+           "Uri: http://localhost:9000/bucket/path/writeable.txt"
+           "?partNumber=2&uploadId=upload-id\n"
+           "Put body: ,\n"
+           "Timeouts: 5 1 30\n",
+           "", {{"ETag", "\"etag2\""}}),
+       // S3 may report the failure of the completion in a 200 response.
+       new FakeHttpRequest(
+           "Uri: http://localhost:9000/bucket/path/writeable.txt"
+           "?uploadId=upload-id\n"
+           "Post body: <CompleteMultipartUpload>"
+           "<Part><PartNumber>1</PartNumber><ETag>\"etag1\"</ETag></Part>"
+           "<Part><PartNumber>2</PartNumber><ETag>\"etag2\"</ETag></Part>"
+           "</CompleteMultipartUpload>\n"
+           "Timeouts: 5 1 30\n",
+           "<Error><Code>InternalError</Code>"
+           "<Message>We encountered an internal error.</Message></Error>"),
+       new FakeHttpRequest(
+           "Uri: http://localhost:9000/bucket/path/writeable.txt"
+           "?uploadId=upload-id\n"
+           "Delete: yes\n"
+           "Timeouts: 5 1 10\n",
+           "")});
+  S3Config config = TestConfig();
+  config.multipart_part_size = 8;
+  S3FileSystem fs(std::unique_ptr<HttpRequest::Factory>(
+                      new FakeHttpRequestFactory(&requests)),
+                  config);
+
+  std::unique_ptr<WritableFile> file;
+  TF_EXPECT_OK(
+      fs.NewWritableFile("s3://bucket/path/writeable.txt", nullptr, &file));
+  TF_EXPECT_OK(file->Append("content1,"));
+  const Status status = file->Close();
+  EXPECT_TRUE(errors::IsInternal(status));
+  EXPECT_TRUE(absl::StrContains(status.error_message(), "InternalError"))
+      << status;
+}
+
+TEST(S3FileSystemTest, DeleteFile) {
+  std::vector<HttpRequest*> requests({new FakeHttpRequest(
+      "Uri: http://localhost:9000/bucket/path/file%201.txt\n"
+      "Delete: yes\n"
+      "Timeouts: 5 1 10\n",
+      "")});
+  S3FileSystem fs(std::unique_ptr<HttpRequest::Factory>(
+                      new FakeHttpRequestFactory(&requests)),
+                  TestConfig());
+
+  TF_EXPECT_OK(fs.DeleteFile("s3://bucket/path/file 1.txt", nullptr));
+}
+
+TEST(S3FileSystemTest, RenameFile_Object) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+           "Uri: http://localhost:9000/bucket?list-type=2&max-keys=1&"
+           "prefix=path%2Fsrc.txt\n"
+           "Timeouts: 5 1 10\n",
+           "<ListBucketResult><Contents><Key>path/src.txt</Key>"
+           "<LastModified>2016-04-29T23:15:24.896Z</LastModified>"
+           "<ETag>&quot;etag&quot;</ETag><Size>1010</Size></Contents>"
+           "</ListBucketResult>"),
+       new FakeHttpRequest(
+           "Uri: http://localhost:9000/bucket/path/dst.txt\n"
+           "Header x-amz-copy-source: /bucket/path/src.txt\n"
+           "Put: yes\n"
+           "Timeouts: 5 1 10\n",
+           "<CopyObjectResult><ETag>&quot;etag&quot;</ETag>"
+           "</CopyObjectResult>"),
+       new FakeHttpRequest("Uri: http://localhost:9000/bucket/path/src.txt\n"
+                           "Delete: yes\n"
+                           "Timeouts: 5 1 10\n",
+                           "")});
+  S3FileSystem fs(std::unique_ptr<HttpRequest::Factory>(
+                      new FakeHttpRequestFactory(&requests)),
+                  TestConfig());
+
+  TF_EXPECT_OK(fs.RenameFile("s3://bucket/path/src.txt",
+                             "s3://bucket/path/dst.txt", nullptr));
+}
+
+// Reads the file named by the environment variable `env_var` in chunks of
+// `state.range(0)` MB, to compare the read throughput of the file systems on
+// live buckets, e.g. with
+//   S3_BENCHMARK_FILE=s3://bucket/file GCS_BENCHMARK_FILE=gs://bucket/file
+void ReadBenchmarkFile(::testing::benchmark::State& state,
+                       const char* env_var) {
+  const char* fname = std::getenv(env_var);
+  if (fname == nullptr) {
+    state.SkipWithError(strings::StrCat(env_var, " is not set").c_str());
+    return;
+  }
+  const size_t chunk_size = state.range(0) * 1024 * 1024;
+  std::unique_ptr<char[]> scratch(new char[chunk_size]);
+  int64_t bytes_read = 0;
+  for (auto s : state) {
+    std::unique_ptr<RandomAccessFile> file;
+    Status status = Env::Default()->NewRandomAccessFile(fname, &file);
+    for (uint64 offset = 0; status.ok(); offset += chunk_size) {
+      StringPiece result;
+      status = file->Read(offset, chunk_size, &result, scratch.get());
+      bytes_read += result.size();
+    }
+    if (!errors::IsOutOfRange(status)) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+  }
+  state.SetBytesProcessed(bytes_read);
+}
+
+void BM_S3Read(::testing::benchmark::State& state) {
+  ReadBenchmarkFile(state, "S3_BENCHMARK_FILE");
+}
+BENCHMARK(BM_S3Read)->Arg(1)->Arg(8)->Arg(64);
+
+void BM_GcsRead(::testing::benchmark::State& state) {
+  ReadBenchmarkFile(state, "GCS_BENCHMARK_FILE");
+}
+BENCHMARK(BM_GcsRead)->Arg(1)->Arg(8)->Arg(64);
+
+}  // namespace
+}  // namespace tensorflow
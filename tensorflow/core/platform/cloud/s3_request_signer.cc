@@ -0,0 +1,139 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/s3_request_signer.h"
+
+#include <openssl/hmac.h>
+#include <openssl/sha.h>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/escaping.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+
+namespace {
+
+constexpr char kAlgorithm[] = "AWS4-HMAC-SHA256";
+constexpr char kService[] = "s3";
+constexpr char kTerminator[] = "aws4_request";
+
+string Sha256Hex(StringPiece data) {
+  uint8 digest[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const uint8*>(data.data()), data.size(), digest);
+  return absl::BytesToHexString(
+      StringPiece(reinterpret_cast<const char*>(digest), sizeof(digest)));
+}
+
+string HmacSha256(StringPiece key, StringPiece data) {
+  uint8 digest[EVP_MAX_MD_SIZE];
+  unsigned int digest_size = 0;
+  HMAC(EVP_sha256(), key.data(), key.size(),
+       reinterpret_cast<const uint8*>(data.data()), data.size(), digest,
+       &digest_size);
+  return string(reinterpret_cast<const char*>(digest), digest_size);
+}
+
+}  // namespace
+
+S3RequestSigner::S3RequestSigner(S3Credentials credentials, string region)
+    : credentials_(std::move(credentials)), region_(std::move(region)) {}
+
+string S3RequestSigner::UriEncode(StringPiece str, bool encode_slash) {
+  string result;
+  result.reserve(str.size());
+  for (char c : str) {
+    if (absl::ascii_isalnum(c) || c == '-' || c == '_' || c == '.' ||
+        c == '~' || (c == '/' && !encode_slash)) {
+      result.push_back(c);
+    } else {
+      strings::StrAppend(&result, "%",
+                         absl::AsciiStrToUpper(absl::BytesToHexString(
+                             StringPiece(&c, 1))));
+    }
+  }
+  return result;
+}
+
+string S3RequestSigner::CanonicalQueryString(
+    const std::map<string, string>& query) {
+  string result;
+  for (const auto& param : query) {
+    strings::StrAppend(&result, result.empty() ? "" : "&",
+                       UriEncode(param.first, true), "=",
+                       UriEncode(param.second, true));
+  }
+  return result;
+}
+
+std::vector<std::pair<string, string>> S3RequestSigner::Sign(
+    const string& method, const string& host, const string& canonical_uri,
+    const std::map<string, string>& query,
+    const std::map<string, string>& headers, const string& payload_hash,
+    int64_t now_seconds) const {
+  const absl::Time now = absl::FromUnixSeconds(now_seconds);
+  const string amz_date =
+      absl::FormatTime("%Y%m%dT%H%M%SZ", now, absl::UTCTimeZone());
+  const string date = amz_date.substr(0, 8);
+
+  std::vector<std::pair<string, string>> result;
+  result.emplace_back("x-amz-content-sha256", payload_hash);
+  result.emplace_back("x-amz-date", amz_date);
+  if (!credentials_.session_token.empty()) {
+    result.emplace_back("x-amz-security-token", credentials_.session_token);
+  }
+
+  // The signed headers, sorted by name.
+  std::map<string, string> signed_headers(headers);
+  signed_headers["host"] = host;
+  for (const auto& header : result) {
+    signed_headers[header.first] = header.second;
+  }
+  string canonical_headers;
+  string signed_header_names;
+  for (const auto& header : signed_headers) {
+    strings::StrAppend(&canonical_headers, header.first, ":",
+                       absl::StripAsciiWhitespace(header.second), "\n");
+    strings::StrAppend(&signed_header_names,
+                       signed_header_names.empty() ? "" : ";", header.first);
+  }
+
+  const string canonical_request = strings::StrCat(
+      method, "\n", canonical_uri, "\n", CanonicalQueryString(query), "\n",
+      canonical_headers, "\n", signed_header_names, "\n", payload_hash);
+  const string scope =
+      strings::StrCat(date, "/", region_, "/", kService, "/", kTerminator);
+  const string string_to_sign =
+      strings::StrCat(kAlgorithm, "\n", amz_date, "\n", scope, "\n",
+                      Sha256Hex(canonical_request));
+
+  string signing_key = HmacSha256(
+      strings::StrCat("AWS4", credentials_.secret_access_key), date);
+  signing_key = HmacSha256(signing_key, region_);
+  signing_key = HmacSha256(signing_key, kService);
+  signing_key = HmacSha256(signing_key, kTerminator);
+  const string signature =
+      absl::BytesToHexString(HmacSha256(signing_key, string_to_sign));
+
+  result.emplace_back(
+      "Authorization",
+      strings::StrCat(kAlgorithm, " Credential=", credentials_.access_key_id,
+                      "/", scope, ",SignedHeaders=", signed_header_names,
+                      ",Signature=", signature));
+  return result;
+}
+
+}  // namespace tensorflow
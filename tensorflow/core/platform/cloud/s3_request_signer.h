@@ -0,0 +1,79 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_S3_REQUEST_SIGNER_H_
+#define TENSORFLOW_CORE_PLATFORM_CLOUD_S3_REQUEST_SIGNER_H_
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+/// The hash of the payload for requests whose body isn't signed.
+constexpr char kS3UnsignedPayload[] = "UNSIGNED-PAYLOAD";
+
+/// Credentials of an S3 account. Requests are anonymous if `access_key_id` is
+/// empty.
+struct S3Credentials {
+  string access_key_id;
+  string secret_access_key;
+  // Set for temporary credentials.
+  string session_token;
+};
+
+/// \brief Signs S3 requests with AWS Signature Version 4.
+///
+/// See https://docs.aws.amazon.com/AmazonS3/latest/API/sig-v4-authenticating-requests.html
+class S3RequestSigner {
+ public:
+  S3RequestSigner(S3Credentials credentials, string region);
+
+  /// Returns true if requests are signed, i.e. the credentials are set.
+  bool enabled() const { return !credentials_.access_key_id.empty(); }
+
+  const string& region() const { return region_; }
+
+  /// \brief Returns the headers that authenticate a request.
+  ///
+  /// `canonical_uri` is the URI-encoded path of the request, and `query` its
+  /// decoded query parameters. `headers` are the other headers to sign, with
+  /// lowercase names; the caller adds them to the request. The returned
+  /// headers include `x-amz-date`, `x-amz-content-sha256` and `Authorization`.
+  std::vector<std::pair<string, string>> Sign(
+      const string& method, const string& host, const string& canonical_uri,
+      const std::map<string, string>& query,
+      const std::map<string, string>& headers, const string& payload_hash,
+      int64_t now_seconds) const;
+
+  /// URI-encodes `str` as in the canonical request, where only the unreserved
+  /// characters are kept. '/' is kept too unless `encode_slash` is true.
+  static string UriEncode(StringPiece str, bool encode_slash);
+
+  /// Returns the URI-encoded query string of `query`, sorted by name.
+  static string CanonicalQueryString(const std::map<string, string>& query);
+
+ private:
+  const S3Credentials credentials_;
+  const string region_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_CLOUD_S3_REQUEST_SIGNER_H_
@@ -21,6 +21,15 @@ limitations under the License.
 #include "nsync_mu.h"       // NOLINT
 #include "nsync_mu_wait.h"  // NOLINT
 #include "nsync_time.h"     // NOLINT
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex_contention.h"
+
+#if defined(__clang__) || defined(__GNUC__)
+#define TF_MUTEX_CALL_SITE() __builtin_return_address(0)
+#else
+#define TF_MUTEX_CALL_SITE() nullptr
+#endif
 
 namespace tensorflow {
 
@@ -36,10 +45,79 @@ static inline nsync::nsync_mu *mu_cast(internal::MuData *mu) {
   return reinterpret_cast<nsync::nsync_mu *>(mu);
 }
 
-mutex::mutex() { nsync::nsync_mu_init(mu_cast(&mu_)); }
+mutex::mutex() {
+  nsync::nsync_mu_init(mu_cast(&mu_));
+#ifdef TF_MUTEX_CONTENTION_PROFILING
+  sampled_call_site_ = nullptr;
+#endif
+}
 
 mutex::mutex(LinkerInitialized x) {}
 
+#ifdef TF_MUTEX_CONTENTION_PROFILING
+
+// The sampled acquisitions first try to take the mutex, so that uncontended
+// ones record no wait time.
+
+void mutex::lock() {
+  if (TF_PREDICT_FALSE(MutexContentionProfiler::ShouldSample())) {
+    const void* call_site = TF_MUTEX_CALL_SITE();
+    const uint64 wait_start_ns = EnvTime::NowNanos();
+    uint64 acquire_ns = wait_start_ns;
+    if (!nsync::nsync_mu_trylock(mu_cast(&mu_))) {
+      nsync::nsync_mu_lock(mu_cast(&mu_));
+      acquire_ns = EnvTime::NowNanos();
+    }
+    sampled_call_site_ = call_site;
+    sampled_wait_start_ns_ = wait_start_ns;
+    sampled_acquire_ns_ = acquire_ns;
+    return;
+  }
+  nsync::nsync_mu_lock(mu_cast(&mu_));
+  sampled_call_site_ = nullptr;
+}
+
+bool mutex::try_lock() {
+  if (nsync::nsync_mu_trylock(mu_cast(&mu_)) == 0) return false;
+  sampled_call_site_ = nullptr;
+  return true;
+}
+
+void mutex::unlock() {
+  if (TF_PREDICT_FALSE(sampled_call_site_ != nullptr)) {
+    MutexContentionProfiler::Sample sample;
+    sample.call_site = sampled_call_site_;
+    sample.wait_start_ns = sampled_wait_start_ns_;
+    sample.acquire_ns = sampled_acquire_ns_;
+    sample.release_ns = EnvTime::NowNanos();
+    sampled_call_site_ = nullptr;
+    nsync::nsync_mu_unlock(mu_cast(&mu_));
+    MutexContentionProfiler::Record(sample);
+    return;
+  }
+  nsync::nsync_mu_unlock(mu_cast(&mu_));
+}
+
+void mutex::lock_shared() {
+  if (TF_PREDICT_FALSE(MutexContentionProfiler::ShouldSample())) {
+    MutexContentionProfiler::Sample sample;
+    sample.call_site = TF_MUTEX_CALL_SITE();
+    sample.shared = true;
+    sample.wait_start_ns = EnvTime::NowNanos();
+    sample.acquire_ns = sample.wait_start_ns;
+    if (!nsync::nsync_mu_rtrylock(mu_cast(&mu_))) {
+      nsync::nsync_mu_rlock(mu_cast(&mu_));
+      sample.acquire_ns = EnvTime::NowNanos();
+    }
+    sample.release_ns = sample.acquire_ns;
+    MutexContentionProfiler::Record(sample);
+    return;
+  }
+  nsync::nsync_mu_rlock(mu_cast(&mu_));
+}
+
+#else  // TF_MUTEX_CONTENTION_PROFILING
+
 void mutex::lock() { nsync::nsync_mu_lock(mu_cast(&mu_)); }
 
 bool mutex::try_lock() { return nsync::nsync_mu_trylock(mu_cast(&mu_)) != 0; };
@@ -48,6 +126,8 @@ void mutex::unlock() { nsync::nsync_mu_unlock(mu_cast(&mu_)); }
 
 void mutex::lock_shared() { nsync::nsync_mu_rlock(mu_cast(&mu_)); }
 
+#endif  // TF_MUTEX_CONTENTION_PROFILING
+
 bool mutex::try_lock_shared() {
   return nsync::nsync_mu_rtrylock(mu_cast(&mu_)) != 0;
 };
@@ -60,10 +140,12 @@ static int EvaluateCondition(const void *vcond) {
 }
 
 void mutex::Await(const Condition &cond) {
+  DropContentionSample();
   nsync::nsync_mu_wait(mu_cast(&mu_), &EvaluateCondition, &cond, nullptr);
 }
 
 bool mutex::AwaitWithDeadline(const Condition &cond, uint64 abs_deadline_ns) {
+  DropContentionSample();
   time_t seconds = abs_deadline_ns / (1000 * 1000 * 1000);
   nsync::nsync_time abs_time = nsync::nsync_time_s_ns(
       seconds, abs_deadline_ns - seconds * (1000 * 1000 * 1000));
@@ -90,6 +172,7 @@ condition_variable::condition_variable() {
 }
 
 void condition_variable::wait(mutex_lock &lock) {
+  lock.mutex()->DropContentionSample();
   nsync::nsync_cv_wait(cv_cast(&cv_), mu_cast(&lock.mutex()->mu_));
 }
 
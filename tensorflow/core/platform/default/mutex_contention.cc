@@ -0,0 +1,229 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/mutex_contention.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+#include "tensorflow/core/platform/abi.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/platform.h"
+
+#if !defined(IS_MOBILE_PLATFORM) && !defined(PLATFORM_WINDOWS) && \
+    (defined(__clang__) || defined(__GNUC__))
+#define TF_HAS_DLADDR
+#include <dlfcn.h>
+#endif
+
+namespace tensorflow {
+namespace {
+
+constexpr int64 kUninitialized = -1;
+
+std::atomic<int64> sampling_period_flag{kUninitialized};
+std::atomic<MutexContentionProfiler::Listener> listener{nullptr};
+
+// The acquisitions the thread makes before the next sample.
+thread_local int64 acquisitions_until_sample = 0;
+// True while the thread records a sample, so that the mutexes acquired by the
+// profiler and the listener are not sampled.
+thread_local bool in_profiler = false;
+
+// The aggregated samples. It is guarded by a std::mutex, since a
+// tensorflow::mutex would sample itself.
+struct Registry {
+  std::mutex mu;
+  std::unordered_map<const void*, MutexContentionProfiler::CallSiteStats>
+      stats;
+  std::unordered_map<const void*, string> names;
+};
+
+Registry* GetRegistry() {
+  static Registry* registry = new Registry;
+  return registry;
+}
+
+int64 SamplingPeriodFromEnv() {
+  const char* value = getenv("TF_MUTEX_CONTENTION_SAMPLING_PERIOD");
+  if (value == nullptr) return 0;
+  char* end;
+  const long long period = strtoll(value, &end, 10);  // NOLINT
+  return end != value && period > 0 ? period : 0;
+}
+
+string FormatNanos(int64 nanos) {
+  char buffer[32];
+  if (nanos >= 1000000000) {
+    snprintf(buffer, sizeof(buffer), "%.2fs", nanos / 1e9);
+  } else if (nanos >= 1000000) {
+    snprintf(buffer, sizeof(buffer), "%.2fms", nanos / 1e6);
+  } else if (nanos >= 1000) {
+    snprintf(buffer, sizeof(buffer), "%.2fus", nanos / 1e3);
+  } else {
+    snprintf(buffer, sizeof(buffer), "%lldns",
+             static_cast<long long>(nanos));  // NOLINT
+  }
+  return buffer;
+}
+
+}  // namespace
+
+bool MutexContentionProfiler::IsCompiledIn() {
+#ifdef TF_MUTEX_CONTENTION_PROFILING
+  return true;
+#else
+  return false;
+#endif
+}
+
+void MutexContentionProfiler::Enable(int64 sampling_period) {
+  sampling_period_flag.store(std::max<int64>(sampling_period, 0),
+                             std::memory_order_relaxed);
+}
+
+int64 MutexContentionProfiler::sampling_period() {
+  int64 period = sampling_period_flag.load(std::memory_order_relaxed);
+  if (TF_PREDICT_FALSE(period == kUninitialized)) {
+    int64 expected = kUninitialized;
+    period = SamplingPeriodFromEnv();
+    if (!sampling_period_flag.compare_exchange_strong(expected, period)) {
+      period = expected;
+    }
+  }
+  return period;
+}
+
+void MutexContentionProfiler::SetListener(Listener new_listener) {
+  listener.store(new_listener, std::memory_order_release);
+}
+
+bool MutexContentionProfiler::ShouldSample() {
+#ifdef TF_MUTEX_CONTENTION_PROFILING
+  const int64 period = sampling_period();
+  if (period == 0 || in_profiler) return false;
+  if (--acquisitions_until_sample > 0) return false;
+  acquisitions_until_sample = period;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void MutexContentionProfiler::Record(const Sample& sample) {
+  if (in_profiler) return;
+  in_profiler = true;
+  const int64 wait_ns = sample.acquire_ns - sample.wait_start_ns;
+  const int64 hold_ns = sample.release_ns - sample.acquire_ns;
+  Registry* registry = GetRegistry();
+  {
+    std::lock_guard<std::mutex> lock(registry->mu);
+    CallSiteStats& stats = registry->stats[sample.call_site];
+    stats.call_site = sample.call_site;
+    ++stats.num_samples;
+    if (wait_ns > 0) ++stats.num_contended;
+    stats.total_wait_ns += wait_ns;
+    stats.max_wait_ns = std::max(stats.max_wait_ns, wait_ns);
+    stats.total_hold_ns += hold_ns;
+    stats.max_hold_ns = std::max(stats.max_hold_ns, hold_ns);
+  }
+  Listener current_listener = listener.load(std::memory_order_acquire);
+  if (current_listener != nullptr) current_listener(sample);
+  in_profiler = false;
+}
+
+std::vector<MutexContentionProfiler::CallSiteStats>
+MutexContentionProfiler::TopContended(int n) {
+  std::vector<CallSiteStats> top;
+  Registry* registry = GetRegistry();
+  {
+    std::lock_guard<std::mutex> lock(registry->mu);
+    top.reserve(registry->stats.size());
+    for (const auto& entry : registry->stats) top.push_back(entry.second);
+  }
+  std::sort(top.begin(), top.end(),
+            [](const CallSiteStats& a, const CallSiteStats& b) {
+              return a.total_wait_ns > b.total_wait_ns;
+            });
+  const size_t limit = std::max(n, 0);
+  if (top.size() > limit) top.resize(limit);
+  for (CallSiteStats& stats : top) {
+    stats.call_site_name = CallSiteName(stats.call_site);
+  }
+  return top;
+}
+
+string MutexContentionProfiler::Report(int n) {
+  const std::vector<CallSiteStats> top = TopContended(n);
+  string report = "Mutex contention by call site (sampled):\n";
+  char line[128];
+  snprintf(line, sizeof(line), "%10s %10s %10s %10s %10s %10s  %s\n",
+           "Samples", "Contended", "Wait", "Max wait", "Hold", "Max hold",
+           "Call site");
+  report += line;
+  for (const CallSiteStats& stats : top) {
+    snprintf(line, sizeof(line), "%10lld %10lld %10s %10s %10s %10s  ",
+             static_cast<long long>(stats.num_samples),    // NOLINT
+             static_cast<long long>(stats.num_contended),  // NOLINT
+             FormatNanos(stats.total_wait_ns).c_str(),
+             FormatNanos(stats.max_wait_ns).c_str(),
+             FormatNanos(stats.total_hold_ns).c_str(),
+             FormatNanos(stats.max_hold_ns).c_str());
+    report += line;
+    report += stats.call_site_name;
+    report += "\n";
+  }
+  return report;
+}
+
+void MutexContentionProfiler::Reset() {
+  Registry* registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry->mu);
+  registry->stats.clear();
+}
+
+string MutexContentionProfiler::CallSiteName(const void* call_site) {
+  Registry* registry = GetRegistry();
+  {
+    std::lock_guard<std::mutex> lock(registry->mu);
+    auto it = registry->names.find(call_site);
+    if (it != registry->names.end()) return it->second;
+  }
+  char address[32];
+  snprintf(address, sizeof(address), "%p", call_site);
+  string name = address;
+#ifdef TF_HAS_DLADDR
+  Dl_info info;
+  if (call_site != nullptr && dladdr(call_site, &info) &&
+      info.dli_sname != nullptr) {
+    char offset[32];
+    snprintf(offset, sizeof(offset), "+0x%llx",
+             static_cast<unsigned long long>(  // NOLINT
+                 static_cast<const char*>(call_site) -
+                 static_cast<const char*>(info.dli_saddr)));
+    name = port::MaybeAbiDemangle(info.dli_sname) + offset;
+  }
+#endif
+  std::lock_guard<std::mutex> lock(registry->mu);
+  registry->names.emplace(call_site, name);
+  return name;
+}
+
+}  // namespace tensorflow
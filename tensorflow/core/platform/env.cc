@@ -272,6 +272,44 @@ bool Env::FilesExist(const std::vector<string>& files,
   return result;
 }
 
+Status Env::StatMany(const std::vector<string>& fnames,
+                     std::vector<FileStatistics>* stats,
+                     std::vector<Status>* statuses) {
+  stats->assign(fnames.size(), FileStatistics());
+  statuses->assign(fnames.size(), Status::OK());
+  // The indices in `fnames` of the paths of each file system.
+  std::unordered_map<FileSystem*, std::vector<size_t>> indices_per_fs;
+  for (size_t i = 0; i < fnames.size(); ++i) {
+    FileSystem* fs;
+    (*statuses)[i] = GetFileSystemForFile(fnames[i], &fs);
+    if ((*statuses)[i].ok()) {
+      indices_per_fs[fs].push_back(i);
+    }
+  }
+
+  for (const auto& itr : indices_per_fs) {
+    std::vector<string> fs_fnames;
+    fs_fnames.reserve(itr.second.size());
+    for (size_t i : itr.second) {
+      fs_fnames.push_back(fnames[i]);
+    }
+    std::vector<FileStatistics> fs_stats;
+    std::vector<Status> fs_statuses;
+    // The per-path statuses are merged below.
+    itr.first->StatMany(fs_fnames, &fs_stats, &fs_statuses).IgnoreError();
+    for (size_t j = 0; j < itr.second.size(); ++j) {
+      (*stats)[itr.second[j]] = fs_stats[j];
+      (*statuses)[itr.second[j]] = fs_statuses[j];
+    }
+  }
+
+  Status result;
+  for (const Status& status : *statuses) {
+    result.Update(status);
+  }
+  return result;
+}
+
 Status Env::GetChildren(const string& dir, std::vector<string>* result) {
   FileSystem* fs;
   TF_RETURN_IF_ERROR(GetFileSystemForFile(dir, &fs));
@@ -307,6 +307,15 @@ class Env {
   /// Obtains statistics for the given path.
   Status Stat(const std::string& fname, FileStatistics* stat);
 
+  /// \brief Obtains statistics for all the given paths, which may be on
+  /// different file systems.
+  ///
+  /// The paths of each file system are stat'ed with one FileSystem::StatMany()
+  /// call, see there for details.
+  Status StatMany(const std::vector<string>& fnames,
+                  std::vector<FileStatistics>* stats,
+                  std::vector<Status>* statuses);
+
   Status Stat(const std::string& fname, TransactionToken* token,
               FileStatistics* stat) {
     return Status::OK();
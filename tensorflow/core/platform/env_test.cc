@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 
 #include <sys/stat.h>
+#include <algorithm>
 
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -243,6 +244,56 @@ TEST_F(DefaultEnvTest, RecursivelyCreateDirSubdirsExist) {
   TF_EXPECT_OK(env_->FileExists(io::JoinPath(BaseDir(), "a", "b", "c")));
 }
 
+TEST_F(DefaultEnvTest, StatMany) {
+  const string file1 = io::JoinPath(BaseDir(), "file1");
+  const string file2 = io::JoinPath(BaseDir(), "file2");
+  const string missing = io::JoinPath(BaseDir(), "missing");
+  CreateTestFile(env_, file1, 10);
+  CreateTestFile(env_, file2, 20);
+
+  std::vector<FileStatistics> stats;
+  std::vector<Status> statuses;
+  TF_EXPECT_OK(env_->StatMany({file1, file2}, &stats, &statuses));
+  ASSERT_EQ(2, stats.size());
+  EXPECT_EQ(10, stats[0].length);
+  EXPECT_EQ(20, stats[1].length);
+
+  EXPECT_EQ(error::Code::NOT_FOUND,
+            env_->StatMany({file1, missing, file2}, &stats, &statuses).code());
+  ASSERT_EQ(3, statuses.size());
+  TF_EXPECT_OK(statuses[0]);
+  EXPECT_EQ(error::Code::NOT_FOUND, statuses[1].code());
+  TF_EXPECT_OK(statuses[2]);
+  EXPECT_EQ(20, stats[2].length);
+}
+
+TEST_F(DefaultEnvTest, GetChildrenRecursive) {
+  // BaseDir() -> train-0, eval-0, train -> { train-1, sub -> train-2 }
+  TF_CHECK_OK(
+      env_->RecursivelyCreateDir(io::JoinPath(BaseDir(), "train", "sub")));
+  CreateTestFile(env_, io::JoinPath(BaseDir(), "train-0"), 1);
+  CreateTestFile(env_, io::JoinPath(BaseDir(), "eval-0"), 1);
+  CreateTestFile(env_, io::JoinPath(BaseDir(), "train", "train-1"), 1);
+  CreateTestFile(env_, io::JoinPath(BaseDir(), "train", "sub", "train-2"), 1);
+
+  FileSystem* fs;
+  TF_ASSERT_OK(env_->GetFileSystemForFile(BaseDir(), &fs));
+  std::vector<string> children;
+  TF_EXPECT_OK(fs->GetChildrenRecursive(BaseDir(), "", &children));
+  std::sort(children.begin(), children.end());
+  EXPECT_EQ(std::vector<string>({"eval-0", "train-0", "train/sub/train-2",
+                                 "train/train-1"}),
+            children);
+
+  TF_EXPECT_OK(fs->GetChildrenRecursive(BaseDir(), "train/", &children));
+  std::sort(children.begin(), children.end());
+  EXPECT_EQ(std::vector<string>({"train/sub/train-2", "train/train-1"}),
+            children);
+
+  TF_EXPECT_OK(fs->GetChildrenRecursive(BaseDir(), "train-", &children));
+  EXPECT_EQ(std::vector<string>({"train-0"}), children);
+}
+
 TEST_F(DefaultEnvTest, LocalFileSystem) {
   // Test filename with file:// syntax.
   int expected_num_files = 0;
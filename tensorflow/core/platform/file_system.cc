@@ -31,6 +31,7 @@ limitations under the License.
 
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system_helper.h"
 #include "tensorflow/core/platform/platform.h"
 #include "tensorflow/core/platform/scanner.h"
 #include "tensorflow/core/platform/str_util.h"
@@ -106,6 +107,20 @@ bool FileSystem::FilesExist(const std::vector<string>& files,
   return result;
 }
 
+Status FileSystem::StatMany(const std::vector<string>& fnames,
+                            TransactionToken* token,
+                            std::vector<FileStatistics>* stats,
+                            std::vector<Status>* statuses) {
+  return internal::StatMany(this, fnames, token, stats, statuses);
+}
+
+Status FileSystem::GetChildrenRecursive(const std::string& dir,
+                                        const std::string& prefix,
+                                        TransactionToken* token,
+                                        std::vector<string>* result) {
+  return internal::GetChildrenRecursive(this, dir, prefix, token, result);
+}
+
 Status FileSystem::DeleteRecursively(const string& dirname,
                                      TransactionToken* token,
                                      int64_t* undeleted_files,
@@ -167,6 +167,23 @@ class FileSystem {
   virtual bool FilesExist(const std::vector<string>& files,
                           TransactionToken* token, std::vector<Status>* status);
 
+  /// \brief Obtains statistics for all the given paths.
+  ///
+  /// `stats` and `statuses` are resized to the size of `fnames`, and their
+  /// i-th elements are the results of Stat() on the i-th path. Returns OK if
+  /// all the paths were stat'ed, and otherwise the first error. The default
+  /// implementation stats the paths concurrently.
+  virtual tensorflow::Status StatMany(const std::vector<string>& fnames,
+                                      std::vector<FileStatistics>* stats,
+                                      std::vector<Status>* statuses) {
+    return StatMany(fnames, nullptr, stats, statuses);
+  }
+
+  virtual tensorflow::Status StatMany(const std::vector<string>& fnames,
+                                      TransactionToken* token,
+                                      std::vector<FileStatistics>* stats,
+                                      std::vector<Status>* statuses);
+
   /// \brief Returns the immediate children in the given directory.
   ///
   /// The returned paths are relative to 'dir'.
@@ -181,6 +198,24 @@ class FileSystem {
     return Status::OK();
   }
 
+  /// \brief Stores in *result the paths of all the files under `dir` whose
+  /// path relative to `dir` starts with `prefix`. *result is cleared.
+  ///
+  /// The returned paths are relative to 'dir'. Unlike GetChildren(), the
+  /// subdirectories are listed recursively and are not returned themselves.
+  /// File systems with a flat namespace, such as GCS, list all the files in
+  /// one pass and filter them by `prefix` on the server.
+  virtual tensorflow::Status GetChildrenRecursive(const std::string& dir,
+                                                  const std::string& prefix,
+                                                  std::vector<string>* result) {
+    return GetChildrenRecursive(dir, prefix, nullptr, result);
+  }
+
+  virtual tensorflow::Status GetChildrenRecursive(const std::string& dir,
+                                                  const std::string& prefix,
+                                                  TransactionToken* token,
+                                                  std::vector<string>* result);
+
   /// \brief Given a pattern, stores in *results the set of paths that matches
   /// that pattern. *results is cleared.
   ///
@@ -556,8 +591,10 @@ class FileSystem {
   using FileSystem::NewReadOnlyMemoryRegionFromFile;          \
   using FileSystem::FileExists;                               \
   using FileSystem::GetChildren;                              \
+  using FileSystem::GetChildrenRecursive;                     \
   using FileSystem::GetMatchingPaths;                         \
   using FileSystem::Stat;                                     \
+  using FileSystem::StatMany;                                 \
   using FileSystem::DeleteFile;                               \
   using FileSystem::RecursivelyCreateDir;                     \
   using FileSystem::DeleteDir;                                \
@@ -615,12 +652,26 @@ class WrappedFileSystem : public FileSystem {
     return fs_->FilesExist(files, (token ? token : token_), status);
   }
 
+  tensorflow::Status StatMany(const std::vector<string>& fnames,
+                              TransactionToken* token,
+                              std::vector<FileStatistics>* stats,
+                              std::vector<Status>* statuses) override {
+    return fs_->StatMany(fnames, (token ? token : token_), stats, statuses);
+  }
+
   tensorflow::Status GetChildren(const std::string& dir,
                                  TransactionToken* token,
                                  std::vector<string>* result) override {
     return fs_->GetChildren(dir, (token ? token : token_), result);
   }
 
+  tensorflow::Status GetChildrenRecursive(
+      const std::string& dir, const std::string& prefix,
+      TransactionToken* token, std::vector<string>* result) override {
+    return fs_->GetChildrenRecursive(dir, prefix, (token ? token : token_),
+                                     result);
+  }
+
   tensorflow::Status GetMatchingPaths(const std::string& pattern,
                                       TransactionToken* token,
                                       std::vector<string>* results) override {
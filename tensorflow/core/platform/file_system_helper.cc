@@ -19,14 +19,19 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/strings/match.h"
+#include "absl/strings/strip.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_statistics.h"
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/platform.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/str_util.h"
+#include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
@@ -44,6 +49,13 @@ void ForEach(int first, int last, const std::function<void(int)>& f) {
     f(i);
   }
 #else
+  if (last - first <= 1) {
+    // Not worth a thread.
+    for (int i = first; i < last; i++) {
+      f(i);
+    }
+    return;
+  }
   int num_threads = std::min(kNumThreads, last - first);
   thread::ThreadPool threads(Env::Default(), "ForEach", num_threads);
   for (int i = first; i < last; i++) {
@@ -221,11 +233,15 @@ Status GetMatchingPaths(FileSystem* fs, Env* env, const string& pattern,
       // `children_status` array, one element for each children.
       std::vector<Status> children_status(children.size());
       auto handle_children = [&fs, &match_pattern, &parent, &children,
-                              &children_status](int j) {
+                              &children_status, &dirs, index](int j) {
         const std::string path = io::JoinPath(parent, children[j]);
         if (!fs->Match(path, match_pattern)) {
           children_status[j] =
               Status(tensorflow::error::CANCELLED, "Operation not needed");
+        } else if (index == dirs.size() - 1) {
+          // The matches of the last subpattern are results whether they are
+          // directories or not, so don't pay for an `IsDirectory` per match.
+          children_status[j] = Status::OK();
         } else {
           children_status[j] = fs->IsDirectory(path);
         }
@@ -265,5 +281,76 @@ Status GetMatchingPaths(FileSystem* fs, Env* env, const string& pattern,
   return Status::OK();
 }
 
+Status StatMany(FileSystem* fs, const std::vector<string>& fnames,
+                TransactionToken* token, std::vector<FileStatistics>* stats,
+                std::vector<Status>* statuses) {
+  stats->assign(fnames.size(), FileStatistics());
+  statuses->assign(fnames.size(), Status::OK());
+  ForEach(0, fnames.size(), [fs, &fnames, token, stats, statuses](int i) {
+    (*statuses)[i] = fs->Stat(fnames[i], token, &(*stats)[i]);
+  });
+  Status result;
+  for (const Status& status : *statuses) {
+    result.Update(status);
+  }
+  return result;
+}
+
+Status GetChildrenRecursive(FileSystem* fs, const string& dir,
+                            const string& prefix, TransactionToken* token,
+                            std::vector<string>* result) {
+  result->clear();
+  // The directories of the current level, relative to `dir`.
+  std::vector<string> level = {""};
+  while (!level.empty()) {
+    std::vector<std::vector<string>> children(level.size());
+    std::vector<Status> list_status(level.size());
+    ForEach(0, level.size(),
+            [fs, &dir, token, &level, &children, &list_status](int i) {
+              list_status[i] = fs->GetChildren(io::JoinPath(dir, level[i]),
+                                               token, &children[i]);
+            });
+
+    // Only the children whose path starts with `prefix`, or that are an
+    // ancestor directory of such paths, are worth a look.
+    std::vector<string> paths;
+    for (size_t i = 0; i < level.size(); i++) {
+      if (!level[i].empty() && errors::IsNotFound(list_status[i])) {
+        // The subdirectory was removed since it was listed.
+        continue;
+      }
+      TF_RETURN_IF_ERROR(list_status[i]);
+      for (StringPiece child : children[i]) {
+        // Some file systems list the subdirectories with a trailing "/".
+        absl::ConsumeSuffix(&child, "/");
+        string path = level[i].empty() ? string(child)
+                                       : io::JoinPath(level[i], child);
+        if (absl::StartsWith(path, prefix) ||
+            absl::StartsWith(prefix, strings::StrCat(path, "/"))) {
+          paths.push_back(std::move(path));
+        }
+      }
+    }
+
+    std::vector<Status> is_directory(paths.size());
+    ForEach(0, paths.size(), [fs, &dir, token, &paths, &is_directory](int i) {
+      is_directory[i] = fs->IsDirectory(io::JoinPath(dir, paths[i]), token);
+    });
+
+    level.clear();
+    for (size_t i = 0; i < paths.size(); i++) {
+      if (is_directory[i].ok()) {
+        level.push_back(std::move(paths[i]));
+      } else if (errors::IsNotFound(is_directory[i])) {
+        // The path was removed since it was listed.
+        continue;
+      } else if (absl::StartsWith(paths[i], prefix)) {
+        result->push_back(std::move(paths[i]));
+      }
+    }
+  }
+  return Status::OK();
+}
+
 }  // namespace internal
 }  // namespace tensorflow
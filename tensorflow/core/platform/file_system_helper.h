@@ -25,6 +25,8 @@ namespace tensorflow {
 
 class FileSystem;
 class Env;
+struct FileStatistics;
+struct TransactionToken;
 
 namespace internal {
 
@@ -45,6 +47,27 @@ namespace internal {
 Status GetMatchingPaths(FileSystem* fs, Env* env, const string& pattern,
                         std::vector<string>* results);
 
+// Stats all the paths in 'fnames' (in the given file system) concurrently.
+//
+// This is the default implementation of FileSystem::StatMany(), see there for
+// the meaning of the arguments.
+Status StatMany(FileSystem* fs, const std::vector<string>& fnames,
+                TransactionToken* token, std::vector<FileStatistics>* stats,
+                std::vector<Status>* statuses);
+
+// Stores in 'result' the paths of the files under 'dir' (in the given file
+// system) whose relative path starts with 'prefix'.
+//
+// This is the default implementation of FileSystem::GetChildrenRecursive().
+// The tree is walked one level at a time, listing the directories of a level
+// and checking which of their children are directories concurrently. The
+// subdirectories that can't contain files starting with 'prefix' are skipped.
+//
+// Returns an error status if any call to 'fs' failed.
+Status GetChildrenRecursive(FileSystem* fs, const string& dir,
+                            const string& prefix, TransactionToken* token,
+                            std::vector<string>* result);
+
 }  // namespace internal
 }  // namespace tensorflow
 
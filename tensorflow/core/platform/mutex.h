@@ -102,7 +102,24 @@ class TF_LOCKABLE mutex {
 
  private:
   friend class condition_variable;
+
+  // Forgets the sampled acquisition of the mutex, if any, because its holder
+  // is about to wait for a condition.
+  void DropContentionSample() {
+#ifdef TF_MUTEX_CONTENTION_PROFILING
+    sampled_call_site_ = nullptr;
+#endif
+  }
+
   internal::MuData mu_;
+#ifdef TF_MUTEX_CONTENTION_PROFILING
+  // The sampled exclusive acquisition of the mutex, if `sampled_call_site_` is
+  // not null. See tensorflow/core/platform/mutex_contention.h. Only accessed
+  // by the exclusive holder of the mutex.
+  const void* sampled_call_site_;
+  uint64 sampled_wait_start_ns_;
+  uint64 sampled_acquire_ns_;
+#endif
 };
 
 // A Condition represents a predicate on state protected by a mutex.  The
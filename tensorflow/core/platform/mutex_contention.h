@@ -0,0 +1,104 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PLATFORM_MUTEX_CONTENTION_H_
+#define TENSORFLOW_CORE_PLATFORM_MUTEX_CONTENTION_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Sampled contention profiling of tensorflow::mutex.
+//
+// Mutexes are only instrumented when TensorFlow is built with
+// --copt=-DTF_MUTEX_CONTENTION_PROFILING, so that they carry no overhead
+// otherwise. The profiler then samples one in `sampling_period` acquisitions
+// of each thread, where the period is set with Enable() or with the
+// TF_MUTEX_CONTENTION_SAMPLING_PERIOD environment variable. A sample records
+// how long the caller waited for the mutex and, for exclusive acquisitions,
+// how long it held it. Samples are aggregated per call site of mutex::lock()
+// and mutex::lock_shared(), and passed to the listener if there is one, e.g.
+// the host tracer, which records them as XEvents.
+//
+// A call site is the return address of lock(), which is in the function that
+// constructs the mutex_lock unless the compiler did not inline it. Exclusive
+// acquisitions whose holder waits on a condition are not sampled for their
+// hold time.
+class MutexContentionProfiler {
+ public:
+  // A sampled acquisition, with times from EnvTime::NowNanos().
+  struct Sample {
+    const void* call_site = nullptr;
+    bool shared = false;
+    uint64 wait_start_ns = 0;
+    uint64 acquire_ns = 0;
+    // Equal to `acquire_ns` if the hold time is unknown, e.g. because the
+    // acquisition is shared.
+    uint64 release_ns = 0;
+  };
+
+  // The aggregated samples of a call site.
+  struct CallSiteStats {
+    const void* call_site = nullptr;
+    string call_site_name;
+    int64 num_samples = 0;
+    // The samples that could not acquire the mutex right away.
+    int64 num_contended = 0;
+    int64 total_wait_ns = 0;
+    int64 max_wait_ns = 0;
+    int64 total_hold_ns = 0;
+    int64 max_hold_ns = 0;
+  };
+
+  using Listener = void (*)(const Sample& sample);
+
+  // Returns whether mutexes are instrumented in this build.
+  static bool IsCompiledIn();
+
+  // Samples one in `sampling_period` acquisitions of each thread, or none if
+  // `sampling_period` is 0.
+  static void Enable(int64 sampling_period);
+  static int64 sampling_period();
+
+  // Passes every sample to `listener`, or to no one if it is nullptr. The
+  // listener must not block: it runs on the thread that acquired the mutex,
+  // and the mutexes it acquires are not sampled.
+  static void SetListener(Listener listener);
+
+  // Returns the `n` call sites with the largest total wait time.
+  static std::vector<CallSiteStats> TopContended(int n);
+
+  // Returns a human-readable table of TopContended(n).
+  static string Report(int n);
+
+  // Drops the aggregated samples.
+  static void Reset();
+
+  // Returns the symbol and offset of `call_site`, or its address if it cannot
+  // be symbolized.
+  static string CallSiteName(const void* call_site);
+
+  // Used by tensorflow::mutex: returns whether to sample the acquisition the
+  // calling thread is about to make, and records a sample.
+  static bool ShouldSample();
+  static void Record(const Sample& sample);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_MUTEX_CONTENTION_H_
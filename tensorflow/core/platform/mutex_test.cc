@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/platform/mutex.h"
+
+#include "tensorflow/core/platform/mutex_contention.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -35,5 +37,67 @@ struct SharedMutexLockTest {
   mutex mu;
 };
 
+MutexContentionProfiler::Sample MakeSample(const void* call_site,
+                                           uint64 wait_ns, uint64 hold_ns) {
+  MutexContentionProfiler::Sample sample;
+  sample.call_site = call_site;
+  sample.wait_start_ns = 1000;
+  sample.acquire_ns = sample.wait_start_ns + wait_ns;
+  sample.release_ns = sample.acquire_ns + hold_ns;
+  return sample;
+}
+
+TEST(MutexContentionProfilerTest, AggregatesByCallSite) {
+  static const char kFast = 0;
+  static const char kSlow = 0;
+  MutexContentionProfiler::Reset();
+  MutexContentionProfiler::Record(MakeSample(&kFast, 0, 10));
+  MutexContentionProfiler::Record(MakeSample(&kSlow, 500, 20));
+  MutexContentionProfiler::Record(MakeSample(&kSlow, 300, 40));
+
+  std::vector<MutexContentionProfiler::CallSiteStats> top =
+      MutexContentionProfiler::TopContended(/*n=*/10);
+  ASSERT_EQ(top.size(), 2);
+  EXPECT_EQ(top[0].call_site, &kSlow);
+  EXPECT_EQ(top[0].num_samples, 2);
+  EXPECT_EQ(top[0].num_contended, 2);
+  EXPECT_EQ(top[0].total_wait_ns, 800);
+  EXPECT_EQ(top[0].max_wait_ns, 500);
+  EXPECT_EQ(top[0].total_hold_ns, 60);
+  EXPECT_EQ(top[0].max_hold_ns, 40);
+  EXPECT_FALSE(top[0].call_site_name.empty());
+  EXPECT_EQ(top[1].call_site, &kFast);
+  EXPECT_EQ(top[1].num_contended, 0);
+
+  EXPECT_EQ(MutexContentionProfiler::TopContended(/*n=*/1).size(), 1);
+  EXPECT_NE(MutexContentionProfiler::Report(/*n=*/10).find("800ns"),
+            string::npos);
+  MutexContentionProfiler::Reset();
+  EXPECT_TRUE(MutexContentionProfiler::TopContended(/*n=*/10).empty());
+}
+
+TEST(MutexContentionProfilerTest, SamplesAcquisitions) {
+  MutexContentionProfiler::Reset();
+  MutexContentionProfiler::Enable(/*sampling_period=*/1);
+  mutex mu;
+  {
+    mutex_lock l(mu);
+  }
+  {
+    tf_shared_lock l(mu);
+  }
+  MutexContentionProfiler::Enable(/*sampling_period=*/0);
+  int64 num_samples = 0;
+  for (const auto& stats : MutexContentionProfiler::TopContended(/*n=*/100)) {
+    num_samples += stats.num_samples;
+  }
+  if (MutexContentionProfiler::IsCompiledIn()) {
+    EXPECT_GE(num_samples, 2);
+  } else {
+    EXPECT_EQ(num_samples, 0);
+  }
+  MutexContentionProfiler::Reset();
+}
+
 }  // namespace
 }  // namespace tensorflow
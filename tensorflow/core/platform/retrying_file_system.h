@@ -71,6 +71,17 @@ class RetryingFileSystem : public FileSystem {
         retry_config_);
   }
 
+  Status GetChildrenRecursive(const string& dir, const string& prefix,
+                              TransactionToken* token,
+                              std::vector<string>* result) override {
+    return RetryingUtils::CallWithRetries(
+        [this, &dir, &prefix, result, token]() {
+          return base_file_system_->GetChildrenRecursive(dir, prefix, token,
+                                                         result);
+        },
+        retry_config_);
+  }
+
   Status GetMatchingPaths(const string& pattern, TransactionToken* token,
                           std::vector<string>* result) override {
     return RetryingUtils::CallWithRetries(
@@ -89,6 +100,16 @@ class RetryingFileSystem : public FileSystem {
         retry_config_);
   }
 
+  Status StatMany(const std::vector<string>& fnames, TransactionToken* token,
+                  std::vector<FileStatistics>* stats,
+                  std::vector<Status>* statuses) override {
+    return RetryingUtils::CallWithRetries(
+        [this, &fnames, stats, statuses, token]() {
+          return base_file_system_->StatMany(fnames, token, stats, statuses);
+        },
+        retry_config_);
+  }
+
   Status DeleteFile(const string& fname, TransactionToken* token) override {
     return RetryingUtils::DeleteWithRetries(
         [this, &fname, token]() {
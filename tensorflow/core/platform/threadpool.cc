@@ -17,6 +17,8 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <atomic>
+
 #include "absl/types/optional.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/platform/blocking_counter.h"
@@ -31,12 +33,22 @@ limitations under the License.
 namespace tensorflow {
 namespace thread {
 
+namespace {
+std::atomic<ThreadPoolMetricsFactory> metrics_factory{nullptr};
+}  // namespace
+
+void SetThreadPoolMetricsFactory(ThreadPoolMetricsFactory factory) {
+  metrics_factory.store(factory, std::memory_order_release);
+}
+
 struct EigenEnvironment {
   typedef Thread EnvThread;
   struct TaskImpl {
     std::function<void()> f;
     Context context;
     uint64 trace_id;
+    // Only set if the pool is instrumented.
+    uint64 enqueue_time_us;
   };
   struct Task {
     std::unique_ptr<TaskImpl> f;
@@ -45,10 +57,15 @@ struct EigenEnvironment {
   Env* const env_;
   const ThreadOptions thread_options_;
   const string name_;
+  // Not owned, and nullptr if the pool is not instrumented.
+  ThreadPoolMetrics* const metrics_;
 
   EigenEnvironment(Env* env, const ThreadOptions& thread_options,
-                   const string& name)
-      : env_(env), thread_options_(thread_options), name_(name) {}
+                   const string& name, ThreadPoolMetrics* metrics)
+      : env_(env),
+        thread_options_(thread_options),
+        name_(name),
+        metrics_(metrics) {}
 
   EnvThread* CreateThread(std::function<void()> f) {
     return env_->StartThread(thread_options_, name_, [=]() {
@@ -69,11 +86,17 @@ struct EigenEnvironment {
       id = tracing::GetUniqueArg();
       tracing::RecordEvent(tracing::EventCategory::kScheduleClosure, id);
     }
+    uint64 enqueue_time_us = 0;
+    if (metrics_ != nullptr) {
+      metrics_->TaskQueued();
+      enqueue_time_us = env_->NowMicros();
+    }
     return Task{
         std::unique_ptr<TaskImpl>(new TaskImpl{
             std::move(f),
             Context(ContextKind::kThread),
             id,
+            enqueue_time_us,
         }),
     };
   }
@@ -82,7 +105,14 @@ struct EigenEnvironment {
     WithContext wc(t.f->context);
     tracing::ScopedRegion region(tracing::EventCategory::kRunClosure,
                                  t.f->trace_id);
+    if (metrics_ == nullptr) {
+      t.f->f();
+      return;
+    }
+    const uint64 start_time_us = env_->NowMicros();
+    metrics_->TaskStarted(start_time_us - t.f->enqueue_time_us);
     t.f->f();
+    metrics_->TaskDone(env_->NowMicros() - start_time_us);
   }
 };
 
@@ -97,9 +127,12 @@ ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
                        const string& name, int num_threads,
                        bool low_latency_hint, Eigen::Allocator* allocator) {
   CHECK_GE(num_threads, 1);
+  ThreadPoolMetricsFactory factory =
+      metrics_factory.load(std::memory_order_acquire);
+  if (factory != nullptr) metrics_ = factory(name);
   eigen_threadpool_.reset(new Eigen::ThreadPoolTempl<EigenEnvironment>(
       num_threads, low_latency_hint,
-      EigenEnvironment(env, thread_options, "tf_" + name)));
+      EigenEnvironment(env, thread_options, "tf_" + name, metrics_.get())));
   underlying_threadpool_ = eigen_threadpool_.get();
   threadpool_device_.reset(new Eigen::ThreadPoolDevice(underlying_threadpool_,
                                                        num_threads, allocator));
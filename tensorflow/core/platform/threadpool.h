@@ -39,6 +39,33 @@ namespace thread {
 
 struct EigenEnvironment;
 
+// Observes the scheduling of the tasks of a ThreadPool, e.g. to export it as
+// metrics. The methods are called from the threads that schedule and run the
+// tasks, so they must be thread-safe and cheap.
+class ThreadPoolMetrics {
+ public:
+  virtual ~ThreadPoolMetrics() = default;
+
+  // Called when a task is enqueued.
+  virtual void TaskQueued() = 0;
+
+  // Called when a task starts to run, after `queue_time_us` in the queue.
+  virtual void TaskStarted(uint64 queue_time_us) = 0;
+
+  // Called when a task that ran for `run_time_us` finishes.
+  virtual void TaskDone(uint64 run_time_us) = 0;
+};
+
+// Returns the metrics of a new pool named `name`, or nullptr to not instrument
+// the pool.
+using ThreadPoolMetricsFactory =
+    std::unique_ptr<ThreadPoolMetrics> (*)(const std::string& name);
+
+// Instruments the ThreadPools constructed from now on with the metrics that
+// `factory` returns, or stops instrumenting them if `factory` is nullptr. The
+// pools that wrap a user-provided ThreadPoolInterface are not instrumented.
+void SetThreadPoolMetricsFactory(ThreadPoolMetricsFactory factory);
+
 class ThreadPool {
  public:
   // Scheduling strategies for ParallelFor. The strategy governs how the given
@@ -228,6 +255,8 @@ class ThreadPool {
       const int64_t total, const int64_t block_size,
       const std::function<void(int64_t, int64_t)>& fn);
 
+  // Outlives eigen_threadpool_, whose environment refers to it.
+  std::unique_ptr<ThreadPoolMetrics> metrics_;
   // underlying_threadpool_ is the user_threadpool if user_threadpool is
   // provided in the constructor. Otherwise it is the eigen_threadpool_.
   Eigen::ThreadPoolInterface* underlying_threadpool_;
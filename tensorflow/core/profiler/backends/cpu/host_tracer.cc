@@ -20,11 +20,15 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex_contention.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/backends/cpu/host_tracer_utils.h"
+#include "tensorflow/core/profiler/backends/cpu/perf_counters.h"
 #include "tensorflow/core/profiler/backends/cpu/traceme_recorder.h"
 #include "tensorflow/core/profiler/lib/profiler_interface.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
 #include "tensorflow/core/profiler/utils/time_utils.h"
 #include "tensorflow/core/profiler/utils/xplane_schema.h"
@@ -34,12 +38,33 @@ namespace tensorflow {
 namespace profiler {
 namespace {
 
+// Records a sampled mutex acquisition as a MutexWait event, if the caller had
+// to wait, and a MutexHold event, if the hold time is known.
+void RecordMutexContention(const MutexContentionProfiler::Sample& sample) {
+  if (!TraceMeRecorder::Active()) return;
+  const std::string call_site =
+      MutexContentionProfiler::CallSiteName(sample.call_site);
+  if (sample.acquire_ns > sample.wait_start_ns) {
+    TraceMeRecorder::Record(
+        {TraceMeEncode("MutexWait", {{"call_site", call_site},
+                                     {"shared", sample.shared ? 1 : 0}}),
+         static_cast<int64_t>(sample.wait_start_ns),
+         static_cast<int64_t>(sample.acquire_ns)});
+  }
+  if (sample.release_ns > sample.acquire_ns) {
+    TraceMeRecorder::Record(
+        {TraceMeEncode("MutexHold", {{"call_site", call_site}}),
+         static_cast<int64_t>(sample.acquire_ns),
+         static_cast<int64_t>(sample.release_ns)});
+  }
+}
+
 // Controls TraceMeRecorder and converts TraceMeRecorder::Events into XEvents.
 //
 // Thread-safety: This class is go/thread-compatible.
 class HostTracer : public ProfilerInterface {
  public:
-  explicit HostTracer(int host_trace_level);
+  explicit HostTracer(const HostTracerOptions& options);
   ~HostTracer() override;
 
   Status Start() override;
@@ -52,6 +77,15 @@ class HostTracer : public ProfilerInterface {
   // Level of host tracing.
   const int host_trace_level_;
 
+  // Whether to record hardware performance counters.
+  const bool enable_hardware_counters_;
+
+  // True if the hardware performance counters are enabled by this tracer.
+  bool hardware_counters_enabled_ = false;
+
+  // True if this tracer records the samples of the mutex contention profiler.
+  bool mutex_contention_enabled_ = false;
+
   // True if currently recording.
   bool recording_ = false;
 
@@ -62,8 +96,9 @@ class HostTracer : public ProfilerInterface {
   TraceMeRecorder::Events events_;
 };
 
-HostTracer::HostTracer(int host_trace_level)
-    : host_trace_level_(host_trace_level) {}
+HostTracer::HostTracer(const HostTracerOptions& options)
+    : host_trace_level_(options.trace_level),
+      enable_hardware_counters_(options.enable_hardware_counters) {}
 
 HostTracer::~HostTracer() { Stop().IgnoreError(); }
 
@@ -80,6 +115,16 @@ Status HostTracer::Start() {
   if (!recording_) {
     return errors::Internal("Failed to start TraceMeRecorder");
   }
+  // Tracing continues without counters if they are not available.
+  if (enable_hardware_counters_) {
+    hardware_counters_enabled_ = PerfCounters::Enable();
+  }
+  if (MutexContentionProfiler::IsCompiledIn() &&
+      MutexContentionProfiler::sampling_period() > 0) {
+    MutexContentionProfiler::Reset();
+    MutexContentionProfiler::SetListener(&RecordMutexContention);
+    mutex_contention_enabled_ = true;
+  }
   return Status::OK();
 }
 
@@ -87,6 +132,15 @@ Status HostTracer::Stop() {
   if (!recording_) {
     return errors::Internal("TraceMeRecorder not started");
   }
+  if (hardware_counters_enabled_) {
+    PerfCounters::Disable();
+    hardware_counters_enabled_ = false;
+  }
+  if (mutex_contention_enabled_) {
+    MutexContentionProfiler::SetListener(nullptr);
+    mutex_contention_enabled_ = false;
+    LOG(INFO) << MutexContentionProfiler::Report(/*n=*/20);
+  }
   events_ = TraceMeRecorder::Stop();
   recording_ = false;
   return Status::OK();
@@ -111,7 +165,7 @@ Status HostTracer::CollectData(XSpace* space) {
 std::unique_ptr<ProfilerInterface> CreateHostTracer(
     const HostTracerOptions& options) {
   if (options.trace_level == 0) return nullptr;
-  return absl::make_unique<HostTracer>(options.trace_level);
+  return absl::make_unique<HostTracer>(options);
 }
 
 }  // namespace profiler
@@ -32,6 +32,10 @@ struct HostTracerOptions {
   // - Level 3 enables tracing of all level 2 TraceMe(s) and more verbose
   //           (low-level) program execution details (cheap TF ops, etc).
   int trace_level = 2;
+
+  // Whether TF op TraceMes also record the hardware performance counters of
+  // their thread.
+  bool enable_hardware_counters = false;
 };
 
 std::unique_ptr<ProfilerInterface> CreateHostTracer(
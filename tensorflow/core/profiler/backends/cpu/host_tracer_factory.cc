@@ -24,6 +24,8 @@ std::unique_ptr<ProfilerInterface> CreateHostTracer(
     const ProfileOptions& profile_options) {
   HostTracerOptions options;
   options.trace_level = profile_options.host_tracer_level();
+  options.enable_hardware_counters =
+      profile_options.enable_hardware_counters();
   return CreateHostTracer(options);
 }
 
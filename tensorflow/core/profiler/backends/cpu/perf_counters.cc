@@ -0,0 +1,132 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/backends/cpu/perf_counters.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace internal {
+
+std::atomic<bool> g_perf_counters_enabled(false);
+
+}  // namespace internal
+
+namespace {
+
+#if defined(__linux__)
+
+// The counters of a thread, opened as one group so that they are scheduled
+// together and read with a single read(2).
+class ThreadPerfCounters {
+ public:
+  ThreadPerfCounters() {
+    const uint64 configs[kNumCounters] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    for (int i = 0; i < kNumCounters; ++i) {
+      perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = configs[i];
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP;
+      // Count the calling thread on any CPU.
+      fds_[i] = syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1,
+                        /*group_fd=*/i == 0 ? -1 : fds_[0], /*flags=*/0);
+      if (fds_[i] < 0) {
+        VLOG(1) << "Failed to open hardware performance counter " << i
+                << ": " << strerror(errno);
+        Close();
+        return;
+      }
+    }
+  }
+
+  ~ThreadPerfCounters() { Close(); }
+
+  bool Read(PerfCounterValues* values) {
+    if (fds_[0] < 0) return false;
+    // With PERF_FORMAT_GROUP, read returns the number of counters followed by
+    // their values.
+    uint64 buffer[1 + kNumCounters];
+    if (read(fds_[0], buffer, sizeof(buffer)) != sizeof(buffer) ||
+        buffer[0] != kNumCounters) {
+      return false;
+    }
+    values->cpu_cycles = buffer[1];
+    values->cpu_instructions = buffer[2];
+    values->cache_misses = buffer[3];
+    values->branch_misses = buffer[4];
+    return true;
+  }
+
+ private:
+  static constexpr int kNumCounters = 4;
+
+  void Close() {
+    for (int& fd : fds_) {
+      if (fd >= 0) close(fd);
+      fd = -1;
+    }
+  }
+
+  int fds_[kNumCounters] = {-1, -1, -1, -1};
+};
+
+bool ReadThreadPerfCounters(PerfCounterValues* values) {
+  static thread_local ThreadPerfCounters counters;
+  return counters.Read(values);
+}
+
+#else
+
+bool ReadThreadPerfCounters(PerfCounterValues* values) { return false; }
+
+#endif
+
+}  // namespace
+
+/*static*/ bool PerfCounters::Enable() {
+  PerfCounterValues values;
+  if (!ReadThreadPerfCounters(&values)) {
+    LOG(WARNING) << "Hardware performance counters are not available.";
+    return false;
+  }
+  internal::g_perf_counters_enabled.store(true, std::memory_order_relaxed);
+  return true;
+}
+
+/*static*/ void PerfCounters::Disable() {
+  internal::g_perf_counters_enabled.store(false, std::memory_order_relaxed);
+}
+
+/*static*/ bool PerfCounters::Read(PerfCounterValues* values) {
+  return ReadThreadPerfCounters(values);
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
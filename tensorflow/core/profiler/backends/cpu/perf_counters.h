@@ -0,0 +1,67 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_PROFILER_BACKENDS_CPU_PERF_COUNTERS_H_
+#define TENSORFLOW_CORE_PROFILER_BACKENDS_CPU_PERF_COUNTERS_H_
+
+#include <atomic>
+
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace internal {
+
+// Whether kernel-level TraceMes read the hardware counters. Static atomic so
+// PerfCounters::Enabled can be fast and non-blocking.
+TF_EXPORT extern std::atomic<bool> g_perf_counters_enabled;
+
+}  // namespace internal
+
+// Values of the hardware performance counters of a thread, counted in user
+// space since the counters were opened on that thread.
+struct PerfCounterValues {
+  uint64 cpu_cycles = 0;
+  uint64 cpu_instructions = 0;
+  // Last level cache misses, which approximate the memory traffic.
+  uint64 cache_misses = 0;
+  uint64 branch_misses = 0;
+};
+
+// Per-thread hardware performance counters, read with perf_event_open on
+// Linux. Each thread opens its counters the first time it reads them while
+// the counters are enabled. Elsewhere, or if the kernel does not allow the
+// counters to be opened (see /proc/sys/kernel/perf_event_paranoid), nothing
+// is read.
+class PerfCounters {
+ public:
+  // Enables reading the counters at the begin and end of kernel-level
+  // TraceMes. Returns false if the counters cannot be opened on this thread.
+  static bool Enable();
+  static void Disable();
+
+  static inline bool Enabled() {
+    return internal::g_perf_counters_enabled.load(std::memory_order_relaxed);
+  }
+
+  // Reads the counters of the calling thread. Returns false if they are not
+  // available.
+  static bool Read(PerfCounterValues* values);
+};
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_BACKENDS_CPU_PERF_COUNTERS_H_
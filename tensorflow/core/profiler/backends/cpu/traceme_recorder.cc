@@ -45,6 +45,11 @@ static_assert(ATOMIC_INT_LOCK_FREE == 2, "Assumed atomic<int> was lock free");
 
 namespace {
 
+// The maximum number of events kept by each thread while tracing, or 0 if the
+// number is unbounded. Set by TraceMeRecorder::StartRecording before tracing
+// is activated.
+std::atomic<size_t> g_max_events_per_thread(0);
+
 // Track events created by ActivityStart and merge their data into events
 // created by ActivityEnd. TraceMe records events in its destructor, so this
 // results in complete events sorted by their end_time in the thread they ended.
@@ -105,7 +110,9 @@ class SplitEventTracker {
 // Push writes at end_, and then advances it, allocating a block if needed.
 // Consume takes ownership of events in the range [start_, end_).
 // Clear removes events in the range [start_, end_).
-// The end_ pointer is atomic so Push and Consume can be concurrent.
+// The end_ pointer is atomic so Push and Consume can be concurrent. Consume and
+// Clear publish start_ to consumed_ when they are done, so that the owner
+// thread can bound the size of the queue.
 //
 // Push and Consume are lock free and each might be called from at most one
 // thread. Push is only called by the owner thread. Consume is only called by
@@ -122,7 +129,8 @@ class EventQueue {
       : start_block_(new Block{/*start=*/0, /*next=*/nullptr}),
         start_(start_block_->start),
         end_block_(start_block_),
-        end_(start_) {}
+        end_(start_),
+        consumed_(start_) {}
 
   // Memory should be deallocated and trace events destroyed on destruction.
   // This doesn't require global lock as this discards all the stored trace
@@ -147,12 +155,20 @@ class EventQueue {
     end_.store(end, std::memory_order_release);  // Write index after contents.
   }
 
+  // Returns an upper bound of the number of events in the queue. Only called
+  // by the owner thread.
+  size_t Size() const {
+    return end_.load(std::memory_order_relaxed) -
+           consumed_.load(std::memory_order_acquire);
+  }
+
   // Removes all events from the queue.
   void Clear() {
     size_t end = end_.load(std::memory_order_acquire);
     while (start_ != end) {
       Pop();
     }
+    consumed_.store(start_, std::memory_order_release);
   }
 
   // Retrieve and remove all events in the queue at the time of invocation.
@@ -181,6 +197,7 @@ class EventQueue {
         split_event_tracker->AddEnd(&result.back());
       }
     }
+    consumed_.store(start_, std::memory_order_release);
     return result;
   }
 
@@ -235,6 +252,8 @@ class EventQueue {
   // Tail of list for writing. Accessed by producer thread.
   Block* end_block_;
   std::atomic<size_t> end_;  // Atomic: also read by consumer thread.
+  // Value of start_ after the last Consume or Clear. Read by producer thread.
+  std::atomic<size_t> consumed_;
 };
 
 }  // namespace
@@ -257,7 +276,14 @@ class TraceMeRecorder::ThreadLocalRecorder {
   void SetActive(bool active) { active_ = active; }
 
   // Record is only called from the owner thread.
-  void Record(TraceMeRecorder::Event&& event) { queue_.Push(std::move(event)); }
+  void Record(TraceMeRecorder::Event&& event) {
+    const size_t max_events =
+        g_max_events_per_thread.load(std::memory_order_relaxed);
+    if (TF_PREDICT_FALSE(max_events > 0 && queue_.Size() >= max_events)) {
+      return;
+    }
+    queue_.Push(std::move(event));
+  }
 
   // Clear is called from the control thread when tracing starts to remove any
   // elements added due to Record racing with Consume.
@@ -363,9 +389,14 @@ TraceMeRecorder::Events TraceMeRecorder::Consume() {
   return result;
 }
 
-bool TraceMeRecorder::StartRecording(int level) {
+bool TraceMeRecorder::StartRecording(int level,
+                                     size_t max_events_per_thread) {
   level = std::max(0, level);
   mutex_lock lock(mutex_);
+  if (Active(0)) return false;
+  // Set the bound before activating tracing, so all recorded events see it.
+  g_max_events_per_thread.store(max_events_per_thread,
+                                std::memory_order_relaxed);
   // Change trace_level_ while holding mutex_.
   int expected = kTracingDisabled;
   bool started = internal::g_trace_level.compare_exchange_strong(
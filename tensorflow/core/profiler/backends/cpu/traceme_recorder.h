@@ -42,7 +42,8 @@ TF_EXPORT extern std::atomic<int> g_trace_level;
 // It can be safely and cheaply appended to by multiple threads.
 //
 // Start() and Stop() must be called in pairs, Stop() returns the events added
-// since the previous Start().
+// since the previous Start(). A bounded Start() caps the events kept per thread
+// so the recorder can stay on for sampled production profiling.
 //
 // This is the backend for TraceMe instrumentation.
 // The profiler starts the recorder, the TraceMe destructor records complete
@@ -83,7 +84,11 @@ class TraceMeRecorder {
   // Starts recording of TraceMe().
   // Only traces <= level will be recorded.
   // Level must be >= 0. If level is 0, no traces will be recorded.
-  static bool Start(int level) { return Get()->StartRecording(level); }
+  // If max_events_per_thread > 0, each thread keeps at most that many events
+  // until Stop(), and drops the events it records after that.
+  static bool Start(int level, size_t max_events_per_thread = 0) {
+    return Get()->StartRecording(level, max_events_per_thread);
+  }
 
   // Stops recording and returns events recorded since Start().
   // Events passed to Record after Stop has started will be dropped.
@@ -117,7 +122,7 @@ class TraceMeRecorder {
   void RegisterThread(uint32 tid, std::shared_ptr<ThreadLocalRecorder> thread);
   void UnregisterThread(uint32 tid);
 
-  bool StartRecording(int level);
+  bool StartRecording(int level, size_t max_events_per_thread);
   Events StopRecording();
 
   // Clears events from all active threads that were added due to Record
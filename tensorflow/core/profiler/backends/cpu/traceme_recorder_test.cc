@@ -57,6 +57,28 @@ TEST(RecorderTest, SingleThreaded) {
               ElementsAre(Named("during1"), Named("during2")));
 }
 
+TEST(RecorderTest, MaxEventsPerThread) {
+  int64_t start_time = GetCurrentTimeNanos();
+  int64_t end_time = start_time + UniToNano(1);
+
+  TraceMeRecorder::Start(/*level=*/1, /*max_events_per_thread=*/2);
+  TraceMeRecorder::Record({"during1", start_time, end_time});
+  TraceMeRecorder::Record({"during2", start_time, end_time});
+  TraceMeRecorder::Record({"dropped", start_time, end_time});
+  auto results = TraceMeRecorder::Stop();
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_THAT(results[0].events,
+              ElementsAre(Named("during1"), Named("during2")));
+
+  // The bound applies to each recording, not to the lifetime of the thread.
+  TraceMeRecorder::Start(/*level=*/1, /*max_events_per_thread=*/1);
+  TraceMeRecorder::Record({"during3", start_time, end_time});
+  TraceMeRecorder::Record({"dropped", start_time, end_time});
+  results = TraceMeRecorder::Stop();
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_THAT(results[0].events, ElementsAre(Named("during3")));
+}
+
 // Checks the functional behavior of the recorder, when used from several
 // unsynchronized threads.
 //
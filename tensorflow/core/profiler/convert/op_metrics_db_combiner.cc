@@ -72,6 +72,18 @@ void CombineOpMetrics(const OpMetrics& src, OpMetrics* dst) {
   CombineMemoryAccessedBreakdown(src.memory_accessed_breakdown(),
                                  dst->mutable_memory_accessed_breakdown());
   dst->set_dma_stall_ps(src.dma_stall_ps() + dst->dma_stall_ps());
+  if (src.has_hardware_counters()) {
+    CombineHardwareCounters(src.hardware_counters(),
+                            dst->mutable_hardware_counters());
+  }
+}
+
+void CombineHardwareCounters(const OpMetrics::HardwareCounters& src,
+                             OpMetrics::HardwareCounters* dst) {
+  dst->set_cpu_cycles(src.cpu_cycles() + dst->cpu_cycles());
+  dst->set_cpu_instructions(src.cpu_instructions() + dst->cpu_instructions());
+  dst->set_cache_misses(src.cache_misses() + dst->cache_misses());
+  dst->set_branch_misses(src.branch_misses() + dst->branch_misses());
 }
 
 void CombineMemoryAccessedBreakdown(
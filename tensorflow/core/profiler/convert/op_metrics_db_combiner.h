@@ -29,6 +29,10 @@ void CopyOpMetricsMetadata(const OpMetrics& src, OpMetrics* dst);
 // Combines OpMetrics data (e.g., occurrences, time) from src into dst.
 void CombineOpMetrics(const OpMetrics& src, OpMetrics* dst);
 
+// Combines the hardware performance counters.
+void CombineHardwareCounters(const OpMetrics::HardwareCounters& src,
+                             OpMetrics::HardwareCounters* dst);
+
 // Combines the memory access breakdown.
 void CombineMemoryAccessedBreakdown(
     const protobuf::RepeatedPtrField<OpMetrics_MemoryAccessed>& src,
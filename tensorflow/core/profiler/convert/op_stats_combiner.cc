@@ -155,6 +155,10 @@ void CombineOpStats(
   dst->mutable_kernel_stats_db()->mutable_reports()->MergeFrom(
       src.kernel_stats_db().reports());
 
+  // Combine device idle time breakdowns.
+  dst->mutable_device_idle_db()->mutable_steps()->MergeFrom(
+      src.device_idle_db().steps());
+
   // Combine tf-function stats.
   CombineTfFunctionDb(src.tf_function_db(), dst->mutable_tf_function_db());
 
@@ -15,10 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/convert/op_stats_to_overview_page.h"
 
+#include <algorithm>
+#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "google/protobuf/any.pb.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/convert/op_metrics_to_record.h"
 #include "tensorflow/core/profiler/convert/op_stats_to_input_pipeline_analysis.h"
@@ -129,6 +134,50 @@ std::string GeneratePrecisionStatement(const PrecisionStats& precision_stats) {
   return "";
 }
 
+absl::string_view DeviceIdleCauseName(int cause) {
+  switch (cause) {
+    case IDLE_HOST_TO_DEVICE:
+      return "Host-to-device copy";
+    case IDLE_SYNC:
+      return "Synchronization";
+    case IDLE_WAIT_INPUT:
+      return "Waiting for input";
+    case IDLE_KERNEL_LAUNCH:
+      return "Kernel launch";
+    case IDLE_HOST_DISPATCH:
+      return "Host op dispatch";
+    default:
+      return "Unattributed";
+  }
+}
+
+// Adds the percentage of the device idle time of each cause, over all steps
+// and devices, from the most to the least common cause.
+void ComputeDeviceIdleCauses(const DeviceIdleDb& device_idle_db,
+                             OverviewPageAnalysis* analysis) {
+  std::map<int, uint64> idle_ps_per_cause;
+  uint64 total_idle_ps = 0;
+  for (const DeviceIdleBreakdown& step : device_idle_db.steps()) {
+    for (const auto& cause_and_idle_ps : step.idle_ps()) {
+      idle_ps_per_cause[cause_and_idle_ps.first] += cause_and_idle_ps.second;
+      total_idle_ps += cause_and_idle_ps.second;
+    }
+  }
+  std::vector<std::pair<int, uint64>> sorted_causes(idle_ps_per_cause.begin(),
+                                                    idle_ps_per_cause.end());
+  std::stable_sort(sorted_causes.begin(), sorted_causes.end(),
+                   [](const std::pair<int, uint64>& a,
+                      const std::pair<int, uint64>& b) {
+                     return a.second > b.second;
+                   });
+  for (const auto& cause_and_idle_ps : sorted_causes) {
+    OverviewDeviceIdleCause* cause = analysis->add_device_idle_causes();
+    cause->set_cause(std::string(DeviceIdleCauseName(cause_and_idle_ps.first)));
+    cause->set_idle_time_percent(
+        100.0 * SafeDivide(cause_and_idle_ps.second, total_idle_ps));
+  }
+}
+
 }  // namespace
 
 void SetCommonRecommendation(
@@ -259,6 +308,7 @@ OverviewPageAnalysis ComputeAnalysisResult(const OpStats& op_stats) {
   analysis.set_device_op_time_outside_compilation_percent(
       100.0 * SafeDivide(outside_compilation_device_op_time_ps,
                          total_device_op_time_ps_exclude_idle));
+  ComputeDeviceIdleCauses(op_stats.device_idle_db(), &analysis);
   return analysis;
 }
 
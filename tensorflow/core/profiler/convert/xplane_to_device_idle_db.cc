@@ -0,0 +1,272 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/xplane_to_device_idle_db.h"
+
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/protobuf/steps_db.pb.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/tf_op_utils.h"
+#include "tensorflow/core/profiler/utils/tf_xplane_visitor.h"
+#include "tensorflow/core/profiler/utils/timespan.h"
+#include "tensorflow/core/profiler/utils/trace_utils.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_utils.h"
+#include "tensorflow/core/profiler/utils/xplane_visitor.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+// The kind of an activity that keeps the device busy. The other kinds are the
+// DeviceIdleCause values, whose order is their priority.
+constexpr int kBusy = DeviceIdleCause_ARRAYSIZE;
+constexpr int kNumActivityKinds = kBusy + 1;
+
+struct Activity {
+  uint64 begin_ps;
+  uint64 end_ps;
+  int kind;
+};
+
+// The activities of a step on the host or on a device.
+struct StepActivities {
+  uint64 begin_ps = kuint64max;
+  uint64 end_ps = 0;
+  std::vector<Activity> activities;
+
+  // Extends the step to include `span`.
+  void Extend(const Timespan& span) {
+    begin_ps = std::min(begin_ps, span.begin_ps());
+    end_ps = std::max(end_ps, span.end_ps());
+  }
+
+  void Add(const Timespan& span, int kind) {
+    Extend(span);
+    activities.push_back({span.begin_ps(), span.end_ps(), kind});
+  }
+};
+
+// Map group id to the activities of the step.
+using StepActivitiesMap = absl::flat_hash_map<int64_t, StepActivities>;
+
+// Returns true if the event encloses the other events of a step rather than
+// doing work, e.g. a step marker.
+bool IsStepContainer(absl::string_view event_name) {
+  return absl::StartsWith(event_name, "EagerExecute") ||
+         absl::StartsWith(event_name, "EagerLocalExecute") ||
+         absl::StartsWith(event_name, "EagerKernelExecute") ||
+         absl::StartsWith(event_name, "FunctionRun") ||
+         absl::StartsWith(event_name, "TraceContext") ||
+         absl::StartsWith(event_name, "train") ||
+         absl::StartsWith(event_name, "test");
+}
+
+DeviceIdleCause ClassifyHostEvent(absl::string_view event_name,
+                                  bool has_correlation_id) {
+  TfOp tf_op = ParseTfOpFullname(event_name);
+  if (IsInfeedEnqueueOp(tf_op) || IsMemcpyHToDOp(tf_op)) {
+    return IDLE_HOST_TO_DEVICE;
+  } else if (IsMemcpyDToHOp(tf_op) ||
+             absl::StrContains(event_name, "Synchronize")) {
+    return IDLE_SYNC;
+  } else if (absl::StartsWithIgnoreCase(event_name, "IteratorGetNext") ||
+             absl::StartsWith(event_name, "Iterator::")) {
+    return IDLE_WAIT_INPUT;
+  } else if (has_correlation_id) {
+    // Events with a correlation id are the runtime API calls that enqueue the
+    // device events.
+    return IDLE_KERNEL_LAUNCH;
+  } else {
+    return IDLE_HOST_DISPATCH;
+  }
+}
+
+int ClassifyDeviceEvent(absl::string_view event_name) {
+  TfOp tf_op = ParseTfOpFullname(event_name);
+  if (IsMemcpyHToDOp(tf_op)) return IDLE_HOST_TO_DEVICE;
+  if (IsMemcpyDToHOp(tf_op)) return IDLE_SYNC;
+  return kBusy;
+}
+
+StepActivitiesMap ConvertHostThreadsXPlaneToStepActivities(
+    const XPlane& host_trace) {
+  StepActivitiesMap result;
+  XPlaneVisitor plane = CreateTfXPlaneVisitor(&host_trace);
+  plane.ForEachLine([&](const XLineVisitor& line) {
+    line.ForEachEvent([&](const XEventVisitor& event) {
+      int64_t group_id = -1;
+      bool has_correlation_id = false;
+      bool is_step_marker = false;
+      event.ForEachStat([&](const XStatVisitor& stat) {
+        if (!stat.Type().has_value()) return;
+        switch (stat.Type().value()) {
+          case StatType::kGroupId:
+            group_id = stat.IntValue();
+            break;
+          case StatType::kCorrelationId:
+            has_correlation_id = true;
+            break;
+          case StatType::kStepName:
+          case StatType::kStepNum:
+            is_step_marker = true;
+            break;
+        }
+      });
+      if (group_id < 0) return;
+      StepActivities& step = result[group_id];
+      if (is_step_marker || IsStepContainer(event.Name())) {
+        step.Extend(event.GetTimespan());
+      } else {
+        step.Add(event.GetTimespan(),
+                 ClassifyHostEvent(event.Name(), has_correlation_id));
+      }
+    });
+  });
+  return result;
+}
+
+StepActivitiesMap ConvertDeviceTraceXPlaneToStepActivities(
+    const XPlane& device_trace) {
+  StepActivitiesMap result;
+  XPlaneVisitor plane = CreateTfXPlaneVisitor(&device_trace);
+  plane.ForEachLine([&](const XLineVisitor& line) {
+    if (IsDerivedThreadId(line.Id())) return;
+    line.ForEachEvent([&](const XEventVisitor& event) {
+      absl::optional<XStatVisitor> group_id =
+          event.GetStat(StatType::kGroupId);
+      if (!group_id.has_value()) return;
+      result[group_id->IntValue()].Add(event.GetTimespan(),
+                                       ClassifyDeviceEvent(event.Name()));
+    });
+  });
+  return result;
+}
+
+// Attributes every picosecond of the step to the busy time, or to the idle
+// cause with the highest priority among the activities at that time.
+DeviceIdleBreakdown BreakDownStep(const StepActivities& step) {
+  struct Edge {
+    uint64 time_ps;
+    int kind;
+    int delta;
+  };
+  std::vector<Edge> edges;
+  edges.reserve(2 * step.activities.size());
+  for (const Activity& activity : step.activities) {
+    if (activity.begin_ps == activity.end_ps) continue;
+    edges.push_back({activity.begin_ps, activity.kind, 1});
+    edges.push_back({activity.end_ps, activity.kind, -1});
+  }
+  std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) {
+    return a.time_ps < b.time_ps;
+  });
+
+  DeviceIdleBreakdown breakdown;
+  breakdown.set_begin_ps(step.begin_ps);
+  breakdown.set_duration_ps(step.end_ps - step.begin_ps);
+  std::array<int, kNumActivityKinds> active = {};
+  std::array<uint64, kNumActivityKinds> time_ps = {};
+  auto attribute = [&](uint64 duration_ps) {
+    int kind = IDLE_UNATTRIBUTED;
+    if (active[kBusy] > 0) {
+      kind = kBusy;
+    } else {
+      for (int cause = IDLE_UNATTRIBUTED + 1; cause < kBusy; ++cause) {
+        if (active[cause] > 0) {
+          kind = cause;
+          break;
+        }
+      }
+    }
+    time_ps[kind] += duration_ps;
+  };
+  uint64 time = step.begin_ps;
+  for (const Edge& edge : edges) {
+    if (edge.time_ps > time) {
+      attribute(edge.time_ps - time);
+      time = edge.time_ps;
+    }
+    active[edge.kind] += edge.delta;
+  }
+  if (step.end_ps > time) attribute(step.end_ps - time);
+
+  breakdown.set_busy_ps(time_ps[kBusy]);
+  for (int cause = 0; cause < kBusy; ++cause) {
+    if (time_ps[cause] > 0) {
+      (*breakdown.mutable_idle_ps())[cause] = time_ps[cause];
+    }
+  }
+  return breakdown;
+}
+
+uint32 DeviceOrdinal(const XPlane& device_trace) {
+  uint32 ordinal;
+  absl::string_view name = device_trace.name();
+  name.remove_prefix(kGpuPlanePrefix.size());
+  if (absl::SimpleAtoi(name, &ordinal)) return ordinal;
+  return device_trace.id();
+}
+
+}  // namespace
+
+DeviceIdleDb ConvertXSpaceToDeviceIdleDb(const XSpace& space) {
+  DeviceIdleDb result;
+  StepActivitiesMap host_steps;
+  if (const XPlane* host_plane =
+          FindPlaneWithName(space, kHostThreadsPlaneName)) {
+    host_steps = ConvertHostThreadsXPlaneToStepActivities(*host_plane);
+  }
+  for (const XPlane* device_trace :
+       FindPlanesWithPrefix(space, kGpuPlanePrefix)) {
+    const uint32 device_ordinal = DeviceOrdinal(*device_trace);
+    StepActivitiesMap device_steps =
+        ConvertDeviceTraceXPlaneToStepActivities(*device_trace);
+    for (auto& id_and_step : device_steps) {
+      StepActivities& step = id_and_step.second;
+      auto host_step = host_steps.find(id_and_step.first);
+      if (host_step != host_steps.end()) {
+        step.begin_ps = std::min(step.begin_ps, host_step->second.begin_ps);
+        step.end_ps = std::max(step.end_ps, host_step->second.end_ps);
+        step.activities.insert(step.activities.end(),
+                               host_step->second.activities.begin(),
+                               host_step->second.activities.end());
+      }
+      DeviceIdleBreakdown* breakdown = result.add_steps();
+      *breakdown = BreakDownStep(step);
+      breakdown->set_step_id(id_and_step.first);
+      breakdown->set_device_ordinal(device_ordinal);
+    }
+  }
+  std::sort(result.mutable_steps()->begin(), result.mutable_steps()->end(),
+            [](const DeviceIdleBreakdown& a, const DeviceIdleBreakdown& b) {
+              return std::make_tuple(a.step_id(), a.device_ordinal()) <
+                     std::make_tuple(b.step_id(), b.device_ordinal());
+            });
+  return result;
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
@@ -0,0 +1,35 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PROFILER_CONVERT_XPLANE_TO_DEVICE_IDLE_DB_H_
+#define TENSORFLOW_CORE_PROFILER_CONVERT_XPLANE_TO_DEVICE_IDLE_DB_H_
+
+#include "tensorflow/core/profiler/protobuf/steps_db.pb.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+// Breaks down the time each GPU is idle in each step by the host or copy
+// activity of the step that overlaps the idle intervals, e.g. the executor
+// dispatching ops, kernel launches, IteratorGetNext, host-to-device copies
+// and synchronizations. A step spans the host and device events of a group.
+// NOTE: call GroupTfEvents before so that events have a group id.
+DeviceIdleDb ConvertXSpaceToDeviceIdleDb(const XSpace& space);
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_CONVERT_XPLANE_TO_DEVICE_IDLE_DB_H_
@@ -0,0 +1,93 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/xplane_to_device_idle_db.h"
+
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/protobuf/steps_db.pb.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/group_events.h"
+#include "tensorflow/core/profiler/utils/xplane_builder.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_test_utils.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+// Tests a step in which the device runs a kernel and a host-to-device copy.
+// Before the kernel, the host waits for the input, dispatches the op and
+// launches the kernel. The copy is issued by a second op.
+TEST(ConvertXSpaceToDeviceIdleDb, AttributesIdleTimePerStep) {
+  constexpr int64_t kStepNum = 123;
+  constexpr int64_t kStepId = 0;
+  constexpr int64_t kKernelCorrelationId = 100;
+  constexpr int64_t kMemcpyCorrelationId = 200;
+
+  XSpace space;
+  XPlaneBuilder host_plane_builder(GetOrCreateHostXPlane(&space));
+  host_plane_builder.ReserveLines(2);
+
+  auto main_thread = host_plane_builder.GetOrCreateLine(0);
+  CreateXEvent(&host_plane_builder, &main_thread, HostEventType::kTraceContext,
+               0, 1000, {{StatType::kStepNum, kStepNum}});
+  CreateXEvent(&host_plane_builder, &main_thread, HostEventType::kFunctionRun,
+               10, 970, {{StatType::kStepId, kStepId}});
+
+  auto tf_executor_thread = host_plane_builder.GetOrCreateLine(1);
+  CreateXEvent(&host_plane_builder, &tf_executor_thread,
+               HostEventType::kExecutorStateProcess, 100, 200,
+               {{StatType::kStepId, kStepId}});
+  CreateXEvent(&host_plane_builder, &tf_executor_thread, "IteratorGetNext",
+               100, 100);
+  CreateXEvent(&host_plane_builder, &tf_executor_thread, "matmul", 250, 50,
+               {{StatType::kCorrelationId, kKernelCorrelationId}});
+  CreateXEvent(&host_plane_builder, &tf_executor_thread,
+               HostEventType::kExecutorStateProcess, 500, 200,
+               {{StatType::kStepId, kStepId}});
+  CreateXEvent(&host_plane_builder, &tf_executor_thread, "MemcpyHToD", 600,
+               100, {{StatType::kCorrelationId, kMemcpyCorrelationId}});
+
+  XPlaneBuilder device_plane_builder(GetOrCreateGpuXPlane(&space, 1));
+  device_plane_builder.ReserveLines(1);
+  auto stream = device_plane_builder.GetOrCreateLine(0);
+  CreateXEvent(&device_plane_builder, &stream, "matmul", 300, 150,
+               {{StatType::kCorrelationId, kKernelCorrelationId}});
+  CreateXEvent(&device_plane_builder, &stream, "MemcpyHToD", 650, 150,
+               {{StatType::kCorrelationId, kMemcpyCorrelationId}});
+
+  GroupTfEvents(&space);
+  DeviceIdleDb device_idle_db = ConvertXSpaceToDeviceIdleDb(space);
+
+  ASSERT_EQ(device_idle_db.steps_size(), 1);
+  const DeviceIdleBreakdown& step = device_idle_db.steps(0);
+  EXPECT_EQ(step.device_ordinal(), 1);
+  EXPECT_EQ(step.begin_ps(), 0);
+  EXPECT_EQ(step.duration_ps(), 1000);
+  EXPECT_EQ(step.busy_ps(), 150);
+  // Before and after the device events, and between the ops.
+  EXPECT_EQ(step.idle_ps().at(IDLE_UNATTRIBUTED), 350);
+  EXPECT_EQ(step.idle_ps().at(IDLE_WAIT_INPUT), 100);
+  EXPECT_EQ(step.idle_ps().at(IDLE_HOST_DISPATCH), 150);
+  EXPECT_EQ(step.idle_ps().at(IDLE_KERNEL_LAUNCH), 50);
+  // The host copy and the device copy overlap.
+  EXPECT_EQ(step.idle_ps().at(IDLE_HOST_TO_DEVICE), 200);
+  EXPECT_EQ(step.idle_ps().count(IDLE_SYNC), 0);
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
@@ -155,6 +155,9 @@ MemoryProfile GenerateMemoryProfile(const XPlane* host_trace) {
           case StatType::kTensorShapes:
             metadata.set_tensor_shape(std::string(stat.StrOrRefValue()));
             break;
+          case StatType::kTensorName:
+            metadata.set_tensor_name(std::string(stat.StrOrRefValue()));
+            break;
         }
       });
 
@@ -210,6 +213,8 @@ void UpdateDeallocation(PerAllocatorMemoryProfile* memory_profile) {
             alloc_meta->data_type());
         snapshot.mutable_activity_metadata()->set_tensor_shape(
             alloc_meta->tensor_shape());
+        snapshot.mutable_activity_metadata()->set_tensor_name(
+            alloc_meta->tensor_name());
         // In case of following (unexpected) deallocations to the same chunk
         // address, leave the metadata as it is (empty or already captured).
         addr_metadata_map.erase(address);
@@ -248,7 +253,7 @@ int64_t GetPeakMemoryStep(int64_t peak_bytes_profile,
 
 // Functor that compares (index, metadata) pair to sort in the order of
 // allocation bytes and requested bytes (descending), as well as TF Op name,
-// region type, data type, and tensor shape (ascending).
+// region type, data type, tensor shape, and tensor name (ascending).
 struct MetadataComparator {
   bool operator()(const IndexMetaPair& a, const IndexMetaPair& b) const {
     const MemoryActivityMetadata* a_meta = a.second;
@@ -259,11 +264,13 @@ struct MetadataComparator {
     auto lhs =
         std::make_tuple(-a_meta->allocation_bytes(), -a_meta->requested_bytes(),
                         a_meta->tf_op_name(), a_meta->region_type(),
-                        a_meta->data_type(), a_meta->tensor_shape());
+                        a_meta->data_type(), a_meta->tensor_shape(),
+                        a_meta->tensor_name());
     auto rhs =
         std::make_tuple(-b_meta->allocation_bytes(), -b_meta->requested_bytes(),
                         b_meta->tf_op_name(), b_meta->region_type(),
-                        b_meta->data_type(), b_meta->tensor_shape());
+                        b_meta->data_type(), b_meta->tensor_shape(),
+                        b_meta->tensor_name());
     return lhs < rhs;
   }
 };
@@ -317,7 +324,8 @@ bool operator==(const IndexMetaPair& a, const IndexMetaPair& b) {
          a_meta->tf_op_name() == b_meta->tf_op_name() &&
          a_meta->region_type() == b_meta->region_type() &&
          a_meta->data_type() == b_meta->data_type() &&
-         a_meta->tensor_shape() == b_meta->tensor_shape();
+         a_meta->tensor_shape() == b_meta->tensor_shape() &&
+         a_meta->tensor_name() == b_meta->tensor_name();
 }
 
 // Generate the memory breakdown table of active allocations at the peak usage
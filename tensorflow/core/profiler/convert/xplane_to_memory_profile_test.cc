@@ -122,6 +122,46 @@ TEST(ConvertXPlaneToMemoryProfile, OneAllocatorMultiActivitiesTest) {
       2000);
 }
 
+// Tests that the active allocations at peak are attributed to their tensors.
+TEST(ConvertXPlaneToMemoryProfile, TensorNameTest) {
+  XSpace space;
+  XPlane* host_plane = GetOrCreateHostXPlane(&space);
+  XPlaneBuilder host_plane_builder(host_plane);
+  host_plane_builder.ReserveLines(1);
+
+  auto tf_executor_thread = host_plane_builder.GetOrCreateLine(0);
+  CreateXEvent(&host_plane_builder, &tf_executor_thread, "MemoryAllocation",
+               40000, 1000,
+               {{StatType::kBytesReserved, int64_t{0}},
+                {StatType::kBytesAllocated, int64_t{1024}},
+                {StatType::kBytesAvailable, int64_t{3072}},
+                {StatType::kPeakBytesInUse, int64_t{1024}},
+                {StatType::kRequestedBytes, int64_t{1024}},
+                {StatType::kAllocationBytes, int64_t{1024}},
+                {StatType::kAddress, int64_t{222333}},
+                {StatType::kDataType, int64_t{1}},
+                {StatType::kAllocatorName, "gpu_async_0"},
+                {StatType::kTfOp, "dense/MatMul"},
+                {StatType::kRegionType, "output"},
+                {StatType::kTensorName, "dense/MatMul:0"},
+                {StatType::kTensorShapes, "[16, 16]"}});
+
+  tensorflow::profiler::GroupTfEvents(&space);
+  MemoryProfile memory_profile = ConvertXPlaneToMemoryProfile(*host_plane);
+  ASSERT_EQ(memory_profile.memory_profile_per_allocator().size(), 1);
+  const auto& allocator_memory_profile =
+      memory_profile.memory_profile_per_allocator().at("gpu_async_0");
+  ASSERT_EQ(allocator_memory_profile.memory_profile_snapshots_size(), 1);
+  const auto& metadata = allocator_memory_profile.memory_profile_snapshots()
+                             .at(0)
+                             .activity_metadata();
+  EXPECT_EQ(metadata.tf_op_name(), "dense/MatMul");
+  EXPECT_EQ(metadata.tensor_name(), "dense/MatMul:0");
+  ASSERT_GE(allocator_memory_profile.active_allocations_size(), 1);
+  EXPECT_EQ(
+      allocator_memory_profile.active_allocations().at(0).snapshot_index(), 0);
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
@@ -60,6 +60,9 @@ struct TfActivity {
   TfOp tf_op;
   // Whether it is eagerly executed.
   bool is_eager;
+  // The hardware performance counters of the Op, if they were recorded. Only
+  // set on kTfOpEnd activities.
+  absl::optional<OpMetrics::HardwareCounters> hardware_counters;
 };
 
 // TF Op metrics stored as element in OpStack.
@@ -96,7 +99,10 @@ void ProcessOneTfActivity(const TfActivity& activity,
           PicoSpan(info->start_timestamp_ps, activity.timestamp_ps);
       tf_metrics_data->tf_metrics_db_builder.EnterOp(
           activity.tf_op.name, activity.tf_op.type, activity.is_eager,
-          tf_op_span.duration_ps(), info->children_duration_ps);
+          tf_op_span.duration_ps(), info->children_duration_ps,
+          activity.hardware_counters.has_value()
+              ? &*activity.hardware_counters
+              : nullptr);
       TfOpInfo* parent_info = tf_op_stack->Top();
       if (parent_info != nullptr) {
         parent_info->children_duration_ps += tf_op_span.duration_ps();
@@ -138,15 +144,38 @@ void CollectTfActivities(const XLineVisitor& line,
     if (tf_op != nullptr) {
       ++tf_op_id;
       bool is_eager = false;
-      if (absl::optional<XStatVisitor> stat =
-              event.GetStat(StatType::kIsEager)) {
-        is_eager = stat->IntValue();
-      }
+      absl::optional<OpMetrics::HardwareCounters> hardware_counters;
+      event.ForEachStat([&](const XStatVisitor& stat) {
+        if (!stat.Type().has_value()) return;
+        switch (static_cast<StatType>(*stat.Type())) {
+          case StatType::kIsEager:
+            is_eager = stat.IntValue();
+            break;
+          case StatType::kCpuCycles:
+            if (!hardware_counters) hardware_counters.emplace();
+            hardware_counters->set_cpu_cycles(stat.IntOrUintValue());
+            break;
+          case StatType::kCpuInstructions:
+            if (!hardware_counters) hardware_counters.emplace();
+            hardware_counters->set_cpu_instructions(stat.IntOrUintValue());
+            break;
+          case StatType::kCacheMisses:
+            if (!hardware_counters) hardware_counters.emplace();
+            hardware_counters->set_cache_misses(stat.IntOrUintValue());
+            break;
+          case StatType::kBranchMisses:
+            if (!hardware_counters) hardware_counters.emplace();
+            hardware_counters->set_branch_misses(stat.IntOrUintValue());
+            break;
+          default:
+            break;
+        }
+      });
       Timespan span = event.GetTimespan();
       tf_activities->push_back(
           {span.begin_ps(), tf_op_id, kTfOpBegin, *tf_op, is_eager});
-      tf_activities->push_back(
-          {span.end_ps(), tf_op_id, kTfOpEnd, *tf_op, is_eager});
+      tf_activities->push_back({span.end_ps(), tf_op_id, kTfOpEnd, *tf_op,
+                                is_eager, std::move(hardware_counters)});
     }
   });
 }
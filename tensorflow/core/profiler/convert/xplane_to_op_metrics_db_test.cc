@@ -101,6 +101,44 @@ TEST(ConvertXPlaneToOpMetricsDb, HostOpMetricsDb) {
   EXPECT_EQ(NanoToPico(kTfOp2DurationNs), op_2.time_ps());
 }
 
+TEST(ConvertXPlaneToOpMetricsDb, HostOpHardwareCounters) {
+  static constexpr char kTfOp[] = "TfOp";
+
+  XSpace xspace;
+  XPlane* xplane = GetOrCreateHostXPlane(&xspace);
+  XPlaneBuilder host_plane(xplane);
+  XLineBuilder thread = host_plane.GetOrCreateLine(/*line_id=*/10);
+  for (int64_t start_ns : {100000, 200000}) {
+    XEventBuilder event = thread.AddEvent(
+        *host_plane.GetOrCreateEventMetadata(absl::StrCat(kTfOp, ":", kTfOp)));
+    event.SetTimestampNs(start_ns);
+    event.SetDurationNs(1000);
+    event.AddStatValue(*host_plane.GetOrCreateStatMetadata(
+                           GetStatTypeStr(StatType::kCpuCycles)),
+                       uint64{3000});
+    event.AddStatValue(*host_plane.GetOrCreateStatMetadata(
+                           GetStatTypeStr(StatType::kCpuInstructions)),
+                       uint64{6000});
+    event.AddStatValue(*host_plane.GetOrCreateStatMetadata(
+                           GetStatTypeStr(StatType::kCacheMisses)),
+                       uint64{10});
+    event.AddStatValue(*host_plane.GetOrCreateStatMetadata(
+                           GetStatTypeStr(StatType::kBranchMisses)),
+                       uint64{5});
+  }
+
+  OpMetricsDb op_metrics = ConvertHostThreadsXPlaneToOpMetricsDb(*xplane);
+  const OpMetrics& op = op_metrics.metrics_db().at(0);
+  EXPECT_EQ(kTfOp, op.name());
+  EXPECT_EQ(2, op.occurrences());
+  EXPECT_EQ(6000, op.hardware_counters().cpu_cycles());
+  EXPECT_EQ(12000, op.hardware_counters().cpu_instructions());
+  EXPECT_EQ(20, op.hardware_counters().cache_misses());
+  EXPECT_EQ(10, op.hardware_counters().branch_misses());
+  // Each cache miss transfers a cache line.
+  EXPECT_EQ(20 * 64, op.bytes_accessed());
+}
+
 TEST(ConvertXPlaneToOpMetricsDb, DeviceOpMetricsDb) {
   // TfOp1 has kernel1 and kernel2; TfOp2 has kernel3.
   static constexpr char kTfOp1[] = "TfOp1";
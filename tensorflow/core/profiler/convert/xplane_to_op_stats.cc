@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/convert/op_metrics_db_combiner.h"
 #include "tensorflow/core/profiler/convert/op_stats_combiner.h"
 #include "tensorflow/core/profiler/convert/step_events_to_steps_db.h"
+#include "tensorflow/core/profiler/convert/xplane_to_device_idle_db.h"
 #include "tensorflow/core/profiler/convert/xplane_to_kernel_stats_db.h"
 #include "tensorflow/core/profiler/convert/xplane_to_op_metrics_db.h"
 #include "tensorflow/core/profiler/convert/xplane_to_step_events.h"
@@ -175,6 +176,9 @@ OpStats ConvertXSpaceToOpStats(const XSpace& space,
         nonoverlapped_step_events);
     *op_stats.mutable_device_op_metrics_db()->mutable_precision_stats() =
         ComputePrecisionStats(nonoverlapped_step_events);
+    if (has_device) {
+      *op_stats.mutable_device_idle_db() = ConvertXSpaceToDeviceIdleDb(space);
+    }
   }
 
   CoreDetails& details =
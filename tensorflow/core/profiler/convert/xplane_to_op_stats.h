@@ -28,6 +28,7 @@ namespace profiler {
 struct OpStatsOptions {
   bool maybe_drop_incomplete_steps = false;
   bool generate_op_metrics_db = false;
+  // Also generates the device idle time breakdown if there is a device.
   bool generate_step_db = false;
   bool generate_kernel_stats_db = false;
 };
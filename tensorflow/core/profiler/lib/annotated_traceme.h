@@ -24,12 +24,19 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
+#if !defined(IS_MOBILE_PLATFORM)
+#include "tensorflow/core/profiler/backends/cpu/perf_counters.h"
+#endif
 
 namespace tensorflow {
 namespace profiler {
 
 // Combination of TraceMe and ScopedAnnotation which share the same label.
 // Optimization are done to ensure the label generation are done once.
+// AnnotatedTraceMe is used for kernel-level spans, so when the hardware
+// performance counters are enabled, it also records the counters of the span
+// as metadata of the TraceMe.
 class AnnotatedTraceMe {
  public:
   template <typename NameGeneratorT>
@@ -44,12 +51,41 @@ class AnnotatedTraceMe {
       }
       if (TF_PREDICT_TRUE(traceme_enabled)) {
         trace_me_.emplace([&name] { return std::move(name); }, level);
+#if !defined(IS_MOBILE_PLATFORM)
+        if (TF_PREDICT_FALSE(PerfCounters::Enabled())) {
+          perf_counters_.emplace();
+          if (!PerfCounters::Read(&*perf_counters_)) perf_counters_.reset();
+        }
+#endif
       }
     }
   }
 
+  ~AnnotatedTraceMe() {
+#if !defined(IS_MOBILE_PLATFORM)
+    if (TF_PREDICT_FALSE(perf_counters_.has_value())) {
+      PerfCounterValues end;
+      if (PerfCounters::Read(&end)) {
+        const PerfCounterValues& begin = *perf_counters_;
+        trace_me_->AppendMetadata([&begin, &end] {
+          return TraceMeEncode(
+              {{"cpu_cycles", end.cpu_cycles - begin.cpu_cycles},
+               {"cpu_instructions",
+                end.cpu_instructions - begin.cpu_instructions},
+               {"cache_misses", end.cache_misses - begin.cache_misses},
+               {"branch_misses", end.branch_misses - begin.branch_misses}});
+        });
+      }
+    }
+#endif
+  }
+
  private:
   absl::optional<TraceMe> trace_me_;
+#if !defined(IS_MOBILE_PLATFORM)
+  // The counters at the begin of the span, if they are recorded.
+  absl::optional<PerfCounterValues> perf_counters_;
+#endif
   absl::optional<ScopedAnnotation> scoped_annotation_;
 };
 
@@ -0,0 +1,149 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/lib/continuous_profiler.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/profiler/backends/cpu/host_tracer_utils.h"
+#include "tensorflow/core/profiler/backends/cpu/traceme_recorder.h"
+#include "tensorflow/core/profiler/convert/xplane_to_op_metrics_db.h"
+#include "tensorflow/core/profiler/lib/profiler_lock.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/time_utils.h"
+
+namespace tensorflow {
+namespace profiler {
+
+OpMetricsDbSink MakeFileOpMetricsDbSink(Env* env,
+                                        const std::string& directory) {
+  return [env, directory](const OpMetricsDb& summary) {
+    TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory));
+    return WriteBinaryProto(
+        env,
+        io::JoinPath(directory,
+                     strings::StrCat("op_metrics_", env->NowMicros(), ".pb")),
+        summary);
+  };
+}
+
+ContinuousProfiler::ContinuousProfiler(Env* env,
+                                       const ContinuousProfilerOptions& options,
+                                       OpMetricsDbSink sink)
+    : env_(env),
+      options_(options),
+      sink_(std::move(sink)),
+      combiner_(absl::make_unique<OpMetricsDbCombiner>(&summary_)) {
+  if (options_.period_ms > 0) {
+    thread_ = absl::WrapUnique(env_->StartThread(
+        {}, "tf_continuous_profiler", [this]() { Run(); }));
+  }
+}
+
+ContinuousProfiler::~ContinuousProfiler() {
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    cond_var_.notify_all();
+  }
+  // Joins the background thread.
+  thread_.reset();
+  Status s = Export();
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to export the op metrics summary: " << s;
+  }
+}
+
+Status ContinuousProfiler::TraceWindow(int64_t window_ms) {
+  StatusOr<ProfilerLock> lock = ProfilerLock::Acquire();
+  if (!lock.ok()) return lock.status();
+  const uint64 start_time_ns = GetCurrentTimeNanos();
+  if (!TraceMeRecorder::Start(options_.trace_level,
+                              options_.max_events_per_thread)) {
+    return errors::Unavailable("TraceMeRecorder is already recording.");
+  }
+  WaitUntil(env_->NowMicros() + window_ms * EnvTime::kMillisToMicros);
+  TraceMeRecorder::Events events = TraceMeRecorder::Stop();
+  lock->ReleaseIfActive();
+
+  XPlane host_plane;
+  ConvertCompleteEventsToXPlane(start_time_ns, std::move(events), &host_plane);
+  OpMetricsDb op_metrics_db = ConvertHostThreadsXPlaneToOpMetricsDb(host_plane);
+  mutex_lock l(mu_);
+  combiner_->Combine(op_metrics_db);
+  if (++num_windows_ >= options_.windows_per_export) {
+    return ExportLocked();
+  }
+  return Status::OK();
+}
+
+Status ContinuousProfiler::Export() {
+  mutex_lock l(mu_);
+  return ExportLocked();
+}
+
+Status ContinuousProfiler::ExportLocked() {
+  if (num_windows_ == 0) return Status::OK();
+  OpMetricsDb summary = std::move(summary_);
+  summary_.Clear();
+  // The combiner indexes the metrics of the summary, so it is recreated.
+  combiner_ = absl::make_unique<OpMetricsDbCombiner>(&summary_);
+  num_windows_ = 0;
+  return sink_(summary);
+}
+
+void ContinuousProfiler::Run() {
+  const int64_t window_ms = std::min(options_.window_ms, options_.period_ms);
+  while (true) {
+    const uint64 period_start = env_->NowMicros();
+    const uint64 offset_ms =
+        random::New64() % (options_.period_ms - window_ms + 1);
+    if (!WaitUntil(period_start + offset_ms * EnvTime::kMillisToMicros)) {
+      return;
+    }
+    const double sample =
+        static_cast<double>(random::New64() >> 11) / (uint64{1} << 53);
+    if (sample < options_.sampling_rate) {
+      Status s = TraceWindow(window_ms);
+      if (!s.ok()) {
+        VLOG(1) << "Skipped a continuous profiling window: " << s;
+      }
+    }
+    if (!WaitUntil(period_start +
+                   options_.period_ms * EnvTime::kMillisToMicros)) {
+      return;
+    }
+  }
+}
+
+bool ContinuousProfiler::WaitUntil(uint64 deadline_micros) {
+  mutex_lock l(mu_);
+  while (!cancelled_) {
+    const uint64 now = env_->NowMicros();
+    if (now >= deadline_micros) return true;
+    cond_var_.wait_for(l, std::chrono::microseconds(deadline_micros - now));
+  }
+  return false;
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
@@ -0,0 +1,110 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_PROFILER_LIB_CONTINUOUS_PROFILER_H_
+#define TENSORFLOW_CORE_PROFILER_LIB_CONTINUOUS_PROFILER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/convert/op_metrics_db_combiner.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+struct ContinuousProfilerOptions {
+  // The profiler traces at most one window of `window_ms` in every
+  // `period_ms`, at a random offset within the period so that the windows do
+  // not alias with periodic training steps or requests. If `period_ms` is 0,
+  // no background thread is started and windows are only traced by
+  // ContinuousProfiler::TraceWindow.
+  int64_t period_ms = 60 * 1000;
+  int64_t window_ms = 1000;
+  // The fraction of periods in which a window is traced.
+  double sampling_rate = 1.0;
+  // Only TraceMes with a level <= trace_level are recorded.
+  int trace_level = 1;
+  // Bounds the memory used by the TraceMeRecorder during a window.
+  size_t max_events_per_thread = 1 << 16;
+  // The number of traced windows aggregated into each exported summary.
+  int windows_per_export = 10;
+};
+
+// Receives the op metrics of the host threads aggregated over a number of
+// windows. Sinks are called from a single thread at a time.
+using OpMetricsDbSink = std::function<Status(const OpMetricsDb&)>;
+
+// Returns a sink that writes each summary to a new binary proto file in
+// `directory`.
+OpMetricsDbSink MakeFileOpMetricsDbSink(Env* env, const std::string& directory);
+
+// A low-overhead profiler that can be left on in production. Unlike a
+// ProfilerSession, which records every event between its creation and
+// CollectData, it samples short windows of TraceMe events, aggregates them
+// into an OpMetricsDb, and periodically exports the aggregated summary.
+//
+// The profiler lock is only held while a window is traced. Windows that
+// overlap with a ProfilerSession are skipped.
+class ContinuousProfiler {
+ public:
+  ContinuousProfiler(Env* env, const ContinuousProfilerOptions& options,
+                     OpMetricsDbSink sink);
+
+  // Stops profiling and exports the windows traced since the last export.
+  ~ContinuousProfiler();
+
+  ContinuousProfiler(const ContinuousProfiler&) = delete;
+  ContinuousProfiler& operator=(const ContinuousProfiler&) = delete;
+
+  // Traces the host threads for `window_ms` and adds their op metrics to the
+  // summary. Returns an error if another profiler is active.
+  Status TraceWindow(int64_t window_ms);
+
+  // Exports the summary of the windows traced since the last export, if any.
+  Status Export();
+
+ private:
+  void Run();
+
+  // Waits until the time `deadline_micros` or until the profiler is
+  // cancelled. Returns false if the profiler is cancelled.
+  bool WaitUntil(uint64 deadline_micros);
+
+  Status ExportLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Env* const env_;
+  const ContinuousProfilerOptions options_;
+  const OpMetricsDbSink sink_;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  OpMetricsDb summary_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<OpMetricsDbCombiner> combiner_ TF_GUARDED_BY(mu_);
+  int num_windows_ TF_GUARDED_BY(mu_) = 0;
+
+  std::unique_ptr<Thread> thread_;
+};
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_LIB_CONTINUOUS_PROFILER_H_
@@ -0,0 +1,121 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/lib/continuous_profiler.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/lib/profiler_lock.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+
+ContinuousProfilerOptions ManualOptions() {
+  ContinuousProfilerOptions options;
+  options.period_ms = 0;
+  options.windows_per_export = 100;
+  return options;
+}
+
+// Records MatMul ops until `stop` is notified.
+std::unique_ptr<Thread> StartMatMulThread(Notification* stop) {
+  return absl::WrapUnique(
+      Env::Default()->StartThread({}, "matmul", [stop]() {
+        while (!stop->HasBeenNotified()) {
+          TraceMe trace("MatMul:MatMul");
+          Env::Default()->SleepForMicroseconds(100);
+        }
+      }));
+}
+
+bool HasOp(const OpMetricsDb& db, const std::string& name) {
+  for (const OpMetrics& metrics : db.metrics_db()) {
+    if (metrics.name() == name && metrics.occurrences() > 0) return true;
+  }
+  return false;
+}
+
+TEST(ContinuousProfilerTest, AggregatesWindows) {
+  std::vector<OpMetricsDb> summaries;
+  ContinuousProfiler profiler(Env::Default(), ManualOptions(),
+                              [&summaries](const OpMetricsDb& summary) {
+                                summaries.push_back(summary);
+                                return Status::OK();
+                              });
+  Notification stop;
+  std::unique_ptr<Thread> thread = StartMatMulThread(&stop);
+  TF_ASSERT_OK(profiler.TraceWindow(/*window_ms=*/50));
+  TF_ASSERT_OK(profiler.TraceWindow(/*window_ms=*/50));
+  stop.Notify();
+  thread.reset();
+
+  EXPECT_TRUE(summaries.empty());
+  TF_ASSERT_OK(profiler.Export());
+  ASSERT_EQ(summaries.size(), 1);
+  EXPECT_TRUE(HasOp(summaries[0], "MatMul"));
+  // Nothing was traced since the last export.
+  TF_ASSERT_OK(profiler.Export());
+  EXPECT_EQ(summaries.size(), 1);
+}
+
+TEST(ContinuousProfilerTest, SkipsWindowsDuringProfilerSessions) {
+  ContinuousProfiler profiler(
+      Env::Default(), ManualOptions(),
+      [](const OpMetricsDb& summary) { return Status::OK(); });
+  StatusOr<ProfilerLock> lock = ProfilerLock::Acquire();
+  TF_ASSERT_OK(lock.status());
+  EXPECT_THAT(profiler.TraceWindow(/*window_ms=*/10),
+              StatusIs(error::ALREADY_EXISTS));
+  lock->ReleaseIfActive();
+  TF_EXPECT_OK(profiler.TraceWindow(/*window_ms=*/10));
+}
+
+TEST(ContinuousProfilerTest, FileSink) {
+  const std::string directory =
+      io::JoinPath(::testing::TempDir(), "continuous_profiler");
+  ContinuousProfilerOptions options = ManualOptions();
+  options.windows_per_export = 1;
+  ContinuousProfiler profiler(Env::Default(), options,
+                              MakeFileOpMetricsDbSink(Env::Default(),
+                                                      directory));
+  Notification stop;
+  std::unique_ptr<Thread> thread = StartMatMulThread(&stop);
+  TF_ASSERT_OK(profiler.TraceWindow(/*window_ms=*/50));
+  stop.Notify();
+  thread.reset();
+
+  std::vector<std::string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(directory, &children));
+  ASSERT_EQ(children.size(), 1);
+  OpMetricsDb summary;
+  TF_ASSERT_OK(ReadBinaryProto(
+      Env::Default(), io::JoinPath(directory, children[0]), &summary));
+  EXPECT_TRUE(HasOp(summary, "MatMul"));
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
@@ -0,0 +1,216 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/lib/flight_recorder.h"
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/profiler/backends/cpu/host_tracer_utils.h"
+#include "tensorflow/core/profiler/utils/time_utils.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_utils.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+// The flight recorder that is currently recording. There is at most one, as
+// each flight recorder holds the profiler lock.
+struct ActiveFlightRecorder {
+  mutex mu;
+  FlightRecorder* recorder TF_GUARDED_BY(mu) = nullptr;
+};
+
+ActiveFlightRecorder& GetActiveFlightRecorder() {
+  static ActiveFlightRecorder* active = new ActiveFlightRecorder;
+  return *active;
+}
+
+}  // namespace
+
+/*static*/ Status FlightRecorder::Create(
+    Env* env, const FlightRecorderOptions& options,
+    std::unique_ptr<FlightRecorder>* out) {
+  if (options.buffer_ms <= 0 || options.drain_interval_ms <= 0) {
+    return errors::InvalidArgument(
+        "FlightRecorderOptions.buffer_ms and drain_interval_ms must be "
+        "positive.");
+  }
+  StatusOr<ProfilerLock> lock = ProfilerLock::Acquire();
+  if (!lock.ok()) return lock.status();
+  auto recorder = absl::WrapUnique(
+      new FlightRecorder(env, options, std::move(lock).ValueOrDie()));
+  {
+    mutex_lock l(recorder->mu_);
+    recorder->start_time_ns_ = GetCurrentTimeNanos();
+    recorder->recording_ = TraceMeRecorder::Start(
+        options.trace_level, options.max_events_per_thread);
+    if (!recorder->recording_) {
+      return errors::Internal("Failed to start TraceMeRecorder.");
+    }
+  }
+  recorder->thread_ = absl::WrapUnique(env->StartThread(
+      {}, "tf_flight_recorder", [r = recorder.get()]() { r->Run(); }));
+  {
+    ActiveFlightRecorder& active = GetActiveFlightRecorder();
+    mutex_lock l(active.mu);
+    active.recorder = recorder.get();
+  }
+  *out = std::move(recorder);
+  return Status::OK();
+}
+
+FlightRecorder::FlightRecorder(Env* env, const FlightRecorderOptions& options,
+                               ProfilerLock lock)
+    : env_(env), options_(options), lock_(std::move(lock)) {}
+
+FlightRecorder::~FlightRecorder() {
+  {
+    ActiveFlightRecorder& active = GetActiveFlightRecorder();
+    mutex_lock l(active.mu);
+    if (active.recorder == this) active.recorder = nullptr;
+  }
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    cond_var_.notify_all();
+  }
+  // Joins the drain thread.
+  thread_.reset();
+  mutex_lock l(mu_);
+  if (recording_) {
+    TraceMeRecorder::Stop();
+    recording_ = false;
+  }
+}
+
+Status FlightRecorder::Snapshot(XSpace* space) {
+  mutex_lock l(mu_);
+  if (recording_) DrainLocked();
+  if (chunks_.empty()) return Status::OK();
+  XPlane* plane = FindOrAddMutablePlaneWithName(space, kHostThreadsPlaneName);
+  // Events that started before the oldest chunk may have lost their nested
+  // events to eviction, and are dropped by the conversion.
+  const uint64 start_time_ns = chunks_.front().start_time_ns;
+  for (const Chunk& chunk : chunks_) {
+    // The events are copied, as they stay in the buffer for later snapshots.
+    TraceMeRecorder::Events events = chunk.events;
+    ConvertCompleteEventsToXPlane(start_time_ns, std::move(events), plane);
+  }
+  SortXPlane(plane);
+  return Status::OK();
+}
+
+Status FlightRecorder::Trigger(absl::string_view reason) {
+  if (options_.dump_dir.empty()) {
+    return errors::FailedPrecondition(
+        "FlightRecorderOptions.dump_dir is not set.");
+  }
+  const uint64 now_micros = env_->NowMicros();
+  {
+    mutex_lock l(mu_);
+    if (last_dump_micros_ != 0 &&
+        now_micros - last_dump_micros_ <
+            options_.min_trigger_interval_ms * EnvTime::kMillisToMicros) {
+      return errors::Unavailable("The flight recorder was dumped ",
+                                 (now_micros - last_dump_micros_) /
+                                     EnvTime::kMillisToMicros,
+                                 "ms ago.");
+    }
+    last_dump_micros_ = now_micros;
+  }
+  XSpace space;
+  TF_RETURN_IF_ERROR(Snapshot(&space));
+  space.add_hostnames(port::Hostname());
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(options_.dump_dir));
+  const std::string path = io::JoinPath(
+      options_.dump_dir, absl::StrCat(now_micros, ".", reason, ".xplane.pb"));
+  LOG(INFO) << "Dumping the flight recorder to " << path << ": " << reason;
+  return WriteBinaryProto(env_, path, space);
+}
+
+bool FlightRecorder::RecordStepLatency(int64_t latency_us) {
+  if (options_.step_latency_threshold_us <= 0 ||
+      latency_us <= options_.step_latency_threshold_us) {
+    return false;
+  }
+  Status s = Trigger(absl::StrCat("step_latency_", latency_us, "us"));
+  if (!s.ok()) {
+    VLOG(1) << "Did not dump the flight recorder for a slow step: " << s;
+    return false;
+  }
+  return true;
+}
+
+/*static*/ Status FlightRecorder::SnapshotActive(XSpace* space) {
+  ActiveFlightRecorder& active = GetActiveFlightRecorder();
+  mutex_lock l(active.mu);
+  if (active.recorder == nullptr) {
+    return errors::NotFound("No flight recorder is active.");
+  }
+  return active.recorder->Snapshot(space);
+}
+
+/*static*/ Status FlightRecorder::TriggerActive(absl::string_view reason) {
+  ActiveFlightRecorder& active = GetActiveFlightRecorder();
+  mutex_lock l(active.mu);
+  if (active.recorder == nullptr) {
+    return errors::NotFound("No flight recorder is active.");
+  }
+  return active.recorder->Trigger(reason);
+}
+
+void FlightRecorder::Run() {
+  mutex_lock l(mu_);
+  while (true) {
+    const uint64 deadline_micros =
+        env_->NowMicros() +
+        options_.drain_interval_ms * EnvTime::kMillisToMicros;
+    uint64 now_micros;
+    while (!cancelled_ && (now_micros = env_->NowMicros()) < deadline_micros) {
+      cond_var_.wait_for(
+          l, std::chrono::microseconds(deadline_micros - now_micros));
+    }
+    if (cancelled_) return;
+    DrainLocked();
+  }
+}
+
+void FlightRecorder::DrainLocked() {
+  const uint64 end_time_ns = GetCurrentTimeNanos();
+  chunks_.push_back({start_time_ns_, end_time_ns, TraceMeRecorder::Stop()});
+  // Events recorded between Stop and Start are lost, so the gap is kept short.
+  start_time_ns_ = GetCurrentTimeNanos();
+  recording_ = TraceMeRecorder::Start(options_.trace_level,
+                                      options_.max_events_per_thread);
+  if (!recording_) {
+    LOG(ERROR) << "Failed to restart TraceMeRecorder. The flight recorder "
+                  "stopped recording.";
+  }
+  const uint64 buffer_ns = options_.buffer_ms * EnvTime::kMillisToNanos;
+  while (!chunks_.empty() && chunks_.front().end_time_ns + buffer_ns <
+                                 end_time_ns) {
+    chunks_.pop_front();
+  }
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
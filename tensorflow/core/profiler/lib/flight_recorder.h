@@ -0,0 +1,127 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_PROFILER_LIB_FLIGHT_RECORDER_H_
+#define TENSORFLOW_CORE_PROFILER_LIB_FLIGHT_RECORDER_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/backends/cpu/traceme_recorder.h"
+#include "tensorflow/core/profiler/lib/profiler_lock.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+struct FlightRecorderOptions {
+  // The recorder keeps the host events of the last `buffer_ms`.
+  int64_t buffer_ms = 10 * 1000;
+  // The events are moved out of the TraceMeRecorder every
+  // `drain_interval_ms`, which is also the granularity of the eviction of old
+  // events.
+  int64_t drain_interval_ms = 500;
+  // Only TraceMes with a level <= trace_level are recorded.
+  int trace_level = 1;
+  // Bounds the events recorded by each thread in a drain interval.
+  size_t max_events_per_thread = 1 << 16;
+  // RecordStepLatency triggers a dump for steps slower than this. 0 disables
+  // the latency trigger.
+  int64_t step_latency_threshold_us = 0;
+  // Triggers closer than this to the previous dump are ignored, so that a
+  // burst of slow steps produces one dump.
+  int64_t min_trigger_interval_ms = 60 * 1000;
+  // The directory triggered dumps are written to.
+  std::string dump_dir;
+};
+
+// A flight recorder for host traces. While it is alive, it records TraceMe
+// events into a circular buffer of the last few seconds, which can be dumped
+// as an XSpace when something interesting happens: a slow step, an OOM, or a
+// manual request. It holds the profiler lock, so ProfilerSessions cannot be
+// created while it records; the profiler service pulls the buffer instead.
+class FlightRecorder {
+ public:
+  // Starts recording. Fails if another profiler or flight recorder is active.
+  static Status Create(Env* env, const FlightRecorderOptions& options,
+                       std::unique_ptr<FlightRecorder>* out);
+
+  ~FlightRecorder();
+
+  FlightRecorder(const FlightRecorder&) = delete;
+  FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+  // Stores the buffered events, including the ones recorded since the last
+  // drain, to `space`.
+  Status Snapshot(XSpace* space);
+
+  // Dumps a snapshot to `options.dump_dir`, unless a dump was written less
+  // than `options.min_trigger_interval_ms` ago.
+  Status Trigger(absl::string_view reason);
+
+  // Triggers a dump if `latency_us` exceeds
+  // `options.step_latency_threshold_us`. Returns true if a dump was written.
+  bool RecordStepLatency(int64_t latency_us);
+
+  // The following act on the flight recorder that is currently recording,
+  // and return a NotFound error if there is none. They let the profiler
+  // service and error handlers (e.g. on OOM) reach the recorder without a
+  // reference to it.
+  static Status SnapshotActive(XSpace* space);
+  static Status TriggerActive(absl::string_view reason);
+
+ private:
+  // The events drained from the TraceMeRecorder at `end_time_ns`.
+  struct Chunk {
+    uint64 start_time_ns;
+    uint64 end_time_ns;
+    TraceMeRecorder::Events events;
+  };
+
+  FlightRecorder(Env* env, const FlightRecorderOptions& options,
+                 ProfilerLock lock);
+
+  void Run();
+
+  // Moves the events recorded since the last drain to `chunks_`, restarts
+  // recording, and evicts events older than `options_.buffer_ms`.
+  void DrainLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Env* const env_;
+  const FlightRecorderOptions options_;
+  ProfilerLock lock_;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  bool recording_ TF_GUARDED_BY(mu_) = false;
+  uint64 start_time_ns_ TF_GUARDED_BY(mu_) = 0;
+  std::deque<Chunk> chunks_ TF_GUARDED_BY(mu_);
+  // The time of the last triggered dump, or 0 if there was none.
+  uint64 last_dump_micros_ TF_GUARDED_BY(mu_) = 0;
+
+  std::unique_ptr<Thread> thread_;
+};
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_LIB_FLIGHT_RECORDER_H_
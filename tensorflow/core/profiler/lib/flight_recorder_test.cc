@@ -0,0 +1,122 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/lib/flight_recorder.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/lib/profiler_lock.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_utils.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+
+FlightRecorderOptions TestOptions() {
+  FlightRecorderOptions options;
+  options.drain_interval_ms = 10;
+  return options;
+}
+
+std::set<std::string> GetEventNames(const XSpace& space) {
+  std::set<std::string> names;
+  const XPlane* plane = FindPlaneWithName(space, kHostThreadsPlaneName);
+  if (plane == nullptr) return names;
+  for (const auto& id_and_metadata : plane->event_metadata()) {
+    names.insert(id_and_metadata.second.name());
+  }
+  return names;
+}
+
+TEST(FlightRecorderTest, SnapshotContainsRecentEvents) {
+  std::unique_ptr<FlightRecorder> recorder;
+  TF_ASSERT_OK(FlightRecorder::Create(Env::Default(), TestOptions(),
+                                      &recorder));
+  { TraceMe trace("recent"); }
+  XSpace space;
+  TF_ASSERT_OK(FlightRecorder::SnapshotActive(&space));
+  EXPECT_EQ(GetEventNames(space).count("recent"), 1);
+
+  // Later snapshots still include the event.
+  space.Clear();
+  TF_ASSERT_OK(recorder->Snapshot(&space));
+  EXPECT_EQ(GetEventNames(space).count("recent"), 1);
+}
+
+TEST(FlightRecorderTest, EvictsOldEvents) {
+  FlightRecorderOptions options = TestOptions();
+  options.buffer_ms = 50;
+  std::unique_ptr<FlightRecorder> recorder;
+  TF_ASSERT_OK(FlightRecorder::Create(Env::Default(), options, &recorder));
+  { TraceMe trace("old"); }
+  Env::Default()->SleepForMicroseconds(500 * 1000);
+  { TraceMe trace("new"); }
+  XSpace space;
+  TF_ASSERT_OK(recorder->Snapshot(&space));
+  std::set<std::string> names = GetEventNames(space);
+  EXPECT_EQ(names.count("old"), 0);
+  EXPECT_EQ(names.count("new"), 1);
+}
+
+TEST(FlightRecorderTest, DumpsSlowSteps) {
+  FlightRecorderOptions options = TestOptions();
+  options.dump_dir = io::JoinPath(::testing::TempDir(), "flight_recorder");
+  options.step_latency_threshold_us = 1000;
+  std::unique_ptr<FlightRecorder> recorder;
+  TF_ASSERT_OK(FlightRecorder::Create(Env::Default(), options, &recorder));
+  { TraceMe trace("slow_step"); }
+  EXPECT_FALSE(recorder->RecordStepLatency(10));
+  EXPECT_TRUE(recorder->RecordStepLatency(5000));
+  // Triggers are rate limited.
+  EXPECT_FALSE(recorder->RecordStepLatency(5000));
+
+  std::vector<std::string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(options.dump_dir, &children));
+  ASSERT_EQ(children.size(), 1);
+  XSpace space;
+  TF_ASSERT_OK(ReadBinaryProto(Env::Default(),
+                               io::JoinPath(options.dump_dir, children[0]),
+                               &space));
+  EXPECT_EQ(GetEventNames(space).count("slow_step"), 1);
+}
+
+TEST(FlightRecorderTest, HoldsProfilerLock) {
+  std::unique_ptr<FlightRecorder> recorder;
+  TF_ASSERT_OK(FlightRecorder::Create(Env::Default(), TestOptions(),
+                                      &recorder));
+  EXPECT_THAT(ProfilerLock::Acquire().status(),
+              StatusIs(error::ALREADY_EXISTS));
+  recorder.reset();
+  XSpace space;
+  EXPECT_THAT(FlightRecorder::SnapshotActive(&space),
+              StatusIs(error::NOT_FOUND));
+  TF_EXPECT_OK(ProfilerLock::Acquire().status());
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
@@ -17,6 +17,12 @@ limitations under the License.
 namespace tensorflow {
 namespace profiler {
 
+std::string MemoryDebugAnnotation::PendingTensorName() const {
+  if (pending_op_name == nullptr || pending_output_index < 0) return "";
+  return std::string(pending_op_name) + ":" +
+         std::to_string(pending_output_index);
+}
+
 /*static*/ MemoryDebugAnnotation*
 ScopedMemoryDebugAnnotation::ThreadMemoryDebugAnnotation() {
   static thread_local MemoryDebugAnnotation annotation;
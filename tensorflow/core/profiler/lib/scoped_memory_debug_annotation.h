@@ -31,10 +31,17 @@ struct MemoryDebugAnnotation {
   int64_t pending_step_id = 0;
   const char* pending_region_type = nullptr;
   int32_t pending_data_type = 0;
+  // The index of the output of the pending op that the pending tensor is
+  // allocated for, or -1 if the tensor is not an output, e.g. a temporary.
+  int32_t pending_output_index = -1;
   // A lambda function, when invoked, it will generate the string that describe
   // the shape of the pending tensor. By default, the TensorShape string is an
   // empty string.
   std::function<std::string()> pending_shape_func = []() { return ""; };
+
+  // Returns the name of the pending tensor, e.g. "MatMul:0" for the first
+  // output of an op, or an empty string if the tensor is not an output.
+  std::string PendingTensorName() const;
 };
 
 // Wrapper class of MemoryDebugAnnotation for RAII.
@@ -74,6 +81,7 @@ class ScopedMemoryDebugAnnotation {
     }
     thread_local_annotation->pending_region_type = region_type;
     thread_local_annotation->pending_data_type = data_type;
+    thread_local_annotation->pending_output_index = -1;
     thread_local_annotation->pending_shape_func = std::move(pending_shape_func);
   }
 
@@ -87,9 +95,20 @@ class ScopedMemoryDebugAnnotation {
     thread_local_annotation->pending_step_id = step_id;
     thread_local_annotation->pending_region_type = region_type;
     thread_local_annotation->pending_data_type = data_type;
+    thread_local_annotation->pending_output_index = -1;
     thread_local_annotation->pending_shape_func = std::move(pending_shape_func);
   }
 
+  // Annotates the allocation of the output `output_index` of `op_name`.
+  explicit ScopedMemoryDebugAnnotation(
+      const char* op_name, int64_t step_id, const char* region_type,
+      int32_t data_type, int32_t output_index,
+      std::function<std::string()>&& pending_shape_func)
+      : ScopedMemoryDebugAnnotation(op_name, step_id, region_type, data_type,
+                                    std::move(pending_shape_func)) {
+    ThreadMemoryDebugAnnotation()->pending_output_index = output_index;
+  }
+
   ~ScopedMemoryDebugAnnotation() {
     *ThreadMemoryDebugAnnotation() = last_annotation_;
   }
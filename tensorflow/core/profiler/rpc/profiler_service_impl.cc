@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/profiler/lib/flight_recorder.h"
 #include "tensorflow/core/profiler/lib/profiler_session.h"
 #include "tensorflow/core/profiler/profiler_service.grpc.pb.h"
 #include "tensorflow/core/profiler/profiler_service.pb.h"
@@ -41,18 +42,12 @@ namespace {
 
 const absl::string_view kXPlanePb = "xplane.pb";
 
-// Collects data in XSpace format. The data is saved to a repository
-// unconditionally.
-Status CollectDataToRepository(const ProfileRequest& request,
-                               ProfilerSession* profiler,
-                               ProfileResponse* response) {
-  response->set_empty_trace(true);
-  // Read the profile data into xspace.
-  XSpace xspace;
-  TF_RETURN_IF_ERROR(profiler->CollectData(&xspace));
-  xspace.add_hostnames(request.host_name());
+// Saves `xspace` to the repository of `request` unconditionally.
+Status SaveXSpaceToRepository(const ProfileRequest& request, XSpace* xspace,
+                              ProfileResponse* response) {
+  xspace->add_hostnames(request.host_name());
   VLOG(3) << "Collected XSpace to repository.";
-  response->set_empty_trace(IsEmpty(xspace));
+  response->set_empty_trace(IsEmpty(*xspace));
 
   std::string log_dir_path =
       ProfilerJoinPath(request.repository_root(), request.session_id());
@@ -66,7 +61,19 @@ Status CollectDataToRepository(const ProfileRequest& request,
   std::string out_path = ProfilerJoinPath(log_dir_path, file_name);
   LOG(INFO) << "Collecting XSpace to repository: " << out_path;
 
-  return WriteBinaryProto(Env::Default(), out_path, xspace);
+  return WriteBinaryProto(Env::Default(), out_path, *xspace);
+}
+
+// Collects data in XSpace format. The data is saved to a repository
+// unconditionally.
+Status CollectDataToRepository(const ProfileRequest& request,
+                               ProfilerSession* profiler,
+                               ProfileResponse* response) {
+  response->set_empty_trace(true);
+  // Read the profile data into xspace.
+  XSpace xspace;
+  TF_RETURN_IF_ERROR(profiler->CollectData(&xspace));
+  return SaveXSpaceToRepository(request, &xspace, response);
 }
 
 class ProfilerServiceImpl : public grpc::ProfilerService::Service {
@@ -79,9 +86,25 @@ class ProfilerServiceImpl : public grpc::ProfilerService::Service {
   ::grpc::Status Profile(::grpc::ServerContext* ctx, const ProfileRequest* req,
                          ProfileResponse* response) override {
     VLOG(1) << "Received a profile request: " << req->DebugString();
+    // An active flight recorder holds the profiler lock. Its buffer of recent
+    // events is returned instead of a new trace.
+    XSpace flight_recorder_xspace;
+    Status status = FlightRecorder::SnapshotActive(&flight_recorder_xspace);
+    if (!errors::IsNotFound(status)) {
+      if (status.ok()) {
+        status = SaveXSpaceToRepository(*req, &flight_recorder_xspace,
+                                        response);
+      }
+      if (!status.ok()) {
+        return ::grpc::Status(::grpc::StatusCode::INTERNAL,
+                              status.error_message());
+      }
+      return ::grpc::Status::OK;
+    }
+
     std::unique_ptr<ProfilerSession> profiler =
         ProfilerSession::Create(req->opts());
-    Status status = profiler->Status();
+    status = profiler->Status();
     if (!status.ok()) {
       return ::grpc::Status(::grpc::StatusCode::INTERNAL,
                             status.error_message());
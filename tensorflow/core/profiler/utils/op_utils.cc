@@ -29,6 +29,9 @@ namespace tensorflow {
 namespace profiler {
 namespace {
 
+// The number of bytes transferred from memory by a last level cache miss.
+constexpr uint64 kCacheLineBytes = 64;
+
 // Return capped performance. If time == 0, returns the original perf.
 // Otherwise, returns the minimum of perf and the product of rate_limit
 // and time.
@@ -40,9 +43,10 @@ double GetCappedPerf(double perf, uint64 time, double rate_limit) {
 
 }  // namespace
 
-void HostOpMetricsDbBuilder::EnterOp(absl::string_view name,
-                                     absl::string_view category, bool is_eager,
-                                     uint64 time_ps, uint64 children_time_ps) {
+void HostOpMetricsDbBuilder::EnterOp(
+    absl::string_view name, absl::string_view category, bool is_eager,
+    uint64 time_ps, uint64 children_time_ps,
+    const OpMetrics::HardwareCounters* hardware_counters) {
   uint64 self_time_ps = time_ps - children_time_ps;
   DCHECK_GE(time_ps, self_time_ps);
   OpMetrics* op_metrics = LookupOrInsertNewOpMetrics(/*hlo_module_id=*/0, name);
@@ -53,6 +57,13 @@ void HostOpMetricsDbBuilder::EnterOp(absl::string_view name,
   op_metrics->set_time_ps(op_metrics->time_ps() + time_ps);
   op_metrics->set_self_time_ps(op_metrics->self_time_ps() + self_time_ps);
   db()->set_total_op_time_ps(db()->total_op_time_ps() + self_time_ps);
+  if (hardware_counters != nullptr) {
+    CombineHardwareCounters(*hardware_counters,
+                            op_metrics->mutable_hardware_counters());
+    op_metrics->set_bytes_accessed(
+        op_metrics->bytes_accessed() +
+        hardware_counters->cache_misses() * kCacheLineBytes);
+  }
 }
 
 void HostOpMetricsDbBuilder::EnterHostInfeedEnqueue(
@@ -39,8 +39,13 @@ class HostOpMetricsDbBuilder : public OpMetricsDbBuilder {
   //             the execution time of its children.
   //   children_time_ps = the execution time of the children of this OP in
   //                      picoseconds
+  //   hardware_counters = the hardware performance counters of the OP,
+  //                       including its children, if they were recorded. The
+  //                       last level cache misses are also accounted as the
+  //                       bytes accessed by the OP.
   void EnterOp(absl::string_view name, absl::string_view category,
-               bool is_eager, uint64 time_ps, uint64 children_time_ps);
+               bool is_eager, uint64 time_ps, uint64 children_time_ps,
+               const OpMetrics::HardwareCounters* hardware_counters = nullptr);
 
   // Updates total_host_infeed_enq_duration_ps_ and
   // total_host_infeed_enq_duration_ps_.
@@ -213,6 +213,7 @@ const StatTypeMap& GetStatTypeMap() {
       {"data_type", kDataType},
       {"shape", kTensorShapes},
       {"layout", kTensorLayout},
+      {"tensor_name", kTensorName},
       {"kpi_name", kKpiName},
       {"kpi_value", kKpiValue},
       {"element_id", kElementId},
@@ -280,6 +281,11 @@ const StatTypeMap& GetStatTypeMap() {
       {"theoretical_occupancy_pct", kTheoreticalOccupancyPct},
       {"occupancy_min_grid_size", kOccupancyMinGridSize},
       {"occupancy_suggested_block_size", kOccupancySuggestedBlockSize},
+      // Host hardware performance counters.
+      {"cpu_cycles", kCpuCycles},
+      {"cpu_instructions", kCpuInstructions},
+      {"cache_misses", kCacheMisses},
+      {"branch_misses", kBranchMisses},
   });
   DCHECK_EQ(stat_type_map->size(), kNumStatTypes);
   return *stat_type_map;
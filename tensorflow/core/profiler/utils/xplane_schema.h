@@ -203,6 +203,7 @@ enum StatType {
   kDataType,
   kTensorShapes,
   kTensorLayout,
+  kTensorName,
   kKpiName,
   kKpiValue,
   kElementId,
@@ -272,7 +273,12 @@ enum StatType {
   kTheoreticalOccupancyPct,
   kOccupancyMinGridSize,
   kOccupancySuggestedBlockSize,
-  kLastStatType = kOccupancySuggestedBlockSize,
+  // Host hardware performance counters of an op.
+  kCpuCycles,
+  kCpuInstructions,
+  kCacheMisses,
+  kBranchMisses,
+  kLastStatType = kBranchMisses,
 };
 
 inline std::string GpuPlaneName(int32_t device_ordinal) {
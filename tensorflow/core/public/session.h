@@ -282,6 +282,22 @@ class Session {
         "ReleaseCallable is not supported for this session.");
   }
 
+  /// \brief Creates, in parallel, the executors of the `Run()` calls with the
+  /// feeds, fetches and targets of each of `signatures`.
+  ///
+  /// The first `Run()` with a new combination of feeds, fetches and targets
+  /// prunes, optimizes and partitions the graph for it. Declaring these
+  /// combinations ahead, e.g. right after `Session::Create()`, moves this cost
+  /// out of the first requests. Only the `feed`, `fetch`, `target` and
+  /// `run_options` fields of each `CallableOptions` are used, and the
+  /// `run_options` must match those of the later `Run()` calls.
+  /// NOTE: This API is still experimental and may change.
+  virtual Status PrewarmRunExecutors(
+      const std::vector<CallableOptions>& signatures) {
+    return errors::Unimplemented(
+        "PrewarmRunExecutors is not supported for this session.");
+  }
+
   /// \brief Release global graph-related state in this session.
   ///
   /// After calling `this->Finalize()`, calls to `this->Run()` with previously
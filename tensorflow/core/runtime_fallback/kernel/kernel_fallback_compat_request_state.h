@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/threadpool_interface.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
 #include "tensorflow/core/tfrt/utils/fallback_tensor.h"
 #include "tfrt/host_context/async_value.h"  // from @tf_runtime
@@ -132,7 +133,22 @@ class KernelFallbackCompatRequestState {
 
   const SessionMetadata& session_metadata() const { return session_metadata_; }
 
+  // If set, the execution time of the fallback ops in this request is recorded
+  // in `cost_recorder`.
+  void set_cost_recorder(tfrt_stub::CostRecorder* cost_recorder) {
+    cost_recorder_ = cost_recorder;
+  }
+  tfrt_stub::CostRecorder* cost_recorder() const { return cost_recorder_; }
+
+  // Returns an id that is unique among all the request states created by the
+  // process.
+  int64_t id() const { return id_; }
+
  private:
+  static int64_t NextId();
+
+  const int64_t id_ = NextId();
+
   // Below are resources needed by current tensorflow.
   std::function<void(std::function<void()>)>* runner_ = nullptr;
   ::tfrt::OwnedOrUnownedPtr<ScopedStepContainer> step_container_;
@@ -160,6 +176,8 @@ class KernelFallbackCompatRequestState {
 
   const tensorflow::ProcessFunctionLibraryRuntime* pflr_ = nullptr;
 
+  tfrt_stub::CostRecorder* cost_recorder_ = nullptr;
+
   bool log_device_placement_ = false;
 };
 
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/logging.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/threadpool_interface.h"
@@ -119,7 +120,8 @@ Status SetUpKernelFallbackCompatRequestContext(
     const tensorflow::ProcessFunctionLibraryRuntime* pflr,
     tensorflow::thread::ThreadPoolInterface* user_intra_op_threadpool,
     const absl::optional<SessionMetadata>& model_metadata,
-    std::function<void(std::function<void()>)>* runner) {
+    std::function<void(std::function<void()>)>* runner,
+    tfrt_stub::CostRecorder* cost_recorder) {
   DCHECK(builder);
   DCHECK(device_manager);
   DCHECK(pflr);
@@ -132,10 +134,12 @@ Status SetUpKernelFallbackCompatRequestContext(
       builder->resource_context()->GetOrCreateResource<FallbackResourceArray>(
           kFallbackResourceArray);
 
-  builder->context_data().emplace<KernelFallbackCompatRequestState>(
-      runner ? runner : GetDefaultRunner(), device_manager, builder->id(),
-      runner_table, resource_array, user_intra_op_threadpool, model_metadata,
-      pflr);
+  auto& fallback_request_state =
+      builder->context_data().emplace<KernelFallbackCompatRequestState>(
+          runner ? runner : GetDefaultRunner(), device_manager, builder->id(),
+          runner_table, resource_array, user_intra_op_threadpool,
+          model_metadata, pflr);
+  fallback_request_state.set_cost_recorder(cost_recorder);
 
   return Status::OK();
 }
@@ -227,10 +231,15 @@ void SetUpParams(const OpKernelRunner& runner,
   params.resource_manager = runner.resource_manager();
   params.input_alloc_attrs = &runner.input_alloc_attrs();
   params.output_attr_array = runner.output_alloc_attrs().data();
-  params.step_container = fallback_request_state.step_container();
   // Following two parameters are used to support executing tf.data via
   // fallback.
   params.function_library = runner.function_library_runtime();
+
+  // The thread usually runs many kernels of the same request in a row, so skip
+  // setting up the per-request fields again.
+  if (run_state.request_id == fallback_request_state.id()) return;
+  run_state.request_id = fallback_request_state.id();
+  params.step_container = fallback_request_state.step_container();
   params.runner = fallback_request_state.runner();
   params.collective_executor = fallback_request_state.collective_executor();
   params.rendezvous = fallback_request_state.rendezvous();
@@ -556,6 +565,15 @@ TF_ATTRIBUTE_ALWAYS_INLINE static void KernelFallbackExecuteOpInternal(
     KernelFallbackExecuteCompatAsyncInternal<
         tensorflow::tfrt_stub::FallbackTensor>(
         exec_ctx, &run_state, kernel_runner, op_chain, results);
+  } else if (auto* cost_recorder = fallback_request_state.cost_recorder()) {
+    // Only synchronous kernels are profiled, as the time spent by an async
+    // kernel is mostly waiting and does not occupy the thread.
+    const uint64_t start_us = Env::Default()->NowMicros();
+    KernelFallbackExecuteCompatSyncInternal<
+        tensorflow::tfrt_stub::FallbackTensor>(
+        exec_ctx, &run_state, kernel_runner, op_chain, results);
+    cost_recorder->RecordCost(frame.op_key().GetValue(),
+                              Env::Default()->NowMicros() - start_us);
   } else {
     KernelFallbackExecuteCompatSyncInternal<
         tensorflow::tfrt_stub::FallbackTensor>(
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <algorithm>
+
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -31,11 +33,13 @@ namespace {
 
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
-  SummaryFileWriter(int max_queue, int flush_millis, Env* env)
+  SummaryFileWriter(int max_queue, int flush_millis,
+                    const SummaryFileWriterOptions& options, Env* env)
       : SummaryWriterInterface(),
         is_initialized_(false),
         max_queue_(max_queue),
         flush_millis_(flush_millis),
+        options_(options),
         env_(env) {}
 
   Status Initialize(const string& logdir, const string& filename_suffix) {
@@ -55,13 +59,21 @@ class SummaryFileWriter : public SummaryWriterInterface {
     const string uniquified_filename_suffix = absl::StrCat(
         ".", pid, ".", file_id_counter.fetch_add(1), sep, filename_suffix);
     mutex_lock ml(mu_);
-    events_writer_ =
-        tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(
-        events_writer_->InitWithSuffix(uniquified_filename_suffix),
-        "Could not initialize events writer.");
+    {
+      mutex_lock write_lock(write_mu_);
+      events_writer_ =
+          tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(
+          events_writer_->InitWithSuffix(uniquified_filename_suffix),
+          "Could not initialize events writer.");
+    }
     last_flush_ = env_->NowMicros();
     is_initialized_ = true;
+    if (options_.asynchronous) {
+      writer_thread_.reset(env_->StartThread(
+          ThreadOptions(), "summary_file_writer",
+          [this]() { WriteQueuedEventsInBackground(); }));
+    }
     return Status::OK();
   }
 
@@ -70,11 +82,31 @@ class SummaryFileWriter : public SummaryWriterInterface {
     if (!is_initialized_) {
       return errors::FailedPrecondition("Class was not properly initialized.");
     }
-    return InternalFlush();
+    if (!options_.asynchronous) {
+      return InternalFlush();
+    }
+    const int64_t flush_request = ++num_flush_requests_;
+    queued_cv_.notify_one();
+    while (num_flushes_done_ < flush_request) {
+      flushed_cv_.wait(ml);
+    }
+    Status status = background_status_;
+    background_status_ = Status::OK();
+    return status;
   }
 
   ~SummaryFileWriter() override {
-    (void)Flush();  // Ignore errors.
+    if (writer_thread_ == nullptr) {
+      (void)Flush();  // Ignore errors.
+      return;
+    }
+    {
+      mutex_lock ml(mu_);
+      stop_ = true;
+    }
+    queued_cv_.notify_one();
+    // Joins the thread, which writes the queued events before it exits.
+    writer_thread_.reset();
   }
 
   Status WriteTensor(int64_t global_step, Tensor t, const string& tag,
@@ -151,6 +183,27 @@ class SummaryFileWriter : public SummaryWriterInterface {
 
   Status WriteEvent(std::unique_ptr<Event> event) override {
     mutex_lock ml(mu_);
+    if (options_.asynchronous) {
+      const size_t capacity = std::max(max_queue_, 1);
+      while (queue_.size() >= capacity) {
+        if (options_.full_queue_policy ==
+            SummaryFileWriterOptions::FullQueuePolicy::kDrop) {
+          ++num_dropped_events_;
+          LOG_EVERY_N(WARNING, 1000)
+              << "Dropped " << num_dropped_events_
+              << " summaries because the summary writer fell behind.";
+          return Status::OK();
+        }
+        dequeued_cv_.wait(ml);
+      }
+      queue_.emplace_back(std::move(event));
+      // The background thread waits indefinitely for an event if the queue
+      // is empty, and otherwise until it is full or the flush is due.
+      if (queue_.size() == 1 || queue_.size() >= max_queue_) {
+        queued_cv_.notify_one();
+      }
+      return Status::OK();
+    }
     queue_.emplace_back(std::move(event));
     if (queue_.size() > max_queue_ ||
         env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
@@ -167,25 +220,98 @@ class SummaryFileWriter : public SummaryWriterInterface {
   }
 
   Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
-      events_writer_->WriteEvent(*e);
+    {
+      mutex_lock write_lock(write_mu_);
+      TF_RETURN_IF_ERROR(WriteAndFlush(queue_));
     }
     queue_.clear();
+    last_flush_ = env_->NowMicros();
+    return Status::OK();
+  }
+
+  Status WriteAndFlush(const std::vector<std::unique_ptr<Event>>& events)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(write_mu_) {
+    for (const std::unique_ptr<Event>& e : events) {
+      events_writer_->WriteEvent(*e);
+    }
     TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
                                     "Could not flush events file.");
-    last_flush_ = env_->NowMicros();
     return Status::OK();
   }
 
+  // The loop of the background thread of an asynchronous writer. It takes all
+  // the queued events when the queue is full, the flush is due, Flush() is
+  // called or the writer is destroyed, and serializes, writes and flushes
+  // them without holding `mu_`.
+  void WriteQueuedEventsInBackground() {
+    while (true) {
+      std::vector<std::unique_ptr<Event>> events;
+      int64_t flush_request;
+      bool flush_requested;
+      bool stop;
+      {
+        mutex_lock ml(mu_);
+        while (!stop_ && num_flush_requests_ == num_flushes_done_ &&
+               queue_.size() < max_queue_) {
+          if (queue_.empty()) {
+            queued_cv_.wait(ml);
+            continue;
+          }
+          const uint64 now = env_->NowMicros();
+          const uint64 deadline = last_flush_ + 1000 * flush_millis_;
+          if (now >= deadline) break;
+          WaitForMilliseconds(&ml, &queued_cv_, (deadline - now + 999) / 1000);
+        }
+        events.swap(queue_);
+        flush_request = num_flush_requests_;
+        flush_requested = flush_request > num_flushes_done_;
+        stop = stop_;
+      }
+      dequeued_cv_.notify_all();
+      Status status;
+      if (!events.empty() || flush_requested) {
+        mutex_lock write_lock(write_mu_);
+        status = WriteAndFlush(events);
+      }
+      {
+        mutex_lock ml(mu_);
+        last_flush_ = env_->NowMicros();
+        background_status_.Update(status);
+        num_flushes_done_ = flush_request;
+      }
+      flushed_cv_.notify_all();
+      if (stop) return;
+    }
+  }
+
   bool is_initialized_;
   const int max_queue_;
   const int flush_millis_;
-  uint64 last_flush_;
+  const SummaryFileWriterOptions options_;
+  uint64 last_flush_ TF_GUARDED_BY(mu_);
   Env* env_;
   mutex mu_;
   std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
+  // Serializes the writes to `events_writer_`, which an asynchronous writer
+  // makes on its background thread without holding `mu_`.
+  mutex write_mu_ TF_ACQUIRED_AFTER(mu_);
   // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(write_mu_);
+
+  // The state of an asynchronous writer.
+  std::unique_ptr<Thread> writer_thread_;
+  // Signals the background thread that there are events or flush requests.
+  condition_variable queued_cv_;
+  // Signals WriteEvent() that the background thread took the queued events.
+  condition_variable dequeued_cv_;
+  // Signals Flush() that the background thread flushed.
+  condition_variable flushed_cv_;
+  bool stop_ TF_GUARDED_BY(mu_) = false;
+  int64_t num_flush_requests_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_flushes_done_ TF_GUARDED_BY(mu_) = 0;
+  // The first write error of the background thread since the last Flush().
+  Status background_status_ TF_GUARDED_BY(mu_);
+  int64_t num_dropped_events_ TF_GUARDED_BY(mu_) = 0;
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
 };
@@ -196,7 +322,18 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& logdir,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result) {
-  SummaryFileWriter* w = new SummaryFileWriter(max_queue, flush_millis, env);
+  return CreateSummaryFileWriter(max_queue, flush_millis, logdir,
+                                 filename_suffix, env,
+                                 SummaryFileWriterOptions(), result);
+}
+
+Status CreateSummaryFileWriter(int max_queue, int flush_millis,
+                               const string& logdir,
+                               const string& filename_suffix, Env* env,
+                               const SummaryFileWriterOptions& options,
+                               SummaryWriterInterface** result) {
+  SummaryFileWriter* w =
+      new SummaryFileWriter(max_queue, flush_millis, options, env);
   const Status s = w->Initialize(logdir, filename_suffix);
   if (!s.ok()) {
     w->Unref();
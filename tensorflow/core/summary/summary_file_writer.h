@@ -38,6 +38,34 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result);
 
+/// \brief Options of the summary writer of CreateSummaryFileWriter.
+struct SummaryFileWriterOptions {
+  /// What an asynchronous writer does with a summary when max_queue summaries
+  /// wait for the background thread.
+  enum class FullQueuePolicy {
+    /// Waits until the background thread takes the queued summaries.
+    kBlock,
+    /// Drops the summary.
+    kDrop,
+  };
+
+  /// If true, writing a summary only enqueues its event. A background thread
+  /// serializes and writes the queued events, and flushes the file, when
+  /// max_queue events are queued or flush_millis milliseconds passed since the
+  /// last flush. Flush() waits for the events written before it. Write errors
+  /// are returned by the next Flush().
+  bool asynchronous = false;
+  FullQueuePolicy full_queue_policy = FullQueuePolicy::kBlock;
+};
+
+/// \brief Creates SummaryWriterInterface which writes to a file, as above,
+/// with `options`.
+Status CreateSummaryFileWriter(int max_queue, int flush_millis,
+                               const string& logdir,
+                               const string& filename_suffix, Env* env,
+                               const SummaryFileWriterOptions& options,
+                               SummaryWriterInterface** result);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_SUMMARY_SUMMARY_FILE_WRITER_H_
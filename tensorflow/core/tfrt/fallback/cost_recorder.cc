@@ -0,0 +1,46 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/tfrt/fallback/cost_recorder.h"
+
+namespace tensorflow {
+namespace tfrt_stub {
+
+void CostRecorder::RecordCost(int64_t op_key, uint64_t execution_time_us) {
+  tensorflow::mutex_lock l(mu_);
+  auto& cost = cost_map_[op_key];
+  cost.first += execution_time_us;
+  ++cost.second;
+}
+
+uint64_t CostRecorder::GetCost(int64_t op_key, uint64_t default_value) const {
+  tensorflow::tf_shared_lock l(mu_);
+  const auto iter = cost_map_.find(op_key);
+  if (iter == cost_map_.end()) return default_value;
+  return iter->second.first / iter->second.second;
+}
+
+bool CostRecorder::HasCost(int64_t op_key) const {
+  tensorflow::tf_shared_lock l(mu_);
+  return cost_map_.contains(op_key);
+}
+
+size_t CostRecorder::size() const {
+  tensorflow::tf_shared_lock l(mu_);
+  return cost_map_.size();
+}
+
+}  // namespace tfrt_stub
+}  // namespace tensorflow
@@ -0,0 +1,65 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_TFRT_FALLBACK_COST_RECORDER_H_
+#define TENSORFLOW_CORE_TFRT_FALLBACK_COST_RECORDER_H_
+
+#include <cstdint>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace tfrt_stub {
+
+// Records the measured execution time of fallback ops, keyed by their op keys
+// (i.e. the `op_key` attribute assigned by the compiler to
+// tfrt_fallback_async.executeop). The recorded costs can be fed back to the
+// compiler so that stream analysis is driven by real costs instead of the
+// static heuristic in CostAnalysis.
+//
+// This class is thread-safe.
+class CostRecorder {
+ public:
+  // Records `execution_time_us` for the op with `op_key`. The cost of an op is
+  // the average of all the recorded execution times.
+  void RecordCost(int64_t op_key, uint64_t execution_time_us)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the average execution time in microseconds of the op with
+  // `op_key`, or `default_value` if no cost is recorded for it.
+  uint64_t GetCost(int64_t op_key, uint64_t default_value = 0) const
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns whether any cost is recorded for the op with `op_key`.
+  bool HasCost(int64_t op_key) const TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of ops that have recorded costs.
+  size_t size() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  mutable tensorflow::mutex mu_;
+  // Maps op keys to the sum of the recorded execution times and the number of
+  // records.
+  absl::flat_hash_map<int64_t, std::pair<uint64_t, uint64_t>> cost_map_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tfrt_stub
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_TFRT_FALLBACK_COST_RECORDER_H_
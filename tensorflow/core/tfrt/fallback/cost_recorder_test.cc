@@ -0,0 +1,48 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/tfrt/fallback/cost_recorder.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorflow {
+namespace tfrt_stub {
+namespace {
+
+TEST(CostRecorderTest, RecordCostTest) {
+  CostRecorder recorder;
+
+  recorder.RecordCost(/*op_key=*/1, /*execution_time_us=*/1000);
+  recorder.RecordCost(/*op_key=*/1, /*execution_time_us=*/3000);
+  recorder.RecordCost(/*op_key=*/2, /*execution_time_us=*/10);
+
+  EXPECT_EQ(recorder.size(), 2);
+  EXPECT_EQ(recorder.GetCost(1), 2000);
+  EXPECT_EQ(recorder.GetCost(2), 10);
+}
+
+TEST(CostRecorderTest, MissingCostTest) {
+  CostRecorder recorder;
+  recorder.RecordCost(/*op_key=*/1, /*execution_time_us=*/0);
+
+  EXPECT_TRUE(recorder.HasCost(1));
+  EXPECT_EQ(recorder.GetCost(1, /*default_value=*/5), 0);
+  EXPECT_FALSE(recorder.HasCost(2));
+  EXPECT_EQ(recorder.GetCost(2, /*default_value=*/5), 5);
+}
+
+}  // namespace
+}  // namespace tfrt_stub
+}  // namespace tensorflow
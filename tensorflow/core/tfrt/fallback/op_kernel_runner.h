@@ -106,6 +106,10 @@ struct OpKernelRunState {
   gtl::InlinedVector<tensorflow::Tensor, 4> input_tf_tensors;
   gtl::InlinedVector<tensorflow::TensorValue, 4> input_tf_tensor_values;
   OpKernelContext::Params params;
+  // Identifies the request whose per-request fields, like the step container
+  // and the rendezvous, are set in `params`, so that they are only set up
+  // again when a kernel of another request runs. -1 if none.
+  int64_t request_id = -1;
 
   OpKernelRunState() = default;
   OpKernelRunState(
@@ -50,6 +50,15 @@ struct GraphExecutionOptions {
   tensorflow::SessionMetadata model_metadata;
 
   tensorflow::TfrtCompileOptions compile_options;
+
+  // If true, the op costs of the first request to each client graph are
+  // measured, and the client graph is then recompiled in the background using
+  // the measured costs instead of the static cost analysis. This lets the
+  // compiler merge cheap ops into sequential chains and only parallelize ops
+  // whose measured cost justifies it. Note that the measured costs are in
+  // microseconds, so `compile_options.cost_threshold` should be set
+  // accordingly.
+  bool enable_online_cost_analysis = false;
 };
 
 // Per-request options for graph execution.
@@ -81,7 +81,8 @@ StatusOr<std::unique_ptr<RequestInfo>> SetUpRequestContext(
     const SessionMetadata& model_metadata, tfrt::HostContext* host,
     tensorflow::tfrt_stub::WorkQueueInterface* work_queue,
     tfrt::ResourceContext* resource_context,
-    const tensorflow::tfrt_stub::FallbackState& fallback_state) {
+    const tensorflow::tfrt_stub::FallbackState& fallback_state,
+    CostRecorder* cost_recorder) {
   DCHECK(host);
   DCHECK(work_queue);
   // Create request context and prepare deadline tracker.
@@ -114,7 +115,7 @@ StatusOr<std::unique_ptr<RequestInfo>> SetUpRequestContext(
   TF_RETURN_IF_ERROR(tensorflow::tfd::SetUpKernelFallbackCompatRequestContext(
       &request_context_builder, &fallback_state.device_manager(),
       &fallback_state.process_function_library_runtime(), intra_op_threadpool,
-      model_metadata, &request_info->runner));
+      model_metadata, &request_info->runner, cost_recorder));
 
   TF_RETURN_IF_ERROR(
       tensorflow::SetUpTfJitRtRequestContext(&request_context_builder));
@@ -142,7 +143,8 @@ tensorflow::Status GraphExecutionRunOnFunction(
     std::vector<tensorflow::Tensor>* outputs,
     tfrt::ResourceContext* resource_context, const Runtime& runtime,
     const FallbackState& fallback_state,
-    tfrt::RequestDeadlineTracker& req_deadline_tracker) {
+    tfrt::RequestDeadlineTracker& req_deadline_tracker,
+    CostRecorder* cost_recorder) {
   auto* host = runtime.core_runtime()->GetHostContext();
 
   TF_ASSIGN_OR_RETURN(
@@ -150,7 +152,7 @@ tensorflow::Status GraphExecutionRunOnFunction(
       SetUpRequestContext(run_options, options.model_metadata, host,
                           run_options.work_queue ? run_options.work_queue
                                                  : runtime.work_queue(),
-                          resource_context, fallback_state));
+                          resource_context, fallback_state, cost_recorder));
 
   tensorflow::profiler::TraceMeProducer traceme(
       // To TraceMeConsumers in RunHandlerThreadPool::WorkerLoop.
@@ -373,12 +375,19 @@ tensorflow::Status GraphExecutor::Run(
   std::sort(sorted_target_node_names.begin(), sorted_target_node_names.end());
 
   // Load the client graph.
-  TF_ASSIGN_OR_RETURN(const LoadedClientGraph& loaded_client_graph,
+  TF_ASSIGN_OR_RETURN(std::shared_ptr<LoadedClientGraph> loaded_client_graph,
                       GetOrCreateLoadedClientGraph(
                           sorted_input_names, sorted_input_dtypes,
                           sorted_output_names, sorted_target_node_names));
 
-  const auto* func = loaded_client_graph.bef_file->GetFunction(
+  // With online cost analysis, only the first request to the graph is profiled.
+  CostRecorder* cost_recorder = nullptr;
+  if (loaded_client_graph->cost_recorder != nullptr &&
+      !loaded_client_graph->is_profiled.exchange(true)) {
+    cost_recorder = loaded_client_graph->cost_recorder.get();
+  }
+
+  const auto* func = loaded_client_graph->bef_file->GetFunction(
       tensorflow::kImportModelDefaultGraphFuncName);
   DCHECK(func);
 
@@ -392,10 +401,14 @@ tensorflow::Status GraphExecutor::Run(
 
   std::vector<tensorflow::Tensor> flat_outputs;
   TF_RETURN_IF_ERROR(GraphExecutionRunOnFunction(
-      options_, run_options, loaded_client_graph.name, *func, flat_inputs,
+      options_, run_options, loaded_client_graph->name, *func, flat_inputs,
       /*captures=*/{}, &flat_outputs,
-      loaded_client_graph.resource_context.get(), runtime(), fallback_state_,
-      req_deadline_tracker_));
+      loaded_client_graph->resource_context.get(), runtime(), fallback_state_,
+      req_deadline_tracker_, cost_recorder));
+
+  if (cost_recorder != nullptr) {
+    ScheduleRecompilation(std::move(loaded_client_graph));
+  }
 
   // Create the outputs from the actual function results, which are sorted
   // according to the output tensor names.
@@ -414,7 +427,8 @@ tensorflow::Status GraphExecutor::Extend(const GraphDef& graph) {
 }
 
 StatusOr<std::unique_ptr<GraphExecutor::LoadedClientGraph>>
-GraphExecutor::LoadClientGraph(const GraphExecutor::ClientGraph& client_graph) {
+GraphExecutor::LoadClientGraph(const GraphExecutor::ClientGraph& client_graph,
+                               const CostRecorder* cost_recorder) {
   auto loaded_client_graph = std::make_unique<LoadedClientGraph>();
   loaded_client_graph->name = client_graph.name;
   loaded_client_graph->resource_context = CreateResourceContext(
@@ -427,7 +441,7 @@ GraphExecutor::LoadClientGraph(const GraphExecutor::ClientGraph& client_graph) {
 
   // Step 2: Compile the MLIR module from TF dialect to TFRT dialect (in BEF).
   TF_ASSIGN_OR_RETURN(loaded_client_graph->bef,
-                      CompileMlirModuleToBef(module.get()));
+                      CompileMlirModuleToBef(module.get(), cost_recorder));
 
   // Step 3: Initialize runtime states using special BEF functions.
   TF_ASSIGN_OR_RETURN(
@@ -436,9 +450,39 @@ GraphExecutor::LoadClientGraph(const GraphExecutor::ClientGraph& client_graph) {
   TF_RETURN_IF_ERROR(InitBef(loaded_client_graph->bef_file.get(),
                              loaded_client_graph->resource_context.get()));
 
+  // Profile the graph if it is not yet compiled with the measured costs.
+  if (options_.enable_online_cost_analysis && cost_recorder == nullptr) {
+    loaded_client_graph->client_graph = client_graph;
+    loaded_client_graph->cost_recorder = std::make_unique<CostRecorder>();
+  }
+
   return loaded_client_graph;
 }
 
+void GraphExecutor::ScheduleRecompilation(
+    std::shared_ptr<LoadedClientGraph> loaded_client_graph) {
+  DCHECK(recompile_thread_pool_);
+  recompile_thread_pool_->Schedule(
+      [this, old_graph = std::move(loaded_client_graph)]() {
+        auto new_graph = LoadClientGraph(old_graph->client_graph,
+                                         old_graph->cost_recorder.get());
+        if (!new_graph.ok()) {
+          // The graph compiled with the static costs stays in use.
+          LOG(WARNING) << "Failed to recompile client graph "
+                       << old_graph->name
+                       << " with measured costs: " << new_graph.status();
+          return;
+        }
+        VLOG(1) << "Recompiled client graph " << old_graph->name << " with "
+                << old_graph->cost_recorder->size() << " measured op costs.";
+
+        // Requests already running on the old graph keep it alive until they
+        // are done.
+        tensorflow::mutex_lock l(loaded_client_graphs_mu_);
+        loaded_client_graphs_[old_graph->name] = std::move(new_graph).value();
+      });
+}
+
 tensorflow::StatusOr<mlir::OwningOpRef<mlir::ModuleOp>>
 GraphExecutor::ImportClientGraphToMlirModule(
     const GraphExecutor::ClientGraph& client_graph,
@@ -462,10 +506,12 @@ GraphExecutor::ImportClientGraphToMlirModule(
 }
 
 StatusOr<tfrt::BefBuffer> GraphExecutor::CompileMlirModuleToBef(
-    mlir::ModuleOp module) const {
+    mlir::ModuleOp module, const CostRecorder* cost_recorder) const {
   tfrt::BefBuffer bef;
+  auto compile_options = options_.compile_options;
+  compile_options.cost_recorder = cost_recorder;
   TF_RETURN_IF_ERROR(
-      tensorflow::ConvertTfMlirToBef(options_.compile_options, module, &bef));
+      tensorflow::ConvertTfMlirToBef(compile_options, module, &bef));
   return bef;
 }
 
@@ -495,7 +541,7 @@ tensorflow::Status GraphExecutor::InitBef(
   return tensorflow::Status::OK();
 }
 
-StatusOr<std::reference_wrapper<const GraphExecutor::LoadedClientGraph>>
+StatusOr<std::shared_ptr<GraphExecutor::LoadedClientGraph>>
 GraphExecutor::GetOrCreateLoadedClientGraph(
     absl::Span<const std::string> input_tensor_names,
     absl::Span<const tensorflow::DataType> input_tensor_dtypes,
@@ -514,7 +560,7 @@ GraphExecutor::GetOrCreateLoadedClientGraph(
 
   // Cache hit; return immediately.
   const auto iter = loaded_client_graphs_.find(joined_name);
-  if (iter != loaded_client_graphs_.end()) return {*iter->second};
+  if (iter != loaded_client_graphs_.end()) return iter->second;
 
   // Cache miss; populate a `ClientGraph` and load it.
   tensorflow::GraphImportConfig::InputArrays input_nodes;
@@ -536,9 +582,10 @@ GraphExecutor::GetOrCreateLoadedClientGraph(
   TF_ASSIGN_OR_RETURN(auto loaded_client_graph, LoadClientGraph(client_graph));
 
   // Store the new loaded client graph in cache and return.
-  const auto* loaded_client_graph_ptr = loaded_client_graph.get();
-  loaded_client_graphs_[joined_name] = std::move(loaded_client_graph);
-  return {*loaded_client_graph_ptr};
+  std::shared_ptr<LoadedClientGraph> shared_loaded_client_graph =
+      std::move(loaded_client_graph);
+  loaded_client_graphs_[joined_name] = shared_loaded_client_graph;
+  return shared_loaded_client_graph;
 }
 
 }  // namespace tfrt_stub
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_GRAPH_EXECUTOR_GRAPH_EXECUTOR_H_
 #define TENSORFLOW_CORE_TFRT_GRAPH_EXECUTOR_GRAPH_EXECUTOR_H_
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <string>
@@ -22,7 +23,9 @@ limitations under the License.
 
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "tensorflow/core/common_runtime/graph_execution_state.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
 #include "tensorflow/core/tfrt/graph_executor/graph_execution_options.h"
 #include "tensorflow/core/tfrt/runtime/work_queue_interface.h"
@@ -52,7 +55,8 @@ StatusOr<std::unique_ptr<RequestInfo>> SetUpRequestContext(
     const SessionMetadata& model_metadata, tfrt::HostContext* host,
     tensorflow::tfrt_stub::WorkQueueInterface* work_queue,
     tfrt::ResourceContext* resource_context,
-    const FallbackState& fallback_state);
+    const FallbackState& fallback_state,
+    CostRecorder* cost_recorder = nullptr);
 
 // Runs on a function given input/output and other info.
 tensorflow::Status GraphExecutionRunOnFunction(
@@ -64,7 +68,8 @@ tensorflow::Status GraphExecutionRunOnFunction(
     std::vector<tensorflow::Tensor>* outputs,
     tfrt::ResourceContext* resource_context, const Runtime& runtime,
     const FallbackState& fallback_state,
-    tfrt::RequestDeadlineTracker& req_deadline_tracker);
+    tfrt::RequestDeadlineTracker& req_deadline_tracker,
+    CostRecorder* cost_recorder = nullptr);
 
 // Creates a ResourceContext and populate it with per model resource from
 // Runtime. If `tpu_target` is set to kTpurt, also call a special
@@ -97,7 +102,13 @@ class GraphExecutor {
         tpu_model_resource_(tpu_model_resource),
         graph_execution_state_(std::move(graph_execution_state)),
         req_deadline_tracker_(
-            options_.runtime->core_runtime()->GetHostContext()) {}
+            options_.runtime->core_runtime()->GetHostContext()) {
+    if (options_.enable_online_cost_analysis) {
+      recompile_thread_pool_ = std::make_unique<tensorflow::thread::ThreadPool>(
+          tensorflow::Env::Default(), "tfrt_graph_executor_recompile",
+          /*num_threads=*/1);
+    }
+  }
 
   // Runs on the graph according to given input/output.
   tensorflow::Status Run(
@@ -116,14 +127,6 @@ class GraphExecutor {
   }
 
  private:
-  // The loading result of a `ClientGraph`.
-  struct LoadedClientGraph {
-    std::string name;
-    tfrt::BefBuffer bef;
-    tfrt::RCReference<tfrt::BEFFile> bef_file;
-    std::unique_ptr<tfrt::ResourceContext> resource_context;
-  };
-
   // A subgraph constructed by specifying input/output tensors.
   struct ClientGraph {
     // A unique name by joining all the input/output/target names.
@@ -138,19 +141,44 @@ class GraphExecutor {
     std::vector<std::string> target_nodes;
   };
 
-  // A set of methods to load a client graph.
+  // The loading result of a `ClientGraph`.
+  struct LoadedClientGraph {
+    std::string name;
+    tfrt::BefBuffer bef;
+    tfrt::RCReference<tfrt::BEFFile> bef_file;
+    std::unique_ptr<tfrt::ResourceContext> resource_context;
+
+    // Below are only set if online cost analysis is enabled and this graph is
+    // compiled with the static cost analysis. `client_graph` is kept for the
+    // recompilation, and the costs of the first request are recorded in
+    // `cost_recorder`.
+    ClientGraph client_graph;
+    std::unique_ptr<CostRecorder> cost_recorder;
+    std::atomic<bool> is_profiled{false};
+  };
+
+  // A set of methods to load a client graph. If `cost_recorder` is not null,
+  // the measured costs in it are used by the compiler.
   StatusOr<std::unique_ptr<GraphExecutor::LoadedClientGraph>> LoadClientGraph(
-      const GraphExecutor::ClientGraph& client_graph);
+      const GraphExecutor::ClientGraph& client_graph,
+      const CostRecorder* cost_recorder = nullptr);
   tensorflow::StatusOr<mlir::OwningOpRef<mlir::ModuleOp>>
   ImportClientGraphToMlirModule(const GraphExecutor::ClientGraph& client_graph,
                                 mlir::MLIRContext* context) const;
-  StatusOr<tfrt::BefBuffer> CompileMlirModuleToBef(mlir::ModuleOp module) const;
+  StatusOr<tfrt::BefBuffer> CompileMlirModuleToBef(
+      mlir::ModuleOp module, const CostRecorder* cost_recorder) const;
   tensorflow::Status InitBef(tfrt::BEFFile* bef_file,
                              tfrt::ResourceContext* resource_context);
 
+  // Recompiles `loaded_client_graph` in the background with the costs recorded
+  // in it, and replaces it in the cache once done.
+  void ScheduleRecompilation(
+      std::shared_ptr<LoadedClientGraph> loaded_client_graph);
+
   // Returns a `LoadedClientGraph` given input/output tensor info. If there is
-  // no existing one yet, creates one first.
-  StatusOr<std::reference_wrapper<const GraphExecutor::LoadedClientGraph>>
+  // no existing one yet, creates one first. The returned graph stays valid
+  // even if it is replaced in the cache while it is being run.
+  StatusOr<std::shared_ptr<GraphExecutor::LoadedClientGraph>>
   GetOrCreateLoadedClientGraph(
       absl::Span<const std::string> input_tensor_names,
       absl::Span<const tensorflow::DataType> input_tensor_dtypes,
@@ -173,12 +201,16 @@ class GraphExecutor {
   tfrt::RequestDeadlineTracker req_deadline_tracker_;
 
   tensorflow::mutex loaded_client_graphs_mu_;
-  // Caches `LoadedClientGraph` by the joined name.
-  // For pointer stability of values in `absl::flat_hash_map<>`, additional
-  // `std::unique_ptr<>` is necessary. (See https://abseil.io/tips/136.)
+  // Caches `LoadedClientGraph` by the joined name. The values are shared with
+  // the running requests, so that a graph can be replaced after being
+  // recompiled.
   absl::flat_hash_map<std::string /*joined_name*/,
-                      std::unique_ptr<LoadedClientGraph>>
+                      std::shared_ptr<LoadedClientGraph>>
       loaded_client_graphs_ TF_GUARDED_BY(loaded_client_graphs_mu_);
+
+  // Runs the recompilations for online cost analysis. It is declared last so
+  // that pending recompilations finish before the other members are destroyed.
+  std::unique_ptr<tensorflow::thread::ThreadPool> recompile_thread_pool_;
 };
 
 }  // namespace tfrt_stub
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/util/debug_events_writer.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
@@ -116,6 +119,63 @@ Status SingleDebugEventFileWriter::Close() {
 
 const string SingleDebugEventFileWriter::FileName() { return file_path_; }
 
+DebugEventCircularBuffer::DebugEventCircularBuffer(int64_t capacity)
+    : capacity_(capacity), next_sequence_number_(0) {}
+
+void DebugEventCircularBuffer::Add(std::unique_ptr<DebugEvent> debug_event) {
+  Entry entry;
+  entry.debug_event = std::move(debug_event);
+  AddEntry(std::move(entry));
+}
+
+void DebugEventCircularBuffer::AddSerialized(string debug_event_str) {
+  Entry entry;
+  entry.debug_event_str = std::move(debug_event_str);
+  AddEntry(std::move(entry));
+}
+
+void DebugEventCircularBuffer::AddEntry(Entry entry) {
+  // Each thread adds to the shard it is assigned on its first event.
+  static std::atomic<int> next_shard(0);
+  thread_local const int shard_index =
+      next_shard.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+  Shard& shard = shards_[shard_index];
+  mutex_lock l(shard.mu);
+  // Taken under the shard's lock, so that the entries of a shard are in
+  // order. Each shard keeps up to `capacity_` entries, which includes all of
+  // its entries among the `capacity_` most recent ones.
+  entry.sequence_number =
+      next_sequence_number_.fetch_add(1, std::memory_order_relaxed);
+  shard.entries.push_back(std::move(entry));
+  if (shard.entries.size() > capacity_) {
+    shard.entries.pop_front();
+  }
+}
+
+void DebugEventCircularBuffer::WriteTo(SingleDebugEventFileWriter* writer) {
+  mutex_lock write_lock(write_mu_);
+  std::vector<Entry> entries;
+  for (Shard& shard : shards_) {
+    mutex_lock l(shard.mu);
+    std::move(shard.entries.begin(), shard.entries.end(),
+              std::back_inserter(entries));
+    shard.entries.clear();
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) {
+              return a.sequence_number < b.sequence_number;
+            });
+  const size_t first =
+      entries.size() > capacity_ ? entries.size() - capacity_ : 0;
+  for (size_t i = first; i < entries.size(); ++i) {
+    Entry& entry = entries[i];
+    if (entry.debug_event != nullptr) {
+      entry.debug_event->AppendToString(&entry.debug_event_str);
+    }
+    writer->WriteSerializedDebugEvent(entry.debug_event_str);
+  }
+}
+
 mutex DebugEventsWriter::factory_mu_(LINKER_INITIALIZED);
 
 DebugEventsWriter::~DebugEventsWriter() { Close().IgnoreError(); }
@@ -232,17 +292,10 @@ Status DebugEventsWriter::WriteExecution(Execution* execution) {
     return SerializeAndWriteDebugEvent(&debug_event, EXECUTION);
   } else {
     // Circular buffer behavior.
-    DebugEvent debug_event;
-    MaybeSetDebugEventTimestamp(&debug_event, env_);
-    debug_event.set_allocated_execution(execution);
-    string serialized;
-    debug_event.SerializeToString(&serialized);
-
-    mutex_lock l(execution_buffer_mu_);
-    execution_buffer_.emplace_back(std::move(serialized));
-    if (execution_buffer_.size() > circular_buffer_size_) {
-      execution_buffer_.pop_front();
-    }
+    std::unique_ptr<DebugEvent> debug_event(new DebugEvent);
+    MaybeSetDebugEventTimestamp(debug_event.get(), env_);
+    debug_event->set_allocated_execution(execution);
+    execution_buffer_.Add(std::move(debug_event));
     return Status::OK();
   }
 }
@@ -257,17 +310,10 @@ Status DebugEventsWriter::WriteGraphExecutionTrace(
     return SerializeAndWriteDebugEvent(&debug_event, GRAPH_EXECUTION_TRACES);
   } else {
     // Circular buffer behavior.
-    DebugEvent debug_event;
-    MaybeSetDebugEventTimestamp(&debug_event, env_);
-    debug_event.set_allocated_graph_execution_trace(graph_execution_trace);
-    string serialized;
-    debug_event.SerializeToString(&serialized);
-
-    mutex_lock l(graph_execution_trace_buffer_mu_);
-    graph_execution_trace_buffer_.emplace_back(std::move(serialized));
-    if (graph_execution_trace_buffer_.size() > circular_buffer_size_) {
-      graph_execution_trace_buffer_.pop_front();
-    }
+    std::unique_ptr<DebugEvent> debug_event(new DebugEvent);
+    MaybeSetDebugEventTimestamp(debug_event.get(), env_);
+    debug_event->set_allocated_graph_execution_trace(graph_execution_trace);
+    graph_execution_trace_buffer_.Add(std::move(debug_event));
     return Status::OK();
   }
 }
@@ -302,18 +348,15 @@ void DebugEventsWriter::WriteSerializedNonExecutionDebugEvent(
 void DebugEventsWriter::WriteSerializedExecutionDebugEvent(
     const string& debug_event_str, DebugEventFileType type) {
   const std::unique_ptr<SingleDebugEventFileWriter>* writer = nullptr;
-  std::deque<string>* buffer = nullptr;
-  mutex* mu = nullptr;
+  DebugEventCircularBuffer* buffer = nullptr;
   switch (type) {
     case EXECUTION:
       writer = &execution_writer_;
       buffer = &execution_buffer_;
-      mu = &execution_buffer_mu_;
       break;
     case GRAPH_EXECUTION_TRACES:
       writer = &graph_execution_traces_writer_;
       buffer = &graph_execution_trace_buffer_;
-      mu = &graph_execution_trace_buffer_mu_;
       break;
     default:
       return;
@@ -324,11 +367,7 @@ void DebugEventsWriter::WriteSerializedExecutionDebugEvent(
     (*writer)->WriteSerializedDebugEvent(debug_event_str);
   } else {
     // Circular buffer behavior.
-    mutex_lock l(*mu);
-    buffer->push_back(debug_event_str);
-    if (buffer->size() > circular_buffer_size_) {
-      buffer->pop_front();
-    }
+    buffer->AddSerialized(debug_event_str);
   }
 }
 
@@ -369,12 +408,7 @@ Status DebugEventsWriter::FlushExecutionFiles() {
   if (execution_writer_ != nullptr) {
     if (circular_buffer_size_ > 0) {
       // Write out all the content in the circular buffers.
-      mutex_lock l(execution_buffer_mu_);
-      while (!execution_buffer_.empty()) {
-        execution_writer_->WriteSerializedDebugEvent(execution_buffer_.front());
-        // SerializeAndWriteDebugEvent(&execution_buffer_.front());
-        execution_buffer_.pop_front();
-      }
+      execution_buffer_.WriteTo(execution_writer_.get());
     }
     TF_RETURN_IF_ERROR(execution_writer_->Flush());
   }
@@ -382,12 +416,8 @@ Status DebugEventsWriter::FlushExecutionFiles() {
   if (graph_execution_traces_writer_ != nullptr) {
     if (circular_buffer_size_ > 0) {
       // Write out all the content in the circular buffers.
-      mutex_lock l(graph_execution_trace_buffer_mu_);
-      while (!graph_execution_trace_buffer_.empty()) {
-        graph_execution_traces_writer_->WriteSerializedDebugEvent(
-            graph_execution_trace_buffer_.front());
-        graph_execution_trace_buffer_.pop_front();
-      }
+      graph_execution_trace_buffer_.WriteTo(
+          graph_execution_traces_writer_.get());
     }
     TF_RETURN_IF_ERROR(graph_execution_traces_writer_->Flush());
   }
@@ -481,10 +511,8 @@ DebugEventsWriter::DebugEventsWriter(const string& dump_root,
       is_initialized_(false),
       initialization_mu_(),
       circular_buffer_size_(circular_buffer_size),
-      execution_buffer_(),
-      execution_buffer_mu_(),
-      graph_execution_trace_buffer_(),
-      graph_execution_trace_buffer_mu_(),
+      execution_buffer_(circular_buffer_size),
+      graph_execution_trace_buffer_(circular_buffer_size),
       device_name_to_id_(),
       device_mu_() {}
 
@@ -16,7 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_UTIL_DEBUG_EVENTS_WRITER_H_
 #define TENSORFLOW_CORE_UTIL_DEBUG_EVENTS_WRITER_H_
 
+#include <atomic>
 #include <deque>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -67,6 +69,49 @@ class SingleDebugEventFileWriter {
   mutex writer_mu_;
 };
 
+// Helper class for DebugEventsWriter.
+// A circular buffer of the most recent debug events of one file type. It is
+// sharded by writing thread, so that threads that write concurrently, e.g. the
+// debug ops of a model with always-on numeric health checks, rarely contend.
+// Events added as protos are only serialized when they are written out, so the
+// events that the buffer drops are never serialized.
+class DebugEventCircularBuffer {
+ public:
+  explicit DebugEventCircularBuffer(int64_t capacity);
+
+  void Add(std::unique_ptr<DebugEvent> debug_event);
+  void AddSerialized(string debug_event_str);
+
+  // Writes the most recent `capacity` buffered events to `writer` in the
+  // order they were added and clears the buffer. Adding events does not wait
+  // for the write.
+  void WriteTo(SingleDebugEventFileWriter* writer);
+
+ private:
+  static constexpr int kNumShards = 16;
+
+  struct Entry {
+    int64_t sequence_number;
+    std::unique_ptr<DebugEvent> debug_event;
+    string debug_event_str;
+  };
+
+  struct Shard {
+    mutex mu;
+    std::deque<Entry> entries TF_GUARDED_BY(mu);
+  };
+
+  void AddEntry(Entry entry);
+
+  const int64_t capacity_;
+  std::atomic<int64_t> next_sequence_number_;
+  Shard shards_[kNumShards];
+  // Keeps concurrent WriteTo() calls from interleaving their events.
+  mutex write_mu_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DebugEventCircularBuffer);
+};
+
 // The DebugEvents writer class.
 class DebugEventsWriter {
  public:
@@ -244,11 +289,8 @@ class DebugEventsWriter {
   mutex initialization_mu_;
 
   const int64_t circular_buffer_size_;
-  std::deque<string> execution_buffer_ TF_GUARDED_BY(execution_buffer_mu_);
-  mutex execution_buffer_mu_;
-  std::deque<string> graph_execution_trace_buffer_
-      TF_GUARDED_BY(graph_execution_trace_buffer_mu_);
-  mutex graph_execution_trace_buffer_mu_;
+  DebugEventCircularBuffer execution_buffer_;
+  DebugEventCircularBuffer graph_execution_trace_buffer_;
 
   absl::flat_hash_map<string, int> device_name_to_id_ TF_GUARDED_BY(device_mu_);
   mutex device_mu_;
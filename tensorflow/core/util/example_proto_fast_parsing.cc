@@ -109,6 +109,43 @@ uint8 PeekTag(protobuf::io::CodedInputStream* stream) {
   return *static_cast<const uint8*>(ptr);
 }
 
+// Returns the number of varints in the `size` bytes at `data`, that is the
+// number of bytes without the continuation bit. Counts 8 bytes at a time.
+size_t CountVarints(const uint8* data, size_t size) {
+  constexpr uint64 kContinuationBits = 0x8080808080808080ULL;
+  constexpr uint64 kLowBytes = 0x0101010101010101ULL;
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + sizeof(uint64) <= size; i += sizeof(uint64)) {
+    uint64 word;
+    memcpy(&word, data + i, sizeof(word));
+    // One bit per terminating byte, moved to the low bit of the byte, then
+    // summed into the top byte by the multiplication.
+    const uint64 ends = (~word & kContinuationBits) >> 7;
+    count += (ends * kLowBytes) >> 56;
+  }
+  for (; i < size; ++i) {
+    count += data[i] < 0x80;
+  }
+  return count;
+}
+
+// Decodes the varint at `*data`, which must end before `end`, and advances
+// `*data` past it. Returns false if the varint is malformed.
+inline bool DecodeVarint64(const uint8** data, const uint8* end,
+                           uint64* value) {
+  uint64 result = 0;
+  for (int shift = 0; shift < 64 && *data < end; shift += 7) {
+    const uint8 byte = *(*data)++;
+    result |= static_cast<uint64>(byte & 0x7f) << shift;
+    if (byte < 0x80) {
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
 constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
@@ -299,15 +336,39 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64_t>(n));
+        const void* packed_data;
+        int available;
+        if (packed_length == 0) {
+          // Nothing to read.
+        } else if (!stream.GetDirectBufferPointer(&packed_data, &available) ||
+                   static_cast<uint32>(available) < packed_length) {
+          return false;
+        } else {
+          // Count the values first, so that the output is resized once and
+          // the values are decoded straight from the buffer.
+          const uint8* begin = static_cast<const uint8*>(packed_data);
+          const uint8* const end = begin + packed_length;
+          if (end[-1] >= 0x80) return false;  // Truncated varint.
+          const size_t num_values = CountVarints(begin, packed_length);
+          const size_t initial_size = int64_list->size();
+          int64_list->resize(initial_size + num_values);
+          // May be smaller than requested for a LimitedArraySlice.
+          const size_t size = int64_list->size();
+          int64_t* values = int64_list->data();
+          if (num_values == packed_length) {
+            // All values are single bytes.
+            for (size_t i = initial_size; i < size; ++i) {
+              values[i] = begin[i - initial_size];
+            }
+          } else {
+            for (size_t i = initial_size; begin < end; ++i) {
+              protobuf_uint64 n;  // There is no API for int64
+              if (!DecodeVarint64(&begin, end, &n)) return false;
+              if (i < size) values[i] = static_cast<int64_t>(n);
+            }
+          }
+          if (!stream.Skip(packed_length)) return false;
         }
-
-        stream.PopLimit(packed_limit);
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
@@ -1208,17 +1269,36 @@ Status FastParseExample(const Config& config,
                             std::min<size_t>(max_minibatches, result));
   }();
 
+  // Split the examples so that minibatches have about the same number of
+  // bytes rather than of examples, which balances the work of the threads
+  // when example sizes are skewed.
+  std::vector<size_t> minibatch_starts(num_minibatches + 1, serialized.size());
+  if (num_minibatches > 0) {
+    size_t total_bytes = 0;
+    for (const tstring& example : serialized) {
+      total_bytes += example.size() + 1;
+    }
+    minibatch_starts[0] = 0;
+    size_t minibatch = 1;
+    size_t bytes = 0;
+    for (size_t i = 0; i < serialized.size(); ++i) {
+      // Example `i` starts the minibatches whose share of the bytes begins
+      // before it.
+      while (minibatch < num_minibatches &&
+             bytes * num_minibatches >= total_bytes * minibatch) {
+        minibatch_starts[minibatch++] = i;
+      }
+      bytes += serialized[i].size() + 1;
+    }
+  }
   auto first_example_of_minibatch = [&](size_t minibatch) -> size_t {
-    return (serialized.size() * minibatch) / num_minibatches;
+    return minibatch_starts[minibatch];
   };
 
-  // TODO(lew): A big performance low-hanging fruit here is to improve
-  //   num_minibatches calculation to take into account actual amount of work
-  //   needed, as the size in bytes is not perfect. Linear combination of
-  //   size in bytes and average number of features per example is promising.
-  //   Even better: measure time instead of estimating, but this is too costly
-  //   in small batches.
-  //   Maybe accept outside parameter #num_minibatches?
+  // TODO(lew): The size in bytes is not a perfect measure of the work needed.
+  //   Linear combination of size in bytes and average number of features per
+  //   example is promising. Even better: measure time instead of estimating,
+  //   but this is too costly in small batches.
 
   // Do minibatches in parallel.
   std::vector<std::vector<SparseBuffer>> sparse_buffers(num_minibatches);
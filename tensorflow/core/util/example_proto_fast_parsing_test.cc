@@ -13,17 +13,20 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <limits>
 #include <utility>
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/util/example_proto_fast_parsing_test.pb.h"
 
 namespace tensorflow {
@@ -170,6 +173,26 @@ TEST(FastParse, Packed) {
       "\x0a\x0d\x0a\x0b\x0a\x03\x61\x67\x65\x12\x04\x1a\x02\x08\x0d");
 }
 
+TEST(FastParse, PackedMultiByteInt64) {
+  Example example;
+  auto* values = (*example.mutable_features()->mutable_feature())["age"]
+                     .mutable_int64_list();
+  for (int64_t value : std::vector<int64_t>{
+           0, 1, 127, 128, 300, -1, int64_t{1} << 40,
+           std::numeric_limits<int64_t>::max(),
+           std::numeric_limits<int64_t>::min(), 5}) {
+    values->add_value(value);
+  }
+  TestCorrectness(Serialize(example));
+}
+
+TEST(FastParse, TruncatedPackedInt64) {
+  Example example;
+  EXPECT_FALSE(TestFastParse(
+      "\x0a\x0e\x0a\x0c\x0a\x03\x61\x67\x65\x12\x05\x1a\x03\x0a\x01\x80",
+      &example));
+}
+
 TEST(FastParse, ValueBeforeKeyInMap) {
   TestCorrectness("\x0a\x12\x0a\x10\x12\x09\x0a\x07\x0a\x05value\x0a\x03key");
 }
@@ -427,6 +450,43 @@ TEST(TestFastParseExample, Empty) {
   EXPECT_TRUE(status.ok()) << status;
 }
 
+TEST(TestFastParseExample, SkewedExampleSizes) {
+  // The first example is much larger than the others, so splitting the batch
+  // by bytes gives it a minibatch of its own.
+  constexpr int kNumExamples = 64;
+  constexpr int kNumLargeValues = 1000;
+  std::vector<tstring> serialized;
+  for (int i = 0; i < kNumExamples; ++i) {
+    Example example;
+    auto* values =
+        (*example.mutable_features()->mutable_feature())[kSparseInt64Key]
+            .mutable_int64_list();
+    const int num_values = i == 0 ? kNumLargeValues : 1;
+    for (int j = 0; j < num_values; ++j) values->add_value(i + j);
+    serialized.push_back(Serialize(example));
+  }
+
+  FastParseExampleConfig config;
+  AddSparseFeature(kSparseInt64Key, DT_INT64, &config);
+  thread::ThreadPool thread_pool(Env::Default(), "test", 4);
+  Result result;
+  TF_ASSERT_OK(
+      FastParseExample(config, serialized, {}, &thread_pool, &result));
+
+  const auto values = result.sparse_values[0].flat<int64_t>();
+  const auto indices = result.sparse_indices[0].matrix<int64_t>();
+  ASSERT_EQ(values.size(), kNumLargeValues + kNumExamples - 1);
+  for (int j = 0; j < kNumLargeValues; ++j) {
+    EXPECT_EQ(values(j), j);
+    EXPECT_EQ(indices(j, 0), 0);
+    EXPECT_EQ(indices(j, 1), j);
+  }
+  for (int i = 1; i < kNumExamples; ++i) {
+    EXPECT_EQ(values(kNumLargeValues + i - 1), i);
+    EXPECT_EQ(indices(kNumLargeValues + i - 1, 0), i);
+  }
+}
+
 }  // namespace
 }  // namespace example
 }  // namespace tensorflow
@@ -20,7 +20,9 @@ limitations under the License.
 #include <cstring>
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -44,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/platform/cord.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap.h"
@@ -63,6 +66,12 @@ const int kTensorBundleVersion = 1;
 // Size of our input buffer for streaming reads
 static const int kBufferSize = 1024 * 1024;
 
+// Memcpy-able tensors larger than this are read as several ranges of this size
+// issued concurrently, which hides the per-request latency of remote
+// filesystems such as GCS.
+static const int64_t kParallelReadChunkSize = 16 * 1024 * 1024;
+static const int kMaxParallelReads = 8;
+
 // Key to the special BundleHeaderProto entry.  Do not change this, as clients
 // can make the assumption that the header is always the first entry in the
 // bundle.
@@ -70,6 +79,72 @@ const char* const kHeaderEntryKey = "";
 
 namespace {
 
+// Tensor storage aliasing a memory-mapped range of a bundle data file.
+class MemmappedTensorBuffer : public TensorBuffer {
+ public:
+  MemmappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                        uint64 offset, size_t num_bytes)
+      : TensorBuffer(const_cast<char*>(
+                         static_cast<const char*>(region->data()) + offset)),
+        region_(std::move(region)),
+        size_(num_bytes) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("bundle_memmap");
+  }
+  // The mapping is read-only, so the buffer must never be forwarded to an op
+  // output and written in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
+// Reads file[offset, offset+size) into "destination".
+Status ReadRange(RandomAccessFile* file, uint64 offset, size_t size,
+                 char* destination) {
+  StringPiece sp;
+  TF_RETURN_IF_ERROR(file->Read(offset, size, &sp, destination));
+  if (sp.data() != destination) {
+    memmove(destination, sp.data(), size);
+  }
+  return Status::OK();
+}
+
+// Like ReadRange, but splits the range into kParallelReadChunkSize pieces that
+// are read concurrently.
+Status ParallelReadRange(Env* env, RandomAccessFile* file, uint64 offset,
+                         size_t size, char* destination) {
+  const int64_t num_chunks =
+      (size + kParallelReadChunkSize - 1) / kParallelReadChunkSize;
+  if (num_chunks <= 1) {
+    return ReadRange(file, offset, size, destination);
+  }
+  std::vector<Status> statuses(num_chunks);
+  {
+    thread::ThreadPool pool(
+        env, "bundle_read",
+        static_cast<int>(std::min<int64_t>(num_chunks, kMaxParallelReads)));
+    for (int64_t i = 0; i < num_chunks; ++i) {
+      pool.Schedule([&, i]() {
+        const int64_t begin = i * kParallelReadChunkSize;
+        const int64_t chunk_size =
+            std::min<int64_t>(kParallelReadChunkSize, size - begin);
+        statuses[i] = ReadRange(file, offset + begin, chunk_size,
+                                destination + begin);
+      });
+    }
+  }
+  for (const Status& s : statuses) {
+    TF_RETURN_IF_ERROR(s);
+  }
+  return Status::OK();
+}
+
 // Reads "num_elements" string elements from file[offset, offset+size) into the
 // length-N "destination".  Discards the original content of "destination".
 //
@@ -451,6 +526,12 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   entry->set_dtype(val.dtype());
   val.shape().AsProto(entry->mutable_shape());
   entry->set_shard_id(0);
+  if (options_.large_tensor_alignment > 1 &&
+      DataTypeCanUseMemcpy(val.dtype()) &&
+      val.TotalBytes() >= BundleReader::kMemmapMinBytes) {
+    status_ = PadAlignment(out_.get(), options_.large_tensor_alignment, &size_);
+    if (!status_.ok()) return status_;
+  }
   entry->set_offset(size_);
 
   // Updates the data file.
@@ -743,6 +824,8 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
 
 // Interface for reading a tensor bundle.
 
+constexpr size_t BundleReader::kMemmapMinBytes;
+
 BundleReader::BundleReader(Env* env, StringPiece prefix)
     : env_(env),
       prefix_(prefix),
@@ -750,7 +833,12 @@ BundleReader::BundleReader(Env* env, StringPiece prefix)
       table_(nullptr),
       index_cache_(nullptr),
       iter_(nullptr),
+      memmap_large_tensors_(false),
       need_to_swap_bytes_(false) {
+  status_ = ReadBoolFromEnvVar("TF_BUNDLE_MEMMAP_LARGE_TENSORS", false,
+                               &memmap_large_tensors_);
+  if (!status_.ok()) return;
+
   const string filename = MetaFilename(prefix_);
   uint64 file_size;
   status_ = env_->GetFileSize(filename, &file_size);
@@ -818,6 +906,7 @@ BundleReader::~BundleReader() {
     delete temp.second;
   }
   data_.clear();
+  data_regions_.clear();
   tensor_slices_.clear();
 }
 
@@ -871,6 +960,16 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     }
   }
 
+  if (memmap_large_tensors_ && DataTypeCanUseMemcpy(entry.dtype()) &&
+      entry.size() >= kMemmapMinBytes && !need_to_swap_bytes_) {
+    bool mapped = false;
+    TF_RETURN_IF_ERROR(GetMemmappedValue(entry, val, &mapped));
+    if (mapped) {
+      if (ret != val) delete ret;
+      return Status::OK();
+    }
+  }
+
   // Open the data file if it has not been opened.
   io::InputBuffer* buffered_file = data_[entry.shard_id()];
   if (buffered_file == nullptr) {
@@ -890,12 +989,9 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     char* backing_buffer = const_cast<char*>((ret->tensor_data().data()));
     size_t unused_bytes_read;
     if (entry.size() > kBufferSize) {
-      StringPiece sp;
-      TF_RETURN_IF_ERROR(buffered_file->file()->Read(
-          entry.offset(), entry.size(), &sp, backing_buffer));
-      if (sp.data() != backing_buffer) {
-        memmove(backing_buffer, sp.data(), entry.size());
-      }
+      TF_RETURN_IF_ERROR(ParallelReadRange(env_, buffered_file->file(),
+                                           entry.offset(), entry.size(),
+                                           backing_buffer));
     } else {
       TF_RETURN_IF_ERROR(buffered_file->ReadNBytes(entry.size(), backing_buffer,
                                                    &unused_bytes_read));
@@ -938,6 +1034,42 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   return Status::OK();
 }
 
+Status BundleReader::GetMemmappedValue(const BundleEntryProto& entry,
+                                       Tensor* val, bool* mapped) {
+  *mapped = false;
+  auto it = data_regions_.find(entry.shard_id());
+  if (it == data_regions_.end()) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    const Status s = env_->NewReadOnlyMemoryRegionFromFile(
+        DataFilename(prefix_, entry.shard_id(), num_shards_), &region);
+    if (!s.ok()) {
+      VLOG(1) << "Cannot memory-map shard " << entry.shard_id() << " of "
+              << prefix_ << ", reading it instead: " << s;
+    }
+    it = data_regions_
+             .emplace(entry.shard_id(),
+                      std::shared_ptr<ReadOnlyMemoryRegion>(std::move(region)))
+             .first;
+  }
+  const std::shared_ptr<ReadOnlyMemoryRegion>& region = it->second;
+  if (region == nullptr) return Status::OK();
+  if (static_cast<uint64>(entry.offset() + entry.size()) > region->length()) {
+    return errors::DataLoss("TensorBundle at ", prefix_, " shard ",
+                            entry.shard_id(), " is truncated: entry ends at ",
+                            entry.offset() + entry.size(),
+                            ", file length is ", region->length());
+  }
+  const char* data = static_cast<const char*>(region->data()) + entry.offset();
+  if (reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return Status::OK();
+  }
+  auto* buf = new MemmappedTensorBuffer(region, entry.offset(), entry.size());
+  *val = Tensor(entry.dtype(), TensorShape(entry.shape()), buf);
+  buf->Unref();
+  *mapped = true;
+  return Status::OK();
+}
+
 Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -62,6 +62,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
 
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -116,6 +117,11 @@ class BundleWriter {
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
     int data_alignment{1};
+    // Alignment, in bytes, for the data of memcpy-able tensors of at least
+    // BundleReader::kMemmapMinBytes, so that readers can memory-map them (see
+    // BundleReader::set_memmap_large_tensors).  Only pads before such
+    // tensors, so small tensors stay densely packed.  Must be >= 1.
+    int large_tensor_alignment{1};
   };
   BundleWriter(Env* env, StringPiece prefix,
                const Options& options = Options());
@@ -277,6 +283,25 @@ class BundleReader {
   // REQUIRES: status().ok() && Valid()
   StringPiece value() const { return iter_->value(); }
 
+  // If enabled, memcpy-able tensors of at least "kMemmapMinBytes" are returned
+  // backed by read-only memory-mapped regions of the data files instead of
+  // being copied into "val", so their pages are loaded on demand and shared
+  // between processes reading the same bundle.  The stored checksums of such
+  // tensors are not validated, since that would fault in every page.  Falls
+  // back to regular reads when the filesystem cannot map the file, the bundle
+  // needs byte swapping, or the data is not suitably aligned; bundles written
+  // with a "data_alignment" of at least EIGEN_MAX_ALIGN_BYTES always are.
+  //
+  // The returned tensors never alias op outputs, so they cannot be modified in
+  // place; they stay valid after the reader is destroyed.
+  //
+  // Defaults to the value of the TF_BUNDLE_MEMMAP_LARGE_TENSORS environment
+  // variable.
+  void set_memmap_large_tensors(bool enabled) {
+    memmap_large_tensors_ = enabled;
+  }
+  static constexpr size_t kMemmapMinBytes = 1 << 20;
+
   string DebugString();
 
  private:
@@ -299,6 +324,11 @@ class BundleReader {
                        const TensorSlice& slice_spec,
                        Tensor* val) TF_MUST_USE_RESULT;
 
+  // Points "val" at the memory-mapped bytes of "entry".  Sets "*mapped" to
+  // false, leaving "val" untouched, if the entry cannot be mapped.
+  Status GetMemmappedValue(const BundleEntryProto& entry, Tensor* val,
+                           bool* mapped) TF_MUST_USE_RESULT;
+
   Env* env_;  // Not owned.
   const string prefix_;
 
@@ -309,6 +339,11 @@ class BundleReader {
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
+  // Memory-mapped data files, shared with the tensors that alias them.  Holds
+  // nullptr for shards that could not be mapped.
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>>
+      data_regions_;
+  bool memmap_large_tensors_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
@@ -545,6 +545,60 @@ TEST(TensorBundleTest, Basic) {
   TestBasic<bfloat16>();
 }
 
+TEST(TensorBundleTest, LargeTensorParallelRead) {
+  // Large enough to be read as several concurrent ranges, with a partial
+  // last range.
+  const int64_t num_elements = 10 * 1024 * 1024 + 3;
+  Tensor expected(DT_INT32, TensorShape({num_elements}));
+  auto flat = expected.flat<int32>();
+  for (int64_t i = 0; i < num_elements; ++i) {
+    flat(i) = static_cast<int32>(i);
+  }
+  {
+    BundleWriter writer(Env::Default(), Prefix("large"));
+    TF_EXPECT_OK(writer.Add("small", Constant(1.0f, TensorShape({2}))));
+    TF_EXPECT_OK(writer.Add("large", expected));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("large"));
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("large", &val));
+  test::ExpectTensorEqual<int32>(expected, val);
+}
+
+TEST(TensorBundleTest, MemmapLargeTensors) {
+  const int64_t num_elements = BundleReader::kMemmapMinBytes / sizeof(float);
+  Tensor expected(DT_FLOAT, TensorShape({num_elements}));
+  auto flat = expected.flat<float>();
+  for (int64_t i = 0; i < num_elements; ++i) {
+    flat(i) = static_cast<float>(i);
+  }
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(Env::Default(), Prefix("memmap"), opts);
+    TF_EXPECT_OK(writer.Add("large", expected));
+    TF_EXPECT_OK(writer.Add("small", Constant(1.0f, TensorShape({2}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor large;
+  Tensor small;
+  {
+    BundleReader reader(Env::Default(), Prefix("memmap"));
+    TF_ASSERT_OK(reader.status());
+    reader.set_memmap_large_tensors(true);
+    TF_ASSERT_OK(reader.Lookup("large", &large));
+    TF_ASSERT_OK(reader.Lookup("small", &small));
+  }
+  // The large tensor aliases the mapping, which outlives the reader, and can
+  // not be forwarded; the small one is a regular copy.
+  test::ExpectTensorEqual<float>(expected, large);
+  EXPECT_FALSE(large.RefCountIsOne());
+  test::ExpectTensorEqual<float>(Constant(1.0f, TensorShape({2})), small);
+  EXPECT_TRUE(small.RefCountIsOne());
+}
+
 TEST(TensorBundleTest, Endianness) {
   TestEndianness<float>();
   TestEndianness<double>();
@@ -1108,6 +1162,12 @@ class TensorBundleAlignmentTest : public ::testing::Test {
     TF_ASSERT_OK(reader->GetBundleEntryProto(key, &full_tensor_entry));
     EXPECT_EQ(0, full_tensor_entry.offset() % alignment);
   }
+
+  int64_t Offset(BundleReader* reader, const string& key) {
+    BundleEntryProto entry;
+    TF_EXPECT_OK(reader->GetBundleEntryProto(key, &entry));
+    return entry.offset();
+  }
 };
 
 TEST_F(TensorBundleAlignmentTest, AlignmentTest) {
@@ -1153,6 +1213,33 @@ TEST_F(TensorBundleAlignmentTest, AlignmentTest) {
   }
 }
 
+TEST_F(TensorBundleAlignmentTest, LargeTensorAlignment) {
+  const int64_t num_elements = BundleReader::kMemmapMinBytes / sizeof(float);
+  Tensor large(DT_FLOAT, TensorShape({num_elements}));
+  large.flat<float>().setConstant(2.0f);
+  {
+    BundleWriter::Options opts;
+    opts.large_tensor_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(Env::Default(), Prefix("large_alignment"), opts);
+    TF_EXPECT_OK(writer.Add("a_small", Constant_2x3<float>(1)));
+    TF_EXPECT_OK(writer.Add("b_large", large));
+    TF_EXPECT_OK(writer.Add("c_small", Constant_2x3<float>(3)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("large_alignment"));
+  TF_ASSERT_OK(reader.status());
+  ExpectAlignment<float>(&reader, "b_large", EIGEN_MAX_ALIGN_BYTES);
+  // Only the large tensor is padded; the small ones stay densely packed.
+  EXPECT_EQ(0, Offset(&reader, "a_small"));
+  EXPECT_EQ(Offset(&reader, "b_large") +
+                static_cast<int64_t>(BundleReader::kMemmapMinBytes),
+            Offset(&reader, "c_small"));
+
+  reader.set_memmap_large_tensors(true);
+  Expect<float>(&reader, "b_large", large);
+  Expect<float>(&reader, "c_small", Constant_2x3<float>(3));
+}
+
 static void BM_BundleAlignment(::testing::benchmark::State& state) {
   {
     const int alignment = state.range(0);
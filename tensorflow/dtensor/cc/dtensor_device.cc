@@ -65,6 +65,7 @@ limitations under the License.
 #include "tensorflow/dtensor/cc/dstatus.h"
 #include "tensorflow/dtensor/cc/dtensor_device_util.h"
 #include "tensorflow/dtensor/cc/dtensor_graph_to_mlir_pass.h"
+#include "tensorflow/dtensor/cc/dtensor_utils.h"
 #include "tensorflow/dtensor/cc/small_constant_optimization.h"
 #include "tensorflow/dtensor/cc/tensor_layout.h"
 #include "tensorflow/dtensor/cc/tpu_system_interface.h"
@@ -356,6 +357,16 @@ class DTensorDevice {
                            const ExecutionFunctions** execution_functions,
                            TF_Status* status);
 
+  // Executes an elementwise operation whose inputs are all fully replicated on
+  // the same local mesh directly on each device of the mesh, without layout
+  // propagation or SPMD expansion. The output is fully replicated as well. Sets
+  // `is_op_handled` to false if the operation does not qualify.
+  void MaybeExecuteReplicatedElementwise(
+      TFE_Context* context, const std::vector<TensorWithLayout*>& inputs,
+      const DTensorOperation& doperation, const TFE_OpAttrs* attributes,
+      int* num_outputs, TFE_TensorHandle** outputs, bool* is_op_handled,
+      TF_Status* status);
+
   // Implements `Execute` for operations which aren't special-cased in
   void ExecuteRegularOperation(TFE_Context* context,
                                const std::vector<TensorWithLayout*>& inputs,
@@ -1473,10 +1484,79 @@ void DTensorDevice::LowerToSPMDFunction(
   *execution_functions = AddCachedFunction(cache_key, std::move(functions));
 }
 
+void DTensorDevice::MaybeExecuteReplicatedElementwise(
+    TFE_Context* context, const std::vector<TensorWithLayout*>& inputs,
+    const DTensorOperation& doperation, const TFE_OpAttrs* attributes,
+    int* num_outputs, TFE_TensorHandle** outputs, bool* is_op_handled,
+    TF_Status* status) {
+  *is_op_handled = false;
+  // A default layout may ask for a different output layout than the
+  // replicated one.
+  if (DisableReplicatedElementwiseFastPath() || doperation.is_func() ||
+      !IsElementwiseOp(doperation.name) || inputs.empty() ||
+      *num_outputs < 1 || default_layout_.has_value()) {
+    return;
+  }
+  const Mesh& mesh = inputs[0]->layout().mesh();
+  if (mesh.IsEmpty() || is_remote_mesh(mesh) || mesh.is_tpu_mesh()) return;
+
+  // The inputs must have the same shape, except for scalars, so that the
+  // output shape is known without shape inference.
+  std::vector<int64_t> output_shape;
+  std::vector<parallel_device::ParallelTensor*> parallel_inputs;
+  parallel_inputs.reserve(inputs.size());
+  for (const TensorWithLayout* input : inputs) {
+    if (input->tensor_type() != TensorType::kDense ||
+        !input->layout().IsFullyReplicated() ||
+        input->layout().mesh() != mesh) {
+      return;
+    }
+    const std::vector<int64_t> shape = input->local_shape();
+    if (!shape.empty()) {
+      if (output_shape.empty()) {
+        output_shape = shape;
+      } else if (shape != output_shape) {
+        return;
+      }
+    }
+    parallel_inputs.push_back(input->tensor());
+  }
+  *is_op_handled = true;
+
+  const MeshWithParallelDevice& parallel_device_mesh = inputs[0]->mesh();
+  parallel_device_mesh.parallel_device().StartExecute(
+      context, parallel_inputs, doperation.name, attributes,
+      /*expected_max_outputs=*/1, *cancellation_manager_);
+  auto result = parallel_device_mesh.parallel_device().Join(
+      {PartialTensorShape(output_shape)}, status);
+  if (TF_GetCode(status) != TF_OK) return;
+  if (result->size() != 1) {
+    RETURN_STATUS(status, TF_INTERNAL,
+                  absl::StrCat("Expected one output from ", doperation.name,
+                               " but got ", result->size())
+                      .c_str());
+  }
+  ASSIGN_OR_RETURN_C_STATUS(
+      auto output,
+      TensorWithLayout::Wrap(
+          std::move((*result)[0]), parallel_device_mesh,
+          Layout::ReplicatedOnMesh(mesh, output_shape.size())),
+      status);
+  RecordInShapeLayoutCache(*output);
+  *num_outputs = 1;
+  outputs[0] = MakeLayoutTensorHandle(context, std::move(output), status);
+}
+
 void DTensorDevice::ExecuteRegularOperation(
     TFE_Context* context, const std::vector<TensorWithLayout*>& inputs,
     const DTensorOperation& doperation, const TFE_OpAttrs* attributes,
     int* num_outputs, TFE_TensorHandle** outputs, TF_Status* status) {
+  bool is_op_handled = false;
+  MaybeExecuteReplicatedElementwise(context, inputs, doperation, attributes,
+                                    num_outputs, outputs, &is_op_handled,
+                                    status);
+  if (is_op_handled) return;
+
   const ExecutionFunctions* execution_functions = nullptr;
 
   LowerToSPMDFunction(context, inputs, doperation, attributes, *num_outputs,
@@ -1802,8 +1882,9 @@ void DTensorDevice::Execute(const TFE_Op* original_op, int* num_outputs,
     // allows certains op to work, e.g.: For reduce, the reduction_indices
     // from BroadcastGradientArgs would be lifted as a constant that allows
     // proper computation.
-    if (!dtensor_operation.is_func() && !t->const_value().has_value() &&
-        t->layout().IsFullyReplicated()) {
+    if (!t->const_value().has_value() && t->layout().IsFullyReplicated() &&
+        ShouldFoldInputArgument(dtensor_operation.is_func(),
+                                dtensor_operation.name, /*input_index=*/j)) {
       absl::optional<NodeDef> maybe_const =
           ExtractSmallTensorValue(context, input, t->layout(), status);
       if (TF_GetCode(status) != TF_OK) return;
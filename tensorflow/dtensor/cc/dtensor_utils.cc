@@ -84,6 +84,14 @@ bool DoNotFuseReduceScatter() {
   return true;
 }
 
+bool DisableReplicatedElementwiseFastPath() {
+  char* dtensor_disable_replicated_elementwise_fast_path_str =
+      std::getenv("DTENSOR_DISABLE_REPLICATED_ELEMENTWISE_FAST_PATH");
+  if (dtensor_disable_replicated_elementwise_fast_path_str == nullptr)
+    return false;
+  return true;
+}
+
 int ReduceInBfloat16MaxGroupSize() {
   char* dtensor_reduce_in_bfloat16_max_group_size_str =
       std::getenv("DTENSOR_REDUCE_IN_BFLOAT16_MAX_GROUP_SIZE");
@@ -46,6 +46,10 @@ bool EnableMixedPrecisionReduce();
 // which can be more efficiently implemented.
 bool DoNotFuseReduceScatter();
 
+// Returns whether to run elementwise ops on fully replicated inputs through
+// layout propagation and SPMD expansion instead of directly on each device.
+bool DisableReplicatedElementwiseFastPath();
+
 // Returns the maximum reduction group size for bfloat16 reduction. If the
 // group size exceeds this, then tensors are upcasted to float32 before the
 // reduce op.
@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/c/eager/c_api.h"
 #include "tensorflow/c/eager/c_api_experimental.h"
@@ -63,6 +64,22 @@ void AppendStringValues(const int num_of_elements,
 
 }  // namespace
 
+bool IsElementwiseOp(absl::string_view operation_name) {
+  static const auto* const kElementwiseOps =
+      new absl::flat_hash_set<absl::string_view>{
+          "Abs", "Add", "AddN", "AddV2", "BitwiseAnd", "BitwiseOr",
+          "BitwiseXor", "Cast", "Ceil", "Cos", "Div", "DivNoNan", "Equal",
+          "Erf", "Exp", "Floor", "FloorDiv", "FloorMod", "Greater",
+          "GreaterEqual", "Identity", "IsFinite", "LeakyRelu", "Less",
+          "LessEqual", "Log", "Log1p", "LogicalAnd", "LogicalNot", "LogicalOr",
+          "Maximum", "Minimum", "Mul", "MulNoNan", "Neg", "NotEqual", "Pow",
+          "RealDiv", "Reciprocal", "Relu", "ReluGrad", "Round", "Rsqrt",
+          "Select", "SelectV2", "Sigmoid", "SigmoidGrad", "Sign", "Sin", "Sqrt",
+          "Square", "SquaredDifference", "StopGradient", "Sub", "Tanh",
+          "TanhGrad", "ZerosLike"};
+  return kElementwiseOps->contains(operation_name);
+}
+
 absl::optional<NodeDef> ExtractSmallTensorValue(TFE_Context* context,
                                                 TFE_TensorHandle* tensor,
                                                 const Layout& layout,
@@ -150,6 +167,11 @@ bool ShouldFoldInputArgument(bool is_func, absl::string_view operation_name,
   //   its value should be avoided.
   if (is_func) return false;
 
+  // The layouts of elementwise ops never depend on the values of their inputs,
+  // so folding them would only compile a new function for every value, e.g.
+  // for a step counter.
+  if (IsElementwiseOp(operation_name)) return false;
+
   // TODO(xiejw,power): Think about how to generalize this so it does not depend
   // on operation_name. For example, we can check the max abs value of the
   // tensor value.
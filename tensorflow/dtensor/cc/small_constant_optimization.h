@@ -37,6 +37,10 @@ absl::optional<NodeDef> ExtractSmallTensorValue(TFE_Context* context,
                                                 const Layout& layout,
                                                 TF_Status* status);
 
+// Returns true if `operation_name` is an elementwise operation, whose output
+// layout only depends on the layouts of its inputs and not on their values.
+bool IsElementwiseOp(absl::string_view operation_name);
+
 // Returns true if the given input argument should be eligible for extracting
 // into a graph constant.
 bool ShouldFoldInputArgument(bool is_func, absl::string_view operation_name,
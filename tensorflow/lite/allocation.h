@@ -60,9 +60,33 @@ class Allocation {
 // Use `IsSupported()` to check.
 class MMAPAllocation : public Allocation {
  public:
+  // Options to prepare the mapping when it is created, so that large models
+  // do not page-fault during their first inferences. They are hints: an
+  // option that the platform does not support is ignored.
+  struct Options {
+    // Reads the whole mapping in when it is created, with MAP_POPULATE where
+    // available.
+    bool prefault = false;
+    // Advises the kernel to read the mapping ahead (MADV_WILLNEED).
+    bool will_need = false;
+    // Advises the kernel to back the mapping with transparent huge pages
+    // (MADV_HUGEPAGE), which reduces TLB misses on the weights.
+    bool huge_pages = false;
+    // Copies the mapping into anonymous memory that is aligned to 2MB and
+    // advised for huge pages, and unmaps the file. This uses memory for the
+    // whole model, but huge pages are then used even when the file system
+    // does not support them. The file descriptor stays open.
+    bool copy_to_huge_pages = false;
+  };
+
   // Loads and maps the provided file to a memory region.
   MMAPAllocation(const char* filename, ErrorReporter* error_reporter);
 
+  // Loads and maps the provided file to a memory region, prepared with the
+  // given options.
+  MMAPAllocation(const char* filename, const Options& options,
+                 ErrorReporter* error_reporter);
+
   // Maps the provided file descriptor to a memory region.
   // Note: The provided file descriptor will be dup'ed for usage; the caller
   // retains ownership of the provided descriptor and should close accordingly.
@@ -75,6 +99,13 @@ class MMAPAllocation : public Allocation {
   MMAPAllocation(int fd, size_t offset, size_t length,
                  ErrorReporter* error_reporter);
 
+  // Maps the provided file descriptor, with the given offset and length (both
+  // in bytes), to a memory region prepared with the given options.
+  // Note: The provided file descriptor will be dup'ed for usage; the caller
+  // retains ownership of the provided descriptor and should close accordingly.
+  MMAPAllocation(int fd, size_t offset, size_t length, const Options& options,
+                 ErrorReporter* error_reporter);
+
   virtual ~MMAPAllocation();
   const void* base() const override;
   size_t bytes() const override;
@@ -94,12 +125,13 @@ class MMAPAllocation : public Allocation {
 
  private:
   // Assumes ownership of the provided `owned_fd` instance.
-  MMAPAllocation(ErrorReporter* error_reporter, int owned_fd);
+  MMAPAllocation(ErrorReporter* error_reporter, int owned_fd,
+                 const Options& options);
 
   // Assumes ownership of the provided `owned_fd` instance, and uses the given
   // offset and length (both in bytes) for memory mapping.
   MMAPAllocation(ErrorReporter* error_reporter, int owned_fd, size_t offset,
-                 size_t length);
+                 size_t length, const Options& options);
 };
 
 class FileCopyAllocation : public Allocation {
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <sys/stat.h>
 
+#include <cstring>
 #include <string>
 
 #include <gtest/gtest.h>
@@ -139,6 +140,70 @@ TEST(MMAPAllocation, TestValidFileDescriptorWithOffset) {
 
   close(fd);
 }
+
+// Maps the test model with `options` and checks that it has the same bytes as
+// the plain mapping.
+void ExpectSameBytesWithOptions(const MMAPAllocation::Options& options) {
+  TestErrorReporter error_reporter;
+  MMAPAllocation expected("tensorflow/lite/testdata/empty_model.bin",
+                          &error_reporter);
+  MMAPAllocation allocation("tensorflow/lite/testdata/empty_model.bin",
+                            options, &error_reporter);
+  ASSERT_TRUE(expected.valid());
+  ASSERT_TRUE(allocation.valid());
+  EXPECT_GT(allocation.fd(), 0);
+  ASSERT_EQ(allocation.bytes(), expected.bytes());
+  EXPECT_EQ(
+      std::memcmp(allocation.base(), expected.base(), expected.bytes()), 0);
+}
+
+TEST(MMAPAllocation, TestValidFileWithOptions) {
+  if (!MMAPAllocation::IsSupported()) {
+    return;
+  }
+
+  MMAPAllocation::Options prefault;
+  prefault.prefault = true;
+  ExpectSameBytesWithOptions(prefault);
+
+  MMAPAllocation::Options advised;
+  advised.will_need = true;
+  advised.huge_pages = true;
+  ExpectSameBytesWithOptions(advised);
+
+  MMAPAllocation::Options copied;
+  copied.copy_to_huge_pages = true;
+  ExpectSameBytesWithOptions(copied);
+}
+
+TEST(MMAPAllocation, TestCopyToHugePagesWithOffset) {
+  if (!MMAPAllocation::IsSupported()) {
+    return;
+  }
+
+  int fd =
+      open("tensorflow/lite/testdata/empty_model.bin", O_RDONLY);
+  ASSERT_GT(fd, 0);
+
+  struct stat fd_stat;
+  ASSERT_EQ(fstat(fd, &fd_stat), 0);
+  size_t file_size = fd_stat.st_size;
+
+  TestErrorReporter error_reporter;
+  MMAPAllocation expected(fd, /*offset=*/10, /*length=*/file_size - 10,
+                          &error_reporter);
+  MMAPAllocation::Options options;
+  options.copy_to_huge_pages = true;
+  MMAPAllocation allocation(fd, /*offset=*/10, /*length=*/file_size - 10,
+                            options, &error_reporter);
+  ASSERT_TRUE(expected.valid());
+  ASSERT_TRUE(allocation.valid());
+  ASSERT_EQ(allocation.bytes(), expected.bytes());
+  EXPECT_EQ(
+      std::memcmp(allocation.base(), expected.base(), expected.bytes()), 0);
+
+  close(fd);
+}
 #endif  // defined(__linux__)
 
 }  // namespace tflite
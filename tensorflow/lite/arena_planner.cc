@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <limits>
 #include <memory>
 #include <utility>
@@ -36,13 +37,18 @@ constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
 
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
-                           bool preserve_all_tensors, int tensor_alignment)
+                           bool preserve_all_tensors, int tensor_alignment,
+                           ArenaPlanningStrategy strategy,
+                           int max_cached_plans, bool reuse_larger_plans)
     : context_(context),
       graph_info_(std::move(graph_info)),
       arena_(kDefaultArenaAlignment),
       persistent_arena_(kDefaultArenaAlignment),
       preserve_all_tensors_(preserve_all_tensors),
-      tensor_alignment_(tensor_alignment) {}
+      tensor_alignment_(tensor_alignment),
+      strategy_(strategy),
+      max_cached_plans_(max_cached_plans),
+      reuse_larger_plans_(reuse_larger_plans) {}
 
 ArenaPlanner::~ArenaPlanner() {}
 
@@ -88,6 +94,9 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
 
   // Keeps track of references to each tensor.
   std::vector<int> refcounts(graph_info_->num_tensors(), 0);
+  // The latest execution step at which each tensor is read. Nodes that run
+  // concurrently may release their inputs in any order.
+  std::vector<int32_t> last_use_step(graph_info_->num_tensors(), 0);
 
   auto allocate = [this](int node, int tensor) -> TfLiteStatus {
     if (alloc_node_[tensor] != kNodeNotAssigned) {
@@ -154,12 +163,13 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   // Go through the graph in execution order.
   for (size_t i = 0; i < graph_info_->num_execution_nodes(); ++i) {
     const TfLiteNode& node = graph_info_->node(i);
+    const int32_t step = graph_info_->execution_step(i);
 
     // First queue output tensors for allocation.
     TfLiteIntArray* node_outputs = node.outputs;
     for (int j = 0; j < node_outputs->size; ++j) {
       int tensor_index = node_outputs->data[j];
-      TF_LITE_ENSURE_STATUS(allocate(i, tensor_index));
+      TF_LITE_ENSURE_STATUS(allocate(step, tensor_index));
     }
 
     // Then update the ref-counts of the node's inputs, and if necessary queue
@@ -169,9 +179,12 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
       for (int j = 0; j < node_inputs->size; ++j) {
         int tensor_index = node_inputs->data[j];
         if (tensor_index != kTfLiteOptionalTensor) {
+          last_use_step[tensor_index] =
+              std::max(last_use_step[tensor_index], step);
           refcounts[tensor_index]--;
           if (refcounts[tensor_index] == 0) {
-            TF_LITE_ENSURE_STATUS(deallocate(i, tensor_index));
+            TF_LITE_ENSURE_STATUS(
+                deallocate(last_use_step[tensor_index], tensor_index));
           }
         }
       }
@@ -195,12 +208,13 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
                               i < graph_info_->num_execution_nodes();
        ++i) {
     const TfLiteNode& node = graph_info_->node(i);
+    const int32_t step = graph_info_->execution_step(i);
     TfLiteIntArray* node_temporaries = node.temporaries;
     for (int j = 0; j < node_temporaries->size; ++j) {
       int tensor_index = node_temporaries->data[j];
-      alloc_node_[tensor_index] = i;
+      alloc_node_[tensor_index] = step;
       if (!preserve_all_tensors_) {
-        dealloc_node_[tensor_index] = i;
+        dealloc_node_[tensor_index] = step;
       }
     }
   }
@@ -251,6 +265,36 @@ void ArenaPlanner::DumpDebugInfo(const std::vector<int>& execution_plan) const {
                                   execution_plan);
 }
 
+void ArenaPlanner::GetArenaSizeInfo(size_t* arena_size,
+                                    size_t* lower_bound) const {
+  *arena_size = arena_.high_water_mark();
+
+  // Sweep the usage intervals of the planned allocations to find the largest
+  // number of bytes live at any node.
+  const int32_t num_nodes =
+      std::max<int32_t>(1, graph_info_->num_execution_nodes());
+  std::vector<int64_t> live_bytes_delta(num_nodes + 1, 0);
+  for (int i = 0; i < static_cast<int>(allocs_.size()); ++i) {
+    const ArenaAllocWithUsageInterval& alloc = allocs_[i];
+    if (graph_info_->tensor(i)->allocation_type != kTfLiteArenaRw ||
+        alloc.size == 0) {
+      continue;
+    }
+    const int32_t first_node = std::min(alloc.first_node, num_nodes - 1);
+    const int32_t last_node =
+        std::max(first_node, std::min(alloc.last_node, num_nodes - 1));
+    live_bytes_delta[first_node] += alloc.size;
+    live_bytes_delta[last_node + 1] -= alloc.size;
+  }
+  int64_t live_bytes = 0;
+  int64_t max_live_bytes = 0;
+  for (int32_t node = 0; node < num_nodes; ++node) {
+    live_bytes += live_bytes_delta[node];
+    max_live_bytes = std::max(max_live_bytes, live_bytes);
+  }
+  *lower_bound = static_cast<size_t>(max_live_bytes);
+}
+
 TfLiteStatus ArenaPlanner::Commit() {
   TF_LITE_ENSURE_STATUS(arena_.Commit(context_));
   TF_LITE_ENSURE_STATUS(persistent_arena_.Commit(context_));
@@ -298,6 +342,126 @@ std::vector<int32_t> ArenaPlanner::CreateTensorAllocationVector(int first_node,
   return tensor_order;
 }
 
+int32_t ArenaPlanner::LastUseNode(int32_t tensor_index) const {
+  if (dealloc_node_[tensor_index] != kNodeNotAssigned) {
+    return dealloc_node_[tensor_index];
+  }
+  const int32_t num_nodes = graph_info_->num_execution_nodes();
+  return std::max(alloc_node_[tensor_index], num_nodes - 1);
+}
+
+std::vector<int32_t> ArenaPlanner::SortMovableTensors(
+    const std::vector<int32_t>& tensor_order,
+    const std::function<bool(int32_t, int32_t)>& compare) const {
+  std::vector<int32_t> order;
+  std::vector<int32_t> movable;
+  for (const int32_t tensor_index : tensor_order) {
+    const bool whole_lifetime = alloc_node_[tensor_index] == 0 &&
+                                dealloc_node_[tensor_index] == kNodeNotAssigned;
+    if (graph_info_->tensor(tensor_index)->allocation_type == kTfLiteArenaRw &&
+        !whole_lifetime) {
+      movable.push_back(tensor_index);
+    } else {
+      order.push_back(tensor_index);
+    }
+  }
+  std::stable_sort(movable.begin(), movable.end(), compare);
+  order.insert(order.end(), movable.begin(), movable.end());
+  return order;
+}
+
+std::vector<int32_t> ArenaPlanner::OrderByBreadth(
+    const std::vector<int32_t>& tensor_order) const {
+  // Memory live at each node (its "breadth"), counting the tensors being
+  // planned.
+  const int32_t num_nodes =
+      std::max<int32_t>(1, graph_info_->num_execution_nodes());
+  std::vector<int64_t> breadth(num_nodes + 1, 0);
+  for (const int32_t tensor_index : tensor_order) {
+    if (graph_info_->tensor(tensor_index)->allocation_type != kTfLiteArenaRw) {
+      continue;
+    }
+    const size_t bytes = graph_info_->tensor(tensor_index)->bytes;
+    breadth[alloc_node_[tensor_index]] += bytes;
+    breadth[std::min(LastUseNode(tensor_index), num_nodes - 1) + 1] -= bytes;
+  }
+  for (int32_t node = 1; node < num_nodes; ++node) {
+    breadth[node] += breadth[node - 1];
+  }
+
+  // Visiting nodes from the broadest one, place the tensors live at each node
+  // that haven't been placed yet, largest first. A tensor is therefore placed
+  // along with the other tensors of the broadest node it is live at.
+  std::vector<int32_t> peak_node(graph_info_->num_tensors(), 0);
+  for (const int32_t tensor_index : tensor_order) {
+    const int32_t last_node =
+        std::min(LastUseNode(tensor_index), num_nodes - 1);
+    int32_t best_node = alloc_node_[tensor_index];
+    for (int32_t node = best_node + 1; node <= last_node; ++node) {
+      if (breadth[node] > breadth[best_node]) best_node = node;
+    }
+    peak_node[tensor_index] = best_node;
+  }
+  return SortMovableTensors(tensor_order, [&](int32_t idx1, int32_t idx2) {
+    const int32_t node1 = peak_node[idx1];
+    const int32_t node2 = peak_node[idx2];
+    if (breadth[node1] != breadth[node2]) {
+      return breadth[node1] > breadth[node2];
+    }
+    if (node1 != node2) return node1 < node2;
+    return graph_info_->tensor(idx1)->bytes > graph_info_->tensor(idx2)->bytes;
+  });
+}
+
+std::vector<int32_t> ArenaPlanner::OrderByLifetime(
+    const std::vector<int32_t>& tensor_order) const {
+  return SortMovableTensors(tensor_order, [this](int32_t idx1, int32_t idx2) {
+    const int32_t lifetime1 = LastUseNode(idx1) - alloc_node_[idx1];
+    const int32_t lifetime2 = LastUseNode(idx2) - alloc_node_[idx2];
+    if (lifetime1 != lifetime2) return lifetime1 > lifetime2;
+    return graph_info_->tensor(idx1)->bytes > graph_info_->tensor(idx2)->bytes;
+  });
+}
+
+std::vector<int32_t> ArenaPlanner::ApplyPlanningStrategy(
+    const std::vector<int32_t>& tensor_order) const {
+  switch (strategy_) {
+    case ArenaPlanningStrategy::kGreedyBySize:
+      return tensor_order;
+    case ArenaPlanningStrategy::kGreedyByBreadth:
+      return OrderByBreadth(tensor_order);
+    case ArenaPlanningStrategy::kBestOf:
+      break;
+  }
+
+  // Try each order on a copy of the arena, preferring the earlier candidates
+  // on ties.
+  std::vector<std::vector<int32_t>> candidates = {
+      tensor_order, OrderByBreadth(tensor_order),
+      OrderByLifetime(tensor_order)};
+  size_t best_candidate = 0;
+  size_t best_size = std::numeric_limits<size_t>::max();
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    std::vector<ArenaAllocWithUsageInterval> allocs;
+    for (const int32_t tensor_index : candidates[i]) {
+      const TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
+      if (tensor.allocation_type != kTfLiteArenaRw) continue;
+      ArenaAllocWithUsageInterval alloc;
+      alloc.tensor = tensor_index;
+      alloc.size = tensor.bytes;
+      alloc.first_node = alloc_node_[tensor_index];
+      alloc.last_node = dealloc_node_[tensor_index];
+      allocs.push_back(alloc);
+    }
+    const size_t size = arena_.SimulateAllocations(tensor_alignment_, allocs);
+    if (size < best_size) {
+      best_size = size;
+      best_candidate = i;
+    }
+  }
+  return std::move(candidates[best_candidate]);
+}
+
 TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   // Indices of tensors in order their allocation offsets will be calculated.
   const std::vector<int32_t> tensor_order =
@@ -312,8 +476,24 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
     }
   }
 
+  // Plans can only be reused from a clean slate, they don't account for
+  // allocations made by earlier calls.
+  const bool use_plan_cache =
+      max_cached_plans_ > 0 && arena_.empty() && persistent_arena_.empty();
+  // The allocation vector is sorted by size, so key the plans by tensor index
+  // instead to match them across sizes.
+  std::vector<int32_t> cache_order;
+  if (use_plan_cache) {
+    cache_order = tensor_order;
+    std::sort(cache_order.begin(), cache_order.end());
+    bool restored = false;
+    TF_LITE_ENSURE_STATUS(
+        RestoreCachedPlan(cache_order, first_node, last_node, &restored));
+    if (restored) return kTfLiteOk;
+  }
+
   // Vector of ids of already allocated tensors, ordered by offset.
-  for (const auto& tensor_index : tensor_order) {
+  for (const auto& tensor_index : ApplyPlanningStrategy(tensor_order)) {
     TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
     if (tensor.allocation_type == kTfLiteArenaRw) {
       TF_LITE_ENSURE_STATUS(
@@ -331,9 +511,113 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
           &allocs_[tensor_index]));
     }
   }
+
+  if (use_plan_cache) {
+    CachePlan(cache_order, first_node, last_node);
+  }
+  return kTfLiteOk;
+}
+
+bool ArenaPlanner::PlanFits(const CachedPlan& plan,
+                            const std::vector<int32_t>& tensor_order,
+                            int first_node, int last_node, bool exact) const {
+  if (plan.first_node != first_node || plan.last_node != last_node ||
+      plan.allocs.size() != tensor_order.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < tensor_order.size(); ++i) {
+    const int32_t tensor_index = tensor_order[i];
+    const TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
+    const ArenaAllocWithUsageInterval& alloc = plan.allocs[i];
+    if (alloc.tensor != tensor_index ||
+        plan.allocation_types[i] != tensor.allocation_type ||
+        alloc.first_node != alloc_node_[tensor_index]) {
+      return false;
+    }
+    if (tensor.allocation_type == kTfLiteArenaRw &&
+        alloc.last_node != dealloc_node_[tensor_index]) {
+      return false;
+    }
+    if (exact ? tensor.bytes != alloc.size : tensor.bytes > alloc.size) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TfLiteStatus ArenaPlanner::RestoreCachedPlan(
+    const std::vector<int32_t>& tensor_order, int first_node, int last_node,
+    bool* restored) {
+  *restored = false;
+  auto best_plan = cached_plans_.end();
+  for (auto it = cached_plans_.begin(); it != cached_plans_.end(); ++it) {
+    if (PlanFits(*it, tensor_order, first_node, last_node, /*exact=*/true)) {
+      best_plan = it;
+      break;
+    }
+  }
+  if (best_plan == cached_plans_.end() && reuse_larger_plans_) {
+    // Among the plans that are large enough, use the smallest one.
+    for (auto it = cached_plans_.begin(); it != cached_plans_.end(); ++it) {
+      if (PlanFits(*it, tensor_order, first_node, last_node,
+                   /*exact=*/false) &&
+          (best_plan == cached_plans_.end() ||
+           it->arena_size < best_plan->arena_size)) {
+        best_plan = it;
+      }
+    }
+  }
+  if (best_plan == cached_plans_.end()) return kTfLiteOk;
+
+  // Most recently used plans go first.
+  cached_plans_.splice(cached_plans_.begin(), cached_plans_, best_plan);
+  const CachedPlan& plan = cached_plans_.front();
+  for (size_t i = 0; i < tensor_order.size(); ++i) {
+    const int32_t tensor_index = tensor_order[i];
+    const TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
+    const ArenaAllocWithUsageInterval& alloc = plan.allocs[i];
+    SimpleMemoryArena* arena = nullptr;
+    if (tensor.allocation_type == kTfLiteArenaRw) {
+      arena = &arena_;
+    } else if (tensor.allocation_type == kTfLiteArenaRwPersistent) {
+      arena = &persistent_arena_;
+    } else {
+      continue;
+    }
+    TF_LITE_ENSURE_STATUS(arena->AllocateAtOffset(
+        context_, tensor_alignment_, alloc.offset, tensor.bytes, tensor_index,
+        alloc.first_node, alloc.last_node, &allocs_[tensor_index]));
+  }
+  *restored = true;
   return kTfLiteOk;
 }
 
+void ArenaPlanner::CachePlan(const std::vector<int32_t>& tensor_order,
+                             int first_node, int last_node) {
+  CachedPlan plan;
+  plan.first_node = first_node;
+  plan.last_node = last_node;
+  plan.arena_size = arena_.high_water_mark();
+  for (const int32_t tensor_index : tensor_order) {
+    const TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
+    ArenaAllocWithUsageInterval alloc = allocs_[tensor_index];
+    if (tensor.allocation_type != kTfLiteArenaRw &&
+        tensor.allocation_type != kTfLiteArenaRwPersistent) {
+      // Not planned, only record what is needed to match the tensor.
+      alloc.reset();
+      alloc.first_node = alloc_node_[tensor_index];
+    }
+    alloc.tensor = tensor_index;
+    alloc.size = tensor.bytes;
+    plan.allocation_types.push_back(tensor.allocation_type);
+    plan.allocs.push_back(alloc);
+  }
+  cached_plans_.push_front(std::move(plan));
+  if (cached_plans_.size() > static_cast<size_t>(max_cached_plans_)) {
+    cached_plans_.pop_back();
+  }
+}
+
 TfLiteStatus ArenaPlanner::ResolveTensorAllocation(int tensor_index) {
   TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
   if (tensor.allocation_type == kTfLiteArenaRw) {
@@ -15,7 +15,11 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_ARENA_PLANNER_H_
 #define TENSORFLOW_LITE_ARENA_PLANNER_H_
 
+#include <stddef.h>
+
 #include <cstdint>
+#include <functional>
+#include <list>
 #include <memory>
 #include <vector>
 
@@ -48,9 +52,20 @@ class ArenaPlanner : public MemoryPlanner {
   // Ownership of 'context' is not taken and it must remain util the
   // ArenaPlanner is destroyed. The inputs to the graph will not share
   // memory with any other tensor, effectively preserving them until the end
-  // of inference.
+  // of inference. `strategy` chooses the order in which tensors are placed in
+  // the non-persistent arena.
+  //
+  // If `max_cached_plans` is positive, the offsets computed for the last
+  // `max_cached_plans` distinct sets of tensor sizes are kept, and reused
+  // when the same sizes come back (e.g. when inputs are resized back and
+  // forth). If `reuse_larger_plans` is also true, a cached plan whose tensors
+  // are all at least as large as the current ones is reused too, so that
+  // planning once for the largest input shapes serves every smaller shape.
   ArenaPlanner(TfLiteContext* context, std::unique_ptr<GraphInfo> graph_info,
-               bool preserve_all_tensors, int tensor_alignment);
+               bool preserve_all_tensors, int tensor_alignment,
+               ArenaPlanningStrategy strategy =
+                   ArenaPlanningStrategy::kGreedyBySize,
+               int max_cached_plans = 0, bool reuse_larger_plans = false);
   ~ArenaPlanner() override;
   ArenaPlanner(const ArenaPlanner&) = delete;
   ArenaPlanner& operator=(const ArenaPlanner&) = delete;
@@ -63,6 +78,7 @@ class ArenaPlanner : public MemoryPlanner {
   TfLiteStatus AcquireNonPersistentMemory() override;
   bool HasNonPersistentMemory() override;
   void DumpDebugInfo(const std::vector<int>& execution_plan) const override;
+  void GetArenaSizeInfo(size_t* arena_size, size_t* lower_bound) const override;
 
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
@@ -82,10 +98,65 @@ class ArenaPlanner : public MemoryPlanner {
   std::vector<int32_t> CreateTensorAllocationVector(int first_node,
                                                     int last_node);
 
+  // Returns `tensor_order`, as returned by CreateTensorAllocationVector(),
+  // reordered for `strategy_`.
+  std::vector<int32_t> ApplyPlanningStrategy(
+      const std::vector<int32_t>& tensor_order) const;
+
+  // Returns `tensor_order` with the kTfLiteArenaRw tensors that don't live
+  // through the whole inference ordered by the peak memory of the nodes they
+  // are live at, then by size.
+  std::vector<int32_t> OrderByBreadth(
+      const std::vector<int32_t>& tensor_order) const;
+
+  // Returns `tensor_order` with the kTfLiteArenaRw tensors that don't live
+  // through the whole inference ordered by how long they live, then by size.
+  std::vector<int32_t> OrderByLifetime(
+      const std::vector<int32_t>& tensor_order) const;
+
+  // Returns `tensor_order` with the kTfLiteArenaRw tensors that don't live
+  // through the whole inference stably sorted by `compare`, after all the
+  // other tensors.
+  std::vector<int32_t> SortMovableTensors(
+      const std::vector<int32_t>& tensor_order,
+      const std::function<bool(int32_t, int32_t)>& compare) const;
+
+  // Returns the last node using tensor `tensor_index`. Tensors that are never
+  // deallocated live until the last node of the execution plan.
+  int32_t LastUseNode(int32_t tensor_index) const;
+
   // Traverse the allocation queue and reserve space in the appropriate arena
   // for all tensors affected by ops in the interval [first_node, last_node].
   TfLiteStatus CalculateAllocations(int first_node, int last_node);
 
+  // Offsets planned for a set of tensor sizes and usage intervals.
+  struct CachedPlan {
+    int first_node;
+    int last_node;
+    // One entry per tensor of the allocation vector, by tensor index.
+    std::vector<TfLiteAllocationType> allocation_types;
+    std::vector<ArenaAllocWithUsageInterval> allocs;
+    // High water mark of the non-persistent arena.
+    size_t arena_size;
+  };
+
+  // `tensor_order` is sorted by tensor index in the helpers below.
+  // If a cached plan fits the tensors in `tensor_order`, schedules their
+  // allocations at its offsets and sets `restored` to true.
+  TfLiteStatus RestoreCachedPlan(const std::vector<int32_t>& tensor_order,
+                                 int first_node, int last_node,
+                                 bool* restored);
+
+  // Returns true if `plan` can hold the tensors in `tensor_order`, exactly
+  // (same sizes) if `exact` is true.
+  bool PlanFits(const CachedPlan& plan,
+                const std::vector<int32_t>& tensor_order, int first_node,
+                int last_node, bool exact) const;
+
+  // Adds the allocations just calculated for `tensor_order` to the cache.
+  void CachePlan(const std::vector<int32_t>& tensor_order, int first_node,
+                 int last_node);
+
   // Assign absolute memory location to a tensor, based on its relative
   // position inside the corresponding arena buffer.
   TfLiteStatus ResolveTensorAllocation(int tensor_index);
@@ -105,7 +176,9 @@ class ArenaPlanner : public MemoryPlanner {
   std::vector<ArenaAllocWithUsageInterval> allocs_;
 
   // First node, that uses the tensor. It needs to be allocated before
-  // execution of the node's operation.
+  // execution of the node's operation. Nodes are identified by their
+  // GraphInfo::execution_step(), which is the execution plan index unless
+  // nodes run concurrently.
   std::vector<int32_t> alloc_node_;
 
   // Last node, that uses the tensor. It can be deallocated after execution of
@@ -127,6 +200,14 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Number of bytes that tensor buffers should be aligned to.
   int tensor_alignment_;
+
+  // Order in which tensors are placed in `arena_`.
+  ArenaPlanningStrategy strategy_;
+
+  // Recently used plans first, at most `max_cached_plans_` of them.
+  std::list<CachedPlan> cached_plans_;
+  int max_cached_plans_;
+  bool reuse_larger_plans_;
 };
 
 }  // namespace tflite
@@ -114,11 +114,16 @@ class TestGraph {
   const std::vector<int>& inputs() { return inputs_; }
   const std::vector<int>& outputs() { return outputs_; }
   const std::vector<int>& variables() { return variables_; }
+  const std::vector<int>& execution_steps() { return execution_steps_; }
 
   void SetVariables(const std::vector<int>& variables) {
     variables_ = variables;
   }
 
+  void SetExecutionSteps(const std::vector<int>& execution_steps) {
+    execution_steps_ = execution_steps;
+  }
+
   void Swap(TestGraph* other) {
     std::swap(nodes_, other->nodes_);
     std::swap(tensors_, other->tensors_);
@@ -133,6 +138,7 @@ class TestGraph {
   std::vector<int> inputs_;
   std::vector<int> outputs_;
   std::vector<int> variables_;
+  std::vector<int> execution_steps_;
 };
 
 // The GraphInfo for a TestGraph.
@@ -155,6 +161,10 @@ class TestGraphInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return graph_->variables();
   }
+  size_t execution_step(size_t index) const override {
+    return graph_->execution_steps().empty() ? index
+                                             : graph_->execution_steps()[index];
+  }
 
  private:
   TestGraph* graph_;
@@ -174,12 +184,16 @@ void ReportError(TfLiteContext* context, const char* format, ...) {
 
 class ArenaPlannerTest : public ::testing::Test {
  protected:
-  void SetGraph(TestGraph* graph, bool preserve_all_tensors = false) {
+  void SetGraph(TestGraph* graph, bool preserve_all_tensors = false,
+                ArenaPlanningStrategy strategy =
+                    ArenaPlanningStrategy::kGreedyBySize,
+                int max_cached_plans = 0, bool reuse_larger_plans = false) {
     graph_ = graph;
     context_.ReportError = ReportError;
     planner_.reset(new ArenaPlanner(
         &context_, std::unique_ptr<GraphInfo>(new TestGraphInfo(graph)),
-        preserve_all_tensors, kTensorAlignment));
+        preserve_all_tensors, kTensorAlignment, strategy, max_cached_plans,
+        reuse_larger_plans));
     CHECK(planner_->ResetAllocations() == kTfLiteOk);
     CHECK(planner_->PlanAllocations() == kTfLiteOk);
   }
@@ -201,10 +215,21 @@ class ArenaPlannerTest : public ::testing::Test {
     CHECK(planner_->AcquireNonPersistentMemory() == kTfLiteOk);
   }
 
+  void ResetAllocations() {
+    CHECK(planner_->ResetAllocations() == kTfLiteOk);
+  }
+
   void ResetAllocationsAfter(int node) {
     CHECK(planner_->ResetAllocationsAfter(node) == kTfLiteOk);
   }
 
+  // Returns the planned arena size, and sets `lower_bound` to its lower bound.
+  size_t GetArenaSize(size_t* lower_bound) {
+    size_t arena_size;
+    planner_->GetArenaSizeInfo(&arena_size, lower_bound);
+    return arena_size;
+  }
+
   bool HasNonPersistentMemory() {
     return planner_ && planner_->HasNonPersistentMemory();
   }
@@ -759,5 +784,164 @@ TEST_F(ArenaPlannerTest, DebugTensors) {
   EXPECT_EQ(tensorOffsets.size(), 8);
 }
 
+TEST_F(ArenaPlannerTest, ConcurrentNodesDoNotShareMemory) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {4}},     // First op, with temporary
+                      {{0}, {2}, {5}},     // Second op, with temporary
+                      {{1, 2}, {3}, {6}},  // Third op, with temporary
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  // Temporaries of nodes running one after the other share memory.
+  EXPECT_EQ(GetOffset(4), GetOffset(5));
+
+  // Let the first two ops run at the same time.
+  graph.SetExecutionSteps({0, 0, 1});
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  auto overlap = [this](int tensor1, int tensor2) {
+    return GetOffset(tensor1) < GetOffsetAfter(tensor2) &&
+           GetOffset(tensor2) < GetOffsetAfter(tensor1);
+  };
+  // Tensors used by the first two ops are all live during their step.
+  for (int t1 : {0, 1, 2, 4, 5}) {
+    for (int t2 : {0, 1, 2, 4, 5}) {
+      if (t1 != t2) {
+        EXPECT_FALSE(overlap(t1, t2)) << t1 << " and " << t2;
+      }
+    }
+  }
+  // The third op's temporary may still reuse the earlier ones.
+  EXPECT_FALSE(overlap(6, 1));
+  EXPECT_FALSE(overlap(6, 2));
+  EXPECT_FALSE(overlap(6, 3));
+}
+
+TEST_F(ArenaPlannerTest, ArenaSizeInfo) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {}},
+                      {{1}, {2}, {}},
+                      {{1}, {3}, {}},
+                      {{1}, {4}, {}},
+                      {{2, 3, 4}, {5}, {}},
+                      {{5}, {6}, {}},
+                      {{5}, {7}, {}},
+                      {{6, 7}, {8}, {}},
+                  },
+                  {8});
+  (*graph.tensors())[0].bytes = 32;
+  (*graph.tensors())[1].bytes = 28;
+  (*graph.tensors())[2].bytes = 36;
+  (*graph.tensors())[3].bytes = 16;
+  (*graph.tensors())[4].bytes = 8;
+  (*graph.tensors())[5].bytes = 64;
+  (*graph.tensors())[6].bytes = 10;
+  (*graph.tensors())[7].bytes = 40;
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  // Tensors 0, 2, 3, 4 and 5 are live at the fifth node.
+  size_t lower_bound;
+  EXPECT_EQ(GetArenaSize(&lower_bound), 156);
+  EXPECT_EQ(lower_bound, 156);
+}
+
+TEST_F(ArenaPlannerTest, PlanningStrategies) {
+  // Placing tensor 4 before tensor 3, as the largest-first order does, leaves
+  // a gap too small for tensor 3.
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {}},
+                      {{1}, {2}, {}},
+                      {{2}, {3}, {}},
+                      {{3}, {4}, {}},
+                  },
+                  {4});
+  (*graph.tensors())[0].bytes = 20;
+  (*graph.tensors())[1].bytes = 32;
+  (*graph.tensors())[2].bytes = 32;
+  (*graph.tensors())[3].bytes = 16;
+  (*graph.tensors())[4].bytes = 20;
+
+  size_t lower_bound;
+  SetGraph(&graph, /*preserve_all_tensors=*/false,
+           ArenaPlanningStrategy::kGreedyBySize);
+  Execute(0, 10);
+  EXPECT_EQ(GetArenaSize(&lower_bound), 100);
+  EXPECT_EQ(lower_bound, 84);
+
+  // Placing the tensors of the second node first, then those of the third
+  // node, reaches the lower bound.
+  SetGraph(&graph, /*preserve_all_tensors=*/false,
+           ArenaPlanningStrategy::kGreedyByBreadth);
+  Execute(0, 10);
+  EXPECT_EQ(GetArenaSize(&lower_bound), 84);
+  EXPECT_EQ(GetOffset(1), GetOffsetAfter(0));
+  EXPECT_EQ(GetOffset(3), GetOffsetAfter(0));
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(3));
+
+  SetGraph(&graph, /*preserve_all_tensors=*/false,
+           ArenaPlanningStrategy::kBestOf);
+  Execute(0, 10);
+  EXPECT_EQ(GetArenaSize(&lower_bound), 84);
+}
+
+TEST_F(ArenaPlannerTest, CachedPlans) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {}},
+                      {{1}, {2}, {}},
+                      {{2}, {3}, {}},
+                  },
+                  {3});
+  for (bool reuse_larger_plans : {false, true}) {
+    SCOPED_TRACE(reuse_larger_plans);
+    (*graph.tensors())[3].bytes = 12;
+    SetGraph(&graph, /*preserve_all_tensors=*/false,
+             ArenaPlanningStrategy::kGreedyBySize, /*max_cached_plans=*/2,
+             reuse_larger_plans);
+    Execute(0, 10);
+    const std::ptrdiff_t large_offset2 = GetOffset(2);
+    const std::ptrdiff_t large_offset3 = GetOffset(3);
+    EXPECT_EQ(large_offset2, GetOffsetAfter(3));
+    EXPECT_EQ(large_offset3, GetOffsetAfter(0));
+
+    // Shrink the output, as when resizing the inputs.
+    (*graph.tensors())[3].bytes = 4;
+    ResetAllocations();
+    Execute(0, 10);
+    if (reuse_larger_plans) {
+      // The plan made for the larger output still fits.
+      EXPECT_EQ(GetOffset(2), large_offset2);
+      EXPECT_EQ(GetOffset(3), large_offset3);
+    } else {
+      // Planned again, the larger tensor 2 goes first.
+      EXPECT_EQ(GetOffset(2), GetOffsetAfter(0));
+      EXPECT_EQ(GetOffset(3), GetOffset(1));
+    }
+    const std::ptrdiff_t small_offset2 = GetOffset(2);
+
+    // Going back to either size reuses its plan.
+    (*graph.tensors())[3].bytes = 12;
+    ResetAllocations();
+    Execute(0, 10);
+    EXPECT_EQ(GetOffset(2), large_offset2);
+    EXPECT_EQ(GetOffset(3), large_offset3);
+    (*graph.tensors())[3].bytes = 4;
+    ResetAllocations();
+    Execute(0, 10);
+    EXPECT_EQ(GetOffset(2), small_offset2);
+  }
+}
+
 }  // namespace
 }  // namespace tflite
@@ -28,6 +28,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "ruy/thread_pool.h"  // from @ruy
 #include "tensorflow/lite/allocation.h"
 #include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/c/c_api_types.h"
@@ -38,6 +39,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/tensor_utils.h"
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/minimal_logging.h"
@@ -219,6 +221,11 @@ class InterpreterInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return subgraph_->variables();
   }
+  size_t execution_step(size_t index) const override {
+    return index < subgraph_->execution_steps_.size()
+               ? subgraph_->execution_steps_[index]
+               : index;
+  }
 
  public:
   Subgraph* subgraph_;
@@ -749,11 +756,21 @@ TfLiteStatus Subgraph::AllocateTensors() {
   next_execution_plan_index_to_prepare_ = 0;
   next_execution_plan_index_to_plan_allocation_ = 0;
   next_original_execution_plan_index_to_prepare_ = 0;
+  // Ops are prepared in execution plan order. Any previous inter-op schedule
+  // is rebuilt afterwards, once it is known that no tensor is dynamic.
+  if (!execution_steps_.empty()) {
+    inter_op_steps_.clear();
+    execution_steps_.clear();
+    if (memory_planner_) {
+      TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+    }
+  }
   if (memory_planner_) {
     TF_LITE_ENSURE_STATUS(memory_planner_->ResetAllocations());
   }
 
   TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
+  TF_LITE_ENSURE_STATUS(PlanInterOpParallelism());
 
   state_ = kStateInvokable;
 
@@ -1039,14 +1056,25 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::GetArenaSizeInfo(size_t* arena_size,
+                                        size_t* lower_bound) {
+  if (!memory_planner_) {
+    ReportError("GetArenaSizeInfo called before AllocateTensors.");
+    return kTfLiteError;
+  }
+  memory_planner_->GetArenaSizeInfo(arena_size, lower_bound);
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::PrepareOpsAndTensors() {
   if (!memory_planner_) {
 #ifdef TFLITE_USE_SIMPLE_MEMORY_PLANNER
     memory_planner_.reset(new SimplePlanner(&context_, CreateGraphInfo()));
 #else
-    memory_planner_.reset(new ArenaPlanner(&context_, CreateGraphInfo(),
-                                           preserve_all_tensors_,
-                                           kDefaultTensorAlignment));
+    memory_planner_.reset(new ArenaPlanner(
+        &context_, CreateGraphInfo(), preserve_all_tensors_,
+        kDefaultTensorAlignment, arena_planning_strategy_,
+        max_cached_arena_plans_, reuse_larger_arena_plans_));
 #endif
     memory_planner_->PlanAllocations();
   }
@@ -1150,6 +1178,42 @@ TfLiteStatus Subgraph::RemoveUnusedInputs() {
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::EnsureOpInputsAreReadable(
+    const TfLiteNode& node, const TfLiteRegistration& registration) {
+  for (int i = 0; i < node.inputs->size; ++i) {
+    int tensor_index = node.inputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) {
+      continue;
+    }
+    TfLiteTensor* tensor = &tensors_[tensor_index];
+    if (tensor->delegate && tensor->delegate != node.delegate &&
+        tensor->data_is_stale) {
+      TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+    }
+    if (tensor->data.raw == nullptr && tensor->bytes > 0) {
+      if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
+          tensor->dims->size != 1) {
+        // In general, having a tensor here with no buffer will be an error.
+        // However, for the reshape operator, the second input tensor is
+        // sometimes only used for the shape, not for the data. Thus, null
+        // buffer is ok in this situation.
+        // The situation where null buffer is not ok for reshape operator is
+        // only when there are 2 inputs given to the node and the one
+        // corresponding to the shape (i == 1) is a vector that contains all
+        // dimensions. See `GetOutputShape()` function in
+        // `tensorflow/lite/kernels/reshape.cc`
+        continue;
+      } else {
+        // In all other cases, we need to return an error as otherwise we will
+        // trigger a null pointer dereference (likely).
+        ReportError("Input tensor %d lacks data", tensor_index);
+        return kTfLiteError;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::Invoke() {
   if (!consistent_) {
     ReportError("Invoke called on model that is not consistent.");
@@ -1166,6 +1230,10 @@ TfLiteStatus Subgraph::Invoke() {
   }
   TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(), "Invoke");
 
+  if (!inter_op_steps_.empty()) {
+    return InvokeInterOpParallel();
+  }
+
   // Invocations are always done in node order.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
@@ -1186,37 +1254,7 @@ TfLiteStatus Subgraph::Invoke() {
     if (profiler_) op_name = GetTFLiteOpName(registration);
     TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(profiler_.get(), op_name, node_index);
 
-    for (int i = 0; i < node.inputs->size; ++i) {
-      int tensor_index = node.inputs->data[i];
-      if (tensor_index == kTfLiteOptionalTensor) {
-        continue;
-      }
-      TfLiteTensor* tensor = &tensors_[tensor_index];
-      if (tensor->delegate && tensor->delegate != node.delegate &&
-          tensor->data_is_stale) {
-        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
-      }
-      if (tensor->data.raw == nullptr && tensor->bytes > 0) {
-        if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
-            tensor->dims->size != 1) {
-          // In general, having a tensor here with no buffer will be an error.
-          // However, for the reshape operator, the second input tensor is
-          // sometimes only used for the shape, not for the data. Thus, null
-          // buffer is ok in this situation.
-          // The situation where null buffer is not ok for reshape operator is
-          // only when there are 2 inputs given to the node and the one
-          // corresponding to the shape (i == 1) is a vector that contains all
-          // dimensions. See `GetOutputShape()` function in
-          // `tensorflow/lite/kernels/reshape.cc`
-          continue;
-        } else {
-          // In all other cases, we need to return an error as otherwise we will
-          // trigger a null pointer dereference (likely).
-          ReportError("Input tensor %d lacks data", tensor_index);
-          return kTfLiteError;
-        }
-      }
-    }
+    TF_LITE_ENSURE_STATUS(EnsureOpInputsAreReadable(node, registration));
     // Allocate dynamic tensors which memory is required to be allocated
     // before executing the node.
     MayAllocateOpOutput(&node);
@@ -1260,6 +1298,238 @@ TfLiteStatus Subgraph::Invoke() {
   return status;
 }
 
+struct Subgraph::InterOpWorker {
+  // A copy of the subgraph's context that recommends a single thread, and
+  // hands out `cpu_backend_context` instead of the shared CPU backend context.
+  // Kernels running concurrently would otherwise race on it.
+  TfLiteContext context;
+  ExternalCpuBackendContext cpu_backend_context;
+};
+
+// Invokes every `stride`-th node of an inter-op step, starting at `first`.
+class Subgraph::InterOpTask : public ruy::Task {
+ public:
+  InterOpTask(Subgraph* subgraph, InterOpWorker* worker,
+              const std::vector<int>* step, int first, int stride)
+      : subgraph_(subgraph),
+        worker_(worker),
+        step_(step),
+        first_(first),
+        stride_(stride) {}
+
+  void Run() override {
+    for (int i = first_; i < step_->size(); i += stride_) {
+      const int execution_plan_index = (*step_)[i];
+      const int node_index = subgraph_->execution_plan_[execution_plan_index];
+      auto& node_and_registration =
+          subgraph_->nodes_and_registration_[node_index];
+      const TfLiteRegistration& registration = node_and_registration.second;
+      if (registration.invoke == nullptr ||
+          registration.invoke(&worker_->context,
+                              &node_and_registration.first) != kTfLiteOk) {
+        failed_execution_plan_index_ = execution_plan_index;
+        return;
+      }
+    }
+  }
+
+  // Execution plan index of the node that failed, or -1.
+  int failed_execution_plan_index() const {
+    return failed_execution_plan_index_;
+  }
+
+ private:
+  Subgraph* subgraph_;
+  InterOpWorker* worker_;
+  const std::vector<int>* step_;
+  int first_;
+  int stride_;
+  int failed_execution_plan_index_ = -1;
+};
+
+bool Subgraph::CanRunConcurrently(int node_index) const {
+  const TfLiteNode& node = nodes_and_registration_[node_index].first;
+  const TfLiteRegistration& registration =
+      nodes_and_registration_[node_index].second;
+  // Delegate kernels and custom ops may not be reentrant, and nodes with side
+  // effects must keep their order relative to each other.
+  if (node.delegate != nullptr ||
+      registration.builtin_code == kTfLiteBuiltinCustom ||
+      OpMightHaveSideEffect(&node, &registration)) {
+    return false;
+  }
+  // Variable tensors are updated in place, which is invisible to the data
+  // dependencies the schedule is built from.
+  for (const TfLiteIntArray* tensor_indices : {node.inputs, node.outputs}) {
+    for (int i = 0; i < tensor_indices->size; ++i) {
+      const int tensor_index = tensor_indices->data[i];
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& tensor = tensors_[tensor_index];
+      if (tensor.is_variable || tensor.delegate != nullptr) return false;
+    }
+  }
+  // Resizing dynamic temporaries during Invoke touches shared state.
+  for (int i = 0; i < node.temporaries->size; ++i) {
+    const int tensor_index = node.temporaries->data[i];
+    if (tensors_[tensor_index].allocation_type == kTfLiteDynamic) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TfLiteStatus Subgraph::PlanInterOpParallelism() {
+  if (num_inter_op_threads_ < 2 || !memory_planner_ || has_dynamic_tensors_ ||
+      execution_plan_.empty() ||
+      next_execution_plan_index_to_prepare_ != execution_plan_.size()) {
+    return kTfLiteOk;
+  }
+
+  // A node runs one step after the latest of its producers. Nodes that can't
+  // run concurrently get a step of their own, after all nodes before them in
+  // the execution plan, and nodes after them can't be scheduled before it.
+  std::vector<int> producer_step(tensors_.size(), -1);
+  int num_steps = 0;
+  int first_free_step = 0;
+  execution_steps_.assign(execution_plan_.size(), 0);
+  for (int execution_plan_index = 0;
+       execution_plan_index < execution_plan_.size(); execution_plan_index++) {
+    const int node_index = execution_plan_[execution_plan_index];
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    int step = first_free_step;
+    if (CanRunConcurrently(node_index)) {
+      for (int i = 0; i < node.inputs->size; ++i) {
+        const int tensor_index = node.inputs->data[i];
+        if (tensor_index != kTfLiteOptionalTensor) {
+          step = std::max(step, producer_step[tensor_index] + 1);
+        }
+      }
+    } else {
+      step = num_steps;
+      first_free_step = step + 1;
+    }
+    for (int i = 0; i < node.outputs->size; ++i) {
+      const int tensor_index = node.outputs->data[i];
+      if (tensor_index != kTfLiteOptionalTensor) {
+        producer_step[tensor_index] = step;
+      }
+    }
+    execution_steps_[execution_plan_index] = step;
+    num_steps = std::max(num_steps, step + 1);
+  }
+
+  inter_op_steps_.assign(num_steps, {});
+  for (int execution_plan_index = 0;
+       execution_plan_index < execution_plan_.size(); execution_plan_index++) {
+    inter_op_steps_[execution_steps_[execution_plan_index]].push_back(
+        execution_plan_index);
+  }
+  if (num_steps == execution_plan_.size()) {
+    // Nothing to run concurrently.
+    inter_op_steps_.clear();
+    execution_steps_.clear();
+    return kTfLiteOk;
+  }
+
+  if (!inter_op_thread_pool_) {
+    inter_op_thread_pool_ = std::make_unique<ruy::ThreadPool>();
+  }
+  // All ops are prepared, so the whole plan can be laid out again with the
+  // lifetimes of tensors extended to the steps they are used in.
+  TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+  TF_LITE_ENSURE_STATUS(
+      memory_planner_->ExecuteAllocations(0, execution_plan_.size() - 1));
+  return kTfLiteOk;
+}
+
+TfLiteExternalContext* Subgraph::GetInterOpExternalContext(
+    struct TfLiteContext* context, TfLiteExternalContextType type) {
+  Subgraph* subgraph = static_cast<Subgraph*>(context->impl_);
+  if (type == kTfLiteCpuBackendContext) {
+    for (const auto& worker : subgraph->inter_op_workers_) {
+      if (&worker->context == context) {
+        return &worker->cpu_backend_context;
+      }
+    }
+  }
+  return subgraph->GetExternalContext(type);
+}
+
+TfLiteStatus Subgraph::InvokeInterOpParallel() {
+  std::vector<InterOpTask> tasks;
+  for (const std::vector<int>& step : inter_op_steps_) {
+    for (int execution_plan_index : step) {
+      const auto& node_and_registration =
+          nodes_and_registration_[execution_plan_[execution_plan_index]];
+      TF_LITE_ENSURE_STATUS(EnsureOpInputsAreReadable(
+          node_and_registration.first, node_and_registration.second));
+    }
+
+    if (check_cancelled_func_ != nullptr &&
+        check_cancelled_func_(cancellation_data_)) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteError;
+    }
+
+    EnsureTensorsVectorCapacity();
+
+    // Profilers aren't thread-safe, so profiled runs invoke one node at a
+    // time. They still have to follow the steps the arena was planned for.
+    if (step.size() == 1 || profiler_) {
+      for (int execution_plan_index : step) {
+        const int node_index = execution_plan_[execution_plan_index];
+        TfLiteNode& node = nodes_and_registration_[node_index].first;
+        const TfLiteRegistration& registration =
+            nodes_and_registration_[node_index].second;
+        const char* op_name = nullptr;
+        if (profiler_) op_name = GetTFLiteOpName(registration);
+        TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(profiler_.get(), op_name,
+                                              node_index);
+        if (OpInvoke(registration, &node) != kTfLiteOk) {
+          return ReportOpError(&context_, node, registration, node_index,
+                               "failed to invoke");
+        }
+      }
+      continue;
+    }
+
+    const int num_tasks =
+        std::min(static_cast<int>(step.size()), num_inter_op_threads_);
+    while (inter_op_workers_.size() < num_tasks) {
+      inter_op_workers_.push_back(std::make_unique<InterOpWorker>());
+    }
+    // Workers share the packed weights cache of the subgraph's own CPU
+    // backend context, if it has one.
+    auto* cpu_backend_context = static_cast<ExternalCpuBackendContext*>(
+        GetExternalContext(kTfLiteCpuBackendContext));
+    tasks.clear();
+    for (int i = 0; i < num_tasks; ++i) {
+      InterOpWorker* worker = inter_op_workers_[i].get();
+      worker->context = context_;
+      worker->context.recommended_num_threads = 1;
+      worker->context.GetExternalContext = GetInterOpExternalContext;
+      if (cpu_backend_context != nullptr) {
+        worker->cpu_backend_context.set_packed_weights_cache(
+            cpu_backend_context->packed_weights_cache());
+      }
+      tasks.emplace_back(this, worker, &step, i, num_tasks);
+    }
+    inter_op_thread_pool_->Execute(num_tasks, tasks.data());
+
+    for (const InterOpTask& task : tasks) {
+      const int execution_plan_index = task.failed_execution_plan_index();
+      if (execution_plan_index >= 0) {
+        const int node_index = execution_plan_[execution_plan_index];
+        return ReportOpError(&context_,
+                             nodes_and_registration_[node_index].first,
+                             nodes_and_registration_[node_index].second,
+                             node_index, "failed to invoke");
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
@@ -37,9 +37,14 @@ limitations under the License.
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/util.h"
 
+namespace ruy {
+class ThreadPool;
+}  // namespace ruy
+
 namespace tflite {
 
-class SingleOpModel;  // Class for friend declarations.
+class InterpreterInfo;  // Class for friend declarations.
+class SingleOpModel;    // Class for friend declarations.
 
 namespace delegates {
 namespace test_utils {
@@ -50,6 +55,7 @@ class TestDelegate;  // Class for friend declarations.
 class Subgraph {
  public:
   friend class Interpreter;
+  friend class InterpreterInfo;
   friend class SingleOpModel;
 
   Subgraph(ErrorReporter* error_reporter,
@@ -378,6 +384,17 @@ class Subgraph {
     release_dynamic_tensors_if_unused_ = true;
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // Runs nodes that don't depend on each other concurrently on up to
+  // `num_threads` threads, including the thread calling `Invoke`. Values below
+  // 2 keep the default of running one node at a time. Only takes effect for
+  // graphs without dynamic tensors; nodes that are delegated, custom or might
+  // have side effects always run on their own. This API needs to be called
+  // before calling `AllocateTensors`.
+  void SetNumInterOpThreads(int num_threads) {
+    num_inter_op_threads_ = num_threads;
+  }
+
   /// WARNING: This is an experimental API and subject to change.
   /// Use dynamic tensor allocation and deallocation method for large tensors
   /// instead of static memory planner. Dynamic tensors are allocated just
@@ -394,6 +411,32 @@ class Subgraph {
     return (large_tensors_thresholds_in_bytes_ > 0);
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // Sets the order in which the arena memory planner assigns offsets to
+  // tensors. This API must be called before `AllocateTensors`.
+  void SetArenaPlanningStrategy(ArenaPlanningStrategy strategy) {
+    arena_planning_strategy_ = strategy;
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // Keeps the arena offsets planned for the last `max_plans` distinct sets of
+  // tensor sizes, so that `AllocateTensors` after `ResizeInputTensor` back to
+  // previously seen shapes doesn't plan them again. Ops are still prepared.
+  // If `reuse_larger_plans` is true, a plan made for larger tensors with the
+  // same lifetimes is reused as well: allocating tensors once for the largest
+  // input shapes then serves every smaller shape, with the arena of the
+  // largest. This API must be called before `AllocateTensors`.
+  void CacheArenaPlans(int max_plans, bool reuse_larger_plans) {
+    max_cached_arena_plans_ = max_plans;
+    reuse_larger_arena_plans_ = reuse_larger_plans;
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // Returns the size of the non-persistent arena planned by the last call to
+  // `AllocateTensors`, and a lower bound on it. See
+  // MemoryPlanner::GetArenaSizeInfo.
+  TfLiteStatus GetArenaSizeInfo(size_t* arena_size, size_t* lower_bound);
+
   // WARNING: This is an experimental API and subject to change.
   // Remove unused inputs of the subgraph. It checks usage of inputs and mark it
   // as kTfLiteOptionalTensor if the input is not used in graph execution.
@@ -719,6 +762,35 @@ class Subgraph {
   // tensors if configured.
   void MaybeReleaseDynamicTensors(const TfLiteNode& node, size_t node_index);
 
+  // Checks that the input tensors of 'node' hold readable data before it is
+  // invoked.
+  TfLiteStatus EnsureOpInputsAreReadable(
+      const TfLiteNode& node, const TfLiteRegistration& registration);
+
+  // Per-thread state and task for running nodes concurrently, see
+  // InvokeInterOpParallel().
+  struct InterOpWorker;
+  class InterOpTask;
+
+  // Returns true if the node at 'node_index' may run at the same time as other
+  // nodes it doesn't depend on.
+  bool CanRunConcurrently(int node_index) const;
+
+  // Groups the execution plan into steps of independent nodes and re-plans
+  // the arena so that tensors of nodes sharing a step never share memory.
+  // Does nothing unless `SetNumInterOpThreads` was called and all ops have
+  // been prepared.
+  TfLiteStatus PlanInterOpParallelism();
+
+  // Invokes the steps built by PlanInterOpParallelism() in order, running the
+  // nodes of each step concurrently.
+  TfLiteStatus InvokeInterOpParallel();
+
+  // GetExternalContext() of the contexts that nodes are invoked with by
+  // inter-op workers. Gives each worker its own CPU backend context.
+  static TfLiteExternalContext* GetInterOpExternalContext(
+      struct TfLiteContext* context, TfLiteExternalContextType type);
+
   // The state of the Interpreter.
   enum State {
     // The interpreter isn't ready to be invoked.
@@ -884,6 +956,29 @@ class Subgraph {
 
   // Threshold bytes of tensors to apply dymamic allocation.
   size_t large_tensors_thresholds_in_bytes_;
+
+  // Passed to the ArenaPlanner, see `SetArenaPlanningStrategy`.
+  ArenaPlanningStrategy arena_planning_strategy_ =
+      ArenaPlanningStrategy::kGreedyBySize;
+
+  // Passed to the ArenaPlanner, see `CacheArenaPlans`.
+  int max_cached_arena_plans_ = 0;
+  bool reuse_larger_arena_plans_ = false;
+
+  // Maximum number of nodes to run concurrently, see `SetNumInterOpThreads`.
+  int num_inter_op_threads_ = 0;
+
+  // Execution plan indices of the nodes in each inter-op step. Empty unless an
+  // inter-op schedule is in use.
+  std::vector<std::vector<int>> inter_op_steps_;
+
+  // Inter-op step of each execution plan index, reported to the memory
+  // planner through GraphInfo::execution_step().
+  std::vector<int> execution_steps_;
+
+  // Threads and per-thread state for running the nodes of a step.
+  std::unique_ptr<ruy::ThreadPool> inter_op_thread_pool_;
+  std::vector<std::unique_ptr<InterOpWorker>> inter_op_workers_;
 };
 
 }  // namespace tflite
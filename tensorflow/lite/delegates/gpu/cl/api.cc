@@ -550,6 +550,25 @@ class InferenceRunnerImpl : public CLInferenceRunner {
     return absl::OkStatus();
   }
 
+  absl::Status RunAsync(CLEvent* event) override {
+#ifdef CL_DELEGATE_ALLOW_GL
+    if (gl_interop_fabric_) {
+      return absl::UnimplementedError(
+          "RunAsync is not supported with GL interop.");
+    }
+#endif
+    for (const auto& input : inputs_) {
+      RETURN_IF_ERROR(input->CopyFromExternalObject());
+    }
+    RETURN_IF_ERROR(context_->AddToQueue(queue_));
+    for (const auto& output : outputs_) {
+      RETURN_IF_ERROR(output->CopyToExternalObject());
+    }
+    RETURN_IF_ERROR(queue_->EnqueueEvent(event));
+    clFlush(queue_->queue());
+    return absl::OkStatus();
+  }
+
   absl::Status RunWithoutExternalBufferCopy() override {
     RETURN_IF_ERROR(context_->AddToQueue(queue_));
     clFlush(queue_->queue());
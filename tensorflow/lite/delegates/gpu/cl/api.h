@@ -27,6 +27,7 @@ limitations under the License.
 
 #include "absl/types/span.h"
 #include "tensorflow/lite/delegates/gpu/api.h"
+#include "tensorflow/lite/delegates/gpu/cl/cl_event.h"
 #include "tensorflow/lite/delegates/gpu/common/model.h"
 #include "tensorflow/lite/delegates/gpu/common/status.h"
 
@@ -166,6 +167,16 @@ class CLInferenceRunner : public ::tflite::gpu::InferenceRunner {
   // is expected to hold a copy of the queue and wait for completion if the
   // external buffer is a CPU buffer.
   virtual absl::Status CopyToExternalOutput(int index) = 0;
+
+  // Same as Run, but doesn't wait for the GPU to finish. Input uploads, the
+  // inference itself and output downloads are only queued, and `event` is set
+  // to a marker that completes once all of them are done.
+  // External CPU objects must not be modified or read until `event`
+  // completes. Bind a different set of objects with SetInputObject and
+  // SetOutputObject to prepare the next frame in the meantime, see
+  // DoubleBufferedRunner.
+  // GL interop is not supported by this call.
+  virtual absl::Status RunAsync(CLEvent* event) = 0;
 };
 
 }  // namespace cl
@@ -0,0 +1,134 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/cl/double_buffered_runner.h"
+
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/lite/delegates/gpu/common/data_type.h"
+
+namespace tflite {
+namespace gpu {
+namespace cl {
+namespace {
+
+absl::Status AllocateBuffers(const std::vector<TensorObjectDef>& defs,
+                             std::vector<std::vector<uint8_t>>* buffers) {
+  buffers->resize(defs.size());
+  for (int i = 0; i < defs.size(); ++i) {
+    const ObjectDef& object_def = defs[i].object_def;
+    if (object_def.object_type != ObjectType::CPU_MEMORY ||
+        !object_def.user_provided) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Tensor ", i, " must be a user provided CPU_MEMORY object."));
+    }
+    (*buffers)[i].resize(NumElements(defs[i]) *
+                         SizeOf(object_def.data_type));
+  }
+  return absl::OkStatus();
+}
+
+CpuMemory ToCpuMemory(std::vector<uint8_t>* buffer) {
+  return CpuMemory{buffer->data(), buffer->size()};
+}
+
+}  // namespace
+
+absl::Status DoubleBufferedRunner::Create(
+    CLInferenceRunner* runner, std::unique_ptr<DoubleBufferedRunner>* result) {
+  std::unique_ptr<DoubleBufferedRunner> pipeline(
+      new DoubleBufferedRunner(runner));
+  for (Slot& slot : pipeline->slots_) {
+    RETURN_IF_ERROR(AllocateBuffers(runner->inputs(), &slot.inputs));
+    RETURN_IF_ERROR(AllocateBuffers(runner->outputs(), &slot.outputs));
+  }
+  *result = std::move(pipeline);
+  return absl::OkStatus();
+}
+
+absl::Status DoubleBufferedRunner::GetNextInput(int index, CpuMemory* memory) {
+  Slot& slot = slots_[next_slot_];
+  if (index < 0 || index >= slot.inputs.size()) {
+    return absl::OutOfRangeError("Input index is out of range");
+  }
+  WaitForSlot(next_slot_);
+  *memory = ToCpuMemory(&slot.inputs[index]);
+  return absl::OkStatus();
+}
+
+absl::Status DoubleBufferedRunner::Submit() {
+  WaitForSlot(next_slot_);
+  Slot& slot = slots_[next_slot_];
+  for (int i = 0; i < slot.inputs.size(); ++i) {
+    RETURN_IF_ERROR(runner_->SetInputObject(i, ToCpuMemory(&slot.inputs[i])));
+  }
+  for (int i = 0; i < slot.outputs.size(); ++i) {
+    RETURN_IF_ERROR(
+        runner_->SetOutputObject(i, ToCpuMemory(&slot.outputs[i])));
+  }
+  RETURN_IF_ERROR(runner_->RunAsync(&slot.done));
+  slot.in_flight = true;
+  if (completed_slot_ == next_slot_) {
+    completed_slot_ = -1;
+  }
+  next_slot_ = (next_slot_ + 1) % kNumSlots;
+  return absl::OkStatus();
+}
+
+absl::Status DoubleBufferedRunner::WaitForOldestFrame() {
+  // Slots are used round-robin, so the oldest in-flight frame is the first
+  // in-flight slot starting from the one that will be submitted next.
+  for (int i = 0; i < kNumSlots; ++i) {
+    const int slot = (next_slot_ + i) % kNumSlots;
+    if (slots_[slot].in_flight) {
+      WaitForSlot(slot);
+      completed_slot_ = slot;
+      return absl::OkStatus();
+    }
+  }
+  return absl::FailedPreconditionError("No frame is in flight.");
+}
+
+absl::Status DoubleBufferedRunner::GetCompletedOutput(int index,
+                                                      CpuMemory* memory) {
+  if (completed_slot_ < 0) {
+    return absl::FailedPreconditionError("No completed frame is available.");
+  }
+  Slot& slot = slots_[completed_slot_];
+  if (index < 0 || index >= slot.outputs.size()) {
+    return absl::OutOfRangeError("Output index is out of range");
+  }
+  *memory = ToCpuMemory(&slot.outputs[index]);
+  return absl::OkStatus();
+}
+
+int DoubleBufferedRunner::num_in_flight() const {
+  int count = 0;
+  for (const Slot& slot : slots_) {
+    if (slot.in_flight) ++count;
+  }
+  return count;
+}
+
+void DoubleBufferedRunner::WaitForSlot(int slot) {
+  if (!slots_[slot].in_flight) return;
+  slots_[slot].done.Wait();
+  slots_[slot].in_flight = false;
+}
+
+}  // namespace cl
+}  // namespace gpu
+}  // namespace tflite
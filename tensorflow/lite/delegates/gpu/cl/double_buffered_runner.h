@@ -0,0 +1,106 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_DELEGATES_GPU_CL_DOUBLE_BUFFERED_RUNNER_H_
+#define TENSORFLOW_LITE_DELEGATES_GPU_CL_DOUBLE_BUFFERED_RUNNER_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/lite/delegates/gpu/api.h"
+#include "tensorflow/lite/delegates/gpu/cl/api.h"
+#include "tensorflow/lite/delegates/gpu/cl/cl_event.h"
+#include "tensorflow/lite/delegates/gpu/common/status.h"
+
+namespace tflite {
+namespace gpu {
+namespace cl {
+
+// Pipelines frames through a CLInferenceRunner by alternating between two sets
+// of CPU input and output buffers, so that the caller can prepare frame N+1
+// while the GPU still processes frame N.
+//
+// Usage example:
+//
+//   std::unique_ptr<DoubleBufferedRunner> pipeline;
+//   RETURN_IF_ERROR(DoubleBufferedRunner::Create(runner, &pipeline));
+//   while (HasFrames()) {
+//     CpuMemory input;
+//     RETURN_IF_ERROR(pipeline->GetNextInput(0, &input));
+//     Preprocess(input);
+//     RETURN_IF_ERROR(pipeline->Submit());
+//     if (pipeline->num_in_flight() == 2) {
+//       RETURN_IF_ERROR(pipeline->WaitForOldestFrame());
+//       CpuMemory output;
+//       RETURN_IF_ERROR(pipeline->GetCompletedOutput(0, &output));
+//       Postprocess(output);
+//     }
+//   }
+//
+// The runner must be built with user provided CPU_MEMORY inputs and outputs.
+// All commands go through the single in-order queue of the environment, so
+// GPU side uploading of frame N+1 still happens after frame N is computed;
+// the overlap is between the CPU and the GPU.
+class DoubleBufferedRunner {
+ public:
+  static absl::Status Create(CLInferenceRunner* runner,
+                             std::unique_ptr<DoubleBufferedRunner>* result);
+
+  // Returns the buffer for input `index` of the next frame to be submitted.
+  // Blocks until the frame that previously used this buffer has completed.
+  absl::Status GetNextInput(int index, CpuMemory* memory);
+
+  // Queues the next frame on the GPU and returns without waiting for it.
+  absl::Status Submit();
+
+  // Blocks until the oldest in-flight frame completes. Its outputs are then
+  // available through GetCompletedOutput until its buffers are submitted
+  // again, i.e. at most until the next Submit call.
+  absl::Status WaitForOldestFrame();
+
+  // Returns output `index` of the frame completed by the last
+  // WaitForOldestFrame call.
+  absl::Status GetCompletedOutput(int index, CpuMemory* memory);
+
+  int num_in_flight() const;
+
+ private:
+  static constexpr int kNumSlots = 2;
+
+  struct Slot {
+    std::vector<std::vector<uint8_t>> inputs;
+    std::vector<std::vector<uint8_t>> outputs;
+    CLEvent done;
+    bool in_flight = false;
+  };
+
+  explicit DoubleBufferedRunner(CLInferenceRunner* runner) : runner_(runner) {}
+
+  void WaitForSlot(int slot);
+
+  CLInferenceRunner* runner_;
+  Slot slots_[kNumSlots];
+  // Slot used by the next Submit call.
+  int next_slot_ = 0;
+  // Slot whose outputs were returned by the last WaitForOldestFrame call.
+  int completed_slot_ = -1;
+};
+
+}  // namespace cl
+}  // namespace gpu
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_GPU_CL_DOUBLE_BUFFERED_RUNNER_H_
@@ -0,0 +1,190 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/delegates/nnapi/nnapi_partition_calibration.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/delegates/serialization.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/profiling/time.h"
+
+namespace tflite {
+namespace {
+
+constexpr char kCalibrationId[] = "nnapi_partition_calibration_";
+
+// Returns a key unique to the accelerator that the calibration is for.
+std::string CalibrationKey(const StatefulNnApiDelegate::Options& options) {
+  std::string key = kCalibrationId;
+  if (options.accelerator_name) {
+    key += options.accelerator_name;
+  }
+  return key;
+}
+
+// Builds an interpreter for `model`, applies `delegate` if it is not null and
+// zero-fills the inputs.
+TfLiteStatus BuildInterpreter(const FlatBufferModel& model,
+                              const OpResolver& op_resolver, int num_threads,
+                              TfLiteDelegate* delegate,
+                              std::unique_ptr<Interpreter>* interpreter) {
+  if (InterpreterBuilder(model, op_resolver)(interpreter, num_threads) !=
+          kTfLiteOk ||
+      *interpreter == nullptr) {
+    return kTfLiteError;
+  }
+  if (delegate != nullptr) {
+    TF_LITE_ENSURE_STATUS((*interpreter)->ModifyGraphWithDelegate(delegate));
+  }
+  TF_LITE_ENSURE_STATUS((*interpreter)->AllocateTensors());
+  for (int input : (*interpreter)->inputs()) {
+    TfLiteTensor* tensor = (*interpreter)->tensor(input);
+    if (tensor->type != kTfLiteString && tensor->data.raw != nullptr) {
+      std::memset(tensor->data.raw, 0, tensor->bytes);
+    }
+  }
+  return kTfLiteOk;
+}
+
+// Returns the number of nodes of the execution plan that `delegate` replaced.
+int CountDelegatedPartitions(const Interpreter& interpreter,
+                             const TfLiteDelegate* delegate) {
+  int num_partitions = 0;
+  for (int node_index : interpreter.execution_plan()) {
+    const auto* node_and_registration =
+        interpreter.node_and_registration(node_index);
+    if (node_and_registration->first.delegate == delegate) ++num_partitions;
+  }
+  return num_partitions;
+}
+
+// Returns the median latency of Invoke() in microseconds.
+TfLiteStatus MeasureLatency(Interpreter* interpreter,
+                            const NnApiPartitionCalibrationOptions& options,
+                            uint64_t* latency_us) {
+  for (int i = 0; i < options.num_warmup_runs; ++i) {
+    TF_LITE_ENSURE_STATUS(interpreter->Invoke());
+  }
+  std::vector<uint64_t> latencies;
+  latencies.reserve(std::max(options.num_timed_runs, 1));
+  for (int i = 0; i < std::max(options.num_timed_runs, 1); ++i) {
+    const uint64_t start_us = profiling::time::NowMicros();
+    TF_LITE_ENSURE_STATUS(interpreter->Invoke());
+    latencies.push_back(profiling::time::NowMicros() - start_us);
+  }
+  std::nth_element(latencies.begin(), latencies.begin() + latencies.size() / 2,
+                   latencies.end());
+  *latency_us = latencies[latencies.size() / 2];
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+TfLiteStatus CalibrateNnApiDelegatePartitions(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    const StatefulNnApiDelegate::Options& delegate_options,
+    const NnApiPartitionCalibrationOptions& calibration_options,
+    int* num_delegated_partitions, const NnApi* nnapi) {
+  std::unique_ptr<Interpreter> cpu_interpreter;
+  TF_LITE_ENSURE_STATUS(BuildInterpreter(model, op_resolver,
+                                         calibration_options.num_threads,
+                                         /*delegate=*/nullptr,
+                                         &cpu_interpreter));
+  // The context of the undelegated graph fingerprints the model in the cache.
+  TfLiteContext* context = cpu_interpreter->primary_subgraph().context();
+  std::unique_ptr<delegates::Serialization> cache;
+  if (delegate_options.cache_dir && delegate_options.model_token) {
+    cache.reset(new delegates::Serialization(
+        {delegate_options.model_token, delegate_options.cache_dir}));
+    std::string data;
+    if (cache->GetEntryForDelegate(CalibrationKey(delegate_options), context)
+                .GetData(context, &data) == kTfLiteOk &&
+        data.size() == sizeof(int32_t)) {
+      int32_t cached_partitions;
+      std::memcpy(&cached_partitions, data.data(), sizeof(int32_t));
+      *num_delegated_partitions = cached_partitions;
+      return kTfLiteOk;
+    }
+  }
+
+  uint64_t best_latency_us;
+  TF_LITE_ENSURE_STATUS(MeasureLatency(cpu_interpreter.get(),
+                                       calibration_options, &best_latency_us));
+  TFLITE_LOG_PROD(TFLITE_LOG_INFO,
+                  "NNAPI partition calibration: %llu us without NNAPI.",
+                  static_cast<unsigned long long>(best_latency_us));
+  int best_partitions = 0;
+
+  // Measures the candidates from the most delegated partitions down, since
+  // the delegate only reports how many partitions there are once applied.
+  // Each candidate keeps its largest partitions.
+  StatefulNnApiDelegate::Options options = delegate_options;
+  options.cache_dir = nullptr;
+  options.model_token = nullptr;
+  options.max_number_delegated_partitions =
+      std::max(calibration_options.max_candidate_partitions, 0);
+  while (true) {
+    StatefulNnApiDelegate delegate(nnapi, options);
+    std::unique_ptr<Interpreter> interpreter;
+    if (BuildInterpreter(model, op_resolver, calibration_options.num_threads,
+                         &delegate, &interpreter) != kTfLiteOk) {
+      TFLITE_LOG_PROD(TFLITE_LOG_WARNING,
+                      "NNAPI partition calibration: could not apply the "
+                      "delegate with at most %d partitions.",
+                      options.max_number_delegated_partitions);
+      break;
+    }
+    const int num_partitions =
+        CountDelegatedPartitions(*interpreter, &delegate);
+    if (num_partitions == 0) break;
+    uint64_t latency_us;
+    if (MeasureLatency(interpreter.get(), calibration_options, &latency_us) ==
+        kTfLiteOk) {
+      TFLITE_LOG_PROD(TFLITE_LOG_INFO,
+                      "NNAPI partition calibration: %llu us with %d "
+                      "partitions.",
+                      static_cast<unsigned long long>(latency_us),
+                      num_partitions);
+      if (latency_us < best_latency_us) {
+        best_latency_us = latency_us;
+        best_partitions = num_partitions;
+      }
+    }
+    if (num_partitions == 1) break;
+    options.max_number_delegated_partitions = num_partitions - 1;
+  }
+  *num_delegated_partitions = best_partitions;
+
+  if (cache) {
+    const int32_t data = best_partitions;
+    if (cache->GetEntryForDelegate(CalibrationKey(delegate_options), context)
+            .SetData(context, reinterpret_cast<const char*>(&data),
+                     sizeof(data)) != kTfLiteOk) {
+      // Not a critical error.
+      TFLITE_LOG_PROD(TFLITE_LOG_WARNING,
+                      "Could not save the NNAPI partition calibration.");
+    }
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
@@ -0,0 +1,61 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_DELEGATES_NNAPI_NNAPI_PARTITION_CALIBRATION_H_
+#define TENSORFLOW_LITE_DELEGATES_NNAPI_NNAPI_PARTITION_CALIBRATION_H_
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/nnapi/nnapi_implementation.h"
+
+namespace tflite {
+
+// Options for CalibrateNnApiDelegatePartitions.
+struct NnApiPartitionCalibrationOptions {
+  // The number of invocations of each candidate before it is measured.
+  int num_warmup_runs = 1;
+  // The number of measured invocations of each candidate, whose median
+  // latency is compared.
+  int num_timed_runs = 10;
+  // The most partitions to delegate. A value <= 0 means no limit.
+  int max_candidate_partitions = 0;
+  // The number of CPU threads of the interpreters, -1 for the default.
+  int num_threads = -1;
+};
+
+// Measures the end-to-end latency of `model` on this device without NNAPI and
+// with the NNAPI delegate accelerating its N largest partitions, for every N up
+// to the number of partitions the delegate supports. Returns the fastest N in
+// `num_delegated_partitions`, 0 meaning that the model runs faster without
+// NNAPI. Partition transitions often make delegating small partitions slower
+// than running them on the CPU.
+//
+// Apply the result with `max_number_delegated_partitions = N` in the options
+// of the delegate, or do not apply the delegate if N is 0.
+//
+// If `delegate_options` has a cache_dir and a model_token, the result is saved
+// alongside the NNAPI compilation cache, and later calls return it without
+// measuring again. The candidates are measured with zero-filled inputs and
+// without compilation caching.
+TfLiteStatus CalibrateNnApiDelegatePartitions(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    const StatefulNnApiDelegate::Options& delegate_options,
+    const NnApiPartitionCalibrationOptions& calibration_options,
+    int* num_delegated_partitions, const NnApi* nnapi = NnApiImplementation());
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_NNAPI_NNAPI_PARTITION_CALIBRATION_H_
@@ -0,0 +1,93 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/delegates/nnapi/nnapi_partition_calibration.h"
+
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
+#include "tensorflow/lite/delegates/nnapi/nnapi_delegate_mock_test.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/nnapi/NeuralNetworksTypes.h"
+
+namespace tflite {
+namespace {
+
+class NnApiPartitionCalibrationTest
+    : public ::tflite::delegate::nnapi::NnApiDelegateMockTest {
+ protected:
+  void SetUp() override {
+    ::tflite::delegate::nnapi::NnApiDelegateMockTest::SetUp();
+    nnapi_mock_->GetDeviceCountReturnsCount<2>();
+    model_ = FlatBufferModel::BuildFromFile("tensorflow/lite/testdata/add.bin");
+    ASSERT_NE(model_, nullptr);
+    options_.disallow_nnapi_cpu = false;
+    calibration_options_.num_timed_runs = 3;
+  }
+
+  std::unique_ptr<FlatBufferModel> model_;
+  ops::builtin::BuiltinOpResolver resolver_;
+  StatefulNnApiDelegate::Options options_;
+  NnApiPartitionCalibrationOptions calibration_options_;
+};
+
+TEST_F(NnApiPartitionCalibrationTest, PicksAPartitionCount) {
+  int num_partitions = -1;
+  ASSERT_EQ(CalibrateNnApiDelegatePartitions(
+                *model_, resolver_, options_, calibration_options_,
+                &num_partitions, nnapi_mock_->GetNnApi()),
+            kTfLiteOk);
+  EXPECT_GE(num_partitions, 0);
+  EXPECT_LE(num_partitions, 1);
+}
+
+TEST_F(NnApiPartitionCalibrationTest, SkipsFailingNnApiExecution) {
+  nnapi_mock_->ExecutionComputeReturns<ANEURALNETWORKS_OP_FAILED>();
+  nnapi_mock_->ExecutionStartComputeReturns<ANEURALNETWORKS_OP_FAILED>();
+  int num_partitions = -1;
+  ASSERT_EQ(CalibrateNnApiDelegatePartitions(
+                *model_, resolver_, options_, calibration_options_,
+                &num_partitions, nnapi_mock_->GetNnApi()),
+            kTfLiteOk);
+  EXPECT_EQ(num_partitions, 0);
+}
+
+TEST_F(NnApiPartitionCalibrationTest, ReusesSavedCalibration) {
+  const std::string cache_dir = ::testing::TempDir();
+  options_.cache_dir = cache_dir.c_str();
+  options_.model_token = "nnapi_partition_calibration_test";
+  int num_partitions = -1;
+  ASSERT_EQ(CalibrateNnApiDelegatePartitions(
+                *model_, resolver_, options_, calibration_options_,
+                &num_partitions, nnapi_mock_->GetNnApi()),
+            kTfLiteOk);
+
+  // The second calibration does not build an NNAPI model.
+  nnapi_mock_->StubModelCreateWith([](ANeuralNetworksModel** model) -> int {
+    ADD_FAILURE() << "Should not build an NNAPI model";
+    return ANEURALNETWORKS_OP_FAILED;
+  });
+  int cached_num_partitions = -1;
+  ASSERT_EQ(CalibrateNnApiDelegatePartitions(
+                *model_, resolver_, options_, calibration_options_,
+                &cached_num_partitions, nnapi_mock_->GetNnApi()),
+            kTfLiteOk);
+  EXPECT_EQ(cached_num_partitions, num_partitions);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -0,0 +1,132 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/batching/batch_invoker.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace experimental {
+
+BatchInvoker::BatchInvoker(Interpreter* interpreter, const Options& options)
+    : interpreter_(interpreter), options_(options) {}
+
+TfLiteStatus BatchInvoker::Init() {
+  ErrorReporter* error_reporter = interpreter_->error_reporter();
+  if (options_.max_batch_size < 1) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Invalid max_batch_size %d.",
+                         options_.max_batch_size);
+    return kTfLiteError;
+  }
+  for (const int tensor_index : interpreter_->inputs()) {
+    const TfLiteTensor* tensor = interpreter_->tensor(tensor_index);
+    if (tensor->dims->size < 1 || tensor->type == kTfLiteString) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Input '%s' can't be batched, it needs a batch "
+                           "dimension and a fixed size type.",
+                           tensor->name);
+      return kTfLiteError;
+    }
+    const int* dims = tensor->dims->data;
+    per_request_input_dims_.emplace_back(dims + 1, dims + tensor->dims->size);
+    BatchedTensor input;
+    input.tensor_index = tensor_index;
+    inputs_.push_back(std::move(input));
+  }
+  TF_LITE_ENSURE_STATUS(SetBatchSize(options_.max_batch_size));
+
+  // Shapes are now at their largest, size the buffers for them.
+  for (BatchedTensor& input : inputs_) {
+    TF_LITE_ENSURE_STATUS(AllocateBuffer(&input));
+  }
+  for (const int tensor_index : interpreter_->outputs()) {
+    BatchedTensor output;
+    output.tensor_index = tensor_index;
+    TF_LITE_ENSURE_STATUS(AllocateBuffer(&output));
+    outputs_.push_back(std::move(output));
+  }
+  return interpreter_->AllocateTensors();
+}
+
+int BatchInvoker::AddRequest() {
+  if (num_requests_ == options_.max_batch_size) return -1;
+  return num_requests_++;
+}
+
+void* BatchInvoker::input_data(int slot, int input_index) {
+  const BatchedTensor& input = inputs_[input_index];
+  return input.data + slot * input.bytes_per_request;
+}
+
+const void* BatchInvoker::output_data(int slot, int output_index) const {
+  const BatchedTensor& output = outputs_[output_index];
+  return output.data + slot * output.bytes_per_request;
+}
+
+TfLiteStatus BatchInvoker::Invoke() {
+  if (num_requests_ == 0) return kTfLiteOk;
+  const int batch_size =
+      options_.pad_partial_batches ? options_.max_batch_size : num_requests_;
+  if (batch_size != batch_size_) {
+    TF_LITE_ENSURE_STATUS(SetBatchSize(batch_size));
+  }
+  return interpreter_->Invoke();
+}
+
+TfLiteStatus BatchInvoker::AllocateBuffer(BatchedTensor* batched_tensor) {
+  const TfLiteTensor* tensor =
+      interpreter_->tensor(batched_tensor->tensor_index);
+  if (tensor->allocation_type != kTfLiteArenaRw ||
+      tensor->dims->size < 1 ||
+      tensor->dims->data[0] != options_.max_batch_size) {
+    TF_LITE_REPORT_ERROR(interpreter_->error_reporter(),
+                         "Tensor '%s' can't be batched, it needs a static "
+                         "shape with the batch size as first dimension.",
+                         tensor->name);
+    return kTfLiteError;
+  }
+  const size_t bytes = tensor->bytes;
+  batched_tensor->bytes_per_request = bytes / options_.max_batch_size;
+  batched_tensor->buffer.reset(new char[bytes + kDefaultTensorAlignment]);
+  const std::uintptr_t address =
+      reinterpret_cast<std::uintptr_t>(batched_tensor->buffer.get());
+  batched_tensor->data = batched_tensor->buffer.get() +
+                         (kDefaultTensorAlignment -
+                          address % kDefaultTensorAlignment) %
+                             kDefaultTensorAlignment;
+  TfLiteCustomAllocation allocation = {batched_tensor->data, bytes};
+  return interpreter_->SetCustomAllocationForTensor(
+      batched_tensor->tensor_index, allocation);
+}
+
+TfLiteStatus BatchInvoker::SetBatchSize(int batch_size) {
+  const std::vector<int>& inputs = interpreter_->inputs();
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    std::vector<int> dims = {batch_size};
+    dims.insert(dims.end(), per_request_input_dims_[i].begin(),
+                per_request_input_dims_[i].end());
+    TF_LITE_ENSURE_STATUS(interpreter_->ResizeInputTensor(inputs[i], dims));
+  }
+  TF_LITE_ENSURE_STATUS(interpreter_->AllocateTensors());
+  batch_size_ = batch_size;
+  return kTfLiteOk;
+}
+
+}  // namespace experimental
+}  // namespace tflite
@@ -0,0 +1,138 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_BATCHING_BATCH_INVOKER_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_BATCHING_BATCH_INVOKER_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace tflite {
+namespace experimental {
+
+/// WARNING: Experimental interface, subject to change.
+///
+/// Runs several independent requests in one Invoke by stacking them along the
+/// first (batch) dimension of every input and output of the interpreter.
+///
+/// The input and output tensors are backed by buffers owned by the
+/// BatchInvoker, set with Interpreter::SetCustomAllocationForTensor. Each
+/// request gets a slot in them, and callers read and write their request's
+/// data in place, so gathering and scattering doesn't copy anything.
+///
+/// Usage:
+///
+/// <pre><code>
+/// BatchInvoker::Options options;
+/// options.max_batch_size = 8;
+/// BatchInvoker invoker(interpreter.get(), options);
+/// if (invoker.Init() != kTfLiteOk) {
+///   // Return failure.
+/// }
+/// for (const Request& request : requests) {
+///   int slot = invoker.AddRequest();
+///   memcpy(invoker.input_data(slot, 0), ..., invoker.input_bytes(0));
+/// }
+/// invoker.Invoke();
+/// // Read each request's result from invoker.output_data(slot, 0).
+/// invoker.Clear();
+/// </code></pre>
+///
+/// Every request must have the per-request shape of the inputs at the time
+/// Init() is called, that is their shape without the batch dimension. All
+/// outputs must have a batch dimension of the same size as the inputs.
+///
+/// Queueing requests and deciding when to run a partial batch is left to the
+/// caller, which typically knows its own latency budget.
+///
+/// WARNING: This class is *not* thread-safe, and the interpreter must only be
+/// used through it after Init().
+class BatchInvoker {
+ public:
+  struct Options {
+    // The maximum number of requests in a batch.
+    int max_batch_size = 8;
+    // If true, partial batches are run at `max_batch_size`, leaving the
+    // unused slots with stale data. This wastes some compute but never
+    // changes the tensor shapes, so the interpreter doesn't have to prepare
+    // its ops and plan its memory again. Otherwise, the inputs are resized to
+    // the number of requests when it changes. See also
+    // InterpreterOptions::CacheArenaPlans to make that cheaper.
+    bool pad_partial_batches = false;
+  };
+
+  BatchInvoker(Interpreter* interpreter, const Options& options);
+
+  // Sets up the input and output buffers for `max_batch_size` requests. Must
+  // be called once, before any other method.
+  TfLiteStatus Init();
+
+  // Reserves a slot for a request in the next batch and returns its index,
+  // or -1 if the batch is full.
+  int AddRequest();
+
+  // The number of requests added since the last Clear().
+  int num_requests() const { return num_requests_; }
+
+  // The data of input `input_index` (an index into Interpreter::inputs()) for
+  // the request in `slot`, and its size in bytes.
+  void* input_data(int slot, int input_index);
+  size_t input_bytes(int input_index) const {
+    return inputs_[input_index].bytes_per_request;
+  }
+
+  // Runs all the requests added since the last Clear().
+  TfLiteStatus Invoke();
+
+  // The data of output `output_index` (an index into Interpreter::outputs())
+  // for the request in `slot`, and its size in bytes. Valid after Invoke().
+  const void* output_data(int slot, int output_index) const;
+  size_t output_bytes(int output_index) const {
+    return outputs_[output_index].bytes_per_request;
+  }
+
+  // Releases all the slots, for the next batch.
+  void Clear() { num_requests_ = 0; }
+
+ private:
+  // The buffer backing an input or output tensor.
+  struct BatchedTensor {
+    int tensor_index = -1;
+    size_t bytes_per_request = 0;
+    std::unique_ptr<char[]> buffer;
+    // `buffer`, aligned to kDefaultTensorAlignment.
+    char* data = nullptr;
+  };
+
+  TfLiteStatus AllocateBuffer(BatchedTensor* batched_tensor);
+  TfLiteStatus SetBatchSize(int batch_size);
+
+  Interpreter* const interpreter_;
+  const Options options_;
+  std::vector<BatchedTensor> inputs_;
+  std::vector<BatchedTensor> outputs_;
+  // Shapes of the inputs without their batch dimension.
+  std::vector<std::vector<int>> per_request_input_dims_;
+  int batch_size_ = 0;
+  int num_requests_ = 0;
+};
+
+}  // namespace experimental
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_BATCHING_BATCH_INVOKER_H_
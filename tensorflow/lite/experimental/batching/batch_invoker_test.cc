@@ -0,0 +1,133 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/batching/batch_invoker.h"
+
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace tflite {
+namespace experimental {
+namespace {
+
+// Adds 1 to each element of a float tensor.
+TfLiteRegistration* RegisterAddOne() {
+  static TfLiteRegistration registration = {
+      nullptr, nullptr,
+      [](TfLiteContext* context, TfLiteNode* node) {
+        const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+        TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+        return context->ResizeTensor(context, output,
+                                     TfLiteIntArrayCopy(input->dims));
+      },
+      [](TfLiteContext* context, TfLiteNode* node) {
+        const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+        TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+        for (int i = 0; i < input->bytes / sizeof(float); ++i) {
+          output->data.f[i] = input->data.f[i] + 1;
+        }
+        return kTfLiteOk;
+      }};
+  return &registration;
+}
+
+class BatchInvokerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(interpreter_.AddTensors(2), kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetInputs({0}), kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetOutputs({1}), kTfLiteOk);
+    TfLiteQuantizationParams quant;
+    interpreter_.SetTensorParametersReadWrite(0, kTfLiteFloat32, "input",
+                                              {1, 3}, quant);
+    interpreter_.SetTensorParametersReadWrite(1, kTfLiteFloat32, "output",
+                                              {1, 3}, quant);
+    ASSERT_EQ(interpreter_.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                                 RegisterAddOne()),
+              kTfLiteOk);
+  }
+
+  void AddRequests(BatchInvoker* invoker, int count) {
+    for (int i = 0; i < count; ++i) {
+      const int slot = invoker->AddRequest();
+      ASSERT_EQ(slot, i);
+      const float values[3] = {10.f * i, 10.f * i + 1, 10.f * i + 2};
+      ASSERT_EQ(invoker->input_bytes(0), sizeof(values));
+      std::memcpy(invoker->input_data(slot, 0), values, sizeof(values));
+    }
+  }
+
+  void ExpectOutputs(const BatchInvoker& invoker, int count) {
+    for (int i = 0; i < count; ++i) {
+      const float* output =
+          static_cast<const float*>(invoker.output_data(i, 0));
+      EXPECT_EQ(output[0], 10.f * i + 1);
+      EXPECT_EQ(output[1], 10.f * i + 2);
+      EXPECT_EQ(output[2], 10.f * i + 3);
+    }
+  }
+
+  Interpreter interpreter_;
+};
+
+TEST_F(BatchInvokerTest, RunsRequestsInPlace) {
+  BatchInvoker::Options options;
+  options.max_batch_size = 4;
+  BatchInvoker invoker(&interpreter_, options);
+  ASSERT_EQ(invoker.Init(), kTfLiteOk);
+
+  AddRequests(&invoker, 3);
+  ASSERT_EQ(invoker.Invoke(), kTfLiteOk);
+  EXPECT_EQ(interpreter_.tensor(0)->dims->data[0], 3);
+  ExpectOutputs(invoker, 3);
+  // The tensors use the request buffers.
+  EXPECT_EQ(interpreter_.tensor(0)->data.raw, invoker.input_data(0, 0));
+  EXPECT_EQ(interpreter_.tensor(1)->data.raw, invoker.output_data(0, 0));
+
+  invoker.Clear();
+  AddRequests(&invoker, 4);
+  EXPECT_EQ(invoker.AddRequest(), -1);
+  ASSERT_EQ(invoker.Invoke(), kTfLiteOk);
+  EXPECT_EQ(interpreter_.tensor(0)->dims->data[0], 4);
+  ExpectOutputs(invoker, 4);
+}
+
+TEST_F(BatchInvokerTest, PadsPartialBatches) {
+  BatchInvoker::Options options;
+  options.max_batch_size = 4;
+  options.pad_partial_batches = true;
+  BatchInvoker invoker(&interpreter_, options);
+  ASSERT_EQ(invoker.Init(), kTfLiteOk);
+
+  AddRequests(&invoker, 2);
+  ASSERT_EQ(invoker.Invoke(), kTfLiteOk);
+  EXPECT_EQ(interpreter_.tensor(0)->dims->data[0], 4);
+  ExpectOutputs(invoker, 2);
+}
+
+TEST_F(BatchInvokerTest, RejectsInvalidBatchSize) {
+  BatchInvoker::Options options;
+  options.max_batch_size = 0;
+  BatchInvoker invoker(&interpreter_, options);
+  EXPECT_EQ(invoker.Init(), kTfLiteError);
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace tflite
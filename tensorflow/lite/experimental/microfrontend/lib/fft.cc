@@ -16,6 +16,11 @@ limitations under the License.
 
 #include <string.h>
 
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define MICROFRONTEND_USE_NEON
+#include <arm_neon.h>
+#endif
+
 #define FIXED_POINT 16
 #include "kiss_fft.h"
 #include "tools/kiss_fftr.h"
@@ -27,8 +32,14 @@ void FftCompute(struct FftState* state, const int16_t* input,
 
   int16_t* fft_input = state->input;
   // First, scale the input by the given shift.
-  size_t i;
-  for (i = 0; i < input_size; ++i) {
+  size_t i = 0;
+#ifdef MICROFRONTEND_USE_NEON
+  const int16x8_t shift = vdupq_n_s16(input_scale_shift);
+  for (; i + 8 <= input_size; i += 8) {
+    vst1q_s16(fft_input + i, vshlq_s16(vld1q_s16(input + i), shift));
+  }
+#endif
+  for (; i < input_size; ++i) {
     fft_input[i] = static_cast<int16_t>(static_cast<uint16_t>(input[i])
                                         << input_scale_shift);
   }
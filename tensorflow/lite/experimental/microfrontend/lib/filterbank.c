@@ -18,6 +18,11 @@ limitations under the License.
 
 #include "tensorflow/lite/experimental/microfrontend/lib/bits.h"
 
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define MICROFRONTEND_USE_NEON
+#include <arm_neon.h>
+#endif
+
 void FilterbankConvertFftComplexToEnergy(struct FilterbankState* state,
                                          struct complex_int16_t* fft_output,
                                          int32_t* energy) {
@@ -25,7 +30,20 @@ void FilterbankConvertFftComplexToEnergy(struct FilterbankState* state,
   int i;
   energy += state->start_index;
   fft_output += state->start_index;
-  for (i = state->start_index; i < end_index; ++i) {
+  i = state->start_index;
+#ifdef MICROFRONTEND_USE_NEON
+  // Each energy overwrites the complex value it is computed from, so the
+  // values are read before they are overwritten.
+  for (; i + 4 <= end_index; i += 4) {
+    const int16x4x2_t values = vld2_s16((const int16_t*)fft_output);
+    int32x4_t mag_squared = vmull_s16(values.val[0], values.val[0]);
+    mag_squared = vmlal_s16(mag_squared, values.val[1], values.val[1]);
+    vst1q_s32(energy, mag_squared);
+    fft_output += 4;
+    energy += 4;
+  }
+#endif
+  for (; i < end_index; ++i) {
     const int32_t real = fft_output->real;
     const int32_t imag = fft_output->imag;
     fft_output++;
@@ -51,8 +69,38 @@ void FilterbankAccumulateChannels(struct FilterbankState* state,
     const int16_t* weights = state->weights + *channel_weight_starts;
     const int16_t* unweights = state->unweights + *channel_weight_starts++;
     const int width = *channel_widths++;
-    int j;
-    for (j = 0; j < width; ++j) {
+    int j = 0;
+#ifdef MICROFRONTEND_USE_NEON
+    // The weights are non-negative, and the sums wrap around the same way as
+    // the scalar ones.
+    if (width >= 4) {
+      uint64x2_t weight_sums = vdupq_n_u64(0);
+      uint64x2_t unweight_sums = vdupq_n_u64(0);
+      for (; j + 4 <= width; j += 4) {
+        const uint32x4_t mags = vld1q_u32((const uint32_t*)magnitudes);
+        const uint32x4_t w =
+            vmovl_u16(vreinterpret_u16_s16(vld1_s16(weights)));
+        const uint32x4_t u =
+            vmovl_u16(vreinterpret_u16_s16(vld1_s16(unweights)));
+        weight_sums =
+            vmlal_u32(weight_sums, vget_low_u32(w), vget_low_u32(mags));
+        weight_sums =
+            vmlal_u32(weight_sums, vget_high_u32(w), vget_high_u32(mags));
+        unweight_sums =
+            vmlal_u32(unweight_sums, vget_low_u32(u), vget_low_u32(mags));
+        unweight_sums =
+            vmlal_u32(unweight_sums, vget_high_u32(u), vget_high_u32(mags));
+        weights += 4;
+        unweights += 4;
+        magnitudes += 4;
+      }
+      weight_accumulator +=
+          vgetq_lane_u64(weight_sums, 0) + vgetq_lane_u64(weight_sums, 1);
+      unweight_accumulator +=
+          vgetq_lane_u64(unweight_sums, 0) + vgetq_lane_u64(unweight_sums, 1);
+    }
+#endif
+    for (; j < width; ++j) {
       weight_accumulator += *weights++ * ((uint64_t)*magnitudes);
       unweight_accumulator += *unweights++ * ((uint64_t)*magnitudes);
       ++magnitudes;
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/experimental/microfrontend/lib/frontend.h"
 
+#include <string.h>
+
 #include "tensorflow/lite/experimental/microfrontend/lib/bits.h"
 
 struct FrontendOutput FrontendProcessSamples(struct FrontendState* state,
@@ -64,6 +66,35 @@ struct FrontendOutput FrontendProcessSamples(struct FrontendState* state,
   return output;
 }
 
+size_t FrontendProcessSampleRing(struct FrontendState* state,
+                                 struct FrontendSampleRing* input,
+                                 struct FrontendFeatureRing* output) {
+  size_t num_features = 0;
+  // Every call of FrontendProcessSamples generates at most one feature vector,
+  // so it is only called while there is room for one.
+  while (input->write_index != input->read_index &&
+         output->write_index - output->read_index < output->capacity) {
+    // Process the samples up to the end of the ring, or of the available ones.
+    const size_t offset = input->read_index % input->capacity;
+    size_t num_samples = input->write_index - input->read_index;
+    if (num_samples > input->capacity - offset) {
+      num_samples = input->capacity - offset;
+    }
+    size_t num_samples_read;
+    struct FrontendOutput frame = FrontendProcessSamples(
+        state, input->samples + offset, num_samples, &num_samples_read);
+    input->read_index += num_samples_read;
+    if (frame.values != NULL) {
+      memcpy(output->features +
+                 (output->write_index % output->capacity) * frame.size,
+             frame.values, frame.size * sizeof(*frame.values));
+      ++output->write_index;
+      ++num_features;
+    }
+  }
+  return num_features;
+}
+
 void FrontendReset(struct FrontendState* state) {
   WindowReset(&state->window);
   FftReset(&state->fft);
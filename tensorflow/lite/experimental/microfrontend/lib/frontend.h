@@ -55,6 +55,36 @@ struct FrontendOutput FrontendProcessSamples(struct FrontendState* state,
                                              size_t num_samples,
                                              size_t* num_samples_read);
 
+// A caller-owned ring buffer of audio samples. The caller appends samples at
+// write_index and the frontend consumes them from read_index. Both indices
+// only grow, and are taken modulo capacity to address the samples.
+struct FrontendSampleRing {
+  int16_t* samples;
+  size_t capacity;
+  size_t read_index;
+  size_t write_index;
+};
+
+// A caller-owned ring buffer of feature vectors, each of
+// filterbank.num_channels values. The frontend appends feature vectors at
+// write_index and the caller consumes them from read_index. Both indices only
+// grow, and are taken modulo capacity (in feature vectors).
+struct FrontendFeatureRing {
+  uint16_t* features;
+  size_t capacity;
+  size_t read_index;
+  size_t write_index;
+};
+
+// Streaming entry point: processes the samples available in `input` and
+// appends every feature vector they generate to `output`, stopping early if
+// `output` is full. Returns the number of feature vectors appended. Nothing is
+// allocated, so it is suitable to call for every block of captured audio. The
+// rings must not be modified concurrently with this call.
+size_t FrontendProcessSampleRing(struct FrontendState* state,
+                                 struct FrontendSampleRing* input,
+                                 struct FrontendFeatureRing* output);
+
 void FrontendReset(struct FrontendState* state);
 
 #ifdef __cplusplus
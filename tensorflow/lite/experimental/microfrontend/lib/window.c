@@ -16,6 +16,11 @@ limitations under the License.
 
 #include <string.h>
 
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define MICROFRONTEND_USE_NEON
+#include <arm_neon.h>
+#endif
+
 int WindowProcessSamples(struct WindowState* state, const int16_t* samples,
                          size_t num_samples, size_t* num_samples_read) {
   const int size = state->size;
@@ -39,9 +44,35 @@ int WindowProcessSamples(struct WindowState* state, const int16_t* samples,
   const int16_t* coefficients = state->coefficients;
   const int16_t* input = state->input;
   int16_t* output = state->output;
-  int i;
+  int i = 0;
   int16_t max_abs_output_value = 0;
-  for (i = 0; i < size; ++i) {
+#ifdef MICROFRONTEND_USE_NEON
+  if (size >= 8) {
+    int16x8_t max_abs_values = vdupq_n_s16(0);
+    for (; i + 8 <= size; i += 8) {
+      const int16x8_t values = vld1q_s16(input);
+      const int16x8_t weights = vld1q_s16(coefficients);
+      const int16x4_t low = vmovn_s32(vshrq_n_s32(
+          vmull_s16(vget_low_s16(values), vget_low_s16(weights)),
+          kFrontendWindowBits));
+      const int16x4_t high = vmovn_s32(vshrq_n_s32(
+          vmull_s16(vget_high_s16(values), vget_high_s16(weights)),
+          kFrontendWindowBits));
+      const int16x8_t new_values = vcombine_s16(low, high);
+      vst1q_s16(output, new_values);
+      max_abs_values = vmaxq_s16(max_abs_values, vabsq_s16(new_values));
+      input += 8;
+      coefficients += 8;
+      output += 8;
+    }
+    int16x4_t max_abs = vmax_s16(vget_low_s16(max_abs_values),
+                                 vget_high_s16(max_abs_values));
+    max_abs = vpmax_s16(max_abs, max_abs);
+    max_abs = vpmax_s16(max_abs, max_abs);
+    max_abs_output_value = vget_lane_s16(max_abs, 0);
+  }
+#endif
+  for (; i < size; ++i) {
     int16_t new_value =
         (((int32_t)*input++) * *coefficients++) >> kFrontendWindowBits;
     *output++ = new_value;
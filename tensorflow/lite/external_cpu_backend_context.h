@@ -22,6 +22,8 @@ limitations under the License.
 
 namespace tflite {
 
+class PackedWeightsCache;
+
 // This is the base class for TF Lite internal backend contexts (like a
 // RUY-based cpu backend context class). A derived internal backend context is
 // generally a collection of utilities (i.e. a thread pool etc.) for TF Lite to
@@ -92,9 +94,21 @@ class ExternalCpuBackendContext : public TfLiteExternalContext {
     return internal_backend_context_.get();
   }
 
+  // Sets the cache that kernels use to share packed copies of constant
+  // weights with other interpreters. May be null.
+  void set_packed_weights_cache(
+      std::shared_ptr<PackedWeightsCache> packed_weights_cache) {
+    packed_weights_cache_ = std::move(packed_weights_cache);
+  }
+
+  const std::shared_ptr<PackedWeightsCache>& packed_weights_cache() const {
+    return packed_weights_cache_;
+  }
+
  private:
   // Note the actual internal backend context object is lazily initialized.
   std::unique_ptr<TfLiteInternalBackendContext> internal_backend_context_;
+  std::shared_ptr<PackedWeightsCache> packed_weights_cache_;
 
   ExternalCpuBackendContext(const ExternalCpuBackendContext&) = delete;
   ExternalCpuBackendContext& operator=(const ExternalCpuBackendContext&) =
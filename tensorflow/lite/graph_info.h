@@ -61,6 +61,13 @@ class GraphInfo {
 
   // Returns the indices of the variable tensors.
   virtual const std::vector<int>& variables() const = 0;
+
+  // Returns the step at which the node at execution-plan index `index` runs.
+  // Nodes that share a step may run concurrently, so their tensors must not
+  // share memory. Steps are non-decreasing along data dependencies and are
+  // at most `index`. By default nodes run one at a time in execution plan
+  // order.
+  virtual size_t execution_step(size_t index) const { return index; }
 };
 
 // Represents a subset of nodes in a TensorFlow Lite graph.
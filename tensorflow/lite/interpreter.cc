@@ -442,29 +442,53 @@ TfLiteStatus Interpreter::ApplyOptionsImpl(InterpreterOptions* options) {
     return kTfLiteOk;
   }
 
+  for (auto& subgraph : subgraphs_) {
+    ApplyOptionsToSubgraph(options, subgraph.get());
+  }
+
+  // Handle `experimental_packed_weights_cache_`.
+  if (options->GetPackedWeightsCache() && own_external_cpu_backend_context_) {
+    own_external_cpu_backend_context_->set_packed_weights_cache(
+        options->GetPackedWeightsCache());
+  }
+  return kTfLiteOk;
+}
+
+void Interpreter::ApplyOptionsToSubgraph(InterpreterOptions* options,
+                                         Subgraph* subgraph) {
   // Handle `experimental_preserve_all_tensors_`.
   if (options->GetPreserveAllTensors()) {
-    for (auto& subgraph : subgraphs_) {
-      subgraph->PreserveAllTensorsExperimental();
-    }
+    subgraph->PreserveAllTensorsExperimental();
   }
 
   // Handle `experimental_ensure_dynamic_tensors_are_released_`.
   if (options->GetEnsureDynamicTensorsAreReleased()) {
-    for (auto& subgraph : subgraphs_) {
-      subgraph->EnsureDynamicTensorsAreReleased();
-    }
+    subgraph->EnsureDynamicTensorsAreReleased();
   }
 
   // Handle `experimental_dynamic_allocation_for_large_tensors_`.
   if (options->GetDynamicAllocationForLargeTensors() > 0) {
-    for (auto& subgraph : subgraphs_) {
-      subgraph->OptimizeMemoryForLargeTensors(
-          options->GetDynamicAllocationForLargeTensors());
-      subgraph->EnsureDynamicTensorsAreReleased();
-    }
+    subgraph->OptimizeMemoryForLargeTensors(
+        options->GetDynamicAllocationForLargeTensors());
+    subgraph->EnsureDynamicTensorsAreReleased();
+  }
+
+  // Handle `experimental_num_inter_op_threads_`.
+  if (options->GetNumInterOpThreads() > 1) {
+    subgraph->SetNumInterOpThreads(options->GetNumInterOpThreads());
+  }
+
+  // Handle `experimental_arena_planning_strategy_`.
+  if (options->GetArenaPlanningStrategy() !=
+      ArenaPlanningStrategy::kGreedyBySize) {
+    subgraph->SetArenaPlanningStrategy(options->GetArenaPlanningStrategy());
+  }
+
+  // Handle `experimental_max_cached_arena_plans_`.
+  if (options->GetMaxCachedArenaPlans() > 0) {
+    subgraph->CacheArenaPlans(options->GetMaxCachedArenaPlans(),
+                              options->GetReuseLargerArenaPlans());
   }
-  return kTfLiteOk;
 }
 
 }  // namespace tflite
@@ -41,6 +41,7 @@ limitations under the License.
 #include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/internal/signature_def.h"
 #include "tensorflow/lite/memory_planner.h"
+#include "tensorflow/lite/packed_weights_cache.h"
 #include "tensorflow/lite/portable_type_to_tflitetype.h"
 #include "tensorflow/lite/signature_runner.h"
 #include "tensorflow/lite/stderr_reporter.h"
@@ -70,7 +71,12 @@ class InterpreterOptions {
   InterpreterOptions()
       : experimental_preserve_all_tensors_(false),
         experimental_ensure_dynamic_tensors_are_released_(false),
-        experimental_optimize_memory_for_large_tensors_(0) {}
+        experimental_optimize_memory_for_large_tensors_(0),
+        experimental_num_inter_op_threads_(0),
+        experimental_arena_planning_strategy_(
+            ArenaPlanningStrategy::kGreedyBySize),
+        experimental_max_cached_arena_plans_(0),
+        experimental_reuse_larger_arena_plans_(false) {}
 
   /// Preserving all intermediates tensors for debugging.
   /// WARNING: This is an experimental API and subject to change.
@@ -118,10 +124,87 @@ class InterpreterOptions {
     return experimental_optimize_memory_for_large_tensors_;
   }
 
+  /// Run nodes that don't depend on each other concurrently, on up to
+  /// `num_threads` threads including the one calling `Invoke`. It helps
+  /// multi-branch models whose ops are too small to use all threads on their
+  /// own, at the cost of a larger arena. Each thread uses a
+  /// single-threaded CPU backend context of its own. Graphs with dynamic
+  /// tensors still run one node at a time.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetNumInterOpThreads(int num_threads) {
+    experimental_num_inter_op_threads_ = num_threads;
+  }
+
+  /// Returns the number of threads set by `SetNumInterOpThreads`, or zero if
+  /// the feature is not enabled.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetNumInterOpThreads() { return experimental_num_inter_op_threads_; }
+
+  /// Sets the order in which the arena memory planner assigns offsets to
+  /// tensors. `ArenaPlanningStrategy::kBestOf` usually yields the smallest
+  /// arena at the cost of a slower `AllocateTensors`. Use
+  /// `Subgraph::GetArenaSizeInfo` to compare strategies on a model.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetArenaPlanningStrategy(ArenaPlanningStrategy strategy) {
+    experimental_arena_planning_strategy_ = strategy;
+  }
+
+  /// Returns the strategy set by `SetArenaPlanningStrategy`.
+  /// WARNING: This is an experimental API and subject to change.
+  ArenaPlanningStrategy GetArenaPlanningStrategy() {
+    return experimental_arena_planning_strategy_;
+  }
+
+  /// Keep the arena plans of the last `max_plans` distinct sets of tensor
+  /// sizes, so that resizing inputs back to a previously seen shape doesn't
+  /// require planning the arena again. If `reuse_larger_plans` is true, a plan
+  /// made for larger shapes is reused for smaller ones too: calling
+  /// `AllocateTensors` once with the largest expected input shapes then
+  /// avoids arena planning for all the smaller ones.
+  /// WARNING: This is an experimental API and subject to change.
+  void CacheArenaPlans(int max_plans = 8, bool reuse_larger_plans = false) {
+    experimental_max_cached_arena_plans_ = max_plans;
+    experimental_reuse_larger_arena_plans_ = reuse_larger_plans;
+  }
+
+  /// Returns the number of plans set by `CacheArenaPlans`, or zero if the
+  /// feature is not enabled.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetMaxCachedArenaPlans() { return experimental_max_cached_arena_plans_; }
+
+  /// Returns if `CacheArenaPlans` enabled reusing larger plans.
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetReuseLargerArenaPlans() {
+    return experimental_reuse_larger_arena_plans_;
+  }
+
+  /// Share packed copies of constant weights through `cache`. Interpreters
+  /// built from the same FlatBufferModel with the same cache keep a single
+  /// copy of the weights that built-in kernels repack. The cache is attached
+  /// to the interpreter's own CPU backend context, so it is dropped if that
+  /// context is later replaced with `SetExternalContext`. For weights packed
+  /// by the XNNPACK delegate, share a `TfLiteXNNPackDelegateWeightsCache`
+  /// through the delegate options instead.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetPackedWeightsCache(std::shared_ptr<PackedWeightsCache> cache) {
+    experimental_packed_weights_cache_ = std::move(cache);
+  }
+
+  /// Returns the cache set by `SetPackedWeightsCache`, or null.
+  /// WARNING: This is an experimental API and subject to change.
+  const std::shared_ptr<PackedWeightsCache>& GetPackedWeightsCache() {
+    return experimental_packed_weights_cache_;
+  }
+
  private:
   bool experimental_preserve_all_tensors_;
   bool experimental_ensure_dynamic_tensors_are_released_;
   int experimental_optimize_memory_for_large_tensors_;
+  int experimental_num_inter_op_threads_;
+  ArenaPlanningStrategy experimental_arena_planning_strategy_;
+  int experimental_max_cached_arena_plans_;
+  bool experimental_reuse_larger_arena_plans_;
+  std::shared_ptr<PackedWeightsCache> experimental_packed_weights_cache_;
 };
 
 /// An interpreter for a graph of nodes that input and output from tensors.
@@ -882,6 +965,10 @@ class Interpreter {
 
   TfLiteStatus ApplyOptionsImpl(InterpreterOptions* options);
 
+  // Applies the per-subgraph parts of `options` to `subgraph`.
+  static void ApplyOptionsToSubgraph(InterpreterOptions* options,
+                                     Subgraph* subgraph);
+
   // A pure C data structure used to communicate with the pure C plugin
   // interface. To avoid copying tensor metadata, this is also the definitive
   // structure to store tensors.
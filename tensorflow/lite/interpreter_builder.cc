@@ -669,6 +669,46 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
   return status;
 }
 
+TfLiteStatus InterpreterBuilder::ParseSubgraph(int subgraph_index,
+                                               Subgraph* modified_subgraph) {
+  const tflite::SubGraph* subgraph = (*model_->subgraphs())[subgraph_index];
+  auto operators = subgraph->operators();
+  auto tensors = subgraph->tensors();
+  if (!tensors) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Did not get tensors in subgraph %d.\n",
+                         subgraph_index);
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE_STATUS(modified_subgraph->AddTensors(tensors->size()));
+  // Parse inputs/outputs
+  modified_subgraph->SetInputs(FlatBufferIntArrayToVector(subgraph->inputs()));
+  modified_subgraph->SetOutputs(
+      FlatBufferIntArrayToVector(subgraph->outputs()));
+
+  // Finally setup nodes and tensors
+  // Parse tensors before nodes as ParseNodes checks input tensors for the
+  // nodes.
+  TF_LITE_ENSURE_STATUS(
+      ParseTensors(model_->buffers(), tensors, modified_subgraph));
+  if (operators) {
+    TF_LITE_ENSURE_STATUS(ParseNodes(operators, modified_subgraph));
+  }
+
+  std::vector<int> variables;
+  for (int i = 0; i < modified_subgraph->tensors_size(); ++i) {
+    auto* tensor = modified_subgraph->tensor(i);
+    if (tensor->is_variable) {
+      variables.push_back(i);
+    }
+  }
+  modified_subgraph->SetVariables(std::move(variables));
+  if (subgraph->name()) {
+    modified_subgraph->SetName(subgraph->name()->c_str());
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus InterpreterBuilder::ApplyDelegates(Interpreter* interpreter) {
   // Apply Flex delegate if applicable.
   if (has_flex_op_) {
@@ -774,45 +814,10 @@ TfLiteStatus InterpreterBuilder::operator()(
 
   for (int subgraph_index = 0; subgraph_index < subgraphs->size();
        ++subgraph_index) {
-    const tflite::SubGraph* subgraph = (*subgraphs)[subgraph_index];
-    tflite::Subgraph* modified_subgraph =
-        (*interpreter)->subgraph(subgraph_index);
-    auto operators = subgraph->operators();
-    auto tensors = subgraph->tensors();
-    if (!tensors) {
-      TF_LITE_REPORT_ERROR(error_reporter_,
-                           "Did not get tensors in subgraph %d.\n",
-                           subgraph_index);
+    if (ParseSubgraph(subgraph_index,
+                      (*interpreter)->subgraph(subgraph_index)) != kTfLiteOk) {
       return cleanup_and_error();
     }
-    if (modified_subgraph->AddTensors(tensors->size()) != kTfLiteOk) {
-      return cleanup_and_error();
-    }
-    // Parse inputs/outputs
-    modified_subgraph->SetInputs(
-        FlatBufferIntArrayToVector(subgraph->inputs()));
-    modified_subgraph->SetOutputs(
-        FlatBufferIntArrayToVector(subgraph->outputs()));
-
-    // Finally setup nodes and tensors
-    // Parse tensors before nodes as ParseNodes checks input tensors for the
-    // nodes.
-    if (ParseTensors(buffers, tensors, modified_subgraph) != kTfLiteOk)
-      return cleanup_and_error();
-    if (operators && ParseNodes(operators, modified_subgraph) != kTfLiteOk)
-      return cleanup_and_error();
-
-    std::vector<int> variables;
-    for (int i = 0; i < modified_subgraph->tensors_size(); ++i) {
-      auto* tensor = modified_subgraph->tensor(i);
-      if (tensor->is_variable) {
-        variables.push_back(i);
-      }
-    }
-    modified_subgraph->SetVariables(std::move(variables));
-    if (subgraph->name()) {
-      modified_subgraph->SetName(subgraph->name()->c_str());
-    }
   }
 
   if (ParseSignatureDefs(model_->signature_defs(), interpreter->get()) !=
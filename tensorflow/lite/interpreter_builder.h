@@ -108,6 +108,28 @@ class InterpreterBuilder {
   /// any Interpreter generated by this InterpreterBuilder.
   void AddDelegate(TfLiteDelegate* delegate);
 
+  /// WARNING: Experimental interface, subject to change
+  /// Builds a SignatureRunner for the signature `signature_key` of
+  /// `interpreter`, which must have been built by this builder. The runner has
+  /// its own copy of the signature's subgraph: its own tensors, arena, kernel
+  /// state, CPU backend context and resources. It shares with `interpreter`
+  /// only the read-only parts of the model, namely the constant tensors, which
+  /// point into the model buffer, and the interpreter's packed weights cache.
+  /// Different runners, and the interpreter, may therefore be invoked
+  /// concurrently from different threads, including several runners of the
+  /// same signature. Each runner on its own is still *not* thread-safe.
+  ///
+  /// The runner runs the builtin kernels: delegates added with AddDelegate,
+  /// and the interpreter's default delegates, are not applied to it.
+  /// Signatures that call other subgraphs through control flow ops (e.g.
+  /// WHILE, IF or CALL_ONCE) are not supported. The model and the error
+  /// reporter must outlive the runner; the builder and `interpreter` need not.
+  ///
+  /// On failure, returns an error status and sets `*runner` to nullptr.
+  TfLiteStatus BuildSignatureRunner(const Interpreter* interpreter,
+                                    const char* signature_key,
+                                    std::unique_ptr<SignatureRunner>* runner);
+
  private:
   TfLiteStatus BuildLocalIndexToRegistrationMapping();
   TfLiteStatus ParseNodes(
@@ -117,6 +139,8 @@ class InterpreterBuilder {
       const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
       const flatbuffers::Vector<flatbuffers::Offset<Tensor>>* tensors,
       Subgraph* subgraph);
+  // Sets up `modified_subgraph` from the model's subgraph `subgraph_index`.
+  TfLiteStatus ParseSubgraph(int subgraph_index, Subgraph* modified_subgraph);
   TfLiteStatus ApplyDelegates(Interpreter* interpreter);
   TfLiteStatus ParseQuantization(const QuantizationParameters* src_quantization,
                                  TfLiteQuantization* quantization,
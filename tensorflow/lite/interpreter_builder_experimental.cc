@@ -0,0 +1,121 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <utility>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/internal/signature_def.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/signature_runner.h"
+
+namespace tflite {
+
+TfLiteStatus InterpreterBuilder::BuildSignatureRunner(
+    const Interpreter* interpreter, const char* signature_key,
+    std::unique_ptr<SignatureRunner>* runner) {
+  if (!runner) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Null output pointer passed to BuildSignatureRunner.");
+    return kTfLiteError;
+  }
+  runner->reset();
+  if (!interpreter || !model_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Null interpreter or model passed to "
+                         "BuildSignatureRunner.");
+    return kTfLiteError;
+  }
+
+  const internal::SignatureDef* signature_def = nullptr;
+  for (const auto& signature : interpreter->signature_defs_) {
+    if (signature.signature_key == signature_key) {
+      signature_def = &signature;
+      break;
+    }
+  }
+  if (signature_def == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Signature %s was not found.",
+                         signature_key);
+    return kTfLiteError;
+  }
+  const int subgraph_index = signature_def->subgraph_index;
+  auto* subgraphs = model_->subgraphs();
+  if (!subgraphs || subgraphs->size() != interpreter->subgraphs_size() ||
+      subgraph_index < 0 || subgraph_index >= subgraphs->size()) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "The interpreter was not built from the model of "
+                         "this InterpreterBuilder.");
+    return kTfLiteError;
+  }
+
+  // Control flow ops invoke the other subgraphs of the model, which the
+  // runner does not have its own copy of. The registrations were resolved by
+  // operator(), and are not rebuilt here since the interpreter refers to the
+  // unresolved custom ops they hold.
+  if (const auto* operators = (*subgraphs)[subgraph_index]->operators()) {
+    for (const auto* op : *operators) {
+      const int index = op->opcode_index();
+      // Invalid indices are reported by ParseNodes.
+      if (index < 0 || index >= flatbuffer_op_index_to_registration_.size() ||
+          flatbuffer_op_index_to_registration_[index] == nullptr) {
+        continue;
+      }
+      const auto op_type = static_cast<BuiltinOperator>(
+          flatbuffer_op_index_to_registration_[index]->builtin_code);
+      if (op_type == BuiltinOperator_WHILE || op_type == BuiltinOperator_IF ||
+          op_type == BuiltinOperator_CALL_ONCE) {
+        TF_LITE_REPORT_ERROR(error_reporter_,
+                             "Signature %s uses %s, which is not supported by "
+                             "BuildSignatureRunner.",
+                             signature_key, EnumNameBuiltinOperator(op_type));
+        return kTfLiteError;
+      }
+    }
+  }
+
+  auto instance = std::make_unique<SignatureRunner::Instance>();
+  instance->signature_def = *signature_def;
+  for (int i = 0; i < kTfLiteMaxExternalContexts; ++i) {
+    instance->external_contexts[i] = nullptr;
+  }
+  // A context of its own, since the CPU backend context is not thread-safe.
+  // Packed weights are still shared through the cache, which is.
+  instance->cpu_backend_context =
+      std::make_unique<ExternalCpuBackendContext>();
+  instance->cpu_backend_context->set_packed_weights_cache(
+      options_.GetPackedWeightsCache());
+  instance->external_contexts[kTfLiteCpuBackendContext] =
+      instance->cpu_backend_context.get();
+  instance->subgraphs.emplace_back(new Subgraph(
+      error_reporter_, instance->external_contexts, &instance->subgraphs,
+      &instance->resources, &instance->resource_ids,
+      &instance->initialization_status_map));
+
+  Subgraph* modified_subgraph = instance->subgraphs.front().get();
+  modified_subgraph->context()->recommended_num_threads =
+      interpreter->subgraphs_.front()->context()->recommended_num_threads;
+  Interpreter::ApplyOptionsToSubgraph(&options_, modified_subgraph);
+  TF_LITE_ENSURE_STATUS(ParseSubgraph(subgraph_index, modified_subgraph));
+
+  runner->reset(new SignatureRunner(std::move(instance)));
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
@@ -24,6 +24,7 @@ limitations under the License.
 #include <memory>
 #include <new>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
 
@@ -1113,6 +1114,95 @@ TEST(BasicInterpreter, ReleaseDynamicTensors) {
   ASSERT_EQ(interpreter.tensor(3)->bytes, sizeof(float) * 6 * 6);
 }
 
+// Records where and how an independent node was invoked. Stored in the node's
+// builtin_data, which the interpreter releases with free().
+struct InterOpRecord {
+  std::thread::id thread_id;
+  int recommended_num_threads = 0;
+  TfLiteExternalContext* cpu_backend_context = nullptr;
+};
+
+TEST(BasicInterpreter, InterOpThreadsRunIndependentNodesConcurrently) {
+  Interpreter interpreter;
+  interpreter.primary_subgraph().SetNumInterOpThreads(2);
+  interpreter.AddTensors(4);
+  interpreter.SetInputs({0});
+  interpreter.SetOutputs({3});
+  TfLiteQuantizationParams quant;
+  for (int i = 0; i < 4; ++i) {
+    interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {3},
+                                             quant);
+  }
+
+  // Copies input 0 to output 0 and records the invocation.
+  TfLiteRegistration copy_reg = {nullptr, nullptr, nullptr, nullptr};
+  copy_reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* input = GetInput(context, node, 0);
+    return context->ResizeTensor(context, GetOutput(context, node, 0),
+                                 TfLiteIntArrayCopy(input->dims));
+  };
+  copy_reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    auto* record = static_cast<InterOpRecord*>(node->builtin_data);
+    record->thread_id = std::this_thread::get_id();
+    record->recommended_num_threads = context->recommended_num_threads;
+    record->cpu_backend_context =
+        context->GetExternalContext(context, kTfLiteCpuBackendContext);
+    const TfLiteTensor* input = GetInput(context, node, 0);
+    memcpy(GetOutput(context, node, 0)->data.raw, input->data.raw,
+           input->bytes);
+    return kTfLiteOk;
+  };
+
+  // Adds inputs 0 and 1 into output 0.
+  TfLiteRegistration sum_reg = {nullptr, nullptr, nullptr, nullptr};
+  sum_reg.prepare = copy_reg.prepare;
+  sum_reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* a = GetInput(context, node, 0);
+    const TfLiteTensor* b = GetInput(context, node, 1);
+    TfLiteTensor* out = GetOutput(context, node, 0);
+    for (int i = 0; i < NumElements(out); ++i) {
+      out->data.f[i] = a->data.f[i] + b->data.f[i];
+    }
+    return kTfLiteOk;
+  };
+
+  InterOpRecord* records[2];
+  for (int i = 0; i < 2; ++i) {
+    records[i] = static_cast<InterOpRecord*>(malloc(sizeof(InterOpRecord)));
+    new (records[i]) InterOpRecord;
+    ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {i + 1}, nullptr, 0,
+                                                records[i], &copy_reg),
+              kTfLiteOk);
+  }
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({1, 2}, {3}, nullptr, 0, nullptr,
+                                        &sum_reg),
+      kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  // The concurrent outputs must not share memory.
+  EXPECT_NE(interpreter.tensor(1)->data.raw, interpreter.tensor(2)->data.raw);
+
+  float* input = interpreter.typed_tensor<float>(0);
+  input[0] = 1.f;
+  input[1] = 2.f;
+  input[2] = 3.f;
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  const float* output = interpreter.typed_tensor<float>(3);
+  EXPECT_EQ(output[0], 2.f);
+  EXPECT_EQ(output[1], 4.f);
+  EXPECT_EQ(output[2], 6.f);
+
+  // Each concurrent node runs on its own worker with a private,
+  // single-threaded CPU backend context.
+  EXPECT_NE(records[0]->thread_id, records[1]->thread_id);
+  EXPECT_EQ(records[0]->recommended_num_threads, 1);
+  EXPECT_EQ(records[1]->recommended_num_threads, 1);
+  ASSERT_NE(records[0]->cpu_backend_context, nullptr);
+  ASSERT_NE(records[1]->cpu_backend_context, nullptr);
+  EXPECT_NE(records[0]->cpu_backend_context, records[1]->cpu_backend_context);
+}
+
 TEST(InterpreterTensorsCapacityTest, TestWithinHeadroom) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(Interpreter::kTensorsReservedCapacity),
@@ -17,6 +17,7 @@ limitations under the License.
 #include <stddef.h>
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 // Only use multi-threaded Eigen if ruy is disabled.
@@ -45,6 +46,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/packed_weights_cache.h"
 #include "tensorflow/lite/util.h"
 
 namespace tflite {
@@ -68,6 +70,9 @@ enum KernelType {
 
 const int kTensorNotAllocated = -1;
 
+// Layout tag of HWCN-transposed filters in the PackedWeightsCache ("HWCN").
+constexpr uint64_t kHwcnWeightsLayout = 0x4857434e;
+
 static constexpr size_t kMaxIm2colBufferSizeMobile = 1024 * 1024 * 1024;  // 1GB
 
 struct OpData {
@@ -108,6 +113,10 @@ struct OpData {
 
   bool need_hwcn_weights = false;
   bool have_weights_been_transposed = false;
+  // If true, the HWCN weights come from the interpreter's PackedWeightsCache,
+  // and are shared with other interpreters, instead of a temporary tensor.
+  bool use_shared_hwcn_weights = false;
+  std::shared_ptr<const PackedWeightsCache::Entry> shared_hwcn_weights;
   bool need_im2col = false;
   // If it's true, it means im2col is needed but gets disabled because the
   // temporary im2col tensor requires too much memory (i.e.
@@ -155,11 +164,9 @@ void Free(TfLiteContext* context, void* buffer) {
 // Naive implementation of transpose for floats. Could be optimized to be more
 // cache friendly, but for now it's a one-time cost on first run, and we would
 // prefer to remove the need to do this at all eventually.
-void TransposeFloatTensor(const TfLiteTensor* input, TfLiteTensor* output) {
-  const int rows = output->dims->data[1];
-  const int cols = output->dims->data[0];
+void TransposeFloatTensor(const TfLiteTensor* input, int rows, int cols,
+                          float* output_data) {
   const float* input_data = GetTensorData<float>(input);
-  float* output_data = GetTensorData<float>(output);
   for (int i = 0; i < rows; ++i) {
     for (int j = 0; j < cols; ++j) {
       const float in_value = input_data[i * cols + j];
@@ -168,6 +175,11 @@ void TransposeFloatTensor(const TfLiteTensor* input, TfLiteTensor* output) {
   }
 }
 
+void TransposeFloatTensor(const TfLiteTensor* input, TfLiteTensor* output) {
+  TransposeFloatTensor(input, output->dims->data[1], output->dims->data[0],
+                       GetTensorData<float>(output));
+}
+
 // Check if im2col needs to be allocated, as some version of optimized Conv dont
 // use it. If any change is supporting im2col in any of the Conv versions, then
 // it should be updated here as well
@@ -247,6 +259,11 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(
   // we're running with that data type.
   data->need_hwcn_weights =
       input->type == kTfLiteFloat32 && data->supports_multithreaded_kernel;
+  // Constant filters are transposed once for all the interpreters sharing a
+  // packed weights cache, rather than into a persistent tensor of each.
+  data->use_shared_hwcn_weights =
+      data->need_hwcn_weights && IsConstantTensor(filter) &&
+      CpuBackendContext::GetPackedWeightsCache(context) != nullptr;
 
   // We don't always need to allocate im2col. It is only used in some versions
   // of the optimized Conv. This test just mimics something that happens inside
@@ -274,7 +291,7 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(
     }
     ++temporaries_count;
   }
-  if (data->need_hwcn_weights) {
+  if (data->need_hwcn_weights && !data->use_shared_hwcn_weights) {
     data->hwcn_weights_index = temporaries_count;
     if (data->hwcn_weights_id == kTensorNotAllocated) {
       context->AddTensors(context, 1, &data->hwcn_weights_id);
@@ -517,7 +534,22 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
     if (im2col_status != kTfLiteOk) return im2col_status;
   }
 
-  if (data->need_hwcn_weights) {
+  data->shared_hwcn_weights.reset();
+  if (data->use_shared_hwcn_weights) {
+    // Channels are part of the layout since models may reuse one constant
+    // buffer for filters of different shapes.
+    const int filter_size = NumElements(filter) / channels_out;
+    const PackedWeightsCache::Key key = {
+        filter->data.raw, filter->bytes,
+        (kHwcnWeightsLayout << 32) | static_cast<uint32_t>(channels_out)};
+    data->shared_hwcn_weights =
+        CpuBackendContext::GetPackedWeightsCache(context)->GetOrPack(
+            key, filter->bytes, [filter, filter_size, channels_out](void* dst) {
+              TransposeFloatTensor(filter, channels_out, filter_size,
+                                   static_cast<float*>(dst));
+            });
+    data->have_weights_been_transposed = true;
+  } else if (data->need_hwcn_weights) {
     node->temporaries->data[data->hwcn_weights_index] = data->hwcn_weights_id;
     TfLiteIntArray* hwcn_weights_size = TfLiteIntArrayCreate(2);
 
@@ -927,7 +959,10 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
     case kMultithreadOptimized: {
 #if defined(TFLITE_WITH_MULTITHREADED_EIGEN)
       const float* filter_data;
-      if (data->need_hwcn_weights) {
+      if (data->use_shared_hwcn_weights) {
+        filter_data =
+            static_cast<const float*>(data->shared_hwcn_weights->data());
+      } else if (data->need_hwcn_weights) {
         filter_data = GetTensorData<float>(hwcn_weights);
       } else {
         filter_data = GetTensorData<float>(filter);
@@ -1159,7 +1194,7 @@ TfLiteStatus EvalImpl(TfLiteContext* context, TfLiteNode* node) {
           ? &context->tensors[node->temporaries->data[data->im2col_index]]
           : nullptr;
   TfLiteTensor* hwcn_weights =
-      data->need_hwcn_weights
+      data->need_hwcn_weights && !data->use_shared_hwcn_weights
           ? &context->tensors[node->temporaries->data[data->hwcn_weights_index]]
           : nullptr;
 
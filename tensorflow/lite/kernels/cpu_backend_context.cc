@@ -80,6 +80,10 @@ bool CpuBackendContext::CpuInfo::Avx512() {
          cpuinfo_has_x86_avx512dq() && cpuinfo_has_x86_avx512cd() &&
          cpuinfo_has_x86_avx512bw() && cpuinfo_has_x86_avx512vl();
 }
+
+bool CpuBackendContext::CpuInfo::Avx512Vnni() {
+  return Avx512() && cpuinfo_has_x86_avx512vnni();
+}
 #else
 
 CpuBackendContext::CpuInfo::~CpuInfo() {}
@@ -97,6 +101,8 @@ bool CpuBackendContext::CpuInfo::Avx2Fma() { return false; }
 bool CpuBackendContext::CpuInfo::Avx() { return false; }
 
 bool CpuBackendContext::CpuInfo::Avx512() { return false; }
+
+bool CpuBackendContext::CpuInfo::Avx512Vnni() { return false; }
 #endif  // TFLITE_HAVE_CPUINFO
 
 CpuBackendContext* CpuBackendContext::GetFromContext(TfLiteContext* context) {
@@ -123,6 +129,14 @@ CpuBackendContext* CpuBackendContext::GetFromContext(TfLiteContext* context) {
   return cpu_backend_context;
 }
 
+PackedWeightsCache* CpuBackendContext::GetPackedWeightsCache(
+    TfLiteContext* context) {
+  auto* external_context = static_cast<ExternalCpuBackendContext*>(
+      context->GetExternalContext(context, kTfLiteCpuBackendContext));
+  if (external_context == nullptr) return nullptr;
+  return external_context->packed_weights_cache().get();
+}
+
 CpuBackendContext::CpuBackendContext()
     : TfLiteInternalBackendContext(),
       ruy_context_(new ruy::Context),
@@ -159,6 +173,8 @@ bool CpuBackendContext::PreferGemmlowpOnX86() {
   return use_gemmlowp_on_x86 || !RuyHasAvxOrAbove();
 }
 
+bool CpuBackendContext::HasAvx512Vnni() { return cpuinfo_.Avx512Vnni(); }
+
 bool CpuBackendContext::RuyHasAvxOrAbove() {
   // TODO(b/183178387): Use a proper query to detect AVX/optimized paths.
 #if RUY_PLATFORM_X86_ENHANCEMENTS
@@ -30,10 +30,17 @@ limitations under the License.
 
 namespace tflite {
 
+class PackedWeightsCache;
+
 class CpuBackendContext final : public TfLiteInternalBackendContext {
  public:
   static CpuBackendContext* GetFromContext(TfLiteContext* context);
 
+  // Returns the cache through which kernels share packed copies of constant
+  // weights with other interpreters, or nullptr if there is none. See
+  // InterpreterOptions::SetPackedWeightsCache.
+  static PackedWeightsCache* GetPackedWeightsCache(TfLiteContext* context);
+
   CpuBackendContext();
   ~CpuBackendContext() override;
 
@@ -59,6 +66,11 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
   // this path based on link time dependencies.
   bool PreferGemmlowpOnX86();
 
+  // Returns true if the CPU supports the AVX-512 VNNI int8 dot product
+  // instructions, used by the int8 Gemv kernel in
+  // cpu_backend_gemm_avx512_vnni.h.
+  bool HasAvx512Vnni();
+
  private:
   bool RuyHasAvxOrAbove();
 
@@ -72,6 +84,7 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
     bool Avx();
     bool Avx2Fma();
     bool Avx512();
+    bool Avx512Vnni();
 
    private:
     enum class InitStatus {
@@ -159,7 +159,13 @@ void Gemm(const MatrixParams<LhsScalar>& lhs_params, const LhsScalar* lhs_data,
   const bool try_custom_gemv = (dst_params.cols == 1);
   if (try_custom_gemv) {
     // GEMV case: try a custom fast GEMV path. It will return true if it
-    // actually handled it.
+    // actually handled it. Kernels for the CPU features detected at runtime
+    // go first.
+    if (detail::TryRuntimeDispatchedGemv(lhs_params, lhs_data, rhs_params,
+                                         rhs_data, dst_params, dst_data,
+                                         params, context)) {
+      return;
+    }
     if (detail::CustomGemv(lhs_params, lhs_data, rhs_params, rhs_data,
                            dst_params, dst_data, params, context)) {
       return;
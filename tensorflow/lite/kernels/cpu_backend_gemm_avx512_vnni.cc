@@ -0,0 +1,154 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/cpu_backend_gemm_avx512_vnni.h"
+
+#ifdef TFLITE_HAVE_AVX512_VNNI_GEMV
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+
+namespace tflite {
+namespace cpu_backend_gemm {
+namespace detail {
+namespace {
+
+constexpr int kKernelRows = 4;
+
+// Computes the dot products of `kKernelRows` consecutive rows of `lhs` with
+// `rhs`, and the sums of those rows.
+//
+// vpdpbusd multiplies unsigned by signed bytes, so `rhs` is offset by 128 to
+// make it unsigned. That adds 128 times the sum of the lhs row to each dot
+// product, which is subtracted at the end.
+__attribute__((target("avx512f,avx512bw,avx512vnni"))) void DotProductRows(
+    const std::int8_t* lhs, int lhs_stride, const std::int8_t* rhs, int depth,
+    std::int32_t* dots, std::int32_t* lhs_sums) {
+  const __m512i sign_flip = _mm512_set1_epi8(static_cast<char>(0x80));
+  const __m512i ones = _mm512_set1_epi8(1);
+  __m512i dot_acc[kKernelRows];
+  __m512i sum_acc[kKernelRows];
+  for (int r = 0; r < kKernelRows; ++r) {
+    dot_acc[r] = _mm512_setzero_si512();
+    sum_acc[r] = _mm512_setzero_si512();
+  }
+  int k = 0;
+  for (; k <= depth - 64; k += 64) {
+    const __m512i rhs_val =
+        _mm512_xor_si512(_mm512_loadu_si512(rhs + k), sign_flip);
+    for (int r = 0; r < kKernelRows; ++r) {
+      const __m512i lhs_val = _mm512_loadu_si512(lhs + r * lhs_stride + k);
+      dot_acc[r] = _mm512_dpbusd_epi32(dot_acc[r], rhs_val, lhs_val);
+      sum_acc[r] = _mm512_dpbusd_epi32(sum_acc[r], ones, lhs_val);
+    }
+  }
+  if (k < depth) {
+    // The masked out lhs values are zero, so whatever the rhs lanes hold
+    // doesn't contribute.
+    const __mmask64 mask = _cvtu64_mask64(~0ULL >> (64 - (depth - k)));
+    const __m512i rhs_val =
+        _mm512_xor_si512(_mm512_maskz_loadu_epi8(mask, rhs + k), sign_flip);
+    for (int r = 0; r < kKernelRows; ++r) {
+      const __m512i lhs_val =
+          _mm512_maskz_loadu_epi8(mask, lhs + r * lhs_stride + k);
+      dot_acc[r] = _mm512_dpbusd_epi32(dot_acc[r], rhs_val, lhs_val);
+      sum_acc[r] = _mm512_dpbusd_epi32(sum_acc[r], ones, lhs_val);
+    }
+  }
+  for (int r = 0; r < kKernelRows; ++r) {
+    lhs_sums[r] = _mm512_reduce_add_epi32(sum_acc[r]);
+    dots[r] = _mm512_reduce_add_epi32(dot_acc[r]) - 128 * lhs_sums[r];
+  }
+}
+
+}  // namespace
+
+template <QuantizationFlavor quantization_flavor>
+void Avx512VnniGemvInt8(
+    const MatrixParams<std::int8_t>& lhs_params, const std::int8_t* lhs_data,
+    const MatrixParams<std::int8_t>& rhs_params, const std::int8_t* rhs_data,
+    const MatrixParams<std::int8_t>& dst_params, std::int8_t* dst_data,
+    const GemmParams<std::int32_t, std::int8_t, quantization_flavor>& params,
+    int row_start, int row_end) {
+  TFLITE_DCHECK_GE(row_end - row_start, kKernelRows);
+  const int depth = lhs_params.cols;
+  const std::int32_t lhs_zero_point = lhs_params.zero_point;
+  const std::int32_t rhs_zero_point = rhs_params.zero_point;
+  // Only needed for a non-zero lhs zero point, weights usually have none.
+  std::int32_t rhs_sum = 0;
+  if (lhs_zero_point != 0) {
+    for (int k = 0; k < depth; ++k) rhs_sum += rhs_data[k];
+  }
+  const std::int32_t zero_points_term =
+      depth * lhs_zero_point * rhs_zero_point - lhs_zero_point * rhs_sum;
+
+  for (int row = row_start; row < row_end; row += kKernelRows) {
+    // As in the other Gemv kernels, the last group of rows is nudged back to
+    // fit, recomputing a few rows if needed.
+    row = std::min(row, row_end - kKernelRows);
+    std::int32_t dots[kKernelRows];
+    std::int32_t lhs_sums[kKernelRows];
+    DotProductRows(lhs_data + row * depth, depth, rhs_data, depth, dots,
+                   lhs_sums);
+    for (int r = 0; r < kKernelRows; ++r) {
+      const int dst_row = row + r;
+      std::int32_t acc =
+          dots[r] - rhs_zero_point * lhs_sums[r] + zero_points_term;
+      if (params.bias) acc += params.bias[dst_row];
+      if (quantization_flavor ==
+          QuantizationFlavor::kIntegerWithPerRowMultiplier) {
+        acc = MultiplyByQuantizedMultiplier(
+            acc, params.multiplier_fixedpoint_perchannel[dst_row],
+            params.multiplier_exponent_perchannel[dst_row]);
+      } else {
+        acc = MultiplyByQuantizedMultiplier(acc, params.multiplier_fixedpoint,
+                                            params.multiplier_exponent);
+      }
+      acc += dst_params.zero_point;
+      acc = std::max<std::int32_t>(acc, params.clamp_min);
+      acc = std::min<std::int32_t>(acc, params.clamp_max);
+      dst_data[dst_row] = static_cast<std::int8_t>(acc);
+    }
+  }
+}
+
+template void Avx512VnniGemvInt8<
+    QuantizationFlavor::kIntegerWithUniformMultiplier>(
+    const MatrixParams<std::int8_t>& lhs_params, const std::int8_t* lhs_data,
+    const MatrixParams<std::int8_t>& rhs_params, const std::int8_t* rhs_data,
+    const MatrixParams<std::int8_t>& dst_params, std::int8_t* dst_data,
+    const GemmParams<std::int32_t, std::int8_t,
+                     QuantizationFlavor::kIntegerWithUniformMultiplier>& params,
+    int row_start, int row_end);
+
+template void Avx512VnniGemvInt8<
+    QuantizationFlavor::kIntegerWithPerRowMultiplier>(
+    const MatrixParams<std::int8_t>& lhs_params, const std::int8_t* lhs_data,
+    const MatrixParams<std::int8_t>& rhs_params, const std::int8_t* rhs_data,
+    const MatrixParams<std::int8_t>& dst_params, std::int8_t* dst_data,
+    const GemmParams<std::int32_t, std::int8_t,
+                     QuantizationFlavor::kIntegerWithPerRowMultiplier>& params,
+    int row_start, int row_end);
+
+}  // namespace detail
+}  // namespace cpu_backend_gemm
+}  // namespace tflite
+
+#endif  // TFLITE_HAVE_AVX512_VNNI_GEMV
@@ -0,0 +1,57 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Int8 GEMV using the AVX-512 VNNI dot product instructions.
+//
+// These kernels are compiled with function-level target attributes, so TFLite
+// itself doesn't have to be built for AVX-512. Callers must check
+// CpuBackendContext::HasAvx512Vnni() before running them.
+
+#ifndef TENSORFLOW_LITE_KERNELS_CPU_BACKEND_GEMM_AVX512_VNNI_H_
+#define TENSORFLOW_LITE_KERNELS_CPU_BACKEND_GEMM_AVX512_VNNI_H_
+
+#include <cstdint>
+
+#include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
+
+#if (defined(__i386__) || defined(__x86_64__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define TFLITE_HAVE_AVX512_VNNI_GEMV
+#endif
+
+namespace tflite {
+namespace cpu_backend_gemm {
+namespace detail {
+
+#ifdef TFLITE_HAVE_AVX512_VNNI_GEMV
+
+// Computes rows [row_start, row_end) of the product of a row-major int8
+// matrix by an int8 column vector, requantized to int8. Requires
+// row_end - row_start >= 4.
+template <QuantizationFlavor quantization_flavor>
+void Avx512VnniGemvInt8(
+    const MatrixParams<std::int8_t>& lhs_params, const std::int8_t* lhs_data,
+    const MatrixParams<std::int8_t>& rhs_params, const std::int8_t* rhs_data,
+    const MatrixParams<std::int8_t>& dst_params, std::int8_t* dst_data,
+    const GemmParams<std::int32_t, std::int8_t, quantization_flavor>& params,
+    int row_start, int row_end);
+
+#endif  // TFLITE_HAVE_AVX512_VNNI_GEMV
+
+}  // namespace detail
+}  // namespace cpu_backend_gemm
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_CPU_BACKEND_GEMM_AVX512_VNNI_H_
@@ -40,6 +40,7 @@ limitations under the License.
 
 #include "ruy/profiler/instrumentation.h"  // from @ruy
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_gemm_avx512_vnni.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
 #include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 #include "tensorflow/lite/kernels/internal/common.h"
@@ -93,9 +94,12 @@ struct CustomGemvImpl {
       int row_start, int row_end) {}
 };
 
-// Wraps CustomGemvImpl for multi-threaded operation.
+// Wraps CustomGemvImpl, or another implementation with the same interface,
+// for multi-threaded operation.
 template <typename LhsScalar, typename RhsScalar, typename AccumScalar,
-          typename DstScalar, QuantizationFlavor quantization_flavor>
+          typename DstScalar, QuantizationFlavor quantization_flavor,
+          typename Impl = CustomGemvImpl<LhsScalar, RhsScalar, AccumScalar,
+                                         DstScalar, quantization_flavor>>
 class CustomGemvTask : public cpu_backend_threadpool::Task {
  public:
   CustomGemvTask(
@@ -115,8 +119,6 @@ class CustomGemvTask : public cpu_backend_threadpool::Task {
         row_end_(row_end) {}
 
   void Run() override {
-    using Impl = CustomGemvImpl<LhsScalar, RhsScalar, AccumScalar, DstScalar,
-                                quantization_flavor>;
     Impl::Run(lhs_params_, lhs_data_, rhs_params_, rhs_data_, dst_params_,
               dst_data_, params_, row_start_, row_end_);
   }
@@ -141,9 +143,11 @@ class CustomGemvTask : public cpu_backend_threadpool::Task {
 //
 // Here is only high-level logic.
 // The actual implementation details are in specializations of
-// CustomGemvImpl.
+// CustomGemvImpl, or in `Impl` if given.
 template <typename LhsScalar, typename RhsScalar, typename AccumScalar,
-          typename DstScalar, QuantizationFlavor quantization_flavor>
+          typename DstScalar, QuantizationFlavor quantization_flavor,
+          typename Impl = CustomGemvImpl<LhsScalar, RhsScalar, AccumScalar,
+                                         DstScalar, quantization_flavor>>
 bool CustomGemv(
     const MatrixParams<LhsScalar>& lhs_params, const LhsScalar* lhs_data,
     const MatrixParams<RhsScalar>& rhs_params, const RhsScalar* rhs_data,
@@ -151,8 +155,6 @@ bool CustomGemv(
     const GemmParams<AccumScalar, DstScalar, quantization_flavor>& params,
     CpuBackendContext* context) {
   ruy::profiler::ScopeLabel label("cpu_backend_gemm::Gemm: CustomGemv");
-  using Impl = CustomGemvImpl<LhsScalar, RhsScalar, AccumScalar, DstScalar,
-                              quantization_flavor>;
   if (lhs_params.rows < Impl::kKernelRows) {
     return false;
   }
@@ -169,7 +171,7 @@ bool CustomGemv(
               params, 0, lhs_params.rows);
   } else {
     using Task = CustomGemvTask<LhsScalar, RhsScalar, AccumScalar, DstScalar,
-                                quantization_flavor>;
+                                quantization_flavor, Impl>;
     std::vector<Task> tasks;
     tasks.reserve(thread_count);
     const int kRowsPerThread =
@@ -186,6 +188,69 @@ bool CustomGemv(
   return true;
 }
 
+#ifdef TFLITE_HAVE_AVX512_VNNI_GEMV
+
+// Int8 Gemv using AVX-512 VNNI, only used when the CPU supports it. See
+// TryAvx512VnniGemv.
+template <QuantizationFlavor quantization_flavor>
+struct Avx512VnniGemvImpl {
+  static constexpr int kKernelRows = 4;
+
+  static bool IsSupportedGivenSufficientlyManyRows(
+      const MatrixParams<std::int8_t>& lhs_params,
+      const MatrixParams<std::int8_t>& rhs_params,
+      const MatrixParams<std::int8_t>& dst_params,
+      const GemmParams<std::int32_t, std::int8_t, quantization_flavor>&
+          params) {
+    return true;
+  }
+
+  static void Run(
+      const MatrixParams<std::int8_t>& lhs_params, const std::int8_t* lhs_data,
+      const MatrixParams<std::int8_t>& rhs_params, const std::int8_t* rhs_data,
+      const MatrixParams<std::int8_t>& dst_params, std::int8_t* dst_data,
+      const GemmParams<std::int32_t, std::int8_t, quantization_flavor>& params,
+      int row_start, int row_end) {
+    Avx512VnniGemvInt8(lhs_params, lhs_data, rhs_params, rhs_data, dst_params,
+                       dst_data, params, row_start, row_end);
+  }
+};
+
+#endif  // TFLITE_HAVE_AVX512_VNNI_GEMV
+
+// Either performs the requested Gemv operation with a kernel selected at
+// runtime from the CPU features and returns true, or immediately returns
+// false. Only int8 Gemv has such kernels.
+template <typename LhsScalar, typename RhsScalar, typename AccumScalar,
+          typename DstScalar, QuantizationFlavor quantization_flavor>
+bool TryRuntimeDispatchedGemv(
+    const MatrixParams<LhsScalar>& lhs_params, const LhsScalar* lhs_data,
+    const MatrixParams<RhsScalar>& rhs_params, const RhsScalar* rhs_data,
+    const MatrixParams<DstScalar>& dst_params, DstScalar* dst_data,
+    const GemmParams<AccumScalar, DstScalar, quantization_flavor>& params,
+    CpuBackendContext* context) {
+  return false;
+}
+
+template <QuantizationFlavor quantization_flavor>
+bool TryRuntimeDispatchedGemv(
+    const MatrixParams<std::int8_t>& lhs_params, const std::int8_t* lhs_data,
+    const MatrixParams<std::int8_t>& rhs_params, const std::int8_t* rhs_data,
+    const MatrixParams<std::int8_t>& dst_params, std::int8_t* dst_data,
+    const GemmParams<std::int32_t, std::int8_t, quantization_flavor>& params,
+    CpuBackendContext* context) {
+#ifdef TFLITE_HAVE_AVX512_VNNI_GEMV
+  if (context->HasAvx512Vnni()) {
+    return CustomGemv<std::int8_t, std::int8_t, std::int32_t, std::int8_t,
+                      quantization_flavor,
+                      Avx512VnniGemvImpl<quantization_flavor>>(
+        lhs_params, lhs_data, rhs_params, rhs_data, dst_params, dst_data,
+        params, context);
+  }
+#endif  // TFLITE_HAVE_AVX512_VNNI_GEMV
+  return false;
+}
+
 // USE_NEON still allows for x86 where we may be using the arm_neon_sse.h
 // wrapper implementing NEON intrinsics on top of SSE4 intrinsics.
 #ifdef USE_NEON
@@ -53,6 +53,16 @@ bool SupportedSparsityFormat(const TfLiteSparsity& sparsity) {
 static const int kDimMetadataSizeRandomSparse = 2;
 static const int kDimMetadataSizeBlockSparse = 3;
 
+// Returns true if the 2D weight described by `sparsity` is blocked along the
+// single dimension `block_dim` with blocks of `block_size` elements.
+bool IsBlockSparse(const TfLiteSparsity& sparsity, int block_dim,
+                   int block_size) {
+  return sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
+         sparsity.block_map != nullptr && sparsity.block_map->size == 1 &&
+         sparsity.block_map->data[0] == block_dim &&
+         sparsity.dim_metadata[2].dense_size == block_size;
+}
+
 TfLiteStatus CreateLedgerTensor(const TfLiteSparsity* sparsity,
                                 TfLiteContext* context, TfLiteTensor* ledger) {
   TF_LITE_ENSURE(context, sparsity != nullptr);
@@ -1051,8 +1061,7 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
             filter_shape, GetTensorData<float>(filter),  // Disable formatting
             bias_shape, GetTensorData<float>(bias),      // Disable formatting
             output_shape, GetTensorData<float>(output));
-      } else if (sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
-                 sparsity.dim_metadata[2].dense_size == 4) {
+      } else if (IsBlockSparse(sparsity, /*block_dim=*/1, /*block_size=*/4)) {
         // Block sparse with block size of 1x4.
         optimized_ops::FullyConnectedSparseWeight1x4(
             sparsity, op_params,                         // Disable formatting
@@ -1061,6 +1070,17 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
             bias_shape, GetTensorData<float>(bias),      // Disable formatting
             output_shape, GetTensorData<float>(output),
             CpuBackendContext::GetFromContext(context));
+      } else if (IsBlockSparse(sparsity, /*block_dim=*/0, /*block_size=*/8) &&
+                 sparsity.dim_metadata[0].dense_size * 8 ==
+                     filter_shape.Dims(0)) {
+        // Block sparse with block size of 8x1.
+        optimized_ops::FullyConnectedSparseWeight8x1(
+            sparsity, op_params,                         // Disable formatting
+            input_shape, GetTensorData<float>(input),    // Disable formatting
+            filter_shape, GetTensorData<float>(filter),  // Disable formatting
+            bias_shape, GetTensorData<float>(bias),      // Disable formatting
+            output_shape, GetTensorData<float>(output),
+            CpuBackendContext::GetFromContext(context));
       } else {
         TF_LITE_KERNEL_LOG(context,
                            "Unsupported sparse fully-connected weight format.");
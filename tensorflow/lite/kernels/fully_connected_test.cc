@@ -1558,6 +1558,53 @@ TEST_P(SparseFullyConnectedOpTest, Simple1x4Test) {
   EXPECT_THAT(m.GetOutput(), ElementsAre(289, 290, 291, 81, 82, 83));
 }
 
+TEST_P(SparseFullyConnectedOpTest, Simple8x1Test) {
+  std::initializer_list<float> weight_data = {
+      1, 0, 2, 0,   // u = 0
+      1, 0, 2, 0,   // u = 1
+      1, 0, 2, 0,   // u = 2
+      1, 0, 2, 0,   // u = 3
+      2, 0, 1, 0,   // u = 4
+      2, 0, 1, 0,   // u = 5
+      2, 0, 1, 0,   // u = 6
+      2, 0, 1, 0,   // u = 7
+      0, 1, 0, -1,  // u = 8
+      0, 1, 0, -1,  // u = 9
+      0, 1, 0, -1,  // u = 10
+      0, 1, 0, -1,  // u = 11
+      0, 3, 0, 1,   // u = 12
+      0, 3, 0, 1,   // u = 13
+      0, 3, 0, 1,   // u = 14
+      0, 3, 0, 1,   // u = 15
+  };
+  TensorData weight = {};
+  weight.type = TensorType_FLOAT32;
+  weight.shape = {16, 4};
+  weight.traversal_order = {0, 1, 2};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {0};
+  weight.block_size = {8};
+  SparseFullyConnectedOpModel<float> m(GetRegistration(),
+                                       /*units=*/16, /*batches=*/2,
+                                       /*input=*/{TensorType_FLOAT32, {2, 4}},
+                                       weight, weight_data);
+  m.SetBias({1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16});
+
+  m.SetInput({
+      1, 2, 3, 4,    // b = 0
+      -1, 2, -3, 4,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 16));
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray({8, 9, 10, 11, 10, 11, 12, 13,  // b = 0
+                                7, 8, 9, 10, 23, 24, 25, 26,   // b = 0
+                                0, 0, 0, 0, 0, 1, 2, 3,        // b = 1
+                                7, 8, 9, 10, 23, 24, 25, 26}));
+}
+
 TEST_P(SparseFullyConnectedOpTest, Simple1x4TestNoBias) {
   std::initializer_list<float> weight_data = {
       1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,  // u = 0
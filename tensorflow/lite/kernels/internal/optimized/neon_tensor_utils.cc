@@ -1955,6 +1955,39 @@ void NeonSparseMatrixBatchVectorMultiplyAccumulate1x4(
   }
 }
 
+void NeonSparseMatrixBatchVectorMultiplyAccumulate8x1(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  constexpr int kBlockSize = 2 * kFloatValuesPerNeonVector;
+  TFLITE_DCHECK_EQ(m_rows % kBlockSize, 0);
+
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    const float* vector_in_batch = vector + batch * m_cols;
+    float* result_in_batch = result + batch * m_rows;
+    for (int row_block = 0; row_block < m_rows / kBlockSize; row_block++) {
+      float32x4_t acc0_32x4 = vmovq_n_f32(0.0);
+      float32x4_t acc1_32x4 = vmovq_n_f32(0.0);
+
+      for (int i = segments[row_block]; i < segments[row_block + 1]; i++) {
+        // Each block is one column of 8 rows, so it is scaled by a single
+        // vector value.
+        const float vector_value = vector_in_batch[indices[i]];
+        acc0_32x4 = vmlaq_n_f32(acc0_32x4, vld1q_f32(matrix_ptr), vector_value);
+        acc1_32x4 =
+            vmlaq_n_f32(acc1_32x4, vld1q_f32(matrix_ptr + 4), vector_value);
+        matrix_ptr += kBlockSize;
+      }
+      vst1q_f32(result_in_batch,
+                vaddq_f32(vld1q_f32(result_in_batch), acc0_32x4));
+      vst1q_f32(result_in_batch + 4,
+                vaddq_f32(vld1q_f32(result_in_batch + 4), acc1_32x4));
+      result_in_batch += kBlockSize;
+    }
+  }
+}
+
 void NeonSparseMatrixBatchVectorMultiplyAccumulate1x16(
     const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
@@ -196,6 +196,37 @@ void Avx2MatrixBatchVectorMultiplyAccumulateImpl(
   }
 }
 
+void Avx2SparseMatrixBatchVectorMultiplyAccumulate8x1Impl(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  // A 8x1 block holds exactly one YMM register worth of float values.
+  constexpr int kBlockSize = kFloatValuesPerAvx2Vector;
+  TFLITE_DCHECK_EQ(m_rows % kBlockSize, 0);
+
+  for (int b = 0; b < n_batch; ++b) {
+    const float* matrix_ptr = matrix;
+    const float* vector_in_batch = vector + b * m_cols;
+    float* result_in_batch = result + b * m_rows;
+    for (int row_block = 0; row_block < m_rows / kBlockSize; ++row_block) {
+      __m256 acc_32x8 = _mm256_setzero_ps();
+      for (int i = segments[row_block]; i < segments[row_block + 1]; ++i) {
+        // Broadcast the vector value of the block's column and multiply it
+        // with the 8 rows of the block.
+        const __m256 vector_f32x8 =
+            _mm256_broadcast_ss(vector_in_batch + indices[i]);
+        const __m256 matrix_f32x8 = _mm256_loadu_ps(matrix_ptr);
+        acc_32x8 =
+            _mm256_add_ps(acc_32x8, _mm256_mul_ps(vector_f32x8, matrix_f32x8));
+        matrix_ptr += kBlockSize;
+      }
+      acc_32x8 = _mm256_add_ps(_mm256_loadu_ps(result_in_batch), acc_32x8);
+      _mm256_storeu_ps(result_in_batch, acc_32x8);
+      result_in_batch += kBlockSize;
+    }
+  }
+}
+
 void Avx2MatrixBatchVectorMultiplyAccumulateImpl(
     const int8_t* __restrict__ matrix, const int m_rows, const int m_cols,
     const int8_t* __restrict__ vectors,
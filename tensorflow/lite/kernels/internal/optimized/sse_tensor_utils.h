@@ -84,6 +84,19 @@ void SparseMatrixBatchVectorMultiplyAccumulate1x4(
                    segments, indices, m_rows, m_cols, vector, n_batch, result);
 }
 
+void SparseMatrixBatchVectorMultiplyAccumulate8x1(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+#if defined(__AVX2__)
+  Avx2SparseMatrixBatchVectorMultiplyAccumulate8x1Impl(
+      matrix, segments, indices, m_rows, m_cols, vector, n_batch, result);
+#else
+  NEON_OR_PORTABLE(SparseMatrixBatchVectorMultiplyAccumulate8x1, matrix,
+                   segments, indices, m_rows, m_cols, vector, n_batch, result);
+#endif
+}
+
 void SparseMatrixBatchVectorMultiplyAccumulate1x16(
     const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
@@ -40,6 +40,12 @@ void Avx2MatrixBatchVectorMultiplyAccumulateImpl(
     float* __restrict__ result, const float* per_channel_scale,
     const int32_t* input_offset, int32_t* scratch, int32_t* row_sums,
     bool* compute_row_sums, CpuBackendContext* context);
+
+// Matrix multiplication for float values, sparse with block pattern 8x1.
+void Avx2SparseMatrixBatchVectorMultiplyAccumulate8x1Impl(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result);
 #endif  // defined(__AVX2__)
 
 #ifdef __SSSE3__
@@ -188,6 +188,18 @@ void SparseMatrixBatchVectorMultiplyAccumulate1x4(
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
     const float* __restrict__ vector, int n_batch, float* __restrict__ result);
 
+// Same as the function above, but the matrix is a sparse tensor with block
+// pattern 8x1, i.e. each block covers 8 consecutive rows of a single column.
+// `segments` and `indices` describe the CSR layout of the row blocks and
+// `indices` holds column indexes. The 8 values of a block are stored
+// contiguously.
+// This function assumes that m_rows is a multiple of the block size (8 in this
+// case) so that there's no incomplete block.
+void SparseMatrixBatchVectorMultiplyAccumulate8x1(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result);
+
 // Same as the function above, but the matrix is stored in block compressed
 // sparse row format with block pattern 1x16 which consists of two arrays:
 //   1. A matrix array stores non-zero blocks of the matrix in row major.
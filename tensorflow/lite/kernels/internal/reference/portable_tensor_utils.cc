@@ -227,6 +227,31 @@ void PortableSparseMatrixBatchVectorMultiplyAccumulate1x4(
   }
 }
 
+void PortableSparseMatrixBatchVectorMultiplyAccumulate8x1(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  const int kBlockSize = 8;
+  TFLITE_DCHECK_EQ(m_rows % kBlockSize, 0);
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    const float* vector_in_batch = vector + batch * m_cols;
+    for (int row_block = 0; row_block < m_rows / kBlockSize; row_block++) {
+      float dot_prod[kBlockSize] = {0.0f};
+      for (int i = segments[row_block]; i < segments[row_block + 1]; i++) {
+        const float vector_value = vector_in_batch[indices[i]];
+        for (int r = 0; r < kBlockSize; r++) {
+          dot_prod[r] += *matrix_ptr++ * vector_value;
+        }
+      }
+      float* result_in_batch = result + batch * m_rows + row_block * kBlockSize;
+      for (int r = 0; r < kBlockSize; r++) {
+        result_in_batch[r] += dot_prod[r];
+      }
+    }
+  }
+}
+
 void PortableSparseMatrixBatchVectorMultiplyAccumulate1x16(
     const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
@@ -15,12 +15,28 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_MEMORY_PLANNER_H_
 #define TENSORFLOW_LITE_MEMORY_PLANNER_H_
 
+#include <stddef.h>
+
 #include <vector>
 
 #include "tensorflow/lite/c/common.h"
 
 namespace tflite {
 
+// Orders in which an arena-based memory planner assigns offsets to tensors.
+// Every tensor is placed in the smallest gap that fits it among the tensors
+// already placed, so the order determines how fragmented the arena gets.
+enum class ArenaPlanningStrategy {
+  // Largest tensors first.
+  kGreedyBySize,
+  // Tensors live at the nodes that need the most memory first, largest first
+  // within a node.
+  kGreedyByBreadth,
+  // Plans with each of the orders above, and also with the longest-lived
+  // tensors first, and keeps the one with the smallest arena. Slower to plan.
+  kBestOf,
+};
+
 // A MemoryPlanner is responsible for planning and executing a number of
 // memory-related operations that are necessary in TF Lite.
 class MemoryPlanner {
@@ -65,6 +81,15 @@ class MemoryPlanner {
   // Dumps the memory planning information against the specified op node
   // execution plan (i.e. `execution_plan`) for the purpose of debugging.
   virtual void DumpDebugInfo(const std::vector<int>& execution_plan) const = 0;
+
+  // Returns in `arena_size` the number of bytes of the non-persistent arena
+  // planned so far, and in `lower_bound` the largest total size of the
+  // non-persistent tensors live at the same time, which no plan can go below.
+  // Planners that don't use an arena return zero for both.
+  virtual void GetArenaSizeInfo(size_t* arena_size, size_t* lower_bound) const {
+    *arena_size = 0;
+    *lower_bound = 0;
+  }
 };
 
 }  // namespace tflite
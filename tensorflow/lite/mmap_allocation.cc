@@ -20,6 +20,8 @@ limitations under the License.
 #include <unistd.h>
 
 #include <cerrno>
+#include <cstdint>
+#include <cstring>
 
 #include "tensorflow/lite/allocation.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
@@ -27,6 +29,10 @@ limitations under the License.
 namespace tflite {
 namespace {
 
+// The alignment of the copies made for `Options::copy_to_huge_pages`, which is
+// the size of a transparent huge page on x86-64 and arm64.
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
 size_t GetFdSizeBytes(int fd) {
   if (fd < 0) {
     return 0;
@@ -40,18 +46,65 @@ size_t GetFdSizeBytes(int fd) {
   return fd_stat.st_size;
 }
 
+// Reads one byte of every page of `buffer`, so that the pages are faulted in
+// now rather than during the first inference.
+void TouchPages(const void* buffer, size_t size, size_t pagesize) {
+  const volatile char* bytes = static_cast<const volatile char*>(buffer);
+  for (size_t i = 0; i < size; i += pagesize) {
+    (void)bytes[i];
+  }
+}
+
+// Copies `size` bytes of `buffer` into read-only anonymous memory that starts
+// at a multiple of kHugePageSize and is advised for huge pages. The copy spans
+// `size` rounded up to `pagesize`, so it can be unmapped with `size` like the
+// file mapping it replaces. Returns MAP_FAILED if the memory can't be mapped.
+void* CopyToHugePages(const void* buffer, size_t size, size_t pagesize) {
+  const size_t copy_size = (size + pagesize - 1) / pagesize * pagesize;
+  // Over-reserve by a huge page, so that an aligned start exists, and trim
+  // the unaligned head and the tail afterwards.
+  const size_t reserved_size = copy_size + kHugePageSize;
+  char* reserved = static_cast<char*>(mmap(nullptr, reserved_size,
+                                           PROT_READ | PROT_WRITE,
+                                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  if (reserved == MAP_FAILED) {
+    return MAP_FAILED;
+  }
+  char* copy = reinterpret_cast<char*>(
+      (reinterpret_cast<uintptr_t>(reserved) + kHugePageSize - 1) &
+      ~static_cast<uintptr_t>(kHugePageSize - 1));
+  if (copy > reserved) {
+    munmap(reserved, copy - reserved);
+  }
+  char* copy_end = copy + copy_size;
+  char* reserved_end = reserved + reserved_size;
+  if (reserved_end > copy_end) {
+    munmap(copy_end, reserved_end - copy_end);
+  }
+#ifdef MADV_HUGEPAGE
+  madvise(copy, copy_size, MADV_HUGEPAGE);
+#endif
+  memcpy(copy, buffer, size);
+  mprotect(copy, copy_size, PROT_READ);
+  return copy;
+}
+
 }  // namespace
 
 MMAPAllocation::MMAPAllocation(const char* filename,
                                ErrorReporter* error_reporter)
-    : MMAPAllocation(error_reporter, open(filename, O_RDONLY)) {
+    : MMAPAllocation(filename, Options(), error_reporter) {}
+
+MMAPAllocation::MMAPAllocation(const char* filename, const Options& options,
+                               ErrorReporter* error_reporter)
+    : MMAPAllocation(error_reporter, open(filename, O_RDONLY), options) {
   if (mmap_fd_ == -1) {
     TF_LITE_REPORT_ERROR(error_reporter, "Could not open '%s'.", filename);
   }
 }
 
 MMAPAllocation::MMAPAllocation(int fd, ErrorReporter* error_reporter)
-    : MMAPAllocation(error_reporter, dup(fd)) {
+    : MMAPAllocation(error_reporter, dup(fd), Options()) {
   if (mmap_fd_ == -1) {
     TF_LITE_REPORT_ERROR(error_reporter, "Failed to dup '%d' file descriptor.",
                          fd);
@@ -60,19 +113,26 @@ MMAPAllocation::MMAPAllocation(int fd, ErrorReporter* error_reporter)
 
 MMAPAllocation::MMAPAllocation(int fd, size_t offset, size_t length,
                                ErrorReporter* error_reporter)
-    : MMAPAllocation(error_reporter, dup(fd), offset, length) {
+    : MMAPAllocation(fd, offset, length, Options(), error_reporter) {}
+
+MMAPAllocation::MMAPAllocation(int fd, size_t offset, size_t length,
+                               const Options& options,
+                               ErrorReporter* error_reporter)
+    : MMAPAllocation(error_reporter, dup(fd), offset, length, options) {
   if (mmap_fd_ == -1) {
     TF_LITE_REPORT_ERROR(error_reporter, "Failed to dup '%d' file descriptor.",
                          fd);
   }
 }
 
-MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd)
+MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd,
+                               const Options& options)
     : MMAPAllocation(error_reporter, owned_fd, /*offset=*/0,
-                     /*length=*/GetFdSizeBytes(owned_fd)) {}
+                     /*length=*/GetFdSizeBytes(owned_fd), options) {}
 
 MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd,
-                               size_t offset, size_t length)
+                               size_t offset, size_t length,
+                               const Options& options)
     : Allocation(error_reporter, Allocation::Type::kMMap),
       mmap_fd_(owned_fd),
       mmapped_buffer_(MAP_FAILED),
@@ -98,15 +158,50 @@ MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd,
     return;
   }
 
-  mmapped_buffer_ =
-      mmap(nullptr, /*__len=*/length + offset_in_buffer_, PROT_READ, MAP_SHARED,
-           mmap_fd_, /*__offset=*/offset - offset_in_buffer_);
+  int flags = MAP_SHARED;
+  bool populated = false;
+#ifdef MAP_POPULATE
+  // The copy reads the whole mapping anyway.
+  if (options.prefault && !options.copy_to_huge_pages) {
+    flags |= MAP_POPULATE;
+    populated = true;
+  }
+#endif
+  const size_t mapped_size = length + offset_in_buffer_;
+  mmapped_buffer_ = mmap(nullptr, /*__len=*/mapped_size, PROT_READ, flags,
+                         mmap_fd_, /*__offset=*/offset - offset_in_buffer_);
   if (mmapped_buffer_ == MAP_FAILED) {
     TF_LITE_REPORT_ERROR(error_reporter,
                          "Mmap of '%d' at offset '%d' failed with error '%d'.",
                          mmap_fd_, offset, errno);
     return;
   }
+
+  if (options.copy_to_huge_pages) {
+    void* copy = CopyToHugePages(mmapped_buffer_, mapped_size, pagesize);
+    if (copy != MAP_FAILED) {
+      munmap(const_cast<void*>(mmapped_buffer_), mapped_size);
+      mmapped_buffer_ = copy;
+      return;
+    }
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Copying '%d' bytes of '%d' to huge pages failed with "
+                         "error '%d'. Using the file mapping instead.",
+                         length, mmap_fd_, errno);
+  }
+  // Advice is best effort, so failures are ignored.
+  void* mapped = const_cast<void*>(mmapped_buffer_);
+  if (options.will_need) {
+    madvise(mapped, mapped_size, MADV_WILLNEED);
+  }
+#ifdef MADV_HUGEPAGE
+  if (options.huge_pages) {
+    madvise(mapped, mapped_size, MADV_HUGEPAGE);
+  }
+#endif
+  if (options.prefault && !populated) {
+    TouchPages(mmapped_buffer_, mapped_size, pagesize);
+  }
 }
 
 MMAPAllocation::~MMAPAllocation() {
@@ -0,0 +1,71 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/packed_weights_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+
+namespace tflite {
+
+constexpr size_t PackedWeightsCache::kAlignment;
+
+PackedWeightsCache::Entry::Entry(size_t bytes)
+    : buffer_(new char[bytes + kAlignment]), bytes_(bytes) {
+  const uintptr_t base = reinterpret_cast<uintptr_t>(buffer_.get());
+  data_ = reinterpret_cast<void*>((base + kAlignment - 1) & ~(kAlignment - 1));
+}
+
+std::shared_ptr<const PackedWeightsCache::Entry> PackedWeightsCache::GetOrPack(
+    const Key& key, size_t packed_bytes,
+    const std::function<void(void* packed_data)>& pack) {
+  // Packing runs under the lock: it happens once per entry, normally while
+  // interpreters are being prepared, and holding the lock guarantees that
+  // racing interpreters don't pack the same weights twice.
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    if (auto entry = it->second.lock()) {
+      if (entry->bytes() == packed_bytes) return entry;
+    }
+  }
+
+  auto entry = std::make_shared<Entry>(packed_bytes);
+  pack(entry->data_);
+  entries_[key] = entry;
+
+  // Drop the bookkeeping of entries no kernel holds anymore.
+  for (auto i = entries_.begin(); i != entries_.end();) {
+    if (i->second.expired()) {
+      i = entries_.erase(i);
+    } else {
+      ++i;
+    }
+  }
+  return entry;
+}
+
+size_t PackedWeightsCache::num_entries() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t count = 0;
+  for (const auto& entry : entries_) {
+    if (!entry.second.expired()) ++count;
+  }
+  return count;
+}
+
+}  // namespace tflite
@@ -0,0 +1,105 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PACKED_WEIGHTS_CACHE_H_
+#define TENSORFLOW_LITE_PACKED_WEIGHTS_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <tuple>
+
+namespace tflite {
+
+// A thread-safe cache of kernel-specific, repacked copies of constant weights
+// that can be shared by several interpreters running the same model.
+//
+// Kernels that keep a transformed copy of a constant tensor (e.g. a transposed
+// filter) look it up here instead of allocating it in their own arena. Entries
+// are keyed by the address and size of the source buffer, which is the same
+// for all interpreters built from the same FlatBufferModel, and by a
+// kernel-defined layout fingerprint. Entries are reference counted: they are
+// released when the last kernel holding them goes away.
+//
+// Usage:
+//
+//   auto cache = std::make_shared<tflite::PackedWeightsCache>();
+//   tflite::InterpreterOptions options;
+//   options.SetPackedWeightsCache(cache);
+//   // Pass `options` to every InterpreterBuilder using the shared model.
+//
+// WARNING: This is an experimental API and subject to change.
+class PackedWeightsCache {
+ public:
+  // Identifies a packed copy of a constant tensor.
+  struct Key {
+    // Start and size of the source (unpacked) constant buffer.
+    const void* source_data;
+    size_t source_bytes;
+    // Kernel-defined fingerprint of the packed layout. Kernels must make it
+    // unique among the kernels that may pack the same source buffer, and
+    // include in it anything other than the source data the packing depends
+    // on.
+    uint64_t layout;
+
+    bool operator<(const Key& other) const {
+      return std::tie(source_data, source_bytes, layout) <
+             std::tie(other.source_data, other.source_bytes, other.layout);
+    }
+  };
+
+  // Read-only packed weights, aligned to `kAlignment` bytes.
+  class Entry {
+   public:
+    explicit Entry(size_t bytes);
+
+    const void* data() const { return data_; }
+    size_t bytes() const { return bytes_; }
+
+   private:
+    friend class PackedWeightsCache;
+
+    std::unique_ptr<char[]> buffer_;
+    void* data_;
+    size_t bytes_;
+  };
+
+  static constexpr size_t kAlignment = 64;
+
+  PackedWeightsCache() = default;
+
+  // Returns the packed weights for `key`. On a miss, allocates `packed_bytes`
+  // and calls `pack` once to fill them in. Concurrent lookups of the same key
+  // wait for that call to finish. The returned handle keeps the entry alive.
+  std::shared_ptr<const Entry> GetOrPack(
+      const Key& key, size_t packed_bytes,
+      const std::function<void(void* packed_data)>& pack);
+
+  // Returns the number of entries currently held by at least one kernel.
+  size_t num_entries() const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::map<Key, std::weak_ptr<const Entry>> entries_;
+
+  PackedWeightsCache(const PackedWeightsCache&) = delete;
+  PackedWeightsCache& operator=(const PackedWeightsCache&) = delete;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PACKED_WEIGHTS_CACHE_H_
@@ -0,0 +1,101 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/packed_weights_cache.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace {
+
+TEST(PackedWeightsCacheTest, PacksOncePerKey) {
+  PackedWeightsCache cache;
+  const std::vector<float> weights = {1.f, 2.f, 3.f, 4.f};
+  const PackedWeightsCache::Key key = {
+      weights.data(), weights.size() * sizeof(float), /*layout=*/1};
+  int num_packs = 0;
+  auto pack = [&](void* dst) {
+    ++num_packs;
+    memcpy(dst, weights.data(), weights.size() * sizeof(float));
+  };
+
+  auto first = cache.GetOrPack(key, weights.size() * sizeof(float), pack);
+  auto second = cache.GetOrPack(key, weights.size() * sizeof(float), pack);
+  EXPECT_EQ(num_packs, 1);
+  EXPECT_EQ(first.get(), second.get());
+  EXPECT_EQ(first->bytes(), weights.size() * sizeof(float));
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(first->data()) %
+                PackedWeightsCache::kAlignment,
+            0);
+  EXPECT_EQ(static_cast<const float*>(first->data())[3], 4.f);
+  EXPECT_EQ(cache.num_entries(), 1);
+
+  // A different layout of the same buffer is a different entry.
+  const PackedWeightsCache::Key other_layout = {
+      weights.data(), weights.size() * sizeof(float), /*layout=*/2};
+  auto third = cache.GetOrPack(other_layout, 8, pack);
+  EXPECT_EQ(num_packs, 2);
+  EXPECT_NE(third.get(), first.get());
+  EXPECT_EQ(cache.num_entries(), 2);
+}
+
+TEST(PackedWeightsCacheTest, ReleasesUnusedEntries) {
+  PackedWeightsCache cache;
+  const std::vector<float> weights(16, 1.f);
+  const PackedWeightsCache::Key key = {weights.data(), 64, /*layout=*/0};
+  int num_packs = 0;
+  auto pack = [&](void*) { ++num_packs; };
+
+  auto entry = cache.GetOrPack(key, 64, pack);
+  EXPECT_EQ(cache.num_entries(), 1);
+  entry.reset();
+  EXPECT_EQ(cache.num_entries(), 0);
+
+  // Once released, the weights are packed again on the next lookup.
+  entry = cache.GetOrPack(key, 64, pack);
+  EXPECT_EQ(num_packs, 2);
+  EXPECT_EQ(cache.num_entries(), 1);
+}
+
+TEST(PackedWeightsCacheTest, ConcurrentLookupsShareOneEntry) {
+  PackedWeightsCache cache;
+  const std::vector<float> weights(256, 1.f);
+  const PackedWeightsCache::Key key = {weights.data(), 1024, /*layout=*/0};
+  int num_packs = 0;
+  auto pack = [&](void*) { ++num_packs; };
+
+  constexpr int kNumThreads = 8;
+  std::vector<std::shared_ptr<const PackedWeightsCache::Entry>> entries(
+      kNumThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back(
+        [&, i]() { entries[i] = cache.GetOrPack(key, 1024, pack); });
+  }
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_EQ(num_packs, 1);
+  for (const auto& entry : entries) {
+    EXPECT_EQ(entry.get(), entries[0].get());
+  }
+}
+
+}  // namespace
+}  // namespace tflite
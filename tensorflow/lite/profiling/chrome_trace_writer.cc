@@ -0,0 +1,239 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/profiling/chrome_trace_writer.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/profiling/memory_info.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+// Delegate operators of subgraph `i` go on lane `kDelegateLaneOffset + i`.
+constexpr int64_t kDelegateLaneOffset = 1 << 16;
+
+std::string EscapeJson(const std::string& str) {
+  std::string escaped;
+  escaped.reserve(str.size());
+  for (const char c : str) {
+    switch (c) {
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          escaped += ' ';
+        } else {
+          escaped += c;
+        }
+    }
+  }
+  return escaped;
+}
+
+int64_t NumElements(const TfLiteTensor* tensor) {
+  if (tensor == nullptr || tensor->dims == nullptr) return 0;
+  int64_t count = 1;
+  for (int i = 0; i < tensor->dims->size; ++i) {
+    count *= tensor->dims->data[i];
+  }
+  return count;
+}
+
+// Returns the floating point operations (multiply-adds counting as two) of
+// the node, or 0 if there's no estimate for its op.
+int64_t EstimateFlops(const Subgraph& subgraph, const TfLiteNode& node,
+                      const TfLiteRegistration& registration) {
+  if (node.inputs->size < 2 || node.outputs->size < 1) return 0;
+  const TfLiteTensor* filter = subgraph.tensor(node.inputs->data[1]);
+  const TfLiteTensor* output = subgraph.tensor(node.outputs->data[0]);
+  if (filter == nullptr || filter->dims == nullptr) return 0;
+  const TfLiteIntArray* dims = filter->dims;
+  switch (registration.builtin_code) {
+    case BuiltinOperator_CONV_2D:
+      // Filter is [output_channels, height, width, input_channels].
+      if (dims->size != 4) return 0;
+      return 2 * NumElements(output) * dims->data[1] * dims->data[2] *
+             dims->data[3];
+    case BuiltinOperator_DEPTHWISE_CONV_2D:
+      // Filter is [1, height, width, output_channels].
+      if (dims->size != 4) return 0;
+      return 2 * NumElements(output) * dims->data[1] * dims->data[2];
+    case BuiltinOperator_FULLY_CONNECTED:
+      // Weights are [output_depth, input_depth].
+      if (dims->size != 2) return 0;
+      return 2 * NumElements(output) * dims->data[1];
+    default:
+      return 0;
+  }
+}
+
+int64_t TensorBytes(const Subgraph& subgraph, const TfLiteIntArray* tensors) {
+  int64_t bytes = 0;
+  for (int i = 0; i < tensors->size; ++i) {
+    if (tensors->data[i] == kTfLiteOptionalTensor) continue;
+    const TfLiteTensor* tensor = subgraph.tensor(tensors->data[i]);
+    if (tensor != nullptr) bytes += tensor->bytes;
+  }
+  return bytes;
+}
+
+// Returns the arguments of the span of an operator invocation.
+std::string GetOperatorArgs(const tflite::Interpreter& interpreter,
+                            int64_t subgraph_index, int64_t node_index) {
+  std::stringstream args;
+  args << "\"subgraph\":" << subgraph_index << ",\"node\":" << node_index;
+  if (subgraph_index < 0 || subgraph_index >= interpreter.subgraphs_size()) {
+    return args.str();
+  }
+  // subgraph(...) is non-const member method.
+  const Subgraph& subgraph =
+      *const_cast<tflite::Interpreter&>(interpreter).subgraph(subgraph_index);
+  if (node_index < 0 || node_index >= subgraph.nodes_size()) {
+    return args.str();
+  }
+  const auto* node_reg = subgraph.node_and_registration(node_index);
+  const TfLiteNode& node = node_reg->first;
+  const int64_t input_bytes = TensorBytes(subgraph, node.inputs);
+  const int64_t output_bytes = TensorBytes(subgraph, node.outputs);
+  args << ",\"input_bytes\":" << input_bytes
+       << ",\"output_bytes\":" << output_bytes;
+  const int64_t flops = EstimateFlops(subgraph, node, node_reg->second);
+  if (flops > 0) {
+    args << ",\"flops\":" << flops;
+  }
+  return args.str();
+}
+
+}  // namespace
+
+void ChromeTraceWriter::ProcessProfiles(
+    const std::vector<const ProfileEvent*>& profile_stats,
+    const tflite::Interpreter& interpreter) {
+  // Subgraph and start of the last operator, and where the next delegate
+  // operator without timestamp goes.
+  int64_t op_subgraph_index = 0;
+  uint64_t delegate_op_begin_us = 0;
+
+  for (const ProfileEvent* event : profile_stats) {
+    const int64_t subgraph_index = event->extra_event_metadata;
+    if (event->event_type == Profiler::EventType::OPERATOR_INVOKE_EVENT) {
+      AddCompleteEvent(event->tag, "Operator", subgraph_index,
+                       event->begin_timestamp_us, event->elapsed_time,
+                       GetOperatorArgs(interpreter, subgraph_index,
+                                       event->event_metadata));
+      op_subgraph_index = subgraph_index;
+      delegate_op_begin_us = event->begin_timestamp_us;
+    } else if (event->event_type ==
+               Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT) {
+      uint64_t begin_us = event->begin_timestamp_us;
+      if (begin_us == 0) {
+        // Only the duration was reported, by the delegate node that was
+        // invoked last.
+        begin_us = delegate_op_begin_us;
+        delegate_op_begin_us += event->elapsed_time;
+      }
+      AddCompleteEvent(event->tag, "DelegateOperator",
+                       kDelegateLaneOffset + op_subgraph_index, begin_us,
+                       event->elapsed_time,
+                       "\"node\":" + std::to_string(event->event_metadata));
+    } else {
+      // Events added without a timestamp can't be placed.
+      if (event->begin_timestamp_us == 0) continue;
+      AddCompleteEvent(event->tag, "Runtime", subgraph_index,
+                       event->begin_timestamp_us, event->elapsed_time, "");
+      AddMemoryCounter(event->begin_timestamp_us, event->begin_mem_usage);
+      AddMemoryCounter(event->begin_timestamp_us + event->elapsed_time,
+                       event->end_mem_usage);
+    }
+  }
+}
+
+std::string ChromeTraceWriter::GetOutputString() const {
+  std::stringstream stream;
+  stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for (const int64_t lane : lanes_) {
+    const bool is_delegate_lane = lane >= kDelegateLaneOffset;
+    const int64_t subgraph_index =
+        is_delegate_lane ? lane - kDelegateLaneOffset : lane;
+    stream << (first ? "" : ",")
+           << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":"
+           << lane << ",\"args\":{\"name\":\"Subgraph " << subgraph_index
+           << (is_delegate_lane ? " delegate" : "") << "\"}}";
+    first = false;
+  }
+  for (const std::string& trace_event : trace_events_) {
+    stream << (first ? "" : ",") << "\n" << trace_event;
+    first = false;
+  }
+  stream << "\n]}\n";
+  return stream.str();
+}
+
+bool ChromeTraceWriter::WriteToFile(const std::string& file_path) const {
+  std::ofstream output_file(file_path);
+  if (!output_file.good()) return false;
+  output_file << GetOutputString();
+  return output_file.good();
+}
+
+void ChromeTraceWriter::AddCompleteEvent(const std::string& name,
+                                         const char* category, int64_t tid,
+                                         uint64_t begin_us,
+                                         uint64_t duration_us,
+                                         const std::string& args) {
+  if (std::find(lanes_.begin(), lanes_.end(), tid) == lanes_.end()) {
+    lanes_.push_back(tid);
+  }
+  std::stringstream trace_event;
+  trace_event << "{\"name\":\"" << EscapeJson(name) << "\",\"cat\":\""
+              << category << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << tid
+              << ",\"ts\":" << begin_us << ",\"dur\":" << duration_us
+              << ",\"args\":{" << args << "}}";
+  trace_events_.push_back(trace_event.str());
+}
+
+void ChromeTraceWriter::AddMemoryCounter(uint64_t timestamp_us,
+                                         const memory::MemoryUsage& usage) {
+  if (!memory::MemoryUsage::IsSupported() ||
+      usage.total_allocated_bytes == memory::MemoryUsage::kValueNotSet) {
+    return;
+  }
+  std::stringstream trace_event;
+  trace_event << "{\"name\":\"Memory\",\"ph\":\"C\",\"pid\":0,\"ts\":"
+              << timestamp_us << ",\"args\":{\"max_rss_kb\":"
+              << usage.max_rss_kb
+              << ",\"total_allocated_bytes\":" << usage.total_allocated_bytes
+              << ",\"in_use_allocated_bytes\":" << usage.in_use_allocated_bytes
+              << "}}";
+  trace_events_.push_back(trace_event.str());
+}
+
+}  // namespace profiling
+}  // namespace tflite
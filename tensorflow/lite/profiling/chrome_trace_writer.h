@@ -0,0 +1,72 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_CHROME_TRACE_WRITER_H_
+#define TENSORFLOW_LITE_PROFILING_CHROME_TRACE_WRITER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/profiling/profile_buffer.h"
+
+namespace tflite {
+namespace profiling {
+
+// Collects profile events into a trace in the Chrome trace event format
+// (https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU),
+// which can be opened in chrome://tracing or https://ui.perfetto.dev.
+//
+// Every operator invocation becomes a span on the lane of its subgraph, with
+// the bytes of its input and output tensors and, for the ops where it is
+// well-defined, an estimate of its floating point operations as arguments.
+// Operators run by a delegate go on a lane of their own. Delegates that only
+// report the duration of their operators have them laid out back to back from
+// the start of the delegate node. Other events, like AllocateTensors, also
+// produce counters of the allocator state reported by memory_info.h.
+class ChromeTraceWriter {
+ public:
+  ChromeTraceWriter() = default;
+
+  // Adds the events of one profiled run to the trace.
+  void ProcessProfiles(const std::vector<const ProfileEvent*>& profile_stats,
+                       const tflite::Interpreter& interpreter);
+
+  bool HasProfiles() const { return !trace_events_.empty(); }
+
+  // Returns the trace as a JSON document.
+  std::string GetOutputString() const;
+
+  // Writes the trace as a JSON document to `file_path`. Returns false if the
+  // file can't be written.
+  bool WriteToFile(const std::string& file_path) const;
+
+ private:
+  void AddCompleteEvent(const std::string& name, const char* category,
+                        int64_t tid, uint64_t begin_us, uint64_t duration_us,
+                        const std::string& args);
+  void AddMemoryCounter(uint64_t timestamp_us,
+                        const memory::MemoryUsage& usage);
+
+  // Serialized trace events, one JSON object each.
+  std::vector<std::string> trace_events_;
+  // Subgraphs and delegates that were seen, to name their lanes.
+  std::vector<int64_t> lanes_;
+};
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_CHROME_TRACE_WRITER_H_
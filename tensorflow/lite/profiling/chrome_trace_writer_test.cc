@@ -0,0 +1,131 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/profiling/chrome_trace_writer.h"
+
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+using ::testing::HasSubstr;
+
+TfLiteStatus NoOpEval(TfLiteContext* context, TfLiteNode* node) {
+  return kTfLiteOk;
+}
+
+class ChromeTraceWriterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(interpreter_.AddTensors(3), kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetInputs({0, 1}), kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetOutputs({2}), kTfLiteOk);
+    TfLiteQuantizationParams quant;
+    interpreter_.SetTensorParametersReadWrite(0, kTfLiteFloat32, "input",
+                                              {1, 4}, quant);
+    interpreter_.SetTensorParametersReadWrite(1, kTfLiteFloat32, "weights",
+                                              {3, 4}, quant);
+    interpreter_.SetTensorParametersReadWrite(2, kTfLiteFloat32, "output",
+                                              {1, 3}, quant);
+    registration_ = {nullptr, nullptr, nullptr, NoOpEval};
+    registration_.builtin_code = BuiltinOperator_FULLY_CONNECTED;
+    ASSERT_EQ(interpreter_.AddNodeWithParameters({0, 1}, {2}, nullptr, 0,
+                                                 nullptr, &registration_),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+  }
+
+  ProfileEvent MakeEvent(const char* tag, ProfileEvent::EventType event_type,
+                         uint64_t begin_us, uint64_t elapsed_us,
+                         int64_t metadata) {
+    ProfileEvent event;
+    event.tag = tag;
+    event.event_type = event_type;
+    event.begin_timestamp_us = begin_us;
+    event.elapsed_time = elapsed_us;
+    event.event_metadata = metadata;
+    event.extra_event_metadata = 0;
+    return event;
+  }
+
+  Interpreter interpreter_;
+  TfLiteRegistration registration_;
+};
+
+TEST_F(ChromeTraceWriterTest, Empty) {
+  ChromeTraceWriter writer;
+  EXPECT_FALSE(writer.HasProfiles());
+  EXPECT_THAT(writer.GetOutputString(), HasSubstr("\"traceEvents\":["));
+}
+
+TEST_F(ChromeTraceWriterTest, OperatorSpans) {
+  const ProfileEvent op_event = MakeEvent(
+      "FULLY_CONNECTED", ProfileEvent::EventType::OPERATOR_INVOKE_EVENT, 100,
+      10, /*node_index=*/0);
+  ChromeTraceWriter writer;
+  writer.ProcessProfiles({&op_event}, interpreter_);
+  ASSERT_TRUE(writer.HasProfiles());
+
+  const std::string trace = writer.GetOutputString();
+  EXPECT_THAT(trace, HasSubstr("\"name\":\"FULLY_CONNECTED\",\"cat\":"
+                               "\"Operator\",\"ph\":\"X\",\"pid\":0,\"tid\":0,"
+                               "\"ts\":100,\"dur\":10"));
+  // 16 bytes of input, 48 of weights, 3 outputs of 4 multiply-adds each.
+  EXPECT_THAT(trace, HasSubstr("\"input_bytes\":64,\"output_bytes\":12,"
+                               "\"flops\":24"));
+  EXPECT_THAT(trace, HasSubstr("\"args\":{\"name\":\"Subgraph 0\"}"));
+}
+
+TEST_F(ChromeTraceWriterTest, DelegateOperatorsWithoutTimestamps) {
+  const ProfileEvent events[] = {
+      MakeEvent("DELEGATE", ProfileEvent::EventType::OPERATOR_INVOKE_EVENT,
+                100, 10, /*node_index=*/0),
+      MakeEvent("Op1", ProfileEvent::EventType::DELEGATE_OPERATOR_INVOKE_EVENT,
+                0, 4, 0),
+      MakeEvent("Op2", ProfileEvent::EventType::DELEGATE_OPERATOR_INVOKE_EVENT,
+                0, 3, 1),
+  };
+  ChromeTraceWriter writer;
+  writer.ProcessProfiles({&events[0], &events[1], &events[2]}, interpreter_);
+
+  const std::string trace = writer.GetOutputString();
+  EXPECT_THAT(trace, HasSubstr("\"name\":\"Op1\",\"cat\":\"DelegateOperator\","
+                               "\"ph\":\"X\",\"pid\":0,\"tid\":65536,"
+                               "\"ts\":100,\"dur\":4"));
+  EXPECT_THAT(trace, HasSubstr("\"name\":\"Op2\",\"cat\":\"DelegateOperator\","
+                               "\"ph\":\"X\",\"pid\":0,\"tid\":65536,"
+                               "\"ts\":104,\"dur\":3"));
+  EXPECT_THAT(trace, HasSubstr("\"name\":\"Subgraph 0 delegate\""));
+}
+
+TEST_F(ChromeTraceWriterTest, EscapesNames) {
+  const ProfileEvent event = MakeEvent(
+      "Model \"v2\"", ProfileEvent::EventType::DEFAULT, 100, 1, 0);
+  ChromeTraceWriter writer;
+  writer.ProcessProfiles({&event}, interpreter_);
+  const std::string trace = writer.GetOutputString();
+  EXPECT_THAT(trace, HasSubstr("\"name\":\"Model \\\"v2\\\"\""));
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace tflite
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/lite/signature_runner.h"
 
+#include <memory>
+#include <utility>
+
 #include "tensorflow/lite/c/c_api_types.h"
 
 namespace tflite {
@@ -31,6 +34,12 @@ SignatureRunner::SignatureRunner(const internal::SignatureDef* signature_def,
   }
 }
 
+SignatureRunner::SignatureRunner(std::unique_ptr<Instance> instance)
+    : SignatureRunner(&instance->signature_def,
+                      instance->subgraphs.front().get()) {
+  instance_ = std::move(instance);
+}
+
 TfLiteTensor* SignatureRunner::input_tensor(const char* input_name) {
   const auto& it = signature_def_->inputs.find(input_name);
   if (it == signature_def_->inputs.end()) {
@@ -17,14 +17,20 @@ limitations under the License.
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/experimental/resource/initialization_status.h"
+#include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/internal/signature_def.h"
 
 namespace tflite {
 class Interpreter;  // Class for friend declarations.
+class InterpreterBuilder;        // Class for friend declarations.
 class SignatureRunnerJNIHelper;  // Class for friend declarations.
 class TensorHandle;              // Class for friend declarations.
 
@@ -83,6 +89,11 @@ class TensorHandle;              // Class for friend declarations.
 /// SignatureRunner objects. Therefore, it is recommended not to call other
 /// Interpreter methods after calling GetSignatureRunner to create
 /// SignatureRunner instances.
+///
+/// To invoke signatures concurrently, build independent SignatureRunner
+/// instances with InterpreterBuilder::BuildSignatureRunner instead. These own
+/// their tensors and arena, share the model weights, and can each be used from
+/// a different thread.
 class SignatureRunner {
  public:
   /// Returns the key for the corresponding signature.
@@ -141,12 +152,31 @@ class SignatureRunner {
   SignatureRunner(const internal::SignatureDef* signature_def,
                   Subgraph* subgraph);
   friend class Interpreter;
+  friend class InterpreterBuilder;
   friend class SignatureRunnerJNIHelper;
   friend class TensorHandle;
 
-  // The SignatureDef object is owned by the interpreter.
+  // The state owned by a runner built by InterpreterBuilder, which does not
+  // depend on an Interpreter.
+  struct Instance {
+    internal::SignatureDef signature_def;
+    TfLiteExternalContext* external_contexts[kTfLiteMaxExternalContexts];
+    std::unique_ptr<ExternalCpuBackendContext> cpu_backend_context;
+    resource::ResourceMap resources;
+    resource::ResourceIDMap resource_ids;
+    resource::InitializationStatusMap initialization_status_map;
+    // Holds the single subgraph of the signature, and is declared last so
+    // that it is destroyed before the contexts and resources its kernels use.
+    std::vector<std::unique_ptr<Subgraph>> subgraphs;
+  };
+
+  explicit SignatureRunner(std::unique_ptr<Instance> instance);
+
+  // Set only for runners built by InterpreterBuilder.
+  std::unique_ptr<Instance> instance_;
+  // The SignatureDef object is owned by the interpreter or by `instance_`.
   const internal::SignatureDef* signature_def_;
-  // The Subgraph object is owned by the interpreter.
+  // The Subgraph object is owned by the interpreter or by `instance_`.
   Subgraph* subgraph_;
   // The list of input tensor names.
   std::vector<const char*> input_names_;
@@ -14,7 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/signature_runner.h"
 
+#include <memory>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -93,5 +96,73 @@ TEST(SignatureRunnerTest, TestMultiSignatures) {
   ASSERT_EQ(sub_output->data.f[2], 3);
 }
 
+TEST(SignatureRunnerTest, TestConcurrentSignatureRunners) {
+  TestErrorReporter reporter;
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/multi_signatures.bin", &reporter);
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolver resolver;
+  InterpreterBuilder builder(*model, resolver);
+
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(builder(&interpreter), kTfLiteOk);
+  ASSERT_NE(interpreter, nullptr);
+
+  std::unique_ptr<SignatureRunner> runner;
+  ASSERT_NE(builder.BuildSignatureRunner(interpreter.get(), "dummy", &runner),
+            kTfLiteOk);
+  ASSERT_EQ(runner, nullptr);
+
+  // Two instances of "add" and one of "sub", each with its own tensors.
+  const std::vector<const char*> signature_keys = {"add", "add", "sub"};
+  const std::vector<float> offsets = {2, 2, -3};
+  std::vector<std::unique_ptr<SignatureRunner>> runners(signature_keys.size());
+  for (int i = 0; i < runners.size(); ++i) {
+    ASSERT_EQ(builder.BuildSignatureRunner(interpreter.get(),
+                                           signature_keys[i], &runners[i]),
+              kTfLiteOk);
+    ASSERT_NE(runners[i], nullptr);
+    ASSERT_EQ(runners[i]->signature_key(), signature_keys[i]);
+    ASSERT_EQ(runners[i]->ResizeInputTensor("x", {i + 1}), kTfLiteOk);
+    ASSERT_EQ(runners[i]->AllocateTensors(), kTfLiteOk);
+  }
+  ASSERT_NE(runners[0]->input_tensor("x"), runners[1]->input_tensor("x"));
+  ASSERT_NE(runners[0]->input_tensor("x")->data.f,
+            runners[1]->input_tensor("x")->data.f);
+
+  // The interpreter's own runner is unaffected by the instances.
+  SignatureRunner* add_runner = interpreter->GetSignatureRunner("add");
+  ASSERT_NE(add_runner, nullptr);
+  ASSERT_EQ(add_runner->ResizeInputTensor("x", {4}), kTfLiteOk);
+  ASSERT_EQ(add_runner->AllocateTensors(), kTfLiteOk);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < runners.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      TfLiteTensor* input = runners[i]->input_tensor("x");
+      const TfLiteTensor* output = runners[i]->output_tensor("output_0");
+      for (int iteration = 0; iteration < 100; ++iteration) {
+        for (int j = 0; j <= i; ++j) input->data.f[j] = iteration + j;
+        ASSERT_EQ(runners[i]->Invoke(), kTfLiteOk);
+        for (int j = 0; j <= i; ++j) {
+          EXPECT_EQ(output->data.f[j], iteration + j + offsets[i]);
+        }
+      }
+    });
+  }
+  TfLiteTensor* add_input = add_runner->input_tensor("x");
+  const TfLiteTensor* add_output = add_runner->output_tensor("output_0");
+  for (int iteration = 0; iteration < 100; ++iteration) {
+    for (int j = 0; j < 4; ++j) add_input->data.f[j] = -iteration - j;
+    EXPECT_EQ(add_runner->Invoke(), kTfLiteOk);
+    for (int j = 0; j < 4; ++j) {
+      EXPECT_EQ(add_output->data.f[j], 2 - iteration - j);
+    }
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
 }  // namespace
 }  // namespace tflite
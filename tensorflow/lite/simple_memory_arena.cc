@@ -37,23 +37,12 @@ T AlignTo(size_t alignment, T offset) {
                                  : offset + (alignment - offset % alignment);
 }
 
-}  // namespace
-
-namespace tflite {
-TfLiteStatus SimpleMemoryArena::Allocate(
-    TfLiteContext* context, size_t alignment, size_t size, int32_t tensor,
-    int32_t first_node, int32_t last_node,
-    ArenaAllocWithUsageInterval* new_alloc) {
-  TF_LITE_ENSURE(context, alignment <= arena_alignment_);
-  new_alloc->tensor = tensor;
-  new_alloc->first_node = first_node;
-  new_alloc->last_node = last_node;
-  new_alloc->size = size;
-  if (size == 0) {
-    new_alloc->offset = 0;
-    return kTfLiteOk;
-  }
-
+// Returns the offset of the smallest gap between `ordered_allocs` that fits
+// `size` bytes over the usage interval [first_node, last_node], or the end of
+// the allocations live during that interval if there is no such gap.
+size_t FindBestOffset(
+    const std::vector<tflite::ArenaAllocWithUsageInterval>& ordered_allocs,
+    size_t alignment, size_t size, int32_t first_node, int32_t last_node) {
   // If we don't find a better gap just allocate at the end of the buffer.
   const size_t kOffsetNotAssigned = std::numeric_limits<size_t>::max();
   size_t best_offset = kOffsetNotAssigned;
@@ -61,7 +50,7 @@ TfLiteStatus SimpleMemoryArena::Allocate(
 
   // Go through the sorted allocs and look at the gaps between them.
   size_t current_offset = 0;
-  for (const auto& alloc : ordered_allocs_) {
+  for (const auto& alloc : ordered_allocs) {
     if (alloc.last_node < first_node || alloc.first_node > last_node) {
       // Usage interval of alloc doesn't intersect with current tensor's usage
       // interval, so we skip it.
@@ -80,6 +69,28 @@ TfLiteStatus SimpleMemoryArena::Allocate(
   if (best_offset == kOffsetNotAssigned) {
     best_offset = AlignTo(alignment, current_offset);
   }
+  return best_offset;
+}
+
+}  // namespace
+
+namespace tflite {
+TfLiteStatus SimpleMemoryArena::Allocate(
+    TfLiteContext* context, size_t alignment, size_t size, int32_t tensor,
+    int32_t first_node, int32_t last_node,
+    ArenaAllocWithUsageInterval* new_alloc) {
+  TF_LITE_ENSURE(context, alignment <= arena_alignment_);
+  new_alloc->tensor = tensor;
+  new_alloc->first_node = first_node;
+  new_alloc->last_node = last_node;
+  new_alloc->size = size;
+  if (size == 0) {
+    new_alloc->offset = 0;
+    return kTfLiteOk;
+  }
+
+  const size_t best_offset =
+      FindBestOffset(ordered_allocs_, alignment, size, first_node, last_node);
 
   // Update the required buffer size.
   high_water_mark_ = std::max(high_water_mark_, best_offset + size);
@@ -91,6 +102,45 @@ TfLiteStatus SimpleMemoryArena::Allocate(
   return kTfLiteOk;
 }
 
+TfLiteStatus SimpleMemoryArena::AllocateAtOffset(
+    TfLiteContext* context, size_t alignment, size_t offset, size_t size,
+    int32_t tensor, int32_t first_node, int32_t last_node,
+    ArenaAllocWithUsageInterval* new_alloc) {
+  TF_LITE_ENSURE(context, alignment <= arena_alignment_);
+  TF_LITE_ENSURE_EQ(context, offset % alignment, 0);
+  new_alloc->tensor = tensor;
+  new_alloc->first_node = first_node;
+  new_alloc->last_node = last_node;
+  new_alloc->size = size;
+  if (size == 0) {
+    new_alloc->offset = 0;
+    return kTfLiteOk;
+  }
+  new_alloc->offset = offset;
+  high_water_mark_ = std::max(high_water_mark_, offset + size);
+  auto insertion_it = std::upper_bound(ordered_allocs_.begin(),
+                                       ordered_allocs_.end(), *new_alloc);
+  ordered_allocs_.insert(insertion_it, *new_alloc);
+  return kTfLiteOk;
+}
+
+size_t SimpleMemoryArena::SimulateAllocations(
+    size_t alignment,
+    const std::vector<ArenaAllocWithUsageInterval>& allocs) const {
+  std::vector<ArenaAllocWithUsageInterval> ordered_allocs = ordered_allocs_;
+  size_t high_water_mark = high_water_mark_;
+  for (ArenaAllocWithUsageInterval alloc : allocs) {
+    if (alloc.size == 0) continue;
+    alloc.offset = FindBestOffset(ordered_allocs, alignment, alloc.size,
+                                  alloc.first_node, alloc.last_node);
+    high_water_mark = std::max(high_water_mark, alloc.offset + alloc.size);
+    ordered_allocs.insert(std::upper_bound(ordered_allocs.begin(),
+                                           ordered_allocs.end(), alloc),
+                          alloc);
+  }
+  return high_water_mark;
+}
+
 TfLiteStatus SimpleMemoryArena::Deallocate(
     TfLiteContext* context, const ArenaAllocWithUsageInterval& alloc) {
   if (alloc.size == 0) {
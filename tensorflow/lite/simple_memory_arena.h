@@ -76,9 +76,31 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Schedule memory allocation for a tensor at a given offset, typically one
+  // found by an earlier call to Allocate() for a tensor at least as large with
+  // the same usage interval. The caller must make sure the allocation doesn't
+  // overlap any other allocation whose usage interval intersects with its own.
+  TfLiteStatus AllocateAtOffset(TfLiteContext* context, size_t alignment,
+                                size_t offset, size_t size, int32_t tensor,
+                                int32_t first_node, int32_t last_node,
+                                ArenaAllocWithUsageInterval* new_alloc);
+
   TfLiteStatus Deallocate(TfLiteContext* context,
                           const ArenaAllocWithUsageInterval& alloc);
 
+  // Returns true if there are no allocations scheduled.
+  bool empty() const { return ordered_allocs_.empty(); }
+
+  // Returns the high water mark the arena would reach if `allocs`, whose
+  // size and usage interval are set, were allocated in order on top of the
+  // current allocations. The arena itself is left unchanged.
+  size_t SimulateAllocations(
+      size_t alignment,
+      const std::vector<ArenaAllocWithUsageInterval>& allocs) const;
+
+  // Returns the end offset of the highest allocation made so far.
+  size_t high_water_mark() const { return high_water_mark_; }
+
   inline size_t RequiredBufferSize() {
     // Add in a small amount of padding to reduce the chance of resize events
     // for small allocations.
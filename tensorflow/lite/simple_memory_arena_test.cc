@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/simple_memory_arena.h"
 
+#include <cstdint>
+#include <vector>
+
 #include <gtest/gtest.h>
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/testing/util.h"
@@ -43,6 +46,32 @@ TEST(SimpleMemoryArenaTest, BasicArenaOperations) {
   EXPECT_EQ(allocs[5].offset, 2048);
 }
 
+TEST(SimpleMemoryArenaTest, SimulateAllocations) {
+  TfLiteContext context;
+  SimpleMemoryArena arena(64);
+  ArenaAllocWithUsageInterval allocs[2];
+  arena.Allocate(&context, 32, 2047, 0, 1, 3, &allocs[0]);
+  arena.Allocate(&context, 32, 2047, 1, 2, 5, &allocs[1]);
+  ASSERT_EQ(arena.high_water_mark(), 4095);
+
+  // Same as the last four allocations of BasicArenaOperations.
+  std::vector<ArenaAllocWithUsageInterval> more_allocs(4);
+  const int32_t intervals[4][2] = {{3, 6}, {5, 6}, {4, 6}, {6, 6}};
+  for (int i = 0; i < 4; ++i) {
+    more_allocs[i].tensor = i + 2;
+    more_allocs[i].size = i < 2 ? 2047 : 1023;
+    more_allocs[i].first_node = intervals[i][0];
+    more_allocs[i].last_node = intervals[i][1];
+  }
+  EXPECT_EQ(arena.SimulateAllocations(32, more_allocs), 6144 + 1023);
+
+  // The arena itself didn't change.
+  EXPECT_EQ(arena.high_water_mark(), 4095);
+  ArenaAllocWithUsageInterval alloc;
+  arena.Allocate(&context, 32, 2047, 2, 3, 6, &alloc);
+  EXPECT_EQ(alloc.offset, 4096);
+}
+
 TEST(SimpleMemoryArenaTest, BasicZeroAlloc) {
   TfLiteContext context;
   SimpleMemoryArena arena(64);
@@ -196,6 +225,31 @@ TEST_P(BufferAndPlanClearingTest, TestClearBufferAndClearPlan) {
   EXPECT_NE(resolved_ptr, nullptr);
 }
 
+TEST(SimpleMemoryArenaTest, AllocateAtOffset) {
+  TfLiteContext context;
+  context.ReportError = ReportError;
+  SimpleMemoryArena arena(64);
+  ArenaAllocWithUsageInterval allocs[3];
+  ASSERT_TRUE(arena.empty());
+
+  ASSERT_EQ(arena.AllocateAtOffset(&context, 32, 64, 100, 0, 0, 1, &allocs[0]),
+            kTfLiteOk);
+  ASSERT_EQ(arena.AllocateAtOffset(&context, 32, 0, 48, 1, 1, 2, &allocs[1]),
+            kTfLiteOk);
+  EXPECT_FALSE(arena.empty());
+  EXPECT_EQ(allocs[0].offset, 64);
+  EXPECT_EQ(allocs[1].offset, 0);
+  EXPECT_EQ(arena.high_water_mark(), 164);
+
+  // Misaligned offsets are rejected.
+  EXPECT_NE(arena.AllocateAtOffset(&context, 32, 8, 16, 2, 0, 2, &allocs[2]),
+            kTfLiteOk);
+
+  // Regular allocations see the pinned ones.
+  arena.Allocate(&context, 32, 16, 2, 0, 2, &allocs[2]);
+  EXPECT_EQ(allocs[2].offset, 192);
+}
+
 INSTANTIATE_TEST_SUITE_P(BufferAndPlanClearingTest, BufferAndPlanClearingTest,
                          ::testing::Values(true, false));
 
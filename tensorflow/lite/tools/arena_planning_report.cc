@@ -0,0 +1,105 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Reports, for each subgraph of a model, the non-persistent arena size planned
+// by every ArenaPlanningStrategy against the lower bound given by the largest
+// total size of the tensors live at the same time.
+//
+// Usage: arena_planning_report --graph=/path/to/model.tflite
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/memory_planner.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+
+namespace tflite {
+namespace {
+
+struct StrategyInfo {
+  const char* name;
+  ArenaPlanningStrategy strategy;
+};
+
+constexpr StrategyInfo kStrategies[] = {
+    {"greedy_by_size", ArenaPlanningStrategy::kGreedyBySize},
+    {"greedy_by_breadth", ArenaPlanningStrategy::kGreedyByBreadth},
+    {"best_of", ArenaPlanningStrategy::kBestOf},
+};
+
+int Run(const std::string& graph) {
+  std::unique_ptr<FlatBufferModel> model =
+      FlatBufferModel::BuildFromFile(graph.c_str());
+  if (!model) {
+    fprintf(stderr, "Failed to load model %s\n", graph.c_str());
+    return 1;
+  }
+  ops::builtin::BuiltinOpResolver resolver;
+
+  printf("%-20s %8s %16s %16s %9s\n", "strategy", "subgraph", "arena_bytes",
+         "lower_bound", "overhead");
+  for (const StrategyInfo& info : kStrategies) {
+    InterpreterOptions options;
+    options.SetArenaPlanningStrategy(info.strategy);
+    std::unique_ptr<Interpreter> interpreter;
+    if (InterpreterBuilder(*model, resolver, &options)(&interpreter) !=
+            kTfLiteOk ||
+        interpreter->AllocateTensors() != kTfLiteOk) {
+      fprintf(stderr, "Failed to allocate tensors with %s\n", info.name);
+      return 1;
+    }
+    for (int i = 0; i < static_cast<int>(interpreter->subgraphs_size()); ++i) {
+      size_t arena_size = 0;
+      size_t lower_bound = 0;
+      // Subgraphs that AllocateTensors doesn't prepare, such as the bodies
+      // of control flow ops, report nothing.
+      if (interpreter->subgraph(i)->GetArenaSizeInfo(
+              &arena_size, &lower_bound) != kTfLiteOk) {
+        continue;
+      }
+      const double overhead =
+          lower_bound == 0 ? 0.0
+                           : 100.0 * (static_cast<double>(arena_size) -
+                                      static_cast<double>(lower_bound)) /
+                                 static_cast<double>(lower_bound);
+      printf("%-20s %8d %16zu %16zu %8.1f%%\n", info.name, i, arena_size,
+             lower_bound, overhead);
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  std::string graph;
+  std::vector<tflite::Flag> flag_list = {
+      tflite::Flag::CreateFlag("graph", &graph, "Path to the tflite model.",
+                               tflite::Flag::kRequired),
+  };
+  if (!tflite::Flags::Parse(&argc, const_cast<const char**>(argv),
+                            flag_list)) {
+    fprintf(stderr, "%s\n",
+            tflite::Flags::Usage(argv[0], flag_list).c_str());
+    return 1;
+  }
+  return tflite::Run(graph);
+}
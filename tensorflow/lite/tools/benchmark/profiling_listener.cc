@@ -26,10 +26,12 @@ namespace benchmark {
 ProfilingListener::ProfilingListener(
     Interpreter* interpreter, uint32_t max_num_initial_entries,
     bool allow_dynamic_buffer_increase, const std::string& csv_file_path,
-    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter)
+    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter,
+    const std::string& chrome_trace_file_path)
     : run_summarizer_(summarizer_formatter),
       init_summarizer_(summarizer_formatter),
       csv_file_path_(csv_file_path),
+      chrome_trace_file_path_(chrome_trace_file_path),
       interpreter_(interpreter),
       profiler_(max_num_initial_entries, allow_dynamic_buffer_increase) {
   TFLITE_TOOLS_CHECK(interpreter);
@@ -49,6 +51,9 @@ void ProfilingListener::OnBenchmarkStart(const BenchmarkParams& params) {
   profiler_.StopProfiling();
   auto profile_events = profiler_.GetProfileEvents();
   init_summarizer_.ProcessProfiles(profile_events, *interpreter_);
+  if (!chrome_trace_file_path_.empty()) {
+    trace_writer_.ProcessProfiles(profile_events, *interpreter_);
+  }
   profiler_.Reset();
 }
 
@@ -63,6 +68,9 @@ void ProfilingListener::OnSingleRunEnd() {
   profiler_.StopProfiling();
   auto profile_events = profiler_.GetProfileEvents();
   run_summarizer_.ProcessProfiles(profile_events, *interpreter_);
+  if (!chrome_trace_file_path_.empty()) {
+    trace_writer_.ProcessProfiles(profile_events, *interpreter_);
+  }
 }
 
 void ProfilingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
@@ -81,6 +89,14 @@ void ProfilingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
                 run_summarizer_.GetOutputString(),
                 output_stream == nullptr ? &TFLITE_LOG(INFO) : output_stream);
   }
+  if (trace_writer_.HasProfiles()) {
+    if (trace_writer_.WriteToFile(chrome_trace_file_path_)) {
+      TFLITE_LOG(INFO) << "Wrote Chrome trace to " << chrome_trace_file_path_;
+    } else {
+      TFLITE_LOG(ERROR) << "Failed to write Chrome trace to "
+                        << chrome_trace_file_path_;
+    }
+  }
 }
 
 void ProfilingListener::WriteOutput(const std::string& header,
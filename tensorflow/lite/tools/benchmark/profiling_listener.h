@@ -20,6 +20,7 @@ limitations under the License.
 #include <string>
 
 #include "tensorflow/lite/profiling/buffered_profiler.h"
+#include "tensorflow/lite/profiling/chrome_trace_writer.h"
 #include "tensorflow/lite/profiling/profile_summarizer.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
@@ -27,14 +28,17 @@ limitations under the License.
 namespace tflite {
 namespace benchmark {
 
-// Dumps profiling events if profiling is enabled.
+// Dumps profiling events if profiling is enabled. If `chrome_trace_file_path`
+// is not empty, the events of every run are also written there as a Chrome
+// trace.
 class ProfilingListener : public BenchmarkListener {
  public:
   ProfilingListener(
       Interpreter* interpreter, uint32_t max_num_initial_entries,
       bool allow_dynamic_buffer_increase, const std::string& csv_file_path = "",
       std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter =
-          std::make_shared<profiling::ProfileSummaryDefaultFormatter>());
+          std::make_shared<profiling::ProfileSummaryDefaultFormatter>(),
+      const std::string& chrome_trace_file_path = "");
 
   void OnBenchmarkStart(const BenchmarkParams& params) override;
 
@@ -48,6 +52,8 @@ class ProfilingListener : public BenchmarkListener {
   profiling::ProfileSummarizer run_summarizer_;
   profiling::ProfileSummarizer init_summarizer_;
   std::string csv_file_path_;
+  std::string chrome_trace_file_path_;
+  profiling::ChromeTraceWriter trace_writer_;
 
  private:
   void WriteOutput(const std::string& header, const string& data,
@@ -736,8 +736,13 @@ def _register_dataset(service, dataset, compression):
         dataset.element_spec).SerializeToString()
 
   if compression == COMPRESSION_AUTO:
+    options = dataset.options()
+    codec = options.experimental_compression_codec or "SNAPPY"
+    level = options.experimental_compression_level
+    if level is None:
+      level = -1
     dataset = dataset.map(
-        lambda *x: compression_ops.compress(x),
+        lambda *x: compression_ops.compress(x, codec=codec, level=level),
         num_parallel_calls=dataset_ops.AUTOTUNE)
   dataset = dataset.prefetch(dataset_ops.AUTOTUNE)
   dataset = dataset._apply_debug_options()  # pylint: disable=protected-access
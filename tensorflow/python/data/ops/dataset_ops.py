@@ -2189,7 +2189,9 @@ name=None))
         processed concurrently. If not set, the tf.data runtime decides what it
         should be based on available CPU. If `num_parallel_calls` is set to
         `tf.data.AUTOTUNE`, the `cycle_length` argument identifies
-        the maximum degree of parallelism.
+        the maximum degree of parallelism. If it is not set and elements may
+        be produced out of order, the number of input elements processed
+        concurrently is tuned dynamically, up to that maximum.
       block_length: (Optional.) The number of consecutive elements to produce
         from each input element before cycling to another input element. If not
         set, defaults to 1.
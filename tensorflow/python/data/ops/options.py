@@ -40,11 +40,16 @@ class AutotuneAlgorithm(enum.Enum):
 
   MAX_PARALLELISM: Similar to HILL_CLIMB but uses a relaxed stopping condition,
   allowing the optimization to oversubscribe the CPU.
+
+  STAGE_BASED: In each optimization step, this algorithm identifies the stage
+  of the input pipeline that takes the longest and increases its parallelism,
+  taking parallelism from the other stages when the CPU is oversubscribed.
   """
   DEFAULT = 0
   HILL_CLIMB = 1
   GRADIENT_DESCENT = 2
   MAX_PARALLELISM = 3
+  STAGE_BASED = 4
 
   @classmethod
   def _to_proto(cls, obj):
@@ -56,6 +61,8 @@ class AutotuneAlgorithm(enum.Enum):
       return model_pb2.AutotuneAlgorithm.GRADIENT_DESCENT
     if obj == cls.MAX_PARALLELISM:
       return model_pb2.AutotuneAlgorithm.MAX_PARALLELISM
+    if obj == cls.STAGE_BASED:
+      return model_pb2.AutotuneAlgorithm.STAGE_BASED
     raise ValueError(
         f"Invalid `obj.` Supported values include `DEFAULT`, `HILL_CLIMB` and "
         f"`GRADIENT_DESCENT`. Got {obj.name}.")
@@ -70,6 +77,8 @@ class AutotuneAlgorithm(enum.Enum):
       return cls.GRADIENT_DESCENT
     if pb == model_pb2.AutotuneAlgorithm.MAX_PARALLELISM:
       return cls.MAX_PARALLELISM
+    if pb == model_pb2.AutotuneAlgorithm.STAGE_BASED:
+      return cls.STAGE_BASED
     raise ValueError(f"Invalid `pb.` Supported values include `DEFAULT`, "
                      f"`HILL_CLIMB` and `GRADIENT_DESCENT`. Got {pb}.")
 
@@ -510,6 +519,22 @@ class Options(options_lib.OptionsBase):
       "Whether the outputs need to be produced in deterministic order. If None,"
       " defaults to True.")
 
+  experimental_compression_codec = options_lib.create_option(
+      name="experimental_compression_codec",
+      ty=str,
+      docstring="The codec with which the tf.data service compresses the "
+      "dataset's elements when its `compression` is \"AUTO\". One of "
+      "\"SNAPPY\", \"NONE\", \"ZLIB\", or \"ADAPTIVE\", which skips "
+      "compression for elements that do not compress well. If None, defaults "
+      "to \"SNAPPY\".")
+
+  experimental_compression_level = options_lib.create_option(
+      name="experimental_compression_level",
+      ty=int,
+      docstring="The compression level used with the \"ZLIB\" "
+      "`experimental_compression_codec`, from 0 to 9. If None, defaults to "
+      "the zlib default level.")
+
   experimental_deterministic = options_lib.create_option(
       name="experimental_deterministic",
       ty=bool,
@@ -593,6 +618,10 @@ class Options(options_lib.OptionsBase):
     if self.deterministic is not None:
       pb.deterministic = self.deterministic
     pb.autotune_options.CopyFrom(self.autotune._to_proto())  # pylint: disable=protected-access
+    if self.experimental_compression_codec is not None:
+      pb.compression_codec = self.experimental_compression_codec
+    if self.experimental_compression_level is not None:
+      pb.compression_level = self.experimental_compression_level
     pb.distribute_options.CopyFrom(self.experimental_distribute._to_proto())  # pylint: disable=protected-access
     if self.experimental_external_state_policy is not None:
       pb.external_state_policy = (
@@ -608,6 +637,10 @@ class Options(options_lib.OptionsBase):
     if pb.WhichOneof("optional_deterministic") is not None:
       self.deterministic = pb.deterministic
     self.autotune._from_proto(pb.autotune_options)  # pylint: disable=protected-access
+    if pb.WhichOneof("optional_compression_codec") is not None:
+      self.experimental_compression_codec = pb.compression_codec
+    if pb.WhichOneof("optional_compression_level") is not None:
+      self.experimental_compression_level = pb.compression_level
     self.experimental_distribute._from_proto(pb.distribute_options)  # pylint: disable=protected-access
     if pb.WhichOneof("optional_external_state_policy") is not None:
       self.experimental_external_state_policy = (
@@ -438,7 +438,9 @@ class TFRecordDatasetV2(dataset_ops.DatasetV2):
       filenames: A `tf.string` tensor or `tf.data.Dataset` containing one or
         more filenames.
       compression_type: (Optional.) A `tf.string` scalar evaluating to one of
-        `""` (no compression), `"ZLIB"`, or `"GZIP"`.
+        `""` (no compression), `"ZLIB"`, `"GZIP"`, or `"SNAPPY_BLOCK"` or
+        `"ZLIB_BLOCK"` for files of independently compressed blocks, which
+        can be skipped through and decompressed in parallel.
       buffer_size: (Optional.) A `tf.int64` scalar representing the number of
         bytes in the read buffer. If your input pipeline is I/O bottlenecked,
         consider setting this parameter to a value 1-100 MBs. If `None`, a
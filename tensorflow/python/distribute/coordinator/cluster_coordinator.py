@@ -17,6 +17,7 @@
 This is currently under development and the API is subject to change.
 """
 
+import collections
 import contextlib
 import os
 import re
@@ -56,6 +57,23 @@ _WORKER_MAXIMUM_RECOVERY_SEC = 3600
 # queue is full.
 _CLOSURE_QUEUE_MAX_SIZE = 256 * 1024
 
+# When a worker is idle, a closure that has been running on another worker for
+# longer than this multiple of the median closure latency is speculatively
+# re-executed on the idle worker, and the first execution to finish provides
+# the result. Disabled if set to 0. Only enable this if the scheduled functions
+# are idempotent, e.g. evaluation steps, since a straggler closure may run
+# twice.
+_SPECULATIVE_EXECUTION_MULTIPLIER = float(
+    os.environ.get("TF_COORDINATOR_SPECULATIVE_EXECUTION_MULTIPLIER", "0"))
+
+# The number of recent closure latencies the median is taken over, and the
+# number of them needed before any closure is speculatively re-executed.
+_CLOSURE_LATENCY_WINDOW = 100
+_SPECULATION_MIN_LATENCIES = 10
+
+# How often idle workers look for straggler closures.
+_SPECULATION_POLL_INTERVAL_SEC = 0.1
+
 # RPC error message from PS
 _RPC_ERROR_FROM_PS = "GRPC error information from remote target /job:ps"
 
@@ -201,6 +219,59 @@ class Closure(object):
 
     self._output_remote_value_ref = None
 
+    # The closure runs on two workers at once if it is speculatively
+    # re-executed, in which case only the first execution to compute its
+    # outputs sets them.
+    self._execution_lock = threading.Lock()
+    self._running_executions = 0
+    self._speculated = False
+    self._result_claimed = False
+    self._finished = False
+
+  def _start_execution(self, speculative=False):
+    with self._execution_lock:
+      self._running_executions += 1
+      if speculative:
+        self._speculated = True
+
+  def _end_execution(self, finished):
+    """Ends an execution and returns the number of others still running."""
+    with self._execution_lock:
+      self._running_executions -= 1
+      if finished:
+        self._finished = True
+      return self._running_executions
+
+  def _claim_result(self):
+    """Returns whether this execution gets to set the outputs."""
+    with self._execution_lock:
+      if self._speculated and self._result_claimed:
+        return False
+      self._result_claimed = True
+      return True
+
+  def _is_superseded(self, failed):
+    """Returns whether another execution determines the outcome."""
+    with self._execution_lock:
+      if self._finished:
+        return True
+      if failed and self._running_executions > 1:
+        # The other execution may claim the result again.
+        self._result_claimed = False
+        return True
+      return False
+
+  def _reset_execution(self):
+    with self._execution_lock:
+      self._running_executions = 0
+      self._speculated = False
+      self._result_claimed = False
+
+  def _can_speculate(self):
+    with self._execution_lock:
+      return (not self._speculated and not self._finished and
+              self._running_executions == 1)
+
   def build_output_remote_value(self):
     if self._output_remote_value_ref is None:
       ret = RemoteValueImpl(None, self._output_type_spec)
@@ -229,6 +300,10 @@ class Closure(object):
 
     Args:
       worker: a `Worker` object.
+
+    Returns:
+      False if another execution of a speculatively re-executed closure set the
+      outputs first, and True otherwise.
     """
     replica_args = _select_worker_slice(worker.worker_index, self._args)
     replica_kwargs = _select_worker_slice(worker.worker_index, self._kwargs)
@@ -248,8 +323,11 @@ class Closure(object):
             output_values = self._function(
                 *nest.map_structure(_maybe_get_remote_value, replica_args),
                 **nest.map_structure(_maybe_get_remote_value, replica_kwargs))
+    if not self._claim_result():
+      return False
     self.maybe_call_with_output_remote_value(
         lambda r: r._set_values(output_values))  # pylint: disable=protected-access
+    return True
 
 
 class ResourceClosure(Closure):
@@ -319,6 +397,12 @@ class _CoordinatedClosureQueue(object):
     # of the code.
     self._put_wait_lock = threading.Lock()
 
+    # The inflight closures and their start times, and the latencies of recent
+    # closures, used to find the stragglers to speculatively re-execute.
+    self._speculation_multiplier = _SPECULATIVE_EXECUTION_MULTIPLIER
+    self._inflight_closures = collections.OrderedDict()
+    self._closure_latencies = collections.deque(maxlen=_CLOSURE_LATENCY_WINDOW)
+
     self._watchdog = watchdog.WatchDog(on_triggered=self._on_watchdog_timeout)
 
   def _on_watchdog_timeout(self):
@@ -387,22 +471,89 @@ class _CoordinatedClosureQueue(object):
       self._raise_if_error()
       self._closures_queued_condition.notify()
 
+  def _find_straggler_locked(self):
+    """Returns an inflight closure to speculatively re-execute, if any.
+
+    This method expects self._queue_lock to be held prior to entry.
+    """
+    if (self._speculation_multiplier <= 0 or
+        len(self._closure_latencies) < _SPECULATION_MIN_LATENCIES):
+      return None
+    threshold = self._speculation_multiplier * sorted(
+        self._closure_latencies)[len(self._closure_latencies) // 2]
+    now = time.time()
+    # The closures are ordered by start time, so the first candidate is the
+    # one that has been running for the longest.
+    for closure, start_time in self._inflight_closures.items():
+      if now - start_time <= threshold:
+        return None
+      if closure._can_speculate():  # pylint: disable=protected-access
+        return closure
+    return None
+
   def get(self, timeout=None):
-    """Return a closure from the queue to be executed."""
+    """Return a closure from the queue to be executed.
+
+    If the queue is empty and speculative execution is enabled, this may return
+    a straggler closure that is still being executed by another worker.
+    """
+    deadline = None if timeout is None else time.time() + timeout
     with self._queue_lock:
       while self._queue.empty() and self._should_process_closures:
-        if not self._closures_queued_condition.wait(timeout=timeout):
+        straggler = self._find_straggler_locked()
+        if straggler is not None:
+          logging.info("Speculatively re-executing a closure that has been "
+                       "running for %.1f seconds.",
+                       time.time() - self._inflight_closures[straggler])
+          straggler._start_execution(speculative=True)  # pylint: disable=protected-access
+          return straggler
+        wait_timeout = None if deadline is None else deadline - time.time()
+        if self._speculation_multiplier > 0 and self._inflight_closures:
+          wait_timeout = min(wait_timeout or _SPECULATION_POLL_INTERVAL_SEC,
+                             _SPECULATION_POLL_INTERVAL_SEC)
+        if (not self._closures_queued_condition.wait(timeout=wait_timeout) and
+            deadline is not None and time.time() >= deadline):
           return None
       if not self._should_process_closures:
         return None
       closure = self._queue.get(block=False)
       self._queue_free_slot_condition.notify()
       self._inflight_closure_count += 1
+      if self._speculation_multiplier > 0:
+        self._inflight_closures[closure] = time.time()
+      closure._start_execution()  # pylint: disable=protected-access
       return closure
 
-  def mark_finished(self):
-    """Let the queue know that a closure has been successfully executed."""
+  def discard_execution(self, closure):
+    """Ends an execution whose result was superseded by another one."""
+    closure._end_execution(finished=False)  # pylint: disable=protected-access
+
+  def _end_closure_locked(self, closure, succeeded, finished):
+    """Returns whether the outcome of this execution of `closure` is dropped.
+
+    This method expects self._queue_lock to be held prior to entry.
+    """
+    if closure is None:
+      return False
+    if closure._is_superseded(failed=not succeeded):  # pylint: disable=protected-access
+      self.discard_execution(closure)
+      return True
+    closure._end_execution(finished=finished)  # pylint: disable=protected-access
+    start_time = self._inflight_closures.pop(closure, None)
+    if succeeded and start_time is not None:
+      self._closure_latencies.append(time.time() - start_time)
+    return False
+
+  def mark_finished(self, closure=None):
+    """Let the queue know that a closure has been successfully executed.
+
+    Args:
+      closure: The executed `Closure`. Required if closures may be
+        speculatively re-executed.
+    """
     with self._queue_lock:
+      if self._end_closure_locked(closure, succeeded=True, finished=True):
+        return
       if self._inflight_closure_count < 1:
         raise AssertionError("There is no inflight closures to mark_finished.")
       self._inflight_closure_count -= 1
@@ -413,10 +564,17 @@ class _CoordinatedClosureQueue(object):
       self._watchdog.report_closure_done()
 
   def put_back(self, closure):
-    """Put the closure back into the queue as it was not properly executed."""
+    """Put the closure back into the queue as it was not properly executed.
+
+    If another execution of a speculatively re-executed closure is still
+    running or has finished, the closure is not put back.
+    """
     with self._queue_lock:
+      if self._end_closure_locked(closure, succeeded=False, finished=False):
+        return
       if self._inflight_closure_count < 1:
         raise AssertionError("There is no inflight closures to put_back.")
+      closure._reset_execution()  # pylint: disable=protected-access
       if self._error:
         closure.mark_cancelled()
       else:
@@ -447,11 +605,23 @@ class _CoordinatedClosureQueue(object):
       self._raise_if_error()
       return True
 
-  def mark_failed(self, e):
-    """Sets error and unblocks any wait() call."""
+  def mark_failed(self, e, closure=None):
+    """Sets error and unblocks any wait() call.
+
+    Args:
+      e: The error the closure failed with.
+      closure: The failed `Closure`. Required if closures may be speculatively
+        re-executed, in which case the error is dropped if another execution of
+        the closure is still running or has finished.
+
+    Returns:
+      False if the error was dropped, and True otherwise.
+    """
     with self._queue_lock:
       # TODO(yuefengz): maybe record all failure and give users more
       # information?
+      if self._end_closure_locked(closure, succeeded=False, finished=True):
+        return False
       if self._inflight_closure_count < 1:
         raise AssertionError("There is no inflight closures to mark_failed.")
       if self._error is None:
@@ -460,6 +630,7 @@ class _CoordinatedClosureQueue(object):
       if self._inflight_closure_count == 0:
         self._no_inflight_closure_condition.notify_all()
       self._stop_waiting_condition.notify_all()
+      return True
 
   def done(self):
     """Returns true if the queue is empty and there is no inflight closure.
@@ -660,13 +831,21 @@ class Worker(object):
     executor: The worker's executor for remote function execution.
     failure_handler: The failure handler used to handler worker preemption
       failure.
+    num_finished_closures: The number of closures the worker has finished.
+    closure_latency_sec: The exponential moving average of the time the worker
+      takes to finish a closure, or None if it has not finished any.
   """
 
+  # The weight of the latest closure in `closure_latency_sec`.
+  _CLOSURE_LATENCY_DECAY = 0.1
+
   def __init__(self, worker_index, device_name, cluster):
     self.worker_index = worker_index
     self.device_name = device_name
     self.executor = executor.new_executor(enable_async=False)
     self.failure_handler = cluster.failure_handler
+    self.num_finished_closures = 0
+    self.closure_latency_sec = None
     self._cluster = cluster
     self._resource_remote_value_refs = []
     self._should_worker_thread_run = True
@@ -691,9 +870,18 @@ class Worker(object):
   def _set_dead(self):
     raise NotImplementedError("_set_dead is not implemented.")
 
+  def _record_closure_latency(self, latency_sec):
+    self.num_finished_closures += 1
+    if self.closure_latency_sec is None:
+      self.closure_latency_sec = latency_sec
+    else:
+      self.closure_latency_sec += self._CLOSURE_LATENCY_DECAY * (
+          latency_sec - self.closure_latency_sec)
+
   def _process_closure(self, closure):
     """Runs a closure with preemption handling."""
     assert closure is not None
+    start_time = time.time()
     try:
       with self.failure_handler.wait_on_failure(
           on_failure_fn=lambda: self._cluster.closure_queue.put_back(closure),
@@ -701,20 +889,28 @@ class Worker(object):
               closure),
           on_recovery_fn=self._set_resources_aborted,
           worker_device_name=self.device_name):
-        closure.execute_on(self)
+        if not closure.execute_on(self):
+          # Another worker finished the speculatively re-executed closure.
+          self._cluster.closure_queue.discard_execution(closure)
+          return
         with metric_utils.monitored_timer("remote_value_fetch"):
           # Copy the remote tensor to local (the coordinator) in case worker
           # becomes unavailable at a later time.
           closure.maybe_call_with_output_remote_value(lambda r: r.get())
-        self._cluster.closure_queue.mark_finished()
+        self._cluster.closure_queue.mark_finished(closure)
+        self._record_closure_latency(time.time() - start_time)
     except Exception as e:  # pylint: disable=broad-except
+      if not self._cluster.closure_queue.mark_failed(e, closure):
+        logging.info(
+            "/job:worker/task:%d ignored the error %r of a closure that "
+            "another worker executes as well.", self.worker_index, e)
+        return
       # Avoid logging the derived cancellation error
       if not isinstance(e, errors.CancelledError):
         logging.error(
             "/job:worker/task:%d encountered the following error when "
             "processing closure: %r:%s", self.worker_index, e, e)
       closure.maybe_call_with_output_remote_value(lambda r: r._set_error(e))  # pylint: disable=protected-access
-      self._cluster.closure_queue.mark_failed(e)
 
   def _maybe_delay(self):
     """Delay if corresponding env vars are set."""
@@ -373,6 +373,47 @@ class CoordinatedClosureQueueTest(test.TestCase):
     closure_queue.put(self._create_closure(closure_queue._cancellation_mgr))
     self.assertIsNone(closure_queue._error)
 
+  def testSpeculativeExecutionOfStraggler(self):
+    queue = coordinator_lib._CoordinatedClosureQueue()
+    queue._speculation_multiplier = 2
+    queue._closure_latencies.extend(
+        [0.01] * coordinator_lib._SPECULATION_MIN_LATENCIES)
+    closure = self._create_closure(queue._cancellation_mgr)
+    queue.put(closure)
+    self.assertIs(closure, queue.get())
+
+    # Once the closure runs for longer than twice the median latency, an idle
+    # worker re-executes it.
+    self.assertIs(closure, queue.get(timeout=10))
+    self.assertTrue(closure._claim_result())
+    self.assertFalse(closure._claim_result())
+    queue.mark_finished(closure)
+    self.assertTrue(queue.done())
+
+    # The outcome of the straggler execution is dropped.
+    self.assertFalse(queue.mark_failed(ValueError(), closure))
+    self.assertIsNone(queue._error)
+    self.assertTrue(queue.done())
+    self.assertIsNone(queue.get(timeout=0.3))
+
+  def testSpeculativeExecutionFailureLeavesOtherExecution(self):
+    queue = coordinator_lib._CoordinatedClosureQueue()
+    queue._speculation_multiplier = 2
+    queue._closure_latencies.extend(
+        [0.01] * coordinator_lib._SPECULATION_MIN_LATENCIES)
+    closure = self._create_closure(queue._cancellation_mgr)
+    queue.put(closure)
+    self.assertIs(closure, queue.get())
+    self.assertIs(closure, queue.get(timeout=10))
+
+    # The speculative execution fails, and the original one finishes.
+    queue.put_back(closure)
+    self.assertFalse(queue.done())
+    self.assertTrue(closure._claim_result())
+    queue.mark_finished(closure)
+    self.assertTrue(queue.done())
+    queue.wait()
+
   def testThreadSafey(self):
     thread_count = 10
     queue = coordinator_lib._CoordinatedClosureQueue()
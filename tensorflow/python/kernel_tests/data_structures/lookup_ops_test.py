@@ -40,8 +40,10 @@ from tensorflow.python.framework import test_ops
 from tensorflow.python.framework import test_util
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import control_flow_ops
+from tensorflow.python.ops import gen_lookup_ops
 from tensorflow.python.ops import lookup_ops
 from tensorflow.python.ops import map_fn
+from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import variables
 from tensorflow.python.ops.ragged import ragged_tensor
 from tensorflow.python.platform import test
@@ -1825,6 +1827,54 @@ class DenseHashTableOpTest(test.TestCase):
     self.assertAllEqual([[11, 1], [13, 3], [14, 4], [100, 0], [100, 0],
                          [100, 0], [100, 0], [200, 2]], pairs)
 
+  def testShardedExportImport(self, is_anonymous):
+    if is_anonymous:
+      self.skipTest("Sharded tables can't be anonymous")
+    keys = constant_op.constant(np.arange(1, 101), dtypes.int64)
+    values = constant_op.constant(np.arange(101, 201), dtypes.int64)
+    table = lookup_ops.DenseHashTable(
+        dtypes.int64,
+        dtypes.int64,
+        default_value=-1,
+        empty_key=0,
+        deleted_key=-1,
+        initial_num_buckets=32,
+        experimental_num_shards=4)
+    self.evaluate(table.insert(keys, values))
+    self.evaluate(
+        table.remove(constant_op.constant([10, 20, 200], dtypes.int64)))
+    self.assertAllEqual(98, self.evaluate(table.size()))
+
+    lookup_keys = constant_op.constant([1, 10, 50, 100, 200], dtypes.int64)
+    self.assertAllEqual([101, -1, 150, 200, -1],
+                        self.evaluate(table.lookup(lookup_keys)))
+
+    exported_keys, exported_values = table.export()
+    resharded_table = lookup_ops.DenseHashTable(
+        dtypes.int64,
+        dtypes.int64,
+        default_value=-1,
+        empty_key=0,
+        deleted_key=-1,
+        experimental_num_shards=3)
+    self.evaluate(
+        gen_lookup_ops.lookup_table_import_v2(resharded_table.resource_handle,
+                                              exported_keys, exported_values))
+    self.assertAllEqual(98, self.evaluate(resharded_table.size()))
+    self.assertAllEqual([101, -1, 150, 200, -1],
+                        self.evaluate(resharded_table.lookup(lookup_keys)))
+
+  def testShardedAnonymousRaises(self, is_anonymous):
+    with self.assertRaisesRegex(ValueError, "experimental_num_shards"):
+      lookup_ops.DenseHashTable(
+          dtypes.int64,
+          dtypes.int64,
+          default_value=-1,
+          empty_key=0,
+          deleted_key=-1,
+          experimental_is_anonymous=True,
+          experimental_num_shards=2)
+
   @test_util.run_v1_only("Saver V1 only")
   def testSaveRestore(self, is_anonymous):
     if is_anonymous and not tf2.enabled():
@@ -4212,6 +4262,109 @@ class MutableHashTableOpTest(test.TestCase):
     self.assertTrue(inferred_shapes[1].is_compatible_with(actual_shapes[1]))
 
 
+class DynamicEmbeddingTableTest(test.TestCase):
+
+  def _table(self, **kwargs):
+    return gen_lookup_ops.dynamic_embedding_table(
+        key_dtype=dtypes.int64,
+        value_dtype=dtypes.float32,
+        value_shape=[2],
+        shared_name="dynamic_embedding_table_%d" % ops.uid(),
+        **kwargs)
+
+  def _insert(self, table, keys):
+    keys = constant_op.constant(keys, dtypes.int64)
+    values = array_ops.stack([math_ops.cast(keys, dtypes.float32)] * 2, 1)
+    self.evaluate(gen_lookup_ops.lookup_table_insert_v2(table, keys, values))
+
+  def _find(self, table, keys):
+    return self.evaluate(
+        gen_lookup_ops.lookup_table_find_v2(
+            table, constant_op.constant(keys, dtypes.int64),
+            constant_op.constant([-1., -1.])))
+
+  def _size(self, table):
+    return self.evaluate(gen_lookup_ops.lookup_table_size_v2(table))
+
+  def testBasic(self):
+    table = self._table()
+    self._insert(table, [11, 12, 13])
+    self.assertAllEqual(3, self._size(table))
+    self.evaluate(
+        gen_lookup_ops.lookup_table_remove_v2(
+            table, constant_op.constant([12, 15], dtypes.int64)))
+    self.assertAllEqual(2, self._size(table))
+    self.assertAllEqual([[11., 11.], [-1., -1.], [13., 13.]],
+                        self._find(table, [11, 12, 13]))
+
+  def testAdmissionByFrequency(self):
+    table = self._table(min_frequency=2)
+    self._insert(table, [1, 2])
+    self.assertAllEqual(0, self._size(table))
+    self.assertAllEqual([[-1., -1.], [-1., -1.]], self._find(table, [1, 2]))
+    self._insert(table, [1])
+    self.assertAllEqual(1, self._size(table))
+    self.assertAllEqual([[1., 1.], [-1., -1.]], self._find(table, [1, 2]))
+
+  def testLruEviction(self):
+    table = self._table(capacity=2, eviction_policy="lru")
+    self._insert(table, [1])
+    self._insert(table, [2])
+    self._insert(table, [1])
+    self._insert(table, [3])
+    self.assertAllEqual(2, self._size(table))
+    self.assertAllEqual([[1., 1.], [-1., -1.], [3., 3.]],
+                        self._find(table, [1, 2, 3]))
+
+  def testLfuEviction(self):
+    table = self._table(capacity=2, eviction_policy="lfu")
+    self._insert(table, [1])
+    self._insert(table, [1])
+    self._insert(table, [2])
+    self._insert(table, [3])
+    self.assertAllEqual(2, self._size(table))
+    self.assertAllEqual([[1., 1.], [-1., -1.], [3., 3.]],
+                        self._find(table, [1, 2, 3]))
+
+  def testTtlEviction(self):
+    table = self._table(eviction_policy="ttl", ttl_steps=2)
+    self._insert(table, [1])
+    self._insert(table, [2])
+    self._insert(table, [2])
+    self._insert(table, [2])
+    self.assertAllEqual(1, self._size(table))
+    self.assertAllEqual([[-1., -1.], [2., 2.]], self._find(table, [1, 2]))
+
+  def testSparseApplyAdagrad(self):
+    table = self._table(num_slots=1, slot_init_value=0.1)
+    self._insert(table, [1])
+    self.evaluate(
+        gen_lookup_ops.dynamic_embedding_sparse_apply_adagrad(
+            table,
+            lr=constant_op.constant(0.5),
+            grad=constant_op.constant([[1., 2.], [3., 4.]]),
+            indices=constant_op.constant([1, 5], dtypes.int64)))
+    self.assertAllEqual(1, self._size(table))
+
+    keys, values = self.evaluate(
+        gen_lookup_ops.lookup_table_export_v2(table, dtypes.int64,
+                                              dtypes.float32))
+    self.assertAllEqual([1], keys)
+    self.assertAllClose(
+        [[1. - 0.5 / np.sqrt(1.1), 1. - 1. / np.sqrt(4.1), 1.1, 4.1]], values)
+
+    # Importing just the values resets the slots.
+    imported_table = self._table(num_slots=1, slot_init_value=0.1)
+    self.evaluate(
+        gen_lookup_ops.lookup_table_import_v2(imported_table, keys,
+                                              values[:, :2]))
+    _, imported_values = self.evaluate(
+        gen_lookup_ops.lookup_table_export_v2(imported_table, dtypes.int64,
+                                              dtypes.float32))
+    self.assertAllClose(np.concatenate([values[:, :2], [[0.1, 0.1]]], 1),
+                        imported_values)
+
+
 class MutableHashTableBenchmark(test.Benchmark):
 
   def _create_table(self):
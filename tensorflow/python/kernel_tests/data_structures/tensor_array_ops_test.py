@@ -128,6 +128,25 @@ class TensorArrayTest(test.TestCase):
   def testTensorArrayWritePack(self):
     self._testTensorArrayWritePackMaybeLegacy()
 
+  def testTensorArrayFixedSizeWritePackConcatAndRead(self):
+    # Elements of a fixed size and shape are written into one buffer.
+    with self.cached_session():
+      ta = tensor_array_ops.TensorArray(
+          dtype=dtypes.float32,
+          size=3,
+          element_shape=[2, 8],
+          clear_after_read=False)
+      values = np.arange(48, dtype=np.float32).reshape([3, 2, 8])
+      for i in range(3):
+        ta = ta.write(i, values[i])
+
+      stacked, concatenated, gathered, read = self.evaluate(
+          [ta.stack(), ta.concat(), ta.gather([2, 0]), ta.read(1)])
+      self.assertAllEqual(values, stacked)
+      self.assertAllEqual(values.reshape([6, 8]), concatenated)
+      self.assertAllEqual(values[[2, 0]], gathered)
+      self.assertAllEqual(values[1], read)
+
   def testEmptyTensorArrayPack(self):
     with self.session():
       ta = tensor_array_ops.TensorArray(
@@ -163,6 +163,19 @@ class TopKTest(test.TestCase):
       values = -np.sort(-inputs, axis=1)[:, :k]
       self._validateTopK(inputs, k, values, indices)
 
+  def testWideRowsStableSort(self):
+    # Rows wide enough to be split into blocks of columns across threads,
+    # with repeated values that span several blocks.
+    b = 2
+    n = 1 << 18
+    for k in [10, 1000]:
+      inputs = np.random.permutation(
+          np.linspace(0, 1000, b * n, dtype=np.int32)).reshape(b, n)
+      indices = np.argsort(-inputs, axis=1, kind="mergesort")[:, :k]
+      values = -np.sort(-inputs, axis=1)[:, :k]
+      self._validateTopK(inputs, k, values, indices)
+      self._validateTopK(inputs, k, values, indices, sorted=False)
+
   def testTopAll(self):
     inputs = [[0.1, 0.3, 0.2, 0.4], [0.1, 0.3, 0.3, 0.2]]
     self._validateTopK(inputs, 4, [[0.4, 0.3, 0.2, 0.1], [0.3, 0.3, 0.2, 0.1]],
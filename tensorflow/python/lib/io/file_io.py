@@ -922,6 +922,20 @@ def stat_v2(path):
   return _pywrap_file_io.Stat(compat.path_to_str(path))
 
 
+def stat_many(filenames):
+  """Returns file statistics for all the given paths, stat'ed concurrently.
+
+  Args:
+    filenames: list of strings, paths to files
+
+  Returns:
+    A list with the FileStatistics struct of each path, or None for the paths
+    that could not be stat'ed (e.g. because they don't exist).
+  """
+  return _pywrap_file_io.StatMany(
+      [compat.path_to_str(filename) for filename in filenames])
+
+
 def filecmp(filename_a, filename_b):
   """Compare two files, returning True if they are the same, False otherwise.
 
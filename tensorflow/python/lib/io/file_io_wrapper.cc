@@ -232,6 +232,28 @@ PYBIND11_MODULE(_pywrap_file_io, m) {
       },
       py::arg("filename"), py::arg("token") = (PyTransactionToken*)nullptr);
 
+  m.def("StatMany", [](const std::vector<std::string>& filenames) {
+    std::vector<tensorflow::FileStatistics> stats;
+    std::vector<tensorflow::Status> statuses;
+    {
+      py::gil_scoped_release release;
+      // The per-path statuses are checked below.
+      tensorflow::Env::Default()
+          ->StatMany(filenames, &stats, &statuses)
+          .IgnoreError();
+    }
+    // None for the paths that could not be stat'ed.
+    py::list result;
+    for (size_t i = 0; i < filenames.size(); ++i) {
+      if (statuses[i].ok()) {
+        result.append(py::cast(stats[i]));
+      } else {
+        result.append(py::none());
+      }
+    }
+    return result;
+  });
+
   m.def("GetRegisteredSchemes", []() {
     std::vector<std::string> results;
     py::gil_scoped_release release;
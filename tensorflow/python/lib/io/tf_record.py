@@ -32,6 +32,11 @@ class TFRecordCompressionType(object):
   GZIP = 2
 
 
+# Files of independently compressed blocks of records, which readers can skip
+# through and decompress in parallel.
+_BLOCK_COMPRESSION_TYPES = ("SNAPPY_BLOCK", "ZLIB_BLOCK")
+
+
 @tf_export(
     "io.TFRecordOptions",
     v1=["io.TFRecordOptions", "python_io.TFRecordOptions"])
@@ -64,7 +69,8 @@ class TFRecordOptions(object):
     Leaving an option as `None` allows C++ to set a reasonable default.
 
     Args:
-      compression_type: `"GZIP"`, `"ZLIB"`, or `""` (no compression).
+      compression_type: `"GZIP"`, `"ZLIB"`, `"SNAPPY_BLOCK"`, `"ZLIB_BLOCK"`,
+        or `""` (no compression).
       flush_mode: flush mode or `None`, Default: Z_NO_FLUSH.
       input_buffer_size: int or `None`.
       output_buffer_size: int or `None`.
@@ -115,7 +121,8 @@ class TFRecordOptions(object):
       return cls.compression_type_map[options]
     elif options in TFRecordOptions.compression_type_map:
       return cls.compression_type_map[options]
-    elif options in TFRecordOptions.compression_type_map.values():
+    elif (options in TFRecordOptions.compression_type_map.values() or
+          options in _BLOCK_COMPRESSION_TYPES):
       return options
     else:
       raise ValueError('Not a valid compression_type: "{}"'.format(options))
@@ -42,7 +42,11 @@ def all_reduce(t,
       be done.
     communication_hint: preferred collective communication.  The implementation
       may fall back to another mechanism.  Options include `auto`, `ring`, and
-      `nccl`.
+      `nccl`.  `ring_fp16` and `ring_bf16` select the ring implementation and
+      send float32 values between CPU devices as float16 or bfloat16, which
+      halves the traffic at the cost of precision.  `nccl_hierarchical`
+      all-reduces within each task over NCCL and across tasks over a ring,
+      when every task has the same number of GPUs.
     timeout: a float. If set to a non zero, set a completion timeout to detect
       staleness.  If the timer goes off, a DeadlineExceededError is raised.  The
       timeout value in seconds. This feature is experimental.
@@ -118,7 +122,11 @@ def all_reduce_v2(t,
       value.  Can be 'Id' for no operation.
     communication_hint: preferred collective communication.  The implementation
       may fall back to another mechanism.  Options include `auto`, `ring`, and
-      `nccl`.
+      `nccl`.  `ring_fp16` and `ring_bf16` select the ring implementation and
+      send float32 values between CPU devices as float16 or bfloat16, which
+      halves the traffic at the cost of precision.  `nccl_hierarchical`
+      all-reduces within each task over NCCL and across tasks over a ring,
+      when every task has the same number of GPUs.
     timeout: a float. If set to a non zero, set a completion timeout to detect
       staleness.  If the timer goes off, a DeadlineExceededError is raised.  The
       timeout value in seconds. This feature is experimental.
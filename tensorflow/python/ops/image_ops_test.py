@@ -4441,6 +4441,35 @@ class JpegTest(test_util.TensorFlowTestCase):
         error = self.averageError(rgb, cmyk)
         self.assertLess(error, 4)
 
+  def testBatchDecodeJpeg(self):
+    path = ("tensorflow/core/lib/jpeg/testdata/"
+            "jpeg_merge_test1.jpg")
+    with self.cached_session():
+      jpeg0 = io_ops.read_file(path)
+      jpeg1 = image_ops.encode_jpeg(image_ops.decode_jpeg(jpeg0))
+      for ratio in 1, 4:
+        images = [
+            image_ops.decode_jpeg(jpeg, ratio=ratio) for jpeg in (jpeg0, jpeg1)
+        ]
+        batch = gen_image_ops.batch_decode_jpeg(
+            array_ops.stack([jpeg0, jpeg1]), ratio=ratio)
+        images, batch = self.evaluate([images, batch])
+        self.assertEqual(batch.shape, (2,) + images[0].shape)
+        self.assertAllEqual(batch[0], images[0])
+        self.assertAllEqual(batch[1], images[1])
+
+  def testBatchDecodeJpegDifferentShapes(self):
+    path = ("tensorflow/core/lib/jpeg/testdata/"
+            "jpeg_merge_test1.jpg")
+    with self.cached_session():
+      jpeg0 = io_ops.read_file(path)
+      jpeg1 = image_ops.encode_jpeg(
+          image_ops.decode_jpeg(jpeg0, ratio=2))
+      with self.assertRaisesRegex(errors.InvalidArgumentError,
+                                  "must have the same shape"):
+        self.evaluate(
+            gen_image_ops.batch_decode_jpeg(array_ops.stack([jpeg0, jpeg1])))
+
   def testCropAndDecodeJpeg(self):
     with self.cached_session() as sess:
       # Encode it, then decode it, then encode it
@@ -2121,7 +2121,8 @@ class DenseHashTable(LookupInterface):
                initial_num_buckets=None,
                name="MutableDenseHashTable",
                checkpoint=True,
-               experimental_is_anonymous=False):
+               experimental_is_anonymous=False,
+               experimental_num_shards=None):
     """Creates an empty `DenseHashTable` object.
 
     Creates a table, the type of its keys and values are specified by key_dtype
@@ -2152,13 +2153,23 @@ class DenseHashTable(LookupInterface):
         be looked up by a name. When all resource handles pointing to
         that resource are gone, the resource will be deleted
         automatically.
+      experimental_num_shards: If set, splits the table by key hash into this
+        many independently locked shards, which reduces lock contention when
+        many threads look up and insert concurrently, and makes growing the
+        table rehash one shard at a time. `initial_num_buckets` is split
+        between the shards. Tables with and without shards use different
+        checkpoint layouts. Not supported in anonymous mode.
 
     Returns:
       A `DenseHashTable` object.
 
     Raises:
-      ValueError: If checkpoint is True and no name was specified.
+      ValueError: If checkpoint is True and no name was specified, or if
+        `experimental_num_shards` is set in anonymous mode.
     """
+    if experimental_num_shards is not None and experimental_is_anonymous:
+      raise ValueError("`experimental_num_shards` is not supported when "
+                       "`experimental_is_anonymous` is True.")
     self._default_value = ops.convert_to_tensor(
         default_value, dtype=value_dtype, name="default_value")
     self._key_dtype = key_dtype
@@ -2172,6 +2183,7 @@ class DenseHashTable(LookupInterface):
     self._empty_key = empty_key
     self._deleted_key = deleted_key
     self._is_anonymous = experimental_is_anonymous
+    self._num_shards = experimental_num_shards
     if not self._is_anonymous:
       self._shared_name = None
       if context.executing_eagerly():
@@ -2205,15 +2217,27 @@ class DenseHashTable(LookupInterface):
       # training to work correctly. Use the node name if no shared_name has been
       # explicitly specified.
       use_node_name_sharing = self._checkpoint and self._shared_name is None
-      table_ref = gen_lookup_ops.mutable_dense_hash_table_v2(
-          empty_key=empty_key,
-          deleted_key=deleted_key,
-          shared_name=self._shared_name,
-          use_node_name_sharing=use_node_name_sharing,
-          value_dtype=self._value_dtype,
-          value_shape=self._value_shape,
-          initial_num_buckets=self._initial_num_buckets,
-          name=self._name)
+      if self._num_shards is not None:
+        table_ref = gen_lookup_ops.sharded_mutable_dense_hash_table(
+            empty_key=empty_key,
+            deleted_key=deleted_key,
+            shared_name=self._shared_name,
+            use_node_name_sharing=use_node_name_sharing,
+            value_dtype=self._value_dtype,
+            value_shape=self._value_shape,
+            initial_num_buckets=self._initial_num_buckets,
+            num_shards=self._num_shards,
+            name=self._name)
+      else:
+        table_ref = gen_lookup_ops.mutable_dense_hash_table_v2(
+            empty_key=empty_key,
+            deleted_key=deleted_key,
+            shared_name=self._shared_name,
+            use_node_name_sharing=use_node_name_sharing,
+            value_dtype=self._value_dtype,
+            value_shape=self._value_shape,
+            initial_num_buckets=self._initial_num_buckets,
+            name=self._name)
     if context.executing_eagerly():
       self._table_name = None
     else:
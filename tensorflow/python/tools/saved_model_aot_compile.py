@@ -21,6 +21,7 @@ import re
 import shlex
 from typing import List, Tuple
 
+from google.protobuf import text_format
 from tensorflow.core.protobuf import config_pb2
 from tensorflow.core.protobuf import meta_graph_pb2
 from tensorflow.python.client import session
@@ -316,7 +317,8 @@ def aot_compile_cpu_meta_graph_def(checkpoint_path,
                                    target_triple,
                                    target_cpu,
                                    variables_to_feed=(),
-                                   multithreading=False):
+                                   multithreading=False,
+                                   saved_model_dir=None):
   """Compile a `MetaGraphDef` to header+object files in `output_prefix`.
 
   Use XLA AOT (`tfcompile`) to convert the given meta graph and
@@ -349,6 +351,12 @@ def aot_compile_cpu_meta_graph_def(checkpoint_path,
     multithreading: Whether to enable multithreading in the compiled
       computation.  Note that if using this option, the resulting object files
       may have external dependencies on multithreading libraries like nsync.
+    saved_model_dir: Optional Python string.  If set, the generated header and
+      object files are also copied into
+      `saved_model_dir/assets.extra/xla_aot/<signature_def_key>/` together with
+      an `aot_compiled_signature.pbtxt` describing them, so that C++
+      `LoadSavedModel` exposes the compiled signature when `cpp_class` is
+      linked into the serving binary.
 
   Raises:
     RuntimeError: If tensorflow was not built with XLA.
@@ -393,6 +401,7 @@ def aot_compile_cpu_meta_graph_def(checkpoint_path,
   with file_io.FileIO(makefile_inc_location, mode='w') as makefile_writer:
     makefile_writer.write(_xla_makefile_string(output_prefix))
 
+  unquoted_output_prefix = output_prefix
   output_prefix = _shlex_quote(output_prefix)
 
   _pywrap_tfcompile.Compile(
@@ -409,6 +418,46 @@ def aot_compile_cpu_meta_graph_def(checkpoint_path,
       # ProgramShape isn't uniquefied by entry_point.
       gen_program_shape=False)
 
+  if saved_model_dir:
+    _store_aot_artifacts_in_saved_model(
+        saved_model_dir=saved_model_dir,
+        output_prefix=unquoted_output_prefix,
+        config_pbtxt_location=config_pbtxt_location,
+        signature_def_key=signature_def_key,
+        cpp_class=cpp_class,
+        target_triple=target_triple,
+        target_cpu=target_cpu)
+
+
+def _store_aot_artifacts_in_saved_model(saved_model_dir, output_prefix,
+                                        config_pbtxt_location,
+                                        signature_def_key, cpp_class,
+                                        target_triple, target_cpu):
+  """Copies tfcompile outputs into the SavedModel's `assets.extra`."""
+  from tensorflow.compiler.tf2xla import tf2xla_pb2  # pylint: disable=g-import-not-at-top
+
+  aot_dir = os.path.join(saved_model_dir, 'assets.extra', 'xla_aot',
+                         signature_def_key)
+  file_io.recursive_create_dir(aot_dir)
+  logging.info('Storing XLA AOT artifacts in: {}'.format(aot_dir))
+  basename = os.path.basename(output_prefix)
+  for suffix in ('.o', '.h', '_metadata.o'):
+    file_io.copy(output_prefix + suffix,
+                 os.path.join(aot_dir, basename + suffix),
+                 overwrite=True)
+
+  signature = tf2xla_pb2.AotCompiledSignature(
+      signature_def_key=signature_def_key,
+      cpp_class=cpp_class.lstrip(':'),
+      target_triple=target_triple,
+      target_cpu=target_cpu)
+  text_format.Parse(
+      file_io.read_file_to_string(config_pbtxt_location), signature.config)
+  with file_io.FileIO(
+      os.path.join(aot_dir, 'aot_compiled_signature.pbtxt'),
+      mode='w') as writer:
+    writer.write(str(signature))
+
 
 def _optimize_graph(meta_graph_def, signature_def):
   """Optimize `meta_graph_def` using grappler.  Returns a `GraphDef`."""
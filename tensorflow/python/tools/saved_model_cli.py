@@ -856,6 +856,10 @@ def freeze_model(args):
     variables_to_feed = None  # We will identify them after.
   else:
     variables_to_feed = args.variables_to_feed.split(',')
+  if args.store_in_saved_model.lower() in ('f', 'false', '0'):
+    saved_model_dir = None
+  else:
+    saved_model_dir = args.dir
 
   saved_model_aot_compile.freeze_model(
       checkpoint_path=checkpoint_path,
@@ -892,7 +896,8 @@ def aot_compile_cpu(args):
       target_triple=args.target_triple,
       target_cpu=args.target_cpu,
       cpp_class=args.cpp_class,
-      multithreading=args.multithreading.lower() not in ('f', 'false', '0'))
+      multithreading=args.multithreading.lower() not in ('f', 'false', '0'),
+      saved_model_dir=saved_model_dir)
 
 
 def add_show_subparser(subparsers):
@@ -1239,6 +1244,16 @@ def add_aot_compile_cpu_subparser(subparsers):
             'Note that if using this option, the resulting object files '
             'may have external dependencies on multithreading libraries '
             'like nsync.'))
+  parser_compile.add_argument(
+      '--store_in_saved_model',
+      type=str,
+      default='False',
+      help=('Also store the generated header and object files under '
+            'assets.extra/xla_aot/<signature_def_key> in the SavedModel '
+            'directory given by --dir.  C++ LoadSavedModel exposes the '
+            'compiled signature in SavedModelBundle::aot_compiled_signatures '
+            'when the generated class is linked into the serving binary and '
+            'registered with REGISTER_XLA_AOT_FUNCTION.'))
 
   parser_compile.set_defaults(func=aot_compile_cpu)
 
@@ -875,6 +875,37 @@ Concrete Functions:
     self.assertTrue(
         file_io.file_exists(os.path.join(output_prefix, 'config.pbtxt')))
 
+  def testAOTCompileCPUStoresArtifactsInSavedModel(self):
+    if not test.is_built_with_xla():
+      self.skipTest('Skipping test because XLA is not compiled in.')
+
+    saved_model_dir = os.path.join(test.get_temp_dir(), 'dummy_model_aot')
+    dummy_model = self.AOTCompileDummyModel()
+    with self.cached_session():
+      self.evaluate(dummy_model.var.initializer)
+      self.evaluate(dummy_model.write_var.initializer)
+      save.save(dummy_model, saved_model_dir,
+                signatures={'func': dummy_model.func2})
+
+    self.parser = saved_model_cli.create_parser()
+    output_prefix = os.path.join(test.get_temp_dir(), 'aot_store_dir/out')
+    args = self.parser.parse_args([
+        'aot_compile_cpu', '--dir', saved_model_dir, '--tag_set', 'serve',
+        '--signature_def_key', 'func', '--output_prefix', output_prefix,
+        '--cpp_class', 'foo::Generated', '--store_in_saved_model', 'True'
+    ])
+    with test.mock.patch.object(logging, 'warn'):
+      saved_model_cli.aot_compile_cpu(args)
+    aot_dir = os.path.join(saved_model_dir, 'assets.extra', 'xla_aot', 'func')
+    for suffix in ('.o', '.h', '_metadata.o'):
+      self.assertTrue(
+          file_io.file_exists(os.path.join(aot_dir, 'out' + suffix)))
+    signature_contents = file_io.read_file_to_string(
+        os.path.join(aot_dir, 'aot_compiled_signature.pbtxt'))
+    self.assertIn('signature_def_key: "func"', signature_contents)
+    self.assertIn('cpp_class: "foo::Generated"', signature_contents)
+    self.assertIn('fetch {', signature_contents)
+
 
 if __name__ == '__main__':
   test.main()
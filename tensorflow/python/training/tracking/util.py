@@ -77,6 +77,37 @@ _CHECKPOINT_V2 = "checkpoint_v2"
 _ASYNC_CHECKPOINT_THREAD = None
 
 
+class _AsyncCheckpointThread(threading.Thread):
+  """Background checkpoint write that keeps the error it raised, if any."""
+
+  def __init__(self, target):
+    super(_AsyncCheckpointThread, self).__init__(target=target)
+    self.error = None
+
+  def run(self):
+    try:
+      super(_AsyncCheckpointThread, self).run()
+    except Exception as e:  # pylint: disable=broad-except
+      self.error = e
+
+
+def _wait_for_async_checkpoint():
+  """Blocks until the in-flight async checkpoint write, if any, finishes.
+
+  Raises:
+    The error raised by the background write, if it failed. The error is only
+    raised once.
+  """
+  global _ASYNC_CHECKPOINT_THREAD
+  thread = _ASYNC_CHECKPOINT_THREAD
+  if thread is None:
+    return
+  _ASYNC_CHECKPOINT_THREAD = None
+  thread.join()
+  if thread.error is not None:
+    raise thread.error
+
+
 def _get_duration_microseconds(start_time_seconds, end_time_seconds):
   if end_time_seconds < start_time_seconds:
     # Avoid returning negative value in case of clock skew.
@@ -1255,10 +1286,10 @@ class TrackableSaver(object):
 
       # Step-2: Execute the rest of the checkpoint operations on the host device
       #         using an async executor.
+      #         A failure of the previous async write is raised here.
+      _wait_for_async_checkpoint()
       global _ASYNC_CHECKPOINT_THREAD
-      if _ASYNC_CHECKPOINT_THREAD is not None:
-        _ASYNC_CHECKPOINT_THREAD.join()
-      _ASYNC_CHECKPOINT_THREAD = threading.Thread(target=_async_save_fn)
+      _ASYNC_CHECKPOINT_THREAD = _AsyncCheckpointThread(target=_async_save_fn)
       _ASYNC_CHECKPOINT_THREAD.start()
 
       # Step-3: Return the expected checkpoint file path though the save op may
@@ -1415,9 +1446,7 @@ class TrackableSaver(object):
     #                   are still ongiing. Need to add timeout mechanism along
     #                   with conditional variables to notify when the checkpoint
     #                   file is ready.
-    global _ASYNC_CHECKPOINT_THREAD
-    if _ASYNC_CHECKPOINT_THREAD is not None:
-      _ASYNC_CHECKPOINT_THREAD.join()
+    _wait_for_async_checkpoint()
 
     reader = py_checkpoint_reader.NewCheckpointReader(save_path)
     graph_building = not context.executing_eagerly()
@@ -2376,6 +2405,21 @@ class Checkpoint(tracking.AutoTrackable):
 
     return file_path
 
+  def sync(self):
+    """Waits for an asynchronous checkpoint write to finish.
+
+    With `tf.train.CheckpointOptions(experimental_enable_async_checkpoint=True)`
+    `save()` and `write()` return once variable values are copied to the host,
+    and the files are written on a background thread. `sync()` blocks until
+    that write is done, e.g. before the checkpoint files are copied elsewhere.
+    A failed background write is reported by the next call to `sync()`,
+    `save()`, `write()` or `restore()`.
+
+    Raises:
+      The error raised by the background write, if it failed.
+    """
+    _wait_for_async_checkpoint()
+
   def read(self, save_path, options=None):
     """Reads a training checkpoint written with `write`.
 
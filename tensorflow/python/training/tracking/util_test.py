@@ -353,6 +353,25 @@ class CheckpointingTests(parameterized.TestCase, test.TestCase):
         self.fail("%s should have suffix %s" % (path, expected_suffix))
       self.evaluate(step.assign_add(2))
 
+  def testAsyncCheckpointErrorRaisedBySync(self):
+    with context.eager_mode():
+      not_a_directory = os.path.join(self.get_temp_dir(), "file")
+      with open(not_a_directory, "w") as f:
+        f.write("x")
+      checkpoint = trackable_utils.Checkpoint(v=variables_lib.Variable(1.))
+      ckpt_options = checkpoint_options.CheckpointOptions(
+          experimental_enable_async_checkpoint=True)
+      checkpoint.write(os.path.join(not_a_directory, "ckpt"),
+                       options=ckpt_options)
+      with self.assertRaises(errors_impl.OpError):
+        checkpoint.sync()
+      # The error is reported once, and later writes still succeed.
+      checkpoint.sync()
+      prefix = os.path.join(self.get_temp_dir(), "ckpt")
+      checkpoint.write(prefix, options=ckpt_options)
+      checkpoint.sync()
+      self.assertTrue(os.path.exists(prefix + ".index"))
+
   def testPartialRestoreWarningAttribute(self):
     with context.eager_mode():
       original_root = trackable_utils.Checkpoint(v1=variables_lib.Variable(2.),
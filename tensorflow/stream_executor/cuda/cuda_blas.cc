@@ -482,7 +482,7 @@ cublasLtPointerMode_t CUBLASPointerMode(blas::PointerMode pointer_mode) {
       return CUBLASLT_POINTER_MODE_DEVICE;
   }
 }
-cublasLtEpilogue_t CUBLASEpilogue(blas::Epilogue epilogue) {
+port::StatusOr<cublasLtEpilogue_t> CUBLASEpilogue(blas::Epilogue epilogue) {
   switch (epilogue) {
     case blas::Epilogue::kDefault:
       return CUBLASLT_EPILOGUE_DEFAULT;
@@ -492,6 +492,17 @@ cublasLtEpilogue_t CUBLASEpilogue(blas::Epilogue epilogue) {
       return CUBLASLT_EPILOGUE_BIAS;
     case blas::Epilogue::kBiasThenReLU:
       return CUBLASLT_EPILOGUE_RELU_BIAS;
+#if CUDA_VERSION >= 11040
+    case blas::Epilogue::kGELU:
+      return CUBLASLT_EPILOGUE_GELU;
+    case blas::Epilogue::kBiasThenGELU:
+      return CUBLASLT_EPILOGUE_GELU_BIAS;
+#else
+    case blas::Epilogue::kGELU:
+    case blas::Epilogue::kBiasThenGELU:
+      return port::Status(port::error::UNIMPLEMENTED,
+                          "GELU epilogues require CUDA 11.4 or newer");
+#endif
   }
 }
 #endif  // CUDA_VERSION >= 11000
@@ -3228,8 +3239,10 @@ port::StatusOr<UniqueOpDesc> CreateCublasLtOperationDesc(
   UniqueOpDesc unique_desc(desc);
   SE_RETURN_IF_ERROR(SetCublasLtAttr(desc, CUBLASLT_MATMUL_DESC_POINTER_MODE,
                                      CUBLASPointerMode(pointer_mode)));
+  TF_ASSIGN_OR_RETURN(cublasLtEpilogue_t cublas_epilogue,
+                      CUBLASEpilogue(epilogue));
   SE_RETURN_IF_ERROR(SetCublasLtAttr(desc, CUBLASLT_MATMUL_DESC_EPILOGUE,
-                                     CUBLASEpilogue(epilogue)));
+                                     cublas_epilogue));
   SE_RETURN_IF_ERROR(SetCublasLtAttr(desc, CUBLASLT_MATMUL_DESC_TRANSA,
                                      CUDABlasTranspose(transa)));
   SE_RETURN_IF_ERROR(SetCublasLtAttr(desc, CUBLASLT_MATMUL_DESC_TRANSB,
@@ -3589,7 +3602,8 @@ bool CUDABlas::DoBlasLtMatmulInternal(
     return false;
   }
   if ((cuda_plan.params().epilogue == blas::Epilogue::kBias ||
-       cuda_plan.params().epilogue == blas::Epilogue::kBiasThenReLU) !=
+       cuda_plan.params().epilogue == blas::Epilogue::kBiasThenReLU ||
+       cuda_plan.params().epilogue == blas::Epilogue::kBiasThenGELU) !=
       (bias != nullptr)) {
     VLOG(2) << "DoBlasLtMatmul returning false because plan has wrong "
                "epilogue for the given bias pointer.";
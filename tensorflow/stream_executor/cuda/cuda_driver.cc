@@ -792,6 +792,18 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
   }
 }
 
+/* static */ port::Status GpuDriver::PrefetchUnifiedMemoryAsync(
+    GpuContext* context, CUdeviceptr location, uint64_t bytes,
+    CUstream stream) {
+  ScopedActivateContext activation(context);
+  auto device = DeviceFromContext(context);
+  if (!device.ok()) return device.status();
+  RETURN_IF_CUDA_RES_ERROR(
+      cuMemPrefetchAsync(location, bytes, device.ValueOrDie(), stream),
+      "Failed to enqueue prefetch of unified memory");
+  return port::Status::OK();
+}
+
 /* static */ void* GpuDriver::HostAllocate(GpuContext* context,
                                            uint64_t bytes) {
   ScopedActivateContext activation(context);
@@ -970,6 +982,75 @@ GpuDriver::CreateMemoryHandle(GpuContext* context, uint64_t bytes) {
   }
 }
 
+/* static */ port::Status GpuDriver::StreamBeginCapture(GpuContext* context,
+                                                        CUstream stream) {
+  ScopedActivateContext activation(context);
+  RETURN_IF_CUDA_RES_ERROR(
+      cuStreamBeginCapture(stream, CU_STREAM_CAPTURE_MODE_THREAD_LOCAL),
+      "Failed to begin stream capture");
+  return port::Status::OK();
+}
+
+/* static */ port::StatusOr<CUgraph> GpuDriver::StreamEndCapture(
+    GpuContext* context, CUstream stream) {
+  ScopedActivateContext activation(context);
+  CUgraph graph;
+  RETURN_IF_CUDA_RES_ERROR(cuStreamEndCapture(stream, &graph),
+                           "Failed to end stream capture");
+  return graph;
+}
+
+/* static */ port::StatusOr<CUgraphExec> GpuDriver::GraphInstantiate(
+    GpuContext* context, CUgraph graph) {
+  ScopedActivateContext activation(context);
+  CUgraphExec exec;
+  RETURN_IF_CUDA_RES_ERROR(
+      cuGraphInstantiate(&exec, graph, /*phErrorNode=*/nullptr,
+                         /*logBuffer=*/nullptr, /*bufferSize=*/0),
+      "Failed to instantiate CUDA graph");
+  return exec;
+}
+
+/* static */ port::StatusOr<bool> GpuDriver::GraphExecUpdate(
+    GpuContext* context, CUgraphExec exec, CUgraph graph) {
+  ScopedActivateContext activation(context);
+  CUgraphNode error_node;
+  CUgraphExecUpdateResult result;
+  CUresult res = cuGraphExecUpdate(exec, graph, &error_node, &result);
+  if (res == CUDA_ERROR_GRAPH_EXEC_UPDATE_FAILURE) {
+    VLOG(2) << "CUDA graph update failed with result " << result;
+    return false;
+  }
+  RETURN_IF_CUDA_RES_ERROR(res, "Failed to update CUDA graph");
+  return true;
+}
+
+/* static */ port::Status GpuDriver::GraphLaunch(GpuContext* context,
+                                                 CUgraphExec exec,
+                                                 CUstream stream) {
+  ScopedActivateContext activation(context);
+  RETURN_IF_CUDA_RES_ERROR(cuGraphLaunch(exec, stream),
+                           "Failed to launch CUDA graph");
+  return port::Status::OK();
+}
+
+/* static */ void GpuDriver::DestroyGraph(GpuContext* context, CUgraph graph) {
+  ScopedActivateContext activation(context);
+  CUresult res = cuGraphDestroy(graph);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "Failed to destroy CUDA graph: " << ToString(res);
+  }
+}
+
+/* static */ void GpuDriver::DestroyGraphExec(GpuContext* context,
+                                              CUgraphExec exec) {
+  ScopedActivateContext activation(context);
+  CUresult res = cuGraphExecDestroy(exec);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "Failed to destroy CUDA graph exec: " << ToString(res);
+  }
+}
+
 #endif
 
 /* static */ port::Status GpuDriver::DestroyEvent(GpuContext* context,
@@ -16,8 +16,12 @@ limitations under the License.
 #if GOOGLE_CUDA
 #include "tensorflow/stream_executor/cuda/cuda_driver.h"
 
+#include <string.h>
+
+#include "absl/base/casts.h"
 #include "absl/memory/memory.h"
 #include "third_party/gpus/cuda/include/cuda_runtime_api.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace stream_executor {
@@ -70,6 +74,44 @@ TEST(CudaDriverTest, ScopedActivateContextTest) {
   }
 }
 
+TEST(CudaDriverTest, PrefetchUnifiedMemoryAsync) {
+  CHECK_CUDA(cuInit(0));
+  CUdevice device;
+  CHECK_CUDA(cuDeviceGet(&device, 0));
+  int concurrent_managed_access = 0;
+  CHECK_CUDA(cuDeviceGetAttribute(
+      &concurrent_managed_access,
+      CU_DEVICE_ATTRIBUTE_CONCURRENT_MANAGED_ACCESS, device));
+  if (!concurrent_managed_access) {
+    GTEST_SKIP() << "The GPU does not support prefetching unified memory";
+  }
+  CUcontext context;
+  CHECK_CUDA(cuCtxCreate(&context, 0, device));
+  GpuContext se_context(context, /*id=*/102);
+
+  constexpr uint64_t kBytes = 4 << 20;
+  void* memory = GpuDriver::UnifiedMemoryAllocate(&se_context, kBytes);
+  ASSERT_NE(memory, nullptr);
+  // Touch the pages on the host, so that the prefetch has to migrate them.
+  memset(memory, 1, kBytes);
+  CUstream stream;
+  CHECK_CUDA(cuStreamCreate(&stream, CU_STREAM_NON_BLOCKING));
+  TF_EXPECT_OK(GpuDriver::PrefetchUnifiedMemoryAsync(
+      &se_context, absl::bit_cast<CUdeviceptr>(memory), kBytes, stream));
+  CHECK_CUDA(cuStreamSynchronize(stream));
+  int location = -1;
+  CHECK_CUDA(cuMemRangeGetAttribute(
+      &location, sizeof(location),
+      CU_MEM_RANGE_ATTRIBUTE_LAST_PREFETCH_LOCATION,
+      absl::bit_cast<CUdeviceptr>(memory), kBytes));
+  EXPECT_EQ(location, device);
+  EXPECT_EQ(static_cast<char*>(memory)[kBytes - 1], 1);
+
+  CHECK_CUDA(cuStreamDestroy(stream));
+  GpuDriver::UnifiedMemoryDeallocate(&se_context, memory);
+  CHECK_CUDA(cuCtxDestroy(context));
+}
+
 }  // namespace gpu
 }  // namespace stream_executor
 
@@ -118,6 +118,16 @@ class GpuDriver {
   // (supported on CUDA only)
   static void UnifiedMemoryDeallocate(GpuContext* context, void* location);
 
+  // Enqueues onto `stream` a migration of the unified memory in
+  // [location, location + bytes) to the device of the given context via
+  // cuMemPrefetchAsync. The pages are accessible at all times, so nothing needs
+  // to wait for the migration.
+  // (supported on CUDA only)
+  static port::Status PrefetchUnifiedMemoryAsync(GpuContext* context,
+                                                 GpuDevicePtr location,
+                                                 uint64_t bytes,
+                                                 GpuStreamHandle stream);
+
   // Allocates page-locked and CUDA-registered memory on the host via
   // cuMemAllocHost.
   // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__MEM.html#group__CUDA__MEM_1gdd8311286d2c2691605362c689bc64e0
@@ -196,6 +206,43 @@ class GpuDriver {
   // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__VA.html#group__CUDA__VA_1gfb50aac00c848fd7087e858f59bf7e2a
   static void UnmapMemory(GpuContext* context, GpuDevicePtr va, uint64_t bytes);
 
+  // Starts capturing the work enqueued on stream into a graph via
+  // cuStreamBeginCapture, rather than running it. Only work enqueued by the
+  // calling thread is captured.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__STREAM.html#group__CUDA__STREAM_1g767167da0bbf07157dc20b6c258a2143
+  static port::Status StreamBeginCapture(GpuContext* context,
+                                         GpuStreamHandle stream);
+
+  // Ends the capture started by StreamBeginCapture via cuStreamEndCapture and
+  // returns the captured graph, which is owned by the caller.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__STREAM.html#group__CUDA__STREAM_1g03dab8b2ba76b00718955177a929970c
+  static port::StatusOr<CUgraph> StreamEndCapture(GpuContext* context,
+                                                  GpuStreamHandle stream);
+
+  // Creates an executable graph from graph via cuGraphInstantiate. The result
+  // is owned by the caller.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__GRAPH.html#group__CUDA__GRAPH_1gb53b435e178cccfa37ac87285d2c3fa1
+  static port::StatusOr<CUgraphExec> GraphInstantiate(GpuContext* context,
+                                                      CUgraph graph);
+
+  // Updates the parameters of exec, such as kernel arguments, to those of
+  // graph via cuGraphExecUpdate. Returns false, leaving exec unchanged, if the
+  // topology of graph differs from the one exec was instantiated from.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__GRAPH.html#group__CUDA__GRAPH_1g96efefc56df46927da7297f122adfb9f
+  static port::StatusOr<bool> GraphExecUpdate(GpuContext* context,
+                                              CUgraphExec exec, CUgraph graph);
+
+  // Enqueues exec on stream via cuGraphLaunch.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__GRAPH.html#group__CUDA__GRAPH_1g6b2dceb3901e71a390d2bd8b0491e471
+  static port::Status GraphLaunch(GpuContext* context, CUgraphExec exec,
+                                  GpuStreamHandle stream);
+
+  // Destroys a graph via cuGraphDestroy.
+  static void DestroyGraph(GpuContext* context, CUgraph graph);
+
+  // Destroys an executable graph via cuGraphExecDestroy.
+  static void DestroyGraphExec(GpuContext* context, CUgraphExec exec);
+
 #endif  // CUDA_VERSION >= 10200
 
   // Given a device ordinal, returns a device handle into the device outparam,
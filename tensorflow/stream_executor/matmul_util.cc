@@ -97,7 +97,8 @@ static inline port::StatusOr<blas::ComputationType> GetBlasComputationType(
 port::StatusOr<const blas::PlanAndAlgorithms*> GetPlanAndAlgorithms(
     Stream* stream, BatchMatmulParameters matmul_parameters, int64_t batch_size,
     tensorflow::DataType dtype, blas::MatrixDescriptor lhs_matrix,
-    blas::MatrixDescriptor rhs_matrix, blas::MatrixDescriptor output_matrix) {
+    blas::MatrixDescriptor rhs_matrix, blas::MatrixDescriptor output_matrix,
+    blas::Epilogue epilogue) {
   static const int64_t max_scratch_size =
       GetWorkspaceLimit(1LL << 32);  // 4GB by default
   static const int64_t max_autotune_algorithm_count =
@@ -107,7 +108,7 @@ port::StatusOr<const blas::PlanAndAlgorithms*> GetPlanAndAlgorithms(
   if (!plan_and_algorithms) {
     TF_ASSIGN_OR_RETURN(blas::BlasLtMatmulPlanParams plan_params,
                         CreatePlanParams(batch_size, dtype, lhs_matrix,
-                                         rhs_matrix, output_matrix));
+                                         rhs_matrix, output_matrix, epilogue));
     TF_ASSIGN_OR_RETURN(std::unique_ptr<blas::IBlasLtMatmulPlan> plan,
                         stream->parent()->CreateBlasLtMatmulPlan(plan_params));
     TF_ASSIGN_OR_RETURN(
@@ -125,7 +126,7 @@ port::StatusOr<const blas::PlanAndAlgorithms*> GetPlanAndAlgorithms(
 port::StatusOr<blas::BlasLtMatmulPlanParams> CreatePlanParams(
     int64_t batch_size, tensorflow::DataType dtype,
     blas::MatrixDescriptor lhs_matrix, blas::MatrixDescriptor rhs_matrix,
-    blas::MatrixDescriptor output_matrix) {
+    blas::MatrixDescriptor output_matrix, blas::Epilogue epilogue) {
   blas::BlasLtMatmulPlanParams plan_params;
   int64_t m = output_matrix.num_rows;
   int64_t n = output_matrix.num_cols;
@@ -141,7 +142,7 @@ port::StatusOr<blas::BlasLtMatmulPlanParams> CreatePlanParams(
   plan_params.computation_type = computation_type;
 
   plan_params.pointer_mode = blas::PointerMode::kHost;
-  plan_params.epilogue = blas::Epilogue::kDefault;
+  plan_params.epilogue = epilogue;
 
   plan_params.transa = lhs_matrix.transpose;
   plan_params.transb = rhs_matrix.transpose;
@@ -652,6 +652,14 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
       << "Feature not supported on ROCm platform (UnifiedMemoryDeallocate)";
 }
 
+/* static */ port::Status GpuDriver::PrefetchUnifiedMemoryAsync(
+    GpuContext* context, hipDeviceptr_t location, uint64_t bytes,
+    GpuStreamHandle stream) {
+  return port::Status{
+      port::error::UNIMPLEMENTED,
+      "Feature not supported on ROCm platform (PrefetchUnifiedMemoryAsync)"};
+}
+
 /* static */ void* GpuDriver::HostAllocate(GpuContext* context,
                                            uint64_t bytes) {
   ScopedActivateContext activation{context};
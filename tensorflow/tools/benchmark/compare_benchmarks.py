@@ -0,0 +1,185 @@
+# Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Flags the benchmarks that regressed between two builds.
+
+Compares two JSON files written by a benchmark binary with
+`--benchmark_out_format=json --benchmark_out=<file>`, such as the curated
+suite of tensorflow/core/kernels:kernel_benchmarks_test:
+
+  compare_benchmarks --baseline=/tmp/old.json --contender=/tmp/new.json
+
+Run the benchmarks with `--benchmark_repetitions` so that the comparison
+accounts for their noise. A benchmark regressed if its median time grew by more
+than `--threshold` and by more than `--noise_stddevs` standard deviations of
+either run. Exits with status 1 if any benchmark regressed.
+"""
+
+import json
+import statistics
+import sys
+
+from absl import app
+from absl import flags
+
+FLAGS = flags.FLAGS
+
+flags.DEFINE_string('baseline', None, 'Benchmark results of the old build.')
+flags.DEFINE_string('contender', None, 'Benchmark results of the new build.')
+flags.DEFINE_float('threshold', 0.05,
+                   'Relative slowdown of the median time that is a regression.')
+flags.DEFINE_float(
+    'noise_stddevs', 2.0,
+    'Standard deviations a slowdown must exceed to be a regression.')
+flags.DEFINE_string('output_json', None,
+                    'File to write the comparison of every benchmark to.')
+
+_TIME_UNITS = {'ns': 1e-9, 'us': 1e-6, 'ms': 1e-3, 's': 1.0}
+
+
+class Summary(object):
+  """The statistics of the repetitions of a benchmark, in seconds."""
+
+  def __init__(self, median, stddev, repetitions):
+    self.median = median
+    self.stddev = stddev
+    self.repetitions = repetitions
+
+
+def _time(entry, key):
+  return entry[key] * _TIME_UNITS[entry.get('time_unit', 'ns')]
+
+
+def summarize(results, key='real_time'):
+  """Returns a map from benchmark name to the `Summary` of its `key` times.
+
+  Uses the median and stddev aggregates of the benchmark if the results have
+  them, and the individual repetitions otherwise.
+
+  Args:
+    results: The parsed JSON output of a benchmark binary.
+    key: 'real_time' or 'cpu_time'.
+  """
+  repetitions = {}
+  aggregates = {}
+  for entry in results.get('benchmarks', []):
+    name = entry.get('run_name', entry['name'])
+    if entry.get('run_type') == 'aggregate':
+      aggregates.setdefault(name, {})[entry['aggregate_name']] = entry
+    elif 'error_occurred' not in entry:
+      repetitions.setdefault(name, []).append(_time(entry, key))
+
+  summaries = {}
+  for name in set(repetitions) | set(aggregates):
+    times = repetitions.get(name, [])
+    aggregate = aggregates.get(name, {})
+    if 'median' in aggregate:
+      median = _time(aggregate['median'], key)
+    elif times:
+      median = statistics.median(times)
+    else:
+      continue
+    if 'stddev' in aggregate:
+      stddev = _time(aggregate['stddev'], key)
+    elif len(times) > 1:
+      stddev = statistics.stdev(times)
+    else:
+      stddev = 0.0
+    count = aggregate.get('median', {}).get('repetitions', len(times))
+    summaries[name] = Summary(median, stddev, count)
+  return summaries
+
+
+def compare(baseline, contender, threshold, noise_stddevs):
+  """Compares the summaries of the benchmarks that both runs have.
+
+  Args:
+    baseline: The `summarize` output of the old build.
+    contender: The `summarize` output of the new build.
+    threshold: The relative slowdown of the median that is a regression.
+    noise_stddevs: The standard deviations a slowdown must exceed.
+
+  Returns:
+    A list of dicts, sorted by benchmark name, with the `name`, the median
+    times in seconds, the relative `change` of the median, and whether the
+    benchmark `regressed` or `improved`.
+  """
+  comparisons = []
+  for name in sorted(set(baseline) & set(contender)):
+    old = baseline[name]
+    new = contender[name]
+    change = (new.median - old.median) / old.median if old.median else 0.0
+    noise = noise_stddevs * max(old.stddev, new.stddev)
+    significant = abs(new.median - old.median) > noise
+    comparisons.append({
+        'name': name,
+        'baseline_median_s': old.median,
+        'contender_median_s': new.median,
+        'change': change,
+        'regressed': significant and change > threshold,
+        'improved': significant and change < -threshold,
+    })
+  return comparisons
+
+
+def _format_time(seconds):
+  for unit in ('s', 'ms', 'us', 'ns'):
+    if seconds >= _TIME_UNITS[unit] or unit == 'ns':
+      return '%.3g%s' % (seconds / _TIME_UNITS[unit], unit)
+
+
+def _load(path):
+  with open(path) as f:
+    return json.load(f)
+
+
+def main(argv):
+  if len(argv) > 1:
+    raise app.UsageError('Too many command-line arguments.')
+  baseline = summarize(_load(FLAGS.baseline))
+  contender = summarize(_load(FLAGS.contender))
+  comparisons = compare(baseline, contender, FLAGS.threshold,
+                        FLAGS.noise_stddevs)
+
+  width = max([len(c['name']) for c in comparisons] + [9])
+  print('%-*s %10s %10s %8s' % (width, 'Benchmark', 'Baseline', 'Contender',
+                                'Change'))
+  for c in comparisons:
+    status = ''
+    if c['regressed']:
+      status = '  REGRESSED'
+    elif c['improved']:
+      status = '  improved'
+    print('%-*s %10s %10s %+7.1f%%%s' %
+          (width, c['name'], _format_time(c['baseline_median_s']),
+           _format_time(c['contender_median_s']), 100 * c['change'], status))
+  for name in sorted(set(baseline) - set(contender)):
+    print('%s is missing from the contender' % name)
+  for name in sorted(set(contender) - set(baseline)):
+    print('%s is new in the contender' % name)
+
+  if FLAGS.output_json:
+    with open(FLAGS.output_json, 'w') as f:
+      json.dump(comparisons, f, indent=2)
+
+  regressions = [c for c in comparisons if c['regressed']]
+  if regressions:
+    print('%d of %d benchmarks regressed.' %
+          (len(regressions), len(comparisons)))
+    sys.exit(1)
+
+
+if __name__ == '__main__':
+  flags.mark_flags_as_required(['baseline', 'contender'])
+  app.run(main)
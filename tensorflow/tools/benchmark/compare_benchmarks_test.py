@@ -0,0 +1,89 @@
+# Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for compare_benchmarks."""
+
+from absl.testing import absltest
+
+from tensorflow.tools.benchmark import compare_benchmarks
+
+
+def _aggregates(name, median, stddev, time_unit='ns'):
+  return [{
+      'name': name + '_' + aggregate,
+      'run_name': name,
+      'run_type': 'aggregate',
+      'aggregate_name': aggregate,
+      'repetitions': 10,
+      'real_time': value,
+      'cpu_time': value,
+      'time_unit': time_unit,
+  } for aggregate, value in (('median', median), ('stddev', stddev))]
+
+
+def _iterations(name, times):
+  return [{
+      'name': name,
+      'run_name': name,
+      'run_type': 'iteration',
+      'real_time': time,
+      'cpu_time': time,
+      'time_unit': 'ns'
+  } for time in times]
+
+
+class CompareBenchmarksTest(absltest.TestCase):
+
+  def testSummarizeAggregates(self):
+    summaries = compare_benchmarks.summarize(
+        {'benchmarks': _aggregates('BM_A/1', 2.0, 0.5, time_unit='us')})
+    self.assertAlmostEqual(summaries['BM_A/1'].median, 2e-6)
+    self.assertAlmostEqual(summaries['BM_A/1'].stddev, 5e-7)
+    self.assertEqual(summaries['BM_A/1'].repetitions, 10)
+
+  def testSummarizeIterations(self):
+    summaries = compare_benchmarks.summarize(
+        {'benchmarks': _iterations('BM_A/1', [1.0, 3.0, 2.0])})
+    self.assertAlmostEqual(summaries['BM_A/1'].median, 2e-9)
+    self.assertAlmostEqual(summaries['BM_A/1'].stddev, 1e-9)
+    self.assertEqual(summaries['BM_A/1'].repetitions, 3)
+
+  def testCompare(self):
+    baseline = compare_benchmarks.summarize({
+        'benchmarks':
+            _aggregates('BM_Slower', 100, 1) +
+            _aggregates('BM_Noisy', 100, 20) +
+            _aggregates('BM_Faster', 100, 1) +
+            _aggregates('BM_Removed', 100, 1)
+    })
+    contender = compare_benchmarks.summarize({
+        'benchmarks':
+            _aggregates('BM_Slower', 120, 1) +
+            _aggregates('BM_Noisy', 120, 20) +
+            _aggregates('BM_Faster', 80, 1)
+    })
+    comparisons = compare_benchmarks.compare(
+        baseline, contender, threshold=0.05, noise_stddevs=2.0)
+    self.assertEqual([c['name'] for c in comparisons],
+                     ['BM_Faster', 'BM_Noisy', 'BM_Slower'])
+    faster, noisy, slower = comparisons
+    self.assertTrue(slower['regressed'])
+    self.assertAlmostEqual(slower['change'], 0.2)
+    self.assertFalse(noisy['regressed'])
+    self.assertFalse(faster['regressed'])
+    self.assertTrue(faster['improved'])
+
+
+if __name__ == '__main__':
+  absltest.main()
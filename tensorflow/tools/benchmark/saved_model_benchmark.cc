@@ -0,0 +1,293 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tools/benchmark/saved_model_benchmark.h"
+
+#if !defined(PLATFORM_WINDOWS)
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <utility>
+
+#include "tensorflow/cc/saved_model/warmup.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
+
+namespace tensorflow {
+namespace benchmark_model {
+namespace {
+
+// The feeds and fetches of a request.
+struct Feeds {
+  std::vector<std::pair<string, Tensor>> inputs;
+  std::vector<string> output_tensor_names;
+};
+
+// Resource usage of the process.
+struct Usage {
+  // User and system CPU time, or -1 if unknown.
+  int64 cpu_micros = -1;
+  int64 peak_memory_bytes = -1;
+};
+
+Usage GetUsage() {
+  Usage usage;
+#if !defined(PLATFORM_WINDOWS)
+  struct rusage rusage;
+  if (getrusage(RUSAGE_SELF, &rusage) == 0) {
+    usage.cpu_micros =
+        (rusage.ru_utime.tv_sec + rusage.ru_stime.tv_sec) * 1000000LL +
+        rusage.ru_utime.tv_usec + rusage.ru_stime.tv_usec;
+#if defined(__APPLE__)
+    usage.peak_memory_bytes = rusage.ru_maxrss;
+#else
+    usage.peak_memory_bytes = rusage.ru_maxrss * 1024LL;
+#endif
+  }
+#endif
+  return usage;
+}
+
+Status MakeTensor(const string& alias, const TensorInfo& info, int batch_size,
+                  random::SimplePhilox* random, Tensor* tensor) {
+  if (info.encoding_case() != TensorInfo::kName) {
+    return errors::Unimplemented("Cannot generate the composite input ",
+                                 alias);
+  }
+  TensorShape shape;
+  if (info.tensor_shape().unknown_rank()) {
+    shape.AddDim(batch_size);
+  } else {
+    for (int i = 0; i < info.tensor_shape().dim_size(); ++i) {
+      const int64 size = info.tensor_shape().dim(i).size();
+      shape.AddDim(size >= 0 ? size : (i == 0 ? batch_size : 1));
+    }
+  }
+  *tensor = Tensor(info.dtype(), shape);
+  switch (info.dtype()) {
+#define ZERO_CASE(T)           \
+  case DataTypeToEnum<T>::value: \
+    tensor->flat<T>().setZero(); \
+    break;
+    TF_CALL_POD_TYPES(ZERO_CASE)
+#undef ZERO_CASE
+    case DT_STRING:
+      break;
+    default:
+      return errors::Unimplemented("Cannot generate the input ", alias,
+                                   " of type ", DataTypeString(info.dtype()));
+  }
+  if (info.dtype() == DT_FLOAT) {
+    for (float& value : tensor->flat<float>()) value = random->RandFloat();
+  } else if (info.dtype() == DT_DOUBLE) {
+    for (double& value : tensor->flat<double>()) value = random->RandDouble();
+  }
+  return Status::OK();
+}
+
+// Returns the `p`-th percentile of the sorted `latencies` with the nearest
+// rank method.
+int64 Percentile(const std::vector<int64>& latencies, double p) {
+  if (latencies.empty()) return 0;
+  const int64 rank = static_cast<int64>(std::ceil(p * latencies.size()));
+  return latencies[std::min<int64>(std::max<int64>(rank, 1),
+                                   latencies.size()) -
+                   1];
+}
+
+}  // namespace
+
+string SavedModelBenchmarkStats::ToJson() const {
+  return strings::StrCat(
+      "{\"num_clients\": ", num_clients, ", \"target_qps\": ", target_qps,
+      ", \"num_requests\": ", num_requests, ", \"wall_time_s\": ", wall_time_s,
+      ", \"throughput_qps\": ", throughput_qps,
+      ", \"mean_latency_us\": ", mean_latency_us,
+      ", \"min_latency_us\": ", min_latency_us,
+      ", \"p50_latency_us\": ", p50_latency_us,
+      ", \"p90_latency_us\": ", p90_latency_us,
+      ", \"p99_latency_us\": ", p99_latency_us,
+      ", \"p999_latency_us\": ", p999_latency_us,
+      ", \"max_latency_us\": ", max_latency_us,
+      ", \"cpu_utilization\": ", cpu_utilization,
+      ", \"peak_memory_bytes\": ", peak_memory_bytes, "}");
+}
+
+Status MakeSignatureRequest(const SavedModelBundleInterface& bundle,
+                            const string& signature_name, int batch_size,
+                            SavedModelWarmupRequest* request) {
+  const auto signature = bundle.GetSignatures().find(signature_name);
+  if (signature == bundle.GetSignatures().end()) {
+    return errors::InvalidArgument("Unknown signature: ", signature_name);
+  }
+  request->Clear();
+  request->set_signature_name(signature_name);
+  random::PhiloxRandom philox(random::New64(), random::New64());
+  random::SimplePhilox random(&philox);
+  for (const auto& input : signature->second.inputs()) {
+    Tensor tensor;
+    TF_RETURN_IF_ERROR(
+        MakeTensor(input.first, input.second, batch_size, &random, &tensor));
+    tensor.AsProtoTensorContent(&(*request->mutable_inputs())[input.first]);
+  }
+  return Status::OK();
+}
+
+Status RunSavedModelBenchmark(
+    const SavedModelBenchmarkOptions& options,
+    const SavedModelBundleInterface& bundle,
+    const std::vector<SavedModelWarmupRequest>& requests,
+    SavedModelBenchmarkStats* stats) {
+  if (requests.empty()) {
+    return errors::InvalidArgument("No requests to benchmark.");
+  }
+  if (options.num_clients < 1) {
+    return errors::InvalidArgument("num_clients must be positive, got ",
+                                   options.num_clients);
+  }
+  // The requests are converted up front so that only Session::Run() is
+  // measured.
+  std::vector<Feeds> feeds(requests.size());
+  for (int i = 0; i < requests.size(); ++i) {
+    const auto signature =
+        bundle.GetSignatures().find(requests[i].signature_name());
+    if (signature == bundle.GetSignatures().end()) {
+      return errors::InvalidArgument("Unknown signature: ",
+                                     requests[i].signature_name());
+    }
+    TF_RETURN_IF_ERROR(GetSavedModelWarmupFeedsAndFetches(
+        requests[i], signature->second, &feeds[i].inputs,
+        &feeds[i].output_tensor_names));
+  }
+  auto run = [&](int64 i) {
+    const Feeds& request_feeds = feeds[i % feeds.size()];
+    std::vector<Tensor> outputs;
+    RunMetadata run_metadata;
+    return bundle.GetSession()->Run(
+        options.run_options, request_feeds.inputs,
+        request_feeds.output_tensor_names, {}, &outputs, &run_metadata);
+  };
+  for (int i = 0; i < options.num_warmup_requests; ++i) {
+    TF_RETURN_IF_ERROR(run(i));
+  }
+
+  mutex mu;
+  Status status;
+  std::vector<int64> latencies;
+  latencies.reserve(std::min<int64>(options.num_requests, 1 << 20));
+  std::atomic<bool> failed(false);
+  auto record = [&](const Status& request_status, int64 latency_us) {
+    mutex_lock l(mu);
+    if (!request_status.ok()) {
+      status.Update(request_status);
+      failed = true;
+      return;
+    }
+    latencies.push_back(latency_us);
+  };
+
+  const Usage start_usage = GetUsage();
+  const uint64 start_us = EnvTime::NowMicros();
+  const uint64 deadline_us =
+      start_us + static_cast<uint64>(options.max_time_s * 1e6);
+  std::atomic<int64> next_request(0);
+  {
+    // The destructor of the pool waits for all the requests to finish.
+    thread::ThreadPool pool(Env::Default(), "saved_model_benchmark",
+                            options.num_clients);
+    if (options.target_qps > 0) {
+      const double interval_us = 1e6 / options.target_qps;
+      for (int64 i = 0; i < options.num_requests && !failed; ++i) {
+        const uint64 scheduled_us =
+            start_us + static_cast<uint64>(i * interval_us);
+        if (scheduled_us >= deadline_us) break;
+        const uint64 now_us = EnvTime::NowMicros();
+        if (scheduled_us > now_us) {
+          Env::Default()->SleepForMicroseconds(scheduled_us - now_us);
+        }
+        // Latencies are measured from the scheduled time, so that a request
+        // that waits for a client is not reported as fast.
+        pool.Schedule([&run, &record, i, scheduled_us]() {
+          const Status request_status = run(i);
+          record(request_status, EnvTime::NowMicros() - scheduled_us);
+        });
+      }
+    } else {
+      for (int client = 0; client < options.num_clients; ++client) {
+        pool.Schedule([&]() {
+          while (!failed) {
+            const int64 i = next_request++;
+            if (i >= options.num_requests) break;
+            const uint64 request_start_us = EnvTime::NowMicros();
+            if (request_start_us >= deadline_us) break;
+            const Status request_status = run(i);
+            record(request_status, EnvTime::NowMicros() - request_start_us);
+          }
+        });
+      }
+    }
+  }
+  const uint64 end_us = EnvTime::NowMicros();
+  const Usage end_usage = GetUsage();
+  TF_RETURN_IF_ERROR(status);
+
+  *stats = SavedModelBenchmarkStats();
+  stats->num_clients = options.num_clients;
+  stats->target_qps = options.target_qps;
+  stats->num_requests = latencies.size();
+  stats->wall_time_s = (end_us - start_us) / 1e6;
+  if (stats->wall_time_s > 0) {
+    stats->throughput_qps = stats->num_requests / stats->wall_time_s;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  if (!latencies.empty()) {
+    double total_us = 0;
+    for (int64 latency : latencies) total_us += latency;
+    stats->mean_latency_us = total_us / latencies.size();
+    stats->min_latency_us = latencies.front();
+    stats->max_latency_us = latencies.back();
+  }
+  stats->p50_latency_us = Percentile(latencies, 0.5);
+  stats->p90_latency_us = Percentile(latencies, 0.9);
+  stats->p99_latency_us = Percentile(latencies, 0.99);
+  stats->p999_latency_us = Percentile(latencies, 0.999);
+  if (start_usage.cpu_micros >= 0 && end_usage.cpu_micros >= 0 &&
+      end_us > start_us) {
+    stats->cpu_utilization =
+        static_cast<double>(end_usage.cpu_micros - start_usage.cpu_micros) /
+        (end_us - start_us);
+  }
+  stats->peak_memory_bytes = end_usage.peak_memory_bytes;
+  return Status::OK();
+}
+
+}  // namespace benchmark_model
+}  // namespace tensorflow
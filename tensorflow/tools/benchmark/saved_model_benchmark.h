@@ -0,0 +1,94 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TOOLS_BENCHMARK_SAVED_MODEL_BENCHMARK_H_
+#define TENSORFLOW_TOOLS_BENCHMARK_SAVED_MODEL_BENCHMARK_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/cc/saved_model/warmup.pb.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace benchmark_model {
+
+// Options of a SavedModel serving benchmark.
+struct SavedModelBenchmarkOptions {
+  // The number of clients that send requests concurrently.
+  int num_clients = 1;
+  // If positive, requests are sent at this rate whatever the latency of the
+  // model (open loop), with at most `num_clients` of them in flight.
+  // Otherwise each client sends its next request as soon as the previous one
+  // returns (closed loop).
+  double target_qps = 0;
+  // The benchmark stops after `num_requests` requests or `max_time_s`
+  // seconds, whichever comes first.
+  int64 num_requests = 1000;
+  double max_time_s = 60;
+  // Requests run before the measurement, to create the executors and kernels.
+  int num_warmup_requests = 10;
+  RunOptions run_options;
+};
+
+// Results of a SavedModel serving benchmark. Latencies are in microseconds
+// and, in open loop, include the time requests waited for a free client.
+struct SavedModelBenchmarkStats {
+  int num_clients = 0;
+  double target_qps = 0;
+  int64 num_requests = 0;
+  double wall_time_s = 0;
+  double throughput_qps = 0;
+  double mean_latency_us = 0;
+  int64 min_latency_us = 0;
+  int64 p50_latency_us = 0;
+  int64 p90_latency_us = 0;
+  int64 p99_latency_us = 0;
+  int64 p999_latency_us = 0;
+  int64 max_latency_us = 0;
+  // The CPU time of the process during the benchmark over its wall time, or
+  // -1 if unknown: 2.0 means two cores were busy on average.
+  double cpu_utilization = -1;
+  // The peak resident memory of the process, or -1 if unknown.
+  int64 peak_memory_bytes = -1;
+
+  // Returns the stats as a JSON object.
+  std::string ToJson() const;
+};
+
+// Fills `request` with generated inputs for all the inputs of the signature
+// `signature_name` of `bundle`. Unknown dimensions are `batch_size` for the
+// first dimension and 1 for the others. Floating point inputs are random,
+// other inputs are zeros, false, or empty strings.
+Status MakeSignatureRequest(const SavedModelBundleInterface& bundle,
+                            const std::string& signature_name, int batch_size,
+                            SavedModelWarmupRequest* request);
+
+// Sends `requests` to the session of `bundle` in a round-robin fashion
+// following `options` and summarizes the latencies in `stats`. Fails with the
+// status of the first request that fails.
+Status RunSavedModelBenchmark(
+    const SavedModelBenchmarkOptions& options,
+    const SavedModelBundleInterface& bundle,
+    const std::vector<SavedModelWarmupRequest>& requests,
+    SavedModelBenchmarkStats* stats);
+
+}  // namespace benchmark_model
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_TOOLS_BENCHMARK_SAVED_MODEL_BENCHMARK_H_
@@ -0,0 +1,186 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks the serving latency and throughput of a SavedModel, for example:
+//
+// bazel run -c opt tensorflow/tools/benchmark:saved_model_benchmark -- \
+//   --saved_model_dir=/tmp/model/1 --num_clients=1,4,16 \
+//   --output_json=/tmp/benchmark.json
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/cc/saved_model/warmup.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/numbers.h"
+#include "tensorflow/core/platform/str_util.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/command_line_flags.h"
+#include "tensorflow/tools/benchmark/saved_model_benchmark.h"
+
+namespace tensorflow {
+namespace benchmark_model {
+namespace {
+
+int Main(int argc, char** argv) {
+  string saved_model_dir = "";
+  string tags = "serve";
+  string signature = "serving_default";
+  string requests_file = "";
+  int batch_size = 1;
+  string num_clients_string = "1";
+  float target_qps = 0;
+  int64 num_requests = 1000;
+  float max_time = 60;
+  int num_warmup_requests = 10;
+  string session_config_file = "";
+  int intra_op_threads = 0;
+  int inter_op_threads = 0;
+  string output_json = "";
+
+  std::vector<Flag> flag_list = {
+      Flag("saved_model_dir", &saved_model_dir, "the SavedModel to load"),
+      Flag("tags", &tags, "comma separated tags of the MetaGraph to load"),
+      Flag("signature", &signature,
+           "signature to generate the requests for, without --requests_file"),
+      Flag("requests_file", &requests_file,
+           "TFRecord file of SavedModelWarmupRequests to replay instead of "
+           "generated requests"),
+      Flag("batch_size", &batch_size,
+           "first dimension of the generated inputs of unknown size"),
+      Flag("num_clients", &num_clients_string,
+           "comma separated numbers of concurrent clients, one benchmark each"),
+      Flag("target_qps", &target_qps,
+           "if positive, send requests at this rate (open loop)"),
+      Flag("num_requests", &num_requests, "maximum requests per benchmark"),
+      Flag("max_time", &max_time, "maximum seconds per benchmark"),
+      Flag("num_warmup_requests", &num_warmup_requests,
+           "requests run before each benchmark"),
+      Flag("session_config", &session_config_file,
+           "text ConfigProto file of the serving session"),
+      Flag("intra_op_threads", &intra_op_threads,
+           "intra-op threads, overrides --session_config if positive"),
+      Flag("inter_op_threads", &inter_op_threads,
+           "inter-op threads, overrides --session_config if positive"),
+      Flag("output_json", &output_json, "file to write the results to"),
+  };
+  const string usage = Flags::Usage(argv[0], flag_list);
+  const bool parse_result = Flags::Parse(&argc, argv, flag_list);
+  if (!parse_result || saved_model_dir.empty()) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+  ::tensorflow::port::InitMain(argv[0], &argc, &argv);
+  if (argc > 1) {
+    LOG(ERROR) << "Unknown argument " << argv[1] << "\n" << usage;
+    return -1;
+  }
+
+  std::vector<int> num_clients;
+  for (const string& value : str_util::Split(num_clients_string, ',')) {
+    int32 clients;
+    if (!strings::safe_strto32(value, &clients) || clients < 1) {
+      LOG(ERROR) << "Invalid --num_clients: " << num_clients_string;
+      return -1;
+    }
+    num_clients.push_back(clients);
+  }
+
+  SessionOptions session_options;
+  if (!session_config_file.empty()) {
+    const Status s = ReadTextProto(Env::Default(), session_config_file,
+                                   &session_options.config);
+    if (!s.ok()) {
+      LOG(ERROR) << "Could not read --session_config: " << s;
+      return -1;
+    }
+  }
+  if (intra_op_threads > 0) {
+    session_options.config.set_intra_op_parallelism_threads(intra_op_threads);
+  }
+  if (inter_op_threads > 0) {
+    session_options.config.set_inter_op_parallelism_threads(inter_op_threads);
+  }
+  const std::vector<string> tag_list = str_util::Split(tags, ',');
+  const std::unordered_set<string> tag_set(tag_list.begin(), tag_list.end());
+  SavedModelBundle bundle;
+  Status s = LoadSavedModel(session_options, RunOptions(), saved_model_dir,
+                            tag_set, &bundle);
+  if (!s.ok()) {
+    LOG(ERROR) << "Could not load " << saved_model_dir << ": " << s;
+    return -1;
+  }
+
+  std::vector<SavedModelWarmupRequest> requests;
+  if (!requests_file.empty()) {
+    s = ReadSavedModelWarmupRequestsFromFile(requests_file, &requests);
+  } else {
+    requests.emplace_back();
+    s = MakeSignatureRequest(bundle, signature, batch_size, &requests.back());
+  }
+  if (!s.ok()) {
+    LOG(ERROR) << "Could not make the requests: " << s;
+    return -1;
+  }
+
+  std::vector<string> results;
+  for (int clients : num_clients) {
+    SavedModelBenchmarkOptions options;
+    options.num_clients = clients;
+    options.target_qps = target_qps;
+    options.num_requests = num_requests;
+    options.max_time_s = max_time;
+    options.num_warmup_requests = num_warmup_requests;
+    SavedModelBenchmarkStats stats;
+    s = RunSavedModelBenchmark(options, bundle, requests, &stats);
+    if (!s.ok()) {
+      LOG(ERROR) << "Benchmark with " << clients << " clients failed: " << s;
+      return -1;
+    }
+    LOG(INFO) << "Clients: " << clients << " Requests: " << stats.num_requests
+              << " Throughput: " << stats.throughput_qps
+              << " qps Latency p50: " << stats.p50_latency_us
+              << "us p90: " << stats.p90_latency_us
+              << "us p99: " << stats.p99_latency_us
+              << "us p99.9: " << stats.p999_latency_us
+              << "us CPU: " << stats.cpu_utilization
+              << " Peak memory: " << stats.peak_memory_bytes << " bytes";
+    results.push_back(stats.ToJson());
+  }
+
+  if (!output_json.empty()) {
+    s = WriteStringToFile(
+        Env::Default(), output_json,
+        strings::StrCat("[", str_util::Join(results, ", "), "]\n"));
+    if (!s.ok()) {
+      LOG(ERROR) << "Could not write " << output_json << ": " << s;
+      return -1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace benchmark_model
+}  // namespace tensorflow
+
+int main(int argc, char** argv) {
+  return tensorflow::benchmark_model::Main(argc, argv);
+}
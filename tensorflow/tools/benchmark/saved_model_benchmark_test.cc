@@ -0,0 +1,118 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tools/benchmark/saved_model_benchmark.h"
+
+#include <vector>
+
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/cc/saved_model/signature_constants.h"
+#include "tensorflow/cc/saved_model/tag_constants.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace benchmark_model {
+namespace {
+
+constexpr char kTestData[] = "cc/saved_model/testdata/half_plus_two/00000123";
+
+class SavedModelBenchmarkTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const string export_dir =
+        io::JoinPath(testing::TensorFlowSrcRoot(), kTestData);
+    TF_ASSERT_OK(LoadSavedModel(SessionOptions(), RunOptions(), export_dir,
+                                {kSavedModelTagServe}, &bundle_));
+    requests_.emplace_back();
+    TF_ASSERT_OK(MakeSignatureRequest(bundle_,
+                                      kDefaultServingSignatureDefKey,
+                                      /*batch_size=*/4, &requests_.back()));
+  }
+
+  SavedModelBundle bundle_;
+  std::vector<SavedModelWarmupRequest> requests_;
+};
+
+TEST_F(SavedModelBenchmarkTest, GeneratesSignatureInputs) {
+  const SavedModelWarmupRequest& request = requests_.front();
+  EXPECT_EQ(request.signature_name(), kDefaultServingSignatureDefKey);
+  const SignatureDef& signature =
+      bundle_.GetSignatures().at(kDefaultServingSignatureDefKey);
+  ASSERT_EQ(request.inputs_size(), signature.inputs_size());
+  for (const auto& input : signature.inputs()) {
+    Tensor tensor;
+    ASSERT_TRUE(tensor.FromProto(request.inputs().at(input.first)));
+    EXPECT_EQ(tensor.dtype(), input.second.dtype());
+    ASSERT_GE(tensor.dims(), 1);
+    if (input.second.tensor_shape().unknown_rank() ||
+        input.second.tensor_shape().dim(0).size() < 0) {
+      EXPECT_EQ(tensor.dim_size(0), 4);
+    }
+  }
+}
+
+TEST_F(SavedModelBenchmarkTest, UnknownSignature) {
+  SavedModelWarmupRequest request;
+  EXPECT_FALSE(MakeSignatureRequest(bundle_, "no_such_signature", 1, &request)
+                   .ok());
+}
+
+TEST_F(SavedModelBenchmarkTest, ClosedLoop) {
+  SavedModelBenchmarkOptions options;
+  options.num_clients = 4;
+  options.num_requests = 100;
+  options.num_warmup_requests = 1;
+  SavedModelBenchmarkStats stats;
+  TF_ASSERT_OK(RunSavedModelBenchmark(options, bundle_, requests_, &stats));
+  EXPECT_EQ(stats.num_clients, 4);
+  EXPECT_EQ(stats.num_requests, 100);
+  EXPECT_GT(stats.throughput_qps, 0);
+  EXPECT_LE(stats.min_latency_us, stats.p50_latency_us);
+  EXPECT_LE(stats.p50_latency_us, stats.p90_latency_us);
+  EXPECT_LE(stats.p90_latency_us, stats.p99_latency_us);
+  EXPECT_LE(stats.p99_latency_us, stats.p999_latency_us);
+  EXPECT_LE(stats.p999_latency_us, stats.max_latency_us);
+  EXPECT_NE(stats.ToJson().find("\"p999_latency_us\": "), string::npos);
+}
+
+TEST_F(SavedModelBenchmarkTest, OpenLoop) {
+  SavedModelBenchmarkOptions options;
+  options.num_clients = 2;
+  options.target_qps = 200;
+  options.num_requests = 20;
+  options.num_warmup_requests = 0;
+  SavedModelBenchmarkStats stats;
+  TF_ASSERT_OK(RunSavedModelBenchmark(options, bundle_, requests_, &stats));
+  EXPECT_EQ(stats.num_requests, 20);
+  // The last request is sent after 19 intervals of 5ms.
+  EXPECT_GE(stats.wall_time_s, 0.095);
+}
+
+TEST_F(SavedModelBenchmarkTest, FailingRequest) {
+  SavedModelWarmupRequest request = requests_.front();
+  const TensorProto input = request.inputs().begin()->second;
+  (*request.mutable_inputs())["no_such_input"] = input;
+  SavedModelBenchmarkOptions options;
+  SavedModelBenchmarkStats stats;
+  EXPECT_FALSE(
+      RunSavedModelBenchmark(options, bundle_, {request}, &stats).ok());
+}
+
+}  // namespace
+}  // namespace benchmark_model
+}  // namespace tensorflow